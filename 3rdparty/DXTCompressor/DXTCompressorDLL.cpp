@@ -35,8 +35,11 @@
 #include <cstdlib>
 #include <cstring>
 #include <emmintrin.h>
+#include <immintrin.h>
+#include <intrin.h>
 
 #define ALIGN16(x) __declspec(align(16)) x
+#define ALIGN32(x) __declspec(align(32)) x
 #define INSET_SHIFT 4 // Inset the bounding box with (range >> shift).
 #define C565_5_MASK 0xF8 // 0xFF minus last three bits
 #define C565_6_MASK 0xFC // 0xFF minus last two bits
@@ -76,12 +79,21 @@ namespace DXTC
 	// The buffer pointed to by outBuf should be large enough to store the compressed image. This
 	// implementation has an 8:1 compression ratio.
 	void CompressImageDXT1(const uint8_t* inBuf, uint8_t* outBuf, int width, int height)
+	{
+		CompressImageDXT1(inBuf, outBuf, width, height, 0, (height + 3) / 4);
+	}
+
+	void CompressImageDXT1(const uint8_t* inBuf, uint8_t* outBuf, int width, int height, int blockRowBegin, int blockRowEnd)
 	{
 		ALIGN16(uint8_t block[64]);
 		ALIGN16(uint8_t minColor[4]);
 		ALIGN16(uint8_t maxColor[4]);
 
-		for(int j = 0; j < height; j += 4, inBuf += width * 4 * 4)
+		assert(0 <= blockRowBegin && blockRowBegin <= blockRowEnd && blockRowEnd * 4 < height + 4);
+		inBuf += blockRowBegin * width * 4 * 4;
+		outBuf += blockRowBegin * (width / 4) * 8;
+
+		for(int j = blockRowBegin; j < blockRowEnd; ++j, inBuf += width * 4 * 4)
 		{
 			for(int i = 0; i < width; i += 4)
 			{
@@ -386,12 +398,21 @@ namespace DXTC
 	// must be 16-byte aligned and should be large enough to store the compressed image. This
 	// implementation has an 8:1 compression ratio.
 	void CompressImageDXT1SSE2(const uint8_t* inBuf, uint8_t* outBuf, int width, int height)
+	{
+		CompressImageDXT1SSE2(inBuf, outBuf, width, height, 0, (height + 3) / 4);
+	}
+
+	void CompressImageDXT1SSE2(const uint8_t* inBuf, uint8_t* outBuf, int width, int height, int blockRowBegin, int blockRowEnd)
 	{
 		ALIGN16(uint8_t block[64]);
 		ALIGN16(uint8_t minColor[4]);
 		ALIGN16(uint8_t maxColor[4]);
 
-		for(int j = 0; j < height; j += 4, inBuf += width * 4 * 4)
+		assert(0 <= blockRowBegin && blockRowBegin <= blockRowEnd && blockRowEnd * 4 < height + 4);
+		inBuf += blockRowBegin * width * 4 * 4;
+		outBuf += blockRowBegin * (width / 4) * 8;
+
+		for(int j = blockRowBegin; j < blockRowEnd; ++j, inBuf += width * 4 * 4)
 		{
 			for(int i = 0; i < width; i += 4)
 			{
@@ -435,6 +456,32 @@ namespace DXTC
 		}
 	}
 
+	void CompressImageDXT5SSE2(const uint8_t* inBuf, uint8_t* outBuf, int width, int height, int blockRowBegin, int blockRowEnd)
+	{
+		ALIGN16(uint8_t block[64]);
+		ALIGN16(uint8_t minColor[4]);
+		ALIGN16(uint8_t maxColor[4]);
+
+		assert(0 <= blockRowBegin && blockRowBegin <= blockRowEnd && blockRowEnd * 4 < height + 4);
+		inBuf += blockRowBegin * width * 4 * 4;
+		outBuf += blockRowBegin * (width / 4) * 16;
+
+		for(int j = blockRowBegin; j < blockRowEnd; ++j, inBuf += width * 4 * 4)
+		{
+			for(int i = 0; i < width; i += 4)
+			{
+				ExtractBlock_SSE2(inBuf + i * 4, width, block);
+				GetMinMaxColors_SSE2(block, minColor, maxColor);
+				EmitByte(outBuf, maxColor[3]);
+				EmitByte(outBuf, minColor[3]);
+				EmitAlphaIndices_SSE2(block, outBuf, minColor[3], maxColor[3]);
+				EmitWord(outBuf, ColorTo565(maxColor));
+				EmitWord(outBuf, ColorTo565(minColor));
+				EmitColorIndices_SSE2(block, outBuf, minColor, maxColor);
+			}
+		}
+	}
+
 	// Extract a 4 by 4 block of pixels from inPtr and store it in colorBlock. The width parameter
 	// specifies the size of the image in pixels.
 	void ExtractBlock_SSE2(const uint8_t* inPtr, int width, uint8_t* colorBlock)
@@ -795,4 +842,396 @@ namespace DXTC
 
 		outBuf += 6;
 	}
+
+	// AVX2 versions keep a pair of blocks in the two 128-bit lanes. Every operation below works
+	// within lanes, so each lane repeats the SSE2 computation for its own block.
+
+	bool HasAVX2()
+	{
+		static const bool result = []
+		{
+			int info[4];
+			__cpuid(info, 0);
+			if (info[0] < 7)
+				return false;
+			__cpuid(info, 1);
+			// os saves ymm registers and the cpu has avx
+			if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0)
+				return false;
+			if ((_xgetbv(0) & 6) != 6)
+				return false;
+			__cpuidex(info, 7, 0);
+			return (info[1] & (1 << 5)) != 0;
+		}();
+		return result;
+	}
+
+	// Extract two adjacent 4 by 4 blocks. Row r of the left block is stored at blocks + r * 32,
+	// the right block follows it in the upper lane.
+	static void ExtractBlockPair_AVX2(const uint8_t* inPtr, int width, uint8_t* blocks)
+	{
+		const int stride = width * 4;
+		for(int r = 0; r < 4; r++, inPtr += stride)
+		{
+			_mm256_store_si256((__m256i*)(blocks + r * 32), _mm256_loadu_si256((const __m256i*)inPtr));
+		}
+	}
+
+	// Load 8 bytes at offset of each block of the pair, offset is relative to a 64 byte block.
+	static __m256i LoadBlockPair64_AVX2(const uint8_t* blocks, int offset)
+	{
+		const uint8_t* p = blocks + (offset / 16) * 32 + (offset % 16);
+		__m128i lo = _mm_loadl_epi64((const __m128i*)p);
+		__m128i hi = _mm_loadl_epi64((const __m128i*)(p + 16));
+		return _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+	}
+
+	// The low uint32_t of each lane receives the inset bounding box of its block.
+	static void GetMinMaxColorPair_AVX2(const uint8_t* blocks, __m256i& minColors, __m256i& maxColors)
+	{
+		__m256i min = _mm256_load_si256((const __m256i*)blocks);
+		__m256i max = min;
+		for(int r = 1; r < 4; r++)
+		{
+			__m256i row = _mm256_load_si256((const __m256i*)(blocks + r * 32));
+			min = _mm256_min_epu8(min, row);
+			max = _mm256_max_epu8(max, row);
+		}
+
+		__m256i minShuf = _mm256_shuffle_epi32(min, R_SHUFFLE_D(2, 3, 2, 3));
+		__m256i maxShuf = _mm256_shuffle_epi32(max, R_SHUFFLE_D(2, 3, 2, 3));
+		min = _mm256_min_epu8(min, minShuf);
+		max = _mm256_max_epu8(max, maxShuf);
+
+		minShuf = _mm256_shufflelo_epi16(min, R_SHUFFLE_D(2, 3, 2, 3));
+		maxShuf = _mm256_shufflelo_epi16(max, R_SHUFFLE_D(2, 3, 2, 3));
+		min = _mm256_min_epu8(min, minShuf);
+		max = _mm256_max_epu8(max, maxShuf);
+
+		const __m256i zero = _mm256_setzero_si256();
+		min = _mm256_unpacklo_epi8(min, zero);
+		max = _mm256_unpacklo_epi8(max, zero);
+		__m256i inset = _mm256_sub_epi16(max, min);
+		inset = _mm256_srli_epi16(inset, INSET_SHIFT);
+
+		min = _mm256_add_epi16(min, inset);
+		max = _mm256_sub_epi16(max, inset);
+
+		minColors = _mm256_packus_epi16(min, min);
+		maxColors = _mm256_packus_epi16(max, max);
+	}
+
+	// Expand the low uint32_t of each lane from 565 precision back to 8 bits per channel.
+	static __m256i ExpandColorPair_AVX2(__m256i color)
+	{
+		const __m256i RGB565Mask = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)SIMD_SSE2_byte_colorMask));
+		const __m256i lowMask = _mm256_setr_epi32(-1, 0, 0, 0, -1, 0, 0, 0);
+		color = _mm256_and_si256(color, lowMask);
+		color = _mm256_and_si256(color, RGB565Mask);
+		color = _mm256_unpacklo_epi8(color, _mm256_setzero_si256());
+		__m256i redBlue = _mm256_shufflelo_epi16(color, R_SHUFFLE_D(0, 3, 2, 3));
+		__m256i green = _mm256_shufflelo_epi16(color, R_SHUFFLE_D(3, 1, 3, 3));
+		redBlue = _mm256_srli_epi16(redBlue, 5);
+		green = _mm256_srli_epi16(green, 6);
+		color = _mm256_or_si256(color, redBlue);
+		return _mm256_or_si256(color, green);
+	}
+
+	// Color indices of both blocks, see EmitColorIndices_SSE2.
+	static void GetColorIndexPair_AVX2(const uint8_t* blocks, __m256i minColors, __m256i maxColors, uint32_t* indices)
+	{
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i divBy3 = _mm256_set1_epi16((1 << 16) / 3 + 1);
+
+		__m256i color0 = ExpandColorPair_AVX2(maxColors);
+		__m256i color1 = ExpandColorPair_AVX2(minColors);
+
+		__m256i color3 = _mm256_add_epi16(color1, color1);
+		color3 = _mm256_add_epi16(color0, color3);
+		color3 = _mm256_mulhi_epi16(color3, divBy3);
+		color3 = _mm256_packus_epi16(color3, zero);
+		color3 = _mm256_shuffle_epi32(color3, R_SHUFFLE_D(0, 1, 0, 1));
+
+		__m256i color2 = _mm256_add_epi16(color0, color0);
+		color2 = _mm256_add_epi16(color2, color1);
+		color2 = _mm256_mulhi_epi16(color2, divBy3);
+		color2 = _mm256_packus_epi16(color2, zero);
+		color2 = _mm256_shuffle_epi32(color2, R_SHUFFLE_D(0, 1, 0, 1));
+
+		color1 = _mm256_packus_epi16(color1, zero);
+		color1 = _mm256_shuffle_epi32(color1, R_SHUFFLE_D(0, 1, 0, 1));
+
+		color0 = _mm256_packus_epi16(color0, zero);
+		color0 = _mm256_shuffle_epi32(color0, R_SHUFFLE_D(0, 1, 0, 1));
+
+		const __m256i word1 = _mm256_set1_epi16(1);
+		const __m256i word2 = _mm256_set1_epi16(2);
+		__m256i result = zero;
+		for(int i = 32; i >= 0; i -= 32)
+		{
+			__m256i colorHi = _mm256_shuffle_epi32(LoadBlockPair64_AVX2(blocks, i), R_SHUFFLE_D(0, 2, 1, 3));
+			__m256i colorLo = _mm256_shuffle_epi32(LoadBlockPair64_AVX2(blocks, i + 8), R_SHUFFLE_D(0, 2, 1, 3));
+
+			__m256i dHi = _mm256_sad_epu8(colorHi, color0);
+			__m256i dLo = _mm256_sad_epu8(colorLo, color0);
+			__m256i d0 = _mm256_packs_epi32(dHi, dLo);
+			dHi = _mm256_sad_epu8(colorHi, color1);
+			dLo = _mm256_sad_epu8(colorLo, color1);
+			__m256i d1 = _mm256_packs_epi32(dHi, dLo);
+			dHi = _mm256_sad_epu8(colorHi, color2);
+			dLo = _mm256_sad_epu8(colorLo, color2);
+			__m256i d2 = _mm256_packs_epi32(dHi, dLo);
+			dHi = _mm256_sad_epu8(colorHi, color3);
+			dLo = _mm256_sad_epu8(colorLo, color3);
+			__m256i d3 = _mm256_packs_epi32(dHi, dLo);
+
+			colorHi = _mm256_shuffle_epi32(LoadBlockPair64_AVX2(blocks, i + 16), R_SHUFFLE_D(0, 2, 1, 3));
+			colorLo = _mm256_shuffle_epi32(LoadBlockPair64_AVX2(blocks, i + 24), R_SHUFFLE_D(0, 2, 1, 3));
+
+			dHi = _mm256_sad_epu8(colorHi, color0);
+			dLo = _mm256_sad_epu8(colorLo, color0);
+			dLo = _mm256_packs_epi32(dHi, dLo);
+			d0 = _mm256_packs_epi32(d0, dLo);
+			dHi = _mm256_sad_epu8(colorHi, color1);
+			dLo = _mm256_sad_epu8(colorLo, color1);
+			dLo = _mm256_packs_epi32(dHi, dLo);
+			d1 = _mm256_packs_epi32(d1, dLo);
+			dHi = _mm256_sad_epu8(colorHi, color2);
+			dLo = _mm256_sad_epu8(colorLo, color2);
+			dLo = _mm256_packs_epi32(dHi, dLo);
+			d2 = _mm256_packs_epi32(d2, dLo);
+			dHi = _mm256_sad_epu8(colorHi, color3);
+			dLo = _mm256_sad_epu8(colorLo, color3);
+			dLo = _mm256_packs_epi32(dHi, dLo);
+			d3 = _mm256_packs_epi32(d3, dLo);
+
+			__m256i b0 = _mm256_cmpgt_epi16(d0, d3);
+			__m256i b1 = _mm256_cmpgt_epi16(d1, d2);
+			__m256i b2 = _mm256_cmpgt_epi16(d0, d2);
+			__m256i b3 = _mm256_cmpgt_epi16(d1, d3);
+			__m256i b4 = _mm256_cmpgt_epi16(d2, d3);
+
+			__m256i x0 = _mm256_and_si256(b2, b1);
+			__m256i x1 = _mm256_and_si256(b3, b0);
+			__m256i x2 = _mm256_and_si256(b4, b0);
+			__m256i indexBit0 = _mm256_or_si256(x0, x1);
+			indexBit0 = _mm256_and_si256(indexBit0, word2);
+			__m256i indexBit1 = _mm256_and_si256(x2, word1);
+			__m256i index = _mm256_or_si256(indexBit1, indexBit0);
+
+			__m256i indexHi = _mm256_shuffle_epi32(index, R_SHUFFLE_D(2, 3, 0, 1));
+			indexHi = _mm256_unpacklo_epi16(indexHi, zero);
+			indexHi = _mm256_slli_epi32(indexHi, 8);
+			__m256i indexLo = _mm256_unpacklo_epi16(index, zero);
+			result = _mm256_slli_epi32(result, 16);
+			result = _mm256_or_si256(result, indexHi);
+			result = _mm256_or_si256(result, indexLo);
+		}
+
+		__m256i result1 = _mm256_shuffle_epi32(result, R_SHUFFLE_D(1, 2, 3, 0));
+		__m256i result2 = _mm256_shuffle_epi32(result, R_SHUFFLE_D(2, 3, 0, 1));
+		__m256i result3 = _mm256_shuffle_epi32(result, R_SHUFFLE_D(3, 0, 1, 2));
+		result1 = _mm256_slli_epi32(result1, 2);
+		result2 = _mm256_slli_epi32(result2, 4);
+		result3 = _mm256_slli_epi32(result3, 6);
+		result = _mm256_or_si256(result, result1);
+		result = _mm256_or_si256(result, result2);
+		result = _mm256_or_si256(result, result3);
+
+		indices[0] = (uint32_t)_mm256_cvtsi256_si32(result);
+		indices[1] = (uint32_t)_mm256_extract_epi32(result, 4);
+	}
+
+	// Alpha indices of both blocks, 6 bytes each, see EmitAlphaIndices_SSE2.
+	static void GetAlphaIndexPair_AVX2(const uint8_t* blocks, const uint8_t* minAlpha, const uint8_t* maxAlpha, uint8_t (*indices)[8])
+	{
+		__m256i alpha1 = _mm256_srli_epi32(_mm256_load_si256((const __m256i*)blocks), 24);
+		__m256i alpha2 = _mm256_srli_epi32(_mm256_load_si256((const __m256i*)(blocks + 32)), 24);
+		alpha1 = _mm256_packus_epi16(alpha1, alpha2);
+		__m256i alpha3 = _mm256_srli_epi32(_mm256_load_si256((const __m256i*)(blocks + 64)), 24);
+		__m256i alpha4 = _mm256_srli_epi32(_mm256_load_si256((const __m256i*)(blocks + 96)), 24);
+		alpha3 = _mm256_packus_epi16(alpha3, alpha4);
+		__m256i alpha = _mm256_packus_epi16(alpha1, alpha3);
+
+		__m256i max = _mm256_set_m128i(_mm_set1_epi16(maxAlpha[1]), _mm_set1_epi16(maxAlpha[0]));
+		__m256i min = _mm256_set_m128i(_mm_set1_epi16(minAlpha[1]), _mm_set1_epi16(minAlpha[0]));
+
+		const __m256i divBy7 = _mm256_set1_epi16((1 << 16) / 7 + 1);
+		const __m256i scale66554400 = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)SIMD_SSE2_word_scale66554400));
+		const __m256i scale11223300 = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)SIMD_SSE2_word_scale11223300));
+
+		__m256i mid = _mm256_sub_epi16(max, min);
+		mid = _mm256_mulhi_epi16(mid, _mm256_set1_epi16((1 << 16) / 14 + 1));
+
+		__m256i ab1 = _mm256_add_epi16(min, mid);
+		ab1 = _mm256_packus_epi16(ab1, ab1);
+
+		__m256i max456 = _mm256_mullo_epi16(max, scale66554400);
+		__m256i min123 = _mm256_mullo_epi16(min, scale11223300);
+		__m256i ab234 = _mm256_add_epi16(max456, min123);
+		ab234 = _mm256_mulhi_epi16(ab234, divBy7);
+		ab234 = _mm256_add_epi16(ab234, mid);
+		__m256i ab2 = _mm256_shuffle_epi32(ab234, R_SHUFFLE_D(0, 0, 0, 0));
+		ab2 = _mm256_packus_epi16(ab2, ab2);
+		__m256i ab3 = _mm256_shuffle_epi32(ab234, R_SHUFFLE_D(1, 1, 1, 1));
+		ab3 = _mm256_packus_epi16(ab3, ab3);
+		__m256i ab4 = _mm256_shuffle_epi32(ab234, R_SHUFFLE_D(2, 2, 2, 2));
+		ab4 = _mm256_packus_epi16(ab4, ab4);
+
+		__m256i max123 = _mm256_mullo_epi16(max, scale11223300);
+		__m256i min456 = _mm256_mullo_epi16(min, scale66554400);
+		__m256i ab567 = _mm256_add_epi16(max123, min456);
+		ab567 = _mm256_mulhi_epi16(ab567, divBy7);
+		ab567 = _mm256_add_epi16(ab567, mid);
+		__m256i ab5 = _mm256_shuffle_epi32(ab567, R_SHUFFLE_D(2, 2, 2, 2));
+		ab5 = _mm256_packus_epi16(ab5, ab5);
+		__m256i ab6 = _mm256_shuffle_epi32(ab567, R_SHUFFLE_D(1, 1, 1, 1));
+		ab6 = _mm256_packus_epi16(ab6, ab6);
+		__m256i ab7 = _mm256_shuffle_epi32(ab567, R_SHUFFLE_D(0, 0, 0, 0));
+		ab7 = _mm256_packus_epi16(ab7, ab7);
+
+		// count the midpoints each alpha value does not exceed
+		const __m256i byte1 = _mm256_set1_epi8(1);
+		const __m256i midpoints[7] = { ab1, ab2, ab3, ab4, ab5, ab6, ab7 };
+		__m256i index = _mm256_setzero_si256();
+		for(int k = 0; k < 7; k++)
+		{
+			__m256i b = _mm256_cmpeq_epi8(_mm256_min_epu8(midpoints[k], alpha), alpha);
+			index = _mm256_adds_epu8(index, _mm256_and_si256(b, byte1));
+		}
+
+		// Convert natural index ordering to DXT index ordering.
+		index = _mm256_adds_epu8(index, byte1);
+		index = _mm256_and_si256(index, _mm256_set1_epi8(7));
+		__m256i swapMinMax = _mm256_cmpgt_epi8(_mm256_set1_epi8(2), index);
+		swapMinMax = _mm256_and_si256(swapMinMax, byte1);
+		index = _mm256_xor_si256(index, swapMinMax);
+
+		// Pack the 16 3-bit indices of each lane into 6 bytes.
+		__m256i packed = _mm256_and_si256(index,
+			_mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)SIMD_SSE2_dword_alpha_bit_mask0)));
+		const uint32_t* masks[7] = {
+			SIMD_SSE2_dword_alpha_bit_mask1, SIMD_SSE2_dword_alpha_bit_mask2, SIMD_SSE2_dword_alpha_bit_mask3,
+			SIMD_SSE2_dword_alpha_bit_mask4, SIMD_SSE2_dword_alpha_bit_mask5, SIMD_SSE2_dword_alpha_bit_mask6,
+			SIMD_SSE2_dword_alpha_bit_mask7,
+		};
+		for(int k = 1; k < 8; k++)
+		{
+			__m256i shifted = _mm256_srli_epi64(index, 5 * k);
+			shifted = _mm256_and_si256(shifted, _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)masks[k - 1])));
+			packed = _mm256_or_si256(packed, shifted);
+		}
+
+		// bytes 0-2 of each uint64_t hold the 24 bits of 8 indices
+		__m256i packedHi = _mm256_shuffle_epi32(packed, R_SHUFFLE_D(2, 3, 0, 1));
+		uint32_t lo0 = (uint32_t)_mm256_cvtsi256_si32(packed);
+		uint32_t lo1 = (uint32_t)_mm256_extract_epi32(packed, 4);
+		uint32_t hi0 = (uint32_t)_mm256_cvtsi256_si32(packedHi);
+		uint32_t hi1 = (uint32_t)_mm256_extract_epi32(packedHi, 4);
+		memcpy(indices[0], &lo0, 3);
+		memcpy(indices[0] + 3, &hi0, 3);
+		memcpy(indices[1], &lo1, 3);
+		memcpy(indices[1] + 3, &hi1, 3);
+	}
+
+	void CompressImageDXT1AVX2(const uint8_t* inBuf, uint8_t* outBuf, int width, int height, int blockRowBegin, int blockRowEnd)
+	{
+		ALIGN32(uint8_t blocks[128]);
+		ALIGN16(uint8_t block[64]);
+		ALIGN16(uint8_t minColor[2][4]);
+		ALIGN16(uint8_t maxColor[2][4]);
+		uint32_t indices[2];
+
+		assert(0 <= blockRowBegin && blockRowBegin <= blockRowEnd && blockRowEnd * 4 < height + 4);
+		inBuf += blockRowBegin * width * 4 * 4;
+		outBuf += blockRowBegin * (width / 4) * 8;
+
+		for(int j = blockRowBegin; j < blockRowEnd; ++j, inBuf += width * 4 * 4)
+		{
+			int i = 0;
+			for(; i + 8 <= width; i += 8)
+			{
+				__m256i minColors, maxColors;
+				ExtractBlockPair_AVX2(inBuf + i * 4, width, blocks);
+				GetMinMaxColorPair_AVX2(blocks, minColors, maxColors);
+				GetColorIndexPair_AVX2(blocks, minColors, maxColors, indices);
+				*((int*)minColor[0]) = _mm256_cvtsi256_si32(minColors);
+				*((int*)minColor[1]) = _mm256_extract_epi32(minColors, 4);
+				*((int*)maxColor[0]) = _mm256_cvtsi256_si32(maxColors);
+				*((int*)maxColor[1]) = _mm256_extract_epi32(maxColors, 4);
+				for(int b = 0; b < 2; b++)
+				{
+					EmitWord(outBuf, ColorTo565(maxColor[b]));
+					EmitWord(outBuf, ColorTo565(minColor[b]));
+					EmitDoubleWord(outBuf, indices[b]);
+				}
+			}
+			// odd block at the end of the row
+			for(; i < width; i += 4)
+			{
+				ExtractBlock_SSE2(inBuf + i * 4, width, block);
+				GetMinMaxColors_SSE2(block, minColor[0], maxColor[0]);
+				EmitWord(outBuf, ColorTo565(maxColor[0]));
+				EmitWord(outBuf, ColorTo565(minColor[0]));
+				EmitColorIndices_SSE2(block, outBuf, minColor[0], maxColor[0]);
+			}
+		}
+		_mm256_zeroupper();
+	}
+
+	void CompressImageDXT5AVX2(const uint8_t* inBuf, uint8_t* outBuf, int width, int height, int blockRowBegin, int blockRowEnd)
+	{
+		ALIGN32(uint8_t blocks[128]);
+		ALIGN16(uint8_t block[64]);
+		ALIGN16(uint8_t minColor[2][4]);
+		ALIGN16(uint8_t maxColor[2][4]);
+		uint32_t indices[2];
+		uint8_t alphaIndices[2][8];
+
+		assert(0 <= blockRowBegin && blockRowBegin <= blockRowEnd && blockRowEnd * 4 < height + 4);
+		inBuf += blockRowBegin * width * 4 * 4;
+		outBuf += blockRowBegin * (width / 4) * 16;
+
+		for(int j = blockRowBegin; j < blockRowEnd; ++j, inBuf += width * 4 * 4)
+		{
+			int i = 0;
+			for(; i + 8 <= width; i += 8)
+			{
+				__m256i minColors, maxColors;
+				ExtractBlockPair_AVX2(inBuf + i * 4, width, blocks);
+				GetMinMaxColorPair_AVX2(blocks, minColors, maxColors);
+				GetColorIndexPair_AVX2(blocks, minColors, maxColors, indices);
+				*((int*)minColor[0]) = _mm256_cvtsi256_si32(minColors);
+				*((int*)minColor[1]) = _mm256_extract_epi32(minColors, 4);
+				*((int*)maxColor[0]) = _mm256_cvtsi256_si32(maxColors);
+				*((int*)maxColor[1]) = _mm256_extract_epi32(maxColors, 4);
+				const uint8_t minAlpha[2] = { minColor[0][3], minColor[1][3] };
+				const uint8_t maxAlpha[2] = { maxColor[0][3], maxColor[1][3] };
+				GetAlphaIndexPair_AVX2(blocks, minAlpha, maxAlpha, alphaIndices);
+				for(int b = 0; b < 2; b++)
+				{
+					EmitByte(outBuf, maxAlpha[b]);
+					EmitByte(outBuf, minAlpha[b]);
+					memcpy(outBuf, alphaIndices[b], 6);
+					outBuf += 6;
+					EmitWord(outBuf, ColorTo565(maxColor[b]));
+					EmitWord(outBuf, ColorTo565(minColor[b]));
+					EmitDoubleWord(outBuf, indices[b]);
+				}
+			}
+			// odd block at the end of the row
+			for(; i < width; i += 4)
+			{
+				ExtractBlock_SSE2(inBuf + i * 4, width, block);
+				GetMinMaxColors_SSE2(block, minColor[0], maxColor[0]);
+				EmitByte(outBuf, maxColor[0][3]);
+				EmitByte(outBuf, minColor[0][3]);
+				EmitAlphaIndices_SSE2(block, outBuf, minColor[0][3], maxColor[0][3]);
+				EmitWord(outBuf, ColorTo565(maxColor[0]));
+				EmitWord(outBuf, ColorTo565(minColor[0]));
+				EmitColorIndices_SSE2(block, outBuf, minColor[0], maxColor[0]);
+			}
+		}
+		_mm256_zeroupper();
+	}
 }
@@ -52,4 +52,16 @@ namespace DXTC
     void GetMinMaxColors_SSE2(const uint8_t* colorBlock, uint8_t* minColor, uint8_t* maxColor);
     void EmitColorIndices_SSE2(const uint8_t* colorBlock, uint8_t*& outBuf, const uint8_t* minColor, const uint8_t* maxColor);
     void EmitAlphaIndices_SSE2(const uint8_t* colorBlock, uint8_t*& outBuf, const uint8_t minAlpha, const uint8_t maxAlpha);
+
+	// Block row versions compress rows [blockRowBegin, blockRowEnd) of 4x4 blocks. inBuf and outBuf
+	// point to the start of the image, disjoint row ranges can be compressed on different threads.
+	void CompressImageDXT1(const uint8_t* inBuf, uint8_t* outBuf, int width, int height, int blockRowBegin, int blockRowEnd);
+	void CompressImageDXT1SSE2(const uint8_t* inBuf, uint8_t* outBuf, int width, int height, int blockRowBegin, int blockRowEnd);
+	void CompressImageDXT5SSE2(const uint8_t* inBuf, uint8_t* outBuf, int width, int height, int blockRowBegin, int blockRowEnd);
+
+	// DXT compressor (AVX2 version), two horizontally adjacent blocks per iteration.
+	// Output matches the SSE2 version, callers must check HasAVX2 first.
+	bool HasAVX2();
+	void CompressImageDXT1AVX2(const uint8_t* inBuf, uint8_t* outBuf, int width, int height, int blockRowBegin, int blockRowEnd);
+	void CompressImageDXT5AVX2(const uint8_t* inBuf, uint8_t* outBuf, int width, int height, int blockRowBegin, int blockRowEnd);
 }
@@ -0,0 +1,331 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "SLuminousBenchmark.h"
+#include <Star/DX12Engine/SDX12Factory.h>
+#include <Star/SMappedFile.h>
+#include <Star/Core/SStartupTimeline.h>
+#include <fstream>
+#include <future>
+
+namespace Star {
+
+using namespace Graphics::Render;
+
+namespace {
+
+constexpr uint32_t sBenchmarkSwapChain = 0;
+
+void writeJsonString(std::ostream& os, std::string_view str) {
+    os << '"';
+    for (char c : str) {
+        if (c == '"' || c == '\\') {
+            os << '\\';
+        }
+        os << c;
+    }
+    os << '"';
+}
+
+// nearest rank of sorted samples
+double percentile(const std::vector<double>& sorted, double p) noexcept {
+    if (sorted.empty())
+        return 0;
+    auto rank = static_cast<size_t>(std::ceil(p / 100.0 * sorted.size()));
+    return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+void writeStatistics(std::ostream& os, std::vector<double> samples) {
+    std::sort(samples.begin(), samples.end());
+    double sum = 0;
+    for (auto ms : samples) {
+        sum += ms;
+    }
+    os << "{\"samples\":" << samples.size()
+        << ",\"mean\":" << (samples.empty() ? 0 : sum / samples.size())
+        << ",\"min\":" << (samples.empty() ? 0 : samples.front())
+        << ",\"p50\":" << percentile(samples, 50)
+        << ",\"p90\":" << percentile(samples, 90)
+        << ",\"p95\":" << percentile(samples, 95)
+        << ",\"p99\":" << percentile(samples, 99)
+        << ",\"max\":" << (samples.empty() ? 0 : samples.back());
+    // sorted samples, for rank tests of Star.PerfCompare
+    os << ",\"values\":[";
+    for (size_t i = 0; i != samples.size(); ++i) {
+        os << (i ? "," : "") << samples[i];
+    }
+    os << "]}";
+}
+
+}
+
+LuminousBenchmark::LuminousBenchmark(HINSTANCE hInstance, const Options& options)
+    : DesktopApp(hInstance, DesktopApp::Desc{})
+    , mOptions(options)
+    , mAssetManager(std::make_unique<Asset::AssetFactory>(
+        R"(asset)", R"(windows2)",
+        std::pmr::get_default_resource()))
+    , mFrameTimer(mRenderService)
+{
+    if (!mOptions.mReplay.empty()) {
+        MappedFile file(mOptions.mReplay);
+        auto& capture = mCapture.emplace();
+        loadRenderCapture(file.data(), file.size(), capture);
+        if (capture.mFrames.empty()) {
+            throw std::invalid_argument("render capture has no frame: " + mOptions.mReplay);
+        }
+        mOptions.mRenderGraph = capture.mHeader.mRenderGraph;
+        mOptions.mSolutionName = capture.name(capture.mHeader.mSolutionName);
+        mOptions.mPipelineName = capture.name(capture.mHeader.mPipelineName);
+        if (capture.mHeader.mWidth) {
+            mOptions.mWidth = capture.mHeader.mWidth;
+            mOptions.mHeight = capture.mHeader.mHeight;
+        }
+        mOptions.mFrames = gsl::narrow<uint32_t>(capture.mFrames.size());
+    }
+    Expects(mOptions.mFrames);
+
+    auto& configs = mConfigs;
+    configs.mNumSwapChains = 1;
+    configs.mFrameQueueSize = 3;
+    configs.mNumRecordingThreads = 4;
+    configs.mPipelineCaching = true;
+    configs.mRenderPasses = true;
+    configs.mGpuProfiling = true;
+
+    configs.mRenderGraph = mOptions.mRenderGraph;
+    configs.mSolutionName = mOptions.mSolutionName;
+    configs.mPipelineName = mOptions.mPipelineName;
+
+    if (!mOptions.mParallelStartup) {
+        createEngine();
+    }
+
+    mCpuMilliseconds.reserve(mOptions.mFrames);
+    mGpuMilliseconds.reserve(mOptions.mFrames);
+}
+
+LuminousBenchmark::~LuminousBenchmark() = default;
+
+// task threads do not run yet when called by the constructor
+void LuminousBenchmark::createEngine() {
+    STAR_STARTUP_SCOPE("engine creation");
+    Engine::Context context{
+        &mRenderService, &mTaskService,
+        &mRenderStrand, &mTaskStrand,
+        &mJobSystem,
+    };
+
+    EngineMemory memory{
+        &mPool,
+        &mMonotonic,
+        &mPerFrame,
+        &mPerPass,
+        &mPerBatch,
+        &mPerInstance
+    };
+
+    mEngine = Star::Graphics::Render::createDX12Engine(memory, context, mConfigs);
+}
+
+void LuminousBenchmark::start() {
+    if (mOptions.mParallelStartup) {
+        // the asset factory is bound to the render thread and the render graph needs its producers,
+        // device creation and engine settings overlap the scan instead
+        auto engineTask = std::make_shared<std::packaged_task<void()>>([this]() {
+            createEngine();
+            mEngine->preload();
+        });
+        auto engineReady = engineTask->get_future();
+        post(mTaskService, [engineTask]() {
+            (*engineTask)();
+        });
+
+        mAssetManager->scan();
+        mAssetManager->registerProducers();
+        {
+            STAR_STARTUP_SCOPE("engine wait");
+            engineReady.get();
+        }
+    } else {
+        mAssetManager->scan();
+        mAssetManager->registerProducers();
+    }
+
+    {
+        STAR_STARTUP_SCOPE("engine start");
+        mEngine->start();
+    }
+
+    mBenchmarkWork = mRenderWorkObserver.lock();
+    Ensures(mBenchmarkWork);
+
+    // swapchain without window, created by resize
+    auto& sc = mSwapChainContext;
+    sc.mName = "Benchmark";
+    sc.mWidth = mOptions.mWidth;
+    sc.mHeight = mOptions.mHeight;
+    sc.mMaxFrameLatency = 3;
+    mEngine->startSwapChain(sBenchmarkSwapChain, nullptr);
+    mEngine->resizeSwapChain(sBenchmarkSwapChain, sc);
+
+    post(mRenderStrand, [this]() {
+        renderFrame();
+    });
+}
+
+void LuminousBenchmark::stop() noexcept {
+    mEngine->stop();
+}
+
+void LuminousBenchmark::renderFrame() {
+    // handlers of the strand run in order, engine renders between them
+    post(mRenderStrand, [this]() {
+        mFrameBegin = std::chrono::steady_clock::now();
+    });
+    // engine calls are posted to the strand, inputs are applied in order before the frame renders
+    if (mCapture && mMeasuring) {
+        replayRenderCaptureFrame(*mCapture, mMeasuredFrames, *mEngine,
+            sBenchmarkSwapChain, mSwapChainContext);
+    }
+    mEngine->renderSwapChain(sBenchmarkSwapChain);
+    post(mRenderStrand, [this]() {
+        endFrame();
+    });
+}
+
+void LuminousBenchmark::endFrame() {
+    auto frameEnd = std::chrono::steady_clock::now();
+    auto counters = Core::Counters::lastFrame();
+
+    if (mWarmedFrames == 0 && !mMeasuring) {
+        Core::StartupTimeline::record("first frame", mFrameBegin, frameEnd);
+        std::ostringstream oss;
+        Core::StartupTimeline::writeReport(oss);
+        S_INFO << oss.str();
+    }
+
+    if (!mMeasuring) {
+        ++mWarmedFrames;
+        // content is streamed by the first frames, measured once it is resident
+        mMeasuring = mWarmedFrames >= mOptions.mWarmupFrames && !counters[Core::Gauge::ResourcesLoading];
+    } else {
+        mCpuMilliseconds.emplace_back(
+            std::chrono::duration<double, std::milli>(frameEnd - mFrameBegin).count());
+
+        // gpu timings lag frame queue size frames, they belong to measured frames too
+        mGpuTimings.clear();
+        mGpuMilliseconds.emplace_back(mEngine->getGpuTimings(mGpuTimings));
+        for (const auto& timing : mGpuTimings) {
+            auto iter = std::find_if(mPassMilliseconds.begin(), mPassMilliseconds.end(),
+                [&](const PassSamples& pass) { return pass.mName == timing.mName; });
+            if (iter == mPassMilliseconds.end()) {
+                iter = mPassMilliseconds.emplace(mPassMilliseconds.end(), PassSamples{ std::string(timing.mName) });
+            }
+            iter->mMilliseconds.emplace_back(timing.mMilliseconds);
+        }
+
+        for (size_t i = 0; i != mCounterSums.size(); ++i) {
+            mCounterSums[i] += counters.mCounters[i];
+        }
+
+        if (++mMeasuredFrames == mOptions.mFrames) {
+            writeResults();
+            mEngine->stopSwapChain(sBenchmarkSwapChain);
+            // render service stops once the swapchain is released
+            post(mRenderStrand, [this]() {
+                mBenchmarkWork.reset();
+            });
+            return;
+        }
+    }
+
+    if (mOptions.mFrameInterval == 0) {
+        renderFrame();
+        return;
+    }
+
+    // fixed pacing, measured from the start of the frame
+    mFrameTimer.expires_at(mFrameBegin + std::chrono::milliseconds(mOptions.mFrameInterval));
+    mFrameTimer.async_wait(boost::asio::bind_executor(mRenderStrand, [this](const boost::system::error_code& ec) {
+        if (!ec) {
+            renderFrame();
+        }
+    }));
+}
+
+void LuminousBenchmark::writeResults() const {
+    std::ofstream os(mOptions.mOutput);
+    if (!os) {
+        S_ERROR << "benchmark output not writable: " << mOptions.mOutput;
+        return;
+    }
+
+    os << "{\"renderGraph\":\"" << mOptions.mRenderGraph << "\"";
+    os << ",\"solution\":";
+    writeJsonString(os, mOptions.mSolutionName);
+    os << ",\"pipeline\":";
+    writeJsonString(os, mOptions.mPipelineName);
+    os << ",\"width\":" << mOptions.mWidth
+        << ",\"height\":" << mOptions.mHeight
+        << ",\"warmupFrames\":" << mWarmedFrames
+        << ",\"frameInterval\":" << mOptions.mFrameInterval;
+    if (mCapture) {
+        os << ",\"replay\":";
+        writeJsonString(os, mOptions.mReplay);
+    }
+
+    // launch to the end of the first frame
+    os << ",\n\"startup\":{\"mode\":\"" << (mOptions.mParallelStartup ? "parallel" : "sequential")
+        << "\",\"milliseconds\":" << Core::StartupTimeline::totalMilliseconds()
+        << ",\"phases\":";
+    Core::StartupTimeline::writeJson(os);
+    os << "}";
+
+    os << ",\n\"cpu\":";
+    writeStatistics(os, mCpuMilliseconds);
+    os << ",\n\"gpu\":";
+    writeStatistics(os, mGpuMilliseconds);
+
+    os << ",\n\"passes\":[";
+    for (size_t i = 0; i != mPassMilliseconds.size(); ++i) {
+        if (i) {
+            os << ",";
+        }
+        os << "\n{\"name\":";
+        writeJsonString(os, mPassMilliseconds[i].mName);
+        os << ",\"gpu\":";
+        writeStatistics(os, mPassMilliseconds[i].mMilliseconds);
+        os << "}";
+    }
+    os << "\n]";
+
+    // means per measured frame
+    os << ",\n\"counters\":{";
+    for (size_t i = 0; i != mCounterSums.size(); ++i) {
+        if (i) {
+            os << ",";
+        }
+        writeJsonString(os, Core::Counters::name(Core::Counter(i)));
+        os << ":" << double(mCounterSums[i]) / std::max(1u, mMeasuredFrames);
+    }
+    os << "}}\n";
+
+    S_INFO << "benchmark written: " << mOptions.mOutput;
+}
+
+}
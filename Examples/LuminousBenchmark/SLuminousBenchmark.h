@@ -0,0 +1,98 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include "../LuminousDesktop/SDesktopApp.h"
+#include <Star/Graphics/SRenderEngine.h>
+#include <Star/Graphics/SRenderCapture.h>
+#include <Star/AssetFactory/SAssetFactory.h>
+#include <Star/Core/SCounters.h>
+#include <boost/asio/steady_timer.hpp>
+
+namespace Star {
+
+// renders a render graph offscreen without window, timings are written to json
+class LuminousBenchmark : public DesktopApp {
+public:
+    struct Options {
+        MetaID mRenderGraph;
+        std::string mSolutionName = "Deferred";
+        std::string mPipelineName = "Diffuse";
+        uint32_t mWidth = 1280;
+        uint32_t mHeight = 720;
+        // frames rendered after content is loaded, not measured
+        uint32_t mWarmupFrames = 60;
+        uint32_t mFrames = 1000;
+        // milliseconds between frame starts, 0 renders as fast as the frame queue allows
+        uint32_t mFrameInterval = 0;
+        std::string mOutput = "benchmark.json";
+        // capture of Star.Luminous.Desktop --capture, its frames are measured with their recorded inputs
+        // render graph, solution, pipeline and size of the capture replace the options
+        std::string mReplay;
+        // engine is created and its settings read on a task thread while assets are scanned
+        bool mParallelStartup = false;
+    };
+
+    LuminousBenchmark(HINSTANCE hInstance, const Options& options);
+    ~LuminousBenchmark();
+private:
+    void start() override;
+    void stop() noexcept override;
+
+    void createEngine();
+    void renderFrame();
+    void endFrame();
+    void writeResults() const;
+
+    struct PassSamples {
+        std::string mName;
+        std::vector<double> mMilliseconds;
+    };
+
+    Options mOptions;
+
+    std::pmr::monotonic_buffer_resource mMonotonic;
+    FrameArena mPerFrame;
+    FrameArena mPerPass;
+    FrameArena mPerBatch;
+    FrameArena mPerInstance;
+    std::pmr::synchronized_pool_resource mPool;
+
+    std::unique_ptr<Asset::AssetFactory> mAssetManager;
+    std::unique_ptr<Graphics::Render::Engine> mEngine;
+    Graphics::Render::Engine::Configs mConfigs;
+
+    // keeps render service running until the last frame, no window holds it
+    std::shared_ptr<boost::asio::io_context::work> mBenchmarkWork;
+    boost::asio::steady_timer mFrameTimer;
+
+    Graphics::Render::SwapChainContext mSwapChainContext;
+    std::optional<Graphics::Render::RenderCapture> mCapture;
+
+    // decided when the previous frame ends, replayed inputs are applied to measured frames only
+    bool mMeasuring = false;
+    uint32_t mWarmedFrames = 0;
+    uint32_t mMeasuredFrames = 0;
+    std::chrono::steady_clock::time_point mFrameBegin;
+    std::vector<double> mCpuMilliseconds;
+    std::vector<double> mGpuMilliseconds;
+    std::vector<PassSamples> mPassMilliseconds;
+    std::pmr::vector<Graphics::Render::GpuTiming> mGpuTimings;
+    std::array<uint64_t, size_t(Core::Counter::Count)> mCounterSums{};
+};
+
+}
@@ -0,0 +1,71 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "SLuminousBenchmark.h"
+#include <iostream>
+
+using namespace Star;
+
+// Star.Luminous.Benchmark [--graph uuid] [--solution name] [--pipeline name]
+//     [--width n] [--height n] [--warmup n] [--frames n] [--interval ms] [--output file] [--replay file]
+//     [--startup sequential|parallel]
+int main(int argc, char* argv[]) {
+    LuminousBenchmark::Options options;
+    {
+        std::stringstream ss;
+        ss << "823b599a-677e-4bb6-83c4-cd28818f3e82";
+        ss >> options.mRenderGraph;
+    }
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string_view arg = argv[i];
+        const char* value = argv[i + 1];
+        if (arg == "--graph") {
+            std::stringstream ss;
+            ss << value;
+            ss >> options.mRenderGraph;
+        } else if (arg == "--solution") {
+            options.mSolutionName = value;
+        } else if (arg == "--pipeline") {
+            options.mPipelineName = value;
+        } else if (arg == "--width") {
+            options.mWidth = std::stoul(value);
+        } else if (arg == "--height") {
+            options.mHeight = std::stoul(value);
+        } else if (arg == "--warmup") {
+            options.mWarmupFrames = std::stoul(value);
+        } else if (arg == "--frames") {
+            options.mFrames = std::stoul(value);
+        } else if (arg == "--interval") {
+            options.mFrameInterval = std::stoul(value);
+        } else if (arg == "--output") {
+            options.mOutput = value;
+        } else if (arg == "--replay") {
+            options.mReplay = value;
+        } else if (arg == "--startup") {
+            options.mParallelStartup = std::string_view(value) == "parallel";
+        } else {
+            std::cerr << "unknown option: " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    LuminousBenchmark app(GetModuleHandle(nullptr), options);
+    app.run();
+
+    return 0;
+}
@@ -15,10 +15,4 @@
 // You should have received a copy of the GNU Affero General Public License
 // along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
 
-#pragma once
-
-namespace Star::Graphics::Render {
-
-static constexpr uint32_t WM_STAR_RENDER = 0x0400 + 1;
-
-}
+#include "pch.h"
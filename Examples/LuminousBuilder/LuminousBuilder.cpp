@@ -25,6 +25,8 @@
 #include <StarCompiler/ShaderWorks/SStarModules.h>
 #include <StarCompiler/ShaderWorks/SShaderCompiler.h>
 #include <StarCompiler/ShaderWorks/SShaderAssetBuilder.h>
+#include <Star/AssetFactory/SAssetBuildGraph.h>
+#include <Star/AssetFactory/SAssetBuildReport.h>
 #include <Star/Graphics/SRenderSerialization.h>
 #include <Star/Graphics/SRenderGraphSerialization.h>
 #include <Star/Graphics/SContentSerialization.h>
@@ -146,6 +148,8 @@ void buildDeferredSolution(RenderSolutionFactory& renderSolutionFactory) {
                 { "DepthStencil", DepthWrite, ClearDepthStencil() },
             }
         );
+        OCCLUSION_CULLING(Geometry);
+        LIGHT_CULLING(Lighting);
 
         CONNECT(PostProcessing, Output); 
         CONNECT(Lighting, PostProcessing);
@@ -249,6 +253,7 @@ int buildMainShaders(const ShaderModules& modules, ShaderDatabase& db) {
             Pass.mShaderState.mDepthStencilState.mStencilEnable = false;
 
             PixelShader({ "color", half4, SV_Target }) {
+                Group(EvaluateClusteredLights);
                 Group(EvaluateDirectionalLight);
                 Group(InitColor);
                 Group(NdotL);
@@ -264,73 +269,177 @@ int buildMainShaders(const ShaderModules& modules, ShaderDatabase& db) {
     return 0;
 }
 
-int main() {
+// LuminousBuilder [--stress count [source|shared|unique] [depth] [grid]]
+// LuminousBuilder --benchmark [output folder]
+// stress builds scene/stress.content from the sponza meshes and draws it instead of sponza
+// benchmark builds from clean then incrementally, build_clean.json and build_incremental.json are written
+// steps run as build jobs, solutions are compiled while contents are created, job timings are printed at the end
+int main(int argc, char* argv[]) {
+    std::optional<Asset::StressSceneDesc> stress;
+    std::optional<std::filesystem::path> benchmark;
+    if (argc > 1 && std::string_view(argv[1]) == "--benchmark") {
+        benchmark.emplace(argc > 2 ? argv[2] : ".");
+    }
+    const bool watch = argc > 1 && std::string_view(argv[1]) == "--watch";
+    if (argc > 2 && std::string_view(argv[1]) == "--stress") {
+        auto& desc = stress.emplace();
+        desc.mObjectCount = std::stoul(argv[2]);
+        if (argc > 3) {
+            std::string_view materials = argv[3];
+            if (materials == "shared") {
+                desc.mMaterials = Asset::StressMaterials::Shared;
+            } else if (materials == "unique") {
+                desc.mMaterials = Asset::StressMaterials::Unique;
+            }
+        }
+        if (argc > 4) {
+            desc.mHierarchyDepth = std::stoul(argv[4]);
+        }
+        if (argc > 5 && std::string_view(argv[5]) == "grid") {
+            desc.mDistribution = Asset::StressDistribution::Grid;
+        }
+    }
+
     std::cout << "---------------------------------------\n";
     std::cout << "create render graph2\n";
     std::cout << "---------------------------------------\n";
 
     try {
-        Asset::AssetFactory factory("../../../deploy/asset", "../../../deploy/windows2",
-            std::pmr::get_default_resource());
+        // build scratch is large and long lived, pooled on large pages when the account may lock memory
+        LargePageMemoryResource largePages;
+        std::pmr::synchronized_pool_resource buildPool(&largePages);
+        Asset::AssetFactory factory("../../../deploy/asset", "../../../deploy/windows2", &buildPool);
         
         auto& modules = factory.getShaderModules();
         createBasicModules(modules);
 
-        // cleanup meta files
-        factory.cleanup();
+        // the asset factory is edited on this thread, solutions are compiled beside it
+        Asset::BuildGraph jobs;
+        auto onMain = [](std::string name, std::vector<uint32_t> dependencies) {
+            return Asset::BuildJobDesc{ std::move(name), std::move(dependencies), true };
+        };
+
+        auto imported = jobs.add(onMain("import", {}), [&]() {
+            // cleanup meta files
+            factory.cleanup();
 
-        // read asset info
-        factory.scan();
+            // read asset info
+            factory.scan();
 
-        // import assets
-        factory.processAssets();
+            // import assets
+            factory.processAssets();
+        });
 
         // build render graph
         std::string_view renderGraphAsset = "main.1280x720.render";
         std::string_view renderGraphShaderFolder = "main/shaders";
-        factory.try_createRenderGraph(renderGraphAsset, "main", 1280, 720);
-
-        factory.editRenderGraph(renderGraphAsset, renderGraphShaderFolder);
-        { // Forward Solution
-            auto res = factory.try_createRenderSolution(renderGraphAsset, "Forward");
-            Ensures(res.second);
-            buildForwardSolution(res.first);
-
-        }
-        { // Deferred solution
-            auto res = factory.try_createRenderSolution(renderGraphAsset, "Deferred");
-            Ensures(res.second);
-            buildDeferredSolution(res.first);
-        }
-
-        auto& shaders = factory.setupRenderGraph(renderGraphAsset);
-
-        // bind shaders
-        buildMainShaders(modules, shaders);
-
-        // save render graph
-        factory.saveRenderGraph(renderGraphAsset);
+        RenderSolutionFactory* pForward = nullptr;
+        RenderSolutionFactory* pDeferred = nullptr;
+        auto renderGraph = jobs.add(onMain("render graph", { imported }), [&]() {
+            factory.try_createRenderGraph(renderGraphAsset, "main", 1280, 720);
+            factory.editRenderGraph(renderGraphAsset, renderGraphShaderFolder);
+
+            auto forward = factory.try_createRenderSolution(renderGraphAsset, "Forward");
+            Ensures(forward.second);
+            pForward = &forward.first;
+
+            auto deferred = factory.try_createRenderSolution(renderGraphAsset, "Deferred");
+            Ensures(deferred.second);
+            pDeferred = &deferred.first;
+        });
+
+        // solutions only touch their own factory
+        auto forwardSolution = jobs.add({ "forward solution", { renderGraph } }, [&]() {
+            buildForwardSolution(*pForward);
+        });
+        auto deferredSolution = jobs.add({ "deferred solution", { renderGraph } }, [&]() {
+            buildDeferredSolution(*pDeferred);
+        });
+
+        auto shaders = jobs.add(onMain("shaders", { forwardSolution, deferredSolution }), [&]() {
+            auto& db = factory.setupRenderGraph(renderGraphAsset);
+
+            // bind shaders
+            buildMainShaders(modules, db);
+
+            // save render graph
+            factory.saveRenderGraph(renderGraphAsset);
+        });
 
         // build contents
-        factory.try_createContent("scene/sponza.content");
-        factory.clearContent("scene/sponza.content");
-        factory.contentInstantiateFlattenedObjects("scene/sponza.content", "model/scene/sponza_pbr.fbx");
-        factory.saveContent("scene/sponza.content");
+        auto sponza = jobs.add(onMain("sponza content", { imported }), [&]() {
+            factory.try_createContent("scene/sponza.content");
+            factory.clearContent("scene/sponza.content");
+            factory.contentInstantiateFlattenedObjects("scene/sponza.content", "model/scene/sponza_pbr.fbx");
+            factory.saveContent("scene/sponza.content");
+        });
+
+        std::string_view sceneContent = "scene/sponza.content";
+        std::vector<uint32_t> contents = { sponza };
+        if (stress) {
+            sceneContent = "scene/stress.content";
+            contents.emplace_back(jobs.add(onMain("stress content", { imported }), [&]() {
+                factory.try_createContent(sceneContent);
+                factory.clearContent(sceneContent);
+                factory.contentInstantiateStressObjects(sceneContent, "model/scene/sponza_pbr.fbx", *stress);
+                factory.saveContent(sceneContent);
+            }));
+        }
 
-        factory.try_createMaterial("scene/deferred_pipeline.material", "Star/Fullscreen/Deferred Pipeline");
+        contents.emplace_back(jobs.add(onMain("deferred pipeline content", { imported }), [&]() {
+            factory.try_createMaterial("scene/deferred_pipeline.material", "Star/Fullscreen/Deferred Pipeline");
 
-        factory.try_createContent("scene/deferred_pipeline.content");
-        factory.clearContent("scene/deferred_pipeline.content");
-        factory.contentAddFullscreenTriangle("scene/deferred_pipeline.content", "scene/deferred_pipeline.material");
-        factory.saveContent("scene/deferred_pipeline.content");
+            factory.try_createContent("scene/deferred_pipeline.content");
+            factory.clearContent("scene/deferred_pipeline.content");
+            factory.contentAddFullscreenTriangle("scene/deferred_pipeline.content", "scene/deferred_pipeline.material");
+            factory.saveContent("scene/deferred_pipeline.content");
+        }));
 
         // add contents
-        factory.addContent("scene/sponza.content", renderGraphAsset, "Forward", "Diffuse", "Lighting");
-        factory.addContent("scene/sponza.content", renderGraphAsset, "Deferred", "Diffuse", "Geometry");
-        factory.addContent("scene/deferred_pipeline.content", renderGraphAsset, "Deferred", "Diffuse", "Lighting");
-        factory.addContent("scene/deferred_pipeline.content", renderGraphAsset, "Deferred", "Diffuse", "PostProcessing");
-
-        factory.build();
+        contents.emplace_back(shaders);
+        auto queues = jobs.add(onMain("render queues", contents), [&]() {
+            factory.addContent(sceneContent, renderGraphAsset, "Forward", "Diffuse", "Lighting");
+            factory.addContent(sceneContent, renderGraphAsset, "Deferred", "Diffuse", "Geometry");
+            factory.addContent("scene/deferred_pipeline.content", renderGraphAsset, "Deferred", "Diffuse", "Lighting");
+            factory.addContent("scene/deferred_pipeline.content", renderGraphAsset, "Deferred", "Diffuse", "PostProcessing");
+        });
+
+        jobs.add(onMain("build", { queues }), [&]() {
+            if (benchmark) {
+                auto writeReport = [&](std::string_view name) {
+                    const auto& report = factory.getBuildReport();
+                    std::ofstream os(*benchmark / name);
+                    report.writeJson(os);
+                    std::cout << name << ": " << report.totalMilliseconds() << " ms\n";
+                };
+                factory.clearBuildCaches();
+                factory.build();
+                writeReport("build_clean.json");
+                // nothing changed, measures the up-to-date checks
+                factory.build();
+                writeReport("build_incremental.json");
+            } else {
+                factory.build();
+            }
+        });
+
+        jobs.run();
+        jobs.writeSummary(std::cout);
+
+        // changed assets are built again incrementally, only shaders whose data changed are rewritten
+        // and reloaded by running engines, shader graph code changes need the builder to be rebuilt
+        if (watch) {
+            factory.watch();
+            std::cout << "watching assets\n";
+            for (;;) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(500));
+                Asset::AssetChanges changes;
+                if (factory.processChanges(changes)) {
+                    factory.build();
+                    std::cout << "rebuilt in " << factory.getBuildReport().totalMilliseconds() << " ms\n";
+                }
+            }
+        }
     } catch (std::invalid_argument & e) {
         {
             CONSOLE_COLOR(Red);
@@ -17,12 +17,27 @@
 
 #include "SDesktopApp.h"
 #include <Star/Core/SManagerFwd.h>
+#include <Star/Core/SProfiler.h>
+#include <fstream>
 
 namespace Star {
 
 using namespace winrt;
 using namespace winrt::Windows::Foundation;
 
+namespace {
+
+uint32_t getNumJobThreads(const DesktopApp::Desc& desc) noexcept {
+    if (desc.mNumJobThreads)
+        return desc.mNumJobThreads;
+    return std::max(2u, std::thread::hardware_concurrency()) - 1;
+}
+
+// job threads are started by the job system, their policy ends when the thread exits
+thread_local std::optional<ThreadScope> tJobThreadScope;
+
+}
+
 DesktopSystem::DesktopSystem() {
     // detect memory leak
 #ifdef _DEBUG
@@ -36,8 +51,16 @@ DesktopSystem::~DesktopSystem() = default;
 
 DesktopApp::DesktopApp(HINSTANCE hInstance, const Desc& desc)
     : mInstance(hInstance)
+    , mRenderThread(desc.mRenderThread)
+    , mWindowThread(desc.mWindowThread)
+    , mTaskThread(desc.mTaskThread)
     , mTaskStrand(mTaskService)
     , mRenderStrand(mRenderService)
+    , mJobSystem(getNumJobThreads(desc), 4096, [policy = desc.mJobThread](uint32_t i) {
+        auto name = "Job thread " + std::to_string(i);
+        tJobThreadScope.emplace(name.c_str(), policy);
+        Core::Profiler::setThreadName(name);
+    })
     , mTaskThreads(desc.mNumTaskThreads)
     , mRenderWork(std::make_shared<boost::asio::io_context::work>(mRenderService))
     , mRenderWorkObserver(mRenderWork)
@@ -50,7 +73,8 @@ DesktopApp::DesktopApp(HINSTANCE hInstance, const Desc& desc)
     // logging
     {
         updateLogFolder("log");
-        initLogging(boost::log::trivial::debug, ("log/luminous_desktop_" + getDateTimeStr() + ".txt").c_str());
+        initLogging(boost::log::trivial::debug, ("log/luminous_desktop_" + getDateTimeStr() + ".txt").c_str(),
+            LogMode::AsynchronousBlocking);
 
         // start logging
         S_INFO << getDateTimeAscStr();
@@ -66,6 +90,7 @@ DesktopApp::DesktopApp(HINSTANCE hInstance, const Desc& desc)
 
 DesktopApp::~DesktopApp() {
     Core::Workflow::terminate();
+    exitLogging();
 }
 
 bool DesktopApp::try_spawnWindow(uint32_t width, uint32_t height, int nCmdShow,
@@ -96,7 +121,8 @@ bool DesktopApp::try_spawnWindow(uint32_t width, uint32_t height, int nCmdShow,
         renderWork = std::move(renderWork)
         ]()
     {
-        setThreadName(threadName.c_str());
+        ThreadScope scope(threadName.c_str(), mWindowThread);
+        Core::Profiler::setThreadName(threadName);
 
         auto style = WS_OVERLAPPED | WS_CAPTION | WS_MINIMIZEBOX | WS_SYSMENU;
         //auto style = WS_OVERLAPPEDWINDOW;
@@ -142,18 +168,18 @@ bool DesktopApp::try_spawnWindow(uint32_t width, uint32_t height, int nCmdShow,
 
 void DesktopApp::run() {
     // init threads
-    {
-        std::string name;
-        name.reserve(20);
-        for (int i = 0; i != mTaskThreads.size(); ++i) {
-            mTaskThreads[i] = std::thread([this, i]() {
-                mTaskService.run();
-                });
-            name = "Task thread " + std::to_string(i);
-            setThreadName(name.c_str(), mTaskThreads[i]);
-        }
+    for (int i = 0; i != mTaskThreads.size(); ++i) {
+        mTaskThreads[i] = std::thread([this, i]() {
+            auto name = "Task thread " + std::to_string(i);
+            ThreadScope scope(name.c_str(), mTaskThread);
+            Core::Profiler::setThreadName(name);
+            mTaskService.run();
+        });
     }
 
+    ThreadScope renderScope("Render thread", mRenderThread);
+    Core::Profiler::setThreadName("Render thread");
+
     // call derived start
     start();
 
@@ -180,6 +206,12 @@ void DesktopApp::run() {
 
     // stop core workflow
     Core::Workflow::stop();
+
+#ifdef STAR_DEV
+    // open in chrome://tracing
+    std::ofstream trace("log/profile_" + getDateTimeStr() + ".json");
+    Core::Profiler::writeChromeTrace(trace);
+#endif
 }
 
 }
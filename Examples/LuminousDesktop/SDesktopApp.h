@@ -16,6 +16,8 @@
 // along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
 
 #pragma once
+#include <Star/SJobSystem.h>
+#include <Star/SThreadPolicy.h>
 
 namespace Star {
 
@@ -31,8 +33,17 @@ class DesktopApp : DesktopSystem {
 public:
     struct Desc {
         uint32_t mNumTaskThreads = 12;
+        // 0 uses one job thread per hardware thread, except the render thread
+        uint32_t mNumJobThreads = 0;
         uint32_t mMaxTaskCount = 8;
         uint32_t mMaxResourceCount = 2048;
+        // the render thread is the thread calling run
+        ThreadPolicy mRenderThread = { 0, true, 0, "Games", false };
+        // input is written by window threads
+        ThreadPolicy mWindowThread = { 0, false, THREAD_PRIORITY_ABOVE_NORMAL, nullptr, false };
+        // task threads read and decode assets, they must not delay frames
+        ThreadPolicy mTaskThread = { 0, false, 0, nullptr, true };
+        ThreadPolicy mJobThread = {};
     };
     DesktopApp(HINSTANCE hInstance, const Desc& desc);
     DesktopApp(const DesktopApp&) = delete;
@@ -48,6 +59,9 @@ protected:
     virtual void stop() noexcept = 0;
 
     HINSTANCE mInstance = {};
+    ThreadPolicy mRenderThread;
+    ThreadPolicy mWindowThread;
+    ThreadPolicy mTaskThread;
 
     std::vector<std::thread> mTaskThreads;
     Map<std::string, std::thread> mWindowThreads;
@@ -58,6 +72,8 @@ protected:
     boost::asio::io_context::strand mTaskStrand;
     boost::asio::io_context::strand mRenderStrand;
 
+    JobSystem mJobSystem;
+
     std::shared_ptr<boost::asio::io_context::work> mTaskWork;
     std::shared_ptr<boost::asio::io_context::work> mRenderWork;
     std::weak_ptr<boost::asio::io_context::work> mRenderWorkObserver;
@@ -0,0 +1,64 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "SInputSnapshot.h"
+
+namespace Star {
+
+namespace {
+
+uint64_t packDelta(int32_t x, int32_t y) noexcept {
+    return uint64_t(uint32_t(x)) | (uint64_t(uint32_t(y)) << 32);
+}
+
+}
+
+void InputSnapshot::addMouseDelta(int32_t dx, int32_t dy) noexcept {
+    auto prev = mMouseDelta.load(std::memory_order_relaxed);
+    uint64_t next = 0;
+    do {
+        next = packDelta(int32_t(uint32_t(prev)) + dx, int32_t(uint32_t(prev >> 32)) + dy);
+    } while (!mMouseDelta.compare_exchange_weak(prev, next, std::memory_order_relaxed));
+}
+
+void InputSnapshot::setKey(uint8_t key, bool down) noexcept {
+    const uint64_t bit = uint64_t(1) << (key % 64);
+    if (down) {
+        mKeys[key / 64].fetch_or(bit, std::memory_order_relaxed);
+    } else {
+        mKeys[key / 64].fetch_and(~bit, std::memory_order_relaxed);
+    }
+}
+
+void InputSnapshot::clearKeys() noexcept {
+    for (auto& keys : mKeys) {
+        keys.store(0, std::memory_order_relaxed);
+    }
+}
+
+InputSnapshot::Sample InputSnapshot::sample() noexcept {
+    Sample result;
+    const auto delta = mMouseDelta.exchange(0, std::memory_order_relaxed);
+    result.mMouseX = int32_t(uint32_t(delta));
+    result.mMouseY = int32_t(uint32_t(delta >> 32));
+    for (size_t i = 0; i != std::size(mKeys); ++i) {
+        result.mKeys |= std::bitset<256>(mKeys[i].load(std::memory_order_relaxed)) << (64 * i);
+    }
+    return result;
+}
+
+}
@@ -0,0 +1,52 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <atomic>
+#include <bitset>
+
+namespace Star {
+
+// input written by the window thread and sampled by the render thread right before the camera is used
+// lock free, a sample takes the mouse motion accumulated since the previous sample
+class InputSnapshot {
+public:
+    struct Sample {
+        bool down(uint8_t key) const noexcept {
+            return mKeys.test(key);
+        }
+
+        int32_t mMouseX = 0;
+        int32_t mMouseY = 0;
+        // virtual key codes, mouse buttons included
+        std::bitset<256> mKeys;
+    };
+
+    // relative motion in mouse counts, not clipped by the screen
+    void addMouseDelta(int32_t dx, int32_t dy) noexcept;
+    void setKey(uint8_t key, bool down) noexcept;
+    // keys released while the window had no focus are never seen
+    void clearKeys() noexcept;
+
+    Sample sample() noexcept;
+private:
+    // x in the low, y in the high 32 bits
+    std::atomic<uint64_t> mMouseDelta = 0;
+    std::atomic<uint64_t> mKeys[4] = {};
+};
+
+}
@@ -17,7 +17,11 @@
 
 #include "SLuminousApp.h"
 #include <Star/DX12Engine/SDX12Factory.h>
+#include <Star/Core/SStartupTimeline.h>
+#include <Star/Graphics/SCamera.h>
 #include "SLuminousGameWindow.h"
+#include <sstream>
+#include <fstream>
 
 namespace Star {
 
@@ -25,6 +29,11 @@ using namespace Graphics::Render;
 
 namespace {
 LuminousDesktop* sApp = nullptr;
+
+// radians per mouse count, meters per second
+constexpr float sMouseSensitivity = 0.0025f;
+constexpr float sMoveSpeed = 4.0f;
+constexpr float sMaxPitch = 1.5f;
 }
 
 LuminousDesktop& LuminousDesktop::instance() {
@@ -33,7 +42,8 @@ LuminousDesktop& LuminousDesktop::instance() {
 }
 
 LuminousDesktop::LuminousDesktop(HINSTANCE hInstance, int nCmd, const MetaID& renderGraph,
-    std::string_view solutionName, std::string_view pipelineName)
+    std::string_view solutionName, std::string_view pipelineName,
+    const std::filesystem::path& capturePath)
     : DesktopApp(hInstance, DesktopApp::Desc{})
     // buffers
     //, mPerFrameBuffer(4 * 1024 * 1024)
@@ -49,16 +59,25 @@ LuminousDesktop::LuminousDesktop(HINSTANCE hInstance, int nCmd, const MetaID& re
     //, mPerInstance(mPerInstanceBuffer.data(), mPerInstanceBuffer.size(), std::pmr::null_memory_resource())
     // pool
     //, mPool(&mPoolMonotonic)
+    , mContentPool(&mLargePages)
+    // memory accounting
+    , mTrackedRoot("Luminous", std::pmr::get_default_resource())
+    , mTrackedEnginePool("Engine/Pool", &mPool, &mTrackedRoot)
+    , mTrackedEngineMonotonic("Engine/Monotonic", &mMonotonic, &mTrackedRoot)
+    , mTrackedAssets("Assets", &mContentPool, &mTrackedRoot)
     , mAssetManager(std::make_unique<Asset::AssetFactory>(
         R"(asset)", R"(windows2)",
-        std::pmr::get_default_resource()))
+        &mTrackedAssets))
+    , mCapturePath(capturePath)
     , mCmd(nCmd)
 {
     Engine::Configs configs{};
     configs.mNumSwapChains = 1;
     configs.mFrameQueueSize = 3;
-    configs.mShaderDescriptorCapacity = 8192;
-    configs.mShaderDescriptorCircularReserve = 2048;
+    configs.mNumRecordingThreads = 4;
+    configs.mPipelineCaching = true;
+    configs.mRenderPasses = true;
+    configs.mResizeSettleTime = 100;
 
     configs.mRenderGraph = renderGraph;
     configs.mSolutionName = solutionName;
@@ -67,18 +86,28 @@ LuminousDesktop::LuminousDesktop(HINSTANCE hInstance, int nCmd, const MetaID& re
     Engine::Context context{
         &mRenderService, &mTaskService,
         &mRenderStrand, &mTaskStrand,
+        &mJobSystem,
     };
 
     EngineMemory memory{
-        &mPool,
-        &mMonotonic,
+        &mTrackedEnginePool,
+        &mTrackedEngineMonotonic,
         &mPerFrame,
         &mPerPass,
         &mPerBatch,
         &mPerInstance
     };
 
-    mEngine = Star::Graphics::Render::createDX12Engine(memory, context, configs);
+    {
+        STAR_STARTUP_SCOPE("engine creation");
+        mEngine = Star::Graphics::Render::createDX12Engine(memory, context, configs);
+    }
+    if (!mCapturePath.empty()) {
+        // game window is the first window
+        auto capture = std::make_unique<CaptureEngine>(std::move(mEngine), configs, 0);
+        mCapture = capture.get();
+        mEngine = std::move(capture);
+    }
 
     Expects(!sApp);
     sApp = this;
@@ -106,28 +135,121 @@ void LuminousDesktop::stopWindow(std::string_view name) {
     mEngine->stopSwapChain(id);
 }
 
-void LuminousDesktop::renderWindow(std::string_view name) {
-    auto id = at(mWindows, name);
-    mEngine->renderSwapChain(id);
-}
-
 void LuminousDesktop::start() {
     mAssetManager->scan();
     mAssetManager->registerProducers();
+    mAssetManager->watch();
+
+    {
+        STAR_STARTUP_SCOPE("engine start");
+        mEngine->start();
+    }
 
-    mEngine->start();
+    std::ostringstream oss;
+    Core::StartupTimeline::writeReport(oss);
+    OutputDebugStringA(oss.str().c_str());
 
     uint32_t id = gsl::narrow_cast<uint32_t>(mWindows.size());
     auto res = mWindows.emplace("GameWindow", id);
     Ensures(res.second);
 
+    mLastSample = std::chrono::steady_clock::now();
+    mLastAssetPoll = mLastSample;
+    mEngine->setFrameCallback([this, id](uint32_t swapChainID, CameraData& camera) {
+        if (swapChainID != id)
+            return false;
+        reloadChangedAssets();
+        return updateCamera(camera);
+    });
+
     try_spawnWindow(1280, 720, mCmd, LuminousGameWindow::class_name(),
         L"Star.Luminous.GameWindow", "GameWindow",
         new LuminousGameWindow::Desc{ "GameWindow" });
 }
 
+void LuminousDesktop::reloadChangedAssets() {
+    const auto now = std::chrono::steady_clock::now();
+    if (now - mLastAssetPoll < sAssetPollInterval)
+        return;
+    mLastAssetPoll = now;
+
+    Asset::AssetChanges changes;
+    mAssetManager->processChanges(changes);
+    if (!changes.mTextures.empty()) {
+        mEngine->reloadTextures(changes.mTextures);
+    }
+    if (!changes.mShaders.empty()) {
+        mEngine->reloadShaders(changes.mShaders);
+    }
+}
+
+bool LuminousDesktop::updateCamera(CameraData& camera) {
+    const auto now = std::chrono::steady_clock::now();
+    // long stalls, e.g. a breakpoint, do not teleport the camera
+    const float dt = std::min(std::chrono::duration<float>(now - mLastSample).count(), 0.1f);
+    mLastSample = now;
+
+    const auto input = mInput.sample();
+    const bool drag = input.down(VK_LBUTTON) && (input.mMouseX || input.mMouseY);
+    Vector3f move = Vector3f::Zero();
+    if (input.down('W')) move.y() += 1;
+    if (input.down('S')) move.y() -= 1;
+    if (input.down('D')) move.x() += 1;
+    if (input.down('A')) move.x() -= 1;
+    if (input.down('E')) move.z() += 1;
+    if (input.down('Q')) move.z() -= 1;
+    if (!drag && move.isZero())
+        return false;
+
+    // view is orthonormal in every view space, eye = -R^t * t
+    const Matrix3f rotation = camera.mView.topLeftCorner<3, 3>();
+    Vector3f eye = -(rotation.transpose() * camera.mView.topRightCorner<3, 1>());
+
+    // X-right, Y-forward, Z-up
+    float yaw = std::atan2(camera.mForward.x(), camera.mForward.y());
+    float pitch = std::asin(std::clamp(camera.mForward.z(), -1.0f, 1.0f));
+    if (drag) {
+        yaw += sMouseSensitivity * input.mMouseX;
+        pitch = std::clamp(pitch - sMouseSensitivity * input.mMouseY, -sMaxPitch, sMaxPitch);
+    }
+    const Vector3f forward(std::sin(yaw) * std::cos(pitch), std::cos(yaw) * std::cos(pitch), std::sin(pitch));
+    const Vector3f right(std::cos(yaw), -std::sin(yaw), 0);
+    const Vector3f up(0, 0, 1);
+    eye += sMoveSpeed * dt * (move.x() * right + move.y() * forward + move.z() * up);
+
+    Camera cam;
+    static_cast<CameraData&>(cam) = camera;
+    cam.lookTo(eye, forward, up);
+    cam.mPosition = eye.cast<double>();
+    cam.mYaw = yaw;
+    cam.mPitch = pitch;
+    camera = cam;
+    return true;
+}
+
 void LuminousDesktop::stop() noexcept {
     mEngine->stop();
+
+    if (mCapture) {
+        std::ofstream ofs(mCapturePath, std::ios::binary);
+        mCapture->save(ofs);
+    }
+
+    // peaks of the frame arenas, to size their buffers
+    char buffer[256];
+    snprintf(buffer, sizeof(buffer),
+        "frame arenas high water: frame %zu, pass %zu, batch %zu, instance %zu bytes\n",
+        mPerFrame.highWaterMark(), mPerPass.highWaterMark(),
+        mPerBatch.highWaterMark(), mPerInstance.highWaterMark());
+    OutputDebugStringA(buffer);
+    snprintf(buffer, sizeof(buffer),
+        "content pages: %zu large page allocations, %zu normal page allocations, large page %zu bytes\n",
+        mLargePages.largePageAllocations(), mLargePages.fallbackAllocations(), mLargePages.largePageSize());
+    OutputDebugStringA(buffer);
+
+    std::ostringstream oss;
+    mTrackedRoot.writeReport(oss);
+    OutputDebugStringA(oss.str().c_str());
 }
 
 }
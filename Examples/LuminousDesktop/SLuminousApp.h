@@ -17,8 +17,12 @@
 
 #pragma once
 #include "SDesktopApp.h"
+#include "SInputSnapshot.h"
 #include <Star/Graphics/SRenderEngine.h>
 #include <Star/AssetFactory/SAssetFactory.h>
+#include <Star/Graphics/SRenderCapture.h>
+#include <filesystem>
+#include <chrono>
 
 namespace Star {
 
@@ -26,18 +30,29 @@ class LuminousDesktop : public DesktopApp {
 public:
     static LuminousDesktop& instance();
 
+    // inputs of the game window are recorded to capturePath if set, for Star.Luminous.Benchmark --replay
     LuminousDesktop(HINSTANCE hInstance, int nCmd, const MetaID& renderGraph,
-        std::string_view solutionName, std::string_view pipelineName);
+        std::string_view solutionName, std::string_view pipelineName,
+        const std::filesystem::path& capturePath = {});
     ~LuminousDesktop();
 
     void resizeWindow(const Graphics::Render::SwapChainContext& context);
     void startWindow(std::string_view name, HWND hWnd);
     void stopWindow(std::string_view name);
-    void renderWindow(std::string_view name);
+
+    InputSnapshot& input() noexcept {
+        return mInput;
+    }
 private:
     void start() override;
     void stop() noexcept override;
 
+    // render thread, the game window flies the camera with left drag and WASD, E and Q
+    bool updateCamera(Graphics::Render::CameraData& camera);
+    // render thread, textures changed on disk are rebuilt and shaders rewritten by the builder are read again,
+    // both are swapped in by the engine
+    void reloadChangedAssets();
+
     std::vector<std::byte> mPerFrameBuffer;
     std::vector<std::byte> mPerPassBuffer;
     std::vector<std::byte> mPerBatchBuffer;
@@ -45,18 +60,36 @@ private:
 
     std::pmr::monotonic_buffer_resource mPoolMonotonic;
     std::pmr::monotonic_buffer_resource mMonotonic;
-    std::pmr::monotonic_buffer_resource mPerFrame;
-    std::pmr::monotonic_buffer_resource mPerPass;
-    std::pmr::monotonic_buffer_resource mPerBatch;
-    std::pmr::monotonic_buffer_resource mPerInstance;
+    FrameArena mPerFrame;
+    FrameArena mPerPass;
+    FrameArena mPerBatch;
+    FrameArena mPerInstance;
 
     std::pmr::synchronized_pool_resource mPool;
 
+    // contents are large and long lived, pooled on large pages when the account may lock memory
+    LargePageMemoryResource mLargePages;
+    std::pmr::synchronized_pool_resource mContentPool;
+
+    // working set of each subsystem, written to the debugger on stop
+    TrackingMemoryResource mTrackedRoot;
+    TrackingMemoryResource mTrackedEnginePool;
+    TrackingMemoryResource mTrackedEngineMonotonic;
+    TrackingMemoryResource mTrackedAssets;
+
     std::unique_ptr<Asset::AssetFactory> mAssetManager;
     std::unique_ptr<Graphics::Render::Engine> mEngine;
+    // owned by mEngine, null if not recording
+    Graphics::Render::CaptureEngine* mCapture = nullptr;
+    std::filesystem::path mCapturePath;
 
     int mCmd = 0;
     Map<std::string, uint32_t> mWindows;
+
+    InputSnapshot mInput;
+    std::chrono::steady_clock::time_point mLastSample;
+    static constexpr std::chrono::milliseconds sAssetPollInterval{ 250 };
+    std::chrono::steady_clock::time_point mLastAssetPoll;
 };
 
 }
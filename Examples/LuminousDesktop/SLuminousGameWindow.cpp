@@ -17,7 +17,6 @@
 
 #include "SLuminousGameWindow.h"
 #include "SLuminousApp.h"
-#include <Star/Graphics/SWindowMessages.h>
 
 namespace Star {
 
@@ -56,9 +55,8 @@ LuminousGameWindow::LuminousGameWindow(HWND w, LPCREATESTRUCT, Desc* pDesc)
 
     OnPaint();
     OnResize();
-    OnPresent();
-    OnKeyDown();
-    OnMovesWhileLButtonDown();
+    OnKeys();
+    OnMouseInput();
     OnDoubleClick();
 
     LuminousDesktop::instance().startWindow(mName, w);
@@ -80,66 +78,76 @@ void LuminousGameWindow::OnPaint() {
         });
 }
 
+// sizes are coalesced by the engine, a burst of WM_SIZE costs one resize on the render thread
 void LuminousGameWindow::OnResize() {
-    auto ob = messages<WM_SIZE, int64_t>() |
-        map([this](auto m) {
-            m.handled();
-            return m;
-        }) |
-        debounce(std::chrono::milliseconds(10), observe_on_new_thread());
-
-    ob.subscribe([this](auto m) {
-        mContext.mWidth = LOWORD(m.lParam);
-        mContext.mHeight = HIWORD(m.lParam);
-        if (mContext.mWidth && mContext.mHeight) {
-            LuminousDesktop::instance().resizeWindow(mContext);
-        }
-        S_INFO << "debounced resize: " << "w: " << mContext.mWidth << ", h: " << mContext.mHeight;
-    });
-}
-
-void LuminousGameWindow::OnPresent() {
-    messages<Graphics::Render::WM_STAR_RENDER>(). 
+    messages<WM_SIZE, int64_t>().
         subscribe([this](auto m) {
-            m.handled(); // skip DefWindowProc
-            LuminousDesktop::instance().renderWindow(mName);
+            m.handled();
+            mContext.mWidth = LOWORD(m.lParam);
+            mContext.mHeight = HIWORD(m.lParam);
+            if (mContext.mWidth && mContext.mHeight) {
+                LuminousDesktop::instance().resizeWindow(mContext);
+            }
         });
 }
 
-void LuminousGameWindow::OnKeyDown() {
+// keys are written to the input snapshot, the render thread samples them before each frame
+void LuminousGameWindow::OnKeys() {
+    auto& input = LuminousDesktop::instance().input();
+
     messages<WM_KEYDOWN>().
-        subscribe([this](auto m) {
+        subscribe([&input](auto m) {
             m.handled();
+            input.setKey(gsl::narrow_cast<uint8_t>(m.wParam), true);
+        });
 
-            //MessageBox(window, L"KeyDown", L"LuminousGameWindow", MB_OK);
-            // NOTE: MessageBox pumps messages, but this subscription only
-            // receives messages if it is suspended by 'for await', so any
-            // WM_KEYDOWN arriving while the message box is up is not delivered.
-            // the other subscriptions will receive messages.
+    messages<WM_KEYUP>().
+        subscribe([&input](auto m) {
+            m.handled();
+            input.setKey(gsl::narrow_cast<uint8_t>(m.wParam), false);
+        });
+
+    messages<WM_KILLFOCUS>().
+        subscribe([&input](auto) {
+            input.clearKeys();
         });
 }
 
-void LuminousGameWindow::OnMovesWhileLButtonDown() {
-    auto moves_while_lbutton_down = messages<WM_LBUTTONDOWN>().
-        map([this](auto m) {
-            m.handled();
-            return this->messages<WM_MOUSEMOVE>().
-                take_until(this->messages<WM_LBUTTONUP>());
-        }).
-        merge();
+// raw input has no pointer acceleration and keeps counting at the screen edge
+void LuminousGameWindow::OnMouseInput() {
+    auto& input = LuminousDesktop::instance().input();
+
+    RAWINPUTDEVICE mouse{ 0x01, 0x02, 0, mWindow }; // generic desktop, mouse
+    if (!RegisterRawInputDevices(&mouse, 1, sizeof(mouse))) {
+        S_WARNING << "raw mouse input not available: " << GetLastError();
+    }
+
+    // DefWindowProc releases the input buffer, not handled
+    messages<WM_INPUT>().
+        subscribe([&input](auto m) {
+            RAWINPUT raw{};
+            UINT size = sizeof(raw);
+            if (GetRawInputData(reinterpret_cast<HRAWINPUT>(m.lParam), RID_INPUT,
+                &raw, &size, sizeof(RAWINPUTHEADER)) == UINT(-1))
+                return;
+            if (raw.header.dwType == RIM_TYPEMOUSE && !(raw.data.mouse.usFlags & MOUSE_MOVE_ABSOLUTE)) {
+                input.addMouseDelta(raw.data.mouse.lLastX, raw.data.mouse.lLastY);
+            }
+        });
 
-    moves_while_lbutton_down.
-        subscribe([this](auto m) {
-            Expects(m.message == WM_MOUSEMOVE);
-            m.handled();            
-            //position = MAKEPOINTS(m.lParam);
+    // captured, the button is released even outside the window
+    messages<WM_LBUTTONDOWN>().
+        subscribe([this, &input](auto m) {
+            m.handled();
+            SetCapture(mWindow);
+            input.setKey(VK_LBUTTON, true);
         });
 
-    moves_while_lbutton_down.
-        debounce(std::chrono::milliseconds(100), observe_on_new_thread()).
-        subscribe([this](auto m) {
-            std::ignore = m;
-            S_INFO << "drag";
+    messages<WM_LBUTTONUP>().
+        subscribe([&input](auto m) {
+            m.handled();
+            ReleaseCapture();
+            input.setKey(VK_LBUTTON, false);
         });
 }
 
@@ -41,9 +41,8 @@ public:
 private:
     void OnPaint();
     void OnResize();
-    void OnPresent();
-    void OnKeyDown();
-    void OnMovesWhileLButtonDown();
+    void OnKeys();
+    void OnMouseInput();
     void OnDoubleClick();
 
 private:
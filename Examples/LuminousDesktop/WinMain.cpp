@@ -19,13 +19,21 @@
 
 using namespace Star;
 
-int __stdcall wWinMain(HINSTANCE hInstance, HINSTANCE, LPWSTR, int nCmd) {
+// Star.Luminous.Desktop [--capture file]
+int __stdcall wWinMain(HINSTANCE hInstance, HINSTANCE, LPWSTR lpCmdLine, int nCmd) {
     MetaID renderGraphID;
     std::stringstream ss;
     ss << "823b599a-677e-4bb6-83c4-cd28818f3e82";
     ss >> renderGraphID;
 
-    LuminousDesktop app(hInstance, nCmd, renderGraphID, "Deferred", "Diffuse");
+    std::filesystem::path capturePath;
+    std::wstring_view cmdLine(lpCmdLine);
+    constexpr std::wstring_view captureOption = L"--capture ";
+    if (cmdLine.substr(0, captureOption.size()) == captureOption) {
+        capturePath = cmdLine.substr(captureOption.size());
+    }
+
+    LuminousDesktop app(hInstance, nCmd, renderGraphID, "Deferred", "Diffuse", capturePath);
     app.run();
 
     return 0;
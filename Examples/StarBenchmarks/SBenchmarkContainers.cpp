@@ -0,0 +1,173 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <Star/SMetaID.h>
+#include <Star/SMultiIndex.h>
+#include <Star/SFlatHashMap.h>
+#include <Star/SFlatMap.h>
+#include <Star/SMap.h>
+#include <Star/SLockFree.h>
+#include <Star/SAlignedBuffer.h>
+
+using namespace Star;
+
+namespace {
+
+struct MetaIDItem {
+    const MetaID& metaID() const noexcept {
+        return mMetaID;
+    }
+    MetaID mMetaID;
+    uint32_t mValue = 0;
+};
+
+std::vector<MetaID> makeMetaIDs(size_t count) {
+    boost::uuids::random_generator gen;
+    std::vector<MetaID> ids(count);
+    for (auto& id : ids) {
+        id = gen();
+    }
+    return ids;
+}
+
+// names like the passes and queues of a render graph
+std::vector<std::string> makeNames(size_t count) {
+    std::vector<std::string> names(count);
+    for (size_t i = 0; i != count; ++i) {
+        names[i] = "Star/Pass" + std::to_string(i * 7919 % count);
+    }
+    return names;
+}
+
+void MetaIDHashMapFind(benchmark::State& state) {
+    const auto ids = makeMetaIDs(state.range(0));
+    MetaIDHashMap<MetaIDItem> map;
+    for (const auto& id : ids) {
+        map.emplace(MetaIDItem{ id, 1 });
+    }
+    size_t i = 0;
+    for (auto _ : state) {
+        auto iter = map.find(ids[i]);
+        benchmark::DoNotOptimize(iter);
+        i = (i + 1) % ids.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(MetaIDHashMapFind)->Range(64, 64 * 1024);
+
+// the replacement of MetaIDHashMap, same keys and hash
+void FlatHashMapFind(benchmark::State& state) {
+    const auto ids = makeMetaIDs(state.range(0));
+    FlatHashMap<MetaID, uint32_t, MetaIDHash, MetaIDEqual> map;
+    for (const auto& id : ids) {
+        map.try_emplace(id, 1u);
+    }
+    size_t i = 0;
+    for (auto _ : state) {
+        auto iter = map.find(ids[i]);
+        benchmark::DoNotOptimize(iter);
+        i = (i + 1) % ids.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(FlatHashMapFind)->Range(64, 64 * 1024);
+
+void PmrFlatMapStringFind(benchmark::State& state) {
+    const auto names = makeNames(state.range(0));
+    PmrFlatMap<std::pmr::string, uint32_t> map(std::pmr::get_default_resource());
+    for (const auto& name : names) {
+        map.emplace(name, 1u);
+    }
+    size_t i = 0;
+    for (auto _ : state) {
+        auto iter = map.find(std::string_view(names[i]));
+        benchmark::DoNotOptimize(iter);
+        i = (i + 1) % names.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(PmrFlatMapStringFind)->Range(8, 4096);
+
+void MapStringFind(benchmark::State& state) {
+    const auto names = makeNames(state.range(0));
+    Map<std::string, uint32_t> map;
+    for (const auto& name : names) {
+        map.emplace(name, 1u);
+    }
+    size_t i = 0;
+    for (auto _ : state) {
+        auto iter = map.find(std::string_view(names[i]));
+        benchmark::DoNotOptimize(iter);
+        i = (i + 1) % names.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(MapStringFind)->Range(8, 4096);
+
+void MessageQueuePushPop(benchmark::State& state) {
+    static MessageQueue<uint64_t> sQueue(1024);
+    uint64_t value = 0;
+    for (auto _ : state) {
+        sQueue.push(value);
+        bool popped = sQueue.pop(value);
+        benchmark::DoNotOptimize(popped);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(MessageQueuePushPop)->ThreadRange(1, 8)->UseRealTime();
+
+// recording threads push and pop in bursts of a frame
+void MessageQueueBurst(benchmark::State& state) {
+    MessageQueue<uint64_t> queue(state.range(0));
+    for (auto _ : state) {
+        for (int64_t i = 0; i != state.range(0); ++i) {
+            queue.bounded_push(uint64_t(i));
+        }
+        uint64_t value = 0;
+        while (queue.pop(value)) {
+            benchmark::DoNotOptimize(value);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(MessageQueueBurst)->Range(16, 1024);
+
+void AlignedBufferResize(benchmark::State& state) {
+    AlignedBuffer16 buffer(std::pmr::get_default_resource());
+    const auto size = static_cast<size_t>(state.range(0));
+    for (auto _ : state) {
+        buffer.resize_aligned(size);
+        benchmark::DoNotOptimize(buffer.data());
+        buffer.clear();
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(AlignedBufferResize)->Range(256, 1 << 20);
+
+void AlignedBufferResizeUninitialized(benchmark::State& state) {
+    AlignedBuffer16 buffer(std::pmr::get_default_resource());
+    const auto size = static_cast<size_t>(state.range(0));
+    for (auto _ : state) {
+        buffer.resize_aligned_uninitialized(size);
+        benchmark::DoNotOptimize(buffer.data());
+        buffer.clear();
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(AlignedBufferResizeUninitialized)->Range(256, 1 << 20);
+
+}
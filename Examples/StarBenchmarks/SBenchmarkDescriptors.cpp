@@ -0,0 +1,80 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <Star/Graphics/SDescriptorPools.h>
+
+using namespace Star;
+using namespace Star::Graphics;
+
+namespace {
+
+// sizes of the engine shader descriptor heap
+constexpr uint32_t sBlockSize = 64;
+constexpr uint32_t sCapacity = 8192;
+constexpr uint32_t sFrameQueueSize = 3;
+
+// shared by threads, recording threads allocate from the same pool
+void DescriptorPoolAllocateRange(benchmark::State& state) {
+    static DescriptorPool pool(sBlockSize, sCapacity, std::pmr::get_default_resource());
+    for (auto _ : state) {
+        auto block = pool.allocateRange();
+        benchmark::DoNotOptimize(block.begin());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(DescriptorPoolAllocateRange)->ThreadRange(1, 8)->UseRealTime();
+
+// allocations of a frame, advanced every range(0) allocations
+void CircularDescriptorPoolAllocate(benchmark::State& state) {
+    DescriptorPool pool(sBlockSize, sCapacity, std::pmr::get_default_resource());
+    CircularDescriptorPool circular(sCapacity / 2, sCapacity / 4, &pool, sFrameQueueSize,
+        sBlockSize, std::pmr::get_default_resource());
+    int64_t count = 0;
+    for (auto _ : state) {
+        auto range = circular.allocate(8);
+        benchmark::DoNotOptimize(range);
+        if (++count == state.range(0)) {
+            circular.advanceFrame();
+            count = 0;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(CircularDescriptorPoolAllocate)->Arg(64)->Arg(128);
+
+// vectors of range(0) descriptors, freed after the deallocation latency of the frame queue
+void PersistentDescriptorPoolAllocateFree(benchmark::State& state) {
+    DescriptorPool pool(sBlockSize, sCapacity, std::pmr::get_default_resource());
+    PersistentDescriptorPool persistent(sCapacity / 2, &pool, sFrameQueueSize);
+    const auto count = static_cast<uint32_t>(state.range(0));
+    std::vector<std::pair<uint32_t, uint32_t>> frame;
+    frame.reserve(64);
+    for (auto _ : state) {
+        frame.emplace_back(persistent.allocate(count));
+        if (frame.size() == frame.capacity()) {
+            for (const auto& range : frame) {
+                persistent.deallocate(range.first, count);
+            }
+            frame.clear();
+            persistent.advanceFrame();
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(PersistentDescriptorPoolAllocateFree)->Arg(1)->Arg(4)->Arg(8);
+
+}
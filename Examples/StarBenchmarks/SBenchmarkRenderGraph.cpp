@@ -0,0 +1,132 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "pch.h"
+#include <StarCompiler/RenderGraph/SRenderGraph.h>
+#include <StarCompiler/RenderGraph/SRenderGraphDSL.h>
+
+using namespace Star;
+using namespace Star::Graphics;
+using namespace Star::Graphics::Render;
+
+namespace {
+
+using Inputs = ResourceDataViewMap<RenderValue>;
+using Outputs = ResourceDataViewMap<RenderValue>;
+
+// the compiler reports every step to std::cout, it is silenced while timing
+class SilentConsole {
+public:
+    SilentConsole()
+        : mBuffer(std::cout.rdbuf(mNull.rdbuf()))
+    {}
+    ~SilentConsole() {
+        std::cout.rdbuf(mBuffer);
+    }
+private:
+    std::ostringstream mNull;
+    std::streambuf* mBuffer = nullptr;
+};
+
+// geometry, a chain of count screen passes each reading the previous target, present
+GraphicsRenderNodeGraph createSyntheticGraph(uint32_t count) {
+    GraphicsRenderNodeGraph graph{ "Synthetic", RenderConfigs{} };
+    graph.mRenderTargets = {
+        rt("Color", Format::S_R8G8B8A8_SRGB, Width{ 1280 }, Height{ 720 }, Device, BackBuffer),
+        ds("DepthStencil", Format::S_D24_UNORM_S8_UINT, Width{ 1280 }, Height{ 720 }),
+    };
+    for (uint32_t i = 0; i != count; ++i) {
+        graph.mRenderTargets.emplace(rt("Target" + std::to_string(i),
+            Format::S_R16G16B16A16_SFLOAT, Width{ 1280 }, Height{ 720 }));
+    }
+
+    auto output = graph.createNode(RenderNode{ "Output",
+        Outputs{
+            { "Color", Present },
+        }
+    });
+    auto prev = graph.createNode(RenderNode{ "Geometry",
+        Outputs{
+            { "Target0", RenderTarget, ClearColor{} },
+            { "DepthStencil", DepthWrite, ClearDepthStencil{} },
+        }
+    });
+    for (uint32_t i = 1; i != count; ++i) {
+        auto node = graph.createNode(RenderNode{ "Pass" + std::to_string(i),
+            Outputs{
+                { "Target" + std::to_string(i), RenderTarget, DontRead },
+            },
+            Inputs{
+                { "Target" + std::to_string(i - 1), ShaderResource },
+                { "DepthStencil", DepthRead },
+            }
+        });
+        graph.connectNode(prev, node);
+        prev = node;
+    }
+    auto resolve = graph.createNode(RenderNode{ "Resolve",
+        Outputs{
+            { "Color", RenderTarget, DontRead },
+        },
+        Inputs{
+            { "Target" + std::to_string(count - 1), ShaderResource },
+        }
+    });
+    graph.connectNode(prev, resolve);
+    graph.connectNode(resolve, output);
+    return graph;
+}
+
+void compileGraph(GraphicsRenderNodeGraph& graph) {
+    if (graph.compile()) {
+        throw std::runtime_error("synthetic render graph compile failed");
+    }
+    graph.buildRenderStatePaths2();
+    graph.buildResourceViews();
+}
+
+// full compile, as done for every pipeline of a solution when anything changes
+void RenderGraphCompile(benchmark::State& state) {
+    SilentConsole silent;
+    const auto count = gsl::narrow<uint32_t>(state.range(0));
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto graph = createSyntheticGraph(count);
+        state.ResumeTiming();
+        compileGraph(graph);
+        benchmark::DoNotOptimize(graph.mViewStates.size());
+    }
+    state.SetComplexityN(state.range(0));
+}
+BENCHMARK(RenderGraphCompile)->RangeMultiplier(4)->Range(16, 256)->Complexity();
+
+// one pass in the middle of the chain edited, only its targets are rebuilt
+void RenderGraphUpdateNodeStates(benchmark::State& state) {
+    SilentConsole silent;
+    const auto count = gsl::narrow<uint32_t>(state.range(0));
+    auto graph = createSyntheticGraph(count);
+    compileGraph(graph);
+    const auto nodeID = graph.mNodeIndex.at("Pass" + std::to_string(count / 2));
+    for (auto _ : state) {
+        graph.updateNodeStates(nodeID);
+        benchmark::DoNotOptimize(graph.mViewStates.size());
+    }
+    state.SetComplexityN(state.range(0));
+}
+BENCHMARK(RenderGraphUpdateNodeStates)->RangeMultiplier(4)->Range(16, 256)->Complexity();
+
+}
@@ -0,0 +1,73 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <Star/DX12Engine/SDX12UploadBuffer.h>
+
+using namespace Star;
+using namespace Star::Graphics::Render;
+
+namespace {
+
+// software adapter, upload heaps are cpu memory so the numbers match hardware adapters
+ID3D12Device* getWarpDevice() {
+    static com_ptr<ID3D12Device> sDevice = []() {
+        com_ptr<IDXGIFactory4> factory;
+        V(CreateDXGIFactory1(IID_PPV_ARGS(factory.put())));
+        com_ptr<IDXGIAdapter> adapter;
+        V(factory->EnumWarpAdapter(IID_PPV_ARGS(adapter.put())));
+        com_ptr<ID3D12Device> device;
+        V(D3D12CreateDevice(adapter.get(), D3D_FEATURE_LEVEL_11_0, IID_PPV_ARGS(device.put())));
+        return device;
+    }();
+    return sDevice.get();
+}
+
+void UploadBufferBlockTrySuballocate(benchmark::State& state) {
+    DX12UploadBufferBlock block(getWarpDevice(), 4 * 1024 * 1024, 0);
+    const auto size = static_cast<size_t>(state.range(0));
+    int64_t frameID = 0;
+    for (auto _ : state) {
+        auto res = block.try_suballocate(size, 256, frameID);
+        if (!res.second) {
+            block.clear();
+            ++frameID;
+        }
+        benchmark::DoNotOptimize(res);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(UploadBufferBlockTrySuballocate)->Arg(64)->Arg(256)->Arg(4096);
+
+// frames of range(0) constant buffers, blocks are recycled through the pool
+void UploadBufferSuballocate(benchmark::State& state) {
+    DX12UploadBufferPool pool(getWarpDevice(), 4 * 1024 * 1024, 64);
+    DX12UploadBuffer upload(pool, 3, 0);
+    int64_t count = 0;
+    for (auto _ : state) {
+        auto res = upload.suballocate(256);
+        benchmark::DoNotOptimize(res.second);
+        if (++count == state.range(0)) {
+            upload.advanceFrame();
+            pool.trim();
+            count = 0;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(UploadBufferSuballocate)->Arg(1024)->Arg(16 * 1024);
+
+}
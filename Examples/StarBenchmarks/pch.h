@@ -0,0 +1,40 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <Star/PrecompiledHeaders/SCore.h>
+#include <Star/PrecompiledHeaders/SCoreRuntime.h>
+#include <StarCompiler/PrecompiledHeaders/SCoreCompiler.h>
+
+#include <StarCompiler/RenderGraph/SRenderGraphContainer.h>
+
+#include <boost/uuid/random_generator.hpp>
+
+// msvc, upload buffers are created on a warp device without gpu
+#include <dxgi1_6.h>
+#include <d3d12.h>
+#include <3rdparty/d3dx12.h>
+#pragma comment(lib, "d3d12.lib")
+#pragma comment(lib, "dxgi.lib")
+
+// Star
+#include <Star/SWinRT.h>
+#include <Star/SLocale.h>
+#include <Star/DX12Engine/SDX12Helpers.h>
+
+#include <benchmark/benchmark.h>
@@ -0,0 +1,123 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "pch.h"
+#include "SPerfRuns.h"
+
+namespace Star::Perf {
+
+using boost::property_tree::ptree;
+
+namespace {
+
+Metric& metric(Run& run, std::string name, MetricKind kind, std::string_view unit = "ms") {
+    auto& m = run.mMetrics[std::move(name)];
+    m.mKind = kind;
+    m.mUnit = unit;
+    return m;
+}
+
+// runner statistics, older outputs without values are compared by their median only
+void addStatistics(Metric& m, const ptree& stats) {
+    if (auto values = stats.get_child_optional("values")) {
+        for (const auto& v : *values) {
+            m.mSamples.emplace_back(v.second.get_value<double>());
+        }
+    } else {
+        m.mSamples.emplace_back(stats.get<double>("p50"));
+    }
+}
+
+void loadFrames(const ptree& tree, Run& run) {
+    addStatistics(metric(run, "frame cpu", MetricKind::Cpu), tree.get_child("cpu"));
+    addStatistics(metric(run, "frame gpu", MetricKind::Gpu), tree.get_child("gpu"));
+    if (auto passes = tree.get_child_optional("passes")) {
+        for (const auto& pass : *passes) {
+            addStatistics(metric(run, "pass " + pass.second.get<std::string>("name"), MetricKind::Gpu),
+                pass.second.get_child("gpu"));
+        }
+    }
+    // one sample per run, phases of a name are summed
+    if (auto startup = tree.get_child_optional("startup")) {
+        metric(run, "startup", MetricKind::Cpu).mSamples.emplace_back(startup->get<double>("milliseconds"));
+        std::map<std::string, double> phases;
+        for (const auto& phase : startup->get_child("phases")) {
+            phases[phase.second.get<std::string>("name")] +=
+                phase.second.get<double>("end") - phase.second.get<double>("begin");
+        }
+        for (const auto& [name, ms] : phases) {
+            metric(run, "startup " + name, MetricKind::Cpu).mSamples.emplace_back(ms);
+        }
+    }
+    if (auto counters = tree.get_child_optional("counters")) {
+        for (const auto& counter : *counters) {
+            run.mCounters[counter.first].emplace_back(counter.second.get_value<double>());
+        }
+    }
+}
+
+// iterations of every repetition are samples, aggregates are recomputed from them
+void loadMicrobenchmarks(const ptree& tree, Run& run) {
+    for (const auto& entry : tree.get_child("benchmarks")) {
+        const auto& bench = entry.second;
+        if (bench.get<std::string>("run_type", "iteration") != "iteration")
+            continue;
+        auto name = bench.get<std::string>("run_name", bench.get<std::string>("name"));
+        metric(run, std::move(name), MetricKind::Microbenchmark, bench.get<std::string>("time_unit", "ns"))
+            .mSamples.emplace_back(bench.get<double>("real_time"));
+    }
+}
+
+// a build is one sample of each stage, assets of a step are summed
+void loadBuild(const ptree& tree, Run& run) {
+    for (const auto& stage : tree.get_child("stages")) {
+        metric(run, "stage " + stage.second.get<std::string>("name"), MetricKind::Build)
+            .mSamples.emplace_back(stage.second.get<double>("milliseconds"));
+    }
+    std::map<std::string, double> steps;
+    if (auto assets = tree.get_child_optional("assets")) {
+        for (const auto& asset : *assets) {
+            steps[asset.second.get<std::string>("step")] += asset.second.get<double>("milliseconds");
+        }
+    }
+    for (const auto& [step, ms] : steps) {
+        metric(run, "step " + step, MetricKind::Build).mSamples.emplace_back(ms);
+    }
+}
+
+}
+
+void loadRun(const std::filesystem::path& file, Run& run) {
+    std::ifstream ifs(file);
+    if (!ifs) {
+        throw std::invalid_argument("cannot open " + file.string());
+    }
+    ptree tree;
+    boost::property_tree::read_json(ifs, tree);
+
+    if (tree.get_child_optional("benchmarks")) {
+        loadMicrobenchmarks(tree, run);
+    } else if (tree.get_child_optional("stages")) {
+        loadBuild(tree, run);
+    } else if (tree.get_child_optional("cpu")) {
+        loadFrames(tree, run);
+    } else {
+        throw std::invalid_argument("unknown benchmark output: " + file.string());
+    }
+}
+
+}
@@ -0,0 +1,47 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+namespace Star::Perf {
+
+// what a regression of the metric is attributed to
+enum class MetricKind {
+    Cpu,
+    Gpu,
+    Build,
+    Microbenchmark,
+};
+
+struct Metric {
+    MetricKind mKind = MetricKind::Cpu;
+    std::string mUnit = "ms";
+    std::vector<double> mSamples;
+};
+
+// samples of every file of one side, pooled by metric name
+struct Run {
+    std::map<std::string, Metric, std::less<>> mMetrics;
+    // means per measured frame of the statistics counters, one sample per runner output
+    std::map<std::string, std::vector<double>, std::less<>> mCounters;
+};
+
+// Star.Luminous.Benchmark, Star.Benchmarks --benchmark_format=json or star_build_report.json
+// the format is detected by content, throws on anything else
+void loadRun(const std::filesystem::path& file, Run& run);
+
+}
@@ -0,0 +1,120 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "pch.h"
+#include "SPerfStatistics.h"
+
+namespace Star::Perf {
+
+namespace {
+
+// the normal approximation is poor below this, fewer samples are compared by threshold only
+constexpr size_t sMinTestedSamples = 5;
+
+}
+
+double median(std::vector<double> samples) {
+    if (samples.empty())
+        return 0;
+    auto mid = samples.begin() + samples.size() / 2;
+    std::nth_element(samples.begin(), mid, samples.end());
+    if (samples.size() % 2) {
+        return *mid;
+    }
+    return (*std::max_element(samples.begin(), mid) + *mid) / 2;
+}
+
+double mannWhitneyP(const std::vector<double>& a, const std::vector<double>& b) {
+    const double n1 = double(a.size());
+    const double n2 = double(b.size());
+    if (a.empty() || b.empty())
+        return 1;
+
+    struct Sample {
+        double mValue;
+        bool mFirst;
+    };
+    std::vector<Sample> samples;
+    samples.reserve(a.size() + b.size());
+    for (auto v : a) {
+        samples.emplace_back(Sample{ v, true });
+    }
+    for (auto v : b) {
+        samples.emplace_back(Sample{ v, false });
+    }
+    std::sort(samples.begin(), samples.end(), [](const Sample& lhs, const Sample& rhs) {
+        return lhs.mValue < rhs.mValue;
+    });
+
+    // tied samples share their mean rank
+    double rankSum = 0;
+    double tieSum = 0;
+    for (size_t i = 0; i != samples.size();) {
+        size_t j = i + 1;
+        while (j != samples.size() && samples[j].mValue == samples[i].mValue) {
+            ++j;
+        }
+        const double rank = (double(i + 1) + double(j)) / 2;
+        for (size_t k = i; k != j; ++k) {
+            if (samples[k].mFirst) {
+                rankSum += rank;
+            }
+        }
+        const double t = double(j - i);
+        tieSum += t * t * t - t;
+        i = j;
+    }
+
+    const double n = n1 + n2;
+    const double u = rankSum - n1 * (n1 + 1) / 2;
+    const double mean = n1 * n2 / 2;
+    const double variance = n1 * n2 / 12 * ((n + 1) - tieSum / (n * (n - 1)));
+    if (variance <= 0)
+        return 1;
+
+    // continuity corrected
+    const double z = std::max(0.0, std::abs(u - mean) - 0.5) / std::sqrt(variance);
+    return std::erfc(z / std::sqrt(2.0));
+}
+
+Comparison compareSamples(const std::vector<double>& baseline,
+    const std::vector<double>& candidate, double threshold, double alpha
+) {
+    Comparison result;
+    result.mBaseline = median(baseline);
+    result.mCandidate = median(candidate);
+    if (result.mBaseline != 0) {
+        result.mChange = (result.mCandidate - result.mBaseline) / std::abs(result.mBaseline);
+    }
+
+    result.mTested = baseline.size() >= sMinTestedSamples && candidate.size() >= sMinTestedSamples;
+    if (result.mTested) {
+        result.mP = mannWhitneyP(baseline, candidate);
+        if (result.mP >= alpha) {
+            return result;
+        }
+    }
+
+    if (result.mChange > threshold) {
+        result.mVerdict = Verdict::Regressed;
+    } else if (result.mChange < -threshold) {
+        result.mVerdict = Verdict::Improved;
+    }
+    return result;
+}
+
+}
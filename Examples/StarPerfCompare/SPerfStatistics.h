@@ -0,0 +1,49 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+namespace Star::Perf {
+
+double median(std::vector<double> samples);
+
+// two sided p value of the Mann-Whitney U test, normal approximation with tie correction
+// frame times are skewed and have outliers, ranks need no distribution
+double mannWhitneyP(const std::vector<double>& a, const std::vector<double>& b);
+
+enum class Verdict {
+    Unchanged,
+    Improved,
+    Regressed,
+};
+
+struct Comparison {
+    double mBaseline = 0;
+    double mCandidate = 0;
+    // relative change of the medians
+    double mChange = 0;
+    // 1 if either side has too few samples to be tested
+    double mP = 1;
+    bool mTested = false;
+    Verdict mVerdict = Verdict::Unchanged;
+};
+
+// lower values are better, a change counts when it exceeds threshold and, if tested, is significant
+Comparison compareSamples(const std::vector<double>& baseline,
+    const std::vector<double>& candidate, double threshold, double alpha);
+
+}
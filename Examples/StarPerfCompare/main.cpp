@@ -0,0 +1,192 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "pch.h"
+#include "SPerfRuns.h"
+#include "SPerfStatistics.h"
+
+using namespace Star::Perf;
+
+namespace {
+
+// counters measuring how much work a frame submits, not how fast it runs
+constexpr std::string_view sWorkloadCounters[] = {
+    "draw calls",
+    "instances",
+    "triangles",
+    "pso switches",
+    "root signature switches",
+    "descriptor allocations",
+    "upload bytes",
+    "barriers",
+};
+
+std::vector<std::string_view> split(std::string_view files) {
+    std::vector<std::string_view> result;
+    while (!files.empty()) {
+        auto pos = files.find(',');
+        result.emplace_back(files.substr(0, pos));
+        if (pos == std::string_view::npos)
+            break;
+        files.remove_prefix(pos + 1);
+    }
+    return result;
+}
+
+double mean(const std::vector<double>& values) {
+    double sum = 0;
+    for (auto v : values) {
+        sum += v;
+    }
+    return values.empty() ? 0 : sum / values.size();
+}
+
+const char* verdictName(Verdict verdict) {
+    switch (verdict) {
+    case Verdict::Improved: return "improved";
+    case Verdict::Regressed: return "REGRESSED";
+    default: return "";
+    }
+}
+
+const char* attribution(MetricKind kind, bool workloadChanged) {
+    switch (kind) {
+    case MetricKind::Cpu: return workloadChanged ? "workload" : "cpu";
+    case MetricKind::Gpu: return workloadChanged ? "workload" : "gpu";
+    case MetricKind::Build: return "build";
+    default: return "code";
+    }
+}
+
+}
+
+// Star.PerfCompare [--threshold percent] [--alpha p] [--all] baseline.json[,...] candidate.json[,...]
+// files of a side are pooled, e.g. repeated runs or builds, every file of a side has the same format
+// returns 1 if anything regressed
+int main(int argc, char* argv[]) {
+    double threshold = 0.02;
+    double alpha = 0.01;
+    bool printAll = false;
+    std::vector<std::string_view> sides;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--threshold" && i + 1 < argc) {
+            threshold = std::stod(argv[++i]) / 100;
+        } else if (arg == "--alpha" && i + 1 < argc) {
+            alpha = std::stod(argv[++i]);
+        } else if (arg == "--all") {
+            printAll = true;
+        } else {
+            sides.emplace_back(arg);
+        }
+    }
+    if (sides.size() != 2) {
+        std::cerr << "usage: Star.PerfCompare [--threshold percent] [--alpha p] [--all] "
+            "baseline.json[,...] candidate.json[,...]" << std::endl;
+        return 2;
+    }
+
+    Run baseline, candidate;
+    try {
+        for (auto file : split(sides[0])) {
+            loadRun(std::filesystem::path(file), baseline);
+        }
+        for (auto file : split(sides[1])) {
+            loadRun(std::filesystem::path(file), candidate);
+        }
+    } catch (std::exception& e) {
+        std::cerr << "[error] " << e.what() << std::endl;
+        return 2;
+    }
+
+    std::cout << std::fixed;
+
+    // frame times follow the work submitted, a changed workload is a content change, not a slower engine
+    bool workloadChanged = false;
+    if (!baseline.mCounters.empty() && !candidate.mCounters.empty()) {
+        std::cout << "counters, mean per frame\n";
+        for (const auto& [name, values] : baseline.mCounters) {
+            auto iter = candidate.mCounters.find(name);
+            if (iter == candidate.mCounters.end())
+                continue;
+            const double before = mean(values);
+            const double after = mean(iter->second);
+            const double change = before != 0 ? (after - before) / before : (after != 0 ? 1 : 0);
+            const bool workload = std::find(std::begin(sWorkloadCounters), std::end(sWorkloadCounters), name)
+                != std::end(sWorkloadCounters);
+            if (workload && std::abs(change) > threshold) {
+                workloadChanged = true;
+            }
+            std::cout << "  " << std::left << std::setw(28) << name << std::right
+                << std::setprecision(1) << std::setw(14) << before << " -> " << std::setw(14) << after
+                << std::showpos << std::setw(9) << change * 100 << "%" << std::noshowpos
+                << (workload && std::abs(change) > threshold ? "  workload" : "") << "\n";
+        }
+        std::cout << "\n";
+    }
+
+    uint32_t regressions = 0;
+    uint32_t improvements = 0;
+    for (const auto& [name, before] : baseline.mMetrics) {
+        auto iter = candidate.mMetrics.find(name);
+        if (iter == candidate.mMetrics.end()) {
+            if (printAll) {
+                std::cout << "  removed    " << name << "\n";
+            }
+            continue;
+        }
+        const auto& after = iter->second;
+        const auto result = compareSamples(before.mSamples, after.mSamples, threshold, alpha);
+        if (result.mVerdict == Verdict::Regressed) {
+            ++regressions;
+        } else if (result.mVerdict == Verdict::Improved) {
+            ++improvements;
+        } else if (!printAll) {
+            continue;
+        }
+
+        std::cout << "  " << std::left << std::setw(10) << verdictName(result.mVerdict) << " "
+            << std::setw(40) << name << std::right
+            << std::setprecision(3) << std::setw(12) << result.mBaseline << " -> "
+            << std::setw(12) << result.mCandidate << " " << std::left << std::setw(3) << after.mUnit << std::right
+            << std::setprecision(1) << std::showpos << std::setw(8) << result.mChange * 100 << "%" << std::noshowpos;
+        if (result.mTested) {
+            std::cout << "  p=" << std::setprecision(4) << result.mP;
+        } else {
+            std::cout << "  untested";
+        }
+        if (result.mVerdict == Verdict::Regressed) {
+            std::cout << "  " << attribution(before.mKind, workloadChanged);
+        }
+        std::cout << "\n";
+    }
+    if (printAll) {
+        for (const auto& [name, after] : candidate.mMetrics) {
+            if (!baseline.mMetrics.count(name)) {
+                std::cout << "  added      " << name << "\n";
+            }
+        }
+    }
+
+    std::cout << "\n" << regressions << " regressed, " << improvements << " improved, threshold "
+        << std::setprecision(1) << threshold * 100 << "%, alpha " << std::setprecision(3) << alpha << "\n";
+    if (regressions && workloadChanged) {
+        std::cout << "workload counters changed, frame time regressions may come from content\n";
+    }
+
+    return regressions ? 1 : 0;
+}
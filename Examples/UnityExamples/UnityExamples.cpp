@@ -19,6 +19,7 @@
 #include <StarCompiler/ShaderGraph/SShaderDatabase.h>
 #include <StarCompiler/ShaderGraph/SShaderDSL.h>
 #include <StarCompiler/ShaderWorks/SUnityShaderBuilder.h>
+#include <Star/AssetFactory/SAssetBuildGraph.h>
 
 using namespace Star;
 using namespace Star::Graphics;
@@ -84,22 +85,39 @@ int buildUnityShaders(const ShaderModules& modules, ShaderDatabase& db) {
     } // SubShader
     } // Shader
 
-    BUILD("Star/PBR Standard", "../../Unity/Shaders/PBRStandard.shader");
-    //BUILD("Star/PBR Standard", "../../../StarUnity/Assets/Shaders/PBRStandard.shader");
+    UnityShaderBuilder().exportShaders(modules.mAttributes, db, {
+        { "Star/PBR Standard", "../../Unity/Shaders/PBRStandard.shader" },
+        //{ "Star/PBR Standard", "../../../StarUnity/Assets/Shaders/PBRStandard.shader" },
+    });
 
     return 0;
 }
 
-int main() {
+// exported shaders are skipped while this builder and their files are unchanged
+int main(int argc, char* argv[]) {
     std::cout << "---------------------------------------\n";
     std::cout << "create render graph2\n";
     std::cout << "---------------------------------------\n";
 
     try {
         ShaderModules modules;
-        ShaderDatabase shaderDB;
         createUnityModules(modules);
-        buildUnityShaders(modules, shaderDB);
+
+        // shaders only change with the shader graph code compiled into this builder
+        std::string builderKey;
+        std::error_code ec;
+        auto builderTime = std::filesystem::last_write_time(argc > 0 ? argv[0] : "", ec);
+        if (!ec) {
+            builderKey = std::to_string(builderTime.time_since_epoch().count());
+        }
+
+        Asset::BuildGraph jobs("UnityExamples.jobs");
+        jobs.add({ "PBR Standard", {}, false, builderKey, { "../../Unity/Shaders/PBRStandard.shader" } }, [&]() {
+            ShaderDatabase shaderDB;
+            buildUnityShaders(modules, shaderDB);
+        });
+        jobs.run();
+        jobs.writeSummary(std::cout);
     } catch (std::invalid_argument & e) {
         {
             CONSOLE_COLOR(Red);
@@ -0,0 +1,249 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "SAssetBuildGraph.h"
+#include "SAssetBuildReport.h"
+#include <algorithm>
+#include <condition_variable>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+
+namespace Star::Asset {
+
+namespace {
+
+// one job per line, name and key separated by a tab
+std::unordered_map<std::string, std::string> loadCacheKeys(const std::filesystem::path& file) {
+    std::unordered_map<std::string, std::string> keys;
+    std::ifstream ifs(file);
+    std::string line;
+    while (std::getline(ifs, line)) {
+        auto pos = line.find('\t');
+        if (pos != std::string::npos) {
+            keys.emplace(line.substr(0, pos), line.substr(pos + 1));
+        }
+    }
+    return keys;
+}
+
+const char* getStateName(BuildJobState state) noexcept {
+    switch (state) {
+    case BuildJobState::Pending: return "pending";
+    case BuildJobState::Built: return "built";
+    case BuildJobState::Cached: return "cached";
+    case BuildJobState::Failed: return "FAILED";
+    case BuildJobState::Cancelled: return "cancelled";
+    default: return "";
+    }
+}
+
+}
+
+BuildGraph::BuildGraph(std::filesystem::path cacheFile)
+    : mCacheFile(std::move(cacheFile))
+{}
+
+BuildGraph::~BuildGraph() = default;
+
+uint32_t BuildGraph::add(BuildJobDesc desc, std::function<void()> job) {
+    const auto id = gsl::narrow<uint32_t>(mJobs.size());
+    for (auto dependency : desc.mDependencies) {
+        if (dependency >= id) {
+            throw std::invalid_argument("build job " + desc.mName + " depends on a job added after it");
+        }
+    }
+    if (desc.mCacheKey.find_first_of("\t\n") != std::string::npos) {
+        throw std::invalid_argument("cache key of build job " + desc.mName + " contains a tab or newline");
+    }
+    mJobs.emplace_back(Job{ std::move(desc), std::move(job) });
+    return id;
+}
+
+void BuildGraph::run(uint32_t maxThreads) {
+    BuildTimer timer;
+    const auto cacheKeys = mCacheFile.empty()
+        ? std::unordered_map<std::string, std::string>{} : loadCacheKeys(mCacheFile);
+
+    mTimings.assign(mJobs.size(), BuildJobTiming{});
+    for (size_t i = 0; i != mJobs.size(); ++i) {
+        mTimings[i].mName = mJobs[i].mDesc.mName;
+    }
+
+    // states are read and written under the mutex
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<char> started(mJobs.size());
+    size_t remaining = mJobs.size();
+    std::exception_ptr failure;
+
+    // jobs are added after their dependencies, one pass cancels every dependent of a failed job
+    auto findReady = [&](bool mainThread) -> std::optional<uint32_t> {
+        std::optional<uint32_t> ready;
+        bool cancelled = false;
+        for (uint32_t id = 0; id != mJobs.size(); ++id) {
+            if (started[id])
+                continue;
+            bool dependenciesDone = true;
+            bool dependencyFailed = false;
+            for (auto dependency : mJobs[id].mDesc.mDependencies) {
+                const auto state = mTimings[dependency].mState;
+                if (state == BuildJobState::Failed || state == BuildJobState::Cancelled) {
+                    dependencyFailed = true;
+                } else if (state == BuildJobState::Pending) {
+                    dependenciesDone = false;
+                }
+            }
+            if (dependencyFailed) {
+                started[id] = true;
+                mTimings[id].mState = BuildJobState::Cancelled;
+                --remaining;
+                cancelled = true;
+            } else if (!ready && dependenciesDone && mJobs[id].mDesc.mMainThread == mainThread) {
+                ready = id;
+            }
+        }
+        if (cancelled) {
+            cv.notify_all();
+        }
+        return ready;
+    };
+
+    auto execute = [&](bool mainThread) {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            auto id = findReady(mainThread);
+            if (!id) {
+                if (!remaining)
+                    break;
+                cv.wait(lock);
+                continue;
+            }
+            started[*id] = true;
+            const auto& job = mJobs[*id];
+            auto& timing = mTimings[*id];
+            timing.mStart = timer.elapsed();
+            const bool dependenciesCached = std::all_of(job.mDesc.mDependencies.begin(),
+                job.mDesc.mDependencies.end(), [&](uint32_t dependency) {
+                    return mTimings[dependency].mState == BuildJobState::Cached;
+                });
+            lock.unlock();
+
+            auto state = BuildJobState::Built;
+            std::exception_ptr error;
+            auto key = cacheKeys.find(job.mDesc.mName);
+            if (dependenciesCached && !job.mDesc.mCacheKey.empty() &&
+                key != cacheKeys.end() && key->second == job.mDesc.mCacheKey &&
+                std::all_of(job.mDesc.mOutputs.begin(), job.mDesc.mOutputs.end(),
+                    [](const std::filesystem::path& output) { return std::filesystem::exists(output); })) {
+                state = BuildJobState::Cached;
+            } else {
+                try {
+                    job.mFunction();
+                } catch (...) {
+                    state = BuildJobState::Failed;
+                    error = std::current_exception();
+                }
+            }
+            const auto milliseconds = timer.elapsed() - timing.mStart;
+
+            lock.lock();
+            timing.mState = state;
+            timing.mMilliseconds = milliseconds;
+            if (error && !failure) {
+                failure = error;
+            }
+            --remaining;
+            cv.notify_all();
+        }
+    };
+
+    const bool hasWorkerJobs = std::any_of(mJobs.begin(), mJobs.end(),
+        [](const Job& job) { return !job.mDesc.mMainThread; });
+    uint32_t threadCount = maxThreads ? maxThreads : std::max(1u, std::thread::hardware_concurrency());
+    threadCount = hasWorkerJobs ? std::min(threadCount, gsl::narrow<uint32_t>(mJobs.size())) : 0;
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount);
+    for (uint32_t i = 0; i != threadCount; ++i) {
+        threads.emplace_back(execute, false);
+    }
+    execute(true);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    mTotalMilliseconds = timer.elapsed();
+
+    // failed jobs are left out, they run again next time
+    if (!mCacheFile.empty()) {
+        std::ofstream ofs(mCacheFile);
+        for (size_t i = 0; i != mJobs.size(); ++i) {
+            const auto state = mTimings[i].mState;
+            if (!mJobs[i].mDesc.mCacheKey.empty() &&
+                (state == BuildJobState::Built || state == BuildJobState::Cached)) {
+                ofs << mJobs[i].mDesc.mName << '\t' << mJobs[i].mDesc.mCacheKey << '\n';
+            }
+        }
+    }
+
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+}
+
+double BuildGraph::criticalPathMilliseconds() const {
+    // dependencies precede their jobs, finish times are accumulated in order
+    std::vector<double> finish(mTimings.size());
+    double longest = 0;
+    for (size_t i = 0; i != mTimings.size(); ++i) {
+        double start = 0;
+        for (auto dependency : mJobs[i].mDesc.mDependencies) {
+            start = std::max(start, finish[dependency]);
+        }
+        finish[i] = start + mTimings[i].mMilliseconds;
+        longest = std::max(longest, finish[i]);
+    }
+    return longest;
+}
+
+void BuildGraph::writeSummary(std::ostream& os) const {
+    std::vector<const BuildJobTiming*> jobs;
+    jobs.reserve(mTimings.size());
+    double sum = 0;
+    for (const auto& timing : mTimings) {
+        jobs.emplace_back(&timing);
+        sum += timing.mMilliseconds;
+    }
+    std::stable_sort(jobs.begin(), jobs.end(), [](const auto* lhs, const auto* rhs) {
+        return lhs->mStart < rhs->mStart;
+    });
+
+    os << std::fixed << std::setprecision(1);
+    os << "jobs:\n";
+    for (const auto* job : jobs) {
+        os << "  " << std::setw(10) << job->mStart << " ms +" << std::setw(10) << job->mMilliseconds << " ms "
+            << std::left << std::setw(10) << getStateName(job->mState) << std::right << job->mName << "\n";
+    }
+    // jobs overlap, their sum exceeds the wall time
+    os << "total " << mTotalMilliseconds << " ms, jobs " << sum
+        << " ms, critical path " << criticalPathMilliseconds() << " ms\n";
+    os << std::defaultfloat;
+}
+
+}
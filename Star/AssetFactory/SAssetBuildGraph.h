@@ -0,0 +1,101 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <Star/AssetFactory/SConfig.h>
+#include <filesystem>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Star::Asset {
+
+struct BuildJobDesc {
+    std::string mName;
+    // ids returned by BuildGraph::add, jobs are added after their dependencies
+    std::vector<uint32_t> mDependencies;
+    // runs on the thread calling run, one at a time, e.g. jobs editing the asset factory
+    // other jobs run on threads of the run
+    bool mMainThread = false;
+    // inputs of the job written by the caller, a job with a key is skipped when the key of the last run
+    // matches, its outputs exist and its dependencies were skipped too
+    // skipped jobs leave nothing in memory, only jobs writing files should have a key
+    std::string mCacheKey;
+    std::vector<std::filesystem::path> mOutputs;
+};
+
+enum class BuildJobState : uint32_t {
+    Pending,
+    Built,
+    Cached,
+    Failed,
+    // a dependency failed
+    Cancelled,
+};
+
+struct BuildJobTiming {
+    std::string mName;
+    BuildJobState mState = BuildJobState::Pending;
+    // milliseconds since the run started
+    double mStart = 0;
+    double mMilliseconds = 0;
+};
+
+// steps of a builder as a dependency graph, independent jobs run concurrently
+// cache keys of built and skipped jobs are kept in the cache file between runs
+class STAR_ASSETFACTORY_API BuildGraph {
+public:
+    // empty cache file disables caching
+    explicit BuildGraph(std::filesystem::path cacheFile = {});
+    ~BuildGraph();
+    BuildGraph(const BuildGraph&) = delete;
+    BuildGraph& operator=(const BuildGraph&) = delete;
+
+    uint32_t add(BuildJobDesc desc, std::function<void()> job);
+
+    // every job runs or is skipped, the first exception is rethrown once running jobs finished
+    // jobs depending on a failed job are cancelled, threads default to the hardware concurrency
+    void run(uint32_t maxThreads = 0);
+
+    const std::vector<BuildJobTiming>& timings() const noexcept {
+        return mTimings;
+    }
+    double totalMilliseconds() const noexcept {
+        return mTotalMilliseconds;
+    }
+    // longest chain of dependent jobs, the shortest time the run could take
+    double criticalPathMilliseconds() const;
+
+    // jobs in start order with their state, then wall time against the sum of jobs and the critical path
+    void writeSummary(std::ostream& os) const;
+private:
+    struct Job {
+        BuildJobDesc mDesc;
+        std::function<void()> mFunction;
+    };
+
+#pragma warning(push)
+#pragma warning(disable: 4251)
+    std::filesystem::path mCacheFile;
+    std::vector<Job> mJobs;
+    std::vector<BuildJobTiming> mTimings;
+    double mTotalMilliseconds = 0;
+#pragma warning(pop)
+};
+
+}
@@ -0,0 +1,134 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "SAssetBuildReport.h"
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <map>
+
+namespace Star::Asset {
+
+namespace {
+
+std::atomic<BuildReport*> sActiveReport = nullptr;
+
+void writeJsonString(std::ostream& os, std::string_view str) {
+    os << '"';
+    for (char c : str) {
+        if (c == '"' || c == '\\') {
+            os << '\\';
+        }
+        os << c;
+    }
+    os << '"';
+}
+
+}
+
+void BuildReport::clear() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStages.clear();
+    mAssets.clear();
+}
+
+void BuildReport::addStage(std::string_view name, double milliseconds) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStages.emplace_back(BuildStageTiming{ std::string(name), milliseconds });
+}
+
+void BuildReport::addAsset(std::string_view step, std::string_view asset, double milliseconds) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mAssets.emplace_back(BuildAssetTiming{ std::string(step), std::string(asset), milliseconds });
+}
+
+std::vector<BuildAssetTiming> BuildReport::assets() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mAssets;
+}
+
+double BuildReport::totalMilliseconds() const noexcept {
+    double total = 0;
+    for (const auto& stage : mStages) {
+        total += stage.mMilliseconds;
+    }
+    return total;
+}
+
+void BuildReport::writeText(std::ostream& os, size_t assetsPerStep) const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    const auto total = totalMilliseconds();
+    os << std::fixed << std::setprecision(1);
+    os << "build " << total << " ms\n";
+    for (const auto& stage : mStages) {
+        os << "  " << std::setw(10) << stage.mMilliseconds << " ms "
+            << std::setw(5) << (total > 0 ? 100.0 * stage.mMilliseconds / total : 0.0) << "% "
+            << stage.mName << "\n";
+    }
+
+    // assets run in parallel, their sum exceeds the stage they belong to
+    std::map<std::string_view, std::vector<const BuildAssetTiming*>> steps;
+    for (const auto& asset : mAssets) {
+        steps[asset.mStep].emplace_back(&asset);
+    }
+    for (auto& [step, assets] : steps) {
+        std::sort(assets.begin(), assets.end(), [](const auto* lhs, const auto* rhs) {
+            return lhs->mMilliseconds > rhs->mMilliseconds;
+        });
+        double sum = 0;
+        for (const auto* asset : assets) {
+            sum += asset->mMilliseconds;
+        }
+        os << step << ": " << assets.size() << " assets, " << sum << " ms\n";
+        for (size_t i = 0; i != std::min(assetsPerStep, assets.size()); ++i) {
+            os << "  " << std::setw(10) << assets[i]->mMilliseconds << " ms " << assets[i]->mAsset << "\n";
+        }
+    }
+    os << std::defaultfloat;
+}
+
+void BuildReport::writeJson(std::ostream& os) const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    os << "{\"totalMilliseconds\":" << totalMilliseconds() << ",\n\"stages\":[";
+    for (size_t i = 0; i != mStages.size(); ++i) {
+        os << (i ? ",\n" : "\n") << "{\"name\":";
+        writeJsonString(os, mStages[i].mName);
+        os << ",\"milliseconds\":" << mStages[i].mMilliseconds << "}";
+    }
+    os << "\n],\n\"assets\":[";
+    for (size_t i = 0; i != mAssets.size(); ++i) {
+        os << (i ? ",\n" : "\n") << "{\"step\":";
+        writeJsonString(os, mAssets[i].mStep);
+        os << ",\"asset\":";
+        writeJsonString(os, mAssets[i].mAsset);
+        os << ",\"milliseconds\":" << mAssets[i].mMilliseconds << "}";
+    }
+    os << "\n]}\n";
+}
+
+void BuildReport::setActive(BuildReport* pReport) noexcept {
+    sActiveReport.store(pReport, std::memory_order_release);
+}
+
+void BuildReport::record(std::string_view step, std::string_view asset, double milliseconds) {
+    auto* pReport = sActiveReport.load(std::memory_order_acquire);
+    if (pReport) {
+        pReport->addAsset(step, asset, milliseconds);
+    }
+}
+
+}
@@ -0,0 +1,89 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <Star/AssetFactory/SConfig.h>
+#include <chrono>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Star::Asset {
+
+struct BuildStageTiming {
+    std::string mName;
+    double mMilliseconds = 0;
+};
+
+// one step of one asset, e.g. the fbx import of a scene
+struct BuildAssetTiming {
+    std::string mStep;
+    std::string mAsset;
+    double mMilliseconds = 0;
+};
+
+class BuildTimer {
+public:
+    BuildTimer() noexcept
+        : mStart(std::chrono::steady_clock::now())
+    {}
+    double elapsed() const noexcept {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - mStart).count();
+    }
+    // milliseconds since construction or the previous lap
+    double lap() noexcept {
+        auto now = std::chrono::steady_clock::now();
+        auto ms = std::chrono::duration<double, std::milli>(now - mStart).count();
+        mStart = now;
+        return ms;
+    }
+private:
+    std::chrono::steady_clock::time_point mStart;
+};
+
+// timings of the last build, assets are recorded by the worker threads importing them
+class STAR_ASSETFACTORY_API BuildReport {
+public:
+    void clear();
+    void addStage(std::string_view name, double milliseconds);
+    void addAsset(std::string_view step, std::string_view asset, double milliseconds);
+
+    const std::vector<BuildStageTiming>& stages() const noexcept {
+        return mStages;
+    }
+    std::vector<BuildAssetTiming> assets() const;
+    double totalMilliseconds() const noexcept;
+
+    // stages in build order, then the slowest assets of each step
+    void writeText(std::ostream& os, size_t assetsPerStep = 10) const;
+    void writeJson(std::ostream& os) const;
+
+    // steps deep inside importers, e.g. tangents of a mesh, are recorded to the report of the running build
+    static void setActive(BuildReport* pReport) noexcept;
+    static void record(std::string_view step, std::string_view asset, double milliseconds);
+private:
+#pragma warning(push)
+#pragma warning(disable: 4251)
+    mutable std::mutex mMutex;
+    std::vector<BuildStageTiming> mStages;
+    std::vector<BuildAssetTiming> mAssets;
+#pragma warning(pop)
+};
+
+}
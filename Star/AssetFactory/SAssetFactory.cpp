@@ -18,10 +18,20 @@
 #include "SAssetFactory.h"
 #include <Star/Core/SProducer.h>
 #include <Star/Core/SResourceUtils.h>
+#include <Star/Core/SProfiler.h>
+#include <Star/Core/SStartupTimeline.h>
 #include "SAssetTypes.h"
 #include "SAssetUtils.h"
 #include "SAssetFbxImporter.h"
 #include "SAssetTexture.h"
+#include "SAssetTextureAtlas.h"
+#include "SAssetPack.h"
+#include "SAssetWatcher.h"
+#include "SAssetStaticBatch.h"
+#include "SAssetStressScene.h"
+#include "SAssetBuildReport.h"
+#include "SAssetMesh.h"
+#include "SAssetPipelineState.h"
 #include <Star/Graphics/SContentSerialization.h>
 #include <Star/AssetFactory/SAssetSerialization.h>
 #include <StarCompiler/ShaderGraph/SShaderModules.h>
@@ -30,6 +40,15 @@
 #include <StarCompiler/ShaderWorks/SShaderAssetBuilder.h>
 #include <Star/Graphics/SContentUtils.h>
 #include <Star/Graphics/SRenderFormatUtils.h>
+#include <Star/Graphics/SMeshFile.h>
+#include <Star/Graphics/SContentFile.h>
+#include <Star/Graphics/SShaderBlobFile.h>
+#include <Star/SMappedFile.h>
+#include <Star/SFileIO.h>
+#include <Star/SScopeExit.h>
+#include <boost/functional/hash.hpp>
+#include <iomanip>
+#include <mutex>
 
 namespace Star::Asset {
 
@@ -37,6 +56,9 @@ using namespace Graphics::Render;
 using namespace Graphics::Render::Shader;
 using std::filesystem::path;
 
+// MetaID and ResourceType index of every dependency
+using DependencyManifest = std::vector<std::pair<MetaID, uint32_t>>;
+
 struct AssetFactory::Impl final : public Core::Producer {
     using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
     allocator_type get_allocator() const noexcept {
@@ -68,11 +90,28 @@ struct AssetFactory::Impl final : public Core::Producer {
             { "uv", { 0, 3 } },
         };
         mResources.mSettings.mVertexLayoutIndex.emplace("StaticMesh", 1);
+
+        // 24 bytes per vertex, decoded by the input assembler
+        auto& compactLayout = mResources.mSettings.mVertexLayouts.emplace_back();
+        auto& compactDesc = compactLayout.mBuffers.emplace_back();
+        compactDesc.mElements = {
+            { SV_Position, 0, Format::R32G32B32_SFLOAT },
+            { NORMAL, 12, Format::R8G8B8A8_SNORM },
+            { TANGENT, 16, Format::R8G8B8A8_SNORM },
+            { TEXCOORD, 20, Format::R16G16_SFLOAT },
+        };
+        compactDesc.mVertexSize = 24;
+        compactLayout.mIndex = mResources.mSettings.mVertexLayouts.at(1).mIndex;
+        mResources.mSettings.mVertexLayoutIndex.emplace("StaticMeshCompact", 2);
     }
     Impl(const Impl&) = delete;
     Impl& operator=(const Impl&) = delete;
 private:
     std::pair<MetaID, bool> try_readAssetMetaID(std::string_view assetPath) const {
+        auto iter = mMetaIDs.find(assetPath);
+        if (iter != mMetaIDs.end()) {
+            return { iter->second, true };
+        }
         MetaID id{};
         Expects(id.is_nil());
         auto filename = mFolder / (str(assetPath) + ".meta");
@@ -93,6 +132,7 @@ private:
             create_directories(filename.parent_path());
         }
         writeMetaIDFile(filename, metaID);
+        mMetaIDs.insert_or_assign(getAssetName(assetPath), metaID);
         return { metaID, true };
     }
 
@@ -294,21 +334,133 @@ private:
         }
     }
 
+    // lowercase asset name of a meta file, without filesystem access
+    std::string getMetaAssetName(const std::filesystem::path& meta) const {
+        auto name = boost::algorithm::to_lower_copy(meta.lexically_relative(mFolder).generic_u8string());
+        name.resize(name.size() - std::string_view(".meta").size());
+        return name;
+    }
+
+    // asset names of every meta file, sorted, top level folders are walked in parallel
+    std::vector<std::string> enumerateAssets() const {
+        std::vector<std::string> names;
+        std::vector<std::filesystem::path> folders;
+        for (const auto& p : std::filesystem::directory_iterator(mFolder)) {
+            if (p.is_directory()) {
+                folders.emplace_back(p.path());
+            } else if (isMeta(p.path().extension())) {
+                names.emplace_back(getMetaAssetName(p.path()));
+            }
+        }
+        std::vector<std::vector<std::string>> found(folders.size());
+        std::for_each(std::execution::par, folders.begin(), folders.end(),
+            [&](const std::filesystem::path& folder) {
+                auto& dst = found[&folder - folders.data()];
+                for (const auto& p : std::filesystem::recursive_directory_iterator(folder)) {
+                    if (isMeta(p.path().extension())) {
+                        dst.emplace_back(getMetaAssetName(p.path()));
+                    }
+                }
+            }
+        );
+        for (auto& dst : found) {
+            names.insert(names.end(), std::make_move_iterator(dst.begin()), std::make_move_iterator(dst.end()));
+        }
+        std::sort(names.begin(), names.end());
+        return names;
+    }
+
+    static constexpr uint32_t sScanCacheVersion = 1;
+
+    std::filesystem::path getScanCachePath() const {
+        return mLibrary / "star_scan.db";
+    }
+
+    void loadScanCache() {
+        mScanCache.mRecords.clear();
+        auto filename = getScanCachePath();
+        if (!exists(filename)) {
+            return;
+        }
+        try {
+            std::ifstream ifs(filename, std::ios::binary);
+            ifs.exceptions(std::istream::failbit);
+            boost::archive::binary_iarchive ia(ifs);
+            uint32_t version = 0;
+            ia >> version;
+            if (version != sScanCacheVersion) {
+                return;
+            }
+            ia >> mScanCache;
+        } catch (const std::exception&) {
+            mScanCache.mRecords.clear();
+        }
+    }
+
+    void saveScanCache() const {
+        std::ostringstream oss;
+        {
+            boost::archive::binary_oarchive oa(oss);
+            oa << sScanCacheVersion;
+            oa << mScanCache;
+        }
+        if (!exists(mLibrary)) {
+            create_directories(mLibrary);
+        }
+        updateBinary(getScanCachePath(), oss.str());
+    }
+
+    // meta files are parsed in parallel, meta files unchanged since the last scan are not opened,
+    // the database is filled serially in name order afterwards
     void readAllAssetInfo() {
-        std::string_view extMeta(".meta");
-        for (const auto& p0 : std::filesystem::recursive_directory_iterator(mFolder)) {
-            auto p = std::filesystem::path(boost::algorithm::to_lower_copy(p0.path().string()));
-            const auto& ext = p.extension().string();
-            if (boost::algorithm::iequals(ext, extMeta)) {
-                auto filepath = p;
-                filepath.replace_extension("");
+        STAR_PROFILE_SCOPE("AssetFactory::readAllAssetInfo");
+        loadScanCache();
+        mScannedAssets = enumerateAssets();
+
+        std::vector<ScanRecord> records(mScannedAssets.size());
+        std::vector<char> missing(mScannedAssets.size(), 0);
+        std::for_each(std::execution::par, mScannedAssets.begin(), mScannedAssets.end(),
+            [&](const std::string& name) {
+                const auto i = &name - mScannedAssets.data();
+                auto filepath = mFolder / name;
                 if (!exists(filepath)) {
-                    throw std::runtime_error("asset not found: " + filepath.string());
+                    missing[i] = 1;
+                    return;
                 }
+                auto metaPath = filepath;
+                metaPath += ".meta";
+                std::error_code ec;
+                auto writeTime = std::filesystem::last_write_time(metaPath, ec).time_since_epoch().count();
+                auto iter = mScanCache.mRecords.find(name);
+                if (!ec && iter != mScanCache.mRecords.end() && iter->second.mWriteTime == writeTime) {
+                    records[i] = iter->second;
+                    return;
+                }
+                auto [metaID, succeeded] = try_readMetaIDFile(metaPath);
+                Ensures(succeeded);
+                records[i] = ScanRecord{ ec ? 0 : int64_t(writeTime), metaID };
+            }
+        );
 
-                readAssetInfo(filepath, p);
+        ScanCache next;
+        for (size_t i = 0; i != mScannedAssets.size(); ++i) {
+            const auto& name = mScannedAssets[i];
+            if (missing[i]) {
+                throw std::runtime_error("asset not found: " + (mFolder / name).string());
             }
+            mMetaIDs.insert_or_assign(name, records[i].mMetaID);
+            next.mRecords.emplace(name, records[i]);
+        }
+        mScanCache = std::move(next);
+        saveScanCache();
+
+        for (const auto& name : mScannedAssets) {
+            auto filepath = mFolder / name;
+            auto metaPath = filepath;
+            metaPath += ".meta";
+            readAssetInfo(filepath, metaPath);
         }
+        registerStaticBatches();
     }
 
     template<class Info>
@@ -322,17 +474,76 @@ private:
         return *res.first;
     }
 
+    static constexpr uint32_t sAssetInfoVersion = 1;
+
+    // binary twins of the xml asset descriptions, read instead of the xml while the asset is unchanged
+    std::filesystem::path getAssetInfoPath(std::string_view assetPath) const {
+        auto filename = mLibrary / "star_asset_info" / assetPath;
+        filename += ".bin";
+        return filename;
+    }
+
+    template<class T>
+    bool try_readAssetInfo(std::string_view assetPath, int64_t writeTime, T& value) const {
+        auto filename = getAssetInfoPath(assetPath);
+        if (!exists(filename)) {
+            return false;
+        }
+        try {
+            std::ifstream ifs(filename, std::ios::binary);
+            ifs.exceptions(std::istream::failbit);
+            boost::archive::binary_iarchive ia(ifs);
+            uint32_t version = 0;
+            int64_t time = 0;
+            ia >> version;
+            ia >> time;
+            if (version != sAssetInfoVersion || time != writeTime) {
+                return false;
+            }
+            ia >> value;
+        } catch (const std::exception&) {
+            value = T{};
+            return false;
+        }
+        return true;
+    }
+
+    template<class T>
+    void writeAssetInfo(std::string_view assetPath, int64_t writeTime, const T& value) const {
+        std::ostringstream oss;
+        {
+            boost::archive::binary_oarchive oa(oss);
+            oa << sAssetInfoVersion;
+            oa << writeTime;
+            oa << value;
+        }
+        auto filename = getAssetInfoPath(assetPath);
+        auto folder = filename.parent_path();
+        if (!exists(folder)) {
+            create_directories(folder);
+        }
+        updateBinary(filename, oss.str());
+    }
+
+    // the xml is parsed once per change, scans read its binary twin
     template<class Info>
     auto& readAsset(std::string_view assetPath, Info& info) {
         auto [metaID, succeeded] = try_readAssetMetaID(assetPath);
         Ensures(succeeded);
 
         typename Info::value_type v{};
-        {
-            std::ifstream ifs(mFolder / assetPath, std::ios::binary);
-            ifs.exceptions(std::istream::failbit);
-            boost::archive::xml_iarchive ia(ifs);
-            ia >> boost::serialization::make_nvp("value", v);
+        std::error_code ec;
+        const int64_t writeTime = std::filesystem::last_write_time(mFolder / assetPath, ec).time_since_epoch().count();
+        if (ec || !try_readAssetInfo(assetPath, writeTime, v)) {
+            {
+                std::ifstream ifs(mFolder / assetPath, std::ios::binary);
+                ifs.exceptions(std::istream::failbit);
+                boost::archive::xml_iarchive ia(ifs);
+                ia >> boost::serialization::make_nvp("value", v);
+            }
+            if (!ec) {
+                writeAssetInfo(assetPath, writeTime, v);
+            }
         }
         v.mName = assetPath;
         v.mMetaID = metaID;
@@ -400,10 +611,17 @@ private:
             auto res3 = mResources.mContents.try_emplace(metaID);
             Ensures(res3.second);
 
-            std::ifstream ifs(mFolder / assetPath, std::ios::binary);
-            ifs.exceptions(std::istream::failbit);
-            boost::archive::binary_iarchive ia(ifs);
-            ia >> res3.first->second;
+            try {
+                std::ifstream ifs(mFolder / assetPath, std::ios::binary);
+                ifs.exceptions(std::istream::failbit);
+                boost::archive::binary_iarchive ia(ifs);
+                ia >> res3.first->second;
+            } catch (const std::exception&) {
+                // written before object arrays were stored as blocks, empty until the content is saved again
+                S_WARNING << "content " << assetPath << " has an older format, build it again";
+                mResources.mContents.erase(res3.first);
+                mResources.mContents.try_emplace(metaID);
+            }
         }
 
         return *res.first;
@@ -507,44 +725,686 @@ private:
         return iter->mMetaID;
     }
 
+    using ShaderUsages = std::map<std::string, ShaderQueueSet, std::less<>>;
+
+    // collects the (solution, pipeline, queue) each shader is drawn in from the contents bound to render graphs
+    ShaderUsages collectShaderUsages() const {
+        ShaderUsages usages;
+        for (const auto& renderGraphInfo : mDatabase.mRenderGraphInfo) {
+            auto rgIter = mResources.mRenderGraphs.find(renderGraphInfo.mMetaID);
+            if (rgIter == mResources.mRenderGraphs.end()) {
+                continue;
+            }
+            const auto& renderSwapChain = rgIter->second.mRenderGraph;
+            for (const auto& [solutionName, solutionID] : renderSwapChain.mSolutionIndex) {
+                const auto& solution = renderSwapChain.mSolutions.at(solutionID);
+                for (const auto& [pipelineName, pipelineID] : solution.mPipelineIndex) {
+                    const auto& pipeline = solution.mPipelines.at(pipelineID);
+                    for (const auto& [queueName, desc] : pipeline.mSubpassIndex) {
+                        const auto& subpass = pipeline.mPasses.at(desc.mPassID)
+                            .mGraphicsSubpasses.at(desc.mSubpassID);
+                        ShaderQueueKey key{ str(solutionName), str(pipelineName), str(queueName) };
+
+                        auto addMaterial = [&](const MetaID& material) {
+                            const auto& materialAsset = at(mDatabase.mMaterialInfo, material);
+                            usages[materialAsset.mShader].emplace(key);
+                        };
+                        for (const auto& queue : subpass.mOrderedRenderQueue) {
+                            for (const auto& contentID : queue.mContents) {
+                                auto contentIter = mResources.mContents.find(contentID);
+                                if (contentIter == mResources.mContents.end()) {
+                                    continue;
+                                }
+                                const auto& contentData = contentIter->second;
+                                for (const auto& dc : contentData.mDrawCalls) {
+                                    addMaterial(dc.mMaterial);
+                                }
+                                for (const auto& object : contentData.mFlattenedObjects) {
+                                    for (const auto& renderer : object.mMeshRenderers) {
+                                        for (const auto& materialID : renderer.mMaterialIDs) {
+                                            addMaterial(materialID);
+                                        }
+                                    }
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        return usages;
+    }
+
     void createShaders(const RenderGraphFactory& factory,
-        const Shader::AttributeDatabase& attrs, RenderGraphData& rg
+        const Shader::AttributeDatabase& attrs, RenderGraphData& rg,
+        const ShaderUsages& usages
     ) {
         const auto& shaderFolder = factory.mFolder;
         if (!exists(mFolder / shaderFolder)) {
             create_directories(mFolder / shaderFolder);
         }
+        // the shader groups, modules and attributes are immutable here, prototypes are resolved in parallel
+        // the asset database is only updated serially, compilation of all prototypes is gathered and run in parallel
+        struct PrototypeBuild {
+            const std::string* mName = nullptr;
+            const ShaderPrototype* mPrototype = nullptr;
+            std::string mContent;
+            ShaderData* mResource = nullptr;
+            const ShaderQueueSet* mQueues = nullptr;
+            std::vector<ShaderCompileTask> mTasks;
+        };
+        std::vector<PrototypeBuild> builds;
+        builds.reserve(factory.mShaderDatabase.mPrototypes.size());
         for (const auto& [prototypeName, prototype] : factory.mShaderDatabase.mPrototypes) {
             if (prototype.mAssetPath.empty()) {
                 throw std::invalid_argument("shader path not specified in shader graph");
             }
-            auto assetPath = boost::algorithm::to_lower_copy((shaderFolder / prototype.mAssetPath).generic_string());
+            builds.emplace_back(PrototypeBuild{ &prototypeName, &prototype });
+        }
 
+        std::for_each(std::execution::par, builds.begin(), builds.end(), [&](PrototypeBuild& build) {
             ShaderData prototypeData(std::pmr::get_default_resource());
-            prototypeData.mName = prototypeName;
-            buildShaderData(prototype, mShaderModules, factory.mShaderGroups, attrs, prototypeData, false);
+            prototypeData.mName = *build.mName;
+            buildShaderData(*build.mPrototype, mShaderModules, factory.mShaderGroups, attrs, prototypeData, false);
 
             std::ostringstream oss;
             buildShaderText2(oss, prototypeData);
+            build.mContent = oss.str();
+        });
+
+        const ShaderQueueSet unused;
+        for (auto& build : builds) {
+            const auto& prototypeName = *build.mName;
+            auto assetPath = boost::algorithm::to_lower_copy(
+                (shaderFolder / build.mPrototype->mAssetPath).generic_string());
 
             auto res = try_createAsset(assetPath, "shader", mDatabase.mShaderInfo);
 
             auto res2 = mDatabase.mShaderInfo.modify(res.first, [&](ShaderInfo& asset) {
                 if (res.second) {
-                    asset.mShaderName = prototypeData.mName;
+                    asset.mShaderName = build.mPrototype->mName;
                 }
-                asset.mContent = oss.str();
+                asset.mContent = std::move(build.mContent);
             });
             Ensures(res2);
             updateAsset(assetPath, "shader", *res.first);
 
             auto res3 = try_createResource(assetPath, mDatabase.mShaderInfo, mResources.mShaders);
             Ensures(res3.second);
-            auto& prototypeResource = res3.first.second;
-            buildShaderData(prototype, mShaderModules, factory.mShaderGroups, attrs, prototypeResource);
+            build.mResource = &res3.first.second;
+            // variants no content is drawn with are stripped from the runtime data
+            build.mQueues = &unused;
+            auto usageIter = usages.find(prototypeName);
+            if (usageIter != usages.end()) {
+                build.mQueues = &usageIter->second;
+            }
 
             rg.mShaderIndex.emplace(prototypeName, res.first->mMetaID);
         }
+
+        // resources are nodes of the map, they stay in place while the tasks point into them
+        std::for_each(std::execution::par, builds.begin(), builds.end(), [&](PrototypeBuild& build) {
+            buildShaderData(*build.mPrototype, mShaderModules, factory.mShaderGroups, attrs,
+                *build.mResource, build.mTasks, build.mQueues);
+        });
+
+        std::vector<ShaderCompileTask> tasks;
+        for (auto& build : builds) {
+            std::move(build.mTasks.begin(), build.mTasks.end(), std::back_inserter(tasks));
+        }
+        std::vector<double> milliseconds;
+        compileShaderTasks(tasks, &milliseconds);
+        for (size_t i = 0; i != tasks.size(); ++i) {
+            if (milliseconds[i] > 0) {
+                mBuildReport.addAsset("shader compile", tasks[i].mName + " " + tasks[i].mTarget, milliseconds[i]);
+            }
+        }
+    }
+
+    // transitive closure of resources a content draws with, fetched together at runtime
+    DependencyManifest buildDependencyManifest(const ContentData& contentData) const {
+        std::set<std::pair<MetaID, uint32_t>> dependencies;
+        auto addMaterial = [&](const MetaID& materialID) {
+            if (materialID.is_nil())
+                return;
+            dependencies.emplace(materialID, gsl::narrow_cast<uint32_t>(Core::ResourceType(Core::Material).index()));
+            const auto& materialAsset = at(mDatabase.mMaterialInfo, materialID);
+            for (const auto& renderGraph : mResources.mRenderGraphs) {
+                const auto& shaderIndex = renderGraph.second.mShaderIndex;
+                auto iter = shaderIndex.find(materialAsset.mShader);
+                if (iter != shaderIndex.end()) {
+                    dependencies.emplace(iter->second, gsl::narrow_cast<uint32_t>(Core::ResourceType(Core::Shader).index()));
+                }
+            }
+            for (const auto& texture : materialAsset.mTextures) {
+                auto tileIter = mAtlasTiles.find(texture.second);
+                dependencies.emplace(tileIter != mAtlasTiles.end() ? tileIter->second.mAtlas : texture.second,
+                    gsl::narrow_cast<uint32_t>(Core::ResourceType(Core::Texture).index()));
+            }
+        };
+        auto addMesh = [&](const MetaID& meshID) {
+            if (!meshID.is_nil()) {
+                dependencies.emplace(meshID, gsl::narrow_cast<uint32_t>(Core::ResourceType(Core::Mesh).index()));
+            }
+        };
+        for (const auto& dc : contentData.mDrawCalls) {
+            addMesh(dc.mMesh);
+            addMaterial(dc.mMaterial);
+        }
+        for (const auto& object : contentData.mFlattenedObjects) {
+            for (const auto& renderer : object.mMeshRenderers) {
+                addMesh(renderer.mMeshID);
+                for (const auto& materialID : renderer.mMaterialIDs) {
+                    addMaterial(materialID);
+                }
+            }
+        }
+        return DependencyManifest(dependencies.begin(), dependencies.end());
+    }
+
+    // bump when the render graph compiler output changes
+    static constexpr uint32_t sSolutionCacheVersion = 2;
+
+    std::string buildSolutionCacheKey(const Shader::AttributeDatabase& attrs,
+        const RenderGraphData& rg, const RenderSolutionFactory& factory,
+        const RenderSolution& solution
+    ) const {
+        std::ostringstream oss;
+        {
+            boost::archive::binary_oarchive oa(oss);
+            oa << sSolutionCacheVersion;
+            for (const auto& [attrName, attrID] : attrs.mIndex) {
+                oa << attrName;
+                oa << attrID;
+            }
+            for (const auto& [prototypeName, shaderID] : rg.mShaderIndex) {
+                oa << str(prototypeName);
+                oa << at(mDatabase.mShaderInfo, shaderID).mContent;
+            }
+            oa << solution;
+        }
+        factory.outputCacheKey(oss);
+        return oss.str();
+    }
+
+    std::filesystem::path getSolutionCachePath(const std::string& key) const {
+        std::ostringstream oss;
+        oss << std::hex << std::setw(16) << std::setfill('0')
+            << boost::hash<std::string>{}(key) << ".solution";
+        return mLibrary / "star_solutions" / oss.str();
+    }
+
+    bool try_loadSolutionCache(const std::string& key, RenderSolution& solution, std::string& rsg) const {
+        auto filename = getSolutionCachePath(key);
+        if (!exists(filename)) {
+            return false;
+        }
+        try {
+            std::ifstream ifs(filename, std::ios::binary);
+            ifs.exceptions(std::istream::failbit);
+            PmrBinaryInArchive ia(ifs, solution.get_allocator().resource());
+            std::string key0;
+            ia >> key0;
+            if (key0 != key) {
+                return false;
+            }
+            RenderSolution cached(solution.get_allocator());
+            ia >> cached;
+            ia >> rsg;
+            solution = cached;
+        } catch (const std::exception&) {
+            return false;
+        }
+        return true;
+    }
+
+    void saveSolutionCache(const std::string& key, const RenderSolution& solution, const std::string& rsg) const {
+        auto filename = getSolutionCachePath(key);
+        if (!exists(filename.parent_path())) {
+            create_directories(filename.parent_path());
+        }
+        std::ostringstream oss;
+        {
+            boost::archive::binary_oarchive oa(oss);
+            oa << key;
+            oa << solution;
+            oa << rsg;
+        }
+        updateBinary(filename, oss.str());
+    }
+
+    std::filesystem::path getAssetPackPath() const {
+        return mLibrary / "star_assets.pak";
+    }
+
+    void openAssetPack() {
+        mPack.reset();
+        auto filename = getAssetPackPath();
+        if (exists(filename)) {
+            mPack = std::make_unique<AssetPack>(filename);
+        }
+    }
+
+    std::filesystem::path getLibraryPath(const MetaID& metaID, uint32_t type) const {
+        std::filesystem::path filename;
+        auto find = [&](const auto& info) {
+            auto iter = info.find(metaID);
+            if (iter != info.end()) {
+                filename = mLibrary / iter->mName;
+            }
+        };
+        visit(overload(
+            [&](Core::Mesh_) {
+                find(mDatabase.mMeshInfo);
+            },
+            [&](Core::Texture_) {
+                find(mDatabase.mTextureInfo);
+                if (!filename.empty()) {
+                    filename.replace_extension(".dds");
+                }
+            },
+            [&](Core::Shader_) {
+                find(mDatabase.mShaderInfo);
+            },
+            [&](Core::Material_) {
+                find(mDatabase.mMaterialInfo);
+            },
+            [&](Core::Content_) {
+                find(mDatabase.mContentInfo);
+            },
+            [&](Core::RenderGraph_) {
+                find(mDatabase.mRenderGraphInfo);
+            }
+        ), getResourceType(type));
+        return filename;
+    }
+
+    // every content is followed by its dependencies in manifest order, which is the order they are requested,
+    // resources no content references are appended at the end
+    std::vector<AssetPackSource> collectAssetPackSources() const {
+        std::vector<AssetPackSource> sources;
+        auto typeIndex = [](Core::ResourceType type) {
+            return gsl::narrow_cast<uint32_t>(type.index());
+        };
+        // raw vertex data and BCn mips dominate the pack and compress well
+        auto add = [&](const MetaID& metaID, uint32_t type) {
+            auto filename = getLibraryPath(metaID, type);
+            if (!filename.empty()) {
+                const bool compress = type == typeIndex(Core::Mesh) || type == typeIndex(Core::Texture);
+                sources.emplace_back(AssetPackSource{ metaID, type, std::move(filename), compress });
+            }
+        };
+        for (const auto& renderGraphAsset : mDatabase.mRenderGraphInfo) {
+            add(renderGraphAsset.mMetaID, typeIndex(Core::RenderGraph));
+        }
+        for (const auto& contentAsset : mDatabase.mContentInfo) {
+            add(contentAsset.mMetaID, typeIndex(Core::Content));
+            auto iter = mResources.mContents.find(contentAsset.mMetaID);
+            if (iter == mResources.mContents.end()) {
+                continue;
+            }
+            for (const auto& [metaID, type] : buildDependencyManifest(iter->second)) {
+                add(metaID, type);
+            }
+        }
+        for (const auto& shaderAsset : mDatabase.mShaderInfo) {
+            add(shaderAsset.mMetaID, typeIndex(Core::Shader));
+        }
+        for (const auto& materialAsset : mDatabase.mMaterialInfo) {
+            add(materialAsset.mMetaID, typeIndex(Core::Material));
+        }
+        for (const auto& meshAsset : mDatabase.mMeshInfo) {
+            add(meshAsset.mMetaID, typeIndex(Core::Mesh));
+        }
+        for (const auto& textureAsset : mDatabase.mTextureInfo) {
+            add(textureAsset.mMetaID, typeIndex(Core::Texture));
+        }
+        return sources;
+    }
+
+    // bump when the build database layout changes
+    static constexpr uint32_t sBuildDatabaseVersion = 1;
+    // bump when the fbx or texture import output changes
+    static constexpr uint32_t sMeshImportVersion = 2;
+    static constexpr uint32_t sTextureImportVersion = 1;
+
+    static uint64_t hashContent(std::string_view content) noexcept {
+        return std::hash<std::string_view>{}(content);
+    }
+
+    template<class... Args>
+    static uint64_t hashSettings(const Args&... args) {
+        std::ostringstream oss;
+        {
+            boost::archive::binary_oarchive oa(oss);
+            (oa << ... << args);
+        }
+        return hashContent(oss.str());
+    }
+
+    std::filesystem::path getBuildDatabasePath() const {
+        return mLibrary / "star_build.db";
+    }
+
+    void clearBuildCaches() {
+        // the shared shader cache is left alone, other machines fill it
+        std::error_code ec;
+        std::filesystem::remove(getBuildDatabasePath(), ec);
+        std::filesystem::remove_all(mLibrary / "star_shader_cache", ec);
+        std::filesystem::remove_all(mLibrary / "star_solutions", ec);
+        std::filesystem::remove_all(mLibrary / "star_asset_info", ec);
+        mBuildDatabase.mRecords.clear();
+    }
+
+    void loadBuildDatabase() {
+        mBuildDatabase.mRecords.clear();
+        auto filename = getBuildDatabasePath();
+        if (!exists(filename)) {
+            return;
+        }
+        try {
+            std::ifstream ifs(filename, std::ios::binary);
+            ifs.exceptions(std::istream::failbit);
+            boost::archive::binary_iarchive ia(ifs);
+            uint32_t version = 0;
+            ia >> version;
+            if (version != sBuildDatabaseVersion) {
+                return;
+            }
+            ia >> mBuildDatabase;
+        } catch (const std::exception&) {
+            mBuildDatabase.mRecords.clear();
+        }
+    }
+
+    void saveBuildDatabase() const {
+        std::ostringstream oss;
+        {
+            boost::archive::binary_oarchive oa(oss);
+            oa << sBuildDatabaseVersion;
+            oa << mBuildDatabase;
+        }
+        updateBinary(getBuildDatabasePath(), oss.str());
+    }
+
+    // inputs match the last build and the output is still the one written by it,
+    // the output content is returned for assets that need it loaded back
+    bool isUpToDate(std::string_view key, const BuildRecord& record,
+        const std::filesystem::path& output, std::string* outputContent = nullptr
+    ) const {
+        auto iter = mBuildDatabase.mRecords.find(key);
+        if (iter == mBuildDatabase.mRecords.end()) {
+            return false;
+        }
+        const auto& prev = iter->second;
+        if (prev.mSourceHash != record.mSourceHash || prev.mSettingsHash != record.mSettingsHash) {
+            return false;
+        }
+        if (!exists(output)) {
+            return false;
+        }
+        auto content = readBinary(output);
+        if (hashContent(content) != prev.mOutputHash) {
+            return false;
+        }
+        if (outputContent) {
+            *outputContent = std::move(content);
+        }
+        return true;
+    }
+
+    // records of this build, replaces the loaded database once the build is done
+    void recordBuild(BuildDatabase& next, std::string_view key, const BuildRecord& record) {
+        std::lock_guard<std::mutex> lock(mBuildMutex);
+        next.mRecords.insert_or_assign(std::string(key), record);
+    }
+
+    static TextureImportSettings getTextureImportSettings(std::string_view name) {
+        TextureImportSettings settings;
+        settings.mNormalMap = boost::algorithm::contains(name, "normal");
+        settings.mAlphaCoverage = boost::algorithm::contains(name, "albedo") ||
+            boost::algorithm::contains(name, "diffuse") ||
+            boost::algorithm::contains(name, "basecolor");
+        return settings;
+    }
+
+    // textureData is left empty for unknown image types
+    void importTexture(const TextureInfo& textureAsset, const TextureImportSettings& settings,
+        TextureData& textureData
+    ) const {
+        std::filesystem::path name(textureAsset.mName);
+        if (boost::algorithm::iequals(name.extension().string(), ".png")) {
+            std::ifstream ifs(mFolder / textureAsset.mName, std::ios::binary);
+            ifs.exceptions(std::istream::failbit);
+            loadPNG(ifs, std::pmr::get_default_resource(), settings, textureData);
+        } else if (boost::algorithm::iequals(name.extension().string(), ".jpg")) {
+            std::ifstream ifs(mFolder / textureAsset.mName, std::ios::binary);
+            ifs.exceptions(std::istream::failbit);
+            loadJPG(ifs, std::pmr::get_default_resource(), settings, textureData);
+        } else if (boost::algorithm::iequals(name.extension().string(), ".exr")) {
+            loadEXR(mFolder / textureAsset.mName, std::pmr::get_default_resource(), settings, textureData);
+        } else if (boost::algorithm::iequals(name.extension().string(), ".tga")) {
+            std::ifstream ifs(mFolder / textureAsset.mName, std::ios::binary);
+            ifs.exceptions(std::istream::failbit);
+            loadTGA(ifs, std::pmr::get_default_resource(), settings, textureData);
+        }
+    }
+
+    // returns true if the library dds was written, called concurrently by build
+    bool buildTexture(const TextureInfo& textureAsset, BuildDatabase& nextBuild) {
+        TextureData textureData(std::pmr::get_default_resource());
+
+        std::filesystem::path name(textureAsset.mName);
+        const auto settings = getTextureImportSettings(textureAsset.mName);
+
+        auto filename = mLibrary / name;
+        filename.replace_extension(".dds");
+        BuildRecord record{
+            hashContent(readBinary(mFolder / name)),
+            hashSettings(sTextureImportVersion, settings),
+            0
+        };
+        if (isUpToDate(textureAsset.mName, record, filename)) {
+            recordBuild(nextBuild, textureAsset.mName, at(mBuildDatabase.mRecords, textureAsset.mName));
+            return false;
+        }
+
+        importTexture(textureAsset, settings, textureData);
+        if (!textureData.mBuffer.empty()) {
+            BuildTimer timer;
+            std::ostringstream oss;
+            saveDDS(oss, textureData);
+            mBuildReport.addAsset("dds encode", textureAsset.mName, timer.elapsed());
+            if (!exists(filename.parent_path())) {
+                create_directories(filename.parent_path());
+            }
+            auto content = oss.str();
+            updateBinary(filename, content);
+            record.mOutputHash = hashContent(content);
+            recordBuild(nextBuild, textureAsset.mName, record);
+            return true;
+        }
+        return false;
+    }
+
+    // rebuilt textures are read from the library, their packed copies are stale
+    bool rebuildTexture(std::string_view assetPath) {
+        const auto& index = mDatabase.mTextureInfo.get<Index::Name>();
+        auto iter = index.find(sv(getAssetName(assetPath)));
+        if (iter == index.end() || !buildTexture(*iter, mBuildDatabase))
+            return false;
+        saveBuildDatabase();
+        mRebuilt.emplace(iter->mMetaID);
+        return true;
+    }
+
+    // offsets of the material constants of a shader by attribute id, and the size of its material constant buffer
+    struct MaterialConstantLayout {
+        std::map<uint32_t, uint32_t> mOffsets;
+        uint32_t mSize = 0;
+    };
+
+    std::map<std::string_view, MaterialConstantLayout> collectMaterialConstantLayouts() const {
+        std::map<std::string_view, MaterialConstantLayout> layouts;
+        for (const auto& [metaID, shaderData] : mResources.mShaders) {
+            auto& layout = layouts[sv(shaderData.mName)];
+            visitShaderSubpassData(shaderData, [&](const ShaderSubpassData& pass) {
+                for (const auto& cb : pass.mConstantBuffers) {
+                    for (const auto& constant : cb.mConstants) {
+                        if (!std::holds_alternative<MaterialSource_>(constant.mSource))
+                            continue;
+                        layout.mOffsets.try_emplace(constant.mID, constant.mOffset);
+                        layout.mSize = std::max(layout.mSize, cb.mSize);
+                    }
+                }
+            });
+        }
+        return layouts;
+    }
+
+    static void setMaterialConstant(const MaterialConstantLayout& layout, uint32_t id,
+        const Vector4f& value, ConstantMap& constants
+    ) {
+        auto iter = layout.mOffsets.find(id);
+        if (iter == layout.mOffsets.end())
+            return;
+        if (constants.mBuffer.empty()) {
+            constants.mBuffer.resize_aligned(layout.mSize);
+        }
+        Expects(iter->second + sizeof(Vector4f) <= constants.mBuffer.size());
+        std::memcpy(constants.mBuffer.data() + iter->second, value.data(), sizeof(Vector4f));
+        constants.mIndex.insert_or_assign(id,
+            ConstantDescriptor{ gsl::narrow<uint16_t>(iter->second), gsl::narrow<uint16_t>(sizeof(Vector4f)) });
+    }
+
+    // small textures whose every material remaps their uvs through a <texture>_ST material constant
+    // are packed into atlases of the same format, size and mips, written under star_texture_atlases.
+    // tiles are imported again, an atlas is named after its first tile so rebuilds keep its metaID
+    void buildTextureAtlases(const AttributeDatabase& attributes,
+        const std::map<std::string_view, MaterialConstantLayout>& layouts
+    ) {
+        mAtlasTiles.clear();
+        mDependencyManifests.clear();
+        if (mAtlasMaxDimension == 0)
+            return;
+
+        // a texture is packed only if no material samples it without the transform
+        MetaIDUnorderedMap<bool> packable;
+        for (const auto& materialAsset : mDatabase.mMaterialInfo) {
+            auto layoutIter = layouts.find(materialAsset.mShader);
+            for (const auto& [attrName, texID] : materialAsset.mTextures) {
+                bool remapped = false;
+                auto iter = attributes.mIndex.find(attrName + "_ST");
+                if (iter != attributes.mIndex.end() && layoutIter != layouts.end()) {
+                    remapped = layoutIter->second.mOffsets.count(iter->second) != 0;
+                }
+                auto res = packable.try_emplace(texID, remapped);
+                res.first->second = res.first->second && remapped;
+            }
+        }
+        std::vector<const TextureInfo*> candidates;
+        for (const auto& [texID, remapped] : packable) {
+            auto iter = mDatabase.mTextureInfo.find(texID);
+            if (remapped && iter != mDatabase.mTextureInfo.end() && !mTextureAtlases.count(texID)) {
+                candidates.emplace_back(&*iter);
+            }
+        }
+        // grouped in name order, atlases do not depend on hashing
+        std::sort(candidates.begin(), candidates.end(), [](const TextureInfo* lhs, const TextureInfo* rhs) {
+            return lhs->mName < rhs->mName;
+        });
+
+        std::pmr::vector<TextureData> textures(std::pmr::get_default_resource());
+        std::vector<size_t> textureIDs(candidates.size());
+        textures.reserve(candidates.size());
+        for (size_t i = 0; i != candidates.size(); ++i) {
+            textures.emplace_back();
+            textureIDs[i] = i;
+        }
+        std::for_each(std::execution::par, textureIDs.begin(), textureIDs.end(), [&](size_t i) {
+            importTexture(*candidates[i], getTextureImportSettings(candidates[i]->mName), textures[i]);
+        });
+
+        std::vector<std::vector<size_t>> groups;
+        for (size_t i = 0; i != textures.size(); ++i) {
+            const auto& desc = textures[i].mDesc;
+            if (textures[i].mBuffer.empty() || desc.mWidth > mAtlasMaxDimension || desc.mHeight > mAtlasMaxDimension)
+                continue;
+            auto iter = std::find_if(groups.begin(), groups.end(), [&](const std::vector<size_t>& group) {
+                return isAtlasCompatible(textures[group.front()], textures[i]);
+            });
+            if (iter == groups.end()) {
+                if (isAtlasCompatible(textures[i], textures[i])) {
+                    groups.emplace_back().emplace_back(i);
+                }
+            } else {
+                iter->emplace_back(i);
+            }
+        }
+
+        size_t atlasCount = 0;
+        for (const auto& group : groups) {
+            const size_t capacity = std::max(getAtlasTileCapacity(textures[group.front()], sTextureAtlasDimension), 1u);
+            for (size_t first = 0; first < group.size(); first += capacity) {
+                const auto count = std::min(capacity, group.size() - first);
+                if (count < 2)
+                    continue;
+                std::vector<const TextureData*> tiles;
+                tiles.reserve(count);
+                for (size_t k = 0; k != count; ++k) {
+                    tiles.emplace_back(&textures[group[first + k]]);
+                }
+                TextureData atlas(std::pmr::get_default_resource());
+                std::vector<Vector4f> transforms;
+                buildTextureAtlas(tiles, atlas, transforms);
+
+                // loaded as srgb unless named like a normal map, as the tiles were
+                const auto* pFirst = candidates[group[first]];
+                boost::uuids::name_generator_latest gen(pFirst->mMetaID);
+                const auto atlasID = gen("texture_atlas/" + std::to_string(count));
+                std::ostringstream oss;
+                oss << "star_texture_atlases/" << atlasID
+                    << (boost::algorithm::contains(pFirst->mName, "normal") ? "_normal" : "") << ".dds";
+                const auto name = oss.str();
+                if (mDatabase.mTextureInfo.find(atlasID) == mDatabase.mTextureInfo.end()) {
+                    mDatabase.mTextureInfo.emplace(TextureInfo{ atlasID, name });
+                }
+                mTextureAtlases.emplace(atlasID);
+
+                std::ostringstream dds;
+                saveDDS(dds, atlas);
+                auto filename = mLibrary / name;
+                if (!exists(filename.parent_path())) {
+                    create_directories(filename.parent_path());
+                }
+                updateBinary(filename, dds.str());
+
+                for (size_t k = 0; k != count; ++k) {
+                    mAtlasTiles.emplace(candidates[group[first + k]]->mMetaID, AtlasTile{ atlasID, transforms[k] });
+                }
+                ++atlasCount;
+            }
+        }
+        S_INFO << mAtlasTiles.size() << " textures packed into " << atlasCount << " atlases";
+    }
+
+    // shaders rewritten in the library by another build are read from it again, their packed copies are stale
+    void processLibraryChanges(std::vector<MetaID>& rebuiltShaders) {
+        if (!mLibraryWatcher) {
+            return;
+        }
+        std::vector<std::string> changes;
+        if (!mLibraryWatcher->poll(changes)) {
+            S_WARNING << "library watcher overflowed, shaders changed meanwhile are not reloaded";
+        }
+        const auto& index = mDatabase.mShaderInfo.get<Index::Name>();
+        for (const auto& name : changes) {
+            auto iter = index.find(sv(name));
+            if (iter == index.end())
+                continue;
+            mRebuilt.emplace(iter->mMetaID);
+            rebuiltShaders.emplace_back(iter->mMetaID);
+        }
     }
 public:
     void cleanup() const {
@@ -555,7 +1415,9 @@ public:
 
     void scan() {
         Expects(std::this_thread::get_id() == mThreadID);
+        STAR_STARTUP_SCOPE("asset scan");
         readAllAssetInfo();
+        openAssetPack();
     }
 
     void processAssets() {
@@ -563,7 +1425,20 @@ public:
     }
 
     void build() {
+        STAR_PROFILE_SCOPE("AssetFactory::build");
+        // stages are timed in sequence, assets by the threads building them
+        mBuildReport.clear();
+        BuildReport::setActive(&mBuildReport);
+        ON_SCOPE_EXIT(deactivateReport, []() {
+            BuildReport::setActive(nullptr);
+        });
+        BuildTimer stageTimer;
+
+        loadBuildDatabase();
+        BuildDatabase nextBuild;
+
         updateResource("settings.star", mResources.mSettings);
+        setShaderCache(mLibrary / "star_shader_cache", mSharedShaderCache);
 
         // build shader attributes
         Shader::AttributeDatabase attributes;
@@ -575,14 +1450,16 @@ public:
             auto id = attributes.mIndex.size();
             attributes.mIndex.emplace(attr.mName, gsl::narrow<uint32_t>(id));
         }
+        mBuildReport.addStage("attribute database", stageTimer.lap());
 
         // build render graph and shaders
+        const auto usages = collectShaderUsages();
         for (const auto& renderGraphInfo : mDatabase.mRenderGraphInfo) {
             auto& renderGraphData = mResources.mRenderGraphs.at(renderGraphInfo.mMetaID);
             auto& renderSwapChain = renderGraphData.mRenderGraph;
             
             const auto& rg = at(mRenderGraphs, renderGraphInfo.mName);
-            createShaders(rg, attributes, renderGraphData);
+            createShaders(rg, attributes, renderGraphData, usages);
 
             renderSwapChain.mNumBackBuffers = 3;
 
@@ -595,7 +1472,16 @@ public:
                 if (count++)
                     oss << "\n";
 
-                factory.build(attributes, solutionName, solutionData, oss);
+                // unchanged solutions are loaded from the cache instead of recompiled
+                auto key = buildSolutionCacheKey(attributes, renderGraphData, factory, solutionData);
+                std::string rsg;
+                if (!try_loadSolutionCache(key, solutionData, rsg)) {
+                    std::ostringstream rsgOss;
+                    factory.build(attributes, solutionName, solutionData, rsgOss);
+                    rsg = rsgOss.str();
+                    saveSolutionCache(key, solutionData, rsg);
+                }
+                oss << rsg;
                 fileRSG.replace_extension(".rsg");
                 renderSwapChain.mNumReserveFramebuffers = std::max(renderSwapChain.mNumReserveFramebuffers, gsl::narrow<uint32_t>(solutionData.mFramebuffers.size()));
                 renderSwapChain.mNumReserveCBV_SRV_UAVs = std::max(renderSwapChain.mNumReserveCBV_SRV_UAVs,
@@ -607,41 +1493,168 @@ public:
 
             updateResource(renderGraphInfo.mName, mResources.mRenderGraphs.at(renderGraphInfo.mMetaID));
         }
+        mBuildReport.addStage("render graph and shaders", stageTimer.lap());
 
         auto meshFolder = mLibrary / "star_meshes";
         if (!mDatabase.mMeshInfo.empty()) {
             create_directories(meshFolder);
         }
-        for (const auto& meshAsset : mDatabase.mMeshInfo) {
-            auto iter = mResources.mMeshes.find(meshAsset.mMetaID);
-            if (iter == mResources.mMeshes.end()) {
+        // every fbx with meshes not imported yet is read once, scenes are imported in parallel
+        std::vector<const FbxInfo*> fbxFiles;
+        {
+            std::unordered_set<const FbxInfo*> visited;
+            for (const auto& meshAsset : mDatabase.mMeshInfo) {
+                if (mResources.mMeshes.count(meshAsset.mMetaID))
+                    continue;
+                // static batches not instantiated this session keep their last output
+                if (!meshAsset.mFbx)
+                    continue;
+                if (visited.emplace(meshAsset.mFbx).second) {
+                    fbxFiles.emplace_back(meshAsset.mFbx);
+                }
+            }
+        }
+        auto getMeshKey = [](const MetaID& metaID) {
+            std::ostringstream oss;
+            oss << "star_meshes/" << metaID << ".mesh";
+            return oss.str();
+        };
+        std::vector<PmrMetaIDUnorderedMap<MeshData>> imported;
+        std::vector<size_t> fbxIDs;
+        // fbx files whose meshes were loaded back from the last build
+        std::vector<char> upToDate(fbxFiles.size(), false);
+        std::vector<BuildRecord> fbxRecords(fbxFiles.size());
+        imported.reserve(fbxFiles.size());
+        fbxIDs.reserve(fbxFiles.size());
+        for (size_t i = 0; i != fbxFiles.size(); ++i) {
+            imported.emplace_back(std::pmr::get_default_resource());
+            fbxIDs.emplace_back(i);
+        }
+        const auto meshSettingsHash = hashSettings(sMeshImportVersion,
+            std::string("StaticMeshCompact"), mResources.mSettings);
+        std::for_each(std::execution::par, fbxIDs.begin(), fbxIDs.end(),
+            [&](size_t fbxID) {
+                const auto* pFbx = fbxFiles[fbxID];
+                auto filePath = (mFolder / pFbx->mName).generic_string();
+                auto& record = fbxRecords[fbxID];
+                record = BuildRecord{ hashContent(readBinary(mFolder / pFbx->mName)), meshSettingsHash, 0 };
+
+                // every mesh of the fbx must still match its output, otherwise the scene is imported again
+                auto& meshes = imported[fbxID];
+                bool loaded = !pFbx->mMeshes.empty();
+                for (const auto& meshID : pFbx->mMeshes) {
+                    auto key = getMeshKey(meshID);
+                    std::string content;
+                    if (!isUpToDate(key, record, mLibrary / key, &content)) {
+                        loaded = false;
+                        break;
+                    }
+                    auto& meshData = meshes.try_emplace(meshID).first->second;
+                    loadMeshFile(reinterpret_cast<const std::byte*>(content.data()), content.size(), meshData);
+                }
+                if (loaded) {
+                    upToDate[fbxID] = true;
+                    for (const auto& meshID : pFbx->mMeshes) {
+                        recordBuild(nextBuild, getMeshKey(meshID), at(mBuildDatabase.mRecords, getMeshKey(meshID)));
+                    }
+                    return;
+                }
+                meshes.clear();
+
+                BuildTimer timer;
                 AssetFbxImporter importer{};
-                Expects(meshAsset.mFbx);
-                auto fbxPath = meshAsset.mFbx->mName;
-                auto filePath = (mFolder / fbxPath).generic_string();
                 auto pScene = importer.read(filePath);
-                AssetFbxScene fbx(std::move(pScene), meshAsset.mFbx->mMetaID, mFolder, filePath);
-                fbx.readMeshes("StaticMesh", mResources);
+                AssetFbxScene fbx(std::move(pScene), pFbx->mMetaID, mFolder, filePath);
+                fbx.readMeshes("StaticMeshCompact", mResources.mSettings, meshes);
+                mBuildReport.addAsset("fbx import", pFbx->mName, timer.elapsed());
+            });
+        // meshes loaded back are not written again
+        MetaIDUnorderedSet loadedMeshes;
+        MetaIDUnorderedMap<BuildRecord> meshRecords;
+        for (size_t i = 0; i != fbxFiles.size(); ++i) {
+            for (const auto& [metaID, meshData] : imported[i]) {
+                if (upToDate[i]) {
+                    loadedMeshes.emplace(metaID);
+                } else {
+                    meshRecords.emplace(metaID, fbxRecords[i]);
+                }
+            }
+        }
+        // merged in database order, metaIDs do not depend on scheduling
+        for (auto& meshes : imported) {
+            for (auto& [metaID, meshData] : meshes) {
+                auto res = mResources.mMeshes.emplace(metaID, std::move(meshData));
+                if (!res.second) {
+                    throw std::runtime_error("mesh name uuid collision");
+                }
             }
+        }
 
-            std::filesystem::path filename;
-            {
+        std::for_each(std::execution::par,
+            mDatabase.mMeshInfo.begin(),
+            mDatabase.mMeshInfo.end(),
+            [&](const MeshInfo& meshAsset) {
+                if (loadedMeshes.count(meshAsset.mMetaID)) {
+                    return;
+                }
+                if (!meshAsset.mFbx && !mResources.mMeshes.count(meshAsset.mMetaID)) {
+                    return;
+                }
+                auto key = getMeshKey(meshAsset.mMetaID);
+                auto iter = meshRecords.find(meshAsset.mMetaID);
+                auto filename = mLibrary / key;
+                const auto& meshData = mResources.mMeshes.at(meshAsset.mMetaID);
                 std::ostringstream oss;
-                oss << meshAsset.mMetaID << ".mesh";
-                filename = meshFolder / oss.str();
+                saveMeshFile(oss, meshData);
+                auto content = oss.str();
+                updateBinary(filename, content);
+                if (iter != meshRecords.end()) {
+                    auto record = iter->second;
+                    record.mOutputHash = hashContent(content);
+                    recordBuild(nextBuild, key, record);
+                }
             }
-            const auto& meshData = mResources.mMeshes.at(meshAsset.mMetaID);
-            std::ostringstream oss;
-            boost::archive::binary_oarchive oa(oss);
-            oa << meshData;
-            updateBinary(filename, oss.str());
-        }
+        );
+        mBuildReport.addStage("mesh import", stageTimer.lap());
 
         std::map<std::string, std::map<std::string, uint32_t>, std::less<>> shaderVertexLayouts;
 
+        std::map<MetaID, Aabb3f> meshBounds;
         for (const auto& contentAsset : mDatabase.mContentInfo) {
-            const auto& contentData = mResources.mContents.at(contentAsset.mMetaID);
-            updateResource(contentAsset.mName, contentData);
+            auto& contentData = mResources.mContents.at(contentAsset.mMetaID);
+            // renderer bounds feed the culling hierarchy, objects without mesh are never culled
+            for (auto& object : contentData.mFlattenedObjects) {
+                for (size_t i = 0; i != object.mMeshRenderers.size(); ++i) {
+                    const auto& meshID = object.mMeshRenderers[i].mMeshID;
+                    auto& bounds = object.mBoundingBoxes[i];
+                    bounds = BoundingBox{};
+
+                    auto meshIter = mResources.mMeshes.find(meshID);
+                    if (meshIter == mResources.mMeshes.end())
+                        continue;
+                    auto boundsIter = meshBounds.find(meshID);
+                    if (boundsIter == meshBounds.end()) {
+                        boundsIter = meshBounds.emplace(meshID, getMeshBounds(meshIter->second)).first;
+                    }
+                    const auto& local = boundsIter->second;
+                    if (!local.valid())
+                        continue;
+
+                    bounds.mLocalBounds = local;
+                    bounds.mWorldBounds = local.transformed(object.mWorldTransforms[i].mTransform);
+                }
+                buildBvh(object);
+            }
+            {
+                auto filename = mLibrary / contentAsset.mName;
+                if (!exists(filename.parent_path())) {
+                    create_directories(filename.parent_path());
+                }
+                std::ostringstream oss;
+                saveContentFile(oss, contentData);
+                updateBinary(filename, oss.str());
+            }
+            updateResource(contentAsset.mName + ".deps", buildDependencyManifest(contentData));
 
             auto addShader = [this, &shaderVertexLayouts](const MetaID& mesh, const MetaID& material) {
                 const auto& materialAsset = at(mDatabase.mMaterialInfo, material);
@@ -676,7 +1689,12 @@ public:
                 }
             }
         }
+        mBuildReport.addStage("content", stageTimer.lap());
 
+        // bytecode goes to the blob file, shaders in memory keep theirs for this process
+        // the blob file is written first, a running engine reloads the shader files as they change
+        ShaderBlobWriter shaderBlobs;
+        std::vector<std::pair<std::string_view, std::unique_ptr<ShaderData>>> storedShaders;
         for (const auto& shaderAsset : mDatabase.mShaderInfo) {
             auto shaderIter = mResources.mShaders.find(shaderAsset.mMetaID);
             if (shaderIter == mResources.mShaders.end()) {
@@ -693,69 +1711,156 @@ public:
                     }
                 });
             }
+            // pso descs of the render graph the shader was built for, runtime only converts them
+            for (const auto& [renderGraphID, renderGraphData] : mResources.mRenderGraphs) {
+                auto shaderIter = renderGraphData.mShaderIndex.find(shaderData.mName);
+                if (shaderIter != renderGraphData.mShaderIndex.end() && shaderIter->second == shaderAsset.mMetaID) {
+                    buildPipelineStates(renderGraphData.mRenderGraph, mResources.mSettings, shaderData);
+                    break;
+                }
+            }
 
-            updateResource(shaderAsset.mName, shaderData);
+            auto& storedData = *storedShaders.emplace_back(shaderAsset.mName,
+                std::make_unique<ShaderData>(shaderData, std::pmr::get_default_resource())).second;
+            visitShaderSubpassData(storedData, [&](ShaderSubpassData& pass) {
+                shaderBlobs.add(pass.mProgram);
+            });
         }
-                
+        updateBinary(mLibrary / sShaderBlobFileName, shaderBlobs.data());
+        for (const auto& [name, storedData] : storedShaders) {
+            updateResource(name, *storedData);
+        }
+        mBuildReport.addStage("shader binding", stageTimer.lap());
+
+        const auto materialLayouts = collectMaterialConstantLayouts();
+        buildTextureAtlases(attributes, materialLayouts);
+        mBuildReport.addStage("texture atlases", stageTimer.lap());
+
         for (const auto& materialAsset : mDatabase.mMaterialInfo) {
             MaterialData materialData(std::pmr::get_default_resource());
             materialData.mShader = materialAsset.mShader;
             materialData.mTextures.reserve(materialAsset.mTextures.size());
+            auto layoutIter = materialLayouts.find(materialAsset.mShader);
             for (const auto& texID : materialAsset.mTextures) {
+                auto tileIter = mAtlasTiles.find(texID.second);
+                const bool packed = tileIter != mAtlasTiles.end();
                 auto iter = attributes.mIndex.find(texID.first);
                 if (iter != attributes.mIndex.end()) {
                     const auto& id = iter->second;
-                    materialData.mTextures.emplace(id, texID.second);
+                    materialData.mTextures.emplace(id, packed ? tileIter->second.mAtlas : texID.second);
+                }
+                // textures outside atlases sample their whole range
+                auto stIter = attributes.mIndex.find(texID.first + "_ST");
+                if (stIter != attributes.mIndex.end() && layoutIter != materialLayouts.end()) {
+                    setMaterialConstant(layoutIter->second, stIter->second,
+                        packed ? tileIter->second.mTransform : Vector4f(1, 1, 0, 0), materialData.mConstantMap);
                 }
             }
             updateResource(materialAsset.mName, materialData);
         }
-        TextureImportSettings settings;
-        std::for_each(std::execution::par_unseq,
+        mBuildReport.addStage("materials", stageTimer.lap());
+
+        std::for_each(std::execution::par,
             mDatabase.mTextureInfo.begin(),
             mDatabase.mTextureInfo.end(),
-            [this, &settings](const TextureInfo& textureAsset){
-                TextureData textureData(std::pmr::get_default_resource());
-
-                std::filesystem::path name(textureAsset.mName);
-                if (boost::algorithm::iequals(name.extension().string(), ".png")) {
-                    std::ifstream ifs(mFolder / textureAsset.mName, std::ios::binary);
-                    ifs.exceptions(std::istream::failbit);
-                    loadPNG(ifs, std::pmr::get_default_resource(), settings, textureData);
-                } else if (boost::algorithm::iequals(name.extension().string(), ".tga")) {
-                    std::ifstream ifs(mFolder / textureAsset.mName, std::ios::binary);
-                    ifs.exceptions(std::istream::failbit);
-                    loadTGA(ifs, std::pmr::get_default_resource(), settings, textureData);
-                }
-                if (!textureData.mBuffer.empty()) {
-                    std::ostringstream oss;
-                    saveDDS(oss, textureData);
-                    auto filename = mLibrary / name;
-                    filename.replace_extension(".dds");
-                    if (!exists(filename.parent_path())) {
-                        create_directories(filename.parent_path());
-                    }
-                    updateBinary(filename, oss.str());
+            [this, &nextBuild](const TextureInfo& textureAsset) {
+                // atlases are written by buildTextureAtlases
+                if (!mTextureAtlases.count(textureAsset.mMetaID)) {
+                    buildTexture(textureAsset, nextBuild);
                 }
             }
         );
+        mBuildReport.addStage("textures", stageTimer.lap());
+
+        // assets removed since the last build drop out of the database
+        mBuildDatabase = std::move(nextBuild);
+        saveBuildDatabase();
+
+        mPack.reset();
+        writeAssetPack(getAssetPackPath(), collectAssetPackSources());
+        openAssetPack();
+        mRebuilt.clear();
+        mBuildReport.addStage("asset pack", stageTimer.lap());
+
+        std::ostringstream report;
+        mBuildReport.writeText(report);
+        S_INFO << report.str();
+        std::ofstream json(mLibrary / "star_build_report.json");
+        mBuildReport.writeJson(json);
     }
 
+    // the asset list of the last scan is reused, the folder is only walked without one
     void processAllAssets() {
-        std::string_view extMeta(".meta");
-        for (const auto& p0 : std::filesystem::recursive_directory_iterator(mFolder)) {
-            auto p = std::filesystem::path(boost::algorithm::to_lower_copy(p0.path().string()));
-            const auto& ext = p.extension().string();
-            if (boost::algorithm::iequals(ext, extMeta)) {
-                auto filepath = p;
-                filepath.replace_extension("");
-                if (!exists(filepath)) {
+        const auto names = mScannedAssets.empty() ? enumerateAssets() : mScannedAssets;
+        for (const auto& name : names) {
+            auto filepath = mFolder / name;
+            if (!exists(filepath)) {
+                continue;
+            }
+            processAsset(name, filepath.extension().string());
+        }
+    }
+
+    void watch() {
+        Expects(std::this_thread::get_id() == mThreadID);
+        if (!mWatcher) {
+            mWatcher = std::make_unique<AssetWatcher>(mFolder);
+        }
+        if (!mLibraryWatcher) {
+            mLibraryWatcher = std::make_unique<AssetWatcher>(mLibrary);
+        }
+    }
+
+    // changed meta files are read again, new assets are added to the database,
+    // removed and renamed assets are left to the next scan
+    // changed textures are built again, their ids are appended to rebuilt.mTextures
+    size_t processChanges(AssetChanges& rebuilt) {
+        Expects(std::this_thread::get_id() == mThreadID);
+        if (!mWatcher) {
+            return 0;
+        }
+        processLibraryChanges(rebuilt.mShaders);
+
+        std::vector<std::string> changes;
+        if (!mWatcher->poll(changes)) {
+            // changes were lost, every scanned asset is processed again
+            S_WARNING << "asset watcher overflowed, processing all assets";
+            processAllAssets();
+            return mScannedAssets.size();
+        }
+
+        std::set<std::string> assets;
+        for (auto& name : changes) {
+            if (boost::algorithm::ends_with(name, ".meta")) {
+                name.resize(name.size() - std::string_view(".meta").size());
+            }
+            assets.emplace(std::move(name));
+        }
+
+        size_t count = 0;
+        for (const auto& name : assets) {
+            auto filepath = mFolder / name;
+            auto metaPath = filepath;
+            metaPath += ".meta";
+            if (!isAsset(filepath.extension()) || !exists(filepath) || !exists(metaPath)) {
+                continue;
+            }
+            if (!mMetaIDs.count(name)) {
+                auto [metaID, succeeded] = try_readMetaIDFile(metaPath);
+                if (!succeeded || mUnique.count(metaID)) {
                     continue;
                 }
-                auto name = getAssetNameFromFullPath(filepath, mFolder);
-                processAsset(name, filepath.extension().string());
+                mMetaIDs.emplace(name, metaID);
+                mScannedAssets.insert(std::lower_bound(mScannedAssets.begin(), mScannedAssets.end(), name), name);
+                readAssetInfo(filepath, metaPath);
             }
+            processAsset(name, filepath.extension().string());
+            if (isImage(filepath.extension()) && rebuildTexture(name)) {
+                rebuilt.mTextures.emplace_back(mMetaIDs.at(name));
+            }
+            ++count;
         }
+        return count;
     }
 
     void processAsset(std::string_view assetPath, std::string_view ext) {
@@ -834,6 +1939,7 @@ public:
 
     void registerProducers() {
         Expects(std::this_thread::get_id() == mThreadID);
+        STAR_STARTUP_SCOPE("register producers");
         registerProducer(Core::Mesh);
         registerProducer(Core::Texture);
         registerProducer(Core::Shader);
@@ -842,41 +1948,127 @@ public:
         registerProducer(Core::RenderGraph);
     }
 
+    // file reads and deserialization run on the load pool when async,
+    // the resource slot is created on the producer thread beforehand
+    // packed resources are read from the pack, the library file is the fallback
+    template<class Value, class Reader>
+    void read(const Core::Resource& resource, Value* ptr, const MetaID& metaID, path filePath, bool async, Reader reader) {
+        const auto* entry = mPack && !mRebuilt.count(metaID) ? mPack->find(metaID) : nullptr;
+        auto task = [this, &resource, ptr, entry, filePath = std::move(filePath), reader = std::move(reader), async]() {
+            if (entry) {
+                AssetPackBuffer buffer(std::pmr::get_default_resource());
+                auto size = mPack->read(*entry, buffer);
+                MemoryStreamBuf sb(buffer.data(), size);
+                std::istream is(&sb);
+                reader(is, *ptr);
+            } else {
+                FileBuffer buffer(std::pmr::get_default_resource());
+                auto size = readFileUnbuffered(filePath, buffer);
+                MemoryStreamBuf sb(buffer.data(), size);
+                std::istream is(&sb);
+                reader(is, *ptr);
+            }
+            deliver(resource, ptr, async);
+        };
+        if (async) {
+            boost::asio::post(getLoadPool(resource), std::move(task));
+        } else {
+            task();
+        }
+    }
+
     template<class Info, class Resources>
-    auto load(const MetaID& metaID, const Info& info, Resources& resources) {
+    void load(const Core::Resource& resource, bool async, const MetaID& metaID, const Info& info, Resources& resources) {
         Expects(std::this_thread::get_id() == mThreadID);
         auto iter = resources.find(metaID);
         if (iter != resources.end()) {
-            return &iter->second;
+            deliver(resource, &iter->second, async);
+            return;
         }
-        Expects(iter == resources.end());
         auto iterInfo = info.find(metaID);
         Expects(iterInfo != info.end());
-        auto filePath = mLibrary / iterInfo->mName;
-        std::ifstream ifs(filePath, std::ios::binary);
-        PmrBinaryInArchive ia(ifs, mResources.get_allocator().resource());
         auto res = resources.try_emplace(metaID);
         Ensures(res.second);
-        iter = res.first;
-        ia >> iter->second;
-        return &iter->second;
+        read(resource, &res.first->second, metaID, mLibrary / iterInfo->mName, async,
+            [resource = mResources.get_allocator().resource()](std::istream& is, auto& data) {
+                PmrBinaryInArchive ia(is, resource);
+                ia >> data;
+            });
     }
 
-    bool load(const Core::Resource& resource, bool async) override {
-        if (mTaskCount >= mMaxTaskCount)
-            return false;
+    // runtime meshes and contents are flat files, sections are copied out of the read or mapped file
+    template<class Info, class Resources, class Loader>
+    void loadFlat(const Core::Resource& resource, bool async, const MetaID& metaID,
+        const Info& info, Resources& resources, Loader loader
+    ) {
+        Expects(std::this_thread::get_id() == mThreadID);
+        auto iter = resources.find(metaID);
+        if (iter != resources.end()) {
+            deliver(resource, &iter->second, async);
+            return;
+        }
+        auto iterInfo = info.find(metaID);
+        Expects(iterInfo != info.end());
+        auto res = resources.try_emplace(metaID);
+        Ensures(res.second);
+        const auto* entry = mPack && !mRebuilt.count(metaID) ? mPack->find(metaID) : nullptr;
+        auto task = [this, &resource, ptr = &res.first->second, entry, filePath = mLibrary / iterInfo->mName, async, loader]() {
+            if (entry) {
+                AssetPackBuffer buffer(std::pmr::get_default_resource());
+                auto size = mPack->read(*entry, buffer);
+                loader(buffer.data(), size, *ptr);
+            } else {
+                UnbufferedFile file(filePath);
+                if (file.size() < sMappedReadThreshold) {
+                    FileBuffer buffer(std::pmr::get_default_resource());
+                    file.beginRead(buffer);
+                    auto size = file.endRead();
+                    loader(buffer.data(), size, *ptr);
+                } else {
+                    MappedFile mapped(filePath);
+                    loader(mapped.data(), mapped.size(), *ptr);
+                }
+            }
+            deliver(resource, ptr, async);
+        };
+        if (async) {
+            boost::asio::post(getLoadPool(resource), std::move(task));
+        } else {
+            task();
+        }
+    }
+
+    // meshes and contents are mapped and copied, textures feed the upload budget,
+    // the other types are small and bound by deserialization
+    Core::ProducerWorkload getWorkload(const Core::ResourceType& tag) const noexcept override {
+        return visit(overload(
+            [](Core::Mesh_) { return Core::IOWorkload; },
+            [](Core::Content_) { return Core::IOWorkload; },
+            [](Core::Texture_) { return Core::GpuUploadWorkload; },
+            [](auto) { return Core::CpuWorkload; }
+        ), tag);
+    }
+
+    int32_t getConcurrency(Core::ProducerWorkload workload) const noexcept override {
+        return sMaxTaskCounts[workload];
+    }
+
+    boost::asio::thread_pool& getLoadPool(const Core::Resource& resource) noexcept {
+        return mLoadPools[getWorkload(getTag(resource))];
+    }
 
+    bool load(const Core::Resource& resource, bool async) override {
         const auto& metaID = getMetaID(resource);
         const auto& tag = getTag(resource);
 
-        ++mTaskCount;
         ++mResourceCount;
 
         visit(overload(
             [&](Core::Mesh_) {
-                Expects(!async);
-                auto ptr = load(metaID, mDatabase.mMeshInfo, mResources.mMeshes);
-                deliver(resource, ptr, async);
+                loadFlat(resource, async, metaID, mDatabase.mMeshInfo, mResources.mMeshes,
+                    [](const std::byte* data, size_t size, MeshData& mesh) {
+                        loadMeshFile(data, size, mesh);
+                    });
             },
             [&](Core::Texture_) {
                 const auto& info = mDatabase.mTextureInfo;
@@ -890,38 +2082,32 @@ public:
                 Expects(iterInfo != info.end());
                 auto filePath = mLibrary / iterInfo->mName;
                 filePath.replace_extension(".dds");
-                std::ifstream ifs(filePath, std::ios::binary);
                 auto res = resources.try_emplace(metaID);
                 Ensures(res.second);
-                iter = res.first;
                 bool bSrgb = true;
                 if (boost::algorithm::contains(iterInfo->mName, "normal")) {
                     bSrgb = false;
                 }
-                loadDDS(ifs, std::pmr::get_default_resource(), iter->second, bSrgb);
-                auto ptr = &iter->second;
-                deliver(resource, ptr, async);
-                S_WARNING << filePath << " loaded";
+                read(resource, &res.first->second, metaID, filePath, async,
+                    [bSrgb, filePath](std::istream& is, TextureData& data) {
+                        loadDDS(is, std::pmr::get_default_resource(), data, bSrgb);
+                        S_LOG(Asset, debug) << filePath << " loaded";
+                    });
             },
             [&](Core::Shader_) {
-                Expects(!async);
-                auto ptr = load(metaID, mDatabase.mShaderInfo, mResources.mShaders);
-                deliver(resource, ptr, async);
+                load(resource, async, metaID, mDatabase.mShaderInfo, mResources.mShaders);
             },
             [&](Core::Material_) {
-                Expects(!async);
-                auto ptr = load(metaID, mDatabase.mMaterialInfo, mResources.mMaterials);
-                deliver(resource, ptr, async);
+                load(resource, async, metaID, mDatabase.mMaterialInfo, mResources.mMaterials);
             },
             [&](Core::Content_) {
-                Expects(!async);
-                auto ptr = load(metaID, mDatabase.mContentInfo, mResources.mContents);
-                deliver(resource, ptr, async);
+                loadFlat(resource, async, metaID, mDatabase.mContentInfo, mResources.mContents,
+                    [](const std::byte* data, size_t size, ContentData& content) {
+                        loadContentFile(data, size, content);
+                    });
             },
             [&](Core::RenderGraph_) {
-                Expects(!async);
-                auto ptr = load(metaID, mDatabase.mRenderGraphInfo, mResources.mRenderGraphs);
-                deliver(resource, ptr, async);
+                load(resource, async, metaID, mDatabase.mRenderGraphInfo, mResources.mRenderGraphs);
             }
         ), tag);
         return true;
@@ -929,14 +2115,92 @@ public:
 
     void created(const Core::Resource& resource) override {
         Expects(std::this_thread::get_id() == mThreadID);
-        --mTaskCount;
     }
 
     void destroy(const Core::Resource& resource) noexcept override {
         Expects(std::this_thread::get_id() == mThreadID);
         --mResourceCount;
-        // lazy deletion
+        // textures and shaders are read again once invalidated, other types are deleted lazily
         // TODO: add destroy
+        visit(overload(
+            [&](Core::Texture_) {
+                mResources.mTextures.erase(getMetaID(resource));
+            },
+            [&](Core::Shader_) {
+                mResources.mShaders.erase(getMetaID(resource));
+            },
+            [&](auto) {}
+        ), getTag(resource));
+    }
+
+    void getDependencies(const Core::Resource& resource,
+        std::vector<std::pair<MetaID, Core::ResourceType>>& dependencies) override
+    {
+        Expects(std::this_thread::get_id() == mThreadID);
+        if (!std::holds_alternative<Core::Content_>(getTag(resource)))
+            return;
+
+        const auto& metaID = getMetaID(resource);
+        auto iter = mDependencyManifests.find(metaID);
+        if (iter == mDependencyManifests.end()) {
+            DependencyManifest manifest;
+            auto iterInfo = mDatabase.mContentInfo.find(metaID);
+            if (iterInfo != mDatabase.mContentInfo.end()) {
+                auto filePath = mLibrary / (iterInfo->mName + ".deps");
+                if (exists(filePath)) {
+                    std::ifstream ifs(filePath, std::ios::binary);
+                    boost::archive::binary_iarchive ia(ifs);
+                    ia >> manifest;
+                }
+            }
+            iter = mDependencyManifests.emplace(metaID, std::move(manifest)).first;
+        }
+
+        dependencies.reserve(dependencies.size() + iter->second.size());
+        for (const auto& [id, tagIndex] : iter->second) {
+            dependencies.emplace_back(id, getResourceType(tagIndex));
+        }
+    }
+
+    static Core::ResourceType getResourceType(uint32_t index) {
+        return getResourceType(index, std::make_index_sequence<std::variant_size_v<Core::ResourceType>>{});
+    }
+
+    template<size_t... I>
+    static Core::ResourceType getResourceType(uint32_t index, std::index_sequence<I...>) {
+        if (index >= sizeof...(I)) {
+            throw std::out_of_range("resource type index out of range");
+        }
+        Core::ResourceType tag;
+        (void)((I == index ? (tag.emplace<I>(), true) : false) || ...);
+        return tag;
+    }
+
+    Core::ResidencySize getResidencySize(const Core::Resource& resource) const noexcept override {
+        // meshes and textures are uploaded as is, gpu size follows cpu size
+        Core::ResidencySize size;
+        const auto& metaID = getMetaID(resource);
+        visit(overload(
+            [&](Core::Mesh_) {
+                auto iter = mResources.mMeshes.find(metaID);
+                if (iter == mResources.mMeshes.end())
+                    return;
+                for (const auto& vb : iter->second.mVertexBuffers) {
+                    size.mCpuBytes += vb.mBuffer.size();
+                }
+                size.mCpuBytes += iter->second.mIndexBuffer.mBuffer.size();
+                size.mGpuBytes = size.mCpuBytes;
+            },
+            [&](Core::Texture_) {
+                auto iter = mResources.mTextures.find(metaID);
+                if (iter == mResources.mTextures.end())
+                    return;
+                size.mCpuBytes = iter->second.mBuffer.size();
+                size.mGpuBytes = size.mCpuBytes;
+            },
+            [&](auto) {}
+        ), getTag(resource));
+        return size;
     }
 
     bool try_createMaterial(std::string_view assetPath, std::string_view shaderName) {
@@ -967,15 +2231,15 @@ public:
         return { *res2.first, res2.second };
     }
 
-    FlattenedObjects& contentInstantiateFlattenedObjects(std::string_view contentPath, std::string_view fbxPath) {
-        auto& content = getResource(contentPath, mDatabase.mContentInfo, mResources.mContents);
-        MetaID fbxID{};
-        {
-            auto iter = mDatabase.mFbxInfo.get<Index::Name>().find(sv(getAssetName(fbxPath)));
-            Expects(iter != mDatabase.mFbxInfo.get<Index::Name>().end());
-            fbxID = iter->mMetaID;
-        }
-        Ensures(!fbxID.is_nil());
+    const FbxInfo& getFbxInfo(std::string_view fbxPath) const {
+        auto iter = mDatabase.mFbxInfo.get<Index::Name>().find(sv(getAssetName(fbxPath)));
+        Expects(iter != mDatabase.mFbxInfo.get<Index::Name>().end());
+        Ensures(!iter->mMetaID.is_nil());
+        return *iter;
+    }
+
+    const FlattenedObjects& readFlattenedFbx(std::string_view fbxPath) {
+        const auto fbxID = getFbxInfo(fbxPath).mMetaID;
         auto iter = mFlattenedFbx.find(fbxID);
         if (iter == mFlattenedFbx.end()) {
             AssetFbxImporter importer{};
@@ -987,12 +2251,124 @@ public:
             iter = res.first;
             fbx.readFlattenedNodes(mDatabase.mMeshInfo, iter->second);
         }
+        return iter->second;
+    }
+
+    FlattenedObjects& contentInstantiateFlattenedObjects(std::string_view contentPath, std::string_view fbxPath) {
+        auto& content = getResource(contentPath, mDatabase.mContentInfo, mResources.mContents);
+        const auto& flattened = readFlattenedFbx(fbxPath);
+        content.mIDs.emplace_back(ContentID{ { ObjectBatch }, gsl::narrow<uint16_t>(content.mFlattenedObjects.size()) });
+        auto& objects = content.mFlattenedObjects.emplace_back();
+        objects = flattened;
+        return objects;
+    }
+
+    // batching needs the source meshes now, they are imported once and reused by build
+    FlattenedObjects& contentInstantiateStaticBatches(std::string_view contentPath, std::string_view fbxPath, float cellSize) {
+        auto& content = getResource(contentPath, mDatabase.mContentInfo, mResources.mContents);
+        const auto& contentID = getAssetMetaID(contentPath, mDatabase.mContentInfo);
+        const auto& flattened = readFlattenedFbx(fbxPath);
+        const auto& fbxInfo = getFbxInfo(fbxPath);
+
+        bool imported = true;
+        for (const auto& meshID : fbxInfo.mMeshes) {
+            if (!mResources.mMeshes.count(meshID)) {
+                imported = false;
+            }
+        }
+        if (!imported) {
+            PmrMetaIDUnorderedMap<MeshData> meshes(std::pmr::get_default_resource());
+            AssetFbxImporter importer{};
+            auto filePath = (mFolder / fbxPath).string();
+            AssetFbxScene fbx(importer.read(filePath), fbxInfo.mMetaID, mFolder, filePath);
+            fbx.readMeshes("StaticMeshCompact", mResources.mSettings, meshes);
+            for (auto& [metaID, meshData] : meshes) {
+                mResources.mMeshes.try_emplace(metaID, std::move(meshData));
+            }
+        }
+
+        PmrMetaIDUnorderedMap<MeshData> batchMeshes(std::pmr::get_default_resource());
+        content.mIDs.emplace_back(ContentID{ { ObjectBatch }, gsl::narrow<uint16_t>(content.mFlattenedObjects.size()) });
+        auto& objects = content.mFlattenedObjects.emplace_back();
+        buildStaticBatches(flattened, mResources.mMeshes, contentID, cellSize, objects, batchMeshes);
+
+        for (auto& [metaID, meshData] : batchMeshes) {
+            registerStaticBatch(metaID, meshData.mSubMeshes.size());
+            mResources.mMeshes.insert_or_assign(metaID, std::move(meshData));
+        }
+        return objects;
+    }
+
+    // unique materials are copies of the fbx materials, written next to the content as <content>_stress/<object>_<slot>.material
+    FlattenedObjects& contentInstantiateStressObjects(std::string_view contentPath, std::string_view fbxPath,
+        const StressSceneDesc& desc
+    ) {
+        auto& content = getResource(contentPath, mDatabase.mContentInfo, mResources.mContents);
+        const auto& flattened = readFlattenedFbx(fbxPath);
         content.mIDs.emplace_back(ContentID{ { ObjectBatch }, gsl::narrow<uint16_t>(content.mFlattenedObjects.size()) });
         auto& objects = content.mFlattenedObjects.emplace_back();
-        objects = iter->second;
+        buildStressObjects(flattened, desc, objects);
+
+        if (desc.mMaterials == StressMaterials::Shared) {
+            MetaID shared{};
+            for (const auto& renderer : objects.mMeshRenderers) {
+                if (!renderer.mMaterialIDs.empty()) {
+                    shared = renderer.mMaterialIDs.front();
+                    break;
+                }
+            }
+            for (auto& renderer : objects.mMeshRenderers) {
+                std::fill(renderer.mMaterialIDs.begin(), renderer.mMaterialIDs.end(), shared);
+            }
+        } else if (desc.mMaterials == StressMaterials::Unique) {
+            auto folder = std::filesystem::path(getAssetName(contentPath)).replace_extension().string() + "_stress/";
+            for (size_t i = 0; i != objects.mMeshRenderers.size(); ++i) {
+                auto& materialIDs = objects.mMeshRenderers[i].mMaterialIDs;
+                for (size_t k = 0; k != materialIDs.size(); ++k) {
+                    const auto source = at(mDatabase.mMaterialInfo, materialIDs[k]);
+                    auto materialPath = folder + std::to_string(i) + "_" + std::to_string(k) + ".material";
+                    auto res = try_createAsset(materialPath, "material", mDatabase.mMaterialInfo);
+                    if (res.second) {
+                        auto res2 = mDatabase.mMaterialInfo.modify(res.first, [&](MaterialInfo& asset) {
+                            asset.mShader = source.mShader;
+                            asset.mTextures = source.mTextures;
+                        });
+                        Ensures(res2);
+                        res2 = updateAsset(materialPath, "material", *res.first);
+                        Ensures(res2);
+                    }
+                    materialIDs[k] = res.first->mMetaID;
+                }
+            }
+        }
+
+        S_INFO << "stress objects: " << objects.mMeshRenderers.size() << " renderers of " << fbxPath
+            << ", depth " << desc.mHierarchyDepth << ", seed " << desc.mSeed;
         return objects;
     }
 
+    // batch meshes belong to no fbx, they are written with the other meshes under star_meshes
+    void registerStaticBatch(const MetaID& metaID, size_t numSubMeshes) {
+        if (mDatabase.mMeshInfo.find(metaID) != mDatabase.mMeshInfo.end())
+            return;
+        std::ostringstream oss;
+        oss << metaID << ".mesh";
+        auto assetPath = std::filesystem::path("star_meshes") / oss.str();
+        mDatabase.mMeshInfo.emplace(MeshInfo{ metaID, getAssetName(assetPath), "static_batch", nullptr, numSubMeshes });
+        mUnique.emplace(metaID);
+    }
+
+    // meshes referenced by contents but by no fbx are static batches of an earlier build
+    void registerStaticBatches() {
+        for (const auto& [metaID, content] : mResources.mContents) {
+            for (const auto& objects : content.mFlattenedObjects) {
+                for (const auto& renderer : objects.mMeshRenderers) {
+                    registerStaticBatch(renderer.mMeshID, renderer.mMaterialIDs.size());
+                }
+            }
+        }
+    }
+
     void contentAddFullscreenTriangle(std::string_view contentPath, std::string_view materialPath) {
         auto& content = getResource(contentPath, mDatabase.mContentInfo, mResources.mContents);
         MetaID materialID{};
@@ -1098,17 +2474,49 @@ public:
     std::filesystem::path mFolder;
     std::filesystem::path mLibrary;
 
-    std::unordered_set<MetaID> mUnique;
+    MetaIDUnorderedSet mUnique;
+    // asset names of the last scan and their meta ids, so meta files are parsed once
+    std::vector<std::string> mScannedAssets;
+    std::map<std::string, MetaID, std::less<>> mMetaIDs;
+    ScanCache mScanCache;
+    std::unique_ptr<AssetWatcher> mWatcher;
+    std::unique_ptr<AssetWatcher> mLibraryWatcher;
     AssetDatabase mDatabase;
     Resources mResources;
 
-    std::pmr::unordered_map<MetaID, FlattenedObjects> mFlattenedFbx;
+    PmrMetaIDUnorderedMap<FlattenedObjects> mFlattenedFbx;
     Shader::ShaderModules mShaderModules;
     Map<std::string, RenderGraphFactory> mRenderGraphs;
-
-    int32_t mMaxTaskCount = 4;
-    int32_t mTaskCount = 0;
+    std::filesystem::path mSharedShaderCache;
+    // uv scale and offset of a texture packed into an atlas
+    struct AtlasTile {
+        MetaID mAtlas;
+        Vector4f mTransform;
+    };
+    // textures of at most this size are packed into atlases of at most sTextureAtlasDimension, 0 disables
+    static constexpr uint32_t sTextureAtlasDimension = 4096;
+    uint32_t mAtlasMaxDimension = 0;
+    MetaIDUnorderedMap<AtlasTile> mAtlasTiles;
+    MetaIDUnorderedSet mTextureAtlases;
+    MetaIDUnorderedMap<DependencyManifest> mDependencyManifests;
+    BuildDatabase mBuildDatabase;
+    std::mutex mBuildMutex;
+    BuildReport mBuildReport;
+
+    // tasks in flight per workload, limited by the manager
+    static constexpr std::array<int32_t, Core::ProducerWorkloadCount> sMaxTaskCounts = { 4, 2, 4 };
     int64_t mResourceCount = 0;
+
+    std::unique_ptr<AssetPack> mPack;
+    // rebuilt since the pack was written, read from the library
+    MetaIDUnorderedSet mRebuilt;
+
+    // one pool per workload and one thread per task in flight, destroyed first so pending loads are joined
+    std::array<boost::asio::thread_pool, Core::ProducerWorkloadCount> mLoadPools{
+        boost::asio::thread_pool{ size_t(sMaxTaskCounts[Core::IOWorkload]) },
+        boost::asio::thread_pool{ size_t(sMaxTaskCounts[Core::CpuWorkload]) },
+        boost::asio::thread_pool{ size_t(sMaxTaskCounts[Core::GpuUploadWorkload]) },
+    };
 };
 
 AssetFactory::AssetFactory(std::string_view assetPath, std::string_view libPath, const allocator_type& alloc)
@@ -1134,6 +2542,14 @@ void AssetFactory::processAssets() {
     mImpl->processAssets();
 }
 
+void AssetFactory::watch() {
+    mImpl->watch();
+}
+
+size_t AssetFactory::processChanges(AssetChanges& changes) {
+    return mImpl->processChanges(changes);
+}
+
 void AssetFactory::registerProducers() {
     mImpl->registerProducers();
 }
@@ -1174,10 +2590,26 @@ void AssetFactory::saveRenderGraph(std::string_view renderGraph) {
     mImpl->saveRenderGraph(renderGraph);
 }
 
+void AssetFactory::setSharedShaderCache(std::string_view folder) {
+    mImpl->mSharedShaderCache = folder;
+}
+
+void AssetFactory::setTextureAtlasing(uint32_t maxDimension) {
+    mImpl->mAtlasMaxDimension = maxDimension;
+}
+
 void AssetFactory::build() const {
     mImpl->build();
 }
 
+void AssetFactory::clearBuildCaches() {
+    mImpl->clearBuildCaches();
+}
+
+const BuildReport& AssetFactory::getBuildReport() const noexcept {
+    return mImpl->mBuildReport;
+}
+
 bool AssetFactory::try_createMaterial(std::string_view material, std::string_view shaderName) {
     return mImpl->try_createMaterial(material, shaderName);
 }
@@ -1198,6 +2630,16 @@ FlattenedObjects& AssetFactory::contentInstantiateFlattenedObjects(std::string_v
     return mImpl->contentInstantiateFlattenedObjects(content, fbx);
 }
 
+FlattenedObjects& AssetFactory::contentInstantiateStaticBatches(std::string_view content, std::string_view fbx, float cellSize) {
+    return mImpl->contentInstantiateStaticBatches(content, fbx, cellSize);
+}
+
+FlattenedObjects& AssetFactory::contentInstantiateStressObjects(std::string_view content, std::string_view fbx,
+    const StressSceneDesc& desc
+) {
+    return mImpl->contentInstantiateStressObjects(content, fbx, desc);
+}
+
 void AssetFactory::contentAddFullscreenTriangle(std::string_view content, std::string_view material) {
     return mImpl->contentAddFullscreenTriangle(content, material);
 }
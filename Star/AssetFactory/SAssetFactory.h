@@ -35,6 +35,45 @@ class ShaderDatabase;
 
 namespace Star::Asset {
 
+class BuildReport;
+
+enum class StressMaterials : uint32_t {
+    // materials of the fbx objects
+    Source,
+    // one material for all objects, best case of sorting and instancing
+    Shared,
+    // a material asset per renderer slot, worst case of sorting and instancing
+    Unique,
+};
+
+enum class StressDistribution : uint32_t {
+    Uniform,
+    Grid,
+};
+
+// synthetic objects instancing the meshes of an fbx, for scaling benchmarks
+struct StressSceneDesc {
+    uint32_t mObjectCount = 1000;
+    // fbx objects instanced round robin, 0 uses all of them
+    uint32_t mMeshVariety = 0;
+    StressMaterials mMaterials = StressMaterials::Source;
+    // objects are flattened, their transforms are composed of this many levels of mBranching children
+    uint32_t mHierarchyDepth = 1;
+    uint32_t mBranching = 8;
+    // roots are placed within [-mExtent, mExtent] on each axis
+    StressDistribution mDistribution = StressDistribution::Uniform;
+    float mExtent = 1000.0f;
+    uint32_t mSeed = 0;
+};
+
+// resources changed since the last processChanges
+struct AssetChanges {
+    // rebuilt from the changed images of the asset folder, see Engine::reloadTextures
+    std::vector<MetaID> mTextures;
+    // rewritten in the library by another build, see Engine::reloadShaders
+    std::vector<MetaID> mShaders;
+};
+
 class STAR_ASSETFACTORY_API AssetFactory {
 public:
     using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
@@ -49,6 +88,11 @@ public:
     void scan();
     void processAssets();
 
+    // watches the asset folder and the library, processChanges re-processes the assets changed since the last call
+    // textures are built again, shaders written by another build are read from the library again
+    void watch();
+    size_t processChanges(AssetChanges& changes);
+
     void registerProducers();
     
     // shaders
@@ -63,6 +107,10 @@ public:
         try_createContent(std::string_view content);
     void clearContent(std::string_view content);
     Graphics::Render::FlattenedObjects& contentInstantiateFlattenedObjects(std::string_view content, std::string_view fbx);
+    // static renderers sharing a material and layout are merged per cell of cellSize into world space meshes
+    Graphics::Render::FlattenedObjects& contentInstantiateStaticBatches(std::string_view content, std::string_view fbx, float cellSize);
+    Graphics::Render::FlattenedObjects& contentInstantiateStressObjects(std::string_view content, std::string_view fbx,
+        const StressSceneDesc& desc);
     void contentAddFullscreenTriangle(std::string_view content, std::string_view material);
     void saveContent(std::string_view content);
 
@@ -76,7 +124,18 @@ public:
 
     void saveRenderGraph(std::string_view renderGraph);
 
+    // shader bytecode cache shared between machines, e.g. a network folder
+    void setSharedShaderCache(std::string_view folder);
+
+    // textures of at most maxDimension are packed into atlases by build, 0 disables.
+    // only textures every material remaps through a <texture>_ST material constant are packed
+    void setTextureAtlasing(uint32_t maxDimension);
+
     void build() const;
+    // next build starts from scratch, for clean build timings
+    void clearBuildCaches();
+    // stage and asset timings of the last build
+    const BuildReport& getBuildReport() const noexcept;
 private:
 #pragma warning(push)
 #pragma warning(disable: 4251)
@@ -20,8 +20,11 @@
 #include "SAssetTypes.h"
 #include "SAssetFbxUtils.h"
 #include "SAssetUtils.h"
+#include "SAssetMesh.h"
+#include "SAssetBuildReport.h"
 #include <Star/Graphics/SContentSerialization.h>
 #include <3rdparty/mikktspace/mikktspace.h>
+#include <Star/SHalf.h>
 
 using namespace fbxsdk;
 
@@ -61,8 +64,10 @@ void checkLayoutRequirement(const MeshBufferLayout& layout, const fbxsdk::FbxMes
                     throw std::invalid_argument("psize not supported yet");
                 },
                 [&](TANGENT_) {
-                    if (!(count.at(e.mType.index()) < pMesh->GetElementTangentCount())) {
-                        throw std::invalid_argument("texcoord index exceeds uv count");
+                    // the first tangent is generated by mikktspace when the fbx has none
+                    const bool generated = pMesh->GetElementTangentCount() == 0 && count.at(e.mType.index()) == 0;
+                    if (!generated && !(count.at(e.mType.index()) < pMesh->GetElementTangentCount())) {
+                        throw std::invalid_argument("tangent index exceeds tangent count");
                     }
                     ++count.at(e.mType.index());
                 },
@@ -118,199 +123,134 @@ void checkLayoutRequirement(const MeshBufferLayout& layout, const fbxsdk::FbxMes
     }
 }
 
+// triangle list attributes pre-extracted once for mikktspace, vertex 3 * face + k is corner k of face
+struct TangentSpaceData {
+    std::vector<Vector3fu> mPositions;
+    std::vector<Vector3fu> mNormals;
+    std::vector<Vector2fu> mTexCoords;
+    std::vector<Vector4fu> mTangents; // xyz + bitangent sign
+};
+
 int getNumFaces(const SMikkTSpaceContext* pContext) {
     Expects(pContext && pContext->m_pUserData);
-    const auto* mesh = static_cast<const MeshData*>(pContext->m_pUserData);
-    return mesh->mIndexBuffer.mPrimitiveCount;
+    const auto* data = static_cast<const TangentSpaceData*>(pContext->m_pUserData);
+    return gsl::narrow_cast<int>(data->mPositions.size() / 3);
 }
 
 int getNumVerticesOfFace(const SMikkTSpaceContext* pContext, const int iFace) {
-    Expects(pContext && pContext->m_pUserData);
-    const auto* mesh = static_cast<const MeshData*>(pContext->m_pUserData);
-    Expects(mesh->mIndexBuffer.mPrimitiveTopology == GFX_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
     return 3;
 }
 
 void getPosition(const SMikkTSpaceContext* pContext, float fvPosOut[], const int iFace, const int iVert) {
-    Expects(pContext && pContext->m_pUserData);
-    const auto* mesh = static_cast<const MeshData*>(pContext->m_pUserData);
-    Expects(mesh->mIndexBuffer.mElementSize);
-    uint32_t id = -1;
-    if (mesh->mIndexBuffer.mElementSize == 2) {
-        auto* pIndex = reinterpret_cast<const uint16_t*>(mesh->mIndexBuffer.mBuffer.data());
-        id = pIndex[3 * iFace + iVert];
-    } else {
-        auto* pIndex = reinterpret_cast<const uint32_t*>(mesh->mIndexBuffer.mBuffer.data());
-        id = pIndex[3 * iFace + iVert];
-    }
-    Ensures(id != -1);
-
-    for (const auto& vb : mesh->mVertexBuffers) {
-        Expects(id < vb.mVertexCount);
-        for (const auto& elem : vb.mDesc.mElements) {
-            if (std::holds_alternative<SV_Position_>(elem.mType)) {
-                switch (elem.mFormat) {
-                case Format::R32G32B32_SFLOAT:
-                case Format::R32G32B32A32_SFLOAT:
-                {
-                    const auto* pPos = reinterpret_cast<const float*>(vb.mBuffer.data() + id * vb.mDesc.mVertexSize + elem.mAlignedByteOffset);
-                    fvPosOut[0] = pPos[0];
-                    fvPosOut[1] = pPos[1];
-                    fvPosOut[2] = pPos[2];
-                }
-                break;
-                case Format::R16G16B16A16_SFLOAT:
-                {
-                    const auto* pPos = reinterpret_cast<const half*>(vb.mBuffer.data() + id * vb.mDesc.mVertexSize + elem.mAlignedByteOffset);
-                    fvPosOut[0] = pPos[0];
-                    fvPosOut[1] = pPos[1];
-                    fvPosOut[2] = pPos[2];
-                }
-                break;
-                default:
-                    throw std::invalid_argument("unsupported position format");
-                }
-            }
-        }
-    }
+    const auto* data = static_cast<const TangentSpaceData*>(pContext->m_pUserData);
+    const auto& v = data->mPositions[3 * iFace + iVert];
+    fvPosOut[0] = v[0];
+    fvPosOut[1] = v[1];
+    fvPosOut[2] = v[2];
 }
 
 void getNormal(const SMikkTSpaceContext* pContext, float fvNormOut[], const int iFace, const int iVert) {
-    Expects(pContext && pContext->m_pUserData);
-    const auto* mesh = static_cast<const MeshData*>(pContext->m_pUserData);
-    Expects(mesh->mIndexBuffer.mElementSize);
-    uint32_t id = -1;
-    if (mesh->mIndexBuffer.mElementSize == 2) {
-        auto* pIndex = reinterpret_cast<const uint16_t*>(mesh->mIndexBuffer.mBuffer.data());
-        id = pIndex[3 * iFace + iVert];
-    } else {
-        auto* pIndex = reinterpret_cast<const uint32_t*>(mesh->mIndexBuffer.mBuffer.data());
-        id = pIndex[3 * iFace + iVert];
-    }
-    Ensures(id != -1);
-
-    for (const auto& vb : mesh->mVertexBuffers) {
-        Expects(id < vb.mVertexCount);
-        for (const auto& elem : vb.mDesc.mElements) {
-            if (std::holds_alternative<NORMAL_>(elem.mType)) {
-                switch (elem.mFormat) {
-                case Format::R32G32B32_SFLOAT:
-                case Format::R32G32B32A32_SFLOAT:
-                {
-                    const auto* pPos = reinterpret_cast<const float*>(vb.mBuffer.data() + id * vb.mDesc.mVertexSize + elem.mAlignedByteOffset);
-                    fvNormOut[0] = pPos[0];
-                    fvNormOut[1] = pPos[1];
-                    fvNormOut[2] = pPos[2];
-                }
-                break;
-                case Format::R16G16B16A16_SFLOAT:
-                {
-                    const auto* pPos = reinterpret_cast<const half*>(vb.mBuffer.data() + id * vb.mDesc.mVertexSize + elem.mAlignedByteOffset);
-                    fvNormOut[0] = pPos[0];
-                    fvNormOut[1] = pPos[1];
-                    fvNormOut[2] = pPos[2];
-                }
-                break;
-                default:
-                    throw std::invalid_argument("unsupported normal format");
-                }
-            }
-        }
-    }
+    const auto* data = static_cast<const TangentSpaceData*>(pContext->m_pUserData);
+    const auto& v = data->mNormals[3 * iFace + iVert];
+    fvNormOut[0] = v[0];
+    fvNormOut[1] = v[1];
+    fvNormOut[2] = v[2];
 }
 
 void getTexCoord(const SMikkTSpaceContext* pContext, float fvTexcOut[], const int iFace, const int iVert) {
-    Expects(pContext && pContext->m_pUserData);
-    const auto* mesh = static_cast<const MeshData*>(pContext->m_pUserData);
-    Expects(mesh->mIndexBuffer.mElementSize);
-    uint32_t id = -1;
-    if (mesh->mIndexBuffer.mElementSize == 2) {
-        auto* pIndex = reinterpret_cast<const uint16_t*>(mesh->mIndexBuffer.mBuffer.data());
-        id = pIndex[3 * iFace + iVert];
-    } else {
-        auto* pIndex = reinterpret_cast<const uint32_t*>(mesh->mIndexBuffer.mBuffer.data());
-        id = pIndex[3 * iFace + iVert];
-    }
-    Ensures(id != -1);
+    const auto* data = static_cast<const TangentSpaceData*>(pContext->m_pUserData);
+    const auto& v = data->mTexCoords[3 * iFace + iVert];
+    fvTexcOut[0] = v[0];
+    fvTexcOut[1] = v[1];
+}
 
-    for (const auto& vb : mesh->mVertexBuffers) {
-        Expects(id < vb.mVertexCount);
-        for (const auto& elem : vb.mDesc.mElements) {
-            if (std::holds_alternative<TEXCOORD_>(elem.mType)) {
-                switch (elem.mFormat) {
-                case Format::R32G32B32A32_SFLOAT:
-                case Format::R32G32B32_SFLOAT:
-                case Format::R32G32_SFLOAT:
-                {
-                    const auto* pPos = reinterpret_cast<const float*>(vb.mBuffer.data() + id * vb.mDesc.mVertexSize + elem.mAlignedByteOffset);
-                    fvTexcOut[0] = pPos[0];
-                    fvTexcOut[1] = pPos[1];
-                }
-                break;
-                case Format::R16G16B16A16_SFLOAT:
-                case Format::R16G16_SFLOAT:
-                {
-                    const auto* pPos = reinterpret_cast<const half*>(vb.mBuffer.data() + id * vb.mDesc.mVertexSize + elem.mAlignedByteOffset);
-                    fvTexcOut[0] = pPos[0];
-                    fvTexcOut[1] = pPos[1];
-                }
-                break;
-                default:
-                    throw std::invalid_argument("unsupported texcoord format");
-                }
+void setTSpaceBasic(const SMikkTSpaceContext* pContext, const float fvTangent[], const float fSign, const int iFace, const int iVert) {
+    auto* data = static_cast<TangentSpaceData*>(pContext->m_pUserData);
+    data->mTangents[3 * iFace + iVert] = Vector4fu(fvTangent[0], fvTangent[1], fvTangent[2], fSign);
+}
+
+// one pass per tangent element, the format is resolved once instead of per vertex
+void writeTangents(const std::vector<Vector4fu>& tangents, const VertexElement& elem,
+    VertexBufferData& vb
+) {
+    Expects(tangents.size() == vb.mVertexCount);
+    const auto stride = vb.mDesc.mVertexSize;
+    auto* dst = vb.mBuffer.data() + elem.mAlignedByteOffset;
+    const auto count = tangents.size();
+    if (count == 0)
+        return;
+
+    switch (elem.mFormat) {
+    case Format::R32G32B32A32_SFLOAT:
+        for (size_t i = 0; i != count; ++i, dst += stride) {
+            std::memcpy(dst, tangents[i].data(), sizeof(float) * 4);
+        }
+        break;
+    case Format::R32G32B32_SFLOAT:
+        for (size_t i = 0; i != count; ++i, dst += stride) {
+            std::memcpy(dst, tangents[i].data(), sizeof(float) * 3);
+        }
+        break;
+    case Format::R16G16B16A16_SFLOAT:
+    {
+        std::vector<half> halves(count * 4);
+        convertFloatToHalf(gsl::span<const float>(tangents.front().data(), halves.size()), halves);
+        for (size_t i = 0; i != count; ++i, dst += stride) {
+            std::memcpy(dst, halves.data() + i * 4, sizeof(half) * 4);
+        }
+    }
+    break;
+    case Format::R8G8B8A8_SNORM:
+        for (size_t i = 0; i != count; ++i, dst += stride) {
+            auto* pPos = reinterpret_cast<int8_t*>(dst);
+            for (int k = 0; k != 3; ++k) {
+                pPos[k] = static_cast<int8_t>(std::lround(std::clamp(tangents[i][k], -1.f, 1.f) * 127.f));
             }
+            pPos[3] = tangents[i][3] < 0.f ? -127 : 127;
         }
+        break;
+    default:
+        throw std::invalid_argument("unsupported tangent format");
     }
 }
 
-void setTSpaceBasic(const SMikkTSpaceContext* pContext, const float fvTangent[], const float fSign, const int iFace, const int iVert) {
-    Expects(pContext && pContext->m_pUserData);
-    auto* mesh = static_cast<MeshData*>(pContext->m_pUserData);
-    Expects(mesh->mIndexBuffer.mElementSize);
-    uint32_t id = -1;
-    if (mesh->mIndexBuffer.mElementSize == 2) {
-        auto* pIndex = reinterpret_cast<const uint16_t*>(mesh->mIndexBuffer.mBuffer.data());
-        id = pIndex[3 * iFace + iVert];
-    } else {
-        auto* pIndex = reinterpret_cast<const uint32_t*>(mesh->mIndexBuffer.mBuffer.data());
-        id = pIndex[3 * iFace + iVert];
+void generateTangents(const fbxsdk::FbxMesh* pMesh, MeshData& mesh) {
+    static const int PolygonSize = 3;
+    if (pMesh->GetElementNormalCount() == 0 || pMesh->GetElementUVCount() == 0) {
+        throw std::invalid_argument("mikktspace requires normal and texcoord");
     }
-    Ensures(id != -1);
+    const size_t vertexCount = size_t(PolygonSize) * pMesh->GetPolygonCount();
+
+    TangentSpaceData data;
+    data.mPositions.resize(vertexCount);
+    data.mNormals.resize(vertexCount);
+    data.mTexCoords.resize(vertexCount);
+    data.mTangents.resize(vertexCount, Vector4fu(1.f, 0.f, 0.f, 1.f));
+
+    readPointByVertex<PolygonSize, Vector3fu>(pMesh,
+        reinterpret_cast<char*>(data.mPositions.data()), sizeof(Vector3fu));
+    readByVertex<PolygonSize, Vector3fu>(pMesh, pMesh->GetElementNormal(0),
+        reinterpret_cast<char*>(data.mNormals.data()), sizeof(Vector3fu));
+    readByVertex<PolygonSize, Vector2fu>(pMesh, pMesh->GetElementUV(0),
+        reinterpret_cast<char*>(data.mTexCoords.data()), sizeof(Vector2fu));
+
+    SMikkTSpaceInterface interface {
+        &getNumFaces, &getNumVerticesOfFace, &getPosition, &getNormal, &getTexCoord, &setTSpaceBasic
+    };
+
+    SMikkTSpaceContext context{
+        &interface,
+        &data
+    };
 
-    for (auto& vb : mesh->mVertexBuffers) {
-        Expects(id < vb.mVertexCount);
-        for (auto& elem : vb.mDesc.mElements) {
+    if (!genTangSpaceDefault(&context)) {
+        throw std::runtime_error("calculate mikktspace failed");
+    }
+
+    for (auto& vb : mesh.mVertexBuffers) {
+        for (const auto& elem : vb.mDesc.mElements) {
             if (std::holds_alternative<TANGENT_>(elem.mType)) {
-                switch (elem.mFormat) {
-                case Format::R32G32B32A32_SFLOAT:
-                {
-                    auto* pPos = reinterpret_cast<float*>(vb.mBuffer.data() + id * vb.mDesc.mVertexSize + elem.mAlignedByteOffset);
-                    pPos[0] = fvTangent[0];
-                    pPos[1] = fvTangent[1];
-                    pPos[2] = fvTangent[2];
-                    pPos[3] = fSign;
-                }
-                break;
-                case Format::R32G32B32_SFLOAT:
-                {
-                    auto* pPos = reinterpret_cast<float*>(vb.mBuffer.data() + id * vb.mDesc.mVertexSize + elem.mAlignedByteOffset);
-                    pPos[0] = fvTangent[0];
-                    pPos[1] = fvTangent[1];
-                    pPos[2] = fvTangent[2];
-                }
-                break;
-                case Format::R16G16B16A16_SFLOAT:
-                {
-                    auto* pPos = reinterpret_cast<half*>(vb.mBuffer.data() + id * vb.mDesc.mVertexSize + elem.mAlignedByteOffset);
-                    pPos[0] = half(fvTangent[0]);
-                    pPos[1] = half(fvTangent[1]);
-                    pPos[2] = half(fvTangent[2]);
-                    pPos[3] = half(fSign);
-                }
-                break;
-                default:
-                    throw std::invalid_argument("unsupported texcoord format");
-                }
+                writeTangents(data.mTangents, elem, vb);
             }
         }
     }
@@ -319,7 +259,7 @@ void setTSpaceBasic(const SMikkTSpaceContext* pContext, const float fvTangent[],
 void fillBufferByVertex(const MeshBufferLayout& layout,
     const fbxsdk::FbxMesh* pMesh, MeshData& mesh
 ) {
-    bool mikktspace = false;
+    const bool mikktspace = pMesh->GetElementTangentCount() == 0;
 
     static const int PolygonSize = 3;
     const int faceCount = pMesh->GetPolygonCount();
@@ -378,6 +318,9 @@ void fillBufferByVertex(const MeshBufferLayout& layout,
                     case Format::R16G16B16A16_SFLOAT:
                         readByVertex<PolygonSize, Vector4hu>(pMesh, pMesh->GetElementNormal(slot), buffer, stride);
                         break;
+                    case Format::R8G8B8A8_SNORM:
+                        readByVertex<PolygonSize, Snorm4>(pMesh, pMesh->GetElementNormal(slot), buffer, stride);
+                        break;
                     default:
                         throw std::invalid_argument("normal Format not support");
                     }
@@ -402,6 +345,9 @@ void fillBufferByVertex(const MeshBufferLayout& layout,
                         case Format::R16G16B16A16_SFLOAT:
                             readByVertex<PolygonSize, Vector4hu>(pMesh, pMesh->GetElementTangent(slot), buffer, stride);
                             break;
+                        case Format::R8G8B8A8_SNORM:
+                            readByVertex<PolygonSize, Snorm4>(pMesh, pMesh->GetElementTangent(slot), buffer, stride);
+                            break;
                         default:
                             throw std::invalid_argument("tangent Format not support");
                         }
@@ -487,31 +433,20 @@ void fillBufferByVertex(const MeshBufferLayout& layout,
         }
     }
 
-    // mikktspace
+    // mikktspace, meshes are already read in parallel by readMeshes
     if (mikktspace) {
         bool hasTangent = false;
-        for (auto& vb : mesh.mVertexBuffers) {
-            for (auto& elem : vb.mDesc.mElements) {
+        for (const auto& vb : mesh.mVertexBuffers) {
+            for (const auto& elem : vb.mDesc.mElements) {
                 if (std::holds_alternative<TANGENT_>(elem.mType)) {
                     hasTangent = true;
-                    break;
                 }
             }
         }
         if (hasTangent) {
-            SMikkTSpaceInterface interface {
-                &getNumFaces, & getNumVerticesOfFace, & getPosition, & getNormal, & getTexCoord, & setTSpaceBasic
-            };
-
-            SMikkTSpaceContext context{
-                &interface,
-                &mesh
-            };
-
-            auto res = genTangSpaceDefault(&context);
-            if (!res) {
-                throw std::runtime_error("calculate mikktspace failed");
-            }
+            BuildTimer timer;
+            generateTangents(pMesh, mesh);
+            BuildReport::record("tangents", pMesh->GetNode() ? pMesh->GetNode()->GetName() : pMesh->GetName(), timer.elapsed());
         }
     }
 }
@@ -573,6 +508,9 @@ void fillBufferByPoint(const MeshBufferLayout& layout,
                     case Format::R16G16B16A16_SFLOAT:
                         readByPoint<PolygonSize, Vector4hu>(pMesh, pMesh->GetElementNormal(slot), buffer, stride);
                         break;
+                    case Format::R8G8B8A8_SNORM:
+                        readByPoint<PolygonSize, Snorm4>(pMesh, pMesh->GetElementNormal(slot), buffer, stride);
+                        break;
                     default:
                         throw std::invalid_argument("normal Format not support");
                     }
@@ -594,6 +532,9 @@ void fillBufferByPoint(const MeshBufferLayout& layout,
                     case Format::R16G16B16A16_SFLOAT:
                         readByPoint<PolygonSize, Vector4hu>(pMesh, pMesh->GetElementTangent(slot), buffer, stride);
                         break;
+                    case Format::R8G8B8A8_SNORM:
+                        readByPoint<PolygonSize, Snorm4>(pMesh, pMesh->GetElementTangent(slot), buffer, stride);
+                        break;
                     default:
                         throw std::invalid_argument("tangent Format not support");
                     }
@@ -852,7 +793,7 @@ void AssetFbxScene::validateMaterialFiles(fbxsdk::FbxNode* pFbxNode) const {
 }
 
 void AssetFbxScene::readInfo(const FbxInfo& info,
-    MetaIDNameIndex<MeshInfo>& meshInfo, std::unordered_set<MetaID>& assets
+    MetaIDNameIndex<MeshInfo>& meshInfo, MetaIDUnorderedSet& assets
 ) const {
     std::set<const fbxsdk::FbxMesh*> meshes;
     std::set<std::string> names;
@@ -862,7 +803,7 @@ void AssetFbxScene::readInfo(const FbxInfo& info,
 
 void AssetFbxScene::readMeshInfo(fbxsdk::FbxNode* pFbxNode, std::set<const fbxsdk::FbxMesh*>& meshes,
     std::set<std::string>& names, size_t& meshID, const FbxInfo& info,
-    MetaIDNameIndex<MeshInfo>& meshInfo, std::unordered_set<MetaID>& assets
+    MetaIDNameIndex<MeshInfo>& meshInfo, MetaIDUnorderedSet& assets
 ) const {
     // first pass
     auto pAttribute = pFbxNode->GetNodeAttribute();
@@ -886,7 +827,7 @@ void AssetFbxScene::readMeshInfo(fbxsdk::FbxNode* pFbxNode, std::set<const fbxsd
 void AssetFbxScene::readMeshInfo(const fbxsdk::FbxMesh* pMesh,
     std::set<std::string>& names, size_t& meshID,
     const FbxInfo& info, MetaIDNameIndex<MeshInfo>& meshInfo,
-    std::unordered_set<MetaID>& assets
+    MetaIDUnorderedSet& assets
 ) const {
     auto meshName = getMeshName(pMesh, names, meshID);
     boost::uuids::name_generator_latest gen(mMetaID);
@@ -953,26 +894,49 @@ void AssetFbxScene::readMeshInfo(const fbxsdk::FbxMesh* pMesh,
     Ensures(res.second);
 }
 
-void AssetFbxScene::readMeshes(std::string_view layout, Resources& resources) const {
+void AssetFbxScene::readMeshes(std::string_view layout, const ContentSettings& settings,
+    PmrMetaIDUnorderedMap<MeshData>& meshes
+) const {
+    std::set<const fbxsdk::FbxMesh*> visited;
+    std::vector<const fbxsdk::FbxMesh*> ordered;
+    collectMeshes(mScene->GetRootNode(), visited, ordered);
+
+    // names depend on traversal order, slots are created before the parallel pass
     size_t meshID = 0;
-    std::set<const fbxsdk::FbxMesh*> meshes;
     std::set<std::string> names;
-    readMeshes(layout, mScene->GetRootNode(), resources, meshes, names, meshID);
-    Ensures(meshes.size() == names.size());
+    boost::uuids::name_generator_latest gen(mMetaID);
+    std::vector<std::pair<const fbxsdk::FbxMesh*, MeshData*>> tasks;
+    tasks.reserve(ordered.size());
+    for (const auto* pMesh : ordered) {
+        auto metaID = gen(getMeshName(pMesh, names, meshID));
+        auto [iter, added] = meshes.emplace(
+            std::piecewise_construct,
+            std::forward_as_tuple(metaID),
+            std::forward_as_tuple());
+        if (!added) {
+            throw std::runtime_error("mesh name uuid collision");
+        }
+        tasks.emplace_back(pMesh, &iter->second);
+    }
+    Ensures(ordered.size() == names.size());
+
+    // fbx meshes are only read, vertex processing is independent per mesh
+    std::for_each(std::execution::par, tasks.begin(), tasks.end(),
+        [&](const std::pair<const fbxsdk::FbxMesh*, MeshData*>& task) {
+            readMesh(layout, task.first, settings, *task.second);
+        });
 }
 
-void AssetFbxScene::readMeshes(std::string_view layout,
-    fbxsdk::FbxNode* pFbxNode, Resources& resources,
-    std::set<const fbxsdk::FbxMesh*>& meshes, std::set<std::string>& names, size_t& meshID
+void AssetFbxScene::collectMeshes(fbxsdk::FbxNode* pFbxNode,
+    std::set<const fbxsdk::FbxMesh*>& meshes, std::vector<const fbxsdk::FbxMesh*>& ordered
 ) const {
-    // first pass
     auto pAttribute = pFbxNode->GetNodeAttribute();
     if (pAttribute) {
         switch (pAttribute->GetAttributeType()) {
         case fbxsdk::FbxNodeAttribute::eMesh:
             auto res = meshes.emplace(static_cast<const FbxMesh*>(pAttribute));
             if (res.second) {
-                readMesh(layout, *res.first, resources, names, meshID);
+                ordered.emplace_back(*res.first);
             }
             break;
         }
@@ -980,33 +944,16 @@ void AssetFbxScene::readMeshes(std::string_view layout,
 
     int childCount = pFbxNode->GetChildCount();
     for (int i = 0; i != childCount; ++i) {
-        readMeshes(layout, pFbxNode->GetChild(i), resources, meshes, names, meshID);
+        collectMeshes(pFbxNode->GetChild(i), meshes, ordered);
     }
 }
 
-void AssetFbxScene::readMesh(std::string_view layoutName,
-    const fbxsdk::FbxMesh* pMesh, Resources& resources,
-    std::set<std::string>& names, size_t& meshID
+void AssetFbxScene::readMesh(std::string_view layoutName, const fbxsdk::FbxMesh* pMesh,
+    const ContentSettings& settings, MeshData& mesh
 ) const {
-    auto meshName = getMeshName(pMesh, names, meshID);
-    boost::uuids::name_generator_latest gen(mMetaID);
-    auto metaID = gen(meshName);
-    auto iter = resources.mMeshes.find(metaID);
-    if (iter != resources.mMeshes.end()) {
-        throw std::runtime_error("mesh name uuid collision");
-    }
-
-    bool added;
-    std::tie(iter, added) = resources.mMeshes.emplace(
-        std::piecewise_construct,
-        std::forward_as_tuple(metaID),
-        std::forward_as_tuple());
-    Ensures(added);
-
-    auto& mesh = iter->second;
     mesh.mLayoutName = layoutName;
-    mesh.mLayoutID = resources.mSettings.mVertexLayoutIndex.at(mesh.mLayoutName);
-    const auto& layout = resources.mSettings.mVertexLayouts.at(mesh.mLayoutID);
+    mesh.mLayoutID = settings.mVertexLayoutIndex.at(mesh.mLayoutName);
+    const auto& layout = settings.mVertexLayouts.at(mesh.mLayoutID);
     checkLayoutRequirement(layout, pMesh);
 
     int faceCount = pMesh->GetPolygonCount();
@@ -1055,10 +1002,23 @@ void AssetFbxScene::readMesh(std::string_view layoutName,
     if (byPolygon)
         byVertex = true;
 
+    // generated tangents are per polygon vertex
+    if (pMesh->GetElementTangentCount() == 0) {
+        for (const auto& vb : layout.mBuffers) {
+            for (const auto& e : vb.mElements) {
+                if (std::holds_alternative<TANGENT_>(e.mType)) {
+                    byVertex = true;
+                }
+            }
+        }
+    }
+
     const int PolygonSize = 3;
 
     if (byVertex) {
+        // every polygon vertex is emitted, shared ones are merged afterwards
         fillBufferByVertex(layout, pMesh, mesh);
+        weldVertices(mesh);
     } else {
         fillBufferByPoint(layout, pMesh, mesh);
     }
@@ -1103,6 +1063,10 @@ void AssetFbxScene::readMesh(std::string_view layoutName,
 
         mesh.mSubMeshes.emplace_back(SubMeshData{ prevOffset * PolygonSize, (meshFaceCount - prevOffset) * PolygonSize });
     }
+
+    optimizeMesh(mesh, pMesh->GetName());
+    buildMeshlets(mesh);
+    buildMeshLods(mesh, pMesh->GetName());
 }
 
 void AssetFbxScene::readFlattenedNodes(const MetaIDNameIndex<MeshInfo>& meshInfo,
@@ -48,9 +48,11 @@ public:
     void createMaterials(const std::function<void(std::string_view, const Map<std::string, std::string>&)>& func) const;
 
     void readInfo(const FbxInfo& info, MetaIDNameIndex<MeshInfo>& meshInfo,
-        std::unordered_set<MetaID>& assets) const;
+        MetaIDUnorderedSet& assets) const;
 
-    void readMeshes(std::string_view layout, Graphics::Render::Resources& resources) const;
+    // meshes of the scene are processed in parallel, metaIDs are named in traversal order
+    void readMeshes(std::string_view layout, const Graphics::Render::ContentSettings& settings,
+        PmrMetaIDUnorderedMap<Graphics::Render::MeshData>& meshes) const;
 
     void readFlattenedNodes(const MetaIDNameIndex<MeshInfo>& meshInfo,
         Graphics::Render::FlattenedObjects& batch) const;
@@ -66,20 +68,18 @@ private:
 
     void readMeshInfo(fbxsdk::FbxNode* pFbxNode, std::set<const fbxsdk::FbxMesh*>& meshes,
         std::set<std::string>& names, size_t& meshID, const FbxInfo& info,
-        MetaIDNameIndex<MeshInfo>& meshInfo, std::unordered_set<MetaID>& assets) const;
+        MetaIDNameIndex<MeshInfo>& meshInfo, MetaIDUnorderedSet& assets) const;
 
     void readMeshInfo(const fbxsdk::FbxMesh* pMesh,
         std::set<std::string>& names, size_t& meshID,
         const FbxInfo& info, MetaIDNameIndex<MeshInfo>& meshInfo,
-        std::unordered_set<MetaID>& assets) const;
+        MetaIDUnorderedSet& assets) const;
 
-    void readMeshes(std::string_view layout, 
-        fbxsdk::FbxNode* pFbxNode, Graphics::Render::Resources& resources,
-        std::set<const fbxsdk::FbxMesh*>& meshes, std::set<std::string>& names, size_t& meshID) const;
+    void collectMeshes(fbxsdk::FbxNode* pFbxNode, std::set<const fbxsdk::FbxMesh*>& meshes,
+        std::vector<const fbxsdk::FbxMesh*>& ordered) const;
 
-    void readMesh(std::string_view layout,
-        const fbxsdk::FbxMesh* pMesh, Graphics::Render::Resources& resources,
-        std::set<std::string>& names, size_t& meshID) const;
+    void readMesh(std::string_view layout, const fbxsdk::FbxMesh* pMesh,
+        const Graphics::Render::ContentSettings& settings, Graphics::Render::MeshData& mesh) const;
 
     void readFlattenedNodes(fbxsdk::FbxNode* pFbxNode, const MetaIDNameIndex<MeshInfo>& resources,
         Graphics::Render::FlattenedObjects& batch, size_t& nodeID,
@@ -34,6 +34,14 @@ void toEigen(const Vector& src, Eigen::Matrix<uint8_t, Size, 1, Options, MaxRows
     }
 }
 
+template<int Size, int Options, int MaxRows, int MaxCols, class Vector>
+void toEigen(const Vector& src, Eigen::Matrix<int8_t, Size, 1, Options, MaxRows, MaxCols>& dst) {
+    for (int i = 0; i != Size; ++i) {
+        const float v = std::clamp(static_cast<float>(src[i]), -1.f, 1.f);
+        dst[i] = static_cast<int8_t>(std::lround(v * 127.f));
+    }
+}
+
 template<class LayerElement>
 MappingMode getMappingMode(const LayerElement* pLayer) {
     switch (pLayer->GetMappingMode()) {
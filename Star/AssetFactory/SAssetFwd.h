@@ -31,6 +31,10 @@ struct ContentInfo;
 struct RenderGraphInfo;
 struct FbxImportSettings;
 struct AssetDatabase;
+struct BuildRecord;
+struct BuildDatabase;
+struct ScanRecord;
+struct ScanCache;
 struct Direct_;
 struct IndexToDirect_;
 
@@ -0,0 +1,1120 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+#include "SAssetMesh.h"
+#include <Star/SHalf.h>
+#include <queue>
+
+namespace Star::Asset {
+
+using namespace Graphics::Render;
+
+namespace {
+
+std::vector<uint32_t> readIndices(const IndexBufferData& ib) {
+    std::vector<uint32_t> indices(ib.mBuffer.size() / ib.mElementSize);
+    if (ib.mElementSize == 2) {
+        const auto* pIndices = reinterpret_cast<const uint16_t*>(ib.mBuffer.data());
+        std::copy(pIndices, pIndices + indices.size(), indices.begin());
+    } else if (ib.mElementSize == 4) {
+        const auto* pIndices = reinterpret_cast<const uint32_t*>(ib.mBuffer.data());
+        std::copy(pIndices, pIndices + indices.size(), indices.begin());
+    } else {
+        throw std::invalid_argument("index element size must be 2 or 4");
+    }
+    return indices;
+}
+
+void writeIndices(const std::vector<uint32_t>& indices, uint32_t vertexCount, IndexBufferData& ib) {
+    ib.mElementSize = vertexCount <= 65536 ? 2 : 4;
+    ib.mBuffer.resize(indices.size() * ib.mElementSize);
+    if (ib.mElementSize == 2) {
+        auto* pIndices = reinterpret_cast<uint16_t*>(ib.mBuffer.data());
+        for (size_t i = 0; i != indices.size(); ++i) {
+            pIndices[i] = gsl::narrow_cast<uint16_t>(indices[i]);
+        }
+    } else {
+        std::copy(indices.begin(), indices.end(), reinterpret_cast<uint32_t*>(ib.mBuffer.data()));
+    }
+}
+
+struct CacheStats {
+    float mACMR = 0; // misses per triangle
+    float mATVR = 0; // misses per vertex
+};
+
+// fifo cache of typical hardware
+CacheStats getCacheStats(const std::vector<uint32_t>& indices, uint32_t vertexCount) {
+    constexpr uint32_t cacheSize = 16;
+    CacheStats stats;
+    if (indices.empty() || !vertexCount)
+        return stats;
+
+    std::vector<uint32_t> timestamps(vertexCount, 0);
+    uint32_t time = cacheSize + 1;
+    uint32_t misses = 0;
+    for (auto v : indices) {
+        if (time - timestamps[v] > cacheSize) {
+            timestamps[v] = time++;
+            ++misses;
+        }
+    }
+    stats.mACMR = float(misses) / float(indices.size() / 3);
+    stats.mATVR = float(misses) / float(vertexCount);
+    return stats;
+}
+
+// https://tomforsyth1000.github.io/papers/fast_vert_cache_opt.html
+constexpr int32_t sForsythCacheSize = 32;
+
+float getForsythScore(int32_t cachePos, uint32_t valence) noexcept {
+    if (!valence)
+        return -1.0f;
+    float score = 0;
+    if (cachePos >= 0) {
+        if (cachePos < 3) {
+            // last triangle, discourage using it again immediately
+            score = 0.75f;
+        } else {
+            score = std::pow(1.0f - float(cachePos - 3) / float(sForsythCacheSize - 3), 1.5f);
+        }
+    }
+    // favor finishing vertices with few triangles left
+    return score + 2.0f * std::pow(float(valence), -0.5f);
+}
+
+void optimizeVertexCache(uint32_t* indices, uint32_t indexCount, uint32_t vertexCount) {
+    const uint32_t triangleCount = indexCount / 3;
+    if (triangleCount < 2)
+        return;
+
+    // triangles of each vertex, compacted as they are emitted
+    std::vector<uint32_t> offsets(vertexCount + 1, 0);
+    for (uint32_t i = 0; i != indexCount; ++i) {
+        ++offsets[indices[i] + 1];
+    }
+    for (uint32_t v = 0; v != vertexCount; ++v) {
+        offsets[v + 1] += offsets[v];
+    }
+    std::vector<uint32_t> valences(vertexCount, 0);
+    std::vector<uint32_t> adjacency(indexCount);
+    for (uint32_t t = 0; t != triangleCount; ++t) {
+        for (uint32_t k = 0; k != 3; ++k) {
+            auto v = indices[t * 3 + k];
+            adjacency[offsets[v] + valences[v]++] = t;
+        }
+    }
+
+    std::vector<int32_t> cachePos(vertexCount, -1);
+    std::vector<float> vertexScores(vertexCount);
+    for (uint32_t v = 0; v != vertexCount; ++v) {
+        vertexScores[v] = getForsythScore(-1, valences[v]);
+    }
+    std::vector<float> triangleScores(triangleCount);
+    for (uint32_t t = 0; t != triangleCount; ++t) {
+        triangleScores[t] = vertexScores[indices[t * 3]]
+            + vertexScores[indices[t * 3 + 1]]
+            + vertexScores[indices[t * 3 + 2]];
+    }
+
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<uint32_t> output;
+    output.reserve(indexCount);
+    std::array<uint32_t, sForsythCacheSize + 3> cache;
+    uint32_t cacheCount = 0;
+    uint32_t cursor = 0;
+
+    auto best = std::optional<uint32_t>(0);
+    while (best) {
+        const auto t = *best;
+        Expects(!emitted[t]);
+        emitted[t] = true;
+
+        // new cache, emitted vertices first
+        std::array<uint32_t, sForsythCacheSize + 3> next;
+        uint32_t nextCount = 0;
+        for (uint32_t k = 0; k != 3; ++k) {
+            auto v = indices[t * 3 + k];
+            output.emplace_back(v);
+            next[nextCount++] = v;
+
+            // remove the triangle from the vertex
+            auto* first = adjacency.data() + offsets[v];
+            auto* last = first + valences[v];
+            std::iter_swap(std::find(first, last, t), last - 1);
+            --valences[v];
+        }
+        for (uint32_t i = 0; i != cacheCount; ++i) {
+            auto v = cache[i];
+            if (v != next[0] && v != next[1] && v != next[2]) {
+                next[nextCount++] = v;
+            }
+        }
+
+        // rescore vertices of the old and new cache, and their triangles
+        for (uint32_t i = 0; i != nextCount; ++i) {
+            auto v = next[i];
+            cachePos[v] = i < uint32_t(sForsythCacheSize) ? int32_t(i) : -1;
+            auto score = getForsythScore(cachePos[v], valences[v]);
+            auto delta = score - vertexScores[v];
+            vertexScores[v] = score;
+            for (uint32_t j = 0; j != valences[v]; ++j) {
+                triangleScores[adjacency[offsets[v] + j]] += delta;
+            }
+        }
+        cacheCount = std::min(nextCount, uint32_t(sForsythCacheSize));
+        std::copy_n(next.begin(), cacheCount, cache.begin());
+
+        // best triangle touching the cache, otherwise the next one in input order
+        best.reset();
+        float bestScore = -1.0f;
+        for (uint32_t i = 0; i != cacheCount; ++i) {
+            auto v = cache[i];
+            for (uint32_t j = 0; j != valences[v]; ++j) {
+                auto candidate = adjacency[offsets[v] + j];
+                if (triangleScores[candidate] > bestScore) {
+                    bestScore = triangleScores[candidate];
+                    best = candidate;
+                }
+            }
+        }
+        if (!best) {
+            while (cursor != triangleCount && emitted[cursor]) {
+                ++cursor;
+            }
+            if (cursor != triangleCount) {
+                best = cursor;
+            }
+        }
+    }
+    Ensures(output.size() == indexCount);
+    std::copy(output.begin(), output.end(), indices);
+}
+
+std::vector<Eigen::Vector3f> readPositions(const MeshData& mesh) {
+    for (const auto& vb : mesh.mVertexBuffers) {
+        for (const auto& e : vb.mDesc.mElements) {
+            if (!std::holds_alternative<SV_Position_>(e.mType))
+                continue;
+            std::vector<Eigen::Vector3f> positions(vb.mVertexCount);
+            for (uint32_t v = 0; v != vb.mVertexCount; ++v) {
+                const auto* p = vb.mBuffer.data() + size_t(v) * vb.mDesc.mVertexSize + e.mAlignedByteOffset;
+                switch (e.mFormat) {
+                case Format::R32G32B32A32_SFLOAT:
+                case Format::R32G32B32_SFLOAT: {
+                    std::array<float, 3> xyz;
+                    std::memcpy(xyz.data(), p, sizeof(xyz));
+                    positions[v] = Eigen::Vector3f(xyz[0], xyz[1], xyz[2]);
+                    break;
+                }
+                case Format::R16G16B16A16_SFLOAT: {
+                    std::array<half, 3> xyz;
+                    std::memcpy(xyz.data(), p, sizeof(xyz));
+                    positions[v] = Eigen::Vector3f(float(xyz[0]), float(xyz[1]), float(xyz[2]));
+                    break;
+                }
+                default:
+                    return {};
+                }
+            }
+            return positions;
+        }
+    }
+    return {};
+}
+
+// vertices converted per task, kernels widen each batch into contiguous floats for the simd conversions
+constexpr size_t sVertexBatchSize = 1024;
+
+// converts count vertices of one element, strides are the vertex sizes of the buffers
+using VertexKernel = void (*)(const char* src, uint32_t srcStride, char* dst, uint32_t dstStride, size_t count);
+
+// components missing in the source are 0, w is 1
+void padComponents(float* v, uint32_t first, uint32_t count) noexcept {
+    for (uint32_t k = first; k < count; ++k) {
+        v[k] = k == 3 ? 1.f : 0.f;
+    }
+}
+
+// rounded to nearest even, the scalar tail matches the simd rounding
+void quantizeSnorm8(const float* src, int8_t* dst, size_t count) noexcept {
+    size_t i = 0;
+#ifdef __AVX2__
+    const auto lo = _mm_set1_ps(-1.f);
+    const auto hi = _mm_set1_ps(1.f);
+    const auto scale = _mm_set1_ps(127.f);
+    for (; i + 8 <= count; i += 8) {
+        auto a = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i), lo), hi), scale));
+        auto b = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i + 4), lo), hi), scale));
+        auto words = _mm_packs_epi32(a, b);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i), _mm_packs_epi16(words, words));
+    }
+#endif
+    for (; i != count; ++i) {
+        dst[i] = static_cast<int8_t>(std::lrint(std::clamp(src[i], -1.f, 1.f) * 127.f));
+    }
+}
+
+void quantizeUnorm16(const float* src, uint16_t* dst, size_t count) noexcept {
+    size_t i = 0;
+#ifdef __AVX2__
+    const auto lo = _mm_setzero_ps();
+    const auto hi = _mm_set1_ps(1.f);
+    const auto scale = _mm_set1_ps(65535.f);
+    for (; i + 8 <= count; i += 8) {
+        auto a = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i), lo), hi), scale));
+        auto b = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i + 4), lo), hi), scale));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi32(a, b));
+    }
+#endif
+    for (; i != count; ++i) {
+        dst[i] = static_cast<uint16_t>(std::lrint(std::clamp(src[i], 0.f, 1.f) * 65535.f));
+    }
+}
+
+// element formats, read widens vertices to n floats each, write narrows Components floats each
+template<Format F, uint32_t N>
+struct Float32Element {
+    static constexpr Format sFormat = F;
+    static constexpr uint32_t Components = N;
+    static constexpr uint32_t sSize = sizeof(float) * N;
+
+    static void read(const char* src, uint32_t stride, float* dst, uint32_t n, size_t count) noexcept {
+        for (size_t i = 0; i != count; ++i, src += stride, dst += n) {
+            std::memcpy(dst, src, sizeof(float) * std::min(N, n));
+            padComponents(dst, N, n);
+        }
+    }
+    static void write(const float* src, char* dst, uint32_t stride, size_t count) noexcept {
+        for (size_t i = 0; i != count; ++i, src += N, dst += stride) {
+            std::memcpy(dst, src, sizeof(float) * N);
+        }
+    }
+};
+
+template<Format F, uint32_t N>
+struct Float16Element {
+    static constexpr Format sFormat = F;
+    static constexpr uint32_t Components = N;
+    static constexpr uint32_t sSize = sizeof(half) * N;
+
+    static void read(const char* src, uint32_t stride, float* dst, uint32_t n, size_t count) noexcept {
+        std::array<half, sVertexBatchSize * 4> halves;
+        for (size_t i = 0; i != count; ++i, src += stride) {
+            auto* v = halves.data() + i * n;
+            std::memcpy(v, src, sizeof(half) * std::min(N, n));
+            for (uint32_t k = N; k < n; ++k) {
+                v[k] = half(k == 3 ? 1.f : 0.f);
+            }
+        }
+        convertHalfToFloat(gsl::span<const half>(halves.data(), count * n), gsl::span<float>(dst, count * n));
+    }
+    static void write(const float* src, char* dst, uint32_t stride, size_t count) noexcept {
+        std::array<half, sVertexBatchSize * N> halves;
+        convertFloatToHalf(gsl::span<const float>(src, count * N), gsl::span<half>(halves.data(), count * N));
+        for (size_t i = 0; i != count; ++i, dst += stride) {
+            std::memcpy(dst, halves.data() + i * N, sizeof(half) * N);
+        }
+    }
+};
+
+// packed normals and tangents, the tangent sign is kept in w
+struct Snorm8x4Element {
+    static constexpr Format sFormat = Format::R8G8B8A8_SNORM;
+    static constexpr uint32_t Components = 4;
+    static constexpr uint32_t sSize = 4;
+
+    static void read(const char* src, uint32_t stride, float* dst, uint32_t n, size_t count) noexcept {
+        for (size_t i = 0; i != count; ++i, src += stride, dst += n) {
+            const auto* p = reinterpret_cast<const int8_t*>(src);
+            for (uint32_t k = 0; k != std::min(Components, n); ++k) {
+                dst[k] = std::max(p[k] / 127.f, -1.f);
+            }
+        }
+    }
+    static void write(const float* src, char* dst, uint32_t stride, size_t count) noexcept {
+        std::array<int8_t, sVertexBatchSize * 4> packed;
+        quantizeSnorm8(src, packed.data(), count * 4);
+        for (size_t i = 0; i != count; ++i, dst += stride) {
+            std::memcpy(dst, packed.data() + i * 4, 4);
+        }
+    }
+};
+
+struct Unorm16x2Element {
+    static constexpr Format sFormat = Format::R16G16_UNORM;
+    static constexpr uint32_t Components = 2;
+    static constexpr uint32_t sSize = sizeof(uint16_t) * 2;
+
+    static void read(const char* src, uint32_t stride, float* dst, uint32_t n, size_t count) noexcept {
+        for (size_t i = 0; i != count; ++i, src += stride, dst += n) {
+            std::array<uint16_t, 2> p;
+            std::memcpy(p.data(), src, sizeof(p));
+            for (uint32_t k = 0; k != std::min(Components, n); ++k) {
+                dst[k] = p[k] / 65535.f;
+            }
+            padComponents(dst, Components, n);
+        }
+    }
+    static void write(const float* src, char* dst, uint32_t stride, size_t count) noexcept {
+        std::array<uint16_t, sVertexBatchSize * 2> packed;
+        quantizeUnorm16(src, packed.data(), count * 2);
+        for (size_t i = 0; i != count; ++i, dst += stride) {
+            std::memcpy(dst, packed.data() + i * 2, sizeof(uint16_t) * 2);
+        }
+    }
+};
+
+template<uint32_t Size>
+void copyElement(const char* src, uint32_t srcStride, char* dst, uint32_t dstStride, size_t count) {
+    for (size_t i = 0; i != count; ++i, src += srcStride, dst += dstStride) {
+        std::memcpy(dst, src, Size);
+    }
+}
+
+template<class Src, class Dst>
+void convertElement(const char* src, uint32_t srcStride, char* dst, uint32_t dstStride, size_t count) {
+    Expects(count <= sVertexBatchSize);
+    std::array<float, sVertexBatchSize * Dst::Components> floats;
+    Src::read(src, srcStride, floats.data(), Dst::Components, count);
+    Dst::write(floats.data(), dst, dstStride, count);
+}
+
+template<class Src, class... Dsts>
+void addVertexKernels(std::map<std::pair<Format, Format>, VertexKernel>& kernels) {
+    (kernels.emplace(std::pair(Src::sFormat, Dsts::sFormat), Src::sFormat == Dsts::sFormat
+        ? &copyElement<Src::sSize> : &convertElement<Src, Dsts>), ...);
+}
+
+template<class... Elements>
+std::map<std::pair<Format, Format>, VertexKernel> buildVertexKernels() {
+    std::map<std::pair<Format, Format>, VertexKernel> kernels;
+    (addVertexKernels<Elements, Elements...>(kernels), ...);
+    return kernels;
+}
+
+VertexKernel getVertexKernel(Format src, Format dst) {
+    static const auto sKernels = buildVertexKernels<
+        Float32Element<Format::R32G32B32A32_SFLOAT, 4>,
+        Float32Element<Format::R32G32B32_SFLOAT, 3>,
+        Float32Element<Format::R32G32_SFLOAT, 2>,
+        Float16Element<Format::R16G16B16A16_SFLOAT, 4>,
+        Float16Element<Format::R16G16_SFLOAT, 2>,
+        Snorm8x4Element,
+        Unorm16x2Element>();
+    auto iter = sKernels.find(std::pair(src, dst));
+    if (iter == sKernels.end()) {
+        throw std::invalid_argument("vertex format conversion not supported");
+    }
+    return iter->second;
+}
+
+}
+
+Aabb3f getMeshBounds(const MeshData& mesh) {
+    Aabb3f bounds;
+    for (const auto& p : readPositions(mesh)) {
+        bounds.grow(p);
+    }
+    return bounds;
+}
+
+namespace {
+
+// clusters start where the cache order jumps, drawn outside facing first
+// Sander et al., Fast Triangle Reordering for Vertex Locality and Reduced Overdraw
+void optimizeOverdraw(uint32_t* indices, uint32_t indexCount, uint32_t vertexCount,
+    const std::vector<Eigen::Vector3f>& positions
+) {
+    constexpr uint32_t minClusterSize = 64;
+    const uint32_t triangleCount = indexCount / 3;
+    if (triangleCount < minClusterSize * 2)
+        return;
+
+    std::vector<uint32_t> clusters{ 0 };
+    {
+        constexpr uint32_t cacheSize = 16;
+        std::vector<uint32_t> timestamps(vertexCount, 0);
+        uint32_t time = cacheSize + 1;
+        for (uint32_t t = 0; t != triangleCount; ++t) {
+            uint32_t misses = 0;
+            for (uint32_t k = 0; k != 3; ++k) {
+                auto v = indices[t * 3 + k];
+                if (time - timestamps[v] > cacheSize) {
+                    timestamps[v] = time++;
+                    ++misses;
+                }
+            }
+            if (misses == 3 && t - clusters.back() >= minClusterSize) {
+                clusters.emplace_back(t);
+            }
+        }
+    }
+    clusters.emplace_back(triangleCount);
+    const auto clusterCount = clusters.size() - 1;
+    if (clusterCount < 2)
+        return;
+
+    Eigen::Vector3f meshCenter = Eigen::Vector3f::Zero();
+    for (uint32_t i = 0; i != indexCount; ++i) {
+        meshCenter += positions[indices[i]];
+    }
+    meshCenter /= float(indexCount);
+
+    std::vector<std::pair<float, uint32_t>> order(clusterCount);
+    for (uint32_t c = 0; c != clusterCount; ++c) {
+        Eigen::Vector3f center = Eigen::Vector3f::Zero();
+        Eigen::Vector3f normal = Eigen::Vector3f::Zero();
+        float areaSum = 0;
+        for (uint32_t t = clusters[c]; t != clusters[c + 1]; ++t) {
+            const auto& p0 = positions[indices[t * 3]];
+            const auto& p1 = positions[indices[t * 3 + 1]];
+            const auto& p2 = positions[indices[t * 3 + 2]];
+            // area weighted
+            Eigen::Vector3f n = (p1 - p0).cross(p2 - p0);
+            auto area = n.norm();
+            center += (p0 + p1 + p2) * (area / 3.0f);
+            normal += n;
+            areaSum += area;
+        }
+        float dp = 0;
+        auto normalLength = normal.norm();
+        if (areaSum > 0 && normalLength > 0) {
+            center /= areaSum;
+            dp = (center - meshCenter).dot(normal / normalLength);
+        }
+        order[c] = { -dp, c };
+    }
+    std::stable_sort(order.begin(), order.end());
+
+    std::vector<uint32_t> output;
+    output.reserve(indexCount);
+    for (const auto& [dp, c] : order) {
+        output.insert(output.end(), indices + clusters[c] * 3, indices + clusters[c + 1] * 3);
+    }
+    std::copy(output.begin(), output.end(), indices);
+}
+
+// vertices renumbered in first use order, unreferenced ones are dropped
+uint32_t optimizeVertexFetch(MeshData& mesh, std::vector<uint32_t>& indices) {
+    const auto vertexCount = mesh.mVertexBuffers.front().mVertexCount;
+    constexpr uint32_t unused = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> remap(vertexCount, unused);
+    std::vector<uint32_t> order;
+    order.reserve(vertexCount);
+    for (auto& i : indices) {
+        if (remap[i] == unused) {
+            remap[i] = gsl::narrow_cast<uint32_t>(order.size());
+            order.emplace_back(i);
+        }
+        i = remap[i];
+    }
+
+    const auto newCount = gsl::narrow_cast<uint32_t>(order.size());
+    for (auto& vb : mesh.mVertexBuffers) {
+        const auto stride = vb.mDesc.mVertexSize;
+        std::pmr::vector<char> buffer(size_t(newCount) * stride, vb.mBuffer.get_allocator());
+        for (uint32_t i = 0; i != newCount; ++i) {
+            std::copy_n(vb.mBuffer.data() + size_t(order[i]) * stride, stride,
+                buffer.data() + size_t(i) * stride);
+        }
+        vb.mBuffer = std::move(buffer);
+        vb.mVertexCount = newCount;
+    }
+    return newCount;
+}
+
+constexpr uint32_t sMeshletMaxVertices = 64;
+constexpr uint32_t sMeshletMaxTriangles = 124;
+
+// Ritter bounding sphere, cone culling is disabled when normals spread too wide
+void computeMeshletBounds(const MeshData& mesh, const std::vector<Eigen::Vector3f>& positions,
+    MeshletData& meshlet
+) {
+    Expects(meshlet.mVertexCount);
+    const auto* pVertices = mesh.mMeshletVertices.data() + meshlet.mVertexOffset;
+    const auto* pTriangles = mesh.mMeshletTriangles.data() + size_t(meshlet.mTriangleOffset) * 3;
+
+    auto farthest = [&](const Eigen::Vector3f& from) {
+        uint32_t best = 0;
+        float bestDist = -1;
+        for (uint32_t i = 0; i != meshlet.mVertexCount; ++i) {
+            auto d = (positions[pVertices[i]] - from).squaredNorm();
+            if (d > bestDist) {
+                bestDist = d;
+                best = i;
+            }
+        }
+        return positions[pVertices[best]];
+    };
+    const Eigen::Vector3f p1 = farthest(positions[pVertices[0]]);
+    const Eigen::Vector3f p2 = farthest(p1);
+    Eigen::Vector3f center = (p1 + p2) * 0.5f;
+    float radius = (p2 - p1).norm() * 0.5f;
+    for (uint32_t i = 0; i != meshlet.mVertexCount; ++i) {
+        const auto& p = positions[pVertices[i]];
+        auto d = (p - center).norm();
+        if (d > radius) {
+            auto newRadius = (radius + d) * 0.5f;
+            center += (p - center) * ((d - newRadius) / d);
+            radius = newRadius;
+        }
+    }
+    meshlet.mCenter = center;
+    meshlet.mRadius = radius;
+
+    std::array<Eigen::Vector3f, sMeshletMaxTriangles> normals;
+    uint32_t normalCount = 0;
+    Eigen::Vector3f axis = Eigen::Vector3f::Zero();
+    for (uint32_t t = 0; t != meshlet.mTriangleCount; ++t) {
+        const auto& p0 = positions[pVertices[pTriangles[t * 3]]];
+        const auto& p1 = positions[pVertices[pTriangles[t * 3 + 1]]];
+        const auto& p2 = positions[pVertices[pTriangles[t * 3 + 2]]];
+        Eigen::Vector3f n = (p1 - p0).cross(p2 - p0);
+        auto area = n.norm();
+        if (area == 0)
+            continue;
+        normals[normalCount++] = n / area;
+        axis += n / area;
+    }
+    meshlet.mConeAxis = Eigen::Vector3f::Zero();
+    meshlet.mConeCutoff = 1;
+    auto axisLength = axis.norm();
+    if (normalCount == 0 || axisLength == 0)
+        return;
+    axis /= axisLength;
+    float minDot = 1;
+    for (uint32_t i = 0; i != normalCount; ++i) {
+        minDot = std::min(minDot, axis.dot(normals[i]));
+    }
+    meshlet.mConeAxis = axis;
+    // cone wider than ~84 degrees rarely culls, keep it disabled
+    if (minDot > 0.1f) {
+        meshlet.mConeCutoff = std::sqrt(1 - minDot * minDot);
+    }
+}
+
+// symmetric 4x4 matrix of summed plane equations, upper triangle
+struct Quadric {
+    double a00 = 0, a01 = 0, a02 = 0, a03 = 0;
+    double a11 = 0, a12 = 0, a13 = 0;
+    double a22 = 0, a23 = 0;
+    double a33 = 0;
+
+    void addPlane(const Eigen::Vector3d& n, double d) noexcept {
+        a00 += n.x() * n.x(); a01 += n.x() * n.y(); a02 += n.x() * n.z(); a03 += n.x() * d;
+        a11 += n.y() * n.y(); a12 += n.y() * n.z(); a13 += n.y() * d;
+        a22 += n.z() * n.z(); a23 += n.z() * d;
+        a33 += d * d;
+    }
+    Quadric& operator+=(const Quadric& rhs) noexcept {
+        a00 += rhs.a00; a01 += rhs.a01; a02 += rhs.a02; a03 += rhs.a03;
+        a11 += rhs.a11; a12 += rhs.a12; a13 += rhs.a13;
+        a22 += rhs.a22; a23 += rhs.a23;
+        a33 += rhs.a33;
+        return *this;
+    }
+    // sum of squared distances to the planes
+    double error(const Eigen::Vector3f& p) const noexcept {
+        const double x = p.x(), y = p.y(), z = p.z();
+        return a00 * x * x + 2 * a01 * x * y + 2 * a02 * x * z + 2 * a03 * x
+            + a11 * y * y + 2 * a12 * y * z + 2 * a13 * y
+            + a22 * z * z + 2 * a23 * z
+            + a33;
+    }
+};
+
+// half edge collapses ordered by quadric error, vertices are not moved so attributes stay valid.
+// border and non-manifold vertices are locked, uv seams and submesh boundaries do not crack.
+// triangles are written when each target count is reached, targets are decreasing
+void simplifyTriangles(const uint32_t* indices, uint32_t indexCount,
+    const std::vector<Eigen::Vector3f>& positions, const std::vector<uint32_t>& targets,
+    std::vector<std::vector<uint32_t>>& levels, std::vector<float>& errors
+) {
+    const uint32_t triangleCount = indexCount / 3;
+    const auto vertexCount = positions.size();
+    std::vector<uint32_t> tris(indices, indices + size_t(triangleCount) * 3);
+    std::vector<uint8_t> alive(triangleCount, 1);
+    uint32_t aliveCount = triangleCount;
+
+    std::vector<Quadric> quadrics(vertexCount);
+    std::vector<std::vector<uint32_t>> adjacency(vertexCount);
+    std::vector<uint32_t> versions(vertexCount, 0);
+    std::vector<uint8_t> locked(vertexCount, 0);
+    std::vector<uint8_t> removed(vertexCount, 0);
+
+    auto edgeKey = [](uint32_t a, uint32_t b) {
+        if (a > b)
+            std::swap(a, b);
+        return (uint64_t(a) << 32) | b;
+    };
+    std::unordered_map<uint64_t, uint32_t> edges;
+    edges.reserve(size_t(triangleCount) * 3 / 2);
+    for (uint32_t t = 0; t != triangleCount; ++t) {
+        const auto* tri = &tris[size_t(t) * 3];
+        const Eigen::Vector3d p0 = positions[tri[0]].cast<double>();
+        const Eigen::Vector3d p1 = positions[tri[1]].cast<double>();
+        const Eigen::Vector3d p2 = positions[tri[2]].cast<double>();
+        Eigen::Vector3d n = (p1 - p0).cross(p2 - p0);
+        const auto length = n.norm();
+        for (uint32_t k = 0; k != 3; ++k) {
+            adjacency[tri[k]].emplace_back(t);
+            ++edges[edgeKey(tri[k], tri[(k + 1) % 3])];
+            if (length > 0) {
+                quadrics[tri[k]].addPlane(n / length, -(n / length).dot(p0));
+            }
+        }
+    }
+    for (const auto& [key, count] : edges) {
+        if (count != 2) {
+            locked[key >> 32] = 1;
+            locked[key & 0xFFFFFFFF] = 1;
+        }
+    }
+
+    struct Candidate {
+        double mCost;
+        uint32_t mFrom;
+        uint32_t mTo;
+        uint32_t mFromVersion;
+        uint32_t mToVersion;
+        bool operator>(const Candidate& rhs) const noexcept {
+            return mCost > rhs.mCost;
+        }
+    };
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> heap;
+    auto pushCandidate = [&](uint32_t from, uint32_t to) {
+        if (locked[from])
+            return;
+        Quadric q = quadrics[from];
+        q += quadrics[to];
+        heap.push(Candidate{ q.error(positions[to]), from, to, versions[from], versions[to] });
+    };
+    for (const auto& [key, count] : edges) {
+        if (count == 2) {
+            pushCandidate(uint32_t(key >> 32), uint32_t(key & 0xFFFFFFFF));
+            pushCandidate(uint32_t(key & 0xFFFFFFFF), uint32_t(key >> 32));
+        }
+    }
+
+    // opposite vertices of the triangles around v
+    std::vector<uint32_t> ringU, ringV;
+    auto collectRing = [&](uint32_t v, std::vector<uint32_t>& ring) {
+        ring.clear();
+        for (auto t : adjacency[v]) {
+            if (!alive[t])
+                continue;
+            for (uint32_t k = 0; k != 3; ++k) {
+                if (tris[size_t(t) * 3 + k] != v)
+                    ring.emplace_back(tris[size_t(t) * 3 + k]);
+            }
+        }
+        std::sort(ring.begin(), ring.end());
+        ring.erase(std::unique(ring.begin(), ring.end()), ring.end());
+    };
+
+    // link condition keeps the surface manifold, no triangle around u may flip
+    auto canCollapse = [&](uint32_t u, uint32_t v) {
+        uint32_t shared = 0;
+        for (auto t : adjacency[u]) {
+            if (!alive[t])
+                continue;
+            const auto* tri = &tris[size_t(t) * 3];
+            if (tri[0] == v || tri[1] == v || tri[2] == v) {
+                ++shared;
+                continue;
+            }
+            std::array<Eigen::Vector3f, 3> p;
+            std::array<Eigen::Vector3f, 3> q;
+            for (uint32_t k = 0; k != 3; ++k) {
+                p[k] = positions[tri[k]];
+                q[k] = positions[tri[k] == u ? v : tri[k]];
+            }
+            const Eigen::Vector3f before = (p[1] - p[0]).cross(p[2] - p[0]);
+            const Eigen::Vector3f after = (q[1] - q[0]).cross(q[2] - q[0]);
+            if (before.dot(after) <= 0)
+                return false;
+        }
+        collectRing(u, ringU);
+        collectRing(v, ringV);
+        uint32_t common = 0;
+        for (auto w : ringU) {
+            common += std::binary_search(ringV.begin(), ringV.end(), w);
+        }
+        return shared == 2 && common == 2;
+    };
+
+    double maxError = 0;
+    for (const auto target : targets) {
+        while (aliveCount > target && !heap.empty()) {
+            const auto c = heap.top();
+            heap.pop();
+            const auto u = c.mFrom;
+            const auto v = c.mTo;
+            if (removed[u] || removed[v] ||
+                versions[u] != c.mFromVersion || versions[v] != c.mToVersion)
+                continue;
+            if (!canCollapse(u, v))
+                continue;
+
+            removed[u] = 1;
+            quadrics[v] += quadrics[u];
+            ++versions[v];
+            maxError = std::max(maxError, c.mCost);
+            for (auto t : adjacency[u]) {
+                if (!alive[t])
+                    continue;
+                auto* tri = &tris[size_t(t) * 3];
+                if (tri[0] == v || tri[1] == v || tri[2] == v) {
+                    alive[t] = 0;
+                    --aliveCount;
+                    continue;
+                }
+                for (uint32_t k = 0; k != 3; ++k) {
+                    if (tri[k] == u)
+                        tri[k] = v;
+                }
+                adjacency[v].emplace_back(t);
+            }
+            adjacency[u].clear();
+            auto& adj = adjacency[v];
+            adj.erase(std::remove_if(adj.begin(), adj.end(),
+                [&](uint32_t t) { return !alive[t]; }), adj.end());
+
+            collectRing(v, ringV);
+            for (auto w : ringV) {
+                pushCandidate(v, w);
+                pushCandidate(w, v);
+            }
+        }
+
+        auto& level = levels.emplace_back();
+        level.reserve(size_t(aliveCount) * 3);
+        for (uint32_t t = 0; t != triangleCount; ++t) {
+            if (alive[t]) {
+                level.insert(level.end(), tris.begin() + size_t(t) * 3, tris.begin() + size_t(t) * 3 + 3);
+            }
+        }
+        errors.emplace_back(float(std::sqrt(std::max(maxError, 0.0))));
+        if (heap.empty())
+            break;
+    }
+}
+
+constexpr uint32_t sMeshLodCount = 3;
+constexpr uint32_t sMeshLodMinTriangles = 256;
+// a level must drop at least this fraction of the previous level
+constexpr float sMeshLodMinReduction = 0.2f;
+
+} // namespace
+
+void weldVertices(MeshData& mesh) {
+    if (mesh.mVertexBuffers.empty())
+        return;
+
+    const auto vertexCount = mesh.mVertexBuffers.front().mVertexCount;
+    size_t recordSize = 0;
+    for (const auto& vb : mesh.mVertexBuffers) {
+        Expects(vb.mVertexCount == vertexCount);
+        recordSize += vb.mDesc.mVertexSize;
+    }
+
+    // records of all streams side by side, buffers are zero filled so padding compares equal
+    std::vector<char> records(recordSize * vertexCount);
+    {
+        size_t offset = 0;
+        for (const auto& vb : mesh.mVertexBuffers) {
+            const auto stride = vb.mDesc.mVertexSize;
+            for (uint32_t v = 0; v != vertexCount; ++v) {
+                std::copy_n(vb.mBuffer.data() + size_t(v) * stride, stride,
+                    records.data() + size_t(v) * recordSize + offset);
+            }
+            offset += stride;
+        }
+    }
+
+    // first occurrence keeps its relative order
+    std::vector<uint32_t> remap(vertexCount);
+    std::vector<uint32_t> unique;
+    unique.reserve(vertexCount);
+    std::unordered_map<std::string_view, uint32_t> index;
+    index.reserve(vertexCount);
+    for (uint32_t v = 0; v != vertexCount; ++v) {
+        std::string_view record(records.data() + size_t(v) * recordSize, recordSize);
+        auto [iter, added] = index.emplace(record, gsl::narrow_cast<uint32_t>(unique.size()));
+        if (added) {
+            unique.emplace_back(v);
+        }
+        remap[v] = iter->second;
+    }
+
+    const auto uniqueCount = gsl::narrow_cast<uint32_t>(unique.size());
+    if (uniqueCount == vertexCount)
+        return;
+
+    for (auto& vb : mesh.mVertexBuffers) {
+        const auto stride = vb.mDesc.mVertexSize;
+        std::pmr::vector<char> buffer(size_t(uniqueCount) * stride, vb.mBuffer.get_allocator());
+        for (uint32_t i = 0; i != uniqueCount; ++i) {
+            std::copy_n(vb.mBuffer.data() + size_t(unique[i]) * stride, stride,
+                buffer.data() + size_t(i) * stride);
+        }
+        vb.mBuffer = std::move(buffer);
+        vb.mVertexCount = uniqueCount;
+    }
+
+    auto indices = readIndices(mesh.mIndexBuffer);
+    for (auto& i : indices) {
+        i = remap[i];
+    }
+    writeIndices(indices, uniqueCount, mesh.mIndexBuffer);
+}
+
+void optimizeMesh(MeshData& mesh, std::string_view name) {
+    if (mesh.mVertexBuffers.empty() ||
+        mesh.mIndexBuffer.mPrimitiveTopology != GFX_PRIMITIVE_TOPOLOGY_TRIANGLELIST)
+        return;
+
+    const auto vertexCount = mesh.mVertexBuffers.front().mVertexCount;
+    auto indices = readIndices(mesh.mIndexBuffer);
+    const auto before = getCacheStats(indices, vertexCount);
+
+    const auto positions = readPositions(mesh);
+    for (const auto& submesh : mesh.mSubMeshes) {
+        Expects(size_t(submesh.mIndexOffset) + submesh.mIndexCount <= indices.size());
+        auto* pIndices = indices.data() + submesh.mIndexOffset;
+        optimizeVertexCache(pIndices, submesh.mIndexCount, vertexCount);
+        if (!positions.empty()) {
+            optimizeOverdraw(pIndices, submesh.mIndexCount, vertexCount, positions);
+        }
+    }
+
+    const auto newCount = optimizeVertexFetch(mesh, indices);
+    writeIndices(indices, newCount, mesh.mIndexBuffer);
+
+    const auto after = getCacheStats(indices, newCount);
+    S_INFO << "mesh " << name << ": ACMR " << before.mACMR << " -> " << after.mACMR
+        << ", ATVR " << before.mATVR << " -> " << after.mATVR;
+}
+
+void buildMeshLods(MeshData& mesh, std::string_view name) {
+    mesh.mLods.clear();
+    mesh.mLodSubMeshes.clear();
+    if (mesh.mVertexBuffers.empty() ||
+        mesh.mIndexBuffer.mPrimitiveTopology != GFX_PRIMITIVE_TOPOLOGY_TRIANGLELIST)
+        return;
+
+    uint32_t triangleCount = 0;
+    for (const auto& submesh : mesh.mSubMeshes) {
+        triangleCount += submesh.mIndexCount / 3;
+    }
+    if (triangleCount < sMeshLodMinTriangles)
+        return;
+
+    const auto positions = readPositions(mesh);
+    if (positions.empty())
+        return;
+
+    const auto vertexCount = mesh.mVertexBuffers.front().mVertexCount;
+    auto indices = readIndices(mesh.mIndexBuffer);
+
+    const auto submeshCount = mesh.mSubMeshes.size();
+    std::vector<std::vector<std::vector<uint32_t>>> levels(submeshCount);
+    std::vector<std::vector<float>> errors(submeshCount);
+    for (size_t i = 0; i != submeshCount; ++i) {
+        const auto& submesh = mesh.mSubMeshes[i];
+        Expects(size_t(submesh.mIndexOffset) + submesh.mIndexCount <= indices.size());
+        std::vector<uint32_t> targets;
+        auto target = submesh.mIndexCount / 3;
+        for (uint32_t lod = 0; lod != sMeshLodCount; ++lod) {
+            target /= 2;
+            targets.emplace_back(target);
+        }
+        simplifyTriangles(indices.data() + submesh.mIndexOffset, submesh.mIndexCount,
+            positions, targets, levels[i], errors[i]);
+    }
+
+    uint32_t prevCount = triangleCount;
+    std::ostringstream oss;
+    for (uint32_t lod = 0; lod != sMeshLodCount; ++lod) {
+        uint32_t count = 0;
+        for (size_t i = 0; i != submeshCount; ++i) {
+            count += lod < levels[i].size()
+                ? gsl::narrow_cast<uint32_t>(levels[i][lod].size() / 3)
+                : (mesh.mLods.empty() ? mesh.mSubMeshes[i] : mesh.mLodSubMeshes[mesh.mLods.back().mSubMeshOffset + i]).mIndexCount / 3;
+        }
+        if (float(count) > (1.0f - sMeshLodMinReduction) * float(prevCount))
+            break;
+
+        MeshLodData lodData;
+        lodData.mSubMeshOffset = gsl::narrow_cast<uint32_t>(mesh.mLodSubMeshes.size());
+        for (size_t i = 0; i != submeshCount; ++i) {
+            // submeshes that cannot be reduced further keep their previous range
+            if (lod >= levels[i].size()) {
+                const auto prev = mesh.mLods.empty() ? mesh.mSubMeshes[i]
+                    : mesh.mLodSubMeshes[mesh.mLods.back().mSubMeshOffset + i];
+                mesh.mLodSubMeshes.emplace_back(SubMeshData{ prev.mIndexOffset, prev.mIndexCount });
+                if (!errors[i].empty()) {
+                    lodData.mError = std::max(lodData.mError, errors[i].back());
+                }
+                continue;
+            }
+            auto& level = levels[i][lod];
+            const auto offset = gsl::narrow_cast<uint32_t>(indices.size());
+            const auto levelCount = gsl::narrow_cast<uint32_t>(level.size());
+            if (levelCount) {
+                optimizeVertexCache(level.data(), levelCount, vertexCount);
+            }
+            indices.insert(indices.end(), level.begin(), level.end());
+            mesh.mLodSubMeshes.emplace_back(SubMeshData{ offset, levelCount });
+            lodData.mError = std::max(lodData.mError, errors[i][lod]);
+        }
+        mesh.mLods.emplace_back(lodData);
+        oss << " " << count << " (" << lodData.mError << ")";
+        prevCount = count;
+    }
+    if (mesh.mLods.empty())
+        return;
+
+    writeIndices(indices, vertexCount, mesh.mIndexBuffer);
+    S_INFO << "mesh " << name << ": " << triangleCount << " triangles, lods" << oss.str();
+}
+
+void buildMeshlets(MeshData& mesh) {
+    mesh.mMeshlets.clear();
+    mesh.mMeshletVertices.clear();
+    mesh.mMeshletTriangles.clear();
+    if (mesh.mVertexBuffers.empty() ||
+        mesh.mIndexBuffer.mPrimitiveTopology != GFX_PRIMITIVE_TOPOLOGY_TRIANGLELIST)
+        return;
+
+    const auto positions = readPositions(mesh);
+    if (positions.empty())
+        return;
+
+    const auto vertexCount = mesh.mVertexBuffers.front().mVertexCount;
+    const auto indices = readIndices(mesh.mIndexBuffer);
+    // local index of each vertex in the open meshlet
+    std::vector<uint8_t> local(vertexCount, 0xFF);
+
+    auto flush = [&](MeshletData& meshlet) {
+        if (meshlet.mTriangleCount == 0)
+            return false;
+        for (uint32_t i = 0; i != meshlet.mVertexCount; ++i) {
+            local[mesh.mMeshletVertices[meshlet.mVertexOffset + i]] = 0xFF;
+        }
+        computeMeshletBounds(mesh, positions, meshlet);
+        return true;
+    };
+
+    for (auto& submesh : mesh.mSubMeshes) {
+        Expects(size_t(submesh.mIndexOffset) + submesh.mIndexCount <= indices.size());
+        submesh.mMeshletOffset = gsl::narrow_cast<uint32_t>(mesh.mMeshlets.size());
+
+        MeshletData meshlet{};
+        meshlet.mVertexOffset = gsl::narrow_cast<uint32_t>(mesh.mMeshletVertices.size());
+        meshlet.mTriangleOffset = gsl::narrow_cast<uint32_t>(mesh.mMeshletTriangles.size() / 3);
+
+        const auto* pIndices = indices.data() + submesh.mIndexOffset;
+        for (uint32_t t = 0; t != submesh.mIndexCount / 3; ++t) {
+            const auto* tri = pIndices + t * 3;
+            uint32_t newVertices = 0;
+            for (uint32_t k = 0; k != 3; ++k) {
+                newVertices += local[tri[k]] == 0xFF;
+            }
+            if (meshlet.mVertexCount + newVertices > sMeshletMaxVertices ||
+                meshlet.mTriangleCount + 1 > sMeshletMaxTriangles) {
+                if (flush(meshlet)) {
+                    mesh.mMeshlets.emplace_back(meshlet);
+                }
+                meshlet = MeshletData{};
+                meshlet.mVertexOffset = gsl::narrow_cast<uint32_t>(mesh.mMeshletVertices.size());
+                meshlet.mTriangleOffset = gsl::narrow_cast<uint32_t>(mesh.mMeshletTriangles.size() / 3);
+            }
+            for (uint32_t k = 0; k != 3; ++k) {
+                auto& id = local[tri[k]];
+                if (id == 0xFF) {
+                    id = gsl::narrow_cast<uint8_t>(meshlet.mVertexCount++);
+                    mesh.mMeshletVertices.emplace_back(tri[k]);
+                }
+                mesh.mMeshletTriangles.emplace_back(id);
+            }
+            ++meshlet.mTriangleCount;
+        }
+        if (flush(meshlet)) {
+            mesh.mMeshlets.emplace_back(meshlet);
+        }
+        submesh.mMeshletCount = gsl::narrow_cast<uint32_t>(mesh.mMeshlets.size()) - submesh.mMeshletOffset;
+    }
+}
+
+void convertVertexLayout(MeshData& mesh, const MeshBufferLayout& layout) {
+    const uint32_t vertexCount = mesh.mVertexBuffers.empty() ? 0 : mesh.mVertexBuffers.front().mVertexCount;
+
+    // source element of each type and slot
+    std::map<std::pair<size_t, uint32_t>, std::pair<const VertexBufferData*, const VertexElement*>> sources;
+    std::array<uint32_t, std::variant_size_v<VertexElementType>> slots = {};
+    for (const auto& vb : mesh.mVertexBuffers) {
+        Expects(vb.mVertexCount == vertexCount);
+        for (const auto& e : vb.mDesc.mElements) {
+            sources.emplace(std::pair(e.mType.index(), slots[e.mType.index()]++), std::pair(&vb, &e));
+        }
+    }
+
+    struct Conversion {
+        const VertexBufferData* mSource;
+        uint32_t mSourceOffset;
+        uint32_t mBuffer;
+        uint32_t mOffset;
+        VertexKernel mKernel;
+    };
+    std::pmr::vector<VertexBufferData> buffers(mesh.mVertexBuffers.get_allocator());
+    std::vector<Conversion> conversions;
+    buffers.reserve(layout.mBuffers.size());
+    slots = {};
+    for (const auto& desc : layout.mBuffers) {
+        auto& vb = buffers.emplace_back();
+        vb.mDesc = desc;
+        vb.mVertexCount = vertexCount;
+        vb.mBuffer.resize(size_t(desc.mVertexSize) * vertexCount);
+        for (const auto& e : desc.mElements) {
+            auto iter = sources.find(std::pair(e.mType.index(), slots[e.mType.index()]++));
+            if (iter == sources.end())
+                continue;
+            const auto& [pSource, pElement] = iter->second;
+            conversions.emplace_back(Conversion{ pSource, pElement->mAlignedByteOffset,
+                gsl::narrow_cast<uint32_t>(buffers.size() - 1), e.mAlignedByteOffset,
+                getVertexKernel(pElement->mFormat, e.mFormat) });
+        }
+    }
+
+    std::vector<uint32_t> batches((vertexCount + sVertexBatchSize - 1) / sVertexBatchSize);
+    std::iota(batches.begin(), batches.end(), 0);
+    std::for_each(std::execution::par, batches.begin(), batches.end(), [&](uint32_t batchID) {
+        const size_t first = size_t(batchID) * sVertexBatchSize;
+        const size_t count = std::min(vertexCount - first, sVertexBatchSize);
+        for (const auto& c : conversions) {
+            const auto srcStride = c.mSource->mDesc.mVertexSize;
+            auto& dst = buffers[c.mBuffer];
+            const auto dstStride = dst.mDesc.mVertexSize;
+            c.mKernel(c.mSource->mBuffer.data() + first * srcStride + c.mSourceOffset, srcStride,
+                dst.mBuffer.data() + first * dstStride + c.mOffset, dstStride, count);
+        }
+    });
+    mesh.mVertexBuffers = std::move(buffers);
+}
+
+}
@@ -0,0 +1,45 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+#include <Star/Graphics/SContentTypes.h>
+
+namespace Star::Asset {
+
+// merges vertices whose records are equal in all vertex buffers and rebuilds the index buffer,
+// 16-bit indices are used if the remaining vertices allow
+void weldVertices(Graphics::Render::MeshData& mesh);
+
+// reorders triangles of each submesh for the post-transform cache, then clusters by overdraw,
+// vertices are renumbered in first use order, cache stats are logged
+void optimizeMesh(Graphics::Render::MeshData& mesh, std::string_view name);
+
+// splits each submesh into clusters of at most 64 vertices and 124 triangles,
+// each with a bounding sphere and a normal cone for cluster culling
+void buildMeshlets(Graphics::Render::MeshData& mesh);
+
+// appends simplified levels of halving triangle counts, levels that barely reduce are dropped
+void buildMeshLods(Graphics::Render::MeshData& mesh, std::string_view name);
+
+// object space bounds of the positions, inverted if the mesh has no float positions
+Aabb3f getMeshBounds(const Graphics::Render::MeshData& mesh);
+
+// rewrites the vertex buffers in layout, elements are matched by type and slot,
+// each element pair is converted by the kernel of its formats, vertices are converted in parallel batches
+// elements missing from the mesh are zero, throws if a format pair has no kernel
+void convertVertexLayout(Graphics::Render::MeshData& mesh, const Graphics::Render::MeshBufferLayout& layout);
+
+}
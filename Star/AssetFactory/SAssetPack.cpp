@@ -0,0 +1,283 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "SAssetPack.h"
+#include <Star/SScopeExit.h>
+#include <lz4.h>
+#include <lz4hc.h>
+#include <numeric>
+
+namespace Star::Asset {
+
+static_assert(sizeof(AssetPackHeader) == 32);
+static_assert(sizeof(AssetPackEntry) == 48);
+static_assert(sizeof(AssetPackChunkHeader) == 8);
+
+namespace {
+
+void padStream(std::ostream& os, uint64_t& pos) {
+    static constexpr char sZeros[sAssetPackAlignment] = {};
+    auto target = boost::alignment::align_up(pos, uint64_t(sAssetPackAlignment));
+    os.write(sZeros, gsl::narrow_cast<std::streamsize>(target - pos));
+    pos = target;
+}
+
+// chunk header, chunk sizes and chunks; returns false if compression saved too little to pay for it
+bool compressChunked(const std::string& content, std::string& compressed) {
+    const auto chunkCount = gsl::narrow<uint32_t>(
+        (content.size() + sAssetPackChunkSize - 1) / sAssetPackChunkSize);
+    std::vector<std::string> chunks(chunkCount);
+    std::vector<uint32_t> chunkIDs(chunkCount);
+    std::iota(chunkIDs.begin(), chunkIDs.end(), 0u);
+    std::for_each(std::execution::par, chunkIDs.begin(), chunkIDs.end(), [&](uint32_t chunkID) {
+        const auto offset = size_t(chunkID) * sAssetPackChunkSize;
+        const auto size = std::min<size_t>(sAssetPackChunkSize, content.size() - offset);
+        auto& chunk = chunks[chunkID];
+        chunk.resize(LZ4_compressBound(gsl::narrow_cast<int>(size)));
+        const int written = LZ4_compress_HC(content.data() + offset, chunk.data(),
+            gsl::narrow_cast<int>(size), gsl::narrow_cast<int>(chunk.size()), LZ4HC_CLEVEL_DEFAULT);
+        if (written <= 0 || size_t(written) >= size) {
+            chunk.assign(content.data() + offset, size);
+        } else {
+            chunk.resize(written);
+        }
+    });
+
+    AssetPackChunkHeader header;
+    header.mChunkCount = chunkCount;
+    size_t total = sizeof(header) + sizeof(uint32_t) * chunkCount;
+    for (const auto& chunk : chunks) {
+        total += chunk.size();
+    }
+    // below 1/16 saving the decompression is not worth it
+    if (total + content.size() / 16 >= content.size()) {
+        return false;
+    }
+    compressed.clear();
+    compressed.reserve(total);
+    compressed.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const auto& chunk : chunks) {
+        const auto size = gsl::narrow_cast<uint32_t>(chunk.size());
+        compressed.append(reinterpret_cast<const char*>(&size), sizeof(size));
+    }
+    for (const auto& chunk : chunks) {
+        compressed.append(chunk);
+    }
+    Ensures(compressed.size() == total);
+    return true;
+}
+
+void decompressChunked(const std::byte* data, size_t size, std::byte* dst, size_t dstSize) {
+    AssetPackChunkHeader header;
+    if (size < sizeof(header)) {
+        throw std::runtime_error("asset pack chunk header truncated");
+    }
+    std::memcpy(&header, data, sizeof(header));
+    const size_t tableSize = sizeof(header) + sizeof(uint32_t) * size_t(header.mChunkCount);
+    if (tableSize > size || header.mChunkSize == 0 ||
+        header.mChunkCount != (dstSize + header.mChunkSize - 1) / header.mChunkSize)
+    {
+        throw std::runtime_error("asset pack chunk table corrupted");
+    }
+    std::vector<uint32_t> sizes(header.mChunkCount);
+    std::memcpy(sizes.data(), data + sizeof(header), sizeof(uint32_t) * sizes.size());
+
+    std::vector<size_t> offsets(header.mChunkCount);
+    size_t offset = tableSize;
+    for (uint32_t i = 0; i != header.mChunkCount; ++i) {
+        offsets[i] = offset;
+        offset += sizes[i];
+    }
+    if (offset > size) {
+        throw std::runtime_error("asset pack chunks truncated");
+    }
+
+    std::vector<uint32_t> chunkIDs(header.mChunkCount);
+    std::iota(chunkIDs.begin(), chunkIDs.end(), 0u);
+    std::atomic<bool> failed = false;
+    std::for_each(std::execution::par, chunkIDs.begin(), chunkIDs.end(), [&](uint32_t chunkID) {
+        const auto dstOffset = size_t(chunkID) * header.mChunkSize;
+        const auto dstChunkSize = std::min<size_t>(header.mChunkSize, dstSize - dstOffset);
+        const auto* src = reinterpret_cast<const char*>(data + offsets[chunkID]);
+        auto* out = reinterpret_cast<char*>(dst + dstOffset);
+        if (sizes[chunkID] == dstChunkSize) {
+            std::memcpy(out, src, dstChunkSize);
+            return;
+        }
+        const int read = LZ4_decompress_safe(src, out,
+            gsl::narrow_cast<int>(sizes[chunkID]), gsl::narrow_cast<int>(dstChunkSize));
+        if (read != gsl::narrow_cast<int>(dstChunkSize)) {
+            failed = true;
+        }
+    });
+    if (failed) {
+        throw std::runtime_error("asset pack chunk decompression failed");
+    }
+}
+
+}
+
+void writeAssetPack(const std::filesystem::path& filename, const std::vector<AssetPackSource>& sources) {
+    if (!exists(filename.parent_path())) {
+        create_directories(filename.parent_path());
+    }
+    std::ofstream ofs(filename, std::ios::binary | std::ios::trunc);
+    ofs.exceptions(std::ostream::failbit);
+
+    AssetPackHeader header;
+    uint64_t pos = 0;
+    ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    pos += sizeof(header);
+    padStream(ofs, pos);
+
+    std::vector<AssetPackEntry> entries;
+    entries.reserve(sources.size());
+    MetaIDUnorderedSet placed;
+    std::string content;
+    std::string compressed;
+    for (const auto& source : sources) {
+        if (!placed.emplace(source.mMetaID).second || !exists(source.mPath)) {
+            continue;
+        }
+        content = readBinary(source.mPath);
+        auto& entry = entries.emplace_back();
+        entry.mMetaID = source.mMetaID;
+        entry.mType = source.mType;
+        entry.mOffset = pos;
+        entry.mUncompressedSize = content.size();
+        const std::string* payload = &content;
+        if (source.mCompress && !content.empty() && compressChunked(content, compressed)) {
+            entry.mCompression = AssetPackCompression::LZ4Chunked;
+            payload = &compressed;
+        }
+        entry.mSize = payload->size();
+        ofs.write(payload->data(), payload->size());
+        pos += payload->size();
+        padStream(ofs, pos);
+    }
+
+    header.mEntryCount = gsl::narrow<uint32_t>(entries.size());
+    header.mTocOffset = pos;
+    header.mTocSize = sizeof(AssetPackEntry) * uint64_t(entries.size());
+    ofs.write(reinterpret_cast<const char*>(entries.data()), gsl::narrow<std::streamsize>(header.mTocSize));
+    pos += header.mTocSize;
+    padStream(ofs, pos);
+
+    ofs.seekp(0);
+    ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+AssetPack::AssetPack(const std::filesystem::path& filename) {
+    // header and table of contents are read once, buffered
+    {
+        std::ifstream ifs(filename, std::ios::binary);
+        ifs.exceptions(std::istream::failbit);
+        AssetPackHeader header;
+        ifs.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (header.mMagic != sAssetPackMagic) {
+            throw std::invalid_argument("not an asset pack: " + filename.string());
+        }
+        if (header.mVersion != sAssetPackVersion) {
+            throw std::runtime_error("asset pack version not supported: " + filename.string());
+        }
+        if (header.mTocSize != sizeof(AssetPackEntry) * uint64_t(header.mEntryCount)) {
+            throw std::runtime_error("asset pack table of contents corrupted: " + filename.string());
+        }
+        std::vector<AssetPackEntry> entries(header.mEntryCount);
+        ifs.seekg(header.mTocOffset);
+        ifs.read(reinterpret_cast<char*>(entries.data()), gsl::narrow<std::streamsize>(header.mTocSize));
+        mEntries.reserve(entries.size());
+        for (const auto& entry : entries) {
+            if (entry.mOffset % sAssetPackAlignment) {
+                throw std::runtime_error("asset pack entry not aligned: " + filename.string());
+            }
+            mEntries.emplace(entry.mMetaID, entry);
+        }
+    }
+
+    mFile = CreateFileW(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED | FILE_FLAG_NO_BUFFERING, nullptr);
+    if (mFile == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("open asset pack failed: " + filename.string());
+    }
+}
+
+AssetPack::~AssetPack() {
+    if (mFile != INVALID_HANDLE_VALUE) {
+        CloseHandle(mFile);
+    }
+}
+
+const AssetPackEntry* AssetPack::find(const MetaID& metaID) const noexcept {
+    auto iter = mEntries.find(metaID);
+    if (iter == mEntries.end()) {
+        return nullptr;
+    }
+    return &iter->second;
+}
+
+size_t AssetPack::read(const AssetPackEntry& entry, AssetPackBuffer& buffer) const {
+    if (entry.mCompression == AssetPackCompression::LZ4Chunked) {
+        AssetPackBuffer compressed(buffer.get_allocator());
+        readStored(entry, compressed);
+        const auto size = gsl::narrow<size_t>(entry.mUncompressedSize);
+        buffer.resize_aligned_uninitialized(size);
+        decompressChunked(compressed.data(), gsl::narrow<size_t>(entry.mSize), buffer.data(), size);
+        return size;
+    }
+    if (entry.mCompression != AssetPackCompression::None) {
+        throw std::runtime_error("asset pack compression not supported");
+    }
+    readStored(entry, buffer);
+    return gsl::narrow<size_t>(entry.mSize);
+}
+
+void AssetPack::readStored(const AssetPackEntry& entry, AssetPackBuffer& buffer) const {
+    const auto size = buffer.resize_aligned_uninitialized(gsl::narrow<size_t>(entry.mSize));
+    if (size == 0) {
+        return;
+    }
+    if (size > std::numeric_limits<DWORD>::max()) {
+        throw std::runtime_error("asset pack entry too large");
+    }
+
+    OVERLAPPED overlapped{};
+    overlapped.Offset = static_cast<DWORD>(entry.mOffset);
+    overlapped.OffsetHigh = static_cast<DWORD>(entry.mOffset >> 32);
+    overlapped.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    if (!overlapped.hEvent) {
+        throw std::runtime_error("create asset pack read event failed");
+    }
+    ON_SCOPE_EXIT(closeEvent, [&]() {
+        CloseHandle(overlapped.hEvent);
+    });
+
+    if (!ReadFile(mFile, buffer.data(), static_cast<DWORD>(size), nullptr, &overlapped)
+        && GetLastError() != ERROR_IO_PENDING)
+    {
+        throw std::runtime_error("asset pack read failed");
+    }
+    DWORD transferred = 0;
+    if (!GetOverlappedResult(mFile, &overlapped, &transferred, TRUE)) {
+        throw std::runtime_error("asset pack read failed");
+    }
+    if (transferred < entry.mSize) {
+        throw std::runtime_error("asset pack entry truncated");
+    }
+}
+
+}
@@ -0,0 +1,121 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <Star/SMetaID.h>
+#include <Star/SAlignedBuffer.h>
+#include <filesystem>
+#include <streambuf>
+
+namespace Star::Asset {
+
+// library resources packed into one file, a table of contents follows the payloads
+constexpr uint32_t sAssetPackMagic = 0x4B415053; // SPAK
+constexpr uint32_t sAssetPackVersion = 2;
+// payloads start on sector boundaries and are padded to them, so they can be read unbuffered
+constexpr uint32_t sAssetPackAlignment = 4096;
+
+enum class AssetPackCompression : uint32_t {
+    None,
+    // independent chunks, so a payload is decompressed in parallel
+    LZ4Chunked,
+};
+
+// uncompressed bytes per chunk, the last chunk may be shorter
+constexpr uint32_t sAssetPackChunkSize = 256 * 1024;
+
+// chunked payload: chunk count, then the stored size of every chunk, then the chunks,
+// a chunk stored at its full uncompressed size was not compressible and is copied as is
+struct AssetPackChunkHeader {
+    uint32_t mChunkCount = 0;
+    uint32_t mChunkSize = sAssetPackChunkSize;
+};
+
+struct AssetPackHeader {
+    uint32_t mMagic = sAssetPackMagic;
+    uint32_t mVersion = sAssetPackVersion;
+    uint32_t mEntryCount = 0;
+    uint32_t mReserved = 0;
+    uint64_t mTocOffset = 0;
+    uint64_t mTocSize = 0;
+};
+
+struct AssetPackEntry {
+    MetaID mMetaID;
+    uint32_t mType = 0; // Core::ResourceType index
+    AssetPackCompression mCompression = AssetPackCompression::None;
+    uint64_t mOffset = 0;
+    uint64_t mSize = 0; // stored bytes
+    uint64_t mUncompressedSize = 0;
+};
+
+struct AssetPackSource {
+    MetaID mMetaID;
+    uint32_t mType = 0;
+    std::filesystem::path mPath;
+    bool mCompress = false;
+};
+
+using AssetPackBuffer = AlignedBuffer<sAssetPackAlignment>;
+
+// payloads are placed in source order, missing files are skipped
+void writeAssetPack(const std::filesystem::path& filename, const std::vector<AssetPackSource>& sources);
+
+// pack opened for unbuffered overlapped reads, reads of different threads run concurrently
+class AssetPack {
+public:
+    explicit AssetPack(const std::filesystem::path& filename);
+    AssetPack(const AssetPack&) = delete;
+    AssetPack& operator=(const AssetPack&) = delete;
+    ~AssetPack();
+
+    const AssetPackEntry* find(const MetaID& metaID) const noexcept;
+
+    // returns the payload size, compressed payloads are decompressed chunk by chunk in parallel
+    size_t read(const AssetPackEntry& entry, AssetPackBuffer& buffer) const;
+private:
+    // stored bytes of the entry, padded to sectors
+    void readStored(const AssetPackEntry& entry, AssetPackBuffer& buffer) const;
+
+    HANDLE mFile = INVALID_HANDLE_VALUE;
+    MetaIDUnorderedMap<AssetPackEntry> mEntries;
+};
+
+// istream source over a payload read from the pack
+class MemoryStreamBuf : public std::streambuf {
+public:
+    MemoryStreamBuf(const std::byte* data, size_t size) {
+        auto* p = const_cast<char*>(reinterpret_cast<const char*>(data));
+        setg(p, p, p + size);
+    }
+protected:
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override {
+        char* base = eback();
+        char* pos = dir == std::ios_base::beg ? base : dir == std::ios_base::cur ? gptr() : egptr();
+        pos += off;
+        if (!(which & std::ios_base::in) || pos < base || pos > egptr()) {
+            return pos_type(off_type(-1));
+        }
+        setg(base, pos, egptr());
+        return pos_type(pos - base);
+    }
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) override {
+        return seekoff(off_type(pos), std::ios_base::beg, which);
+    }
+};
+
+}
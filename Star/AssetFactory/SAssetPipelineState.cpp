@@ -0,0 +1,117 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "SAssetPipelineState.h"
+#include <Star/Graphics/SContentSerialization.h>
+#include <boost/archive/binary_oarchive.hpp>
+
+namespace Star::Asset {
+
+using namespace Graphics::Render;
+
+namespace {
+
+// input layout of the mesh, or the one of the shader if it takes no vertex input
+void buildInputLayout(const ShaderInputLayout& inputLayout, const MeshBufferLayout& meshLayout,
+    PipelineStateDesc& desc
+) {
+    desc.mInputElements.clear();
+    if (inputLayout.mSemantics.empty()) {
+        desc.mStripCutValue = inputLayout.mStripCutValue;
+        desc.mPrimitiveTopologyType = inputLayout.mPrimitiveTopologyType;
+        return;
+    }
+    for (const auto& [semantic, inputs] : inputLayout.mSemantics) {
+        uint32_t semanticID = 0;
+        for (const auto& input : inputs) {
+            const auto& [bufferID, elementID] = meshLayout.mIndex.at(input);
+            const auto& descData = meshLayout.mBuffers.at(bufferID).mElements.at(elementID);
+            auto& element = desc.mInputElements.emplace_back();
+            element.mType = descData.mType;
+            element.mSemanticIndex = semanticID++;
+            element.mFormat = descData.mFormat;
+            element.mInputSlot = bufferID;
+            element.mAlignedByteOffset = descData.mAlignedByteOffset;
+        }
+    }
+    desc.mStripCutValue = meshLayout.mStripCutValue;
+    desc.mPrimitiveTopologyType = meshLayout.mPrimitiveTopologyType;
+}
+
+void buildRenderTargets(const RenderSolution& solution, const GraphicsSubpass& subpass,
+    PipelineStateDesc& desc
+) {
+    desc.mRTVFormats.clear();
+    for (const auto& attachment : subpass.mOutputAttachments) {
+        desc.mRTVFormats.emplace_back(solution.mRTVs.at(attachment.mDescriptor.mHandle).mFormat);
+    }
+    desc.mDSVFormat = Format::UNKNOWN;
+    if (subpass.mDepthStencilAttachment) {
+        desc.mDSVFormat = solution.mDSVs.at(subpass.mDepthStencilAttachment->mDescriptor.mHandle).mFormat;
+    }
+    desc.mSampleDesc = subpass.mSampleDesc;
+}
+
+uint64_t hashPipelineState(const ShaderSubpassData& subpass, const PipelineStateDesc& desc) {
+    std::ostringstream oss;
+    {
+        boost::archive::binary_oarchive oa(oss, boost::archive::no_header);
+        oa << subpass.mState;
+        oa << subpass.mProgram;
+        oa << desc.mInputElements;
+        oa << desc.mStripCutValue;
+        oa << desc.mPrimitiveTopologyType;
+        oa << desc.mRTVFormats;
+        oa << desc.mDSVFormat;
+        oa << desc.mSampleDesc;
+    }
+    return std::hash<std::string_view>{}(oss.str());
+}
+
+}
+
+void buildPipelineStates(const RenderSwapChain& renderGraph, const ContentSettings& settings,
+    ShaderData& shaderData
+) {
+    for (auto& [solutionName, solutionData] : shaderData.mSolutions) {
+        const auto& solution = renderGraph.mSolutions.at(at(renderGraph.mSolutionIndex, solutionName));
+        for (auto& [pipelineName, pipelineData] : solutionData.mPipelines) {
+            const auto& pipeline = solution.mPipelines.at(at(solution.mPipelineIndex, pipelineName));
+            for (auto& [queueName, queueData] : pipelineData.mQueues) {
+                const auto& subpassDesc = at(pipeline.mSubpassIndex, queueName);
+                const auto& renderSubpass = pipeline.mPasses.at(subpassDesc.mPassID)
+                    .mGraphicsSubpasses.at(subpassDesc.mSubpassID);
+                for (auto& level : queueData.mLevels) {
+                    for (auto& [passName, pass] : level.mPasses) {
+                        for (auto& subpass : pass.mSubpasses) {
+                            subpass.mPipelineStates.clear();
+                            subpass.mPipelineStates.reserve(subpass.mVertexLayouts.size());
+                            for (auto vertID : subpass.mVertexLayouts) {
+                                auto& desc = subpass.mPipelineStates.emplace_back();
+                                buildInputLayout(subpass.mInputLayout, settings.mVertexLayouts.at(vertID), desc);
+                                buildRenderTargets(solution, renderSubpass, desc);
+                                desc.mHash = hashPipelineState(subpass, desc);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+}
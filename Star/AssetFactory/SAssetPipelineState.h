@@ -0,0 +1,30 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <Star/Graphics/SContentTypes.h>
+#include <Star/Graphics/SRenderGraphTypes.h>
+
+namespace Star::Asset {
+
+// fills mPipelineStates of every shader subpass, one per vertex layout, from the render subpass
+// its queue is drawn in. mVertexLayouts and the bytecode of the programs must be set
+void buildPipelineStates(const Graphics::Render::RenderSwapChain& renderGraph,
+    const Graphics::Render::ContentSettings& settings,
+    Graphics::Render::ShaderData& shaderData);
+
+}
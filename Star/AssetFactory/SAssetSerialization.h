@@ -102,6 +102,37 @@ void serialize(Archive& ar, Star::Asset::AssetDatabase& v, const uint32_t versio
     ar & boost::serialization::make_nvp("renderGraphInfo", v.mRenderGraphInfo);
 }
 
+STAR_CLASS_IMPLEMENTATION(Star::Asset::BuildRecord, object_serializable);
+STAR_CLASS_TRACKING(Star::Asset::BuildRecord, track_never);
+template<class Archive>
+void serialize(Archive& ar, Star::Asset::BuildRecord& v, const uint32_t version) {
+    ar & boost::serialization::make_nvp("sourceHash", v.mSourceHash);
+    ar & boost::serialization::make_nvp("settingsHash", v.mSettingsHash);
+    ar & boost::serialization::make_nvp("outputHash", v.mOutputHash);
+}
+
+STAR_CLASS_IMPLEMENTATION(Star::Asset::BuildDatabase, object_serializable);
+STAR_CLASS_TRACKING(Star::Asset::BuildDatabase, track_never);
+template<class Archive>
+void serialize(Archive& ar, Star::Asset::BuildDatabase& v, const uint32_t version) {
+    ar & boost::serialization::make_nvp("records", v.mRecords);
+}
+
+STAR_CLASS_IMPLEMENTATION(Star::Asset::ScanRecord, object_serializable);
+STAR_CLASS_TRACKING(Star::Asset::ScanRecord, track_never);
+template<class Archive>
+void serialize(Archive& ar, Star::Asset::ScanRecord& v, const uint32_t version) {
+    ar & boost::serialization::make_nvp("writeTime", v.mWriteTime);
+    ar & boost::serialization::make_nvp("metaID", v.mMetaID);
+}
+
+STAR_CLASS_IMPLEMENTATION(Star::Asset::ScanCache, object_serializable);
+STAR_CLASS_TRACKING(Star::Asset::ScanCache, track_never);
+template<class Archive>
+void serialize(Archive& ar, Star::Asset::ScanCache& v, const uint32_t version) {
+    ar & boost::serialization::make_nvp("records", v.mRecords);
+}
+
 STAR_CLASS_IMPLEMENTATION(Star::Asset::Direct_, object_serializable);
 STAR_CLASS_TRACKING(Star::Asset::Direct_, track_never);
 template<class Archive>
@@ -139,6 +170,9 @@ void serialize(Archive& ar, Star::Asset::TextureImportSettings& v, const uint32_
     ar & boost::serialization::make_nvp("format", v.mFormat);
     ar & boost::serialization::make_nvp("generateMipMaps", v.mGenerateMipMaps);
     ar & boost::serialization::make_nvp("flipY", v.mFlipY);
+    ar & boost::serialization::make_nvp("normalMap", v.mNormalMap);
+    ar & boost::serialization::make_nvp("quality", v.mQuality);
+    ar & boost::serialization::make_nvp("alphaCoverage", v.mAlphaCoverage);
 }
 
 } // namespace serialization
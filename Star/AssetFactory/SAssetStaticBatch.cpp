@@ -0,0 +1,347 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "SAssetStaticBatch.h"
+#include "SAssetMesh.h"
+#include <Star/Graphics/SContentUtils.h>
+#include <Star/SHalf.h>
+#include <Star/SAabb.h>
+
+namespace Star::Asset {
+
+using namespace Graphics::Render;
+
+namespace {
+
+// submesh of a renderer
+struct BatchPiece {
+    uint32_t mObjectID;
+    uint32_t mSubMeshID;
+};
+
+struct BatchKey {
+    MetaID mMaterialID;
+    uint32_t mLayoutID;
+    std::array<int32_t, 3> mCell;
+};
+
+bool operator<(const BatchKey& lhs, const BatchKey& rhs) noexcept {
+    return std::forward_as_tuple(lhs.mMaterialID, lhs.mLayoutID, lhs.mCell) <
+        std::forward_as_tuple(rhs.mMaterialID, rhs.mLayoutID, rhs.mCell);
+}
+
+uint32_t readIndex(const IndexBufferData& ib, size_t i) noexcept {
+    if (ib.mElementSize == 2) {
+        return reinterpret_cast<const uint16_t*>(ib.mBuffer.data())[i];
+    } else {
+        return reinterpret_cast<const uint32_t*>(ib.mBuffer.data())[i];
+    }
+}
+
+Vector4f loadVector(const char* p, Format format) {
+    switch (format) {
+    case Format::R32G32B32A32_SFLOAT: {
+        std::array<float, 4> v;
+        std::memcpy(v.data(), p, sizeof(v));
+        return Vector4f(v[0], v[1], v[2], v[3]);
+    }
+    case Format::R32G32B32_SFLOAT: {
+        std::array<float, 3> v;
+        std::memcpy(v.data(), p, sizeof(v));
+        return Vector4f(v[0], v[1], v[2], 1.f);
+    }
+    case Format::R16G16B16A16_SFLOAT: {
+        std::array<half, 4> v;
+        std::memcpy(v.data(), p, sizeof(v));
+        return Vector4f(float(v[0]), float(v[1]), float(v[2]), float(v[3]));
+    }
+    case Format::R8G8B8A8_SNORM: {
+        std::array<int8_t, 4> v;
+        std::memcpy(v.data(), p, sizeof(v));
+        return Vector4f(std::max(v[0] / 127.f, -1.f), std::max(v[1] / 127.f, -1.f),
+            std::max(v[2] / 127.f, -1.f), std::max(v[3] / 127.f, -1.f));
+    }
+    default:
+        throw std::invalid_argument("static batching does not support vertex format");
+    }
+}
+
+void storeVector(char* p, Format format, const Vector4f& v) {
+    switch (format) {
+    case Format::R32G32B32A32_SFLOAT:
+        std::memcpy(p, v.data(), sizeof(float) * 4);
+        break;
+    case Format::R32G32B32_SFLOAT:
+        std::memcpy(p, v.data(), sizeof(float) * 3);
+        break;
+    case Format::R16G16B16A16_SFLOAT: {
+        std::array<half, 4> h;
+        convertFloatToHalf(gsl::span<const float>(v.data(), 4), h);
+        std::memcpy(p, h.data(), sizeof(h));
+        break;
+    }
+    case Format::R8G8B8A8_SNORM: {
+        std::array<int8_t, 4> s;
+        for (int k = 0; k != 4; ++k) {
+            s[k] = static_cast<int8_t>(std::lround(std::clamp(v[k], -1.f, 1.f) * 127.f));
+        }
+        std::memcpy(p, s.data(), sizeof(s));
+        break;
+    }
+    default:
+        throw std::invalid_argument("static batching does not support vertex format");
+    }
+}
+
+const VertexElement* findPosition(const VertexBufferData& vb) noexcept {
+    for (const auto& e : vb.mDesc.mElements) {
+        if (std::holds_alternative<SV_Position_>(e.mType))
+            return &e;
+    }
+    return nullptr;
+}
+
+// world space center of the vertices referenced by the submesh
+Vector3f getPieceCenter(const MeshData& mesh, const SubMeshData& subMesh, const Affine3f& world) {
+    Vector3f lower = Vector3f::Constant(std::numeric_limits<float>::max());
+    Vector3f upper = Vector3f::Constant(std::numeric_limits<float>::lowest());
+    for (const auto& vb : mesh.mVertexBuffers) {
+        const auto* e = findPosition(vb);
+        if (!e)
+            continue;
+        for (uint32_t i = 0; i != subMesh.mIndexCount; ++i) {
+            const auto id = readIndex(mesh.mIndexBuffer, subMesh.mIndexOffset + i);
+            const auto p = loadVector(vb.mBuffer.data() + size_t(id) * vb.mDesc.mVertexSize + e->mAlignedByteOffset, e->mFormat);
+            lower = lower.cwiseMin(p.head<3>());
+            upper = upper.cwiseMax(p.head<3>());
+        }
+        return world * (0.5f * (lower + upper));
+    }
+    throw std::invalid_argument("static batching requires position");
+}
+
+// appends the submesh vertices in world space, vertices are copied once per piece
+void appendPiece(const MeshData& src, const SubMeshData& subMesh, const Affine3f& world,
+    MeshData& dst, std::vector<uint32_t>& indices
+) {
+    const Matrix3f linear = world.linear();
+    const Matrix3f normalMatrix = linear.inverse().transpose();
+    const bool mirrored = linear.determinant() < 0;
+
+    std::vector<uint32_t> remap(src.mVertexBuffers.front().mVertexCount, uint32_t(-1));
+    const auto first = dst.mVertexBuffers.front().mVertexCount;
+    uint32_t added = 0;
+    const auto begin = indices.size();
+    for (uint32_t i = 0; i != subMesh.mIndexCount; ++i) {
+        const auto id = readIndex(src.mIndexBuffer, subMesh.mIndexOffset + i);
+        if (remap[id] == uint32_t(-1)) {
+            remap[id] = first + added++;
+            for (size_t b = 0; b != src.mVertexBuffers.size(); ++b) {
+                const auto& svb = src.mVertexBuffers[b];
+                auto& dvb = dst.mVertexBuffers[b];
+                const auto stride = svb.mDesc.mVertexSize;
+                const auto* sp = svb.mBuffer.data() + size_t(id) * stride;
+                auto* dp = &*dvb.mBuffer.insert(dvb.mBuffer.end(), sp, sp + stride);
+                for (const auto& e : svb.mDesc.mElements) {
+                    auto* p = dp + e.mAlignedByteOffset;
+                    visit(overload(
+                        [&](SV_Position_) {
+                            auto v = loadVector(p, e.mFormat);
+                            v.head<3>() = world * Vector3f(v.head<3>());
+                            storeVector(p, e.mFormat, v);
+                        },
+                        [&](NORMAL_) {
+                            auto v = loadVector(p, e.mFormat);
+                            v.head<3>() = (normalMatrix * v.head<3>()).normalized();
+                            storeVector(p, e.mFormat, v);
+                        },
+                        [&](TANGENT_) {
+                            auto v = loadVector(p, e.mFormat);
+                            v.head<3>() = (linear * v.head<3>()).normalized();
+                            // handedness flips with the winding
+                            if (mirrored) {
+                                v[3] = -v[3];
+                            }
+                            storeVector(p, e.mFormat, v);
+                        },
+                        [&](BINORMAL_) {
+                            auto v = loadVector(p, e.mFormat);
+                            v.head<3>() = (linear * v.head<3>()).normalized();
+                            storeVector(p, e.mFormat, v);
+                        },
+                        [&](const auto&) {
+                            // not spatial, copied as is
+                        }
+                    ), e.mType);
+                }
+            }
+        }
+        indices.emplace_back(remap[id]);
+    }
+    if (mirrored) {
+        for (auto i = begin; i + 2 < indices.size(); i += 3) {
+            std::swap(indices[i + 1], indices[i + 2]);
+        }
+    }
+    for (auto& vb : dst.mVertexBuffers) {
+        vb.mVertexCount += added;
+    }
+}
+
+}
+
+void buildStaticBatches(const FlattenedObjects& objects,
+    const PmrMetaIDUnorderedMap<MeshData>& meshes,
+    const MetaID& nameSpace, float cellSize,
+    FlattenedObjects& batched, PmrMetaIDUnorderedMap<MeshData>& batchMeshes
+) {
+    Expects(cellSize > 0);
+    const auto objectCount = objects.mMeshRenderers.size();
+
+    // group submeshes by material, layout and the cell of their center
+    std::map<BatchKey, std::vector<BatchPiece>> groups;
+    std::vector<std::vector<const std::vector<BatchPiece>*>> objectGroups(objectCount);
+    for (uint32_t i = 0; i != objectCount; ++i) {
+        const auto& renderer = objects.mMeshRenderers[i];
+        const auto& mesh = meshes.at(renderer.mMeshID);
+        const auto& world = objects.mWorldTransforms[i].mTransform;
+        Expects(renderer.mMaterialIDs.size() == mesh.mSubMeshes.size());
+        for (uint32_t s = 0; s != mesh.mSubMeshes.size(); ++s) {
+            const Vector3f cell = (getPieceCenter(mesh, mesh.mSubMeshes[s], world) / cellSize).array().floor();
+            BatchKey key{ renderer.mMaterialIDs[s], mesh.mLayoutID,
+                { int32_t(cell.x()), int32_t(cell.y()), int32_t(cell.z()) } };
+            auto& group = groups[key];
+            group.emplace_back(BatchPiece{ i, s });
+            objectGroups[i].emplace_back(&group);
+        }
+    }
+
+    // a renderer is batched if any of its submeshes shares a batch
+    std::vector<char> merged(objectCount, false);
+    for (uint32_t i = 0; i != objectCount; ++i) {
+        for (const auto* group : objectGroups[i]) {
+            if (group->size() > 1) {
+                merged[i] = true;
+            }
+        }
+    }
+
+    resize(batched, 0);
+    for (uint32_t i = 0; i != objectCount; ++i) {
+        if (merged[i])
+            continue;
+        batched.mWorldTransforms.emplace_back(objects.mWorldTransforms[i]);
+        batched.mWorldTransformInvs.emplace_back(objects.mWorldTransformInvs[i]);
+        batched.mBoundingBoxes.emplace_back(objects.mBoundingBoxes[i]);
+        batched.mMeshRenderers.emplace_back(objects.mMeshRenderers[i]);
+    }
+
+    struct Batch {
+        const BatchKey* mKey;
+        std::vector<BatchPiece> mPieces;
+        MetaID mMeshID;
+        MeshData mMesh;
+        Vector3f mLower;
+        Vector3f mUpper;
+    };
+    std::vector<Batch> batches;
+    boost::uuids::name_generator_latest gen(nameSpace);
+    for (const auto& [key, pieces] : groups) {
+        Batch batch{ &key, {}, {}, MeshData(std::pmr::get_default_resource()), {}, {} };
+        for (const auto& piece : pieces) {
+            if (merged[piece.mObjectID]) {
+                batch.mPieces.emplace_back(piece);
+            }
+        }
+        if (batch.mPieces.empty())
+            continue;
+        std::ostringstream oss;
+        oss << "static_batch/" << key.mMaterialID << "/" << key.mLayoutID << "/"
+            << key.mCell[0] << "_" << key.mCell[1] << "_" << key.mCell[2];
+        batch.mMeshID = gen(oss.str());
+        batches.emplace_back(std::move(batch));
+    }
+
+    std::for_each(std::execution::par, batches.begin(), batches.end(), [&](Batch& batch) {
+        const auto& first = meshes.at(objects.mMeshRenderers[batch.mPieces.front().mObjectID].mMeshID);
+        auto& mesh = batch.mMesh;
+        mesh.mLayoutID = first.mLayoutID;
+        mesh.mLayoutName = first.mLayoutName;
+        for (const auto& vb : first.mVertexBuffers) {
+            auto& dst = mesh.mVertexBuffers.emplace_back();
+            dst.mDesc = vb.mDesc;
+            dst.mVertexCount = 0;
+        }
+        std::vector<uint32_t> indices;
+        for (const auto& piece : batch.mPieces) {
+            const auto& src = meshes.at(objects.mMeshRenderers[piece.mObjectID].mMeshID);
+            if (src.mVertexBuffers.size() != mesh.mVertexBuffers.size()) {
+                throw std::invalid_argument("static batching requires identical vertex buffers");
+            }
+            appendPiece(src, src.mSubMeshes[piece.mSubMeshID],
+                objects.mWorldTransforms[piece.mObjectID].mTransform, mesh, indices);
+        }
+
+        auto& ib = mesh.mIndexBuffer;
+        ib.mPrimitiveTopology = GFX_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+        ib.mPrimitiveCount = gsl::narrow<uint32_t>(indices.size() / 3);
+        ib.mElementSize = mesh.mVertexBuffers.front().mVertexCount <= 65536 ? 2 : 4;
+        ib.mBuffer.resize(indices.size() * ib.mElementSize);
+        for (size_t i = 0; i != indices.size(); ++i) {
+            if (ib.mElementSize == 2) {
+                reinterpret_cast<uint16_t*>(ib.mBuffer.data())[i] = gsl::narrow_cast<uint16_t>(indices[i]);
+            } else {
+                reinterpret_cast<uint32_t*>(ib.mBuffer.data())[i] = indices[i];
+            }
+        }
+        mesh.mSubMeshes.emplace_back(SubMeshData{ 0u, gsl::narrow<uint32_t>(indices.size()) });
+
+        const auto name = boost::uuids::to_string(batch.mMeshID);
+        optimizeMesh(mesh, name);
+        buildMeshlets(mesh);
+        buildMeshLods(mesh, name);
+
+        batch.mLower = Vector3f::Constant(std::numeric_limits<float>::max());
+        batch.mUpper = Vector3f::Constant(std::numeric_limits<float>::lowest());
+        for (const auto& vb : mesh.mVertexBuffers) {
+            const auto* e = findPosition(vb);
+            if (!e)
+                continue;
+            for (uint32_t v = 0; v != vb.mVertexCount; ++v) {
+                const auto p = loadVector(vb.mBuffer.data() + size_t(v) * vb.mDesc.mVertexSize + e->mAlignedByteOffset, e->mFormat);
+                batch.mLower = batch.mLower.cwiseMin(p.head<3>());
+                batch.mUpper = batch.mUpper.cwiseMax(p.head<3>());
+            }
+        }
+    });
+
+    for (auto& batch : batches) {
+        batched.mWorldTransforms.emplace_back(WorldTransform{ Affine3f::Identity() });
+        batched.mWorldTransformInvs.emplace_back(WorldTransformInv{ Affine3f::Identity() });
+        const Aabb3f bounds(batch.mLower, batch.mUpper);
+        batched.mBoundingBoxes.emplace_back(BoundingBox{ bounds, bounds });
+        auto& renderer = batched.mMeshRenderers.emplace_back();
+        renderer.mMeshID = batch.mMeshID;
+        renderer.mMaterialIDs.emplace_back(batch.mKey->mMaterialID);
+
+        batchMeshes.insert_or_assign(batch.mMeshID, std::move(batch.mMesh));
+    }
+    S_INFO << "static batching: " << objectCount << " renderers, "
+        << batched.mMeshRenderers.size() << " after batching, " << batches.size() << " batches" << std::endl;
+}
+
+}
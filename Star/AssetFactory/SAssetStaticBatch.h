@@ -0,0 +1,33 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <Star/Graphics/SContentTypes.h>
+
+namespace Star::Asset {
+
+// renderers whose submeshes share a material, a vertex layout and a grid cell of cellSize
+// are merged into world space meshes, one renderer with an identity transform per batch.
+// renderers that would share a batch with nothing else are kept as they are.
+// batch meshes are named after nameSpace and their key, so rebuilds keep their metaIDs
+void buildStaticBatches(const Graphics::Render::FlattenedObjects& objects,
+    const PmrMetaIDUnorderedMap<Graphics::Render::MeshData>& meshes,
+    const MetaID& nameSpace, float cellSize,
+    Graphics::Render::FlattenedObjects& batched,
+    PmrMetaIDUnorderedMap<Graphics::Render::MeshData>& batchMeshes);
+
+}
@@ -0,0 +1,145 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "SAssetStressScene.h"
+#include <Star/Graphics/SContentUtils.h>
+
+namespace Star::Asset {
+
+using namespace Graphics::Render;
+
+namespace {
+
+// splitmix64, nodes are placed by their index so the scene does not depend on generation order
+uint64_t mix(uint64_t x) noexcept {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+class NodeRandom {
+public:
+    NodeRandom(uint32_t seed, uint32_t level, uint64_t node) noexcept
+        : mState(mix(mix(mix(seed) ^ level) ^ node))
+    {}
+
+    // [-1, 1)
+    float next() noexcept {
+        mState = mix(mState);
+        return float(mState >> 40) / float(1ull << 23) - 1.0f;
+    }
+private:
+    uint64_t mState;
+};
+
+uint64_t power(uint64_t base, uint32_t exp) noexcept {
+    uint64_t result = 1;
+    for (uint32_t i = 0; i != exp; ++i) {
+        result *= base;
+    }
+    return result;
+}
+
+}
+
+void buildStressObjects(const FlattenedObjects& source,
+    const StressSceneDesc& desc, FlattenedObjects& objects
+) {
+    Expects(desc.mBranching);
+
+    // fbx objects without mesh are transform nodes
+    std::vector<uint32_t> candidates;
+    for (uint32_t i = 0; i != source.mMeshRenderers.size(); ++i) {
+        if (source.mMeshRenderers[i].mMeshID.is_nil())
+            continue;
+        if (desc.mMeshVariety && candidates.size() == desc.mMeshVariety)
+            break;
+        candidates.emplace_back(i);
+    }
+    if (candidates.empty()) {
+        throw std::invalid_argument("stress objects need an fbx with meshes");
+    }
+
+    const uint32_t levels = std::max(1u, desc.mHierarchyDepth);
+    const uint64_t objectsPerRoot = power(desc.mBranching, levels - 1);
+    const uint64_t rootCount = (desc.mObjectCount + objectsPerRoot - 1) / objectsPerRoot;
+    const auto gridSide = static_cast<uint64_t>(std::ceil(std::cbrt(double(rootCount))));
+    const float rootSpacing = 2.0f * desc.mExtent / std::max<uint64_t>(1, gridSide);
+
+    auto placeNode = [&](uint32_t level, uint64_t node) -> Affine3f {
+        NodeRandom random(desc.mSeed, level, node);
+        Affine3f transform = Affine3f::Identity();
+        if (level == 0) {
+            if (desc.mDistribution == StressDistribution::Grid) {
+                const Vector3f cell(float(node % gridSide), float(node / gridSide % gridSide),
+                    float(node / (gridSide * gridSide)));
+                transform.translate((cell.array() + 0.5f).matrix() * rootSpacing
+                    - Vector3f::Constant(desc.mExtent));
+            } else {
+                transform.translate(Vector3f(random.next(), random.next(), random.next()) * desc.mExtent);
+            }
+        } else {
+            // children spread within half the room of their parent
+            const float radius = rootSpacing * std::ldexp(0.5f, -int(level));
+            transform.translate(Vector3f(random.next(), random.next(), random.next()) * radius);
+        }
+        transform.rotate(Eigen::AngleAxisf(random.next() * float(EIGEN_PI), Vector3f::UnitY()));
+        return transform;
+    };
+
+    // objects of a root are a contiguous range, roots are filled in parallel into the sized arrays
+    // an object only depends on its index, the output is the same as a serial walk
+    resize(objects, desc.mObjectCount);
+
+    std::vector<uint64_t> roots(rootCount);
+    std::iota(roots.begin(), roots.end(), uint64_t(0));
+    std::for_each(std::execution::par, roots.begin(), roots.end(), [&](uint64_t root) {
+        const uint64_t first = root * objectsPerRoot;
+        const uint64_t last = std::min<uint64_t>(first + objectsPerRoot, desc.mObjectCount);
+
+        // transforms of the ancestors of the current object, siblings are generated in a row
+        std::vector<Affine3f> ancestors(levels, Affine3f::Identity());
+        std::vector<uint64_t> ancestorIDs(levels, std::numeric_limits<uint64_t>::max());
+
+        for (uint64_t i = first; i != last; ++i) {
+            for (uint32_t level = 0; level != levels; ++level) {
+                const uint64_t node = i / power(desc.mBranching, levels - 1 - level);
+                if (ancestorIDs[level] == node)
+                    continue;
+                ancestorIDs[level] = node;
+                ancestors[level] = placeNode(level, node);
+                // a new parent always starts new children, deeper levels are recomposed below
+                if (level) {
+                    ancestors[level] = ancestors[level - 1] * ancestors[level];
+                }
+            }
+
+            // fbx scale and orientation are kept, its placement is replaced
+            const uint32_t sourceID = candidates[i % candidates.size()];
+            Affine3f local = Affine3f::Identity();
+            local.linear() = source.mWorldTransforms[sourceID].mTransform.linear();
+            const Affine3f world = ancestors.back() * local;
+
+            objects.mWorldTransforms[i].mTransform = world;
+            objects.mWorldTransformInvs[i].mTransform = world.inverse();
+            objects.mMeshRenderers[i] = source.mMeshRenderers[sourceID];
+        }
+    });
+}
+
+}
@@ -27,15 +27,18 @@
 #pragma warning(disable:5040)
 #include <Star/SGIL.h>
 #include <boost/gil/extension/io/png.hpp>
+#include <boost/gil/extension/io/jpeg.hpp>
 #include <boost/gil/extension/io/targa.hpp>
 #pragma warning(pop)
-#include <boost/gil/extension/numeric/sampler.hpp>
-#include <boost/gil/extension/numeric/resample.hpp>
 #include <3rdparty/DXTCompressor/DXTCompressorDLL.h>
 #include <Star/SAlignedBuffer.h>
 #include <StarCompiler/Graphics/SRenderFormatNames.h>
 #include <DirectXTex.h>
+#include <DirectXTexEXR.h>
 #include <Star/SStreamUtils.h>
+#include <smmintrin.h>
+#include <numeric>
+#include <future>
 
 namespace Star::Asset {
 
@@ -45,6 +48,9 @@ using namespace boost::gil;
 
 namespace {
 
+// matches clip(transparency - 0.5f) of the AlphaTest shader module
+constexpr float sAlphaTestCutoff = 0.5f;
+
 template<class Tag>
 void readImageInfo(std::istream& is, RESOURCE_DESC& desc) {
     Expects(is);
@@ -65,67 +71,230 @@ void readImageInfo(std::istream& is, RESOURCE_DESC& desc) {
     is.seekg(0);
 }
 
+// sRGB transfer of 8-bit channels, decoded by table and encoded at 12-bit linear precision
+struct SRGBTables {
+    SRGBTables() noexcept {
+        for (uint32_t i = 0; i != 256; ++i) {
+            float c = i / 255.0f;
+            mToLinear[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+        for (uint32_t i = 0; i != 4096; ++i) {
+            float c = i / 4095.0f;
+            float s = c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+            mFromLinear[i] = gsl::narrow_cast<uint8_t>(std::lround(std::clamp(s, 0.0f, 1.0f) * 255.0f));
+        }
+    }
+    std::array<float, 256> mToLinear;
+    std::array<uint8_t, 4096> mFromLinear;
+};
+
+const SRGBTables& getSRGBTables() noexcept {
+    static const SRGBTables sTables;
+    return sTables;
+}
+
+struct MipFilterSettings {
+    bool mSRGB = false;
+    bool mNormalMap = false;
+    bool mAlphaCoverage = false;
+};
+
+// rgba8 texel to linear rgba, alpha is always linear
+inline __m128 decodeTexel(const uint8_t* p, const SRGBTables* srgb) noexcept {
+    if (srgb) {
+        const auto& lut = srgb->mToLinear;
+        return _mm_setr_ps(lut[p[0]], lut[p[1]], lut[p[2]], p[3] * (1.0f / 255.0f));
+    }
+    int32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return _mm_mul_ps(_mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(v))),
+        _mm_set1_ps(1.0f / 255.0f));
+}
+
+inline void encodeTexel(__m128 c, uint8_t* p, const SRGBTables* srgb) noexcept {
+    c = _mm_min_ps(_mm_max_ps(c, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+    if (srgb) {
+        alignas(16) int32_t idx[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(idx),
+            _mm_cvtps_epi32(_mm_mul_ps(c, _mm_setr_ps(4095.0f, 4095.0f, 4095.0f, 255.0f))));
+        const auto& lut = srgb->mFromLinear;
+        p[0] = lut[idx[0]];
+        p[1] = lut[idx[1]];
+        p[2] = lut[idx[2]];
+        p[3] = gsl::narrow_cast<uint8_t>(idx[3]);
+        return;
+    }
+    __m128i v = _mm_cvtps_epi32(_mm_mul_ps(c, _mm_set1_ps(255.0f)));
+    v = _mm_packus_epi32(v, v);
+    v = _mm_packus_epi16(v, v);
+    int32_t r = _mm_cvtsi128_si32(v);
+    std::memcpy(p, &r, sizeof(r));
+}
+
+// filtered normals are shorter than unit, xyz is renormalized and w kept
+inline __m128 renormalize(__m128 c) noexcept {
+    __m128 n = _mm_sub_ps(_mm_mul_ps(c, _mm_set1_ps(2.0f)), _mm_set1_ps(1.0f));
+    __m128 len2 = _mm_dp_ps(n, n, 0x7F);
+    if (_mm_cvtss_f32(len2) < 1e-12f) {
+        return c;
+    }
+    n = _mm_div_ps(n, _mm_sqrt_ps(len2));
+    n = _mm_add_ps(_mm_mul_ps(n, _mm_set1_ps(0.5f)), _mm_set1_ps(0.5f));
+    return _mm_blend_ps(n, c, 0x8);
+}
+
+// 2x2 box filter in linear space, odd edges reuse the last texel
+// rows of the destination are independent and filtered in parallel
+void downsampleMip(const uint8_t* src, uint32_t srcWidth, uint32_t srcHeight, size_t srcPitch,
+    uint8_t* dst, uint32_t dstWidth, uint32_t dstHeight, size_t dstPitch,
+    const MipFilterSettings& settings
+) {
+    const SRGBTables* srgb = settings.mSRGB ? &getSRGBTables() : nullptr;
+    std::vector<uint32_t> rows(dstHeight);
+    std::iota(rows.begin(), rows.end(), 0u);
+    std::for_each(std::execution::par, rows.begin(), rows.end(), [&](uint32_t y) {
+        const uint8_t* row0 = src + srcPitch * std::min(2 * y, srcHeight - 1);
+        const uint8_t* row1 = src + srcPitch * std::min(2 * y + 1, srcHeight - 1);
+        uint8_t* out = dst + dstPitch * y;
+        const __m128 quarter = _mm_set1_ps(0.25f);
+        for (uint32_t x = 0; x != dstWidth; ++x) {
+            const size_t x0 = size_t(std::min(2 * x, srcWidth - 1)) * 4;
+            const size_t x1 = size_t(std::min(2 * x + 1, srcWidth - 1)) * 4;
+            __m128 c = _mm_add_ps(
+                _mm_add_ps(decodeTexel(row0 + x0, srgb), decodeTexel(row0 + x1, srgb)),
+                _mm_add_ps(decodeTexel(row1 + x0, srgb), decodeTexel(row1 + x1, srgb)));
+            c = _mm_mul_ps(c, quarter);
+            if (settings.mNormalMap) {
+                c = renormalize(c);
+            }
+            encodeTexel(c, out + size_t(x) * 4, srgb);
+        }
+    });
+}
+
+// texels past the image edge replicate the last column and row,
+// so partial 4x4 blocks are not pulled towards black or an average color
+void padMip(uint8_t* data, uint32_t width, uint32_t height,
+    uint32_t alignedWidth, uint32_t alignedHeight, size_t pitch, size_t pixelSize = 4
+) noexcept {
+    for (uint32_t y = 0; y != height; ++y) {
+        auto* row = data + pitch * y;
+        for (uint32_t x = width; x != alignedWidth; ++x) {
+            std::memcpy(row + x * pixelSize, row + (width - 1) * pixelSize, pixelSize);
+        }
+    }
+    for (uint32_t y = height; y != alignedHeight; ++y) {
+        std::memcpy(data + pitch * y, data + pitch * (height - 1), pitch);
+    }
+}
+
+using AlphaHistogram = std::array<uint32_t, 256>;
+
+AlphaHistogram getAlphaHistogram(const uint8_t* data, uint32_t width, uint32_t height, size_t pitch) noexcept {
+    AlphaHistogram hist{};
+    for (uint32_t y = 0; y != height; ++y) {
+        const auto* row = data + pitch * y;
+        for (uint32_t x = 0; x != width; ++x) {
+            ++hist[row[size_t(x) * 4 + 3]];
+        }
+    }
+    return hist;
+}
+
+// fraction of texels passing the alpha test once alpha is scaled
+float getAlphaCoverage(const AlphaHistogram& hist, float scale) noexcept {
+    uint32_t total = 0;
+    uint32_t passed = 0;
+    for (uint32_t a = 0; a != 256; ++a) {
+        total += hist[a];
+        if (a * scale >= sAlphaTestCutoff * 255.0f) {
+            passed += hist[a];
+        }
+    }
+    return total ? float(passed) / float(total) : 0.0f;
+}
+
+// box filtered alpha loses coverage at the cutoff and alpha-tested foliage thins out in the distance,
+// alpha of the mip is scaled so the same fraction of texels passes the test as in the top level
+void scaleAlphaToCoverage(uint8_t* data, uint32_t width, uint32_t height, size_t pitch, float coverage) noexcept {
+    const auto hist = getAlphaHistogram(data, width, height, pitch);
+    float lo = 0.0f;
+    float hi = 16.0f;
+    for (int k = 0; k != 16; ++k) {
+        float mid = (lo + hi) * 0.5f;
+        if (getAlphaCoverage(hist, mid) < coverage) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    const float scale = hi;
+    for (uint32_t y = 0; y != height; ++y) {
+        auto* row = data + pitch * y;
+        for (uint32_t x = 0; x != width; ++x) {
+            auto& a = row[size_t(x) * 4 + 3];
+            a = gsl::narrow_cast<uint8_t>(std::min(255l, std::lround(a * scale)));
+        }
+    }
+}
+
 // see https://www.khronos.org/opengl/wiki/S3_Texture_Compression
 // For non-power-of-two images that aren't a multiple of 4 in size,
 // the other colors of the 4x4 block are taken to be black.
 // Each 4x4 block is independent of any other, so it can be decompressed independently.
-template<class DstPixel>
+// Edge blocks are padded by replicating the image edge instead, and mips are box filtered
+// in linear space, so sRGB textures do not darken down the chain.
+// mip 0 is only read when already padded, so its strips may be compressed concurrently
 void generateImageMipMaps(std::byte* dstBuffer, uint32_t width, uint32_t height,
     const uint32_t BlockX, const uint32_t BlockY,
-    const size_t AlignX, uint32_t mipCount
+    const size_t AlignX, uint32_t mipCount,
+    const MipFilterSettings& settings,
+    bool padded = false
 ) {
     Expects(mipCount > 0);
 
+    const uint32_t BPE = 4 * BlockX * BlockY;
+    auto* data = reinterpret_cast<uint8_t*>(dstBuffer);
+
+    uint32_t width1 = boost::alignment::align_up(width, BlockX);
+    uint32_t height1 = boost::alignment::align_up(height, BlockY);
+    size_t pitch1 = width1 * size_t(4);
+    if (!padded) {
+        padMip(data, width, height, width1, height1, pitch1);
+    }
+
+    // alpha coverage is only preserved for textures mixing opaque and transparent texels
+    float coverage = -1.0f;
+    if (settings.mAlphaCoverage) {
+        const auto hist = getAlphaHistogram(data, width, height, pitch1);
+        const auto total = width * height;
+        if (hist[255] != total && hist[0] != total) {
+            coverage = getAlphaCoverage(hist, 1.0f);
+        }
+    }
+
     size_t offset = 0;
-    const uint32_t BPE = sizeof(DstPixel) * BlockX * BlockY;
     for (uint32_t k = 1; k != mipCount; ++k) {
-        uint32_t width1 = boost::alignment::align_up(width, BlockX);
-        uint32_t height1 = boost::alignment::align_up(height, BlockY);
-
-        size_t rowAlignment = width1 * sizeof(DstPixel);
-        auto srcView = interleaved_view(width, height, (const DstPixel*)(dstBuffer + offset), rowAlignment);
+        const auto* src = data + offset;
+        const uint32_t srcWidth = width;
+        const uint32_t srcHeight = height;
+        const size_t srcPitch = pitch1;
 
         offset += mip_size(width, height, BlockX, BlockY, BPE);
         Ensures(offset % AlignX == 0);
 
         width = half_size(width);
         height = half_size(height);
-
-        uint32_t width2 = boost::alignment::align_up(width, BlockX);
-        uint32_t height2 = boost::alignment::align_up(height, BlockY);
-
-        rowAlignment = width2 * sizeof(DstPixel);
-
-        auto dstView = interleaved_view(width, height, (DstPixel*)(dstBuffer + offset), rowAlignment);
-        resize_view(srcView, dstView, boost::gil::bilinear_sampler());
-
-        if (width2 == width && height2 == height) {
-            continue;
-        }
-
-        std::array<float, num_channels<DstPixel>::value> acc{};
-
-        float count = 0.0f;
-        for_each_pixel(dstView, [&](const DstPixel& pixel) {
-            for (size_t k = 0; k != num_channels<DstPixel>::value; ++k) {
-                acc[k] += pixel[k];
-            }
-            count += 1.0f;
-        });
-
-        DstPixel avg;
-        for (size_t k = 0; k != num_channels<DstPixel>::value; ++k) {
-            avg[k] = boost::numeric_cast<typename channel_type<DstPixel>::type>(acc[k] / count);
-        }
-
-        auto dstView2 = interleaved_view(width2, height2, (DstPixel*)(dstBuffer + offset), rowAlignment);
-        for (uint32_t i = 0; i != height2; ++i) {
-            for (uint32_t j = 0; j != width2; ++j) {
-                if (i < height && j < width)
-                    continue;
-                dstView2(j, i) = avg;
-            }
+        width1 = boost::alignment::align_up(width, BlockX);
+        height1 = boost::alignment::align_up(height, BlockY);
+        pitch1 = width1 * size_t(4);
+
+        auto* dst = data + offset;
+        downsampleMip(src, srcWidth, srcHeight, srcPitch, dst, width, height, pitch1, settings);
+        if (coverage >= 0.0f) {
+            scaleAlphaToCoverage(dst, width, height, pitch1, coverage);
         }
+        padMip(dst, width, height, width1, height1, pitch1);
     }
     Ensures(width == 1 && height == 1);
 }
@@ -133,9 +302,12 @@ void generateImageMipMaps(std::byte* dstBuffer, uint32_t width, uint32_t height,
 template<class Tag, class SrcPixel, size_t AlignX>
 void prepareTextureForCompression(std::istream& is, uint32_t width, uint32_t height,
     const uint32_t BlockX, const uint32_t BlockY, uint32_t mipCount, AlignedBuffer<AlignX>& buffer,
+    const MipFilterSettings& mipSettings,
     bool generateMipMaps = true,
     bool flipY = true
 ) {
+    static_assert(std::is_same_v<SrcPixel, rgba8_pixel_t>, "mip generation only supports rgba8");
+
     auto bpe = gsl::narrow_cast<uint32_t>(sizeof(SrcPixel)) * BlockX * BlockY;
     size_t bufferSize;
     if (generateMipMaps) {
@@ -143,7 +315,7 @@ void prepareTextureForCompression(std::istream& is, uint32_t width, uint32_t hei
     } else {
         bufferSize = mip_size(width, height, BlockX, BlockY, bpe);
     }
-    buffer.resize_aligned(bufferSize);
+    buffer.resize_aligned_uninitialized(bufferSize);
     size_t rowAlignment = boost::alignment::align_up(width, BlockX) * sizeof(SrcPixel);
     Expects(rowAlignment % AlignX == 0);
 
@@ -159,8 +331,237 @@ void prepareTextureForCompression(std::istream& is, uint32_t width, uint32_t hei
     }
 
     if (generateMipMaps) {
-        generateImageMipMaps<SrcPixel>(buffer.data(), width, height,
-            BlockX, BlockY, AlignX, mipCount);
+        generateImageMipMaps(buffer.data(), width, height,
+            BlockX, BlockY, AlignX, mipCount, mipSettings);
+    } else {
+        padMip(reinterpret_cast<uint8_t*>(buffer.data()), width, height,
+            boost::alignment::align_up(width, BlockX), boost::alignment::align_up(height, BlockY), rowAlignment);
+    }
+}
+
+// 8-bit gray, gray alpha, rgb or rgba row to rgba8, gray is replicated and alpha defaults to opaque
+void convertRowToRGBA8(const uint8_t* src, uint32_t channels, uint32_t width, uint8_t* dst) noexcept {
+    switch (channels) {
+    case 1:
+        for (uint32_t x = 0; x != width; ++x, src += 1, dst += 4) {
+            dst[0] = dst[1] = dst[2] = src[0];
+            dst[3] = 255;
+        }
+        break;
+    case 2:
+        for (uint32_t x = 0; x != width; ++x, src += 2, dst += 4) {
+            dst[0] = dst[1] = dst[2] = src[0];
+            dst[3] = src[1];
+        }
+        break;
+    case 3:
+        for (uint32_t x = 0; x != width; ++x, src += 3, dst += 4) {
+            dst[0] = src[0];
+            dst[1] = src[1];
+            dst[2] = src[2];
+            dst[3] = 255;
+        }
+        break;
+    default:
+        std::memcpy(dst, src, size_t(width) * 4);
+        break;
+    }
+}
+
+// block rows compressed by one task
+constexpr uint32_t sBlockRowsPerStrip = 16;
+
+// block rows [mBlockRowBegin, mBlockRowEnd) of a mip, strips of a mip are disjoint
+struct CompressionStrip {
+    const std::byte* mSource = nullptr; // rgba8 or rgba16f mip
+    std::byte* mDest = nullptr; // compressed mip
+    uint32_t mWidth = 0; // aligned to blocks
+    uint32_t mHeight = 0;
+    uint32_t mBlockRowBegin = 0;
+    uint32_t mBlockRowEnd = 0;
+};
+
+// png and jpeg rows are decoded one at a time straight into mip 0, flipped, converted to rgba8 and padded,
+// strips whose rows are all decoded are handed to submit while decoding continues
+template<class Tag, class Submit>
+void decodeRows(std::istream& is, uint32_t width, uint32_t height,
+    const uint32_t BlockX, const uint32_t BlockY, std::byte* dstBuffer, bool flipY,
+    const CompressionStrip* strips, size_t stripCount, Submit submit
+) {
+    auto reader = make_scanline_reader(is, Tag());
+    const auto& img = reader._info;
+    if constexpr (std::is_same_v<Tag, png_tag>) {
+        if (img._bit_depth != 8) {
+            throw std::runtime_error("png row decode only supports 8 bit depth");
+        }
+    } else {
+        if (img._data_precision != 8) {
+            throw std::runtime_error("jpeg row decode only supports 8 bit precision");
+        }
+    }
+    if (img._width != width || img._height != height) {
+        throw std::runtime_error("image size mismatch");
+    }
+    // cmyk jpeg rows are 4 channels too, but not rgba
+    const auto channels = gsl::narrow_cast<uint32_t>(reader._scanline_length / width);
+    if (reader._scanline_length != size_t(width) * channels || channels < 1 || channels > 4 ||
+        (std::is_same_v<Tag, jpeg_tag> && channels == 4))
+    {
+        throw std::runtime_error("row decode only supports 8 bit gray, rgb and rgba");
+    }
+
+    const uint32_t width1 = boost::alignment::align_up(width, BlockX);
+    const uint32_t height1 = boost::alignment::align_up(height, BlockY);
+    const size_t pitch = width1 * size_t(4);
+    auto* data = reinterpret_cast<uint8_t*>(dstBuffer);
+    std::vector<uint8_t> row(reader._scanline_length);
+    std::vector<char> submitted(stripCount, 0);
+
+    // rows [low, high) of mip 0 are final, padding rows replicate row height - 1
+    uint32_t low = flipY ? height : 0;
+    uint32_t high = low;
+    for (uint32_t y = 0; y != height; ++y) {
+        reader.read(row.data(), gsl::narrow_cast<int>(y));
+        const uint32_t dstY = flipY ? height - 1 - y : y;
+        auto* dst = data + pitch * dstY;
+        convertRowToRGBA8(row.data(), channels, width, dst);
+        for (uint32_t x = width; x != width1; ++x) {
+            std::memcpy(dst + size_t(x) * 4, dst + size_t(width - 1) * 4, 4);
+        }
+        if (dstY == height - 1) {
+            for (uint32_t padY = height; padY != height1; ++padY) {
+                std::memcpy(data + pitch * padY, dst, pitch);
+            }
+        }
+        if (flipY) {
+            low = dstY;
+            high = height1;
+        } else {
+            high = dstY + 1 == height ? height1 : dstY + 1;
+        }
+        for (size_t i = 0; i != stripCount; ++i) {
+            const auto& strip = strips[i];
+            if (!submitted[i] && low <= strip.mBlockRowBegin * BlockY && strip.mBlockRowEnd * BlockY <= high) {
+                submitted[i] = 1;
+                submit(strip);
+            }
+        }
+    }
+    Ensures(std::all_of(submitted.begin(), submitted.end(), [](char v) { return v != 0; }));
+}
+
+// BC1 and BC3 strips, two blocks per iteration where AVX2 is available
+void compressStripsDXTC(const std::vector<CompressionStrip>& strips, bool alpha) {
+    const bool avx2 = DXTC::HasAVX2();
+    std::for_each(std::execution::par, strips.begin(), strips.end(),
+        [&](const CompressionStrip& strip) {
+            const auto* pSrc = reinterpret_cast<const uint8_t*>(strip.mSource);
+            auto* pDst = reinterpret_cast<uint8_t*>(strip.mDest);
+            const int w = gsl::narrow_cast<int>(strip.mWidth);
+            const int h = gsl::narrow_cast<int>(strip.mHeight);
+            const int begin = gsl::narrow_cast<int>(strip.mBlockRowBegin);
+            const int end = gsl::narrow_cast<int>(strip.mBlockRowEnd);
+            if (alpha) {
+                if (avx2) {
+                    DXTC::CompressImageDXT5AVX2(pSrc, pDst, w, h, begin, end);
+                } else {
+                    DXTC::CompressImageDXT5SSE2(pSrc, pDst, w, h, begin, end);
+                }
+            } else if (w > 4 && h > 4) {
+                if (avx2) {
+                    DXTC::CompressImageDXT1AVX2(pSrc, pDst, w, h, begin, end);
+                } else {
+                    DXTC::CompressImageDXT1SSE2(pSrc, pDst, w, h, begin, end);
+                }
+            } else {
+                DXTC::CompressImageDXT1(pSrc, pDst, w, h, begin, end);
+            }
+        });
+}
+
+// BC5, BC6H and BC7 strips encoded by DirectXTex, sources are rgba8 or rgba16f
+void compressStripsDirectXTex(const std::vector<CompressionStrip>& strips,
+    Format format, TextureCompressionQuality quality,
+    DXGI_FORMAT srcFormat = DXGI_FORMAT_UNKNOWN, size_t srcPixelSize = 4
+) {
+    const auto dstFormat = getDXGIFormat(format);
+    if (srcFormat == DXGI_FORMAT_UNKNOWN) {
+        srcFormat = isSRGB(format) ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM;
+    }
+    auto flags = DirectX::TEX_COMPRESS_DEFAULT;
+    if (quality == TextureCompressionQuality::Fast) {
+        flags |= DirectX::TEX_COMPRESS_BC7_QUICK;
+    } else if (quality == TextureCompressionQuality::Slow) {
+        flags |= DirectX::TEX_COMPRESS_BC7_USE_3SUBSETS;
+    }
+
+    std::for_each(std::execution::par, strips.begin(), strips.end(),
+        [&](const CompressionStrip& strip) {
+            const auto blockRows = strip.mBlockRowEnd - strip.mBlockRowBegin;
+            DirectX::Image image{};
+            image.width = strip.mWidth;
+            image.height = blockRows * 4;
+            image.format = srcFormat;
+            image.rowPitch = size_t(strip.mWidth) * srcPixelSize;
+            image.slicePitch = image.rowPitch * image.height;
+            image.pixels = const_cast<uint8_t*>(reinterpret_cast<const uint8_t*>(strip.mSource))
+                + image.rowPitch * 4 * strip.mBlockRowBegin;
+
+            DirectX::ScratchImage result;
+            if (FAILED(DirectX::Compress(image, dstFormat, flags, DirectX::TEX_THRESHOLD_DEFAULT, result))) {
+                throw std::runtime_error("texture compression failed");
+            }
+            const auto blockRowSize = size_t(strip.mWidth / 4) * 16;
+            Expects(result.GetPixelsSize() >= blockRowSize * blockRows);
+            std::memcpy(strip.mDest + blockRowSize * strip.mBlockRowBegin,
+                result.GetPixels(), blockRowSize * blockRows);
+        });
+}
+
+enum class StripEncoder {
+    None,
+    BC1,
+    BC3,
+    DirectXTex,
+};
+
+StripEncoder getStripEncoder(Format format) noexcept {
+    switch (format) {
+    case Format::BC1_UNORM_BLOCK:
+    case Format::BC1_SRGB_BLOCK:
+    case Format::BC1_TYPELESS_BLOCK:
+        return StripEncoder::BC1;
+    case Format::BC3_UNORM_BLOCK:
+    case Format::BC3_SRGB_BLOCK:
+    case Format::BC3_TYPELESS_BLOCK:
+        return StripEncoder::BC3;
+    case Format::BC5_UNORM_BLOCK:
+    case Format::BC5_TYPELESS_BLOCK:
+    case Format::BC7_UNORM_BLOCK:
+    case Format::BC7_SRGB_BLOCK:
+    case Format::BC7_TYPELESS_BLOCK:
+        return StripEncoder::DirectXTex;
+    default:
+        return StripEncoder::None;
+    }
+}
+
+void compressStrips(const std::vector<CompressionStrip>& strips, StripEncoder encoder,
+    Format format, TextureCompressionQuality quality
+) {
+    switch (encoder) {
+    case StripEncoder::BC1:
+        compressStripsDXTC(strips, false);
+        break;
+    case StripEncoder::BC3:
+        compressStripsDXTC(strips, true);
+        break;
+    case StripEncoder::DirectXTex:
+        compressStripsDirectXTex(strips, format, quality);
+        break;
+    case StripEncoder::None:
+    default:
+        throw std::invalid_argument("Format not supported");
     }
 }
 
@@ -189,8 +590,27 @@ void loadImage(std::istream& is, std::pmr::memory_resource* mr,
 
     const int AlignX = 16;
     AlignedBuffer<16> buffer(mr);
-    prepareTextureForCompression<Tag, SrcPixel>(is, width, height, BlockX, BlockY, mipCount, buffer,
-        info.mGenerateMipMaps, info.mFlipY);
+    MipFilterSettings mipSettings;
+    mipSettings.mSRGB = isSRGB(info.mFormat);
+    mipSettings.mNormalMap = info.mNormalMap;
+    mipSettings.mAlphaCoverage = info.mAlphaCoverage && !info.mNormalMap;
+
+    const auto encoder = getStripEncoder(info.mFormat);
+    if (encoder == StripEncoder::None) {
+        S_ERROR << "Format not supported" << getName(info.mFormat) << std::endl;
+        throw std::invalid_argument("Format not supported");
+    }
+
+    // png and jpeg are decoded row by row while mip 0 is compressed, other sources are decoded up front
+    constexpr bool streamRows = std::is_same_v<Tag, png_tag> || std::is_same_v<Tag, jpeg_tag>;
+    if constexpr (streamRows) {
+        buffer.resize_aligned_uninitialized(info.mGenerateMipMaps
+            ? texture_size(width, height, BlockX, BlockY, srcBPE)
+            : mip_size(width, height, BlockX, BlockY, srcBPE));
+    } else {
+        prepareTextureForCompression<Tag, SrcPixel>(is, width, height, BlockX, BlockY, mipCount, buffer,
+            mipSettings, info.mGenerateMipMaps, info.mFlipY);
+    }
 
     auto [dstBPE, blockX, blockY] = getEncoding(info.mFormat);
     Expects(blockX == BlockX);
@@ -199,66 +619,60 @@ void loadImage(std::istream& is, std::pmr::memory_resource* mr,
         auto sz = getTextureSize(info.mFormat, width, height);
         auto sz1 = texture_size(width, height, blockX, blockY, dstBPE);
         Expects(sz == sz1);
-        tex.mBuffer.resize_aligned(sz);
+        tex.mBuffer.resize_aligned_uninitialized(sz);
         tex.mDesc.mMipLevels = mipCount;
     } else {
         auto sz = getMipSize(info.mFormat, width, height);
         auto sz1 = mip_size(width, height, blockX, blockY, dstBPE);
-        tex.mBuffer.resize_aligned(sz);
+        tex.mBuffer.resize_aligned_uninitialized(sz);
     }
 
+    // strips of every mip are compressed in parallel, mip 0 strips come first
+    std::vector<CompressionStrip> strips;
+    size_t mip0StripCount = 0;
     size_t srcOffset = 0;
     size_t dstOffset = 0;
     auto w = width;
     auto h = height;
+    for (int k = 0; k != tex.mDesc.mMipLevels; ++k) {
+        auto wa = boost::alignment::align_up(w, blockX);
+        auto ha = boost::alignment::align_up(h, blockY);
+        for (uint32_t row = 0; row < ha / blockY; row += sBlockRowsPerStrip) {
+            strips.emplace_back(CompressionStrip{
+                buffer.data() + srcOffset, tex.mBuffer.data() + dstOffset,
+                wa, ha, row, std::min(row + sBlockRowsPerStrip, ha / blockY) });
+        }
+        if (k == 0) {
+            mip0StripCount = strips.size();
+        }
+        srcOffset += mip_size(w, h, BlockX, BlockY, srcBPE);
+        dstOffset += mip_size(w, h, blockX, blockY, dstBPE);
+        w = half_size(w);
+        h = half_size(h);
+    }
 
     // convert to target texture
-    switch (info.mFormat) {
-    case Format::BC1_UNORM_BLOCK:
-    case Format::BC1_SRGB_BLOCK:
-    case Format::BC1_TYPELESS_BLOCK:
-    {
-        for (int k = 0; k != tex.mDesc.mMipLevels; ++k) {
-            auto wa = boost::alignment::align_up(w, blockX);
-            auto ha = boost::alignment::align_up(h, blockY);
-            if (wa > blockX && ha > blockY) {
-                DXTC::CompressImageDXT1SSE2(
-                    reinterpret_cast<const uint8_t*>(buffer.data() + srcOffset),
-                    reinterpret_cast<uint8_t*>(tex.mBuffer.data() + dstOffset),
-                    wa, ha);
-            } else {
-                DXTC::CompressImageDXT1(
-                    reinterpret_cast<const uint8_t*>(buffer.data() + srcOffset),
-                    reinterpret_cast<uint8_t*>(tex.mBuffer.data() + dstOffset),
-                    wa, ha);
-            }
-            srcOffset += mip_size(w, h, BlockX, BlockY, srcBPE);
-            dstOffset += mip_size(w, h, blockX, blockY, dstBPE);
-            w = half_size(w);
-            h = half_size(h);
+    static_assert(sizeof(SrcPixel) == 4);
+    if constexpr (streamRows) {
+        // declared after the buffers, so pending strips are joined before they are freed
+        std::vector<std::future<void>> tasks;
+        decodeRows<Tag>(is, width, height, BlockX, BlockY, buffer.data(), info.mFlipY,
+            strips.data(), mip0StripCount, [&](const CompressionStrip& strip) {
+                tasks.emplace_back(std::async(std::launch::async, [&info, encoder, strip]() {
+                    compressStrips({ strip }, encoder, info.mFormat, info.mQuality);
+                }));
+            });
+        if (info.mGenerateMipMaps) {
+            generateImageMipMaps(buffer.data(), width, height,
+                BlockX, BlockY, AlignX, mipCount, mipSettings, true);
         }
-    }
-    break;
-    case Format::BC3_UNORM_BLOCK:
-    case Format::BC3_SRGB_BLOCK:
-    case Format::BC3_TYPELESS_BLOCK:
-    {
-        for (int k = 0; k != tex.mDesc.mMipLevels; ++k) {
-            DXTC::CompressImageDXT5SSE2(
-                reinterpret_cast<const uint8_t*>(buffer.data() + srcOffset),
-                reinterpret_cast<uint8_t*>(tex.mBuffer.data() + dstOffset),
-                boost::alignment::align_up(w, blockX), boost::alignment::align_up(h, blockY));
-            srcOffset += mip_size(w, h, BlockX, BlockY, srcBPE);
-            dstOffset += mip_size(w, h, blockX, blockX, dstBPE);
-            w = half_size(w);
-            h = half_size(h);
-        }
-    }
-    break;
-    case Format::UNKNOWN:
-    default:
-        S_ERROR << "Format not supported" << getName(info.mFormat) << std::endl;
-        throw std::invalid_argument("Format not supported");
+        strips.erase(strips.begin(), strips.begin() + mip0StripCount);
+        compressStrips(strips, encoder, info.mFormat, info.mQuality);
+        for (auto& task : tasks) {
+            task.get();
+        }
+    } else {
+        compressStrips(strips, encoder, info.mFormat, info.mQuality);
     }
 }
 
@@ -307,21 +721,164 @@ void loadPNG(std::istream& is, std::pmr::memory_resource* mr, const TextureImpor
     const auto& img = read_image_info(is, png_tag())._info;
     is.seekg(0);
 
-    if (settings.mFormat == Format::UNKNOWN) {
-        if (img._bit_depth != 8) {
-            throw std::runtime_error("png only support 8 bit depth");
-        }
-        auto info = settings;
-        if (img._num_channels < 4) {
+    if (img._bit_depth != 8) {
+        throw std::runtime_error("png only support 8 bit depth");
+    }
+    auto info = settings;
+    if (info.mFormat == Format::UNKNOWN) {
+        if (settings.mNormalMap) {
+            info.mFormat = Format::S_BC5_UNORM_BLOCK;
+        } else if (settings.mQuality != TextureCompressionQuality::Fast) {
+            info.mFormat = Format::S_BC7_SRGB_BLOCK;
+        } else if (img._num_channels < 4) {
             info.mFormat = Format::S_BC1_SRGB_BLOCK;
         } else {
             info.mFormat = Format::S_BC3_SRGB_BLOCK;
         }
-        loadImage<png_tag, rgba8_pixel_t>(is, mr,
-            gsl::narrow_cast<uint32_t>(img._width),
-            gsl::narrow_cast<uint32_t>(img._height),
-            4, 4, info, tex);
     }
+    loadImage<png_tag, rgba8_pixel_t>(is, mr,
+        gsl::narrow_cast<uint32_t>(img._width),
+        gsl::narrow_cast<uint32_t>(img._height),
+        4, 4, info, tex);
+}
+
+void loadJPG(std::istream& is, std::pmr::memory_resource* mr, const TextureImportSettings& settings, TextureData& tex) {
+    const auto& img = read_image_info(is, jpeg_tag())._info;
+    is.seekg(0);
+
+    if (img._data_precision != 8) {
+        throw std::runtime_error("jpeg only support 8 bit precision");
+    }
+    // jpeg has no alpha, BC1 is enough at fast quality
+    auto info = settings;
+    info.mAlphaCoverage = false;
+    if (info.mFormat == Format::UNKNOWN) {
+        if (settings.mNormalMap) {
+            info.mFormat = Format::S_BC5_UNORM_BLOCK;
+        } else if (settings.mQuality != TextureCompressionQuality::Fast) {
+            info.mFormat = Format::S_BC7_SRGB_BLOCK;
+        } else {
+            info.mFormat = Format::S_BC1_SRGB_BLOCK;
+        }
+    }
+    loadImage<jpeg_tag, rgba8_pixel_t>(is, mr,
+        gsl::narrow_cast<uint32_t>(img._width),
+        gsl::narrow_cast<uint32_t>(img._height),
+        4, 4, info, tex);
+}
+
+void loadEXR(const std::filesystem::path& filename, std::pmr::memory_resource* mr,
+    const TextureImportSettings& settings, TextureData& tex
+) {
+    const auto format = settings.mFormat == Format::UNKNOWN ? Format::S_BC6H_UFLOAT_BLOCK : settings.mFormat;
+    if (format != Format::BC6H_UFLOAT_BLOCK && format != Format::BC6H_SFLOAT_BLOCK &&
+        format != Format::R16G16B16A16_SFLOAT)
+    {
+        S_ERROR << "Format not supported" << getName(format) << std::endl;
+        throw std::invalid_argument("exr only supports BC6H and R16G16B16A16_SFLOAT");
+    }
+
+    DirectX::TexMetadata meta{};
+    DirectX::ScratchImage image;
+    if (FAILED(DirectX::LoadFromEXRFile(filename.c_str(), &meta, image))) {
+        throw std::runtime_error("load exr failed: " + filename.string());
+    }
+    if (meta.format != DXGI_FORMAT_R16G16B16A16_FLOAT) {
+        DirectX::ScratchImage converted;
+        if (FAILED(DirectX::Convert(*image.GetImage(0, 0, 0), DXGI_FORMAT_R16G16B16A16_FLOAT,
+            DirectX::TEX_FILTER_DEFAULT, DirectX::TEX_THRESHOLD_DEFAULT, converted)))
+        {
+            throw std::runtime_error("exr conversion failed: " + filename.string());
+        }
+        image = std::move(converted);
+    }
+    if (settings.mFlipY) {
+        DirectX::ScratchImage flipped;
+        if (FAILED(DirectX::FlipRotate(*image.GetImage(0, 0, 0), DirectX::TEX_FR_FLIP_VERTICAL, flipped))) {
+            throw std::runtime_error("exr flip failed: " + filename.string());
+        }
+        image = std::move(flipped);
+    }
+    const auto width = gsl::narrow<uint32_t>(image.GetMetadata().width);
+    const auto height = gsl::narrow<uint32_t>(image.GetMetadata().height);
+    // box filtered by the DirectXMath float path, hdr texels are never gamma decoded
+    if (settings.mGenerateMipMaps && (width > 1 || height > 1)) {
+        DirectX::ScratchImage mips;
+        if (FAILED(DirectX::GenerateMipMaps(*image.GetImage(0, 0, 0),
+            DirectX::TEX_FILTER_BOX | DirectX::TEX_FILTER_FORCE_NON_WIC, 0, mips)))
+        {
+            throw std::runtime_error("exr mip generation failed: " + filename.string());
+        }
+        image = std::move(mips);
+    }
+    const auto mipCount = gsl::narrow<uint32_t>(image.GetMetadata().mipLevels);
+    Expects(mipCount == 1 || mipCount == mip_count(width, height));
+
+    tex.mDesc.mDimension = RESOURCE_DIMENSION_TEXTURE2D;
+    tex.mDesc.mAlignment = 0u;
+    tex.mDesc.mWidth = width;
+    tex.mDesc.mHeight = height;
+    tex.mDesc.mDepthOrArraySize = 1u;
+    tex.mDesc.mMipLevels = gsl::narrow<uint16_t>(mipCount);
+    tex.mDesc.mFormat = format;
+    tex.mDesc.mSampleDesc = { 1u, 0u };
+    tex.mDesc.mLayout = TEXTURE_LAYOUT_UNKNOWN;
+    tex.mDesc.mFlags = {};
+    tex.mFormat = format;
+    tex.mBuffer.resize_aligned_uninitialized(mipCount == 1
+        ? getMipSize(format, width, height)
+        : getTextureSize(format, width, height));
+
+    constexpr size_t pixelSize = 8;
+    if (format == Format::R16G16B16A16_SFLOAT) {
+        // mips are stored tightly, rows of DirectXTex images may be padded
+        auto* dst = tex.mBuffer.data();
+        for (uint32_t k = 0; k != mipCount; ++k) {
+            const auto& mip = *image.GetImage(k, 0, 0);
+            const auto rowSize = mip.width * pixelSize;
+            for (size_t y = 0; y != mip.height; ++y, dst += rowSize) {
+                std::memcpy(dst, mip.pixels + mip.rowPitch * y, rowSize);
+            }
+        }
+        return;
+    }
+
+    // mips are copied into a block aligned chain with replicated edges, then compressed in strips
+    const uint32_t srcBPE = pixelSize * 16;
+    const auto [dstBPE, blockX, blockY] = getEncoding(format);
+    Expects(blockX == 4 && blockY == 4);
+    AlignedBuffer16 buffer(mr);
+    buffer.resize_aligned_uninitialized(mipCount == 1
+        ? mip_size(width, height, 4, 4, srcBPE)
+        : texture_size(width, height, 4, 4, srcBPE));
+
+    std::vector<CompressionStrip> strips;
+    size_t srcOffset = 0;
+    size_t dstOffset = 0;
+    auto w = width;
+    auto h = height;
+    for (uint32_t k = 0; k != mipCount; ++k) {
+        const auto wa = boost::alignment::align_up(w, 4u);
+        const auto ha = boost::alignment::align_up(h, 4u);
+        const auto pitch = wa * pixelSize;
+        const auto& mip = *image.GetImage(k, 0, 0);
+        Expects(mip.width == w && mip.height == h);
+        auto* src = reinterpret_cast<uint8_t*>(buffer.data() + srcOffset);
+        for (uint32_t y = 0; y != h; ++y) {
+            std::memcpy(src + pitch * y, mip.pixels + mip.rowPitch * y, w * pixelSize);
+        }
+        padMip(src, w, h, wa, ha, pitch, pixelSize);
+        for (uint32_t row = 0; row < ha / 4; row += sBlockRowsPerStrip) {
+            strips.emplace_back(CompressionStrip{
+                buffer.data() + srcOffset, tex.mBuffer.data() + dstOffset,
+                wa, ha, row, std::min(row + sBlockRowsPerStrip, ha / 4) });
+        }
+        srcOffset += mip_size(w, h, 4, 4, srcBPE);
+        dstOffset += mip_size(w, h, blockX, blockY, dstBPE);
+        w = half_size(w);
+        h = half_size(h);
+    }
+    compressStripsDirectXTex(strips, format, settings.mQuality, DXGI_FORMAT_R16G16B16A16_FLOAT, pixelSize);
 }
 
 void loadTGA(std::istream& is, std::pmr::memory_resource* mr, const TextureImportSettings& settings, TextureData& tex) {
@@ -358,6 +915,14 @@ struct DDS_HEADER {
     uint32_t        reserved2;
 };
 
+struct DDS_HEADER_DXT10 {
+    uint32_t        dxgiFormat;
+    uint32_t        resourceDimension;
+    uint32_t        miscFlag; // see D3D11_RESOURCE_MISC_FLAG
+    uint32_t        arraySize;
+    uint32_t        miscFlags2;
+};
+
 }
 
 void loadDDS(std::istream& is, std::pmr::memory_resource* mr, Graphics::Render::TextureData& tex, bool bSrgb) {
@@ -371,6 +936,7 @@ void loadDDS(std::istream& is, std::pmr::memory_resource* mr, Graphics::Render::
 
     std::array<char, 4> dxt1{ 'D', 'X', 'T', '1' };
     std::array<char, 4> dxt5{ 'D', 'X', 'T', '5' };
+    std::array<char, 4> dx10{ 'D', 'X', '1', '0' };
 
     auto& desc = tex.mDesc;
 
@@ -400,33 +966,47 @@ void loadDDS(std::istream& is, std::pmr::memory_resource* mr, Graphics::Render::
         } else {
             tex.mFormat = makeTypelessUNorm(desc.mFormat);
         }
+    } else if (memcmp(fourcc.data(), dx10.data(), 4) == 0) {
+        DDS_HEADER_DXT10 header10;
+        read_data(is, header10);
+        desc.mDimension = Graphics::Render::RESOURCE_DIMENSION_TEXTURE2D;
+        desc.mAlignment = 0;
+        desc.mWidth = header.width;
+        desc.mHeight = header.height;
+        desc.mDepthOrArraySize = gsl::narrow<uint16_t>(header10.arraySize);
+        desc.mMipLevels = header.mipMapCount;
+        desc.mFormat = getRenderFormat(static_cast<DXGI_FORMAT>(header10.dxgiFormat));
+        // ldr formats are saved typeless, hdr formats keep their float type
+        if (!isTypeless(desc.mFormat)) {
+            tex.mFormat = desc.mFormat;
+        } else if (bSrgb) {
+            tex.mFormat = makeTypelessSRGB(desc.mFormat);
+        } else {
+            tex.mFormat = makeTypelessUNorm(desc.mFormat);
+        }
     } else {
         throw std::runtime_error("dds file not found");
     }
     desc.mSampleDesc = { 1, 0 };
 
-    auto uploadSize = Graphics::Render::getTextureUploadSize(desc.mFormat,
-        gsl::narrow_cast<uint32_t>(desc.mWidth), gsl::narrow_cast<uint32_t>(desc.mHeight));
-    tex.mBuffer.resize_aligned(uploadSize);
+    std::vector<Graphics::Render::SubresourceFootprint> footprints(desc.mMipLevels);
+    auto uploadSize = Graphics::Render::getSubresourceFootprints(desc.mFormat,
+        gsl::narrow_cast<uint32_t>(desc.mWidth), gsl::narrow_cast<uint32_t>(desc.mHeight),
+        desc.mMipLevels, 1, footprints);
+    tex.mBuffer.resize_aligned_uninitialized(uploadSize);
     
-    auto width = gsl::narrow_cast<uint32_t>(desc.mWidth);
-    auto height = gsl::narrow_cast<uint32_t>(desc.mHeight);
     int64_t readCount = 0;
     char* dstSliceBuffer = reinterpret_cast<char*>(tex.mBuffer.data());
 
-    for (int k = 0; k != desc.mMipLevels; ++k) {
-        auto [rowCount, rowPitch, uploadRowPitch, sliceSize, alignedSliceSize, uploadSliceSize] = getMipInfo(desc.mFormat, width, height);
-
-        auto dstPitchBuffer = dstSliceBuffer;
-        for (int i = 0; i != rowCount; ++i) {
-            is.read(dstPitchBuffer, rowPitch);
-            readCount += rowPitch;
-            dstPitchBuffer += uploadRowPitch;
+    for (const auto& footprint : footprints) {
+        const auto& mip = footprint.mMip;
+        auto dstPitchBuffer = reinterpret_cast<char*>(tex.mBuffer.data()) + footprint.mOffset;
+        for (uint32_t i = 0; i != mip.mRowCount; ++i) {
+            is.read(dstPitchBuffer, mip.mRowPitchSize);
+            readCount += mip.mRowPitchSize;
+            dstPitchBuffer += mip.mUploadRowPitchSize;
         }
-
-        width = half_size(width);
-        height = half_size(height);
-        dstSliceBuffer += uploadSliceSize;
+        dstSliceBuffer = reinterpret_cast<char*>(tex.mBuffer.data()) + footprint.mOffset + mip.mUploadSliceSize;
     }
 
     auto texSize = getTextureSize(desc.mFormat,
@@ -436,7 +1016,7 @@ void loadDDS(std::istream& is, std::pmr::memory_resource* mr, Graphics::Render::
         desc.mFormat == Graphics::Render::Format::BC1_UNORM_BLOCK ||
         desc.mFormat == Graphics::Render::Format::BC1_SRGB_BLOCK) {
         Expects(boost::alignment::align_up(readCount, 8) == texSize);
-    } else {
+    } else if (desc.mFormat != Graphics::Render::Format::R16G16B16A16_SFLOAT) {
         Expects(boost::alignment::align_up(readCount, 16) == texSize);
     }
 
@@ -455,7 +1035,11 @@ void saveDDS(std::ostream& os, const Graphics::Render::TextureData& tex0) {
         int sz = tex.mDepthOrArraySize * tex.mMipLevels;
         
         auto formatS = makeTypeless(tex.mFormat);
-        formatS = makeTypelessUNorm(formatS);
+        if (formatS == Format::BC6H_TYPELESS_BLOCK || formatS == Format::R16G16B16A16_TYPELESS) {
+            formatS = tex.mFormat;
+        } else {
+            formatS = makeTypelessUNorm(formatS);
+        }
         DXGI_FORMAT format = getDXGIFormat(formatS);
 
         std::vector<DirectX::Image> images(sz);
@@ -494,7 +1078,7 @@ void saveDDS(std::ostream& os, const Graphics::Render::TextureData& tex0) {
 
         DirectX::Blob blob;
         HRESULT hr = DirectX::SaveToDDSMemory(reinterpret_cast<const DirectX::Image*>(images.data()),
-            images.size(), meta, 0, blob);
+            images.size(), meta, DirectX::DDS_FLAGS_FORCE_DX10_EXT, blob);
 
         if (hr) {
             S_ERROR << "Save DDS File :failed" << std::endl;
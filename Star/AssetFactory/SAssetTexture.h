@@ -25,6 +25,9 @@ uint32_t getNumChannelsPNG(std::istream& is);
 bool isAlphaTestPNG(std::istream& is);
 
 void loadPNG(std::istream& is, std::pmr::memory_resource* mr, const TextureImportSettings& settings, Graphics::Render::TextureData& tex);
+void loadJPG(std::istream& is, std::pmr::memory_resource* mr, const TextureImportSettings& settings, Graphics::Render::TextureData& tex);
+// hdr, BC6H unsigned by default, mFormat picks BC6H signed or uncompressed R16G16B16A16_SFLOAT
+void loadEXR(const std::filesystem::path& filename, std::pmr::memory_resource* mr, const TextureImportSettings& settings, Graphics::Render::TextureData& tex);
 void loadTGA(std::istream& is, std::pmr::memory_resource* mr, const TextureImportSettings& settings, Graphics::Render::TextureData& tex);
 
 void loadDDS(std::istream& is, std::pmr::memory_resource* mr, Graphics::Render::TextureData& tex, bool bSrgb);
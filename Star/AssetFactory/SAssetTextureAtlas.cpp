@@ -0,0 +1,122 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "SAssetTextureAtlas.h"
+#include <Star/Graphics/SRenderFormatTextureUtils.h>
+
+namespace Star::Asset {
+
+using namespace Graphics::Render;
+
+namespace {
+
+bool isPowerOfTwo(uint64_t x) noexcept {
+    return x && !(x & (x - 1));
+}
+
+// mips smaller than a block would mix neighbouring tiles
+uint32_t getAtlasMipLevels(const TextureData& tile) noexcept {
+    const auto [bpe, blockX, blockY] = getEncoding(tile.mDesc.mFormat);
+    uint32_t mipLevels = 0;
+    auto width = tile.mDesc.mWidth;
+    auto height = tile.mDesc.mHeight;
+    while (mipLevels != tile.mDesc.mMipLevels && width >= blockX && height >= blockY) {
+        ++mipLevels;
+        width /= 2;
+        height /= 2;
+    }
+    return std::max(mipLevels, 1u);
+}
+
+}
+
+bool isAtlasCompatible(const TextureData& lhs, const TextureData& rhs) noexcept {
+    const auto& l = lhs.mDesc;
+    const auto& r = rhs.mDesc;
+    return l.mDimension == RESOURCE_DIMENSION_TEXTURE2D && r.mDimension == RESOURCE_DIMENSION_TEXTURE2D &&
+        l.mDepthOrArraySize == 1 && r.mDepthOrArraySize == 1 &&
+        isPowerOfTwo(l.mWidth) && isPowerOfTwo(l.mHeight) &&
+        std::forward_as_tuple(l.mFormat, lhs.mFormat, l.mWidth, l.mHeight, l.mMipLevels) ==
+        std::forward_as_tuple(r.mFormat, rhs.mFormat, r.mWidth, r.mHeight, r.mMipLevels);
+}
+
+uint32_t getAtlasTileCapacity(const TextureData& tile, uint32_t maxDimension) noexcept {
+    const auto columns = maxDimension / std::max<uint64_t>(tile.mDesc.mWidth, 1);
+    const auto rows = maxDimension / std::max<uint32_t>(tile.mDesc.mHeight, 1);
+    return gsl::narrow_cast<uint32_t>(columns * rows);
+}
+
+void buildTextureAtlas(gsl::span<const TextureData* const> tiles,
+    TextureData& atlas, std::vector<Vector4f>& uvTransforms
+) {
+    Expects(!tiles.empty());
+    const auto& first = *tiles[0];
+    for (const auto* pTile : tiles) {
+        Expects(isAtlasCompatible(first, *pTile));
+    }
+    const auto format = first.mDesc.mFormat;
+    const auto tileWidth = gsl::narrow<uint32_t>(first.mDesc.mWidth);
+    const auto tileHeight = first.mDesc.mHeight;
+    const auto count = gsl::narrow<uint32_t>(tiles.size());
+    const auto columns = gsl::narrow_cast<uint32_t>(std::ceil(std::sqrt(double(count))));
+    const auto rows = (count + columns - 1) / columns;
+    const auto mipLevels = getAtlasMipLevels(first);
+
+    atlas.mDesc = first.mDesc;
+    atlas.mDesc.mWidth = uint64_t(tileWidth) * columns;
+    atlas.mDesc.mHeight = tileHeight * rows;
+    atlas.mDesc.mMipLevels = gsl::narrow<uint16_t>(mipLevels);
+    atlas.mFormat = first.mFormat;
+
+    // power of two tiles halve exactly, mip m of the atlas is the grid of mip m of the tiles
+    uint64_t atlasSize = 0;
+    for (uint32_t mip = 0; mip != mipLevels; ++mip) {
+        atlasSize += getMipSize(format, (tileWidth >> mip) * columns, (tileHeight >> mip) * rows);
+    }
+    // cells left over by the last row are zero
+    atlas.mBuffer.clear();
+    atlas.mBuffer.resize_aligned(atlasSize);
+
+    uint64_t srcOffset = 0;
+    uint64_t dstOffset = 0;
+    for (uint32_t mip = 0; mip != mipLevels; ++mip) {
+        const auto tileInfo = getMipInfo(format, tileWidth >> mip, tileHeight >> mip);
+        const auto atlasInfo = getMipInfo(format, (tileWidth >> mip) * columns, (tileHeight >> mip) * rows);
+        for (uint32_t i = 0; i != count; ++i) {
+            const auto* src = tiles[i]->mBuffer.data() + srcOffset;
+            auto* dst = atlas.mBuffer.data() + dstOffset +
+                uint64_t(i / columns) * tileInfo.mRowCount * atlasInfo.mRowPitchSize +
+                uint64_t(i % columns) * tileInfo.mRowPitchSize;
+            for (uint32_t row = 0; row != tileInfo.mRowCount; ++row) {
+                std::memcpy(dst + uint64_t(row) * atlasInfo.mRowPitchSize,
+                    src + uint64_t(row) * tileInfo.mRowPitchSize, tileInfo.mRowPitchSize);
+            }
+        }
+        srcOffset += tileInfo.mSliceSize;
+        dstOffset += atlasInfo.mSliceSize;
+    }
+    Ensures(dstOffset == atlasSize);
+
+    uvTransforms.clear();
+    uvTransforms.reserve(count);
+    for (uint32_t i = 0; i != count; ++i) {
+        uvTransforms.emplace_back(1.f / columns, 1.f / rows,
+            float(i % columns) / columns, float(i / columns) / rows);
+    }
+}
+
+}
@@ -0,0 +1,34 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <Star/Graphics/SContentTypes.h>
+
+namespace Star::Asset {
+
+// textures of one format, power of two size and mip count can share an atlas
+bool isAtlasCompatible(const Graphics::Render::TextureData& lhs, const Graphics::Render::TextureData& rhs) noexcept;
+
+// tiles fitting an atlas of at most maxDimension on each side
+uint32_t getAtlasTileCapacity(const Graphics::Render::TextureData& tile, uint32_t maxDimension) noexcept;
+
+// packs compatible tiles on a grid, mips are kept down to the block size so tiles never share a block.
+// uvTransforms receives the uv scale in xy and offset in zw of each tile
+void buildTextureAtlas(gsl::span<const Graphics::Render::TextureData* const> tiles,
+    Graphics::Render::TextureData& atlas, std::vector<Vector4f>& uvTransforms);
+
+}
@@ -119,6 +119,29 @@ struct AssetDatabase {
     MetaIDNameIndex<RenderGraphInfo> mRenderGraphInfo;
 };
 
+// hashes of the last build of an asset, unchanged inputs skip the import
+struct BuildRecord {
+    uint64_t mSourceHash = 0;
+    uint64_t mSettingsHash = 0;
+    uint64_t mOutputHash = 0;
+};
+
+// records of the last build, keyed by asset or output name
+struct BuildDatabase {
+    std::map<std::string, BuildRecord, std::less<>> mRecords;
+};
+
+// meta file of an asset at the last scan, unchanged meta files are not parsed again
+struct ScanRecord {
+    int64_t mWriteTime = 0;
+    MetaID mMetaID = {};
+};
+
+// records of the last scan, keyed by asset name
+struct ScanCache {
+    std::map<std::string, ScanRecord, std::less<>> mRecords;
+};
+
 struct Direct_ {} static constexpr Direct;
 struct IndexToDirect_ {} static constexpr IndexToDirect;
 
@@ -130,10 +153,22 @@ struct ByPolygon_ {} static constexpr ByPolygon;
 
 using MappingMode = std::variant<ByControlPoint_, ByPolygonVertex_, ByPolygon_>;
 
+// BC7 mode search effort, BC1, BC3 and BC5 are not affected
+enum class TextureCompressionQuality : uint32_t {
+    Fast,
+    Normal,
+    Slow,
+};
+
 struct TextureImportSettings {
+    // unknown picks BC5 for normal maps, BC7 for color maps and BC1 or BC3 at fast quality
     Graphics::Render::Format mFormat = Graphics::Render::Format::UNKNOWN;
     bool mGenerateMipMaps = true;
     bool mFlipY = true;
+    bool mNormalMap = false;
+    // scale mip alpha to keep the alpha-test coverage of the top level
+    bool mAlphaCoverage = false;
+    TextureCompressionQuality mQuality = TextureCompressionQuality::Normal;
 };
 
 } // namespace Asset
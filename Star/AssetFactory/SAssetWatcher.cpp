@@ -0,0 +1,94 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+#include "SAssetWatcher.h"
+
+namespace Star::Asset {
+
+namespace {
+
+constexpr DWORD sAssetWatcherBufferSize = 64 * 1024;
+
+}
+
+AssetWatcher::AssetWatcher(const std::filesystem::path& folder) {
+    mDirectory = CreateFileW(folder.c_str(), FILE_LIST_DIRECTORY,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+        FILE_FLAG_BACKUP_SEMANTICS, nullptr);
+    if (mDirectory == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("open asset folder for watching failed: " + folder.string());
+    }
+    mThread = std::thread([this]() { run(); });
+}
+
+AssetWatcher::~AssetWatcher() {
+    // wakes the blocking ReadDirectoryChangesW of the watcher thread
+    CancelIoEx(mDirectory, nullptr);
+    if (mThread.joinable()) {
+        mThread.join();
+    }
+    CloseHandle(mDirectory);
+}
+
+bool AssetWatcher::poll(std::vector<std::string>& changes) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    changes.reserve(changes.size() + mChanges.size());
+    for (auto iter = mChanges.begin(); iter != mChanges.end();) {
+        auto node = mChanges.extract(iter++);
+        changes.emplace_back(std::move(node.value()));
+    }
+    bool complete = !mOverflowed;
+    mOverflowed = false;
+    return complete;
+}
+
+void AssetWatcher::run() noexcept {
+    // DWORD aligned, FILE_NOTIFY_INFORMATION records are chained by offset
+    std::vector<DWORD> buffer(sAssetWatcherBufferSize / sizeof(DWORD));
+    const DWORD filter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME |
+        FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE;
+
+    for (;;) {
+        DWORD bytes = 0;
+        if (!ReadDirectoryChangesW(mDirectory, buffer.data(), sAssetWatcherBufferSize,
+            TRUE, filter, &bytes, nullptr, nullptr))
+        {
+            // cancelled by the destructor, or the folder is gone
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (bytes == 0) {
+            mOverflowed = true;
+            continue;
+        }
+        const auto* data = reinterpret_cast<const std::byte*>(buffer.data());
+        for (;;) {
+            const auto& info = *reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(data);
+            std::filesystem::path name(std::wstring_view(info.FileName, info.FileNameLength / sizeof(WCHAR)));
+            try {
+                mChanges.emplace(boost::algorithm::to_lower_copy(name.generic_u8string()));
+            } catch (const std::exception&) {
+                mOverflowed = true;
+            }
+            if (info.NextEntryOffset == 0) {
+                break;
+            }
+            data += info.NextEntryOffset;
+        }
+    }
+}
+
+}
@@ -0,0 +1,46 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+#include <filesystem>
+#include <mutex>
+#include <thread>
+
+namespace Star::Asset {
+
+// ReadDirectoryChangesW on the asset folder, changes are collected on a background thread,
+// names are lowercase and relative to the folder, like asset names
+class AssetWatcher {
+public:
+    explicit AssetWatcher(const std::filesystem::path& folder);
+    AssetWatcher(const AssetWatcher&) = delete;
+    AssetWatcher& operator=(const AssetWatcher&) = delete;
+    ~AssetWatcher();
+
+    // drains the changed names, sorted and unique,
+    // returns false if the change buffer overflowed since the last poll and changes were lost
+    bool poll(std::vector<std::string>& changes);
+private:
+    void run() noexcept;
+
+    HANDLE mDirectory = INVALID_HANDLE_VALUE;
+    std::mutex mMutex;
+    std::set<std::string> mChanges;
+    bool mOverflowed = false;
+    std::thread mThread;
+};
+
+}
@@ -0,0 +1,131 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "SAllocationTracker.h"
+#include <dbghelp.h>
+#include <mutex>
+
+#pragma comment(lib, "dbghelp.lib")
+
+namespace Star::Core {
+
+namespace {
+
+thread_local bool tTracking = false;
+thread_local bool tAsserting = false;
+// set while reporting, allocations of dbghelp are not reported again
+thread_local bool tReporting = false;
+thread_local uint64_t tCount = 0;
+
+// dbghelp is single threaded
+std::mutex sSymbolMutex;
+bool sSymbolsInitialized = false;
+
+void reportAllocation(size_t size) noexcept {
+    void* frames[32];
+    // skips reportAllocation, onAllocate and the operator new hook
+    auto numFrames = CaptureStackBackTrace(3, 32, frames, nullptr);
+
+    char buffer[512];
+    snprintf(buffer, sizeof(buffer), "heap allocation of %zu bytes on tracked frame path:\n", size);
+    OutputDebugStringA(buffer);
+
+    std::lock_guard<std::mutex> lock(sSymbolMutex);
+    auto process = GetCurrentProcess();
+    if (!sSymbolsInitialized) {
+        SymSetOptions(SYMOPT_UNDNAME | SYMOPT_DEFERRED_LOADS | SYMOPT_LOAD_LINES);
+        sSymbolsInitialized = SymInitialize(process, nullptr, TRUE) != FALSE;
+    }
+
+    alignas(SYMBOL_INFO) char symbolStorage[sizeof(SYMBOL_INFO) + MAX_SYM_NAME];
+    auto* pSymbol = reinterpret_cast<SYMBOL_INFO*>(symbolStorage);
+    for (USHORT i = 0; i != numFrames; ++i) {
+        auto address = reinterpret_cast<DWORD64>(frames[i]);
+        pSymbol->SizeOfStruct = sizeof(SYMBOL_INFO);
+        pSymbol->MaxNameLen = MAX_SYM_NAME;
+        DWORD64 displacement = 0;
+        if (sSymbolsInitialized && SymFromAddr(process, address, &displacement, pSymbol)) {
+            IMAGEHLP_LINE64 line{};
+            line.SizeOfStruct = sizeof(line);
+            DWORD lineDisplacement = 0;
+            if (SymGetLineFromAddr64(process, address, &lineDisplacement, &line)) {
+                snprintf(buffer, sizeof(buffer), "    %s(%lu): %s\n", line.FileName, line.LineNumber, pSymbol->Name);
+            } else {
+                snprintf(buffer, sizeof(buffer), "    %s+0x%llx\n", pSymbol->Name, displacement);
+            }
+        } else {
+            snprintf(buffer, sizeof(buffer), "    0x%llx\n", address);
+        }
+        OutputDebugStringA(buffer);
+    }
+}
+
+}
+
+void AllocationTracker::onAllocate(size_t size) noexcept {
+    if (!tTracking || tReporting) {
+        return;
+    }
+    ++tCount;
+    tReporting = true;
+    reportAllocation(size);
+    tReporting = false;
+    if (tAsserting) {
+        __debugbreak();
+    }
+}
+
+bool AllocationTracker::tracking() noexcept {
+    return tTracking;
+}
+
+void AllocationTracker::begin(bool asserting) noexcept {
+    tTracking = true;
+    tAsserting = asserting;
+    tCount = 0;
+}
+
+uint64_t AllocationTracker::end() noexcept {
+    tTracking = false;
+    tAsserting = false;
+    return tCount;
+}
+
+AllocationTrackingScope::AllocationTrackingScope(bool enabled, bool asserting) noexcept {
+    if (!enabled) {
+        return;
+    }
+    // other threads may still hold the counting resource after the scope, so it is never destroyed
+    static CountingMemoryResource sCounting(std::pmr::get_default_resource());
+    mPreviousDefault = std::pmr::set_default_resource(&sCounting);
+    AllocationTracker::begin(asserting);
+}
+
+AllocationTrackingScope::~AllocationTrackingScope() noexcept {
+    if (!mPreviousDefault) {
+        return;
+    }
+    auto count = AllocationTracker::end();
+    std::pmr::set_default_resource(mPreviousDefault);
+    if (count) {
+        char buffer[128];
+        snprintf(buffer, sizeof(buffer), "%llu heap allocations on tracked frame path\n", count);
+        OutputDebugStringA(buffer);
+    }
+}
+
+}
@@ -0,0 +1,68 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <Star/Core/SConfig.h>
+
+namespace Star::Core {
+
+// counts heap allocations of tracked threads, replaced operator new of each module calls onAllocate
+class AllocationTracker {
+public:
+    // reports the allocation and its call stack if the calling thread is tracked
+    STAR_CORE_API static void onAllocate(size_t size) noexcept;
+    STAR_CORE_API static bool tracking() noexcept;
+
+    // allocations of the calling thread are counted until end, breaks on each one if asserting
+    STAR_CORE_API static void begin(bool asserting) noexcept;
+    // returns the allocations counted since begin
+    STAR_CORE_API static uint64_t end() noexcept;
+};
+
+// forwards to upstream and counts allocations of tracked threads
+class CountingMemoryResource : public std::pmr::memory_resource {
+public:
+    explicit CountingMemoryResource(std::pmr::memory_resource* upstream) noexcept
+        : mUpstream(upstream)
+    {}
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        AllocationTracker::onAllocate(bytes);
+        return mUpstream->allocate(bytes, alignment);
+    }
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        mUpstream->deallocate(p, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& rhs) const noexcept override {
+        return this == &rhs;
+    }
+
+    std::pmr::memory_resource* mUpstream = nullptr;
+};
+
+// tracks the calling thread and routes the default memory resource through a counting one
+class AllocationTrackingScope {
+public:
+    STAR_CORE_API AllocationTrackingScope(bool enabled, bool asserting) noexcept;
+    AllocationTrackingScope(const AllocationTrackingScope&) = delete;
+    AllocationTrackingScope& operator=(const AllocationTrackingScope&) = delete;
+    STAR_CORE_API ~AllocationTrackingScope() noexcept;
+private:
+    std::pmr::memory_resource* mPreviousDefault = nullptr;
+};
+
+}
@@ -49,6 +49,20 @@ inline bool operator!=(const ResourceType& lhs, const ResourceType& rhs) noexcep
     return !(lhs == rhs);
 }
 
+struct ResidencySize {
+    uint64_t mCpuBytes = 0;
+    uint64_t mGpuBytes = 0;
+};
+
+// queued loads are sent to producers from the highest priority bucket down
+enum LoadPriority : uint8_t {
+    LowPriority = 0,
+    NormalPriority = 1,
+    HighPriority = 2,
+    CriticalPriority = 3,
+    LoadPriorityCount = 4,
+};
+
 } // namespace Core
 
 } // namespace Star
@@ -0,0 +1,117 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "SCounters.h"
+#include <mutex>
+
+namespace Star::Core {
+
+namespace {
+
+struct CounterThreadSlots {
+    std::array<std::atomic<uint64_t>, size_t(Counter::Count)> mValues{};
+};
+
+struct CounterRegistry {
+    CounterThreadSlots* add() {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mSlots.emplace_back(std::make_unique<CounterThreadSlots>()).get();
+    }
+
+    std::mutex mMutex;
+    // slots outlive their threads, so counts of exited threads are still summed
+    std::vector<std::unique_ptr<CounterThreadSlots>> mSlots;
+    std::array<uint64_t, size_t(Counter::Count)> mTotals{};
+    std::array<std::atomic<uint64_t>, size_t(Gauge::Count)> mGauges{};
+    FrameCounters mLastFrame;
+};
+
+CounterRegistry& registry() {
+    static CounterRegistry sRegistry;
+    return sRegistry;
+}
+
+CounterThreadSlots& threadSlots() {
+    thread_local CounterThreadSlots* tSlots = registry().add();
+    return *tSlots;
+}
+
+}
+
+void Counters::add(Counter counter, uint64_t value) noexcept {
+    auto& slot = threadSlots().mValues[size_t(counter)];
+    slot.store(slot.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+void Counters::set(Gauge gauge, uint64_t value) noexcept {
+    registry().mGauges[size_t(gauge)].store(value, std::memory_order_relaxed);
+}
+
+void Counters::endFrame() noexcept {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mMutex);
+
+    std::array<uint64_t, size_t(Counter::Count)> totals{};
+    for (const auto& pSlots : reg.mSlots) {
+        for (size_t i = 0; i != totals.size(); ++i) {
+            totals[i] += pSlots->mValues[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    auto& frame = reg.mLastFrame;
+    ++frame.mFrame;
+    for (size_t i = 0; i != totals.size(); ++i) {
+        frame.mCounters[i] = totals[i] - reg.mTotals[i];
+    }
+    for (size_t i = 0; i != frame.mGauges.size(); ++i) {
+        frame.mGauges[i] = reg.mGauges[i].load(std::memory_order_relaxed);
+    }
+    reg.mTotals = totals;
+}
+
+FrameCounters Counters::lastFrame() noexcept {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mMutex);
+    return reg.mLastFrame;
+}
+
+const char* Counters::name(Counter counter) noexcept {
+    switch (counter) {
+    case Counter::DrawCalls: return "draw calls";
+    case Counter::Instances: return "instances";
+    case Counter::Triangles: return "triangles";
+    case Counter::PipelineSwitches: return "pso switches";
+    case Counter::RootSignatureSwitches: return "root signature switches";
+    case Counter::DescriptorAllocations: return "descriptor allocations";
+    case Counter::UploadBytes: return "upload bytes";
+    case Counter::Barriers: return "barriers";
+    case Counter::FenceWaitMicroseconds: return "fence wait us";
+    default: return "unknown";
+    }
+}
+
+const char* Counters::name(Gauge gauge) noexcept {
+    switch (gauge) {
+    case Gauge::ResourcesLoading: return "resources loading";
+    case Gauge::BytesResident: return "bytes resident";
+    case Gauge::ShaderDescriptorCapacity: return "shader descriptor capacity";
+    case Gauge::ShaderDescriptorsFree: return "shader descriptors free";
+    default: return "unknown";
+    }
+}
+
+}
@@ -0,0 +1,75 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <Star/Core/SConfig.h>
+#include <array>
+
+namespace Star::Core {
+
+// summed over threads and reset every frame
+enum class Counter : uint32_t {
+    DrawCalls,
+    Instances,
+    Triangles,
+    PipelineSwitches,
+    RootSignatureSwitches,
+    DescriptorAllocations,
+    UploadBytes,
+    Barriers,
+    FenceWaitMicroseconds,
+    Count,
+};
+
+// last value set, kept across frames
+enum class Gauge : uint32_t {
+    ResourcesLoading,
+    BytesResident,
+    // shader visible descriptor heap, free descriptors are the headroom before it grows
+    ShaderDescriptorCapacity,
+    ShaderDescriptorsFree,
+    Count,
+};
+
+struct FrameCounters {
+    uint64_t mFrame = 0;
+    std::array<uint64_t, size_t(Counter::Count)> mCounters{};
+    std::array<uint64_t, size_t(Gauge::Count)> mGauges{};
+
+    uint64_t operator[](Counter counter) const noexcept {
+        return mCounters[size_t(counter)];
+    }
+    uint64_t operator[](Gauge gauge) const noexcept {
+        return mGauges[size_t(gauge)];
+    }
+};
+
+class Counters {
+public:
+    // only the calling thread writes its slots, increments never contend
+    STAR_CORE_API static void add(Counter counter, uint64_t value) noexcept;
+    STAR_CORE_API static void set(Gauge gauge, uint64_t value) noexcept;
+
+    // closes the frame, counters added since the previous endFrame become lastFrame
+    STAR_CORE_API static void endFrame() noexcept;
+    STAR_CORE_API static FrameCounters lastFrame() noexcept;
+
+    STAR_CORE_API static const char* name(Counter counter) noexcept;
+    STAR_CORE_API static const char* name(Gauge gauge) noexcept;
+};
+
+}
@@ -28,9 +28,10 @@ void FetchBase::Deleter::operator()(const Resource* ptr) const noexcept {
 
 FetchBase::FetchBase() noexcept = default;
 
-FetchBase::FetchBase(const MetaID& id, const ResourceType& tag, bool async) noexcept
+FetchBase::FetchBase(const MetaID& id, const ResourceType& tag, bool async, LoadPriority priority) noexcept
     : mResource(Manager::instance().get(id, tag))
 {
+    mResource->raisePriority(priority);
     if (async) {
         mResource->async_acquire();
     } else {
@@ -66,8 +67,9 @@ void FetchBase::resetResource() noexcept {
     mResource.reset();
 }
 
-void FetchBase::resetResource(const MetaID& id, const ResourceType& tag, bool async) noexcept {
+void FetchBase::resetResource(const MetaID& id, const ResourceType& tag, bool async, LoadPriority priority) noexcept {
     mResource.reset(Manager::instance().get(id, tag));
+    mResource->raisePriority(priority);
     if (async) {
         mResource->async_acquire();
     } else {
@@ -80,9 +82,101 @@ const void* FetchBase::get() const noexcept {
     return mResource->mPointer;
 }
 
+void FetchBase::setPriority(LoadPriority priority) const noexcept {
+    Expects(mResource);
+    mResource->setPriority(priority);
+}
+
+void FetchBase::notify(std::function<void()> callback) const {
+    Expects(mResource);
+    Manager::instance().postNotify(*mResource, std::move(callback));
+}
+
 bool FetchBase::loading() const noexcept {
     Expects(mResource);
     return !mResource->mPointer;
 }
 
+FetchGroupBase::FetchGroupBase() noexcept = default;
+FetchGroupBase::FetchGroupBase(FetchGroupBase&& rhs) noexcept = default;
+FetchGroupBase& FetchGroupBase::operator=(FetchGroupBase&& rhs) noexcept = default;
+FetchGroupBase::~FetchGroupBase() noexcept = default;
+
+size_t FetchGroupBase::loadingCount() const noexcept {
+    return std::count_if(mResources.begin(), mResources.end(), [](const auto& resource) {
+        return !resource->mPointer;
+    });
+}
+
+const MetaID& FetchGroupBase::metaID(size_t i) const noexcept {
+    Expects(i < mResources.size());
+    return mResources[i]->metaID();
+}
+
+void FetchGroupBase::setPriority(LoadPriority priority) const noexcept {
+    for (const auto& resource : mResources) {
+        resource->setPriority(priority);
+    }
+}
+
+void FetchGroupBase::notify(std::function<void()> callback) const {
+    auto resources = std::make_unique<std::vector<Resource*>>();
+    resources->reserve(mResources.size());
+    for (const auto& resource : mResources) {
+        resources->emplace_back(const_cast<Resource*>(resource.get()));
+    }
+    Manager::instance().postNotify(std::move(resources), std::move(callback));
+}
+
+void FetchGroupBase::resetResources() noexcept {
+    mResources.clear();
+}
+
+void FetchGroupBase::resetResources(gsl::span<const MetaID> ids, const ResourceType& tag,
+    LoadPriority priority
+) {
+    auto& manager = Manager::instance();
+    std::vector<const Resource*> resources;
+    resources.reserve(ids.size());
+    for (const auto& id : ids) {
+        resources.emplace_back(manager.get(id, tag));
+    }
+    acquire(resources, priority);
+}
+
+void FetchGroupBase::resetResources(gsl::span<const std::pair<MetaID, ResourceType>> ids,
+    LoadPriority priority
+) {
+    auto& manager = Manager::instance();
+    std::vector<const Resource*> resources;
+    resources.reserve(ids.size());
+    for (const auto& [id, tag] : ids) {
+        resources.emplace_back(manager.get(id, tag));
+    }
+    acquire(resources, priority);
+}
+
+void FetchGroupBase::acquire(const std::vector<const Resource*>& resources, LoadPriority priority) {
+    std::vector<std::unique_ptr<const Resource, FetchBase::Deleter>> acquired;
+    acquired.reserve(resources.size());
+    auto started = std::make_unique<std::vector<Resource*>>();
+    for (auto pResource : resources) {
+        pResource->raisePriority(priority);
+        if (atomicAddRef(pResource->mRefCount)) {
+            started->emplace_back(const_cast<Resource*>(pResource));
+        }
+        acquired.emplace_back(pResource);
+    }
+    if (!started->empty()) {
+        Manager::instance().postLoad(std::move(started));
+    }
+    // previous resources are released after the new ones are acquired, shared ones stay loaded
+    mResources = std::move(acquired);
+}
+
+const void* FetchGroupBase::get(size_t i) const noexcept {
+    Expects(i < mResources.size());
+    return mResources[i]->mPointer;
+}
+
 }
@@ -17,6 +17,8 @@
 
 #pragma once
 #include <Star/Core/SCoreTypes.h>
+#include <boost/asio/post.hpp>
+#include <functional>
 
 namespace Star::Core {
 
@@ -29,7 +31,8 @@ public:
     };
 
     FetchBase() noexcept;
-    FetchBase(const MetaID& id, const ResourceType& tag, bool async) noexcept;
+    FetchBase(const MetaID& id, const ResourceType& tag, bool async,
+        LoadPriority priority = NormalPriority) noexcept;
     FetchBase(FetchBase&& rhs) noexcept;
     FetchBase& operator=(FetchBase&& rhs) noexcept;
     FetchBase(const FetchBase& rhs) noexcept;
@@ -42,9 +45,13 @@ public:
 
     bool loading() const noexcept;
     const MetaID& metaID() const noexcept;
+    void setPriority(LoadPriority priority) const noexcept;
+    // callback runs on the manager thread once the resource is loaded
+    void notify(std::function<void()> callback) const;
 protected:
     void resetResource() noexcept;
-    void resetResource(const MetaID& id, const ResourceType& tag, bool async) noexcept;
+    void resetResource(const MetaID& id, const ResourceType& tag, bool async,
+        LoadPriority priority = NormalPriority) noexcept;
     const void* get() const noexcept;
 #pragma warning(push)
 #pragma warning(disable: 4251)
@@ -56,8 +63,8 @@ template<class T>
 class Fetch : public FetchBase {
 public:
     Fetch() noexcept = default;
-    Fetch(const MetaID& id, bool async = true) noexcept
-        : FetchBase(id, getTag((const T*)nullptr), async)
+    Fetch(const MetaID& id, bool async = true, LoadPriority priority = NormalPriority) noexcept
+        : FetchBase(id, getTag((const T*)nullptr), async, priority)
     {}
 
     Fetch(Fetch&& rhs) = default;
@@ -75,8 +82,8 @@ public:
         resetResource();
     }
 
-    void reset(const MetaID& id, bool async = true) noexcept {
-        resetResource(id, getTag((const T*)nullptr), async);
+    void reset(const MetaID& id, bool async = true, LoadPriority priority = NormalPriority) noexcept {
+        resetResource(id, getTag((const T*)nullptr), async, priority);
         mCached = static_cast<const T*>(get());
     }
 
@@ -100,4 +107,98 @@ private:
     const T* mCached = nullptr;
 };
 
+// resources acquired together, e.g. the dependencies of a content
+// registry lookups are wait-free, the resources that start loading are posted as one command,
+// notify posts one callback for the whole group
+class STAR_CORE_API FetchGroupBase {
+public:
+    FetchGroupBase() noexcept;
+    FetchGroupBase(FetchGroupBase&& rhs) noexcept;
+    FetchGroupBase& operator=(FetchGroupBase&& rhs) noexcept;
+    FetchGroupBase(const FetchGroupBase&) = delete;
+    FetchGroupBase& operator=(const FetchGroupBase&) = delete;
+    ~FetchGroupBase() noexcept;
+
+    size_t size() const noexcept {
+        return mResources.size();
+    }
+    bool empty() const noexcept {
+        return mResources.empty();
+    }
+
+    // resources not loaded yet
+    size_t loadingCount() const noexcept;
+    const MetaID& metaID(size_t i) const noexcept;
+    void setPriority(LoadPriority priority) const noexcept;
+    // callback runs once on the manager thread when every resource is loaded
+    void notify(std::function<void()> callback) const;
+protected:
+    friend class Manager;
+    void resetResources() noexcept;
+    void resetResources(gsl::span<const MetaID> ids, const ResourceType& tag,
+        LoadPriority priority = NormalPriority);
+    void resetResources(gsl::span<const std::pair<MetaID, ResourceType>> ids,
+        LoadPriority priority = NormalPriority);
+    const void* get(size_t i) const noexcept;
+    void acquire(const std::vector<const Resource*>& resources, LoadPriority priority);
+#pragma warning(push)
+#pragma warning(disable: 4251)
+    std::vector<std::unique_ptr<const Resource, FetchBase::Deleter>> mResources;
+#pragma warning(pop)
+};
+
+// dense handles of ids, try_get(i) is the resource of ids[i]
+template<class T>
+class FetchGroup : public FetchGroupBase {
+public:
+    FetchGroup() noexcept = default;
+    explicit FetchGroup(gsl::span<const MetaID> ids, LoadPriority priority = NormalPriority) {
+        reset(ids, priority);
+    }
+
+    FetchGroup(FetchGroup&& rhs) = default;
+    FetchGroup& operator=(FetchGroup&& rhs) = default;
+
+    void reset() noexcept {
+        mCached.clear();
+        resetResources();
+    }
+
+    void reset(gsl::span<const MetaID> ids, LoadPriority priority = NormalPriority) {
+        resetResources(ids, getTag((const T*)nullptr), priority);
+        mCached.assign(ids.size(), nullptr);
+    }
+
+    const T* try_get(size_t i) noexcept {
+        Expects(i < mCached.size());
+        if (!mCached[i]) {
+            mCached[i] = static_cast<const T*>(get(i));
+        }
+        return mCached[i];
+    }
+
+    const T* cache(size_t i) const noexcept {
+        Expects(i < mCached.size());
+        return mCached[i];
+    }
+private:
+    std::vector<const T*> mCached;
+};
+
+// continuation front-end, handler(Fetch<T>) is posted to the executor
+// (task or render strand) once the resource is loaded, so creation
+// chains can be written without polling try_get() every frame
+template<class T, class Executor, class Handler>
+void fetchAsync(const MetaID& id, const Executor& executor, Handler&& handler,
+    LoadPriority priority = NormalPriority
+) {
+    Fetch<T> fetch(id, true, priority);
+    fetch.notify([fetch, executor, handler = std::forward<Handler>(handler)]() mutable {
+        boost::asio::post(executor, [fetch = std::move(fetch), handler = std::move(handler)]() mutable {
+            fetch.try_get();
+            handler(std::move(fetch));
+        });
+    });
+}
+
 }
@@ -24,6 +24,27 @@ void Workflow::init(size_t resourceCount, size_t taskCount) {
     Manager::sInstance.reset(new Manager(resourceCount, taskCount));
 }
 
+void Workflow::setResidencyBudget(const ResourceType& tag, uint64_t cpuBytes, uint64_t gpuBytes) {
+    Expects(Manager::sInstance);
+    Manager::sInstance->setResidencyBudget(tag, ResidencySize{ cpuBytes, gpuBytes });
+}
+
+void Workflow::reportVideoMemory(uint64_t budget, uint64_t usage) noexcept {
+    if (Manager::sInstance) {
+        Manager::sInstance->reportVideoMemory(budget, usage);
+    }
+}
+
+void Workflow::setConcurrency(const ResourceType& tag, int32_t count) {
+    Expects(Manager::sInstance);
+    Manager::sInstance->setConcurrency(tag, count);
+}
+
+bool Workflow::reload(const MetaID& metaID, const ResourceType& tag) {
+    Expects(Manager::sInstance);
+    return Manager::sInstance->reload(metaID, tag);
+}
+
 STAR_CORE_API void Workflow::stop() noexcept {
     Expects(Manager::sInstance);
     Manager::sInstance->stop();
@@ -17,12 +17,23 @@
 
 #pragma once
 #include <Star/Core/SConfig.h>
+#include <Star/Core/SCoreFwd.h>
+#include <Star/SMetaID.h>
 
 namespace Star::Core {
 
 class Workflow {
 public:
     STAR_CORE_API static void init(size_t resourceCount, size_t taskCount);
+    // unreferenced resources stay loaded until their type exceeds the budget
+    STAR_CORE_API static void setResidencyBudget(const ResourceType& tag, uint64_t cpuBytes, uint64_t gpuBytes);
+    // thread safe, evicts cached resources when usage exceeds budget
+    STAR_CORE_API static void reportVideoMemory(uint64_t budget, uint64_t usage) noexcept;
+    // max async loads in flight per resource type
+    STAR_CORE_API static void setConcurrency(const ResourceType& tag, int32_t count);
+    // the asset was rebuilt, a loaded resource is read again at once if referenced, else by the next fetch
+    // holders must not keep pointers to its data, returns false if it was not loaded
+    STAR_CORE_API static bool reload(const MetaID& metaID, const ResourceType& tag);
     STAR_CORE_API static void stop() noexcept;
     STAR_CORE_API static void terminate() noexcept;
     STAR_CORE_API static void processEvents();
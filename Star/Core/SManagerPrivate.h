@@ -18,7 +18,12 @@
 #pragma once
 #include <Star/SLockFree.h>
 #include <Star/Core/SResource.h>
+#include <Star/Core/SResourceRegistry.h>
+#include <Star/Core/SResidency.h>
+#include <Star/Core/SFetch.h>
 #include <Star/Core/SProducer.h>
+#include <Star/Core/SProfiler.h>
+#include <Star/Core/SCounters.h>
 
 namespace Star::Core {
 
@@ -37,9 +42,22 @@ class Manager {
         Resource* mResource = nullptr;
         void* mPointer = nullptr;
     };
+    struct NotifyResource {
+        Resource* mResource = nullptr;
+        std::function<void()>* mCallback = nullptr;
+    };
+    // resources of a fetch group, one command for the whole group
+    struct LoadResources {
+        std::vector<Resource*>* mResources = nullptr;
+    };
+    struct NotifyResources {
+        std::vector<Resource*>* mResources = nullptr;
+        std::function<void()>* mCallback = nullptr;
+    };
 
     using Command = std::variant<
-        LoadResource, UnloadResource, ResourceCreated
+        LoadResource, UnloadResource, ResourceCreated, NotifyResource,
+        LoadResources, NotifyResources
     >;
 public:
     static Manager& instance() noexcept;
@@ -47,17 +65,30 @@ public:
     Manager(size_t resourceCount, size_t taskCount)
         : mThreadID(std::this_thread::get_id())
         , mProducers(std::variant_size_v<ResourceType>)
-        , mCommands(taskCount * 4)
+        , mCommands(std::max(resourceCount, taskCount * 4))
+        , mResources(resourceCount)
+        , mTagJobCounts(std::variant_size_v<ResourceType>, 0)
+        , mTagJobLimits(std::variant_size_v<ResourceType>, std::numeric_limits<int32_t>::max())
+        , mTagWorkloads(std::variant_size_v<ResourceType>, CpuWorkload)
     {
-        mResources.reserve(resourceCount * 2);
-        mQueueCurr.reserve(taskCount);
-        mQueueNext.reserve(taskCount);
+        mWorkloadJobLimits.fill(std::numeric_limits<int32_t>::max());
+        for (auto& queue : mQueueCurr) {
+            queue.reserve(taskCount);
+        }
+        for (auto& queue : mQueueNext) {
+            queue.reserve(taskCount);
+        }
         mQueueCreated.reserve(taskCount);
     }
 
     void stop() noexcept {
         Expects(std::this_thread::get_id() == mThreadID);
         mStopped = true;
+        mResidency.evictAll([this](Resource& resource) {
+            evict(resource);
+        });
+        mPrefetches.clear();
+        mWaiters.clear();
     }
 
     void registerProducer(const ResourceType& tag, Producer* producer) {
@@ -66,20 +97,47 @@ public:
         Expects(tag.index() < mProducers.size());
         Expects(!mProducers[tag.index()]);
         mProducers[tag.index()] = producer;
+        // producers sharing a workload share its limit, the tightest one holds
+        auto workload = producer->getWorkload(tag);
+        Expects(workload < ProducerWorkloadCount);
+        mTagWorkloads[tag.index()] = workload;
+        mWorkloadJobLimits[workload] = std::min(mWorkloadJobLimits[workload], producer->getConcurrency(workload));
+    }
+
+    void setResidencyBudget(const ResourceType& tag, const ResidencySize& budget) {
+        Expects(std::this_thread::get_id() == mThreadID);
+        mResidency.setBudget(tag, budget);
+        evictOverBudget();
+    }
+
+    void reportVideoMemory(uint64_t budget, uint64_t usage) noexcept {
+        mVideoMemoryBudget.store(budget, std::memory_order_relaxed);
+        mVideoMemoryUsage.store(usage, std::memory_order_relaxed);
+    }
+
+    void setConcurrency(const ResourceType& tag, int32_t count) {
+        Expects(std::this_thread::get_id() == mThreadID);
+        Expects(tag.index() < mTagJobLimits.size());
+        Expects(count > 0);
+        mTagJobLimits[tag.index()] = count;
     }
 
     const Resource* get(const MetaID& metaID, const ResourceType& tag) const noexcept {
-        const std::lock_guard<std::mutex> lock(mResourceMutex);
-        auto iter = mResources.find(metaID);
-        if (iter == mResources.end()) {
-            bool succeeded;
-            std::tie(iter, succeeded) = mResources.emplace(metaID, tag);
-            Ensures(succeeded);
-        } else {
-            Expects(iter->mTag == tag);
-        }
+        return mResources.get(metaID, tag);
+    }
 
-        return &*iter;
+    // references survive, e.g. dependency prefetches, unreferenced resources are read by the next fetch
+    bool reload(const MetaID& metaID, const ResourceType& tag) noexcept {
+        Expects(std::this_thread::get_id() == mThreadID);
+        auto pResource = const_cast<Resource*>(mResources.get(metaID, tag));
+        if (!pResource || !isLoaded(*pResource))
+            return false;
+        mResidency.remove(*pResource);
+        pResource->unload(false);
+        if (!pResource->unused()) {
+            loadNow(*pResource);
+        }
+        return true;
     }
 
     // functions
@@ -91,7 +149,7 @@ public:
 
     void async_created(const Resource& resource, void* pointer) const noexcept {
         Expects(!mStopped);
-        mCommands.push(ResourceCreated{ const_cast<Resource*>(&resource), pointer });
+        push(ResourceCreated{ const_cast<Resource*>(&resource), pointer });
     }
 private:
     inline Producer* getProducer(const ResourceType& tag) const noexcept {
@@ -105,17 +163,26 @@ private:
     bool try_send(Resource& resource, bool async) noexcept {
         Expects(std::this_thread::get_id() == mThreadID);
         auto pProducer = getProducer(resource.mTag);
+        auto& tagJobCount = mTagJobCounts[resource.mTag.index()];
+        const auto workload = mTagWorkloads[resource.mTag.index()];
+        auto& workloadJobCount = mWorkloadJobCounts[workload];
         bool succeeded;
         if (async) { // if async
-            succeeded = pProducer->load(resource, async);
+            succeeded = tagJobCount < mTagJobLimits[resource.mTag.index()]
+                && workloadJobCount < mWorkloadJobLimits[workload]
+                && pProducer->load(resource, async);
             if (succeeded) { // succeeded
                 ++mJobCount;
-            } else { // producer too busy, delayed to next frame
-                mQueueNext.emplace(&resource);
+                ++tagJobCount;
+                ++workloadJobCount;
+            } else { // producer or workload too busy, delayed to next frame
+                mQueueNext[resource.priority()].emplace(&resource);
             }
         } else {
             auto prevCount = mJobCount;
             ++mJobCount;
+            ++tagJobCount;
+            ++workloadJobCount;
             succeeded = pProducer->load(resource, async);
             Ensures(succeeded);
         }
@@ -125,19 +192,26 @@ private:
     void enqueue(Resource& resource, bool async) {
         Expects(std::this_thread::get_id() == mThreadID);
         if (async) {
-            mQueueCurr.emplace(&resource);
+            mQueueCurr[resource.priority()].emplace(&resource);
+            prefetch(resource);
         }
     }
 
     void dequeue(Resource& resource, bool async) noexcept {
         Expects(std::this_thread::get_id() == mThreadID);
         if (async) {
-            mQueueCurr.erase(&resource);
+            // priority might have changed since queued
+            for (auto& queue : mQueueCurr) {
+                queue.erase(&resource);
+            }
+            mPrefetches.erase(&resource);
         }
     }
 
     void finishLoadingSucceeded(Resource& resource) {
         --mJobCount;
+        --mTagJobCounts[resource.mTag.index()];
+        --mWorkloadJobCounts[mTagWorkloads[resource.mTag.index()]];
         auto pProducer = getProducer(resource.mTag);
         Expects(pProducer);
         pProducer->created(resource);
@@ -145,12 +219,16 @@ private:
 
     void finishLoadingFailed(Resource& resource) noexcept {
         --mJobCount;
+        --mTagJobCounts[resource.mTag.index()];
+        --mWorkloadJobCounts[mTagWorkloads[resource.mTag.index()]];
+        mPrefetches.erase(&resource);
         auto pProducer = getProducer(resource.mTag);
         Expects(pProducer);
         pProducer->destroy(resource);
     }
 
     void destroy(Resource& resource) const noexcept {
+        mPrefetches.erase(&resource);
         auto pProducer = getProducer(resource.mTag);
         Expects(pProducer);
         pProducer->destroy(resource);
@@ -158,19 +236,23 @@ private:
 
     void loadNow(Resource& resource) noexcept {
         Expects(std::this_thread::get_id() == mThreadID);
-        Expects(Resource::nr_regions::value == 1);
+        if (isLoaded(resource)) {
+            // still resident, released but not evicted yet
+            mResidency.remove(resource);
+            return;
+        }
         auto prevCount = mJobCount;
 
         resource.load(false);
-        Ensures(resource.current_state()[0] == 1); // Ensures queued
+        Ensures(resource.state() == Queued);
 
         Expects(!mSyncCreated);
         resource.start(false);
-        Ensures(resource.current_state()[0] == 2); // Ensures loading
+        Ensures(resource.state() == Loading);
         Ensures(mSyncCreated);
 
         mSyncCreated->mResource->created(mSyncCreated->mPointer);
-        Ensures(resource.current_state()[0] == 4); // Ensures loaded
+        Ensures(resource.state() == Loaded);
         Ensures(prevCount == mJobCount);
         mSyncCreated.reset();
         Ensures(!mSyncCreated);
@@ -178,7 +260,23 @@ private:
 
     void postLoad(Resource& resource) noexcept {
         Expects(!mStopped);
-        mCommands.push(LoadResource{ &resource });
+        push(LoadResource{ &resource });
+    }
+
+    void postLoad(std::unique_ptr<std::vector<Resource*>> resources) noexcept {
+        Expects(!mStopped);
+        push(LoadResources{ resources.release() });
+    }
+
+    void postNotify(const Resource& resource, std::function<void()> callback) const {
+        Expects(!mStopped);
+        push(NotifyResource{ const_cast<Resource*>(&resource),
+            new std::function<void()>(std::move(callback)) });
+    }
+
+    void postNotify(std::unique_ptr<std::vector<Resource*>> resources, std::function<void()> callback) const {
+        Expects(!mStopped);
+        push(NotifyResources{ resources.release(), new std::function<void()>(std::move(callback)) });
     }
 
     void postUnload(Resource& resource) const noexcept {
@@ -186,7 +284,15 @@ private:
             Expects(std::this_thread::get_id() == mThreadID);
             resource.unload(false);
         } else {
-            mCommands.push(UnloadResource{ &resource });
+            push(UnloadResource{ &resource });
+        }
+    }
+
+    // bounded, producers wait for processEvents when full
+    void push(const Command& command) const noexcept {
+        while (!mCommands.push(command)) {
+            Expects(std::this_thread::get_id() != mThreadID);
+            std::this_thread::yield();
         }
     }
 
@@ -202,49 +308,189 @@ private:
         Expects(std::this_thread::get_id() == mThreadID);
         visit(overload(
             [this](const LoadResource& c) {
-                c.mResource->load(true);
+                handleLoad(*c.mResource);
             },
             [this](const UnloadResource& c) {
-                c.mResource->unload(true);
+                auto& resource = *c.mResource;
+                if (isLoaded(resource) && mResidency.enabled(resource.mTag)) {
+                    if (!resource.unused()) {
+                        // reacquired before the command arrived
+                        return;
+                    }
+                    mResidency.add(resource, getProducer(resource.mTag)->getResidencySize(resource));
+                    evictOverBudget();
+                    return;
+                }
+                resource.unload(true);
             },
             [this](const ResourceCreated& c) {
                 mQueueCreated.emplace_back(c);
+            },
+            [this](const NotifyResource& c) {
+                std::unique_ptr<std::function<void()>> callback(c.mCallback);
+                if (isLoaded(*c.mResource)) {
+                    (*callback)();
+                    return;
+                }
+                mWaiters[c.mResource].emplace_back(std::move(callback));
+            },
+            [this](const LoadResources& c) {
+                std::unique_ptr<std::vector<Resource*>> resources(c.mResources);
+                for (auto* pResource : *resources) {
+                    handleLoad(*pResource);
+                }
+            },
+            [this](const NotifyResources& c) {
+                std::unique_ptr<std::vector<Resource*>> resources(c.mResources);
+                std::shared_ptr<std::function<void()>> callback(c.mCallback);
+                auto remaining = std::make_shared<size_t>(std::count_if(resources->begin(), resources->end(),
+                    [](const Resource* pResource) { return !isLoaded(*pResource); }));
+                if (*remaining == 0) {
+                    (*callback)();
+                    return;
+                }
+                // every waiter holds the group callback, the last loaded resource runs it
+                for (auto* pResource : *resources) {
+                    if (isLoaded(*pResource))
+                        continue;
+                    mWaiters[pResource].emplace_back(std::make_unique<std::function<void()>>(
+                        [callback, remaining]() {
+                            if (--*remaining == 0) {
+                                (*callback)();
+                            }
+                        }));
+                }
             }
         ), v);
     }
 
+    void handleLoad(Resource& resource) {
+        if (isLoaded(resource)) {
+            // reacquired before eviction
+            mResidency.remove(resource);
+            return;
+        }
+        resource.load(true);
+    }
+
     void loadResources() {
         Expects(std::this_thread::get_id() == mThreadID);
-        for (auto& pResource : mQueueCurr) {
-            pResource->start(true);
+        STAR_PROFILE_SCOPE("Manager::loadResources");
+        // move resources whose priority hint changed to their bucket
+        for (size_t p = 0; p != LoadPriorityCount; ++p) {
+            auto& queue = mQueueCurr[p];
+            for (auto iter = queue.begin(); iter != queue.end();) {
+                auto priority = (*iter)->priority();
+                if (priority != p) {
+                    mQueueCurr[priority].emplace(*iter);
+                    iter = queue.erase(iter);
+                } else {
+                    ++iter;
+                }
+            }
+        }
+        // feed producers highest priority first
+        for (size_t p = LoadPriorityCount; p-- > 0;) {
+            for (auto& pResource : mQueueCurr[p]) {
+                pResource->start(true);
+            }
+            mQueueCurr[p].clear();
         }
-        mQueueCurr.clear();
         std::swap(mQueueCurr, mQueueNext);
     }
 
     void updateResources() {
         Expects(std::this_thread::get_id() == mThreadID);
         for (const auto& c : mQueueCreated) {
-            mSyncCreated->mResource->created(mSyncCreated->mPointer);
+            c.mResource->created(c.mPointer);
+            notifyLoaded(*c.mResource);
         }
         mQueueCreated.clear();
+
+        // memory pressure, reported by the render engine
+        auto budget = mVideoMemoryBudget.load(std::memory_order_relaxed);
+        auto usage = mVideoMemoryUsage.load(std::memory_order_relaxed);
+        if (budget && usage > budget) {
+            mResidency.evictGpuBytes(usage - budget, [this](Resource& resource) {
+                evict(resource);
+            });
+        }
+
+        Counters::set(Gauge::ResourcesLoading, gsl::narrow_cast<uint64_t>(std::max<int64_t>(mJobCount, 0)));
+        Counters::set(Gauge::BytesResident, usage);
+    }
+
+    // dependencies are fetched in parallel with the resource,
+    // and held until it is unloaded
+    void prefetch(Resource& resource) {
+        mDependencies.clear();
+        getProducer(resource.mTag)->getDependencies(resource, mDependencies);
+        if (mDependencies.empty())
+            return;
+
+        // acquired as one group, thousands of dependencies post one load command
+        mPrefetches[&resource].resetResources(mDependencies, resource.priority());
+    }
+
+    // waiters hold a reference, so the resource cannot be cancelled
+    // before it is loaded
+    void notifyLoaded(Resource& resource) {
+        if (!isLoaded(resource))
+            return;
+        auto iter = mWaiters.find(&resource);
+        if (iter == mWaiters.end())
+            return;
+        auto callbacks = std::move(iter->second);
+        mWaiters.erase(iter);
+        for (auto& callback : callbacks) {
+            (*callback)();
+        }
+    }
+
+    static bool isLoaded(const Resource& resource) noexcept {
+        return resource.state() == Loaded;
+    }
+
+    void evict(Resource& resource) noexcept {
+        Expects(isLoaded(resource));
+        if (resource.unused()) {
+            resource.unload(true);
+        }
+    }
+
+    void evictOverBudget() noexcept {
+        mResidency.evictOverBudget([this](Resource& resource) {
+            evict(resource);
+        });
     }
 
     friend class Workflow;
     friend class ControlBlock;
     friend class Resource;
+    friend class FetchBase;
+    friend class FetchGroupBase;
 
     bool mStopped = false;
     std::thread::id mThreadID = {};
     int64_t mJobCount = 0;
-    mutable MessageQueue<Command> mCommands;
+    mutable RingQueue<Command> mCommands;
     std::vector<Producer*> mProducers;
 
-    mutable std::mutex mResourceMutex;
-    mutable MetaIDHashMap<Resource> mResources;
-
-    boost::container::flat_set<Resource*> mQueueCurr;
-    boost::container::flat_set<Resource*> mQueueNext;
+    ResourceRegistry mResources;
+    std::vector<int32_t> mTagJobCounts;
+    std::vector<int32_t> mTagJobLimits;
+    std::vector<ProducerWorkload> mTagWorkloads;
+    std::array<int32_t, ProducerWorkloadCount> mWorkloadJobCounts = {};
+    std::array<int32_t, ProducerWorkloadCount> mWorkloadJobLimits = {};
+    ResidencyCache mResidency;
+    std::vector<std::pair<MetaID, ResourceType>> mDependencies;
+    mutable std::unordered_map<const Resource*, FetchGroupBase> mPrefetches;
+    std::unordered_map<const Resource*, std::vector<std::unique_ptr<std::function<void()>>>> mWaiters;
+    std::atomic_uint64_t mVideoMemoryBudget = 0;
+    std::atomic_uint64_t mVideoMemoryUsage = 0;
+
+    std::array<boost::container::flat_set<Resource*>, LoadPriorityCount> mQueueCurr;
+    std::array<boost::container::flat_set<Resource*>, LoadPriorityCount> mQueueNext;
     std::vector<ResourceCreated> mQueueCreated;
     std::optional<ResourceCreated> mSyncCreated;
 };
@@ -24,6 +24,15 @@ namespace Star::Core {
 class Manager;
 class Resource;
 
+// what bounds the loads of a resource type, the manager limits every workload on its own
+// so a flood of heavy loads cannot hold back cheap loads of another workload
+enum ProducerWorkload : uint8_t {
+    IOWorkload = 0,
+    CpuWorkload = 1,
+    GpuUploadWorkload = 2,
+    ProducerWorkloadCount = 3,
+};
+
 class STAR_CORE_API Producer {
 public:
     Producer();
@@ -38,6 +47,22 @@ private:
     virtual bool load(const Resource& resource, bool async) = 0;
     virtual void created(const Resource& resource) = 0;
     virtual void destroy(const Resource& resource) noexcept = 0;
+    // resources loaded together with an async request, e.g. from a build-time manifest
+    virtual void getDependencies(const Resource& resource,
+        std::vector<std::pair<MetaID, ResourceType>>& dependencies) {
+    }
+    // memory held by a loaded resource, used by the residency budget
+    virtual ResidencySize getResidencySize(const Resource& resource) const noexcept {
+        return {};
+    }
+    // workload of the loads of tag, read once when tag is registered
+    virtual ProducerWorkload getWorkload(const ResourceType& tag) const noexcept {
+        return CpuWorkload;
+    }
+    // async loads of a workload in flight, more are delayed to the next frame
+    virtual int32_t getConcurrency(ProducerWorkload workload) const noexcept {
+        return std::numeric_limits<int32_t>::max();
+    }
 };
 
 }
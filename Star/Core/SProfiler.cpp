@@ -0,0 +1,204 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "SProfiler.h"
+#include <mutex>
+#include <ostream>
+
+namespace Star::Core {
+
+namespace {
+
+struct ProfileZone {
+    const char* mName;
+    uint64_t mBegin;
+    uint64_t mEnd;
+};
+
+// single producer ring, old zones are overwritten and never block the owner thread
+struct ProfileThreadBuffer {
+    static constexpr uint64_t sCapacity = 1 << 14;
+    static constexpr uint64_t sMask = sCapacity - 1;
+
+    explicit ProfileThreadBuffer(uint32_t threadID) noexcept
+        : mThreadID(threadID)
+    {}
+
+    std::atomic<uint64_t> mHead = 0;
+    uint32_t mThreadID = 0;
+    // guarded by Registry::mMutex
+    uint64_t mCollected = 0;
+    std::string mName;
+    std::array<ProfileZone, sCapacity> mZones;
+};
+
+struct Registry {
+    Registry() noexcept {
+        LARGE_INTEGER counter, frequency;
+        QueryPerformanceCounter(&counter);
+        QueryPerformanceFrequency(&frequency);
+        mOriginTicks = __rdtsc();
+        mOriginCounter = counter.QuadPart;
+        mCounterFrequency = frequency.QuadPart;
+    }
+
+    ProfileThreadBuffer* add() {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto threadID = gsl::narrow_cast<uint32_t>(GetCurrentThreadId());
+        return mBuffers.emplace_back(std::make_unique<ProfileThreadBuffer>(threadID)).get();
+    }
+
+    // rdtsc is invariant but its rate is unknown, measure it against qpc
+    double ticksPerMicrosecond() const noexcept {
+        LARGE_INTEGER counter;
+        QueryPerformanceCounter(&counter);
+        auto ticks = __rdtsc() - mOriginTicks;
+        auto microseconds = double(counter.QuadPart - mOriginCounter) * 1e6 / double(mCounterFrequency);
+        if (microseconds <= 0.0) {
+            return 1.0;
+        }
+        return double(ticks) / microseconds;
+    }
+
+    std::mutex mMutex;
+    // buffers outlive their threads, so zones of exited threads can still be written
+    std::vector<std::unique_ptr<ProfileThreadBuffer>> mBuffers;
+    uint64_t mOriginTicks = 0;
+    int64_t mOriginCounter = 0;
+    int64_t mCounterFrequency = 1;
+};
+
+Registry& registry() {
+    static Registry sRegistry;
+    return sRegistry;
+}
+
+ProfileThreadBuffer& threadBuffer() {
+    thread_local ProfileThreadBuffer* tBuffer = registry().add();
+    return *tBuffer;
+}
+
+// copies zones [from, head), zones the owner may have overwritten during the copy are dropped
+template<class Function>
+uint64_t readZones(const ProfileThreadBuffer& buffer, uint64_t from, Function&& f) {
+    auto head = buffer.mHead.load(std::memory_order_acquire);
+    if (head > ProfileThreadBuffer::sCapacity) {
+        from = std::max(from, head - ProfileThreadBuffer::sCapacity);
+    }
+
+    std::vector<ProfileZone> zones;
+    zones.reserve(head - from);
+    for (auto i = from; i != head; ++i) {
+        zones.emplace_back(buffer.mZones[i & ProfileThreadBuffer::sMask]);
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    auto current = buffer.mHead.load(std::memory_order_relaxed);
+    uint64_t valid = from;
+    if (current > ProfileThreadBuffer::sCapacity) {
+        valid = std::max(valid, current - ProfileThreadBuffer::sCapacity);
+    }
+
+    for (auto i = valid; i < head; ++i) {
+        f(zones[i - from]);
+    }
+    return head;
+}
+
+void writeJsonString(std::ostream& os, std::string_view str) {
+    os << '"';
+    for (auto c : str) {
+        if (c == '"' || c == '\\') {
+            os << '\\' << c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            os << ' ';
+        } else {
+            os << c;
+        }
+    }
+    os << '"';
+}
+
+}
+
+void Profiler::record(const char* name, uint64_t begin, uint64_t end) noexcept {
+    auto& buffer = threadBuffer();
+    auto head = buffer.mHead.load(std::memory_order_relaxed);
+    buffer.mZones[head & ProfileThreadBuffer::sMask] = ProfileZone{ name, begin, end };
+    buffer.mHead.store(head + 1, std::memory_order_release);
+}
+
+void Profiler::setThreadName(std::string_view name) {
+    auto& buffer = threadBuffer();
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mMutex);
+    buffer.mName = name;
+}
+
+void Profiler::collect(std::pmr::vector<ProfileEvent>& events) {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mMutex);
+    for (auto& pBuffer : reg.mBuffers) {
+        auto& buffer = *pBuffer;
+        buffer.mCollected = readZones(buffer, buffer.mCollected, [&](const ProfileZone& zone) {
+            events.emplace_back(ProfileEvent{ zone.mName, buffer.mThreadID, zone.mBegin, zone.mEnd });
+        });
+    }
+}
+
+void Profiler::writeChromeTrace(std::ostream& os) {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mMutex);
+    const auto ticksPerMicrosecond = reg.ticksPerMicrosecond();
+
+    os << "{\"traceEvents\":[";
+    bool first = true;
+    auto separate = [&]() {
+        if (!first) {
+            os << ",";
+        }
+        first = false;
+        os << "\n";
+    };
+
+    for (const auto& pBuffer : reg.mBuffers) {
+        const auto& buffer = *pBuffer;
+        if (!buffer.mName.empty()) {
+            separate();
+            os << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << buffer.mThreadID
+                << ",\"args\":{\"name\":";
+            writeJsonString(os, buffer.mName);
+            os << "}}";
+        }
+        readZones(buffer, 0, [&](const ProfileZone& zone) {
+            separate();
+            os << "{\"name\":";
+            writeJsonString(os, zone.mName);
+            os << ",\"ph\":\"X\",\"pid\":0,\"tid\":" << buffer.mThreadID
+                << ",\"ts\":" << double(zone.mBegin - reg.mOriginTicks) / ticksPerMicrosecond
+                << ",\"dur\":" << double(zone.mEnd - zone.mBegin) / ticksPerMicrosecond << "}";
+        });
+    }
+    os << "\n]}\n";
+}
+
+double Profiler::toMicroseconds(uint64_t ticks) noexcept {
+    return double(ticks) / registry().ticksPerMicrosecond();
+}
+
+}
@@ -0,0 +1,74 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+#include <Star/Core/SConfig.h>
+#include <intrin.h>
+#include <iosfwd>
+
+namespace Star::Core {
+
+// zone names must outlive the profiler, pass string literals
+struct ProfileEvent {
+    const char* mName = nullptr;
+    uint32_t mThreadID = 0;
+    uint64_t mBegin = 0;
+    uint64_t mEnd = 0;
+};
+
+class Profiler {
+public:
+    // called by ProfileScope, appends to the calling thread's ring
+    STAR_CORE_API static void record(const char* name, uint64_t begin, uint64_t end) noexcept;
+    STAR_CORE_API static void setThreadName(std::string_view name);
+
+    // appends zones recorded since the last collect, for live streaming
+    STAR_CORE_API static void collect(std::pmr::vector<ProfileEvent>& events);
+    // writes every zone still held by the rings as a chrome trace_event json
+    STAR_CORE_API static void writeChromeTrace(std::ostream& os);
+    STAR_CORE_API static double toMicroseconds(uint64_t ticks) noexcept;
+};
+
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name) noexcept
+        : mName(name)
+        , mBegin(__rdtsc())
+    {}
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+    ~ProfileScope() noexcept {
+        Profiler::record(mName, mBegin, __rdtsc());
+    }
+private:
+    const char* mName;
+    uint64_t mBegin;
+};
+
+}
+
+#define STAR_PROFILE_CONCAT_IMPL(a, b) a ## b
+#define STAR_PROFILE_CONCAT(a, b) STAR_PROFILE_CONCAT_IMPL(a, b)
+
+#ifdef STAR_DEV
+#define STAR_PROFILE_SCOPE(name) \
+	::Star::Core::ProfileScope STAR_PROFILE_CONCAT(star_profile_scope_, __LINE__)(name)
+#else
+#define STAR_PROFILE_SCOPE(name) ((void)0)
+#endif
@@ -0,0 +1,136 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <Star/Core/SResource.h>
+
+namespace Star::Core {
+
+// keeps unreferenced resources loaded, least recently released evicted first
+// per resource type budgets, a zero budget disables caching of that type
+class ResidencyCache {
+    struct Entry {
+        Resource* mResource = nullptr;
+        ResidencySize mSize;
+    };
+public:
+    ResidencyCache()
+        : mBudgets(std::variant_size_v<ResourceType>)
+        , mCached(std::variant_size_v<ResourceType>)
+    {}
+
+    void setBudget(const ResourceType& tag, const ResidencySize& budget) {
+        Expects(tag.index() < mBudgets.size());
+        mBudgets[tag.index()] = budget;
+    }
+
+    bool enabled(const ResourceType& tag) const noexcept {
+        const auto& budget = mBudgets[tag.index()];
+        return budget.mCpuBytes || budget.mGpuBytes;
+    }
+
+    bool empty() const noexcept {
+        return mLRU.empty();
+    }
+
+    const ResidencySize& cached(const ResourceType& tag) const noexcept {
+        return mCached[tag.index()];
+    }
+
+    void add(Resource& resource, const ResidencySize& size) {
+        Expects(!mIndex.count(&resource));
+        mLRU.emplace_back(Entry{ &resource, size });
+        mIndex.emplace(&resource, std::prev(mLRU.end()));
+        auto& cached = mCached[resource.mTag.index()];
+        cached.mCpuBytes += size.mCpuBytes;
+        cached.mGpuBytes += size.mGpuBytes;
+    }
+
+    bool remove(Resource& resource) noexcept {
+        auto iter = mIndex.find(&resource);
+        if (iter == mIndex.end())
+            return false;
+        erase(iter->second);
+        mIndex.erase(iter);
+        return true;
+    }
+
+    // evicts until every type is within budget
+    template<class F>
+    void evictOverBudget(F&& evict) {
+        for (auto iter = mLRU.begin(); iter != mLRU.end();) {
+            const auto id = iter->mResource->mTag.index();
+            if (!overBudget(id)) {
+                ++iter;
+                continue;
+            }
+            iter = evictEntry(iter, evict);
+        }
+    }
+
+    // evicts gpu resources until gpuBytes are freed, e.g. under memory pressure
+    template<class F>
+    void evictGpuBytes(uint64_t gpuBytes, F&& evict) {
+        uint64_t freed = 0;
+        for (auto iter = mLRU.begin(); iter != mLRU.end() && freed < gpuBytes;) {
+            if (!iter->mSize.mGpuBytes) {
+                ++iter;
+                continue;
+            }
+            freed += iter->mSize.mGpuBytes;
+            iter = evictEntry(iter, evict);
+        }
+    }
+
+    template<class F>
+    void evictAll(F&& evict) {
+        for (auto iter = mLRU.begin(); iter != mLRU.end();) {
+            iter = evictEntry(iter, evict);
+        }
+    }
+private:
+    bool overBudget(size_t id) const noexcept {
+        const auto& budget = mBudgets[id];
+        const auto& cached = mCached[id];
+        return cached.mCpuBytes > budget.mCpuBytes || cached.mGpuBytes > budget.mGpuBytes;
+    }
+
+    template<class F>
+    std::list<Entry>::iterator evictEntry(std::list<Entry>::iterator iter, F& evict) {
+        auto& resource = *iter->mResource;
+        mIndex.erase(&resource);
+        auto next = erase(iter);
+        evict(resource);
+        return next;
+    }
+
+    std::list<Entry>::iterator erase(std::list<Entry>::iterator iter) noexcept {
+        auto& cached = mCached[iter->mResource->mTag.index()];
+        Expects(cached.mCpuBytes >= iter->mSize.mCpuBytes);
+        Expects(cached.mGpuBytes >= iter->mSize.mGpuBytes);
+        cached.mCpuBytes -= iter->mSize.mCpuBytes;
+        cached.mGpuBytes -= iter->mSize.mGpuBytes;
+        return mLRU.erase(iter);
+    }
+
+    std::vector<ResidencySize> mBudgets;
+    std::vector<ResidencySize> mCached;
+    std::list<Entry> mLRU;
+    std::unordered_map<const Resource*, std::list<Entry>::iterator> mIndex;
+};
+
+}
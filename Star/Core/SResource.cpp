@@ -20,29 +20,29 @@
 
 namespace Star::Core {
 
-bool ControlBlock::try_send(const EventTryStart& e) noexcept {
-    return Manager::instance().try_send(*static_cast<Resource*>(this), e.mAsync);
+bool ControlBlock::try_send(bool async) noexcept {
+    return Manager::instance().try_send(*static_cast<Resource*>(this), async);
 }
 
-void ControlBlock::unloaded_queued(const EventLoad& e) {
-    Manager::instance().enqueue(*static_cast<Resource*>(this), e.mAsync);
+void ControlBlock::unloaded_queued(bool async) {
+    Manager::instance().enqueue(*static_cast<Resource*>(this), async);
 }
 
-void ControlBlock::queued_unloaded(const EventUnload& e) noexcept {
-    Manager::instance().dequeue(*static_cast<Resource*>(this), e.mAsync);
+void ControlBlock::queued_unloaded(bool async) noexcept {
+    Manager::instance().dequeue(*static_cast<Resource*>(this), async);
 }
 
-void ControlBlock::loading_loaded(const EventCreated& e) {
-    mPointer = e.mPointer;
+void ControlBlock::loading_loaded(void* pointer) {
+    mPointer = pointer;
     Manager::instance().finishLoadingSucceeded(*static_cast<Resource*>(this));
 }
 
-void ControlBlock::cancelling_unloaded(const EventCreated& e) noexcept {
+void ControlBlock::cancelling_unloaded() noexcept {
     mPointer = nullptr;
     Manager::instance().finishLoadingFailed(*static_cast<Resource*>(this));
 }
 
-void ControlBlock::loaded_unloaded(const EventUnload& e) noexcept {
+void ControlBlock::loaded_unloaded(bool async) noexcept {
     mPointer = nullptr;
     Manager::instance().destroy(*static_cast<Resource*>(this));
 }
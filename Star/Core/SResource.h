@@ -23,83 +23,68 @@ namespace Star::Core {
 class Manager;
 class Producer;
 
-class alignas(16) ControlBlock : public boost::msm::front::state_machine_def<ControlBlock> {
+enum ResourceState : uint8_t {
+    Unloaded = 0,
+    Queued = 1,
+    Loading = 2,
+    Cancelling = 3,
+    Loaded = 4,
+};
+
+// transition table
+//  Unloaded    + load      -> Queued       unloaded_queued
+//  Queued      + unload    -> Unloaded     queued_unloaded
+//  Queued      + start     -> Loading      [try_send]
+//  Loading     + unload    -> Cancelling
+//  Cancelling  + load      -> Loading
+//  Cancelling  + created   -> Unloaded     cancelling_unloaded
+//  Loading     + created   -> Loaded       loading_loaded
+//  Loaded      + unload    -> Unloaded     loaded_unloaded
+class alignas(16) ControlBlock {
 public:
     ControlBlock(const MetaID& metaID, ResourceType tag)
         : mMetaID(metaID)
         , mTag(tag)
     {}
 
-    // Events
-    struct EventLoad {
-        bool mAsync = false;
-    };
-    struct EventUnload {
-        bool mAsync = false;
-    };
-    struct EventTryStart {
-        bool mAsync = false;
-    };
-    struct EventCreated {
-        void* mPointer = nullptr;
-    };
-
-    // config
-    typedef int no_message_queue;
-    //typedef int no_exception_thrown;
-
-    // states
-    struct Unloaded : boost::msm::front::state<> {};
-    struct Queued : boost::msm::front::state<> {};
-    struct Loading : boost::msm::front::state<> {};
-    struct Cancelling : boost::msm::front::state<> {};
-    struct Loaded : boost::msm::front::state<> {};
-
-    // guard
-    bool try_send(const EventTryStart& e) noexcept;
+    ResourceState state() const noexcept {
+        return static_cast<ResourceState>(mState.load(std::memory_order_acquire));
+    }
+protected:
+    bool transit(ResourceState from, ResourceState to) noexcept {
+        auto expected = static_cast<uint8_t>(from);
+        return mState.compare_exchange_strong(expected, static_cast<uint8_t>(to),
+            std::memory_order_acq_rel, std::memory_order_acquire);
+    }
 
-    // actions
-    void unloaded_queued(const EventLoad& e);   
-    void loading_loaded(const EventCreated& e);
-    void cancelling_unloaded(const EventCreated& e) noexcept;
-    void loaded_unloaded(const EventUnload& e) noexcept;
-    void queued_unloaded(const EventUnload& e) noexcept;
-
-    typedef Unloaded initial_state;
-    typedef ControlBlock t;
-    struct transition_table : boost::mpl::vector<
-        a_row<  Unloaded    , EventLoad     , Queued    , &t::unloaded_queued                   >,
-        a_row<  Queued      , EventUnload   , Unloaded  , &t::queued_unloaded                   >,
-
-        g_row<  Queued      , EventTryStart , Loading                           , &t::try_send  >,
-
-         _row<  Loading     , EventUnload   , Cancelling                                        >,
-         _row<  Cancelling  , EventLoad     , Loading                                           >,
-
-        a_row<  Cancelling  , EventCreated  , Unloaded  , &t::cancelling_unloaded               >,
-        a_row<  Loading     , EventCreated  , Loaded    , &t::loading_loaded                    >,
-        a_row<  Loaded      , EventUnload   , Unloaded  , &t::loaded_unloaded                   >>
-    {};
-
-    // exceptions
-    template<class FSM, class Event>
-    void no_transition(Event const& e, FSM& f, int state) {
-        std::string error =  "no transition, state: " + std::to_string(state) +
-            ", event: " + typeid(e).name();
+    [[noreturn]] void no_transition(const char* event) const {
+        std::string error = "no transition, state: " + std::to_string(state()) +
+            ", event: " + event;
         throw std::runtime_error(error);
     }
 
+    // guard
+    bool try_send(bool async) noexcept;
+
+    // actions
+    void unloaded_queued(bool async);
+    void loading_loaded(void* pointer);
+    void cancelling_unloaded() noexcept;
+    void loaded_unloaded(bool async) noexcept;
+    void queued_unloaded(bool async) noexcept;
+public:
     const ResourceType mTag;
+    mutable std::atomic_uint8_t mPriority = NormalPriority;
+    std::atomic_uint8_t mState = Unloaded;
     mutable std::atomic_int32_t mRefCount = 0;
     mutable std::atomic<void*> mPointer = nullptr;
     const MetaID mMetaID;
 };
 
-class Resource : public boost::msm::back::state_machine<ControlBlock> {
+class Resource : public ControlBlock {
 public:
-    Resource() = default;
     Resource(const MetaID& metaID, ResourceType tag)
-        : boost::msm::back::state_machine<ControlBlock>(metaID, tag)
+        : ControlBlock(metaID, tag)
     {}
 
     const MetaID& metaID() const noexcept {
@@ -110,6 +95,24 @@ public:
         return mRefCount == 0;
     }
 
+    LoadPriority priority() const noexcept {
+        return static_cast<LoadPriority>(mPriority.load(std::memory_order_relaxed));
+    }
+
+    // per frame hint, e.g. from distance or screen size
+    void setPriority(LoadPriority priority) const noexcept {
+        Expects(priority < LoadPriorityCount);
+        mPriority.store(priority, std::memory_order_relaxed);
+    }
+
+    // shared resources keep the most urgent request
+    void raisePriority(LoadPriority priority) const noexcept {
+        Expects(priority < LoadPriorityCount);
+        auto prev = mPriority.load(std::memory_order_relaxed);
+        while (prev < priority && !mPriority.compare_exchange_weak(prev, priority, std::memory_order_relaxed)) {
+        }
+    }
+
     inline void sync_acquire() const noexcept {
         if (atomicAddRef(mRefCount)) {
             const_cast<Resource*>(this)->loadNow();
@@ -134,16 +137,39 @@ private:
     friend class Manager;
 
     void load(bool async) {
-        process_event(EventLoad{ async });
+        if (transit(Unloaded, Queued)) {
+            unloaded_queued(async);
+        } else if (!transit(Cancelling, Loading)) {
+            no_transition("load");
+        }
     }
     void unload(bool async) noexcept {
-        process_event(EventUnload{ async });
+        if (transit(Queued, Unloaded)) {
+            queued_unloaded(async);
+        } else if (transit(Loaded, Unloaded)) {
+            loaded_unloaded(async);
+        } else if (!transit(Loading, Cancelling)) {
+            no_transition("unload");
+        }
     }
     void start(bool async) {
-        process_event(EventTryStart{ async });
+        if (state() != Queued) {
+            no_transition("start");
+        }
+        if (try_send(async)) {
+            // only the manager thread starts queued resources
+            auto succeeded = transit(Queued, Loading);
+            Ensures(succeeded);
+        }
     }
     void created(void* pointer) {
-        process_event(EventCreated{ pointer });
+        if (transit(Loading, Loaded)) {
+            loading_loaded(pointer);
+        } else if (transit(Cancelling, Unloaded)) {
+            cancelling_unloaded();
+        } else {
+            no_transition("created");
+        }
     }
 private:
     void loadNow() noexcept;
@@ -152,6 +178,7 @@ private:
 };
 
 CHECK_SIZE(ControlBlock, 32)
+CHECK_SIZE(Resource, 32)
 //PRINT_SIZE(ControlBlock)
 
 }
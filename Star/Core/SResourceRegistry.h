@@ -0,0 +1,84 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <Star/Core/SResource.h>
+
+namespace Star::Core {
+
+// insert-only open addressing table of resources
+// nodes are never moved or erased, so const Resource* stays valid
+// lookups of existing resources only load slots and are wait-free
+class ResourceRegistry {
+public:
+    explicit ResourceRegistry(size_t capacity)
+        : mMask(getSlotCount(capacity) - 1)
+        , mSlots(std::make_unique<std::atomic<Resource*>[]>(mMask + 1))
+    {}
+
+    ResourceRegistry(const ResourceRegistry&) = delete;
+    ResourceRegistry& operator=(const ResourceRegistry&) = delete;
+
+    ~ResourceRegistry() {
+        for (size_t i = 0; i != mMask + 1; ++i) {
+            delete mSlots[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    const Resource* get(const MetaID& metaID, const ResourceType& tag) const noexcept {
+        Resource* pCreated = nullptr;
+        auto slotID = boost::hash<MetaID>{}(metaID) & mMask;
+        for (size_t probe = 0; probe <= mMask; ++probe, slotID = (slotID + 1) & mMask) {
+            auto& slot = mSlots[slotID];
+            auto* ptr = slot.load(std::memory_order_acquire);
+            if (!ptr) {
+                if (!pCreated) {
+                    pCreated = new Resource(metaID, tag);
+                }
+                if (slot.compare_exchange_strong(ptr, pCreated,
+                    std::memory_order_acq_rel, std::memory_order_acquire))
+                {
+                    return pCreated;
+                }
+                // lost the race, ptr is the winner
+                Ensures(ptr);
+            }
+            if (ptr->metaID() == metaID) {
+                Expects(ptr->mTag == tag);
+                delete pCreated;
+                return ptr;
+            }
+        }
+        // registry is full, capacity is configured by max resource count
+        Expects(false);
+        return nullptr;
+    }
+private:
+    static size_t getSlotCount(size_t capacity) noexcept {
+        // keep load factor below 0.5
+        size_t count = 16;
+        while (count < capacity * 2) {
+            count *= 2;
+        }
+        return count;
+    }
+
+    const size_t mMask;
+    std::unique_ptr<std::atomic<Resource*>[]> mSlots;
+};
+
+}
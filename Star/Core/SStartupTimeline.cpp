@@ -0,0 +1,141 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "SStartupTimeline.h"
+#include <mutex>
+#include <ostream>
+#include <iomanip>
+
+namespace Star::Core {
+
+namespace {
+
+// set when the core module is loaded, before the app constructor runs
+const StartupTimeline::clock::time_point sModuleLoad = StartupTimeline::clock::now();
+
+struct StartupRegistry {
+    uint32_t threadIndex(std::thread::id id) {
+        auto iter = std::find(mThreads.begin(), mThreads.end(), id);
+        if (iter == mThreads.end()) {
+            mThreads.emplace_back(id);
+            return gsl::narrow_cast<uint32_t>(mThreads.size() - 1);
+        }
+        return gsl::narrow_cast<uint32_t>(iter - mThreads.begin());
+    }
+
+    double milliseconds(StartupTimeline::clock::time_point t) const noexcept {
+        return std::chrono::duration<double, std::milli>(t - mOrigin).count();
+    }
+
+    std::mutex mMutex;
+    StartupTimeline::clock::time_point mOrigin = sModuleLoad;
+    std::vector<std::thread::id> mThreads;
+    std::vector<StartupPhase> mPhases;
+};
+
+StartupRegistry& registry() {
+    static StartupRegistry sRegistry;
+    return sRegistry;
+}
+
+std::vector<StartupPhase> sortedPhases() {
+    auto phases = StartupTimeline::phases();
+    std::stable_sort(phases.begin(), phases.end(), [](const StartupPhase& lhs, const StartupPhase& rhs) {
+        return lhs.mBegin < rhs.mBegin;
+    });
+    return phases;
+}
+
+}
+
+void StartupTimeline::record(std::string_view name, clock::time_point begin, clock::time_point end) {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mMutex);
+    auto& phase = reg.mPhases.emplace_back();
+    phase.mName = name;
+    phase.mThread = reg.threadIndex(std::this_thread::get_id());
+    phase.mBegin = reg.milliseconds(begin);
+    phase.mEnd = reg.milliseconds(end);
+}
+
+void StartupTimeline::reset() {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mMutex);
+    reg.mOrigin = clock::now();
+    reg.mThreads.clear();
+    reg.mPhases.clear();
+}
+
+std::vector<StartupPhase> StartupTimeline::phases() {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mMutex);
+    return reg.mPhases;
+}
+
+double StartupTimeline::totalMilliseconds() {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mMutex);
+    double total = 0;
+    for (const auto& phase : reg.mPhases) {
+        total = std::max(total, phase.mEnd);
+    }
+    return total;
+}
+
+void StartupTimeline::writeReport(std::ostream& os) {
+    constexpr int sBarWidth = 40;
+    const auto phases = sortedPhases();
+    double total = 0;
+    for (const auto& phase : phases) {
+        total = std::max(total, phase.mEnd);
+    }
+
+    const auto flags = os.flags();
+    os << std::fixed << std::setprecision(1);
+    os << "startup " << total << " ms\n";
+    for (const auto& phase : phases) {
+        const int first = total > 0 ? int(phase.mBegin / total * sBarWidth) : 0;
+        const int last = total > 0 ? std::max(first + 1, int(phase.mEnd / total * sBarWidth)) : 1;
+        std::string bar(sBarWidth, ' ');
+        std::fill(bar.begin() + first, bar.begin() + std::min(last, sBarWidth), '#');
+        os << "  " << std::setw(9) << phase.mBegin << std::setw(9) << phase.mEnd - phase.mBegin
+            << " ms  t" << std::left << std::setw(3) << phase.mThread << std::right
+            << "|" << bar << "| " << phase.mName << "\n";
+    }
+    os.flags(flags);
+}
+
+void StartupTimeline::writeJson(std::ostream& os) {
+    const auto phases = sortedPhases();
+    os << "[";
+    for (size_t i = 0; i != phases.size(); ++i) {
+        const auto& phase = phases[i];
+        os << (i ? "," : "") << "{\"name\":\"";
+        for (char c : phase.mName) {
+            if (c == '"' || c == '\\') {
+                os << '\\';
+            }
+            os << c;
+        }
+        os << "\",\"thread\":" << phase.mThread
+            << ",\"begin\":" << phase.mBegin
+            << ",\"end\":" << phase.mEnd << "}";
+    }
+    os << "]";
+}
+
+}
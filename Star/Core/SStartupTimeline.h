@@ -0,0 +1,75 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <Star/Core/SConfig.h>
+#include <chrono>
+#include <iosfwd>
+
+namespace Star::Core {
+
+// phases of application launch, recorded in every build
+// times are milliseconds since the timeline origin, threads are numbered in order of first phase
+struct StartupPhase {
+    std::string mName;
+    uint32_t mThread = 0;
+    double mBegin = 0;
+    double mEnd = 0;
+};
+
+class StartupTimeline {
+public:
+    using clock = std::chrono::steady_clock;
+
+    // any thread, phases may overlap
+    STAR_CORE_API static void record(std::string_view name, clock::time_point begin, clock::time_point end);
+    // origin of the timeline, the load of the core module unless reset
+    STAR_CORE_API static void reset();
+    STAR_CORE_API static std::vector<StartupPhase> phases();
+    // end of the last phase
+    STAR_CORE_API static double totalMilliseconds();
+
+    // phases sorted by begin, with a bar per phase to show their overlap
+    STAR_CORE_API static void writeReport(std::ostream& os);
+    // [{"name":..,"thread":..,"begin":..,"end":..},...]
+    STAR_CORE_API static void writeJson(std::ostream& os);
+};
+
+class StartupScope {
+public:
+    explicit StartupScope(std::string_view name)
+        : mName(name)
+        , mBegin(StartupTimeline::clock::now())
+    {}
+    StartupScope(const StartupScope&) = delete;
+    StartupScope& operator=(const StartupScope&) = delete;
+
+    ~StartupScope() {
+        StartupTimeline::record(mName, mBegin, StartupTimeline::clock::now());
+    }
+private:
+    std::string_view mName;
+    StartupTimeline::clock::time_point mBegin;
+};
+
+}
+
+#define STAR_STARTUP_CONCAT_IMPL(a, b) a ## b
+#define STAR_STARTUP_CONCAT(a, b) STAR_STARTUP_CONCAT_IMPL(a, b)
+
+#define STAR_STARTUP_SCOPE(name) \
+	::Star::Core::StartupScope STAR_STARTUP_CONCAT(star_startup_scope_, __LINE__)(name)
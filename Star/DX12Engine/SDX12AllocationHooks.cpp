@@ -0,0 +1,49 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "pch.h"
+#include <Star/Core/SAllocationTracker.h>
+
+#ifdef STAR_DEV
+
+// operator new is bound per module on msvc, so these count the engine's own allocations.
+// array, nothrow and sized forms forward to these by default
+void* operator new(size_t size) {
+    Star::Core::AllocationTracker::onAllocate(size);
+    if (auto* p = malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    Star::Core::AllocationTracker::onAllocate(size);
+    if (auto* p = _aligned_malloc(size ? size : 1, static_cast<size_t>(alignment))) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    _aligned_free(p);
+}
+
+#endif
@@ -0,0 +1,380 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "SDX12Culling.h"
+#include "SDX12Transforms.h"
+#include <xmmintrin.h>
+
+namespace Star::Graphics::Render {
+
+DX12Frustum makeDX12Frustum(const CameraData& cam) noexcept {
+    const Matrix4f viewProj = cam.mProj * cam.mView;
+    const Vector4f planes[6] = {
+        (viewProj.row(3) + viewProj.row(0)).transpose(),
+        (viewProj.row(3) - viewProj.row(0)).transpose(),
+        (viewProj.row(3) + viewProj.row(1)).transpose(),
+        (viewProj.row(3) - viewProj.row(1)).transpose(),
+        viewProj.row(2).transpose(),
+        (viewProj.row(3) - viewProj.row(2)).transpose(),
+    };
+
+    DX12Frustum frustum;
+    for (int i = 0; i != 6; ++i) {
+        memcpy(frustum.mPlanes[i], planes[i].data(), sizeof(frustum.mPlanes[i]));
+    }
+    return frustum;
+}
+
+void buildDX12Meshlets(const MeshData& meshData, DX12MeshData& mesh) {
+    mesh.mMeshlets.clear();
+    if (meshData.mMeshlets.empty())
+        return;
+
+    mesh.mMeshlets.resize(meshData.mMeshlets.size());
+    for (const auto& submesh : meshData.mSubMeshes) {
+        Expects(size_t(submesh.mMeshletOffset) + submesh.mMeshletCount <= meshData.mMeshlets.size());
+        auto indexOffset = submesh.mIndexOffset;
+        for (uint32_t i = submesh.mMeshletOffset; i != submesh.mMeshletOffset + submesh.mMeshletCount; ++i) {
+            const auto& src = meshData.mMeshlets[i];
+            auto& dst = mesh.mMeshlets[i];
+            dst.mIndexOffset = indexOffset;
+            dst.mIndexCount = src.mTriangleCount * 3;
+            memcpy(dst.mCenter, src.mCenter.data(), sizeof(dst.mCenter));
+            dst.mRadius = src.mRadius;
+            memcpy(dst.mConeAxis, src.mConeAxis.data(), sizeof(dst.mConeAxis));
+            dst.mConeCutoff = src.mConeCutoff;
+            indexOffset += dst.mIndexCount;
+        }
+        Ensures(indexOffset <= submesh.mIndexOffset + submesh.mIndexCount);
+    }
+}
+
+DX12MeshletCuller::DX12MeshletCuller(const CameraData& cam) noexcept {
+    const auto frustum = makeDX12Frustum(cam);
+    for (int i = 0; i != 6; ++i) {
+        mPlanes[i] = Vector4f(frustum.mPlanes[i][0], frustum.mPlanes[i][1],
+            frustum.mPlanes[i][2], frustum.mPlanes[i][3]);
+        const auto length = mPlanes[i].head<3>().norm();
+        if (length > 0) {
+            mPlanes[i] /= length;
+        }
+    }
+    // view is rigid, eye is -R^T * t
+    const Matrix3f rotation = cam.mView.topLeftCorner<3, 3>();
+    mEye = -(rotation.transpose() * cam.mView.topRightCorner<3, 1>());
+}
+
+uint32_t DX12MeshletCuller::cull(const DX12Meshlet* pMeshlets, uint32_t count, const Affine3f& world,
+    bool coneCulling, std::pair<uint32_t, uint32_t>* pRanges) const noexcept {
+    const Matrix3f linear = world.linear();
+    const Vector3f scales(linear.col(0).norm(), linear.col(1).norm(), linear.col(2).norm());
+    const float scale = scales.maxCoeff();
+    // cones stay valid under rotation and uniform scale, mirroring flips the winding
+    const bool uniform = scales.maxCoeff() - scales.minCoeff() <= 0.01f * scale;
+    const float winding = linear.determinant() < 0 ? -1.0f : 1.0f;
+    coneCulling = coneCulling && uniform && scale > 0;
+
+    uint32_t rangeCount = 0;
+    for (uint32_t i = 0; i != count; ++i) {
+        const auto& meshlet = pMeshlets[i];
+        const Vector3f center = world * Vector3f(meshlet.mCenter[0], meshlet.mCenter[1], meshlet.mCenter[2]);
+        const float radius = meshlet.mRadius * scale;
+
+        bool visible = true;
+        for (const auto& plane : mPlanes) {
+            if (plane.head<3>().dot(center) + plane[3] < -radius) {
+                visible = false;
+                break;
+            }
+        }
+        if (visible && coneCulling && meshlet.mConeCutoff < 1) {
+            const Vector3f axis = (linear * Vector3f(meshlet.mConeAxis[0],
+                meshlet.mConeAxis[1], meshlet.mConeAxis[2])) * (winding / scale);
+            const Vector3f view = center - mEye;
+            if (view.dot(axis) >= meshlet.mConeCutoff * view.norm() + radius) {
+                visible = false;
+            }
+        }
+        if (!visible)
+            continue;
+
+        if (rangeCount && pRanges[rangeCount - 1].first + pRanges[rangeCount - 1].second == meshlet.mIndexOffset) {
+            pRanges[rangeCount - 1].second += meshlet.mIndexCount;
+        } else {
+            pRanges[rangeCount++] = { meshlet.mIndexOffset, meshlet.mIndexCount };
+        }
+    }
+    return rangeCount;
+}
+
+DX12LodSelector::DX12LodSelector(const CameraData& cam, float bias) noexcept
+    : mNearClip(std::max(cam.mNearClip, 1e-3f))
+{
+    const Matrix3f rotation = cam.mView.topLeftCorner<3, 3>();
+    mEye = -(rotation.transpose() * cam.mView.topRightCorner<3, 1>());
+    // projection y scale is 1 / tan(fov / 2)
+    const float tanHalfFov = cam.mProj(1, 1) != 0 ? 1.0f / std::abs(cam.mProj(1, 1))
+        : std::tan(0.5f * cam.mFov);
+    mErrorPerDistance = DX12LodScreenError * std::exp2(bias) * tanHalfFov;
+}
+
+uint8_t DX12LodSelector::select(const DX12MeshData& mesh, const DX12FlattenedObjects& batch,
+    uint32_t objectID) const noexcept {
+    if (mesh.mLods.empty() || objectID >= batch.mObjectCount)
+        return 0;
+
+    const auto stride = batch.mWorldBoundsStride;
+    const float* pData = batch.mWorldBoundsSoA.data();
+    const Vector3f center(pData[objectID], pData[stride + objectID], pData[2 * stride + objectID]);
+    const Vector3f extent(pData[3 * stride + objectID], pData[4 * stride + objectID], pData[5 * stride + objectID]);
+    // objects without bounds are never culled, keep their full detail too
+    if (extent.maxCoeff() >= 1e17f)
+        return 0;
+
+    const auto world = getDX12WorldTransform(batch, objectID);
+    const float scale = world.linear().colwise().norm().maxCoeff();
+    if (scale <= 0)
+        return 0;
+
+    // nearest point of the bounding sphere bounds the projected error
+    const float distance = std::max((center - mEye).norm() - extent.norm(), mNearClip);
+    const float maxError = distance * mErrorPerDistance / scale;
+    uint8_t level = 0;
+    for (const auto& lod : mesh.mLods) {
+        if (lod.mError > maxError)
+            break;
+        ++level;
+    }
+    return level;
+}
+
+DX12ShaderLevelSelector::DX12ShaderLevelSelector(const CameraData& cam, uint32_t level, float lodDistance) noexcept
+    : mLevel(level)
+    , mLevelsPerDistance(lodDistance > 0 ? 1.0f / lodDistance : 0.0f)
+{
+    const Matrix3f rotation = cam.mView.topLeftCorner<3, 3>();
+    mEye = -(rotation.transpose() * cam.mView.topRightCorner<3, 1>());
+}
+
+uint8_t DX12ShaderLevelSelector::select(const DX12DrawPacket& packet) const noexcept {
+    return gsl::narrow_cast<uint8_t>(std::min<uint32_t>(mLevel, packet.mShaderLevelCount - 1u));
+}
+
+uint8_t DX12ShaderLevelSelector::select(const DX12DrawPacket& packet, const DX12FlattenedObjects& batch,
+    uint32_t objectID) const noexcept {
+    if (!mLevelsPerDistance || objectID >= batch.mObjectCount)
+        return select(packet);
+
+    const auto stride = batch.mWorldBoundsStride;
+    const float* pData = batch.mWorldBoundsSoA.data();
+    const Vector3f center(pData[objectID], pData[stride + objectID], pData[2 * stride + objectID]);
+    const Vector3f extent(pData[3 * stride + objectID], pData[4 * stride + objectID], pData[5 * stride + objectID]);
+    if (extent.maxCoeff() >= 1e17f)
+        return select(packet);
+
+    // nearest point of the bounding sphere, objects around the eye keep the quality level
+    const float distance = std::max((center - mEye).norm() - extent.norm(), 0.0f);
+    const auto level = std::min(float(mLevel) + std::floor(distance * mLevelsPerDistance),
+        float(packet.mShaderLevelCount - 1u));
+    return gsl::narrow_cast<uint8_t>(level);
+}
+
+void buildDX12WorldBounds(DX12FlattenedObjects& batch) {
+    const auto count = batch.mObjectCount;
+    const auto stride = gsl::narrow_cast<uint32_t>(boost::alignment::align_up(count, DX12CullingLanes));
+    batch.mWorldBoundsStride = stride;
+    batch.mWorldBoundsSoA.assign(6 * size_t(stride), 0.0f);
+
+    for (uint32_t i = 0; i != count; ++i) {
+        updateDX12WorldBounds(batch, i);
+    }
+}
+
+void updateDX12WorldBounds(DX12FlattenedObjects& batch, uint32_t objectID) {
+    Expects(objectID < batch.mWorldBoundsStride);
+    Vector3f center = Vector3f::Zero();
+    Vector3f extent = Vector3f::Constant(1e18f);
+    if (objectID < batch.mBoundingBoxes.size()) {
+        const auto& bounds = batch.mBoundingBoxes[objectID].mLocalBounds;
+        if (bounds.valid()) {
+            const auto world = bounds.transformed(getDX12WorldTransform(batch, objectID));
+            center = world.center();
+            extent = world.extent();
+        }
+    }
+
+    const auto stride = batch.mWorldBoundsStride;
+    float* pData = batch.mWorldBoundsSoA.data();
+    for (uint32_t axis = 0; axis != 3; ++axis) {
+        pData[axis * stride + objectID] = center[axis];
+        pData[(axis + 3) * stride + objectID] = extent[axis];
+    }
+}
+
+void cullDX12WorldBounds(const DX12FlattenedObjects& batch, const DX12Frustum& frustum,
+    uint32_t begin, uint32_t end, uint8_t* pVisible) noexcept {
+    Expects(begin % DX12CullingLanes == 0);
+    Expects(end <= batch.mWorldBoundsStride);
+    static_assert(DX12CullingLanes == 4);
+
+    const auto stride = batch.mWorldBoundsStride;
+    const float* cx = batch.mWorldBoundsSoA.data();
+    const float* cy = cx + stride;
+    const float* cz = cy + stride;
+    const float* ex = cz + stride;
+    const float* ey = ex + stride;
+    const float* ez = ey + stride;
+
+    __m128 n[6][3];
+    __m128 a[6][3];
+    __m128 d[6];
+    for (int p = 0; p != 6; ++p) {
+        for (int axis = 0; axis != 3; ++axis) {
+            n[p][axis] = _mm_set1_ps(frustum.mPlanes[p][axis]);
+            a[p][axis] = _mm_set1_ps(std::abs(frustum.mPlanes[p][axis]));
+        }
+        d[p] = _mm_set1_ps(frustum.mPlanes[p][3]);
+    }
+    const __m128 zero = _mm_setzero_ps();
+
+    // padded lanes are read but not written
+    for (uint32_t i = begin; i < end; i += DX12CullingLanes) {
+        const __m128 x = _mm_loadu_ps(cx + i);
+        const __m128 y = _mm_loadu_ps(cy + i);
+        const __m128 z = _mm_loadu_ps(cz + i);
+        const __m128 w = _mm_loadu_ps(ex + i);
+        const __m128 h = _mm_loadu_ps(ey + i);
+        const __m128 l = _mm_loadu_ps(ez + i);
+
+        __m128 inside = _mm_cmpeq_ps(zero, zero);
+        for (int p = 0; p != 6; ++p) {
+            __m128 dist = _mm_add_ps(d[p], _mm_mul_ps(n[p][0], x));
+            dist = _mm_add_ps(dist, _mm_mul_ps(n[p][1], y));
+            dist = _mm_add_ps(dist, _mm_mul_ps(n[p][2], z));
+            dist = _mm_add_ps(dist, _mm_mul_ps(a[p][0], w));
+            dist = _mm_add_ps(dist, _mm_mul_ps(a[p][1], h));
+            dist = _mm_add_ps(dist, _mm_mul_ps(a[p][2], l));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(dist, zero));
+        }
+
+        const int mask = _mm_movemask_ps(inside);
+        const auto count = std::min(DX12CullingLanes, end - i);
+        for (uint32_t k = 0; k != count; ++k) {
+            pVisible[i + k] = static_cast<uint8_t>((mask >> k) & 1);
+        }
+    }
+}
+
+void buildDX12Bvh(DX12FlattenedObjects& batch,
+    const std::pmr::vector<BvhNode4>& nodes, const std::pmr::vector<uint32_t>& objects) {
+    batch.mBvhNodes.clear();
+    batch.mBvhObjects.clear();
+    batch.mBvhUnbounded.clear();
+    if (nodes.empty())
+        return;
+
+    std::pmr::vector<uint8_t> bounded(batch.mObjectCount, 0, batch.mBvhUnbounded.get_allocator());
+    for (const auto& objectID : objects) {
+        if (objectID >= batch.mObjectCount)
+            return;
+        bounded[objectID] = 1;
+    }
+    for (const auto& node : nodes) {
+        for (uint32_t k = 0; k != 4; ++k) {
+            if (node.mChild[k] == sBvhInvalidChild)
+                continue;
+            const auto limit = node.mCount[k] ? objects.size() : nodes.size();
+            if (size_t(node.mChild[k]) + node.mCount[k] > limit)
+                return;
+        }
+    }
+
+    batch.mBvhNodes = nodes;
+    batch.mBvhObjects = objects;
+    for (uint32_t i = 0; i != batch.mObjectCount; ++i) {
+        if (!bounded[i]) {
+            batch.mBvhUnbounded.emplace_back(i);
+        }
+    }
+}
+
+void cullDX12Bvh(const DX12FlattenedObjects& batch, const DX12Frustum& frustum, uint8_t* pVisible) {
+    Expects(!batch.mBvhNodes.empty());
+    std::fill(pVisible, pVisible + batch.mObjectCount, uint8_t(0));
+    for (const auto& objectID : batch.mBvhUnbounded) {
+        pVisible[objectID] = 1;
+    }
+
+    __m128 n[6][3];
+    __m128 a[6][3];
+    __m128 d[6];
+    for (int p = 0; p != 6; ++p) {
+        for (int axis = 0; axis != 3; ++axis) {
+            n[p][axis] = _mm_set1_ps(frustum.mPlanes[p][axis]);
+            a[p][axis] = _mm_set1_ps(std::abs(frustum.mPlanes[p][axis]));
+        }
+        d[p] = _mm_set1_ps(frustum.mPlanes[p][3]);
+    }
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 half = _mm_set1_ps(0.5f);
+
+    boost::container::small_vector<uint32_t, 64> stack;
+    stack.emplace_back(0);
+    while (!stack.empty()) {
+        const auto& node = batch.mBvhNodes[stack.back()];
+        stack.pop_back();
+
+        const __m128 minX = _mm_loadu_ps(node.mMinX);
+        const __m128 minY = _mm_loadu_ps(node.mMinY);
+        const __m128 minZ = _mm_loadu_ps(node.mMinZ);
+        const __m128 maxX = _mm_loadu_ps(node.mMaxX);
+        const __m128 maxY = _mm_loadu_ps(node.mMaxY);
+        const __m128 maxZ = _mm_loadu_ps(node.mMaxZ);
+        const __m128 x = _mm_mul_ps(_mm_add_ps(minX, maxX), half);
+        const __m128 y = _mm_mul_ps(_mm_add_ps(minY, maxY), half);
+        const __m128 z = _mm_mul_ps(_mm_add_ps(minZ, maxZ), half);
+        const __m128 w = _mm_mul_ps(_mm_sub_ps(maxX, minX), half);
+        const __m128 h = _mm_mul_ps(_mm_sub_ps(maxY, minY), half);
+        const __m128 l = _mm_mul_ps(_mm_sub_ps(maxZ, minZ), half);
+
+        __m128 inside = _mm_cmpeq_ps(zero, zero);
+        for (int p = 0; p != 6; ++p) {
+            __m128 dist = _mm_add_ps(d[p], _mm_mul_ps(n[p][0], x));
+            dist = _mm_add_ps(dist, _mm_mul_ps(n[p][1], y));
+            dist = _mm_add_ps(dist, _mm_mul_ps(n[p][2], z));
+            dist = _mm_add_ps(dist, _mm_mul_ps(a[p][0], w));
+            dist = _mm_add_ps(dist, _mm_mul_ps(a[p][1], h));
+            dist = _mm_add_ps(dist, _mm_mul_ps(a[p][2], l));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(dist, zero));
+        }
+
+        const int mask = _mm_movemask_ps(inside);
+        for (uint32_t k = 0; k != 4; ++k) {
+            if (!((mask >> k) & 1) || node.mChild[k] == sBvhInvalidChild)
+                continue;
+            if (node.mCount[k]) {
+                for (uint32_t i = node.mChild[k]; i != node.mChild[k] + node.mCount[k]; ++i) {
+                    pVisible[batch.mBvhObjects[i]] = 1;
+                }
+            } else {
+                stack.emplace_back(node.mChild[k]);
+            }
+        }
+    }
+}
+
+}
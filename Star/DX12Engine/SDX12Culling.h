@@ -0,0 +1,113 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <Star/DX12Engine/SDX12Types.h>
+
+namespace Star::Graphics::Render {
+
+// objects are tested in groups of lanes, bounds are padded accordingly
+constexpr uint32_t DX12CullingLanes = 4;
+
+// world space planes, a point is inside if dot(n, p) + d >= 0
+struct DX12Frustum {
+    float mPlanes[6][4];
+};
+
+// extract frustum planes from view projection, d3d depth range [0, 1]
+DX12Frustum makeDX12Frustum(const CameraData& cam) noexcept;
+
+// transform local bounds into world AABBs stored as SoA center/extent blocks
+// objects without valid bounds are never culled
+void buildDX12WorldBounds(DX12FlattenedObjects& batch);
+
+// recompute the world AABB of a single object after its transform changed
+void updateDX12WorldBounds(DX12FlattenedObjects& batch, uint32_t objectID);
+
+// write visibility of objects [begin, end), begin must be a multiple of DX12CullingLanes
+void cullDX12WorldBounds(const DX12FlattenedObjects& batch, const DX12Frustum& frustum,
+    uint32_t begin, uint32_t end, uint8_t* pVisible) noexcept;
+
+// copy the content hierarchy, dropped if it does not match the objects
+void buildDX12Bvh(DX12FlattenedObjects& batch,
+    const std::pmr::vector<BvhNode4>& nodes, const std::pmr::vector<uint32_t>& objects);
+
+// write visibility of all objects by walking mBvhNodes, leaves are visible as a whole
+void cullDX12Bvh(const DX12FlattenedObjects& batch, const DX12Frustum& frustum, uint8_t* pVisible);
+
+// submeshes with fewer meshlets are drawn whole
+constexpr uint32_t DX12MeshletCullingMinCount = 8;
+
+// copy meshlet bounds of the mesh data, meshlets are cut from submesh triangles in order
+void buildDX12Meshlets(const MeshData& meshData, DX12MeshData& mesh);
+
+// normalized planes and eye position for meshlet tests
+struct DX12MeshletCuller {
+    DX12MeshletCuller(const CameraData& cam) noexcept;
+
+    // write index ranges of visible meshlets drawn with world, adjacent ranges are merged
+    // returns the number of ranges, at most count. cones are only tested if coneCulling
+    uint32_t cull(const DX12Meshlet* pMeshlets, uint32_t count, const Affine3f& world,
+        bool coneCulling, std::pair<uint32_t, uint32_t>* pRanges) const noexcept;
+
+    Vector4f mPlanes[6];
+    Vector3f mEye;
+};
+
+// projected error allowed for a simplified level, about one pixel of a 1080p target
+constexpr float DX12LodScreenError = 1.0f / 540.0f;
+
+// picks the mesh level of an instance from its world bounds and the camera
+struct DX12LodSelector {
+    // each unit of bias doubles the allowed error
+    DX12LodSelector(const CameraData& cam, float bias) noexcept;
+
+    // coarsest level whose error projects below the threshold, 0 for meshes without levels
+    uint8_t select(const DX12MeshData& mesh, const DX12FlattenedObjects& batch,
+        uint32_t objectID) const noexcept;
+
+    Vector3f mEye;
+    // allowed object space error per unit of distance at unit scale
+    float mErrorPerDistance = 0;
+    float mNearClip = 0;
+};
+
+// picks the shader level of an instance, the quality level plus one level per lod distance from the eye
+// levels are clamped to the levels of the packet
+struct DX12ShaderLevelSelector {
+    DX12ShaderLevelSelector(const CameraData& cam, uint32_t level, float lodDistance) noexcept;
+
+    // draws without batch and objects without bounds use the quality level only
+    uint8_t select(const DX12DrawPacket& packet) const noexcept;
+    uint8_t select(const DX12DrawPacket& packet, const DX12FlattenedObjects& batch,
+        uint32_t objectID) const noexcept;
+
+    Vector3f mEye;
+    uint32_t mLevel = 0;
+    // 0 if levels do not depend on distance
+    float mLevelsPerDistance = 0;
+};
+
+// visible instances of a frame, draw id i owns [mDrawOffsets[i], mDrawOffsets[i + 1])
+struct DX12VisibleDraws {
+    std::pmr::vector<uint32_t> mInstances;
+    std::pmr::vector<uint32_t> mDrawOffsets;
+    // mesh level of each visible instance, instances of a draw are sorted by level
+    std::pmr::vector<uint8_t> mLevels;
+};
+
+}
@@ -0,0 +1,150 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "SDX12DirectStorage.h"
+#include "SDX12Utils.h"
+
+// the DirectStorage runtime is redistributed with the application, builds without its sdk report it missing
+#if __has_include(<dstorage.h>)
+#include <dstorage.h>
+#pragma comment(lib, "dstorage.lib")
+#define STAR_DIRECT_STORAGE
+#endif
+
+namespace Star::Graphics::Render {
+
+struct DX12DirectStorage::Impl {
+#ifdef STAR_DIRECT_STORAGE
+    com_ptr<IDStorageFactory> mFactory;
+    com_ptr<IDStorageQueue> mQueue;
+    std::vector<com_ptr<IDStorageFile>> mFiles;
+
+    DSTORAGE_REQUEST makeRequest(const DX12StorageSource& source) const {
+        Expects(source.mFileID < mFiles.size());
+        DSTORAGE_REQUEST request{};
+        request.Options.SourceType = DSTORAGE_REQUEST_SOURCE_FILE;
+        request.Options.CompressionFormat = source.mCompression == DX12StorageCompression::GDeflate ?
+            DSTORAGE_COMPRESSION_FORMAT_GDEFLATE : DSTORAGE_COMPRESSION_FORMAT_NONE;
+        request.Source.File.Source = mFiles[source.mFileID].get();
+        request.Source.File.Offset = source.mOffset;
+        request.Source.File.Size = source.mSize;
+        request.UncompressedSize = source.mUncompressedSize;
+        return request;
+    }
+#endif
+    com_ptr<ID3D12Fence> mFence;
+    uint64_t mNextFence = 1;
+};
+
+bool DX12DirectStorage::isSupported() noexcept {
+#ifdef STAR_DIRECT_STORAGE
+    com_ptr<IDStorageFactory> factory;
+    return SUCCEEDED(DStorageGetFactory(IID_PPV_ARGS(factory.put())));
+#else
+    return false;
+#endif
+}
+
+DX12DirectStorage::DX12DirectStorage(ID3D12Device* pDevice, uint32_t queueCapacity)
+    : mImpl(std::make_unique<Impl>())
+{
+#ifdef STAR_DIRECT_STORAGE
+    V(DStorageGetFactory(IID_PPV_ARGS(mImpl->mFactory.put())));
+
+    DSTORAGE_QUEUE_DESC desc{};
+    desc.SourceType = DSTORAGE_REQUEST_SOURCE_FILE;
+    desc.Capacity = gsl::narrow_cast<uint16_t>(std::clamp<uint32_t>(queueCapacity,
+        DSTORAGE_MIN_QUEUE_CAPACITY, DSTORAGE_MAX_QUEUE_CAPACITY));
+    desc.Priority = DSTORAGE_PRIORITY_NORMAL;
+    desc.Name = "DirectStorageQueue";
+    desc.Device = pDevice;
+    V(mImpl->mFactory->CreateQueue(&desc, IID_PPV_ARGS(mImpl->mQueue.put())));
+
+    mImpl->mFence = DX12::createFence(pDevice, mImpl->mNextFence, "DirectStorageFence");
+#else
+    throw std::runtime_error("DirectStorage not available");
+#endif
+}
+
+DX12DirectStorage::~DX12DirectStorage() {
+    // requests in flight write into resources released after the storage
+    if (mImpl->mFence && !isCompleted(mImpl->mNextFence - 1)) {
+        auto fenceEvent = DX12::createFenceEvent();
+        V(mImpl->mFence->SetEventOnCompletion(mImpl->mNextFence - 1, fenceEvent.get()));
+        WaitForSingleObject(fenceEvent.get(), INFINITE);
+    }
+}
+
+uint32_t DX12DirectStorage::openFile(const std::filesystem::path& file) {
+#ifdef STAR_DIRECT_STORAGE
+    auto& f = mImpl->mFiles.emplace_back();
+    if (FAILED(mImpl->mFactory->OpenFile(file.c_str(), IID_PPV_ARGS(f.put())))) {
+        mImpl->mFiles.pop_back();
+        throw std::runtime_error("DirectStorage open file failed: " + file.string());
+    }
+    return gsl::narrow_cast<uint32_t>(mImpl->mFiles.size() - 1);
+#else
+    throw std::runtime_error("DirectStorage not available");
+#endif
+}
+
+void DX12DirectStorage::enqueueBuffer(const DX12StorageSource& source, ID3D12Resource* pBuffer, uint64_t offset) {
+#ifdef STAR_DIRECT_STORAGE
+    auto request = mImpl->makeRequest(source);
+    request.Options.DestinationType = DSTORAGE_REQUEST_DESTINATION_BUFFER;
+    request.Destination.Buffer.Resource = pBuffer;
+    request.Destination.Buffer.Offset = offset;
+    request.Destination.Buffer.Size = source.mUncompressedSize;
+    mImpl->mQueue->EnqueueRequest(&request);
+#endif
+}
+
+void DX12DirectStorage::enqueueTexture(const DX12StorageSource& source, ID3D12Resource* pTexture, uint32_t firstSubresource) {
+#ifdef STAR_DIRECT_STORAGE
+    auto request = mImpl->makeRequest(source);
+    request.Options.DestinationType = DSTORAGE_REQUEST_DESTINATION_MULTIPLE_SUBRESOURCES;
+    request.Destination.MultipleSubresources.Resource = pTexture;
+    request.Destination.MultipleSubresources.FirstSubresource = firstSubresource;
+    mImpl->mQueue->EnqueueRequest(&request);
+#endif
+}
+
+uint64_t DX12DirectStorage::submit() {
+    const auto fence = mImpl->mNextFence++;
+#ifdef STAR_DIRECT_STORAGE
+    mImpl->mQueue->EnqueueSignal(mImpl->mFence.get(), fence);
+    mImpl->mQueue->Submit();
+#endif
+    return fence;
+}
+
+uint64_t DX12DirectStorage::completedFence() const noexcept {
+    return mImpl->mFence ? mImpl->mFence->GetCompletedValue() : 0;
+}
+
+void DX12DirectStorage::checkErrors() const {
+#ifdef STAR_DIRECT_STORAGE
+    DSTORAGE_ERROR_RECORD record{};
+    mImpl->mQueue->RetrieveErrorRecord(&record);
+    if (record.FailureCount) {
+        throw std::runtime_error("DirectStorage request failed, hresult " +
+            std::to_string(record.FirstFailure.HResult) + ", failures " + std::to_string(record.FailureCount));
+    }
+#endif
+}
+
+}
@@ -0,0 +1,74 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <Star/DX12Engine/SDX12Types.h>
+#include <filesystem>
+
+namespace Star::Graphics::Render {
+
+enum class DX12StorageCompression : uint32_t {
+    None,
+    // decompressed on gpu if supported, else on the worker threads of the runtime
+    GDeflate,
+};
+
+// payload of a packed file, stored bytes at mOffset, mUncompressedSize bytes written to the resource
+struct DX12StorageSource {
+    uint32_t mFileID = 0;
+    uint64_t mOffset = 0;
+    uint32_t mSize = 0;
+    uint32_t mUncompressedSize = 0;
+    DX12StorageCompression mCompression = DX12StorageCompression::None;
+};
+
+// payloads streamed from files into gpu resources by DirectStorage, skipping the upload buffer copy
+// destinations are in common state, written once the fence returned by submit completes
+// buffer payloads are raw bytes, texture payloads are subresources in GetCopyableFootprints layout
+class DX12DirectStorage {
+public:
+    // false if the DirectStorage runtime is not installed
+    static bool isSupported() noexcept;
+
+    // throws if the runtime is not installed
+    DX12DirectStorage(ID3D12Device* pDevice, uint32_t queueCapacity);
+    DX12DirectStorage(const DX12DirectStorage&) = delete;
+    DX12DirectStorage& operator=(const DX12DirectStorage&) = delete;
+    ~DX12DirectStorage();
+
+    // file stays open until the storage is destroyed, returns its id
+    uint32_t openFile(const std::filesystem::path& file);
+
+    void enqueueBuffer(const DX12StorageSource& source, ID3D12Resource* pBuffer, uint64_t offset);
+    // subresources starting at firstSubresource, up to the last one of the texture
+    void enqueueTexture(const DX12StorageSource& source, ID3D12Resource* pTexture, uint32_t firstSubresource);
+
+    // submit enqueued requests, returns the fence they complete with
+    uint64_t submit();
+
+    uint64_t completedFence() const noexcept;
+    bool isCompleted(uint64_t fence) const noexcept {
+        return completedFence() >= fence;
+    }
+    // throws if a completed request failed, e.g. a corrupted compressed payload
+    void checkErrors() const;
+private:
+    struct Impl;
+    std::unique_ptr<Impl> mImpl;
+};
+
+}
@@ -0,0 +1,519 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "SDX12DrawPacket.h"
+#include "SDX12Material.h"
+#include "SDX12Culling.h"
+
+namespace Star::Graphics::Render {
+
+namespace {
+
+void buildDrawDescriptor(const DX12ShaderSubpassData& shaderSubpass,
+    const DescriptorIndex& index, uint32_t descID, bool perInstance, size_t alignment,
+    DX12UnorderedRenderQueue& queue
+) {
+    for (const auto& cb : shaderSubpass.mConstantBuffers) {
+        if (cb.mIndex != index)
+            continue;
+
+        Expects(cb.mSize);
+        DX12DrawDescriptor desc{};
+        desc.mIndex = descID;
+        desc.mSize = gsl::narrow_cast<uint32_t>(boost::alignment::align_up(cb.mSize, alignment));
+        desc.mConstantBegin = gsl::narrow_cast<uint32_t>(queue.mDrawConstants.size());
+
+        uint32_t offset = 0;
+        for (const auto& constant : cb.mConstants) {
+            // constants are placed by the compiler following hlsl packing rules
+            Expects(constant.mOffset >= offset);
+            offset = constant.mOffset;
+            visit(overload(
+                [&](EngineSource_) {
+                    visit(overload(
+                        [&](Data::Proj_) {
+                            throw std::runtime_error("Proj cannot be per instance");
+                        },
+                        [&](Data::View_) {
+                            throw std::runtime_error("View cannot be per instance");
+                        },
+                        [&](Data::WorldView_) {
+                            if (!perInstance) {
+                                throw std::runtime_error("batch is nullptr");
+                            }
+                            queue.mDrawConstants.emplace_back(DX12DrawConstant{ WorldViewConstant, offset });
+                            offset += sizeof(Matrix4f);
+                        },
+                        [&](Data::WorldInvT_) {
+                            if (!perInstance) {
+                                throw std::runtime_error("batch is nullptr");
+                            }
+                            queue.mDrawConstants.emplace_back(DX12DrawConstant{ WorldInvTConstant, offset });
+                            offset += sizeof(Matrix4f);
+                        },
+                        [&](Data::PrevWorldView_) {
+                            if (!perInstance) {
+                                throw std::runtime_error("batch is nullptr");
+                            }
+                            queue.mDrawConstants.emplace_back(DX12DrawConstant{ PrevWorldViewConstant, offset });
+                            offset += sizeof(Matrix4f);
+                        },
+                        [&](Data::TextureIndices_) {
+                            queue.mDrawConstants.emplace_back(DX12DrawConstant{ TextureIndicesConstant, offset });
+                            offset += sizeof(DX12MaterialData::mTextureIndices);
+                        },
+                        [&](Data::MaterialIndex_) {
+                            queue.mDrawConstants.emplace_back(DX12DrawConstant{ MaterialIndexConstant, offset });
+                            offset += sizeof(DX12MaterialData::mConstantIndex);
+                        },
+                        [&](Data::ViewportScale_) {
+                            throw std::runtime_error("ViewportScale cannot be per instance");
+                        },
+                        [&](Data::Jitter_) {
+                            throw std::runtime_error("Jitter cannot be per instance");
+                        },
+                        [](std::monostate) {
+                            throw std::runtime_error("engine source constant cannot be monostate");
+                        }
+                    ), constant.mDataType);
+                },
+                [&](RenderTargetSource_) {
+                    throw std::runtime_error("dynamic constant cannot be render target source");
+                },
+                [&](MaterialSource_) {
+                    throw std::runtime_error("dynamic constant cannot be material source");
+                }
+            ), constant.mSource);
+        }
+        Expects(offset <= desc.mSize);
+
+        desc.mConstantCount = gsl::narrow_cast<uint32_t>(queue.mDrawConstants.size()) - desc.mConstantBegin;
+        queue.mDrawDescriptors.emplace_back(desc);
+        return;
+    }
+    throw std::runtime_error("constant buffer not found");
+}
+
+void buildDescriptorTableBindings(const DX12ShaderSubpassData& shaderSubpass,
+    const DX12ShaderDescriptorCollection& collection, bool perInstance,
+    DX12UnorderedRenderQueue& queue
+) {
+    for (const auto& list : collection.mResourceViewLists) {
+        Expects(!list.mRanges.empty());
+        Expects(list.mCapacity);
+        DX12DrawBinding binding{ list.mSlot, list.mCapacity };
+        binding.mDescriptorBegin = gsl::narrow_cast<uint32_t>(queue.mDrawDescriptors.size());
+
+        uint32_t descID = 0;
+        for (const auto& range : list.mRanges) {
+            for (const auto& subrange : range.mSubranges) {
+                visit(overload(
+                    [&](EngineSource_) {
+                        for (const auto& attr : subrange.mDescriptors) {
+                            visit(overload(
+                                [&](Descriptor::ConstantBuffer_) {
+                                    buildDrawDescriptor(shaderSubpass, collection.mIndex,
+                                        descID, perInstance, 256, queue);
+                                },
+                                [&](Descriptor::MainTex_) {
+                                    throw std::runtime_error("not supported yet");
+                                },
+                                [&](Descriptor::PointSampler_) {
+                                },
+                                [&](Descriptor::LinearSampler_) {
+                                },
+                                [&](Descriptor::PointLights_) {
+                                    throw std::runtime_error("light culling buffers must be per pass");
+                                },
+                                [&](Descriptor::LightGrid_) {
+                                    throw std::runtime_error("light culling buffers must be per pass");
+                                },
+                                [&](Descriptor::LightIndices_) {
+                                    throw std::runtime_error("light culling buffers must be per pass");
+                                },
+                                [&](Descriptor::MaterialConstants_) {
+                                    throw std::runtime_error("MaterialConstants must be per pass");
+                                },
+                                [&](std::monostate) {
+                                    throw std::runtime_error("engine source should not be std::monostate");
+                                }
+                            ), attr.mDataType);
+                            ++descID;
+                        }
+                    },
+                    [&](RenderTargetSource_) {
+                        throw std::runtime_error("render target source's Update Frequency should not be less than PerPass");
+                    },
+                    [&](MaterialSource_) {
+                        throw std::runtime_error("not supported yet");
+                    }
+                ), subrange.mSource);
+            }
+        }
+        binding.mDescriptorCount = gsl::narrow_cast<uint32_t>(queue.mDrawDescriptors.size()) - binding.mDescriptorBegin;
+        queue.mDrawBindings.emplace_back(binding);
+    }
+}
+
+void buildRootDescriptorBindings(const DX12ShaderSubpassData& shaderSubpass,
+    const DX12ShaderDescriptorCollection& collection, bool perInstance,
+    DX12DrawBindingEnum type, DX12UnorderedRenderQueue& queue
+) {
+    // constant buffer view must be 256 aligned, structured buffer is tightly packed
+    const size_t alignment = (type == RootConstantBufferBinding) ? 256 : 1;
+
+    for (const auto& list : collection.mResourceViewLists) {
+        Expects(!list.mRanges.empty());
+        uint32_t slot = list.mSlot;
+        for (const auto& range : list.mRanges) {
+            for (const auto& subrange : range.mSubranges) {
+                visit(overload(
+                    [&](EngineSource_) {
+                        for (const auto& attr : subrange.mDescriptors) {
+                            visit(overload(
+                                [&](Descriptor::ConstantBuffer_) {
+                                    DX12DrawBinding binding{ slot };
+                                    binding.mDescriptorBegin = gsl::narrow_cast<uint32_t>(queue.mDrawDescriptors.size());
+                                    binding.mDescriptorCount = 1;
+                                    binding.mType = type;
+                                    buildDrawDescriptor(shaderSubpass, collection.mIndex,
+                                        0, perInstance, alignment, queue);
+                                    queue.mDrawBindings.emplace_back(binding);
+                                },
+                                [&](std::monostate) {
+                                    throw std::runtime_error("engine source should not be std::monostate");
+                                },
+                                [&](auto) {
+                                    throw std::runtime_error("root descriptor must be constant buffer");
+                                }
+                            ), attr.mDataType);
+                            ++slot;
+                        }
+                    },
+                    [&](RenderTargetSource_) {
+                        throw std::runtime_error("render target source's Update Frequency should not be less than PerPass");
+                    },
+                    [&](MaterialSource_) {
+                        throw std::runtime_error("not supported yet");
+                    }
+                ), subrange.mSource);
+            }
+        }
+    }
+}
+
+void buildDrawBindings(const DX12ShaderSubpassData& shaderSubpass,
+    const DX12MaterialSubpassData& subpassData, bool perInstance,
+    DX12UnorderedRenderQueue& queue, DX12DrawPacket& packet
+) {
+    packet.mBindingBegin = gsl::narrow_cast<uint32_t>(queue.mDrawBindings.size());
+
+    for (const auto& collection : subpassData.mCollections) {
+        visit(overload(
+            [&](Persistent_) {
+                Expects(std::holds_alternative<Table_>(collection.mIndex.mType));
+                for (const auto& list : collection.mResourceViewLists) {
+                    queue.mDrawBindings.emplace_back(DX12DrawBinding{ list.mSlot, 0, list.mGpuOffset });
+                }
+                for (const auto& list : collection.mSamplerLists) {
+                    queue.mDrawBindings.emplace_back(DX12DrawBinding{ list.mSlot, 0, list.mGpuOffset });
+                }
+            },
+            [&](Dynamic_) {
+                Expects(collection.mIndex.mUpdate < UpdateEnum::PerPass);
+                visit(overload(
+                    [&](Table_) {
+                        buildDescriptorTableBindings(shaderSubpass, collection, perInstance, queue);
+                    },
+                    [&](CBV_) {
+                        buildRootDescriptorBindings(shaderSubpass, collection, perInstance,
+                            RootConstantBufferBinding, queue);
+                    },
+                    [&](SRV_) {
+                        buildRootDescriptorBindings(shaderSubpass, collection, perInstance,
+                            RootShaderResourceBinding, queue);
+                    },
+                    [&](const auto&) {
+                        throw std::runtime_error("dynamic root parameter type not supported yet");
+                    }
+                ), collection.mIndex.mType);
+                if (!collection.mSamplerLists.empty()) {
+                    throw std::runtime_error("not supported yet");
+                }
+            }
+        ), collection.mIndex.mPersistency);
+    }
+
+    packet.mBindingCount = gsl::narrow_cast<uint32_t>(queue.mDrawBindings.size()) - packet.mBindingBegin;
+}
+
+// per draw constants are uploaded for the first instance only,
+// renderers can be instanced if all dynamic constants are in structured buffers
+// 64-bit sort key fields, from most to least significant
+constexpr uint32_t sLayerBits = 4;
+constexpr uint32_t sPipelineBits = 12;
+constexpr uint32_t sTableBits = 14;
+constexpr uint32_t sMeshBits = 14;
+constexpr uint32_t sPacketBits = 20;
+static_assert(sLayerBits + sPipelineBits + sTableBits + sMeshBits + sPacketBits == 64);
+
+// dense ids in order of first appearance
+template<class T>
+class SortRanks {
+public:
+    uint64_t rank(T value) {
+        auto res = mRanks.emplace(value, mRanks.size());
+        return res.first->second;
+    }
+    size_t size() const noexcept {
+        return mRanks.size();
+    }
+private:
+    std::map<T, uint64_t> mRanks;
+};
+
+uint64_t getMaterialTable(const DX12UnorderedRenderQueue& queue, const DX12DrawPacket& packet) noexcept {
+    for (uint32_t bindingID = packet.mBindingBegin; bindingID != packet.mBindingBegin + packet.mBindingCount; ++bindingID) {
+        const auto& binding = queue.mDrawBindings[bindingID];
+        if (binding.mType == DescriptorTableBinding && binding.mCapacity == 0)
+            return binding.mGpuOffset.ptr;
+    }
+    return 0;
+}
+
+// lsd radix sort with 8-bit digits, bytes shared by all keys are skipped
+void radixSort(std::vector<uint64_t>& keys) {
+    std::vector<uint64_t> buffer(keys.size());
+    for (uint32_t shift = 0; shift != 64; shift += 8) {
+        std::array<size_t, 257> offsets{};
+        for (const auto& key : keys) {
+            ++offsets[((key >> shift) & 0xFF) + 1];
+        }
+        if (std::find(offsets.begin() + 1, offsets.end(), keys.size()) != offsets.end())
+            continue;
+        for (size_t i = 1; i != offsets.size(); ++i) {
+            offsets[i] += offsets[i - 1];
+        }
+        for (const auto& key : keys) {
+            buffer[offsets[(key >> shift) & 0xFF]++] = key;
+        }
+        keys.swap(buffer);
+    }
+}
+
+bool isInstanceable(const DX12UnorderedRenderQueue& queue, const DX12DrawPacket& packet) noexcept {
+    for (uint32_t bindingID = packet.mBindingBegin; bindingID != packet.mBindingBegin + packet.mBindingCount; ++bindingID) {
+        const auto& binding = queue.mDrawBindings[bindingID];
+        if (binding.mType == RootShaderResourceBinding)
+            continue;
+        if (binding.mType == DescriptorTableBinding && binding.mCapacity == 0)
+            continue;
+        return false;
+    }
+    return true;
+}
+
+void buildMaterialPackets(uint32_t solutionID, uint32_t pipelineID,
+    uint32_t passID, uint32_t subpassID, const DX12MaterialData& material,
+    const DX12MeshData* pMesh, const SubMeshData* pSubmesh,
+    const DX12FlattenedObjects* pBatch, uint32_t instanceBegin, uint32_t instanceCount,
+    DX12UnorderedRenderQueue& queue
+) {
+    Expects(instanceCount);
+    uint32_t shaderSolutionID{};
+    uint32_t shaderPipelineID{};
+    uint32_t shaderQueueID{};
+
+    const auto& shaderQueue = getSubpassData(material,
+        solutionID, pipelineID, passID, subpassID,
+        shaderSolutionID, shaderPipelineID, shaderQueueID);
+
+    // coarser levels are selected per instance when the frame is culled
+    const auto levelCount = gsl::narrow_cast<uint8_t>(shaderQueue.mLevels.size());
+    const auto variantID = 0;
+    for (uint8_t levelID = 0; levelID != levelCount; ++levelID) {
+        uint32_t shaderSubpassID = 0;
+        for (const auto& shaderSubpass : shaderQueue.mLevels.at(levelID).mPasses.at(variantID).mSubpasses) {
+            const auto& subpassData = material.mShaderData.at(shaderSolutionID).mPipelines.at(shaderPipelineID).mQueues.at(shaderQueueID).
+                mLevels.at(levelID).mPasses.at(variantID).mSubpasses.at(shaderSubpassID);
+
+            DX12DrawPacket packet{};
+            packet.mMesh = pMesh;
+            packet.mMaterial = &material;
+            packet.mBatch = pBatch;
+            packet.mSortLayer = shaderSubpassID;
+            packet.mShaderLevel = levelID;
+            packet.mShaderLevelCount = levelCount;
+            if (pMesh) {
+                Expects(pSubmesh);
+                const auto& layoutID = shaderSubpass.mVertexLayoutIndex.at(pMesh->mLayoutID);
+                packet.mPipelineSource = &shaderSubpass.mStates.at(layoutID);
+                packet.mPipelineState = packet.mPipelineSource->mObject.get();
+                packet.mPrimitiveTopology = static_cast<D3D12_PRIMITIVE_TOPOLOGY>(pMesh->mIndexBuffer.mPrimitiveTopology);
+                packet.mElementCount = pSubmesh->mIndexCount;
+                packet.mElementOffset = pSubmesh->mIndexOffset + pMesh->mBaseIndex;
+                packet.mBaseVertex = gsl::narrow_cast<int32_t>(pMesh->mBaseVertex);
+                packet.mSubMeshID = gsl::narrow_cast<uint32_t>(pSubmesh - pMesh->mSubMeshes.data());
+                if (pSubmesh->mMeshletCount >= DX12MeshletCullingMinCount &&
+                    size_t(pSubmesh->mMeshletOffset) + pSubmesh->mMeshletCount <= pMesh->mMeshlets.size()) {
+                    packet.mMeshletBegin = pSubmesh->mMeshletOffset;
+                    packet.mMeshletCount = pSubmesh->mMeshletCount;
+                    packet.mConeCulling = shaderSubpass.mBackfaceCulling;
+                }
+            } else {
+                const auto& layoutID = shaderSubpass.mVertexLayoutIndex.at(0);
+                packet.mPipelineSource = &shaderSubpass.mStates.at(layoutID);
+                packet.mPipelineState = packet.mPipelineSource->mObject.get();
+                packet.mPrimitiveTopology = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+                packet.mElementCount = 3;
+                packet.mElementOffset = 0;
+            }
+            Ensures(packet.mPipelineSource);
+
+            buildDrawBindings(shaderSubpass, subpassData, pBatch != nullptr, queue, packet);
+
+            if (isInstanceable(queue, packet)) {
+                packet.mInstanceBegin = instanceBegin;
+                packet.mInstanceCount = instanceCount;
+                queue.mDrawPackets.emplace_back(packet);
+            } else {
+                // bindings are shared by all draws
+                for (uint32_t instanceID = instanceBegin; instanceID != instanceBegin + instanceCount; ++instanceID) {
+                    packet.mInstanceBegin = instanceID;
+                    packet.mInstanceCount = 1;
+                    queue.mDrawPackets.emplace_back(packet);
+                }
+            }
+            ++shaderSubpassID;
+        }
+    }
+}
+
+}
+
+void buildDX12DrawPackets(uint32_t solutionID, uint32_t pipelineID,
+    uint32_t passID, uint32_t subpassID, DX12UnorderedRenderQueue& queue
+) {
+    queue.mDrawPackets.clear();
+    queue.mDrawBindings.clear();
+    queue.mDrawDescriptors.clear();
+    queue.mDrawConstants.clear();
+    queue.mDrawInstances.clear();
+
+    // packets are sorted afterwards, draw calls and batches are walked by type
+    for (const auto& pContent : queue.mContents) {
+        const auto& content = *pContent;
+        for (const auto drawCallID : content.mDrawCallIDs) {
+            const auto& dc = content.mDrawCalls[drawCallID];
+            std::visit(overload(
+                [&](FullScreenTriangle_) {
+                    const auto instanceBegin = gsl::narrow_cast<uint32_t>(queue.mDrawInstances.size());
+                    queue.mDrawInstances.emplace_back(0);
+                    buildMaterialPackets(solutionID, pipelineID, passID, subpassID,
+                        *dc.mMaterial, nullptr, nullptr, nullptr, instanceBegin, 1, queue);
+                },
+                [&](std::monostate) {
+                    throw std::runtime_error("mesh drawcall not supported");
+                }
+            ), dc.mType);
+        }
+        for (const auto batchID : content.mBatchIDs) {
+            const auto& batch = content.mFlattenedObjects[batchID];
+            Expects(batch.mObjectCount == batch.mMeshRenderers.size());
+
+            // group renderers by mesh, submesh and material, in order of appearance
+            using InstanceKey = std::tuple<const DX12MeshData*, size_t, const DX12MaterialData*>;
+            std::map<InstanceKey, size_t> groupIndex;
+            std::vector<std::pair<InstanceKey, std::vector<uint32_t>>> groups;
+            for (uint32_t objectID = 0; objectID != batch.mMeshRenderers.size(); ++objectID) {
+                const auto& renderer = batch.mMeshRenderers[objectID];
+                const auto& mesh = *renderer.mMesh;
+
+                size_t materialID = 0;
+                for (const auto& material : renderer.mMaterials) {
+                    if (materialID >= mesh.mSubMeshes.size()) {
+                        break;
+                    }
+                    InstanceKey key{ &mesh, materialID, material.get() };
+                    auto res = groupIndex.emplace(key, groups.size());
+                    if (res.second) {
+                        groups.emplace_back(key, std::vector<uint32_t>{});
+                    }
+                    groups[res.first->second].second.emplace_back(objectID);
+                    ++materialID;
+                }
+            }
+
+            for (const auto& [key, objects] : groups) {
+                const auto& [pMesh, submeshID, pMaterial] = key;
+                const auto instanceBegin = gsl::narrow_cast<uint32_t>(queue.mDrawInstances.size());
+                queue.mDrawInstances.insert(queue.mDrawInstances.end(), objects.begin(), objects.end());
+                buildMaterialPackets(solutionID, pipelineID, passID, subpassID,
+                    *pMaterial, pMesh, &pMesh->mSubMeshes[submeshID], &batch,
+                    instanceBegin, gsl::narrow_cast<uint32_t>(objects.size()), queue);
+            }
+        }
+    }
+
+    sortDX12DrawPackets(queue);
+}
+
+void sortDX12DrawPackets(DX12UnorderedRenderQueue& queue) {
+    const auto packetCount = queue.mDrawPackets.size();
+    if (packetCount < 2)
+        return;
+
+    // psos may still be compiling, their states are ranked instead
+    SortRanks<const DX12PipelineStateData*> pipelines;
+    SortRanks<uint64_t> tables;
+    SortRanks<const void*> meshes;
+
+    std::vector<uint64_t> keys;
+    keys.reserve(packetCount);
+    for (size_t packetID = 0; packetID != packetCount; ++packetID) {
+        const auto& packet = queue.mDrawPackets[packetID];
+        uint64_t key = packet.mSortLayer;
+        key = (key << sPipelineBits) | pipelines.rank(packet.mPipelineSource);
+        key = (key << sTableBits) | tables.rank(getMaterialTable(queue, packet));
+        key = (key << sMeshBits) | meshes.rank(getDX12MeshBinding(packet.mMesh));
+        key = (key << sPacketBits) | packetID;
+        keys.emplace_back(key);
+    }
+
+    // keep authoring order if any field overflows
+    for (const auto& packet : queue.mDrawPackets) {
+        if (packet.mSortLayer >= (1u << sLayerBits))
+            return;
+    }
+    if (pipelines.size() > (1u << sPipelineBits) ||
+        tables.size() > (1u << sTableBits) ||
+        meshes.size() > (1u << sMeshBits) ||
+        packetCount > (1u << sPacketBits)) {
+        return;
+    }
+
+    radixSort(keys);
+
+    std::pmr::vector<DX12DrawPacket> packets(queue.mDrawPackets.get_allocator());
+    packets.reserve(packetCount);
+    for (const auto& key : keys) {
+        packets.emplace_back(queue.mDrawPackets[key & ((uint64_t(1) << sPacketBits) - 1)]);
+    }
+    queue.mDrawPackets.swap(packets);
+}
+
+}
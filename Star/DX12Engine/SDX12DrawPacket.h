@@ -0,0 +1,30 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <Star/DX12Engine/SDX12Types.h>
+
+namespace Star::Graphics::Render {
+
+// flatten queue contents into draw packets, all layouts are resolved here
+void buildDX12DrawPackets(uint32_t solutionID, uint32_t pipelineID,
+    uint32_t passID, uint32_t subpassID, DX12UnorderedRenderQueue& queue);
+
+// order packets by layer, pipeline state, material table and mesh to minimize state changes
+void sortDX12DrawPackets(DX12UnorderedRenderQueue& queue);
+
+}
@@ -20,13 +20,28 @@
 #include <Star/Graphics/SRenderGraphSerialization.h>
 #include <Star/Graphics/SContentUtils.h>
 #include <Star/Graphics/SRenderFormatTextureUtils.h>
-#include <Star/Graphics/SWindowMessages.h>
+#include <Star/Core/SProfiler.h>
+#include <Star/Core/SAllocationTracker.h>
+#include <Star/Core/SCounters.h>
+#include <Star/Core/SStartupTimeline.h>
+#include <Star/Core/SManagerFwd.h>
 #include "SDX12Utils.h"
 #include <boost/uuid/uuid_io.hpp>
 #include "SDX12Helpers.h"
+#include "SDX12GpuProfiler.h"
 
 namespace Star::Graphics::Render {
 
+namespace {
+
+template<class Create>
+auto timedStartup(std::string_view phase, Create create) {
+    Core::StartupScope scope(phase);
+    return create();
+}
+
+}
+
 DX12Engine::DX12Engine(
     const EngineMemory& memory,
     const Context& context,
@@ -39,52 +54,114 @@ DX12Engine::DX12Engine(
     , mPipelineName(configs.mPipelineName, mMemory.mPool)
     , mTaskWork(std::make_shared<boost::asio::io_context::work>(*context.mTaskService))
     , mFactory(DX12::createFactory())
-    , mDevice(DX12::createDevice(mFactory.get()))
+    , mDevice(timedStartup("device creation", [&]() {
+        return DX12::createDevice(mFactory.get(), configs.mAdapterLuid, configs.mAdapterVendorID,
+            configs.mGpuCrashDiagnostics);
+    }))
+    , mAdapter(DX12::getDeviceAdapter(mFactory.get(), mDevice.get()))
+    , mAdapterLuid(configs.mAdapterLuid)
+    , mAdapterVendorID(configs.mAdapterVendorID)
+    , mAdaptersChangedEvent(DX12::createFenceEvent())
+    , mAdaptersChangedCookie(DX12::registerAdaptersChangedEvent(mFactory.get(), mAdaptersChangedEvent.get()))
+    , mResidency(mDevice.get(), mAdapter.get())
     , mFence(DX12::createFence(mDevice.get(), mCurrentFence, "EngineFence", false))
     , mFenceEvent(DX12::createFenceEvent())
-    , mUploadBufferPool(mDevice.get(), 4 * 1024 * 1024, 8)
-    , mFrameQueue(mDevice.get(), mUploadBufferPool, configs, mMemory.mMonotonic)
+    , mUploadBufferPool(mDevice.get(), gsl::narrow_cast<size_t>(configs.mUploadBlockSize), configs.mUploadBlockCount)
+    , mFrameQueue(mDevice.get(), mUploadBufferPool, context.mJobSystem, configs, mMemory.mMonotonic)
+    , mUploadQueue(mDevice.get(), mFrameQueue.mDirectQueue.get(), mUploadBufferPool, 4)
+    , mCreationUploadBuffer(mUploadBufferPool, 1, 0)
+    , mHeapAllocator(mDevice.get(), &mResidency)
+    , mReservedTextureDimension(configs.mReservedTextureDimension)
+    , mMeshPool(configs.mMeshPooling ? std::make_unique<DX12MeshPool>(mHeapAllocator) : nullptr)
+    , mMaterialConstants(mHeapAllocator)
+    , mPipelineLibrary(configs.mPipelineCaching ?
+        std::make_unique<DX12PipelineLibrary>(mDevice.get(), mFactory.get(), R"(windows2\pipelines.bin)") : nullptr)
+    , mShaderBlobs(R"(windows2\shaders.blob)")
     , mPersistentResources(mMemory.mPool)
+    , mStreaming(configs.mStreamingBudget)
+    , mPipelineCompiler(configs.mAsyncPipelineCompilation ?
+        std::make_unique<DX12PipelineCompiler>(mDevice.get(), mPipelineLibrary.get(), context.mTaskService) : nullptr)
+    , mDescriptorCompactionBudget(configs.mDescriptorCompactionBudget)
+    , mResizeSettleTime(configs.mResizeSettleTime)
+    , mTrackFrameAllocations(configs.mTrackFrameAllocations)
+    , mAssertFrameAllocations(configs.mAssertFrameAllocations)
+    , mTransformWrites(mMemory.mPool)
+    , mWindowSizes(64)
     , mSwapChains(configs.mNumSwapChains, mMemory.mMonotonic)
+    , mFramePacer(configs.mPresentThread)
 {
-
+    mFrameQueue.mRenderThreadArenas = DX12RecordingArenas{
+        mMemory.mPerPass, mMemory.mPerBatch, mMemory.mPerInstance
+    };
+    mFrameQueue.mMaterialConstants = &mMaterialConstants;
+    if (configs.mTilePoolSize && configs.mStreamingBudget) {
+        if (DX12::isTiledResourcesSupported(mDevice.get())) {
+            mTilePool = std::make_unique<DX12TilePool>(mDevice.get(), configs.mTilePoolSize, &mResidency);
+        } else {
+            OutputDebugStringA("WARNING: tiled resources not supported, large textures are placed\n");
+        }
+    }
+    if (configs.mRaytracing) {
+        if (DX12::isDirectXRaytracingSupported(mAdapter.get())) {
+            mAccelerationStructures = std::make_unique<DX12AccelerationStructures>(
+                mDevice.get(), configs.mRaytracingScratchBudget);
+        } else {
+            OutputDebugStringA("WARNING: raytracing not supported, acceleration structures are not built\n");
+        }
+    }
 }
 
-DX12Engine::~DX12Engine() = default;
+DX12Engine::~DX12Engine() {
+    DX12::unregisterAdaptersChangedEvent(mFactory.get(), mAdaptersChangedCookie);
+}
 
 void DX12Engine::stop() {
     Expects(std::this_thread::get_id() == mThreadID);
     mTaskWork.reset();
     waitForGpu();
+    if (mPipelineLibrary) {
+        mPipelineLibrary->save();
+    }
 }
 
-void DX12Engine::start() {
-    Expects(std::this_thread::get_id() == mThreadID);
-
-    {
-        std::ifstream ifs(R"(windows2\settings.star)", std::ios::binary);
-        ifs.exceptions(std::istream::failbit);
-        if (ifs) {
-            PmrBinaryInArchive ia(ifs, mPersistentResources.mSettings.get_allocator().resource());
-            ia >> mPersistentResources.mSettings;
-        }
+void DX12Engine::preload() {
+    STAR_STARTUP_SCOPE("engine settings");
+    std::ifstream ifs(R"(windows2\settings.star)", std::ios::binary);
+    ifs.exceptions(std::istream::failbit);
+    if (ifs) {
+        PmrBinaryInArchive ia(ifs, mPersistentResources.mSettings.get_allocator().resource());
+        ia >> mPersistentResources.mSettings;
     }
+    mPreloaded = true;
+}
 
-    DX12UploadBuffer uploadBuffer(mUploadBufferPool,
-        gsl::narrow_cast<uint32_t>(mFrameQueue.mFrames.size()), 0);
+void DX12Engine::start() {
+    mThreadID = std::this_thread::get_id();
+    if (!mPreloaded) {
+        preload();
+    }
 
     CreationContext creation{ mSolutionName, mPipelineName,
-        mDevice.get(), mFrameQueue.mDirectQueue.get(),
-        mFrameQueue.mFrames.at(mFrameQueue.mNextFrameIndex).mCommandAllocator.get(),
-        mFrameQueue.mFrames.at(mFrameQueue.mNextFrameIndex).mCommandList.get(),
+        mDevice.get(), &mUploadQueue, nullptr, nullptr,
         mMemory.mPerFrame,
         4 * 1024 * 1024, {},
-        &uploadBuffer,
+        &mCreationUploadBuffer,
         &mFrameQueue.mDescriptors,
-        DX12::createFence(mDevice.get(), mCurrentFence, "CreationFence", false),
-        DX12::createFenceEvent()
     };
-
+    creation.mGpuDrivenRendering = static_cast<bool>(mFrameQueue.mIndirectPipeline.mPipelineState);
+    creation.mFrameQueueSize = mFrameQueue.frameSlotCount();
+    creation.mHeapAllocator = &mHeapAllocator;
+    creation.mTilePool = mTilePool.get();
+    creation.mReservedTextureDimension = mReservedTextureDimension;
+    creation.mReleaseQueue = &mReleaseQueue;
+    creation.mMeshPool = mMeshPool.get();
+    creation.mMaterialConstants = &mMaterialConstants;
+    creation.mPipelineLibrary = mPipelineLibrary.get();
+    creation.mPipelineCompiler = mPipelineCompiler.get();
+    creation.mShaderBlobs = &mShaderBlobs;
+
+    using StartupClock = Core::StartupTimeline::clock;
+    auto phaseBegin = StartupClock::now();
     creation.record();
     {
         // default textures
@@ -127,22 +204,73 @@ void DX12Engine::start() {
 #endif
         D3D12_TEXTURE_COPY_LOCATION Src{ buffer.mResource, D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT, layout };
         D3D12_TEXTURE_COPY_LOCATION Dst{ white.mTexture.get(), D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX, 0 };
-        creation.mCommandList->CopyTextureRegion(&Dst, 0, 0, 0, &Src, nullptr);
+        creation.mCopyList->CopyTextureRegion(&Dst, 0, 0, 0, &Src, nullptr);
 
         auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(white.mTexture.get(),
-            D3D12_RESOURCE_STATE_COPY_DEST,
+            CreationContext::sUploadedState,
             D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
         creation.mCommandList->ResourceBarrier(1, &barrier);
+
+        if (mFrameQueue.mDescriptors.getBindlessCapacity()) {
+            createDX12BindlessTextureView(mDevice.get(), mFrameQueue.mDescriptors, white, white);
+        }
     }
     creation.flush();
-    
-
+    Core::StartupTimeline::record("default textures", phaseBegin, StartupClock::now());
 
+    phaseBegin = StartupClock::now();
     creation.mRenderGraph = mRenderGraph;
+    if (mStreaming.enabled()) {
+        creation.mStreaming = &mStreaming;
+    }
+
+    // content uploads are recorded on task threads once everything is created
+    DX12DeferredUploads uploads;
+    if (mFrameQueue.mJobSystem && !creation.mStreaming) {
+        creation.mDeferredUploads = &uploads;
+    }
 
     creation.record();
     try_createDX12(creation, mPersistentResources, mRenderGraph, Core::RenderGraph, false);
-    creation.flush();
+    if (creation.mDeferredUploads) {
+        creation.mDeferredUploads = nullptr;
+        recordDX12Uploads(creation, *mFrameQueue.mJobSystem, uploads);
+    }
+    {
+        // measured on a task thread, startup does not wait for the gpu
+        const auto uploadFence = creation.flush();
+        mFramePacer.whenCompleted(mUploadQueue.batchFence(), uploadFence, *mContext.mTaskService, [phaseBegin]() {
+            Core::StartupTimeline::record("gpu uploads", phaseBegin, StartupClock::now());
+        });
+    }
+
+    // the shader descriptor heap grew to the render graph and contents just created
+    {
+        std::pmr::vector<DX12ShaderDescriptorRelocation> relocations(mMemory.mPerFrame);
+        if (mFrameQueue.mDescriptors.takeGrowthRelocations(relocations)) {
+            relocateDX12ShaderDescriptors(mPersistentResources, relocations);
+        }
+    }
+    Core::StartupTimeline::record("render graph", phaseBegin, StartupClock::now());
+
+#ifdef STAR_DEV
+    {
+        const auto stats = getDX12SharedResourceStats(mDevice.get(), mPersistentResources);
+        auto msg = std::to_string(stats.mContentCount) + " contents: "
+            + std::to_string(stats.mSharedMeshes) + " meshes and "
+            + std::to_string(stats.mSharedTextures) + " textures shared, "
+            + std::to_string(stats.mSharedBytes >> 20) + " MB, "
+            + std::to_string(stats.mUniqueMeshes) + " meshes and "
+            + std::to_string(stats.mUniqueTextures) + " textures unique, "
+            + std::to_string(stats.mUniqueBytes >> 20) + " MB\n";
+        OutputDebugStringA(msg.c_str());
+    }
+#endif
+
+    // psos of the render graph are kept even if the app does not stop cleanly
+    if (mPipelineLibrary) {
+        mPipelineLibrary->save();
+    }
 
     mMemory.mPerFrame->release();
 }
@@ -154,52 +282,330 @@ void DX12Engine::waitForGpu() {
     WaitForSingleObject(mFenceEvent.get(), INFINITE);
 }
 
-void DX12Engine::render(uint32_t id) {
+void DX12Engine::retireFrames(const DX12SwapChain& sc) {
+    if (mFrameQueue.mFence->GetCompletedValue() >= sc.mLastFrameFence)
+        return;
+    V(mFrameQueue.mFence->SetEventOnCompletion(sc.mLastFrameFence, mFenceEvent.get()));
+    DX12::waitForFence(mFrameQueue.mFence.get(), mFenceEvent.get(), sc.mLastFrameFence);
+}
+
+void DX12Engine::applyResize(DX12SwapChain& sc) {
+    Expects(sc.mPendingResize);
+    STAR_PROFILE_SCOPE("DX12Engine::applyResize");
+
+    // back buffers are only referenced by frames of this swapchain
+    retireFrames(sc);
+    sc.try_resize(*sc.mPendingResize);
+    sc.mPendingResize.reset();
+    sc.resizeFramebuffers();
+    mFrameQueue.initPipeline(sc);
+}
+
+void DX12Engine::render() {
     Expects(std::this_thread::get_id() == mThreadID);
+    STAR_PROFILE_SCOPE("DX12Engine::render");
+#ifdef STAR_DEV
+    Core::AllocationTrackingScope allocationTracking(mTrackFrameAllocations,
+        mAssertFrameAllocations && mRenderedFrames >= sAllocationWarmupFrames);
+    if (mRenderedFrames < sAllocationWarmupFrames) {
+        ++mRenderedFrames;
+    }
+#endif
 
-    auto sc = mSwapChains.at(id);
+    applyWindowSizes();
+    updateAdapters();
+
+    // swapchains requested so far are rendered together, their frames are recorded concurrently
+    std::pmr::vector<DX12SwapChain*> swapChains(mMemory.mPerFrame);
+    for (auto& sc : mSwapChains) {
+        if (!sc || !sc->mRenderRequested)
+            continue;
+        sc->mRenderRequested = false;
+
+        // rendered once the first size of its window is applied
+        if (!sc->created()) {
+            continue;
+        }
 
-    if (!sc->created()) {
-        PostMessageA(reinterpret_cast<HWND>(sc->mWindowHandle), WM_STAR_RENDER, int(true), 0);
+        // buffers are resized once the window settled, presented stretched until then
+        if (sc->mPendingResize &&
+            std::chrono::steady_clock::now() - sc->mPendingResizeTime >= mResizeSettleTime) {
+            applyResize(*sc);
+        }
+        swapChains.emplace_back(sc.get());
+    }
+
+    if (swapChains.empty()) {
+        mMemory.mPerFrame->release();
         return;
     }
 
-    auto pFrameContext = mFrameQueue.beginFrame(*sc);
-    mFrameQueue.renderFrame(pFrameContext, mMemory.mPerFrame);
-    mFrameQueue.endFrame(pFrameContext);
+    mUploadBufferPool.trim();
 
-    sc->present();
+    // transforms written during the previous frame, game threads fill the other buffer meanwhile
+    applyDX12TransformWrites(mPersistentResources, mTransformWrites.swap());
 
-    mMemory.mPerFrame->release();
+    // placed memory released by earlier frames is reused once they complete
+    mHeapAllocator.advanceFrame(mFrameQueue.mNextFrameFence, mFrameQueue.mFence->GetCompletedValue());
+    if (mTilePool) {
+        mTilePool->advanceFrame(mFrameQueue.mNextFrameFence, mFrameQueue.mFence->GetCompletedValue());
+    }
 
-    auto work = sc->mWaitWork;
-    auto& service = sc->mWaitService;
-    post(service, [this, sc = std::move(sc), work = std::move(work)]() {
-        if (WaitForSingleObjectEx(sc->mSwapEvent.get(), INFINITE, TRUE)) {
-            throw std::runtime_error("wait for present failed");
+    // streamed uploads are submitted before the frame, which is ordered after them
+    if (!mStreaming.empty()) {
+        CreationContext streaming{ mSolutionName, mPipelineName,
+            mDevice.get(), &mUploadQueue, nullptr, nullptr,
+            mMemory.mPerFrame,
+            4 * 1024 * 1024, mRenderGraph,
+            &mCreationUploadBuffer,
+            &mFrameQueue.mDescriptors,
+        };
+        streaming.mTilePool = mTilePool.get();
+        mStreaming.update(streaming);
+    }
+
+    // rebuilt textures are uploaded like streamed ones and swapped in before the frame once complete
+    if (!mTextureReloads.empty()) {
+        CreationContext reloads{ mSolutionName, mPipelineName,
+            mDevice.get(), &mUploadQueue, nullptr, nullptr,
+            mMemory.mPerFrame,
+            4 * 1024 * 1024, mRenderGraph,
+            &mCreationUploadBuffer,
+            &mFrameQueue.mDescriptors,
+        };
+        reloads.mHeapAllocator = &mHeapAllocator;
+        reloads.mReleaseQueue = &mReleaseQueue;
+        mTextureReloads.update(reloads, mPersistentResources);
+    }
+
+    // builds are recorded after the uploads of their meshes and read by later frames
+    if (mAccelerationStructures &&
+        mAccelerationStructures->isDirty(mPersistentResources, mUploadQueue.completedFence())) {
+        mUploadQueue.record(mCreationUploadBuffer);
+        com_ptr<ID3D12GraphicsCommandList4> commandList4;
+        V(mUploadQueue.directList()->QueryInterface(IID_PPV_ARGS(commandList4.put())));
+        mAccelerationStructures->update(commandList4.get(), mCreationUploadBuffer, mPersistentResources,
+            mUploadQueue.fence(), mUploadQueue.completedFence());
+        mUploadQueue.flush();
+    }
+
+    // psos compiled on task threads are drawn from this frame on
+    bool resolvePipelines = mPipelineCompiler && mPipelineCompiler->update();
+
+    // psos of reloaded shaders are compiled beside the live ones and swapped in once all are done
+    if (!mShaderReloads.empty()) {
+        CreationContext reloads{ mSolutionName, mPipelineName,
+            mDevice.get(), &mUploadQueue, nullptr, nullptr,
+            mMemory.mPerFrame,
+            4 * 1024 * 1024, mRenderGraph,
+            &mCreationUploadBuffer,
+            &mFrameQueue.mDescriptors,
+        };
+        reloads.mReleaseQueue = &mReleaseQueue;
+        reloads.mPipelineLibrary = mPipelineLibrary.get();
+        reloads.mPipelineCompiler = mPipelineCompiler.get();
+        reloads.mShaderBlobs = &mShaderBlobs;
+        resolvePipelines |= mShaderReloads.update(reloads, mPersistentResources);
+    }
+    if (resolvePipelines) {
+        resolveDX12PipelineStates(mPersistentResources);
+    }
+
+    // frames bind the grown heap, descriptors created since the last frame are switched to it first
+    mFrameQueue.mDescriptors.reserveSpilled();
+    {
+        std::pmr::vector<DX12ShaderDescriptorRelocation> relocations(mMemory.mPerFrame);
+        if (mFrameQueue.mDescriptors.takeGrowthRelocations(relocations)) {
+            relocateDX12ShaderDescriptors(mPersistentResources, relocations);
         }
-        PostMessageA(reinterpret_cast<HWND>(sc->mWindowHandle), WM_STAR_RENDER, int(true), 0);
-    });
+    }
+
+    // streaming in and out leaves sparse persistent blocks, return them to the pool
+    if (mDescriptorCompactionBudget) {
+        std::pmr::vector<DX12ShaderDescriptorRelocation> relocations(mMemory.mPerFrame);
+        if (mFrameQueue.mDescriptors.compactPersistent(mDescriptorCompactionBudget, relocations)) {
+            relocateDX12ShaderDescriptors(mPersistentResources, relocations);
+        }
+    }
+
+    std::pmr::vector<const DX12FrameContext*> frames(mMemory.mPerFrame);
+    frames.reserve(swapChains.size());
+    for (auto* sc : swapChains) {
+        frames.emplace_back(mFrameQueue.acquireFrame(*sc));
+    }
+
+    // input sampled right before culling reaches the screen with this frame
+    if (mFrameCallback) {
+        for (const auto* sc : swapChains) {
+            mFrameCallback(sc->mID, mFrameQueue.mCameras.front());
+        }
+    }
+    // gpu hangs surface as device removal on submit or present, the report names the subpasses in flight
+    try {
+        mFrameQueue.renderFrames(frames, mMemory.mPerFrame);
+        for (size_t i = 0; i != frames.size(); ++i) {
+            mFrameQueue.endFrame(frames[i]);
+            presentFrame(*swapChains[i], frames[i]->mFrameFenceId);
+        }
+    } catch (const winrt::hresult_error& e) {
+        if (e.code() == DXGI_ERROR_DEVICE_REMOVED || e.code() == DXGI_ERROR_DEVICE_RESET ||
+            e.code() == DXGI_ERROR_DEVICE_HUNG) {
+            reportDeviceRemoved(mDevice.get(), mFrameQueue.mBreadcrumbs.get());
+        }
+        throw;
+    }
+    // previous world view constants of the next frame are relative to these views
+    mFrameQueue.mPrevCameras = mFrameQueue.mCameras;
+
+    // resources released meanwhile may be used by the frames just submitted
+    mReleaseQueue.advanceFrame(mFrameQueue.mNextFrameFence, mFrameQueue.mFence->GetCompletedValue());
+
+    // framebuffers and upload blocks are counted, heaps no frame in flight reads are evicted under pressure
+    for (const auto* sc : swapChains) {
+        const auto& rw = sc->mRenderGraph->mRenderGraph;
+        mResidency.setSize(&rw, DX12FramebufferMemory, rw.mFramebufferSize);
+    }
+    mResidency.setSize(&mUploadBufferPool, DX12UploadMemory,
+        uint64_t(mUploadBufferPool.blockCount()) * mUploadBufferPool.getMaxBufferSize());
+    mResidency.update(mFrameQueue.mFence->GetCompletedValue());
+
+    // resources cached by the residency budget are evicted under pressure
+    const auto& memoryInfo = mResidency.memoryInfo();
+    if (memoryInfo.Budget) {
+        Core::Workflow::reportVideoMemory(memoryInfo.Budget, memoryInfo.CurrentUsage);
+    }
+
+    // recording jobs of the frames have finished, their counts are complete
+    Core::Counters::endFrame();
+
+    mMemory.mPerFrame->release();
+}
+
+void DX12Engine::updateAdapters() {
+    if (!mAdaptersChangedCookie || WaitForSingleObject(mAdaptersChangedEvent.get(), 0) != WAIT_OBJECT_0)
+        return;
+
+    // adapters of a stale factory are not enumerated again
+    if (!mFactory->IsCurrent()) {
+        DX12::unregisterAdaptersChangedEvent(mFactory.get(), mAdaptersChangedCookie);
+        mFactory = DX12::createFactory();
+        mAdaptersChangedCookie = DX12::registerAdaptersChangedEvent(mFactory.get(), mAdaptersChangedEvent.get());
+    }
+
+    // a removed adapter fails the device, which is reported by its next use
+    com_ptr<IDXGIAdapter3> adapter;
+    if (FAILED(mFactory->EnumAdapterByLuid(mDevice->GetAdapterLuid(), IID_PPV_ARGS(adapter.put()))))
+        return;
+    mAdapter = adapter;
+    mResidency.setAdapter(mAdapter.get());
+
+    auto preferred = DX12::getHardwareAdapter(mFactory.get(), mAdapterLuid, mAdapterVendorID);
+    if (DX12::getAdapterLuid(preferred.get()) != DX12::getAdapterLuid(mAdapter.get())) {
+        OutputDebugStringA("WARNING: a preferred adapter was added, it renders once the engine is restarted\n");
+    }
+}
+
+void DX12Engine::presentFrame(DX12SwapChain& sc, uint64_t frameFence) {
+    sc.mLastFrameFence = frameFence;
+    sc.mFrameFences[sc.mNextFrameFence] = frameFence;
+    sc.mNextFrameFence = (sc.mNextFrameFence + 1) % DX12SwapChain::sNumFrameFences;
+
+    sc.present();
+
+#ifdef STAR_DEV
+    if (sc.mNumPresentIntervals == DX12SwapChain::sNumPresentIntervals && sc.mNextPresentInterval == 0) {
+        auto stats = sc.presentStatistics();
+        auto msg = std::string("SwapChain ") + sc.mName
+            + ": present interval " + std::to_string(stats.mMeanInterval)
+            + " ms, jitter " + std::to_string(stats.mJitter)
+            + " ms, min " + std::to_string(stats.mMinInterval)
+            + " ms, max " + std::to_string(stats.mMaxInterval) + " ms\n";
+        OutputDebugStringA(msg.c_str());
+    }
+#endif
+
+    // offscreen frames are rendered when requested, the frame queue bounds their latency
+    if (sc.offscreen())
+        return;
+
+    // next frame is rendered once a latency slot is free, window messages are not involved,
+    // so modal loops and message backlogs of the window thread do not stall frames
+    auto onReady = [this, id = sc.mID]() {
+        requestRender(id);
+    };
+    if (sc.mSwapEvent) {
+        mFramePacer.wait(sc.mID, sc.mSwapEvent.get(), std::move(onReady));
+    } else {
+        // wait for the frame of this swapchain presented latency - 1 frames ago
+        uint32_t latency = std::clamp(sc.mMaxFrameLatency, 1u, DX12SwapChain::sNumFrameFences);
+        uint32_t slot = (sc.mNextFrameFence + DX12SwapChain::sNumFrameFences - latency) % DX12SwapChain::sNumFrameFences;
+        mFramePacer.waitFence(sc.mID, mFrameQueue.mFence.get(), sc.mFrameFences[slot], std::move(onReady));
+    }
 }
 
 void DX12Engine::resizeSwapChain(uint32_t id, const SwapChainContext& sc) {
-    post(*mContext.mRenderStrand, [=]() {
-        Expects(std::this_thread::get_id() == mThreadID);
-        Expects(mSwapChains[id]);
+    // a full queue is drained before this size is applied, sizes stay in order
+    if (!mWindowSizes.push(WindowSize{ id, sc })) {
+        post(*mContext.mRenderStrand, [=]() {
+            applyWindowSizes();
+            applyWindowSize(id, sc);
+        });
+        return;
+    }
+    // windows not rendered yet have no frame draining their sizes
+    if (!mWindowSizesPosted.exchange(true, std::memory_order_acq_rel)) {
+        post(*mContext.mRenderStrand, [this]() {
+            applyWindowSizes();
+        });
+    }
+}
+
+void DX12Engine::applyWindowSizes() {
+    Expects(std::this_thread::get_id() == mThreadID);
+    // sizes pushed after the flag is cleared post another drain
+    mWindowSizesPosted.store(false, std::memory_order_release);
+    mWindowSizes.consume_all([this](const WindowSize& size) {
+        applyWindowSize(size.mID, size.mContext);
+    });
+}
 
-        if (mSwapChains[id]->created()) {
-            Expects(mSwapChains[id]->mSwapChain);
-            // TODO: here we have some performance issue
-            if (mSwapChains[id]->try_resize(sc)) {
-                waitForGpu();
-                mSwapChains[id]->resizeFramebuffers();
-                mFrameQueue.initPipeline(*mSwapChains[id]);
+void DX12Engine::applyWindowSize(uint32_t id, const SwapChainContext& sc) {
+    Expects(std::this_thread::get_id() == mThreadID);
+    Expects(mSwapChains[id]);
+
+    if (mSwapChains[id]->created()) {
+        auto& swapChain = *mSwapChains[id];
+        swapChain.setFramePacing(sc.mMaxFrameLatency, sc.mSyncInterval, sc.mAllowTearing);
+        if (swapChain.needsResize(sc)) {
+            // resized by a later frame, repeated resizes while dragging are coalesced
+            swapChain.mPendingResize = sc;
+            swapChain.mPendingResizeTime = std::chrono::steady_clock::now();
+            if (mResizeSettleTime.count() == 0) {
+                applyResize(swapChain);
             }
         } else {
-            mSwapChains[id]->try_resize(sc);
-            mSwapChains[id]->createFramebuffers(mFactory.get(), mDevice.get(), mFrameQueue.mDirectQueue.get());
-            mFrameQueue.initPipeline(*mSwapChains[id]);
+            // window went back to the current size
+            swapChain.mPendingResize.reset();
+        }
+    } else {
+        mSwapChains[id]->try_resize(sc);
+        mSwapChains[id]->createFramebuffers(mFactory.get(), mDevice.get(), mFrameQueue.mDirectQueue.get());
+        mFrameQueue.initPipeline(*mSwapChains[id]);
+        // first frame of the window, later frames are requested by the frame pacer
+        if (!mSwapChains[id]->offscreen()) {
+            requestRender(id);
         }
+    }
+}
+
+void DX12Engine::requestRender(uint32_t id) {
+    post(*mContext.mRenderStrand, [this, id]() {
+        Expects(std::this_thread::get_id() == mThreadID);
+        // stopped meanwhile
+        if (!mSwapChains.at(id))
+            return;
+        mSwapChains[id]->mRenderRequested = true;
+        render();
     });
 }
 
@@ -213,16 +619,10 @@ void DX12Engine::startSwapChain(uint32_t id, void* hWnd) {
         sc = std::make_shared<DX12SwapChain>(mDevice.get(), mMemory,
             boost::intrusive_ptr<DX12RenderGraphData>(const_cast<DX12RenderGraphData*>(&*iter)));
 
-        sc->mCurrentSolution = mSolutionName;
-        sc->mCurrentPipeline = mPipelineName;
+        sc->setCurrentPipeline(mSolutionName, mPipelineName);
 
         sc->mWindowHandle = hWnd;
-
-        sc->mWaitThread = std::thread([sc]() {
-            sc->mWaitService.run();
-        });
-
-        PostMessageA(reinterpret_cast<HWND>(sc->mWindowHandle), WM_STAR_RENDER, int(true), 0);
+        sc->mID = id;
     });
 }
 
@@ -231,9 +631,8 @@ void DX12Engine::stopSwapChain(uint32_t id) {
         Expects(std::this_thread::get_id() == mThreadID);
         auto& sc = mSwapChains.at(id);
         Expects(sc);
-        sc->mWaitWork.reset();
-        sc->mWaitThread.join();
-        waitForGpu();
+        mFramePacer.cancel(id);
+        retireFrames(*sc);
         sc.reset();
     });
 }
@@ -241,8 +640,133 @@ void DX12Engine::stopSwapChain(uint32_t id) {
 void DX12Engine::renderSwapChain(uint32_t id) {
     post(*mContext.mRenderStrand, [=]() {
         Expects(std::this_thread::get_id() == mThreadID);
-        render(id);
+        Expects(mSwapChains.at(id));
+        mSwapChains[id]->mRenderRequested = true;
+        render();
     });
 }
 
+void DX12Engine::setFramePacing(uint32_t id, uint32_t maxFrameLatency,
+    uint32_t syncInterval, bool allowTearing
+) {
+    post(*mContext.mRenderStrand, [=]() {
+        Expects(std::this_thread::get_id() == mThreadID);
+        Expects(mSwapChains[id]);
+        mSwapChains[id]->setFramePacing(maxFrameLatency, syncInterval, allowTearing);
+    });
+}
+
+void DX12Engine::setCurrentPipeline(uint32_t id, std::string_view solutionName, std::string_view pipelineName) {
+    post(*mContext.mRenderStrand, [this, id,
+        solutionName = std::string(solutionName), pipelineName = std::string(pipelineName)
+    ]() {
+        Expects(std::this_thread::get_id() == mThreadID);
+        Expects(mSwapChains[id]);
+        auto& sc = *mSwapChains[id];
+        if (sc.mCurrentSolution == solutionName && sc.mCurrentPipeline == pipelineName)
+            return;
+
+        if (!sc.created()) {
+            sc.setCurrentPipeline(solutionName, pipelineName);
+            return;
+        }
+        STAR_PROFILE_SCOPE("DX12Engine::setCurrentPipeline");
+        // render targets of the solution are only referenced by frames of this swapchain
+        retireFrames(sc);
+        sc.switchPipeline(solutionName, pipelineName);
+        mFrameQueue.initPipeline(sc);
+    });
+}
+
+void DX12Engine::enableEventMarkers(bool enabled) {
+    post(*mContext.mRenderStrand, [=]() {
+        Expects(std::this_thread::get_id() == mThreadID);
+        mFrameQueue.enableEventMarkers(enabled);
+    });
+}
+
+void DX12Engine::setLodBias(float bias) {
+    post(*mContext.mRenderStrand, [=]() {
+        Expects(std::this_thread::get_id() == mThreadID);
+        mFrameQueue.mLodBias = bias;
+    });
+}
+
+void DX12Engine::setShaderLevel(uint32_t level) {
+    post(*mContext.mRenderStrand, [=]() {
+        Expects(std::this_thread::get_id() == mThreadID);
+        mFrameQueue.mShaderLevel = level;
+    });
+}
+
+void DX12Engine::setResolutionBudget(float milliseconds) {
+    post(*mContext.mRenderStrand, [=]() {
+        Expects(std::this_thread::get_id() == mThreadID);
+        mFrameQueue.mResolutionScaler.setBudget(milliseconds);
+    });
+}
+
+void DX12Engine::setCamera(const CameraData& camera) {
+    post(*mContext.mRenderStrand, [this, camera]() {
+        Expects(std::this_thread::get_id() == mThreadID);
+        mFrameQueue.mCameras.front() = camera;
+    });
+}
+
+void DX12Engine::setFrameCallback(FrameCallback callback) {
+    post(*mContext.mRenderStrand, [this, callback = std::move(callback)]() mutable {
+        Expects(std::this_thread::get_id() == mThreadID);
+        mFrameCallback = std::move(callback);
+    });
+}
+
+void DX12Engine::setCameras(gsl::span<const CameraData> views) {
+    Expects(!views.empty());
+    post(*mContext.mRenderStrand, [this, views = std::vector<CameraData>(views.begin(), views.end())]() mutable {
+        Expects(std::this_thread::get_id() == mThreadID);
+        mFrameQueue.mCameras = std::move(views);
+    });
+}
+
+void DX12Engine::setPointLights(gsl::span<const PointLightData> lights) {
+    post(*mContext.mRenderStrand, [this, lights = std::vector<PointLightData>(lights.begin(), lights.end())]() mutable {
+        Expects(std::this_thread::get_id() == mThreadID);
+        mFrameQueue.mPointLights = std::move(lights);
+    });
+}
+
+void DX12Engine::setObjectTransform(const ObjectHandle& object, const Affine3f& world) {
+    mTransformWrites.write(object, world);
+}
+
+void DX12Engine::reloadTextures(gsl::span<const MetaID> textures) {
+    post(*mContext.mRenderStrand, [this, textures = std::vector<MetaID>(textures.begin(), textures.end())]() {
+        Expects(std::this_thread::get_id() == mThreadID);
+        for (const auto& metaID : textures) {
+            mTextureReloads.enqueue(metaID);
+        }
+    });
+}
+
+void DX12Engine::reloadShaders(gsl::span<const MetaID> shaders) {
+    post(*mContext.mRenderStrand, [this, shaders = std::vector<MetaID>(shaders.begin(), shaders.end())]() {
+        Expects(std::this_thread::get_id() == mThreadID);
+        for (const auto& metaID : shaders) {
+            mShaderReloads.enqueue(metaID);
+        }
+    });
+}
+
+double DX12Engine::getGpuTimings(std::pmr::vector<GpuTiming>& subpasses) const {
+    Expects(std::this_thread::get_id() == mThreadID);
+    if (!mFrameQueue.mGpuProfiler)
+        return 0;
+
+    const auto& profiler = *mFrameQueue.mGpuProfiler;
+    for (const auto& timing : profiler.timings()) {
+        subpasses.emplace_back(GpuTiming{ timing.mName, timing.mMilliseconds, timing.mStatistics });
+    }
+    return profiler.frameMilliseconds();
+}
+
 }
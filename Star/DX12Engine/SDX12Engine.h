@@ -20,6 +20,23 @@
 #include <Star/DX12Engine/SDX12Types.h>
 #include <Star/DX12Engine/SDX12SwapChain.h>
 #include <Star/DX12Engine/SDX12FrameQueue.h>
+#include <Star/DX12Engine/SDX12UploadQueue.h>
+#include <Star/DX12Engine/SDX12Streaming.h>
+#include <Star/DX12Engine/SDX12TextureReload.h>
+#include <Star/DX12Engine/SDX12ShaderReload.h>
+#include <Star/DX12Engine/SDX12HeapAllocator.h>
+#include <Star/DX12Engine/SDX12MeshPool.h>
+#include <Star/DX12Engine/SDX12MaterialConstants.h>
+#include <Star/DX12Engine/SDX12Raytracing.h>
+#include <Star/DX12Engine/SDX12TilePool.h>
+#include <Star/DX12Engine/SDX12Residency.h>
+#include <Star/DX12Engine/SDX12ReleaseQueue.h>
+#include <Star/DX12Engine/SDX12PipelineLibrary.h>
+#include <Star/DX12Engine/SDX12PipelineCompiler.h>
+#include <Star/DX12Engine/SDX12ShaderBlobStore.h>
+#include <Star/DX12Engine/SDX12FramePacer.h>
+#include <Star/DX12Engine/SDX12Transforms.h>
+#include <Star/SLockFree.h>
 #include <Star/Graphics/SContentTypes.h>
 
 namespace Star::Graphics::Render {
@@ -31,6 +48,7 @@ public:
     DX12Engine& operator=(const DX12Engine&) = delete;
     ~DX12Engine();
 
+    void preload() override;
     void start() override;
     void stop() override;
 
@@ -38,9 +56,37 @@ public:
     void startSwapChain(uint32_t id, void* hWnd) override;
     void stopSwapChain(uint32_t id) override;
     void renderSwapChain(uint32_t id) override;
+    void setFramePacing(uint32_t id, uint32_t maxFrameLatency,
+        uint32_t syncInterval, bool allowTearing) override;
+    void setCurrentPipeline(uint32_t id, std::string_view solutionName, std::string_view pipelineName) override;
+
+    void enableEventMarkers(bool enabled) override;
+    void setLodBias(float bias) override;
+    void setShaderLevel(uint32_t level) override;
+    void setResolutionBudget(float milliseconds) override;
+    void setCamera(const CameraData& camera) override;
+    void setCameras(gsl::span<const CameraData> views) override;
+    void setFrameCallback(FrameCallback callback) override;
+    void setPointLights(gsl::span<const PointLightData> lights) override;
+    void setObjectTransform(const ObjectHandle& object, const Affine3f& world) override;
+    void reloadTextures(gsl::span<const MetaID> textures) override;
+    void reloadShaders(gsl::span<const MetaID> shaders) override;
+    double getGpuTimings(std::pmr::vector<GpuTiming>& subpasses) const override;
 private:
     void waitForGpu();
-    void render(uint32_t id);
+    // waits for frames of the swapchain only
+    void retireFrames(const DX12SwapChain& sc);
+    void applyResize(DX12SwapChain& sc);
+    // sizes pushed by window threads, applied in order on render thread
+    void applyWindowSizes();
+    void applyWindowSize(uint32_t id, const SwapChainContext& sc);
+    // posts a frame of the swapchain to the render strand, called by the frame pacer thread
+    void requestRender(uint32_t id);
+    // renders every requested swapchain
+    void render();
+    // adapters added or removed, the device keeps its adapter until the engine is restarted
+    void updateAdapters();
+    void presentFrame(DX12SwapChain& sc, uint64_t frameFence);
 
     std::thread::id mThreadID = {};
     EngineMemory mMemory;
@@ -56,6 +102,15 @@ private:
 
     // Device 
     com_ptr<ID3D12Device> mDevice;
+    // queried for video memory pressure
+    com_ptr<IDXGIAdapter3> mAdapter;
+    uint64_t mAdapterLuid = 0;
+    uint32_t mAdapterVendorID = 0;
+    // signaled by the factory when adapters are added or removed, unregistered if cookie is 0
+    winrt::handle mAdaptersChangedEvent;
+    DWORD mAdaptersChangedCookie = 0;
+    // video memory by category, evicts cold heaps, outlives the heaps it tracks
+    DX12ResidencyManager mResidency;
 
     // EngineFence
     com_ptr<ID3D12Fence> mFence;
@@ -68,11 +123,67 @@ private:
     // FrameQueue
     DX12FrameQueue mFrameQueue;
 
+    // Uploads, submitted to the copy queue without waiting
+    DX12UploadQueue mUploadQueue;
+    DX12UploadBuffer mCreationUploadBuffer;
+
+    // Placed memory of meshes and textures, outlives resources
+    DX12HeapAllocator mHeapAllocator;
+    // tiles of reserved textures, empty if disabled or not supported
+    std::unique_ptr<DX12TilePool> mTilePool;
+    uint32_t mReservedTextureDimension = 0;
+    // empty if mesh pooling is disabled
+    std::unique_ptr<DX12MeshPool> mMeshPool;
+    // constants of all materials, indexed by draws
+    DX12MaterialConstantPool mMaterialConstants;
+    // psos of previous runs, empty if pipeline caching is disabled
+    std::unique_ptr<DX12PipelineLibrary> mPipelineLibrary;
+    // mapped while psos of created shaders are built
+    DX12ShaderBlobStore mShaderBlobs;
+
+    // resources released by meshes and textures, freed after them once frames are done
+    DX12ReleaseQueue mReleaseQueue;
+
     // Resources
     DX12Resources mPersistentResources;
+    // holds streamed resources, released before them
+    DX12StreamingQueue mStreaming;
+    // holds reloaded textures, released before them
+    DX12TextureReloadQueue mTextureReloads;
+    // holds pipeline states of reloaded shaders compiled by mPipelineCompiler, released after it
+    DX12ShaderReloadQueue mShaderReloads;
+    // built from resources on the upload queue, released before them, empty if disabled or not supported
+    std::unique_ptr<DX12AccelerationStructures> mAccelerationStructures;
+    // compiles psos of created shaders, released before resources, empty if disabled
+    std::unique_ptr<DX12PipelineCompiler> mPipelineCompiler;
+    uint32_t mDescriptorCompactionBudget = 0;
+    std::chrono::milliseconds mResizeSettleTime = {};
+
+    // frame containers grow to their peaks during warmup, later frames are expected not to allocate
+    static constexpr uint32_t sAllocationWarmupFrames = 64;
+    bool mTrackFrameAllocations = false;
+    bool mAssertFrameAllocations = false;
+    bool mPreloaded = false;
+    uint32_t mRenderedFrames = 0;
+
+    // object transforms written by game threads
+    DX12TransformWriteBuffer mTransformWrites;
+    // render thread only
+    FrameCallback mFrameCallback;
+
+    // window sizes written by window threads, which never wait on the render thread
+    // one drain is posted at a time, frames drain the queue before rendering too
+    struct WindowSize {
+        uint32_t mID = 0;
+        SwapChainContext mContext;
+    };
+    RingQueue<WindowSize> mWindowSizes;
+    std::atomic_bool mWindowSizesPosted = false;
 
     // SwapChains    
     std::pmr::vector<std::shared_ptr<DX12SwapChain>> mSwapChains;
+    // waits on latency objects of swapchains, stopped before they are released
+    DX12FramePacer mFramePacer;
 };
 
 }
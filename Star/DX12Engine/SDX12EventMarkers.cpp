@@ -0,0 +1,104 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "SDX12EventMarkers.h"
+#include <boost/uuid/uuid_io.hpp>
+
+namespace Star::Graphics::Render {
+
+namespace {
+
+template<class Map>
+std::wstring findName(const Map& index, uint32_t id) {
+    for (const auto& [name, value] : index) {
+        if (value == id) {
+            return fromUTF8(std::string_view(name));
+        }
+    }
+    return std::to_wstring(id);
+}
+
+}
+
+void DX12EventMarkers::update(const DX12RenderWorks& rg, uint32_t solutionID, uint32_t pipelineID) {
+    const auto& solution = rg.mSolutions.at(solutionID);
+    const auto& pipeline = solution.mPipelines.at(pipelineID);
+
+    // render graph names only change with the pipeline
+    if (mPipeline != &pipeline) {
+        mPipeline = &pipeline;
+        mFrame = findName(rg.mSolutionIndex, solutionID) + L"/" + findName(solution.mPipelineIndex, pipelineID);
+
+        mPasses.clear();
+        mSubpasses.clear();
+        size_t queueCount = 0;
+        for (uint32_t passID = 0; passID != pipeline.mPasses.size(); ++passID) {
+            const auto& pass = pipeline.mPasses[passID];
+            auto& subpasses = mSubpasses.emplace_back();
+            for (uint32_t subpassID = 0; subpassID != pass.mGraphicsSubpasses.size(); ++subpassID) {
+                subpasses.emplace_back(L"Subpass " + std::to_wstring(subpassID));
+                queueCount = std::max(queueCount, pass.mGraphicsSubpasses[subpassID].mOrderedRenderQueue.size());
+            }
+        }
+        for (const auto& [name, desc] : pipeline.mSubpassIndex) {
+            if (desc.mPassID < mSubpasses.size() && desc.mSubpassID < mSubpasses[desc.mPassID].size()) {
+                mSubpasses[desc.mPassID][desc.mSubpassID] = fromUTF8(std::string_view(name));
+            }
+        }
+        // passes are unnamed in render graph, named after their first subpass
+        for (uint32_t passID = 0; passID != mSubpasses.size(); ++passID) {
+            auto name = L"Pass " + std::to_wstring(passID);
+            if (!mSubpasses[passID].empty()) {
+                name += L": " + mSubpasses[passID].front();
+            }
+            mPasses.emplace_back(std::move(name));
+        }
+
+        mQueues.clear();
+        for (size_t queueID = 0; queueID != queueCount; ++queueID) {
+            mQueues.emplace_back(L"Queue " + std::to_wstring(queueID));
+        }
+    }
+
+    mBatches.clear();
+    for (const auto& pass : pipeline.mPasses) {
+        for (const auto& subpass : pass.mGraphicsSubpasses) {
+            for (const auto& queue : subpass.mOrderedRenderQueue) {
+                for (const auto& pContent : queue.mContents) {
+                    if (pContent->mFlattenedObjects.empty()) {
+                        continue;
+                    }
+                    auto name = L"Content " + boost::uuids::to_wstring(pContent->mMetaID);
+                    for (const auto& batch : pContent->mFlattenedObjects) {
+                        mBatches.try_emplace(&batch, name);
+                    }
+                }
+            }
+        }
+    }
+}
+
+const std::wstring& DX12EventMarkers::batch(const DX12FlattenedObjects* pBatch) const {
+    auto iter = mBatches.find(pBatch);
+    if (iter == mBatches.end()) {
+        return mUnknownBatch;
+    }
+    return iter->second;
+}
+
+}
@@ -0,0 +1,75 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+#include <Star/DX12Engine/SDX12Types.h>
+
+namespace Star::Graphics::Render {
+
+// gpu debugger event, legacy pix encoding of a null terminated wide string
+// decoded by pix and renderdoc without WinPixEventRuntime
+class DX12EventScope {
+public:
+    DX12EventScope(ID3D12GraphicsCommandList* pCommandList, const std::wstring& name) noexcept
+        : mCommandList(pCommandList)
+    {
+        mCommandList->BeginEvent(0, name.c_str(),
+            gsl::narrow_cast<uint32_t>((name.size() + 1) * sizeof(wchar_t)));
+    }
+    DX12EventScope(const DX12EventScope&) = delete;
+    DX12EventScope& operator=(const DX12EventScope&) = delete;
+
+    ~DX12EventScope() noexcept {
+        mCommandList->EndEvent();
+    }
+private:
+    ID3D12GraphicsCommandList* mCommandList = nullptr;
+};
+
+// event names of the current pipeline, taken from render graph solution, pipeline and subpass names
+// updated on render thread before recording, read by recording threads
+class DX12EventMarkers {
+public:
+    void update(const DX12RenderWorks& rg, uint32_t solutionID, uint32_t pipelineID);
+
+    const std::wstring& frame() const noexcept {
+        return mFrame;
+    }
+    const std::wstring& pass(uint32_t passID) const {
+        return mPasses.at(passID);
+    }
+    const std::wstring& subpass(uint32_t passID, uint32_t subpassID) const {
+        return mSubpasses.at(passID).at(subpassID);
+    }
+    const std::wstring& queue(uint32_t queueID) const {
+        return mQueues.at(queueID);
+    }
+    // content of the batch, draws without batch share one name
+    const std::wstring& batch(const DX12FlattenedObjects* pBatch) const;
+private:
+    const DX12RenderPipeline* mPipeline = nullptr;
+    std::wstring mFrame;
+    std::vector<std::wstring> mPasses;
+    std::vector<std::vector<std::wstring>> mSubpasses;
+    std::vector<std::wstring> mQueues;
+    std::wstring mUnknownBatch = L"Batch";
+    // contents are streamed in and out, rebuilt every update
+    std::unordered_map<const DX12FlattenedObjects*, std::wstring> mBatches;
+};
+
+}
@@ -0,0 +1,200 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "SDX12FramePacer.h"
+
+namespace Star::Graphics::Render {
+
+DX12FramePacer::DX12FramePacer(const ThreadPolicy& policy)
+    : mWakeEvent(CreateEvent(nullptr, FALSE, FALSE, nullptr))
+{
+    if (!mWakeEvent) {
+        winrt::throw_last_error();
+    }
+    mThread = std::thread([this, policy]() {
+        ThreadScope scope("Frame pacer", policy);
+        run();
+    });
+}
+
+DX12FramePacer::~DX12FramePacer() {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopped = true;
+        mWaits.clear();
+        mFenceWaits.clear();
+    }
+    SetEvent(mWakeEvent.get());
+    mThread.join();
+}
+
+void DX12FramePacer::wait(uint32_t id, HANDLE handle, std::function<void()> callback) {
+    Expects(handle);
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (mWaits.size() + mFenceWaits.size() + 1 >= MAXIMUM_WAIT_OBJECTS) {
+            throw std::runtime_error("too many frame pacing waits");
+        }
+        mWaits.emplace_back(Wait{ id, mNextSerial++, handle, std::move(callback) });
+    }
+    SetEvent(mWakeEvent.get());
+}
+
+void DX12FramePacer::waitFence(uint32_t id, ID3D12Fence* pFence, uint64_t value, std::function<void()> callback) {
+    auto& fenceEvent = mFenceEvents[id];
+    if (!fenceEvent) {
+        fenceEvent.attach(CreateEvent(nullptr, FALSE, FALSE, nullptr));
+        if (!fenceEvent) {
+            winrt::throw_last_error();
+        }
+    }
+    V(pFence->SetEventOnCompletion(value, fenceEvent.get()));
+    wait(id, fenceEvent.get(), std::move(callback));
+}
+
+void DX12FramePacer::cancel(uint32_t id) {
+    {
+        // callbacks run under the lock
+        std::unique_lock<std::mutex> lock(mMutex);
+        mWaits.erase(std::remove_if(mWaits.begin(), mWaits.end(), [id](const Wait& w) {
+            return w.mID == id;
+        }), mWaits.end());
+
+        // the pacer thread might still wait on handles of the swapchain, let it retake them
+        auto target = mSnapshotCount + 1;
+        SetEvent(mWakeEvent.get());
+        mSnapshotTaken.wait(lock, [&]() {
+            return mSnapshotCount >= target || mStopped;
+        });
+    }
+    mFenceEvents.erase(id);
+}
+
+void DX12FramePacer::whenCompleted(ID3D12Fence* pFence, uint64_t value,
+    boost::asio::io_context& executor, std::function<void()> continuation
+) {
+    Expects(pFence);
+    if (pFence->GetCompletedValue() >= value) {
+        boost::asio::post(executor, std::move(continuation));
+        return;
+    }
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto iter = mFenceWaits.find(pFence);
+        if (iter == mFenceWaits.end()) {
+            if (mWaits.size() + mFenceWaits.size() + 1 >= MAXIMUM_WAIT_OBJECTS) {
+                throw std::runtime_error("too many fences waited on");
+            }
+            iter = mFenceWaits.emplace(pFence, FenceWaits{}).first;
+            iter->second.mEvent.attach(CreateEvent(nullptr, FALSE, FALSE, nullptr));
+            if (!iter->second.mEvent) {
+                mFenceWaits.erase(iter);
+                winrt::throw_last_error();
+            }
+        }
+        auto& waits = iter->second;
+        wake = waits.mContinuations.empty();
+        const bool lowest = wake || value < waits.mContinuations.begin()->first;
+        waits.mContinuations.emplace(value, Continuation{ &executor, std::move(continuation) });
+        if (lowest) {
+            V(pFence->SetEventOnCompletion(value, waits.mEvent.get()));
+        }
+    }
+    // the fence joins the handles waited on
+    if (wake) {
+        SetEvent(mWakeEvent.get());
+    }
+}
+
+void DX12FramePacer::completeFence(ID3D12Fence* pFence) {
+    auto iter = mFenceWaits.find(pFence);
+    if (iter == mFenceWaits.end())
+        return;
+    auto& waits = iter->second.mContinuations;
+    const auto completed = pFence->GetCompletedValue();
+    auto end = waits.upper_bound(completed);
+    for (auto c = waits.begin(); c != end; ++c) {
+        boost::asio::post(*c->second.mExecutor, std::move(c->second.mCallback));
+    }
+    waits.erase(waits.begin(), end);
+    if (!waits.empty()) {
+        // signals at once if the fence has moved on meanwhile
+        V(pFence->SetEventOnCompletion(waits.begin()->first, iter->second.mEvent.get()));
+    }
+}
+
+void DX12FramePacer::run() {
+    std::array<HANDLE, MAXIMUM_WAIT_OBJECTS> handles{};
+    std::array<uint64_t, MAXIMUM_WAIT_OBJECTS> serials{};
+    // null for waits of swapchains
+    std::array<ID3D12Fence*, MAXIMUM_WAIT_OBJECTS> fences{};
+    handles[0] = mWakeEvent.get();
+
+    for (;;) {
+        DWORD count = 1;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (mStopped)
+                return;
+            for (const auto& w : mWaits) {
+                handles[count] = w.mHandle;
+                serials[count] = w.mSerial;
+                fences[count] = nullptr;
+                ++count;
+            }
+            for (const auto& [pFence, waits] : mFenceWaits) {
+                if (waits.mContinuations.empty())
+                    continue;
+                handles[count] = waits.mEvent.get();
+                fences[count] = pFence;
+                ++count;
+            }
+            ++mSnapshotCount;
+        }
+        mSnapshotTaken.notify_all();
+
+        auto res = WaitForMultipleObjects(count, handles.data(), FALSE, INFINITE);
+        if (res == WAIT_FAILED || res >= WAIT_OBJECT_0 + count) {
+            throw std::runtime_error("wait for frame pacing failed");
+        }
+        auto index = res - WAIT_OBJECT_0;
+        if (index == 0) {
+            // waits added or removed
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (fences[index]) {
+            completeFence(fences[index]);
+            continue;
+        }
+        auto iter = std::find_if(mWaits.begin(), mWaits.end(), [&](const Wait& w) {
+            return w.mSerial == serials[index];
+        });
+        if (iter == mWaits.end()) {
+            // cancelled while waiting
+            continue;
+        }
+        auto callback = std::move(iter->mCallback);
+        mWaits.erase(iter);
+        callback();
+    }
+}
+
+}
@@ -0,0 +1,85 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <Star/SThreadPolicy.h>
+
+namespace Star::Graphics::Render {
+
+// one thread waiting on the frame latency objects and fences of all swapchains
+// callbacks run on the pacer thread, they should only post work to the render strand
+// fence continuations of other work are waited on by the same thread, no other thread parks on a fence
+class DX12FramePacer {
+public:
+    explicit DX12FramePacer(const ThreadPolicy& policy);
+    DX12FramePacer(const DX12FramePacer&) = delete;
+    DX12FramePacer& operator=(const DX12FramePacer&) = delete;
+    // stops waiting, pending callbacks are dropped
+    ~DX12FramePacer();
+
+    // callback runs once handle is signaled, the handle must outlive the wait
+    void wait(uint32_t id, HANDLE handle, std::function<void()> callback);
+    // callback runs once fence has reached value, for swapchains without waitable object
+    void waitFence(uint32_t id, ID3D12Fence* pFence, uint64_t value, std::function<void()> callback);
+    // drops waits of the swapchain, its handles are no longer waited on after return
+    void cancel(uint32_t id);
+
+    // continuation is posted to executor once fence has reached value, any thread
+    // continuations of a fence share one event armed at their lowest value, the fence must outlive them
+    // pending continuations are dropped when the pacer is destroyed
+    void whenCompleted(ID3D12Fence* pFence, uint64_t value,
+        boost::asio::io_context& executor, std::function<void()> continuation);
+private:
+    struct Wait {
+        uint32_t mID = 0;
+        uint64_t mSerial = 0;
+        HANDLE mHandle = nullptr;
+        std::function<void()> mCallback;
+    };
+    struct Continuation {
+        boost::asio::io_context* mExecutor = nullptr;
+        std::function<void()> mCallback;
+    };
+    struct FenceWaits {
+        winrt::handle mEvent;
+        std::multimap<uint64_t, Continuation> mContinuations;
+    };
+    void run();
+    // posts continuations reached by the fence and arms the event at the next one, under mMutex
+    void completeFence(ID3D12Fence* pFence);
+
+    std::mutex mMutex;
+    std::condition_variable mSnapshotTaken;
+    // guarded by mMutex
+    std::vector<Wait> mWaits;
+    uint64_t mNextSerial = 0;
+    uint64_t mSnapshotCount = 0;
+    bool mStopped = false;
+    // fences with pending continuations are waited on
+    std::unordered_map<ID3D12Fence*, FenceWaits> mFenceWaits;
+    // fence events of swapchains, used on render thread only
+    std::unordered_map<uint32_t, winrt::handle> mFenceEvents;
+    winrt::handle mWakeEvent;
+    std::thread mThread;
+};
+
+}
@@ -17,34 +17,133 @@
 
 #include "SDX12FrameQueue.h"
 #include "SDX12SwapChain.h"
+#include "SDX12IndirectDraw.h"
+#include "SDX12Culling.h"
+#include "SDX12Transforms.h"
+#include "SDX12PersistentConstants.h"
+#include "SDX12StateCache.h"
+#include "SDX12OcclusionCulling.h"
+#include "SDX12LightCulling.h"
+#include "SDX12ShadowCache.h"
+#include "SDX12MaterialConstants.h"
 #include <Star/DX12Engine/SDX12Types.h>
 #include <Star/Graphics/SCamera.h>
+#include <Star/SJobSystem.h>
 #include <Star/Graphics/SContentUtils.h>
-#include "SDX12Material.h"
+#include <Star/Core/SProfiler.h>
+#include <Star/Core/SCounters.h>
 
 namespace Star::Graphics::Render {
 
+namespace {
+
+uint32_t getNumFrameRings(const Engine::Configs& configs) noexcept {
+    return std::max(1u, configs.mNumSwapChains);
+}
+
+DX12ShaderDescriptorHeap::Desc getShaderDescriptorHeapDesc(const Engine::Configs& configs) noexcept {
+    // circular descriptors are shared by rings, at most every slot of every ring is in flight
+    DX12ShaderDescriptorHeap::Desc desc{
+        configs.mShaderDescriptorCapacity,
+        configs.mShaderDescriptorCircularReserve,
+        configs.mFrameQueueSize * getNumFrameRings(configs)
+    };
+    // the pool keeps a block for persistent descriptors, more are added when they run out
+    desc.mCapacity = std::max(desc.mCapacity, gsl::narrow_cast<uint32_t>(
+        boost::alignment::align_up(desc.mCicularReserve, desc.mBlockSize)) + desc.mBlockSize);
+    desc.mCircularSpillCapacity = gsl::narrow_cast<uint32_t>(
+        boost::alignment::align_up(configs.mShaderDescriptorCircularSpill, desc.mBlockSize));
+    desc.mBindlessCapacity = configs.mBindlessTextureCapacity;
+    return desc;
+}
+
+// camera of frames until the application sets one
+Camera createDefaultCamera() {
+    Camera cam{};
+    cam.mViewSpace = OpenGL;
+    cam.mNDC = Direct3D;
+    //cam.lookAt(Vector3f(0, 2.0f, 0), Vector3f(0, 1, 0), Vector3f(0, 0, 1));
+    cam.lookTo(Vector3f(0, 0, 1.7f), Vector3f(-1.f, 0, 0.0f), Vector3f(0, 0.0f, 1.0f));
+    cam.perspective(0.25f * S_PI, 16.0f / 9.0f, 0.25f, 512.0f);
+    return cam;
+}
+
+}
+
 DX12FrameQueue::DX12FrameQueue(ID3D12Device* pDevice,
     const DX12UploadBufferPool& pool,
+    JobSystem* pJobSystem,
     const Engine::Configs& configs, const allocator_type& alloc)
     : mDevice(pDevice)
     , mFence(DX12::createFence(pDevice, mNextFrameFence, "FrameQueueFence"))
     , mFenceEvent(DX12::createFenceEvent())
-    , mFrames(alloc)
+    , mRings(alloc)
     , mDirectQueue(DX12::createDirectQueue(pDevice))
-    , mDescriptors(pDevice, 
-        {
-            configs.mShaderDescriptorCapacity,
-            configs.mShaderDescriptorCircularReserve,
-            configs.mFrameQueueSize
-        }, alloc)
-    , mUploadBuffer(pool, configs.mFrameQueueSize)
+    , mComputeFence(DX12::createFence(pDevice, mNextComputeFence, "ComputeQueueFence"))
+    , mDescriptors(pDevice, getShaderDescriptorHeapDesc(configs), alloc)
+    , mJobSystem(pJobSystem)
+    , mMinDrawsPerRecorder(configs.mMinDrawsPerRecorder)
+    , mTwoPhaseOcclusion(configs.mTwoPhaseOcclusion)
+    , mLodBias(configs.mLodBias)
+    , mShaderLevel(configs.mShaderLevel)
+    , mShaderLodDistance(configs.mShaderLodDistance)
+    , mResolutionScaler(configs.mResolutionBudget, configs.mMinResolutionScale)
+    , mRenderScale(configs.mRenderScale)
+    , mCameras{ createDefaultCamera() }
 {
     mDirectQueue->GetTimestampFrequency(&mCommandQueuePerformanceFrequency);
-    mFrames.reserve(configs.mFrameQueueSize);
-    for (int i = 0; i != configs.mFrameQueueSize; ++i) {
-        mFrames.emplace_back(pDevice, "FrameContext: ", i);
+    const uint32_t numRings = getNumFrameRings(configs);
+    mRings.reserve(numRings);
+    for (uint32_t i = 0; i != numRings; ++i) {
+        mRings.emplace_back(std::make_unique<DX12FrameRing>(pDevice, pool, configs, i, alloc));
     }
+    if (configs.mGpuDrivenRendering) {
+        mIndirectPipeline = createDX12IndirectPipeline(pDevice);
+        if (configs.mAsyncCompute) {
+            mComputeQueue = DX12::createComputeQueue(pDevice);
+        }
+    }
+    mOcclusionPipeline = createDX12OcclusionPipeline(pDevice);
+    mLightCullingPipeline = createDX12LightCullingPipeline(pDevice);
+    if (configs.mRenderPasses) {
+        D3D12_FEATURE_DATA_D3D12_OPTIONS5 options = {};
+        mRenderPasses = SUCCEEDED(pDevice->CheckFeatureSupport(
+            D3D12_FEATURE_D3D12_OPTIONS5, &options, sizeof(options)));
+        if (!mRenderPasses) {
+            OutputDebugStringA("WARNING: render passes not supported, subpasses bind render targets\n");
+        }
+    }
+    {
+        D3D12_FEATURE_DATA_D3D12_OPTIONS6 options = {};
+        if (SUCCEEDED(pDevice->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS6, &options, sizeof(options)))) {
+            mShadingRateTier = options.VariableShadingRateTier;
+        }
+    }
+    if (configs.mGpuProfiling) {
+        mGpuProfiler = std::make_unique<DX12GpuProfiler>(pDevice,
+            frameSlotCount(), mCommandQueuePerformanceFrequency,
+            std::max(1u, configs.mNumRecordingThreads), configs.mPipelineStatistics);
+    }
+    if (configs.mPipelineStatistics && !mGpuProfiler) {
+        OutputDebugStringA("WARNING: pipeline statistics need gpu profiling, subpasses are not counted\n");
+    }
+    if (configs.mResolutionBudget > 0 && !mGpuProfiler) {
+        OutputDebugStringA("WARNING: dynamic resolution needs gpu profiling, frames render at full resolution\n");
+    }
+    if (configs.mGpuCrashDiagnostics) {
+        mBreadcrumbs = std::make_unique<DX12GpuBreadcrumbs>(pDevice, frameSlotCount());
+    }
+    enableEventMarkers(configs.mEventMarkers);
+}
+
+void DX12FrameQueue::enableEventMarkers(bool enabled) {
+#ifdef STAR_DEV
+    if (!enabled) {
+        mEventMarkers.reset();
+    } else if (!mEventMarkers) {
+        mEventMarkers = std::make_unique<DX12EventMarkers>();
+    }
+#endif
 }
 
 void DX12FrameQueue::initPipeline(const DX12SwapChain& sc) {
@@ -66,6 +165,7 @@ void DX12FrameQueue::initPipeline(const DX12SwapChain& sc) {
                 static_cast<D3D12_RESOURCE_STATES>(state)),
         };
         pCL->ResourceBarrier(_countof(barriers), barriers);
+        Core::Counters::add(Core::Counter::Barriers, _countof(barriers));
     }
     pCL->Close();
     ID3D12CommandList* lists[] = { pCL };
@@ -75,23 +175,35 @@ void DX12FrameQueue::initPipeline(const DX12SwapChain& sc) {
 }
 
 const DX12FrameContext* DX12FrameQueue::beginFrame(const DX12SwapChain& sc) {
-    Expects(sc.mSwapChain);
+    STAR_PROFILE_SCOPE("DX12FrameQueue::beginFrame");
+    auto pFrame = acquireFrame(sc);
+    waitFrame(pFrame);
+    return pFrame;
+}
+
+const DX12FrameContext* DX12FrameQueue::acquireFrame(const DX12SwapChain& sc) {
+    Expects(sc.created());
 
     // Get/Increment the fence counter
     uint64_t FrameFence = mNextFrameFence;
     mNextFrameFence = mNextFrameFence + 1;
 
     // Get/Increment the frame ring-buffer index
-    uint32_t FrameIndex = mNextFrameIndex;
-    mNextFrameIndex = (mNextFrameIndex + 1) % (uint32_t)mFrames.size();
-
-    // Wait for the last frame occupying this slot to be complete
-    auto pFrame = &mFrames[FrameIndex];
-    DX12::waitForFence(mFence.get(), mFenceEvent.get(), pFrame->mFrameFenceId);
+    auto& ring = *mRings.at(sc.mID);
+    uint32_t FrameIndex = ring.mNextFrameIndex;
+    ring.mNextFrameIndex = (ring.mNextFrameIndex + 1) % (uint32_t)ring.mFrames.size();
+
+    // the last frame occupying this slot is waited by waitFrame
+    auto pFrame = &ring.mFrames[FrameIndex];
+    Expects(!pFrame->mAcquired);
+    pFrame->mAcquired = true;
+    pFrame->mRetiredFenceId = pFrame->mFrameFenceId;
     pFrame->mFrameFenceId = FrameFence;
+    pFrame->mFrameIndex = sc.mID * (uint32_t)ring.mFrames.size() + FrameIndex;
+    pFrame->mRingID = sc.mID;
 
     // Associate the frame with the swap chain backbuffer & RTV.
-    uint32_t backBufferIndex = sc.mSwapChain->GetCurrentBackBufferIndex();
+    uint32_t backBufferIndex = sc.currentBackBufferIndex();
     const auto& backBuffer = sc.getBackBuffer(backBufferIndex);
     pFrame->mBackBufferIndex = backBufferIndex;
     pFrame->mBackBufferCount = sc.mRenderGraph->mRenderGraph.mNumBackBuffers;
@@ -101,14 +213,6 @@ const DX12FrameContext* DX12FrameQueue::beginFrame(const DX12SwapChain& sc) {
     pFrame->mBackBufferRTV = sc.getBackBufferDescriptor(backBufferIndex, false);
     pFrame->mBackBufferRTVsRGB = sc.getBackBufferDescriptor(backBufferIndex, true);
 
-    // Reset the command allocator and list
-    V(pFrame->mCommandAllocator->Reset());
-    V(pFrame->mCommandList->Reset(pFrame->mCommandAllocator.get(), nullptr));
-
-    // advance frame
-    mDescriptors.advanceFrame();
-    mUploadBuffer.advanceFrame();
-
     // resources
     pFrame->mRenderSolution = &sc.currentSolution();
     pFrame->mRenderWorks = &sc.mRenderGraph->mRenderGraph;
@@ -119,205 +223,762 @@ const DX12FrameContext* DX12FrameQueue::beginFrame(const DX12SwapChain& sc) {
     return pFrame;
 }
 
+void DX12FrameQueue::waitFrame(const DX12FrameContext* pContext) {
+    STAR_PROFILE_SCOPE("DX12FrameQueue::waitFrame");
+    auto* pFrame = const_cast<DX12FrameContext*>(pContext);
+    Expects(pFrame->mAcquired);
+    pFrame->mAcquired = false;
+    auto& ring = *mRings[pFrame->mRingID];
+
+    // Wait for the last frame occupying this slot to be complete, other rings keep running
+    if (mFence->GetCompletedValue() < pFrame->mRetiredFenceId) {
+        V(mFence->SetEventOnCompletion(pFrame->mRetiredFenceId, mFenceEvent.get()));
+    }
+    {
+        auto waitBegin = std::chrono::steady_clock::now();
+        DX12::waitForFence(mFence.get(), mFenceEvent.get(), pFrame->mRetiredFenceId);
+        auto waited = std::chrono::steady_clock::now() - waitBegin;
+        Core::Counters::add(Core::Counter::FenceWaitMicroseconds, gsl::narrow_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(waited).count()));
+    }
+
+    // Reset the command allocator and list
+    V(pFrame->mCommandAllocator->Reset());
+    V(pFrame->mCommandList->Reset(pFrame->mCommandAllocator.get(), nullptr));
+
+    // recorders are reset on task threads, their uploads are stamped with the frame fence
+    for (auto& uploadBuffer : ring.mRecorderUploadBuffers) {
+        uploadBuffer->advanceFrame(gsl::narrow_cast<int64_t>(pFrame->mFrameFenceId));
+    }
+
+    // advance frame
+    mDescriptors.advanceFrame();
+    ring.mUploadBuffer.advanceFrame();
+}
+
 namespace {
 
-void buildDynamicDescriptors(ID3D12Device* pDevice, ID3D12GraphicsCommandList* pCommandList,
-    DX12ShaderDescriptorHeap& shaderHeap, DX12UploadBuffer& uploadBuffer,
-    const DX12ShaderSubpassData& shaderSubpass, const DX12MaterialSubpassData& subpassData,
-    const CameraData& cam, const DX12FlattenedObjects* pBatch, uint32_t objectID,
-    std::pmr::vector<std::byte>& perInstanceCB
+bool hasDX12Stencil(DXGI_FORMAT format) noexcept {
+    switch (format) {
+    case DXGI_FORMAT_D32_FLOAT_S8X24_UINT:
+    case DXGI_FORMAT_D24_UNORM_S8_UINT:
+        return true;
+    default:
+        return false;
+    }
+}
+
+D3D12_RENDER_PASS_ENDING_ACCESS getDX12EndingAccess(const StoreOp& op) noexcept {
+    D3D12_RENDER_PASS_ENDING_ACCESS access{ D3D12_RENDER_PASS_ENDING_ACCESS_TYPE_PRESERVE };
+    if (std::holds_alternative<Discard_>(op)) {
+        access.Type = D3D12_RENDER_PASS_ENDING_ACCESS_TYPE_DISCARD;
+    }
+    return access;
+}
+
+// binds the subpass attachments, load and store ops become beginning and ending accesses.
+// a subpass split between recorders is suspended and resumed, loads and stores happen once
+// depth copied from a shadow cache is preserved instead of loaded
+void beginDX12RenderPass(ID3D12GraphicsCommandList4* pCommandList, const DX12RenderSolution& rsl,
+    const DX12GraphicsSubpass& subpass, const std::pmr::vector<D3D12_CPU_DESCRIPTOR_HANDLE>& rtvs,
+    D3D12_CPU_DESCRIPTOR_HANDLE dsv, bool resuming, bool suspending, bool preserveDepth,
+    std::pmr::vector<D3D12_RENDER_PASS_RENDER_TARGET_DESC>& targets
 ) {
-    // upload descriptors
-    for (const auto& collection : subpassData.mCollections) {
-        Expects(std::holds_alternative<Table_>(collection.mIndex.mType));
+    const D3D12_RENDER_PASS_BEGINNING_ACCESS preserve{ D3D12_RENDER_PASS_BEGINNING_ACCESS_TYPE_PRESERVE };
+    const D3D12_RENDER_PASS_ENDING_ACCESS keep{ D3D12_RENDER_PASS_ENDING_ACCESS_TYPE_PRESERVE };
+    const D3D12_RENDER_PASS_BEGINNING_ACCESS noAccess{ D3D12_RENDER_PASS_BEGINNING_ACCESS_TYPE_NO_ACCESS };
+    const D3D12_RENDER_PASS_ENDING_ACCESS noEnding{ D3D12_RENDER_PASS_ENDING_ACCESS_TYPE_NO_ACCESS };
+
+    targets.clear();
+    for (size_t i = 0; i != rtvs.size(); ++i) {
+        const auto& rt = subpass.mOutputAttachments[i];
+        auto& target = targets.emplace_back();
+        target.cpuDescriptor = rtvs[i];
+        target.BeginningAccess = preserve;
+        target.EndingAccess = suspending ? keep : getDX12EndingAccess(rt.mStoreOp);
+        if (resuming)
+            continue;
+
         visit(overload(
-            [&](Persistent_) {
-                for (const auto& list : collection.mResourceViewLists) {
-                    pCommandList->SetGraphicsRootDescriptorTable(list.mSlot, list.mGpuOffset);
-                }
-                for (const auto& list : collection.mSamplerLists) {
-                    pCommandList->SetGraphicsRootDescriptorTable(list.mSlot, list.mGpuOffset);
-                }
+            [&](const DontRead_&) {
+                target.BeginningAccess.Type = D3D12_RENDER_PASS_BEGINNING_ACCESS_TYPE_DISCARD;
             },
-            [&](Dynamic_) {
-                Expects(collection.mIndex.mUpdate < UpdateEnum::PerPass);
-                for (const auto& list : collection.mResourceViewLists) {
-                    Expects(!list.mRanges.empty());
-                    Expects(list.mCapacity);
-                    auto descs = shaderHeap.allocateCircular(list.mCapacity);
-                    size_t descID = 0;
-                    for (const auto& range : list.mRanges) {
-                        for (const auto& subrange : range.mSubranges) {
-                            visit(overload(
-                                [&](EngineSource_) {
-                                    for (const auto& attr : subrange.mDescriptors) {
-                                        visit(overload(
-                                            [&](Descriptor::ConstantBuffer_) {
-                                                bool foundDescriptor = false;
-                                                for (const auto& cb : shaderSubpass.mConstantBuffers) {
-                                                    if (cb.mIndex != collection.mIndex)
-                                                        continue;
-
-                                                    Expects(cb.mSize);
-                                                    auto sizeCB = boost::alignment::align_up(cb.mSize, 256);
-                                                    perInstanceCB.clear();
-                                                    perInstanceCB.resize(sizeCB);
-                                                    auto* pData = perInstanceCB.data();
-                                                    for (const auto& constant : cb.mConstants) {
-                                                        visit(overload(
-                                                            [&](EngineSource_) {
-                                                                visit(overload(
-                                                                    [&](Data::Proj_) {
-                                                                        throw std::runtime_error("Proj cannot be per instance");
-                                                                    },
-                                                                    [&](Data::View_) {
-                                                                        throw std::runtime_error("View cannot be per instance");
-                                                                    },
-                                                                    [&](Data::WorldView_) {
-                                                                        if (!pBatch) {
-                                                                            throw std::runtime_error("batch is nullptr");
-                                                                        }
-                                                                        const auto& batch = *pBatch;
-                                                                        Matrix4f worldView = cam.mView * batch.mWorldTransforms[objectID].mTransform.matrix();
-                                                                        Expects(pData + sizeof(worldView) <= perInstanceCB.data() + perInstanceCB.size());
-                                                                        memcpy(pData, worldView.data(), sizeof(worldView));
-                                                                        pData += sizeof(worldView);
-                                                                    },
-                                                                    [&](Data::WorldInvT_) {
-                                                                        if (!pBatch) {
-                                                                            throw std::runtime_error("batch is nullptr");
-                                                                        }
-                                                                        const auto& batch = *pBatch;
-                                                                        const Matrix4f& worldInvT = batch.mWorldTransformInvs[objectID].mTransform.matrix();
-                                                                        Expects(pData + sizeof(worldInvT) <= perInstanceCB.data() + perInstanceCB.size());
-                                                                        memcpy(pData, worldInvT.data(), sizeof(worldInvT));
-                                                                        pData += sizeof(worldInvT);
-                                                                    },
-                                                                    [](std::monostate) {
-                                                                        throw std::runtime_error("engine source constant cannot be monostate");
-                                                                    }
-                                                                ), constant.mDataType);
-                                                            },
-                                                            [&](RenderTargetSource_) {
-                                                                throw std::runtime_error("dynamic constant cannot be render target source");
-                                                            },
-                                                            [&](MaterialSource_) {
-                                                                throw std::runtime_error("dynamic constant cannot be material source");
-                                                            }
-                                                        ), constant.mSource);
-                                                    }
-                                                    auto pos2 = uploadBuffer.upload(perInstanceCB.data(), gsl::narrow_cast<uint32_t>(perInstanceCB.size()), 1, 256);
-                                                    D3D12_CONSTANT_BUFFER_VIEW_DESC desc{
-                                                        pos2.mResource->GetGPUVirtualAddress() + pos2.mBufferOffset, (uint32_t)perInstanceCB.size()
-                                                    };
-
-                                                    auto d = shaderHeap.advance(descs.first, descID);
-                                                    pDevice->CreateConstantBufferView(&desc, d.mCpuHandle);
-                                                    foundDescriptor = true;
-                                                    break;
-                                                }
-                                                if (!foundDescriptor) {
-                                                    throw std::runtime_error("constant buffer not found");
-                                                }
-                                            },
-                                            [&](Descriptor::MainTex_) {
-                                                throw std::runtime_error("not supported yet");
-                                            },
-                                            [&](Descriptor::PointSampler_) {
-                                            },
-                                            [&](Descriptor::LinearSampler_) {
-                                            },
-                                            [&](std::monostate) {
-                                                throw std::runtime_error("engine source should not be std::monostate");
-                                            }
-                                        ), attr.mDataType);
+            [&](const ClearColor& v) {
+                target.BeginningAccess.Type = D3D12_RENDER_PASS_BEGINNING_ACCESS_TYPE_CLEAR;
+                auto& clear = target.BeginningAccess.Clear.ClearValue;
+                clear.Format = getDXGIFormat(rsl.mRTVs[rt.mDescriptor.mHandle].mFormat);
+                std::copy(v.mClearColor.data(), v.mClearColor.data() + 4, clear.Color);
+            },
+            [&](const ClearDepthStencil& v) {
+                throw std::runtime_error("RTV should not use clear depth stencil");
+            },
+            [](const auto&) {}
+        ), rt.mLoadOp);
+    }
 
-                                        ++descID;
-                                    }
-                                },
-                                [&](RenderTargetSource_) {
-                                    for (const auto& attr : subrange.mDescriptors) {
-                                        ++descID;
-                                    }
-                                    throw std::runtime_error("render target source's Update Frequency should not be less than PerPass");
-                                },
-                                [&](MaterialSource_) {
-                                    for (const auto& attr : subrange.mDescriptors) {
-                                        ++descID;
-                                    }
-                                    throw std::runtime_error("not supported yet");
-                                }
-                            ), subrange.mSource);
-                        }
+    D3D12_RENDER_PASS_FLAGS flags = D3D12_RENDER_PASS_FLAG_NONE;
+    D3D12_RENDER_PASS_DEPTH_STENCIL_DESC depthStencil{};
+    if (subpass.mDepthStencilAttachment) {
+        const auto& ds = *subpass.mDepthStencilAttachment;
+        const auto& view = rsl.mDSVs[ds.mDescriptor.mHandle];
+        const auto format = getDXGIFormat(view.mFormat);
+        const auto viewFlags = static_cast<D3D12_DSV_FLAGS>(view.mFlags);
+
+        depthStencil.cpuDescriptor = dsv;
+        depthStencil.DepthBeginningAccess = preserve;
+        depthStencil.StencilBeginningAccess = preserve;
+        depthStencil.DepthEndingAccess = suspending ? keep : getDX12EndingAccess(ds.mStoreOp);
+        depthStencil.StencilEndingAccess = depthStencil.DepthEndingAccess;
+
+        if (!resuming && !preserveDepth) {
+            visit(overload(
+                [&](const DontRead_&) {
+                    depthStencil.DepthBeginningAccess.Type = D3D12_RENDER_PASS_BEGINNING_ACCESS_TYPE_DISCARD;
+                    depthStencil.StencilBeginningAccess.Type = D3D12_RENDER_PASS_BEGINNING_ACCESS_TYPE_DISCARD;
+                },
+                [&](const ClearColor& v) {
+                    throw std::runtime_error("DSV should not use clear color");
+                },
+                [&](const ClearDepthStencil& v) {
+                    D3D12_CLEAR_VALUE clear{ format };
+                    clear.DepthStencil = { v.mDepthClearValue, v.mStencilClearValue };
+                    if (v.mClearDepth) {
+                        depthStencil.DepthBeginningAccess.Type = D3D12_RENDER_PASS_BEGINNING_ACCESS_TYPE_CLEAR;
+                        depthStencil.DepthBeginningAccess.Clear.ClearValue = clear;
                     }
-                    pCommandList->SetGraphicsRootDescriptorTable(list.mSlot, descs.first.mGpuHandle);
+                    if (v.mClearStencil) {
+                        depthStencil.StencilBeginningAccess.Type = D3D12_RENDER_PASS_BEGINNING_ACCESS_TYPE_CLEAR;
+                        depthStencil.StencilBeginningAccess.Clear.ClearValue = clear;
+                    }
+                },
+                [](const auto&) {}
+            ), ds.mLoadOp);
+        }
+
+        // read only planes are neither cleared nor written back
+        if (viewFlags & D3D12_DSV_FLAG_READ_ONLY_DEPTH) {
+            depthStencil.DepthBeginningAccess = preserve;
+            depthStencil.DepthEndingAccess = keep;
+            flags |= D3D12_RENDER_PASS_FLAG_BIND_READ_ONLY_DEPTH;
+        }
+        if (viewFlags & D3D12_DSV_FLAG_READ_ONLY_STENCIL) {
+            depthStencil.StencilBeginningAccess = preserve;
+            depthStencil.StencilEndingAccess = keep;
+            flags |= D3D12_RENDER_PASS_FLAG_BIND_READ_ONLY_STENCIL;
+        }
+        if (!hasDX12Stencil(format)) {
+            depthStencil.StencilBeginningAccess = noAccess;
+            depthStencil.StencilEndingAccess = noEnding;
+        }
+    }
+
+    if (resuming) {
+        flags |= D3D12_RENDER_PASS_FLAG_RESUMING_PASS;
+    }
+    if (suspending) {
+        flags |= D3D12_RENDER_PASS_FLAG_SUSPENDING_PASS;
+    }
+
+    pCommandList->BeginRenderPass(gsl::narrow_cast<uint32_t>(targets.size()),
+        targets.empty() ? nullptr : targets.data(),
+        subpass.mDepthStencilAttachment ? &depthStencil : nullptr, flags);
+}
+
+void executeDrawPackets(ID3D12Device* pDevice, DX12GraphicsStateCache& state,
+    DX12ShaderDescriptorHeap& shaderHeap, DX12UploadBuffer& uploadBuffer,
+    const DX12UnorderedRenderQueue& queue, uint32_t packetBegin, uint32_t packetEnd,
+    const DX12VisibleDraws& visible, uint32_t drawOffset,
+    const CameraData& cam, const CameraData& prevCam, const DX12MeshletCuller& culler,
+    const DX12EventMarkers* pMarkers, FrameArena& perInstance,
+    ID3D12Resource* pPredicates, uint32_t predicateOffset
+) {
+    Expects(packetBegin <= packetEnd);
+    Expects(packetEnd <= queue.mDrawPackets.size());
+    Expects(drawOffset + packetEnd < visible.mDrawOffsets.size());
+    auto* pCommandList = state.commandList();
+
+    // consecutive packets of a batch share one event
+    std::optional<DX12EventScope> batchEvent;
+    const DX12FlattenedObjects* pEventBatch = nullptr;
+
+    for (uint32_t packetID = packetBegin; packetID != packetEnd; ++packetID) {
+        const auto& packet = queue.mDrawPackets[packetID];
+        const auto instanceBegin = visible.mDrawOffsets[drawOffset + packetID];
+        const auto instanceCount = visible.mDrawOffsets[drawOffset + packetID + 1] - instanceBegin;
+        // pso still compiling
+        if (!instanceCount || !packet.mPipelineState) {
+            continue;
+        }
+        // packets are skipped by the gpu unless the occlusion test set their predicate
+        if (pPredicates) {
+            pCommandList->SetPredication(pPredicates,
+                sizeof(uint64_t) * (drawOffset + packetID - predicateOffset), D3D12_PREDICATION_OP_EQUAL_ZERO);
+        }
+
+        if (pMarkers && (!batchEvent || pEventBatch != packet.mBatch)) {
+            batchEvent.reset();
+            batchEvent.emplace(pCommandList, pMarkers->batch(packet.mBatch));
+            pEventBatch = packet.mBatch;
+        }
+
+        // input assembler and pipeline state
+        state.setPrimitiveTopology(packet.mPrimitiveTopology);
+        state.setMesh(packet.mMesh);
+        state.setPipelineState(packet.mPipelineState);
+
+        // instances are grouped by mesh level, each run is bound and drawn on its own
+        const auto instanceEnd = instanceBegin + instanceCount;
+        for (uint32_t runBegin = instanceBegin; runBegin != instanceEnd;) {
+            const auto level = visible.mLevels[runBegin];
+            uint32_t runEnd = runBegin + 1;
+            while (runEnd != instanceEnd && visible.mLevels[runEnd] == level) {
+                ++runEnd;
+            }
+            const auto runCount = runEnd - runBegin;
+
+            // descriptors, constants of visible instances are written in place
+            auto uploadDescriptor = [&](const DX12DrawDescriptor& desc, uint32_t count, size_t alignment) {
+                auto [pos, pData] = uploadBuffer.suballocate(desc.mSize, count, alignment);
+                writeDX12DrawDescriptor(queue, packet, desc, cam.mView, prevCam.mView,
+                    visible.mInstances.data() + runBegin, count, pData);
+                return pos.mResource->GetGPUVirtualAddress() + pos.mBufferOffset;
+            };
+
+            for (uint32_t bindingID = packet.mBindingBegin; bindingID != packet.mBindingBegin + packet.mBindingCount; ++bindingID) {
+                const auto& binding = queue.mDrawBindings[bindingID];
+                if (binding.mType == RootShaderResourceBinding) {
+                    Expects(binding.mDescriptorCount == 1);
+                    // fully visible draws read records kept in default heap
+                    const auto& persistent = queue.mPersistentConstants;
+                    if (persistent.mResident && runCount == packet.mInstanceCount &&
+                        bindingID < queue.mPersistentOffsets.size() &&
+                        queue.mPersistentOffsets[bindingID] != UINT64_MAX) {
+                        state.setShaderResourceView(binding.mSlot,
+                            persistent.mBuffer->GetGPUVirtualAddress() + queue.mPersistentOffsets[bindingID]);
+                        continue;
+                    }
+                    auto address = uploadDescriptor(queue.mDrawDescriptors[binding.mDescriptorBegin],
+                        runCount, 16);
+                    state.setShaderResourceView(binding.mSlot, address);
+                    continue;
                 }
-                for (const auto& list : collection.mSamplerLists) {
-                    Expects(std::holds_alternative<Table_>(collection.mIndex.mType));
-                    throw std::runtime_error("not supported yet");
+                if (binding.mType == RootConstantBufferBinding) {
+                    Expects(binding.mDescriptorCount == 1);
+                    auto address = uploadDescriptor(queue.mDrawDescriptors[binding.mDescriptorBegin], 1, 256);
+                    state.setConstantBufferView(binding.mSlot, address);
+                    continue;
                 }
+                if (!binding.mCapacity) {
+                    state.setDescriptorTable(binding.mSlot, binding.mGpuOffset);
+                    continue;
+                }
+
+                auto descs = shaderHeap.allocateCircular(binding.mCapacity);
+                for (uint32_t descID = binding.mDescriptorBegin; descID != binding.mDescriptorBegin + binding.mDescriptorCount; ++descID) {
+                    const auto& desc = queue.mDrawDescriptors[descID];
+                    D3D12_CONSTANT_BUFFER_VIEW_DESC cbv{ uploadDescriptor(desc, 1, 256), desc.mSize };
+                    pDevice->CreateConstantBufferView(&cbv, shaderHeap.advance(descs.first, desc.mIndex).mCpuHandle);
+                }
+                state.setDescriptorTable(binding.mSlot, descs.first.mGpuHandle);
             }
-        ), collection.mIndex.mPersistency);
+
+            // draw call, simplified levels draw their own ranges
+            // single full detail instances of large submeshes draw their visible meshlets only
+            if (packet.mMesh && level) {
+                const auto& lod = packet.mMesh->mLods[level - 1];
+                const auto& submesh = packet.mMesh->mLodSubMeshes[lod.mSubMeshOffset + packet.mSubMeshID];
+                pCommandList->DrawIndexedInstanced(submesh.mIndexCount, runCount,
+                    submesh.mIndexOffset + packet.mMesh->mBaseIndex, packet.mBaseVertex, 0);
+                state.countDraw(submesh.mIndexCount, runCount);
+            } else if (packet.mMesh && packet.mMeshletCount && runCount == 1) {
+                Expects(packet.mBatch);
+                const auto world = getDX12WorldTransform(*packet.mBatch, visible.mInstances[runBegin]);
+                // visible index ranges of the instance
+                FrameArenaScope instanceScope(perInstance);
+                default_init_vector<std::pair<uint32_t, uint32_t>> meshletRanges(packet.mMeshletCount, &perInstance);
+                const auto rangeCount = culler.cull(packet.mMesh->mMeshlets.data() + packet.mMeshletBegin,
+                    packet.mMeshletCount, world, packet.mConeCulling, meshletRanges.data());
+                for (uint32_t rangeID = 0; rangeID != rangeCount; ++rangeID) {
+                    const auto& [indexOffset, indexCount] = meshletRanges[rangeID];
+                    pCommandList->DrawIndexedInstanced(indexCount, 1,
+                        indexOffset + packet.mMesh->mBaseIndex, packet.mBaseVertex, 0);
+                    state.countDraw(indexCount, 1);
+                }
+            } else if (packet.mMesh) {
+                pCommandList->DrawIndexedInstanced(packet.mElementCount, runCount,
+                    packet.mElementOffset, packet.mBaseVertex, 0);
+                state.countDraw(packet.mElementCount, runCount);
+            } else {
+                pCommandList->DrawInstanced(packet.mElementCount, runCount, packet.mElementOffset, 0);
+                state.countDraw(packet.mElementCount, runCount);
+            }
+            runBegin = runEnd;
+        }
+    }
+    if (pPredicates) {
+        pCommandList->SetPredication(nullptr, 0, D3D12_PREDICATION_OP_EQUAL_ZERO);
     }
 }
 
+bool hasUpscaling(const DX12RenderPipeline& pipeline) noexcept {
+    for (const auto& pass : pipeline.mPasses) {
+        for (const auto& subpass : pass.mGraphicsSubpasses) {
+            if (subpass.mUpscaling)
+                return true;
+        }
+    }
+    return false;
 }
 
-void DX12FrameQueue::renderFrame(const DX12FrameContext* pContext, std::pmr::memory_resource* mr) {
-    // met BackBuffer's pre-condition
-    auto pCommandList = pContext->mCommandList.get();
-    {
-        D3D12_RESOURCE_BARRIER barriers[] = {
-            CD3DX12_RESOURCE_BARRIER::Transition(
-                pContext->mRenderWorks->mFramebuffers[pContext->mBackBufferIndex].get(),
-                D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET),
-        };
-        pCommandList->ResourceBarrier(_countof(barriers), barriers);
+// passes of the back buffer size not writing it render the top left of their targets at the resolution scale
+bool isResolutionScaled(const DX12RenderSolution& rsl, uint32_t numBackBuffers, const DX12RenderPass& pass) noexcept {
+    if (pass.mViewports.empty() || rsl.mFramebuffers.empty())
+        return false;
+    const auto& bb = rsl.mFramebuffers.front().mResource;
+    const auto& viewport = pass.mViewports.front();
+    if (viewport.mWidth != float(bb.mWidth) || viewport.mHeight != float(bb.mHeight))
+        return false;
+    for (const auto& subpass : pass.mGraphicsSubpasses) {
+        for (const auto& attachment : subpass.mOutputAttachments) {
+            if (attachment.mFramebuffer.mHandle < numBackBuffers)
+                return false;
+        }
+    }
+    return true;
+}
+
+}
+
+// draws of a frame prepared on render thread, recorded by ranges
+struct DX12FrameRecording {
+    DX12FrameRecording(const DX12FrameContext* pContext, std::pmr::memory_resource* mr)
+        : mContext(pContext)
+        , mBatches(mr)
+        , mMaskOffsets(mr)
+        , mMasks(mr)
+        , mSubpassOffsets(mr)
+        , mVisible{ std::pmr::vector<uint32_t>(mr), std::pmr::vector<uint32_t>(mr), std::pmr::vector<uint8_t>(mr) }
+        , mShadowCasters{ std::pmr::vector<uint32_t>(mr), std::pmr::vector<uint32_t>(mr), std::pmr::vector<uint8_t>(mr) }
+        , mOccluded{ std::pmr::vector<uint32_t>(mr), std::pmr::vector<uint32_t>(mr), std::pmr::vector<uint8_t>(mr) }
+        , mShadowRefresh(mr)
+        , mLists(mr)
+    {}
+
+    uint32_t getDrawOffset(uint32_t rangeID) const noexcept {
+        return gsl::narrow_cast<uint32_t>(uint64_t(mDrawCount) * rangeID / mNumRanges);
     }
 
+    const DX12FrameContext* mContext = nullptr;
+    // frustum culling, done before the frame slot is retired
+    std::pmr::vector<const DX12FlattenedObjects*> mBatches;
+    // masks of view v start at v * mMaskOffsets.back(), views not drawn by any subpass are not culled
+    std::pmr::vector<uint32_t> mMaskOffsets;
+    std::pmr::vector<uint8_t> mMasks;
+    // recording
+    std::pmr::vector<uint32_t> mSubpassOffsets;
+    DX12VisibleDraws mVisible;
+    // static casters of shadow cached subpasses, drawn into the cache of a subpass if it is refreshed
+    DX12VisibleDraws mShadowCasters;
+    // instances culled by the occlusion results of the slot, drawn predicated after the subpass with two phases
+    DX12VisibleDraws mOccluded;
+    // one per subpass of the frame
+    std::pmr::vector<uint8_t> mShadowRefresh;
+    uint32_t mDrawCount = 0;
+    uint32_t mNumRanges = 1;
+    // viewport scale of screen sized passes, set when the frame is prepared
+    float mResolutionScale = 1;
+    // projection offset in ndc of subpasses before the upscaling subpass, 0 without one
+    float mJitter[2] = {};
+    // compute fence waited by graphics work, valid if compute was submitted
+    bool mComputeSubmitted = false;
+    uint64_t mComputeFence = 0;
+    std::pmr::vector<ID3D12CommandList*> mLists;
+};
+
+void DX12FrameQueue::recordFrame(const DX12FrameRecording& frame,
+    ID3D12GraphicsCommandList* pCommandList, DX12UploadBuffer& uploadBuffer,
+    uint32_t rangeID, uint32_t drawBegin, uint32_t drawEnd, const DX12RecordingArenas& arenas
+) {
+    const auto* pContext = frame.mContext;
+    const auto& subpassOffsets = frame.mSubpassOffsets;
+    const auto& visible = frame.mVisible;
+    Expects(drawBegin <= drawEnd);
+    Expects(arenas.mPerPass && arenas.mPerBatch && arenas.mPerInstance);
+    Expects(!subpassOffsets.empty());
+    const bool lastRecorder = (drawEnd == subpassOffsets.back());
+    // split barriers begin and end in one command list, frames recorded in ranges use full barriers
+    const bool splitBarriers = (drawBegin == 0 && lastRecorder);
+
     // Render Passes
     const auto& rsl = *pContext->mRenderSolution;
     const auto& resource = *pContext->mRenderWorks;
 
     const auto& pipeline = rsl.mPipelines[pContext->mPipelineID];
 
-    std::pmr::vector<D3D12_CPU_DESCRIPTOR_HANDLE> rtvs(mr);
-    rtvs.reserve(16);
-    std::pmr::vector<D3D12_RESOURCE_BARRIER> barriers(mr);
-    barriers.reserve(32);
-
-    std::pmr::vector<std::byte> perPassCB(mr);
-    std::pmr::vector<std::byte> perInstanceCB(mr);
-    perPassCB.reserve(256);
-    perInstanceCB.reserve(256);
-
-    uint32_t solutionID = pContext->mSolutionID;
-    uint32_t pipelineID = pContext->mPipelineID;
+    com_ptr<ID3D12GraphicsCommandList2> commandList2;
+    if (mBreadcrumbs) {
+        V(pCommandList->QueryInterface(IID_PPV_ARGS(commandList2.put())));
+    }
+    com_ptr<ID3D12GraphicsCommandList4> commandList4;
+    if (mRenderPasses) {
+        V(pCommandList->QueryInterface(IID_PPV_ARGS(commandList4.put())));
+    }
+    com_ptr<ID3D12GraphicsCommandList5> commandList5;
+    if (mShadingRateTier != D3D12_VARIABLE_SHADING_RATE_TIER_NOT_SUPPORTED) {
+        V(pCommandList->QueryInterface(IID_PPV_ARGS(commandList5.put())));
+    }
+    const bool shadingRateImages = (mShadingRateTier >= D3D12_VARIABLE_SHADING_RATE_TIER_2);
 
     ID3D12DescriptorHeap* ppHeaps[] = {
         mDescriptors.get(),
     };
     pCommandList->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
+    DX12GraphicsStateCache state(pCommandList);
 
+    // events are balanced within each command list, every recorder opens its own
+    const auto* pMarkers = mEventMarkers.get();
+    std::optional<DX12EventScope> frameEvent;
+    if (pMarkers) {
+        frameEvent.emplace(pCommandList, pMarkers->frame());
+    }
+
+    uint32_t subpassIndex = 0;
+    // the upscaling subpass and later ones run at the output resolution
+    bool upscaled = false;
     for (uint32_t passID = 0; passID != pipeline.mPasses.size(); ++passID) {
         const auto& pass = pipeline.mPasses[passID];
-        if (!pass.mViewports.empty()) {
-            Expects(pass.mViewports.size() == 1);
-            static_assert(sizeof(D3D12_VIEWPORT) == sizeof(VIEWPORT));
-            pCommandList->RSSetViewports(gsl::narrow_cast<uint32_t>(pass.mViewports.size()),
-                alias_cast<const D3D12_VIEWPORT*>(&pass.mViewports[0]));
-        }
-        if (!pass.mScissorRects.empty()) {
-            Expects(pass.mScissorRects.size() == 1);
-            static_assert(sizeof(D3D12_RECT) == sizeof(RECT));
-            pCommandList->RSSetScissorRects(gsl::narrow_cast<uint32_t>(pass.mScissorRects.size()),
-                alias_cast<const D3D12_RECT*>(&pass.mScissorRects[0]));
-        }
-        
+        bool viewportSet = false;
+        const bool upscaling = std::any_of(pass.mGraphicsSubpasses.begin(), pass.mGraphicsSubpasses.end(),
+            [](const DX12GraphicsSubpass& subpass) { return subpass.mUpscaling.has_value(); });
+        const bool screenSized = !upscaled && !upscaling && isResolutionScaled(rsl, resource.mNumBackBuffers, pass);
+        const float resolutionScale = screenSized ? frame.mResolutionScale : 1;
+        std::optional<DX12EventScope> passEvent;
+
+        FrameArenaScope passScope(*arenas.mPerPass);
+        std::pmr::vector<D3D12_CPU_DESCRIPTOR_HANDLE> rtvs(arenas.mPerPass);
+        rtvs.reserve(16);
+        std::pmr::vector<D3D12_RESOURCE_BARRIER> barriers(arenas.mPerPass);
+        barriers.reserve(32);
+        std::pmr::vector<D3D12_RENDER_PASS_RENDER_TARGET_DESC> renderTargets(arenas.mPerPass);
+
         for (uint32_t subpassID = 0; subpassID != pass.mGraphicsSubpasses.size(); ++subpassID) {
             const auto& subpass = pass.mGraphicsSubpasses[subpassID];
+            const auto subpassBegin = subpassOffsets[subpassIndex];
+            const auto subpassEnd = subpassOffsets[subpassIndex + 1];
+            const auto profiledSubpass = subpassIndex;
+            ++subpassIndex;
+            // inputs of subpasses up to the upscaling one are at the frame scale, screen sized draws before it are jittered
+            const bool renderResolution = !upscaled;
+            upscaled = upscaled || subpass.mUpscaling.has_value();
+            const bool jittered = screenSized && (frame.mJitter[0] != 0 || frame.mJitter[1] != 0);
+
+            // empty subpass belongs to the recorder containing its offset
+            if (subpassBegin == subpassEnd) {
+                if (subpassBegin < drawBegin || (subpassBegin >= drawEnd && !lastRecorder))
+                    continue;
+            } else if (std::max(subpassBegin, drawBegin) >= std::min(subpassEnd, drawEnd)) {
+                continue;
+            }
+            const bool firstRecord = (drawBegin <= subpassBegin);
+            const bool lastRecord = (subpassEnd <= drawEnd);
+            // the second phase is drawn after the occlusion test, subpasses with two phases bind their targets
+            const bool twoPhase = mTwoPhaseOcclusion && subpass.mOcclusionCulling &&
+                subpass.mDepthStencilAttachment && subpass.mOcclusion.mPacketCount;
+            const bool renderPass = commandList4 && !twoPhase &&
+                (!subpass.mOutputAttachments.empty() || subpass.mDepthStencilAttachment);
+
+            std::optional<DX12EventScope> subpassEvent;
+            if (pMarkers) {
+                if (!passEvent) {
+                    passEvent.emplace(pCommandList, pMarkers->pass(passID));
+                }
+                subpassEvent.emplace(pCommandList, pMarkers->subpass(passID, subpassID));
+            }
+
+            if (mBreadcrumbs && firstRecord) {
+                mBreadcrumbs->beginSubpass(commandList2.get(), pContext->mFrameIndex, profiledSubpass);
+            }
+            if (mGpuProfiler) {
+                if (firstRecord) {
+                    mGpuProfiler->beginSubpass(pCommandList, pContext->mFrameIndex, profiledSubpass);
+                }
+                mGpuProfiler->beginStatistics(pCommandList, pContext->mFrameIndex, profiledSubpass, rangeID);
+            }
+
+            if (!viewportSet) {
+                if (!pass.mViewports.empty()) {
+                    Expects(pass.mViewports.size() == 1);
+                    static_assert(sizeof(D3D12_VIEWPORT) == sizeof(VIEWPORT));
+                    auto viewport = pass.mViewports[0];
+                    viewport.mWidth = std::max(1.0f, std::floor(viewport.mWidth * resolutionScale));
+                    viewport.mHeight = std::max(1.0f, std::floor(viewport.mHeight * resolutionScale));
+                    pCommandList->RSSetViewports(1, alias_cast<const D3D12_VIEWPORT*>(&viewport));
+                }
+                if (!pass.mScissorRects.empty()) {
+                    Expects(pass.mScissorRects.size() == 1);
+                    static_assert(sizeof(D3D12_RECT) == sizeof(RECT));
+                    auto rect = pass.mScissorRects[0];
+                    rect.mRight = rect.mLeft + std::max(1u, uint32_t((rect.mRight - rect.mLeft) * resolutionScale));
+                    rect.mBottom = rect.mTop + std::max(1u, uint32_t((rect.mBottom - rect.mTop) * resolutionScale));
+                    pCommandList->RSSetScissorRects(1, alias_cast<const D3D12_RECT*>(&rect));
+                }
+                viewportSet = true;
+            }
+
+            // draws [recordBegin, recordEnd) of the subpass, per pass descriptors are bound before the first queue
+            // indirect queues are culled on gpu every frame and never cached
+            // packets are predicated by the subpass occlusion predicates if given
+            const auto& cam = viewCamera(subpass.mView);
+            const auto& prevCam = prevViewCamera(subpass.mView);
+            const DX12MeshletCuller culler(cam);
+            Matrix4f proj = cam.mProj;
+            if (jittered) {
+                jitterProjection(proj, Vector2f(frame.mJitter[0], frame.mJitter[1]));
+            }
+            auto recordQueues = [&](const DX12VisibleDraws& draws, uint32_t recordBegin, uint32_t recordEnd,
+                bool indirectQueues, ID3D12Resource* pPredicates) {
+                bool passBound = false;
+                uint32_t drawID = subpassBegin;
+                for (const auto& queue : subpass.mOrderedRenderQueue) {
+                    const auto queueBegin = drawID;
+                    const auto queueEnd = queueBegin + gsl::narrow_cast<uint32_t>(queue.mDrawPackets.size());
+                    drawID = queueEnd;
+                    if (std::max(queueBegin, recordBegin) >= std::min(queueEnd, recordEnd)) {
+                        continue;
+                    }
+                    // indirect queue is drawn by the recorder containing its first packet
+                    const bool indirect = !queue.mIndirectGroups.empty();
+                    if (indirect && (!indirectQueues || queueBegin < recordBegin)) {
+                        continue;
+                    }
+
+                    FrameArenaScope batchScope(*arenas.mPerBatch);
+                    default_init_vector<std::byte> perPassCB(arenas.mPerBatch);
+
+                    std::optional<DX12EventScope> queueEvent;
+                    if (pMarkers) {
+                        const auto queueID = gsl::narrow_cast<uint32_t>(&queue - subpass.mOrderedRenderQueue.data());
+                        queueEvent.emplace(pCommandList, pMarkers->queue(queueID));
+                    }
+
+                    // root signature and per pass descriptors are bound once per subpass
+                    state.setRootSignature(subpass.mRootSignature.get());
+                    if (!passBound) {
+                        // PerPass Descriptors
+                        for (const auto& collection : subpass.mDescriptors) {
+                            if (collection.mIndex.mUpdate != UpdateEnum::PerPass) {
+                                continue;
+                            }
+                            if (std::holds_alternative<SSV_>(collection.mIndex.mType)) {
+                                continue;
+                            }
+                            visit(overload(
+                                [&](Persistent_) {
+                                    for (const auto& list : collection.mResourceViewLists) {
+                                        Expects(std::holds_alternative<Table_>(collection.mIndex.mType));
+                                        Expects(list.mCapacity);
+                                        state.setDescriptorTable(list.mSlot, list.mGpuOffset);
+                                    }
+                                },
+                                [&](Dynamic_) {
+                                    for (const auto& list : collection.mResourceViewLists) {
+                                        Expects(std::holds_alternative<Table_>(collection.mIndex.mType));
+                                        Expects(list.mCapacity);
+                                        auto descs = mDescriptors.allocateCircular(list.mCapacity);
+                                        size_t descID = 0;
+                                        for (const auto& range : list.mRanges) {
+                                            for (const auto& subrange : range.mSubranges) {
+                                                visit(overload(
+                                                    [&](EngineSource_) {
+                                                        for (const auto& attr : subrange.mDescriptors) {
+                                                            visit(overload(
+                                                                [&](Descriptor::ConstantBuffer_) {
+                                                                    bool foundDescriptor = false;
+                                                                    for (const auto& cb : subpass.mConstantBuffers) {
+                                                                        if (cb.mIndex != collection.mIndex)
+                                                                            continue;
+
+                                                                        Expects(cb.mSize);
+                                                                        auto sizeCB = boost::alignment::align_up(cb.mSize, 256);
+                                                                        perPassCB.clear();
+                                                                        perPassCB.resize(sizeCB);
+                                                                        auto* pData = perPassCB.data();
+                                                                        for (const auto& constant : cb.mConstants) {
+                                                                            pData = perPassCB.data() + constant.mOffset;
+                                                                            visit(overload(
+                                                                                [&](EngineSource_) {
+                                                                                    visit(overload(
+                                                                                        [&](Data::Proj_) {
+                                                                                            Expects(pData + sizeof(Matrix4f) <= perPassCB.data() + perPassCB.size());
+                                                                                            memcpy(pData, &proj, sizeof(Matrix4f));
+                                                                                            pData += sizeof(Matrix4f);
+                                                                                        },
+                                                                                        [&](Data::View_) {
+                                                                                            Expects(pData + sizeof(Matrix4f) <= perPassCB.data() + perPassCB.size());
+                                                                                            memcpy(pData, &cam.mView, sizeof(Matrix4f));
+                                                                                            pData += sizeof(Matrix4f);
+                                                                                        },
+                                                                                        [&](Data::WorldView_) {
+                                                                                            throw std::runtime_error("WorldView cannot be per pass");
+                                                                                        },
+                                                                                        [&](Data::WorldInvT_) {
+                                                                                            throw std::runtime_error("WorldInvT cannot be per pass");
+                                                                                        },
+                                                                                        [&](Data::TextureIndices_) {
+                                                                                            throw std::runtime_error("TextureIndices cannot be per pass");
+                                                                                        },
+                                                                                        [&](Data::MaterialIndex_) {
+                                                                                            throw std::runtime_error("MaterialIndex cannot be per pass");
+                                                                                        },
+                                                                                        [&](Data::PrevWorldView_) {
+                                                                                            throw std::runtime_error("PrevWorldView cannot be per pass");
+                                                                                        },
+                                                                                        [&](Data::ViewportScale_) {
+                                                                                            // screen sized inputs were rendered at the frame scale, upscaled ones at the output
+                                                                                            const float s = renderResolution ? frame.mResolutionScale : 1;
+                                                                                            const float scale[2] = { s, s };
+                                                                                            Expects(pData + sizeof(scale) <= perPassCB.data() + perPassCB.size());
+                                                                                            memcpy(pData, scale, sizeof(scale));
+                                                                                            pData += sizeof(scale);
+                                                                                        },
+                                                                                        [&](Data::Jitter_) {
+                                                                                            // read by the upscaling subpass to undo the offset of its inputs
+                                                                                            const float zero[2] = {};
+                                                                                            const float* jitter = renderResolution ? frame.mJitter : zero;
+                                                                                            Expects(pData + sizeof(frame.mJitter) <= perPassCB.data() + perPassCB.size());
+                                                                                            memcpy(pData, jitter, sizeof(frame.mJitter));
+                                                                                            pData += sizeof(frame.mJitter);
+                                                                                        },
+                                                                                        [](std::monostate) {
+                                                                                            throw std::runtime_error("engine source constant cannot be monostate");
+                                                                                        }
+                                                                                    ), constant.mDataType);
+                                                                                },
+                                                                                [&](RenderTargetSource_) {
+                                                                                    throw std::runtime_error("dynamic constant cannot be render target source");
+                                                                                },
+                                                                                [&](MaterialSource_) {
+                                                                                    throw std::runtime_error("dynamic constant cannot be material source");
+                                                                                }
+                                                                            ), constant.mSource);
+                                                                        }
+                                                                        auto pos = uploadBuffer.upload(perPassCB.data(), gsl::narrow_cast<uint32_t>(perPassCB.size()), 1, 256);
+                                                                        D3D12_CONSTANT_BUFFER_VIEW_DESC desc{
+                                                                            pos.mResource->GetGPUVirtualAddress() + pos.mBufferOffset, (uint32_t)perPassCB.size()
+                                                                        };
+
+                                                                        auto d = mDescriptors.advance(descs.first, descID);
+                                                                        mDevice->CreateConstantBufferView(&desc, d.mCpuHandle);
+                                                                        foundDescriptor = true;
+                                                                        break;
+                                                                    }
+                                                                    if (!foundDescriptor) {
+                                                                        throw std::runtime_error("constant buffer not found");
+                                                                    }
+                                                                },
+                                                                [&](Descriptor::PointLights_) {
+                                                                    if (!subpass.mLightCulling) {
+                                                                        throw std::runtime_error("PointLights needs light culling");
+                                                                    }
+                                                                    createDX12PointLightsView(mDevice, subpass.mLights, pContext->mFrameIndex,
+                                                                        mDescriptors.advance(descs.first, descID).mCpuHandle);
+                                                                },
+                                                                [&](Descriptor::LightGrid_) {
+                                                                    if (!subpass.mLightCulling) {
+                                                                        throw std::runtime_error("LightGrid needs light culling");
+                                                                    }
+                                                                    createDX12LightGridView(mDevice, subpass.mLights,
+                                                                        mDescriptors.advance(descs.first, descID).mCpuHandle);
+                                                                },
+                                                                [&](Descriptor::LightIndices_) {
+                                                                    if (!subpass.mLightCulling) {
+                                                                        throw std::runtime_error("LightIndices needs light culling");
+                                                                    }
+                                                                    createDX12LightIndicesView(mDevice, subpass.mLights,
+                                                                        mDescriptors.advance(descs.first, descID).mCpuHandle);
+                                                                },
+                                                                [&](Descriptor::MaterialConstants_) {
+                                                                    if (!mMaterialConstants) {
+                                                                        throw std::runtime_error("MaterialConstants needs a material constant pool");
+                                                                    }
+                                                                    mMaterialConstants->createView(mDevice,
+                                                                        mDescriptors.advance(descs.first, descID).mCpuHandle);
+                                                                },
+                                                                [&](auto) {
+                                                                    throw std::runtime_error("not supported yet");
+                                                                }
+                                                            ), attr.mDataType);
+                                                            ++descID;
+                                                        }
+                                                    },
+                                                    [&](RenderTargetSource_) {
+                                                        for (const auto& attr : subrange.mDescriptors) {
+                                                            ++descID;
+                                                        }
+                                                        throw std::runtime_error("dynamic descriptor cannot be render target source");
+                                                    },
+                                                    [&](MaterialSource_) {
+                                                        for (const auto& attr : subrange.mDescriptors) {
+                                                            ++descID;
+                                                        }
+                                                        throw std::runtime_error("not supported yet");
+                                                    }
+                                                ), subrange.mSource);
+                                            }
+                                        }
+                                        state.setDescriptorTable(list.mSlot, descs.first.mGpuHandle);
+                                    }
+                                }
+                            ), collection.mIndex.mPersistency);
+                        
+                            
+                            for (const auto& list : collection.mSamplerLists) {
+                                throw std::runtime_error("not supported yet");
+                            }
+                        }
+                        passBound = true;
+                    }
+
+                    if (indirect) {
+                        executeDX12IndirectDraws(pCommandList, queue, pContext->mFrameIndex);
+                        state.invalidate();
+                    } else {
+                        executeDrawPackets(mDevice, state, mDescriptors, uploadBuffer, queue,
+                            std::max(queueBegin, recordBegin) - queueBegin,
+                            std::min(queueEnd, recordEnd) - queueBegin,
+                            draws, queueBegin, cam, prevCam, culler, pMarkers, *arenas.mPerInstance,
+                            pPredicates, subpassBegin);
+                    }
+                } // ordered queue
+            };
+
             //---------------------------------------------------
             // Pre-Subpass
+            if (firstRecord && !subpass.mAliasingBarriers.empty()) {
+                // aliased framebuffer takes over its heap region, previous contents are undefined
+                barriers.clear();
+                for (const auto& fb : subpass.mAliasingBarriers) {
+                    barriers.emplace_back(CD3DX12_RESOURCE_BARRIER::Aliasing(
+                        nullptr, resource.mFramebuffers[fb.mHandle].get()));
+                }
+                pCommandList->ResourceBarrier(gsl::narrow_cast<uint32_t>(barriers.size()), barriers.data());
+                Core::Counters::add(Core::Counter::Barriers, barriers.size());
+                for (const auto& fb : subpass.mAliasingBarriers) {
+                    pCommandList->DiscardResource(resource.mFramebuffers[fb.mHandle].get(), nullptr);
+                }
+            }
+            // static casters are redrawn into the cache when they changed, moving casters are drawn over its copy
+            const bool shadowCache = subpass.mShadowCaching && subpass.mDepthStencilAttachment &&
+                subpass.mShadowCache.mDepthStencil;
+            if (firstRecord && shadowCache) {
+                if (frame.mShadowRefresh[profiledSubpass]) {
+                    beginDX12ShadowCache(pCommandList, subpass.mShadowCache);
+                    recordQueues(frame.mShadowCasters, subpassBegin, subpassEnd, false, nullptr);
+                    endDX12ShadowCache(pCommandList, subpass.mShadowCache);
+                }
+                copyDX12ShadowCache(pCommandList, subpass.mShadowCache,
+                    resource.mFramebuffers[subpass.mDepthStencilAttachment->mFramebuffer.mHandle].get());
+            }
             rtvs.clear();
             for (const auto& rt : subpass.mOutputAttachments) {
                 D3D12_CPU_DESCRIPTOR_HANDLE rtv;
@@ -330,6 +991,9 @@ void DX12FrameQueue::renderFrame(const DX12FrameContext* pContext, std::pmr::mem
                 }
                 rtvs.emplace_back(rtv);
 
+                if (!firstRecord || renderPass)
+                    continue;
+
                 visit(overload(
                     [&](const ClearColor& v) {
                         pCommandList->ClearRenderTargetView(
@@ -345,329 +1009,732 @@ void DX12FrameQueue::renderFrame(const DX12FrameContext* pContext, std::pmr::mem
             if (subpass.mDepthStencilAttachment) {
                 const auto& ds = *subpass.mDepthStencilAttachment;
                 dsv = resource.mDSVs.getCpuHandle(ds.mDescriptor.mHandle);
-                visit(overload(
-                    [&](const ClearColor& v) {
-                        throw std::runtime_error("DSV should not use clear color");
-                    },
-                    [&](const ClearDepthStencil& v) {
-                        D3D12_CLEAR_FLAGS flags = {};
-                        if (v.mClearDepth)
-                            flags |= D3D12_CLEAR_FLAG_DEPTH;
-                        if (v.mClearStencil)
-                            flags |= D3D12_CLEAR_FLAG_STENCIL;
-                        pCommandList->ClearDepthStencilView(dsv, flags,
-                            v.mDepthClearValue, v.mStencilClearValue, 0, nullptr);
-                    },
-                    [](const auto&) {}
-                ), ds.mLoadOp);
+                if (firstRecord && !renderPass && !shadowCache) {
+                    visit(overload(
+                        [&](const ClearColor& v) {
+                            throw std::runtime_error("DSV should not use clear color");
+                        },
+                        [&](const ClearDepthStencil& v) {
+                            D3D12_CLEAR_FLAGS flags = {};
+                            if (v.mClearDepth)
+                                flags |= D3D12_CLEAR_FLAG_DEPTH;
+                            if (v.mClearStencil)
+                                flags |= D3D12_CLEAR_FLAG_STENCIL;
+                            pCommandList->ClearDepthStencilView(dsv, flags,
+                                v.mDepthClearValue, v.mStencilClearValue, 0, nullptr);
+                        },
+                        [](const auto&) {}
+                    ), ds.mLoadOp);
+                }
             }
 
-            if (!rtvs.empty() || subpass.mDepthStencilAttachment) {
+            if (renderPass) {
+                beginDX12RenderPass(commandList4.get(), rsl, subpass, rtvs, dsv,
+                    !firstRecord, !lastRecord, shadowCache, renderTargets);
+            } else if (!rtvs.empty() || subpass.mDepthStencilAttachment) {
                 pCommandList->OMSetRenderTargets(
                     gsl::narrow_cast<uint32_t>(rtvs.size()), rtvs.empty() ? nullptr : rtvs.data(),
                     FALSE, subpass.mDepthStencilAttachment ? &dsv : nullptr
                 );
             }
+            // the coarser of the subpass rate and the image rate is used, images need tier 2
+            const bool shadingRateImage = shadingRateImages && subpass.mShadingRateImage;
+            const bool shadingRate = commandList5 &&
+                (subpass.mShadingRate != D3D12_SHADING_RATE_1X1 || shadingRateImage);
+            auto bindShadingRate = [&](bool bind) {
+                if (!shadingRate)
+                    return;
+                if (!bind) {
+                    commandList5->RSSetShadingRate(D3D12_SHADING_RATE_1X1, nullptr);
+                    if (shadingRateImage) {
+                        commandList5->RSSetShadingRateImage(nullptr);
+                    }
+                    return;
+                }
+                const D3D12_SHADING_RATE_COMBINER combiners[D3D12_RS_SET_SHADING_RATE_COMBINER_COUNT] = {
+                    D3D12_SHADING_RATE_COMBINER_PASSTHROUGH,
+                    D3D12_SHADING_RATE_COMBINER_MAX,
+                };
+                commandList5->RSSetShadingRate(subpass.mShadingRate, shadingRateImage ? combiners : nullptr);
+                if (shadingRateImage) {
+                    commandList5->RSSetShadingRateImage(
+                        resource.mFramebuffers[subpass.mShadingRateImage->mHandle].get());
+                }
+            };
             //---------------------------------------------------
             // Subpass
-            {
-                Camera cam{};
-                cam.mViewSpace = OpenGL;
-                cam.mNDC = Direct3D;
-                //cam.lookAt(Vector3f(0, 2.0f, 0), Vector3f(0, 1, 0), Vector3f(0, 0, 1));
-                cam.lookTo(Vector3f(0, 0, 1.7f), Vector3f(-1.f, 0, 0.0f), Vector3f(0, 0.0f, 1.0f));
-                cam.perspective(0.25f * S_PI, 16.0f / 9.0f, 0.25f, 512.0f);
-
-                D3D12_PRIMITIVE_TOPOLOGY prevTopology = {};
-                ID3D12PipelineState* pPrevPSO = nullptr;
-                for (const auto& queue : subpass.mOrderedRenderQueue) {
-                    pCommandList->SetGraphicsRootSignature(subpass.mRootSignature.get());
+            bindShadingRate(true);
+            recordQueues(visible, std::max(subpassBegin, drawBegin), std::min(subpassEnd, drawEnd), true, nullptr);
+            bindShadingRate(false);
 
-                    // PerPass Descriptors
-                    for (const auto& collection : subpass.mDescriptors) {
-                        if (collection.mIndex.mUpdate != UpdateEnum::PerPass) {
-                            continue;
-                        }
-                        if (std::holds_alternative<SSV_>(collection.mIndex.mType)) {
+            if (renderPass) {
+                commandList4->EndRenderPass();
+            }
+
+            //---------------------------------------------------
+            // Post-Subpass
+            if (!lastRecord) {
+                continue;
+            }
+            if (subpass.mOcclusionCulling && subpass.mDepthStencilAttachment) {
+                const auto& ds = *subpass.mDepthStencilAttachment;
+                dispatchDX12OcclusionCulling(mDevice, pCommandList, mDescriptors, mOcclusionPipeline,
+                    cam, resource.mFramebuffers[ds.mFramebuffer.mHandle].get(),
+                    subpass.mOcclusion, pContext->mFrameIndex, resolutionScale, twoPhase);
+                state.invalidate();
+
+                // instances culled by the results of the slot, drawn if the depth drawn so far does not hide them
+                if (twoPhase) {
+                    pCommandList->OMSetRenderTargets(
+                        gsl::narrow_cast<uint32_t>(rtvs.size()), rtvs.empty() ? nullptr : rtvs.data(), FALSE, &dsv);
+                    bindShadingRate(true);
+                    recordQueues(frame.mOccluded, subpassBegin, subpassEnd, false,
+                        subpass.mOcclusion.mPredicates.get());
+                    bindShadingRate(false);
+                }
+            }
+            if (!subpass.mPostViewTransitions.empty()) {
+                barriers.clear();
+                for (const auto& t : subpass.mPostViewTransitions) {
+                    auto flags = getDX12(t.mFlags);
+                    if (!splitBarriers) {
+                        if (flags == D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY)
                             continue;
-                        }
-                        visit(overload(
-                            [&](Persistent_) {
-                                for (const auto& list : collection.mResourceViewLists) {
-                                    Expects(std::holds_alternative<Table_>(collection.mIndex.mType));
-                                    Expects(list.mCapacity);
-                                    pCommandList->SetGraphicsRootDescriptorTable(list.mSlot, list.mGpuOffset);
-                                }
-                            },
-                            [&](Dynamic_) {
-                                for (const auto& list : collection.mResourceViewLists) {
-                                    Expects(std::holds_alternative<Table_>(collection.mIndex.mType));
-                                    Expects(list.mCapacity);
-                                    auto descs = mDescriptors.allocateCircular(list.mCapacity);
-                                    size_t descID = 0;
-                                    for (const auto& range : list.mRanges) {
-                                        for (const auto& subrange : range.mSubranges) {
-                                            visit(overload(
-                                                [&](EngineSource_) {
-                                                    for (const auto& attr : subrange.mDescriptors) {
-                                                        visit(overload(
-                                                            [&](Descriptor::ConstantBuffer_) {
-                                                                bool foundDescriptor = false;
-                                                                for (const auto& cb : subpass.mConstantBuffers) {
-                                                                    if (cb.mIndex != collection.mIndex)
-                                                                        continue;
-
-                                                                    Expects(cb.mSize);
-                                                                    auto sizeCB = boost::alignment::align_up(cb.mSize, 256);
-                                                                    perPassCB.clear();
-                                                                    perPassCB.resize(sizeCB);
-                                                                    auto* pData = perPassCB.data();
-                                                                    for (const auto& constant : cb.mConstants) {
-                                                                        visit(overload(
-                                                                            [&](EngineSource_) {
-                                                                                visit(overload(
-                                                                                    [&](Data::Proj_) {
-                                                                                        Expects(pData + sizeof(Matrix4f) <= perPassCB.data() + perPassCB.size());
-                                                                                        memcpy(pData, &cam.mProj, sizeof(Matrix4f));
-                                                                                        pData += sizeof(Matrix4f);
-                                                                                    },
-                                                                                    [&](Data::View_) {
-                                                                                        Expects(pData + sizeof(Matrix4f) <= perPassCB.data() + perPassCB.size());
-                                                                                        memcpy(pData, &cam.mView, sizeof(Matrix4f));
-                                                                                        pData += sizeof(Matrix4f);
-                                                                                    },
-                                                                                    [&](Data::WorldView_) {
-                                                                                        throw std::runtime_error("WorldView cannot be per pass");
-                                                                                    },
-                                                                                    [&](Data::WorldInvT_) {
-                                                                                        throw std::runtime_error("WorldInvT cannot be per pass");
-                                                                                    },
-                                                                                    [](std::monostate) {
-                                                                                        throw std::runtime_error("engine source constant cannot be monostate");
-                                                                                    }
-                                                                                ), constant.mDataType);
-                                                                            },
-                                                                            [&](RenderTargetSource_) {
-                                                                                throw std::runtime_error("dynamic constant cannot be render target source");
-                                                                            },
-                                                                            [&](MaterialSource_) {
-                                                                                throw std::runtime_error("dynamic constant cannot be material source");
-                                                                            }
-                                                                        ), constant.mSource);
-                                                                    }
-                                                                    auto pos = mUploadBuffer.upload(perPassCB.data(), gsl::narrow_cast<uint32_t>(perPassCB.size()), 1, 256);
-                                                                    D3D12_CONSTANT_BUFFER_VIEW_DESC desc{
-                                                                        pos.mResource->GetGPUVirtualAddress() + pos.mBufferOffset, (uint32_t)perPassCB.size()
-                                                                    };
-
-                                                                    auto d = mDescriptors.advance(descs.first, descID);
-                                                                    mDevice->CreateConstantBufferView(&desc, d.mCpuHandle);
-                                                                    foundDescriptor = true;
-                                                                    break;
-                                                                }
-                                                                if (!foundDescriptor) {
-                                                                    throw std::runtime_error("constant buffer not found");
-                                                                }
-                                                            },
-                                                            [&](auto) {
-                                                                throw std::runtime_error("not supported yet");
-                                                            }
-                                                        ), attr.mDataType);
-                                                        ++descID;
-                                                    }
-                                                },
-                                                [&](RenderTargetSource_) {
-                                                    for (const auto& attr : subrange.mDescriptors) {
-                                                        ++descID;
-                                                    }
-                                                    throw std::runtime_error("dynamic descriptor cannot be render target source");
-                                                },
-                                                [&](MaterialSource_) {
-                                                    for (const auto& attr : subrange.mDescriptors) {
-                                                        ++descID;
-                                                    }
-                                                    throw std::runtime_error("not supported yet");
-                                                }
-                                            ), subrange.mSource);
-                                        }
-                                    }
-                                    pCommandList->SetGraphicsRootDescriptorTable(list.mSlot, descs.first.mGpuHandle);
-                                }
+                        flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+                    }
+                    ID3D12Resource* pResource = nullptr;
+                    if (t.mFramebuffer.mHandle == 0) {
+                        pResource = resource.mFramebuffers[pContext->mBackBufferIndex].get();
+                    } else {
+                        pResource = resource.mFramebuffers[t.mFramebuffer.mHandle].get();
+                    }
+                    D3D12_RESOURCE_STATES prev = static_cast<D3D12_RESOURCE_STATES>(t.mSource);
+                    D3D12_RESOURCE_STATES post = static_cast<D3D12_RESOURCE_STATES>(t.mTarget);
+
+                    barriers.emplace_back(CD3DX12_RESOURCE_BARRIER::Transition(pResource, prev, post,
+                        D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, flags));
+                }
+                if (!barriers.empty()) {
+                    pCommandList->ResourceBarrier(gsl::narrow_cast<uint32_t>(barriers.size()), barriers.data());
+                    Core::Counters::add(Core::Counter::Barriers, barriers.size());
+                }
+            }
+            if (mGpuProfiler) {
+                mGpuProfiler->endStatistics(pCommandList, pContext->mFrameIndex, profiledSubpass, rangeID);
+                mGpuProfiler->endSubpass(pCommandList, pContext->mFrameIndex, profiledSubpass);
+            }
+            if (mBreadcrumbs && lastRecord) {
+                mBreadcrumbs->endSubpass(commandList2.get(), pContext->mFrameIndex, profiledSubpass);
+            }
+        }
+    }
+
+    // timestamps are resolved after the last subpass
+    if (mGpuProfiler && lastRecorder) {
+        mGpuProfiler->endFrame(pCommandList, pContext->mFrameIndex);
+    }
+}
+
+void DX12FrameQueue::cullFrame(DX12FrameRecording& frame, gsl::span<const CameraData> views,
+    std::pmr::memory_resource* mr
+) {
+    const auto* pContext = frame.mContext;
+    const auto& pipeline = pContext->mRenderSolution->mPipelines[pContext->mPipelineID];
+    Expects(!views.empty());
+
+    // batches drawn on cpu path, sorted for lookup, shared by every view
+    auto& batches = frame.mBatches;
+    std::pmr::vector<uint8_t> viewDrawn(views.size(), 0, mr);
+    for (const auto& pass : pipeline.mPasses) {
+        for (const auto& subpass : pass.mGraphicsSubpasses) {
+            viewDrawn[subpass.mView < views.size() ? subpass.mView : 0] = 1;
+            for (const auto& queue : subpass.mOrderedRenderQueue) {
+                if (!queue.mIndirectGroups.empty())
+                    continue;
+                for (const auto& packet : queue.mDrawPackets) {
+                    if (packet.mBatch)
+                        batches.emplace_back(packet.mBatch);
+                }
+            }
+        }
+    }
+    std::sort(batches.begin(), batches.end());
+    batches.erase(std::unique(batches.begin(), batches.end()), batches.end());
+
+    auto& maskOffsets = frame.mMaskOffsets;
+    maskOffsets.reserve(batches.size() + 1);
+    maskOffsets.emplace_back(0);
+    for (const auto* pBatch : batches) {
+        maskOffsets.emplace_back(maskOffsets.back() + pBatch->mWorldBoundsStride);
+    }
+    const auto maskStride = maskOffsets.back();
+    auto& masks = frame.mMasks;
+    masks.resize(size_t(maskStride) * views.size());
+
+    // test fixed size chunks of batches, spread over task threads
+    constexpr uint32_t chunkSize = 1024;
+    static_assert(chunkSize % DX12CullingLanes == 0);
+    struct Chunk {
+        uint32_t mView;
+        uint32_t mBatchID;
+        uint32_t mBegin;
+        uint32_t mEnd;
+    };
+    std::pmr::vector<Chunk> chunks(mr);
+    std::pmr::vector<DX12Frustum> frustums(mr);
+    frustums.reserve(views.size());
+    for (uint32_t view = 0; view != views.size(); ++view) {
+        frustums.emplace_back(makeDX12Frustum(views[view]));
+        if (!viewDrawn[view])
+            continue;
+        for (uint32_t batchID = 0; batchID != batches.size(); ++batchID) {
+            const auto count = batches[batchID]->mObjectCount;
+            // hierarchies are walked whole
+            if (!batches[batchID]->mBvhNodes.empty()) {
+                chunks.emplace_back(Chunk{ view, batchID, 0, count });
+                continue;
+            }
+            for (uint32_t begin = 0; begin < count; begin += chunkSize) {
+                chunks.emplace_back(Chunk{ view, batchID, begin, std::min(begin + chunkSize, count) });
+            }
+        }
+    }
+
+    auto cullChunks = [&](size_t chunkBegin, size_t chunkEnd) {
+        for (size_t chunkID = chunkBegin; chunkID != chunkEnd; ++chunkID) {
+            const auto& chunk = chunks[chunkID];
+            const auto& batch = *batches[chunk.mBatchID];
+            const auto& frustum = frustums[chunk.mView];
+            auto* pMask = masks.data() + size_t(maskStride) * chunk.mView + maskOffsets[chunk.mBatchID];
+            if (batch.mBvhNodes.empty()) {
+                cullDX12WorldBounds(batch, frustum, chunk.mBegin, chunk.mEnd, pMask);
+            } else {
+                cullDX12Bvh(batch, frustum, pMask);
+            }
+        }
+    };
+
+    if (!mJobSystem || pContext->mRecorders.empty()) {
+        cullChunks(0, chunks.size());
+    } else {
+        // a few ranges per worker, stolen by idle threads
+        const size_t numRanges = size_t(mJobSystem->threadCount() + 1) * 4;
+        mJobSystem->parallel_for(0, chunks.size(), std::max<size_t>(1, chunks.size() / numRanges),
+            [&](size_t chunkBegin, size_t chunkEnd) {
+                STAR_PROFILE_SCOPE("DX12FrameQueue::cullChunks");
+                cullChunks(chunkBegin, chunkEnd);
+            });
+    }
+}
+
+void DX12FrameQueue::compactVisibleDraws(DX12FrameRecording& frame) {
+    const auto* pContext = frame.mContext;
+    const auto& pipeline = pContext->mRenderSolution->mPipelines[pContext->mPipelineID];
+    const auto& batches = frame.mBatches;
+    const auto& maskOffsets = frame.mMaskOffsets;
+    const auto& masks = frame.mMasks;
+    auto& visible = frame.mVisible;
+    auto& casters = frame.mShadowCasters;
+    auto& occluded = frame.mOccluded;
+    // level in high bits, position within the draw in low bits
+    std::pmr::vector<uint64_t> lodKeys(visible.mInstances.get_allocator().resource());
+
+    // levels of the instances of a draw from drawBegin, selected for the view of the subpass
+    auto selectLevels = [&](DX12VisibleDraws& draws, size_t drawBegin, const DX12DrawPacket& packet,
+        const DX12LodSelector& lodSelector) {
+        draws.mLevels.resize(draws.mInstances.size(), 0);
+        if (!packet.mMesh || packet.mMesh->mLods.empty())
+            return;
+        bool sorted = true;
+        for (auto i = drawBegin; i != draws.mInstances.size(); ++i) {
+            draws.mLevels[i] = lodSelector.select(*packet.mMesh, *packet.mBatch, draws.mInstances[i]);
+            sorted = sorted && (i == drawBegin || draws.mLevels[i - 1] <= draws.mLevels[i]);
+        }
+        // group instances of a level, keeping their order
+        if (!sorted) {
+            lodKeys.clear();
+            for (auto i = drawBegin; i != draws.mInstances.size(); ++i) {
+                lodKeys.emplace_back((uint64_t(draws.mLevels[i]) << 32) | gsl::narrow_cast<uint32_t>(i - drawBegin));
+            }
+            std::sort(lodKeys.begin(), lodKeys.end());
+            for (size_t k = 0; k != lodKeys.size(); ++k) {
+                draws.mLevels[drawBegin + k] = uint8_t(lodKeys[k] >> 32);
+                // keys are reused to hold the reordered instances
+                lodKeys[k] = draws.mInstances[drawBegin + (lodKeys[k] & 0xFFFFFFFF)];
+            }
+            for (size_t k = 0; k != lodKeys.size(); ++k) {
+                draws.mInstances[drawBegin + k] = gsl::narrow_cast<uint32_t>(lodKeys[k]);
+            }
+        }
+    };
+
+    // compact visible instances in frame draw order
+    for (auto* pDraws : { &visible, &casters, &occluded }) {
+        pDraws->mInstances.clear();
+        pDraws->mDrawOffsets.clear();
+        pDraws->mLevels.clear();
+        pDraws->mDrawOffsets.emplace_back(0);
+    }
+    for (const auto& pass : pipeline.mPasses) {
+        for (const auto& subpass : pass.mGraphicsSubpasses) {
+            const auto view = subpass.mView < mCameras.size() ? subpass.mView : 0;
+            const auto& cam = mCameras[view];
+            const DX12LodSelector lodSelector(cam, mLodBias);
+            const DX12ShaderLevelSelector shaderLevelSelector(cam, mShaderLevel, mShaderLodDistance);
+            const auto* pViewMasks = masks.data() + size_t(maskOffsets.back()) * view;
+            // occlusion results of this frame slot, written when the slot was last rendered
+            const uint32_t* pOcclusion = nullptr;
+            if (subpass.mOcclusionCulling && pContext->mFrameIndex < subpass.mOcclusion.mReadbackData.size()) {
+                pOcclusion = subpass.mOcclusion.mReadbackData[pContext->mFrameIndex];
+            }
+            // objects not moved since their content was loaded are static casters
+            const bool shadowCache = subpass.mShadowCaching && subpass.mShadowCache.mDepthStencil;
+            uint32_t queueOffset = 0;
+            for (const auto& queue : subpass.mOrderedRenderQueue) {
+                const auto* pQueueOcclusion = pOcclusion ? pOcclusion + queueOffset : nullptr;
+                queueOffset += gsl::narrow_cast<uint32_t>(queue.mDrawInstances.size());
+
+                // indirect queues are culled on gpu and own no instances
+                const bool indirect = !queue.mIndirectGroups.empty();
+                for (const auto& packet : queue.mDrawPackets) {
+                    // streamed meshes are drawn once uploaded
+                    if (indirect || (packet.mMesh && !packet.mMesh->mResident)) {
+                        visible.mDrawOffsets.emplace_back(gsl::narrow_cast<uint32_t>(visible.mInstances.size()));
+                        casters.mDrawOffsets.emplace_back(gsl::narrow_cast<uint32_t>(casters.mInstances.size()));
+                        occluded.mDrawOffsets.emplace_back(gsl::narrow_cast<uint32_t>(occluded.mInstances.size()));
+                        continue;
+                    }
+                    const auto drawBegin = visible.mInstances.size();
+                    const auto casterBegin = casters.mInstances.size();
+                    const auto occludedBegin = occluded.mInstances.size();
+                    if (packet.mBatch) {
+                        auto iter = std::lower_bound(batches.begin(), batches.end(), packet.mBatch);
+                        Expects(iter != batches.end() && *iter == packet.mBatch);
+                        const auto* pMask = pViewMasks + maskOffsets[iter - batches.begin()];
+                        const auto& versions = packet.mBatch->mTransformVersions;
+                        for (uint32_t instanceID = 0; instanceID != packet.mInstanceCount; ++instanceID) {
+                            const auto slot = packet.mInstanceBegin + instanceID;
+                            const auto objectID = queue.mDrawInstances[slot];
+                            // culled instances are tested again in the second phase
+                            const bool culled = pQueueOcclusion && !pQueueOcclusion[slot];
+                            if (culled && !mTwoPhaseOcclusion)
+                                continue;
+                            // instance is drawn by the packet of its shader level
+                            if (packet.mShaderLevelCount > 1 && shaderLevelSelector.select(
+                                packet, *packet.mBatch, objectID) != packet.mShaderLevel)
+                                continue;
+                            if (!pMask[objectID])
+                                continue;
+                            if (culled) {
+                                occluded.mInstances.emplace_back(objectID);
+                            } else if (shadowCache && !versions[objectID]) {
+                                casters.mInstances.emplace_back(objectID);
+                            } else {
+                                visible.mInstances.emplace_back(objectID);
                             }
-                        ), collection.mIndex.mPersistency);
-                        
-                            
-                        for (const auto& list : collection.mSamplerLists) {
-                            throw std::runtime_error("not supported yet");
                         }
+                        selectLevels(visible, drawBegin, packet, lodSelector);
+                        selectLevels(casters, casterBegin, packet, lodSelector);
+                        selectLevels(occluded, occludedBegin, packet, lodSelector);
+                    } else if (shaderLevelSelector.select(packet) == packet.mShaderLevel) {
+                        visible.mInstances.insert(visible.mInstances.end(),
+                            queue.mDrawInstances.begin() + packet.mInstanceBegin,
+                            queue.mDrawInstances.begin() + packet.mInstanceBegin + packet.mInstanceCount);
+                        visible.mLevels.resize(visible.mInstances.size(), 0);
                     }
+                    visible.mDrawOffsets.emplace_back(gsl::narrow_cast<uint32_t>(visible.mInstances.size()));
+                    casters.mDrawOffsets.emplace_back(gsl::narrow_cast<uint32_t>(casters.mInstances.size()));
+                    occluded.mDrawOffsets.emplace_back(gsl::narrow_cast<uint32_t>(occluded.mInstances.size()));
+                }
+            }
+        }
+    }
+}
 
-                    for (const auto& pContent : queue.mContents) {
-                        const auto& content = *pContent;
-                        for (const auto& object : content.mIDs) {
-                            visit(overload(
-                                [&](const DrawCall_&) {
-                                    auto& id = object.mIndex;
-                                    const auto& dc = content.mDrawCalls.at(id);
-                                    std::visit(overload(
-                                        [&](FullScreenTriangle_) {
-                                            if (D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST != prevTopology) {
-                                                pCommandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-                                                prevTopology = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
-                                            }
-
-                                            pCommandList->IASetVertexBuffers(0, 0, nullptr);
-                                            pCommandList->IASetIndexBuffer(nullptr);
-
-                                            auto material = dc.mMaterial.get();
-
-                                            uint32_t shaderSolutionID{};
-                                            uint32_t shaderPipelineID{};
-                                            uint32_t shaderQueueID{};
-
-                                            const auto& queue = getSubpassData(*material,
-                                                solutionID, pipelineID, passID, subpassID,
-                                                shaderSolutionID, shaderPipelineID, shaderQueueID);
-
-                                            // materials
-                                            auto levelID = 0;
-                                            auto variantID = 0;
-                                            auto subpassID = 0;
-                                            for (const auto& shaderSubpass : queue.mLevels.at(levelID).mPasses.at(variantID).mSubpasses) {
-                                                // draw call
-                                                const auto& layoutID = shaderSubpass.mVertexLayoutIndex.at(0);
-                                                if (pPrevPSO != shaderSubpass.mStates.at(layoutID).mObject.get()) {
-                                                    pCommandList->SetPipelineState(shaderSubpass.mStates.at(layoutID).mObject.get());
-                                                    pPrevPSO = shaderSubpass.mStates.at(layoutID).mObject.get();
-                                                }
-
-                                                const auto& subpassData = material->mShaderData.at(shaderSolutionID).mPipelines.at(shaderPipelineID).mQueues.at(shaderQueueID).
-                                                    mLevels.at(levelID).mPasses.at(variantID).mSubpasses.at(subpassID);
-
-                                                buildDynamicDescriptors(mDevice, pCommandList,
-                                                    mDescriptors, mUploadBuffer,
-                                                    shaderSubpass, subpassData,
-                                                    cam, nullptr, 0,
-                                                    perInstanceCB);
-
-                                                pCommandList->DrawInstanced(3, 1, 0, 0);
-                                                ++subpassID;
-                                            }
-                                        },
-                                        [&](std::monostate) {
-                                            throw std::runtime_error("mesh drawcall not supported");
-                                        }
-                                    ), dc.mType);
-                                },
-                                [&](const ObjectBatch_&) {
-                                    auto& id = object.mIndex;
-                                    const auto& batch = content.mFlattenedObjects.at(id);
-                                    Expects(batch.mWorldTransforms.size() == batch.mMeshRenderers.size());
-                                    Expects(batch.mWorldTransformInvs.size() == batch.mMeshRenderers.size());
-                                    for (uint32_t objectID = 0; objectID != batch.mMeshRenderers.size(); ++objectID) {
-                                        const auto& renderer = batch.mMeshRenderers[objectID];
-
-                                        size_t materialID = 0;
-                                        for (const auto& material : renderer.mMaterials) {
-                                            const auto& mesh = *renderer.mMesh;
-                                            if (materialID >= mesh.mSubMeshes.size()) {
-                                                break;
-                                            }
-                                            const auto& submesh = mesh.mSubMeshes.at(materialID);
+void DX12FrameQueue::prepareFrame(DX12FrameRecording& frame, std::pmr::memory_resource* mr) {
+    const auto* pContext = frame.mContext;
+    auto& ring = *mRings[pContext->mRingID];
 
-                                            uint32_t shaderSolutionID{};
-                                            uint32_t shaderPipelineID{};
-                                            uint32_t shaderQueueID{};
+    // met BackBuffer's pre-condition
+    auto pCommandList = pContext->mCommandList.get();
+    if (mGpuProfiler) {
+        mGpuProfiler->beginFrame(pCommandList, pContext->mFrameIndex,
+            pContext->mRenderSolution->mPipelines[pContext->mPipelineID]);
+        frame.mResolutionScale = mResolutionScaler.update(mGpuProfiler->frameMilliseconds());
+    }
+    if (mEventMarkers) {
+        mEventMarkers->update(*pContext->mRenderWorks, pContext->mSolutionID, pContext->mPipelineID);
+    }
+    if (mBreadcrumbs) {
+        mBreadcrumbs->beginFrame(pContext->mFrameIndex, pContext->mFrameFenceId,
+            *pContext->mRenderWorks, pContext->mSolutionID, pContext->mPipelineID);
+    }
+    {
+        D3D12_RESOURCE_BARRIER barriers[] = {
+            CD3DX12_RESOURCE_BARRIER::Transition(
+                pContext->mRenderWorks->mFramebuffers[pContext->mBackBufferIndex].get(),
+                D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET),
+        };
+        pCommandList->ResourceBarrier(_countof(barriers), barriers);
+        Core::Counters::add(Core::Counter::Barriers, _countof(barriers));
+    }
 
-                                            const auto& queue = getSubpassData(*material,
-                                                solutionID, pipelineID, passID, subpassID,
-                                                shaderSolutionID, shaderPipelineID, shaderQueueID);
+    // draw offsets of subpasses, used to split recording between command lists
+    const auto& pipeline = pContext->mRenderSolution->mPipelines[pContext->mPipelineID];
+
+    // subpasses before the upscaling subpass render at the render scale, jittered by a subpixel of their resolution
+    if (hasUpscaling(pipeline) && !pContext->mRenderSolution->mFramebuffers.empty()) {
+        const auto& bb = pContext->mRenderSolution->mFramebuffers.front().mResource;
+        frame.mResolutionScale *= mRenderScale;
+        const float scale = frame.mResolutionScale;
+        // 8 samples per output pixel
+        const auto phases = gsl::narrow_cast<uint32_t>(std::ceil(8 / (scale * scale)));
+        const auto jitter = getHaltonJitter(pContext->mFrameFenceId, phases);
+        const float width = std::max(1.0f, std::floor(float(bb.mWidth) * scale));
+        const float height = std::max(1.0f, std::floor(float(bb.mHeight) * scale));
+        // ndc y points up, pixel rows down
+        frame.mJitter[0] = 2 * jitter.x() / width;
+        frame.mJitter[1] = -2 * jitter.y() / height;
+    }
+    auto& subpassOffsets = frame.mSubpassOffsets;
+    subpassOffsets.reserve(16);
+    subpassOffsets.emplace_back(0);
+    for (const auto& pass : pipeline.mPasses) {
+        for (const auto& subpass : pass.mGraphicsSubpasses) {
+            uint32_t count = 0;
+            for (const auto& queue : subpass.mOrderedRenderQueue) {
+                count += gsl::narrow_cast<uint32_t>(queue.mDrawPackets.size());
+            }
+            subpassOffsets.emplace_back(subpassOffsets.back() + count);
+        }
+    }
+    const auto drawCount = subpassOffsets.back();
+    frame.mDrawCount = drawCount;
 
-                                            // mesh
-                                            auto primTopology = static_cast<D3D12_PRIMITIVE_TOPOLOGY>(mesh.mIndexBuffer.mPrimitiveTopology);
-                                            if (primTopology != prevTopology) {
-                                                pCommandList->IASetPrimitiveTopology(primTopology);
-                                                prevTopology = primTopology;
-                                            }
+    // frustum culled before the slot was retired, occlusion results of the slot are ready now
+    compactVisibleDraws(frame);
+    Ensures(frame.mVisible.mDrawOffsets.size() == drawCount + 1);
 
-                                            pCommandList->IASetVertexBuffers(0,
-                                                gsl::narrow_cast<uint32_t>(mesh.mVertexBufferViews.size()),
-                                                mesh.mVertexBufferViews.data());
+    // shadow caches are refreshed when their static casters or the camera changed
+    frame.mShadowRefresh.assign(subpassOffsets.size() - 1, 0);
+    {
+        uint32_t subpassIndex = 0;
+        for (const auto& pass : pipeline.mPasses) {
+            for (const auto& subpass : pass.mGraphicsSubpasses) {
+                if (subpass.mShadowCaching && subpass.mShadowCache.mDepthStencil) {
+                    // caches are only modified before recording
+                    frame.mShadowRefresh[subpassIndex] = updateDX12ShadowCache(
+                        const_cast<DX12ShadowCache&>(subpass.mShadowCache), viewCamera(subpass.mView),
+                        frame.mShadowCasters,
+                        subpassOffsets[subpassIndex], subpassOffsets[subpassIndex + 1]);
+                }
+                ++subpassIndex;
+            }
+        }
+    }
 
-                                            if (mesh.mIndexBufferView.BufferLocation) {
-                                                pCommandList->IASetIndexBuffer(&mesh.mIndexBufferView);
-                                            } else {
-                                                pCommandList->IASetIndexBuffer(nullptr);
-                                            }
+    // refresh persistent constants of cpu driven queues, read by the recorders
+    for (const auto& pass : pipeline.mPasses) {
+        for (const auto& subpass : pass.mGraphicsSubpasses) {
+            const auto& cam = viewCamera(subpass.mView);
+            const auto& prevCam = prevViewCamera(subpass.mView);
+            for (const auto& queue : subpass.mOrderedRenderQueue) {
+                // persistent constants are only modified before recording
+                updateDX12PersistentConstants(pCommandList, ring.mUploadBuffer, cam.mView, prevCam.mView,
+                    const_cast<DX12UnorderedRenderQueue&>(queue));
+            }
+        }
+    }
 
-                                            // materials
-                                            auto levelID = 0;
-                                            auto variantID = 0;
-                                            auto subpassID = 0;
-                                            for (const auto& shaderSubpass : queue.mLevels.at(levelID).mPasses.at(variantID).mSubpasses) {
-                                                // draw call
-                                                const auto& layoutID = shaderSubpass.mVertexLayoutIndex.at(mesh.mLayoutID);
-                                                if (pPrevPSO != shaderSubpass.mStates.at(layoutID).mObject.get()) {
-                                                    pCommandList->SetPipelineState(shaderSubpass.mStates.at(layoutID).mObject.get());
-                                                    pPrevPSO = shaderSubpass.mStates.at(layoutID).mObject.get();
-                                                }
-
-                                                const auto& subpassData = material->mShaderData.at(shaderSolutionID).mPipelines.at(shaderPipelineID).mQueues.at(shaderQueueID).
-                                                    mLevels.at(levelID).mPasses.at(variantID).mSubpasses.at(subpassID);
-
-                                                buildDynamicDescriptors(mDevice, pCommandList,
-                                                    mDescriptors, mUploadBuffer,
-                                                    shaderSubpass, subpassData,
-                                                    cam, &batch, objectID,
-                                                    perInstanceCB);
-
-                                                pCommandList->DrawIndexedInstanced(submesh.mIndexCount, 1, submesh.mIndexOffset, 0, 0);
-                                                ++subpassID;
-                                            } // shader subpass
-                                            ++materialID;
-                                        } // material
-                                    } // mesh renderer
-                                } // object batch
-                            ), object.mType); // objects
-                        } // content
-                    } // unordered queue
-                } // ordered queue
-            } // subpass
+    // bin lights of light culled subpasses, the lists are read by the recorders
+    for (const auto& pass : pipeline.mPasses) {
+        for (const auto& subpass : pass.mGraphicsSubpasses) {
+            if (subpass.mLightCulling) {
+                dispatchDX12LightCulling(pCommandList, mLightCullingPipeline, viewCamera(subpass.mView),
+                    mPointLights, subpass.mLights, pContext->mFrameIndex);
+            }
+        }
+    }
 
-            //---------------------------------------------------
-            // Post-Subpass
-            if (subpass.mPostViewTransitions.empty()) {
-                continue;
-            }            
-            barriers.clear();
-            for (const auto& t : subpass.mPostViewTransitions) {
-                ID3D12Resource* pResource = nullptr;
-                if (t.mFramebuffer.mHandle == 0) {
-                    pResource = resource.mFramebuffers[pContext->mBackBufferIndex].get();
-                } else {
-                    pResource = resource.mFramebuffers[t.mFramebuffer.mHandle].get();
+    // cull gpu driven queues, their arguments are consumed by the recorders
+    frame.mComputeSubmitted = submitCompute(pContext);
+    frame.mComputeFence = mNextComputeFence - 1;
+    if (mIndirectPipeline.mPipelineState && !frame.mComputeSubmitted) {
+        for (const auto& pass : pipeline.mPasses) {
+            for (const auto& subpass : pass.mGraphicsSubpasses) {
+                for (const auto& queue : subpass.mOrderedRenderQueue) {
+                    dispatchDX12IndirectDraws(pCommandList, mIndirectPipeline, viewCamera(subpass.mView),
+                        queue, pContext->mFrameIndex);
                 }
-                D3D12_RESOURCE_STATES prev = static_cast<D3D12_RESOURCE_STATES>(t.mSource);
-                D3D12_RESOURCE_STATES post = static_cast<D3D12_RESOURCE_STATES>(t.mTarget);
+            }
+        }
+    }
+
+    uint32_t numRanges = 1;
+    if (mJobSystem && mMinDrawsPerRecorder && !pContext->mRecorders.empty()) {
+        numRanges = std::min(gsl::narrow_cast<uint32_t>(pContext->mRecorders.size() + 1),
+            std::max(1u, drawCount / mMinDrawsPerRecorder));
+    }
+    frame.mNumRanges = numRanges;
+
+    frame.mLists.reserve(numRanges);
+    frame.mLists.emplace_back(pCommandList);
+    for (uint32_t i = 1; i != numRanges; ++i) {
+        frame.mLists.emplace_back(pContext->mRecorders[i - 1]->mCommandList.get());
+    }
+}
+
+void DX12FrameQueue::recordRange(DX12FrameRecording& frame, uint32_t rangeID, const DX12RecordingArenas& arenas) {
+    const auto* pContext = frame.mContext;
+    auto& ring = *mRings[pContext->mRingID];
+    const auto drawBegin = frame.getDrawOffset(rangeID);
+    const auto drawEnd = frame.getDrawOffset(rangeID + 1);
+
+    if (rangeID == 0) {
+        recordFrame(frame, pContext->mCommandList.get(), ring.mUploadBuffer,
+            rangeID, drawBegin, drawEnd, arenas);
+        return;
+    }
+
+    auto& recorder = *pContext->mRecorders[rangeID - 1];
+    V(recorder.mCommandAllocator->Reset());
+    V(recorder.mCommandList->Reset(recorder.mCommandAllocator.get(), nullptr));
+    recordFrame(frame, recorder.mCommandList.get(), *ring.mRecorderUploadBuffers[rangeID - 1],
+        rangeID, drawBegin, drawEnd, arenas);
+    recorder.mCommandList->Close();
+}
+
+void DX12FrameQueue::submitFrame(DX12FrameRecording& frame) {
+    frame.mContext->mCommandList->Close();
+
+    // indirect arguments of this frame are written on the compute queue
+    if (frame.mComputeSubmitted) {
+        V(mDirectQueue->Wait(mComputeFence.get(), frame.mComputeFence));
+    }
+    mDirectQueue->ExecuteCommandLists(gsl::narrow_cast<uint32_t>(frame.mLists.size()), frame.mLists.data());
+}
+
+namespace {
+
+// stack arenas of a recording job, spilled to the heap if exceeded
+struct DX12RecordingScratch {
+    DX12RecordingScratch() noexcept
+        : mPerPass(mBuffer.data(), 2048)
+        , mPerBatch(mBuffer.data() + 2048, 1024)
+        , mPerInstance(mBuffer.data() + 3072, 1024)
+    {}
+
+    DX12RecordingArenas arenas() noexcept {
+        return DX12RecordingArenas{ &mPerPass, &mPerBatch, &mPerInstance };
+    }
+
+    alignas(64) std::array<std::byte, 4096> mBuffer;
+    FrameArena mPerPass;
+    FrameArena mPerBatch;
+    FrameArena mPerInstance;
+};
+
+// ranges are recorded on job threads with their own scratch memory
+template<class Record>
+void runRecording(JobSystem& jobs, Job& parent, Record record) {
+    jobs.run(jobs.create([record = std::move(record)]() {
+        STAR_PROFILE_SCOPE("DX12FrameQueue::recordFrame");
+        DX12RecordingScratch scratch;
+        record(scratch.arenas());
+    }, &parent));
+}
+
+}
+
+void DX12FrameQueue::renderFrame(const DX12FrameContext* pContext, std::pmr::memory_resource* mr) {
+    STAR_PROFILE_SCOPE("DX12FrameQueue::renderFrame");
+    DX12FrameRecording frame(pContext, mr);
+
+    // cpu culling overlaps the gpu work of the previous frame in this slot
+    cullFrame(frame, mCameras, mr);
+    waitFrame(pContext);
+    prepareFrame(frame, mr);
+
+    DX12RecordingScratch scratch;
+    const auto& arenas = mRenderThreadArenas.mPerPass && mRenderThreadArenas.mPerBatch &&
+        mRenderThreadArenas.mPerInstance ? mRenderThreadArenas : scratch.arenas();
+
+    // record ranges [offset(i), offset(i + 1)) on job threads, first range on render thread
+    if (frame.mNumRanges == 1) {
+        recordRange(frame, 0, arenas);
+    } else {
+        // jobs reference the frame, the root waits for all of them before rethrowing
+        auto& root = mJobSystem->create([]() {});
+        for (uint32_t i = 1; i != frame.mNumRanges; ++i) {
+            runRecording(*mJobSystem, root, [this, &frame, i](const DX12RecordingArenas& jobArenas) {
+                recordRange(frame, i, jobArenas);
+            });
+        }
+        recordRange(frame, 0, arenas);
+        mJobSystem->run(root);
+        mJobSystem->wait(root);
+    }
+
+    submitFrame(frame);
+}
 
-                barriers.emplace_back(CD3DX12_RESOURCE_BARRIER::Transition(pResource, prev, post));
+void DX12FrameQueue::buildFrameGraph(uint32_t numFrames, uint32_t numRanges) {
+    mFrameGraph.clear();
+    mFrameGraphFrames = numFrames;
+    mFrameGraphRanges = numRanges;
+
+    // culling and preparation allocate from frame memory and write persistent constants,
+    // they are chained in frame order, all of them before any frame is recorded
+    std::optional<JobGraph::NodeID> prev;
+    auto chain = [&](JobGraph::NodeID node) {
+        if (prev)
+            mFrameGraph.precede(*prev, node);
+        prev = node;
+    };
+    for (uint32_t i = 0; i != numFrames; ++i) {
+        chain(mFrameGraph.add([this, i]() {
+            cullFrame((*mGraphFrames)[i], *mGraphCameras, mGraphMemory);
+        }));
+    }
+    for (uint32_t i = 0; i != numFrames; ++i) {
+        chain(mFrameGraph.add([this, i]() {
+            auto& frame = (*mGraphFrames)[i];
+            waitFrame(frame.mContext);
+            prepareFrame(frame, mGraphMemory);
+        }));
+    }
+    const auto prepared = *prev;
+
+    // ranges record concurrently, a frame is submitted once its ranges and the previous frame are
+    std::optional<JobGraph::NodeID> prevSubmit;
+    for (uint32_t i = 0; i != numFrames; ++i) {
+        auto submit = mFrameGraph.add([this, i]() {
+            submitFrame((*mGraphFrames)[i]);
+        });
+        for (uint32_t rangeID = 0; rangeID != numRanges; ++rangeID) {
+            auto record = mFrameGraph.add([this, i, rangeID]() {
+                auto& frame = (*mGraphFrames)[i];
+                if (rangeID >= frame.mNumRanges)
+                    return;
+                STAR_PROFILE_SCOPE("DX12FrameQueue::recordFrame");
+                DX12RecordingScratch scratch;
+                recordRange(frame, rangeID, scratch.arenas());
+            });
+            mFrameGraph.precede(prepared, record);
+            mFrameGraph.precede(record, submit);
+        }
+        if (prevSubmit)
+            mFrameGraph.precede(*prevSubmit, submit);
+        prevSubmit = submit;
+    }
+}
+
+void DX12FrameQueue::renderFrames(const std::pmr::vector<const DX12FrameContext*>& contexts,
+    std::pmr::memory_resource* mr
+) {
+    // marker names are cached for one pipeline at a time
+    if (!mJobSystem || mEventMarkers) {
+        for (const auto* pContext : contexts) {
+            renderFrame(pContext, mr);
+        }
+        return;
+    }
+    STAR_PROFILE_SCOPE("DX12FrameQueue::renderFrames");
+
+    std::pmr::deque<DX12FrameRecording> frames(mr);
+    uint32_t numRanges = 1;
+    for (const auto* pContext : contexts) {
+        frames.emplace_back(pContext, mr);
+        numRanges = std::max(numRanges, gsl::narrow_cast<uint32_t>(pContext->mRecorders.size() + 1));
+    }
+    const auto numFrames = gsl::narrow_cast<uint32_t>(frames.size());
+    if (numFrames != mFrameGraphFrames || numRanges != mFrameGraphRanges) {
+        buildFrameGraph(numFrames, numRanges);
+    }
+
+    mGraphFrames = &frames;
+    mGraphCameras = &mCameras;
+    mGraphMemory = mr;
+    ON_SCOPE_EXIT(resetGraphInputs, [this]() {
+        mGraphFrames = nullptr;
+        mGraphCameras = nullptr;
+        mGraphMemory = nullptr;
+    });
+    mFrameGraph.run(*mJobSystem);
+}
+
+bool DX12FrameQueue::submitCompute(const DX12FrameContext* pContext) {
+    if (!mComputeQueue)
+        return false;
+
+    // compute work of the frame is ordered before its graphics work only,
+    // resources of other frame slots are not touched, so it may overlap the previous frame
+    const auto& pipeline = pContext->currentPipeline();
+    bool hasWork = false;
+    for (const auto& pass : pipeline.mPasses) {
+        for (const auto& subpass : pass.mGraphicsSubpasses) {
+            for (const auto& queue : subpass.mOrderedRenderQueue) {
+                hasWork |= !queue.mIndirectGroups.empty();
+            }
+        }
+    }
+    if (!hasWork)
+        return false;
+
+    // allocator is free, the frame slot was retired by beginFrame
+    auto pCommandList = pContext->mComputeList.get();
+    V(pContext->mComputeAllocator->Reset());
+    V(pCommandList->Reset(pContext->mComputeAllocator.get(), nullptr));
+
+    for (const auto& pass : pipeline.mPasses) {
+        for (const auto& subpass : pass.mGraphicsSubpasses) {
+            for (const auto& queue : subpass.mOrderedRenderQueue) {
+                dispatchDX12IndirectDraws(pCommandList, mIndirectPipeline, viewCamera(subpass.mView),
+                    queue, pContext->mFrameIndex);
             }
-            pCommandList->ResourceBarrier(gsl::narrow_cast<uint32_t>(barriers.size()), barriers.data());                            
         }
     }
 
     pCommandList->Close();
     ID3D12CommandList* lists[] = { pCommandList };
-    mDirectQueue->ExecuteCommandLists(_countof(lists), lists);
+    mComputeQueue->ExecuteCommandLists(_countof(lists), lists);
+    V(mComputeQueue->Signal(mComputeFence.get(), mNextComputeFence++));
+    return true;
 }
 
 void DX12FrameQueue::endFrame(const DX12FrameContext* pFrame) {
+    STAR_PROFILE_SCOPE("DX12FrameQueue::endFrame");
     // Signal that the frame is complete
-    check_hresult(mFence->SetEventOnCompletion(pFrame->mFrameFenceId, mFenceEvent.get()));
     check_hresult(mDirectQueue->Signal(mFence.get(), pFrame->mFrameFenceId));
+
+    // blocks of completed frames return to the pool
+    auto completedFence = gsl::narrow_cast<int64_t>(mFence->GetCompletedValue());
+    for (auto& uploadBuffer : mRings[pFrame->mRingID]->mRecorderUploadBuffers) {
+        uploadBuffer->releaseBuffer(completedFence);
+    }
 }
 
-DX12FrameContext::DX12FrameContext(ID3D12Device* pDevice, std::string_view name, uint32_t id) {
+DX12FrameRing::DX12FrameRing(ID3D12Device* pDevice, const DX12UploadBufferPool& pool,
+    const Engine::Configs& configs, uint32_t ringID,
+    const std::pmr::polymorphic_allocator<std::byte>& alloc)
+    : mFrames(alloc)
+    , mUploadBuffer(pool, configs.mFrameQueueSize)
+{
+    mFrames.reserve(configs.mFrameQueueSize);
+    const uint32_t numRecorders = configs.mNumRecordingThreads > 1 ? configs.mNumRecordingThreads - 1 : 0;
+    const auto name = "FrameContext " + std::to_string(ringID) + ": ";
+    for (uint32_t i = 0; i != configs.mFrameQueueSize; ++i) {
+        mFrames.emplace_back(pDevice, numRecorders,
+            configs.mGpuDrivenRendering && configs.mAsyncCompute,
+            name, i);
+    }
+    mRecorderUploadBuffers.reserve(numRecorders);
+    for (uint32_t i = 0; i != numRecorders; ++i) {
+        mRecorderUploadBuffers.emplace_back(std::make_unique<DX12UploadBuffer>(pool, configs.mFrameQueueSize));
+    }
+}
+
+DX12CommandRecorder::DX12CommandRecorder(ID3D12Device* pDevice, std::string_view name, uint32_t id) {
     V(pDevice->CreateCommandAllocator(
         D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(mCommandAllocator.put())));
     STAR_SET_DEBUG_NAME(mCommandAllocator, std::string(name) + std::to_string(id));
@@ -679,6 +1746,38 @@ DX12FrameContext::DX12FrameContext(ID3D12Device* pDevice, std::string_view name,
     mCommandList->Close();
 }
 
+DX12FrameContext::DX12FrameContext(ID3D12Device* pDevice, uint32_t numRecorders,
+    bool asyncCompute, std::string_view name, uint32_t id)
+{
+    V(pDevice->CreateCommandAllocator(
+        D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(mCommandAllocator.put())));
+    STAR_SET_DEBUG_NAME(mCommandAllocator, std::string(name) + std::to_string(id));
+
+    V(pDevice->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT,
+        mCommandAllocator.get(), nullptr, IID_PPV_ARGS(mCommandList.put())));
+    STAR_SET_DEBUG_NAME(mCommandList, std::string(name) + std::to_string(id));
+
+    mCommandList->Close();
+
+    if (asyncCompute) {
+        V(pDevice->CreateCommandAllocator(
+            D3D12_COMMAND_LIST_TYPE_COMPUTE, IID_PPV_ARGS(mComputeAllocator.put())));
+        STAR_SET_DEBUG_NAME(mComputeAllocator, std::string(name) + std::to_string(id) + " Compute");
+
+        V(pDevice->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_COMPUTE,
+            mComputeAllocator.get(), nullptr, IID_PPV_ARGS(mComputeList.put())));
+        STAR_SET_DEBUG_NAME(mComputeList, std::string(name) + std::to_string(id) + " Compute");
+
+        mComputeList->Close();
+    }
+
+    mRecorders.reserve(numRecorders);
+    for (uint32_t i = 0; i != numRecorders; ++i) {
+        mRecorders.emplace_back(std::make_unique<DX12CommandRecorder>(pDevice,
+            std::string(name) + std::to_string(id) + " Recorder: ", i));
+    }
+}
+
 const DX12RenderPipeline& DX12FrameContext::currentPipeline() const noexcept {
     return mRenderSolution->mPipelines[mPipelineID];
 }
@@ -20,23 +20,46 @@
 #include <Star/Graphics/SRenderFwd.h>
 #include <Star/Graphics/SRenderGraphFwd.h>
 #include <Star/DX12Engine/SDX12Fwd.h>
+#include <Star/DX12Engine/SDX12Types.h>
 #include <Star/DX12Engine/SDX12ShaderDescriptorHeap.h>
 #include <Star/DX12Engine/SDX12SamplerDescriptorHeap.h>
 #include <Star/DX12Engine/SDX12UploadBuffer.h>
+#include <Star/DX12Engine/SDX12GpuProfiler.h>
+#include <Star/DX12Engine/SDX12EventMarkers.h>
+#include <Star/DX12Engine/SDX12GpuBreadcrumbs.h>
+#include <Star/SJobSystem.h>
 
 namespace Star::Graphics::Render {
 
 class DX12SwapChain;
+class DX12MaterialConstantPool;
 class DX12RenderResources;
+struct DX12FrameRecording;
+
+// command list recorded on a task thread, owned by a frame slot
+struct DX12CommandRecorder {
+    DX12CommandRecorder(ID3D12Device* pDevice, std::string_view name, uint32_t id);
+    DX12CommandRecorder(const DX12CommandRecorder&) = delete;
+    DX12CommandRecorder& operator=(const DX12CommandRecorder&) = delete;
+
+    com_ptr<ID3D12CommandAllocator> mCommandAllocator;
+    com_ptr<ID3D12GraphicsCommandList> mCommandList;
+};
 
 struct DX12FrameContext {
-    DX12FrameContext(ID3D12Device* pDevice, std::string_view name, uint32_t id);
+    DX12FrameContext(ID3D12Device* pDevice, uint32_t numRecorders,
+        bool asyncCompute, std::string_view name, uint32_t id);
 
     DX12RenderPipeline const& currentPipeline() const noexcept;
     DX12RenderPipeline& currentPipeline() noexcept;
 
     uint64_t mFrameFenceId = 0;
+    // fence of the previous frame in this slot, waited by waitFrame
+    uint64_t mRetiredFenceId = 0;
+    bool mAcquired = false;
+    // slot in all frame rings, indexes per frame gpu resources
     uint32_t mFrameIndex = 0;
+    uint32_t mRingID = 0;
     uint32_t mBackBufferIndex = 0;
     uint32_t mBackBufferCount = 0;
     ID3D12Resource* mBackBuffer = nullptr;
@@ -44,6 +67,10 @@ struct DX12FrameContext {
     D3D12_CPU_DESCRIPTOR_HANDLE mBackBufferRTVsRGB = {};
     com_ptr<ID3D12CommandAllocator> mCommandAllocator;
     com_ptr<ID3D12GraphicsCommandList> mCommandList;
+    // compute list executed on the compute queue, null if async compute is disabled
+    com_ptr<ID3D12CommandAllocator> mComputeAllocator;
+    com_ptr<ID3D12GraphicsCommandList> mComputeList;
+    std::vector<std::unique_ptr<DX12CommandRecorder>> mRecorders;
 
     const DX12RenderSolution* mRenderSolution = nullptr;
     const DX12RenderWorks* mRenderWorks = nullptr;
@@ -51,6 +78,31 @@ struct DX12FrameContext {
     uint32_t mPipelineID = 0;
 };
 
+// frame slots and upload rings of a swapchain, frames of different rings are recorded concurrently
+struct DX12FrameRing {
+    DX12FrameRing(ID3D12Device* pDevice, const DX12UploadBufferPool& pool,
+        const Engine::Configs& configs, uint32_t ringID,
+        const std::pmr::polymorphic_allocator<std::byte>& alloc);
+    DX12FrameRing(const DX12FrameRing&) = delete;
+    DX12FrameRing& operator=(const DX12FrameRing&) = delete;
+
+    std::pmr::vector<DX12FrameContext> mFrames;
+    uint32_t mNextFrameIndex = 0;
+
+    // Upload Buffer
+    DX12UploadBuffer mUploadBuffer;
+    // upload allocator of each recording worker, shared by frame slots,
+    // blocks are stamped with the frame fence and retired at endFrame
+    std::vector<std::unique_ptr<DX12UploadBuffer>> mRecorderUploadBuffers;
+};
+
+// scratch of one recording thread, rewound after each pass, queue and instance
+struct DX12RecordingArenas {
+    FrameArena* mPerPass = nullptr;
+    FrameArena* mPerBatch = nullptr;
+    FrameArena* mPerInstance = nullptr;
+};
+
 class DX12FrameQueue {
 public:
     typedef std::pmr::polymorphic_allocator<std::byte> allocator_type;
@@ -60,35 +112,145 @@ public:
 
     DX12FrameQueue(ID3D12Device* pDevice,
         const DX12UploadBufferPool& pool,
+        JobSystem* pJobSystem,
         const Engine::Configs& configs,
         const allocator_type& alloc);
 
     void initPipeline(const DX12SwapChain& sc);
 
+    // frame slot is taken from the ring of the swapchain and retired
     const DX12FrameContext* beginFrame(const DX12SwapChain& sc);
+    // takes the slot without waiting, the gpu may still run the previous frame of the slot
+    const DX12FrameContext* acquireFrame(const DX12SwapChain& sc);
+    // waits for the previous frame of the slot, then resets its allocators and upload rings
+    void waitFrame(const DX12FrameContext* pContext);
+
+    // frames are acquired, they are culled before their slots are waited
     void renderFrame(const DX12FrameContext* pContext, std::pmr::memory_resource* mr);
+    // frames are prepared in order, recorded concurrently on job threads and submitted in order
+    void renderFrames(const std::pmr::vector<const DX12FrameContext*>& contexts, std::pmr::memory_resource* mr);
     void endFrame(const DX12FrameContext* pFrame);
 
+    // frame slots of all rings
+    uint32_t frameSlotCount() const noexcept {
+        return gsl::narrow_cast<uint32_t>(mRings.size() * mRings.front()->mFrames.size());
+    }
+
+    // markers are compiled out without STAR_DEV
+    void enableEventMarkers(bool enabled);
+
+    // record and submit compute work of the frame, false if nothing was submitted
+    bool submitCompute(const DX12FrameContext* pContext);
+
+    void recordFrame(const DX12FrameRecording& frame,
+        ID3D12GraphicsCommandList* pCommandList, DX12UploadBuffer& uploadBuffer,
+        uint32_t rangeID, uint32_t drawBegin, uint32_t drawEnd, const DX12RecordingArenas& arenas);
+
     // Fence
     ID3D12Device* mDevice = nullptr;
     uint64_t mNextFrameFence = 0;
     com_ptr<ID3D12Fence> mFence;
     winrt::handle mFenceEvent;
 
-    // Frames
-    std::pmr::vector<DX12FrameContext> mFrames;
-    uint32_t mNextFrameIndex = 0;
+    // Frames, one ring per swapchain
+    std::pmr::vector<std::unique_ptr<DX12FrameRing>> mRings;
 
     // DirectQueue
     com_ptr<ID3D12CommandQueue> mDirectQueue;
     uint64_t mCommandQueuePerformanceFrequency = 0;
 
+    // ComputeQueue, null if async compute is disabled
+    uint64_t mNextComputeFence = 0;
+    com_ptr<ID3D12Fence> mComputeFence;
+    com_ptr<ID3D12CommandQueue> mComputeQueue;
+
     // Descriptors
     DX12ShaderDescriptorHeap mDescriptors;
     DX12SamplerDescriptorHeap mSamplerDH;
 
-    // Upload Buffer
-    DX12UploadBuffer mUploadBuffer;
+    // Parallel Recording
+    JobSystem* mJobSystem = nullptr;
+    uint32_t mMinDrawsPerRecorder = 0;
+
+    // GPU Driven Rendering, empty if disabled
+    DX12IndirectPipeline mIndirectPipeline;
+
+    // Occlusion Culling
+    DX12OcclusionPipeline mOcclusionPipeline;
+    bool mTwoPhaseOcclusion = false;
+
+    // Light Culling, lights of the scene binned for light culled subpasses
+    DX12LightCullingPipeline mLightCullingPipeline;
+    std::vector<PointLightData> mPointLights;
+
+    // Material Constants, read by MaterialConstants descriptors, set by the engine
+    const DX12MaterialConstantPool* mMaterialConstants = nullptr;
+
+    // Render Passes, false if disabled or not supported by the runtime
+    bool mRenderPasses = false;
+
+    // Variable Rate Shading, subpass rates and images are ignored if the device does not support them
+    D3D12_VARIABLE_SHADING_RATE_TIER mShadingRateTier = D3D12_VARIABLE_SHADING_RATE_TIER_NOT_SUPPORTED;
+
+    // GPU Timestamps, null if profiling is disabled
+    std::unique_ptr<DX12GpuProfiler> mGpuProfiler;
+
+    // GPU Debugger Events, null if markers are disabled
+    std::unique_ptr<DX12EventMarkers> mEventMarkers;
+
+    // GPU Crash Diagnostics, subpass markers reported on device removal, null if disabled
+    std::unique_ptr<DX12GpuBreadcrumbs> mBreadcrumbs;
+
+    // Mesh Levels, log2 scale of the allowed screen error
+    float mLodBias = 0;
+
+    // Shader Levels, quality level and distance of each coarser level, 0 disables distance selection
+    uint32_t mShaderLevel = 0;
+    float mShaderLodDistance = 0;
+
+    // Dynamic Resolution, scale of screen sized passes, 1 without gpu profiling
+    DX12ResolutionScaler mResolutionScaler;
+
+    // Temporal Upscaling, scale of screen sized passes before the upscaling subpass of a pipeline
+    float mRenderScale = 1;
+
+    // Views of culling and drawing, set between frames by the render thread, view 0 is the camera
+    // subpasses of a view beyond the list use view 0
+    std::vector<CameraData> mCameras;
+    const CameraData& viewCamera(uint32_t view) const noexcept {
+        return view < mCameras.size() ? mCameras[view] : mCameras.front();
+    }
+    // Views of the frame rendered before, set by the render thread once frames are submitted
+    // views without a previous frame have no camera motion
+    std::vector<CameraData> mPrevCameras;
+    const CameraData& prevViewCamera(uint32_t view) const noexcept {
+        if (mPrevCameras.empty())
+            return viewCamera(view);
+        return view < mPrevCameras.size() ? mPrevCameras[view] : mPrevCameras.front();
+    }
+
+    // Scratch of ranges recorded on render thread, recording jobs use stack arenas if unset
+    DX12RecordingArenas mRenderThreadArenas;
+private:
+    // frustum culling only, no gpu resource of the slot is touched, once per view drawn by a subpass
+    void cullFrame(DX12FrameRecording& frame, gsl::span<const CameraData> views, std::pmr::memory_resource* mr);
+    // applies occlusion results of the slot, after waitFrame
+    void compactVisibleDraws(DX12FrameRecording& frame);
+    void prepareFrame(DX12FrameRecording& frame, std::pmr::memory_resource* mr);
+    // range 0 is recorded into the frame command list, others into recorders
+    void recordRange(DX12FrameRecording& frame, uint32_t rangeID, const DX12RecordingArenas& arenas);
+    void submitFrame(DX12FrameRecording& frame);
+    // cull, prepare, record and submit nodes of every frame, ranges beyond a frame's count are skipped
+    void buildFrameGraph(uint32_t numFrames, uint32_t numRanges);
+
+    // Frame Graph, rebuilt when the number of frames or recorders changes
+    JobGraph mFrameGraph;
+    uint32_t mFrameGraphFrames = 0;
+    uint32_t mFrameGraphRanges = 0;
+    // inputs of the running graph, valid during renderFrames only
+    std::pmr::deque<DX12FrameRecording>* mGraphFrames = nullptr;
+    const std::vector<CameraData>* mGraphCameras = nullptr;
+    std::pmr::memory_resource* mGraphMemory = nullptr;
 };
 
 }
@@ -0,0 +1,299 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "SDX12GpuBreadcrumbs.h"
+
+namespace Star::Graphics::Render {
+
+namespace {
+
+template<class Map>
+std::string findName(const Map& index, uint32_t id) {
+    for (const auto& [name, value] : index) {
+        if (value == id) {
+            return std::string(name);
+        }
+    }
+    return std::to_string(id);
+}
+
+// D3D12_AUTO_BREADCRUMB_OP
+constexpr const char* sBreadcrumbOps[] = {
+    "SetMarker",
+    "BeginEvent",
+    "EndEvent",
+    "DrawInstanced",
+    "DrawIndexedInstanced",
+    "ExecuteIndirect",
+    "Dispatch",
+    "CopyBufferRegion",
+    "CopyTextureRegion",
+    "CopyResource",
+    "CopyTiles",
+    "ResolveSubresource",
+    "ClearRenderTargetView",
+    "ClearUnorderedAccessView",
+    "ClearDepthStencilView",
+    "ResourceBarrier",
+    "ExecuteBundle",
+    "Present",
+    "ResolveQueryData",
+    "BeginSubmission",
+    "EndSubmission",
+    "DecodeFrame",
+    "ProcessFrames",
+    "AtomicCopyBufferUint",
+    "AtomicCopyBufferUint64",
+    "ResolveSubresourceRegion",
+    "WriteBufferImmediate",
+    "DecodeFrame1",
+    "SetProtectedResourceSession",
+    "DecodeFrame2",
+    "ProcessFrames1",
+    "BuildRaytracingAccelerationStructure",
+    "EmitRaytracingAccelerationStructurePostbuildInfo",
+    "CopyRaytracingAccelerationStructure",
+    "DispatchRays",
+    "InitializeMetaCommand",
+    "ExecuteMetaCommand",
+    "EstimateMotion",
+    "ResolveMotionVectorHeap",
+    "SetPipelineState1",
+    "InitializeExtensionCommand",
+    "ExecuteExtensionCommand",
+};
+
+std::string getBreadcrumbOp(D3D12_AUTO_BREADCRUMB_OP op) {
+    if (op < std::size(sBreadcrumbOps)) {
+        return sBreadcrumbOps[op];
+    }
+    return "Op " + std::to_string(op);
+}
+
+std::string getHResult(HRESULT hr) {
+    switch (hr) {
+    case DXGI_ERROR_DEVICE_HUNG: return "DXGI_ERROR_DEVICE_HUNG";
+    case DXGI_ERROR_DEVICE_REMOVED: return "DXGI_ERROR_DEVICE_REMOVED";
+    case DXGI_ERROR_DEVICE_RESET: return "DXGI_ERROR_DEVICE_RESET";
+    case DXGI_ERROR_DRIVER_INTERNAL_ERROR: return "DXGI_ERROR_DRIVER_INTERNAL_ERROR";
+    case DXGI_ERROR_INVALID_CALL: return "DXGI_ERROR_INVALID_CALL";
+    case S_OK: return "S_OK";
+    default: {
+        char buffer[16];
+        snprintf(buffer, sizeof(buffer), "0x%08X", static_cast<uint32_t>(hr));
+        return buffer;
+    }
+    }
+}
+
+// debug names are optional, either encoding may be set
+std::string getDebugName(const char* nameA, const wchar_t* nameW) {
+    if (nameA) {
+        return nameA;
+    }
+    if (nameW) {
+        return toUTF8(nameW);
+    }
+    return "unnamed";
+}
+
+void writeAllocations(const D3D12_DRED_ALLOCATION_NODE* pNode, std::string& msg) {
+    for (; pNode; pNode = pNode->pNext) {
+        msg += "    " + getDebugName(pNode->ObjectNameA, pNode->ObjectNameW)
+            + " (type " + std::to_string(pNode->AllocationType) + ")\n";
+    }
+}
+
+}
+
+DX12GpuBreadcrumbs::DX12GpuBreadcrumbs(ID3D12Device* pDevice, uint32_t frameQueueSize)
+    : mSlots(frameQueueSize)
+{
+    // cached system memory written by the gpu stays readable after the device is removed
+    const auto size = markerOffset(frameQueueSize, 0);
+    CD3DX12_HEAP_PROPERTIES heapProps(D3D12_CPU_PAGE_PROPERTY_WRITE_BACK, D3D12_MEMORY_POOL_L0);
+    V(pDevice->CreateCommittedResource(
+        &heapProps,
+        D3D12_HEAP_FLAG_NONE,
+        &CD3DX12_RESOURCE_DESC::Buffer(size),
+        D3D12_RESOURCE_STATE_COPY_DEST,
+        nullptr,
+        IID_PPV_ARGS(mMarkers.put())));
+    STAR_SET_DEBUG_NAME(mMarkers, "GpuBreadcrumbs");
+
+    void* pData = nullptr;
+    V(mMarkers->Map(0, nullptr, &pData));
+    mData = static_cast<uint32_t*>(pData);
+    memset(mData, 0, gsl::narrow_cast<size_t>(size));
+    mAddress = mMarkers->GetGPUVirtualAddress();
+}
+
+DX12GpuBreadcrumbs::~DX12GpuBreadcrumbs() = default;
+
+void DX12GpuBreadcrumbs::beginFrame(uint32_t frameIndex, uint64_t frameFence,
+    const DX12RenderWorks& rg, uint32_t solutionID, uint32_t pipelineID
+) {
+    auto& slot = mSlots.at(frameIndex);
+    const auto& solution = rg.mSolutions.at(solutionID);
+    const auto& pipeline = solution.mPipelines.at(pipelineID);
+
+    slot.mFrameFence = frameFence;
+    slot.mPipeline = findName(rg.mSolutionIndex, solutionID) + "/" + findName(solution.mPipelineIndex, pipelineID);
+
+    std::vector<uint32_t> passOffsets;
+    passOffsets.reserve(pipeline.mPasses.size());
+    slot.mSubpasses.clear();
+    for (uint32_t passID = 0; passID != pipeline.mPasses.size(); ++passID) {
+        passOffsets.emplace_back(gsl::narrow_cast<uint32_t>(slot.mSubpasses.size()));
+        const auto& pass = pipeline.mPasses[passID];
+        for (uint32_t subpassID = 0; subpassID != pass.mGraphicsSubpasses.size(); ++subpassID) {
+            slot.mSubpasses.emplace_back("Pass " + std::to_string(passID) + " Subpass " + std::to_string(subpassID));
+        }
+    }
+    for (const auto& [name, desc] : pipeline.mSubpassIndex) {
+        if (desc.mPassID < passOffsets.size() &&
+            passOffsets[desc.mPassID] + desc.mSubpassID < slot.mSubpasses.size()) {
+            slot.mSubpasses[passOffsets[desc.mPassID] + desc.mSubpassID] = std::string(name);
+        }
+    }
+    if (slot.mSubpasses.size() > sMaxSubpasses) {
+        slot.mSubpasses.resize(sMaxSubpasses);
+    }
+
+    // markers of the last frame of the slot were written before its fence
+    memset(mData + markerOffset(frameIndex, 0) / sizeof(uint32_t), 0, sizeof(uint32_t) * 2 * sMaxSubpasses);
+}
+
+void DX12GpuBreadcrumbs::beginSubpass(ID3D12GraphicsCommandList2* pCommandList,
+    uint32_t frameIndex, uint32_t subpassIndex
+) const noexcept {
+    if (subpassIndex >= sMaxSubpasses)
+        return;
+    // begin marker is written once the previous commands started, the end marker once they finished
+    D3D12_WRITEBUFFERIMMEDIATE_PARAMETER param{
+        mAddress + markerOffset(frameIndex, subpassIndex),
+        static_cast<uint32_t>(mSlots[frameIndex].mFrameFence),
+    };
+    D3D12_WRITEBUFFERIMMEDIATE_MODE mode = D3D12_WRITEBUFFERIMMEDIATE_MODE_MARKER_IN;
+    pCommandList->WriteBufferImmediate(1, &param, &mode);
+}
+
+void DX12GpuBreadcrumbs::endSubpass(ID3D12GraphicsCommandList2* pCommandList,
+    uint32_t frameIndex, uint32_t subpassIndex
+) const noexcept {
+    if (subpassIndex >= sMaxSubpasses)
+        return;
+    D3D12_WRITEBUFFERIMMEDIATE_PARAMETER param{
+        mAddress + markerOffset(frameIndex, subpassIndex) + sizeof(uint32_t),
+        static_cast<uint32_t>(mSlots[frameIndex].mFrameFence),
+    };
+    D3D12_WRITEBUFFERIMMEDIATE_MODE mode = D3D12_WRITEBUFFERIMMEDIATE_MODE_MARKER_OUT;
+    pCommandList->WriteBufferImmediate(1, &param, &mode);
+}
+
+void DX12GpuBreadcrumbs::report(std::string& msg) const {
+    for (uint32_t frameIndex = 0; frameIndex != mSlots.size(); ++frameIndex) {
+        const auto& slot = mSlots[frameIndex];
+        if (!slot.mFrameFence)
+            continue;
+        const auto marker = static_cast<uint32_t>(slot.mFrameFence);
+        const auto* pData = mData + markerOffset(frameIndex, 0) / sizeof(uint32_t);
+
+        uint32_t completed = 0;
+        std::string running;
+        for (uint32_t i = 0; i != slot.mSubpasses.size(); ++i) {
+            const bool begun = pData[2 * i] == marker;
+            const bool ended = pData[2 * i + 1] == marker;
+            if (ended) {
+                ++completed;
+            } else if (begun) {
+                running += "    " + slot.mSubpasses[i] + "\n";
+            }
+        }
+        msg += "frame " + std::to_string(slot.mFrameFence) + " " + slot.mPipeline + ": "
+            + std::to_string(completed) + " of " + std::to_string(slot.mSubpasses.size())
+            + " subpasses completed\n";
+        if (!running.empty()) {
+            msg += "  begun, not ended:\n" + running;
+        }
+    }
+}
+
+void writeDeviceRemovedReport(ID3D12Device* pDevice, std::string& msg) {
+    msg += "device removed: " + getHResult(pDevice->GetDeviceRemovedReason()) + "\n";
+
+    com_ptr<ID3D12DeviceRemovedExtendedData> dred;
+    if (FAILED(pDevice->QueryInterface(IID_PPV_ARGS(dred.put())))) {
+        msg += "dred not enabled\n";
+        return;
+    }
+
+    // command lists the gpu had not finished, the op after the last completed one was executing
+    D3D12_DRED_AUTO_BREADCRUMBS_OUTPUT breadcrumbs = {};
+    if (SUCCEEDED(dred->GetAutoBreadcrumbsOutput(&breadcrumbs))) {
+        for (auto* pNode = breadcrumbs.pHeadAutoBreadcrumbNode; pNode; pNode = pNode->pNext) {
+            const uint32_t last = pNode->pLastBreadcrumbValue ? *pNode->pLastBreadcrumbValue : 0;
+            if (last >= pNode->BreadcrumbCount)
+                continue;
+            msg += "command list " + getDebugName(pNode->pCommandListDebugNameA, pNode->pCommandListDebugNameW)
+                + " on " + getDebugName(pNode->pCommandQueueDebugNameA, pNode->pCommandQueueDebugNameW)
+                + ": " + std::to_string(last) + " of " + std::to_string(pNode->BreadcrumbCount) + " ops completed\n";
+            msg += "    " + getBreadcrumbOp(pNode->pCommandHistory[last]) + " <- executing\n";
+            if (last + 1 < pNode->BreadcrumbCount) {
+                msg += "    " + getBreadcrumbOp(pNode->pCommandHistory[last + 1]) + "\n";
+            }
+        }
+    } else {
+        msg += "auto breadcrumbs not available\n";
+    }
+
+    D3D12_DRED_PAGE_FAULT_OUTPUT pageFault = {};
+    if (SUCCEEDED(dred->GetPageFaultAllocationOutput(&pageFault)) && pageFault.PageFaultVA) {
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), "0x%016llX", static_cast<unsigned long long>(pageFault.PageFaultVA));
+        msg += std::string("page fault at ") + buffer + "\n";
+        msg += "  allocations at the address:\n";
+        writeAllocations(pageFault.pHeadExistingAllocationNode, msg);
+        msg += "  allocations recently freed at the address:\n";
+        writeAllocations(pageFault.pHeadRecentFreedAllocationNode, msg);
+    }
+}
+
+void reportDeviceRemoved(ID3D12Device* pDevice, const DX12GpuBreadcrumbs* pBreadcrumbs) noexcept {
+    try {
+        std::string msg;
+        writeDeviceRemovedReport(pDevice, msg);
+        if (pBreadcrumbs) {
+            pBreadcrumbs->report(msg);
+        }
+        OutputDebugStringA(msg.c_str());
+
+        SYSTEMTIME time;
+        GetLocalTime(&time);
+        char filename[MAX_PATH];
+        snprintf(filename, sizeof(filename), "dump\\%04d%02d%02d-%02d%02d%02d-%lu.txt",
+            time.wYear, time.wMonth, time.wDay, time.wHour, time.wMinute, time.wSecond,
+            GetCurrentProcessId());
+        std::filesystem::create_directories("dump");
+        std::ofstream ofs(filename);
+        ofs << msg;
+    } catch (...) {
+        OutputDebugStringA("WARNING: device removed report failed\n");
+    }
+}
+
+}
@@ -0,0 +1,69 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <Star/DX12Engine/SDX12Types.h>
+
+namespace Star::Graphics::Render {
+
+// gpu progress of each subpass, written by the command lists into memory the cpu still reads after device removal
+// a subpass writes the frame fence when it begins and again when it ends, named by the render graph
+// the report lists subpasses begun and not ended, with dred breadcrumbs and page faults when enabled
+class DX12GpuBreadcrumbs {
+public:
+    DX12GpuBreadcrumbs(ID3D12Device* pDevice, uint32_t frameQueueSize);
+    DX12GpuBreadcrumbs(const DX12GpuBreadcrumbs&) = delete;
+    DX12GpuBreadcrumbs& operator=(const DX12GpuBreadcrumbs&) = delete;
+    ~DX12GpuBreadcrumbs();
+
+    // last frame of the slot must be complete, markers are reset
+    void beginFrame(uint32_t frameIndex, uint64_t frameFence,
+        const DX12RenderWorks& rg, uint32_t solutionID, uint32_t pipelineID);
+    // subpasses are numbered in pipeline order, those past sMaxSubpasses are not tracked
+    void beginSubpass(ID3D12GraphicsCommandList2* pCommandList, uint32_t frameIndex, uint32_t subpassIndex) const noexcept;
+    void endSubpass(ID3D12GraphicsCommandList2* pCommandList, uint32_t frameIndex, uint32_t subpassIndex) const noexcept;
+
+    // subpasses of frames in flight, the gpu may have stopped anywhere after the last begun subpass
+    void report(std::string& msg) const;
+
+    static constexpr uint32_t sMaxSubpasses = 256;
+private:
+    struct Slot {
+        uint64_t mFrameFence = 0;
+        std::string mPipeline;
+        std::vector<std::string> mSubpasses;
+    };
+
+    // begin and end marker of subpass i of slot s are at (s * sMaxSubpasses + i) * 2 and the next uint32
+    uint64_t markerOffset(uint32_t frameIndex, uint32_t subpassIndex) const noexcept {
+        return (uint64_t(frameIndex) * sMaxSubpasses + subpassIndex) * 2 * sizeof(uint32_t);
+    }
+
+    com_ptr<ID3D12Resource> mMarkers;
+    uint32_t* mData = nullptr;
+    D3D12_GPU_VIRTUAL_ADDRESS mAddress = 0;
+    std::vector<Slot> mSlots;
+};
+
+// reason of the device removal, dred breadcrumbs of unfinished command lists and the faulting address
+// with the allocations at it, dred must be enabled before the device is created
+void writeDeviceRemovedReport(ID3D12Device* pDevice, std::string& msg);
+
+// report of the removed device is written to the debugger and to dump\YYYYMMDD-HHMMSS-pid.txt
+void reportDeviceRemoved(ID3D12Device* pDevice, const DX12GpuBreadcrumbs* pBreadcrumbs) noexcept;
+
+}
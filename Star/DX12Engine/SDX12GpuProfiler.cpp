@@ -0,0 +1,241 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "SDX12GpuProfiler.h"
+
+namespace Star::Graphics::Render {
+
+DX12GpuProfiler::DX12GpuProfiler(ID3D12Device* pDevice, uint32_t frameQueueSize, uint64_t frequency,
+    uint32_t maxRanges, bool statistics)
+    : mDevice(pDevice)
+    , mFrequency(frequency)
+    , mMaxRanges(std::max(1u, maxRanges))
+    , mStatistics(statistics)
+    , mSlots(frameQueueSize)
+{
+    Expects(mFrequency);
+}
+
+DX12GpuProfiler::~DX12GpuProfiler() = default;
+
+void DX12GpuProfiler::beginFrame(ID3D12GraphicsCommandList* pCommandList, uint32_t frameIndex,
+    const DX12RenderPipeline& pipeline
+) {
+    auto& slot = mSlots.at(frameIndex);
+
+    // publish the last frame of the slot
+    if (slot.mRecorded) {
+        const auto* pData = slot.mData;
+        mFrameMilliseconds = getMilliseconds(pData[0], pData[1]);
+        mTimings = slot.mSubpasses;
+        for (size_t i = 0; i != mTimings.size(); ++i) {
+            mTimings[i].mMilliseconds = getMilliseconds(pData[2 + 2 * i], pData[3 + 2 * i]);
+        }
+        if (slot.mStatisticsData) {
+            for (uint32_t i = 0; i != mTimings.size(); ++i) {
+                auto& stats = mTimings[i].mStatistics;
+                for (uint32_t r = 0; r != mMaxRanges; ++r) {
+                    const auto queryID = i * mMaxRanges + r;
+                    D3D12_QUERY_DATA_PIPELINE_STATISTICS data;
+                    memcpy(&data, slot.mStatisticsData + sizeof(data) * queryID, sizeof(data));
+                    uint64_t samples = 0;
+                    memcpy(&samples, slot.mStatisticsData + occlusionOffset(slot, queryID), sizeof(samples));
+                    stats.mVertices += data.IAVertices;
+                    stats.mPrimitives += data.IAPrimitives;
+                    stats.mRasterizedPrimitives += data.CPrimitives;
+                    stats.mPixelShaderInvocations += data.PSInvocations;
+                    stats.mComputeShaderInvocations += data.CSInvocations;
+                    stats.mSamplesPassed += samples;
+                }
+            }
+            // ranges not recording a subpass resolve nothing and read zero
+            memset(slot.mStatisticsData, 0, occlusionOffset(slot, slot.mStatisticsCapacity));
+        }
+        slot.mRecorded = false;
+    }
+
+    // subpasses of this frame
+    std::vector<uint32_t> passOffsets;
+    passOffsets.reserve(pipeline.mPasses.size());
+    slot.mSubpasses.clear();
+    for (uint32_t passID = 0; passID != pipeline.mPasses.size(); ++passID) {
+        passOffsets.emplace_back(gsl::narrow_cast<uint32_t>(slot.mSubpasses.size()));
+        const auto& pass = pipeline.mPasses[passID];
+        for (uint32_t subpassID = 0; subpassID != pass.mGraphicsSubpasses.size(); ++subpassID) {
+            auto& timing = slot.mSubpasses.emplace_back();
+            timing.mPassID = passID;
+            timing.mSubpassID = subpassID;
+        }
+    }
+    for (const auto& [name, desc] : pipeline.mSubpassIndex) {
+        if (desc.mPassID < passOffsets.size()) {
+            slot.mSubpasses.at(passOffsets[desc.mPassID] + desc.mSubpassID).mName = name;
+        }
+    }
+
+    // queries of the slot grow with the pipeline
+    const auto queryCount = gsl::narrow_cast<uint32_t>(2 + 2 * slot.mSubpasses.size());
+    if (slot.mCapacity < queryCount) {
+        slot.mQueryHeap = nullptr;
+        slot.mReadback = nullptr;
+        slot.mData = nullptr;
+
+        D3D12_QUERY_HEAP_DESC desc{ D3D12_QUERY_HEAP_TYPE_TIMESTAMP, queryCount, 0 };
+        V(mDevice->CreateQueryHeap(&desc, IID_PPV_ARGS(slot.mQueryHeap.put())));
+        STAR_SET_DEBUG_NAME(slot.mQueryHeap, "GpuProfiler: " + std::to_string(frameIndex));
+
+        V(mDevice->CreateCommittedResource(
+            &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_READBACK),
+            D3D12_HEAP_FLAG_NONE,
+            &CD3DX12_RESOURCE_DESC::Buffer(sizeof(uint64_t) * queryCount),
+            D3D12_RESOURCE_STATE_COPY_DEST,
+            nullptr,
+            IID_PPV_ARGS(slot.mReadback.put())));
+
+        // readback stays mapped, it is read after the frame fence
+        void* pData = nullptr;
+        V(slot.mReadback->Map(0, nullptr, &pData));
+        slot.mData = static_cast<const uint64_t*>(pData);
+        slot.mCapacity = queryCount;
+    }
+    const auto statisticsCount = gsl::narrow_cast<uint32_t>(slot.mSubpasses.size() * mMaxRanges);
+    if (mStatistics && slot.mStatisticsCapacity < statisticsCount) {
+        slot.mStatisticsHeap = nullptr;
+        slot.mOcclusionHeap = nullptr;
+        slot.mStatisticsReadback = nullptr;
+        slot.mStatisticsData = nullptr;
+        slot.mStatisticsCapacity = statisticsCount;
+
+        D3D12_QUERY_HEAP_DESC desc{ D3D12_QUERY_HEAP_TYPE_PIPELINE_STATISTICS, statisticsCount, 0 };
+        V(mDevice->CreateQueryHeap(&desc, IID_PPV_ARGS(slot.mStatisticsHeap.put())));
+        STAR_SET_DEBUG_NAME(slot.mStatisticsHeap, "GpuProfiler Statistics: " + std::to_string(frameIndex));
+        desc.Type = D3D12_QUERY_HEAP_TYPE_OCCLUSION;
+        V(mDevice->CreateQueryHeap(&desc, IID_PPV_ARGS(slot.mOcclusionHeap.put())));
+        STAR_SET_DEBUG_NAME(slot.mOcclusionHeap, "GpuProfiler Occlusion: " + std::to_string(frameIndex));
+
+        const auto size = occlusionOffset(slot, statisticsCount);
+        V(mDevice->CreateCommittedResource(
+            &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_READBACK),
+            D3D12_HEAP_FLAG_NONE,
+            &CD3DX12_RESOURCE_DESC::Buffer(size),
+            D3D12_RESOURCE_STATE_COPY_DEST,
+            nullptr,
+            IID_PPV_ARGS(slot.mStatisticsReadback.put())));
+
+        void* pData = nullptr;
+        V(slot.mStatisticsReadback->Map(0, nullptr, &pData));
+        slot.mStatisticsData = static_cast<std::byte*>(pData);
+        memset(slot.mStatisticsData, 0, size);
+    }
+
+    pCommandList->EndQuery(slot.mQueryHeap.get(), D3D12_QUERY_TYPE_TIMESTAMP, 0);
+    slot.mRecorded = true;
+}
+
+void DX12GpuProfiler::beginSubpass(ID3D12GraphicsCommandList* pCommandList,
+    uint32_t frameIndex, uint32_t subpassIndex
+) const noexcept {
+    const auto& slot = mSlots[frameIndex];
+    Expects(subpassIndex < slot.mSubpasses.size());
+    pCommandList->EndQuery(slot.mQueryHeap.get(), D3D12_QUERY_TYPE_TIMESTAMP, 2 + 2 * subpassIndex);
+}
+
+void DX12GpuProfiler::endSubpass(ID3D12GraphicsCommandList* pCommandList,
+    uint32_t frameIndex, uint32_t subpassIndex
+) const noexcept {
+    const auto& slot = mSlots[frameIndex];
+    Expects(subpassIndex < slot.mSubpasses.size());
+    pCommandList->EndQuery(slot.mQueryHeap.get(), D3D12_QUERY_TYPE_TIMESTAMP, 3 + 2 * subpassIndex);
+}
+
+void DX12GpuProfiler::beginStatistics(ID3D12GraphicsCommandList* pCommandList,
+    uint32_t frameIndex, uint32_t subpassIndex, uint32_t rangeID
+) const noexcept {
+    if (!mStatistics)
+        return;
+    const auto& slot = mSlots[frameIndex];
+    Expects(subpassIndex < slot.mSubpasses.size() && rangeID < mMaxRanges);
+    const auto queryID = subpassIndex * mMaxRanges + rangeID;
+    pCommandList->BeginQuery(slot.mStatisticsHeap.get(), D3D12_QUERY_TYPE_PIPELINE_STATISTICS, queryID);
+    pCommandList->BeginQuery(slot.mOcclusionHeap.get(), D3D12_QUERY_TYPE_OCCLUSION, queryID);
+}
+
+void DX12GpuProfiler::endStatistics(ID3D12GraphicsCommandList* pCommandList,
+    uint32_t frameIndex, uint32_t subpassIndex, uint32_t rangeID
+) const noexcept {
+    if (!mStatistics)
+        return;
+    const auto& slot = mSlots[frameIndex];
+    Expects(subpassIndex < slot.mSubpasses.size() && rangeID < mMaxRanges);
+    const auto queryID = subpassIndex * mMaxRanges + rangeID;
+    pCommandList->EndQuery(slot.mStatisticsHeap.get(), D3D12_QUERY_TYPE_PIPELINE_STATISTICS, queryID);
+    pCommandList->EndQuery(slot.mOcclusionHeap.get(), D3D12_QUERY_TYPE_OCCLUSION, queryID);
+    pCommandList->ResolveQueryData(slot.mStatisticsHeap.get(), D3D12_QUERY_TYPE_PIPELINE_STATISTICS,
+        queryID, 1, slot.mStatisticsReadback.get(), sizeof(D3D12_QUERY_DATA_PIPELINE_STATISTICS) * queryID);
+    pCommandList->ResolveQueryData(slot.mOcclusionHeap.get(), D3D12_QUERY_TYPE_OCCLUSION,
+        queryID, 1, slot.mStatisticsReadback.get(), occlusionOffset(slot, queryID));
+}
+
+void DX12GpuProfiler::endFrame(ID3D12GraphicsCommandList* pCommandList, uint32_t frameIndex) const noexcept {
+    const auto& slot = mSlots[frameIndex];
+    const auto queryCount = gsl::narrow_cast<uint32_t>(2 + 2 * slot.mSubpasses.size());
+    pCommandList->EndQuery(slot.mQueryHeap.get(), D3D12_QUERY_TYPE_TIMESTAMP, 1);
+    pCommandList->ResolveQueryData(slot.mQueryHeap.get(), D3D12_QUERY_TYPE_TIMESTAMP,
+        0, queryCount, slot.mReadback.get(), 0);
+}
+
+double DX12GpuProfiler::passMilliseconds(uint32_t passID) const noexcept {
+    double ms = 0;
+    for (const auto& timing : mTimings) {
+        if (timing.mPassID == passID)
+            ms += timing.mMilliseconds;
+    }
+    return ms;
+}
+
+namespace {
+
+// fraction of the step towards the scale meeting the budget
+constexpr float sResolutionDamping = 0.1f;
+// frames within this fraction of the budget keep their scale
+constexpr float sResolutionTolerance = 0.05f;
+
+}
+
+void DX12ResolutionScaler::setBudget(float milliseconds) noexcept {
+    mBudget = milliseconds;
+    if (mBudget <= 0) {
+        mScale = 1;
+    }
+}
+
+float DX12ResolutionScaler::update(double gpuMilliseconds) noexcept {
+    if (mBudget <= 0 || gpuMilliseconds <= 0)
+        return mScale;
+
+    const auto ratio = float(mBudget / gpuMilliseconds);
+    if (std::abs(ratio - 1.0f) < sResolutionTolerance)
+        return mScale;
+
+    // pixel work follows the area, the scale of the budget is the square root of the time ratio
+    const float target = mScale * std::sqrt(ratio);
+    mScale = std::clamp(mScale + (target - mScale) * sResolutionDamping, mMinScale, 1.0f);
+    return mScale;
+}
+
+}
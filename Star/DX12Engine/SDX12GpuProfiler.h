@@ -0,0 +1,124 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+#include <Star/DX12Engine/SDX12Types.h>
+
+namespace Star::Graphics::Render {
+
+// gpu time of a subpass, named by the render graph
+struct DX12GpuTiming {
+    std::string mName;
+    uint32_t mPassID = 0;
+    uint32_t mSubpassID = 0;
+    double mMilliseconds = 0;
+    GpuStatistics mStatistics;
+};
+
+// timestamps around the frame and each subpass, written to the query heap of the frame slot
+// queries are resolved into readback memory and read when the slot is reused,
+// so timings are frame queue size frames old
+// with statistics, pipeline statistics and occlusion queries wrap each command list range of a subpass
+class DX12GpuProfiler {
+public:
+    DX12GpuProfiler(ID3D12Device* pDevice, uint32_t frameQueueSize, uint64_t frequency,
+        uint32_t maxRanges, bool statistics);
+    DX12GpuProfiler(const DX12GpuProfiler&) = delete;
+    DX12GpuProfiler& operator=(const DX12GpuProfiler&) = delete;
+    ~DX12GpuProfiler();
+
+    // collects results of the slot, its last frame must be complete
+    void beginFrame(ID3D12GraphicsCommandList* pCommandList, uint32_t frameIndex,
+        const DX12RenderPipeline& pipeline);
+    // subpasses are numbered in pipeline order, they may begin and end in different command lists
+    void beginSubpass(ID3D12GraphicsCommandList* pCommandList, uint32_t frameIndex, uint32_t subpassIndex) const noexcept;
+    void endSubpass(ID3D12GraphicsCommandList* pCommandList, uint32_t frameIndex, uint32_t subpassIndex) const noexcept;
+    // queries begin and end in one command list, each range recording the subpass counts its own part
+    void beginStatistics(ID3D12GraphicsCommandList* pCommandList, uint32_t frameIndex,
+        uint32_t subpassIndex, uint32_t rangeID) const noexcept;
+    void endStatistics(ID3D12GraphicsCommandList* pCommandList, uint32_t frameIndex,
+        uint32_t subpassIndex, uint32_t rangeID) const noexcept;
+    // recorded in the last command list executed by the frame
+    void endFrame(ID3D12GraphicsCommandList* pCommandList, uint32_t frameIndex) const noexcept;
+
+    const std::vector<DX12GpuTiming>& timings() const noexcept {
+        return mTimings;
+    }
+    double frameMilliseconds() const noexcept {
+        return mFrameMilliseconds;
+    }
+    // sum of the subpasses of a render pass
+    double passMilliseconds(uint32_t passID) const noexcept;
+private:
+    struct Slot {
+        com_ptr<ID3D12QueryHeap> mQueryHeap;
+        com_ptr<ID3D12Resource> mReadback;
+        const uint64_t* mData = nullptr;
+        uint32_t mCapacity = 0;
+        // frame queries 0 and 1, subpass i queries 2 + 2i and 3 + 2i
+        std::vector<DX12GpuTiming> mSubpasses;
+        bool mRecorded = false;
+        // range r of subpass i uses query i * max ranges + r, occlusion results follow the statistics
+        com_ptr<ID3D12QueryHeap> mStatisticsHeap;
+        com_ptr<ID3D12QueryHeap> mOcclusionHeap;
+        com_ptr<ID3D12Resource> mStatisticsReadback;
+        std::byte* mStatisticsData = nullptr;
+        uint32_t mStatisticsCapacity = 0;
+    };
+
+    uint64_t occlusionOffset(const Slot& slot, uint32_t queryID) const noexcept {
+        return sizeof(D3D12_QUERY_DATA_PIPELINE_STATISTICS) * slot.mStatisticsCapacity + sizeof(uint64_t) * queryID;
+    }
+
+    double getMilliseconds(uint64_t begin, uint64_t end) const noexcept {
+        return end > begin ? double(end - begin) * 1000.0 / double(mFrequency) : 0.0;
+    }
+
+    ID3D12Device* mDevice = nullptr;
+    uint64_t mFrequency = 0;
+    uint32_t mMaxRanges = 1;
+    bool mStatistics = false;
+    std::vector<Slot> mSlots;
+    std::vector<DX12GpuTiming> mTimings;
+    double mFrameMilliseconds = 0;
+};
+
+// viewport scale of screen sized passes, follows the gpu time of frames against a budget
+// timings are frame queue size frames old, so each frame takes a damped step only
+class DX12ResolutionScaler {
+public:
+    DX12ResolutionScaler(float budgetMilliseconds, float minScale) noexcept
+        : mBudget(budgetMilliseconds)
+        , mMinScale(std::clamp(minScale, 0.1f, 1.0f))
+    {}
+
+    // 0 renders at full resolution
+    void setBudget(float milliseconds) noexcept;
+    // returns the scale of the next frame, zero time is a frame without results and keeps the scale
+    float update(double gpuMilliseconds) noexcept;
+
+    float scale() const noexcept {
+        return mScale;
+    }
+private:
+    float mBudget = 0;
+    float mMinScale = 1;
+    float mScale = 1;
+};
+
+}
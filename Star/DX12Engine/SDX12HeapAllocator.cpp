@@ -0,0 +1,261 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "SDX12HeapAllocator.h"
+#include "SDX12Residency.h"
+
+namespace Star::Graphics::Render {
+
+namespace {
+
+uint64_t getHeapAlignment(DX12HeapClass heapClass) noexcept {
+    return heapClass == DX12MSAATextureHeap
+        ? D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT
+        : D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+}
+
+D3D12_HEAP_FLAGS getHeapFlags(DX12HeapClass heapClass) noexcept {
+    return heapClass == DX12BufferHeap
+        ? D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS
+        : D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES;
+}
+
+DX12MemoryCategory getMemoryCategory(DX12HeapClass heapClass) noexcept {
+    return heapClass == DX12BufferHeap ? DX12MeshMemory : DX12TextureMemory;
+}
+
+}
+
+DX12HeapRange::~DX12HeapRange() {
+    mAllocator->release(*this);
+}
+
+DX12HeapAllocator::DX12HeapAllocator(ID3D12Device* pDevice, DX12ResidencyManager* pResidency,
+    uint64_t heapSize)
+    : mDevice(pDevice)
+    , mResidency(pResidency)
+    , mHeapSize(heapSize)
+{
+    Expects(mHeapSize % D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT == 0);
+}
+
+DX12HeapAllocator::~DX12HeapAllocator() {
+    if (!mResidency)
+        return;
+    for (const auto& heaps : mHeaps) {
+        for (const auto& heap : heaps) {
+            mResidency->remove(heap.mHeap.get());
+        }
+    }
+}
+
+DX12PlacedResource DX12HeapAllocator::createBuffer(uint64_t size,
+    D3D12_RESOURCE_STATES state, D3D12_RESOURCE_FLAGS flags
+) {
+    const auto desc = CD3DX12_RESOURCE_DESC::Buffer(size, flags);
+    const auto info = mDevice->GetResourceAllocationInfo(0, 1, &desc);
+
+    DX12PlacedResource placed;
+    placed.mMemory = allocate(DX12BufferHeap, info.SizeInBytes, info.Alignment);
+    const auto& range = *placed.mMemory;
+
+    ID3D12Heap* pHeap = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        pHeap = mHeaps[range.mClass][range.mHeapID].mHeap.get();
+    }
+    V(mDevice->CreatePlacedResource(pHeap, range.mOffset, &desc, state,
+        nullptr, IID_PPV_ARGS(placed.mResource.put())));
+
+    return placed;
+}
+
+DX12PlacedResource DX12HeapAllocator::createTexture(const D3D12_RESOURCE_DESC& desc,
+    D3D12_RESOURCE_STATES state
+) {
+    if (desc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL)) {
+        throw std::invalid_argument("render target and depth stencil textures are not placed");
+    }
+    const auto info = mDevice->GetResourceAllocationInfo(0, 1, &desc);
+    const auto heapClass = info.Alignment > D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT
+        ? DX12MSAATextureHeap : DX12TextureHeap;
+
+    DX12PlacedResource placed;
+    placed.mMemory = allocate(heapClass, info.SizeInBytes, info.Alignment);
+    const auto& range = *placed.mMemory;
+
+    ID3D12Heap* pHeap = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        pHeap = mHeaps[range.mClass][range.mHeapID].mHeap.get();
+    }
+    V(mDevice->CreatePlacedResource(pHeap, range.mOffset, &desc, state,
+        nullptr, IID_PPV_ARGS(placed.mResource.put())));
+
+    return placed;
+}
+
+void DX12HeapAllocator::advanceFrame(uint64_t nextFence, uint64_t completedFence) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    // released ranges may still be read by every frame submitted so far
+    mRetireFence = nextFence ? nextFence - 1 : 0;
+
+    while (!mRetired.empty() && mRetired.front().mFence <= completedFence) {
+        const auto& retired = mRetired.front();
+        auto& heap = mHeaps[retired.mClass][retired.mHeapID];
+        heap.mAllocatedSize -= retired.mSize;
+        insertFree(heap, retired.mOffset, retired.mSize);
+        mRetired.pop_front();
+    }
+
+    // heaps without ranges are not read by frames from now on and may be evicted
+    if (mResidency) {
+        for (const auto& heaps : mHeaps) {
+            for (const auto& heap : heaps) {
+                if (heap.mAllocatedSize) {
+                    mResidency->use(heap.mHeap.get(), nextFence);
+                }
+            }
+        }
+    }
+}
+
+DX12HeapStatistics DX12HeapAllocator::statistics(DX12HeapClass heapClass) const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    DX12HeapStatistics stats;
+    stats.mHeapCount = mHeaps[heapClass].size();
+    for (const auto& heap : mHeaps[heapClass]) {
+        stats.mReservedSize += heap.mSize;
+        stats.mAllocatedSize += heap.mAllocatedSize;
+    }
+    stats.mAllocationCount = mAllocationCounts[heapClass];
+    for (const auto& retired : mRetired) {
+        if (retired.mClass == heapClass) {
+            stats.mRetiredSize += retired.mSize;
+        }
+    }
+    return stats;
+}
+
+DX12HeapStatistics DX12HeapAllocator::statistics() const {
+    DX12HeapStatistics total;
+    for (uint32_t i = 0; i != DX12HeapClassCount; ++i) {
+        const auto stats = statistics(static_cast<DX12HeapClass>(i));
+        total.mHeapCount += stats.mHeapCount;
+        total.mReservedSize += stats.mReservedSize;
+        total.mAllocatedSize += stats.mAllocatedSize;
+        total.mAllocationCount += stats.mAllocationCount;
+        total.mRetiredSize += stats.mRetiredSize;
+    }
+    return total;
+}
+
+std::shared_ptr<const DX12HeapRange> DX12HeapAllocator::allocate(DX12HeapClass heapClass,
+    uint64_t size, uint64_t alignment
+) {
+    // every range is a multiple of the heap alignment, so free offsets stay aligned
+    const auto heapAlignment = getHeapAlignment(heapClass);
+    Expects(alignment <= heapAlignment);
+    size = boost::alignment::align_up(size, heapAlignment);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto& heaps = mHeaps[heapClass];
+    uint32_t heapID = 0;
+    for (; heapID != heaps.size(); ++heapID) {
+        if (heaps[heapID].mFreeBySize.lower_bound(size) != heaps[heapID].mFreeBySize.end())
+            break;
+    }
+
+    if (heapID == heaps.size()) {
+        // resources larger than the heap size get a heap of their own
+        auto& heap = heaps.emplace_back();
+        heap.mSize = std::max(mHeapSize, size);
+
+        D3D12_HEAP_DESC desc{};
+        desc.SizeInBytes = heap.mSize;
+        desc.Properties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+        desc.Alignment = heapAlignment;
+        desc.Flags = getHeapFlags(heapClass);
+        V(mDevice->CreateHeap(&desc, IID_PPV_ARGS(heap.mHeap.put())));
+        STAR_SET_DEBUG_NAME(heap.mHeap, "PlacedHeap " + std::to_string(heapClass)
+            + ": " + std::to_string(heapID));
+
+        insertFree(heap, 0, heap.mSize);
+        if (mResidency) {
+            mResidency->add(heap.mHeap.get(), getMemoryCategory(heapClass), heap.mSize);
+        }
+    }
+
+    auto& heap = heaps[heapID];
+    // an evicted heap is made resident before resources are placed in it
+    if (mResidency) {
+        mResidency->use(heap.mHeap.get(), mRetireFence + 1);
+    }
+    auto bestFit = heap.mFreeBySize.lower_bound(size);
+    Expects(bestFit != heap.mFreeBySize.end());
+    const auto offset = bestFit->second;
+    const auto freeSize = bestFit->first;
+    eraseFree(heap, heap.mFreeByOffset.find(offset));
+    if (freeSize > size) {
+        insertFree(heap, offset + size, freeSize - size);
+    }
+    heap.mAllocatedSize += size;
+    ++mAllocationCounts[heapClass];
+
+    return std::make_shared<const DX12HeapRange>(this, heapClass, heapID, offset, size);
+}
+
+void DX12HeapAllocator::release(const DX12HeapRange& range) noexcept {
+    std::lock_guard<std::mutex> lock(mMutex);
+    --mAllocationCounts[range.mClass];
+    mRetired.emplace_back(Retired{ range.mClass, range.mHeapID,
+        range.mOffset, range.mSize, mRetireFence });
+}
+
+void DX12HeapAllocator::insertFree(Heap& heap, uint64_t offset, uint64_t size) {
+    // merge with the following range
+    auto next = heap.mFreeByOffset.lower_bound(offset);
+    if (next != heap.mFreeByOffset.end() && offset + size == next->first) {
+        size += next->second;
+        eraseFree(heap, next);
+    }
+    // merge with the preceding range
+    auto iter = heap.mFreeByOffset.lower_bound(offset);
+    if (iter != heap.mFreeByOffset.begin()) {
+        auto prev = std::prev(iter);
+        if (prev->first + prev->second == offset) {
+            offset = prev->first;
+            size += prev->second;
+            eraseFree(heap, prev);
+        }
+    }
+    heap.mFreeByOffset.emplace(offset, size);
+    heap.mFreeBySize.emplace(size, offset);
+}
+
+void DX12HeapAllocator::eraseFree(Heap& heap, std::map<uint64_t, uint64_t>::iterator iter) {
+    auto range = heap.mFreeBySize.equal_range(iter->second);
+    for (auto sizeIter = range.first; sizeIter != range.second; ++sizeIter) {
+        if (sizeIter->second == iter->first) {
+            heap.mFreeBySize.erase(sizeIter);
+            break;
+        }
+    }
+    heap.mFreeByOffset.erase(iter);
+}
+
+}
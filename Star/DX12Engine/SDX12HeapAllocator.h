@@ -0,0 +1,138 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <Star/DX12Engine/SDX12Types.h>
+
+namespace Star::Graphics::Render {
+
+class DX12HeapAllocator;
+class DX12ResidencyManager;
+
+enum DX12HeapClass : uint32_t {
+    DX12BufferHeap,
+    DX12TextureHeap,
+    DX12MSAATextureHeap,
+    DX12HeapClassCount,
+};
+
+// range of a heap backing one placed resource, returned to the allocator when released
+// the range is reused once frames submitted before its release are complete
+class DX12HeapRange {
+public:
+    DX12HeapRange(DX12HeapAllocator* pAllocator, DX12HeapClass heapClass,
+        uint32_t heapID, uint64_t offset, uint64_t size) noexcept
+        : mAllocator(pAllocator)
+        , mClass(heapClass)
+        , mHeapID(heapID)
+        , mOffset(offset)
+        , mSize(size)
+    {}
+    DX12HeapRange(const DX12HeapRange&) = delete;
+    DX12HeapRange& operator=(const DX12HeapRange&) = delete;
+    ~DX12HeapRange();
+
+    DX12HeapClass heapClass() const noexcept {
+        return mClass;
+    }
+    uint64_t offset() const noexcept {
+        return mOffset;
+    }
+    uint64_t size() const noexcept {
+        return mSize;
+    }
+private:
+    friend class DX12HeapAllocator;
+    DX12HeapAllocator* mAllocator = nullptr;
+    DX12HeapClass mClass = DX12BufferHeap;
+    uint32_t mHeapID = 0;
+    uint64_t mOffset = 0;
+    uint64_t mSize = 0;
+};
+
+struct DX12PlacedResource {
+    com_ptr<ID3D12Resource> mResource;
+    std::shared_ptr<const DX12HeapRange> mMemory;
+};
+
+struct DX12HeapStatistics {
+    uint64_t mHeapCount = 0;
+    uint64_t mReservedSize = 0;
+    uint64_t mAllocatedSize = 0;
+    uint64_t mAllocationCount = 0;
+    uint64_t mRetiredSize = 0;
+};
+
+// suballocates placed resources from default heaps, one heap list per resource class
+// free ranges of a heap are kept by offset and by size, allocation is best fit
+// and released ranges are merged with their neighbours
+// heaps are registered with the residency manager if set, in use while they hold ranges
+class DX12HeapAllocator {
+public:
+    static const uint64_t sDefaultHeapSize = 64 * 1024 * 1024;
+
+    DX12HeapAllocator(ID3D12Device* pDevice, DX12ResidencyManager* pResidency = nullptr,
+        uint64_t heapSize = sDefaultHeapSize);
+    DX12HeapAllocator(const DX12HeapAllocator&) = delete;
+    DX12HeapAllocator& operator=(const DX12HeapAllocator&) = delete;
+    ~DX12HeapAllocator();
+
+    DX12PlacedResource createBuffer(uint64_t size, D3D12_RESOURCE_STATES state,
+        D3D12_RESOURCE_FLAGS flags = D3D12_RESOURCE_FLAG_NONE);
+    DX12PlacedResource createTexture(const D3D12_RESOURCE_DESC& desc, D3D12_RESOURCE_STATES state);
+
+    // ranges released before nextFence are reused once completedFence reaches their fence
+    void advanceFrame(uint64_t nextFence, uint64_t completedFence);
+
+    DX12HeapStatistics statistics(DX12HeapClass heapClass) const;
+    DX12HeapStatistics statistics() const;
+private:
+    friend class DX12HeapRange;
+
+    struct Heap {
+        com_ptr<ID3D12Heap> mHeap;
+        uint64_t mSize = 0;
+        uint64_t mAllocatedSize = 0;
+        // offset -> size, and size -> offset for best fit
+        std::map<uint64_t, uint64_t> mFreeByOffset;
+        std::multimap<uint64_t, uint64_t> mFreeBySize;
+    };
+    struct Retired {
+        DX12HeapClass mClass;
+        uint32_t mHeapID;
+        uint64_t mOffset;
+        uint64_t mSize;
+        uint64_t mFence;
+    };
+
+    std::shared_ptr<const DX12HeapRange> allocate(DX12HeapClass heapClass,
+        uint64_t size, uint64_t alignment);
+    void release(const DX12HeapRange& range) noexcept;
+    void insertFree(Heap& heap, uint64_t offset, uint64_t size);
+    void eraseFree(Heap& heap, std::map<uint64_t, uint64_t>::iterator iter);
+
+    ID3D12Device* mDevice = nullptr;
+    DX12ResidencyManager* mResidency = nullptr;
+    uint64_t mHeapSize = 0;
+    mutable std::mutex mMutex;
+    std::array<std::vector<Heap>, DX12HeapClassCount> mHeaps;
+    std::array<uint64_t, DX12HeapClassCount> mAllocationCounts = {};
+    std::deque<Retired> mRetired;
+    uint64_t mRetireFence = 0;
+};
+
+}
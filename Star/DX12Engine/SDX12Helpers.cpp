@@ -50,27 +50,40 @@ com_ptr<IDXGIFactory4> createFactory() {
     }
 
     // Determines whether tearing support is available for fullscreen borderless windows.
-    if (true) {
-        BOOL allowTearing = FALSE;
+    if (!isTearingSupported(factory.get())) {
+        OutputDebugStringA("WARNING: Variable refresh rate displays are not supported.\n");
+    }
+    return factory;
+}
 
-        com_ptr<IDXGIFactory5> factory5 = factory.try_as<IDXGIFactory5>();
+bool isTearingSupported(IDXGIFactory4* pFactory) {
+    BOOL allowTearing = FALSE;
 
-        HRESULT hr = S_OK;
-        if (factory5) {
-            hr = factory5->CheckFeatureSupport(DXGI_FEATURE_PRESENT_ALLOW_TEARING, &allowTearing, sizeof(allowTearing));
-        }
+    com_ptr<IDXGIFactory5> factory5;
+    if (FAILED(pFactory->QueryInterface(IID_PPV_ARGS(factory5.put()))))
+        return false;
 
-        if (FAILED(hr)) {
-            OutputDebugStringA("WARNING: Variable refresh rate displays are not supported.\n");
-        }
-    }
-    return factory;
+    HRESULT hr = factory5->CheckFeatureSupport(DXGI_FEATURE_PRESENT_ALLOW_TEARING, &allowTearing, sizeof(allowTearing));
+    return SUCCEEDED(hr) && allowTearing;
 }
 
-com_ptr<IDXGIAdapter1> getHardwareAdapter(IDXGIFactory4* pFactory) {
-    com_ptr<IDXGIAdapter1> adapter;
+com_ptr<IDXGIAdapter1> getHardwareAdapter(IDXGIFactory4* pFactory, uint64_t luid, uint32_t vendorID) {
+    // first adapter of hybrid and multi gpu systems is often the integrated one
+    com_ptr<IDXGIFactory6> factory6;
+    pFactory->QueryInterface(IID_PPV_ARGS(factory6.put()));
+    auto enumAdapter = [&](UINT adapterID, com_ptr<IDXGIAdapter1>& adapter) {
+        adapter = nullptr;
+        if (factory6) {
+            return factory6->EnumAdapterByGpuPreference(adapterID,
+                DXGI_GPU_PREFERENCE_HIGH_PERFORMANCE, IID_PPV_ARGS(adapter.put()));
+        }
+        return pFactory->EnumAdapters1(adapterID, adapter.put());
+    };
 
-    for (UINT adapterID = 0; DXGI_ERROR_NOT_FOUND != pFactory->EnumAdapters1(adapterID, adapter.put()); ++adapterID) {
+    com_ptr<IDXGIAdapter1> adapter;
+    com_ptr<IDXGIAdapter1> fastest;
+    com_ptr<IDXGIAdapter1> vendor;
+    for (UINT adapterID = 0; DXGI_ERROR_NOT_FOUND != enumAdapter(adapterID, adapter); ++adapterID) {
         DXGI_ADAPTER_DESC1 desc;
         ThrowIfFailed(adapter->GetDesc1(&desc));
 
@@ -80,21 +93,60 @@ com_ptr<IDXGIAdapter1> getHardwareAdapter(IDXGIFactory4* pFactory) {
         }
 
         // Check to see if the adapter supports Direct3D 12, but don't create the actual device yet.
-        if (SUCCEEDED(D3D12CreateDevice(adapter.get(),
+        if (FAILED(D3D12CreateDevice(adapter.get(),
             D3D_FEATURE_LEVEL_11_0, _uuidof(ID3D12Device), nullptr)))
-        {
+            continue;
+
 #ifdef STAR_DEV
-            wchar_t buff[256] = {};
-            swprintf_s(buff, L"Direct3D Adapter (%u): VID:%04X, PID:%04X - %ls\n", adapterID, desc.VendorId, desc.DeviceId, desc.Description);
-            OutputDebugStringW(buff);
+        wchar_t buff[256] = {};
+        swprintf_s(buff, L"Direct3D Adapter (%u): VID:%04X, PID:%04X, LUID:%08X%08X, %llu MB - %ls\n",
+            adapterID, desc.VendorId, desc.DeviceId, desc.AdapterLuid.HighPart, desc.AdapterLuid.LowPart,
+            uint64_t(desc.DedicatedVideoMemory) >> 20, desc.Description);
+        OutputDebugStringW(buff);
 #endif
+        if (luid && getAdapterLuid(adapter.get()) == luid) {
             return adapter;
         }
+        if (!vendor && vendorID && desc.VendorId == vendorID) {
+            vendor = adapter;
+        }
+        if (!fastest) {
+            fastest = adapter;
+        }
     }
 
+    if (vendor)
+        return vendor;
+    if (fastest)
+        return fastest;
+
     throw std::runtime_error("no adaptor support d3d12");
 }
 
+uint64_t getAdapterLuid(IDXGIAdapter1* pAdapter) {
+    DXGI_ADAPTER_DESC1 desc;
+    ThrowIfFailed(pAdapter->GetDesc1(&desc));
+    return uint64_t(desc.AdapterLuid.LowPart) | (uint64_t(uint32_t(desc.AdapterLuid.HighPart)) << 32);
+}
+
+DWORD registerAdaptersChangedEvent(IDXGIFactory4* pFactory, HANDLE hEvent) {
+    com_ptr<IDXGIFactory7> factory7;
+    if (FAILED(pFactory->QueryInterface(IID_PPV_ARGS(factory7.put()))))
+        return 0;
+
+    DWORD cookie = 0;
+    if (FAILED(factory7->RegisterAdaptersChangedEvent(hEvent, &cookie)))
+        return 0;
+    return cookie;
+}
+
+void unregisterAdaptersChangedEvent(IDXGIFactory4* pFactory, DWORD cookie) noexcept {
+    com_ptr<IDXGIFactory7> factory7;
+    if (cookie && SUCCEEDED(pFactory->QueryInterface(IID_PPV_ARGS(factory7.put())))) {
+        factory7->UnregisterAdaptersChangedEvent(cookie);
+    }
+}
+
 bool isDirectXRaytracingSupported(IDXGIAdapter1* adapter) {
     com_ptr<ID3D12Device> testDevice;
     D3D12_FEATURE_DATA_D3D12_OPTIONS5 featureSupportData = {};
@@ -104,7 +156,21 @@ bool isDirectXRaytracingSupported(IDXGIAdapter1* adapter) {
         && featureSupportData.RaytracingTier != D3D12_RAYTRACING_TIER_NOT_SUPPORTED;
 }
 
-com_ptr<ID3D12Device> createDevice(IDXGIFactory4* pFactory) {
+com_ptr<IDXGIAdapter3> getDeviceAdapter(IDXGIFactory4* pFactory, ID3D12Device* pDevice) {
+    com_ptr<IDXGIAdapter3> adapter;
+    V(pFactory->EnumAdapterByLuid(pDevice->GetAdapterLuid(), IID_PPV_ARGS(adapter.put())));
+    return adapter;
+}
+
+bool isTiledResourcesSupported(ID3D12Device* pDevice) {
+    D3D12_FEATURE_DATA_D3D12_OPTIONS options = {};
+    return SUCCEEDED(pDevice->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS, &options, sizeof(options)))
+        && options.TiledResourcesTier != D3D12_TILED_RESOURCES_TIER_NOT_SUPPORTED;
+}
+
+com_ptr<ID3D12Device> createDevice(IDXGIFactory4* pFactory, uint64_t adapterLuid, uint32_t adapterVendorID,
+    bool dred
+) {
     com_ptr<ID3D12Device> device;
 #ifdef STAR_DEV
     {
@@ -121,8 +187,17 @@ com_ptr<ID3D12Device> createDevice(IDXGIFactory4* pFactory) {
 //#endif // _DEBUG
     }
 #endif // STAR_DEV
+    if (dred) {
+        com_ptr<ID3D12DeviceRemovedExtendedDataSettings> dredSettings;
+        if (SUCCEEDED(D3D12GetDebugInterface(IID_PPV_ARGS(dredSettings.put())))) {
+            dredSettings->SetAutoBreadcrumbsEnablement(D3D12_DRED_ENABLEMENT_FORCED_ON);
+            dredSettings->SetPageFaultEnablement(D3D12_DRED_ENABLEMENT_FORCED_ON);
+        } else {
+            OutputDebugStringA("WARNING: DRED is not available, device removal is reported without breadcrumbs\n");
+        }
+    }
 
-    com_ptr<IDXGIAdapter1> hardwareAdapter = getHardwareAdapter(pFactory);
+    com_ptr<IDXGIAdapter1> hardwareAdapter = getHardwareAdapter(pFactory, adapterLuid, adapterVendorID);
     //if (!isDirectXRaytracingSupported(hardwareAdapter.get())) {
     //    throw std::runtime_error("ERROR: DirectX Raytracing is not supported by your OS, GPU and/or driver");
     //}
@@ -170,6 +245,30 @@ com_ptr<ID3D12CommandQueue> createDirectQueue(ID3D12Device* pDevice) {
     return cq;
 }
 
+com_ptr<ID3D12CommandQueue> createComputeQueue(ID3D12Device* pDevice) {
+    com_ptr<ID3D12CommandQueue> cq;
+    D3D12_COMMAND_QUEUE_DESC queueDesc = {};
+    queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+    queueDesc.Type = D3D12_COMMAND_LIST_TYPE_COMPUTE;
+
+    V(pDevice->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(cq.put())));
+    STAR_SET_DEBUG_NAME(cq, "ComputeQueue");
+
+    return cq;
+}
+
+com_ptr<ID3D12CommandQueue> createCopyQueue(ID3D12Device* pDevice) {
+    com_ptr<ID3D12CommandQueue> cq;
+    D3D12_COMMAND_QUEUE_DESC queueDesc = {};
+    queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+    queueDesc.Type = D3D12_COMMAND_LIST_TYPE_COPY;
+
+    V(pDevice->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(cq.put())));
+    STAR_SET_DEBUG_NAME(cq, "CopyQueue");
+
+    return cq;
+}
+
 com_ptr<ID3D12Fence> createFence(ID3D12Device* pDevice, uint64_t& nextFrame,
     std::string_view name, bool increment
 ) {
@@ -206,6 +305,20 @@ com_ptr<ID3D12Resource> createBuffer(ID3D12Device* pDevice, uint64_t size) {
     return ptr;
 }
 
+com_ptr<ID3D12Resource> createUnorderedAccessBuffer(ID3D12Device* pDevice, uint64_t size, D3D12_RESOURCE_STATES state) {
+    com_ptr<ID3D12Resource> ptr;
+
+    V(pDevice->CreateCommittedResource(
+        &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
+        D3D12_HEAP_FLAG_NONE,
+        &CD3DX12_RESOURCE_DESC::Buffer(size, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS),
+        state,
+        nullptr,
+        IID_PPV_ARGS(ptr.put())));
+
+    return ptr;
+}
+
 com_ptr<ID3D12Resource> createTexture2D(ID3D12Device* pDevice, const D3D12_RESOURCE_DESC& desc) {
     com_ptr<ID3D12Resource> tex;
     V(pDevice->CreateCommittedResource(
@@ -44,13 +44,32 @@ uint64_t waitForFence(ID3D12Fence* Fence, HANDLE FenceEvent, uint64_t WaitValue)
 
 com_ptr<IDXGIFactory4> createFactory();
 
-com_ptr<IDXGIAdapter1> getHardwareAdapter(IDXGIFactory4* pFactory);
+bool isTearingSupported(IDXGIFactory4* pFactory);
+
+// highest performance adapter supporting d3d12, an adapter matching luid or else vendorID is preferred
+// luid is LowPart | HighPart << 32, 0 matches any adapter
+com_ptr<IDXGIAdapter1> getHardwareAdapter(IDXGIFactory4* pFactory,
+    uint64_t luid = 0, uint32_t vendorID = 0);
+
+uint64_t getAdapterLuid(IDXGIAdapter1* pAdapter);
+
+// event signaled when adapters are added or removed, returns 0 if the factory cannot notify
+DWORD registerAdaptersChangedEvent(IDXGIFactory4* pFactory, HANDLE hEvent);
+void unregisterAdaptersChangedEvent(IDXGIFactory4* pFactory, DWORD cookie) noexcept;
 
 bool isDirectXRaytracingSupported(IDXGIAdapter1* adapter);
 
-com_ptr<ID3D12Device> createDevice(IDXGIFactory4* pFactory);
+bool isTiledResourcesSupported(ID3D12Device* pDevice);
+
+// dred records auto breadcrumbs and page faults of the device, read after it is removed
+com_ptr<ID3D12Device> createDevice(IDXGIFactory4* pFactory,
+    uint64_t adapterLuid = 0, uint32_t adapterVendorID = 0, bool dred = false);
+
+com_ptr<IDXGIAdapter3> getDeviceAdapter(IDXGIFactory4* pFactory, ID3D12Device* pDevice);
 
 com_ptr<ID3D12CommandQueue> createDirectQueue(ID3D12Device* pDevice);
+com_ptr<ID3D12CommandQueue> createComputeQueue(ID3D12Device* pDevice);
+com_ptr<ID3D12CommandQueue> createCopyQueue(ID3D12Device* pDevice);
 
 com_ptr<ID3D12Fence> createFence(ID3D12Device* pDevice,
     uint64_t& nextFrame, std::string_view, bool increment = true);
@@ -58,6 +77,7 @@ com_ptr<ID3D12Fence> createFence(ID3D12Device* pDevice,
 winrt::handle createFenceEvent();
 
 com_ptr<ID3D12Resource> createBuffer(ID3D12Device* pDevice, uint64_t size);
+com_ptr<ID3D12Resource> createUnorderedAccessBuffer(ID3D12Device* pDevice, uint64_t size, D3D12_RESOURCE_STATES state);
 com_ptr<ID3D12Resource> createTexture2D(ID3D12Device* pDevice, const D3D12_RESOURCE_DESC& desc);
 
 }
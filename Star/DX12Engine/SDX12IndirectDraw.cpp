@@ -0,0 +1,595 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "SDX12IndirectDraw.h"
+#include "SDX12Utils.h"
+#include "SDX12Culling.h"
+#include "SDX12Transforms.h"
+
+namespace Star::Graphics::Render {
+
+namespace {
+
+// one thread per object, visible objects append their instance data
+// and increase the instance count of their draw arguments
+const char sIndirectCullShader[] = R"(
+#define IndirectCullRS "RootConstants(num32BitConstants=45, b0), SRV(t0), UAV(u0), UAV(u1)"
+
+struct Object {
+    float4 World[4];
+    float4 WorldInvT[4];
+    float4 Center;
+    float4 Extent;
+    uint InstanceCountOffset;
+    uint InstanceOffset;
+    uint2 Reserved;
+};
+
+cbuffer Cull : register(b0) {
+    float4 View[4];
+    float4 Planes[6];
+    uint ObjectBegin;
+    uint ObjectCount;
+    uint InstanceStride;
+    uint WorldViewOffset;
+    uint WorldInvTOffset;
+};
+
+StructuredBuffer<Object> gObjects : register(t0);
+RWByteAddressBuffer gArguments : register(u0);
+RWByteAddressBuffer gInstances : register(u1);
+
+float4 transform(float4 m[4], float4 v) {
+    return m[0] * v.x + m[1] * v.y + m[2] * v.z + m[3] * v.w;
+}
+
+void storeMatrix(uint offset, float4 m[4]) {
+    [unroll] for (uint i = 0; i != 4; ++i) {
+        gInstances.Store4(offset + 16 * i, asuint(m[i]));
+    }
+}
+
+[RootSignature(IndirectCullRS)]
+[numthreads(64, 1, 1)]
+void main(uint3 id : SV_DispatchThreadID) {
+    if (id.x >= ObjectCount)
+        return;
+
+    Object o = gObjects[ObjectBegin + id.x];
+    float3 center = transform(o.World, float4(o.Center.xyz, 1)).xyz;
+    float3 extent = abs(o.World[0].xyz) * o.Extent.x
+        + abs(o.World[1].xyz) * o.Extent.y
+        + abs(o.World[2].xyz) * o.Extent.z;
+
+    [unroll] for (uint i = 0; i != 6; ++i) {
+        float4 p = Planes[i];
+        if (dot(p.xyz, center) + p.w + dot(abs(p.xyz), extent) < 0)
+            return;
+    }
+
+    uint index;
+    gArguments.InterlockedAdd(o.InstanceCountOffset, 1, index);
+    uint offset = o.InstanceOffset + index * InstanceStride;
+
+    if (WorldViewOffset != 0xFFFFFFFF) {
+        float4 worldView[4];
+        [unroll] for (uint j = 0; j != 4; ++j) {
+            worldView[j] = transform(View, o.World[j]);
+        }
+        storeMatrix(offset + WorldViewOffset, worldView);
+    }
+    if (WorldInvTOffset != 0xFFFFFFFF) {
+        storeMatrix(offset + WorldInvTOffset, o.WorldInvT);
+    }
+}
+)";
+
+struct IndirectCullConstants {
+    float mView[16];
+    float mPlanes[24];
+    uint32_t mObjectBegin;
+    uint32_t mObjectCount;
+    uint32_t mInstanceStride;
+    uint32_t mWorldViewOffset;
+    uint32_t mWorldInvTOffset;
+};
+static_assert(sizeof(IndirectCullConstants) == 45 * sizeof(uint32_t));
+
+// command: instance SRV, vertex buffer views, index buffer view, indexed draw
+uint32_t getCommandArgumentOffset(size_t vertexBufferCount) noexcept {
+    return gsl::narrow_cast<uint32_t>(sizeof(D3D12_GPU_VIRTUAL_ADDRESS)
+        + sizeof(D3D12_VERTEX_BUFFER_VIEW) * vertexBufferCount
+        + sizeof(D3D12_INDEX_BUFFER_VIEW));
+}
+
+uint32_t getCommandStride(size_t vertexBufferCount) noexcept {
+    return gsl::narrow_cast<uint32_t>(boost::alignment::align_up(
+        getCommandArgumentOffset(vertexBufferCount) + sizeof(D3D12_DRAW_INDEXED_ARGUMENTS),
+        sizeof(D3D12_GPU_VIRTUAL_ADDRESS)));
+}
+
+const DX12DrawBinding* getInstanceBinding(const DX12UnorderedRenderQueue& queue,
+    const DX12DrawPacket& packet) noexcept {
+    const DX12DrawBinding* pInstanceBinding = nullptr;
+    for (uint32_t bindingID = packet.mBindingBegin; bindingID != packet.mBindingBegin + packet.mBindingCount; ++bindingID) {
+        const auto& binding = queue.mDrawBindings[bindingID];
+        if (binding.mType == RootShaderResourceBinding) {
+            if (pInstanceBinding)
+                return nullptr;
+            pInstanceBinding = &binding;
+            continue;
+        }
+        if (binding.mType == DescriptorTableBinding && binding.mCapacity == 0)
+            continue;
+        return nullptr;
+    }
+    return pInstanceBinding;
+}
+
+bool isIndirectDrawable(const DX12UnorderedRenderQueue& queue, const DX12DrawPacket& packet) noexcept {
+    if (!packet.mMesh || !packet.mBatch || !packet.mMesh->mIndexBufferView.BufferLocation)
+        return false;
+    const auto* pBinding = getInstanceBinding(queue, packet);
+    if (!pBinding)
+        return false;
+
+    // culling shader writes current transforms only, previous ones are written on the cpu
+    const auto& desc = queue.mDrawDescriptors[pBinding->mDescriptorBegin];
+    for (uint32_t constantID = desc.mConstantBegin; constantID != desc.mConstantBegin + desc.mConstantCount; ++constantID) {
+        const auto type = queue.mDrawConstants[constantID].mType;
+        if (type == TextureIndicesConstant || type == MaterialIndexConstant || type == PrevWorldViewConstant)
+            return false;
+    }
+    return true;
+}
+
+bool isSameIndirectGroup(const DX12UnorderedRenderQueue& queue,
+    const DX12DrawPacket& lhs, const DX12DrawPacket& rhs) noexcept {
+    if (lhs.mPipelineSource != rhs.mPipelineSource ||
+        lhs.mPrimitiveTopology != rhs.mPrimitiveTopology ||
+        lhs.mMesh->mVertexBufferViews.size() != rhs.mMesh->mVertexBufferViews.size() ||
+        lhs.mBindingCount != rhs.mBindingCount) {
+        return false;
+    }
+    for (uint32_t i = 0; i != lhs.mBindingCount; ++i) {
+        const auto& a = queue.mDrawBindings[lhs.mBindingBegin + i];
+        const auto& b = queue.mDrawBindings[rhs.mBindingBegin + i];
+        if (a.mType != b.mType || a.mSlot != b.mSlot)
+            return false;
+        if (a.mType == DescriptorTableBinding && a.mGpuOffset.ptr != b.mGpuOffset.ptr)
+            return false;
+    }
+    return true;
+}
+
+com_ptr<ID3D12CommandSignature> createCommandSignature(ID3D12Device* pDevice,
+    ID3D12RootSignature* pRootSignature, uint32_t instanceSlot, size_t vertexBufferCount
+) {
+    std::vector<D3D12_INDIRECT_ARGUMENT_DESC> args;
+    args.reserve(vertexBufferCount + 3);
+    {
+        auto& arg = args.emplace_back();
+        arg.Type = D3D12_INDIRECT_ARGUMENT_TYPE_SHADER_RESOURCE_VIEW;
+        arg.ShaderResourceView.RootParameterIndex = instanceSlot;
+    }
+    for (uint32_t slot = 0; slot != vertexBufferCount; ++slot) {
+        auto& arg = args.emplace_back();
+        arg.Type = D3D12_INDIRECT_ARGUMENT_TYPE_VERTEX_BUFFER_VIEW;
+        arg.VertexBuffer.Slot = slot;
+    }
+    args.emplace_back().Type = D3D12_INDIRECT_ARGUMENT_TYPE_INDEX_BUFFER_VIEW;
+    args.emplace_back().Type = D3D12_INDIRECT_ARGUMENT_TYPE_DRAW_INDEXED;
+
+    D3D12_COMMAND_SIGNATURE_DESC desc{};
+    desc.ByteStride = getCommandStride(vertexBufferCount);
+    desc.NumArgumentDescs = gsl::narrow_cast<uint32_t>(args.size());
+    desc.pArgumentDescs = args.data();
+
+    com_ptr<ID3D12CommandSignature> signature;
+    V(pDevice->CreateCommandSignature(&desc, pRootSignature, IID_PPV_ARGS(signature.put())));
+    return signature;
+}
+
+DX12IndirectObject makeIndirectObject(const DX12FlattenedObjects& batch, uint32_t objectID) {
+    DX12IndirectObject object{};
+    const Matrix4f world = getDX12WorldTransform(batch, objectID).matrix();
+    const Matrix4f worldInvT = getDX12WorldTransformInv(batch, objectID).matrix();
+    memcpy(object.mWorld, world.data(), sizeof(object.mWorld));
+    memcpy(object.mWorldInvT, worldInvT.data(), sizeof(object.mWorldInvT));
+
+    const Aabb3f* pBounds = objectID < batch.mBoundingBoxes.size() ?
+        &batch.mBoundingBoxes[objectID].mLocalBounds : nullptr;
+    if (pBounds && pBounds->valid()) {
+        const Vector3f center = pBounds->center();
+        const Vector3f extent = pBounds->extent();
+        std::copy(center.data(), center.data() + 3, object.mBoundsCenter);
+        std::copy(extent.data(), extent.data() + 3, object.mBoundsExtent);
+    } else {
+        // unbounded objects are never culled
+        std::fill(object.mBoundsExtent, object.mBoundsExtent + 3, 1e18f);
+    }
+    return object;
+}
+
+// queue is drawn once all of its streamed meshes are uploaded
+bool isResident(const DX12UnorderedRenderQueue& queue) noexcept {
+    for (const auto& packet : queue.mDrawPackets) {
+        if (!packet.mMesh->mResident)
+            return false;
+    }
+    return true;
+}
+
+com_ptr<ID3D12Resource> createUploadedBuffer(CreationContext& context, const void* pData, size_t size) {
+    auto buffer = DX12::createBuffer(context.mDevice, size);
+    auto pos = context.upload(pData, size, 16);
+    context.mCopyList->CopyBufferRegion(buffer.get(), 0, pos.mResource, pos.mBufferOffset, size);
+    return buffer;
+}
+
+// turns a thread count written on gpu into dispatch arguments, a group size of 0 copies the arguments
+const char sDispatchArgumentsShader[] = R"(
+#define DispatchArgumentsRS "RootConstants(num32BitConstants=4, b0), UAV(u0), UAV(u1)"
+
+cbuffer Dispatch : register(b0) {
+    uint CountOffset;
+    uint GroupSize;
+    uint ArgumentOffset;
+    uint Reserved;
+};
+
+RWByteAddressBuffer gCounts : register(u0);
+RWByteAddressBuffer gArguments : register(u1);
+
+[RootSignature(DispatchArgumentsRS)]
+[numthreads(1, 1, 1)]
+void main() {
+    if (GroupSize == 0) {
+        gArguments.Store3(ArgumentOffset, gCounts.Load3(CountOffset));
+    } else {
+        uint count = gCounts.Load(CountOffset);
+        gArguments.Store3(ArgumentOffset, uint3((count + GroupSize - 1) / GroupSize, 1, 1));
+    }
+}
+)";
+
+void transitionIndirectDispatch(ID3D12GraphicsCommandList* pCommandList,
+    DX12IndirectDispatch& dispatch, D3D12_RESOURCE_STATES state
+) {
+    if (dispatch.mState == state)
+        return;
+    D3D12_RESOURCE_BARRIER barriers[] = {
+        CD3DX12_RESOURCE_BARRIER::Transition(dispatch.mArguments.get(), dispatch.mState, state),
+    };
+    pCommandList->ResourceBarrier(_countof(barriers), barriers);
+    dispatch.mState = state;
+}
+
+}
+
+DX12IndirectPipeline createDX12IndirectPipeline(ID3D12Device* pDevice) {
+    com_ptr<ID3DBlob> shader;
+    com_ptr<ID3DBlob> errors;
+    HRESULT hr = D3DCompile(sIndirectCullShader, sizeof(sIndirectCullShader) - 1,
+        "IndirectCull", nullptr, nullptr, "main", "cs_5_1",
+        D3DCOMPILE_OPTIMIZATION_LEVEL3, 0, shader.put(), errors.put());
+    if (FAILED(hr)) {
+        throw std::runtime_error(errors ?
+            static_cast<const char*>(errors->GetBufferPointer()) :
+            "indirect cull shader compilation failed");
+    }
+
+    DX12IndirectPipeline pipeline;
+    V(pDevice->CreateRootSignature(0, shader->GetBufferPointer(), shader->GetBufferSize(),
+        IID_PPV_ARGS(pipeline.mRootSignature.put())));
+
+    D3D12_COMPUTE_PIPELINE_STATE_DESC desc{};
+    desc.pRootSignature = pipeline.mRootSignature.get();
+    desc.CS = CD3DX12_SHADER_BYTECODE(shader.get());
+    V(pDevice->CreateComputePipelineState(&desc, IID_PPV_ARGS(pipeline.mPipelineState.put())));
+    return pipeline;
+}
+
+DX12IndirectDispatchPipeline createDX12IndirectDispatchPipeline(ID3D12Device* pDevice) {
+    com_ptr<ID3DBlob> shader;
+    com_ptr<ID3DBlob> errors;
+    HRESULT hr = D3DCompile(sDispatchArgumentsShader, sizeof(sDispatchArgumentsShader) - 1,
+        "DispatchArguments", nullptr, nullptr, "main", "cs_5_1",
+        D3DCOMPILE_OPTIMIZATION_LEVEL3, 0, shader.put(), errors.put());
+    if (FAILED(hr)) {
+        throw std::runtime_error(errors ?
+            static_cast<const char*>(errors->GetBufferPointer()) :
+            "dispatch arguments shader compilation failed");
+    }
+
+    DX12IndirectDispatchPipeline pipeline;
+    V(pDevice->CreateRootSignature(0, shader->GetBufferPointer(), shader->GetBufferSize(),
+        IID_PPV_ARGS(pipeline.mRootSignature.put())));
+
+    D3D12_COMPUTE_PIPELINE_STATE_DESC desc{};
+    desc.pRootSignature = pipeline.mRootSignature.get();
+    desc.CS = CD3DX12_SHADER_BYTECODE(shader.get());
+    V(pDevice->CreateComputePipelineState(&desc, IID_PPV_ARGS(pipeline.mPipelineState.put())));
+
+    // no root arguments change, the signature is usable with any compute root signature
+    D3D12_INDIRECT_ARGUMENT_DESC arg{};
+    arg.Type = D3D12_INDIRECT_ARGUMENT_TYPE_DISPATCH;
+    D3D12_COMMAND_SIGNATURE_DESC signatureDesc{};
+    signatureDesc.ByteStride = sizeof(D3D12_DISPATCH_ARGUMENTS);
+    signatureDesc.NumArgumentDescs = 1;
+    signatureDesc.pArgumentDescs = &arg;
+    V(pDevice->CreateCommandSignature(&signatureDesc, nullptr,
+        IID_PPV_ARGS(pipeline.mCommandSignature.put())));
+    return pipeline;
+}
+
+void createDX12IndirectDispatch(ID3D12Device* pDevice, uint32_t count, DX12IndirectDispatch& dispatch) {
+    Expects(count);
+    dispatch.mArguments = DX12::createUnorderedAccessBuffer(pDevice,
+        count * sizeof(D3D12_DISPATCH_ARGUMENTS), D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+    dispatch.mState = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+}
+
+void writeDX12DispatchArguments(ID3D12GraphicsCommandList* pCommandList,
+    const DX12IndirectDispatchPipeline& pipeline, ID3D12Resource* pCounts, uint32_t countOffset,
+    uint32_t groupSize, DX12IndirectDispatch& dispatch, uint32_t argumentOffset
+) {
+    Expects(countOffset % sizeof(uint32_t) == 0);
+    Expects(argumentOffset % sizeof(uint32_t) == 0);
+    transitionIndirectDispatch(pCommandList, dispatch, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+    {
+        // counts written by the previous dispatches
+        D3D12_RESOURCE_BARRIER barriers[] = {
+            CD3DX12_RESOURCE_BARRIER::UAV(pCounts),
+        };
+        pCommandList->ResourceBarrier(_countof(barriers), barriers);
+    }
+
+    const uint32_t constants[4] = { countOffset, groupSize, argumentOffset, 0 };
+    pCommandList->SetComputeRootSignature(pipeline.mRootSignature.get());
+    pCommandList->SetPipelineState(pipeline.mPipelineState.get());
+    pCommandList->SetComputeRoot32BitConstants(0, _countof(constants), constants, 0);
+    pCommandList->SetComputeRootUnorderedAccessView(1, pCounts->GetGPUVirtualAddress());
+    pCommandList->SetComputeRootUnorderedAccessView(2, dispatch.mArguments->GetGPUVirtualAddress());
+    pCommandList->Dispatch(1, 1, 1);
+}
+
+void executeDX12IndirectDispatch(ID3D12GraphicsCommandList* pCommandList,
+    const DX12IndirectDispatchPipeline& pipeline, DX12IndirectDispatch& dispatch, uint32_t offset
+) {
+    transitionIndirectDispatch(pCommandList, dispatch, D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT);
+    pCommandList->ExecuteIndirect(pipeline.mCommandSignature.get(), 1,
+        dispatch.mArguments.get(), offset, nullptr, 0);
+}
+
+void buildDX12IndirectDraws(CreationContext& context,
+    ID3D12RootSignature* pRootSignature, DX12UnorderedRenderQueue& queue
+) {
+    queue.mIndirectGroups.clear();
+    queue.mIndirectBuffers = {};
+
+    if (queue.mDrawPackets.empty() || !pRootSignature)
+        return;
+
+    // shader levels are selected per instance on cpu
+    for (const auto& packet : queue.mDrawPackets) {
+        if (!isIndirectDrawable(queue, packet) || packet.mShaderLevelCount > 1)
+            return;
+    }
+
+    std::vector<DX12IndirectObject> objects;
+    std::vector<std::byte> commands;
+    std::vector<uint32_t> commandOffsets;
+    commandOffsets.reserve(queue.mDrawPackets.size());
+    uint32_t instanceSize = 0;
+
+    for (uint32_t packetID = 0; packetID != queue.mDrawPackets.size(); ++packetID) {
+        const auto& packet = queue.mDrawPackets[packetID];
+        const auto& mesh = *packet.mMesh;
+        const auto vertexBufferCount = mesh.mVertexBufferViews.size();
+
+        if (queue.mIndirectGroups.empty() ||
+            !isSameIndirectGroup(queue, queue.mDrawPackets[queue.mIndirectGroups.back().mPacketID], packet)) {
+            const auto& binding = *getInstanceBinding(queue, packet);
+            Expects(binding.mDescriptorCount == 1);
+            const auto& desc = queue.mDrawDescriptors[binding.mDescriptorBegin];
+
+            auto& group = queue.mIndirectGroups.emplace_back();
+            group.mCommandSignature = createCommandSignature(context.mDevice,
+                pRootSignature, binding.mSlot, vertexBufferCount);
+            group.mPipelineState = packet.mPipelineState;
+            group.mPrimitiveTopology = packet.mPrimitiveTopology;
+            group.mPacketID = packetID;
+            group.mArgumentOffset = gsl::narrow_cast<uint32_t>(commands.size());
+            group.mObjectBegin = gsl::narrow_cast<uint32_t>(objects.size());
+            group.mInstanceStride = desc.mSize;
+            for (uint32_t constantID = desc.mConstantBegin; constantID != desc.mConstantBegin + desc.mConstantCount; ++constantID) {
+                const auto& constant = queue.mDrawConstants[constantID];
+                switch (constant.mType) {
+                case WorldViewConstant:
+                    group.mWorldViewOffset = constant.mOffset;
+                    break;
+                case WorldInvTConstant:
+                    group.mWorldInvTOffset = constant.mOffset;
+                    break;
+                default:
+                    break;
+                }
+            }
+        }
+        auto& group = queue.mIndirectGroups.back();
+
+        // command template, instance address is patched once the instance buffer exists
+        const auto commandOffset = gsl::narrow_cast<uint32_t>(commands.size());
+        const auto instanceOffset = gsl::narrow_cast<uint32_t>(boost::alignment::align_up(instanceSize, 16));
+        instanceSize = instanceOffset + packet.mInstanceCount * group.mInstanceStride;
+        commands.resize(commands.size() + getCommandStride(vertexBufferCount));
+        commandOffsets.emplace_back(commandOffset);
+
+        auto* pCommand = commands.data() + commandOffset;
+        D3D12_GPU_VIRTUAL_ADDRESS instanceAddress = instanceOffset;
+        memcpy(pCommand, &instanceAddress, sizeof(instanceAddress));
+        pCommand += sizeof(instanceAddress);
+        memcpy(pCommand, mesh.mVertexBufferViews.data(), sizeof(D3D12_VERTEX_BUFFER_VIEW) * vertexBufferCount);
+        pCommand += sizeof(D3D12_VERTEX_BUFFER_VIEW) * vertexBufferCount;
+        memcpy(pCommand, &mesh.mIndexBufferView, sizeof(D3D12_INDEX_BUFFER_VIEW));
+        pCommand += sizeof(D3D12_INDEX_BUFFER_VIEW);
+        D3D12_DRAW_INDEXED_ARGUMENTS draw{ packet.mElementCount, 0, packet.mElementOffset, packet.mBaseVertex, 0 };
+        memcpy(pCommand, &draw, sizeof(draw));
+
+        const auto instanceCountOffset = commandOffset + getCommandArgumentOffset(vertexBufferCount)
+            + gsl::narrow_cast<uint32_t>(offsetof(D3D12_DRAW_INDEXED_ARGUMENTS, InstanceCount));
+        for (uint32_t instanceID = 0; instanceID != packet.mInstanceCount; ++instanceID) {
+            auto& object = objects.emplace_back(makeIndirectObject(*packet.mBatch,
+                queue.mDrawInstances[packet.mInstanceBegin + instanceID]));
+            object.mInstanceCountOffset = instanceCountOffset;
+            object.mInstanceOffset = instanceOffset;
+        }
+        ++group.mCommandCount;
+        group.mObjectCount += packet.mInstanceCount;
+    }
+
+    auto& buffers = queue.mIndirectBuffers;
+    buffers.mArgumentSize = gsl::narrow_cast<uint32_t>(commands.size());
+    buffers.mObjects = createUploadedBuffer(context, objects.data(), sizeof(DX12IndirectObject) * objects.size());
+
+    std::vector<D3D12_RESOURCE_BARRIER> barriers;
+    barriers.emplace_back(CD3DX12_RESOURCE_BARRIER::Transition(buffers.mObjects.get(),
+        CreationContext::sUploadedState, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE));
+
+    const auto frameCount = std::max(1u, context.mFrameQueueSize);
+    buffers.mFrames.resize(frameCount);
+    std::vector<std::byte> frameCommands;
+    for (auto& frame : buffers.mFrames) {
+        frame.mInstances = DX12::createUnorderedAccessBuffer(context.mDevice,
+            std::max(instanceSize, 16u), D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+        frame.mArguments = DX12::createUnorderedAccessBuffer(context.mDevice,
+            commands.size(), D3D12_RESOURCE_STATE_COPY_DEST);
+
+        frameCommands = commands;
+        const auto instanceBase = frame.mInstances->GetGPUVirtualAddress();
+        for (auto offset : commandOffsets) {
+            D3D12_GPU_VIRTUAL_ADDRESS address;
+            memcpy(&address, frameCommands.data() + offset, sizeof(address));
+            address += instanceBase;
+            memcpy(frameCommands.data() + offset, &address, sizeof(address));
+        }
+        frame.mCommands = createUploadedBuffer(context, frameCommands.data(), frameCommands.size());
+
+        barriers.emplace_back(CD3DX12_RESOURCE_BARRIER::Transition(frame.mCommands.get(),
+            CreationContext::sUploadedState, D3D12_RESOURCE_STATE_COPY_SOURCE));
+        barriers.emplace_back(CD3DX12_RESOURCE_BARRIER::Transition(frame.mArguments.get(),
+            D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT));
+    }
+    context.mCommandList->ResourceBarrier(gsl::narrow_cast<uint32_t>(barriers.size()), barriers.data());
+}
+
+void dispatchDX12IndirectDraws(ID3D12GraphicsCommandList* pCommandList,
+    const DX12IndirectPipeline& pipeline, const CameraData& cam,
+    const DX12UnorderedRenderQueue& queue, uint32_t frameIndex
+) {
+    if (queue.mIndirectGroups.empty() || !isResident(queue))
+        return;
+
+    const auto& buffers = queue.mIndirectBuffers;
+    const auto& frame = buffers.mFrames[frameIndex % buffers.mFrames.size()];
+    auto* pArguments = frame.mArguments.get();
+    auto* pInstances = frame.mInstances.get();
+    {
+        D3D12_RESOURCE_BARRIER barriers[] = {
+            CD3DX12_RESOURCE_BARRIER::Transition(pArguments,
+                D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT, D3D12_RESOURCE_STATE_COPY_DEST),
+            CD3DX12_RESOURCE_BARRIER::Transition(pInstances,
+                D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS),
+        };
+        pCommandList->ResourceBarrier(_countof(barriers), barriers);
+    }
+
+    // reset instance counts
+    pCommandList->CopyBufferRegion(pArguments, 0, frame.mCommands.get(), 0, buffers.mArgumentSize);
+    {
+        D3D12_RESOURCE_BARRIER barriers[] = {
+            CD3DX12_RESOURCE_BARRIER::Transition(pArguments,
+                D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_UNORDERED_ACCESS),
+        };
+        pCommandList->ResourceBarrier(_countof(barriers), barriers);
+    }
+
+    IndirectCullConstants constants{};
+    memcpy(constants.mView, cam.mView.data(), sizeof(constants.mView));
+    const auto frustum = makeDX12Frustum(cam);
+    static_assert(sizeof(constants.mPlanes) == sizeof(frustum.mPlanes));
+    memcpy(constants.mPlanes, frustum.mPlanes, sizeof(constants.mPlanes));
+
+    pCommandList->SetComputeRootSignature(pipeline.mRootSignature.get());
+    pCommandList->SetPipelineState(pipeline.mPipelineState.get());
+    pCommandList->SetComputeRootShaderResourceView(1, buffers.mObjects->GetGPUVirtualAddress());
+    pCommandList->SetComputeRootUnorderedAccessView(2, pArguments->GetGPUVirtualAddress());
+    pCommandList->SetComputeRootUnorderedAccessView(3, pInstances->GetGPUVirtualAddress());
+
+    for (const auto& group : queue.mIndirectGroups) {
+        constants.mObjectBegin = group.mObjectBegin;
+        constants.mObjectCount = group.mObjectCount;
+        constants.mInstanceStride = group.mInstanceStride;
+        constants.mWorldViewOffset = group.mWorldViewOffset;
+        constants.mWorldInvTOffset = group.mWorldInvTOffset;
+        pCommandList->SetComputeRoot32BitConstants(0,
+            sizeof(constants) / sizeof(uint32_t), &constants, 0);
+        pCommandList->Dispatch((group.mObjectCount + 63) / 64, 1, 1);
+    }
+
+    {
+        D3D12_RESOURCE_BARRIER barriers[] = {
+            CD3DX12_RESOURCE_BARRIER::Transition(pArguments,
+                D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT),
+            CD3DX12_RESOURCE_BARRIER::Transition(pInstances,
+                D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE),
+        };
+        pCommandList->ResourceBarrier(_countof(barriers), barriers);
+    }
+}
+
+void executeDX12IndirectDraws(ID3D12GraphicsCommandList* pCommandList,
+    const DX12UnorderedRenderQueue& queue, uint32_t frameIndex
+) {
+    if (queue.mIndirectGroups.empty() || !isResident(queue))
+        return;
+
+    const auto& frames = queue.mIndirectBuffers.mFrames;
+    auto* pArguments = frames[frameIndex % frames.size()].mArguments.get();
+    for (const auto& group : queue.mIndirectGroups) {
+        // pso still compiling
+        if (!group.mPipelineState) {
+            continue;
+        }
+        const auto& packet = queue.mDrawPackets[group.mPacketID];
+        pCommandList->IASetPrimitiveTopology(group.mPrimitiveTopology);
+        pCommandList->SetPipelineState(group.mPipelineState);
+
+        // persistent tables are shared by the group, instance SRV is set by each command
+        for (uint32_t bindingID = packet.mBindingBegin; bindingID != packet.mBindingBegin + packet.mBindingCount; ++bindingID) {
+            const auto& binding = queue.mDrawBindings[bindingID];
+            if (binding.mType == DescriptorTableBinding) {
+                pCommandList->SetGraphicsRootDescriptorTable(binding.mSlot, binding.mGpuOffset);
+            }
+        }
+        pCommandList->ExecuteIndirect(group.mCommandSignature.get(), group.mCommandCount,
+            pArguments, group.mArgumentOffset, nullptr, 0);
+    }
+}
+
+}
@@ -0,0 +1,59 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <Star/DX12Engine/SDX12Types.h>
+
+namespace Star::Graphics::Render {
+
+struct CreationContext;
+
+// compile the culling compute shader and its root signature
+DX12IndirectPipeline createDX12IndirectPipeline(ID3D12Device* pDevice);
+
+// build gpu resident objects and command templates from the draw packets of a queue
+// queue is left on the cpu path if any packet cannot be generated on gpu
+void buildDX12IndirectDraws(CreationContext& context,
+    ID3D12RootSignature* pRootSignature, DX12UnorderedRenderQueue& queue);
+
+// cull objects and write instance data and draw arguments of a frame slot
+// recorded before render passes, on the direct list or on a compute list
+void dispatchDX12IndirectDraws(ID3D12GraphicsCommandList* pCommandList,
+    const DX12IndirectPipeline& pipeline, const CameraData& cam,
+    const DX12UnorderedRenderQueue& queue, uint32_t frameIndex);
+
+// draw all groups of the queue, root signature and per pass descriptors are bound
+void executeDX12IndirectDraws(ID3D12GraphicsCommandList* pCommandList,
+    const DX12UnorderedRenderQueue& queue, uint32_t frameIndex);
+
+// create the dispatch command signature and compile the argument writer
+DX12IndirectDispatchPipeline createDX12IndirectDispatchPipeline(ID3D12Device* pDevice);
+
+// arguments of count dispatches, each D3D12_DISPATCH_ARGUMENTS sized
+void createDX12IndirectDispatch(ID3D12Device* pDevice, uint32_t count, DX12IndirectDispatch& dispatch);
+
+// write the arguments at argumentOffset from the thread count at countOffset of pCounts, in groups of groupSize
+// pCounts is written by earlier dispatches and is in UNORDERED_ACCESS state, compute root bindings are replaced
+void writeDX12DispatchArguments(ID3D12GraphicsCommandList* pCommandList,
+    const DX12IndirectDispatchPipeline& pipeline, ID3D12Resource* pCounts, uint32_t countOffset,
+    uint32_t groupSize, DX12IndirectDispatch& dispatch, uint32_t argumentOffset);
+
+// dispatch the bound compute pipeline with the arguments at offset
+void executeDX12IndirectDispatch(ID3D12GraphicsCommandList* pCommandList,
+    const DX12IndirectDispatchPipeline& pipeline, DX12IndirectDispatch& dispatch, uint32_t offset);
+
+}
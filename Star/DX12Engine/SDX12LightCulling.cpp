@@ -0,0 +1,252 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "SDX12LightCulling.h"
+#include "SDX12Utils.h"
+#include <Star/Core/SCounters.h>
+
+namespace Star::Graphics::Render {
+
+namespace {
+
+// one thread per cluster, a group is a depth slice, lights are moved to view space once per group
+// cluster bounds are view space boxes, projections are perspective
+const char sLightCullingShader[] = R"(
+#define LightCullingRS "RootConstants(num32BitConstants=36, b0), SRV(t0), UAV(u0), UAV(u1)"
+#define ClusterX 16
+#define ClusterY 9
+#define ClusterZ 24
+#define MaxLightsPerCluster 128
+
+cbuffer LightCulling : register(b0) {
+    float4x4 View;
+    float4x4 Proj;
+    uint4 Params;
+};
+
+StructuredBuffer<float4> gLights : register(t0);
+RWStructuredBuffer<uint2> gGrid : register(u0);
+RWStructuredBuffer<uint> gIndices : register(u1);
+
+groupshared float4 sLights[ClusterX * ClusterY];
+
+// view space z of a depth buffer value
+float getViewZ(float depth) {
+    return Proj._34 / (depth * Proj._43 - Proj._33);
+}
+
+float3 getViewPos(float2 ndc, float distance) {
+    float z = Proj._43 < 0 ? -distance : distance;
+    return float3(z * (ndc.x * Proj._43 - Proj._13) / Proj._11,
+        z * (ndc.y * Proj._43 - Proj._23) / Proj._22, z);
+}
+
+// Params: light count
+[RootSignature(LightCullingRS)]
+[numthreads(ClusterX, ClusterY, 1)]
+void cull(uint3 id : SV_DispatchThreadID, uint groupIndex : SV_GroupIndex) {
+    float z0 = abs(getViewZ(0));
+    float z1 = abs(getViewZ(1));
+    float zNear = min(z0, z1);
+    float zFar = max(z0, z1);
+    float d0 = zNear * pow(zFar / zNear, (float)id.z / ClusterZ);
+    float d1 = zNear * pow(zFar / zNear, (float)(id.z + 1) / ClusterZ);
+
+    // tiles are numbered from the top left of the screen
+    float2 ndc0 = float2(2.0f * id.x / ClusterX - 1.0f, 1.0f - 2.0f * (id.y + 1) / ClusterY);
+    float2 ndc1 = float2(2.0f * (id.x + 1) / ClusterX - 1.0f, 1.0f - 2.0f * id.y / ClusterY);
+    float3 lo = 1e30;
+    float3 hi = -1e30;
+    [unroll] for (uint i = 0; i != 8; ++i) {
+        float3 p = getViewPos(float2((i & 1) ? ndc1.x : ndc0.x, (i & 2) ? ndc1.y : ndc0.y),
+            (i & 4) ? d1 : d0);
+        lo = min(lo, p);
+        hi = max(hi, p);
+    }
+
+    uint cluster = (id.z * ClusterY + id.y) * ClusterX + id.x;
+    uint offset = cluster * MaxLightsPerCluster;
+    uint count = 0;
+    for (uint base = 0; base < Params.x; base += ClusterX * ClusterY) {
+        uint lightID = base + groupIndex;
+        if (lightID < Params.x) {
+            float4 light = gLights[2 * lightID];
+            sLights[groupIndex] = float4(mul(View, float4(light.xyz, 1.0f)).xyz, light.w);
+        }
+        GroupMemoryBarrierWithGroupSync();
+
+        uint batch = min(Params.x - base, ClusterX * ClusterY);
+        for (uint j = 0; j != batch; ++j) {
+            float4 light = sLights[j];
+            float3 d = clamp(light.xyz, lo, hi) - light.xyz;
+            if (dot(d, d) <= light.w * light.w && count < MaxLightsPerCluster) {
+                gIndices[offset + count] = base + j;
+                ++count;
+            }
+        }
+        GroupMemoryBarrierWithGroupSync();
+    }
+    gGrid[cluster] = uint2(offset, count);
+}
+)";
+
+struct LightCullingConstants {
+    float mView[16];
+    float mProj[16];
+    uint32_t mParams[4];
+};
+static_assert(sizeof(LightCullingConstants) == 36 * sizeof(uint32_t));
+static_assert(sizeof(PointLightData) == 2 * sizeof(Vector4f));
+
+void createStructuredBufferView(ID3D12Device* pDevice, ID3D12Resource* pResource,
+    uint32_t count, uint32_t stride, D3D12_CPU_DESCRIPTOR_HANDLE handle
+) {
+    D3D12_SHADER_RESOURCE_VIEW_DESC desc{};
+    desc.Format = DXGI_FORMAT_UNKNOWN;
+    desc.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
+    desc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+    desc.Buffer.NumElements = count;
+    desc.Buffer.StructureByteStride = stride;
+    pDevice->CreateShaderResourceView(pResource, &desc, handle);
+}
+
+}
+
+DX12LightCullingPipeline createDX12LightCullingPipeline(ID3D12Device* pDevice) {
+    com_ptr<ID3DBlob> shader;
+    com_ptr<ID3DBlob> errors;
+    HRESULT hr = D3DCompile(sLightCullingShader, sizeof(sLightCullingShader) - 1,
+        "LightCulling", nullptr, nullptr, "cull", "cs_5_1",
+        D3DCOMPILE_OPTIMIZATION_LEVEL3, 0, shader.put(), errors.put());
+    if (FAILED(hr)) {
+        throw std::runtime_error(errors ?
+            static_cast<const char*>(errors->GetBufferPointer()) :
+            "light culling shader compilation failed");
+    }
+
+    DX12LightCullingPipeline pipeline;
+    V(pDevice->CreateRootSignature(0, shader->GetBufferPointer(), shader->GetBufferSize(),
+        IID_PPV_ARGS(pipeline.mRootSignature.put())));
+
+    D3D12_COMPUTE_PIPELINE_STATE_DESC desc{};
+    desc.pRootSignature = pipeline.mRootSignature.get();
+    desc.CS = CD3DX12_SHADER_BYTECODE(shader.get());
+    V(pDevice->CreateComputePipelineState(&desc, IID_PPV_ARGS(pipeline.mPipelineState.put())));
+    return pipeline;
+}
+
+void buildDX12LightCulling(CreationContext& context, DX12GraphicsSubpass& subpass) {
+    auto& culling = subpass.mLights;
+    culling.mLights.clear();
+    culling.mLightData.clear();
+
+    // lights stay mapped, each slot is written when the slot is prepared
+    Expects(context.mFrameQueueSize);
+    culling.mLights.reserve(context.mFrameQueueSize);
+    culling.mLightData.reserve(context.mFrameQueueSize);
+    for (uint32_t i = 0; i != context.mFrameQueueSize; ++i) {
+        auto& lights = culling.mLights.emplace_back();
+        V(context.mDevice->CreateCommittedResource(
+            &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+            D3D12_HEAP_FLAG_NONE,
+            &CD3DX12_RESOURCE_DESC::Buffer(sizeof(PointLightData) * sMaxPointLights),
+            D3D12_RESOURCE_STATE_GENERIC_READ,
+            nullptr,
+            IID_PPV_ARGS(lights.put())));
+
+        void* pData = nullptr;
+        V(lights->Map(0, &CD3DX12_RANGE(0, 0), &pData));
+        culling.mLightData.emplace_back(static_cast<PointLightData*>(pData));
+    }
+
+    culling.mGrid = DX12::createUnorderedAccessBuffer(context.mDevice,
+        sizeof(uint32_t) * 2 * sLightClusterCount, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    culling.mIndices = DX12::createUnorderedAccessBuffer(context.mDevice,
+        sizeof(uint32_t) * sLightClusterCount * sMaxLightsPerCluster, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+}
+
+void dispatchDX12LightCulling(ID3D12GraphicsCommandList* pCommandList,
+    const DX12LightCullingPipeline& pipeline, const CameraData& cam,
+    gsl::span<const PointLightData> lights, const DX12LightCulling& culling, uint32_t frameIndex
+) {
+    Expects(frameIndex < culling.mLightData.size());
+    const auto lightCount = gsl::narrow_cast<uint32_t>(
+        std::min<size_t>(lights.size(), sMaxPointLights));
+    std::copy_n(lights.data(), lightCount, culling.mLightData[frameIndex]);
+
+    auto* pGrid = culling.mGrid.get();
+    auto* pIndices = culling.mIndices.get();
+    {
+        D3D12_RESOURCE_BARRIER barriers[] = {
+            CD3DX12_RESOURCE_BARRIER::Transition(pGrid,
+                D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS),
+            CD3DX12_RESOURCE_BARRIER::Transition(pIndices,
+                D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS),
+        };
+        pCommandList->ResourceBarrier(_countof(barriers), barriers);
+        Core::Counters::add(Core::Counter::Barriers, _countof(barriers));
+    }
+
+    LightCullingConstants constants{};
+    memcpy(constants.mView, cam.mView.data(), sizeof(constants.mView));
+    memcpy(constants.mProj, cam.mProj.data(), sizeof(constants.mProj));
+    constants.mParams[0] = lightCount;
+
+    pCommandList->SetComputeRootSignature(pipeline.mRootSignature.get());
+    pCommandList->SetPipelineState(pipeline.mPipelineState.get());
+    pCommandList->SetComputeRoot32BitConstants(0, sizeof(constants) / sizeof(uint32_t), &constants, 0);
+    pCommandList->SetComputeRootShaderResourceView(1, culling.mLights[frameIndex]->GetGPUVirtualAddress());
+    pCommandList->SetComputeRootUnorderedAccessView(2, pGrid->GetGPUVirtualAddress());
+    pCommandList->SetComputeRootUnorderedAccessView(3, pIndices->GetGPUVirtualAddress());
+    pCommandList->Dispatch(1, 1, sLightClusterZ);
+
+    {
+        D3D12_RESOURCE_BARRIER barriers[] = {
+            CD3DX12_RESOURCE_BARRIER::Transition(pGrid,
+                D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE),
+            CD3DX12_RESOURCE_BARRIER::Transition(pIndices,
+                D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE),
+        };
+        pCommandList->ResourceBarrier(_countof(barriers), barriers);
+        Core::Counters::add(Core::Counter::Barriers, _countof(barriers));
+    }
+}
+
+void createDX12PointLightsView(ID3D12Device* pDevice, const DX12LightCulling& culling,
+    uint32_t frameIndex, D3D12_CPU_DESCRIPTOR_HANDLE handle
+) {
+    Expects(frameIndex < culling.mLights.size());
+    createStructuredBufferView(pDevice, culling.mLights[frameIndex].get(),
+        2 * sMaxPointLights, sizeof(Vector4f), handle);
+}
+
+void createDX12LightGridView(ID3D12Device* pDevice, const DX12LightCulling& culling,
+    D3D12_CPU_DESCRIPTOR_HANDLE handle
+) {
+    createStructuredBufferView(pDevice, culling.mGrid.get(),
+        sLightClusterCount, 2 * sizeof(uint32_t), handle);
+}
+
+void createDX12LightIndicesView(ID3D12Device* pDevice, const DX12LightCulling& culling,
+    D3D12_CPU_DESCRIPTOR_HANDLE handle
+) {
+    createStructuredBufferView(pDevice, culling.mIndices.get(),
+        sLightClusterCount * sMaxLightsPerCluster, sizeof(uint32_t), handle);
+}
+
+}
@@ -0,0 +1,55 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+#include <Star/DX12Engine/SDX12Types.h>
+
+namespace Star::Graphics::Render {
+
+struct CreationContext;
+
+// view clusters, depth is sliced exponentially between the near and far planes
+// the cluster grid is repeated by the EvaluateClusteredLights shader module
+constexpr uint32_t sLightClusterX = 16;
+constexpr uint32_t sLightClusterY = 9;
+constexpr uint32_t sLightClusterZ = 24;
+constexpr uint32_t sLightClusterCount = sLightClusterX * sLightClusterY * sLightClusterZ;
+// lights beyond are not drawn
+constexpr uint32_t sMaxPointLights = 4096;
+constexpr uint32_t sMaxLightsPerCluster = 128;
+
+DX12LightCullingPipeline createDX12LightCullingPipeline(ID3D12Device* pDevice);
+
+// create light buffers of every frame slot and the cluster lists
+void buildDX12LightCulling(CreationContext& context, DX12GraphicsSubpass& subpass);
+
+// upload lights to the frame slot and bin them into clusters of the camera
+// grid and indices are pixel shader resources before and after
+void dispatchDX12LightCulling(ID3D12GraphicsCommandList* pCommandList,
+    const DX12LightCullingPipeline& pipeline, const CameraData& cam,
+    gsl::span<const PointLightData> lights, const DX12LightCulling& culling, uint32_t frameIndex);
+
+// structured buffer views read by the subpass shaders
+void createDX12PointLightsView(ID3D12Device* pDevice, const DX12LightCulling& culling,
+    uint32_t frameIndex, D3D12_CPU_DESCRIPTOR_HANDLE handle);
+void createDX12LightGridView(ID3D12Device* pDevice, const DX12LightCulling& culling,
+    D3D12_CPU_DESCRIPTOR_HANDLE handle);
+void createDX12LightIndicesView(ID3D12Device* pDevice, const DX12LightCulling& culling,
+    D3D12_CPU_DESCRIPTOR_HANDLE handle);
+
+}
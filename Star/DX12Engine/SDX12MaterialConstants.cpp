@@ -0,0 +1,81 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "SDX12MaterialConstants.h"
+#include "SDX12Utils.h"
+
+namespace Star::Graphics::Render {
+
+DX12MaterialConstantPool::DX12MaterialConstantPool(DX12HeapAllocator& allocator, uint32_t capacity)
+    : mAllocator(&allocator)
+    , mCapacity(std::max(capacity, 1u))
+{}
+
+uint32_t DX12MaterialConstantPool::allocate(CreationContext& context, const ConstantMap& constants) {
+    if (constants.mBuffer.empty())
+        return 0;
+
+    const auto size = constants.mBuffer.size();
+    const auto blockCount = gsl::narrow<uint32_t>(size / sBlockSize);
+
+    if (!mBuffer.mResource) {
+        // block 0 is cleared by the first upload
+        grow(context, std::max(mCapacity, blockCount + 1));
+        std::array<std::byte, sBlockSize> zeros{};
+        auto pos = context.upload(zeros.data(), zeros.size(), sBlockSize);
+        context.mCopyList->CopyBufferRegion(mBuffer.mResource.get(), 0,
+            pos.mResource, pos.mBufferOffset, sBlockSize);
+        mBlockCount = 1;
+    } else if (mBlockCount + blockCount > mCapacity) {
+        grow(context, std::max(mCapacity * 2, mBlockCount + blockCount));
+    }
+
+    const auto first = mBlockCount;
+    auto pos = context.upload(constants.mBuffer.data(), size, sBlockSize);
+    context.mCopyList->CopyBufferRegion(mBuffer.mResource.get(), uint64_t(first) * sBlockSize,
+        pos.mResource, pos.mBufferOffset, size);
+    mBlockCount += blockCount;
+    return first;
+}
+
+void DX12MaterialConstantPool::grow(CreationContext& context, uint32_t capacity) {
+    auto buffer = mAllocator->createBuffer(uint64_t(capacity) * sBlockSize, D3D12_RESOURCE_STATE_COMMON);
+    STAR_SET_DEBUG_NAME(buffer.mResource, "MaterialConstants " + std::to_string(mVersion + 1));
+
+    if (mBuffer.mResource) {
+        context.mCopyList->CopyBufferRegion(buffer.mResource.get(), 0,
+            mBuffer.mResource.get(), 0, uint64_t(mBlockCount) * sBlockSize);
+        // frames in flight may still read it
+        mRetired.emplace_back(std::move(mBuffer));
+    }
+    mBuffer = std::move(buffer);
+    mCapacity = capacity;
+    ++mVersion;
+}
+
+void DX12MaterialConstantPool::createView(ID3D12Device* pDevice, D3D12_CPU_DESCRIPTOR_HANDLE handle) const noexcept {
+    D3D12_SHADER_RESOURCE_VIEW_DESC desc{};
+    desc.Format = DXGI_FORMAT_UNKNOWN;
+    desc.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
+    desc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+    desc.Buffer.NumElements = std::max(mBlockCount, 1u);
+    desc.Buffer.StructureByteStride = sBlockSize;
+    pDevice->CreateShaderResourceView(mBuffer.mResource.get(), &desc, handle);
+}
+
+}
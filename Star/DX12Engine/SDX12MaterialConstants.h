@@ -0,0 +1,60 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+#include <Star/DX12Engine/SDX12Types.h>
+#include <Star/DX12Engine/SDX12HeapAllocator.h>
+
+namespace Star::Graphics::Render {
+
+struct CreationContext;
+
+// constants of all materials packed in 16 byte blocks, draws pass the first block of their material
+// block 0 is zero for materials without constants, blocks are appended and not reused
+// the buffer stays in common state, it is replaced by a larger copy when full, replaced buffers live until the pool is released
+class DX12MaterialConstantPool {
+public:
+    static const uint32_t sBlockSize = 16;
+    static const uint32_t sDefaultCapacity = 64 * 1024;
+
+    DX12MaterialConstantPool(DX12HeapAllocator& allocator, uint32_t capacity = sDefaultCapacity);
+    DX12MaterialConstantPool(const DX12MaterialConstantPool&) = delete;
+    DX12MaterialConstantPool& operator=(const DX12MaterialConstantPool&) = delete;
+
+    // copies constants into the pool on the copy list of context, returns the first block
+    uint32_t allocate(CreationContext& context, const ConstantMap& constants);
+
+    // structured buffer of float4, null descriptor if nothing is allocated yet
+    void createView(ID3D12Device* pDevice, D3D12_CPU_DESCRIPTOR_HANDLE handle) const noexcept;
+
+    ID3D12Resource* buffer() const noexcept { return mBuffer.mResource.get(); }
+    uint32_t blockCount() const noexcept { return mBlockCount; }
+    // incremented when the buffer is replaced
+    uint32_t version() const noexcept { return mVersion; }
+private:
+    void grow(CreationContext& context, uint32_t capacity);
+
+    gsl::not_null<DX12HeapAllocator*> mAllocator;
+    DX12PlacedResource mBuffer;
+    std::vector<DX12PlacedResource> mRetired;
+    uint32_t mCapacity = 0;
+    uint32_t mBlockCount = 0;
+    uint32_t mVersion = 0;
+};
+
+}
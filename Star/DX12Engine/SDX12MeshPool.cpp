@@ -0,0 +1,108 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "SDX12MeshPool.h"
+
+namespace Star::Graphics::Render {
+
+DX12MeshPool::DX12MeshPool(DX12HeapAllocator& allocator,
+    uint32_t vertexCapacity, uint32_t indexCapacity)
+    : mAllocator(&allocator)
+    , mVertexCapacity(vertexCapacity)
+    , mIndexCapacity(indexCapacity)
+{}
+
+bool DX12MeshPool::allocate(DX12MeshData& mesh, const MeshData& meshData) {
+    if (meshData.mIndexBuffer.mBuffer.empty() || meshData.mVertexBuffers.empty())
+        return false;
+
+    const auto elementSize = meshData.mIndexBuffer.mElementSize;
+    const auto format = elementSize == 2 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+    const auto indexCount = gsl::narrow_cast<uint32_t>(meshData.mIndexBuffer.mBuffer.size() / elementSize);
+
+    // every stream holds the same vertex count
+    const auto vertexCount = meshData.mVertexBuffers.front().mVertexCount;
+    for (const auto& stream : meshData.mVertexBuffers) {
+        Expects(stream.mVertexCount == vertexCount);
+        Expects(stream.mBuffer.size() == uint64_t(vertexCount) * stream.mDesc.mVertexSize);
+    }
+
+    auto& pages = mPages[{ mesh.mLayoutID, format }];
+    DX12MeshPage* pPage = nullptr;
+    for (auto& page : pages) {
+        if (page->mVertexCount + vertexCount <= page->mVertexCapacity &&
+            page->mIndexCount + indexCount <= page->mIndexCapacity) {
+            pPage = page.get();
+            break;
+        }
+    }
+
+    if (!pPage) {
+        auto& page = *pages.emplace_back(std::make_unique<DX12MeshPage>());
+        page.mVertexCapacity = std::max(mVertexCapacity, vertexCount);
+        page.mIndexCapacity = std::max(mIndexCapacity, indexCount);
+
+        page.mVertexBuffers.reserve(meshData.mVertexBuffers.size());
+        page.mVertexBufferViews.reserve(meshData.mVertexBuffers.size());
+        for (const auto& stream : meshData.mVertexBuffers) {
+            const auto size = uint64_t(page.mVertexCapacity) * stream.mDesc.mVertexSize;
+            auto& buffer = page.mVertexBuffers.emplace_back(
+                mAllocator->createBuffer(size, D3D12_RESOURCE_STATE_COMMON));
+            STAR_SET_DEBUG_NAME(buffer.mResource, "MeshPool vertex buffer " + std::to_string(mesh.mLayoutID));
+
+            auto& vbv = page.mVertexBufferViews.emplace_back();
+            vbv.BufferLocation = buffer.mResource->GetGPUVirtualAddress();
+            vbv.SizeInBytes = gsl::narrow_cast<uint32_t>(size);
+            vbv.StrideInBytes = stream.mDesc.mVertexSize;
+        }
+
+        const auto indexSize = uint64_t(page.mIndexCapacity) * elementSize;
+        page.mIndexBuffer = mAllocator->createBuffer(indexSize, D3D12_RESOURCE_STATE_COMMON);
+        STAR_SET_DEBUG_NAME(page.mIndexBuffer.mResource, "MeshPool index buffer " + std::to_string(mesh.mLayoutID));
+        page.mIndexBufferView.BufferLocation = page.mIndexBuffer.mResource->GetGPUVirtualAddress();
+        page.mIndexBufferView.SizeInBytes = gsl::narrow_cast<uint32_t>(indexSize);
+        page.mIndexBufferView.Format = format;
+
+        pPage = &page;
+    }
+
+    // meshes of a layout share their stream strides
+    Expects(pPage->mVertexBufferViews.size() == meshData.mVertexBuffers.size());
+    for (size_t i = 0; i != meshData.mVertexBuffers.size(); ++i) {
+        Expects(pPage->mVertexBufferViews[i].StrideInBytes == meshData.mVertexBuffers[i].mDesc.mVertexSize);
+    }
+
+    mesh.mPage = pPage;
+    mesh.mBaseVertex = pPage->mVertexCount;
+    mesh.mBaseIndex = pPage->mIndexCount;
+    mesh.mVertexBufferViews.assign(pPage->mVertexBufferViews.begin(), pPage->mVertexBufferViews.end());
+    mesh.mIndexBufferView = pPage->mIndexBufferView;
+
+    pPage->mVertexCount += vertexCount;
+    pPage->mIndexCount += indexCount;
+    return true;
+}
+
+size_t DX12MeshPool::pageCount() const noexcept {
+    size_t count = 0;
+    for (const auto& pages : mPages) {
+        count += pages.second.size();
+    }
+    return count;
+}
+
+}
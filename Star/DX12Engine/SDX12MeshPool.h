@@ -0,0 +1,62 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <Star/DX12Engine/SDX12Types.h>
+#include <Star/DX12Engine/SDX12HeapAllocator.h>
+
+namespace Star::Graphics::Render {
+
+// vertex streams and index buffer shared by meshes of one vertex layout and index format
+// buffers stay in common state, they are promoted by each use and copied into while drawn
+struct DX12MeshPage {
+    std::vector<DX12PlacedResource> mVertexBuffers;
+    std::vector<D3D12_VERTEX_BUFFER_VIEW> mVertexBufferViews;
+    DX12PlacedResource mIndexBuffer;
+    D3D12_INDEX_BUFFER_VIEW mIndexBufferView = {};
+    uint32_t mVertexCapacity = 0;
+    uint32_t mIndexCapacity = 0;
+    uint32_t mVertexCount = 0;
+    uint32_t mIndexCount = 0;
+};
+
+// packs indexed meshes into pages, submeshes are drawn by base vertex and start index
+// ranges are appended and not reused, pages are released with the pool
+class DX12MeshPool {
+public:
+    static const uint32_t sDefaultVertexCapacity = 1024 * 1024;
+    static const uint32_t sDefaultIndexCapacity = 4 * 1024 * 1024;
+
+    DX12MeshPool(DX12HeapAllocator& allocator,
+        uint32_t vertexCapacity = sDefaultVertexCapacity,
+        uint32_t indexCapacity = sDefaultIndexCapacity);
+    DX12MeshPool(const DX12MeshPool&) = delete;
+    DX12MeshPool& operator=(const DX12MeshPool&) = delete;
+
+    // place mesh in a page, mesh views are set to the page buffers
+    // returns false if the mesh cannot be pooled
+    bool allocate(DX12MeshData& mesh, const MeshData& meshData);
+
+    size_t pageCount() const noexcept;
+private:
+    gsl::not_null<DX12HeapAllocator*> mAllocator;
+    uint32_t mVertexCapacity = 0;
+    uint32_t mIndexCapacity = 0;
+    std::map<std::pair<uint32_t, DXGI_FORMAT>, std::vector<std::unique_ptr<DX12MeshPage>>> mPages;
+};
+
+}
@@ -0,0 +1,499 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "SDX12OcclusionCulling.h"
+#include "SDX12Utils.h"
+#include "SDX12ShaderDescriptorHeap.h"
+
+namespace Star::Graphics::Render {
+
+namespace {
+
+// downsample keeps the farthest depth of each 2x2 footprint
+// test compares the nearest depth of projected bounds with the pyramid texels covering them
+const char sOcclusionShader[] = R"(
+#define OcclusionRS "RootConstants(num32BitConstants=24, b0), DescriptorTable(SRV(t0)), DescriptorTable(UAV(u0)), SRV(t1), UAV(u1), SRV(t2), UAV(u2)"
+
+cbuffer Occlusion : register(b0) {
+    float4 ViewProj[4];
+    uint4 Params;
+    uint4 Slot;
+};
+
+Texture2D<float> gSource : register(t0);
+RWTexture2D<float> gTarget : register(u0);
+StructuredBuffer<float4> gBounds : register(t1);
+RWByteAddressBuffer gVisibility : register(u1);
+StructuredBuffer<uint> gPackets : register(t2);
+RWByteAddressBuffer gPredicates : register(u2);
+
+// Params: target size, source size
+[RootSignature(OcclusionRS)]
+[numthreads(8, 8, 1)]
+void downsample(uint3 id : SV_DispatchThreadID) {
+    if (any(id.xy >= Params.xy))
+        return;
+
+    uint2 last = Params.zw - 1;
+    uint2 src = id.xy * 2;
+    float d = gSource.Load(int3(min(src, last), 0));
+    d = max(d, gSource.Load(int3(min(src + uint2(1, 0), last), 0)));
+    d = max(d, gSource.Load(int3(min(src + uint2(0, 1), last), 0)));
+    d = max(d, gSource.Load(int3(min(src + uint2(1, 1), last), 0)));
+    gTarget[id.xy] = d;
+}
+
+// Params: instance count, depth stencil size, pyramid mip levels
+// Slot: visibility offset of the frame slot, two phase culling
+[RootSignature(OcclusionRS)]
+[numthreads(64, 1, 1)]
+void test(uint3 id : SV_DispatchThreadID) {
+    if (id.x >= Params.x)
+        return;
+
+    float3 center = gBounds[2 * id.x].xyz;
+    float3 extent = gBounds[2 * id.x + 1].xyz;
+    float3 lo = 1e30;
+    float3 hi = -1e30;
+    bool visible = false;
+
+    [unroll] for (uint i = 0; i != 8; ++i) {
+        float3 corner = center + extent * float3(
+            (i & 1) ? 1 : -1, (i & 2) ? 1 : -1, (i & 4) ? 1 : -1);
+        float4 clip = ViewProj[0] * corner.x + ViewProj[1] * corner.y
+            + ViewProj[2] * corner.z + ViewProj[3];
+        if (clip.w <= 0) {
+            visible = true;
+        } else {
+            float3 ndc = clip.xyz / clip.w;
+            lo = min(lo, ndc);
+            hi = max(hi, ndc);
+        }
+    }
+
+    if (!visible) {
+        uint2 size = Params.yz;
+        float2 uvMin = saturate(float2(lo.x, -hi.y) * 0.5 + 0.5);
+        float2 uvMax = saturate(float2(hi.x, -lo.y) * 0.5 + 0.5);
+        uint2 p0 = min(uint2(uvMin * size), size - 1) >> 1;
+        uint2 p1 = min(uint2(uvMax * size), size - 1) >> 1;
+
+        uint mip = 0;
+        while (mip + 1 < Params.w && any((p1 >> mip) - (p0 >> mip) > 1)) {
+            ++mip;
+        }
+        p0 >>= mip;
+        p1 >>= mip;
+
+        float depth = max(
+            max(gSource.Load(int3(p0, mip)), gSource.Load(int3(p1.x, p0.y, mip))),
+            max(gSource.Load(int3(p0.x, p1.y, mip)), gSource.Load(int3(p1, mip))));
+        visible = lo.z <= depth;
+    }
+
+    uint slot = Slot.x + id.x;
+    if (Slot.y && visible && !gVisibility.Load(4 * slot)) {
+        gPredicates.InterlockedOr(8 * gPackets[id.x], 1);
+    }
+    gVisibility.Store(4 * slot, visible ? 1 : 0);
+}
+)";
+
+struct OcclusionConstants {
+    float mViewProj[16];
+    uint32_t mParams[4];
+    uint32_t mSlot[4];
+};
+static_assert(sizeof(OcclusionConstants) == 24 * sizeof(uint32_t));
+
+com_ptr<ID3DBlob> compileOcclusionShader(const char* entry) {
+    com_ptr<ID3DBlob> shader;
+    com_ptr<ID3DBlob> errors;
+    HRESULT hr = D3DCompile(sOcclusionShader, sizeof(sOcclusionShader) - 1,
+        "OcclusionCulling", nullptr, nullptr, entry, "cs_5_1",
+        D3DCOMPILE_OPTIMIZATION_LEVEL3, 0, shader.put(), errors.put());
+    if (FAILED(hr)) {
+        throw std::runtime_error(errors ?
+            static_cast<const char*>(errors->GetBufferPointer()) :
+            "occlusion culling shader compilation failed");
+    }
+    return shader;
+}
+
+com_ptr<ID3D12PipelineState> createComputePipeline(ID3D12Device* pDevice,
+    ID3D12RootSignature* pRootSignature, ID3DBlob* pShader
+) {
+    D3D12_COMPUTE_PIPELINE_STATE_DESC desc{};
+    desc.pRootSignature = pRootSignature;
+    desc.CS = CD3DX12_SHADER_BYTECODE(pShader);
+
+    com_ptr<ID3D12PipelineState> pso;
+    V(pDevice->CreateComputePipelineState(&desc, IID_PPV_ARGS(pso.put())));
+    return pso;
+}
+
+uint32_t getPyramidSize(uint32_t depthSize, uint32_t mip) noexcept {
+    return std::max(1u, ((depthSize - 1) >> (mip + 1)) + 1);
+}
+
+}
+
+DX12OcclusionPipeline createDX12OcclusionPipeline(ID3D12Device* pDevice) {
+    auto downsample = compileOcclusionShader("downsample");
+    auto test = compileOcclusionShader("test");
+
+    DX12OcclusionPipeline pipeline;
+    V(pDevice->CreateRootSignature(0, downsample->GetBufferPointer(), downsample->GetBufferSize(),
+        IID_PPV_ARGS(pipeline.mRootSignature.put())));
+    pipeline.mDownsample = createComputePipeline(pDevice, pipeline.mRootSignature.get(), downsample.get());
+    pipeline.mTest = createComputePipeline(pDevice, pipeline.mRootSignature.get(), test.get());
+    return pipeline;
+}
+
+DXGI_FORMAT getDX12DepthTypelessFormat(DXGI_FORMAT format) noexcept {
+    switch (format) {
+    case DXGI_FORMAT_D32_FLOAT_S8X24_UINT:
+        return DXGI_FORMAT_R32G8X24_TYPELESS;
+    case DXGI_FORMAT_D32_FLOAT:
+        return DXGI_FORMAT_R32_TYPELESS;
+    case DXGI_FORMAT_D24_UNORM_S8_UINT:
+        return DXGI_FORMAT_R24G8_TYPELESS;
+    case DXGI_FORMAT_D16_UNORM:
+        return DXGI_FORMAT_R16_TYPELESS;
+    default:
+        return format;
+    }
+}
+
+DXGI_FORMAT getDX12DepthShaderResourceFormat(DXGI_FORMAT format) noexcept {
+    switch (format) {
+    case DXGI_FORMAT_R32G8X24_TYPELESS:
+    case DXGI_FORMAT_D32_FLOAT_S8X24_UINT:
+        return DXGI_FORMAT_R32_FLOAT_X8X24_TYPELESS;
+    case DXGI_FORMAT_R32_TYPELESS:
+    case DXGI_FORMAT_D32_FLOAT:
+        return DXGI_FORMAT_R32_FLOAT;
+    case DXGI_FORMAT_R24G8_TYPELESS:
+    case DXGI_FORMAT_D24_UNORM_S8_UINT:
+        return DXGI_FORMAT_R24_UNORM_X8_TYPELESS;
+    case DXGI_FORMAT_R16_TYPELESS:
+    case DXGI_FORMAT_D16_UNORM:
+        return DXGI_FORMAT_R16_UNORM;
+    default:
+        return format;
+    }
+}
+
+void buildDX12OcclusionCulling(CreationContext& context, DX12GraphicsSubpass& subpass) {
+    auto& occlusion = subpass.mOcclusion;
+    occlusion.mBounds = nullptr;
+    occlusion.mVisibility = nullptr;
+    occlusion.mPackets = nullptr;
+    occlusion.mPredicates = nullptr;
+    occlusion.mClearedPredicates = nullptr;
+    occlusion.mReadbacks.clear();
+    occlusion.mReadbackData.clear();
+
+    // instance slots follow queue order, draw instances of each queue are contiguous
+    uint32_t count = 0;
+    for (const auto& queue : subpass.mOrderedRenderQueue) {
+        count += gsl::narrow_cast<uint32_t>(queue.mDrawInstances.size());
+    }
+    occlusion.mInstanceCount = count;
+    occlusion.mPacketCount = 0;
+    if (!count)
+        return;
+
+    std::vector<Vector4f, Eigen::aligned_allocator<Vector4f>> bounds(2 * size_t(count));
+    for (size_t i = 0; i != count; ++i) {
+        bounds[2 * i] = Vector4f::Zero();
+        bounds[2 * i + 1] = Vector4f::Constant(1e18f);
+    }
+    // packets are numbered in subpass draw order, like the draws of a frame
+    std::vector<uint32_t> packets(count, 0);
+    uint32_t queueOffset = 0;
+    uint32_t packetID = 0;
+    for (const auto& queue : subpass.mOrderedRenderQueue) {
+        for (const auto& packet : queue.mDrawPackets) {
+            const auto currentPacket = packetID++;
+            if (!packet.mBatch)
+                continue;
+            const auto& batch = *packet.mBatch;
+            const auto stride = batch.mWorldBoundsStride;
+            const float* pData = batch.mWorldBoundsSoA.data();
+            for (uint32_t instanceID = 0; instanceID != packet.mInstanceCount; ++instanceID) {
+                const auto slot = queueOffset + packet.mInstanceBegin + instanceID;
+                const auto objectID = queue.mDrawInstances[packet.mInstanceBegin + instanceID];
+                for (uint32_t axis = 0; axis != 3; ++axis) {
+                    bounds[2 * slot][axis] = pData[axis * stride + objectID];
+                    bounds[2 * slot + 1][axis] = pData[(axis + 3) * stride + objectID];
+                }
+                packets[slot] = currentPacket;
+            }
+        }
+        queueOffset += gsl::narrow_cast<uint32_t>(queue.mDrawInstances.size());
+    }
+    occlusion.mPacketCount = packetID;
+
+    const auto boundsSize = sizeof(Vector4f) * bounds.size();
+    occlusion.mBounds = DX12::createBuffer(context.mDevice, boundsSize);
+    auto pos = context.upload(bounds.data(), boundsSize, 16);
+    context.mCopyList->CopyBufferRegion(occlusion.mBounds.get(), 0, pos.mResource, pos.mBufferOffset, boundsSize);
+    {
+        D3D12_RESOURCE_BARRIER barriers[] = {
+            CD3DX12_RESOURCE_BARRIER::Transition(occlusion.mBounds.get(),
+                CreationContext::sUploadedState, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE),
+        };
+        context.mCommandList->ResourceBarrier(_countof(barriers), barriers);
+    }
+
+    const auto packetsSize = sizeof(uint32_t) * packets.size();
+    occlusion.mPackets = DX12::createBuffer(context.mDevice, packetsSize);
+    pos = context.upload(packets.data(), packetsSize, 16);
+    context.mCopyList->CopyBufferRegion(occlusion.mPackets.get(), 0, pos.mResource, pos.mBufferOffset, packetsSize);
+
+    // predicates are 64 bit, cleared by copy before every test
+    const auto predicatesSize = sizeof(uint64_t) * occlusion.mPacketCount;
+    std::vector<uint64_t> cleared(occlusion.mPacketCount, 0);
+    occlusion.mClearedPredicates = DX12::createBuffer(context.mDevice, predicatesSize);
+    pos = context.upload(cleared.data(), predicatesSize, 16);
+    context.mCopyList->CopyBufferRegion(occlusion.mClearedPredicates.get(), 0,
+        pos.mResource, pos.mBufferOffset, predicatesSize);
+    occlusion.mPredicates = DX12::createUnorderedAccessBuffer(context.mDevice,
+        predicatesSize, D3D12_RESOURCE_STATE_PREDICATION);
+    {
+        D3D12_RESOURCE_BARRIER barriers[] = {
+            CD3DX12_RESOURCE_BARRIER::Transition(occlusion.mPackets.get(),
+                CreationContext::sUploadedState, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE),
+            CD3DX12_RESOURCE_BARRIER::Transition(occlusion.mClearedPredicates.get(),
+                CreationContext::sUploadedState, D3D12_RESOURCE_STATE_COPY_SOURCE),
+        };
+        context.mCommandList->ResourceBarrier(_countof(barriers), barriers);
+    }
+
+    // readbacks stay mapped, everything is visible until a test completes
+    // a section of visibility per frame slot, all visible like the readbacks
+    Expects(context.mFrameQueueSize);
+    const auto visibilitySize = sizeof(uint32_t) * count;
+    {
+        const auto sectionsSize = visibilitySize * context.mFrameQueueSize;
+        std::vector<uint32_t> visible(size_t(count) * context.mFrameQueueSize, 1u);
+        occlusion.mVisibility = DX12::createUnorderedAccessBuffer(context.mDevice,
+            sectionsSize, CreationContext::sUploadedState);
+        pos = context.upload(visible.data(), sectionsSize, 16);
+        context.mCopyList->CopyBufferRegion(occlusion.mVisibility.get(), 0, pos.mResource, pos.mBufferOffset, sectionsSize);
+        D3D12_RESOURCE_BARRIER barriers[] = {
+            CD3DX12_RESOURCE_BARRIER::Transition(occlusion.mVisibility.get(),
+                CreationContext::sUploadedState, D3D12_RESOURCE_STATE_UNORDERED_ACCESS),
+        };
+        context.mCommandList->ResourceBarrier(_countof(barriers), barriers);
+    }
+    occlusion.mReadbacks.reserve(context.mFrameQueueSize);
+    occlusion.mReadbackData.reserve(context.mFrameQueueSize);
+    for (uint32_t i = 0; i != context.mFrameQueueSize; ++i) {
+        auto& readback = occlusion.mReadbacks.emplace_back();
+        V(context.mDevice->CreateCommittedResource(
+            &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_READBACK),
+            D3D12_HEAP_FLAG_NONE,
+            &CD3DX12_RESOURCE_DESC::Buffer(visibilitySize),
+            D3D12_RESOURCE_STATE_COPY_DEST,
+            nullptr,
+            IID_PPV_ARGS(readback.put())));
+
+        void* pData = nullptr;
+        V(readback->Map(0, nullptr, &pData));
+        std::fill_n(static_cast<uint32_t*>(pData), count, 1u);
+        occlusion.mReadbackData.emplace_back(static_cast<const uint32_t*>(pData));
+    }
+}
+
+void createDX12OcclusionPyramid(ID3D12Device* pDevice,
+    ID3D12Resource* pDepthStencil, DX12OcclusionCulling& occlusion
+) {
+    const auto depthDesc = pDepthStencil->GetDesc();
+    occlusion.mWidth = gsl::narrow_cast<uint32_t>(depthDesc.Width);
+    occlusion.mHeight = depthDesc.Height;
+
+    uint32_t mipLevels = 1;
+    while (getPyramidSize(occlusion.mWidth, mipLevels - 1) > 1 ||
+        getPyramidSize(occlusion.mHeight, mipLevels - 1) > 1) {
+        ++mipLevels;
+    }
+    occlusion.mMipLevels = mipLevels;
+
+    auto desc = CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_R32_FLOAT,
+        getPyramidSize(occlusion.mWidth, 0), getPyramidSize(occlusion.mHeight, 0),
+        1, gsl::narrow_cast<uint16_t>(mipLevels), 1, 0,
+        D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
+
+    occlusion.mPyramid = nullptr;
+    V(pDevice->CreateCommittedResource(
+        &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
+        D3D12_HEAP_FLAG_NONE, &desc,
+        D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr,
+        IID_PPV_ARGS(occlusion.mPyramid.put())));
+}
+
+void dispatchDX12OcclusionCulling(ID3D12Device* pDevice, ID3D12GraphicsCommandList* pCommandList,
+    DX12ShaderDescriptorHeap& shaderHeap, const DX12OcclusionPipeline& pipeline,
+    const CameraData& cam, ID3D12Resource* pDepthStencil,
+    const DX12OcclusionCulling& occlusion, uint32_t frameIndex, float resolutionScale, bool twoPhase
+) {
+    if (!occlusion.mPyramid || !occlusion.mInstanceCount)
+        return;
+    Expects(frameIndex < occlusion.mReadbacks.size());
+
+    auto* pPyramid = occlusion.mPyramid.get();
+    const auto mipLevels = occlusion.mMipLevels;
+
+    // views: depth, pyramid mips as srv, pyramid mips as uav, whole pyramid
+    auto descs = shaderHeap.allocateCircular(2 * mipLevels + 2);
+    {
+        D3D12_SHADER_RESOURCE_VIEW_DESC desc{};
+        desc.Format = getDX12DepthShaderResourceFormat(pDepthStencil->GetDesc().Format);
+        desc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+        desc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+        desc.Texture2D.MipLevels = 1;
+        pDevice->CreateShaderResourceView(pDepthStencil, &desc, descs[0].mCpuHandle);
+    }
+    for (uint32_t mip = 0; mip != mipLevels; ++mip) {
+        D3D12_SHADER_RESOURCE_VIEW_DESC srv{};
+        srv.Format = DXGI_FORMAT_R32_FLOAT;
+        srv.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+        srv.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+        srv.Texture2D.MostDetailedMip = mip;
+        srv.Texture2D.MipLevels = 1;
+        pDevice->CreateShaderResourceView(pPyramid, &srv, descs[1 + mip].mCpuHandle);
+
+        D3D12_UNORDERED_ACCESS_VIEW_DESC uav{};
+        uav.Format = DXGI_FORMAT_R32_FLOAT;
+        uav.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE2D;
+        uav.Texture2D.MipSlice = mip;
+        pDevice->CreateUnorderedAccessView(pPyramid, nullptr, &uav, descs[1 + mipLevels + mip].mCpuHandle);
+    }
+    {
+        D3D12_SHADER_RESOURCE_VIEW_DESC desc{};
+        desc.Format = DXGI_FORMAT_R32_FLOAT;
+        desc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+        desc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+        desc.Texture2D.MipLevels = mipLevels;
+        pDevice->CreateShaderResourceView(pPyramid, &desc, descs[1 + 2 * mipLevels].mCpuHandle);
+    }
+
+    auto* pPredicates = occlusion.mPredicates.get();
+    twoPhase = twoPhase && occlusion.mPacketCount;
+    if (twoPhase) {
+        D3D12_RESOURCE_BARRIER barriers[] = {
+            CD3DX12_RESOURCE_BARRIER::Transition(pPredicates,
+                D3D12_RESOURCE_STATE_PREDICATION, D3D12_RESOURCE_STATE_COPY_DEST),
+        };
+        pCommandList->ResourceBarrier(_countof(barriers), barriers);
+        pCommandList->CopyBufferRegion(pPredicates, 0, occlusion.mClearedPredicates.get(), 0,
+            sizeof(uint64_t) * occlusion.mPacketCount);
+    }
+    {
+        D3D12_RESOURCE_BARRIER barriers[] = {
+            CD3DX12_RESOURCE_BARRIER::Transition(pDepthStencil,
+                D3D12_RESOURCE_STATE_DEPTH_WRITE, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE),
+            CD3DX12_RESOURCE_BARRIER::Transition(pPredicates,
+                D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_UNORDERED_ACCESS),
+        };
+        pCommandList->ResourceBarrier(twoPhase ? 2 : 1, barriers);
+    }
+
+    OcclusionConstants constants{};
+    {
+        const Matrix4f viewProj = cam.mProj * cam.mView;
+        memcpy(constants.mViewProj, viewProj.data(), sizeof(constants.mViewProj));
+    }
+
+    pCommandList->SetComputeRootSignature(pipeline.mRootSignature.get());
+    pCommandList->SetComputeRootShaderResourceView(3, occlusion.mBounds->GetGPUVirtualAddress());
+    pCommandList->SetComputeRootUnorderedAccessView(4, occlusion.mVisibility->GetGPUVirtualAddress());
+    pCommandList->SetComputeRootShaderResourceView(5, occlusion.mPackets->GetGPUVirtualAddress());
+    pCommandList->SetComputeRootUnorderedAccessView(6, pPredicates->GetGPUVirtualAddress());
+
+    // downsample depth into each mip, previous mip becomes readable after it is written
+    pCommandList->SetPipelineState(pipeline.mDownsample.get());
+    uint32_t srcWidth = occlusion.mWidth;
+    uint32_t srcHeight = occlusion.mHeight;
+    for (uint32_t mip = 0; mip != mipLevels; ++mip) {
+        const auto dstWidth = getPyramidSize(occlusion.mWidth, mip);
+        const auto dstHeight = getPyramidSize(occlusion.mHeight, mip);
+        constants.mParams[0] = dstWidth;
+        constants.mParams[1] = dstHeight;
+        constants.mParams[2] = srcWidth;
+        constants.mParams[3] = srcHeight;
+        pCommandList->SetComputeRoot32BitConstants(0, sizeof(constants) / sizeof(uint32_t), &constants, 0);
+        pCommandList->SetComputeRootDescriptorTable(1, descs[mip].mGpuHandle);
+        pCommandList->SetComputeRootDescriptorTable(2, descs[1 + mipLevels + mip].mGpuHandle);
+        pCommandList->Dispatch((dstWidth + 7) / 8, (dstHeight + 7) / 8, 1);
+
+        D3D12_RESOURCE_BARRIER barriers[] = {
+            CD3DX12_RESOURCE_BARRIER::Transition(pPyramid,
+                D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, mip),
+        };
+        pCommandList->ResourceBarrier(_countof(barriers), barriers);
+        srcWidth = dstWidth;
+        srcHeight = dstHeight;
+    }
+    {
+        D3D12_RESOURCE_BARRIER barriers[] = {
+            CD3DX12_RESOURCE_BARRIER::Transition(pDepthStencil,
+                D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_DEPTH_WRITE),
+        };
+        pCommandList->ResourceBarrier(_countof(barriers), barriers);
+    }
+
+    // test instances against the pyramid
+    pCommandList->SetPipelineState(pipeline.mTest.get());
+    // bounds are tested against the rendered part of the pyramid
+    constants.mParams[0] = occlusion.mInstanceCount;
+    constants.mParams[1] = std::max(1u, uint32_t(occlusion.mWidth * resolutionScale));
+    constants.mParams[2] = std::max(1u, uint32_t(occlusion.mHeight * resolutionScale));
+    constants.mParams[3] = mipLevels;
+    constants.mSlot[0] = frameIndex * occlusion.mInstanceCount;
+    constants.mSlot[1] = twoPhase ? 1 : 0;
+    pCommandList->SetComputeRoot32BitConstants(0, sizeof(constants) / sizeof(uint32_t), &constants, 0);
+    pCommandList->SetComputeRootDescriptorTable(1, descs[1 + 2 * mipLevels].mGpuHandle);
+    pCommandList->SetComputeRootDescriptorTable(2, descs[1 + mipLevels].mGpuHandle);
+    pCommandList->Dispatch((occlusion.mInstanceCount + 63) / 64, 1, 1);
+
+    auto* pVisibility = occlusion.mVisibility.get();
+    {
+        D3D12_RESOURCE_BARRIER barriers[] = {
+            CD3DX12_RESOURCE_BARRIER::Transition(pPyramid,
+                D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS),
+            CD3DX12_RESOURCE_BARRIER::Transition(pVisibility,
+                D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_COPY_SOURCE),
+            CD3DX12_RESOURCE_BARRIER::Transition(pPredicates,
+                D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_PREDICATION),
+        };
+        pCommandList->ResourceBarrier(twoPhase ? 3 : 2, barriers);
+    }
+    pCommandList->CopyBufferRegion(occlusion.mReadbacks[frameIndex].get(), 0,
+        pVisibility, sizeof(uint32_t) * constants.mSlot[0], sizeof(uint32_t) * occlusion.mInstanceCount);
+    {
+        D3D12_RESOURCE_BARRIER barriers[] = {
+            CD3DX12_RESOURCE_BARRIER::Transition(pVisibility,
+                D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS),
+        };
+        pCommandList->ResourceBarrier(_countof(barriers), barriers);
+    }
+}
+
+}
@@ -0,0 +1,49 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <Star/DX12Engine/SDX12Types.h>
+
+namespace Star::Graphics::Render {
+
+struct CreationContext;
+class DX12ShaderDescriptorHeap;
+
+// compile the pyramid downsample and bounds test shaders
+DX12OcclusionPipeline createDX12OcclusionPipeline(ID3D12Device* pDevice);
+
+// depth stencils are created typeless so the pyramid builder can view depth
+DXGI_FORMAT getDX12DepthTypelessFormat(DXGI_FORMAT format) noexcept;
+DXGI_FORMAT getDX12DepthShaderResourceFormat(DXGI_FORMAT format) noexcept;
+
+// upload world bounds of queue instances and create visibility buffers
+void buildDX12OcclusionCulling(CreationContext& context, DX12GraphicsSubpass& subpass);
+
+// create the max depth pyramid, sized to half of the depth stencil
+void createDX12OcclusionPyramid(ID3D12Device* pDevice,
+    ID3D12Resource* pDepthStencil, DX12OcclusionCulling& occlusion);
+
+// build the pyramid from the subpass depth and test instances against it
+// depth stencil is in DEPTH_WRITE state before and after, its top left is rendered at the resolution scale
+// with two phases, predicates of packets whose culled instances are now visible are set for the second phase
+void dispatchDX12OcclusionCulling(ID3D12Device* pDevice, ID3D12GraphicsCommandList* pCommandList,
+    DX12ShaderDescriptorHeap& shaderHeap, const DX12OcclusionPipeline& pipeline,
+    const CameraData& cam, ID3D12Resource* pDepthStencil,
+    const DX12OcclusionCulling& occlusion, uint32_t frameIndex, float resolutionScale = 1,
+    bool twoPhase = false);
+
+}
@@ -0,0 +1,213 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "SDX12PersistentConstants.h"
+#include "SDX12Utils.h"
+#include "SDX12Transforms.h"
+#include "SDX12UploadBuffer.h"
+
+namespace Star::Graphics::Render {
+
+namespace {
+
+// records copied at once, keeps uploads far below the upload block size
+constexpr uint32_t sMaxRecordsPerCopy = 1024;
+
+constexpr D3D12_RESOURCE_STATES sPersistentState =
+    D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+
+}
+
+void writeDX12DrawDescriptor(const DX12UnorderedRenderQueue& queue, const DX12DrawPacket& packet,
+    const DX12DrawDescriptor& desc, const Matrix4f& view, const Matrix4f& prevView,
+    const uint32_t* pInstances, uint32_t instanceCount, std::byte* pData
+) noexcept {
+    const auto constantEnd = desc.mConstantBegin + desc.mConstantCount;
+
+    uint32_t coveredSize = 0;
+    for (uint32_t constantID = desc.mConstantBegin; constantID != constantEnd; ++constantID) {
+        const auto& constant = queue.mDrawConstants[constantID];
+        if (constant.mType == WorldViewConstant || constant.mType == WorldInvTConstant ||
+            constant.mType == PrevWorldViewConstant) {
+            coveredSize += sizeof(Matrix4f);
+        } else if (constant.mType == TextureIndicesConstant) {
+            coveredSize += sizeof(DX12MaterialData::mTextureIndices);
+        } else if (constant.mType == MaterialIndexConstant) {
+            coveredSize += sizeof(DX12MaterialData::mConstantIndex);
+        }
+    }
+    if (coveredSize != desc.mSize) {
+        memset(pData, 0, size_t(desc.mSize) * instanceCount);
+    }
+
+    for (uint32_t constantID = desc.mConstantBegin; constantID != constantEnd; ++constantID) {
+        const auto& constant = queue.mDrawConstants[constantID];
+        switch (constant.mType) {
+        case WorldViewConstant:
+            Expects(packet.mBatch);
+            writeDX12WorldViews(*packet.mBatch, view, pInstances, instanceCount,
+                pData + constant.mOffset, desc.mSize);
+            break;
+        case WorldInvTConstant:
+            Expects(packet.mBatch);
+            writeDX12WorldInvTs(*packet.mBatch, pInstances, instanceCount,
+                pData + constant.mOffset, desc.mSize);
+            break;
+        case PrevWorldViewConstant:
+            Expects(packet.mBatch);
+            writeDX12PrevWorldViews(*packet.mBatch, prevView, pInstances, instanceCount,
+                pData + constant.mOffset, desc.mSize);
+            break;
+        case TextureIndicesConstant:
+            Expects(packet.mMaterial);
+            for (uint32_t i = 0; i != instanceCount; ++i) {
+                memcpy(pData + size_t(desc.mSize) * i + constant.mOffset,
+                    packet.mMaterial->mTextureIndices.data(), sizeof(DX12MaterialData::mTextureIndices));
+            }
+            break;
+        case MaterialIndexConstant:
+            Expects(packet.mMaterial);
+            for (uint32_t i = 0; i != instanceCount; ++i) {
+                memcpy(pData + size_t(desc.mSize) * i + constant.mOffset,
+                    &packet.mMaterial->mConstantIndex, sizeof(DX12MaterialData::mConstantIndex));
+            }
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+void buildDX12PersistentConstants(CreationContext& context, DX12UnorderedRenderQueue& queue) {
+    queue.mPersistentOffsets.assign(queue.mDrawBindings.size(), UINT64_MAX);
+    queue.mPersistentConstants = DX12PersistentConstants{};
+    if (!queue.mIndirectGroups.empty())
+        return;
+
+    uint64_t size = 0;
+    for (const auto& packet : queue.mDrawPackets) {
+        for (uint32_t bindingID = packet.mBindingBegin; bindingID != packet.mBindingBegin + packet.mBindingCount; ++bindingID) {
+            const auto& binding = queue.mDrawBindings[bindingID];
+            if (binding.mType != RootShaderResourceBinding)
+                continue;
+            Expects(binding.mDescriptorCount == 1);
+            Expects(queue.mPersistentOffsets[bindingID] == UINT64_MAX);
+            const auto& desc = queue.mDrawDescriptors[binding.mDescriptorBegin];
+            if (!desc.mSize || !packet.mInstanceCount)
+                continue;
+
+            size = boost::alignment::align_up(size, 16);
+            queue.mPersistentOffsets[bindingID] = size;
+            size += uint64_t(desc.mSize) * packet.mInstanceCount;
+        }
+    }
+    if (!size)
+        return;
+
+    auto& persistent = queue.mPersistentConstants;
+    persistent.mSize = size;
+    persistent.mBuffer = DX12::createBuffer(context.mDevice, size);
+}
+
+void updateDX12PersistentConstants(ID3D12GraphicsCommandList* pCommandList,
+    DX12UploadBuffer& uploadBuffer, const Matrix4f& view, const Matrix4f& prevView,
+    DX12UnorderedRenderQueue& queue
+) {
+    auto& persistent = queue.mPersistentConstants;
+    if (!persistent.mBuffer)
+        return;
+
+    const bool viewChanged = !persistent.mResident ||
+        memcmp(persistent.mView, view.data(), sizeof(persistent.mView)) != 0 ||
+        memcmp(persistent.mPrevView, prevView.data(), sizeof(persistent.mPrevView)) != 0;
+    const auto version = getDX12TransformVersion();
+    if (!viewChanged && version == persistent.mSyncedVersion)
+        return;
+
+    auto* pBuffer = persistent.mBuffer.get();
+    bool copying = false;
+    auto copyRecords = [&](const DX12DrawPacket& packet, const DX12DrawDescriptor& desc,
+        uint64_t offset, uint32_t begin, uint32_t end
+    ) {
+        if (!copying) {
+            if (persistent.mResident) {
+                D3D12_RESOURCE_BARRIER barriers[] = {
+                    CD3DX12_RESOURCE_BARRIER::Transition(pBuffer,
+                        sPersistentState, D3D12_RESOURCE_STATE_COPY_DEST),
+                };
+                pCommandList->ResourceBarrier(_countof(barriers), barriers);
+            }
+            copying = true;
+        }
+        for (uint32_t first = begin; first < end; first += sMaxRecordsPerCopy) {
+            const auto count = std::min(sMaxRecordsPerCopy, end - first);
+            auto [pos, pData] = uploadBuffer.suballocate(desc.mSize, count, 16);
+            writeDX12DrawDescriptor(queue, packet, desc, view, prevView,
+                queue.mDrawInstances.data() + packet.mInstanceBegin + first, count, pData);
+            pCommandList->CopyBufferRegion(pBuffer, offset + uint64_t(desc.mSize) * first,
+                pos.mResource, pos.mBufferOffset, uint64_t(desc.mSize) * count);
+        }
+    };
+
+    // rewrite everything for a new view, otherwise runs of changed objects
+    for (const auto& packet : queue.mDrawPackets) {
+        for (uint32_t bindingID = packet.mBindingBegin; bindingID != packet.mBindingBegin + packet.mBindingCount; ++bindingID) {
+            const auto offset = queue.mPersistentOffsets[bindingID];
+            if (offset == UINT64_MAX)
+                continue;
+            const auto& desc = queue.mDrawDescriptors[queue.mDrawBindings[bindingID].mDescriptorBegin];
+            if (viewChanged) {
+                copyRecords(packet, desc, offset, 0, packet.mInstanceCount);
+                continue;
+            }
+            if (!packet.mBatch || packet.mBatch->mLatestTransformVersion <= persistent.mSyncedVersion)
+                continue;
+
+            const auto& versions = packet.mBatch->mTransformVersions;
+            uint32_t runBegin = 0;
+            bool inRun = false;
+            for (uint32_t instanceID = 0; instanceID != packet.mInstanceCount; ++instanceID) {
+                const auto objectID = queue.mDrawInstances[packet.mInstanceBegin + instanceID];
+                const bool dirty = versions[objectID] > persistent.mSyncedVersion;
+                if (dirty && !inRun) {
+                    runBegin = instanceID;
+                    inRun = true;
+                } else if (!dirty && inRun) {
+                    copyRecords(packet, desc, offset, runBegin, instanceID);
+                    inRun = false;
+                }
+            }
+            if (inRun) {
+                copyRecords(packet, desc, offset, runBegin, packet.mInstanceCount);
+            }
+        }
+    }
+
+    if (copying) {
+        D3D12_RESOURCE_BARRIER barriers[] = {
+            CD3DX12_RESOURCE_BARRIER::Transition(pBuffer,
+                D3D12_RESOURCE_STATE_COPY_DEST, sPersistentState),
+        };
+        pCommandList->ResourceBarrier(_countof(barriers), barriers);
+    }
+    memcpy(persistent.mView, view.data(), sizeof(persistent.mView));
+    memcpy(persistent.mPrevView, prevView.data(), sizeof(persistent.mPrevView));
+    persistent.mSyncedVersion = version;
+    persistent.mResident = true;
+}
+
+}
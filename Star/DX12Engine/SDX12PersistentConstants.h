@@ -0,0 +1,41 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <Star/DX12Engine/SDX12Types.h>
+
+namespace Star::Graphics::Render {
+
+struct CreationContext;
+class DX12UploadBuffer;
+
+// write constants of a descriptor for instances, one record of desc.mSize bytes each
+// prevView is the view of the previous frame, read by previous world view constants
+void writeDX12DrawDescriptor(const DX12UnorderedRenderQueue& queue, const DX12DrawPacket& packet,
+    const DX12DrawDescriptor& desc, const Matrix4f& view, const Matrix4f& prevView,
+    const uint32_t* pInstances, uint32_t instanceCount, std::byte* pData) noexcept;
+
+// lay out instanced root SRV records of a cpu driven queue in a default heap buffer
+// contents are written by the first update
+void buildDX12PersistentConstants(CreationContext& context, DX12UnorderedRenderQueue& queue);
+
+// copy records that are stale for the views or whose transforms changed since the last update
+void updateDX12PersistentConstants(ID3D12GraphicsCommandList* pCommandList,
+    DX12UploadBuffer& uploadBuffer, const Matrix4f& view, const Matrix4f& prevView,
+    DX12UnorderedRenderQueue& queue);
+
+}
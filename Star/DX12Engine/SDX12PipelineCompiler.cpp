@@ -0,0 +1,93 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "SDX12PipelineCompiler.h"
+#include "SDX12PipelineLibrary.h"
+
+namespace Star::Graphics::Render {
+
+DX12PipelineCompiler::DX12PipelineCompiler(ID3D12Device* pDevice, DX12PipelineLibrary* pLibrary,
+    boost::asio::io_context* pTaskService)
+    : mDevice(pDevice)
+    , mLibrary(pLibrary)
+    , mTaskService(pTaskService)
+    , mFinished(256)
+{
+    Expects(mTaskService);
+}
+
+DX12PipelineCompiler::~DX12PipelineCompiler() {
+    while (mRunningCount.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+    mFinished.consume_all([](const Finished& finished) {
+        if (finished.mObject) {
+            finished.mObject->Release();
+        }
+    });
+}
+
+void DX12PipelineCompiler::compile(DX12PipelineStateData& state, const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc,
+    const DX12ShaderProgramData& program, uint64_t rootSignatureHash, uint64_t pipelineHash
+) {
+    Expects(!state.mObject);
+
+    // input elements are allocated per creation, copied with the desc
+    std::vector<D3D12_INPUT_ELEMENT_DESC> elements(desc.InputLayout.pInputElementDescs,
+        desc.InputLayout.pInputElementDescs + desc.InputLayout.NumElements);
+    com_ptr<ID3D12RootSignature> rootSignature;
+    rootSignature.copy_from(desc.pRootSignature);
+
+    ++mPendingCount;
+    mRunningCount.fetch_add(1, std::memory_order_relaxed);
+    post(*mTaskService, [this, pState = &state, desc, program, rootSignature,
+        elements = std::move(elements), rootSignatureHash, pipelineHash]() mutable {
+        desc.InputLayout.pInputElementDescs = elements.empty() ? nullptr : elements.data();
+        Finished finished{ pState, nullptr };
+        try {
+            com_ptr<ID3D12PipelineState> pso;
+            if (mLibrary) {
+                pso = mLibrary->createGraphicsPipelineState(desc, rootSignatureHash, pipelineHash);
+            } else {
+                V(mDevice->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(pso.put())));
+            }
+            finished.mObject = pso.detach();
+        } catch (...) {
+            OutputDebugStringA("WARNING: pso compilation failed, its draws are skipped\n");
+        }
+        mFinished.push(finished);
+        mRunningCount.fetch_sub(1, std::memory_order_release);
+    });
+}
+
+bool DX12PipelineCompiler::update() {
+    bool published = false;
+    mFinished.consume_all([&](const Finished& finished) {
+        Expects(mPendingCount);
+        --mPendingCount;
+        if (!finished.mObject) {
+            return;
+        }
+        finished.mState->mObject = nullptr;
+        finished.mState->mObject.attach(finished.mObject);
+        published = true;
+    });
+    return published;
+}
+
+}
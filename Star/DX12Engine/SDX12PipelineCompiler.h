@@ -0,0 +1,64 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+#include <Star/DX12Engine/SDX12Types.h>
+#include <Star/SLockFree.h>
+
+namespace Star::Graphics::Render {
+
+class DX12PipelineLibrary;
+
+// graphics psos created by jobs on task threads, published on render thread
+// draw packets are skipped until the pso of their pipeline state is published
+class DX12PipelineCompiler {
+public:
+    DX12PipelineCompiler(ID3D12Device* pDevice, DX12PipelineLibrary* pLibrary,
+        boost::asio::io_context* pTaskService);
+    DX12PipelineCompiler(const DX12PipelineCompiler&) = delete;
+    DX12PipelineCompiler& operator=(const DX12PipelineCompiler&) = delete;
+    // waits for running jobs, their states must outlive the compiler
+    ~DX12PipelineCompiler();
+
+    // desc is copied, shader programs and root signature are kept alive by the job
+    // pipelineHash is the hash of the pso desc built by the asset factory
+    void compile(DX12PipelineStateData& state, const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc,
+        const DX12ShaderProgramData& program, uint64_t rootSignatureHash, uint64_t pipelineHash);
+
+    // set finished psos to their states, true if any pso was published
+    bool update();
+
+    uint32_t pendingCount() const noexcept {
+        return mPendingCount;
+    }
+private:
+    struct Finished {
+        DX12PipelineStateData* mState = nullptr;
+        // reference owned by the queue until published, null if compilation failed
+        ID3D12PipelineState* mObject = nullptr;
+    };
+
+    ID3D12Device* mDevice = nullptr;
+    DX12PipelineLibrary* mLibrary = nullptr;
+    boost::asio::io_context* mTaskService = nullptr;
+    MessageQueue<Finished> mFinished;
+    std::atomic<uint32_t> mRunningCount = 0;
+    uint32_t mPendingCount = 0;
+};
+
+}
@@ -0,0 +1,183 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "SDX12PipelineLibrary.h"
+
+namespace Star::Graphics::Render {
+
+namespace {
+
+constexpr uint32_t sLibraryMagic = 0x4c505453; // STPL
+constexpr uint32_t sLibraryVersion = 2;
+
+// the pipeline hash covers everything of the desc but the root signature
+std::wstring getPipelineName(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc,
+    uint64_t rootSignatureHash, uint64_t pipelineHash
+) {
+    Expects(!desc.StreamOutput.NumEntries);
+    Expects(!desc.CachedPSO.CachedBlobSizeInBytes);
+
+    uint64_t seed = hashDX12Bytes(&rootSignatureHash, sizeof(rootSignatureHash));
+    seed = hashDX12Bytes(&pipelineHash, sizeof(pipelineHash), seed);
+
+    wchar_t name[17];
+    swprintf_s(name, L"%016llx", seed);
+    return name;
+}
+
+}
+
+uint64_t hashDX12Bytes(const void* pData, size_t size, uint64_t seed) noexcept {
+    const auto* pBytes = static_cast<const uint8_t*>(pData);
+    for (size_t i = 0; i != size; ++i) {
+        seed ^= pBytes[i];
+        seed *= 0x100000001b3ull;
+    }
+    return seed;
+}
+
+DX12PipelineLibrary::DX12PipelineLibrary(ID3D12Device* pDevice, IDXGIFactory4* pFactory, std::string_view path)
+    : mDevice(pDevice)
+    , mPath(path)
+{
+    // adapter and driver of the stored pipelines
+    com_ptr<IDXGIAdapter1> adapter;
+    V(pFactory->EnumAdapterByLuid(pDevice->GetAdapterLuid(), IID_PPV_ARGS(adapter.put())));
+    DXGI_ADAPTER_DESC1 adapterDesc{};
+    V(adapter->GetDesc1(&adapterDesc));
+    LARGE_INTEGER driverVersion{};
+    if (FAILED(adapter->CheckInterfaceSupport(__uuidof(IDXGIDevice), &driverVersion))) {
+        driverVersion.QuadPart = 0;
+    }
+
+    mHeader.mMagic = sLibraryMagic;
+    mHeader.mVersion = sLibraryVersion;
+    mHeader.mVendorID = adapterDesc.VendorId;
+    mHeader.mDeviceID = adapterDesc.DeviceId;
+    mHeader.mSubSysID = adapterDesc.SubSysId;
+    mHeader.mRevision = adapterDesc.Revision;
+    mHeader.mDriverVersion = driverVersion.QuadPart;
+
+    load();
+}
+
+DX12PipelineLibrary::~DX12PipelineLibrary() = default;
+
+void DX12PipelineLibrary::load() {
+    auto device1 = mDevice->try_as<ID3D12Device1>();
+    if (!device1) {
+        OutputDebugStringA("WARNING: pipeline library requires ID3D12Device1, psos are not cached\n");
+        return;
+    }
+
+    std::ifstream ifs(mPath, std::ios::binary);
+    if (ifs) {
+        Header header;
+        if (ifs.read(reinterpret_cast<char*>(&header), sizeof(header)) &&
+            header.mMagic == mHeader.mMagic && header.mVersion == mHeader.mVersion &&
+            header.mVendorID == mHeader.mVendorID && header.mDeviceID == mHeader.mDeviceID &&
+            header.mSubSysID == mHeader.mSubSysID && header.mRevision == mHeader.mRevision &&
+            header.mDriverVersion == mHeader.mDriverVersion
+        ) {
+            mBlob.resize(gsl::narrow<size_t>(header.mSize));
+            if (!ifs.read(mBlob.data(), mBlob.size())) {
+                mBlob.clear();
+            }
+        }
+    }
+
+    if (!mBlob.empty()) {
+        // runtime rejects libraries of other drivers and adapters as well
+        auto hr = device1->CreatePipelineLibrary(mBlob.data(), mBlob.size(), IID_PPV_ARGS(mLibrary.put()));
+        if (SUCCEEDED(hr)) {
+            return;
+        }
+        mLibrary = nullptr;
+        mBlob.clear();
+        mBlob.shrink_to_fit();
+        OutputDebugStringA("WARNING: pipeline library is stale, psos are rebuilt\n");
+    }
+
+    auto hr = device1->CreatePipelineLibrary(nullptr, 0, IID_PPV_ARGS(mLibrary.put()));
+    if (FAILED(hr)) {
+        mLibrary = nullptr;
+        OutputDebugStringA("WARNING: pipeline library is not supported, psos are not cached\n");
+    }
+}
+
+com_ptr<ID3D12PipelineState> DX12PipelineLibrary::createGraphicsPipelineState(
+    const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, uint64_t rootSignatureHash, uint64_t pipelineHash
+) {
+    com_ptr<ID3D12PipelineState> pso;
+    if (!mLibrary) {
+        V(mDevice->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(pso.put())));
+        return pso;
+    }
+
+    const auto name = getPipelineName(desc, rootSignatureHash, pipelineHash);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (SUCCEEDED(mLibrary->LoadGraphicsPipeline(name.c_str(), &desc, IID_PPV_ARGS(pso.put())))) {
+        ++mLoadedCount;
+        return pso;
+    }
+
+    pso = nullptr;
+    V(mDevice->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(pso.put())));
+    ++mCreatedCount;
+
+    // fails if the name is taken by a pso whose desc differs in what the hash does not cover
+    if (SUCCEEDED(mLibrary->StorePipeline(name.c_str(), pso.get()))) {
+        mDirty = true;
+    } else {
+        OutputDebugStringA("WARNING: pso not stored in pipeline library\n");
+    }
+    return pso;
+}
+
+void DX12PipelineLibrary::save() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (!mLibrary || !mDirty) {
+        return;
+    }
+
+    std::vector<char> blob(mLibrary->GetSerializedSize());
+    V(mLibrary->Serialize(blob.data(), blob.size()));
+
+    auto header = mHeader;
+    header.mSize = blob.size();
+
+    // written aside and renamed, an interrupted save keeps the previous library
+    auto tmpPath = mPath + ".tmp";
+    {
+        std::ofstream ofs(tmpPath, std::ios::binary | std::ios::trunc);
+        ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        ofs.write(blob.data(), blob.size());
+        if (!ofs) {
+            OutputDebugStringA("WARNING: pipeline library not saved\n");
+            return;
+        }
+    }
+    if (!MoveFileExA(tmpPath.c_str(), mPath.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+        OutputDebugStringA("WARNING: pipeline library not saved\n");
+        return;
+    }
+    mDirty = false;
+}
+
+}
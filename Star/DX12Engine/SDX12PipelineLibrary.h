@@ -0,0 +1,78 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+#include <Star/DX12Engine/SDX12Types.h>
+#include <mutex>
+
+namespace Star::Graphics::Render {
+
+// 64-bit fnv-1a, stable between runs
+uint64_t hashDX12Bytes(const void* pData, size_t size, uint64_t seed = 0xcbf29ce484222325ull) noexcept;
+
+// graphics psos of previous runs, serialized in a file next to settings.star
+// pipelines are named by their root signature and the pso desc hash of the asset build
+// the file is dropped when adapter or driver version changes
+class DX12PipelineLibrary {
+public:
+    DX12PipelineLibrary(ID3D12Device* pDevice, IDXGIFactory4* pFactory, std::string_view path);
+    DX12PipelineLibrary(const DX12PipelineLibrary&) = delete;
+    DX12PipelineLibrary& operator=(const DX12PipelineLibrary&) = delete;
+    ~DX12PipelineLibrary();
+
+    // loads the pso from the library, creates and stores it if missing
+    com_ptr<ID3D12PipelineState> createGraphicsPipelineState(
+        const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, uint64_t rootSignatureHash, uint64_t pipelineHash);
+
+    // writes the library if pipelines were stored since it was loaded
+    void save();
+
+    uint32_t loadedCount() const noexcept {
+        return mLoadedCount;
+    }
+    uint32_t createdCount() const noexcept {
+        return mCreatedCount;
+    }
+private:
+    struct Header {
+        uint32_t mMagic = 0;
+        uint32_t mVersion = 0;
+        uint32_t mVendorID = 0;
+        uint32_t mDeviceID = 0;
+        uint32_t mSubSysID = 0;
+        uint32_t mRevision = 0;
+        uint64_t mDriverVersion = 0;
+        uint64_t mSize = 0;
+    };
+
+    void load();
+
+    ID3D12Device* mDevice = nullptr;
+    std::string mPath;
+    Header mHeader;
+    std::mutex mMutex;
+    // serialized pipelines, referenced by mLibrary until it is released
+    std::vector<char> mBlob;
+    // null if pipeline libraries are unsupported, psos are created directly
+    com_ptr<ID3D12PipelineLibrary> mLibrary;
+    uint32_t mLoadedCount = 0;
+    uint32_t mCreatedCount = 0;
+    bool mDirty = false;
+};
+
+}
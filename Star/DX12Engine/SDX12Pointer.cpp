@@ -18,22 +18,52 @@
 #include "SDX12Pointer.h"
 #include "SDX12Types.h"
 #include "SDX12ShaderDescriptorHeap.h"
+#include "SDX12ReleaseQueue.h"
 
 namespace Star::Graphics::Render {
 
+namespace {
+
+// released descriptors are reused, textures must not rewrite them anymore
+void removeDX12TextureViews(DX12MaterialData& material, D3D12_CPU_DESCRIPTOR_HANDLE begin, uint32_t count) {
+    const auto end = material.mDescriptorHeap->advance({ begin, {} }, count).mCpuHandle;
+    for (const auto& tex : material.mTextures) {
+        auto& views = tex->mViewDescriptors;
+        views.erase(std::remove_if(views.begin(), views.end(), [&](D3D12_CPU_DESCRIPTOR_HANDLE handle) {
+            return handle.ptr >= begin.ptr && handle.ptr < end.ptr;
+        }), views.end());
+    }
+}
+
+}
+
 void intrusive_ptr_add_ref(DX12MeshData* p) {
     ++p->mRefCount;
 }
 
 void intrusive_ptr_release(DX12MeshData* p) {
     if (--p->mRefCount == 0) {
+        // frames in flight may still draw the mesh
+        if (p->mReleaseQueue) {
+            for (auto& vb : p->mVertexBuffers) {
+                p->mReleaseQueue->release(vb.mBuffer);
+            }
+            p->mReleaseQueue->release(p->mIndexBuffer.mBuffer);
+        }
         p->mVertexBuffers.clear();
         p->mVertexBufferViews.clear();
         p->mSubMeshes.clear();
+        p->mMeshlets.clear();
+        p->mLods.clear();
+        p->mLodSubMeshes.clear();
         p->mIndexBuffer.mBuffer = nullptr;
+        p->mIndexBuffer.mMemory = nullptr;
         p->mMeshData.reset();
         p->mLayoutID = 0;
         p->mLayoutName.clear();
+        p->mPage = nullptr;
+        p->mBaseVertex = 0;
+        p->mBaseIndex = 0;
     }
 }
 
@@ -43,7 +73,19 @@ void intrusive_ptr_add_ref(DX12TextureData* p) {
 
 void intrusive_ptr_release(DX12TextureData* p) {
     if (--p->mRefCount == 0) {
+        if (p->mBindlessIndex != UINT32_MAX) {
+            p->mDescriptorHeap->deallocateBindless(p->mBindlessIndex);
+            p->mBindlessIndex = UINT32_MAX;
+        }
+        p->mDescriptorHeap = nullptr;
+        // frames in flight may still sample the texture
+        if (p->mReleaseQueue) {
+            p->mReleaseQueue->release(p->mTexture);
+        }
         p->mTexture = nullptr;
+        p->mMemory = nullptr;
+        p->mTiles.clear();
+        p->mViewDescriptors.clear();
         p->mTextureData.reset();
     }
 }
@@ -81,8 +123,12 @@ void intrusive_ptr_release(DX12MaterialData* p) {
                                 for (const auto& collection : subpass.mCollections) {
                                     if (std::holds_alternative<Persistent_>(collection.mIndex.mPersistency)) {
                                         for (const auto& list : collection.mResourceViewLists) {
-                                            Expects(list.mCapacity);
-                                            p->mDescriptorHeap->deallocatePersistent(list.mCpuOffset, list.mCapacity);
+                                            // bindless lists view the shared table
+                                            if (list.mCpuOffset.ptr) {
+                                                Expects(list.mCapacity);
+                                                removeDX12TextureViews(*p, list.mCpuOffset, list.mCapacity);
+                                                p->mDescriptorHeap->deallocatePersistent(list.mCpuOffset, list.mCapacity);
+                                            }
                                         }
                                         for (const auto& list : collection.mSamplerLists) {
                                             throw std::runtime_error("sampler descriptor not supported yet");
@@ -99,6 +145,8 @@ void intrusive_ptr_release(DX12MaterialData* p) {
         p->mShader.reset();
         p->mShaderData.clear();
         p->mMaterialData.reset();
+        p->mTextureIndices.fill(UINT32_MAX);
+        p->mConstantIndex = 0;
         p->mConstantMap.mBuffer.clear();
         p->mConstantMap.mIndex.clear();
 
@@ -112,7 +160,8 @@ void intrusive_ptr_add_ref(DX12ContentData* p) {
 
 void intrusive_ptr_release(DX12ContentData* p) {
     if (--p->mRefCount == 0) {
-        p->mIDs.clear();
+        p->mDrawCallIDs.clear();
+        p->mBatchIDs.clear();
         p->mDrawCalls.clear();
         p->mFlattenedObjects.clear();
         p->mContentData.reset();
@@ -0,0 +1,387 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "SDX12Raytracing.h"
+#include "SDX12Helpers.h"
+#include "SDX12Transforms.h"
+#include "SDX12UploadBuffer.h"
+#include <Star/Graphics/SRenderFormatDXGI.h>
+
+namespace Star::Graphics::Render {
+
+namespace {
+
+constexpr uint64_t sAlignment = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BYTE_ALIGNMENT;
+
+com_ptr<ID3D12Resource> createAccelerationStructure(ID3D12Device* pDevice, uint64_t size) {
+    return DX12::createUnorderedAccessBuffer(pDevice,
+        boost::alignment::align_up(size, sAlignment), D3D12_RESOURCE_STATE_RAYTRACING_ACCELERATION_STRUCTURE);
+}
+
+// vertex formats accepted by tier 1.0
+bool isPositionFormat(DXGI_FORMAT format) noexcept {
+    switch (format) {
+    case DXGI_FORMAT_R32G32B32_FLOAT:
+    case DXGI_FORMAT_R32G32_FLOAT:
+    case DXGI_FORMAT_R16G16B16A16_FLOAT:
+    case DXGI_FORMAT_R16G16_FLOAT:
+    case DXGI_FORMAT_R16G16B16A16_SNORM:
+    case DXGI_FORMAT_R16G16_SNORM:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// one geometry per level 0 submesh, empty if the mesh has no traceable positions
+void getGeometries(const DX12MeshData& mesh, std::vector<D3D12_RAYTRACING_GEOMETRY_DESC>& geometries) {
+    if (!mesh.mMeshData || !mesh.mIndexBufferView.SizeInBytes)
+        return;
+    const auto& meshData = *mesh.mMeshData;
+    const uint32_t indexSize = mesh.mIndexBufferView.Format == DXGI_FORMAT_R16_UINT ? 2 : 4;
+
+    for (size_t id = 0; id != meshData.mVertexBuffers.size(); ++id) {
+        const auto& stream = meshData.mVertexBuffers[id];
+        for (const auto& e : stream.mDesc.mElements) {
+            if (!std::holds_alternative<SV_Position_>(e.mType))
+                continue;
+            const auto format = getDXGIFormat(e.mFormat);
+            if (!isPositionFormat(format))
+                return;
+
+            const auto& vbv = mesh.mVertexBufferViews[id];
+            for (const auto& subMesh : mesh.mSubMeshes) {
+                auto& geometry = geometries.emplace_back();
+                geometry.Type = D3D12_RAYTRACING_GEOMETRY_TYPE_TRIANGLES;
+                geometry.Flags = D3D12_RAYTRACING_GEOMETRY_FLAG_OPAQUE;
+                auto& triangles = geometry.Triangles;
+                triangles.IndexFormat = mesh.mIndexBufferView.Format;
+                triangles.IndexCount = subMesh.mIndexCount;
+                triangles.IndexBuffer = mesh.mIndexBufferView.BufferLocation +
+                    (uint64_t(mesh.mBaseIndex) + subMesh.mIndexOffset) * indexSize;
+                triangles.VertexFormat = format;
+                triangles.VertexCount = stream.mVertexCount;
+                // pooled meshes index from their base vertex
+                triangles.VertexBuffer.StartAddress = vbv.BufferLocation +
+                    uint64_t(mesh.mBaseVertex) * vbv.StrideInBytes + e.mAlignedByteOffset;
+                triangles.VertexBuffer.StrideInBytes = vbv.StrideInBytes;
+            }
+            return;
+        }
+    }
+}
+
+}
+
+DX12AccelerationStructures::DX12AccelerationStructures(ID3D12Device* pDevice, uint64_t scratchBudget)
+    : mScratchBudget(boost::alignment::align_up(scratchBudget, sAlignment))
+{
+    V(pDevice->QueryInterface(IID_PPV_ARGS(mDevice.put())));
+    mPostbuild = DX12::createUnorderedAccessBuffer(mDevice.get(),
+        sMaxBuildsPerBatch * sizeof(uint64_t), D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+    STAR_SET_DEBUG_NAME(mPostbuild, "BLAS Postbuild");
+}
+
+DX12AccelerationStructures::~DX12AccelerationStructures() = default;
+
+bool DX12AccelerationStructures::isDirty(const DX12Resources& resources, uint64_t completedFence) const noexcept {
+    if (!mQueue.empty() || mMissingMeshes || mInstancesChanged)
+        return true;
+    if (resources.mContents.size() != mContentCount)
+        return true;
+    if (!mBatches.empty() && mBatches.front().mFence <= completedFence)
+        return true;
+    return mInstanceCount && getDX12TransformVersion() != mTransformVersion;
+}
+
+void DX12AccelerationStructures::update(ID3D12GraphicsCommandList4* pCommandList, DX12UploadBuffer& uploadBuffer,
+    const DX12Resources& resources, uint64_t fence, uint64_t completedFence
+) {
+    mRetired.erase(std::remove_if(mRetired.begin(), mRetired.end(), [&](const Retired& retired) {
+        return retired.mFence <= completedFence;
+    }), mRetired.end());
+
+    if (resources.mContents.size() != mContentCount || mMissingMeshes) {
+        collectMeshes(resources, fence);
+    }
+    compactBottomLevels(pCommandList, fence, completedFence);
+    buildBottomLevels(pCommandList, resources, fence);
+
+    // transforms only change on the render thread, between updates
+    const auto transformVersion = getDX12TransformVersion();
+    if (mInstancesChanged) {
+        // builds and compactions are read by the top level
+        auto barrier = CD3DX12_RESOURCE_BARRIER::UAV(nullptr);
+        pCommandList->ResourceBarrier(1, &barrier);
+        buildTopLevel(pCommandList, uploadBuffer, resources, false, fence);
+    } else if (mInstanceCount && transformVersion != mTransformVersion) {
+        buildTopLevel(pCommandList, uploadBuffer, resources, true, fence);
+    }
+    mTransformVersion = transformVersion;
+}
+
+D3D12_GPU_VIRTUAL_ADDRESS DX12AccelerationStructures::topLevel() const noexcept {
+    return mInstanceCount ? mTopLevel->GetGPUVirtualAddress() : 0;
+}
+
+void DX12AccelerationStructures::retire(com_ptr<ID3D12Resource> resource, uint64_t fence) {
+    if (resource) {
+        mRetired.emplace_back(Retired{ std::move(resource), fence });
+    }
+}
+
+ID3D12Resource* DX12AccelerationStructures::scratch(uint64_t size, uint64_t fence) {
+    if (!mScratch || mScratch->GetDesc().Width < size) {
+        retire(std::move(mScratch), fence);
+        mScratch = DX12::createUnorderedAccessBuffer(mDevice.get(),
+            std::max(boost::alignment::align_up(size, sAlignment), mScratchBudget),
+            D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+        STAR_SET_DEBUG_NAME(mScratch, "AS Scratch");
+    }
+    return mScratch.get();
+}
+
+void DX12AccelerationStructures::collectMeshes(const DX12Resources& resources, uint64_t fence) {
+    mContentCount = resources.mContents.size();
+    mMissingMeshes = false;
+    mInstancesChanged = true;
+
+    // structures of released meshes
+    for (auto iter = mBottomLevels.begin(); iter != mBottomLevels.end();) {
+        if (resources.mMeshes.find(iter->first)) {
+            ++iter;
+            continue;
+        }
+        retire(std::move(iter->second.mResult), fence);
+        iter = mBottomLevels.erase(iter);
+    }
+
+    for (const auto& content : resources.mContents) {
+        for (const auto& batch : content.mFlattenedObjects) {
+            for (const auto& renderer : batch.mMeshRenderers) {
+                const auto* pMesh = renderer.mMesh.get();
+                if (!pMesh)
+                    continue;
+                // streamed meshes are built once their buffers are uploaded
+                if (!pMesh->mResident) {
+                    mMissingMeshes = true;
+                    continue;
+                }
+                if (mBottomLevels.try_emplace(pMesh->mMetaID).second) {
+                    mQueue.emplace_back(pMesh->mMetaID);
+                }
+            }
+        }
+    }
+}
+
+void DX12AccelerationStructures::buildBottomLevels(ID3D12GraphicsCommandList4* pCommandList,
+    const DX12Resources& resources, uint64_t fence
+) {
+    BuildBatch batch;
+    batch.mFence = fence;
+    ID3D12Resource* pScratch = nullptr;
+    uint64_t scratchOffset = 0;
+    std::vector<D3D12_RAYTRACING_GEOMETRY_DESC> geometries;
+    while (!mQueue.empty() && batch.mBuilds.size() != sMaxBuildsPerBatch) {
+        const auto metaID = mQueue.front();
+        auto iter = mBottomLevels.find(metaID);
+        const auto handle = resources.mMeshes.find(metaID);
+        if (iter == mBottomLevels.end() || !handle) {
+            mQueue.pop_front();
+            continue;
+        }
+
+        // meshes without traceable positions keep an empty structure and have no instances
+        geometries.clear();
+        getGeometries(resources.mMeshes[handle], geometries);
+        if (geometries.empty()) {
+            mQueue.pop_front();
+            continue;
+        }
+
+        D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS inputs{};
+        inputs.Type = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL;
+        inputs.Flags = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_PREFER_FAST_TRACE |
+            D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_ALLOW_COMPACTION;
+        inputs.NumDescs = gsl::narrow_cast<uint32_t>(geometries.size());
+        inputs.DescsLayout = D3D12_ELEMENTS_LAYOUT_ARRAY;
+        inputs.pGeometryDescs = geometries.data();
+
+        D3D12_RAYTRACING_ACCELERATION_STRUCTURE_PREBUILD_INFO info{};
+        mDevice->GetRaytracingAccelerationStructurePrebuildInfo(&inputs, &info);
+
+        // the first build of a batch always fits, the scratch grows for it if needed
+        const auto scratchSize = boost::alignment::align_up(info.ScratchDataSizeInBytes, sAlignment);
+        if (!pScratch) {
+            pScratch = scratch(scratchSize, fence);
+        } else if (scratchOffset + scratchSize > mScratchBudget) {
+            break;
+        }
+
+        auto result = createAccelerationStructure(mDevice.get(), info.ResultDataMaxSizeInBytes);
+        STAR_SET_DEBUG_NAME(result, to_string(metaID) + " BLAS");
+
+        D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_DESC desc{};
+        desc.DestAccelerationStructureData = result->GetGPUVirtualAddress();
+        desc.Inputs = inputs;
+        desc.ScratchAccelerationStructureData = pScratch->GetGPUVirtualAddress() + scratchOffset;
+        D3D12_RAYTRACING_ACCELERATION_STRUCTURE_POSTBUILD_INFO_DESC postbuild{
+            mPostbuild->GetGPUVirtualAddress() + batch.mBuilds.size() * sizeof(uint64_t),
+            D3D12_RAYTRACING_ACCELERATION_STRUCTURE_POSTBUILD_INFO_COMPACTED_SIZE
+        };
+        pCommandList->BuildRaytracingAccelerationStructure(&desc, 1, &postbuild);
+
+        batch.mBuilds.emplace_back(metaID, result.get());
+        iter->second.mResult = std::move(result);
+        iter->second.mCompacted = false;
+        scratchOffset += scratchSize;
+        mQueue.pop_front();
+    }
+    if (batch.mBuilds.empty())
+        return;
+
+    // compacted sizes are read once the batch completes
+    const auto size = batch.mBuilds.size() * sizeof(uint64_t);
+    V(mDevice->CreateCommittedResource(
+        &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_READBACK),
+        D3D12_HEAP_FLAG_NONE,
+        &CD3DX12_RESOURCE_DESC::Buffer(size),
+        D3D12_RESOURCE_STATE_COPY_DEST,
+        nullptr,
+        IID_PPV_ARGS(batch.mReadback.put())));
+
+    auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(mPostbuild.get(),
+        D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_COPY_SOURCE);
+    pCommandList->ResourceBarrier(1, &barrier);
+    pCommandList->CopyBufferRegion(batch.mReadback.get(), 0, mPostbuild.get(), 0, size);
+    std::swap(barrier.Transition.StateBefore, barrier.Transition.StateAfter);
+    pCommandList->ResourceBarrier(1, &barrier);
+
+    mBatches.emplace_back(std::move(batch));
+    mInstancesChanged = true;
+}
+
+void DX12AccelerationStructures::compactBottomLevels(ID3D12GraphicsCommandList4* pCommandList,
+    uint64_t fence, uint64_t completedFence
+) {
+    while (!mBatches.empty() && mBatches.front().mFence <= completedFence) {
+        auto& batch = mBatches.front();
+        const D3D12_RANGE range{ 0, batch.mBuilds.size() * sizeof(uint64_t) };
+        void* pData = nullptr;
+        V(batch.mReadback->Map(0, &range, &pData));
+        const auto* pSizes = static_cast<const uint64_t*>(pData);
+
+        for (size_t i = 0; i != batch.mBuilds.size(); ++i) {
+            const auto& [metaID, pResult] = batch.mBuilds[i];
+            auto iter = mBottomLevels.find(metaID);
+            // released or built again since
+            if (iter == mBottomLevels.end() || iter->second.mResult.get() != pResult)
+                continue;
+
+            auto compacted = createAccelerationStructure(mDevice.get(), pSizes[i]);
+            STAR_SET_DEBUG_NAME(compacted, to_string(metaID) + " BLAS");
+            pCommandList->CopyRaytracingAccelerationStructure(compacted->GetGPUVirtualAddress(),
+                pResult->GetGPUVirtualAddress(), D3D12_RAYTRACING_ACCELERATION_STRUCTURE_COPY_MODE_COMPACT);
+            retire(std::move(iter->second.mResult), fence);
+            iter->second.mResult = std::move(compacted);
+            iter->second.mCompacted = true;
+            mInstancesChanged = true;
+        }
+
+        const D3D12_RANGE written{ 0, 0 };
+        batch.mReadback->Unmap(0, &written);
+        mBatches.pop_front();
+    }
+}
+
+void DX12AccelerationStructures::buildTopLevel(ID3D12GraphicsCommandList4* pCommandList,
+    DX12UploadBuffer& uploadBuffer, const DX12Resources& resources, bool refit, uint64_t fence
+) {
+    // instances of every object with a built mesh, in content order
+    mInstances.clear();
+    for (const auto& content : resources.mContents) {
+        for (const auto& batch : content.mFlattenedObjects) {
+            for (uint32_t objectID = 0; objectID != batch.mMeshRenderers.size(); ++objectID) {
+                const auto* pMesh = batch.mMeshRenderers[objectID].mMesh.get();
+                if (!pMesh)
+                    continue;
+                auto iter = mBottomLevels.find(pMesh->mMetaID);
+                if (iter == mBottomLevels.end() || !iter->second.mResult)
+                    continue;
+
+                const auto world = getDX12WorldTransform(batch, objectID);
+                auto& instance = mInstances.emplace_back();
+                for (uint32_t r = 0; r != 3; ++r) {
+                    for (uint32_t c = 0; c != 4; ++c) {
+                        instance.Transform[r][c] = world.matrix()(r, c);
+                    }
+                }
+                instance.InstanceID = gsl::narrow_cast<uint32_t>(mInstances.size() - 1);
+                instance.InstanceMask = 0xFF;
+                instance.AccelerationStructure = iter->second.mResult->GetGPUVirtualAddress();
+            }
+        }
+    }
+
+    mInstancesChanged = false;
+    const auto count = gsl::narrow_cast<uint32_t>(mInstances.size());
+    if (!count) {
+        mInstanceCount = 0;
+        return;
+    }
+    // instances only change with mInstancesChanged, a refit keeps their count
+    refit = refit && count == mInstanceCount;
+
+    auto pos = uploadBuffer.upload(mInstances.data(), sizeof(D3D12_RAYTRACING_INSTANCE_DESC), count,
+        D3D12_RAYTRACING_INSTANCE_DESCS_BYTE_ALIGNMENT);
+
+    D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS inputs{};
+    inputs.Type = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL;
+    inputs.Flags = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_PREFER_FAST_TRACE |
+        D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_ALLOW_UPDATE;
+    if (refit) {
+        inputs.Flags |= D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_PERFORM_UPDATE;
+    }
+    inputs.NumDescs = count;
+    inputs.DescsLayout = D3D12_ELEMENTS_LAYOUT_ARRAY;
+    inputs.InstanceDescs = pos.mResource->GetGPUVirtualAddress() + pos.mBufferOffset;
+
+    D3D12_RAYTRACING_ACCELERATION_STRUCTURE_PREBUILD_INFO info{};
+    mDevice->GetRaytracingAccelerationStructurePrebuildInfo(&inputs, &info);
+    if (!refit && info.ResultDataMaxSizeInBytes > mTopLevelSize) {
+        retire(std::move(mTopLevel), fence);
+        mTopLevelSize = boost::alignment::align_up(info.ResultDataMaxSizeInBytes, sAlignment);
+        mTopLevel = createAccelerationStructure(mDevice.get(), mTopLevelSize);
+        STAR_SET_DEBUG_NAME(mTopLevel, "TLAS");
+    }
+    auto* pScratch = scratch(refit ? info.UpdateScratchDataSizeInBytes : info.ScratchDataSizeInBytes, fence);
+
+    D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_DESC desc{};
+    desc.DestAccelerationStructureData = mTopLevel->GetGPUVirtualAddress();
+    desc.Inputs = inputs;
+    desc.SourceAccelerationStructureData = refit ? mTopLevel->GetGPUVirtualAddress() : 0;
+    desc.ScratchAccelerationStructureData = pScratch->GetGPUVirtualAddress();
+    pCommandList->BuildRaytracingAccelerationStructure(&desc, 0, nullptr);
+
+    auto barrier = CD3DX12_RESOURCE_BARRIER::UAV(mTopLevel.get());
+    pCommandList->ResourceBarrier(1, &barrier);
+    mInstanceCount = count;
+}
+
+}
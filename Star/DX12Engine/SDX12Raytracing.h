@@ -0,0 +1,107 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+#include <Star/DX12Engine/SDX12Types.h>
+#include <Star/SFlatHashMap.h>
+
+namespace Star::Graphics::Render {
+
+class DX12UploadBuffer;
+
+// bottom level structure of a mesh, built from the triangles of its level 0 submeshes
+struct DX12BottomLevelAS {
+    com_ptr<ID3D12Resource> mResult;
+    // replaced by the compacted copy once the size of the build is read back
+    bool mCompacted = false;
+};
+
+// acceleration structures of the loaded contents, one top level structure over every object batch
+// bottom levels are built in batches under a scratch budget and compacted once their builds complete
+// the top level is rebuilt when its instances change and refit when only transforms move
+// recorded on the direct queue, resources read by earlier submissions are kept until their fence completes
+class DX12AccelerationStructures {
+public:
+    static const uint64_t sDefaultScratchBudget = 64 * 1024 * 1024;
+    static const uint32_t sMaxBuildsPerBatch = 256;
+
+    // the device must support raytracing
+    DX12AccelerationStructures(ID3D12Device* pDevice, uint64_t scratchBudget = sDefaultScratchBudget);
+    DX12AccelerationStructures(const DX12AccelerationStructures&) = delete;
+    DX12AccelerationStructures& operator=(const DX12AccelerationStructures&) = delete;
+    ~DX12AccelerationStructures();
+
+    // true if update would record anything
+    bool isDirty(const DX12Resources& resources, uint64_t completedFence) const noexcept;
+
+    // record builds, compactions and the top level, fence is the fence of pCommandList
+    void update(ID3D12GraphicsCommandList4* pCommandList, DX12UploadBuffer& uploadBuffer,
+        const DX12Resources& resources, uint64_t fence, uint64_t completedFence);
+
+    // 0 until the first top level build
+    D3D12_GPU_VIRTUAL_ADDRESS topLevel() const noexcept;
+    uint32_t instanceCount() const noexcept { return mInstanceCount; }
+    size_t bottomLevelCount() const noexcept { return mBottomLevels.size(); }
+private:
+    // compacted sizes of a batch of builds, read back once its fence completes
+    struct BuildBatch {
+        uint64_t mFence = 0;
+        com_ptr<ID3D12Resource> mReadback;
+        // result of each build, a mesh released and created again is built into another result
+        std::vector<std::pair<MetaID, ID3D12Resource*>> mBuilds;
+    };
+    struct Retired {
+        com_ptr<ID3D12Resource> mResource;
+        uint64_t mFence = 0;
+    };
+
+    void retire(com_ptr<ID3D12Resource> resource, uint64_t fence);
+    ID3D12Resource* scratch(uint64_t size, uint64_t fence);
+    void collectMeshes(const DX12Resources& resources, uint64_t fence);
+    void buildBottomLevels(ID3D12GraphicsCommandList4* pCommandList,
+        const DX12Resources& resources, uint64_t fence);
+    void compactBottomLevels(ID3D12GraphicsCommandList4* pCommandList, uint64_t fence, uint64_t completedFence);
+    void buildTopLevel(ID3D12GraphicsCommandList4* pCommandList, DX12UploadBuffer& uploadBuffer,
+        const DX12Resources& resources, bool refit, uint64_t fence);
+
+    com_ptr<ID3D12Device5> mDevice;
+    uint64_t mScratchBudget = 0;
+    com_ptr<ID3D12Resource> mScratch;
+    // compacted sizes written by the builds of a batch, copied to its readback
+    com_ptr<ID3D12Resource> mPostbuild;
+
+    FlatHashMap<MetaID, DX12BottomLevelAS, MetaIDHash, MetaIDEqual> mBottomLevels;
+    // meshes waiting for their first build
+    std::deque<MetaID> mQueue;
+    std::deque<BuildBatch> mBatches;
+    std::vector<Retired> mRetired;
+    // instances of the last top level build, reused by refits
+    std::vector<D3D12_RAYTRACING_INSTANCE_DESC> mInstances;
+
+    com_ptr<ID3D12Resource> mTopLevel;
+    uint64_t mTopLevelSize = 0;
+    uint32_t mInstanceCount = 0;
+    // rebuilt if set, refit if transforms changed after mTransformVersion
+    bool mInstancesChanged = false;
+    uint64_t mTransformVersion = 0;
+    // contents are scanned for meshes again when their count changes or meshes were not resident
+    size_t mContentCount = 0;
+    bool mMissingMeshes = false;
+};
+
+}
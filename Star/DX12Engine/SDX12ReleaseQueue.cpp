@@ -0,0 +1,52 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "SDX12ReleaseQueue.h"
+
+namespace Star::Graphics::Render {
+
+DX12ReleaseQueue::~DX12ReleaseQueue() = default;
+
+void DX12ReleaseQueue::release(com_ptr<::IUnknown> object) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mRetired.emplace_back(Retired{ std::move(object), mRetireFence });
+}
+
+void DX12ReleaseQueue::advanceFrame(uint64_t nextFence, uint64_t completedFence) {
+    std::deque<Retired> completed;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        // released objects may still be used by every frame submitted so far
+        mRetireFence = nextFence ? nextFence - 1 : 0;
+
+        auto iter = mRetired.begin();
+        while (iter != mRetired.end() && iter->mFence <= completedFence) {
+            ++iter;
+        }
+        completed.insert(completed.end(), std::make_move_iterator(mRetired.begin()),
+            std::make_move_iterator(iter));
+        mRetired.erase(mRetired.begin(), iter);
+    }
+    // final releases run outside the lock
+}
+
+size_t DX12ReleaseQueue::size() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mRetired.size();
+}
+
+}
@@ -0,0 +1,57 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <Star/DX12Engine/SDX12Types.h>
+
+namespace Star::Graphics::Render {
+
+// com objects released while frames in flight may still use them
+// objects released before nextFence are freed once completedFence reaches their fence
+class DX12ReleaseQueue {
+public:
+    DX12ReleaseQueue() = default;
+    DX12ReleaseQueue(const DX12ReleaseQueue&) = delete;
+    DX12ReleaseQueue& operator=(const DX12ReleaseQueue&) = delete;
+    // remaining objects are freed, the gpu is idle by then
+    ~DX12ReleaseQueue();
+
+    template<class T>
+    void release(com_ptr<T>& object) {
+        if (!object)
+            return;
+        com_ptr<::IUnknown> unknown;
+        unknown.attach(object.detach());
+        release(std::move(unknown));
+    }
+    void release(com_ptr<::IUnknown> object);
+
+    void advanceFrame(uint64_t nextFence, uint64_t completedFence);
+
+    size_t size() const;
+private:
+    struct Retired {
+        com_ptr<::IUnknown> mObject;
+        uint64_t mFence;
+    };
+
+    mutable std::mutex mMutex;
+    std::deque<Retired> mRetired;
+    uint64_t mRetireFence = 0;
+};
+
+}
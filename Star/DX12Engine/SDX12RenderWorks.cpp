@@ -18,6 +18,8 @@
 #include "SDX12RenderWorks.h"
 #include "SDX12Types.h"
 #include "SDX12ShaderDescriptorHeap.h"
+#include "SDX12OcclusionCulling.h"
+#include "SDX12ShadowCache.h"
 #include <Star/Graphics/SRenderUtils.h>
 
 namespace Star::Graphics::Render {
@@ -34,62 +36,130 @@ void createRenderSolutionRenderTargets(ID3D12Device* pDevice, IDXGISwapChain3* p
     auto pipelineID = at(solution.mPipelineIndex, pipelineName);
     auto& pipeline = solution.mPipelines.at(pipelineID);
 
+    auto buildResourceDesc = [](const Framebuffer& rt) {
+        D3D12_RESOURCE_DESC desc = {};
+        desc.Dimension = getDX12(rt.mResource.mDimension);
+
+        desc.Alignment = rt.mResource.mAlignment;
+        desc.Width = rt.mResource.mWidth;
+        desc.Height = rt.mResource.mHeight;
+        desc.DepthOrArraySize = rt.mResource.mDepthOrArraySize;
+        desc.MipLevels = rt.mResource.mMipLevels;
+        desc.Format = getDXGIFormat(rt.mResource.mFormat);
+        desc.SampleDesc.Count = rt.mResource.mSampleDesc.mCount;
+        desc.SampleDesc.Quality = rt.mResource.mSampleDesc.mQuality;
+        desc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+        desc.Flags = static_cast<D3D12_RESOURCE_FLAGS>(rt.mResource.mFlags);
+
+        if (desc.Format == DXGI_FORMAT_UNKNOWN) { // skip empty framebuffer
+            throw std::runtime_error("empty render target");
+        }
+
+        if (std::holds_alternative<ClearDepthStencil>(rt.mClear)) {
+            // typeless, depth pyramid reads it through a shader resource view
+            desc.Format = getDX12DepthTypelessFormat(desc.Format);
+        }
+        return desc;
+    };
+
+    // aliased framebuffers share a heap, one region per alias slot
+    std::pmr::vector<D3D12_RESOURCE_ALLOCATION_INFO> slots(rw.get_allocator());
+    for (uint32_t i = rw.mNumBackBuffers; i < solution.mFramebuffers.size(); ++i) {
+        const auto& rt = solution.mFramebuffers[i];
+        if (!rt.mAliasSlot)
+            continue;
+
+        const auto desc = buildResourceDesc(rt);
+        const auto info = pDevice->GetResourceAllocationInfo(0, 1, &desc);
+        if (*rt.mAliasSlot >= slots.size()) {
+            slots.resize(*rt.mAliasSlot + 1, D3D12_RESOURCE_ALLOCATION_INFO{ 0, 0 });
+        }
+        auto& slot = slots[*rt.mAliasSlot];
+        slot.SizeInBytes = std::max(slot.SizeInBytes, info.SizeInBytes);
+        slot.Alignment = std::max(slot.Alignment, info.Alignment);
+    }
+
+    std::pmr::vector<uint64_t> slotOffsets(slots.size(), rw.get_allocator());
+    uint64_t heapSize = 0;
+    uint64_t heapAlignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+    for (size_t s = 0; s != slots.size(); ++s) {
+        heapSize = boost::alignment::align_up(heapSize, slots[s].Alignment);
+        slotOffsets[s] = heapSize;
+        heapSize += slots[s].SizeInBytes;
+        heapAlignment = std::max(heapAlignment, slots[s].Alignment);
+    }
+
+    rw.mFramebufferHeap = nullptr;
+    rw.mFramebufferSize = heapSize;
+    if (heapSize) {
+        D3D12_HEAP_DESC heapDesc{
+            heapSize, CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT), heapAlignment,
+            D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES
+        };
+        V(pDevice->CreateHeap(&heapDesc, IID_PPV_ARGS(rw.mFramebufferHeap.put())));
+    }
+
     for (uint32_t i = 0; i != solution.mFramebuffers.size(); ++i) {
         const auto& rt = solution.mFramebuffers[i];
 
         if (i < rw.mNumBackBuffers) {
-            Expects(!rw.mFramebuffers[i]);
-            V(pSwapChain->GetBuffer(i, IID_PPV_ARGS(rw.mFramebuffers[i].put())));
+            if (pSwapChain) {
+                Expects(!rw.mFramebuffers[i]);
+                V(pSwapChain->GetBuffer(i, IID_PPV_ARGS(rw.mFramebuffers[i].put())));
+            } else {
+                Expects(rw.mFramebuffers[i]);
+            }
             //STAR_SET_DEBUG_NAME(mFramebuffers[i], sc.mName + std::to_string(i));
         } else {
             using namespace Graphics::Render;
 
-            D3D12_RESOURCE_DESC desc = {};
-            desc.Dimension = getDX12(rt.mResource.mDimension);
-
-            desc.Alignment = rt.mResource.mAlignment;
-            desc.Width = rt.mResource.mWidth;
-            desc.Height = rt.mResource.mHeight;
-            desc.DepthOrArraySize = rt.mResource.mDepthOrArraySize;
-            desc.MipLevels = rt.mResource.mMipLevels;
-            desc.Format = getDXGIFormat(rt.mResource.mFormat);
-            desc.SampleDesc.Count = rt.mResource.mSampleDesc.mCount;
-            desc.SampleDesc.Quality = rt.mResource.mSampleDesc.mQuality;
-            desc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
-            desc.Flags = static_cast<D3D12_RESOURCE_FLAGS>(rt.mResource.mFlags);
-            
-            D3D12_HEAP_PROPERTIES heap{
-                D3D12_HEAP_TYPE_DEFAULT, D3D12_CPU_PAGE_PROPERTY_UNKNOWN,
-                D3D12_MEMORY_POOL_UNKNOWN, 1u, 1u
-            };
-        
-            if (desc.Format == DXGI_FORMAT_UNKNOWN) { // skip empty framebuffer
-                throw std::runtime_error("empty render target");
-            }
+            const auto desc = buildResourceDesc(rt);
 
+            D3D12_CLEAR_VALUE clearValue = {};
+            D3D12_RESOURCE_STATES state = {};
             visit(overload(
                 [&](const ClearColor& cv) {
-                    D3D12_CLEAR_VALUE clearValue = {
+                    clearValue = {
                         getDXGIFormat(cv.mClearFormat),
                         { cv.mClearColor.x(), cv.mClearColor.y(), cv.mClearColor.z(), cv.mClearColor.w() }
                     };
-                    V(pDevice->CreateCommittedResource(&heap, D3D12_HEAP_FLAG_NONE,
-                        &desc, D3D12_RESOURCE_STATE_RENDER_TARGET, &clearValue,
-                        IID_PPV_ARGS(rw.mFramebuffers[i].put())));
+                    state = D3D12_RESOURCE_STATE_RENDER_TARGET;
                 },
                 [&](const ClearDepthStencil& cv) {
-                    D3D12_CLEAR_VALUE clearValue = {
-                        getDXGIFormat(cv.mClearFormat),
-                    };
+                    clearValue.Format = getDXGIFormat(cv.mClearFormat);
                     clearValue.DepthStencil = { cv.mDepthClearValue, cv.mStencilClearValue };
-                    V(pDevice->CreateCommittedResource(&heap, D3D12_HEAP_FLAG_NONE,
-                        &desc, D3D12_RESOURCE_STATE_DEPTH_WRITE, &clearValue,
-                        IID_PPV_ARGS(rw.mFramebuffers[i].put())));
+                    state = D3D12_RESOURCE_STATE_DEPTH_WRITE;
                 }
             ), rt.mClear);
+
+            if (rt.mAliasSlot) {
+                V(pDevice->CreatePlacedResource(rw.mFramebufferHeap.get(), slotOffsets[*rt.mAliasSlot],
+                    &desc, state, &clearValue, IID_PPV_ARGS(rw.mFramebuffers[i].put())));
+            } else {
+                D3D12_HEAP_PROPERTIES heap{
+                    D3D12_HEAP_TYPE_DEFAULT, D3D12_CPU_PAGE_PROPERTY_UNKNOWN,
+                    D3D12_MEMORY_POOL_UNKNOWN, 1u, 1u
+                };
+                V(pDevice->CreateCommittedResource(&heap, D3D12_HEAP_FLAG_NONE,
+                    &desc, state, &clearValue, IID_PPV_ARGS(rw.mFramebuffers[i].put())));
+            }
+        }
+        if (i < rw.mNumBackBuffers || !rt.mAliasSlot) {
+            const auto desc = rw.mFramebuffers[i]->GetDesc();
+            rw.mFramebufferSize += pDevice->GetResourceAllocationInfo(0, 1, &desc).SizeInBytes;
         }
     }
 
+#ifdef STAR_DEV
+    {
+        auto msg = std::string("Solution ") + std::string(solutionName)
+            + ": " + std::to_string(solution.mFramebuffers.size()) + " framebuffers, "
+            + std::to_string(rw.mFramebufferSize / (1024 * 1024)) + " MB, aliased heap "
+            + std::to_string(heapSize / (1024 * 1024)) + " MB\n";
+        OutputDebugStringA(msg.c_str());
+    }
+#endif
+
     for (uint32_t i = 0; i != solution.mRTVs.size(); ++i) {
         const auto& rt = rw.mFramebuffers[solution.mRTVSources[i].mHandle];
         const auto& desc0 = solution.mRTVs[i];
@@ -113,6 +183,33 @@ void createRenderSolutionRenderTargets(ID3D12Device* pDevice, IDXGISwapChain3* p
         pDevice->CreateDepthStencilView(ds.get(), &desc, rw.mDSVs.getCpuHandle(i));
     }
 
+    for (auto& pass : pipeline.mPasses) {
+        for (auto& subpass : pass.mGraphicsSubpasses) {
+            if (!subpass.mOcclusionCulling || !subpass.mDepthStencilAttachment)
+                continue;
+            const auto& ds = rw.mFramebuffers[subpass.mDepthStencilAttachment->mFramebuffer.mHandle];
+            createDX12OcclusionPyramid(pDevice, ds.get(), subpass.mOcclusion);
+        }
+    }
+
+    // shadow caches follow the size of their depth stencil, contents are refreshed by the next frame
+    for (auto& pass : pipeline.mPasses) {
+        for (auto& subpass : pass.mGraphicsSubpasses) {
+            if (!subpass.mShadowCaching || !subpass.mDepthStencilAttachment)
+                continue;
+            const auto& attachment = *subpass.mDepthStencilAttachment;
+            const auto& ds = rw.mFramebuffers[attachment.mFramebuffer.mHandle];
+            const auto& desc0 = solution.mDSVs[attachment.mDescriptor.mHandle];
+
+            D3D12_DEPTH_STENCIL_VIEW_DESC desc;
+            desc.Format = getDXGIFormat(desc0.mFormat);
+            desc.ViewDimension = (D3D12_DSV_DIMENSION)desc0.mViewDimension;
+            desc.Flags = (D3D12_DSV_FLAGS)desc0.mFlags;
+            desc.Texture2D = getDX12(desc0.mTexture2D);
+            createDX12ShadowCache(pDevice, ds.get(), desc, attachment.mLoadOp, subpass.mShadowCache);
+        }
+    }
+
     uint32_t cbv_srv_uavIndex = 0;
 
     for (uint32_t i = 0; i != solution.mSRVs.size(); ++i) {
@@ -173,6 +270,7 @@ void createRenderSolutionRenderTargets(ID3D12Device* pDevice, IDXGISwapChain3* p
                             }
 
                             Ensures(offset == dx12List.mCapacity);
+                            pDescriptorHeap->publishPersistent(dx12List.mCpuOffset, dx12List.mCapacity);
 
                             for (const auto& unbounded : dx12List.mUnboundedDescriptors) {
                                 throw std::runtime_error("material resource view list unbounded not supported yet");
@@ -215,6 +313,7 @@ void clearRenderTargets(DX12RenderWorks& rw, DX12ShaderDescriptorHeap* pDescript
 
     for (auto& pass : pipeline.mPasses) {
         for (auto& subpass : pass.mGraphicsSubpasses) {
+            subpass.mOcclusion.mPyramid = nullptr;
             for (auto& collection : subpass.mDescriptors) {
                 for (auto& dx12List : collection.mResourceViewLists) {
                     visit(overload(
@@ -250,6 +349,7 @@ void clearRenderTargets(DX12RenderWorks& rw, DX12ShaderDescriptorHeap* pDescript
     }
 
     rw.mFramebuffers.clear();
+    rw.mFramebufferHeap = nullptr;
 }
 
 }
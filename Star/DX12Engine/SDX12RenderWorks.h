@@ -20,6 +20,7 @@
 
 namespace Star::Graphics::Render {
 
+// back buffers are taken from the swapchain, offscreen buffers are set by the caller without one
 void createRenderSolutionRenderTargets(ID3D12Device* pDevice, IDXGISwapChain3* pSwapChain,
     DX12ShaderDescriptorHeap* pDescriptorHeap, DX12RenderWorks& rw,
     std::string_view solutionName, std::string_view pipelineName);
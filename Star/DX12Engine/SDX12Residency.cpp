@@ -0,0 +1,119 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "SDX12Residency.h"
+
+namespace Star::Graphics::Render {
+
+DX12ResidencyManager::DX12ResidencyManager(ID3D12Device* pDevice, IDXGIAdapter3* pAdapter)
+    : mDevice(pDevice)
+    , mAdapter(pAdapter)
+{}
+
+DX12ResidencyManager::~DX12ResidencyManager() = default;
+
+void DX12ResidencyManager::add(ID3D12Pageable* pPageable, DX12MemoryCategory category, uint64_t size) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto res = mPageables.emplace(pPageable, Pageable{ category, size });
+    Expects(res.second);
+    auto& usage = mUsage[category];
+    usage.mSize += size;
+    ++usage.mCount;
+}
+
+void DX12ResidencyManager::remove(ID3D12Pageable* pPageable) noexcept {
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto iter = mPageables.find(pPageable);
+    if (iter == mPageables.end())
+        return;
+    const auto& pageable = iter->second;
+    auto& usage = mUsage[pageable.mCategory];
+    usage.mSize -= pageable.mSize;
+    if (pageable.mEvicted) {
+        usage.mEvictedSize -= pageable.mSize;
+    }
+    --usage.mCount;
+    mPageables.erase(iter);
+}
+
+void DX12ResidencyManager::use(ID3D12Pageable* pPageable, uint64_t fence) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto& pageable = mPageables.at(pPageable);
+    pageable.mLastUsedFence = std::max(pageable.mLastUsedFence, fence);
+    if (!pageable.mEvicted)
+        return;
+
+    V(mDevice->MakeResident(1, &pPageable));
+    pageable.mEvicted = false;
+    mUsage[pageable.mCategory].mEvictedSize -= pageable.mSize;
+}
+
+void DX12ResidencyManager::setSize(const void* key, DX12MemoryCategory category, uint64_t size) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto iter = mSized.find(key);
+    if (iter != mSized.end()) {
+        mUsage[iter->second.mCategory].mSize -= iter->second.mSize;
+        --mUsage[iter->second.mCategory].mCount;
+        mSized.erase(iter);
+    }
+    if (size) {
+        mSized.emplace(key, Sized{ category, size });
+        mUsage[category].mSize += size;
+        ++mUsage[category].mCount;
+    }
+}
+
+void DX12ResidencyManager::update(uint64_t completedFence) {
+    if (FAILED(mAdapter->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_LOCAL, &mMemoryInfo)))
+        return;
+    if (mMemoryInfo.CurrentUsage <= mMemoryInfo.Budget)
+        return;
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    std::vector<std::pair<ID3D12Pageable* const, Pageable>*> candidates;
+    for (auto& entry : mPageables) {
+        if (!entry.second.mEvicted && entry.second.mLastUsedFence <= completedFence) {
+            candidates.emplace_back(&entry);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const auto* lhs, const auto* rhs) {
+        return lhs->second.mLastUsedFence < rhs->second.mLastUsedFence;
+    });
+
+    // usage is estimated until the next poll
+    auto overcommitted = mMemoryInfo.CurrentUsage - mMemoryInfo.Budget;
+    std::vector<ID3D12Pageable*> evicted;
+    for (auto* pEntry : candidates) {
+        if (!overcommitted)
+            break;
+        auto& pageable = pEntry->second;
+        pageable.mEvicted = true;
+        mUsage[pageable.mCategory].mEvictedSize += pageable.mSize;
+        overcommitted -= std::min(overcommitted, pageable.mSize);
+        evicted.emplace_back(pEntry->first);
+    }
+    if (!evicted.empty()) {
+        V(mDevice->Evict(gsl::narrow_cast<uint32_t>(evicted.size()), evicted.data()));
+    }
+}
+
+DX12MemoryUsage DX12ResidencyManager::usage(DX12MemoryCategory category) const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mUsage[category];
+}
+
+}
@@ -0,0 +1,89 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <Star/DX12Engine/SDX12Types.h>
+
+namespace Star::Graphics::Render {
+
+enum DX12MemoryCategory : uint32_t {
+    DX12MeshMemory,
+    DX12TextureMemory,
+    DX12FramebufferMemory,
+    DX12UploadMemory,
+    DX12MemoryCategoryCount,
+};
+
+struct DX12MemoryUsage {
+    uint64_t mSize = 0;
+    uint64_t mEvictedSize = 0;
+    uint32_t mCount = 0;
+};
+
+// video memory of the engine by category, polled against the budget of the adapter
+// pageables are evicted once no frame in flight uses them and the budget is exceeded,
+// coldest first, and made resident again by their next use
+// sized owners are only counted, their memory is in use every frame
+class DX12ResidencyManager {
+public:
+    DX12ResidencyManager(ID3D12Device* pDevice, IDXGIAdapter3* pAdapter);
+    DX12ResidencyManager(const DX12ResidencyManager&) = delete;
+    DX12ResidencyManager& operator=(const DX12ResidencyManager&) = delete;
+    ~DX12ResidencyManager();
+
+    void add(ID3D12Pageable* pPageable, DX12MemoryCategory category, uint64_t size);
+    void remove(ID3D12Pageable* pPageable) noexcept;
+    // used by frames up to fence, blocks until the pageable is resident if it was evicted
+    void use(ID3D12Pageable* pPageable, uint64_t fence);
+
+    // memory owned by the key, 0 stops counting it
+    void setSize(const void* key, DX12MemoryCategory category, uint64_t size);
+
+    // poll the budget and evict pageables unused since completedFence while it is exceeded
+    void update(uint64_t completedFence);
+
+    // adapter of the device enumerated again, e.g. after adapters changed
+    void setAdapter(IDXGIAdapter3* pAdapter) noexcept {
+        mAdapter = pAdapter;
+    }
+
+    DX12MemoryUsage usage(DX12MemoryCategory category) const;
+    const DXGI_QUERY_VIDEO_MEMORY_INFO& memoryInfo() const noexcept {
+        return mMemoryInfo;
+    }
+private:
+    struct Pageable {
+        DX12MemoryCategory mCategory;
+        uint64_t mSize = 0;
+        uint64_t mLastUsedFence = 0;
+        bool mEvicted = false;
+    };
+    struct Sized {
+        DX12MemoryCategory mCategory;
+        uint64_t mSize = 0;
+    };
+
+    ID3D12Device* mDevice = nullptr;
+    IDXGIAdapter3* mAdapter = nullptr;
+    mutable std::mutex mMutex;
+    std::unordered_map<ID3D12Pageable*, Pageable> mPageables;
+    std::unordered_map<const void*, Sized> mSized;
+    std::array<DX12MemoryUsage, DX12MemoryCategoryCount> mUsage = {};
+    DXGI_QUERY_VIDEO_MEMORY_INFO mMemoryInfo = {};
+};
+
+}
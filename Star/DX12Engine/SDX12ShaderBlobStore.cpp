@@ -0,0 +1,99 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "SDX12ShaderBlobStore.h"
+#include <Star/Graphics/SShaderBlobFile.h>
+
+namespace Star::Graphics::Render {
+
+namespace {
+
+bool hasInlineBytecode(const ShaderProgramData& data) noexcept {
+    return !data.mVS.empty() || !data.mHS.empty() || !data.mDS.empty() ||
+        !data.mGS.empty() || !data.mPS.empty();
+}
+
+}
+
+DX12ShaderBlobStore::DX12ShaderBlobStore(std::filesystem::path filename)
+    : mFilename(std::move(filename))
+{}
+
+DX12ShaderBlobStore::~DX12ShaderBlobStore() = default;
+
+std::shared_ptr<const MappedFile> DX12ShaderBlobStore::map() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto mapping = mMapping.lock();
+    if (!mapping) {
+        auto file = std::make_shared<const MappedFile>(mFilename);
+        validateShaderBlobFile(file->data(), file->size());
+        mapping = std::move(file);
+        mMapping = mapping;
+    }
+    return mapping;
+}
+
+bool DX12ShaderBlobStore::mapped() const noexcept {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return !mMapping.expired();
+}
+
+void DX12ShaderBlobStore::getProgram(const ShaderProgramData& data, DX12ShaderProgramData& program) {
+    program = {};
+    if (hasInlineBytecode(data)) {
+        auto buffer = std::make_shared<std::string>();
+        buffer->reserve(data.mVS.size() + data.mHS.size() + data.mDS.size() + data.mGS.size() + data.mPS.size());
+        size_t offsets[5] = {};
+        size_t i = 0;
+        for (const auto* stage : { &data.mVS, &data.mHS, &data.mDS, &data.mGS, &data.mPS }) {
+            offsets[i++] = buffer->size();
+            buffer->append(*stage);
+        }
+        auto view = [&](const std::pmr::string& stage, size_t offset) {
+            return stage.empty() ? D3D12_SHADER_BYTECODE{} : D3D12_SHADER_BYTECODE{ buffer->data() + offset, stage.size() };
+        };
+        program.mVS = view(data.mVS, offsets[0]);
+        program.mHS = view(data.mHS, offsets[1]);
+        program.mDS = view(data.mDS, offsets[2]);
+        program.mGS = view(data.mGS, offsets[3]);
+        program.mPS = view(data.mPS, offsets[4]);
+        program.mBytes = std::move(buffer);
+        return;
+    }
+    if (!data.mVSBlob.mSize && !data.mHSBlob.mSize && !data.mDSBlob.mSize &&
+        !data.mGSBlob.mSize && !data.mPSBlob.mSize) {
+        return;
+    }
+
+    auto mapping = map();
+    auto view = [&](const ShaderBlobRange& range) {
+        if (!range.mSize) {
+            return D3D12_SHADER_BYTECODE{};
+        }
+        return D3D12_SHADER_BYTECODE{
+            getShaderBlob(mapping->data(), mapping->size(), range), gsl::narrow<size_t>(range.mSize)
+        };
+    };
+    program.mVS = view(data.mVSBlob);
+    program.mHS = view(data.mHSBlob);
+    program.mDS = view(data.mDSBlob);
+    program.mGS = view(data.mGSBlob);
+    program.mPS = view(data.mPSBlob);
+    program.mBytes = std::move(mapping);
+}
+
+}
@@ -0,0 +1,48 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <Star/DX12Engine/SDX12Types.h>
+#include <Star/SMappedFile.h>
+#include <filesystem>
+#include <mutex>
+
+namespace Star::Graphics::Render {
+
+// maps the shader blob file of the library, psos are created from the mapping without copies
+// the mapping is shared by the programs viewing it and unmapped when the last of them is released,
+// it is mapped again when later shaders are created
+class DX12ShaderBlobStore {
+public:
+    explicit DX12ShaderBlobStore(std::filesystem::path filename);
+    DX12ShaderBlobStore(const DX12ShaderBlobStore&) = delete;
+    DX12ShaderBlobStore& operator=(const DX12ShaderBlobStore&) = delete;
+    ~DX12ShaderBlobStore();
+
+    // stages with bytecode in the shader data are copied into one buffer, libraries built before the blob file
+    void getProgram(const ShaderProgramData& data, DX12ShaderProgramData& program);
+
+    bool mapped() const noexcept;
+private:
+    std::shared_ptr<const MappedFile> map();
+
+    std::filesystem::path mFilename;
+    mutable std::mutex mMutex;
+    std::weak_ptr<const MappedFile> mMapping;
+};
+
+}
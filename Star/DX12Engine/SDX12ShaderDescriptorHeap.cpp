@@ -18,38 +18,74 @@
 #include "pch.h"
 #include "SDX12ShaderDescriptorHeap.h"
 #include "SDX12Helpers.h"
+#include <Star/Core/SCounters.h>
 
 namespace Star::Graphics::Render {
 
 DX12ShaderDescriptorHeap::DX12ShaderDescriptorHeap(ID3D12Device* pDevice,
     const Desc& desc, const allocator_type& alloc)
-    : mHeap(pDevice, D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE, desc.mCapacity)
-    , mPool(desc.mBlockSize, desc.mCapacity, alloc)
-    , mCircular(desc.mCapacity, desc.mCicularReserve,
+    : mDevice(pDevice)
+    , mCapacity(gsl::narrow_cast<uint32_t>(boost::alignment::align_up(desc.mCapacity, desc.mBlockSize)))
+    , mFrameSize(desc.mFrameSize)
+    , mHeap(pDevice, D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE,
+        mCapacity + desc.mBindlessCapacity + desc.mCircularSpillCapacity)
+    , mShadow(pDevice, D3D12_DESCRIPTOR_HEAP_FLAG_NONE, mCapacity + desc.mBindlessCapacity)
+    , mPool(desc.mBlockSize, mCapacity, alloc)
+    , mCircular(mCapacity, desc.mCicularReserve,
         &mPool, desc.mFrameSize, desc.mBlockSize, alloc)
-    , mPersistent(desc.mCapacity, &mPool, desc.mFrameSize, desc.mBlockSize,
+    , mSpillBase(mCapacity + desc.mBindlessCapacity)
+    , mSpillPool(desc.mBlockSize, desc.mCircularSpillCapacity, alloc)
+    , mSpill(desc.mCircularSpillCapacity, 0, &mSpillPool, desc.mFrameSize, desc.mBlockSize, alloc)
+    , mPersistent(mCapacity, &mPool, desc.mFrameSize, desc.mBlockSize,
         desc.mMaxPersistentRangeSize, alloc)
     , mMonotonic(&mPool, alloc)
-{}
+    , mBindlessCapacity(desc.mBindlessCapacity)
+    , mBindlessRetired(desc.mFrameSize)
+{
+    Core::Counters::set(Core::Gauge::ShaderDescriptorCapacity, mCapacity);
+}
 
 DX12ShaderDescriptorRange DX12ShaderDescriptorHeap::allocateCircular(uint32_t count) {
-    auto range = mCircular.allocate(count);
+    std::pair<uint32_t, uint32_t> range;
+    {
+        std::lock_guard<std::mutex> guard(mCircularMutex);
+        range = mCircular.try_allocate(count);
+        if (range.first == range.second) {
+            range = mSpill.try_allocate(count);
+            if (range.first == range.second) {
+                throw std::runtime_error("not enough circular descriptor");
+            }
+            if (!mSpilled) {
+                mSpilled = true;
+                OutputDebugStringA("WARNING: circular descriptors spilled, shader descriptor heap grows before the next frame\n");
+            }
+            range.first += mSpillBase;
+            range.second += mSpillBase;
+        }
+    }
     Ensures(range.first != range.second);
+    Core::Counters::add(Core::Counter::DescriptorAllocations, count);
 
     return { mHeap[range.first], mHeap[range.second], mHeap.getDescriptorSize() };
 }
 
 DX12ShaderDescriptorRange DX12ShaderDescriptorHeap::allocatePersistent(uint32_t count) {
     Expects(count);
-    auto range = mPersistent.allocate(count);
+    auto range = mPersistent.try_allocate(count);
+    if (range.first == range.second) {
+        grow(mCapacity + std::max(mCapacity / 2, mPool.getBlockSize()));
+        range = mPersistent.allocate(count);
+    }
     Ensures(range.first != range.second);
+    Core::Counters::add(Core::Counter::DescriptorAllocations, count);
 
-    return { mHeap[range.first], mHeap[range.second], mHeap.getDescriptorSize() };
+    return getPersistentRange(range.first, range.second);
 }
 
 DX12ShaderDescriptorRange DX12ShaderDescriptorHeap::allocateMonotonic(uint32_t count) {
     auto range = mMonotonic.allocate(count);
     Ensures(range.first != range.second);
+    Core::Counters::add(Core::Counter::DescriptorAllocations, count);
 
     return { mHeap[range.first], mHeap[range.second], mHeap.getDescriptorSize() };
 }
@@ -58,12 +94,194 @@ void DX12ShaderDescriptorHeap::deallocatePersistent(
     D3D12_CPU_DESCRIPTOR_HANDLE curr, uint32_t count
 ) noexcept {
     Expects(count);
-    mPersistent.deallocate(mHeap.getIndex(curr), count);
+    auto index = getShadowIndex(curr);
+    Expects(index < mCapacity);
+    mPersistent.deallocate(index, count);
+}
+
+void DX12ShaderDescriptorHeap::publishPersistent(
+    D3D12_CPU_DESCRIPTOR_HANDLE curr, uint32_t count
+) const noexcept {
+    Expects(count);
+    auto index = getShadowIndex(curr);
+    if (index == UINT32_MAX)
+        return;
+
+    // owners not relocated yet write to the shadow of the replaced heap
+    auto shadow = mShadow.getCpuHandle(index);
+    if (shadow.ptr != curr.ptr) {
+        mDevice->CopyDescriptorsSimple(count, shadow, curr, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    }
+    mDevice->CopyDescriptorsSimple(count, mHeap.getCpuHandle(index),
+        shadow, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+}
+
+uint32_t DX12ShaderDescriptorHeap::getShadowIndex(D3D12_CPU_DESCRIPTOR_HANDLE curr) const noexcept {
+    auto contains = [curr](const DescriptorArray& shadow) {
+        const auto begin = shadow.cpu_begin().ptr;
+        const auto end = begin + size_t(shadow.size()) * shadow.getDescriptorSize();
+        return curr.ptr >= begin && curr.ptr < end;
+    };
+    if (contains(mShadow))
+        return mShadow.getIndex(curr);
+
+    for (const auto& retired : mRetiredHeaps) {
+        if (!contains(retired.mShadow))
+            continue;
+        auto index = retired.mShadow.getIndex(curr);
+        if (index < retired.mCapacity)
+            return index;
+        return mCapacity + (index - retired.mCapacity);
+    }
+    return UINT32_MAX;
+}
+
+uint32_t DX12ShaderDescriptorHeap::compactPersistent(uint32_t maxMoves,
+    std::pmr::vector<DX12ShaderDescriptorRelocation>& relocations
+) {
+    std::pmr::vector<Graphics::PersistentDescriptorRelocation> moves(relocations.get_allocator().resource());
+    auto count = mPersistent.compact(maxMoves, moves);
+
+    relocations.reserve(relocations.size() + moves.size());
+    for (const auto& move : moves) {
+        // frames in flight keep reading the source until it is released
+        mDevice->CopyDescriptorsSimple(move.mCount, mShadow.getCpuHandle(move.mTarget),
+            mShadow.getCpuHandle(move.mSource), D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+        mDevice->CopyDescriptorsSimple(move.mCount, mHeap.getCpuHandle(move.mTarget),
+            mShadow.getCpuHandle(move.mTarget), D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+        relocations.emplace_back(DX12ShaderDescriptorRelocation{
+            getPersistentRange(move.mSource, move.mSource + move.mCount),
+            getPersistentRange(move.mTarget, move.mTarget + move.mCount),
+        });
+    }
+    return count;
+}
+
+void DX12ShaderDescriptorHeap::grow(uint32_t capacity) {
+    capacity = gsl::narrow_cast<uint32_t>(boost::alignment::align_up(capacity, mPool.getBlockSize()));
+    if (capacity <= mCapacity)
+        return;
+
+    const auto spillCapacity = mHeap.size() - mSpillBase;
+    DescriptorArray heap(mDevice, D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE,
+        capacity + mBindlessCapacity + spillCapacity);
+    DescriptorArray shadow(mDevice, D3D12_DESCRIPTOR_HEAP_FLAG_NONE, capacity + mBindlessCapacity);
+
+    // pooled descriptors keep their index, circular ones are rewritten by every frame
+    // frames in flight keep reading the replaced heap
+    mDevice->CopyDescriptorsSimple(mCapacity, shadow.getCpuHandle(0),
+        mShadow.getCpuHandle(0), D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    mDevice->CopyDescriptorsSimple(mCapacity, heap.getCpuHandle(0),
+        shadow.getCpuHandle(0), D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    if (mBindlessCapacity) {
+        mDevice->CopyDescriptorsSimple(mBindlessCapacity, shadow.getCpuHandle(capacity),
+            mShadow.getCpuHandle(mCapacity), D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+        mDevice->CopyDescriptorsSimple(mBindlessCapacity, heap.getCpuHandle(capacity),
+            shadow.getCpuHandle(capacity), D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    }
+
+    mRetiredHeaps.emplace_back(RetiredHeap{ std::move(mHeap), std::move(mShadow), mCapacity });
+    mHeap = std::move(heap);
+    mShadow = std::move(shadow);
+    mCapacity = capacity;
+    mSpillBase = mCapacity + mBindlessCapacity;
+
+    mPool.grow(mCapacity);
+    {
+        std::lock_guard<std::mutex> guard(mCircularMutex);
+        mCircular.grow(mCapacity);
+    }
+    Core::Counters::set(Core::Gauge::ShaderDescriptorCapacity, mCapacity);
+}
+
+void DX12ShaderDescriptorHeap::reserveSpilled() {
+    uint32_t spilled = 0;
+    {
+        std::lock_guard<std::mutex> guard(mCircularMutex);
+        spilled = mSpill.statistics().mDescriptorCount;
+    }
+    if (spilled) {
+        // the circular pool takes the spilled blocks from the grown pool
+        grow(mCapacity + std::max(mCapacity / 2, spilled));
+    }
+}
+
+bool DX12ShaderDescriptorHeap::takeGrowthRelocations(
+    std::pmr::vector<DX12ShaderDescriptorRelocation>& relocations
+) {
+    bool taken = false;
+    for (auto& retired : mRetiredHeaps) {
+        if (retired.mRelocated)
+            continue;
+
+        auto getRetiredRange = [&](uint32_t begin, uint32_t end) {
+            return DX12ShaderDescriptorRange{
+                { retired.mShadow.getCpuHandle(begin), retired.mHeap.getGpuHandle(begin) },
+                { retired.mShadow.getCpuHandle(end), retired.mHeap.getGpuHandle(end) },
+                mHeap.getDescriptorSize()
+            };
+        };
+        // heaps replaced by several growths are relocated to the current heap directly
+        relocations.emplace_back(DX12ShaderDescriptorRelocation{
+            getRetiredRange(0, retired.mCapacity),
+            getPersistentRange(0, retired.mCapacity),
+        });
+        if (mBindlessCapacity) {
+            relocations.emplace_back(DX12ShaderDescriptorRelocation{
+                getRetiredRange(retired.mCapacity, retired.mCapacity + mBindlessCapacity),
+                getBindlessRange(),
+            });
+        }
+        retired.mRelocated = true;
+        retired.mFrames = mFrameSize;
+        taken = true;
+    }
+    return taken;
+}
+
+uint32_t DX12ShaderDescriptorHeap::allocateBindless() {
+    std::lock_guard<std::mutex> guard(mBindlessMutex);
+    if (!mBindlessFree.empty()) {
+        auto index = mBindlessFree.back();
+        mBindlessFree.pop_back();
+        return index;
+    }
+    if (mBindlessCount == mBindlessCapacity) {
+        throw std::runtime_error("not enough bindless descriptor");
+    }
+    return mBindlessCount++;
+}
+
+void DX12ShaderDescriptorHeap::deallocateBindless(uint32_t index) noexcept {
+    std::lock_guard<std::mutex> guard(mBindlessMutex);
+    Expects(index < mBindlessCount);
+    mBindlessRetired[mBindlessFrame].emplace_back(index);
 }
 
 void DX12ShaderDescriptorHeap::advanceFrame() {
-    mCircular.advanceFrame();
+    {
+        std::lock_guard<std::mutex> guard(mCircularMutex);
+        mCircular.advanceFrame();
+        mSpill.advanceFrame();
+    }
     mPersistent.advanceFrame();
+
+    for (auto& retired : mRetiredHeaps) {
+        if (retired.mRelocated && retired.mFrames) {
+            --retired.mFrames;
+        }
+    }
+    mRetiredHeaps.erase(std::remove_if(mRetiredHeaps.begin(), mRetiredHeaps.end(),
+        [](const RetiredHeap& retired) {
+            return retired.mRelocated && retired.mFrames == 0;
+        }), mRetiredHeaps.end());
+    Core::Counters::set(Core::Gauge::ShaderDescriptorsFree, getFreeCount());
+
+    std::lock_guard<std::mutex> guard(mBindlessMutex);
+    mBindlessFrame = (mBindlessFrame + 1) % gsl::narrow_cast<uint32_t>(mBindlessRetired.size());
+    auto& retired = mBindlessRetired[mBindlessFrame];
+    mBindlessFree.insert(mBindlessFree.end(), retired.begin(), retired.end());
+    retired.clear();
 }
 
 }
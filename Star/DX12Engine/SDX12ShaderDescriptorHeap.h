@@ -39,6 +39,15 @@ struct DX12ShaderDescriptorRange {
     uint32_t mDescriptorSize = 0;
 };
 
+// persistent descriptors moved by compaction or growth, owners must switch to the target
+// handles inside the source range keep their offset in the target
+struct DX12ShaderDescriptorRelocation {
+    DX12ShaderDescriptorRange mSource;
+    DX12ShaderDescriptorRange mTarget;
+};
+
+// persistent and bindless descriptors are written to a cpu only shadow and published to the
+// shader visible heap, so compaction and growth can copy them
 class DX12ShaderDescriptorHeap {
 public:
     using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
@@ -52,16 +61,69 @@ public:
         uint32_t mFrameSize = 3;
         uint32_t mBlockSize = 64;
         uint32_t mMaxPersistentRangeSize = 8;
+        // circular descriptors allocated when the pool has no block left, placed last
+        uint32_t mCircularSpillCapacity = 0;
+        // texture srvs indexed by shaders, placed after the pooled descriptors
+        uint32_t mBindlessCapacity = 0;
     };
 
     DX12ShaderDescriptorHeap(ID3D12Device* pDevice,
         const Desc& desc, const allocator_type& alloc);
 
     DX12ShaderDescriptorRange allocateCircular(uint32_t count);
+    // grows the heap if the pool has no block left, see takeGrowthRelocations
     DX12ShaderDescriptorRange allocatePersistent(uint32_t count);
     DX12ShaderDescriptorRange allocateMonotonic(uint32_t count);
 
     void deallocatePersistent(D3D12_CPU_DESCRIPTOR_HANDLE curr, uint32_t count) noexcept;
+    // copies shadow descriptors to the shader visible heap, other handles are written in place
+    void publishPersistent(D3D12_CPU_DESCRIPTOR_HANDLE curr, uint32_t count) const noexcept;
+    // moves up to maxMoves vectors out of sparse blocks, sources are released after mFrameSize frames
+    uint32_t compactPersistent(uint32_t maxMoves, std::pmr::vector<DX12ShaderDescriptorRelocation>& relocations);
+
+    // grows the pool between frames by the circular descriptors the last frame spilled
+    void reserveSpilled();
+    // heaps replaced by growth, owners must be relocated before frames bind the new heap
+    // replaced heaps are released mFrameSize frames after their relocations are taken
+    bool takeGrowthRelocations(std::pmr::vector<DX12ShaderDescriptorRelocation>& relocations);
+    uint32_t getCapacity() const noexcept {
+        return mCapacity;
+    }
+    uint32_t getFreeCount() const noexcept {
+        return mPool.getFreeBlockCount() * mPool.getBlockSize();
+    }
+
+    // usage of the last frame
+    Graphics::CircularDescriptorStatistics circularStatistics() noexcept {
+        std::lock_guard<std::mutex> guard(mCircularMutex);
+        return mCircular.statistics();
+    }
+    Graphics::CircularDescriptorStatistics spillStatistics() noexcept {
+        std::lock_guard<std::mutex> guard(mCircularMutex);
+        return mSpill.statistics();
+    }
+
+    Graphics::DescriptorPoolStatistics statistics() const {
+        return mPool.statistics();
+    }
+    void persistentStatistics(std::pmr::vector<Graphics::PersistentDescriptorBinStatistics>& bins) const {
+        mPersistent.statistics(bins);
+    }
+
+    // bindless slots are reused mFrameSize frames after deallocation
+    uint32_t allocateBindless();
+    void deallocateBindless(uint32_t index) noexcept;
+    uint32_t getBindlessCapacity() const noexcept {
+        return mBindlessCapacity;
+    }
+    // moves when the heap grows, handles are relocated like persistent descriptors
+    DX12ShaderDescriptorRange getBindlessRange() const noexcept {
+        return getPersistentRange(mCapacity, mCapacity + mBindlessCapacity);
+    }
+    DX12DescriptorHandle getBindless(uint32_t index) const noexcept {
+        Expects(index < mBindlessCapacity);
+        return { mShadow.getCpuHandle(mCapacity + index), mHeap.getGpuHandle(mCapacity + index) };
+    }
     void advanceFrame();
     DX12DescriptorHandle advance(const DX12DescriptorHandle& prev, size_t sz) const noexcept {
         return DX12DescriptorHandle{
@@ -73,11 +135,52 @@ public:
         return mHeap.get();
     }
 private:
-    DX12DescriptorArray<D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV> mHeap;
+    using DescriptorArray = DX12DescriptorArray<D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV>;
+
+    // heap replaced by growth, pooled descriptors keep their index, bindless follow the pool
+    struct RetiredHeap {
+        DescriptorArray mHeap;
+        DescriptorArray mShadow;
+        uint32_t mCapacity = 0;
+        bool mRelocated = false;
+        uint32_t mFrames = 0;
+    };
+
+    DX12ShaderDescriptorRange getPersistentRange(uint32_t begin, uint32_t end) const noexcept {
+        return {
+            { mShadow.getCpuHandle(begin), mHeap.getGpuHandle(begin) },
+            { mShadow.getCpuHandle(end), mHeap.getGpuHandle(end) },
+            mHeap.getDescriptorSize()
+        };
+    }
+    void grow(uint32_t capacity);
+    // index in the current shadow of a handle allocated before growth, UINT32_MAX if unknown
+    uint32_t getShadowIndex(D3D12_CPU_DESCRIPTOR_HANDLE curr) const noexcept;
+
+    ID3D12Device* mDevice = nullptr;
+    uint32_t mCapacity = 0;
+    uint32_t mFrameSize = 0;
+    DescriptorArray mHeap;
+    DescriptorArray mShadow;
+    std::vector<RetiredHeap> mRetiredHeaps;
     Graphics::DescriptorPool mPool;
+    std::mutex mCircularMutex; // circular descriptors are allocated by frame recorders
     Graphics::CircularDescriptorPool mCircular;
+    // Spill
+    uint32_t mSpillBase = 0;
+    bool mSpilled = false;
+    Graphics::DescriptorPool mSpillPool;
+    Graphics::CircularDescriptorPool mSpill;
     Graphics::PersistentDescriptorPool mPersistent;
     Graphics::MonotonicDescriptorPool mMonotonic;
+
+    // Bindless
+    uint32_t mBindlessCapacity = 0;
+    uint32_t mBindlessCount = 0;
+    uint32_t mBindlessFrame = 0;
+    std::mutex mBindlessMutex;
+    std::vector<uint32_t> mBindlessFree;
+    std::vector<std::vector<uint32_t>> mBindlessRetired;
 };
 
 //PRINT_SIZE(DX12ShaderDescriptorHeap);
@@ -0,0 +1,143 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "SDX12ShaderReload.h"
+#include "SDX12Utils.h"
+#include "SDX12ReleaseQueue.h"
+#include "SDX12PipelineCompiler.h"
+#include <Star/Core/SManagerFwd.h>
+
+namespace Star::Graphics::Render {
+
+namespace {
+
+// materials and draw packets hold the live subpasses, only their psos can be replaced
+bool isSameLayout(const DX12ShaderData& lhs, const DX12ShaderData& rhs) {
+    if (lhs.mSolutions.size() != rhs.mSolutions.size() || lhs.mSolutionIndex != rhs.mSolutionIndex)
+        return false;
+    for (auto&& [solution, solution1] : boost::combine(lhs.mSolutions, rhs.mSolutions)) {
+        if (solution.mPipelines.size() != solution1.mPipelines.size() ||
+            solution.mPipelineIndex != solution1.mPipelineIndex)
+            return false;
+        for (auto&& [pipeline, pipeline1] : boost::combine(solution.mPipelines, solution1.mPipelines)) {
+            if (pipeline.mQueues.size() != pipeline1.mQueues.size() ||
+                pipeline.mQueueIndex.size() != pipeline1.mQueueIndex.size())
+                return false;
+            for (auto&& [queue, queue1] : boost::combine(pipeline.mQueues, pipeline1.mQueues)) {
+                if (queue.mLevels.size() != queue1.mLevels.size())
+                    return false;
+                for (auto&& [level, level1] : boost::combine(queue.mLevels, queue1.mLevels)) {
+                    if (level.mPasses.size() != level1.mPasses.size() || level.mPassIndex != level1.mPassIndex)
+                        return false;
+                    for (auto&& [variant, variant1] : boost::combine(level.mPasses, level1.mPasses)) {
+                        if (variant.mSubpasses.size() != variant1.mSubpasses.size())
+                            return false;
+                        for (auto&& [subpass, subpass1] : boost::combine(variant.mSubpasses, variant1.mSubpasses)) {
+                            if (subpass.mStates.size() != subpass1.mStates.size() ||
+                                subpass.mVertexLayoutIndex != subpass1.mVertexLayoutIndex ||
+                                subpass.mConstantBuffers.size() != subpass1.mConstantBuffers.size() ||
+                                subpass.mDescriptors.size() != subpass1.mDescriptors.size() ||
+                                subpass.mBackfaceCulling != subpass1.mBackfaceCulling)
+                                return false;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// failed psos keep the previous ones
+void swapDX12PipelineStates(DX12ReleaseQueue& releaseQueue, DX12ShaderData& shader, DX12ShaderData& staging) {
+    for (auto&& [solution, solution1] : boost::combine(shader.mSolutions, staging.mSolutions)) {
+        for (auto&& [pipeline, pipeline1] : boost::combine(solution.mPipelines, solution1.mPipelines)) {
+            for (auto&& [queue, queue1] : boost::combine(pipeline.mQueues, pipeline1.mQueues)) {
+                for (auto&& [level, level1] : boost::combine(queue.mLevels, queue1.mLevels)) {
+                    for (auto&& [variant, variant1] : boost::combine(level.mPasses, level1.mPasses)) {
+                        for (auto&& [subpass, subpass1] : boost::combine(variant.mSubpasses, variant1.mSubpasses)) {
+                            for (auto&& [state, state1] : boost::combine(subpass.mStates, subpass1.mStates)) {
+                                if (!state1.mObject)
+                                    continue;
+                                // frames in flight may still use the previous pso
+                                releaseQueue.release(state.mObject);
+                                state.mObject = std::move(state1.mObject);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+    shader.mShaderData = std::move(staging.mShaderData);
+}
+
+}
+
+void DX12ShaderReloadQueue::enqueue(const MetaID& metaID) {
+    if (std::find(mPending.begin(), mPending.end(), metaID) == mPending.end()) {
+        mPending.emplace_back(metaID);
+    }
+}
+
+bool DX12ShaderReloadQueue::update(CreationContext& context, DX12Resources& resources) {
+    bool swapped = false;
+    // compilations finish out of order, reloads are swapped together once none is pending
+    if (!mCompiling.empty() && (!context.mPipelineCompiler || !context.mPipelineCompiler->pendingCount())) {
+        for (auto& reload : mCompiling) {
+            auto handle = resources.mShaders.find(reload.mMetaID);
+            if (!handle)
+                continue;
+            auto& shader = resources.mShaders[handle];
+            if (!isSameLayout(shader, *reload.mStaging)) {
+                OutputDebugStringA("WARNING: reloaded shader changed its passes or bindings, restart to apply it\n");
+                continue;
+            }
+            swapDX12PipelineStates(*context.mReleaseQueue, shader, *reload.mStaging);
+            swapped = true;
+        }
+        mCompiling.clear();
+    }
+
+    if (mPending.empty())
+        return swapped;
+
+    auto rg = resources.mRenderGraphs.find(context.mRenderGraph);
+    Expects(rg != resources.mRenderGraphs.end());
+    for (const auto& metaID : mPending) {
+        auto handle = resources.mShaders.find(metaID);
+        if (!handle || resources.mShaders[handle].mSolutions.empty()) {
+            // created later from the rewritten data
+            continue;
+        }
+        auto& shader = resources.mShaders[handle];
+
+        // the previous data is not read anymore, the rewritten file replaces it
+        shader.mShaderData.reset();
+        Core::Workflow::reload(metaID, Core::Shader);
+
+        auto& reload = mCompiling.emplace_back();
+        reload.mMetaID = metaID;
+        reload.mStaging = std::make_unique<DX12ShaderData>(metaID, std::pmr::get_default_resource());
+        reload.mStaging->mShaderData.reset(metaID, false);
+        createDX12ShaderResources(context, *rg, *reload.mStaging);
+    }
+    mPending.clear();
+    return swapped;
+}
+
+}
@@ -0,0 +1,54 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <Star/DX12Engine/SDX12Types.h>
+
+namespace Star::Graphics::Render {
+
+struct CreationContext;
+
+// shaders rewritten in the library are read again and their psos compiled beside the live ones
+// frames keep drawing with the previous psos until every pso of the reload is compiled,
+// then they are swapped in place, draw packets keep pointing at the same pipeline states
+class DX12ShaderReloadQueue {
+public:
+    DX12ShaderReloadQueue() = default;
+    DX12ShaderReloadQueue(const DX12ShaderReloadQueue&) = delete;
+    DX12ShaderReloadQueue& operator=(const DX12ShaderReloadQueue&) = delete;
+
+    bool empty() const noexcept {
+        return mPending.empty() && mCompiling.empty();
+    }
+
+    void enqueue(const MetaID& metaID);
+
+    // swaps compiled reloads in, then reads pending shaders and compiles their psos
+    // shaders never created are skipped, returns true if draw packets must resolve their psos again
+    bool update(CreationContext& context, DX12Resources& resources);
+private:
+    struct Reload {
+        MetaID mMetaID;
+        // psos swapped in once compiled, compilations hold its pipeline states until then
+        std::unique_ptr<DX12ShaderData> mStaging;
+    };
+
+    std::vector<MetaID> mPending;
+    std::vector<Reload> mCompiling;
+};
+
+}
@@ -0,0 +1,142 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "SDX12ShadowCache.h"
+#include "SDX12Culling.h"
+#include <Star/Core/SCounters.h>
+
+namespace Star::Graphics::Render {
+
+void createDX12ShadowCache(ID3D12Device* pDevice, ID3D12Resource* pDepthStencil,
+    const D3D12_DEPTH_STENCIL_VIEW_DESC& viewDesc, const LoadOp& loadOp, DX12ShadowCache& cache
+) {
+    cache.mValid = false;
+    cache.mClearFlags = D3D12_CLEAR_FLAG_DEPTH;
+    switch (viewDesc.Format) {
+    case DXGI_FORMAT_D32_FLOAT_S8X24_UINT:
+    case DXGI_FORMAT_D24_UNORM_S8_UINT:
+        cache.mClearFlags |= D3D12_CLEAR_FLAG_STENCIL;
+        break;
+    default:
+        break;
+    }
+    if (const auto* pClear = std::get_if<ClearDepthStencil>(&loadOp)) {
+        cache.mClearDepth = pClear->mDepthClearValue;
+        cache.mClearStencil = pClear->mStencilClearValue;
+    }
+
+    D3D12_CLEAR_VALUE clear{ viewDesc.Format };
+    clear.DepthStencil = { cache.mClearDepth, cache.mClearStencil };
+    const auto desc = pDepthStencil->GetDesc();
+    cache.mDepthStencil = nullptr;
+    V(pDevice->CreateCommittedResource(
+        &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
+        D3D12_HEAP_FLAG_NONE,
+        &desc,
+        D3D12_RESOURCE_STATE_COPY_SOURCE,
+        &clear,
+        IID_PPV_ARGS(cache.mDepthStencil.put())));
+
+    cache.mDSV.resize(pDevice, 1);
+    pDevice->CreateDepthStencilView(cache.mDepthStencil.get(), &viewDesc, cache.mDSV.getCpuHandle(0));
+}
+
+bool updateDX12ShadowCache(DX12ShadowCache& cache, const CameraData& cam,
+    const DX12VisibleDraws& casters, uint32_t drawBegin, uint32_t drawEnd
+) {
+    Expects(drawBegin <= drawEnd);
+    Expects(drawEnd < casters.mDrawOffsets.size());
+    const auto instanceBegin = casters.mDrawOffsets[drawBegin];
+    const auto instanceEnd = casters.mDrawOffsets[drawEnd];
+    const auto drawCount = drawEnd - drawBegin;
+
+    // casters are drawn in frame order, equal lists draw the same depth
+    bool changed = !cache.mValid || cache.mView != cam.mView || cache.mProj != cam.mProj ||
+        cache.mDrawOffsets.size() != drawCount + 1 ||
+        cache.mInstances.size() != instanceEnd - instanceBegin;
+    for (uint32_t i = 0; !changed && i <= drawCount; ++i) {
+        changed = cache.mDrawOffsets[i] != casters.mDrawOffsets[drawBegin + i] - instanceBegin;
+    }
+    if (!changed) {
+        changed = !std::equal(cache.mInstances.begin(), cache.mInstances.end(),
+            casters.mInstances.begin() + instanceBegin) ||
+            !std::equal(cache.mLevels.begin(), cache.mLevels.end(),
+            casters.mLevels.begin() + instanceBegin);
+    }
+    if (!changed)
+        return false;
+
+    cache.mValid = true;
+    cache.mView = cam.mView;
+    cache.mProj = cam.mProj;
+    cache.mDrawOffsets.resize(drawCount + 1);
+    for (uint32_t i = 0; i <= drawCount; ++i) {
+        cache.mDrawOffsets[i] = casters.mDrawOffsets[drawBegin + i] - instanceBegin;
+    }
+    cache.mInstances.assign(casters.mInstances.begin() + instanceBegin,
+        casters.mInstances.begin() + instanceEnd);
+    cache.mLevels.assign(casters.mLevels.begin() + instanceBegin,
+        casters.mLevels.begin() + instanceEnd);
+    return true;
+}
+
+void beginDX12ShadowCache(ID3D12GraphicsCommandList* pCommandList, const DX12ShadowCache& cache) {
+    D3D12_RESOURCE_BARRIER barriers[] = {
+        CD3DX12_RESOURCE_BARRIER::Transition(cache.mDepthStencil.get(),
+            D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_DEPTH_WRITE),
+    };
+    pCommandList->ResourceBarrier(_countof(barriers), barriers);
+    Core::Counters::add(Core::Counter::Barriers, _countof(barriers));
+
+    const auto dsv = cache.mDSV.getCpuHandle(0);
+    pCommandList->ClearDepthStencilView(dsv, cache.mClearFlags,
+        cache.mClearDepth, cache.mClearStencil, 0, nullptr);
+    pCommandList->OMSetRenderTargets(0, nullptr, FALSE, &dsv);
+}
+
+void endDX12ShadowCache(ID3D12GraphicsCommandList* pCommandList, const DX12ShadowCache& cache) {
+    D3D12_RESOURCE_BARRIER barriers[] = {
+        CD3DX12_RESOURCE_BARRIER::Transition(cache.mDepthStencil.get(),
+            D3D12_RESOURCE_STATE_DEPTH_WRITE, D3D12_RESOURCE_STATE_COPY_SOURCE),
+    };
+    pCommandList->ResourceBarrier(_countof(barriers), barriers);
+    Core::Counters::add(Core::Counter::Barriers, _countof(barriers));
+}
+
+void copyDX12ShadowCache(ID3D12GraphicsCommandList* pCommandList,
+    const DX12ShadowCache& cache, ID3D12Resource* pDepthStencil
+) {
+    {
+        D3D12_RESOURCE_BARRIER barriers[] = {
+            CD3DX12_RESOURCE_BARRIER::Transition(pDepthStencil,
+                D3D12_RESOURCE_STATE_DEPTH_WRITE, D3D12_RESOURCE_STATE_COPY_DEST),
+        };
+        pCommandList->ResourceBarrier(_countof(barriers), barriers);
+        Core::Counters::add(Core::Counter::Barriers, _countof(barriers));
+    }
+    pCommandList->CopyResource(pDepthStencil, cache.mDepthStencil.get());
+    {
+        D3D12_RESOURCE_BARRIER barriers[] = {
+            CD3DX12_RESOURCE_BARRIER::Transition(pDepthStencil,
+                D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_DEPTH_WRITE),
+        };
+        pCommandList->ResourceBarrier(_countof(barriers), barriers);
+        Core::Counters::add(Core::Counter::Barriers, _countof(barriers));
+    }
+}
+
+}
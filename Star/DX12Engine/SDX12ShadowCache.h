@@ -0,0 +1,42 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <Star/DX12Engine/SDX12Types.h>
+
+namespace Star::Graphics::Render {
+
+struct DX12VisibleDraws;
+
+// created like the depth stencil of the subpass, refreshed before it is first copied
+void createDX12ShadowCache(ID3D12Device* pDevice, ID3D12Resource* pDepthStencil,
+    const D3D12_DEPTH_STENCIL_VIEW_DESC& viewDesc, const LoadOp& loadOp, DX12ShadowCache& cache);
+
+// static casters of draws [drawBegin, drawEnd) are compared with the last refresh
+// true if they or the camera changed, the cache then keeps the new casters
+bool updateDX12ShadowCache(DX12ShadowCache& cache, const CameraData& cam,
+    const DX12VisibleDraws& casters, uint32_t drawBegin, uint32_t drawEnd);
+
+// clear the cache and bind it as the only target, static casters are drawn next
+void beginDX12ShadowCache(ID3D12GraphicsCommandList* pCommandList, const DX12ShadowCache& cache);
+void endDX12ShadowCache(ID3D12GraphicsCommandList* pCommandList, const DX12ShadowCache& cache);
+
+// depth stencil is in DEPTH_WRITE state before and after
+void copyDX12ShadowCache(ID3D12GraphicsCommandList* pCommandList,
+    const DX12ShadowCache& cache, ID3D12Resource* pDepthStencil);
+
+}
@@ -0,0 +1,159 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <Star/DX12Engine/SDX12Types.h>
+#include <Star/Core/SCounters.h>
+
+namespace Star::Graphics::Render {
+
+// graphics state of a command list, redundant calls are dropped
+// root arguments are forgotten when the root signature changes
+// state switches and draws are counted locally and added to the frame counters on destruction
+class DX12GraphicsStateCache {
+public:
+    static const uint32_t sMaxRootParameters = 64;
+
+    explicit DX12GraphicsStateCache(ID3D12GraphicsCommandList* pCommandList) noexcept
+        : mCommandList(pCommandList)
+    {}
+    DX12GraphicsStateCache(const DX12GraphicsStateCache&) = delete;
+    DX12GraphicsStateCache& operator=(const DX12GraphicsStateCache&) = delete;
+
+    ~DX12GraphicsStateCache() {
+        if (mDrawCalls) {
+            Core::Counters::add(Core::Counter::DrawCalls, mDrawCalls);
+            Core::Counters::add(Core::Counter::Instances, mInstances);
+            Core::Counters::add(Core::Counter::Triangles, mTriangles);
+        }
+        if (mPipelineSwitches) {
+            Core::Counters::add(Core::Counter::PipelineSwitches, mPipelineSwitches);
+        }
+        if (mRootSignatureSwitches) {
+            Core::Counters::add(Core::Counter::RootSignatureSwitches, mRootSignatureSwitches);
+        }
+    }
+
+    ID3D12GraphicsCommandList* commandList() const noexcept {
+        return mCommandList;
+    }
+
+    // forget everything but the root signature, after state was set outside of the cache
+    void invalidate() noexcept {
+        mPipelineState = nullptr;
+        mPrimitiveTopology = D3D_PRIMITIVE_TOPOLOGY_UNDEFINED;
+        mMeshBinding = nullptr;
+        mMeshBound = false;
+        mRootArgumentsValid = 0;
+    }
+
+    void setRootSignature(ID3D12RootSignature* pRootSignature) {
+        if (mRootSignature == pRootSignature)
+            return;
+        mCommandList->SetGraphicsRootSignature(pRootSignature);
+        mRootSignature = pRootSignature;
+        mRootArgumentsValid = 0;
+        ++mRootSignatureSwitches;
+    }
+
+    void setPipelineState(ID3D12PipelineState* pPipelineState) {
+        if (mPipelineState == pPipelineState)
+            return;
+        mCommandList->SetPipelineState(pPipelineState);
+        mPipelineState = pPipelineState;
+        ++mPipelineSwitches;
+    }
+
+    void setPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY topology) {
+        if (mPrimitiveTopology == topology)
+            return;
+        mCommandList->IASetPrimitiveTopology(topology);
+        mPrimitiveTopology = topology;
+    }
+
+    // vertex and index buffers of a mesh, nullptr unbinds them
+    void setMesh(const DX12MeshData* pMesh) {
+        // pooled meshes of a page share their bindings
+        const auto* pBinding = getDX12MeshBinding(pMesh);
+        if (mMeshBound && mMeshBinding == pBinding)
+            return;
+        if (pMesh) {
+            mCommandList->IASetVertexBuffers(0,
+                gsl::narrow_cast<uint32_t>(pMesh->mVertexBufferViews.size()),
+                pMesh->mVertexBufferViews.data());
+            mCommandList->IASetIndexBuffer(pMesh->mIndexBufferView.BufferLocation ? &pMesh->mIndexBufferView : nullptr);
+        } else {
+            mCommandList->IASetVertexBuffers(0, 0, nullptr);
+            mCommandList->IASetIndexBuffer(nullptr);
+        }
+        mMeshBinding = pBinding;
+        mMeshBound = true;
+    }
+
+    void setDescriptorTable(uint32_t slot, D3D12_GPU_DESCRIPTOR_HANDLE handle) {
+        if (isBound(slot, handle.ptr))
+            return;
+        mCommandList->SetGraphicsRootDescriptorTable(slot, handle);
+        bind(slot, handle.ptr);
+    }
+
+    void setConstantBufferView(uint32_t slot, D3D12_GPU_VIRTUAL_ADDRESS address) {
+        if (isBound(slot, address))
+            return;
+        mCommandList->SetGraphicsRootConstantBufferView(slot, address);
+        bind(slot, address);
+    }
+
+    void setShaderResourceView(uint32_t slot, D3D12_GPU_VIRTUAL_ADDRESS address) {
+        if (isBound(slot, address))
+            return;
+        mCommandList->SetGraphicsRootShaderResourceView(slot, address);
+        bind(slot, address);
+    }
+    // triangles assume triangle lists
+    void countDraw(uint32_t vertexCount, uint32_t instanceCount) noexcept {
+        ++mDrawCalls;
+        mInstances += instanceCount;
+        mTriangles += uint64_t(vertexCount / 3) * instanceCount;
+    }
+private:
+    bool isBound(uint32_t slot, uint64_t value) const noexcept {
+        Expects(slot < sMaxRootParameters);
+        return (mRootArgumentsValid >> slot & 1) && mRootArguments[slot] == value;
+    }
+    void bind(uint32_t slot, uint64_t value) noexcept {
+        mRootArguments[slot] = value;
+        mRootArgumentsValid |= uint64_t(1) << slot;
+    }
+
+    ID3D12GraphicsCommandList* mCommandList = nullptr;
+    ID3D12RootSignature* mRootSignature = nullptr;
+    ID3D12PipelineState* mPipelineState = nullptr;
+    D3D12_PRIMITIVE_TOPOLOGY mPrimitiveTopology = D3D_PRIMITIVE_TOPOLOGY_UNDEFINED;
+    const void* mMeshBinding = nullptr;
+    bool mMeshBound = false;
+    uint64_t mRootArgumentsValid = 0;
+    std::array<uint64_t, sMaxRootParameters> mRootArguments{};
+
+    uint64_t mDrawCalls = 0;
+    uint64_t mInstances = 0;
+    uint64_t mTriangles = 0;
+    uint64_t mPipelineSwitches = 0;
+    uint64_t mRootSignatureSwitches = 0;
+};
+
+}
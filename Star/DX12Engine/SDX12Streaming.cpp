@@ -0,0 +1,118 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "SDX12Streaming.h"
+#include "SDX12Utils.h"
+#include "SDX12ShaderDescriptorHeap.h"
+
+namespace Star::Graphics::Render {
+
+void DX12StreamingQueue::enqueue(DX12MeshData& mesh) {
+    Expects(mesh.mMeshData);
+    const auto& meshData = *mesh.mMeshData;
+
+    auto& request = mPending.emplace_back();
+    request.mMesh = &mesh;
+    request.mSize = meshData.mIndexBuffer.mBuffer.size();
+    for (const auto& vertexBufferData : meshData.mVertexBuffers) {
+        request.mSize += vertexBufferData.mBuffer.size();
+    }
+}
+
+void DX12StreamingQueue::enqueue(DX12TextureData& tex) {
+    Expects(tex.mTextureData);
+
+    const auto& textureData = *tex.mTextureData;
+
+    auto& request = mPending.emplace_back();
+    request.mTexture = &tex;
+    request.mBeginMip = getDX12TextureMipTail(textureData);
+    request.mEndMip = textureData.mDesc.mMipLevels;
+    request.mSize = getDX12TextureUploadSize(textureData, request.mBeginMip, request.mEndMip);
+}
+
+void DX12StreamingQueue::update(CreationContext& context) {
+    const auto completed = context.mUploadQueue->completedFence();
+    while (!mUploading.empty() && mUploading.front().mFence <= completed) {
+        auto& request = mUploading.front();
+        if (request.mMesh) {
+            request.mMesh->mResident = true;
+        }
+        if (request.mTexture) {
+            auto& tex = *request.mTexture;
+            tex.mResident = true;
+            tex.mResidentMip = std::min(tex.mResidentMip, request.mBeginMip);
+            for (const auto& handle : tex.mViewDescriptors) {
+                createDX12TextureView(context.mDevice, tex, handle);
+                context.mDescriptorHeap->publishPersistent(handle, 1);
+            }
+        }
+        mUploading.pop_front();
+    }
+
+    if (mPending.empty() && mRefining.empty())
+        return;
+
+    context.record();
+    const auto uploadingBegin = mUploading.size();
+    uint64_t size = 0;
+    while (!mPending.empty() || !mRefining.empty()) {
+        auto& queue = mPending.empty() ? mRefining : mPending;
+        if (size && size + queue.front().mSize > mBudget)
+            break;
+
+        // reserved textures need tiles for the mips, refining stops when the pool is full
+        // and mip tails wait for tiles released by other textures
+        auto& front = queue.front();
+        if (front.mTexture && !front.mTexture->mTiles.empty() &&
+            !mapDX12TextureTiles(context, *front.mTexture, front.mBeginMip, front.mEndMip)
+        ) {
+            if (&queue == &mRefining) {
+                mRefining.pop_front();
+                continue;
+            }
+            mPending.emplace_back(std::move(front));
+            mPending.pop_front();
+            break;
+        }
+
+        auto& request = mUploading.emplace_back(std::move(queue.front()));
+        queue.pop_front();
+        if (request.mMesh) {
+            uploadDX12MeshData(context, *request.mMesh);
+        } else {
+            uploadDX12TextureData(context, *request.mTexture, request.mBeginMip, request.mEndMip);
+            if (request.mBeginMip) {
+                auto& next = mRefining.emplace_back();
+                next.mTexture = request.mTexture;
+                next.mBeginMip = request.mBeginMip - 1;
+                next.mEndMip = request.mBeginMip;
+                next.mSize = getDX12TextureUploadSize(*request.mTexture->mTextureData,
+                    next.mBeginMip, next.mEndMip);
+            }
+        }
+        size += request.mSize;
+    }
+
+    // uploads may span several batches, the last one completes after all of them
+    const auto fence = context.flush();
+    for (auto i = uploadingBegin; i != mUploading.size(); ++i) {
+        mUploading[i].mFence = fence;
+    }
+}
+
+}
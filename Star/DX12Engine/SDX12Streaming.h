@@ -0,0 +1,68 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <Star/DX12Engine/SDX12Types.h>
+
+namespace Star::Graphics::Render {
+
+struct CreationContext;
+
+// mesh and texture data uploaded over several frames under a byte budget
+// resources become resident once the upload batch carrying them completes
+// textures arrive smallest mips first, the mip tail makes them resident
+// and larger mips are refined one at a time after all pending tails
+class DX12StreamingQueue {
+public:
+    explicit DX12StreamingQueue(uint64_t budget) noexcept
+        : mBudget(budget)
+    {}
+    DX12StreamingQueue(const DX12StreamingQueue&) = delete;
+    DX12StreamingQueue& operator=(const DX12StreamingQueue&) = delete;
+
+    bool enabled() const noexcept {
+        return mBudget != 0;
+    }
+    bool empty() const noexcept {
+        return mPending.empty() && mRefining.empty() && mUploading.empty();
+    }
+
+    void enqueue(DX12MeshData& mesh);
+    void enqueue(DX12TextureData& tex);
+
+    // publish completed uploads, then submit pending uploads up to the budget
+    // at least one resource is submitted per update, larger ones are not split
+    void update(CreationContext& context);
+private:
+    struct Request {
+        boost::intrusive_ptr<DX12MeshData> mMesh;
+        boost::intrusive_ptr<DX12TextureData> mTexture;
+        uint64_t mSize = 0;
+        uint64_t mFence = 0;
+        // texture mips in [mBeginMip, mEndMip)
+        uint32_t mBeginMip = 0;
+        uint32_t mEndMip = 0;
+    };
+
+    uint64_t mBudget = 0;
+    std::deque<Request> mPending;
+    // next larger mip of resident textures, textures take turns
+    std::deque<Request> mRefining;
+    std::deque<Request> mUploading;
+};
+
+}
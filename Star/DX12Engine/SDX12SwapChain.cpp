@@ -27,39 +27,143 @@ DX12SwapChain::DX12SwapChain(ID3D12Device* pDevice, const EngineMemory& memory,
     , mCurrentSolution(mMemory.mPool)
     , mCurrentPipeline(mMemory.mPool)
     , mRenderGraph(std::move(render))
-    , mWaitWork(std::make_shared<boost::asio::io_context::work>(mWaitService))
 {
 }
 
+void DX12SwapChain::setCurrentPipeline(std::string_view solutionName, std::string_view pipelineName) {
+    const auto& rg = mRenderGraph->mRenderGraph;
+    const auto solutionID = at(rg.mSolutionIndex, solutionName);
+    const auto pipelineID = at(rg.mSolutions.at(solutionID).mPipelineIndex, pipelineName);
+    mCurrentSolution = solutionName;
+    mCurrentPipeline = pipelineName;
+    mCurrentSolutionID = solutionID;
+    mCurrentPipelineID = pipelineID;
+}
+
+void DX12SwapChain::switchPipeline(std::string_view solutionName, std::string_view pipelineName) {
+    Expects(created());
+    clearRenderTargets(mRenderGraph->mRenderGraph, mRenderGraph->mDescriptorHeap, mCurrentSolution, mCurrentPipeline);
+    setCurrentPipeline(solutionName, pipelineName);
+    resizeFramebuffers();
+}
+
+bool DX12SwapChain::needsResize(const SwapChainContext& context) const noexcept {
+    return mWidth != context.mWidth || mHeight != context.mHeight ||
+        mUseWaitableObject != context.mUseWaitableObject;
+}
+
 bool DX12SwapChain::try_resize(const SwapChainContext& context) {
-    if (mWidth != context.mWidth || mHeight != context.mHeight ||
-        mMaxFrameLatency != context.mMaxFrameLatency ||
-        mUseWaitableObject != context.mUseWaitableObject)
-    {
+    if (needsResize(context)) {
         *static_cast<SwapChainContext*>(this) = context;
         return true;
     }
+    setFramePacing(context.mMaxFrameLatency, context.mSyncInterval, context.mAllowTearing);
     return false;
 }
 
+void DX12SwapChain::setFramePacing(uint32_t maxFrameLatency, uint32_t syncInterval, bool allowTearing) {
+    if (mSwapEvent && mMaxFrameLatency != maxFrameLatency) {
+        Expects(mSwapChain);
+        V(mSwapChain->SetMaximumFrameLatency(std::max(1u, maxFrameLatency)));
+    }
+    mMaxFrameLatency = maxFrameLatency;
+    mSyncInterval = syncInterval;
+    mAllowTearing = allowTearing;
+}
+
+UINT DX12SwapChain::swapChainFlags() const noexcept {
+    UINT flags = 0;
+    if (mUseWaitableObject) {
+        flags |= DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT;
+    }
+    if (mTearingSupported) {
+        flags |= DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING;
+    }
+    return flags;
+}
+
+DXGI_FORMAT DX12SwapChain::backBufferFormat() const noexcept {
+    const auto format = getDXGIFormat(currentSolution().mFramebuffers.front().mResource.mFormat);
+    switch (format) {
+    case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+        return DXGI_FORMAT_R8G8B8A8_UNORM;
+    case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+        return DXGI_FORMAT_B8G8R8A8_UNORM;
+    default:
+        return format;
+    }
+}
+
+void DX12SwapChain::applyColorSpace() {
+    const auto colorSpace = visit(overload(
+        [](SDR_) { return DXGI_COLOR_SPACE_RGB_FULL_G22_NONE_P709; },
+        [](HDR10_) { return DXGI_COLOR_SPACE_RGB_FULL_G2084_NONE_P2020; },
+        [](ScRGB_) { return DXGI_COLOR_SPACE_RGB_FULL_G10_NONE_P709; }
+    ), currentSolution().mOutputColorSpace);
+
+    UINT support = 0;
+    if (SUCCEEDED(mSwapChain->CheckColorSpaceSupport(colorSpace, &support))
+        && (support & DXGI_SWAP_CHAIN_COLOR_SPACE_SUPPORT_FLAG_PRESENT))
+    {
+        V(mSwapChain->SetColorSpace1(colorSpace));
+    } else {
+        OutputDebugStringA("WARNING: output color space not supported by the display, presented as sRGB\n");
+    }
+}
+
+void DX12SwapChain::createOffscreenBuffers() {
+    auto& rw = mRenderGraph->mRenderGraph;
+    if (rw.mFramebuffers.size() < rw.mNumBackBuffers) {
+        rw.mFramebuffers.resize(rw.mNumBackBuffers);
+    }
+
+    // 8 bit buffers are typeless, written through unorm and srgb views
+    auto format = backBufferFormat();
+    if (format == DXGI_FORMAT_R8G8B8A8_UNORM) {
+        format = DXGI_FORMAT_R8G8B8A8_TYPELESS;
+    } else if (format == DXGI_FORMAT_B8G8R8A8_UNORM) {
+        format = DXGI_FORMAT_B8G8R8A8_TYPELESS;
+    }
+    const auto desc = CD3DX12_RESOURCE_DESC::Tex2D(format,
+        mWidth, mHeight, 1, 1, 1, 0, D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET);
+    const CD3DX12_HEAP_PROPERTIES heap(D3D12_HEAP_TYPE_DEFAULT);
+    for (uint32_t i = 0; i != rw.mNumBackBuffers; ++i) {
+        Expects(!rw.mFramebuffers[i]);
+        // same state as swapchain buffers, frames transition from present
+        V(mDevice->CreateCommittedResource(&heap, D3D12_HEAP_FLAG_NONE, &desc,
+            D3D12_RESOURCE_STATE_PRESENT, nullptr, IID_PPV_ARGS(rw.mFramebuffers[i].put())));
+        STAR_SET_DEBUG_NAME(rw.mFramebuffers[i], std::string("Offscreen: ") + mName + std::to_string(i));
+    }
+    mOffscreenBackBuffer = 0;
+}
+
 void DX12SwapChain::createFramebuffers(IDXGIFactory4* pFactory,
     ID3D12Device* pDevice, ID3D12CommandQueue* pDirectQueue
 ) {
-    Expects(!mSwapChain);
+    Expects(!created());
     Expects(mWidth && mHeight);
 
+    if (offscreen()) {
+        createOffscreenBuffers();
+        mOffscreenCreated = true;
+        createRenderSolutionRenderTargets(mDevice, nullptr, mRenderGraph->mDescriptorHeap,
+            mRenderGraph->mRenderGraph, mCurrentSolution, mCurrentPipeline);
+        return;
+    }
+
     DXGI_SWAP_CHAIN_DESC1 swapChainDesc = {};
-    swapChainDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    swapChainDesc.Format = backBufferFormat();
 
     swapChainDesc.Stereo = FALSE;
     swapChainDesc.SampleDesc.Count = 1;
     swapChainDesc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
     swapChainDesc.BufferCount = mRenderGraph->mRenderGraph.mNumBackBuffers;
-    swapChainDesc.Scaling = DXGI_SCALING_NONE;
+    // old buffers are stretched to the window until a resize is applied
+    swapChainDesc.Scaling = DXGI_SCALING_STRETCH;
     swapChainDesc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
     swapChainDesc.AlphaMode = DXGI_ALPHA_MODE_UNSPECIFIED; // unused
-    swapChainDesc.Flags = mUseWaitableObject ?
-        DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT : 0;
+    mTearingSupported = DX12::isTearingSupported(pFactory);
+    swapChainDesc.Flags = swapChainFlags();
 
     swapChainDesc.Width = mWidth;
     swapChainDesc.Height = mHeight;
@@ -86,24 +190,33 @@ void DX12SwapChain::createFramebuffers(IDXGIFactory4* pFactory,
         V(mSwapChain->SetMaximumFrameLatency(std::max(1u, mMaxFrameLatency)));
         mSwapEvent.attach(mSwapChain->GetFrameLatencyWaitableObject());
     }
+    applyColorSpace();
 
     createRenderSolutionRenderTargets(mDevice, mSwapChain.get(), mRenderGraph->mDescriptorHeap,
         mRenderGraph->mRenderGraph, mCurrentSolution, mCurrentPipeline);
 }
 
 void DX12SwapChain::resizeFramebuffers() {
-    Expects(mSwapChain);
+    Expects(created());
 
     clearRenderTargets(mRenderGraph->mRenderGraph, mRenderGraph->mDescriptorHeap, mCurrentSolution, mCurrentPipeline);
 
     mRenderGraph->mRenderGraph.mFramebuffers.clear();
+    if (!mSwapChain) {
+        createOffscreenBuffers();
+        createRenderSolutionRenderTargets(mDevice, nullptr, mRenderGraph->mDescriptorHeap,
+            mRenderGraph->mRenderGraph, mCurrentSolution, mCurrentPipeline);
+        return;
+    }
+
     V(mSwapChain->ResizeBuffers(
         mRenderGraph->mRenderGraph.mNumBackBuffers,
         mWidth,
         mHeight,
-        DXGI_FORMAT_R8G8B8A8_UNORM,
-        mUseWaitableObject ?
-        DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT : 0));
+        backBufferFormat(),
+        swapChainFlags()));
+    // solutions switched since may present in another color space
+    applyColorSpace();
 
     if (mUseWaitableObject) {
         V(mSwapChain->SetMaximumFrameLatency(std::max(1u, mMaxFrameLatency)));
@@ -114,7 +227,51 @@ void DX12SwapChain::resizeFramebuffers() {
 }
 
 void DX12SwapChain::present() {
-    mSwapChain->Present(mSyncInterval, 0);
+    // tearing is only allowed when vsync is off
+    UINT flags = 0;
+    if (mSyncInterval == 0 && mAllowTearing && mTearingSupported) {
+        flags |= DXGI_PRESENT_ALLOW_TEARING;
+    }
+    // device removal throws, reported by the engine
+    if (mSwapChain) {
+        V(mSwapChain->Present(mSyncInterval, flags));
+    } else {
+        mOffscreenBackBuffer = (mOffscreenBackBuffer + 1) % mRenderGraph->mRenderGraph.mNumBackBuffers;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (mLastPresent != std::chrono::steady_clock::time_point{}) {
+        mPresentIntervals[mNextPresentInterval] =
+            std::chrono::duration<double, std::milli>(now - mLastPresent).count();
+        mNextPresentInterval = (mNextPresentInterval + 1) % sNumPresentIntervals;
+        mNumPresentIntervals = std::min(mNumPresentIntervals + 1, sNumPresentIntervals);
+    }
+    mLastPresent = now;
+}
+
+DX12PresentStatistics DX12SwapChain::presentStatistics() const noexcept {
+    DX12PresentStatistics stats;
+    if (!mNumPresentIntervals)
+        return stats;
+
+    stats.mSampleCount = mNumPresentIntervals;
+    stats.mMinInterval = mPresentIntervals[0];
+    stats.mMaxInterval = mPresentIntervals[0];
+    double sum = 0;
+    for (uint32_t i = 0; i != mNumPresentIntervals; ++i) {
+        sum += mPresentIntervals[i];
+        stats.mMinInterval = std::min(stats.mMinInterval, mPresentIntervals[i]);
+        stats.mMaxInterval = std::max(stats.mMaxInterval, mPresentIntervals[i]);
+    }
+    stats.mMeanInterval = sum / mNumPresentIntervals;
+
+    double variance = 0;
+    for (uint32_t i = 0; i != mNumPresentIntervals; ++i) {
+        auto d = mPresentIntervals[i] - stats.mMeanInterval;
+        variance += d * d;
+    }
+    stats.mJitter = std::sqrt(variance / mNumPresentIntervals);
+    return stats;
 }
 
 }
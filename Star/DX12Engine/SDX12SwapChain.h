@@ -21,6 +21,16 @@
 
 namespace Star::Graphics::Render {
 
+// present to present intervals of recent frames, in milliseconds
+struct DX12PresentStatistics {
+    uint32_t mSampleCount = 0;
+    double mMeanInterval = 0;
+    double mMinInterval = 0;
+    double mMaxInterval = 0;
+    // standard deviation of intervals
+    double mJitter = 0;
+};
+
 class DX12SwapChain : public SwapChainContext {
 public:
     DX12SwapChain(ID3D12Device* pDevice, const EngineMemory& memory, boost::intrusive_ptr<DX12RenderGraphData> render);
@@ -28,18 +38,33 @@ public:
     DX12SwapChain& operator=(const DX12SwapChain&) = delete;
 
     bool created() const noexcept {
-        return mSwapChain != nullptr;
+        return mSwapChain != nullptr || mOffscreenCreated;
+    }
+
+    // without window back buffers are plain textures, presenting cycles them
+    bool offscreen() const noexcept {
+        return mWindowHandle == nullptr;
+    }
+
+    uint32_t currentBackBufferIndex() const noexcept {
+        return mSwapChain ? mSwapChain->GetCurrentBackBufferIndex() : mOffscreenBackBuffer;
     }
 
     void createFramebuffers(IDXGIFactory4* pFactory,
         ID3D12Device* pDevice,
         ID3D12CommandQueue* pDirectQueue);
 
+    // true if buffers must be resized, pacing changes are applied directly
     bool try_resize(const SwapChainContext& context);
+    bool needsResize(const SwapChainContext& context) const noexcept;
     void resizeFramebuffers();
 
+    void setFramePacing(uint32_t maxFrameLatency, uint32_t syncInterval, bool allowTearing);
+
     void present();
 
+    DX12PresentStatistics presentStatistics() const noexcept;
+
     ID3D12Resource* getBackBuffer(uint32_t id) const noexcept {
         Expects(id < mRenderGraph->mRenderGraph.mNumBackBuffers);
         return mRenderGraph->mRenderGraph.mFramebuffers[id].get();
@@ -50,38 +75,69 @@ public:
         return mRenderGraph->mRenderGraph.mRTVs.getCpuHandle(size_t(id) + sRGB * mRenderGraph->mRenderGraph.mNumBackBuffers);
     }
 
-    uint32_t getSolutionID() const {
-        return mRenderGraph->mRenderGraph.mSolutionIndex.at(mCurrentSolution);
+    // names are resolved here once, frames use the cached ids
+    void setCurrentPipeline(std::string_view solutionName, std::string_view pipelineName);
+    // created swapchains only, render targets of the previous solution are released
+    void switchPipeline(std::string_view solutionName, std::string_view pipelineName);
+
+    uint32_t getSolutionID() const noexcept {
+        return mCurrentSolutionID;
     }
 
-    uint32_t getPipelineID() const {
-        const auto& solution = currentSolution();
-        return solution.mPipelineIndex.at(mCurrentPipeline);
+    uint32_t getPipelineID() const noexcept {
+        return mCurrentPipelineID;
     }
 
-    const DX12RenderSolution& currentSolution() const {
-        auto solutionID = mRenderGraph->mRenderGraph.mSolutionIndex.at(mCurrentSolution);
-        return mRenderGraph->mRenderGraph.mSolutions.at(solutionID);
+    const DX12RenderSolution& currentSolution() const noexcept {
+        return mRenderGraph->mRenderGraph.mSolutions[mCurrentSolutionID];
     }
 
-    const DX12RenderPipeline& currentPipeline() const {
-        const auto& solution = currentSolution();
-        auto pipelineID = solution.mPipelineIndex.at(mCurrentPipeline);
-        return solution.mPipelines.at(pipelineID);
+    const DX12RenderPipeline& currentPipeline() const noexcept {
+        return currentSolution().mPipelines[mCurrentPipelineID];
     }
 
     // BackBuffers
     ID3D12Device* mDevice = nullptr;
+    // index of the swapchain, selects its frame ring
+    uint32_t mID = 0;
     EngineMemory mMemory = {};
     com_ptr<IDXGISwapChain3> mSwapChain;
     winrt::handle mSwapEvent;
+    // offscreen back buffers are held by the render graph framebuffers
+    bool mOffscreenCreated = false;
+    uint32_t mOffscreenBackBuffer = 0;
     std::pmr::string mCurrentSolution;
     std::pmr::string mCurrentPipeline;
+    uint32_t mCurrentSolutionID = 0;
+    uint32_t mCurrentPipelineID = 0;
     boost::intrusive_ptr<DX12RenderGraphData> mRenderGraph;
-
-    boost::asio::io_context mWaitService;
-    std::shared_ptr<boost::asio::io_context::work> mWaitWork;
-    std::thread mWaitThread;
+    // fence of the last frame presented, retired before buffers are resized
+    uint64_t mLastFrameFence = 0;
+    // recent frame fences, waited by frame pacing without waitable object
+    static constexpr uint32_t sNumFrameFences = 8;
+    std::array<uint64_t, sNumFrameFences> mFrameFences = {};
+    uint32_t mNextFrameFence = 0;
+    // set by renderSwapChain, cleared once the frame is rendered
+    bool mRenderRequested = false;
+    // resize applied once the window stopped changing
+    std::optional<SwapChainContext> mPendingResize;
+    std::chrono::steady_clock::time_point mPendingResizeTime = {};
+    // buffers are created with tearing flag if supported, so that it can be toggled
+    bool mTearingSupported = false;
+
+    // Present Intervals
+    static constexpr uint32_t sNumPresentIntervals = 128;
+    std::chrono::steady_clock::time_point mLastPresent = {};
+    std::array<double, sNumPresentIntervals> mPresentIntervals = {};
+    uint32_t mNumPresentIntervals = 0;
+    uint32_t mNextPresentInterval = 0;
+private:
+    UINT swapChainFlags() const noexcept;
+    // back buffer format of the current solution, srgb formats are view formats of unorm buffers
+    DXGI_FORMAT backBufferFormat() const noexcept;
+    // color space of the current solution, displays without support present as srgb
+    void applyColorSpace();
+    void createOffscreenBuffers();
 };
 
 }
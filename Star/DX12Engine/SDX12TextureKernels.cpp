@@ -0,0 +1,679 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "SDX12TextureKernels.h"
+#include "SDX12ShaderDescriptorHeap.h"
+#include <Star/Graphics/SRenderFormatTextureUtils.h>
+#include <Star/Graphics/SRenderFormatUtils.h>
+#include <Star/Core/SCounters.h>
+
+namespace Star::Graphics::Render {
+
+namespace {
+
+// downsample takes a bilinear tap at the center of each 2x2 footprint
+// encoders run a thread per 4x4 block, endpoints are the bounds of the block and indices
+// project texels on the axis between them, bc1 is always encoded with 4 colors and drops alpha
+const char sTextureKernelsShader[] = R"(
+#define TextureKernelsRS "RootConstants(num32BitConstants=8, b0), DescriptorTable(SRV(t0)), DescriptorTable(UAV(u0)), " \
+    "StaticSampler(s0, filter=FILTER_MIN_MAG_MIP_LINEAR, addressU=TEXTURE_ADDRESS_CLAMP, addressV=TEXTURE_ADDRESS_CLAMP)"
+
+cbuffer TextureKernels : register(b0) {
+    uint4 Params;
+    uint4 Layout;
+};
+
+Texture2D<float4> gSource : register(t0);
+RWTexture2D<float4> gTarget : register(u0);
+RWByteAddressBuffer gBlocks : register(u0);
+SamplerState gSampler : register(s0);
+
+float3 linearToSrgb(float3 c) {
+    return c < 0.0031308 ? 12.92 * c : 1.055 * pow(abs(c), 1.0 / 2.4) - 0.055;
+}
+
+// Params: target size, srgb
+[RootSignature(TextureKernelsRS)]
+[numthreads(8, 8, 1)]
+void downsample(uint3 id : SV_DispatchThreadID) {
+    if (any(id.xy >= Params.xy))
+        return;
+
+    float4 c = gSource.SampleLevel(gSampler, (id.xy + 0.5) / float2(Params.xy), 0);
+    if (Params.z) {
+        c.rgb = linearToSrgb(c.rgb);
+    }
+    gTarget[id.xy] = c;
+}
+
+// texels past the edge of the mip repeat the last row or column
+void loadBlock(uint2 block, out float4 texels[16]) {
+    uint2 last = Layout.zw - 1;
+    [unroll] for (uint i = 0; i != 16; ++i) {
+        float4 c = gSource.Load(int3(min(block * 4 + uint2(i & 3, i >> 2), last), 0));
+        if (Params.z) {
+            c.rgb = linearToSrgb(c.rgb);
+        }
+        texels[i] = c;
+    }
+}
+
+uint blockOffset(uint2 block, uint blockSize) {
+    return Layout.x + block.y * Layout.y + block.x * blockSize;
+}
+
+uint packColor(float3 c) {
+    uint3 q = uint3(round(saturate(c) * float3(31, 63, 31)));
+    return (q.r << 11) | (q.g << 5) | q.b;
+}
+
+float3 unpackColor(uint c) {
+    return float3((c >> 11) & 31, (c >> 5) & 63, c & 31) / float3(31, 63, 31);
+}
+
+// endpoints are inset by 1/16 of the bounds, palette positions from c1 to c0 are indices 1, 3, 2, 0
+uint2 encodeColors(float4 texels[16]) {
+    float3 lo = 1;
+    float3 hi = 0;
+    [unroll] for (uint i = 0; i != 16; ++i) {
+        lo = min(lo, texels[i].rgb);
+        hi = max(hi, texels[i].rgb);
+    }
+    float3 inset = (hi - lo) / 16;
+    uint c0 = packColor(hi - inset);
+    uint c1 = packColor(lo + inset);
+    if (c0 < c1) {
+        uint c = c0;
+        c0 = c1;
+        c1 = c;
+    }
+    if (c0 == c1)
+        return uint2(c0 | (c1 << 16), 0);
+
+    float3 e1 = unpackColor(c1);
+    float3 axis = unpackColor(c0) - e1;
+    float scale = 3 / dot(axis, axis);
+    uint indices = 0;
+    [unroll] for (uint j = 0; j != 16; ++j) {
+        uint t = uint(clamp(round(dot(texels[j].rgb - e1, axis) * scale), 0, 3));
+        indices |= ((0x2D >> (2 * t)) & 3) << (2 * j);
+    }
+    return uint2(c0 | (c1 << 16), indices);
+}
+
+// 8 alpha mode, positions from a1 to a0 are indices 1, 7 to 2, 0
+uint2 encodeAlpha(float4 texels[16]) {
+    float lo = 1;
+    float hi = 0;
+    [unroll] for (uint i = 0; i != 16; ++i) {
+        lo = min(lo, texels[i].a);
+        hi = max(hi, texels[i].a);
+    }
+    uint a0 = uint(round(saturate(hi) * 255));
+    uint a1 = uint(round(saturate(lo) * 255));
+    uint2 block = uint2(a0 | (a1 << 8), 0);
+    if (a0 == a1)
+        return block;
+
+    float scale = 7 / float(a0 - a1);
+    [unroll] for (uint j = 0; j != 16; ++j) {
+        uint t = uint(clamp(round((texels[j].a * 255 - a1) * scale), 0, 7));
+        uint index = t == 7 ? 0 : (t == 0 ? 1 : 8 - t);
+        uint bit = 16 + 3 * j;
+        if (bit < 32) {
+            block.x |= index << bit;
+            if (bit > 29) {
+                block.y |= index >> (32 - bit);
+            }
+        } else {
+            block.y |= index << (bit - 32);
+        }
+    }
+    return block;
+}
+
+void putBits(inout uint4 block, inout uint pos, uint value, uint count) {
+    uint word = pos >> 5;
+    uint shift = pos & 31;
+    block[word] |= value << shift;
+    if (shift + count > 32) {
+        block[word + 1] |= value >> (32 - shift);
+    }
+    pos += count;
+}
+
+// 7 bit endpoint and the p bit closest to the color
+uint4 quantizeEndpoint(float4 c, out uint p) {
+    float4 v = saturate(c) * 255;
+    uint4 q0 = uint4(clamp(round(v / 2), 0, 127));
+    uint4 q1 = uint4(clamp(round((v - 1) / 2), 0, 127));
+    float4 d0 = v - float4(q0 * 2);
+    float4 d1 = v - float4(q1 * 2 + 1);
+    p = dot(d1, d1) < dot(d0, d0) ? 1 : 0;
+    return p ? q1 : q0;
+}
+
+// mode 6, one subset of rgba endpoints with 4 bit indices
+uint4 encodeBC7(float4 texels[16]) {
+    float4 lo = 1;
+    float4 hi = 0;
+    [unroll] for (uint i = 0; i != 16; ++i) {
+        lo = min(lo, texels[i]);
+        hi = max(hi, texels[i]);
+    }
+    uint p0;
+    uint p1;
+    uint4 q0 = quantizeEndpoint(lo, p0);
+    uint4 q1 = quantizeEndpoint(hi, p1);
+    float4 e0 = float4(q0 * 2 + p0) / 255;
+    float4 axis = float4(q1 * 2 + p1) / 255 - e0;
+    float scale = 15 / max(dot(axis, axis), 1e-8);
+
+    uint indices[16];
+    [unroll] for (uint j = 0; j != 16; ++j) {
+        indices[j] = uint(clamp(round(dot(texels[j] - e0, axis) * scale), 0, 15));
+    }
+    // the high bit of the first index is implied 0
+    if (indices[0] & 8) {
+        uint4 q = q0;
+        q0 = q1;
+        q1 = q;
+        uint p = p0;
+        p0 = p1;
+        p1 = p;
+        [unroll] for (uint k = 0; k != 16; ++k) {
+            indices[k] = 15 - indices[k];
+        }
+    }
+
+    uint4 block = 0;
+    uint pos = 0;
+    putBits(block, pos, 1 << 6, 7);
+    [unroll] for (uint c = 0; c != 4; ++c) {
+        putBits(block, pos, q0[c], 7);
+        putBits(block, pos, q1[c], 7);
+    }
+    putBits(block, pos, p0, 1);
+    putBits(block, pos, p1, 1);
+    putBits(block, pos, indices[0], 3);
+    [unroll] for (uint n = 1; n != 16; ++n) {
+        putBits(block, pos, indices[n], 4);
+    }
+    return block;
+}
+
+// Params: block count, srgb
+// Layout: offset and row pitch of the mip blocks, mip size
+[RootSignature(TextureKernelsRS)]
+[numthreads(8, 8, 1)]
+void compressBC1(uint3 id : SV_DispatchThreadID) {
+    if (any(id.xy >= Params.xy))
+        return;
+
+    float4 texels[16];
+    loadBlock(id.xy, texels);
+    gBlocks.Store2(blockOffset(id.xy, 8), encodeColors(texels));
+}
+
+[RootSignature(TextureKernelsRS)]
+[numthreads(8, 8, 1)]
+void compressBC3(uint3 id : SV_DispatchThreadID) {
+    if (any(id.xy >= Params.xy))
+        return;
+
+    float4 texels[16];
+    loadBlock(id.xy, texels);
+    gBlocks.Store4(blockOffset(id.xy, 16), uint4(encodeAlpha(texels), encodeColors(texels)));
+}
+
+[RootSignature(TextureKernelsRS)]
+[numthreads(8, 8, 1)]
+void compressBC7(uint3 id : SV_DispatchThreadID) {
+    if (any(id.xy >= Params.xy))
+        return;
+
+    float4 texels[16];
+    loadBlock(id.xy, texels);
+    gBlocks.Store4(blockOffset(id.xy, 16), encodeBC7(texels));
+}
+)";
+
+struct TextureKernelConstants {
+    uint32_t mParams[4];
+    uint32_t mLayout[4];
+};
+static_assert(sizeof(TextureKernelConstants) == 8 * sizeof(uint32_t));
+
+using MipFootprints = std::array<D3D12_PLACED_SUBRESOURCE_FOOTPRINT, D3D12_REQ_MIP_LEVELS>;
+
+com_ptr<ID3DBlob> compileTextureKernel(const char* entry) {
+    com_ptr<ID3DBlob> shader;
+    com_ptr<ID3DBlob> errors;
+    HRESULT hr = D3DCompile(sTextureKernelsShader, sizeof(sTextureKernelsShader) - 1,
+        "TextureKernels", nullptr, nullptr, entry, "cs_5_1",
+        D3DCOMPILE_OPTIMIZATION_LEVEL3, 0, shader.put(), errors.put());
+    if (FAILED(hr)) {
+        throw std::runtime_error(errors ?
+            static_cast<const char*>(errors->GetBufferPointer()) :
+            "texture kernel compilation failed");
+    }
+    return shader;
+}
+
+com_ptr<ID3D12PipelineState> createComputePipeline(ID3D12Device* pDevice,
+    ID3D12RootSignature* pRootSignature, ID3DBlob* pShader
+) {
+    D3D12_COMPUTE_PIPELINE_STATE_DESC desc{};
+    desc.pRootSignature = pRootSignature;
+    desc.CS = CD3DX12_SHADER_BYTECODE(pShader);
+
+    com_ptr<ID3D12PipelineState> pso;
+    V(pDevice->CreateComputePipelineState(&desc, IID_PPV_ARGS(pso.put())));
+    return pso;
+}
+
+com_ptr<ID3D12Resource> createHostBuffer(ID3D12Device* pDevice, D3D12_HEAP_TYPE type,
+    uint64_t size, D3D12_RESOURCE_STATES state
+) {
+    com_ptr<ID3D12Resource> ptr;
+    V(pDevice->CreateCommittedResource(
+        &CD3DX12_HEAP_PROPERTIES(type),
+        D3D12_HEAP_FLAG_NONE,
+        &CD3DX12_RESOURCE_DESC::Buffer(size),
+        state,
+        nullptr,
+        IID_PPV_ARGS(ptr.put())));
+    return ptr;
+}
+
+uint32_t getMipExtent(uint64_t size, uint32_t mip) noexcept {
+    return std::max(1u, gsl::narrow_cast<uint32_t>(size >> mip));
+}
+
+bool isTypelessFormat(DXGI_FORMAT format) noexcept {
+    return format == DXGI_FORMAT_R8G8B8A8_TYPELESS || format == DXGI_FORMAT_B8G8R8A8_TYPELESS;
+}
+
+bool isSrgbFormat(DXGI_FORMAT format) noexcept {
+    return format == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB || format == DXGI_FORMAT_B8G8R8A8_UNORM_SRGB;
+}
+
+// srgb formats have no unordered access, kernels write unorm views and encode srgb themselves
+DXGI_FORMAT getUnorderedAccessFormat(DXGI_FORMAT format) noexcept {
+    switch (format) {
+    case DXGI_FORMAT_R8G8B8A8_TYPELESS:
+    case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+        return DXGI_FORMAT_R8G8B8A8_UNORM;
+    case DXGI_FORMAT_B8G8R8A8_TYPELESS:
+    case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+        return DXGI_FORMAT_B8G8R8A8_UNORM;
+    default:
+        return format;
+    }
+}
+
+// typeless textures are viewed as srgb to be filtered in linear space, or as unorm to read raw texels
+DXGI_FORMAT getShaderResourceFormat(DXGI_FORMAT format, bool srgb) noexcept {
+    switch (format) {
+    case DXGI_FORMAT_R8G8B8A8_TYPELESS:
+        return srgb ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM;
+    case DXGI_FORMAT_B8G8R8A8_TYPELESS:
+        return srgb ? DXGI_FORMAT_B8G8R8A8_UNORM_SRGB : DXGI_FORMAT_B8G8R8A8_UNORM;
+    default:
+        return format;
+    }
+}
+
+ID3D12PipelineState* getCompressionPipeline(const DX12TextureKernels& kernels, DXGI_FORMAT format) noexcept {
+    switch (format) {
+    case DXGI_FORMAT_BC1_UNORM:
+    case DXGI_FORMAT_BC1_UNORM_SRGB:
+        return kernels.mCompressBC1.get();
+    case DXGI_FORMAT_BC3_UNORM:
+    case DXGI_FORMAT_BC3_UNORM_SRGB:
+        return kernels.mCompressBC3.get();
+    case DXGI_FORMAT_BC7_UNORM:
+    case DXGI_FORMAT_BC7_UNORM_SRGB:
+        return kernels.mCompressBC7.get();
+    default:
+        return nullptr;
+    }
+}
+
+}
+
+DX12TextureKernels createDX12TextureKernels(ID3D12Device* pDevice) {
+    auto downsample = compileTextureKernel("downsample");
+    auto bc1 = compileTextureKernel("compressBC1");
+    auto bc3 = compileTextureKernel("compressBC3");
+    auto bc7 = compileTextureKernel("compressBC7");
+
+    DX12TextureKernels kernels;
+    V(pDevice->CreateRootSignature(0, downsample->GetBufferPointer(), downsample->GetBufferSize(),
+        IID_PPV_ARGS(kernels.mRootSignature.put())));
+    kernels.mDownsample = createComputePipeline(pDevice, kernels.mRootSignature.get(), downsample.get());
+    kernels.mCompressBC1 = createComputePipeline(pDevice, kernels.mRootSignature.get(), bc1.get());
+    kernels.mCompressBC3 = createComputePipeline(pDevice, kernels.mRootSignature.get(), bc3.get());
+    kernels.mCompressBC7 = createComputePipeline(pDevice, kernels.mRootSignature.get(), bc7.get());
+    return kernels;
+}
+
+bool isDX12TextureCompressible(DXGI_FORMAT format) noexcept {
+    switch (format) {
+    case DXGI_FORMAT_BC1_UNORM:
+    case DXGI_FORMAT_BC1_UNORM_SRGB:
+    case DXGI_FORMAT_BC3_UNORM:
+    case DXGI_FORMAT_BC3_UNORM_SRGB:
+    case DXGI_FORMAT_BC7_UNORM:
+    case DXGI_FORMAT_BC7_UNORM_SRGB:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void dispatchDX12GenerateMips(ID3D12Device* pDevice, ID3D12GraphicsCommandList* pCommandList,
+    DX12ShaderDescriptorHeap& shaderHeap, const DX12TextureKernels& kernels,
+    ID3D12Resource* pTexture, bool srgb
+) {
+    const auto desc = pTexture->GetDesc();
+    const uint32_t mipLevels = desc.MipLevels;
+    if (mipLevels < 2)
+        return;
+    Expects(desc.Flags & D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
+    Expects(!srgb || isTypelessFormat(desc.Format));
+    Expects(!isSrgbFormat(desc.Format));
+
+    // views: mips but the last as srv, mips but the first as uav
+    const uint32_t count = mipLevels - 1;
+    auto descs = shaderHeap.allocateCircular(2 * count);
+    for (uint32_t i = 0; i != count; ++i) {
+        D3D12_SHADER_RESOURCE_VIEW_DESC srv{};
+        srv.Format = getShaderResourceFormat(desc.Format, srgb);
+        srv.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+        srv.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+        srv.Texture2D.MostDetailedMip = i;
+        srv.Texture2D.MipLevels = 1;
+        pDevice->CreateShaderResourceView(pTexture, &srv, descs[i].mCpuHandle);
+
+        D3D12_UNORDERED_ACCESS_VIEW_DESC uav{};
+        uav.Format = getUnorderedAccessFormat(desc.Format);
+        uav.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE2D;
+        uav.Texture2D.MipSlice = i + 1;
+        pDevice->CreateUnorderedAccessView(pTexture, nullptr, &uav, descs[count + i].mCpuHandle);
+    }
+
+    std::array<D3D12_RESOURCE_BARRIER, D3D12_REQ_MIP_LEVELS> barriers;
+    for (uint32_t i = 0; i != count; ++i) {
+        barriers[i] = CD3DX12_RESOURCE_BARRIER::Transition(pTexture,
+            D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, i + 1);
+    }
+    pCommandList->ResourceBarrier(count, barriers.data());
+    Core::Counters::add(Core::Counter::Barriers, count);
+
+    TextureKernelConstants constants{};
+    constants.mParams[2] = srgb ? 1 : 0;
+
+    pCommandList->SetComputeRootSignature(kernels.mRootSignature.get());
+    pCommandList->SetPipelineState(kernels.mDownsample.get());
+
+    // each mip is filtered from the previous one, which becomes readable after it is written
+    for (uint32_t i = 0; i != count; ++i) {
+        const auto width = getMipExtent(desc.Width, i + 1);
+        const auto height = getMipExtent(desc.Height, i + 1);
+        constants.mParams[0] = width;
+        constants.mParams[1] = height;
+        pCommandList->SetComputeRoot32BitConstants(0, sizeof(constants) / sizeof(uint32_t), &constants, 0);
+        pCommandList->SetComputeRootDescriptorTable(1, descs[i].mGpuHandle);
+        pCommandList->SetComputeRootDescriptorTable(2, descs[count + i].mGpuHandle);
+        pCommandList->Dispatch((width + 7) / 8, (height + 7) / 8, 1);
+
+        D3D12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::Transition(pTexture,
+            D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, i + 1);
+        pCommandList->ResourceBarrier(1, &barrier);
+    }
+    Core::Counters::add(Core::Counter::Barriers, count);
+}
+
+com_ptr<ID3D12Resource> createDX12CompressionBuffer(ID3D12Device* pDevice,
+    const D3D12_RESOURCE_DESC& target
+) {
+    uint64_t size = 0;
+    pDevice->GetCopyableFootprints(&target, 0, target.MipLevels, 0, nullptr, nullptr, nullptr, &size);
+    return DX12::createUnorderedAccessBuffer(pDevice, size, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+}
+
+void dispatchDX12CompressTexture(ID3D12Device* pDevice, ID3D12GraphicsCommandList* pCommandList,
+    DX12ShaderDescriptorHeap& shaderHeap, const DX12TextureKernels& kernels,
+    ID3D12Resource* pSource, ID3D12Resource* pBlocks, const D3D12_RESOURCE_DESC& target
+) {
+    auto* pPipeline = getCompressionPipeline(kernels, target.Format);
+    Expects(pPipeline);
+    const auto source = pSource->GetDesc();
+    Expects(source.Width == target.Width && source.Height == target.Height);
+    Expects(source.MipLevels == target.MipLevels);
+    const uint32_t mipLevels = target.MipLevels;
+
+    MipFootprints layouts;
+    pDevice->GetCopyableFootprints(&target, 0, mipLevels, 0, layouts.data(), nullptr, nullptr, nullptr);
+
+    // views: source mips, blocks
+    // srgb textures viewed as srgb return linear texels, they are encoded back before compression
+    const auto viewFormat = getShaderResourceFormat(source.Format, false);
+    auto descs = shaderHeap.allocateCircular(mipLevels + 1);
+    for (uint32_t mip = 0; mip != mipLevels; ++mip) {
+        D3D12_SHADER_RESOURCE_VIEW_DESC srv{};
+        srv.Format = viewFormat;
+        srv.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+        srv.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+        srv.Texture2D.MostDetailedMip = mip;
+        srv.Texture2D.MipLevels = 1;
+        pDevice->CreateShaderResourceView(pSource, &srv, descs[mip].mCpuHandle);
+    }
+    {
+        D3D12_UNORDERED_ACCESS_VIEW_DESC uav{};
+        uav.Format = DXGI_FORMAT_R32_TYPELESS;
+        uav.ViewDimension = D3D12_UAV_DIMENSION_BUFFER;
+        uav.Buffer.NumElements = gsl::narrow<uint32_t>(pBlocks->GetDesc().Width / sizeof(uint32_t));
+        uav.Buffer.Flags = D3D12_BUFFER_UAV_FLAG_RAW;
+        pDevice->CreateUnorderedAccessView(pBlocks, nullptr, &uav, descs[mipLevels].mCpuHandle);
+    }
+
+    TextureKernelConstants constants{};
+    constants.mParams[2] = isSrgbFormat(viewFormat) ? 1 : 0;
+
+    pCommandList->SetComputeRootSignature(kernels.mRootSignature.get());
+    pCommandList->SetPipelineState(pPipeline);
+    pCommandList->SetComputeRootDescriptorTable(2, descs[mipLevels].mGpuHandle);
+
+    // blocks of different mips never overlap, mips are encoded without barriers in between
+    for (uint32_t mip = 0; mip != mipLevels; ++mip) {
+        const auto width = getMipExtent(target.Width, mip);
+        const auto height = getMipExtent(target.Height, mip);
+        constants.mParams[0] = (width + 3) / 4;
+        constants.mParams[1] = (height + 3) / 4;
+        constants.mLayout[0] = gsl::narrow<uint32_t>(layouts[mip].Offset);
+        constants.mLayout[1] = layouts[mip].Footprint.RowPitch;
+        constants.mLayout[2] = width;
+        constants.mLayout[3] = height;
+        pCommandList->SetComputeRoot32BitConstants(0, sizeof(constants) / sizeof(uint32_t), &constants, 0);
+        pCommandList->SetComputeRootDescriptorTable(1, descs[mip].mGpuHandle);
+        pCommandList->Dispatch((constants.mParams[0] + 7) / 8, (constants.mParams[1] + 7) / 8, 1);
+    }
+}
+
+void copyDX12CompressedBlocks(ID3D12Device* pDevice, ID3D12GraphicsCommandList* pCommandList,
+    ID3D12Resource* pBlocks, ID3D12Resource* pTarget
+) {
+    const auto target = pTarget->GetDesc();
+    const uint32_t mipLevels = target.MipLevels;
+    MipFootprints layouts;
+    pDevice->GetCopyableFootprints(&target, 0, mipLevels, 0, layouts.data(), nullptr, nullptr, nullptr);
+
+    {
+        D3D12_RESOURCE_BARRIER barriers[] = {
+            CD3DX12_RESOURCE_BARRIER::Transition(pBlocks,
+                D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_COPY_SOURCE),
+        };
+        pCommandList->ResourceBarrier(_countof(barriers), barriers);
+    }
+    for (uint32_t mip = 0; mip != mipLevels; ++mip) {
+        D3D12_TEXTURE_COPY_LOCATION Dst{ pTarget, D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX, mip };
+        D3D12_TEXTURE_COPY_LOCATION Src{ pBlocks, D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT, layouts[mip] };
+        pCommandList->CopyTextureRegion(&Dst, 0, 0, 0, &Src, nullptr);
+    }
+    {
+        D3D12_RESOURCE_BARRIER barriers[] = {
+            CD3DX12_RESOURCE_BARRIER::Transition(pBlocks,
+                D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS),
+        };
+        pCommandList->ResourceBarrier(_countof(barriers), barriers);
+    }
+    Core::Counters::add(Core::Counter::Barriers, 2);
+}
+
+void encodeDX12Texture(ID3D12Device* pDevice, const TextureData& source,
+    Format format, bool generateMips, TextureData& encoded
+) {
+    const auto sourceFormat = getDXGIFormat(source.mFormat);
+    if (sourceFormat != DXGI_FORMAT_R8G8B8A8_UNORM && sourceFormat != DXGI_FORMAT_R8G8B8A8_UNORM_SRGB) {
+        throw std::invalid_argument("gpu texture encoder source must be rgba8");
+    }
+    const auto targetFormat = getDXGIFormat(format);
+    if (!isDX12TextureCompressible(targetFormat)) {
+        throw std::invalid_argument("gpu texture encoder target must be bc1, bc3 or bc7");
+    }
+    const auto width = gsl::narrow<uint32_t>(source.mDesc.mWidth);
+    const auto height = source.mDesc.mHeight;
+    if (width % 4 || height % 4) {
+        throw std::invalid_argument("gpu texture encoder source size must be a multiple of 4");
+    }
+    const uint32_t mipLevels = generateMips ? mip_count(width, height) : source.mDesc.mMipLevels;
+    const uint32_t uploadMips = generateMips ? 1 : mipLevels;
+
+    auto kernels = createDX12TextureKernels(pDevice);
+    auto queue = DX12::createDirectQueue(pDevice);
+    com_ptr<ID3D12CommandAllocator> allocator;
+    V(pDevice->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(allocator.put())));
+    com_ptr<ID3D12GraphicsCommandList> commandList;
+    V(pDevice->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, allocator.get(), nullptr,
+        IID_PPV_ARGS(commandList.put())));
+    DX12ShaderDescriptorHeap shaderHeap(pDevice, DX12ShaderDescriptorHeap::Desc{ 256, 128, 1 },
+        std::pmr::get_default_resource());
+
+    // typeless, so srgb mips are filtered in linear space and blocks are encoded from raw texels
+    auto texture = DX12::createTexture2D(pDevice, CD3DX12_RESOURCE_DESC::Tex2D(
+        DXGI_FORMAT_R8G8B8A8_TYPELESS, width, height, 1, gsl::narrow<uint16_t>(mipLevels), 1, 0,
+        D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS));
+
+    // source mips are tightly packed, upload rows are pitch aligned
+    MipFootprints layouts;
+    uint64_t uploadSize = 0;
+    {
+        const auto desc = texture->GetDesc();
+        pDevice->GetCopyableFootprints(&desc, 0, uploadMips, 0, layouts.data(), nullptr, nullptr, &uploadSize);
+    }
+    auto upload = createHostBuffer(pDevice, D3D12_HEAP_TYPE_UPLOAD, uploadSize, D3D12_RESOURCE_STATE_GENERIC_READ);
+    {
+        void* pMapped = nullptr;
+        V(upload->Map(0, &CD3DX12_RANGE(0, 0), &pMapped));
+        auto* pData = static_cast<std::byte*>(pMapped);
+        uint64_t offset = 0;
+        for (uint32_t mip = 0; mip != uploadMips; ++mip) {
+            const auto info = getMipInfo(source.mFormat, getMipExtent(width, mip), getMipExtent(height, mip));
+            Expects(offset + info.mSliceSize <= source.mBuffer.size());
+            for (uint32_t row = 0; row != info.mRowCount; ++row) {
+                memcpy(pData + layouts[mip].Offset + size_t(row) * layouts[mip].Footprint.RowPitch,
+                    source.mBuffer.data() + offset + size_t(row) * info.mRowPitchSize, info.mRowPitchSize);
+            }
+            offset += info.mSliceSize;
+
+            D3D12_TEXTURE_COPY_LOCATION Dst{ texture.get(), D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX, mip };
+            D3D12_TEXTURE_COPY_LOCATION Src{ upload.get(), D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT, layouts[mip] };
+            commandList->CopyTextureRegion(&Dst, 0, 0, 0, &Src, nullptr);
+        }
+        upload->Unmap(0, nullptr);
+    }
+    {
+        D3D12_RESOURCE_BARRIER barriers[] = {
+            CD3DX12_RESOURCE_BARRIER::Transition(texture.get(),
+                D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE),
+        };
+        commandList->ResourceBarrier(_countof(barriers), barriers);
+    }
+
+    ID3D12DescriptorHeap* ppHeaps[] = { shaderHeap.get() };
+    commandList->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
+    if (generateMips) {
+        dispatchDX12GenerateMips(pDevice, commandList.get(), shaderHeap, kernels,
+            texture.get(), sourceFormat == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB);
+    }
+
+    // blocks are read back in their footprint layout, no bc texture is needed
+    const auto target = CD3DX12_RESOURCE_DESC::Tex2D(targetFormat, width, height, 1,
+        gsl::narrow<uint16_t>(mipLevels));
+    auto blocks = createDX12CompressionBuffer(pDevice, target);
+    dispatchDX12CompressTexture(pDevice, commandList.get(), shaderHeap, kernels,
+        texture.get(), blocks.get(), target);
+
+    const auto blocksSize = blocks->GetDesc().Width;
+    auto readback = createHostBuffer(pDevice, D3D12_HEAP_TYPE_READBACK, blocksSize, D3D12_RESOURCE_STATE_COPY_DEST);
+    {
+        D3D12_RESOURCE_BARRIER barriers[] = {
+            CD3DX12_RESOURCE_BARRIER::Transition(blocks.get(),
+                D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_COPY_SOURCE),
+        };
+        commandList->ResourceBarrier(_countof(barriers), barriers);
+    }
+    commandList->CopyBufferRegion(readback.get(), 0, blocks.get(), 0, blocksSize);
+    V(commandList->Close());
+
+    ID3D12CommandList* ppCommandLists[] = { commandList.get() };
+    queue->ExecuteCommandLists(_countof(ppCommandLists), ppCommandLists);
+    uint64_t fenceValue = 0;
+    auto fence = DX12::createFence(pDevice, fenceValue, "Texture Encoder");
+    V(queue->Signal(fence.get(), fenceValue));
+    auto fenceEvent = DX12::createFenceEvent();
+    DX12::waitForFence(fence.get(), fenceEvent.get(), fenceValue);
+
+    encoded.mDesc = source.mDesc;
+    encoded.mDesc.mMipLevels = gsl::narrow<uint16_t>(mipLevels);
+    encoded.mDesc.mFormat = format;
+    encoded.mFormat = format;
+    uint64_t encodedSize = 0;
+    for (uint32_t mip = 0; mip != mipLevels; ++mip) {
+        encodedSize += getMipSize(format, getMipExtent(width, mip), getMipExtent(height, mip));
+    }
+    encoded.mBuffer.resize_aligned_uninitialized(gsl::narrow<size_t>(encodedSize));
+
+    pDevice->GetCopyableFootprints(&target, 0, mipLevels, 0, layouts.data(), nullptr, nullptr, nullptr);
+    void* pMapped = nullptr;
+    V(readback->Map(0, nullptr, &pMapped));
+    const auto* pData = static_cast<const std::byte*>(pMapped);
+    uint64_t offset = 0;
+    for (uint32_t mip = 0; mip != mipLevels; ++mip) {
+        const auto info = getMipInfo(format, getMipExtent(width, mip), getMipExtent(height, mip));
+        for (uint32_t row = 0; row != info.mRowCount; ++row) {
+            memcpy(encoded.mBuffer.data() + offset + size_t(row) * info.mRowPitchSize,
+                pData + layouts[mip].Offset + size_t(row) * layouts[mip].Footprint.RowPitch, info.mRowPitchSize);
+        }
+        offset += info.mSliceSize;
+    }
+    readback->Unmap(0, &CD3DX12_RANGE(0, 0));
+}
+
+}
@@ -0,0 +1,59 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <Star/DX12Engine/SConfig.h>
+#include <Star/DX12Engine/SDX12Types.h>
+
+namespace Star::Graphics::Render {
+
+class DX12ShaderDescriptorHeap;
+
+// compile the mip downsample and bc1, bc3 and bc7 block encoders
+DX12TextureKernels createDX12TextureKernels(ID3D12Device* pDevice);
+
+// bc1, bc3 and bc7 targets, unorm or srgb
+bool isDX12TextureCompressible(DXGI_FORMAT format) noexcept;
+
+// filter every mip after mip 0 from the previous one, the texture is created with unordered access
+// srgb textures are filtered in linear space and must be created typeless
+// texture is in NON_PIXEL_SHADER_RESOURCE state before and after
+void dispatchDX12GenerateMips(ID3D12Device* pDevice, ID3D12GraphicsCommandList* pCommandList,
+    DX12ShaderDescriptorHeap& shaderHeap, const DX12TextureKernels& kernels,
+    ID3D12Resource* pTexture, bool srgb);
+
+// unordered access buffer receiving the blocks of target, laid out like its copyable footprints
+com_ptr<ID3D12Resource> createDX12CompressionBuffer(ID3D12Device* pDevice,
+    const D3D12_RESOURCE_DESC& target);
+
+// encode every mip of source into blocks of the target format, source has the size and mips of the target
+// source is in NON_PIXEL_SHADER_RESOURCE state, blocks in UNORDERED_ACCESS state, before and after
+void dispatchDX12CompressTexture(ID3D12Device* pDevice, ID3D12GraphicsCommandList* pCommandList,
+    DX12ShaderDescriptorHeap& shaderHeap, const DX12TextureKernels& kernels,
+    ID3D12Resource* pSource, ID3D12Resource* pBlocks, const D3D12_RESOURCE_DESC& target);
+
+// copy encoded blocks to every mip of target, target is in COPY_DEST state
+void copyDX12CompressedBlocks(ID3D12Device* pDevice, ID3D12GraphicsCommandList* pCommandList,
+    ID3D12Resource* pBlocks, ID3D12Resource* pTarget);
+
+// gpu alternative of the asset builder encoder, runs on its own queue and waits for completion
+// source is rgba8 with its mips tightly packed like built textures, only mip 0 is read if mips are generated
+// encoded is tightly packed too, with the full mip chain if mips are generated
+STAR_VE_API void encodeDX12Texture(ID3D12Device* pDevice, const TextureData& source,
+    Format format, bool generateMips, TextureData& encoded);
+
+}
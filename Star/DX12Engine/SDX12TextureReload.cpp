@@ -0,0 +1,108 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "SDX12TextureReload.h"
+#include "SDX12Utils.h"
+#include "SDX12ShaderDescriptorHeap.h"
+#include "SDX12ReleaseQueue.h"
+#include "SDX12HeapAllocator.h"
+#include <Star/Core/SManagerFwd.h>
+
+namespace Star::Graphics::Render {
+
+void DX12TextureReloadQueue::enqueue(const MetaID& metaID) {
+    if (std::find(mPending.begin(), mPending.end(), metaID) == mPending.end()) {
+        mPending.emplace_back(metaID);
+    }
+}
+
+void DX12TextureReloadQueue::update(CreationContext& context, DX12Resources& resources) {
+    const auto completed = context.mUploadQueue->completedFence();
+    while (!mUploading.empty() && mUploading.front().mFence <= completed) {
+        auto& reload = mUploading.front();
+        auto& tex = *reload.mTexture;
+        // frames in flight may still sample the previous texture
+        context.mReleaseQueue->release(tex.mTexture);
+        tex.mTexture = std::move(reload.mStaging.mTexture);
+        tex.mMemory = std::move(reload.mStaging.mMemory);
+        tex.mTiles.clear();
+        tex.mFormat = reload.mStaging.mFormat;
+        tex.mTextureData = std::move(reload.mStaging.mTextureData);
+        for (const auto& handle : tex.mViewDescriptors) {
+            createDX12TextureView(context.mDevice, tex, handle);
+            context.mDescriptorHeap->publishPersistent(handle, 1);
+        }
+        mUploading.pop_front();
+    }
+
+    if (mPending.empty())
+        return;
+
+    const auto uploadingBegin = mUploading.size();
+    for (auto iter = mPending.begin(); iter != mPending.end();) {
+        const auto& metaID = *iter;
+        auto handle = resources.mTextures.find(metaID);
+        if (!handle || !resources.mTextures[handle].mTexture) {
+            // created later from the rebuilt data
+            iter = mPending.erase(iter);
+            continue;
+        }
+        auto& tex = resources.mTextures[handle];
+        const bool uploading = std::any_of(mUploading.begin(), mUploading.end(), [&](const Reload& reload) {
+            return reload.mTexture.get() == &tex;
+        });
+        if (uploading || !tex.mResident || tex.mResidentMip) {
+            ++iter;
+            continue;
+        }
+
+        if (mUploading.size() == uploadingBegin) {
+            context.record();
+        }
+
+        // the previous data is not read anymore, the rebuilt file replaces it
+        tex.mTextureData.reset();
+        Core::Workflow::reload(metaID, Core::Texture);
+
+        auto& reload = mUploading.emplace_back();
+        reload.mTexture = &tex;
+        auto& staging = reload.mStaging;
+        staging.mMetaID = metaID;
+        staging.mTextureData.reset(metaID, false);
+        Ensures(staging.mTextureData);
+        auto desc = getDX12(staging.mTextureData->mDesc);
+        desc.Format = getDXGIFormat(staging.mTextureData->mDesc.mFormat);
+        auto placed = context.mHeapAllocator->createTexture(desc, D3D12_RESOURCE_STATE_COPY_DEST);
+        staging.mTexture = std::move(placed.mResource);
+        staging.mMemory = std::move(placed.mMemory);
+        staging.mFormat = getDXGIFormat(staging.mTextureData->mFormat);
+        STAR_SET_DEBUG_NAME(staging.mTexture.get(), to_string(metaID) + " texture");
+        uploadDX12TextureData(context, staging);
+
+        iter = mPending.erase(iter);
+    }
+
+    if (mUploading.size() != uploadingBegin) {
+        const auto fence = context.flush();
+        for (auto i = uploadingBegin; i != mUploading.size(); ++i) {
+            mUploading[i].mFence = fence;
+        }
+    }
+    context.mMemoryArena->release();
+}
+
+}
@@ -0,0 +1,55 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <Star/DX12Engine/SDX12Types.h>
+
+namespace Star::Graphics::Render {
+
+struct CreationContext;
+
+// textures rebuilt on disk are read again and uploaded to new textures
+// frames keep sampling the previous texture until the upload completes,
+// then the texture is swapped and its views are rewritten in place
+class DX12TextureReloadQueue {
+public:
+    DX12TextureReloadQueue() = default;
+    DX12TextureReloadQueue(const DX12TextureReloadQueue&) = delete;
+    DX12TextureReloadQueue& operator=(const DX12TextureReloadQueue&) = delete;
+
+    bool empty() const noexcept {
+        return mPending.empty() && mUploading.empty();
+    }
+
+    void enqueue(const MetaID& metaID);
+
+    // swaps completed uploads in, then uploads pending textures
+    // streamed textures wait until all their mips are resident, textures never created are skipped
+    void update(CreationContext& context, DX12Resources& resources);
+private:
+    struct Reload {
+        boost::intrusive_ptr<DX12TextureData> mTexture;
+        // texture and data swapped in once uploaded
+        DX12TextureData mStaging;
+        uint64_t mFence = 0;
+    };
+
+    std::vector<MetaID> mPending;
+    std::deque<Reload> mUploading;
+};
+
+}
@@ -0,0 +1,121 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "SDX12TilePool.h"
+#include "SDX12Residency.h"
+#include <numeric>
+
+namespace Star::Graphics::Render {
+
+DX12TileRange::~DX12TileRange() {
+    mPool->release(mTiles);
+}
+
+DX12TilePool::DX12TilePool(ID3D12Device* pDevice, uint64_t size, DX12ResidencyManager* pResidency)
+    : mDevice(pDevice)
+    , mResidency(pResidency)
+    , mTileCount(gsl::narrow<uint32_t>(size / sTileSize))
+{
+    if (!mTileCount) {
+        throw std::invalid_argument("tile pool smaller than one tile");
+    }
+
+    D3D12_HEAP_DESC desc{};
+    desc.SizeInBytes = mTileCount * sTileSize;
+    desc.Properties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+    desc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+    desc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES;
+    V(mDevice->CreateHeap(&desc, IID_PPV_ARGS(mHeap.put())));
+    STAR_SET_DEBUG_NAME(mHeap, "TileHeap");
+
+    mFree.resize(mTileCount);
+    std::iota(mFree.rbegin(), mFree.rend(), 0u);
+
+    if (mResidency) {
+        mResidency->add(mHeap.get(), DX12TextureMemory, desc.SizeInBytes);
+    }
+}
+
+DX12TilePool::~DX12TilePool() {
+    if (mResidency) {
+        mResidency->remove(mHeap.get());
+    }
+}
+
+std::shared_ptr<const DX12TileRange> DX12TilePool::allocate(uint32_t tileCount) {
+    std::vector<uint32_t> tiles;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (mFree.size() < tileCount)
+            return {};
+        tiles.assign(mFree.rbegin(), mFree.rbegin() + tileCount);
+        mFree.resize(mFree.size() - tileCount);
+    }
+    return std::make_shared<const DX12TileRange>(this, std::move(tiles));
+}
+
+void DX12TilePool::map(ID3D12CommandQueue* pQueue, ID3D12Resource* pResource,
+    const D3D12_TILED_RESOURCE_COORDINATE& coord, const D3D12_TILE_REGION_SIZE& region,
+    const DX12TileRange& range
+) {
+    const auto& tiles = range.tiles();
+    Expects(tiles.size() == region.NumTiles);
+
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> counts;
+    for (size_t i = 0; i != tiles.size(); ++i) {
+        if (i && tiles[i] == tiles[i - 1] + 1) {
+            ++counts.back();
+        } else {
+            offsets.emplace_back(tiles[i]);
+            counts.emplace_back(1);
+        }
+    }
+
+    pQueue->UpdateTileMappings(pResource, 1, &coord, &region, mHeap.get(),
+        gsl::narrow_cast<uint32_t>(offsets.size()), nullptr,
+        offsets.data(), counts.data(), D3D12_TILE_MAPPING_FLAG_NONE);
+}
+
+void DX12TilePool::advanceFrame(uint64_t nextFence, uint64_t completedFence) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    // released tiles may still be read by every frame submitted so far
+    mRetireFence = nextFence ? nextFence - 1 : 0;
+
+    while (!mRetired.empty() && mRetired.front().mFence <= completedFence) {
+        auto& tiles = mRetired.front().mTiles;
+        mFree.insert(mFree.end(), tiles.rbegin(), tiles.rend());
+        mRetired.pop_front();
+    }
+
+    // mapped tiles may be sampled by any frame
+    if (mResidency) {
+        mResidency->use(mHeap.get(), nextFence);
+    }
+}
+
+uint32_t DX12TilePool::freeTileCount() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return gsl::narrow_cast<uint32_t>(mFree.size());
+}
+
+void DX12TilePool::release(std::vector<uint32_t>& tiles) noexcept {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mRetired.emplace_back(Retired{ std::move(tiles), mRetireFence });
+}
+
+}
@@ -0,0 +1,93 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <Star/DX12Engine/SDX12Types.h>
+
+namespace Star::Graphics::Render {
+
+class DX12TilePool;
+class DX12ResidencyManager;
+
+// tiles of the pool heap mapped to one region of a reserved resource
+// the tiles are reused once frames submitted before their release are complete
+class DX12TileRange {
+public:
+    DX12TileRange(DX12TilePool* pPool, std::vector<uint32_t> tiles) noexcept
+        : mPool(pPool)
+        , mTiles(std::move(tiles))
+    {}
+    DX12TileRange(const DX12TileRange&) = delete;
+    DX12TileRange& operator=(const DX12TileRange&) = delete;
+    ~DX12TileRange();
+
+    const std::vector<uint32_t>& tiles() const noexcept {
+        return mTiles;
+    }
+private:
+    DX12TilePool* mPool = nullptr;
+    std::vector<uint32_t> mTiles;
+};
+
+// one heap of 64KB tiles shared by reserved textures, its size is the vram budget of their mips
+// mips that do not fit stay unmapped and textures are viewed from their coarser mips
+class DX12TilePool {
+public:
+    static const uint64_t sTileSize = D3D12_TILED_RESOURCE_TILE_SIZE_IN_BYTES;
+
+    DX12TilePool(ID3D12Device* pDevice, uint64_t size, DX12ResidencyManager* pResidency = nullptr);
+    DX12TilePool(const DX12TilePool&) = delete;
+    DX12TilePool& operator=(const DX12TilePool&) = delete;
+    ~DX12TilePool();
+
+    // empty if fewer tiles are free
+    std::shared_ptr<const DX12TileRange> allocate(uint32_t tileCount);
+
+    // map the region to the tiles on the queue, runs of consecutive tiles share one range
+    void map(ID3D12CommandQueue* pQueue, ID3D12Resource* pResource,
+        const D3D12_TILED_RESOURCE_COORDINATE& coord, const D3D12_TILE_REGION_SIZE& region,
+        const DX12TileRange& tiles);
+
+    // tiles released before nextFence are reused once completedFence reaches their fence
+    void advanceFrame(uint64_t nextFence, uint64_t completedFence);
+
+    uint32_t tileCount() const noexcept {
+        return mTileCount;
+    }
+    uint32_t freeTileCount() const;
+private:
+    friend class DX12TileRange;
+
+    struct Retired {
+        std::vector<uint32_t> mTiles;
+        uint64_t mFence;
+    };
+
+    void release(std::vector<uint32_t>& tiles) noexcept;
+
+    ID3D12Device* mDevice = nullptr;
+    DX12ResidencyManager* mResidency = nullptr;
+    com_ptr<ID3D12Heap> mHeap;
+    uint32_t mTileCount = 0;
+    mutable std::mutex mMutex;
+    // popped from the back, lowest tiles first so neighbouring allocations stay consecutive
+    std::vector<uint32_t> mFree;
+    std::deque<Retired> mRetired;
+    uint64_t mRetireFence = 0;
+};
+
+}
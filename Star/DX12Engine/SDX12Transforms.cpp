@@ -0,0 +1,293 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "SDX12Transforms.h"
+#include "SDX12Culling.h"
+#include <xmmintrin.h>
+#include <atomic>
+
+namespace Star::Graphics::Render {
+
+namespace {
+
+constexpr uint32_t sLanes = 4;
+constexpr uint32_t sFloatsPerBlock = sizeof(DX12FloatBlock) / sizeof(float);
+
+std::atomic<uint64_t> sTransformVersion = 0;
+
+const float* getTransforms(const DX12FlattenedObjects& batch, uint32_t component) noexcept {
+    return batch.mTransformsSoA.data()->mData + size_t(component) * batch.mTransformStride;
+}
+
+Affine3f getTransform(const DX12FlattenedObjects& batch, uint32_t componentBegin, uint32_t objectID) noexcept {
+    Expects(objectID < batch.mObjectCount);
+    Affine3f transform;
+    for (uint32_t c = 0; c != 4; ++c) {
+        for (uint32_t r = 0; r != 3; ++r) {
+            transform.matrix()(r, c) = getTransforms(batch, componentBegin + c * 3 + r)[objectID];
+        }
+    }
+    transform.makeAffine();
+    return transform;
+}
+
+// lanes of objects, contiguous objects are loaded directly, others are gathered
+struct ObjectLanes {
+    ObjectLanes(const uint32_t* pObjects, uint32_t count) noexcept
+        : mCount(count)
+    {
+        for (uint32_t k = 0; k != sLanes; ++k) {
+            mObjects[k] = pObjects[std::min(k, count - 1)];
+        }
+        mContiguous = count == sLanes &&
+            mObjects[1] == mObjects[0] + 1 &&
+            mObjects[2] == mObjects[0] + 2 &&
+            mObjects[3] == mObjects[0] + 3;
+    }
+
+    __m128 load(const float* pData) const noexcept {
+        if (mContiguous)
+            return _mm_loadu_ps(pData + mObjects[0]);
+        return _mm_setr_ps(pData[mObjects[0]], pData[mObjects[1]], pData[mObjects[2]], pData[mObjects[3]]);
+    }
+
+    // rows hold one matrix element per lane, stored as columns of each object
+    void store(__m128 r0, __m128 r1, __m128 r2, __m128 r3,
+        uint32_t column, std::byte* pDst, size_t dstStride) const noexcept {
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+        const __m128 rows[sLanes] = { r0, r1, r2, r3 };
+        for (uint32_t k = 0; k != mCount; ++k) {
+            _mm_storeu_ps(reinterpret_cast<float*>(pDst + k * dstStride) + 4 * column, rows[k]);
+        }
+    }
+
+    uint32_t mObjects[sLanes];
+    uint32_t mCount = 0;
+    bool mContiguous = false;
+};
+
+// copy the world of an object into its previous world
+void copyPrevTransform(DX12FlattenedObjects& batch, uint32_t objectID) noexcept {
+    float* pData = batch.mTransformsSoA.data()->mData;
+    const auto stride = batch.mTransformStride;
+    for (uint32_t component = 0; component != DX12TransformComponents; ++component) {
+        pData[size_t(DX12PrevTransformComponentBegin + component) * stride + objectID] =
+            pData[size_t(component) * stride + objectID];
+    }
+}
+
+// view * world of objects, world components start at componentBegin
+void writeWorldViews(const DX12FlattenedObjects& batch, uint32_t componentBegin, const Matrix4f& view,
+    const uint32_t* pObjects, uint32_t count, std::byte* pDst, size_t dstStride
+) noexcept {
+    __m128 v[4][4];
+    for (int i = 0; i != 4; ++i) {
+        for (int r = 0; r != 4; ++r) {
+            v[i][r] = _mm_set1_ps(view(i, r));
+        }
+    }
+
+    for (uint32_t k = 0; k < count; k += sLanes) {
+        const ObjectLanes lanes(pObjects + k, std::min(sLanes, count - k));
+        auto* pOut = pDst + k * dstStride;
+
+        // world has an implicit (0, 0, 0, 1) last row
+        for (uint32_t c = 0; c != 4; ++c) {
+            const __m128 w0 = lanes.load(getTransforms(batch, componentBegin + c * 3 + 0));
+            const __m128 w1 = lanes.load(getTransforms(batch, componentBegin + c * 3 + 1));
+            const __m128 w2 = lanes.load(getTransforms(batch, componentBegin + c * 3 + 2));
+            __m128 out[4];
+            for (int i = 0; i != 4; ++i) {
+                out[i] = _mm_add_ps(_mm_add_ps(
+                    _mm_mul_ps(v[i][0], w0), _mm_mul_ps(v[i][1], w1)), _mm_mul_ps(v[i][2], w2));
+                if (c == 3) {
+                    out[i] = _mm_add_ps(out[i], v[i][3]);
+                }
+            }
+            lanes.store(out[0], out[1], out[2], out[3], c, pOut, dstStride);
+        }
+    }
+}
+
+}
+
+void buildDX12Transforms(DX12FlattenedObjects& batch,
+    const std::pmr::vector<WorldTransform>& worlds,
+    const std::pmr::vector<WorldTransformInv>& worldInvs
+) {
+    Expects(worlds.size() == worldInvs.size());
+    const auto count = gsl::narrow_cast<uint32_t>(worlds.size());
+    const auto stride = gsl::narrow_cast<uint32_t>(boost::alignment::align_up(count, sFloatsPerBlock));
+    batch.mObjectCount = count;
+    batch.mTransformStride = stride;
+    batch.mTransformsSoA.assign(DX12TransformSoAComponents * size_t(stride) / sFloatsPerBlock, DX12FloatBlock{});
+    batch.mTransformVersions.assign(count, 0);
+    batch.mMovedObjects.clear();
+    batch.mFrameTransformVersion = 0;
+    if (!count)
+        return;
+
+    float* pData = batch.mTransformsSoA.data()->mData;
+    for (uint32_t i = 0; i != count; ++i) {
+        const auto& world = worlds[i].mTransform.matrix();
+        const auto& worldInv = worldInvs[i].mTransform.matrix();
+        for (uint32_t c = 0; c != 4; ++c) {
+            for (uint32_t r = 0; r != 3; ++r) {
+                const auto component = c * 3 + r;
+                pData[size_t(component) * stride + i] = world(r, c);
+                pData[size_t(DX12TransformComponents + component) * stride + i] = worldInv(r, c);
+                pData[size_t(DX12PrevTransformComponentBegin + component) * stride + i] = world(r, c);
+            }
+        }
+    }
+}
+
+void setDX12WorldTransform(DX12FlattenedObjects& batch, uint32_t objectID, const Affine3f& world) {
+    Expects(objectID < batch.mObjectCount);
+    const Affine3f worldInv = world.inverse();
+
+    // later changes of the same frame keep the previous world
+    if (batch.mTransformVersions[objectID] <= batch.mFrameTransformVersion) {
+        copyPrevTransform(batch, objectID);
+        batch.mMovedObjects.emplace_back(objectID);
+    }
+
+    float* pData = batch.mTransformsSoA.data()->mData;
+    const auto stride = batch.mTransformStride;
+    for (uint32_t c = 0; c != 4; ++c) {
+        for (uint32_t r = 0; r != 3; ++r) {
+            const auto component = c * 3 + r;
+            pData[size_t(component) * stride + objectID] = world.matrix()(r, c);
+            pData[size_t(DX12TransformComponents + component) * stride + objectID] = worldInv.matrix()(r, c);
+        }
+    }
+    batch.mTransformVersions[objectID] = ++sTransformVersion;
+    batch.mLatestTransformVersion = std::max(batch.mLatestTransformVersion, batch.mTransformVersions[objectID]);
+
+    if (objectID < batch.mWorldBoundsStride) {
+        updateDX12WorldBounds(batch, objectID);
+    }
+    // hierarchy bounds are baked, fall back to linear culling
+    batch.mBvhNodes.clear();
+    batch.mBvhObjects.clear();
+    batch.mBvhUnbounded.clear();
+}
+
+void syncDX12PrevTransforms(DX12FlattenedObjects& batch) {
+    for (const auto objectID : batch.mMovedObjects) {
+        copyPrevTransform(batch, objectID);
+        batch.mTransformVersions[objectID] = ++sTransformVersion;
+        batch.mLatestTransformVersion = batch.mTransformVersions[objectID];
+    }
+    batch.mMovedObjects.clear();
+    batch.mFrameTransformVersion = sTransformVersion.load();
+}
+
+uint64_t getDX12TransformVersion() noexcept {
+    return sTransformVersion.load();
+}
+
+DX12TransformWriteBuffer::DX12TransformWriteBuffer(const allocator_type& alloc)
+    : mWrites(alloc)
+    , mApplying(alloc)
+{}
+
+void DX12TransformWriteBuffer::write(const ObjectHandle& object, const Affine3f& world) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mWrites.emplace_back(DX12TransformWrite{ object, world });
+}
+
+const std::pmr::vector<DX12TransformWrite>& DX12TransformWriteBuffer::swap() {
+    // capacity of both buffers is kept, steady frames do not allocate
+    mApplying.clear();
+    std::lock_guard<std::mutex> lock(mMutex);
+    mWrites.swap(mApplying);
+    return mApplying;
+}
+
+void applyDX12TransformWrites(DX12Resources& resources,
+    const std::pmr::vector<DX12TransformWrite>& writes) {
+    for (auto& content : resources.mContents) {
+        for (auto& batch : content.mFlattenedObjects) {
+            syncDX12PrevTransforms(batch);
+        }
+    }
+    if (writes.empty())
+        return;
+
+    // writes of the same content are usually adjacent
+    DX12ContentData* pContent = nullptr;
+    for (const auto& write : writes) {
+        const auto& object = write.mObject;
+        if (!pContent || pContent->mMetaID != object.mContentID) {
+            pContent = resources.mContents.get(resources.mContents.find(object.mContentID));
+        }
+        if (!pContent || object.mBatchID >= pContent->mFlattenedObjects.size())
+            continue;
+        auto& batch = pContent->mFlattenedObjects[object.mBatchID];
+        if (object.mObjectID >= batch.mObjectCount)
+            continue;
+        setDX12WorldTransform(batch, object.mObjectID, write.mWorld);
+    }
+}
+
+Affine3f getDX12WorldTransform(const DX12FlattenedObjects& batch, uint32_t objectID) noexcept {
+    return getTransform(batch, 0, objectID);
+}
+
+Affine3f getDX12WorldTransformInv(const DX12FlattenedObjects& batch, uint32_t objectID) noexcept {
+    return getTransform(batch, DX12TransformComponents, objectID);
+}
+
+Affine3f getDX12PrevWorldTransform(const DX12FlattenedObjects& batch, uint32_t objectID) noexcept {
+    return getTransform(batch, DX12PrevTransformComponentBegin, objectID);
+}
+
+void writeDX12WorldViews(const DX12FlattenedObjects& batch, const Matrix4f& view,
+    const uint32_t* pObjects, uint32_t count, std::byte* pDst, size_t dstStride
+) noexcept {
+    writeWorldViews(batch, 0, view, pObjects, count, pDst, dstStride);
+}
+
+void writeDX12PrevWorldViews(const DX12FlattenedObjects& batch, const Matrix4f& prevView,
+    const uint32_t* pObjects, uint32_t count, std::byte* pDst, size_t dstStride
+) noexcept {
+    writeWorldViews(batch, DX12PrevTransformComponentBegin, prevView, pObjects, count, pDst, dstStride);
+}
+
+void writeDX12WorldInvTs(const DX12FlattenedObjects& batch,
+    const uint32_t* pObjects, uint32_t count, std::byte* pDst, size_t dstStride
+) noexcept {
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+
+    for (uint32_t k = 0; k < count; k += sLanes) {
+        const ObjectLanes lanes(pObjects + k, std::min(sLanes, count - k));
+        auto* pOut = pDst + k * dstStride;
+
+        for (uint32_t c = 0; c != 4; ++c) {
+            const auto component = DX12TransformComponents + c * 3;
+            lanes.store(
+                lanes.load(getTransforms(batch, component + 0)),
+                lanes.load(getTransforms(batch, component + 1)),
+                lanes.load(getTransforms(batch, component + 2)),
+                c == 3 ? one : zero, c, pOut, dstStride);
+        }
+    }
+}
+
+}
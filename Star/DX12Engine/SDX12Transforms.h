@@ -0,0 +1,92 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <Star/DX12Engine/SDX12Types.h>
+#include <Star/Graphics/SRenderEngine.h>
+
+namespace Star::Graphics::Render {
+
+// SoA components of a transform: 3x4 column major, world, inverse world, then world of the previous frame
+constexpr uint32_t DX12TransformComponents = 12;
+constexpr uint32_t DX12PrevTransformComponentBegin = 2 * DX12TransformComponents;
+constexpr uint32_t DX12TransformSoAComponents = 3 * DX12TransformComponents;
+
+// convert content transforms into the SoA store, rows padded to cache lines
+void buildDX12Transforms(DX12FlattenedObjects& batch,
+    const std::pmr::vector<WorldTransform>& worlds,
+    const std::pmr::vector<WorldTransformInv>& worldInvs);
+
+// change the transform of an object, its world bounds and version are updated
+// the first change of a frame keeps the world rendered by the previous frame as previous world
+void setDX12WorldTransform(DX12FlattenedObjects& batch, uint32_t objectID, const Affine3f& world);
+
+// once a frame before transform writes, objects moved by the previous frame stop moving
+// their previous world is set to their world and their version bumped so constants are rewritten
+void syncDX12PrevTransforms(DX12FlattenedObjects& batch);
+
+// latest version given to a transform change, objects changed after a sync have greater versions
+uint64_t getDX12TransformVersion() noexcept;
+
+struct DX12TransformWrite {
+    ObjectHandle mObject;
+    Affine3f mWorld;
+};
+
+// two write buffers, game threads fill one while the render thread applies the other
+class DX12TransformWriteBuffer {
+public:
+    using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+
+    DX12TransformWriteBuffer(const allocator_type& alloc);
+    DX12TransformWriteBuffer(const DX12TransformWriteBuffer&) = delete;
+    DX12TransformWriteBuffer& operator=(const DX12TransformWriteBuffer&) = delete;
+
+    // any thread
+    void write(const ObjectHandle& object, const Affine3f& world);
+    // render thread, returns writes since the last swap, valid until the next swap
+    const std::pmr::vector<DX12TransformWrite>& swap();
+private:
+    std::mutex mMutex;
+    // guarded by mMutex
+    std::pmr::vector<DX12TransformWrite> mWrites;
+    // render thread only
+    std::pmr::vector<DX12TransformWrite> mApplying;
+};
+
+// once a frame, previous transforms of every loaded content are synced first
+// writes to contents that are not loaded or objects out of range are dropped
+void applyDX12TransformWrites(DX12Resources& resources,
+    const std::pmr::vector<DX12TransformWrite>& writes);
+
+Affine3f getDX12WorldTransform(const DX12FlattenedObjects& batch, uint32_t objectID) noexcept;
+Affine3f getDX12WorldTransformInv(const DX12FlattenedObjects& batch, uint32_t objectID) noexcept;
+Affine3f getDX12PrevWorldTransform(const DX12FlattenedObjects& batch, uint32_t objectID) noexcept;
+
+// write view * world of objects as column major float4x4, one every dstStride bytes
+void writeDX12WorldViews(const DX12FlattenedObjects& batch, const Matrix4f& view,
+    const uint32_t* pObjects, uint32_t count, std::byte* pDst, size_t dstStride) noexcept;
+
+// write previous view * previous world of objects as column major float4x4, one every dstStride bytes
+void writeDX12PrevWorldViews(const DX12FlattenedObjects& batch, const Matrix4f& prevView,
+    const uint32_t* pObjects, uint32_t count, std::byte* pDst, size_t dstStride) noexcept;
+
+// write inverse world of objects as column major float4x4, one every dstStride bytes
+void writeDX12WorldInvTs(const DX12FlattenedObjects& batch,
+    const uint32_t* pObjects, uint32_t count, std::byte* pDst, size_t dstStride) noexcept;
+
+}
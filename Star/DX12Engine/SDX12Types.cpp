@@ -30,6 +30,9 @@ DX12MeshData::allocator_type DX12MeshData::get_allocator() const noexcept {
 DX12MeshData::DX12MeshData(const allocator_type& alloc)
     : mVertexBufferViews(alloc)
     , mSubMeshes(alloc)
+    , mMeshlets(alloc)
+    , mLods(alloc)
+    , mLodSubMeshes(alloc)
     , mVertexBuffers(alloc)
     , mLayoutName(alloc)
 {}
@@ -38,6 +41,9 @@ DX12MeshData::DX12MeshData(MetaID metaID, const allocator_type& alloc)
     : mMetaID(std::move(metaID))
     , mVertexBufferViews(alloc)
     , mSubMeshes(alloc)
+    , mMeshlets(alloc)
+    , mLods(alloc)
+    , mLodSubMeshes(alloc)
     , mVertexBuffers(alloc)
     , mLayoutName(alloc)
 {}
@@ -47,12 +53,20 @@ DX12MeshData::DX12MeshData(DX12MeshData const& rhs, const allocator_type& alloc)
     , mVertexBufferViews(rhs.mVertexBufferViews, alloc)
     , mIndexBufferView(rhs.mIndexBufferView)
     , mSubMeshes(rhs.mSubMeshes, alloc)
+    , mMeshlets(rhs.mMeshlets, alloc)
+    , mLods(rhs.mLods, alloc)
+    , mLodSubMeshes(rhs.mLodSubMeshes, alloc)
     , mVertexBuffers(rhs.mVertexBuffers, alloc)
     , mIndexBuffer(rhs.mIndexBuffer)
     , mMeshData(rhs.mMeshData)
     , mRefCount(rhs.mRefCount)
     , mLayoutID(rhs.mLayoutID)
     , mLayoutName(rhs.mLayoutName, alloc)
+    , mResident(rhs.mResident)
+    , mPage(rhs.mPage)
+    , mBaseVertex(rhs.mBaseVertex)
+    , mBaseIndex(rhs.mBaseIndex)
+    , mReleaseQueue(rhs.mReleaseQueue)
 {}
 
 DX12MeshData::DX12MeshData(DX12MeshData&& rhs, const allocator_type& alloc)
@@ -60,12 +74,20 @@ DX12MeshData::DX12MeshData(DX12MeshData&& rhs, const allocator_type& alloc)
     , mVertexBufferViews(std::move(rhs.mVertexBufferViews), alloc)
     , mIndexBufferView(std::move(rhs.mIndexBufferView))
     , mSubMeshes(std::move(rhs.mSubMeshes), alloc)
+    , mMeshlets(std::move(rhs.mMeshlets), alloc)
+    , mLods(std::move(rhs.mLods), alloc)
+    , mLodSubMeshes(std::move(rhs.mLodSubMeshes), alloc)
     , mVertexBuffers(std::move(rhs.mVertexBuffers), alloc)
     , mIndexBuffer(std::move(rhs.mIndexBuffer))
     , mMeshData(std::move(rhs.mMeshData))
     , mRefCount(std::move(rhs.mRefCount))
     , mLayoutID(std::move(rhs.mLayoutID))
     , mLayoutName(std::move(rhs.mLayoutName), alloc)
+    , mResident(std::move(rhs.mResident))
+    , mPage(std::move(rhs.mPage))
+    , mBaseVertex(std::move(rhs.mBaseVertex))
+    , mBaseIndex(std::move(rhs.mBaseIndex))
+    , mReleaseQueue(std::move(rhs.mReleaseQueue))
 {}
 
 DX12MeshData::~DX12MeshData() = default;
@@ -87,6 +109,7 @@ DX12ShaderSubpassData::DX12ShaderSubpassData(DX12ShaderSubpassData const& rhs, c
     , mVertexLayoutIndex(rhs.mVertexLayoutIndex, alloc)
     , mConstantBuffers(rhs.mConstantBuffers, alloc)
     , mDescriptors(rhs.mDescriptors, alloc)
+    , mBackfaceCulling(rhs.mBackfaceCulling)
 {}
 
 DX12ShaderSubpassData::DX12ShaderSubpassData(DX12ShaderSubpassData&& rhs, const allocator_type& alloc)
@@ -95,6 +118,7 @@ DX12ShaderSubpassData::DX12ShaderSubpassData(DX12ShaderSubpassData&& rhs, const
     , mVertexLayoutIndex(std::move(rhs.mVertexLayoutIndex), alloc)
     , mConstantBuffers(std::move(rhs.mConstantBuffers), alloc)
     , mDescriptors(std::move(rhs.mDescriptors), alloc)
+    , mBackfaceCulling(std::move(rhs.mBackfaceCulling))
 {}
 
 DX12ShaderSubpassData::~DX12ShaderSubpassData() = default;
@@ -414,6 +438,8 @@ DX12MaterialData::DX12MaterialData(DX12MaterialData const& rhs, const allocator_
     , mDescriptorHeap(rhs.mDescriptorHeap)
     , mShaderData(rhs.mShaderData, alloc)
     , mTextures(rhs.mTextures, alloc)
+    , mTextureIndices(rhs.mTextureIndices)
+    , mConstantIndex(rhs.mConstantIndex)
     , mConstantMap(rhs.mConstantMap, alloc)
     , mMaterialData(rhs.mMaterialData)
     , mRefCount(rhs.mRefCount)
@@ -425,6 +451,8 @@ DX12MaterialData::DX12MaterialData(DX12MaterialData&& rhs, const allocator_type&
     , mDescriptorHeap(std::move(rhs.mDescriptorHeap))
     , mShaderData(std::move(rhs.mShaderData), alloc)
     , mTextures(std::move(rhs.mTextures), alloc)
+    , mTextureIndices(std::move(rhs.mTextureIndices))
+    , mConstantIndex(std::move(rhs.mConstantIndex))
     , mConstantMap(std::move(rhs.mConstantMap), alloc)
     , mMaterialData(std::move(rhs.mMaterialData))
     , mRefCount(std::move(rhs.mRefCount))
@@ -481,52 +509,80 @@ DX12MeshRenderer::DX12MeshRenderer(DX12MeshRenderer&& rhs, const allocator_type&
 DX12MeshRenderer::~DX12MeshRenderer() = default;
 
 DX12FlattenedObjects::allocator_type DX12FlattenedObjects::get_allocator() const noexcept {
-    return allocator_type(mWorldTransforms.get_allocator().resource());
+    return allocator_type(mTransformsSoA.get_allocator().resource());
 }
 
 DX12FlattenedObjects::DX12FlattenedObjects(const allocator_type& alloc)
-    : mWorldTransforms(alloc)
-    , mWorldTransformInvs(alloc)
+    : mTransformsSoA(alloc)
+    , mTransformVersions(alloc)
+    , mMovedObjects(alloc)
     , mBoundingBoxes(alloc)
     , mMeshRenderers(alloc)
+    , mWorldBoundsSoA(alloc)
+    , mBvhNodes(alloc)
+    , mBvhObjects(alloc)
+    , mBvhUnbounded(alloc)
 {}
 
 DX12FlattenedObjects::DX12FlattenedObjects(DX12FlattenedObjects const& rhs, const allocator_type& alloc)
-    : mWorldTransforms(rhs.mWorldTransforms, alloc)
-    , mWorldTransformInvs(rhs.mWorldTransformInvs, alloc)
+    : mTransformsSoA(rhs.mTransformsSoA, alloc)
+    , mTransformStride(rhs.mTransformStride)
+    , mObjectCount(rhs.mObjectCount)
+    , mTransformVersions(rhs.mTransformVersions, alloc)
+    , mLatestTransformVersion(rhs.mLatestTransformVersion)
+    , mMovedObjects(rhs.mMovedObjects, alloc)
+    , mFrameTransformVersion(rhs.mFrameTransformVersion)
     , mBoundingBoxes(rhs.mBoundingBoxes, alloc)
     , mMeshRenderers(rhs.mMeshRenderers, alloc)
+    , mWorldBoundsSoA(rhs.mWorldBoundsSoA, alloc)
+    , mWorldBoundsStride(rhs.mWorldBoundsStride)
+    , mBvhNodes(rhs.mBvhNodes, alloc)
+    , mBvhObjects(rhs.mBvhObjects, alloc)
+    , mBvhUnbounded(rhs.mBvhUnbounded, alloc)
 {}
 
 DX12FlattenedObjects::DX12FlattenedObjects(DX12FlattenedObjects&& rhs, const allocator_type& alloc)
-    : mWorldTransforms(std::move(rhs.mWorldTransforms), alloc)
-    , mWorldTransformInvs(std::move(rhs.mWorldTransformInvs), alloc)
+    : mTransformsSoA(std::move(rhs.mTransformsSoA), alloc)
+    , mTransformStride(std::move(rhs.mTransformStride))
+    , mObjectCount(std::move(rhs.mObjectCount))
+    , mTransformVersions(std::move(rhs.mTransformVersions), alloc)
+    , mLatestTransformVersion(rhs.mLatestTransformVersion)
+    , mMovedObjects(std::move(rhs.mMovedObjects), alloc)
+    , mFrameTransformVersion(rhs.mFrameTransformVersion)
     , mBoundingBoxes(std::move(rhs.mBoundingBoxes), alloc)
     , mMeshRenderers(std::move(rhs.mMeshRenderers), alloc)
+    , mWorldBoundsSoA(std::move(rhs.mWorldBoundsSoA), alloc)
+    , mWorldBoundsStride(std::move(rhs.mWorldBoundsStride))
+    , mBvhNodes(std::move(rhs.mBvhNodes), alloc)
+    , mBvhObjects(std::move(rhs.mBvhObjects), alloc)
+    , mBvhUnbounded(std::move(rhs.mBvhUnbounded), alloc)
 {}
 
 DX12FlattenedObjects::~DX12FlattenedObjects() = default;
 
 DX12ContentData::allocator_type DX12ContentData::get_allocator() const noexcept {
-    return allocator_type(mIDs.get_allocator().resource());
+    return allocator_type(mDrawCallIDs.get_allocator().resource());
 }
 
 DX12ContentData::DX12ContentData(const allocator_type& alloc)
-    : mIDs(alloc)
+    : mDrawCallIDs(alloc)
+    , mBatchIDs(alloc)
     , mDrawCalls(alloc)
     , mFlattenedObjects(alloc)
 {}
 
 DX12ContentData::DX12ContentData(MetaID metaID, const allocator_type& alloc)
     : mMetaID(std::move(metaID))
-    , mIDs(alloc)
+    , mDrawCallIDs(alloc)
+    , mBatchIDs(alloc)
     , mDrawCalls(alloc)
     , mFlattenedObjects(alloc)
 {}
 
 DX12ContentData::DX12ContentData(DX12ContentData const& rhs, const allocator_type& alloc)
     : mMetaID(rhs.mMetaID)
-    , mIDs(rhs.mIDs, alloc)
+    , mDrawCallIDs(rhs.mDrawCallIDs, alloc)
+    , mBatchIDs(rhs.mBatchIDs, alloc)
     , mDrawCalls(rhs.mDrawCalls, alloc)
     , mFlattenedObjects(rhs.mFlattenedObjects, alloc)
     , mContentData(rhs.mContentData)
@@ -535,7 +591,8 @@ DX12ContentData::DX12ContentData(DX12ContentData const& rhs, const allocator_typ
 
 DX12ContentData::DX12ContentData(DX12ContentData&& rhs, const allocator_type& alloc)
     : mMetaID(std::move(rhs.mMetaID))
-    , mIDs(std::move(rhs.mIDs), alloc)
+    , mDrawCallIDs(std::move(rhs.mDrawCallIDs), alloc)
+    , mBatchIDs(std::move(rhs.mBatchIDs), alloc)
     , mDrawCalls(std::move(rhs.mDrawCalls), alloc)
     , mFlattenedObjects(std::move(rhs.mFlattenedObjects), alloc)
     , mContentData(std::move(rhs.mContentData))
@@ -550,14 +607,39 @@ DX12UnorderedRenderQueue::allocator_type DX12UnorderedRenderQueue::get_allocator
 
 DX12UnorderedRenderQueue::DX12UnorderedRenderQueue(const allocator_type& alloc)
     : mContents(alloc)
+    , mDrawPackets(alloc)
+    , mDrawBindings(alloc)
+    , mDrawDescriptors(alloc)
+    , mDrawConstants(alloc)
+    , mDrawInstances(alloc)
+    , mIndirectGroups(alloc)
+    , mPersistentOffsets(alloc)
 {}
 
 DX12UnorderedRenderQueue::DX12UnorderedRenderQueue(DX12UnorderedRenderQueue const& rhs, const allocator_type& alloc)
     : mContents(rhs.mContents, alloc)
+    , mDrawPackets(rhs.mDrawPackets, alloc)
+    , mDrawBindings(rhs.mDrawBindings, alloc)
+    , mDrawDescriptors(rhs.mDrawDescriptors, alloc)
+    , mDrawConstants(rhs.mDrawConstants, alloc)
+    , mDrawInstances(rhs.mDrawInstances, alloc)
+    , mIndirectGroups(rhs.mIndirectGroups, alloc)
+    , mIndirectBuffers(rhs.mIndirectBuffers)
+    , mPersistentOffsets(rhs.mPersistentOffsets, alloc)
+    , mPersistentConstants(rhs.mPersistentConstants)
 {}
 
 DX12UnorderedRenderQueue::DX12UnorderedRenderQueue(DX12UnorderedRenderQueue&& rhs, const allocator_type& alloc)
     : mContents(std::move(rhs.mContents), alloc)
+    , mDrawPackets(std::move(rhs.mDrawPackets), alloc)
+    , mDrawBindings(std::move(rhs.mDrawBindings), alloc)
+    , mDrawDescriptors(std::move(rhs.mDrawDescriptors), alloc)
+    , mDrawConstants(std::move(rhs.mDrawConstants), alloc)
+    , mDrawInstances(std::move(rhs.mDrawInstances), alloc)
+    , mIndirectGroups(std::move(rhs.mIndirectGroups), alloc)
+    , mIndirectBuffers(std::move(rhs.mIndirectBuffers))
+    , mPersistentOffsets(std::move(rhs.mPersistentOffsets), alloc)
+    , mPersistentConstants(std::move(rhs.mPersistentConstants))
 {}
 
 DX12UnorderedRenderQueue::~DX12UnorderedRenderQueue() = default;
@@ -572,6 +654,7 @@ DX12GraphicsSubpass::DX12GraphicsSubpass(const allocator_type& alloc)
     , mResolveAttachments(alloc)
     , mPreserveAttachments(alloc)
     , mPostViewTransitions(alloc)
+    , mAliasingBarriers(alloc)
     , mOrderedRenderQueue(alloc)
     , mConstantBuffers(alloc)
     , mDescriptors(alloc)
@@ -585,10 +668,22 @@ DX12GraphicsSubpass::DX12GraphicsSubpass(DX12GraphicsSubpass const& rhs, const a
     , mDepthStencilAttachment(rhs.mDepthStencilAttachment)
     , mPreserveAttachments(rhs.mPreserveAttachments, alloc)
     , mPostViewTransitions(rhs.mPostViewTransitions, alloc)
+    , mAliasingBarriers(rhs.mAliasingBarriers, alloc)
     , mOrderedRenderQueue(rhs.mOrderedRenderQueue, alloc)
     , mRootSignature(rhs.mRootSignature)
+    , mRootSignatureHash(rhs.mRootSignatureHash)
     , mConstantBuffers(rhs.mConstantBuffers, alloc)
     , mDescriptors(rhs.mDescriptors, alloc)
+    , mOcclusionCulling(rhs.mOcclusionCulling)
+    , mOcclusion(rhs.mOcclusion)
+    , mLightCulling(rhs.mLightCulling)
+    , mLights(rhs.mLights)
+    , mShadowCaching(rhs.mShadowCaching)
+    , mShadowCache(rhs.mShadowCache)
+    , mShadingRate(rhs.mShadingRate)
+    , mShadingRateImage(rhs.mShadingRateImage)
+    , mView(rhs.mView)
+    , mUpscaling(rhs.mUpscaling)
 {}
 
 DX12GraphicsSubpass::DX12GraphicsSubpass(DX12GraphicsSubpass&& rhs, const allocator_type& alloc)
@@ -599,10 +694,22 @@ DX12GraphicsSubpass::DX12GraphicsSubpass(DX12GraphicsSubpass&& rhs, const alloca
     , mDepthStencilAttachment(std::move(rhs.mDepthStencilAttachment))
     , mPreserveAttachments(std::move(rhs.mPreserveAttachments), alloc)
     , mPostViewTransitions(std::move(rhs.mPostViewTransitions), alloc)
+    , mAliasingBarriers(std::move(rhs.mAliasingBarriers), alloc)
     , mOrderedRenderQueue(std::move(rhs.mOrderedRenderQueue), alloc)
     , mRootSignature(std::move(rhs.mRootSignature))
+    , mRootSignatureHash(std::move(rhs.mRootSignatureHash))
     , mConstantBuffers(std::move(rhs.mConstantBuffers), alloc)
     , mDescriptors(std::move(rhs.mDescriptors), alloc)
+    , mOcclusionCulling(std::move(rhs.mOcclusionCulling))
+    , mOcclusion(std::move(rhs.mOcclusion))
+    , mLightCulling(std::move(rhs.mLightCulling))
+    , mLights(std::move(rhs.mLights))
+    , mShadowCaching(std::move(rhs.mShadowCaching))
+    , mShadowCache(std::move(rhs.mShadowCache))
+    , mShadingRate(std::move(rhs.mShadingRate))
+    , mShadingRateImage(std::move(rhs.mShadingRateImage))
+    , mView(std::move(rhs.mView))
+    , mUpscaling(std::move(rhs.mUpscaling))
 {}
 
 DX12GraphicsSubpass::~DX12GraphicsSubpass() = default;
@@ -703,6 +810,7 @@ DX12RenderSolution::DX12RenderSolution(DX12RenderSolution const& rhs, const allo
     , mUAVs(rhs.mUAVs, alloc)
     , mAttributeIndex(rhs.mAttributeIndex, alloc)
     , mPipelineIndex(rhs.mPipelineIndex, alloc)
+    , mOutputColorSpace(rhs.mOutputColorSpace)
 {}
 
 DX12RenderSolution::DX12RenderSolution(DX12RenderSolution&& rhs, const allocator_type& alloc)
@@ -720,6 +828,7 @@ DX12RenderSolution::DX12RenderSolution(DX12RenderSolution&& rhs, const allocator
     , mUAVs(std::move(rhs.mUAVs), alloc)
     , mAttributeIndex(std::move(rhs.mAttributeIndex), alloc)
     , mPipelineIndex(std::move(rhs.mPipelineIndex), alloc)
+    , mOutputColorSpace(std::move(rhs.mOutputColorSpace))
 {}
 
 DX12RenderSolution::~DX12RenderSolution() = default;
@@ -737,6 +846,8 @@ DX12RenderWorks::DX12RenderWorks(const allocator_type& alloc)
 DX12RenderWorks::DX12RenderWorks(DX12RenderWorks const& rhs, const allocator_type& alloc)
     : mSolutions(rhs.mSolutions, alloc)
     , mFramebuffers(rhs.mFramebuffers, alloc)
+    , mFramebufferHeap(rhs.mFramebufferHeap)
+    , mFramebufferSize(rhs.mFramebufferSize)
     , mRTVs(rhs.mRTVs)
     , mDSVs(rhs.mDSVs)
     , mCBV_SRV_UAVs(rhs.mCBV_SRV_UAVs)
@@ -747,6 +858,8 @@ DX12RenderWorks::DX12RenderWorks(DX12RenderWorks const& rhs, const allocator_typ
 DX12RenderWorks::DX12RenderWorks(DX12RenderWorks&& rhs, const allocator_type& alloc)
     : mSolutions(std::move(rhs.mSolutions), alloc)
     , mFramebuffers(std::move(rhs.mFramebuffers), alloc)
+    , mFramebufferHeap(std::move(rhs.mFramebufferHeap))
+    , mFramebufferSize(std::move(rhs.mFramebufferSize))
     , mRTVs(std::move(rhs.mRTVs))
     , mDSVs(std::move(rhs.mDSVs))
     , mCBV_SRV_UAVs(std::move(rhs.mCBV_SRV_UAVs))
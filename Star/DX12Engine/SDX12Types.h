@@ -18,6 +18,7 @@
 #pragma once
 #include <Star/DX12Engine/SDX12Fwd.h>
 #include <Star/Graphics/SContentTypes.h>
+#include <Star/SSlotMap.h>
 
 namespace Star {
 
@@ -25,15 +26,32 @@ namespace Graphics {
 
 namespace Render {
 
+class DX12HeapRange;
+class DX12TileRange;
+class DX12ReleaseQueue;
+struct DX12MeshPage;
+
 struct DX12VertexBuffer {
     com_ptr<ID3D12Resource> mBuffer;
+    std::shared_ptr<const DX12HeapRange> mMemory;
 };
 
 struct DX12IndexBuffer {
     com_ptr<ID3D12Resource> mBuffer;
+    std::shared_ptr<const DX12HeapRange> mMemory;
     GFX_PRIMITIVE_TOPOLOGY mPrimitiveTopology = GFX_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
 };
 
+// object space cluster of a mesh, index range is in the space of SubMeshData
+struct DX12Meshlet {
+    uint32_t mIndexOffset = 0;
+    uint32_t mIndexCount = 0;
+    float mCenter[3] = {};
+    float mRadius = 0;
+    float mConeAxis[3] = {};
+    float mConeCutoff = 1;
+};
+
 struct DX12MeshData {
     using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
     allocator_type get_allocator() const noexcept;
@@ -48,13 +66,32 @@ struct DX12MeshData {
     std::pmr::vector<D3D12_VERTEX_BUFFER_VIEW> mVertexBufferViews;
     D3D12_INDEX_BUFFER_VIEW mIndexBufferView = {};
     std::pmr::vector<SubMeshData> mSubMeshes;
+    std::pmr::vector<DX12Meshlet> mMeshlets;
+    // simplified levels after level 0, submeshes of a level index mLodSubMeshes
+    std::pmr::vector<MeshLodData> mLods;
+    std::pmr::vector<SubMeshData> mLodSubMeshes;
     std::pmr::vector<DX12VertexBuffer> mVertexBuffers;
     DX12IndexBuffer mIndexBuffer;
     Core::Fetch<MeshData> mMeshData;
     uint32_t mRefCount = 0;
     uint32_t mLayoutID = 0;
     std::pmr::string mLayoutName;
-};
+    // false while streamed buffers are uploading, draws of the mesh are skipped
+    bool mResident = true;
+    // pooled meshes view the buffers of their page, drawn at base vertex and index
+    const DX12MeshPage* mPage = nullptr;
+    uint32_t mBaseVertex = 0;
+    uint32_t mBaseIndex = 0;
+    // buffers are handed to it on release while frames may still read them, freed at once if null
+    DX12ReleaseQueue* mReleaseQueue = nullptr;
+};
+
+// meshes of the same pool page share their vertex and index buffer bindings
+inline const void* getDX12MeshBinding(const DX12MeshData* pMesh) noexcept {
+    if (pMesh && pMesh->mPage)
+        return pMesh->mPage;
+    return pMesh;
+}
 
 struct DX12TextureData {
     DX12TextureData() = default;
@@ -63,9 +100,24 @@ struct DX12TextureData {
     {}
     MetaID mMetaID;
     com_ptr<ID3D12Resource> mTexture;
+    std::shared_ptr<const DX12HeapRange> mMemory;
+    // tiles mapped per mip, packed mips share theirs, empty unless the texture is reserved
+    std::vector<std::shared_ptr<const DX12TileRange>> mTiles;
     DXGI_FORMAT mFormat;
     Core::Fetch<TextureData> mTextureData;
     uint32_t mRefCount = 0;
+    // false while streamed data is uploading, descriptors view a default texture
+    bool mResident = true;
+    // most detailed uploaded mip, views start at it while larger mips stream in
+    uint32_t mResidentMip = 0;
+    // descriptors viewing the texture, rewritten as larger mips become resident or the texture is reloaded
+    // descriptors of released materials are removed
+    std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> mViewDescriptors;
+    // slot in the bindless table, UINT32_MAX if bindless textures are disabled
+    DX12ShaderDescriptorHeap* mDescriptorHeap = nullptr;
+    uint32_t mBindlessIndex = UINT32_MAX;
+    // texture is handed to it on release while frames may still sample it, freed at once if null
+    DX12ReleaseQueue* mReleaseQueue = nullptr;
 };
 
 struct DX12ProgramData {
@@ -80,12 +132,16 @@ struct DX12PipelineStateData {
     com_ptr<ID3D12PipelineState> mObject;
 };
 
+// views of the shader blob mapping, or of one buffer copied from the shader data
+// held until the psos of the subpass are created or handed to the compiler
 struct DX12ShaderProgramData {
-    com_ptr<ID3DBlob> mVS;
-    com_ptr<ID3DBlob> mHS;
-    com_ptr<ID3DBlob> mDS;
-    com_ptr<ID3DBlob> mGS;
-    com_ptr<ID3DBlob> mPS;
+    D3D12_SHADER_BYTECODE mVS = {};
+    D3D12_SHADER_BYTECODE mHS = {};
+    D3D12_SHADER_BYTECODE mDS = {};
+    D3D12_SHADER_BYTECODE mGS = {};
+    D3D12_SHADER_BYTECODE mPS = {};
+    // keeps the views valid, shared with pso compilations
+    std::shared_ptr<const void> mBytes;
 };
 
 struct DX12ShaderSubpassData {
@@ -102,6 +158,8 @@ struct DX12ShaderSubpassData {
     PmrFlatMap<uint32_t, uint32_t> mVertexLayoutIndex;
     std::pmr::vector<ShaderConstantBuffer> mConstantBuffers;
     std::pmr::vector<ShaderDescriptorCollection> mDescriptors;
+    // back faces are culled by the rasterizer, meshlets may be cone culled
+    bool mBackfaceCulling = false;
 };
 
 struct DX12ShaderPassData {
@@ -302,6 +360,10 @@ struct DX12MaterialData {
     DX12ShaderDescriptorHeap* mDescriptorHeap = nullptr;
     std::pmr::vector<DX12MaterialSolutionData> mShaderData;
     std::pmr::vector<boost::intrusive_ptr<DX12TextureData>> mTextures;
+    // bindless indices of mTextures, unused entries index the white texture
+    std::array<uint32_t, 4> mTextureIndices = { UINT32_MAX, UINT32_MAX, UINT32_MAX, UINT32_MAX };
+    // first block of the constants in the material constant pool, 0 if there are none
+    uint32_t mConstantIndex = 0;
     ConstantMap mConstantMap;
     Core::Fetch<MaterialData> mMaterialData;
     uint32_t mRefCount = 0;
@@ -337,6 +399,12 @@ struct DX12MeshRenderer {
     std::pmr::vector<boost::intrusive_ptr<DX12MaterialData>> mMaterials;
 };
 
+// cache line of floats, unit of SoA storage
+struct alignas(64) DX12FloatBlock {
+    float mData[16];
+};
+static_assert(sizeof(DX12FloatBlock) == 64);
+
 struct DX12FlattenedObjects {
     using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
     allocator_type get_allocator() const noexcept;
@@ -346,10 +414,28 @@ struct DX12FlattenedObjects {
     DX12FlattenedObjects(DX12FlattenedObjects const& rhs, const allocator_type& alloc);
     ~DX12FlattenedObjects();
 
-    std::pmr::vector<WorldTransform> mWorldTransforms;
-    std::pmr::vector<WorldTransformInv> mWorldTransformInvs;
+    // world, inverse world and previous world 3x4 matrices, column major: 36 blocks of mTransformStride floats
+    std::pmr::vector<DX12FloatBlock> mTransformsSoA;
+    uint32_t mTransformStride = 0;
+    uint32_t mObjectCount = 0;
+    // version of the last transform change of each object, 0 if never changed
+    std::pmr::vector<uint64_t> mTransformVersions;
+    // greatest of mTransformVersions, batches not changed since a sync are skipped
+    uint64_t mLatestTransformVersion = 0;
+    // objects whose previous world differs from their world, they stop moving at the next frame sync
+    std::pmr::vector<uint32_t> mMovedObjects;
+    // transform version of the last frame sync, objects changed after it already kept their previous world
+    uint64_t mFrameTransformVersion = 0;
     std::pmr::vector<BoundingBox> mBoundingBoxes;
     std::pmr::vector<DX12MeshRenderer> mMeshRenderers;
+    // world AABBs for culling: cx, cy, cz, ex, ey, ez blocks of mWorldBoundsStride floats
+    std::pmr::vector<float> mWorldBoundsSoA;
+    uint32_t mWorldBoundsStride = 0;
+    // static hierarchy of the content, cleared once any transform changes
+    std::pmr::vector<BvhNode4> mBvhNodes;
+    std::pmr::vector<uint32_t> mBvhObjects;
+    // objects outside the hierarchy, always visible
+    std::pmr::vector<uint32_t> mBvhUnbounded;
 };
 
 struct DX12ContentData {
@@ -363,13 +449,160 @@ struct DX12ContentData {
     ~DX12ContentData();
 
     MetaID mMetaID;
-    std::pmr::vector<ContentID> mIDs;
+    // listed draw calls and batches split by type when created, indices are checked
+    std::pmr::vector<uint32_t> mDrawCallIDs;
+    std::pmr::vector<uint32_t> mBatchIDs;
     std::pmr::vector<DX12DrawCallData> mDrawCalls;
     std::pmr::vector<DX12FlattenedObjects> mFlattenedObjects;
     Core::Fetch<ContentData> mContentData;
     uint32_t mRefCount = 0;
 };
 
+enum DX12DrawConstantEnum : uint32_t {
+    WorldViewConstant = 0,
+    WorldInvTConstant,
+    TextureIndicesConstant,
+    MaterialIndexConstant,
+    PrevWorldViewConstant,
+};
+
+// per instance constant, written into a dynamic constant buffer
+struct DX12DrawConstant {
+    DX12DrawConstantEnum mType = WorldViewConstant;
+    uint32_t mOffset = 0;
+};
+
+enum DX12DrawBindingEnum : uint32_t {
+    DescriptorTableBinding = 0,
+    RootConstantBufferBinding,
+    RootShaderResourceBinding,
+};
+
+// dynamic constant buffer, viewed in a circular descriptor table or bound as root CBV,
+// or one structured buffer element per instance bound as root SRV
+struct DX12DrawDescriptor {
+    uint32_t mIndex = 0;
+    uint32_t mSize = 0;
+    uint32_t mConstantBegin = 0;
+    uint32_t mConstantCount = 0;
+};
+
+// root descriptor table, persistent if mCapacity is 0
+// root CBV/SRV has a single descriptor and no capacity
+struct DX12DrawBinding {
+    uint32_t mSlot = 0;
+    uint32_t mCapacity = 0;
+    D3D12_GPU_DESCRIPTOR_HANDLE mGpuOffset = {};
+    uint32_t mDescriptorBegin = 0;
+    uint32_t mDescriptorCount = 0;
+    DX12DrawBindingEnum mType = DescriptorTableBinding;
+};
+
+// one draw of a shader subpass, compiled when queue contents are created
+// renderers sharing mesh, submesh and material are drawn as instances
+struct DX12DrawPacket {
+    // null until the pso of mPipelineSource is compiled, the packet is not drawn meanwhile
+    ID3D12PipelineState* mPipelineState = nullptr;
+    const DX12PipelineStateData* mPipelineSource = nullptr;
+    const DX12MeshData* mMesh = nullptr;
+    const DX12MaterialData* mMaterial = nullptr;
+    const DX12FlattenedObjects* mBatch = nullptr;
+    D3D12_PRIMITIVE_TOPOLOGY mPrimitiveTopology = D3D_PRIMITIVE_TOPOLOGY_UNDEFINED;
+    uint32_t mInstanceBegin = 0;
+    uint32_t mInstanceCount = 0;
+    uint32_t mElementCount = 0;
+    uint32_t mElementOffset = 0;
+    int32_t mBaseVertex = 0;
+    uint32_t mBindingBegin = 0;
+    uint32_t mBindingCount = 0;
+    // meshlets of the submesh in mMesh->mMeshlets
+    uint32_t mMeshletBegin = 0;
+    uint32_t mMeshletCount = 0;
+    bool mConeCulling = false;
+    // submesh of mMesh, selects the ranges of simplified levels
+    uint32_t mSubMeshID = 0;
+    // shader subpass of the material, earlier layers are drawn first
+    uint32_t mSortLayer = 0;
+    // packets of every shader level are built, instances are drawn by the packet of their level
+    uint8_t mShaderLevel = 0;
+    uint8_t mShaderLevelCount = 1;
+};
+
+// gpu resident object of an indirect draw, layout matches the culling shader
+// matrices are stored column major, bounds are local
+struct DX12IndirectObject {
+    float mWorld[16];
+    float mWorldInvT[16];
+    float mBoundsCenter[4];
+    float mBoundsExtent[4];
+    uint32_t mInstanceCountOffset = 0;
+    uint32_t mInstanceOffset = 0;
+    uint32_t mReserved[2] = {};
+};
+static_assert(sizeof(DX12IndirectObject) == 176);
+
+// draw packets sharing pipeline state and persistent bindings, drawn by one ExecuteIndirect
+// each packet is a command: root SRV of its instances, vertex/index buffers and indexed draw
+struct DX12IndirectDrawGroup {
+    com_ptr<ID3D12CommandSignature> mCommandSignature;
+    ID3D12PipelineState* mPipelineState = nullptr;
+    D3D12_PRIMITIVE_TOPOLOGY mPrimitiveTopology = D3D_PRIMITIVE_TOPOLOGY_UNDEFINED;
+    uint32_t mPacketID = 0;
+    uint32_t mArgumentOffset = 0;
+    uint32_t mCommandCount = 0;
+    uint32_t mObjectBegin = 0;
+    uint32_t mObjectCount = 0;
+    uint32_t mInstanceStride = 0;
+    uint32_t mWorldViewOffset = UINT32_MAX;
+    uint32_t mWorldInvTOffset = UINT32_MAX;
+};
+
+// arguments and instances of one frame slot, command templates point at its instances
+struct DX12IndirectFrameBuffers {
+    com_ptr<ID3D12Resource> mCommands;
+    com_ptr<ID3D12Resource> mArguments;
+    com_ptr<ID3D12Resource> mInstances;
+};
+
+// objects and command templates are uploaded once, arguments and instances are written on gpu
+// each frame slot owns its arguments, so culling of a frame may overlap drawing of the previous one
+struct DX12IndirectBuffers {
+    com_ptr<ID3D12Resource> mObjects;
+    std::vector<DX12IndirectFrameBuffers> mFrames;
+    uint32_t mArgumentSize = 0;
+};
+
+// compute pipeline culling objects and generating indirect arguments
+struct DX12IndirectPipeline {
+    com_ptr<ID3D12RootSignature> mRootSignature;
+    com_ptr<ID3D12PipelineState> mPipelineState;
+};
+
+// dispatch signature, and the pipeline turning a gpu written thread count into its arguments
+struct DX12IndirectDispatchPipeline {
+    com_ptr<ID3D12CommandSignature> mCommandSignature;
+    com_ptr<ID3D12RootSignature> mRootSignature;
+    com_ptr<ID3D12PipelineState> mPipelineState;
+};
+
+// D3D12_DISPATCH_ARGUMENTS written on gpu, the state is tracked while lists are recorded in order
+// written in UNORDERED_ACCESS, read by ExecuteIndirect in INDIRECT_ARGUMENT
+struct DX12IndirectDispatch {
+    com_ptr<ID3D12Resource> mArguments;
+    D3D12_RESOURCE_STATES mState = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+};
+
+// per-instance constants of a cpu driven queue kept in default heap memory
+// records are rewritten when the view or transforms of their objects change
+struct DX12PersistentConstants {
+    com_ptr<ID3D12Resource> mBuffer;
+    uint64_t mSize = 0;
+    uint64_t mSyncedVersion = 0;
+    float mView[16] = {};
+    float mPrevView[16] = {};
+    bool mResident = false;
+};
+
 struct DX12UnorderedRenderQueue {
     using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
     allocator_type get_allocator() const noexcept;
@@ -380,6 +613,85 @@ struct DX12UnorderedRenderQueue {
     ~DX12UnorderedRenderQueue();
 
     std::pmr::vector<boost::intrusive_ptr<DX12ContentData>> mContents;
+    std::pmr::vector<DX12DrawPacket> mDrawPackets;
+    std::pmr::vector<DX12DrawBinding> mDrawBindings;
+    std::pmr::vector<DX12DrawDescriptor> mDrawDescriptors;
+    std::pmr::vector<DX12DrawConstant> mDrawConstants;
+    std::pmr::vector<uint32_t> mDrawInstances;
+    std::pmr::vector<DX12IndirectDrawGroup> mIndirectGroups;
+    DX12IndirectBuffers mIndirectBuffers;
+    // record offset of each draw binding in mPersistentConstants, UINT64_MAX if uploaded per frame
+    std::pmr::vector<uint64_t> mPersistentOffsets;
+    DX12PersistentConstants mPersistentConstants;
+};
+
+// hierarchical-z occlusion of a subpass, tested objects are the instances of its queues
+// visibility is read back by the frame slot that wrote it, one frame queue later
+// each slot keeps its own visibility on gpu, equal to what the slot culls by when it is next recorded
+struct DX12OcclusionCulling {
+    com_ptr<ID3D12Resource> mBounds;
+    com_ptr<ID3D12Resource> mVisibility;
+    // two phase culling, draw packet of each instance slot and one predicate per packet
+    // a predicate is set when the test finds an instance visible that the slot visibility culled
+    com_ptr<ID3D12Resource> mPackets;
+    com_ptr<ID3D12Resource> mPredicates;
+    com_ptr<ID3D12Resource> mClearedPredicates;
+    uint32_t mPacketCount = 0;
+    std::vector<com_ptr<ID3D12Resource>> mReadbacks;
+    std::vector<const uint32_t*> mReadbackData;
+    com_ptr<ID3D12Resource> mPyramid;
+    uint32_t mInstanceCount = 0;
+    uint32_t mWidth = 0;
+    uint32_t mHeight = 0;
+    uint32_t mMipLevels = 0;
+};
+
+// compute pipelines building the depth pyramid and testing bounds against it
+struct DX12OcclusionPipeline {
+    com_ptr<ID3D12RootSignature> mRootSignature;
+    com_ptr<ID3D12PipelineState> mDownsample;
+    com_ptr<ID3D12PipelineState> mTest;
+};
+
+// compute pipelines filtering mips and encoding bc blocks of textures created at runtime
+struct DX12TextureKernels {
+    com_ptr<ID3D12RootSignature> mRootSignature;
+    com_ptr<ID3D12PipelineState> mDownsample;
+    com_ptr<ID3D12PipelineState> mCompressBC1;
+    com_ptr<ID3D12PipelineState> mCompressBC3;
+    com_ptr<ID3D12PipelineState> mCompressBC7;
+};
+
+// clustered point lights of a subpass, lists are rebuilt before the subpass of every frame
+// lights are uploaded per frame slot, grid and indices are shared as frames run in order on the gpu
+struct DX12LightCulling {
+    std::vector<com_ptr<ID3D12Resource>> mLights;
+    std::vector<PointLightData*> mLightData;
+    com_ptr<ID3D12Resource> mGrid;
+    com_ptr<ID3D12Resource> mIndices;
+};
+
+// compute pipeline binning lights into view clusters
+struct DX12LightCullingPipeline {
+    com_ptr<ID3D12RootSignature> mRootSignature;
+    com_ptr<ID3D12PipelineState> mPipelineState;
+};
+
+// depth of the static casters of a subpass, objects not moved since their content was loaded
+// copied to the depth stencil every frame before moving casters are drawn, rests in COPY_SOURCE
+struct DX12ShadowCache {
+    com_ptr<ID3D12Resource> mDepthStencil;
+    DX12DescriptorArray<D3D12_DESCRIPTOR_HEAP_TYPE_DSV> mDSV;
+    D3D12_CLEAR_FLAGS mClearFlags = D3D12_CLEAR_FLAG_DEPTH;
+    float mClearDepth = 1;
+    uint8_t mClearStencil = 0;
+    // casters and camera of the last refresh, compared on render thread when a frame is prepared
+    bool mValid = false;
+    Matrix4f mView = Matrix4f::Zero();
+    Matrix4f mProj = Matrix4f::Zero();
+    std::vector<uint32_t> mInstances;
+    std::vector<uint32_t> mDrawOffsets;
+    std::vector<uint8_t> mLevels;
 };
 
 struct DX12GraphicsSubpass {
@@ -398,10 +710,24 @@ struct DX12GraphicsSubpass {
     std::optional<Attachment> mDepthStencilAttachment;
     std::pmr::vector<Attachment> mPreserveAttachments;
     std::pmr::vector<RenderViewTransition> mPostViewTransitions;
+    std::pmr::vector<FramebufferHandle> mAliasingBarriers;
     std::pmr::vector<DX12UnorderedRenderQueue> mOrderedRenderQueue;
     com_ptr<ID3D12RootSignature> mRootSignature;
+    // hash of the serialized root signature, names cached psos
+    uint64_t mRootSignatureHash = 0;
     std::pmr::vector<ShaderConstantBuffer> mConstantBuffers;
     std::pmr::vector<DX12ShaderDescriptorCollection> mDescriptors;
+    bool mOcclusionCulling = false;
+    DX12OcclusionCulling mOcclusion;
+    bool mLightCulling = false;
+    DX12LightCulling mLights;
+    bool mShadowCaching = false;
+    DX12ShadowCache mShadowCache;
+    D3D12_SHADING_RATE mShadingRate = D3D12_SHADING_RATE_1X1;
+    std::optional<FramebufferHandle> mShadingRateImage;
+    uint32_t mView = 0;
+    // inputs of the upscaler, rendered at the render resolution of the frame
+    std::optional<UpscaleAttachments> mUpscaling;
 };
 
 struct DX12RenderPass {
@@ -459,6 +785,7 @@ struct DX12RenderSolution {
     std::pmr::vector<UNORDERED_ACCESS_VIEW_DESC> mUAVs;
     PmrFlatMap<uint32_t, uint32_t> mAttributeIndex;
     PmrMap<std::pmr::string, uint32_t> mPipelineIndex;
+    OutputColorSpace mOutputColorSpace;
 };
 
 struct DX12RenderWorks {
@@ -472,6 +799,10 @@ struct DX12RenderWorks {
 
     std::pmr::vector<DX12RenderSolution> mSolutions;
     std::pmr::vector<com_ptr<ID3D12Resource>> mFramebuffers;
+    // placed memory of aliased framebuffers
+    com_ptr<ID3D12Heap> mFramebufferHeap;
+    // video memory of back buffers, framebuffers and their alias heap
+    uint64_t mFramebufferSize = 0;
     DX12DescriptorArray<D3D12_DESCRIPTOR_HEAP_TYPE_RTV> mRTVs;
     DX12DescriptorArray<D3D12_DESCRIPTOR_HEAP_TYPE_DSV> mDSVs;
     DX12DescriptorArray<D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV> mCBV_SRV_UAVs;
@@ -501,6 +832,90 @@ enum DX12TextureEnum : uint32_t {
     White = 0,
 };
 
+// records in slot map pages addressed by handles, metaIDs are only resolved when resources are created.
+// records never move, so draw data may point into them
+template<class T>
+class DX12ResourceMap {
+public:
+    using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+    allocator_type get_allocator() const noexcept {
+        return mRecords.get_allocator();
+    }
+
+    DX12ResourceMap(const allocator_type& alloc)
+        : mRecords(alloc)
+        , mHandles(alloc)
+    {}
+    DX12ResourceMap(DX12ResourceMap&& rhs, const allocator_type& alloc)
+        : mRecords(std::move(rhs.mRecords), alloc)
+        , mHandles(std::move(rhs.mHandles), alloc)
+    {}
+    DX12ResourceMap(DX12ResourceMap const& rhs, const allocator_type& alloc)
+        : mRecords(rhs.mRecords, alloc)
+        , mHandles(rhs.mHandles, alloc)
+    {}
+
+    // null handle if the resource was never created
+    SlotHandle find(const MetaID& metaID) const noexcept {
+        auto iter = mHandles.find(metaID);
+        return iter == mHandles.end() ? SlotHandle{} : iter->second;
+    }
+
+    // the record is constructed from metaID, existing records are returned unchanged
+    std::pair<SlotHandle, bool> emplace(const MetaID& metaID) {
+        auto res = mHandles.try_emplace(metaID);
+        if (!res.second) {
+            return { res.first->second, false };
+        }
+        try {
+            res.first->second = mRecords.emplace(metaID);
+        } catch (...) {
+            mHandles.erase(res.first);
+            throw;
+        }
+        return { res.first->second, true };
+    }
+
+    T& operator[](SlotHandle handle) noexcept {
+        return mRecords[handle];
+    }
+    const T& operator[](SlotHandle handle) const noexcept {
+        return mRecords[handle];
+    }
+
+    T* get(SlotHandle handle) noexcept {
+        return mRecords.get(handle);
+    }
+
+    T& at(const MetaID& metaID) {
+        auto handle = find(metaID);
+        if (!handle) {
+            throw std::runtime_error("dx12 resource not found");
+        }
+        return mRecords[handle];
+    }
+
+    size_t size() const noexcept {
+        return mRecords.size();
+    }
+
+    auto begin() noexcept {
+        return mRecords.begin();
+    }
+    auto end() noexcept {
+        return mRecords.end();
+    }
+    auto begin() const noexcept {
+        return mRecords.begin();
+    }
+    auto end() const noexcept {
+        return mRecords.end();
+    }
+private:
+    SlotMap<T> mRecords;
+    FlatHashMap<MetaID, SlotHandle, MetaIDHash, MetaIDEqual> mHandles;
+};
+
 struct DX12Resources {
     using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
     allocator_type get_allocator() const noexcept;
@@ -512,11 +927,11 @@ struct DX12Resources {
 
     ContentSettings mSettings;
     std::pmr::vector<DX12TextureData> mDefaultTextures;
-    PmrMetaIDHashListIndex<DX12MeshData> mMeshes;
-    PmrMetaIDHashListIndex<DX12TextureData> mTextures;
-    PmrMetaIDHashListIndex<DX12ShaderData> mShaders;
-    PmrMetaIDHashListIndex<DX12MaterialData> mMaterials;
-    PmrMetaIDHashListIndex<DX12ContentData> mContents;
+    DX12ResourceMap<DX12MeshData> mMeshes;
+    DX12ResourceMap<DX12TextureData> mTextures;
+    DX12ResourceMap<DX12ShaderData> mShaders;
+    DX12ResourceMap<DX12MaterialData> mMaterials;
+    DX12ResourceMap<DX12ContentData> mContents;
     PmrMetaIDHashListIndex<DX12RenderGraphData> mRenderGraphs;
 };
 
@@ -16,6 +16,7 @@
 // along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
 
 #include "SDX12UploadBuffer.h"
+#include <Star/Core/SCounters.h>
 
 namespace Star::Graphics::Render {
 
@@ -56,30 +57,74 @@ DX12UploadBufferBlock::DX12UploadBufferBlock(gsl::not_null<ID3D12Device*> pDevic
 DX12UploadBufferPool::DX12UploadBufferPool(ID3D12Device* pDevice, size_t bufferSize, uint32_t capacity)
     : mDevice(pDevice)
     , mBufferSize(bufferSize)
+    , mCapacity(capacity)
+    , mFreeBlocks(capacity)
 {
     for (size_t i = 0; i != capacity; ++i) {
-        auto ptr = std::make_unique<DX12UploadBufferBlock>(pDevice, mBufferSize,
-            gsl::narrow_cast<uint32_t>(mBufferCount++));
-        mBuffers.emplace_back(std::move(ptr));
+        auto ptr = std::make_unique<DX12UploadBufferBlock>(pDevice, mBufferSize, mBufferID++);
+        ++mBlockCount;
+        mFreeBlocks.push(ptr.release());
     }
 }
 
-std::unique_ptr<DX12UploadBufferBlock> DX12UploadBufferPool::create() const {
+DX12UploadBufferPool::~DX12UploadBufferPool() {
+    Expects(mUsedCount == 0);
+    DX12UploadBufferBlock* pBlock = nullptr;
+    while (mFreeBlocks.pop(pBlock)) {
+        delete pBlock;
+    }
+}
+
+std::unique_ptr<DX12UploadBufferBlock> DX12UploadBufferPool::create(size_t size) const {
     std::unique_ptr<DX12UploadBufferBlock> ptr;
-    std::lock_guard<std::mutex> guard(mMutex);
-    if (!mBuffers.empty()) {
-        ptr.reset(mBuffers.front().release());
-        mBuffers.pop_front();
+    if (size > mBufferSize) {
+        ptr = std::make_unique<DX12UploadBufferBlock>(mDevice, size, mBufferID++);
+        return ptr;
+    }
+
+    DX12UploadBufferBlock* pBlock = nullptr;
+    if (mFreeBlocks.pop(pBlock)) {
+        ptr.reset(pBlock);
     } else {
-        ptr = std::make_unique<DX12UploadBufferBlock>(mDevice, mBufferSize, mBufferCount++);
+        ptr = std::make_unique<DX12UploadBufferBlock>(mDevice, mBufferSize, mBufferID++);
+        ++mBlockCount;
     }
+    updateHighWater(++mUsedCount);
     return ptr;
 }
 
 void DX12UploadBufferPool::recycle(std::unique_ptr<DX12UploadBufferBlock> ptr) const noexcept {
-    std::lock_guard<std::mutex> guard(mMutex);
+    if (ptr->size() > mBufferSize) {
+        return;
+    }
+    --mUsedCount;
+    if (!ptr->begin()) {
+        --mBlockCount;
+        return;
+    }
     ptr->clear();
-    mBuffers.push_back(std::move(ptr));
+    mFreeBlocks.push(ptr.release());
+}
+
+void DX12UploadBufferPool::trim() noexcept {
+    if (++mTrimFrame < sTrimInterval)
+        return;
+    mTrimFrame = 0;
+
+    auto highWater = mHighWater.exchange(usedCount(), std::memory_order_relaxed);
+    auto keep = std::max(mCapacity, highWater);
+
+    DX12UploadBufferBlock* pBlock = nullptr;
+    while (blockCount() > keep && mFreeBlocks.pop(pBlock)) {
+        delete pBlock;
+        --mBlockCount;
+    }
+}
+
+void DX12UploadBufferPool::updateHighWater(uint32_t used) const noexcept {
+    auto highWater = mHighWater.load(std::memory_order_relaxed);
+    while (used > highWater && !mHighWater.compare_exchange_weak(highWater, used, std::memory_order_relaxed)) {
+    }
 }
 
 DX12UploadBuffer::DX12UploadBuffer(const DX12UploadBufferPool& pool, uint32_t frameQueueSize, int64_t frameID)
@@ -96,6 +141,7 @@ DX12UploadBuffer::~DX12UploadBuffer() {
 
 void DX12UploadBuffer::advanceFrame(int64_t frameID) noexcept {
     mFrameID = frameID;
+    rollStatistics();
 }
 
 void DX12UploadBuffer::releaseBuffer(int64_t frameID) noexcept {
@@ -110,6 +156,7 @@ void DX12UploadBuffer::releaseBuffer(int64_t frameID) noexcept {
 
 void DX12UploadBuffer::advanceFrame() noexcept {
     ++mFrameID;
+    rollStatistics();
 
     auto previousGpuFrame = mFrameID - mFrameQueueSize;
 
@@ -122,14 +169,16 @@ void DX12UploadBuffer::advanceFrame() noexcept {
     }
 }
 
-std::pair<DX12BufferData, bool> DX12UploadBuffer::try_upload(
-    const void* pData, size_t bytesPerData, uint32_t dataCount, size_t alignment
+std::pair<DX12BufferData, std::byte*> DX12UploadBuffer::try_suballocate(
+    size_t bytesPerData, uint32_t dataCount, size_t alignment
 ) {
     Expects(DX12UploadBufferBlock::sAlignment >= alignment);
 
     size_t size = bytesPerData * dataCount;
     size_t alignedSize = boost::alignment::align_up(size, alignment);
-    Expects(alignedSize <= mPool->getMaxBufferSize());
+    if (alignedSize > mPool->getMaxBufferSize()) {
+        return try_suballocate_dedicated(size, alignment);
+    }
 
     std::byte* pDst = nullptr;
     bool succeeded = false;
@@ -149,9 +198,9 @@ std::pair<DX12BufferData, bool> DX12UploadBuffer::try_upload(
             std::tie(pDst, succeeded) = pBuffer->try_suballocate(size, alignment, mFrameID);
             Ensures(succeeded);
             if (!succeeded)
-                return { DX12BufferData{}, false };
+                return { DX12BufferData{}, nullptr };
         } else {
-            return { DX12BufferData{}, false };
+            return { DX12BufferData{}, nullptr };
         }
     }
 
@@ -159,11 +208,55 @@ std::pair<DX12BufferData, bool> DX12UploadBuffer::try_upload(
     Ensures(pBuffer->resource());
     Expects(pDst);
 
-    memcpy(pDst, pData, size);
-
     Expects(pDst >= mBuffers.back()->begin());
     auto diff = gsl::narrow_cast<uint64_t>(pDst - mBuffers.back()->begin());
-    return std::pair{ DX12BufferData{ pBuffer->resource(), diff }, true };
+    mStatistics.mBytes += size;
+    Core::Counters::add(Core::Counter::UploadBytes, size);
+    return std::pair{ DX12BufferData{ pBuffer->resource(), diff }, pDst };
+}
+
+std::pair<DX12BufferData, std::byte*> DX12UploadBuffer::try_suballocate_dedicated(
+    size_t size, size_t alignment
+) {
+    auto ptr = mPool->create(boost::alignment::align_up(size, alignment));
+    Ensures(ptr);
+    if (!ptr->begin())
+        return { DX12BufferData{}, nullptr };
+
+    auto [pDst, succeeded] = ptr->try_suballocate(size, alignment, mFrameID);
+    Ensures(succeeded);
+    auto pBuffer = ptr.get();
+
+    // keep the current block at the back, later uploads continue in it
+    auto pos = mBuffers.empty() ? mBuffers.end() : std::prev(mBuffers.end());
+    mBuffers.insert(pos, std::move(ptr));
+    mStatistics.mBytes += size;
+    Core::Counters::add(Core::Counter::UploadBytes, size);
+    ++mStatistics.mDedicatedBlocks;
+
+    auto diff = gsl::narrow_cast<uint64_t>(pDst - pBuffer->begin());
+    return std::pair{ DX12BufferData{ pBuffer->resource(), diff }, pDst };
+}
+
+std::pair<DX12BufferData, std::byte*> DX12UploadBuffer::suballocate(
+    size_t bytesPerData, uint32_t dataCount, size_t alignment
+) {
+    auto res = try_suballocate(bytesPerData, dataCount, alignment);
+    if (!res.second) {
+        throw std::runtime_error("allocate gpu upload buffer failed");
+    }
+    return res;
+}
+
+std::pair<DX12BufferData, bool> DX12UploadBuffer::try_upload(
+    const void* pData, size_t bytesPerData, uint32_t dataCount, size_t alignment
+) {
+    auto [data, pDst] = try_suballocate(bytesPerData, dataCount, alignment);
+    if (!pDst)
+        return { DX12BufferData{}, false };
+
+    memcpy(pDst, pData, bytesPerData * dataCount);
+    return { data, true };
 }
 
 DX12BufferData DX12UploadBuffer::upload(const void* pData, size_t bytesPerData, uint32_t dataCount, size_t alignment) {
@@ -179,8 +272,10 @@ bool DX12UploadBuffer::try_allocate() {
     Ensures(ptr);
     if (ptr->begin()) {
         mBuffers.push_back(std::move(ptr));
+        ++mStatistics.mBlocksAcquired;
         return true;
     } else {
+        mPool->recycle(std::move(ptr));
         return false;
     }
 }
@@ -189,6 +284,12 @@ void DX12UploadBuffer::recycle_front() noexcept {
     Expects(!mBuffers.empty());
     mPool->recycle(std::move(mBuffers.front()));
     mBuffers.pop_front();
+    ++mStatistics.mBlocksReleased;
+}
+
+void DX12UploadBuffer::rollStatistics() noexcept {
+    mLastStatistics = mStatistics;
+    mStatistics = DX12UploadStatistics{};
 }
 
 }
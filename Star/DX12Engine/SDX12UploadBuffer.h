@@ -17,6 +17,7 @@
 
 #pragma once
 #include <Star/DX12Engine/SDX12Types.h>
+#include <Star/SLockFree.h>
 
 namespace Star::Graphics::Render {
 
@@ -61,6 +62,9 @@ public:
     std::byte* end() noexcept {
         return mDataEnd;
     }
+    size_t size() const noexcept {
+        return mDataEnd - mDataBegin;
+    }
     int64_t frameID() const noexcept {
         return mLastFrame;
     }
@@ -74,24 +78,53 @@ private:
 };
 static_assert(sizeof(DX12UploadBufferBlock) == 48);
 
+// create and recycle are lock free and called from recording threads
+// free blocks above the high-water mark of a trim window are released
 class DX12UploadBufferPool {
 public:
+    static const uint32_t sTrimInterval = 120;
+
     DX12UploadBufferPool(ID3D12Device* pDevice, size_t bufferSize, uint32_t capacity);
     DX12UploadBufferPool(const DX12UploadBufferPool&) = delete;
     DX12UploadBufferPool& operator=(const DX12UploadBufferPool&) = delete;
+    ~DX12UploadBufferPool();
 
     size_t getMaxBufferSize() const noexcept {
         return mBufferSize;
     }
+    uint32_t blockCount() const noexcept {
+        return mBlockCount.load(std::memory_order_relaxed);
+    }
+    uint32_t usedCount() const noexcept {
+        return mUsedCount.load(std::memory_order_relaxed);
+    }
 
-    std::unique_ptr<DX12UploadBufferBlock> create() const;
+    // sizes above the block size get a dedicated block, destroyed when recycled
+    std::unique_ptr<DX12UploadBufferBlock> create(size_t size = 0) const;
     void recycle(std::unique_ptr<DX12UploadBufferBlock> ptr) const noexcept;
+
+    // called once per frame by the render thread
+    void trim() noexcept;
 private:
+    void updateHighWater(uint32_t used) const noexcept;
+
     gsl::not_null<ID3D12Device*> mDevice;
     size_t mBufferSize = 0;
-    mutable uint32_t mBufferCount = 0;
-    mutable std::mutex mMutex;
-    mutable std::deque<std::unique_ptr<DX12UploadBufferBlock>> mBuffers;
+    uint32_t mCapacity = 0;
+    uint32_t mTrimFrame = 0;
+    mutable std::atomic_uint32_t mBufferID = 0;
+    mutable std::atomic_uint32_t mBlockCount = 0;
+    mutable std::atomic_uint32_t mUsedCount = 0;
+    mutable std::atomic_uint32_t mHighWater = 0;
+    mutable MessageQueue<DX12UploadBufferBlock*> mFreeBlocks;
+};
+
+// counters of the last completed frame
+struct DX12UploadStatistics {
+    uint64_t mBytes = 0;
+    uint32_t mBlocksAcquired = 0;
+    uint32_t mBlocksReleased = 0;
+    uint32_t mDedicatedBlocks = 0;
 };
 
 class DX12UploadBuffer {
@@ -110,7 +143,20 @@ public:
 
     DX12BufferData upload(const void* pData,
         size_t bytesPerData, uint32_t dataCount = 1, size_t alignment = 16);
+
+    // reserve mapped memory to be written in place, pointer is null on failure
+    std::pair<DX12BufferData, std::byte*> try_suballocate(
+        size_t bytesPerData, uint32_t dataCount = 1, size_t alignment = 16);
+
+    std::pair<DX12BufferData, std::byte*> suballocate(
+        size_t bytesPerData, uint32_t dataCount = 1, size_t alignment = 16);
+
+    const DX12UploadStatistics& statistics() const noexcept {
+        return mLastStatistics;
+    }
 private:
+    std::pair<DX12BufferData, std::byte*> try_suballocate_dedicated(size_t size, size_t alignment);
+    void rollStatistics() noexcept;
     bool try_allocate();
     void recycle_front() noexcept;
 
@@ -118,6 +164,8 @@ private:
     std::deque<std::unique_ptr<DX12UploadBufferBlock>> mBuffers;
     uint32_t mFrameQueueSize = 0;
     int64_t mFrameID = -1;
+    DX12UploadStatistics mStatistics;
+    DX12UploadStatistics mLastStatistics;
 };
 
 }
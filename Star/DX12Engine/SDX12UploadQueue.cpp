@@ -0,0 +1,161 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "SDX12UploadQueue.h"
+
+namespace Star::Graphics::Render {
+
+DX12UploadQueue::DX12UploadQueue(ID3D12Device* pDevice, ID3D12CommandQueue* pDirectQueue,
+    const DX12UploadBufferPool& uploadPool, uint32_t batchCount)
+    : mDevice(pDevice)
+    , mUploadPool(&uploadPool)
+    , mDirectQueue(pDirectQueue)
+    , mCopyQueue(DX12::createCopyQueue(pDevice))
+    , mCopyFence(DX12::createFence(pDevice, mNextFence, "UploadCopyFence", false))
+    , mFence(DX12::createFence(pDevice, mNextFence, "UploadFence"))
+    , mFenceEvent(DX12::createFenceEvent())
+{
+    Expects(batchCount);
+
+    mBatches.resize(batchCount);
+    for (uint32_t i = 0; i != batchCount; ++i) {
+        auto& batch = mBatches[i];
+        V(pDevice->CreateCommandAllocator(
+            D3D12_COMMAND_LIST_TYPE_COPY, IID_PPV_ARGS(batch.mCopyAllocator.put())));
+        STAR_SET_DEBUG_NAME(batch.mCopyAllocator, "UploadBatch Copy: " + std::to_string(i));
+        V(pDevice->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_COPY,
+            batch.mCopyAllocator.get(), nullptr, IID_PPV_ARGS(batch.mCopyList.put())));
+        STAR_SET_DEBUG_NAME(batch.mCopyList, "UploadBatch Copy: " + std::to_string(i));
+        batch.mCopyList->Close();
+
+        V(pDevice->CreateCommandAllocator(
+            D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(batch.mDirectAllocator.put())));
+        STAR_SET_DEBUG_NAME(batch.mDirectAllocator, "UploadBatch Direct: " + std::to_string(i));
+        V(pDevice->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT,
+            batch.mDirectAllocator.get(), nullptr, IID_PPV_ARGS(batch.mDirectList.put())));
+        STAR_SET_DEBUG_NAME(batch.mDirectList, "UploadBatch Direct: " + std::to_string(i));
+        batch.mDirectList->Close();
+    }
+}
+
+void DX12UploadQueue::record(DX12UploadBuffer& uploadBuffer) {
+    Expects(!mRecording);
+    auto& batch = mBatches[mBatchIndex];
+
+    // oldest batch is reused, only waits if all batches are in flight
+    wait(batch.mFence);
+
+    V(batch.mCopyAllocator->Reset());
+    V(batch.mCopyList->Reset(batch.mCopyAllocator.get(), nullptr));
+    V(batch.mDirectAllocator->Reset());
+    V(batch.mDirectList->Reset(batch.mDirectAllocator.get(), nullptr));
+
+    batch.mFence = mNextFence;
+    uploadBuffer.releaseBuffer(gsl::narrow_cast<int64_t>(completedFence()));
+    uploadBuffer.advanceFrame(gsl::narrow_cast<int64_t>(batch.mFence));
+    for (auto& recorder : batch.mRecorders) {
+        recorder.mUploadBuffer->releaseBuffer(gsl::narrow_cast<int64_t>(completedFence()));
+    }
+    batch.mRecorderCount = 0;
+    mRecording = true;
+}
+
+void DX12UploadQueue::recordParallel(uint32_t count) {
+    Expects(mRecording);
+    auto& batch = mBatches[mBatchIndex];
+    Expects(batch.mRecorderCount == 0);
+
+    while (batch.mRecorders.size() < count) {
+        const auto name = std::to_string(mBatchIndex) + "." + std::to_string(batch.mRecorders.size());
+        auto& recorder = batch.mRecorders.emplace_back();
+        V(mDevice->CreateCommandAllocator(
+            D3D12_COMMAND_LIST_TYPE_COPY, IID_PPV_ARGS(recorder.mCopyAllocator.put())));
+        STAR_SET_DEBUG_NAME(recorder.mCopyAllocator, "UploadRecorder Copy: " + name);
+        V(mDevice->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_COPY,
+            recorder.mCopyAllocator.get(), nullptr, IID_PPV_ARGS(recorder.mCopyList.put())));
+        STAR_SET_DEBUG_NAME(recorder.mCopyList, "UploadRecorder Copy: " + name);
+        recorder.mCopyList->Close();
+
+        V(mDevice->CreateCommandAllocator(
+            D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(recorder.mDirectAllocator.put())));
+        STAR_SET_DEBUG_NAME(recorder.mDirectAllocator, "UploadRecorder Direct: " + name);
+        V(mDevice->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT,
+            recorder.mDirectAllocator.get(), nullptr, IID_PPV_ARGS(recorder.mDirectList.put())));
+        STAR_SET_DEBUG_NAME(recorder.mDirectList, "UploadRecorder Direct: " + name);
+        recorder.mDirectList->Close();
+
+        recorder.mUploadBuffer = std::make_unique<DX12UploadBuffer>(*mUploadPool, 1, 0);
+    }
+
+    for (uint32_t i = 0; i != count; ++i) {
+        auto& recorder = batch.mRecorders[i];
+        V(recorder.mCopyAllocator->Reset());
+        V(recorder.mCopyList->Reset(recorder.mCopyAllocator.get(), nullptr));
+        V(recorder.mDirectAllocator->Reset());
+        V(recorder.mDirectList->Reset(recorder.mDirectAllocator.get(), nullptr));
+        recorder.mUploadBuffer->advanceFrame(gsl::narrow_cast<int64_t>(batch.mFence));
+    }
+    batch.mRecorderCount = count;
+}
+
+uint64_t DX12UploadQueue::flush() {
+    Expects(mRecording);
+    auto& batch = mBatches[mBatchIndex];
+    Expects(batch.mFence == mNextFence);
+
+    V(batch.mCopyList->Close());
+    V(batch.mDirectList->Close());
+
+    // lists of the batch and its recorders are submitted together
+    std::vector<ID3D12CommandList*> copyLists{ batch.mCopyList.get() };
+    std::vector<ID3D12CommandList*> directLists{ batch.mDirectList.get() };
+    for (uint32_t i = 0; i != batch.mRecorderCount; ++i) {
+        auto& recorder = batch.mRecorders[i];
+        V(recorder.mCopyList->Close());
+        V(recorder.mDirectList->Close());
+        copyLists.emplace_back(recorder.mCopyList.get());
+        directLists.emplace_back(recorder.mDirectList.get());
+    }
+    {
+        mCopyQueue->ExecuteCommandLists(gsl::narrow_cast<uint32_t>(copyLists.size()), copyLists.data());
+        V(mCopyQueue->Signal(mCopyFence.get(), batch.mFence));
+    }
+    {
+        V(mDirectQueue->Wait(mCopyFence.get(), batch.mFence));
+        mDirectQueue->ExecuteCommandLists(gsl::narrow_cast<uint32_t>(directLists.size()), directLists.data());
+        V(mDirectQueue->Signal(mFence.get(), batch.mFence));
+    }
+
+    ++mNextFence;
+    mBatchIndex = (mBatchIndex + 1) % gsl::narrow_cast<uint32_t>(mBatches.size());
+    mRecording = false;
+    return batch.mFence;
+}
+
+void DX12UploadQueue::wait(uint64_t fence) const {
+    if (isCompleted(fence))
+        return;
+
+    V(mFence->SetEventOnCompletion(fence, mFenceEvent.get()));
+    WaitForSingleObject(mFenceEvent.get(), INFINITE);
+}
+
+void DX12UploadQueue::waitIdle() const {
+    wait(mNextFence - 1);
+}
+
+}
@@ -0,0 +1,127 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <Star/DX12Engine/SDX12Types.h>
+#include <Star/DX12Engine/SDX12UploadBuffer.h>
+
+namespace Star::Graphics::Render {
+
+// uploads recorded in batches, copies are executed on a copy queue
+// and finished on the direct queue, batches are tracked by fences
+// recording only blocks when every batch is still in flight
+class DX12UploadQueue {
+public:
+    DX12UploadQueue(ID3D12Device* pDevice, ID3D12CommandQueue* pDirectQueue,
+        const DX12UploadBufferPool& uploadPool, uint32_t batchCount);
+    DX12UploadQueue(const DX12UploadQueue&) = delete;
+    DX12UploadQueue& operator=(const DX12UploadQueue&) = delete;
+
+    // begin a batch, upload memory of completed batches is released
+    void record(DX12UploadBuffer& uploadBuffer);
+
+    // submit the batch without waiting, resources are usable once its fence completes
+    // later work on the direct queue is ordered after the batch
+    uint64_t flush();
+
+    // add recorders to the batch, each is used by one thread at a time
+    // their lists are submitted with the batch and share its fence
+    void recordParallel(uint32_t count);
+    uint32_t recorderCount() const noexcept {
+        return mBatches[mBatchIndex].mRecorderCount;
+    }
+    ID3D12GraphicsCommandList* copyList(uint32_t recorderID) const noexcept {
+        return recorder(recorderID).mCopyList.get();
+    }
+    ID3D12GraphicsCommandList* directList(uint32_t recorderID) const noexcept {
+        return recorder(recorderID).mDirectList.get();
+    }
+    // upload memory of the recorder, released once the batch completes
+    DX12UploadBuffer& uploadBuffer(uint32_t recorderID) const noexcept {
+        return *recorder(recorderID).mUploadBuffer;
+    }
+
+    // copy commands of the batch, copy targets decay to common when the copy queue is done
+    ID3D12GraphicsCommandList* copyList() const noexcept {
+        return mBatches[mBatchIndex].mCopyList.get();
+    }
+    // tile mappings queued here are ordered before the copies of the batch
+    ID3D12CommandQueue* copyQueue() const noexcept {
+        return mCopyQueue.get();
+    }
+    // barriers and other direct commands of the batch, executed after its copies
+    ID3D12GraphicsCommandList* directList() const noexcept {
+        return mBatches[mBatchIndex].mDirectList.get();
+    }
+
+    // fence of the batch being recorded
+    uint64_t fence() const noexcept {
+        return mBatches[mBatchIndex].mFence;
+    }
+    uint64_t completedFence() const noexcept {
+        return mFence->GetCompletedValue();
+    }
+    bool isCompleted(uint64_t fence) const noexcept {
+        return completedFence() >= fence;
+    }
+    // reaches the fence of each batch once it completes, for continuations instead of waits
+    ID3D12Fence* batchFence() const noexcept {
+        return mFence.get();
+    }
+    void wait(uint64_t fence) const;
+    void waitIdle() const;
+private:
+    struct Recorder {
+        com_ptr<ID3D12CommandAllocator> mCopyAllocator;
+        com_ptr<ID3D12GraphicsCommandList> mCopyList;
+        com_ptr<ID3D12CommandAllocator> mDirectAllocator;
+        com_ptr<ID3D12GraphicsCommandList> mDirectList;
+        std::unique_ptr<DX12UploadBuffer> mUploadBuffer;
+    };
+    struct Batch {
+        com_ptr<ID3D12CommandAllocator> mCopyAllocator;
+        com_ptr<ID3D12GraphicsCommandList> mCopyList;
+        com_ptr<ID3D12CommandAllocator> mDirectAllocator;
+        com_ptr<ID3D12GraphicsCommandList> mDirectList;
+        uint64_t mFence = 0;
+        // created on demand, the first mRecorderCount are recording
+        std::vector<Recorder> mRecorders;
+        uint32_t mRecorderCount = 0;
+    };
+
+    const Recorder& recorder(uint32_t recorderID) const noexcept {
+        const auto& batch = mBatches[mBatchIndex];
+        Expects(recorderID < batch.mRecorderCount);
+        return batch.mRecorders[recorderID];
+    }
+
+    ID3D12Device* mDevice = nullptr;
+    gsl::not_null<const DX12UploadBufferPool*> mUploadPool;
+    ID3D12CommandQueue* mDirectQueue = nullptr;
+    com_ptr<ID3D12CommandQueue> mCopyQueue;
+    // copy fence is signaled on the copy queue, batch fence on the direct queue
+    // both use the fence value of the batch
+    uint64_t mNextFence = 0;
+    com_ptr<ID3D12Fence> mCopyFence;
+    com_ptr<ID3D12Fence> mFence;
+    winrt::handle mFenceEvent;
+    std::vector<Batch> mBatches;
+    uint32_t mBatchIndex = 0;
+    bool mRecording = false;
+};
+
+}
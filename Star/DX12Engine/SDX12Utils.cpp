@@ -23,28 +23,520 @@
 #include <Star/Graphics/SRenderFormatTextureUtils.h>
 #include <Star/Graphics/SRenderUtils.h>
 #include "SDX12ShaderDescriptorHeap.h"
+#include "SDX12DrawPacket.h"
+#include "SDX12IndirectDraw.h"
+#include "SDX12Culling.h"
+#include "SDX12Transforms.h"
+#include "SDX12PersistentConstants.h"
+#include "SDX12OcclusionCulling.h"
+#include "SDX12LightCulling.h"
+#include "SDX12HeapAllocator.h"
+#include "SDX12TilePool.h"
+#include "SDX12MeshPool.h"
+#include "SDX12MaterialConstants.h"
+#include "SDX12PipelineLibrary.h"
+#include "SDX12PipelineCompiler.h"
+#include "SDX12ShaderBlobStore.h"
 
 namespace Star::Graphics::Render {
 
-bool try_createDX12(ID3D12Device* pDevice, std::pmr::monotonic_buffer_resource* mr,
+bool try_createDX12(ID3D12Device* pDevice, FrameArena* mr,
     const MetaID& render, DX12Resources& resources, const MetaID& metaID,
     Core::ResourceType tag, bool async
 );
 
+void uploadDX12MeshData(CreationContext& context, DX12MeshData& mesh) {
+    Expects(mesh.mMeshData);
+    const auto& meshData = *mesh.mMeshData;
+
+    // page buffers stay in common state, no barriers
+    if (mesh.mPage) {
+        const auto& page = *mesh.mPage;
+        const auto& indices = meshData.mIndexBuffer;
+        auto buffer = context.upload(indices.mBuffer, 16);
+        context.mCopyList->CopyBufferRegion(page.mIndexBuffer.mResource.get(),
+            uint64_t(mesh.mBaseIndex) * indices.mElementSize,
+            buffer.mResource, buffer.mBufferOffset, indices.mBuffer.size());
+
+        Expects(page.mVertexBuffers.size() == meshData.mVertexBuffers.size());
+        for (size_t id = 0; id != meshData.mVertexBuffers.size(); ++id) {
+            const auto& vertexBufferData = meshData.mVertexBuffers[id];
+            auto buffer = context.upload(vertexBufferData.mBuffer, 16);
+            context.mCopyList->CopyBufferRegion(page.mVertexBuffers[id].mResource.get(),
+                uint64_t(mesh.mBaseVertex) * vertexBufferData.mDesc.mVertexSize,
+                buffer.mResource, buffer.mBufferOffset, vertexBufferData.mBuffer.size());
+        }
+        return;
+    }
+
+    if (!meshData.mIndexBuffer.mBuffer.empty()) {
+        auto buffer = context.upload(meshData.mIndexBuffer.mBuffer, 16);
+        context.mCopyList->CopyBufferRegion(mesh.mIndexBuffer.mBuffer.get(), 0,
+            buffer.mResource, buffer.mBufferOffset, meshData.mIndexBuffer.mBuffer.size());
+    }
+
+    Expects(mesh.mVertexBuffers.size() == meshData.mVertexBuffers.size());
+    for (size_t id = 0; id != meshData.mVertexBuffers.size(); ++id) {
+        const auto& vertexBufferData = meshData.mVertexBuffers[id];
+        auto buffer = context.upload(vertexBufferData.mBuffer, 16);
+        context.mCopyList->CopyBufferRegion(mesh.mVertexBuffers[id].mBuffer.get(), 0,
+            buffer.mResource, buffer.mBufferOffset, vertexBufferData.mBuffer.size());
+    }
+
+    auto barrierCount = mesh.mVertexBuffers.size() + !meshData.mIndexBuffer.mBuffer.empty();
+
+    auto pBarriers = pmr_make_unique<std::pmr::vector<D3D12_RESOURCE_BARRIER>>(context.mMemoryArena);
+    pBarriers->reserve(barrierCount);
+    auto& barriers = *pBarriers;
+    if (mesh.mIndexBuffer.mBuffer.get()) {
+        auto& barrier = barriers.emplace_back();
+        barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+        barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+        barrier.Transition.pResource = mesh.mIndexBuffer.mBuffer.get();
+        barrier.Transition.StateBefore = CreationContext::sUploadedState;
+        barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_INDEX_BUFFER | D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+        barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+    }
+    for (const auto& vb : mesh.mVertexBuffers) {
+        auto& barrier = barriers.emplace_back();
+        barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+        barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+        barrier.Transition.pResource = vb.mBuffer.get();
+        barrier.Transition.StateBefore = CreationContext::sUploadedState;
+        barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER | D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+        barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+    }
+    Ensures(barrierCount == barriers.size());
+    context.mCommandList->ResourceBarrier(gsl::narrow_cast<uint32_t>(barriers.size()), barriers.data());
+    pBarriers.release();
+    context.mMemoryArena->release();
+}
+
+namespace {
+
+// mips at most this size in texels are uploaded together with the first streamed batch
+constexpr uint32_t sTextureMipTailSize = 64;
+
+using TextureMipFootprints = std::array<SubresourceFootprint, D3D12_REQ_MIP_LEVELS>;
+
+// upload layout of the mips, computed once per query instead of once per mip
+gsl::span<const SubresourceFootprint> getTextureMipFootprints(const TextureData& textureData,
+    TextureMipFootprints& storage
+) noexcept {
+    const auto& resource = textureData.mDesc;
+    Expects(resource.mMipLevels <= storage.size());
+    auto mips = gsl::span<SubresourceFootprint>(storage).first(resource.mMipLevels);
+    getSubresourceFootprints(resource.mFormat, gsl::narrow_cast<uint32_t>(resource.mWidth),
+        resource.mHeight, resource.mMipLevels, 1, mips);
+    return mips;
+}
+
+}
+
+uint32_t getDX12TextureMipTail(const TextureData& textureData) noexcept {
+    uint32_t tail = textureData.mDesc.mMipLevels ? textureData.mDesc.mMipLevels - 1 : 0;
+    TextureMipFootprints storage;
+    auto mips = getTextureMipFootprints(textureData, storage);
+    for (uint32_t i = 0; i < tail; ++i) {
+        if (mips[i].mWidth <= sTextureMipTailSize && mips[i].mHeight <= sTextureMipTailSize)
+            return i;
+    }
+    return tail;
+}
+
+uint64_t getDX12TextureUploadSize(const TextureData& textureData,
+    uint32_t beginMip, uint32_t endMip
+) noexcept {
+    TextureMipFootprints storage;
+    auto mips = getTextureMipFootprints(textureData, storage);
+    endMip = std::min(endMip, gsl::narrow_cast<uint32_t>(mips.size()));
+    if (beginMip >= endMip)
+        return 0;
+    return mips[endMip - 1].mOffset + mips[endMip - 1].mMip.mUploadSliceSize - mips[beginMip].mOffset;
+}
+
+bool mapDX12TextureTiles(CreationContext& context, DX12TextureData& tex,
+    uint32_t beginMip, uint32_t endMip
+) {
+    Expects(context.mTilePool);
+    Expects(tex.mTextureData);
+    const uint32_t mipLevels = tex.mTextureData->mDesc.mMipLevels;
+    endMip = std::min(endMip, mipLevels);
+
+    D3D12_PACKED_MIP_INFO packed{};
+    D3D12_TILE_SHAPE shape{};
+    uint32_t subresourceCount = mipLevels;
+    std::pmr::vector<D3D12_SUBRESOURCE_TILING> tilings(mipLevels, context.mMemoryArena);
+    context.mDevice->GetResourceTiling(tex.mTexture.get(), nullptr, &packed, &shape,
+        &subresourceCount, 0, tilings.data());
+
+    tex.mTiles.resize(mipLevels);
+    for (uint32_t i = beginMip; i < endMip; ++i) {
+        if (tex.mTiles[i])
+            continue;
+
+        // packed mips are mapped together from the first of them
+        const bool packedMip = i >= packed.NumStandardMips;
+        D3D12_TILED_RESOURCE_COORDINATE coord{ 0, 0, 0, i };
+        D3D12_TILE_REGION_SIZE region{};
+        if (packedMip) {
+            coord.Subresource = packed.NumStandardMips;
+            region.NumTiles = packed.NumTilesForPackedMips;
+        } else {
+            const auto& tiling = tilings[i];
+            region.NumTiles = tiling.WidthInTiles * tiling.HeightInTiles * tiling.DepthInTiles;
+        }
+
+        auto tiles = context.mTilePool->allocate(region.NumTiles);
+        if (!tiles)
+            return false;
+        context.mTilePool->map(context.mUploadQueue->copyQueue(), tex.mTexture.get(),
+            coord, region, *tiles);
+
+        if (packedMip) {
+            std::fill(tex.mTiles.begin() + packed.NumStandardMips, tex.mTiles.end(), tiles);
+            break;
+        }
+        tex.mTiles[i] = std::move(tiles);
+    }
+    return true;
+}
+
+void uploadDX12TextureData(CreationContext& context, DX12TextureData& tex,
+    uint32_t beginMip, uint32_t endMip
+) {
+    Expects(tex.mTextureData);
+    const auto& resource = tex.mTextureData->mDesc;
+    endMip = std::min(endMip, uint32_t(resource.mMipLevels));
+    Expects(beginMip < endMip);
+
+    TextureMipFootprints storage;
+    auto mips = getTextureMipFootprints(*tex.mTextureData, storage);
+    const uint64_t beginOffset = mips[beginMip].mOffset;
+    const uint64_t endOffset = mips[endMip - 1].mOffset + mips[endMip - 1].mMip.mUploadSliceSize;
+    const auto& textureData = tex.mTextureData->mBuffer;
+    Expects(endOffset <= textureData.size());
+    auto buffer = context.upload(textureData.data() + beginOffset,
+        gsl::narrow_cast<size_t>(endOffset - beginOffset), sSliceAlignment);
+
+    const uint32_t mipCount = endMip - beginMip;
+#ifdef STAR_DEV
+    D3D12_RESOURCE_DESC Desc = tex.mTexture->GetDesc();
+    Expects(Desc.MipLevels == resource.mMipLevels);
+
+    std::pmr::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> pLayouts(mipCount, context.mMemoryArena);
+    std::pmr::vector<uint32_t> pNumRows(mipCount);
+    std::pmr::vector<uint64_t> pRowSizesInBytes(mipCount);
+
+    uint64_t RequiredSize = 0;
+    context.mDevice->GetCopyableFootprints(&Desc, beginMip, mipCount,
+        buffer.mBufferOffset, pLayouts.data(), pNumRows.data(),
+        pRowSizesInBytes.data(), &RequiredSize);
+#endif
+    std::pmr::vector<D3D12_RESOURCE_BARRIER> barriers(context.mMemoryArena);
+    barriers.reserve(mipCount);
+
+    for (uint32_t i = beginMip; i != endMip; ++i) {
+        const auto& mip = mips[i];
+        D3D12_PLACED_SUBRESOURCE_FOOTPRINT layout{};
+        layout.Offset = buffer.mBufferOffset + (mip.mOffset - beginOffset);
+        layout.Footprint.Format = getDXGIFormat(resource.mFormat);
+        layout.Footprint.Width = mip.mWidth;
+        layout.Footprint.Height = mip.mHeight;
+        layout.Footprint.Depth = resource.mDepthOrArraySize;
+        layout.Footprint.RowPitch = mip.mMip.mUploadRowPitchSize;
+
+#ifdef STAR_DEV
+        const auto& expected = pLayouts[i - beginMip];
+        Expects(layout.Offset == expected.Offset);
+        Expects(layout.Footprint.Format == expected.Footprint.Format);
+        Expects(layout.Footprint.Width == expected.Footprint.Width);
+        Expects(layout.Footprint.Height == expected.Footprint.Height);
+        Expects(layout.Footprint.Depth == expected.Footprint.Depth);
+        Expects(layout.Footprint.RowPitch == expected.Footprint.RowPitch);
+#endif
+        D3D12_TEXTURE_COPY_LOCATION Dst{ tex.mTexture.get(), D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX, i };
+        D3D12_TEXTURE_COPY_LOCATION Src{ buffer.mResource, D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT, layout };
+        context.mCopyList->CopyTextureRegion(&Dst, 0, 0, 0, &Src, nullptr);
+
+        barriers.emplace_back(CD3DX12_RESOURCE_BARRIER::Transition(tex.mTexture.get(),
+            CreationContext::sUploadedState,
+            D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, i));
+    }
+
+    // mips already resident are being sampled, only the uploaded ones transition
+    if (mipCount == resource.mMipLevels) {
+        barriers.resize(1);
+        barriers.front().Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+    }
+    context.mCommandList->ResourceBarrier(gsl::narrow_cast<uint32_t>(barriers.size()), barriers.data());
+}
+
+void createDX12TextureView(ID3D12Device* pDevice, const DX12TextureData& tex,
+    D3D12_CPU_DESCRIPTOR_HANDLE handle
+) {
+    D3D12_SHADER_RESOURCE_VIEW_DESC viewDesc{
+        tex.mFormat,
+        D3D12_SRV_DIMENSION_TEXTURE2D,
+        D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING,
+    };
+    viewDesc.Texture2D = D3D12_TEX2D_SRV{ tex.mResidentMip, (uint32_t)-1, 0, 0.f };
+    pDevice->CreateShaderResourceView(tex.mTexture.get(), &viewDesc, handle);
+}
+
+void createDX12BindlessTextureView(ID3D12Device* pDevice, DX12ShaderDescriptorHeap& heap,
+    const DX12TextureData& fallback, DX12TextureData& tex
+) {
+    Expects(tex.mBindlessIndex == UINT32_MAX);
+    tex.mDescriptorHeap = &heap;
+    tex.mBindlessIndex = heap.allocateBindless();
+
+    auto handle = heap.getBindless(tex.mBindlessIndex).mCpuHandle;
+    createDX12TextureView(pDevice, tex.mResident ? tex : fallback, handle);
+    tex.mViewDescriptors.emplace_back(handle);
+    heap.publishPersistent(handle, 1);
+}
+
+void relocateDX12ShaderDescriptors(DX12Resources& resources,
+    const std::pmr::vector<DX12ShaderDescriptorRelocation>& relocations
+) {
+    if (relocations.empty())
+        return;
+
+    // compaction moves single vectors, growth moves whole heaps, handles keep their offset in the range
+    auto* mr = relocations.get_allocator().resource();
+    std::pmr::map<SIZE_T, const DX12ShaderDescriptorRelocation*> sources(mr);
+    std::pmr::map<UINT64, const DX12ShaderDescriptorRelocation*> gpuSources(mr);
+    for (const auto& relocation : relocations) {
+        sources.emplace(relocation.mSource.first.mCpuHandle.ptr, &relocation);
+        gpuSources.emplace(relocation.mSource.first.mGpuHandle.ptr, &relocation);
+    }
+
+    auto findSource = [&](SIZE_T ptr) -> const DX12ShaderDescriptorRelocation* {
+        auto iter = sources.upper_bound(ptr);
+        if (iter == sources.begin())
+            return nullptr;
+        const auto* relocation = (--iter)->second;
+        if (ptr >= relocation->mSource.second.mCpuHandle.ptr)
+            return nullptr;
+        return relocation;
+    };
+    auto findGpuSource = [&](UINT64 ptr) -> const DX12ShaderDescriptorRelocation* {
+        auto iter = gpuSources.upper_bound(ptr);
+        if (iter == gpuSources.begin())
+            return nullptr;
+        const auto* relocation = (--iter)->second;
+        if (ptr >= relocation->mSource.second.mGpuHandle.ptr)
+            return nullptr;
+        return relocation;
+    };
+
+    auto relocateList = [&](DX12ShaderDescriptorList& list) {
+        if (!list.mCpuOffset.ptr) {
+            // bindless lists only keep the table start
+            if (!list.mGpuOffset.ptr)
+                return;
+            const auto* relocation = findGpuSource(list.mGpuOffset.ptr);
+            if (!relocation)
+                return;
+            list.mGpuOffset.ptr = relocation->mTarget.first.mGpuHandle.ptr +
+                (list.mGpuOffset.ptr - relocation->mSource.first.mGpuHandle.ptr);
+            return;
+        }
+        const auto* relocation = findSource(list.mCpuOffset.ptr);
+        if (!relocation)
+            return;
+        const auto offset = list.mCpuOffset.ptr - relocation->mSource.first.mCpuHandle.ptr;
+        Expects(relocation->mSource.first.mGpuHandle.ptr + offset == list.mGpuOffset.ptr);
+        list.mCpuOffset.ptr = relocation->mTarget.first.mCpuHandle.ptr + offset;
+        list.mGpuOffset.ptr = relocation->mTarget.first.mGpuHandle.ptr + offset;
+    };
+
+    // materials
+    for (const auto& material0 : resources.mMaterials) {
+        auto& material = const_cast<DX12MaterialData&>(material0);
+        for (auto& solution : material.mShaderData) {
+            for (auto& pipeline : solution.mPipelines) {
+                for (auto& queue : pipeline.mQueues) {
+                    for (auto& level : queue.mLevels) {
+                        for (auto& variant : level.mPasses) {
+                            for (auto& subpass : variant.mSubpasses) {
+                                for (auto& collection : subpass.mCollections) {
+                                    for (auto& list : collection.mResourceViewLists) {
+                                        relocateList(list);
+                                    }
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // textures rewrite their views when streamed mips become resident or they are reloaded
+    for (const auto& tex0 : resources.mTextures) {
+        auto& tex = const_cast<DX12TextureData&>(tex0);
+        for (auto& handle : tex.mViewDescriptors) {
+            const auto* relocation = findSource(handle.ptr);
+            if (!relocation)
+                continue;
+            handle.ptr = relocation->mTarget.first.mCpuHandle.ptr +
+                (handle.ptr - relocation->mSource.first.mCpuHandle.ptr);
+        }
+    }
+
+    // render graphs, draw packets keep the tables of their lists
+    for (const auto& rg0 : resources.mRenderGraphs) {
+        auto& rg = const_cast<DX12RenderGraphData&>(rg0);
+        for (auto& solution : rg.mRenderGraph.mSolutions) {
+            for (auto& pipeline : solution.mPipelines) {
+                for (auto& pass : pipeline.mPasses) {
+                    for (auto& subpass : pass.mGraphicsSubpasses) {
+                        for (auto& collection : subpass.mDescriptors) {
+                            for (auto& list : collection.mResourceViewLists) {
+                                relocateList(list);
+                            }
+                        }
+                        for (auto& queue : subpass.mOrderedRenderQueue) {
+                            for (auto& binding : queue.mDrawBindings) {
+                                if (binding.mType != DescriptorTableBinding || binding.mCapacity)
+                                    continue;
+                                const auto* relocation = findGpuSource(binding.mGpuOffset.ptr);
+                                if (relocation) {
+                                    binding.mGpuOffset.ptr = relocation->mTarget.first.mGpuHandle.ptr +
+                                        (binding.mGpuOffset.ptr - relocation->mSource.first.mGpuHandle.ptr);
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+void resolveDX12PipelineStates(DX12Resources& resources) {
+    for (const auto& rg0 : resources.mRenderGraphs) {
+        auto& rg = const_cast<DX12RenderGraphData&>(rg0);
+        for (auto& solution : rg.mRenderGraph.mSolutions) {
+            for (auto& pipeline : solution.mPipelines) {
+                for (auto& pass : pipeline.mPasses) {
+                    for (auto& subpass : pass.mGraphicsSubpasses) {
+                        for (auto& queue : subpass.mOrderedRenderQueue) {
+                            for (auto& packet : queue.mDrawPackets) {
+                                if (packet.mPipelineSource) {
+                                    packet.mPipelineState = packet.mPipelineSource->mObject.get();
+                                }
+                            }
+                            for (auto& group : queue.mIndirectGroups) {
+                                group.mPipelineState = queue.mDrawPackets[group.mPacketID].mPipelineState;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
 namespace {
 
+void recordDX12Uploads(CreationContext& context, JobSystem& jobs, DX12DeferredUploads& uploads) {
+    struct Upload {
+        DX12MeshData* mMesh = nullptr;
+        DX12TextureData* mTexture = nullptr;
+        uint64_t mSize = 0;
+    };
+    std::vector<Upload> items;
+    items.reserve(uploads.mMeshes.size() + uploads.mTextures.size());
+    for (auto* pMesh : uploads.mMeshes) {
+        const auto& meshData = *pMesh->mMeshData;
+        uint64_t size = meshData.mIndexBuffer.mBuffer.size();
+        for (const auto& stream : meshData.mVertexBuffers) {
+            size += stream.mBuffer.size();
+        }
+        items.emplace_back(Upload{ pMesh, nullptr, size });
+    }
+    for (auto* pTexture : uploads.mTextures) {
+        items.emplace_back(Upload{ nullptr, pTexture, pTexture->mTextureData->mBuffer.size() });
+    }
+    uploads.mMeshes.clear();
+    uploads.mTextures.clear();
+    if (items.empty())
+        return;
+
+    // largest first, each is given to the least loaded recorder of its batch
+    std::sort(items.begin(), items.end(), [](const Upload& lhs, const Upload& rhs) {
+        return lhs.mSize > rhs.mSize;
+    });
+    const auto recorderCount = gsl::narrow_cast<uint32_t>(
+        std::min<size_t>(size_t(jobs.threadCount()) + 1, items.size()));
+    const uint64_t batchSize = uint64_t(context.mMaxUploadSize) * recorderCount;
+
+    auto& queue = *context.mUploadQueue;
+    std::vector<uint64_t> loads(recorderCount);
+    std::vector<uint32_t> owners(items.size());
+    for (size_t begin = 0; begin != items.size();) {
+        size_t end = begin;
+        uint64_t size = 0;
+        do {
+            size += items[end++].mSize;
+        } while (end != items.size() && size + items[end].mSize <= batchSize);
+
+        std::fill(loads.begin(), loads.end(), 0);
+        for (size_t i = begin; i != end; ++i) {
+            const auto id = std::min_element(loads.begin(), loads.end()) - loads.begin();
+            loads[id] += items[i].mSize;
+            owners[i] = gsl::narrow_cast<uint32_t>(id);
+        }
+
+        // a batch records one set of recorders
+        if (queue.recorderCount()) {
+            context.flush();
+            context.record();
+        }
+        queue.recordParallel(recorderCount);
+        jobs.parallel_for(0, recorderCount, 1, [&](size_t first, size_t last) {
+            for (auto id = first; id != last; ++id) {
+                FrameArena arena;
+                CreationContext recorder = context;
+                recorder.mCommandList = queue.directList(gsl::narrow_cast<uint32_t>(id));
+                recorder.mCopyList = queue.copyList(gsl::narrow_cast<uint32_t>(id));
+                recorder.mUploadBuffer = &queue.uploadBuffer(gsl::narrow_cast<uint32_t>(id));
+                recorder.mMemoryArena = &arena;
+                // batches are sized above, recorders never flush
+                recorder.mMaxUploadSize = std::numeric_limits<size_t>::max();
+                for (size_t i = begin; i != end; ++i) {
+                    if (owners[i] != id)
+                        continue;
+                    if (items[i].mMesh) {
+                        uploadDX12MeshData(recorder, *items[i].mMesh);
+                    } else {
+                        uploadDX12TextureData(recorder, *items[i].mTexture);
+                        arena.release();
+                    }
+                }
+            }
+        });
+        begin = end;
+    }
+}
+
 std::pair<DX12MeshData*, bool> try_createDX12MeshData(CreationContext& context,
     DX12Resources& resources, const MetaID& metaID, bool async
 ) {
     bool created = false;
-    auto iter = resources.mMeshes.find(metaID);
-    if (iter != resources.mMeshes.end()) {
+    auto handle = resources.mMeshes.find(metaID);
+    if (handle) {
 
     } else {
-        std::tie(iter, created) = resources.mMeshes.emplace(metaID);
+        std::tie(handle, created) = resources.mMeshes.emplace(metaID);
         Ensures(created);
-        resources.mMeshes.modify(iter, [&](DX12MeshData& mesh) {
+        auto& mesh = resources.mMeshes[handle];
+        {
             mesh.mMeshData.reset(metaID, async);
+            mesh.mReleaseQueue = context.mReleaseQueue;
             if (!async) {
                 Ensures(mesh.mMeshData);
                 const auto& meshData = *mesh.mMeshData;
@@ -52,151 +544,118 @@ std::pair<DX12MeshData*, bool> try_createDX12MeshData(CreationContext& context,
                 mesh.mLayoutID = meshData.mLayoutID;
                 mesh.mLayoutName = meshData.mLayoutName;
 
-                if (!meshData.mIndexBuffer.mBuffer.empty()) {
-                    auto buffer = context.upload(meshData.mIndexBuffer.mBuffer, 16);
-                    mesh.mIndexBuffer.mBuffer = DX12::createBuffer(context.mDevice, meshData.mIndexBuffer.mBuffer.size());
-                    STAR_SET_DEBUG_NAME(mesh.mIndexBuffer.mBuffer.get(), to_string(metaID) + " index buffer");
-
-                    context.mCommandList->CopyBufferRegion(mesh.mIndexBuffer.mBuffer.get(), 0,
-                        buffer.mResource, buffer.mBufferOffset, meshData.mIndexBuffer.mBuffer.size());
-
-                    mesh.mIndexBufferView.BufferLocation = mesh.mIndexBuffer.mBuffer->GetGPUVirtualAddress();
-                    mesh.mIndexBufferView.SizeInBytes = gsl::narrow_cast<uint32_t>(meshData.mIndexBuffer.mBuffer.size());
-                    mesh.mIndexBufferView.Format = meshData.mIndexBuffer.mElementSize == 2 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
-                }
+                // pooled meshes are packed into the shared buffers of their layout
+                const bool pooled = context.mMeshPool && context.mMeshPool->allocate(mesh, meshData);
+                if (!pooled) {
+                    if (!meshData.mIndexBuffer.mBuffer.empty()) {
+                        auto placed = context.mHeapAllocator->createBuffer(meshData.mIndexBuffer.mBuffer.size(),
+                            D3D12_RESOURCE_STATE_COPY_DEST);
+                        mesh.mIndexBuffer.mBuffer = std::move(placed.mResource);
+                        mesh.mIndexBuffer.mMemory = std::move(placed.mMemory);
+                        STAR_SET_DEBUG_NAME(mesh.mIndexBuffer.mBuffer.get(), to_string(metaID) + " index buffer");
+
+                        mesh.mIndexBufferView.BufferLocation = mesh.mIndexBuffer.mBuffer->GetGPUVirtualAddress();
+                        mesh.mIndexBufferView.SizeInBytes = gsl::narrow_cast<uint32_t>(meshData.mIndexBuffer.mBuffer.size());
+                        mesh.mIndexBufferView.Format = meshData.mIndexBuffer.mElementSize == 2 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+                    }
 
-                mesh.mVertexBuffers.reserve(meshData.mVertexBuffers.size());
-                mesh.mVertexBufferViews.reserve(meshData.mVertexBuffers.size());
-                for (const auto& vertexBufferData : meshData.mVertexBuffers) {
-                    auto buffer = context.upload(vertexBufferData.mBuffer, 16);
-                    auto id = mesh.mVertexBuffers.size();
-                    auto& vb = mesh.mVertexBuffers.emplace_back();
-                    auto& vbv = mesh.mVertexBufferViews.emplace_back();
-                    vb.mBuffer = DX12::createBuffer(context.mDevice, vertexBufferData.mBuffer.size());
-                    STAR_SET_DEBUG_NAME(vb.mBuffer.get(), to_string(metaID) + " vertex buffer " + std::to_string(id));
-
-                    context.mCommandList->CopyBufferRegion(vb.mBuffer.get(), 0,
-                        buffer.mResource, buffer.mBufferOffset, vertexBufferData.mBuffer.size());
-
-                    vbv.BufferLocation = vb.mBuffer->GetGPUVirtualAddress();
-                    vbv.SizeInBytes = gsl::narrow_cast<uint32_t>(vertexBufferData.mBuffer.size());
-                    vbv.StrideInBytes = vertexBufferData.mDesc.mVertexSize;
-                    Expects(vertexBufferData.mDesc.mVertexSize);
+                    mesh.mVertexBuffers.reserve(meshData.mVertexBuffers.size());
+                    mesh.mVertexBufferViews.reserve(meshData.mVertexBuffers.size());
+                    for (const auto& vertexBufferData : meshData.mVertexBuffers) {
+                        auto id = mesh.mVertexBuffers.size();
+                        auto& vb = mesh.mVertexBuffers.emplace_back();
+                        auto& vbv = mesh.mVertexBufferViews.emplace_back();
+                        auto placed = context.mHeapAllocator->createBuffer(vertexBufferData.mBuffer.size(),
+                            D3D12_RESOURCE_STATE_COPY_DEST);
+                        vb.mBuffer = std::move(placed.mResource);
+                        vb.mMemory = std::move(placed.mMemory);
+                        STAR_SET_DEBUG_NAME(vb.mBuffer.get(), to_string(metaID) + " vertex buffer " + std::to_string(id));
+
+                        vbv.BufferLocation = vb.mBuffer->GetGPUVirtualAddress();
+                        vbv.SizeInBytes = gsl::narrow_cast<uint32_t>(vertexBufferData.mBuffer.size());
+                        vbv.StrideInBytes = vertexBufferData.mDesc.mVertexSize;
+                        Expects(vertexBufferData.mDesc.mVertexSize);
+                    }
                 }
 
                 mesh.mSubMeshes = meshData.mSubMeshes;
-
-                auto barrierCount = mesh.mVertexBuffers.size() + !meshData.mIndexBuffer.mBuffer.empty();
-
-                auto pBarriers = pmr_make_unique<std::pmr::vector<D3D12_RESOURCE_BARRIER>>(context.mMemoryArena);
-                pBarriers->reserve(barrierCount);
-                auto& barriers = *pBarriers;
-                if (mesh.mIndexBuffer.mBuffer.get()) {
-                    auto& barrier = barriers.emplace_back();
-                    barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-                    barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
-                    barrier.Transition.pResource = mesh.mIndexBuffer.mBuffer.get();
-                    barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
-                    barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_INDEX_BUFFER | D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
-                    barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
-                }
-                for (const auto& vb : mesh.mVertexBuffers) {
-                    auto& barrier = barriers.emplace_back();
-                    barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-                    barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
-                    barrier.Transition.pResource = vb.mBuffer.get();
-                    barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
-                    barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER | D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
-                    barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+                mesh.mLods = meshData.mLods;
+                mesh.mLodSubMeshes = meshData.mLodSubMeshes;
+                buildDX12Meshlets(meshData, mesh);
+
+                // streamed meshes are skipped until their buffers are uploaded
+                if (context.mStreaming) {
+                    mesh.mResident = false;
+                } else if (context.mDeferredUploads) {
+                    context.mDeferredUploads->mMeshes.emplace_back(&mesh);
+                } else {
+                    uploadDX12MeshData(context, mesh);
                 }
-                Ensures(barrierCount == barriers.size());
-                context.mCommandList->ResourceBarrier(gsl::narrow_cast<uint32_t>(barriers.size()), barriers.data());
-                pBarriers.release();
-                context.mMemoryArena->release();
             }
-        });
+        }
+        if (context.mStreaming && !mesh.mResident) {
+            context.mStreaming->enqueue(mesh);
+        }
     }
-    return { const_cast<DX12MeshData*>(&*iter), created };
+    return { &resources.mMeshes[handle], created };
 }
 
 std::pair<DX12TextureData*, bool> try_createDX12TextureData(CreationContext& context,
     DX12Resources& resources, const MetaID& metaID, bool async
 ) {
     bool created = false;
-    auto iter = resources.mTextures.find(metaID);
-    if (iter != resources.mTextures.end()) {
+    auto handle = resources.mTextures.find(metaID);
+    if (handle) {
 
     } else {
-        std::tie(iter, created) = resources.mTextures.emplace(metaID);
+        std::tie(handle, created) = resources.mTextures.emplace(metaID);
         Ensures(created);
-        resources.mTextures.modify(iter, [&](DX12TextureData& tex) {
+        auto& tex = resources.mTextures[handle];
+        {
             tex.mTextureData.reset(metaID, async);
+            tex.mReleaseQueue = context.mReleaseQueue;
             if (!async) {
                 Ensures(tex.mTextureData);
-                const auto& textureData = tex.mTextureData->mBuffer;
-                auto buffer = context.upload(textureData.data(), textureData.size(), sSliceAlignment);
                 auto desc = getDX12(tex.mTextureData->mDesc);
                 desc.Format = getDXGIFormat(tex.mTextureData->mDesc.mFormat);
-                tex.mTexture = DX12::createTexture2D(context.mDevice, desc);
+                // large streamed textures only occupy tiles of the mips uploaded so far
+                if (context.mStreaming && context.mTilePool &&
+                    std::max<uint64_t>(desc.Width, desc.Height) >= context.mReservedTextureDimension
+                ) {
+                    desc.Layout = D3D12_TEXTURE_LAYOUT_64KB_UNDEFINED_SWIZZLE;
+                    V(context.mDevice->CreateReservedResource(&desc, D3D12_RESOURCE_STATE_COPY_DEST,
+                        nullptr, IID_PPV_ARGS(tex.mTexture.put())));
+                    tex.mTiles.resize(desc.MipLevels);
+                } else {
+                    auto placed = context.mHeapAllocator->createTexture(desc, D3D12_RESOURCE_STATE_COPY_DEST);
+                    tex.mTexture = std::move(placed.mResource);
+                    tex.mMemory = std::move(placed.mMemory);
+                }
                 tex.mFormat = getDXGIFormat(tex.mTextureData->mFormat);
                 STAR_SET_DEBUG_NAME(tex.mTexture.get(), to_string(metaID) + " texture");
-                
-                const auto& resource = tex.mTextureData->mDesc;
-#ifdef STAR_DEV
-                D3D12_RESOURCE_DESC Desc = tex.mTexture->GetDesc();
-                Expects(Desc.MipLevels == resource.mMipLevels);
 
-                std::pmr::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> pLayouts(resource.mMipLevels, context.mMemoryArena);
-                std::pmr::vector<uint32_t> pNumRows(resource.mMipLevels);
-                std::pmr::vector<uint64_t> pRowSizesInBytes(resource.mMipLevels);
-
-                uint64_t RequiredSize = 0;
-                context.mDevice->GetCopyableFootprints(&Desc, 0, resource.mMipLevels,
-                    buffer.mBufferOffset, pLayouts.data(), pNumRows.data(),
-                    pRowSizesInBytes.data(), &RequiredSize);
-#endif
-                uint64_t offset1 = 0;
-                uint32_t width = gsl::narrow_cast<uint32_t>(resource.mWidth);
-                uint32_t height = resource.mHeight;
-                auto encoding = getEncoding(resource.mFormat);
-                for (uint32_t i = 0; i != resource.mMipLevels; ++i) {
-                    auto mip = getMipInfo(resource.mFormat, width, height);
-
-                    D3D12_PLACED_SUBRESOURCE_FOOTPRINT layout{};
-                    layout.Offset = buffer.mBufferOffset + offset1;
-                    layout.Footprint.Format = getDXGIFormat(resource.mFormat);
-                    layout.Footprint.Width = width;
-                    layout.Footprint.Height = height;
-                    layout.Footprint.Depth = resource.mDepthOrArraySize;
-                    layout.Footprint.RowPitch = mip.mUploadRowPitchSize;
-
-#ifdef STAR_DEV
-                    Expects(layout.Offset == pLayouts[i].Offset);
-                    Expects(layout.Footprint.Format == pLayouts[i].Footprint.Format);
-                    Expects(layout.Footprint.Width == pLayouts[i].Footprint.Width);
-                    Expects(layout.Footprint.Height == pLayouts[i].Footprint.Height);
-                    Expects(layout.Footprint.Depth == pLayouts[i].Footprint.Depth);
-                    Expects(layout.Footprint.RowPitch == pLayouts[i].Footprint.RowPitch);
-#endif
-                    D3D12_TEXTURE_COPY_LOCATION Dst{ tex.mTexture.get(), D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX, i };
-                    D3D12_TEXTURE_COPY_LOCATION Src{ buffer.mResource, D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT, layout };
-                    context.mCommandList->CopyTextureRegion(&Dst, 0, 0, 0, &Src, nullptr);
-
-                    offset1 += mip.mUploadSliceSize;
-                    width = half_size(width, encoding.mBlockWidth);
-                    height = half_size(height, encoding.mBlockHeight);
+                // streamed textures are replaced by default textures until uploaded
+                if (context.mStreaming) {
+                    tex.mResident = false;
+                    tex.mResidentMip = tex.mTextureData->mDesc.mMipLevels;
+                } else if (context.mDeferredUploads) {
+                    context.mDeferredUploads->mTextures.emplace_back(&tex);
+                } else {
+                    uploadDX12TextureData(context, tex);
                 }
 
-                auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(tex.mTexture.get(),
-                    D3D12_RESOURCE_STATE_COPY_DEST,
-                    D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
-
-                context.mCommandList->ResourceBarrier(1, &barrier);
+                if (context.mDescriptorHeap->getBindlessCapacity()) {
+                    createDX12BindlessTextureView(context.mDevice, *context.mDescriptorHeap,
+                        resources.mDefaultTextures.at(White), tex);
+                }
             }
-        });
+        }
+        if (context.mStreaming && !tex.mResident) {
+            context.mStreaming->enqueue(tex);
+        }
     }
     context.mMemoryArena->release();
-    return { const_cast<DX12TextureData*>(&*iter), created };
+    return { &resources.mTextures[handle], created };
 }
 
 void resizeData(DX12ShaderData& prototype, const ShaderData& prototypeData) {
@@ -336,152 +795,144 @@ void createIndex(DX12ShaderData& prototype, const ShaderData& prototypeData,
     }
 }
 
-void createShaderResources(const DX12RenderSolution& renderSolution, const DX12GraphicsSubpass& renderSubpass,
+void createShaderResources(const DX12GraphicsSubpass& renderSubpass,
     DX12ShaderSubpassData& subpass, const ShaderSubpassData& subpassData,
-    const ContentSettings& settings, ID3D12Device* pDevice, std::pmr::monotonic_buffer_resource* mr
+    ID3D12Device* pDevice, DX12PipelineLibrary* pLibrary,
+    DX12PipelineCompiler* pCompiler, DX12ShaderBlobStore* pBlobs, FrameArena* mr
 ) {
     subpass.mConstantBuffers = subpassData.mConstantBuffers;
     subpass.mDescriptors = subpassData.mDescriptors;
+    subpass.mBackfaceCulling = subpassData.mState.mRasterizerState.mCullMode == CULL_MODE_BACK;
     // shader programs
-    HRESULT hr = S_OK;
-    if (!subpassData.mProgram.mPS.empty()) {
-        V(D3DCreateBlob(subpassData.mProgram.mPS.size(), subpass.mProgram.mPS.put()));
-        memcpy(subpass.mProgram.mPS->GetBufferPointer(),
-            subpassData.mProgram.mPS.data(), subpassData.mProgram.mPS.size());
-    }
-    if (!subpassData.mProgram.mVS.empty()) {
-        V(D3DCreateBlob(subpassData.mProgram.mVS.size(), subpass.mProgram.mVS.put()));
-        memcpy(subpass.mProgram.mVS->GetBufferPointer(),
-            subpassData.mProgram.mVS.data(), subpassData.mProgram.mVS.size());
-    }
+    Expects(pBlobs);
+    pBlobs->getProgram(subpassData.mProgram, subpass.mProgram);
 
     auto pElemDescs = pmr_make_unique<std::pmr::vector<D3D12_INPUT_ELEMENT_DESC>>(mr, 16);
 
-    // shader input layouts and pso
+    // pso descs are resolved by the asset factory, one per vertex layout
+    Expects(subpassData.mPipelineStates.size() == subpassData.mVertexLayouts.size());
+    const auto& stateData = subpassData.mState;
     for (uint32_t i = 0; i != subpassData.mVertexLayouts.size(); ++i) {
-        auto vertID = subpassData.mVertexLayouts[i];
-        subpass.mVertexLayoutIndex[vertID] = i;
+        subpass.mVertexLayoutIndex[subpassData.mVertexLayouts[i]] = i;
         auto& state = subpass.mStates[i];
-        const auto& meshLayout = settings.mVertexLayouts.at(vertID);
+        const auto& stateDesc = subpassData.mPipelineStates[i];
 
         pElemDescs->clear();
-
-        for (const auto& [semantic, inputs] : subpassData.mInputLayout.mSemantics) {
-            uint32_t semanticID = 0;
-            for (const auto& input : inputs) {
-                const auto& [bufferID, elementID] = meshLayout.mIndex.at(input);
-                const auto& descData = meshLayout.mBuffers.at(bufferID).mElements.at(elementID);
-                D3D12_INPUT_ELEMENT_DESC desc{};
-                desc.SemanticName = visit(overload(
-                    [](const SV_Position_&) {
-                        return "POSITION";
-                    },
-                    [](const auto& s) {
-                        return getName(s);
-                    }
-                ), descData.mType);
-                desc.SemanticIndex = semanticID++;
-                desc.Format = getDXGIFormat(descData.mFormat);
-                desc.InputSlot = bufferID;
-                desc.AlignedByteOffset = descData.mAlignedByteOffset;
-                desc.InputSlotClass = D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA;
-                desc.InstanceDataStepRate = 0;
-                pElemDescs->emplace_back(desc);
-            }
+        for (const auto& element : stateDesc.mInputElements) {
+            D3D12_INPUT_ELEMENT_DESC desc{};
+            desc.SemanticName = visit(overload(
+                [](const SV_Position_&) {
+                    return "POSITION";
+                },
+                [](const auto& s) {
+                    return getName(s);
+                }
+            ), element.mType);
+            desc.SemanticIndex = element.mSemanticIndex;
+            desc.Format = getDXGIFormat(element.mFormat);
+            desc.InputSlot = element.mInputSlot;
+            desc.AlignedByteOffset = element.mAlignedByteOffset;
+            desc.InputSlotClass = D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA;
+            desc.InstanceDataStepRate = 0;
+            pElemDescs->emplace_back(desc);
         }
-        const auto& stateData = subpassData.mState;
 
         D3D12_GRAPHICS_PIPELINE_STATE_DESC desc{};
         // Shader Binding
         desc.pRootSignature = renderSubpass.mRootSignature.get();
         // Shader
-        desc.VS.pShaderBytecode = subpass.mProgram.mVS->GetBufferPointer();
-        desc.VS.BytecodeLength = subpass.mProgram.mVS->GetBufferSize();
-        desc.PS.pShaderBytecode = subpass.mProgram.mPS->GetBufferPointer();
-        desc.PS.BytecodeLength = subpass.mProgram.mPS->GetBufferSize();
+        desc.VS = subpass.mProgram.mVS;
+        desc.PS = subpass.mProgram.mPS;
         // Render State
         desc.BlendState = getDX12(stateData.mBlendState);
         desc.SampleMask = stateData.mSampleMask;
         desc.RasterizerState = getDX12(stateData.mRasterizerState);
         desc.DepthStencilState = getDX12(stateData.mDepthStencilState);
-
         // Mesh
-        if (!subpassData.mInputLayout.mSemantics.empty()) {
+        if (!pElemDescs->empty()) {
             desc.InputLayout.pInputElementDescs = pElemDescs->data();
             desc.InputLayout.NumElements = (uint32_t)pElemDescs->size();
-            desc.IBStripCutValue = getDX12(meshLayout.mStripCutValue);
-            desc.PrimitiveTopologyType = getDX12(meshLayout.mPrimitiveTopologyType);
-        } else {
-            desc.InputLayout = {};
-            desc.IBStripCutValue = getDX12(subpassData.mInputLayout.mStripCutValue);
-            desc.PrimitiveTopologyType = getDX12(subpassData.mInputLayout.mPrimitiveTopologyType);
         }
-
+        desc.IBStripCutValue = getDX12(stateDesc.mStripCutValue);
+        desc.PrimitiveTopologyType = getDX12(stateDesc.mPrimitiveTopologyType);
         // Render Graph
-        desc.NumRenderTargets = (uint32_t)renderSubpass.mOutputAttachments.size();
-        for (size_t i = 0; i != renderSubpass.mOutputAttachments.size(); ++i) {
-            auto rtvID = renderSubpass.mOutputAttachments[i].mDescriptor.mHandle;
-            desc.RTVFormats[i] = getDXGIFormat(renderSolution.mRTVs[rtvID].mFormat);
-        }
-        if (renderSubpass.mDepthStencilAttachment) {
-            auto dsvID = renderSubpass.mDepthStencilAttachment->mDescriptor.mHandle;
-            desc.DSVFormat = getDXGIFormat(renderSolution.mDSVs[dsvID].mFormat);
-            Expects(desc.DepthStencilState.DepthEnable);
+        Expects(stateDesc.mRTVFormats.size() == renderSubpass.mOutputAttachments.size());
+        desc.NumRenderTargets = (uint32_t)stateDesc.mRTVFormats.size();
+        for (size_t k = 0; k != stateDesc.mRTVFormats.size(); ++k) {
+            desc.RTVFormats[k] = getDXGIFormat(stateDesc.mRTVFormats[k]);
         }
-        desc.SampleDesc = renderSubpass.mSampleDesc;
+        desc.DSVFormat = getDXGIFormat(stateDesc.mDSVFormat);
+        Expects(desc.DSVFormat == DXGI_FORMAT_UNKNOWN || desc.DepthStencilState.DepthEnable);
+        desc.SampleDesc = getDXGI(stateDesc.mSampleDesc);
 
         // Create PSO
-        V(pDevice->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(state.mObject.put())));
+        if (pCompiler) {
+            pCompiler->compile(state, desc, subpass.mProgram, renderSubpass.mRootSignatureHash, stateDesc.mHash);
+        } else if (pLibrary) {
+            state.mObject = pLibrary->createGraphicsPipelineState(desc, renderSubpass.mRootSignatureHash, stateDesc.mHash);
+        } else {
+            V(pDevice->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(state.mObject.put())));
+        }
     }
+    // compilations still running share the bytes
+    subpass.mProgram = {};
 
     pElemDescs.release();
     mr->release();
 }
 
+void createDX12ShaderResources(CreationContext& context,
+    const DX12RenderGraphData& rg, DX12ShaderData& shader
+) {
+    Expects(shader.mShaderData);
+    const auto& prototypeData = *shader.mShaderData;
+    auto& prototype = shader;
+    resizeData(prototype, prototypeData);
+    reserveIndex(prototype);
+    createIndex(prototype, prototypeData, rg.mRenderGraph);
+    Expects(prototype.mSolutions.size() == prototypeData.mSolutions.size());
+    for (auto&& [solution, solutionData] : boost::combine(prototype.mSolutions, prototypeData.mSolutions)) {
+        const auto& renderSolution = rg.mRenderGraph.mSolutions.at(rg.mRenderGraph.mSolutionIndex.at(solutionData.get<0>().first));
+        for (auto&& [pipeline, pipelineData] : boost::combine(solution.mPipelines, solutionData.get<0>().second.mPipelines)) {
+            const auto& renderPipeline = renderSolution.mPipelines.at(renderSolution.mPipelineIndex.at(pipelineData.get<0>().first));
+            for (auto&& [queue, queueData] : boost::combine(pipeline.mQueues, pipelineData.get<0>().second.mQueues)) {
+                const auto& passDesc = renderPipeline.mSubpassIndex.at(queueData.get<0>().first);
+                const auto& renderPass = renderPipeline.mPasses.at(passDesc.mPassID);
+                const auto& renderSubpass = renderPass.mGraphicsSubpasses.at(passDesc.mSubpassID);
+                for (auto&& [level, levelData] : boost::combine(queue.mLevels, queueData.get<0>().second.mLevels)) {
+                    for (auto&& [variant, variantData] : boost::combine(level.mPasses, levelData.get<0>().mPasses)) {
+                        for (auto&& [subpass, subpassData0] : boost::combine(variant.mSubpasses, variantData.get<0>().second.mSubpasses)) {
+                            createShaderResources(renderSubpass,
+                                subpass, subpassData0.get<0>(), context.mDevice,
+                                context.mPipelineLibrary, context.mPipelineCompiler, context.mShaderBlobs,
+                                context.mMemoryArena);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
 std::pair<DX12ShaderData*, bool> try_createDX12ShaderData(CreationContext& context,
     const DX12RenderGraphData& rg, DX12Resources& resources, const MetaID& metaID, bool async
 ) {
     bool created = false;
-    auto iter = resources.mShaders.find(metaID);
-    if (iter != resources.mShaders.end()) {
+    auto handle = resources.mShaders.find(metaID);
+    if (handle) {
 
     } else {
-        std::tie(iter, created) = resources.mShaders.emplace(metaID);
+        std::tie(handle, created) = resources.mShaders.emplace(metaID);
         Ensures(created);
-        auto& shader = const_cast<DX12ShaderData&>(*iter);
+        auto& shader = resources.mShaders[handle];
         /*resources.mShaders.modify(iter, [&](DX12ShaderData& shader) */{
             shader.mShaderData.reset(metaID, async);
             if (!async) {
-                Ensures(shader.mShaderData);
-                const auto& prototypeData = *shader.mShaderData;
-                auto& prototype = shader;
-                resizeData(prototype, prototypeData);
-                reserveIndex(prototype);
-                createIndex(prototype, prototypeData, rg.mRenderGraph);
-                Expects(prototype.mSolutions.size() == prototypeData.mSolutions.size());
-                for (auto&& [solution, solutionData] : boost::combine(prototype.mSolutions, prototypeData.mSolutions)) {
-                    const auto& renderSolution = rg.mRenderGraph.mSolutions.at(rg.mRenderGraph.mSolutionIndex.at(solutionData.get<0>().first));
-                    for (auto&& [pipeline, pipelineData] : boost::combine(solution.mPipelines, solutionData.get<0>().second.mPipelines)) {
-                        const auto& renderPipeline = renderSolution.mPipelines.at(renderSolution.mPipelineIndex.at(pipelineData.get<0>().first));
-                        for (auto&& [queue, queueData] : boost::combine(pipeline.mQueues, pipelineData.get<0>().second.mQueues)) {
-                            const auto& passDesc = renderPipeline.mSubpassIndex.at(queueData.get<0>().first);
-                            const auto& renderPass = renderPipeline.mPasses.at(passDesc.mPassID);
-                            const auto& renderSubpass = renderPass.mGraphicsSubpasses.at(passDesc.mSubpassID);
-                            for (auto&& [level, levelData] : boost::combine(queue.mLevels, queueData.get<0>().second.mLevels)) {
-                                for (auto&& [variant, variantData] : boost::combine(level.mPasses, levelData.get<0>().mPasses)) {
-                                    for (auto&& [subpass, subpassData0] : boost::combine(variant.mSubpasses, variantData.get<0>().second.mSubpasses)) {
-                                        createShaderResources(renderSolution, renderSubpass,
-                                            subpass, subpassData0.get<0>(), resources.mSettings, context.mDevice, context.mMemoryArena);
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
+                createDX12ShaderResources(context, rg, shader);
             } // if async
         }/*);*/
     }
-    return { const_cast<DX12ShaderData*>(&*iter), created };
+    return { &resources.mShaders[handle], created };
 }
 
 void buildDX12MaterialShaderDescriptors(ID3D12Device* pDevice, DX12ShaderDescriptorHeap* pHeap,
@@ -497,8 +948,23 @@ void buildDX12MaterialShaderDescriptors(ID3D12Device* pDevice, DX12ShaderDescrip
     for (const auto& list : collection.mResourceViewLists) {
         auto& dx12List = dx12Collection.mResourceViewLists.emplace_back();
         dx12List.mSlot = list.mSlot;
-        Expects(list.mCapacity);
         dx12List.mCapacity = list.mCapacity;
+        if (std::holds_alternative<Persistent_>(collection.mIndex.mPersistency) &&
+            list.mRanges.empty() && !list.mUnboundedDescriptors.empty()) {
+            // unbounded textures view the bindless table shared by all materials
+            for (const auto& unbounded : list.mUnboundedDescriptors) {
+                if (!std::holds_alternative<SRV_>(unbounded.mType)) {
+                    throw std::runtime_error("material unbounded descriptor must be shader resource view");
+                }
+            }
+            if (!pHeap->getBindlessCapacity()) {
+                throw std::runtime_error("material unbounded descriptor requires bindless textures");
+            }
+            dx12List.mUnboundedDescriptors = list.mUnboundedDescriptors;
+            dx12List.mGpuOffset = pHeap->getBindlessRange().first.mGpuHandle;
+            continue;
+        }
+        Expects(list.mCapacity);
         if (std::holds_alternative<Persistent_>(collection.mIndex.mPersistency)) {
             auto descs = pHeap->allocatePersistent(dx12List.mCapacity);
             dx12List.mGpuOffset = descs.first.mGpuHandle;
@@ -522,6 +988,7 @@ void buildDX12MaterialShaderDescriptors(ID3D12Device* pDevice, DX12ShaderDescrip
                                 auto visitor = overload(
                                     [&](Texture2D_) {
                                         const DX12TextureData* pTex = nullptr;
+                                        DX12TextureData* pViewed = nullptr;
                                         auto iter = material.mMaterialData->mTextures.find(attr.mID);
                                         if (iter != material.mMaterialData->mTextures.end()) {
                                             const auto& texID = iter->second;
@@ -532,21 +999,23 @@ void buildDX12MaterialShaderDescriptors(ID3D12Device* pDevice, DX12ShaderDescrip
                                                     break;
                                                 }
                                             }
+                                            // view default texture until streamed data is uploaded
+                                            // and rewrite the view as larger mips arrive or on reload
+                                            if (pTex) {
+                                                pViewed = const_cast<DX12TextureData*>(pTex);
+                                                if (!pTex->mResident) {
+                                                    pTex = &resources.mDefaultTextures.at(White);
+                                                }
+                                            }
                                         } else {
                                             pTex = &resources.mDefaultTextures.at(White);
                                         }
 
                                         Expects(pTex);
-                                        D3D12_SHADER_RESOURCE_VIEW_DESC viewDesc{
-                                            pTex->mFormat,
-                                            D3D12_SRV_DIMENSION_TEXTURE2D,
-                                            D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING,
-                                        };
-
-                                        viewDesc.Texture2D = D3D12_TEX2D_SRV{ 0, (uint32_t)-1, 0, 0.f };
-
-                                        pDevice->CreateShaderResourceView(pTex->mTexture.get(),
-                                            &viewDesc, descs[i].mCpuHandle);
+                                        createDX12TextureView(pDevice, *pTex, descs[i].mCpuHandle);
+                                        if (pViewed) {
+                                            pViewed->mViewDescriptors.emplace_back(descs[i].mCpuHandle);
+                                        }
                                     },
                                     [&](auto) {
                                         throw std::runtime_error("currently only support Texture2D");
@@ -565,6 +1034,9 @@ void buildDX12MaterialShaderDescriptors(ID3D12Device* pDevice, DX12ShaderDescrip
                                     [&](Descriptor::PointSampler_) {
                                     },
                                     [&](Descriptor::LinearSampler_) {
+                                    },
+                                    [&](auto) {
+                                        throw std::runtime_error("light culling and material constant buffers must be per pass dynamic");
                                     }
                                 ), attr.mDataType);
                                 ++i;
@@ -588,8 +1060,9 @@ void buildDX12MaterialShaderDescriptors(ID3D12Device* pDevice, DX12ShaderDescrip
                 offset += range.mCapacity;
             }
             for (const auto& unbounded : list.mUnboundedDescriptors) {
-                throw std::runtime_error("material resource view list unbounded not supported yet");
+                throw std::runtime_error("material unbounded descriptor must be in its own register space");
             }
+            pHeap->publishPersistent(dx12List.mCpuOffset, dx12List.mCapacity);
         } else {
             dx12List.mRanges = list.mRanges;
         }
@@ -604,13 +1077,13 @@ std::pair<DX12MaterialData*, bool> try_createDX12MaterialData(CreationContext& c
     const DX12RenderGraphData& rg, DX12Resources& resources, const MetaID& metaID, bool async
 ) {
     bool created = false;
-    auto iter = resources.mMaterials.find(metaID);
-    if (iter != resources.mMaterials.end()) {
+    auto handle = resources.mMaterials.find(metaID);
+    if (handle) {
 
     } else {
-        std::tie(iter, created) = resources.mMaterials.emplace(metaID);
+        std::tie(handle, created) = resources.mMaterials.emplace(metaID);
         Ensures(created);
-        auto& material = const_cast<DX12MaterialData&>(*iter);
+        auto& material = resources.mMaterials[handle];
 
         /*resources.mMaterials.modify(iter, [&](DX12MaterialData& material) */{
             material.mMaterialData.reset(metaID, async);
@@ -627,6 +1100,18 @@ std::pair<DX12MaterialData*, bool> try_createDX12MaterialData(CreationContext& c
                     material.mTextures.emplace_back(try_createDX12TextureData(context, resources, texture.second, async).first);
                 }
 
+                // bindless shaders index textures in attribute order
+                material.mTextureIndices.fill(resources.mDefaultTextures.at(White).mBindlessIndex);
+                for (size_t i = 0; i != std::min(material.mTextures.size(), material.mTextureIndices.size()); ++i) {
+                    if (material.mTextures[i]->mBindlessIndex != UINT32_MAX) {
+                        material.mTextureIndices[i] = material.mTextures[i]->mBindlessIndex;
+                    }
+                }
+
+                // draws pass the index, shaders read the constants from the pool
+                material.mConstantIndex = context.mMaterialConstants ?
+                    context.mMaterialConstants->allocate(context, materialData.mConstantMap) : 0;
+
                 material.mShaderData.reserve(material.mShader->mSolutions.size());
                 for (size_t solutionID = 0; solutionID != material.mShader->mSolutions.size(); ++solutionID) {
                     const auto& solution = material.mShader->mSolutions[solutionID];
@@ -674,7 +1159,7 @@ std::pair<DX12MaterialData*, bool> try_createDX12MaterialData(CreationContext& c
         }/*);*/
     }
 
-    return { const_cast<DX12MaterialData*>(&*iter), created };
+    return { &resources.mMaterials[handle], created };
 }
 
 void buildDX12GraphicsSubpassShaderDescriptors(ID3D12Device* pDevice, DX12ShaderDescriptorHeap* pHeap,
@@ -788,6 +1273,8 @@ std::pair<DX12RenderGraphData*, bool> try_createDX12RenderGraphData(CreationCont
             auto& renderData = *render.mRenderGraphData;
             render.mShaderIndex = renderData.mShaderIndex;
             const auto& sc = renderData.mRenderGraph;
+            // subpasses with identical blobs share one root signature, the state cache then skips rebinding it
+            std::unordered_map<std::string_view, com_ptr<ID3D12RootSignature>> rootSignatures;
 
             render.mRenderGraph.mSolutions.reserve(sc.mSolutions.size());
             render.mRenderGraph.mFramebuffers.resize(sc.mNumReserveFramebuffers);
@@ -814,6 +1301,7 @@ std::pair<DX12RenderGraphData*, bool> try_createDX12RenderGraphData(CreationCont
                 solution.mUAVs = solutionData.mUAVs;
                 solution.mAttributeIndex = solutionData.mAttributeIndex;
                 solution.mPipelineIndex = solutionData.mPipelineIndex;
+                solution.mOutputColorSpace = solutionData.mOutputColorSpace;
 
                 for (const auto& pipelineData : solutionData.mPipelines) {
                     auto& pipeline = solution.mPipelines.emplace_back();
@@ -840,7 +1328,15 @@ std::pair<DX12RenderGraphData*, bool> try_createDX12RenderGraphData(CreationCont
                             subpass.mDepthStencilAttachment = subpassData.mDepthStencilAttachment;
                             subpass.mPreserveAttachments = subpassData.mPreserveAttachments;
                             subpass.mPostViewTransitions = subpassData.mPostViewTransitions;
+                            subpass.mAliasingBarriers = subpassData.mAliasingBarriers;
                             subpass.mConstantBuffers = subpassData.mConstantBuffers;
+                            subpass.mOcclusionCulling = subpassData.mOcclusionCulling;
+                            subpass.mLightCulling = subpassData.mLightCulling;
+                            subpass.mShadowCaching = subpassData.mShadowCache;
+                            subpass.mShadingRate = getDX12(subpassData.mShadingRate);
+                            subpass.mShadingRateImage = subpassData.mShadingRateImage;
+                            subpass.mView = subpassData.mView;
+                            subpass.mUpscaling = subpassData.mUpscaling;
 
                             subpass.mDescriptors.reserve(subpassData.mDescriptors.size());
                             for (const auto& collection : subpassData.mDescriptors) {
@@ -850,10 +1346,16 @@ std::pair<DX12RenderGraphData*, bool> try_createDX12RenderGraphData(CreationCont
                             }
 
                             if (!subpassData.mRootSignature.empty()) {
-                                V(context.mDevice->CreateRootSignature(0,
-                                    subpassData.mRootSignature.data(),
-                                    subpassData.mRootSignature.size(),
-                                    IID_PPV_ARGS(subpass.mRootSignature.put())));
+                                auto& rootSignature = rootSignatures[subpassData.mRootSignature];
+                                if (!rootSignature) {
+                                    V(context.mDevice->CreateRootSignature(0,
+                                        subpassData.mRootSignature.data(),
+                                        subpassData.mRootSignature.size(),
+                                        IID_PPV_ARGS(rootSignature.put())));
+                                }
+                                subpass.mRootSignature = rootSignature;
+                                subpass.mRootSignatureHash = hashDX12Bytes(
+                                    subpassData.mRootSignature.data(), subpassData.mRootSignature.size());
                             }
                         }
                     }
@@ -887,10 +1389,12 @@ std::pair<DX12RenderGraphData*, bool> try_createDX12RenderGraphData(CreationCont
                     const auto& pipelineData = pipelineData0.get<0>();
 
                     Expects(pipeline.mPasses.size() == pipelineData.mPasses.size());
+                    uint32_t passID = 0;
                     for (auto&& [pass, passData0] : boost::combine(pipeline.mPasses, pipelineData.mPasses)) {
                         const auto& passData = passData0.get<0>();
 
                         Expects(pass.mGraphicsSubpasses.size() == passData.mGraphicsSubpasses.size());
+                        uint32_t subpassID = 0;
                         for (auto&& [subpass, subpassData0] : boost::combine(pass.mGraphicsSubpasses, passData.mGraphicsSubpasses)) {
                             const auto& subpassData = subpassData0.get<0>();
 
@@ -901,10 +1405,24 @@ std::pair<DX12RenderGraphData*, bool> try_createDX12RenderGraphData(CreationCont
                                 for (const auto& contentID : unorderedQueueData.mContents) {
                                     try_createDX12(context, resources, contentID, Core::Content, async);
                                     unorderedQueue.mContents.emplace_back(boost::intrusive_ptr<DX12ContentData>(
-                                        const_cast<DX12ContentData*>(&at(resources.mContents, contentID))));
+                                        &resources.mContents.at(contentID)));
+                                }
+                                buildDX12DrawPackets(currentSolutionId, currentPipelineID,
+                                    passID, subpassID, unorderedQueue);
+                                if (context.mGpuDrivenRendering) {
+                                    buildDX12IndirectDraws(context, subpass.mRootSignature.get(), unorderedQueue);
                                 }
+                                buildDX12PersistentConstants(context, unorderedQueue);
                             }
+                            if (subpass.mOcclusionCulling) {
+                                buildDX12OcclusionCulling(context, subpass);
+                            }
+                            if (subpass.mLightCulling) {
+                                buildDX12LightCulling(context, subpass);
+                            }
+                            ++subpassID;
                         }
+                        ++passID;
                     }
                     ++pipelineID;
                 }
@@ -944,9 +1462,8 @@ bool try_createDX12(CreationContext& context, DX12Resources& resources, const Me
         [&](Core::Content_) {
             auto res = resources.mContents.emplace(metaID);
             if (res.second) {
-                const auto& metaID2 = res.first->mMetaID;
-                Expects(res.first->mMetaID == metaID);
-                auto& content = const_cast<DX12ContentData&>(*res.first);
+                auto& content = resources.mContents[res.first];
+                Expects(content.mMetaID == metaID);
 
                 /*resources.mContents.modify(res.first, [&](DX12ContentData& content) */{
                     content.mContentData.reset(metaID, async);
@@ -956,7 +1473,20 @@ bool try_createDX12(CreationContext& context, DX12Resources& resources, const Me
 
                         Ensures(content.mContentData);
                         const auto& contentData = *content.mContentData;
-                        content.mIDs = contentData.mIDs;
+                        for (const auto& id : contentData.mIDs) {
+                            visit(overload(
+                                [&](DrawCall_) {
+                                    if (id.mIndex >= contentData.mDrawCalls.size())
+                                        throw std::runtime_error("content draw call out of range");
+                                    content.mDrawCallIDs.emplace_back(id.mIndex);
+                                },
+                                [&](ObjectBatch_) {
+                                    if (id.mIndex >= contentData.mFlattenedObjects.size())
+                                        throw std::runtime_error("content object batch out of range");
+                                    content.mBatchIDs.emplace_back(id.mIndex);
+                                }
+                            ), id.mType);
+                        }
                         content.mDrawCalls.reserve(contentData.mDrawCalls.size());
                         content.mFlattenedObjects.reserve(contentData.mFlattenedObjects.size());
                         for (const auto& data : contentData.mDrawCalls) {
@@ -972,8 +1502,7 @@ bool try_createDX12(CreationContext& context, DX12Resources& resources, const Me
                         }
                         for (const auto& data : contentData.mFlattenedObjects) {
                             auto& object = content.mFlattenedObjects.emplace_back();
-                            object.mWorldTransforms = data.mWorldTransforms;
-                            object.mWorldTransformInvs = data.mWorldTransformInvs;
+                            buildDX12Transforms(object, data.mWorldTransforms, data.mWorldTransformInvs);
                             object.mBoundingBoxes = data.mBoundingBoxes;
                             object.mMeshRenderers.reserve(data.mMeshRenderers.size());
                             for (const auto& rendererData : data.mMeshRenderers) {
@@ -985,13 +1514,15 @@ bool try_createDX12(CreationContext& context, DX12Resources& resources, const Me
                                         try_createDX12MaterialData(context, *iter, resources, materialID, async).first);
                                 }
                             }
+                            buildDX12WorldBounds(object);
+                            buildDX12Bvh(object, data.mBvhNodes, data.mBvhObjects);
                         }
                     }
                 }/*);*/
 
                 return true;
             } else {
-                auto& content = *res.first;
+                const auto& content = resources.mContents[res.first];
                 Expects(content.mContentData.valid());
                 Expects(content.mContentData.metaID() == metaID);
                 return false;
@@ -1003,4 +1534,84 @@ bool try_createDX12(CreationContext& context, DX12Resources& resources, const Me
     ), tag);
 }
 
+DX12SharedResourceStats getDX12SharedResourceStats(ID3D12Device* pDevice, const DX12Resources& resources) {
+    DX12SharedResourceStats stats;
+
+    // loaded contents referencing each mesh and texture
+    std::unordered_map<const DX12MeshData*, uint32_t> meshes;
+    std::unordered_map<const DX12TextureData*, uint32_t> textures;
+    std::unordered_set<const DX12MeshData*> contentMeshes;
+    std::unordered_set<const DX12TextureData*> contentTextures;
+
+    const auto addMesh = [&](const DX12MeshData* pMesh) {
+        if (pMesh) {
+            contentMeshes.emplace(pMesh);
+        }
+    };
+    const auto addMaterial = [&](const DX12MaterialData* pMaterial) {
+        if (!pMaterial)
+            return;
+        for (const auto& tex : pMaterial->mTextures) {
+            if (tex) {
+                contentTextures.emplace(tex.get());
+            }
+        }
+    };
+
+    for (const auto& content : resources.mContents) {
+        if (!content.mRefCount)
+            continue;
+        ++stats.mContentCount;
+        contentMeshes.clear();
+        contentTextures.clear();
+        for (const auto& dc : content.mDrawCalls) {
+            addMesh(dc.mMesh.get());
+            addMaterial(dc.mMaterial.get());
+        }
+        for (const auto& object : content.mFlattenedObjects) {
+            for (const auto& renderer : object.mMeshRenderers) {
+                addMesh(renderer.mMesh.get());
+                for (const auto& material : renderer.mMaterials) {
+                    addMaterial(material.get());
+                }
+            }
+        }
+        for (const auto* pMesh : contentMeshes) {
+            ++meshes[pMesh];
+        }
+        for (const auto* pTex : contentTextures) {
+            ++textures[pTex];
+        }
+    }
+
+    // pooled meshes are sized by their views, not by the page they share
+    for (const auto& [pMesh, count] : meshes) {
+        uint64_t size = pMesh->mIndexBufferView.SizeInBytes;
+        for (const auto& view : pMesh->mVertexBufferViews) {
+            size += view.SizeInBytes;
+        }
+        if (count > 1) {
+            ++stats.mSharedMeshes;
+            stats.mSharedBytes += size;
+        } else {
+            ++stats.mUniqueMeshes;
+            stats.mUniqueBytes += size;
+        }
+    }
+    for (const auto& [pTex, count] : textures) {
+        if (!pTex->mTexture)
+            continue;
+        const auto desc = pTex->mTexture->GetDesc();
+        const auto size = pDevice->GetResourceAllocationInfo(0, 1, &desc).SizeInBytes;
+        if (count > 1) {
+            ++stats.mSharedTextures;
+            stats.mSharedBytes += size;
+        } else {
+            ++stats.mUniqueTextures;
+            stats.mUniqueBytes += size;
+        }
+    }
+    return stats;
+}
+
 }
@@ -19,39 +19,48 @@
 #include <Star/DX12Engine/SDX12Types.h>
 #include <Star/Core/SCoreTypes.h>
 #include <Star/DX12Engine/SDX12UploadBuffer.h>
+#include <Star/DX12Engine/SDX12UploadQueue.h>
+#include <Star/SJobSystem.h>
 
 namespace Star::Graphics::Render {
 
 class DX12UploadBuffer;
 class DX12ShaderDescriptorHeap;
+struct DX12ShaderDescriptorRelocation;
+class DX12StreamingQueue;
+class DX12HeapAllocator;
+class DX12TilePool;
+class DX12ReleaseQueue;
+class DX12MeshPool;
+class DX12MaterialConstantPool;
+class DX12PipelineLibrary;
+class DX12PipelineCompiler;
+class DX12ShaderBlobStore;
+
+// meshes and textures created while collected, their uploads are recorded together by recordDX12Uploads
+struct DX12DeferredUploads {
+    std::vector<DX12MeshData*> mMeshes;
+    std::vector<DX12TextureData*> mTextures;
+};
 
 struct CreationContext {
+    // copy targets are in common state once the copy queue is done with them
+    static constexpr D3D12_RESOURCE_STATES sUploadedState = D3D12_RESOURCE_STATE_COMMON;
+
     void record() {
-        mUploadBuffer->advanceFrame(mNextFrameFence);
-        mCommandList->Reset(mCommandAllocator, nullptr);
+        mUploadQueue->record(*mUploadBuffer);
+        mCommandList = mUploadQueue->directList();
+        mCopyList = mUploadQueue->copyList();
     }
-    void flush() {
-        V(mCommandList->Close());
-        ID3D12CommandList* ppCommandLists[] = { mCommandList };
-        mDirectQueue->ExecuteCommandLists(_countof(ppCommandLists), ppCommandLists);
-        auto fenceID = mNextFrameFence;
-        check_hresult(mDirectQueue->Signal(mFence.get(), mNextFrameFence));
-        ++mNextFrameFence;
-
-        check_hresult(mFence->SetEventOnCompletion(fenceID, mFenceEvent.get()));
-        WaitForSingleObject(mFenceEvent.get(), INFINITE);
-        mCommandAllocator->Reset();
+    // submit without waiting, returns the fence completing the uploads
+    uint64_t flush() {
+        mCommandList = nullptr;
+        mCopyList = nullptr;
         mMemoryAllocated = 0;
-        mUploadBuffer->releaseBuffer(fenceID);
+        return mUploadQueue->flush();
     }
     DX12BufferData upload(const std::pmr::vector<char>& buffer, size_t alignment) {
-        auto accumulatedSize = mMemoryAllocated + buffer.size();
-        if (accumulatedSize > mMaxUploadSize) {
-            flush();
-            record();
-        }
-        mMemoryAllocated += buffer.size();
-        return mUploadBuffer->upload(buffer.data(), buffer.size(), 1, alignment);
+        return upload(buffer.data(), buffer.size(), alignment);
     }
     DX12BufferData upload(const void* data, size_t sz, size_t alignment) {
         auto accumulatedSize = mMemoryAllocated + sz;
@@ -65,23 +74,97 @@ struct CreationContext {
     std::string_view mCurrentSolution;
     std::string_view mCurrentPipeline;
     ID3D12Device* mDevice = nullptr;
-    ID3D12CommandQueue* mDirectQueue = nullptr;
-    ID3D12CommandAllocator* mCommandAllocator = nullptr;
+    DX12UploadQueue* mUploadQueue = nullptr;
+    // copies are recorded on mCopyList, barriers and other commands on mCommandList
     ID3D12GraphicsCommandList* mCommandList = nullptr;
-    std::pmr::monotonic_buffer_resource* mMemoryArena = nullptr;
+    ID3D12GraphicsCommandList* mCopyList = nullptr;
+    FrameArena* mMemoryArena = nullptr;
     size_t mMaxUploadSize = 0;
     MetaID mRenderGraph = {};
     DX12UploadBuffer* mUploadBuffer = nullptr;
     DX12ShaderDescriptorHeap* mDescriptorHeap = nullptr;
-    com_ptr<ID3D12Fence> mFence;
-    winrt::handle mFenceEvent;
-    uint64_t mNextFrameFence = 1;
+    // mesh and texture data is queued instead of uploaded if set
+    DX12StreamingQueue* mStreaming = nullptr;
+    // placed memory of mesh buffers and textures
+    DX12HeapAllocator* mHeapAllocator = nullptr;
+    // streamed textures this wide or high are reserved and mapped from the pool if set
+    DX12TilePool* mTilePool = nullptr;
+    uint32_t mReservedTextureDimension = 0;
+    // meshes and textures release their resources through it if set
+    DX12ReleaseQueue* mReleaseQueue = nullptr;
+    // packs meshes of a vertex layout into shared buffers if set
+    DX12MeshPool* mMeshPool = nullptr;
+    // constants of created materials are copied into it
+    DX12MaterialConstantPool* mMaterialConstants = nullptr;
+    // loads graphics psos of previous runs if set
+    DX12PipelineLibrary* mPipelineLibrary = nullptr;
+    // graphics psos are compiled on task threads if set
+    DX12PipelineCompiler* mPipelineCompiler = nullptr;
+    // bytecode of shaders stored in the blob file of the library
+    DX12ShaderBlobStore* mShaderBlobs = nullptr;
+    // uploads of created meshes and textures are collected instead of recorded if set
+    DX12DeferredUploads* mDeferredUploads = nullptr;
     size_t mMemoryAllocated = 0;
+    bool mGpuDrivenRendering = false;
+    uint32_t mFrameQueueSize = 0;
 };
 
+// record uploads of created resources, buffers and textures are already allocated
+void uploadDX12MeshData(CreationContext& context, DX12MeshData& mesh);
+// mips in [beginMip, endMip) are copied, the rest of the texture is left untouched
+void uploadDX12TextureData(CreationContext& context, DX12TextureData& tex,
+    uint32_t beginMip = 0, uint32_t endMip = UINT32_MAX);
+
+// record collected uploads on recorders of the upload queue, one job per recorder
+// a batch holds about mMaxUploadSize per recorder, larger sets are flushed in several batches
+void recordDX12Uploads(CreationContext& context, JobSystem& jobs, DX12DeferredUploads& uploads);
+
+// map pool tiles to the unmapped mips in [beginMip, endMip) of a reserved texture
+// false if the pool runs out, mips mapped so far stay mapped
+bool mapDX12TextureTiles(CreationContext& context, DX12TextureData& tex,
+    uint32_t beginMip, uint32_t endMip);
+
+// first mip of the tail uploaded in one go before larger mips stream one by one
+uint32_t getDX12TextureMipTail(const TextureData& textureData) noexcept;
+// upload bytes of mips in [beginMip, endMip)
+uint64_t getDX12TextureUploadSize(const TextureData& textureData,
+    uint32_t beginMip, uint32_t endMip) noexcept;
+
+void createDX12TextureView(ID3D12Device* pDevice, const DX12TextureData& tex,
+    D3D12_CPU_DESCRIPTOR_HANDLE handle);
+
+// place texture in the bindless table, views fallback until the texture is resident
+void createDX12BindlessTextureView(ID3D12Device* pDevice, DX12ShaderDescriptorHeap& heap,
+    const DX12TextureData& fallback, DX12TextureData& tex);
+
+// switch descriptor lists, cached draw bindings and fallback views to compacted or grown descriptors
+void relocateDX12ShaderDescriptors(DX12Resources& resources,
+    const std::pmr::vector<DX12ShaderDescriptorRelocation>& relocations);
+
+// set psos published by the pipeline compiler or swapped by shader reloads to the draw packets
+void resolveDX12PipelineStates(DX12Resources& resources);
+
+// psos of the fetched shader data, compiled on task threads if the context has a pipeline compiler
+void createDX12ShaderResources(CreationContext& context,
+    const DX12RenderGraphData& rg, DX12ShaderData& shader);
+
 bool try_createDX12(CreationContext&context,
     DX12Resources& resources, const MetaID& metaID, Core::ResourceType tag, bool async = true);
 
+// meshes and textures are created once per MetaID and ref counted, contents loaded later reuse them
+// shared resources are referenced by more than one loaded content, unique ones by exactly one
+struct DX12SharedResourceStats {
+    uint32_t mContentCount = 0;
+    uint32_t mSharedMeshes = 0;
+    uint32_t mUniqueMeshes = 0;
+    uint32_t mSharedTextures = 0;
+    uint32_t mUniqueTextures = 0;
+    uint64_t mSharedBytes = 0;
+    uint64_t mUniqueBytes = 0;
+};
+
+DX12SharedResourceStats getDX12SharedResourceStats(ID3D12Device* pDevice, const DX12Resources& resources);
+
 inline bool try_streamDX12(DX12Resources& resources, const MetaID& metaID) {
     return false;
 }
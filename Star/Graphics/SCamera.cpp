@@ -226,4 +226,32 @@ void Camera::perspective(float fovRadY, float aspectWByH, float nearPlane, float
     mFarClip = farPlane;
 }
 
+namespace {
+
+float halton(uint32_t index, uint32_t base) noexcept {
+    float f = 1;
+    float r = 0;
+    while (index) {
+        f /= float(base);
+        r += f * float(index % base);
+        index /= base;
+    }
+    return r;
+}
+
+}
+
+Vector2f getHaltonJitter(uint64_t frame, uint32_t phases) noexcept {
+    Expects(phases);
+    // index 0 of the sequence is the origin, start at 1
+    const auto index = gsl::narrow_cast<uint32_t>(frame % phases) + 1;
+    return Vector2f(halton(index, 2) - 0.5f, halton(index, 3) - 0.5f);
+}
+
+void jitterProjection(Matrix4f& proj, const Vector2f& jitter) noexcept {
+    // clip xy are offset by jitter * clip w, ndc are offset by jitter after the divide
+    proj.row(0) += jitter.x() * proj.row(3);
+    proj.row(1) += jitter.y() * proj.row(3);
+}
+
 }
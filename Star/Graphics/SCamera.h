@@ -38,4 +38,10 @@ public:
     void perspective(float fovRadY, float aspectWByH, float nearPlane, float farPlane);
 };
 
+// subpixel offset of a frame in pixels within [-0.5, 0.5), halton sequence of base 2 and 3 repeating every phases frames
+STAR_GRAPHICS_API Vector2f getHaltonJitter(uint64_t frame, uint32_t phases) noexcept;
+
+// shifts the projection by jitter in ndc units, for temporal upscaling and antialiasing
+STAR_GRAPHICS_API void jitterProjection(Matrix4f& proj, const Vector2f& jitter) noexcept;
+
 }
@@ -0,0 +1,160 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+#include "SContentFile.h"
+
+namespace Star::Graphics::Render {
+
+static_assert(std::is_trivially_copyable_v<ContentID>);
+static_assert(std::is_trivially_copyable_v<DrawCallData>);
+static_assert(sizeof(ContentFileObjects) == 48);
+static_assert(sizeof(ContentFileMeshRenderer) == 32);
+// fixed size Eigen transforms and boxes are plain floats, copied bytewise
+static_assert(sizeof(WorldTransform) == 64);
+static_assert(sizeof(WorldTransformInv) == 64);
+static_assert(sizeof(BoundingBox) == 32 * 2);
+static_assert(sizeof(BvhNode4) == 128);
+
+namespace {
+
+using ContentFileWriter = FlatFileWriter<ContentFileSection>;
+
+class ContentFileReader : public FlatFileReader<ContentFileSection> {
+public:
+    ContentFileReader(const std::byte* data, size_t size)
+        : FlatFileReader(data, size, sContentFileMagic, sContentFileVersion, "content file")
+    {}
+
+    // slice of a concatenated section, validated against the section size
+    template<class T>
+    const std::byte* slice(ContentFileSection type, uint32_t offset, uint32_t count) const {
+        if (count == 0) {
+            return nullptr;
+        }
+        const auto* section = find(type);
+        if (!section || (uint64_t(offset) + count) * sizeof(T) > section->mSize) {
+            throw std::runtime_error("content file slice out of range");
+        }
+        return data(*section) + uint64_t(offset) * sizeof(T);
+    }
+};
+
+template<class T>
+void append(std::vector<T>& dst, const std::pmr::vector<T>& src, uint32_t& offset, uint32_t& count) {
+    offset = gsl::narrow<uint32_t>(dst.size());
+    count = gsl::narrow<uint32_t>(src.size());
+    dst.insert(dst.end(), src.begin(), src.end());
+}
+
+template<class T>
+void assign(const ContentFileReader& reader, ContentFileSection type,
+    uint32_t offset, uint32_t count, std::pmr::vector<T>& values
+) {
+    const auto* src = reader.slice<T>(type, offset, count);
+    values.resize(count);
+    if (count) {
+        std::memcpy(values.data(), src, sizeof(T) * count);
+    }
+}
+
+}
+
+bool isContentFile(const std::byte* data, size_t size) noexcept {
+    return isFlatFile(data, size, sContentFileMagic);
+}
+
+void saveContentFile(std::ostream& os, const ContentData& content) {
+    std::vector<ContentFileObjects> objects;
+    std::vector<WorldTransform> worldTransforms;
+    std::vector<WorldTransformInv> worldTransformInvs;
+    std::vector<BoundingBox> boundingBoxes;
+    std::vector<ContentFileMeshRenderer> meshRenderers;
+    std::vector<MetaID> materialIDs;
+    std::vector<BvhNode4> bvhNodes;
+    std::vector<uint32_t> bvhObjects;
+
+    objects.reserve(content.mFlattenedObjects.size());
+    for (const auto& batch : content.mFlattenedObjects) {
+        auto& obj = objects.emplace_back();
+        append(worldTransforms, batch.mWorldTransforms, obj.mWorldTransformOffset, obj.mWorldTransformCount);
+        append(worldTransformInvs, batch.mWorldTransformInvs, obj.mWorldTransformInvOffset, obj.mWorldTransformInvCount);
+        append(boundingBoxes, batch.mBoundingBoxes, obj.mBoundingBoxOffset, obj.mBoundingBoxCount);
+        append(bvhNodes, batch.mBvhNodes, obj.mBvhNodeOffset, obj.mBvhNodeCount);
+        append(bvhObjects, batch.mBvhObjects, obj.mBvhObjectOffset, obj.mBvhObjectCount);
+        obj.mMeshRendererOffset = gsl::narrow<uint32_t>(meshRenderers.size());
+        obj.mMeshRendererCount = gsl::narrow<uint32_t>(batch.mMeshRenderers.size());
+        for (const auto& renderer : batch.mMeshRenderers) {
+            auto& dst = meshRenderers.emplace_back();
+            dst.mMeshID = renderer.mMeshID;
+            dst.mMaterialOffset = gsl::narrow<uint32_t>(materialIDs.size());
+            dst.mMaterialCount = gsl::narrow<uint32_t>(renderer.mMaterialIDs.size());
+            materialIDs.insert(materialIDs.end(), renderer.mMaterialIDs.begin(), renderer.mMaterialIDs.end());
+        }
+    }
+
+    ContentFileWriter writer(sContentFileMagic, sContentFileVersion);
+    writer.add(ContentFileSection::IDs, content.mIDs);
+    writer.add(ContentFileSection::DrawCalls, content.mDrawCalls);
+    writer.add(ContentFileSection::Objects, objects);
+    writer.add(ContentFileSection::WorldTransforms, worldTransforms);
+    writer.add(ContentFileSection::WorldTransformInvs, worldTransformInvs);
+    writer.add(ContentFileSection::BoundingBoxes, boundingBoxes);
+    writer.add(ContentFileSection::MeshRenderers, meshRenderers);
+    writer.add(ContentFileSection::MaterialIDs, materialIDs);
+    writer.add(ContentFileSection::BvhNodes, bvhNodes);
+    writer.add(ContentFileSection::BvhObjects, bvhObjects);
+    writer.write(os);
+}
+
+void loadContentFile(const std::byte* data, size_t size, ContentData& content) {
+    ContentFileReader reader(data, size);
+
+    reader.read(ContentFileSection::IDs, content.mIDs);
+    reader.read(ContentFileSection::DrawCalls, content.mDrawCalls);
+
+    std::vector<ContentFileObjects> objects;
+    reader.read(ContentFileSection::Objects, objects);
+
+    content.mFlattenedObjects.clear();
+    content.mFlattenedObjects.reserve(objects.size());
+    for (const auto& obj : objects) {
+        auto& batch = content.mFlattenedObjects.emplace_back();
+        assign(reader, ContentFileSection::WorldTransforms,
+            obj.mWorldTransformOffset, obj.mWorldTransformCount, batch.mWorldTransforms);
+        assign(reader, ContentFileSection::WorldTransformInvs,
+            obj.mWorldTransformInvOffset, obj.mWorldTransformInvCount, batch.mWorldTransformInvs);
+        assign(reader, ContentFileSection::BoundingBoxes,
+            obj.mBoundingBoxOffset, obj.mBoundingBoxCount, batch.mBoundingBoxes);
+        assign(reader, ContentFileSection::BvhNodes,
+            obj.mBvhNodeOffset, obj.mBvhNodeCount, batch.mBvhNodes);
+        assign(reader, ContentFileSection::BvhObjects,
+            obj.mBvhObjectOffset, obj.mBvhObjectCount, batch.mBvhObjects);
+
+        const auto* renderers = reader.slice<ContentFileMeshRenderer>(ContentFileSection::MeshRenderers,
+            obj.mMeshRendererOffset, obj.mMeshRendererCount);
+        batch.mMeshRenderers.reserve(obj.mMeshRendererCount);
+        for (uint32_t i = 0; i != obj.mMeshRendererCount; ++i) {
+            ContentFileMeshRenderer src;
+            std::memcpy(&src, renderers + sizeof(src) * i, sizeof(src));
+            auto& renderer = batch.mMeshRenderers.emplace_back();
+            renderer.mMeshID = src.mMeshID;
+            assign(reader, ContentFileSection::MaterialIDs,
+                src.mMaterialOffset, src.mMaterialCount, renderer.mMaterialIDs);
+        }
+    }
+}
+
+}
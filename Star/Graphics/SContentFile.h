@@ -0,0 +1,74 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+#include <Star/Graphics/SConfig.h>
+#include <Star/Graphics/SContentTypes.h>
+#include <Star/Graphics/SFlatFile.h>
+
+namespace Star::Graphics::Render {
+
+// flat runtime content container, replaces the boost archive in the library,
+// object arrays of every batch are concatenated and sliced back on load
+constexpr uint32_t sContentFileMagic = 0x544E4353; // SCNT
+constexpr uint32_t sContentFileVersion = 3;
+
+enum class ContentFileSection : uint32_t {
+    IDs,
+    DrawCalls,
+    Objects,
+    WorldTransforms,
+    WorldTransformInvs,
+    BoundingBoxes,
+    MeshRenderers,
+    MaterialIDs,
+    BvhNodes,
+    BvhObjects,
+};
+
+using ContentFileSectionEntry = FlatFileSectionEntry<ContentFileSection>;
+
+// element ranges of one FlattenedObjects batch
+struct ContentFileObjects {
+    uint32_t mWorldTransformOffset = 0;
+    uint32_t mWorldTransformCount = 0;
+    uint32_t mWorldTransformInvOffset = 0;
+    uint32_t mWorldTransformInvCount = 0;
+    uint32_t mBoundingBoxOffset = 0;
+    uint32_t mBoundingBoxCount = 0;
+    uint32_t mMeshRendererOffset = 0;
+    uint32_t mMeshRendererCount = 0;
+    uint32_t mBvhNodeOffset = 0;
+    uint32_t mBvhNodeCount = 0;
+    uint32_t mBvhObjectOffset = 0;
+    uint32_t mBvhObjectCount = 0;
+};
+
+struct ContentFileMeshRenderer {
+    MetaID mMeshID = {};
+    uint32_t mMaterialOffset = 0;
+    uint32_t mMaterialCount = 0;
+    uint32_t mReserved[2] = {};
+};
+
+STAR_GRAPHICS_API bool isContentFile(const std::byte* data, size_t size) noexcept;
+
+STAR_GRAPHICS_API void saveContentFile(std::ostream& os, const ContentData& content);
+
+// content containers keep their allocator, throws on a truncated or foreign file
+STAR_GRAPHICS_API void loadContentFile(const std::byte* data, size_t size, ContentData& content);
+
+}
@@ -32,11 +32,16 @@ struct MeshBufferLayout;
 struct VertexBufferData;
 struct IndexBufferData;
 struct SubMeshData;
+struct MeshletData;
+struct MeshLodData;
 struct MeshData;
 struct TextureData;
 struct PipelineStateData;
+struct ShaderBlobRange;
 struct ShaderProgramData;
 struct ShaderInputLayout;
+struct PipelineInputElement;
+struct PipelineStateDesc;
 struct ShaderSubpassData;
 struct ShaderPassData;
 struct ShaderLevelData;
@@ -61,6 +66,7 @@ using CameraView = std::variant<std::monostate, Direct3D_, Vulkan_, OpenGL_>;
 using CameraNDC = std::variant<Direct3D_, Vulkan_>;
 
 struct CameraData;
+struct PointLightData;
 struct MeshRenderer;
 struct FlattenedObjects;
 struct ContentSettings;
@@ -136,10 +136,37 @@ inline void load_construct_data(
 
 STAR_CLASS_IMPLEMENTATION(Star::Graphics::Render::SubMeshData, object_serializable);
 STAR_CLASS_TRACKING(Star::Graphics::Render::SubMeshData, track_never);
+STAR_CLASS_BITWISE(Star::Graphics::Render::SubMeshData);
 template<class Archive>
 void serialize(Archive& ar, Star::Graphics::Render::SubMeshData& v, const uint32_t version) {
     ar & v.mIndexOffset;
     ar & v.mIndexCount;
+    ar & v.mMeshletOffset;
+    ar & v.mMeshletCount;
+}
+
+STAR_CLASS_IMPLEMENTATION(Star::Graphics::Render::MeshletData, object_serializable);
+STAR_CLASS_TRACKING(Star::Graphics::Render::MeshletData, track_never);
+STAR_CLASS_BITWISE(Star::Graphics::Render::MeshletData);
+template<class Archive>
+void serialize(Archive& ar, Star::Graphics::Render::MeshletData& v, const uint32_t version) {
+    ar & v.mVertexOffset;
+    ar & v.mVertexCount;
+    ar & v.mTriangleOffset;
+    ar & v.mTriangleCount;
+    ar & v.mCenter;
+    ar & v.mRadius;
+    ar & v.mConeAxis;
+    ar & v.mConeCutoff;
+}
+
+STAR_CLASS_IMPLEMENTATION(Star::Graphics::Render::MeshLodData, object_serializable);
+STAR_CLASS_TRACKING(Star::Graphics::Render::MeshLodData, track_never);
+STAR_CLASS_BITWISE(Star::Graphics::Render::MeshLodData);
+template<class Archive>
+void serialize(Archive& ar, Star::Graphics::Render::MeshLodData& v, const uint32_t version) {
+    ar & v.mSubMeshOffset;
+    ar & v.mError;
 }
 
 STAR_CLASS_IMPLEMENTATION(Star::Graphics::Render::MeshData, object_serializable);
@@ -151,6 +178,11 @@ void serialize(Archive& ar, Star::Graphics::Render::MeshData& v, const uint32_t
     ar & v.mSubMeshes;
     ar & v.mLayoutID;
     ar & v.mLayoutName;
+    ar & v.mMeshlets;
+    ar & v.mMeshletVertices;
+    ar & v.mMeshletTriangles;
+    ar & v.mLods;
+    ar & v.mLodSubMeshes;
 }
 
 template<class Archive>
@@ -201,6 +233,14 @@ void serialize(Archive& ar, Star::Graphics::Render::PipelineStateData& v, const
     ar & v.mDepthStencilState;
 }
 
+STAR_CLASS_IMPLEMENTATION(Star::Graphics::Render::ShaderBlobRange, object_serializable);
+STAR_CLASS_TRACKING(Star::Graphics::Render::ShaderBlobRange, track_never);
+template<class Archive>
+void serialize(Archive& ar, Star::Graphics::Render::ShaderBlobRange& v, const uint32_t version) {
+    ar & v.mOffset;
+    ar & v.mSize;
+}
+
 STAR_CLASS_IMPLEMENTATION(Star::Graphics::Render::ShaderProgramData, object_serializable);
 STAR_CLASS_TRACKING(Star::Graphics::Render::ShaderProgramData, track_never);
 template<class Archive>
@@ -210,6 +250,11 @@ void serialize(Archive& ar, Star::Graphics::Render::ShaderProgramData& v, const
     ar & v.mDS;
     ar & v.mGS;
     ar & v.mPS;
+    ar & v.mVSBlob;
+    ar & v.mHSBlob;
+    ar & v.mDSBlob;
+    ar & v.mGSBlob;
+    ar & v.mPSBlob;
 }
 
 template<class Archive>
@@ -249,6 +294,44 @@ inline void load_construct_data(
     ::new(t) std::pair<K, Star::Graphics::Render::ShaderInputLayout>(std::piecewise_construct, std::forward_as_tuple(), std::forward_as_tuple(ar.resource()));
 }
 
+STAR_CLASS_IMPLEMENTATION(Star::Graphics::Render::PipelineInputElement, object_serializable);
+STAR_CLASS_TRACKING(Star::Graphics::Render::PipelineInputElement, track_never);
+template<class Archive>
+void serialize(Archive& ar, Star::Graphics::Render::PipelineInputElement& v, const uint32_t version) {
+    ar & v.mType;
+    ar & v.mSemanticIndex;
+    ar & v.mFormat;
+    ar & v.mInputSlot;
+    ar & v.mAlignedByteOffset;
+}
+
+STAR_CLASS_IMPLEMENTATION(Star::Graphics::Render::PipelineStateDesc, object_serializable);
+STAR_CLASS_TRACKING(Star::Graphics::Render::PipelineStateDesc, track_never);
+template<class Archive>
+void serialize(Archive& ar, Star::Graphics::Render::PipelineStateDesc& v, const uint32_t version) {
+    ar & v.mInputElements;
+    ar & v.mStripCutValue;
+    ar & v.mPrimitiveTopologyType;
+    ar & v.mRTVFormats;
+    ar & v.mDSVFormat;
+    ar & v.mSampleDesc;
+    ar & v.mHash;
+}
+
+template<class Archive>
+inline void load_construct_data(
+    Archive& ar, std::pair<const std::pmr::string, Star::Graphics::Render::PipelineStateDesc>* t, const unsigned int file_version
+) {
+    ::new(t) std::pair<const std::pmr::string, Star::Graphics::Render::PipelineStateDesc>(std::piecewise_construct, std::forward_as_tuple(ar.resource()), std::forward_as_tuple(ar.resource()));
+}
+
+template<class Archive, class K>
+inline void load_construct_data(
+    Archive& ar, std::pair<K, Star::Graphics::Render::PipelineStateDesc>* t, const unsigned int file_version
+) {
+    ::new(t) std::pair<K, Star::Graphics::Render::PipelineStateDesc>(std::piecewise_construct, std::forward_as_tuple(), std::forward_as_tuple(ar.resource()));
+}
+
 STAR_CLASS_IMPLEMENTATION(Star::Graphics::Render::ShaderSubpassData, object_serializable);
 STAR_CLASS_TRACKING(Star::Graphics::Render::ShaderSubpassData, track_never);
 template<class Archive>
@@ -257,6 +340,7 @@ void serialize(Archive& ar, Star::Graphics::Render::ShaderSubpassData& v, const
     ar & v.mProgram;
     ar & v.mInputLayout;
     ar & v.mVertexLayouts;
+    ar & v.mPipelineStates;
     ar & v.mConstantBuffers;
     ar & v.mDescriptors;
 }
@@ -483,6 +567,7 @@ void serialize(Archive& ar, Star::Graphics::Render::BasicTransform& v, const uin
 
 STAR_CLASS_IMPLEMENTATION(Star::Graphics::Render::WorldTransform, object_serializable);
 STAR_CLASS_TRACKING(Star::Graphics::Render::WorldTransform, track_never);
+STAR_CLASS_BITWISE(Star::Graphics::Render::WorldTransform);
 template<class Archive>
 void serialize(Archive& ar, Star::Graphics::Render::WorldTransform& v, const uint32_t version) {
     ar & v.mTransform;
@@ -490,19 +575,44 @@ void serialize(Archive& ar, Star::Graphics::Render::WorldTransform& v, const uin
 
 STAR_CLASS_IMPLEMENTATION(Star::Graphics::Render::WorldTransformInv, object_serializable);
 STAR_CLASS_TRACKING(Star::Graphics::Render::WorldTransformInv, track_never);
+STAR_CLASS_BITWISE(Star::Graphics::Render::WorldTransformInv);
 template<class Archive>
 void serialize(Archive& ar, Star::Graphics::Render::WorldTransformInv& v, const uint32_t version) {
     ar & v.mTransform;
 }
 
+STAR_CLASS_IMPLEMENTATION(Star::Aabb3f, object_serializable);
+STAR_CLASS_TRACKING(Star::Aabb3f, track_never);
+template<class Archive>
+void serialize(Archive& ar, Star::Aabb3f& v, const uint32_t version) {
+    ar & v.mMin;
+    ar & v.mMax;
+}
+
 STAR_CLASS_IMPLEMENTATION(Star::Graphics::Render::BoundingBox, object_serializable);
 STAR_CLASS_TRACKING(Star::Graphics::Render::BoundingBox, track_never);
+STAR_CLASS_BITWISE(Star::Graphics::Render::BoundingBox);
 template<class Archive>
 void serialize(Archive& ar, Star::Graphics::Render::BoundingBox& v, const uint32_t version) {
     ar & v.mLocalBounds;
     ar & v.mWorldBounds;
 }
 
+STAR_CLASS_IMPLEMENTATION(Star::Graphics::Render::BvhNode4, object_serializable);
+STAR_CLASS_TRACKING(Star::Graphics::Render::BvhNode4, track_never);
+STAR_CLASS_BITWISE(Star::Graphics::Render::BvhNode4);
+template<class Archive>
+void serialize(Archive& ar, Star::Graphics::Render::BvhNode4& v, const uint32_t version) {
+    ar & v.mMinX;
+    ar & v.mMinY;
+    ar & v.mMinZ;
+    ar & v.mMaxX;
+    ar & v.mMaxY;
+    ar & v.mMaxZ;
+    ar & v.mChild;
+    ar & v.mCount;
+}
+
 STAR_CLASS_IMPLEMENTATION(Star::Graphics::Render::CameraData, object_serializable);
 STAR_CLASS_TRACKING(Star::Graphics::Render::CameraData, track_never);
 template<class Archive>
@@ -555,6 +665,8 @@ void serialize(Archive& ar, Star::Graphics::Render::FlattenedObjects& v, const u
     ar & v.mWorldTransformInvs;
     ar & v.mBoundingBoxes;
     ar & v.mMeshRenderers;
+    ar & v.mBvhNodes;
+    ar & v.mBvhObjects;
 }
 
 template<class Archive>
@@ -16,6 +16,7 @@
 // along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
 
 #pragma once
+#include <immintrin.h>
 
 namespace Star {
 
@@ -86,4 +87,193 @@ public:
     std::pmr::vector<std::pair<VertexProperty, EdgeList<EdgeProperty>>> mVertices;
 };
 
+constexpr uint32_t sContentTreeNoParent = 0xFFFFFFFF;
+
+// ContentTree flattened for per frame updates: nodes in breadth first order,
+// each level is contiguous and parents always precede their children
+struct CompiledContentTree {
+    using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+
+    allocator_type get_allocator() const noexcept {
+        return mVertexIDs.get_allocator().resource();
+    }
+
+    CompiledContentTree(const allocator_type& alloc) noexcept
+        : mVertexIDs(alloc)
+        , mParents(alloc)
+        , mLevelOffsets(alloc)
+        , mLocalTransformsSoA(alloc)
+        , mWorldTransformsSoA(alloc)
+    {}
+
+    CompiledContentTree(CompiledContentTree&& rhs, const allocator_type& alloc)
+        : mVertexIDs(std::move(rhs.mVertexIDs), alloc)
+        , mParents(std::move(rhs.mParents), alloc)
+        , mLevelOffsets(std::move(rhs.mLevelOffsets), alloc)
+        , mLocalTransformsSoA(std::move(rhs.mLocalTransformsSoA), alloc)
+        , mWorldTransformsSoA(std::move(rhs.mWorldTransformsSoA), alloc)
+        , mStride(rhs.mStride)
+    {}
+
+    CompiledContentTree& operator=(CompiledContentTree&& rhs) = default;
+
+    uint32_t size() const noexcept {
+        return gsl::narrow_cast<uint32_t>(mParents.size());
+    }
+
+    // tree vertex of each node
+    std::pmr::vector<uint32_t> mVertexIDs;
+    // node index of the parent, sContentTreeNoParent for roots
+    std::pmr::vector<uint32_t> mParents;
+    // level l holds nodes [mLevelOffsets[l], mLevelOffsets[l + 1])
+    std::pmr::vector<uint32_t> mLevelOffsets;
+    // 3x4 column major transforms: 12 blocks of mStride floats
+    std::pmr::vector<float> mLocalTransformsSoA;
+    std::pmr::vector<float> mWorldTransformsSoA;
+    uint32_t mStride = 0;
+};
+
+// nodes are visited from the roots, local transforms start as identity
+template<class VertexProperty, class EdgeProperty>
+void compileContentTree(const ContentTree<VertexProperty, EdgeProperty>& g, CompiledContentTree& tree) {
+    const auto count = gsl::narrow<uint32_t>(g.mVertices.size());
+    tree.mVertexIDs.clear();
+    tree.mParents.clear();
+    tree.mLevelOffsets.clear();
+    tree.mVertexIDs.reserve(count);
+    tree.mParents.reserve(count);
+
+    std::pmr::vector<uint32_t> nodeIDs(count, sContentTreeNoParent, tree.get_allocator());
+    for (uint32_t v = 0; v != count; ++v) {
+        if (g.mVertices[v].second.mInEdges.empty()) {
+            nodeIDs[v] = gsl::narrow_cast<uint32_t>(tree.mVertexIDs.size());
+            tree.mVertexIDs.emplace_back(v);
+            tree.mParents.emplace_back(sContentTreeNoParent);
+        }
+    }
+
+    uint32_t levelBegin = 0;
+    while (levelBegin != tree.mVertexIDs.size()) {
+        const auto levelEnd = gsl::narrow_cast<uint32_t>(tree.mVertexIDs.size());
+        tree.mLevelOffsets.emplace_back(levelBegin);
+        for (uint32_t nodeID = levelBegin; nodeID != levelEnd; ++nodeID) {
+            for (const auto& e : g.mVertices[tree.mVertexIDs[nodeID]].second.mOutEdges) {
+                const auto v = gsl::narrow_cast<uint32_t>(e.second);
+                if (nodeIDs[v] != sContentTreeNoParent)
+                    throw std::invalid_argument("content tree vertex has more than one parent");
+                nodeIDs[v] = gsl::narrow_cast<uint32_t>(tree.mVertexIDs.size());
+                tree.mVertexIDs.emplace_back(v);
+                tree.mParents.emplace_back(nodeID);
+            }
+        }
+        levelBegin = levelEnd;
+    }
+    tree.mLevelOffsets.emplace_back(levelBegin);
+    if (tree.mVertexIDs.size() != count)
+        throw std::invalid_argument("content tree has cycles");
+
+    // padded to the simd width
+    tree.mStride = (count + 7) & ~7u;
+    tree.mLocalTransformsSoA.assign(12 * size_t(tree.mStride), 0.0f);
+    tree.mWorldTransformsSoA.assign(12 * size_t(tree.mStride), 0.0f);
+    for (uint32_t i = 0; i != count; ++i) {
+        for (uint32_t c = 0; c != 3; ++c) {
+            tree.mLocalTransformsSoA[size_t(c * 3 + c) * tree.mStride + i] = 1.0f;
+        }
+    }
+}
+
+inline void setLocalTransform(CompiledContentTree& tree, uint32_t nodeID, const Eigen::Affine3f& local) noexcept {
+    Expects(nodeID < tree.size());
+    for (uint32_t c = 0; c != 4; ++c) {
+        for (uint32_t r = 0; r != 3; ++r) {
+            tree.mLocalTransformsSoA[size_t(c * 3 + r) * tree.mStride + nodeID] = local.matrix()(r, c);
+        }
+    }
+}
+
+inline Eigen::Affine3f getWorldTransform(const CompiledContentTree& tree, uint32_t nodeID) noexcept {
+    Expects(nodeID < tree.size());
+    Eigen::Affine3f world = Eigen::Affine3f::Identity();
+    for (uint32_t c = 0; c != 4; ++c) {
+        for (uint32_t r = 0; r != 3; ++r) {
+            world.matrix()(r, c) = tree.mWorldTransformsSoA[size_t(c * 3 + r) * tree.mStride + nodeID];
+        }
+    }
+    return world;
+}
+
+// world = parent world * local for nodes [begin, end) of one level below the roots
+inline void updateWorldTransforms(CompiledContentTree& tree, uint32_t begin, uint32_t end) noexcept {
+    const auto stride = size_t(tree.mStride);
+    const float* pLocal = tree.mLocalTransformsSoA.data();
+    float* pWorld = tree.mWorldTransformsSoA.data();
+    const uint32_t* pParents = tree.mParents.data();
+
+    uint32_t i = begin;
+#ifdef __AVX2__
+    for (; i + 8 <= end; i += 8) {
+        const __m256i parents = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pParents + i));
+        __m256 p[12];
+        __m256 l[12];
+        for (uint32_t k = 0; k != 12; ++k) {
+            p[k] = _mm256_i32gather_ps(pWorld + k * stride, parents, 4);
+            l[k] = _mm256_loadu_ps(pLocal + k * stride + i);
+        }
+        for (uint32_t c = 0; c != 4; ++c) {
+            for (uint32_t r = 0; r != 3; ++r) {
+                __m256 v = c == 3 ? p[9 + r] : _mm256_setzero_ps();
+                for (uint32_t k = 0; k != 3; ++k) {
+                    v = _mm256_fmadd_ps(p[k * 3 + r], l[c * 3 + k], v);
+                }
+                _mm256_storeu_ps(pWorld + (c * 3 + r) * stride + i, v);
+            }
+        }
+    }
+#endif
+    for (; i != end; ++i) {
+        const auto parent = pParents[i];
+        for (uint32_t c = 0; c != 4; ++c) {
+            for (uint32_t r = 0; r != 3; ++r) {
+                float v = c == 3 ? pWorld[(9 + r) * stride + parent] : 0.0f;
+                for (uint32_t k = 0; k != 3; ++k) {
+                    v += pWorld[(k * 3 + r) * stride + parent] * pLocal[(c * 3 + k) * stride + i];
+                }
+                pWorld[(c * 3 + r) * stride + i] = v;
+            }
+        }
+    }
+}
+
+// levels run in order, nodes of a level are split into chunks updated in parallel
+inline void updateWorldTransforms(CompiledContentTree& tree) {
+    constexpr uint32_t chunkSize = 1024;
+    if (tree.mLevelOffsets.size() < 2)
+        return;
+
+    const auto stride = size_t(tree.mStride);
+    const auto rootCount = tree.mLevelOffsets[1];
+    for (uint32_t k = 0; k != 12; ++k) {
+        std::copy_n(tree.mLocalTransformsSoA.data() + k * stride, rootCount,
+            tree.mWorldTransformsSoA.data() + k * stride);
+    }
+
+    std::pmr::vector<uint32_t> chunkBegins(tree.get_allocator());
+    for (size_t level = 1; level + 1 < tree.mLevelOffsets.size(); ++level) {
+        const auto begin = tree.mLevelOffsets[level];
+        const auto end = tree.mLevelOffsets[level + 1];
+        if (end - begin <= chunkSize) {
+            updateWorldTransforms(tree, begin, end);
+            continue;
+        }
+        chunkBegins.clear();
+        for (uint32_t i = begin; i < end; i += chunkSize) {
+            chunkBegins.emplace_back(i);
+        }
+        std::for_each(std::execution::par, chunkBegins.begin(), chunkBegins.end(), [&](uint32_t chunkBegin) {
+            updateWorldTransforms(tree, chunkBegin, std::min(chunkBegin + chunkSize, end));
+        });
+    }
+}
+
 }
@@ -124,6 +124,11 @@ MeshData::MeshData(const allocator_type& alloc)
     , mIndexBuffer(alloc)
     , mSubMeshes(alloc)
     , mLayoutName(alloc)
+    , mMeshlets(alloc)
+    , mMeshletVertices(alloc)
+    , mMeshletTriangles(alloc)
+    , mLods(alloc)
+    , mLodSubMeshes(alloc)
 {}
 
 MeshData::MeshData(MeshData const& rhs, const allocator_type& alloc)
@@ -132,6 +137,11 @@ MeshData::MeshData(MeshData const& rhs, const allocator_type& alloc)
     , mSubMeshes(rhs.mSubMeshes, alloc)
     , mLayoutID(rhs.mLayoutID)
     , mLayoutName(rhs.mLayoutName, alloc)
+    , mMeshlets(rhs.mMeshlets, alloc)
+    , mMeshletVertices(rhs.mMeshletVertices, alloc)
+    , mMeshletTriangles(rhs.mMeshletTriangles, alloc)
+    , mLods(rhs.mLods, alloc)
+    , mLodSubMeshes(rhs.mLodSubMeshes, alloc)
 {}
 
 MeshData::MeshData(MeshData&& rhs, const allocator_type& alloc)
@@ -140,6 +150,11 @@ MeshData::MeshData(MeshData&& rhs, const allocator_type& alloc)
     , mSubMeshes(std::move(rhs.mSubMeshes), alloc)
     , mLayoutID(std::move(rhs.mLayoutID))
     , mLayoutName(std::move(rhs.mLayoutName), alloc)
+    , mMeshlets(std::move(rhs.mMeshlets), alloc)
+    , mMeshletVertices(std::move(rhs.mMeshletVertices), alloc)
+    , mMeshletTriangles(std::move(rhs.mMeshletTriangles), alloc)
+    , mLods(std::move(rhs.mLods), alloc)
+    , mLodSubMeshes(std::move(rhs.mLodSubMeshes), alloc)
 {}
 
 MeshData::~MeshData() = default;
@@ -184,6 +199,11 @@ ShaderProgramData::ShaderProgramData(ShaderProgramData const& rhs, const allocat
     , mDS(rhs.mDS, alloc)
     , mGS(rhs.mGS, alloc)
     , mPS(rhs.mPS, alloc)
+    , mVSBlob(rhs.mVSBlob)
+    , mHSBlob(rhs.mHSBlob)
+    , mDSBlob(rhs.mDSBlob)
+    , mGSBlob(rhs.mGSBlob)
+    , mPSBlob(rhs.mPSBlob)
 {}
 
 ShaderProgramData::ShaderProgramData(ShaderProgramData&& rhs, const allocator_type& alloc)
@@ -192,6 +212,11 @@ ShaderProgramData::ShaderProgramData(ShaderProgramData&& rhs, const allocator_ty
     , mDS(std::move(rhs.mDS), alloc)
     , mGS(std::move(rhs.mGS), alloc)
     , mPS(std::move(rhs.mPS), alloc)
+    , mVSBlob(rhs.mVSBlob)
+    , mHSBlob(rhs.mHSBlob)
+    , mDSBlob(rhs.mDSBlob)
+    , mGSBlob(rhs.mGSBlob)
+    , mPSBlob(rhs.mPSBlob)
 {}
 
 ShaderProgramData::~ShaderProgramData() = default;
@@ -218,6 +243,37 @@ ShaderInputLayout::ShaderInputLayout(ShaderInputLayout&& rhs, const allocator_ty
 
 ShaderInputLayout::~ShaderInputLayout() = default;
 
+PipelineStateDesc::allocator_type PipelineStateDesc::get_allocator() const noexcept {
+    return allocator_type(mInputElements.get_allocator().resource());
+}
+
+PipelineStateDesc::PipelineStateDesc(const allocator_type& alloc)
+    : mInputElements(alloc)
+    , mRTVFormats(alloc)
+{}
+
+PipelineStateDesc::PipelineStateDesc(PipelineStateDesc const& rhs, const allocator_type& alloc)
+    : mInputElements(rhs.mInputElements, alloc)
+    , mStripCutValue(rhs.mStripCutValue)
+    , mPrimitiveTopologyType(rhs.mPrimitiveTopologyType)
+    , mRTVFormats(rhs.mRTVFormats, alloc)
+    , mDSVFormat(rhs.mDSVFormat)
+    , mSampleDesc(rhs.mSampleDesc)
+    , mHash(rhs.mHash)
+{}
+
+PipelineStateDesc::PipelineStateDesc(PipelineStateDesc&& rhs, const allocator_type& alloc)
+    : mInputElements(std::move(rhs.mInputElements), alloc)
+    , mStripCutValue(std::move(rhs.mStripCutValue))
+    , mPrimitiveTopologyType(std::move(rhs.mPrimitiveTopologyType))
+    , mRTVFormats(std::move(rhs.mRTVFormats), alloc)
+    , mDSVFormat(std::move(rhs.mDSVFormat))
+    , mSampleDesc(std::move(rhs.mSampleDesc))
+    , mHash(std::move(rhs.mHash))
+{}
+
+PipelineStateDesc::~PipelineStateDesc() = default;
+
 ShaderSubpassData::allocator_type ShaderSubpassData::get_allocator() const noexcept {
     return allocator_type(mProgram.get_allocator().resource());
 }
@@ -226,6 +282,7 @@ ShaderSubpassData::ShaderSubpassData(const allocator_type& alloc)
     : mProgram(alloc)
     , mInputLayout(alloc)
     , mVertexLayouts(alloc)
+    , mPipelineStates(alloc)
     , mConstantBuffers(alloc)
     , mDescriptors(alloc)
 {}
@@ -235,6 +292,7 @@ ShaderSubpassData::ShaderSubpassData(ShaderSubpassData const& rhs, const allocat
     , mProgram(rhs.mProgram, alloc)
     , mInputLayout(rhs.mInputLayout, alloc)
     , mVertexLayouts(rhs.mVertexLayouts, alloc)
+    , mPipelineStates(rhs.mPipelineStates, alloc)
     , mConstantBuffers(rhs.mConstantBuffers, alloc)
     , mDescriptors(rhs.mDescriptors, alloc)
 {}
@@ -244,6 +302,7 @@ ShaderSubpassData::ShaderSubpassData(ShaderSubpassData&& rhs, const allocator_ty
     , mProgram(std::move(rhs.mProgram), alloc)
     , mInputLayout(std::move(rhs.mInputLayout), alloc)
     , mVertexLayouts(std::move(rhs.mVertexLayouts), alloc)
+    , mPipelineStates(std::move(rhs.mPipelineStates), alloc)
     , mConstantBuffers(std::move(rhs.mConstantBuffers), alloc)
     , mDescriptors(std::move(rhs.mDescriptors), alloc)
 {}
@@ -435,6 +494,8 @@ FlattenedObjects::FlattenedObjects(const allocator_type& alloc)
     , mWorldTransformInvs(alloc)
     , mBoundingBoxes(alloc)
     , mMeshRenderers(alloc)
+    , mBvhNodes(alloc)
+    , mBvhObjects(alloc)
 {}
 
 FlattenedObjects::FlattenedObjects(FlattenedObjects const& rhs, const allocator_type& alloc)
@@ -442,6 +503,8 @@ FlattenedObjects::FlattenedObjects(FlattenedObjects const& rhs, const allocator_
     , mWorldTransformInvs(rhs.mWorldTransformInvs, alloc)
     , mBoundingBoxes(rhs.mBoundingBoxes, alloc)
     , mMeshRenderers(rhs.mMeshRenderers, alloc)
+    , mBvhNodes(rhs.mBvhNodes, alloc)
+    , mBvhObjects(rhs.mBvhObjects, alloc)
 {}
 
 FlattenedObjects::FlattenedObjects(FlattenedObjects&& rhs, const allocator_type& alloc)
@@ -449,6 +512,8 @@ FlattenedObjects::FlattenedObjects(FlattenedObjects&& rhs, const allocator_type&
     , mWorldTransformInvs(std::move(rhs.mWorldTransformInvs), alloc)
     , mBoundingBoxes(std::move(rhs.mBoundingBoxes), alloc)
     , mMeshRenderers(std::move(rhs.mMeshRenderers), alloc)
+    , mBvhNodes(std::move(rhs.mBvhNodes), alloc)
+    , mBvhObjects(std::move(rhs.mBvhObjects), alloc)
 {}
 
 FlattenedObjects::~FlattenedObjects() = default;
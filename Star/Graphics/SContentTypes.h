@@ -20,6 +20,7 @@
 #include <Star/Graphics/SContentFwd.h>
 #include <Star/Graphics/SRenderTypes.h>
 #include <Star/Graphics/SRenderGraphTypes.h>
+#include <Star/SAabb.h>
 
 #ifdef _MSC_VER
 #pragma warning(push)
@@ -143,6 +144,27 @@ struct STAR_GRAPHICS_API IndexBufferData {
 struct SubMeshData {
     uint32_t mIndexOffset;
     uint32_t mIndexCount;
+    uint32_t mMeshletOffset = 0;
+    uint32_t mMeshletCount = 0;
+};
+
+// triangle offset and count are in units of 3 local indices
+struct MeshletData {
+    uint32_t mVertexOffset = 0;
+    uint32_t mVertexCount = 0;
+    uint32_t mTriangleOffset = 0;
+    uint32_t mTriangleCount = 0;
+    Vector3f mCenter = Vector3f::Zero();
+    float mRadius = 0;
+    Vector3f mConeAxis = Vector3f::Zero();
+    float mConeCutoff = 1;
+};
+
+// simplified level of a mesh, submesh i of the level is mLodSubMeshes[mSubMeshOffset + i]
+struct MeshLodData {
+    uint32_t mSubMeshOffset = 0;
+    // object space distance error of the level, relative to level 0
+    float mError = 0;
 };
 
 struct STAR_GRAPHICS_API MeshData {
@@ -159,6 +181,12 @@ struct STAR_GRAPHICS_API MeshData {
     std::pmr::vector<SubMeshData> mSubMeshes;
     uint32_t mLayoutID = 0;
     std::pmr::string mLayoutName;
+    std::pmr::vector<MeshletData> mMeshlets;
+    std::pmr::vector<uint32_t> mMeshletVertices;
+    std::pmr::vector<uint8_t> mMeshletTriangles;
+    // levels after level 0, indices are appended to the index buffer
+    std::pmr::vector<MeshLodData> mLods;
+    std::pmr::vector<SubMeshData> mLodSubMeshes;
 };
 
 struct STAR_GRAPHICS_API TextureData {
@@ -183,6 +211,12 @@ struct PipelineStateData {
     DEPTH_STENCIL_DESC mDepthStencilState;
 };
 
+// bytecode of a stage in the shader blob file of the library
+struct ShaderBlobRange {
+    uint64_t mOffset = 0;
+    uint64_t mSize = 0;
+};
+
 struct STAR_GRAPHICS_API ShaderProgramData {
     using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
     allocator_type get_allocator() const noexcept;
@@ -197,6 +231,12 @@ struct STAR_GRAPHICS_API ShaderProgramData {
     std::pmr::string mDS;
     std::pmr::string mGS;
     std::pmr::string mPS;
+    // used by stages whose bytecode is empty, the library stores the bytecode in the blob file
+    ShaderBlobRange mVSBlob;
+    ShaderBlobRange mHSBlob;
+    ShaderBlobRange mDSBlob;
+    ShaderBlobRange mGSBlob;
+    ShaderBlobRange mPSBlob;
 };
 
 struct STAR_GRAPHICS_API ShaderInputLayout {
@@ -213,6 +253,35 @@ struct STAR_GRAPHICS_API ShaderInputLayout {
     PRIMITIVE_TOPOLOGY_TYPE mPrimitiveTopologyType = PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
 };
 
+// input element of a vertex layout, semantic name is taken from mType
+struct PipelineInputElement {
+    VertexElementType mType;
+    uint32_t mSemanticIndex = 0;
+    Format mFormat = Format::UNKNOWN;
+    uint32_t mInputSlot = 0;
+    uint32_t mAlignedByteOffset = 0;
+};
+
+// pipeline state of a shader subpass and one of its vertex layouts, resolved against its render subpass
+// mHash covers bytecode, render state, input layout and render targets, root signature is not included
+struct STAR_GRAPHICS_API PipelineStateDesc {
+    using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+    allocator_type get_allocator() const noexcept;
+
+    PipelineStateDesc(const allocator_type& alloc);
+    PipelineStateDesc(PipelineStateDesc&& rhs, const allocator_type& alloc);
+    PipelineStateDesc(PipelineStateDesc const& rhs, const allocator_type& alloc);
+    ~PipelineStateDesc();
+
+    std::pmr::vector<PipelineInputElement> mInputElements;
+    INDEX_BUFFER_STRIP_CUT_VALUE mStripCutValue = INDEX_BUFFER_STRIP_CUT_VALUE_DISABLED;
+    PRIMITIVE_TOPOLOGY_TYPE mPrimitiveTopologyType = PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+    std::pmr::vector<Format> mRTVFormats;
+    Format mDSVFormat = Format::UNKNOWN;
+    DISP_SAMPLE_DESC mSampleDesc = { 1, 0 };
+    uint64_t mHash = 0;
+};
+
 struct STAR_GRAPHICS_API ShaderSubpassData {
     using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
     allocator_type get_allocator() const noexcept;
@@ -226,6 +295,8 @@ struct STAR_GRAPHICS_API ShaderSubpassData {
     ShaderProgramData mProgram;
     ShaderInputLayout mInputLayout;
     std::pmr::vector<uint32_t> mVertexLayouts;
+    // one per vertex layout, built with the render graph by the asset factory
+    std::pmr::vector<PipelineStateDesc> mPipelineStates;
     std::pmr::vector<ShaderConstantBuffer> mConstantBuffers;
     std::pmr::vector<ShaderDescriptorCollection> mDescriptors;
 };
@@ -362,8 +433,24 @@ struct WorldTransformInv {
 };
 
 struct BoundingBox {
-    Box3f mLocalBounds;
-    Box3f mWorldBounds;
+    Aabb3f mLocalBounds;
+    Aabb3f mWorldBounds;
+};
+
+constexpr uint32_t sBvhInvalidChild = 0xFFFFFFFF;
+
+// 4-wide bvh node, lane k holds the world bounds of child k so a node is tested in one pass.
+// a child with mCount 0 is the inner node mChild, otherwise mBvhObjects[mChild, mChild + mCount).
+// unused lanes have inverted bounds and mChild sBvhInvalidChild
+struct BvhNode4 {
+    float mMinX[4];
+    float mMinY[4];
+    float mMinZ[4];
+    float mMaxX[4];
+    float mMaxY[4];
+    float mMaxZ[4];
+    uint32_t mChild[4];
+    uint32_t mCount[4];
 };
 
 using CameraView = std::variant<std::monostate, Direct3D_, Vulkan_, OpenGL_>;
@@ -388,6 +475,14 @@ struct CameraData {
     float mFov = 0.785398163f;
 };
 
+// world space, no contribution beyond range
+struct PointLightData {
+    Vector3f mPosition = Vector3f::Zero();
+    float mRange = 1.0f;
+    Vector3f mColor = Vector3f::Ones();
+    float mIntensity = 1.0f;
+};
+
 struct STAR_GRAPHICS_API MeshRenderer {
     using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
     allocator_type get_allocator() const noexcept;
@@ -414,6 +509,9 @@ struct STAR_GRAPHICS_API FlattenedObjects {
     std::pmr::vector<WorldTransformInv> mWorldTransformInvs;
     std::pmr::vector<BoundingBox> mBoundingBoxes;
     std::pmr::vector<MeshRenderer> mMeshRenderers;
+    // SAH hierarchy over the world bounds of objects with valid bounds, node 0 is the root
+    std::pmr::vector<BvhNode4> mBvhNodes;
+    std::pmr::vector<uint32_t> mBvhObjects;
 };
 
 struct STAR_GRAPHICS_API ContentSettings {
@@ -480,12 +578,12 @@ struct STAR_GRAPHICS_API Resources {
     ~Resources();
 
     ContentSettings mSettings;
-    std::pmr::unordered_map<MetaID, MeshData> mMeshes;
-    std::pmr::unordered_map<MetaID, TextureData> mTextures;
-    std::pmr::unordered_map<MetaID, ShaderData> mShaders;
-    std::pmr::unordered_map<MetaID, MaterialData> mMaterials;
-    std::pmr::unordered_map<MetaID, ContentData> mContents;
-    std::pmr::unordered_map<MetaID, RenderGraphData> mRenderGraphs;
+    PmrMetaIDUnorderedMap<MeshData> mMeshes;
+    PmrMetaIDUnorderedMap<TextureData> mTextures;
+    PmrMetaIDUnorderedMap<ShaderData> mShaders;
+    PmrMetaIDUnorderedMap<MaterialData> mMaterials;
+    PmrMetaIDUnorderedMap<ContentData> mContents;
+    PmrMetaIDUnorderedMap<RenderGraphData> mRenderGraphs;
 };
 
 } // namespace Render
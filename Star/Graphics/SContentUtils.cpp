@@ -33,4 +33,206 @@ void reserve(FlattenedObjects& batch, size_t sz) {
     batch.mMeshRenderers.reserve(sz);
 }
 
+namespace {
+
+constexpr uint32_t sBvhBinCount = 12;
+constexpr uint32_t sBvhMaxLeafSize = 4;
+
+struct BvhBounds {
+    void grow(const Vector3f& lower, const Vector3f& upper) noexcept {
+        mLower = mLower.cwiseMin(lower);
+        mUpper = mUpper.cwiseMax(upper);
+    }
+    void grow(const BvhBounds& rhs) noexcept {
+        grow(rhs.mLower, rhs.mUpper);
+    }
+    float halfArea() const noexcept {
+        const Vector3f d = (mUpper - mLower).cwiseMax(0.0f);
+        return d.x() * d.y() + d.y() * d.z() + d.z() * d.x();
+    }
+
+    Vector3f mLower = Vector3f::Constant(std::numeric_limits<float>::max());
+    Vector3f mUpper = Vector3f::Constant(std::numeric_limits<float>::lowest());
+};
+
+struct BvhBinaryNode {
+    BvhBounds mBounds;
+    // leaf range of the object order if mCount, otherwise the two children
+    uint32_t mBegin = 0;
+    uint32_t mCount = 0;
+    uint32_t mChildren[2] = {};
+};
+
+struct BvhBuilder {
+    uint32_t build(uint32_t begin, uint32_t end) {
+        const auto nodeID = gsl::narrow_cast<uint32_t>(mNodes.size());
+        mNodes.emplace_back();
+
+        BvhBounds bounds, centroids;
+        for (uint32_t i = begin; i != end; ++i) {
+            const auto& b = mBounds[mObjects[i]];
+            bounds.grow(b);
+            centroids.grow(mCenters[mObjects[i]], mCenters[mObjects[i]]);
+        }
+        mNodes[nodeID].mBounds = bounds;
+
+        const auto count = end - begin;
+        const Vector3f extent = centroids.mUpper - centroids.mLower;
+        int axis = 0;
+        extent.maxCoeff(&axis);
+        if (count == 1 || (extent[axis] <= 0 && count <= sBvhMaxLeafSize)) {
+            mNodes[nodeID].mBegin = begin;
+            mNodes[nodeID].mCount = count;
+            return nodeID;
+        }
+
+        // binned SAH along the widest centroid axis
+        uint32_t mid = begin;
+        if (extent[axis] > 0) {
+            std::array<BvhBounds, sBvhBinCount> bins;
+            std::array<uint32_t, sBvhBinCount> counts{};
+            const float scale = sBvhBinCount / extent[axis];
+            auto getBin = [&](uint32_t objectID) {
+                const auto bin = static_cast<uint32_t>((mCenters[objectID][axis] - centroids.mLower[axis]) * scale);
+                return std::min(bin, sBvhBinCount - 1);
+            };
+            for (uint32_t i = begin; i != end; ++i) {
+                const auto bin = getBin(mObjects[i]);
+                bins[bin].grow(mBounds[mObjects[i]]);
+                ++counts[bin];
+            }
+
+            std::array<float, sBvhBinCount - 1> costs{};
+            BvhBounds left;
+            uint32_t leftCount = 0;
+            for (uint32_t i = 0; i != sBvhBinCount - 1; ++i) {
+                left.grow(bins[i]);
+                leftCount += counts[i];
+                costs[i] = left.halfArea() * leftCount;
+            }
+            BvhBounds right;
+            uint32_t rightCount = 0;
+            for (uint32_t i = sBvhBinCount - 1; i != 0; --i) {
+                right.grow(bins[i]);
+                rightCount += counts[i];
+                costs[i - 1] += right.halfArea() * rightCount;
+            }
+
+            const auto best = static_cast<uint32_t>(std::min_element(costs.begin(), costs.end()) - costs.begin());
+            if (count <= sBvhMaxLeafSize && costs[best] >= bounds.halfArea() * count) {
+                mNodes[nodeID].mBegin = begin;
+                mNodes[nodeID].mCount = count;
+                return nodeID;
+            }
+            mid = gsl::narrow_cast<uint32_t>(std::partition(mObjects.begin() + begin, mObjects.begin() + end,
+                [&](uint32_t objectID) { return getBin(objectID) <= best; }) - mObjects.begin());
+        }
+
+        // coincident centroids, split by count
+        if (mid == begin || mid == end) {
+            mid = begin + count / 2;
+            std::nth_element(mObjects.begin() + begin, mObjects.begin() + mid, mObjects.begin() + end,
+                [&](uint32_t lhs, uint32_t rhs) { return mCenters[lhs][axis] < mCenters[rhs][axis]; });
+        }
+
+        const auto leftID = build(begin, mid);
+        const auto rightID = build(mid, end);
+        mNodes[nodeID].mChildren[0] = leftID;
+        mNodes[nodeID].mChildren[1] = rightID;
+        return nodeID;
+    }
+
+    // pull grandchildren up until each node has 4 children
+    uint32_t collapse(uint32_t binaryID, std::pmr::vector<BvhNode4>& nodes) const {
+        const auto nodeID = gsl::narrow_cast<uint32_t>(nodes.size());
+        nodes.emplace_back();
+
+        boost::container::static_vector<uint32_t, 4> children;
+        if (mNodes[binaryID].mCount) {
+            children.emplace_back(binaryID);
+        } else {
+            children.emplace_back(mNodes[binaryID].mChildren[0]);
+            children.emplace_back(mNodes[binaryID].mChildren[1]);
+        }
+        while (children.size() != children.capacity()) {
+            int expand = -1;
+            float area = -1;
+            for (int k = 0; k != static_cast<int>(children.size()); ++k) {
+                const auto& child = mNodes[children[k]];
+                if (!child.mCount && child.mBounds.halfArea() > area) {
+                    area = child.mBounds.halfArea();
+                    expand = k;
+                }
+            }
+            if (expand < 0)
+                break;
+            const auto& child = mNodes[children[expand]];
+            children[expand] = child.mChildren[0];
+            children.emplace_back(child.mChildren[1]);
+        }
+
+        uint32_t childIDs[4] = { sBvhInvalidChild, sBvhInvalidChild, sBvhInvalidChild, sBvhInvalidChild };
+        uint32_t counts[4] = {};
+        for (size_t k = 0; k != children.size(); ++k) {
+            const auto& child = mNodes[children[k]];
+            if (child.mCount) {
+                childIDs[k] = child.mBegin;
+                counts[k] = child.mCount;
+            } else {
+                childIDs[k] = collapse(children[k], nodes);
+            }
+        }
+
+        auto& node = nodes[nodeID];
+        for (size_t k = 0; k != 4; ++k) {
+            BvhBounds bounds;
+            if (k < children.size()) {
+                bounds = mNodes[children[k]].mBounds;
+            }
+            node.mMinX[k] = bounds.mLower.x();
+            node.mMinY[k] = bounds.mLower.y();
+            node.mMinZ[k] = bounds.mLower.z();
+            node.mMaxX[k] = bounds.mUpper.x();
+            node.mMaxY[k] = bounds.mUpper.y();
+            node.mMaxZ[k] = bounds.mUpper.z();
+            node.mChild[k] = childIDs[k];
+            node.mCount[k] = counts[k];
+        }
+        return nodeID;
+    }
+
+    std::vector<BvhBounds> mBounds;
+    std::vector<Vector3f> mCenters;
+    std::vector<uint32_t> mObjects;
+    std::vector<BvhBinaryNode> mNodes;
+};
+
+}
+
+void buildBvh(FlattenedObjects& batch) {
+    batch.mBvhNodes.clear();
+    batch.mBvhObjects.clear();
+
+    BvhBuilder builder;
+    const auto count = gsl::narrow<uint32_t>(batch.mBoundingBoxes.size());
+    builder.mBounds.resize(count);
+    builder.mCenters.resize(count);
+    builder.mObjects.reserve(count);
+    for (uint32_t i = 0; i != count; ++i) {
+        const auto& bounds = batch.mBoundingBoxes[i].mWorldBounds;
+        if (!bounds.valid())
+            continue;
+        builder.mBounds[i].grow(bounds.lower(), bounds.upper());
+        builder.mCenters[i] = bounds.center();
+        builder.mObjects.emplace_back(i);
+    }
+    if (builder.mObjects.empty())
+        return;
+
+    builder.mNodes.reserve(2 * builder.mObjects.size());
+    builder.build(0, gsl::narrow_cast<uint32_t>(builder.mObjects.size()));
+    builder.collapse(0, batch.mBvhNodes);
+    batch.mBvhObjects.assign(builder.mObjects.begin(), builder.mObjects.end());
+}
+
 }
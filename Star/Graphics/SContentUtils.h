@@ -24,6 +24,9 @@ namespace Star::Graphics::Render {
 STAR_GRAPHICS_API void resize(FlattenedObjects& batch, size_t sz);
 STAR_GRAPHICS_API void reserve(FlattenedObjects& batch, size_t sz);
 
+// build mBvhNodes and mBvhObjects from world bounds, objects with invalid bounds are left out
+STAR_GRAPHICS_API void buildBvh(FlattenedObjects& batch);
+
 template<class Visitor>
 void visitContent(const RenderSwapChain& sc, const Visitor& visitor) {
     for (const auto& solution : sc.mSolutions) {
@@ -35,10 +35,18 @@ DescriptorPool::DescriptorPool(
 DescriptorPool::~DescriptorPool() = default;
 
 DescriptorBlock DescriptorPool::allocateRange() const {
+    auto block = try_allocateRange();
+    if (block.begin() == block.end()) {
+        throw std::runtime_error("not enough descriptor block");
+    }
+    return block;
+}
+
+DescriptorBlock DescriptorPool::try_allocateRange() const {
     std::lock_guard<std::mutex> guard(mMutex);
 
     if (mFreeBlocks.empty()) {
-        throw std::runtime_error("not enough descriptor block");
+        return DescriptorBlock();
     }
 
     auto range = mFreeBlocks.front();
@@ -48,12 +56,56 @@ DescriptorBlock DescriptorPool::allocateRange() const {
     return DescriptorBlock(*this, range.mBegin, range.mEnd);
 }
 
+uint32_t DescriptorPool::getFreeBlockCount() const noexcept {
+    std::lock_guard<std::mutex> guard(mMutex);
+    return gsl::narrow_cast<uint32_t>(mFreeBlocks.size());
+}
+
+void DescriptorPool::grow(uint32_t capacity) {
+    std::lock_guard<std::mutex> guard(mMutex);
+
+    const auto blockCount = gsl::narrow_cast<uint32_t>(
+        boost::alignment::align_up(capacity, mBlockSize)) / mBlockSize;
+    for (auto i = mBlockCount; i < blockCount; ++i) {
+        auto begin = mBlockStart + i * mBlockSize;
+        mFreeBlocks.emplace_back(Range{ begin, begin + mBlockSize });
+    }
+    mBlockCount = std::max(mBlockCount, blockCount);
+}
+
 void DescriptorPool::destroyBuffer(const std::pair<uint32_t, uint32_t>& block) const noexcept {
     std::lock_guard<std::mutex> guard(mMutex);
     mFreeBlocks.emplace_back(Range{ block.first, block.second });
     --mAllocatedCount;
 }
 
+DescriptorPoolStatistics DescriptorPool::statistics() const {
+    std::pmr::vector<uint32_t> begins(mAllocator.resource());
+
+    std::lock_guard<std::mutex> guard(mMutex);
+    DescriptorPoolStatistics stats;
+    stats.mBlockCount = mBlockCount;
+    stats.mFreeBlockCount = gsl::narrow_cast<uint32_t>(mFreeBlocks.size());
+
+    begins.reserve(mFreeBlocks.size());
+    for (const auto& range : mFreeBlocks) {
+        begins.emplace_back(range.mBegin);
+    }
+    std::sort(begins.begin(), begins.end());
+
+    uint32_t count = 0;
+    for (size_t i = 0; i != begins.size(); ++i) {
+        if (i && begins[i] == begins[i - 1] + mBlockSize) {
+            ++count;
+        } else {
+            ++stats.mFreeRangeCount;
+            count = 1;
+        }
+        stats.mLargestFreeRange = std::max(stats.mLargestFreeRange, count);
+    }
+    return stats;
+}
+
 void DescriptorPool::reset(uint32_t offset, uint32_t descCount) {
     std::lock_guard<std::mutex> guard(mMutex);
 
@@ -173,7 +225,15 @@ PersistentDescriptorTable& PersistentDescriptorTable::operator=(PersistentDescri
 PersistentDescriptorTable::~PersistentDescriptorTable() = default;
 
 std::pair<uint32_t, uint32_t> PersistentDescriptorTable::allocate(const DescriptorPool* pPool) {
-    std::pair<uint32_t, uint32_t> range;
+    auto range = try_allocate(pPool);
+    if (range.first == range.second) {
+        throw std::runtime_error("not enough descriptor block");
+    }
+    return range;
+}
+
+std::pair<uint32_t, uint32_t> PersistentDescriptorTable::try_allocate(const DescriptorPool* pPool) {
+    std::pair<uint32_t, uint32_t> range{};
 
     for (auto& block : mBlocks) {
         range = block.try_allocate(mBlockVectorSize);
@@ -181,7 +241,11 @@ std::pair<uint32_t, uint32_t> PersistentDescriptorTable::allocate(const Descript
             return range;
     }
 
-    mBlocks.emplace_back(pPool->allocateRange(), mBlockBinSize);
+    auto block = pPool->try_allocateRange();
+    if (block.begin() == block.end()) {
+        return range;
+    }
+    mBlocks.emplace_back(std::move(block), mBlockBinSize);
     range = mBlocks.back().try_allocate(mBlockVectorSize);
     Ensures(range.first != range.second);
     return range;
@@ -233,6 +297,85 @@ void PersistentDescriptorTable::do_deallocate() noexcept {
     }
 }
 
+uint64_t PersistentDescriptorTable::live_mask(const PersistentDescriptorBlock& block) const noexcept {
+    uint64_t released = 0;
+    for (const auto& freeList : mDeallocationList) {
+        auto iter = freeList.find(block.begin());
+        if (iter != freeList.end())
+            released |= iter->second.mMask;
+    }
+    return set_least_n_bits(mBlockBinSize.mValue) & ~block.free_mask() & ~released;
+}
+
+PersistentDescriptorBinStatistics PersistentDescriptorTable::statistics() const noexcept {
+    PersistentDescriptorBinStatistics stats;
+    stats.mVectorSize = mBlockVectorSize.mValue;
+    stats.mBlockCount = gsl::narrow_cast<uint32_t>(mBlocks.size());
+    stats.mSlotCount = stats.mBlockCount * mBlockBinSize.mValue;
+    for (const auto& block : mBlocks) {
+        stats.mUsedCount += mBlockBinSize.mValue - count_bits(block.free_mask());
+    }
+    return stats;
+}
+
+uint32_t PersistentDescriptorTable::compact(uint32_t maxMoves,
+    std::pmr::vector<PersistentDescriptorRelocation>& relocations
+) {
+    if (mBlocks.size() < 2 || maxMoves == 0)
+        return 0;
+
+    // find the sparsest block still in use
+    size_t sourceID = mBlocks.size();
+    uint32_t sourceCount = mBlockBinSize.mValue;
+    for (size_t i = 0; i != mBlocks.size(); ++i) {
+        auto count = count_bits(live_mask(mBlocks[i]));
+        if (count && count < sourceCount) {
+            sourceID = i;
+            sourceCount = count;
+        }
+    }
+    if (sourceID == mBlocks.size())
+        return 0;
+
+    // moving is useless if the block cannot be emptied
+    uint32_t freeCount = 0;
+    for (size_t i = 0; i != mBlocks.size(); ++i) {
+        if (i != sourceID)
+            freeCount += count_bits(mBlocks[i].free_mask());
+    }
+    if (freeCount < sourceCount)
+        return 0;
+
+    const auto sourceBegin = mBlocks[sourceID].begin();
+    auto live = live_mask(mBlocks[sourceID]);
+    uint32_t moves = 0;
+    while (live && moves != maxMoves) {
+        // fill the densest block first, free slots stay together
+        size_t targetID = mBlocks.size();
+        uint32_t targetCount = mBlockBinSize.mValue + 1;
+        for (size_t i = 0; i != mBlocks.size(); ++i) {
+            auto count = count_bits(mBlocks[i].free_mask());
+            if (i != sourceID && count && count < targetCount) {
+                targetID = i;
+                targetCount = count;
+            }
+        }
+        Expects(targetID != mBlocks.size());
+
+        auto range = mBlocks[targetID].try_allocate(mBlockVectorSize);
+        Ensures(range.first != range.second);
+
+        auto index = find_lsb(live).first;
+        live &= ~(uint64_t(1) << index);
+
+        auto source = sourceBegin + index * mBlockVectorSize.mValue;
+        relocations.emplace_back(PersistentDescriptorRelocation{ source, range.first, mBlockVectorSize.mValue });
+        deallocate(source);
+        ++moves;
+    }
+    return moves;
+}
+
 PersistentDescriptorPool::PersistentDescriptorPool(uint32_t capacity,
     const DescriptorPool* pPool,
     uint32_t swapchainCount, uint32_t blockSize, uint32_t maxVectorSize,
@@ -270,6 +413,20 @@ std::pair<uint32_t, uint32_t> PersistentDescriptorPool::allocate(uint32_t count)
     return range;
 }
 
+std::pair<uint32_t, uint32_t> PersistentDescriptorPool::try_allocate(uint32_t count) {
+    if (count > mMaxVectorSize || count == 0)
+        throw std::runtime_error("exceeds max descriptor vector size range");
+
+    uint32_t slot = count - 1;
+    Expects(slot < mTables.size());
+
+    auto range = mTables[slot].try_allocate(mPool);
+    if (range.first != range.second) {
+        ++mAllocated;
+    }
+    return range;
+}
+
 void PersistentDescriptorPool::deallocate(uint32_t pos, uint32_t count) noexcept {
     if (count > mMaxVectorSize || count == 0)
         return;
@@ -281,9 +438,30 @@ void PersistentDescriptorPool::deallocate(uint32_t pos, uint32_t count) noexcept
 }
 
 void PersistentDescriptorPool::advanceFrame() {
+    // released vectors are reused after swapchain count frames,
+    // relocated vectors may still be read by frames in flight
+    for (auto& table : mTables) {
+        table.advanceFrame();
+    }
+}
+
+void PersistentDescriptorPool::statistics(std::pmr::vector<PersistentDescriptorBinStatistics>& bins) const {
+    bins.reserve(bins.size() + mTables.size());
+    for (const auto& table : mTables) {
+        bins.emplace_back(table.statistics());
+    }
+}
+
+uint32_t PersistentDescriptorPool::compact(uint32_t maxMoves,
+    std::pmr::vector<PersistentDescriptorRelocation>& relocations
+) {
+    uint32_t moves = 0;
     for (auto& table : mTables) {
-        table.do_deallocate();
+        if (moves == maxMoves)
+            break;
+        moves += table.compact(maxMoves - moves, relocations);
     }
+    return moves;
 }
 
 CircularDescriptorPool::CircularDescriptorPool(uint32_t capacity, uint32_t reserve,
@@ -306,32 +484,53 @@ CircularDescriptorPool::CircularDescriptorPool(uint32_t capacity, uint32_t reser
 CircularDescriptorPool::~CircularDescriptorPool() = default;
 
 std::pair<uint32_t, uint32_t> CircularDescriptorPool::allocate(uint32_t count) {
+    auto range = try_allocate(count);
+    if (range.first == range.second) {
+        throw std::runtime_error("not enough circular descriptor");
+    }
+    return range;
+}
+
+std::pair<uint32_t, uint32_t> CircularDescriptorPool::try_allocate(uint32_t count) {
     Expects(count <= 64 && count > 0);
 
-    std::pair<uint32_t, uint32_t> range;
+    std::pair<uint32_t, uint32_t> range{};
     if (!mBuffer.empty() && mBuffer.back().mCurrentSwapChain == mCurrentSwapChain) {
         range = mBuffer.back().try_allocate(count);
         if (range.first != range.second) {
+            mFrameDescriptorCount += count;
             return range;
         }
     }
 
     // allocation failed, add more blocks
     if (mReserved.empty()) {
-        mReserved.push_back(CircularDescriptorBlock(mPool->allocateRange()));
+        auto block = mPool->try_allocateRange();
+        if (block.begin() == block.end()) {
+            return range;
+        }
+        mReserved.push_back(CircularDescriptorBlock(std::move(block)));
     }
 
     mReserved.front().reset(mCurrentSwapChain);
     mBuffer.push_back(std::move(mReserved.front()));
     mReserved.pop_front();
+    ++mFrameBlockCount;
 
     range = mBuffer.back().try_allocate(count);
     Ensures(range.first != range.second);
+    mFrameDescriptorCount += count;
 
     return range;
 }
 
 void CircularDescriptorPool::advanceFrame() {
+    mStatistics.mDescriptorCount = mFrameDescriptorCount;
+    mStatistics.mBlockCount = mFrameBlockCount;
+    mPeakBlockCount = std::max(mPeakBlockCount, mFrameBlockCount);
+    mFrameDescriptorCount = 0;
+    mFrameBlockCount = 0;
+
     ++mCurrentSwapChain;
     mCurrentSwapChain %= mSwapChainCount;
 
@@ -349,6 +548,35 @@ void CircularDescriptorPool::advanceFrame() {
         if (block.mCurrentSwapChain == mCurrentSwapChain)
             throw std::runtime_error("circular buffer internal error");
     }
+
+    // blocks unused by recent frames are returned to the descriptor pool
+    if (++mFrameCount % sTrimInterval == 0) {
+        while (mReserved.size() > mPeakBlockCount) {
+            mReserved.pop_back();
+        }
+        mPeakBlockCount = mStatistics.mBlockCount;
+    }
+
+    // reserve the peak frame, so frames don't compete with persistent allocations
+    while (mReserved.size() < mPeakBlockCount) {
+        auto block = mPool->try_allocateRange();
+        if (block.begin() == block.end())
+            break;
+        mReserved.push_back(CircularDescriptorBlock(std::move(block)));
+    }
+
+    mStatistics.mPeakBlockCount = mPeakBlockCount;
+    mStatistics.mReservedBlockCount = gsl::narrow_cast<uint32_t>(mReserved.size());
+}
+
+void CircularDescriptorPool::grow(uint32_t capacity) {
+    capacity = gsl::narrow_cast<uint32_t>(boost::alignment::align_up(capacity, mBlockSize));
+    if (capacity <= mCapacity)
+        return;
+
+    mCapacity = capacity;
+    mBuffer.set_capacity(mCapacity / mBlockSize);
+    mReserved.set_capacity(mCapacity / mBlockSize);
 }
 
 MonotonicDescriptorPool::MonotonicDescriptorPool(
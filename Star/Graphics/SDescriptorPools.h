@@ -28,6 +28,37 @@ namespace Graphics {
 
 class DescriptorPool;
 
+struct DescriptorPoolStatistics {
+    uint32_t mBlockCount = 0;
+    uint32_t mFreeBlockCount = 0;
+    // runs of adjacent free blocks
+    uint32_t mFreeRangeCount = 0;
+    uint32_t mLargestFreeRange = 0;
+};
+
+// occupancy of the persistent blocks holding descriptor vectors of one size
+struct PersistentDescriptorBinStatistics {
+    uint32_t mVectorSize = 0;
+    uint32_t mBlockCount = 0;
+    uint32_t mSlotCount = 0;
+    uint32_t mUsedCount = 0;
+};
+
+// usage of the last frame, blocks are reserved for the peak of recent frames
+struct CircularDescriptorStatistics {
+    uint32_t mDescriptorCount = 0;
+    uint32_t mBlockCount = 0;
+    uint32_t mPeakBlockCount = 0;
+    uint32_t mReservedBlockCount = 0;
+};
+
+// descriptor vector moved by compaction, the source is released like a deallocation
+struct PersistentDescriptorRelocation {
+    uint32_t mSource = 0;
+    uint32_t mTarget = 0;
+    uint32_t mCount = 0;
+};
+
 class STAR_GRAPHICS_API DescriptorBlock {
 public:
     DescriptorBlock() noexcept = default;
@@ -88,6 +119,8 @@ public:
     ~DescriptorPool();
 
     DescriptorBlock allocateRange() const;
+    // empty block if all blocks are in use
+    DescriptorBlock try_allocateRange() const;
 
     inline uint32_t getBlockSize() const noexcept {
         return mBlockSize;
@@ -95,6 +128,12 @@ public:
     inline uint32_t getBlockCount() const noexcept {
         return mBlockCount;
     }
+    uint32_t getFreeBlockCount() const noexcept;
+
+    // appends free blocks up to capacity, blocks in use keep their offsets
+    void grow(uint32_t capacity);
+
+    DescriptorPoolStatistics statistics() const;
 private:
     void reset(uint32_t offset, uint32_t count);
     void destroyBuffer(const std::pair<uint32_t, uint32_t>& block) const noexcept;
@@ -148,6 +187,10 @@ public:
 
     bool not_in_use(BinSize sz) const noexcept;
 
+    uint64_t free_mask() const noexcept {
+        return mMask;
+    }
+
     std::pair<uint32_t, uint32_t> find(uint32_t curr) const noexcept {
         if (curr >= mRange.begin() && curr < mRange.end())
             return mRange.get();
@@ -191,11 +234,19 @@ public:
     ~PersistentDescriptorTable();
 
     std::pair<uint32_t, uint32_t> allocate(const DescriptorPool* pPool);
+    // empty range if a new block is needed and the pool has none left
+    std::pair<uint32_t, uint32_t> try_allocate(const DescriptorPool* pPool);
     void deallocate(uint32_t pos) noexcept;
 
     void advanceFrame();
+
+    PersistentDescriptorBinStatistics statistics() const noexcept;
+    // moves vectors out of the sparsest block into the other blocks,
+    // so the block is returned to the pool after the deallocation latency
+    uint32_t compact(uint32_t maxMoves, std::pmr::vector<PersistentDescriptorRelocation>& relocations);
 private:
     void do_deallocate() noexcept;
+    uint64_t live_mask(const PersistentDescriptorBlock& block) const noexcept;
 
     struct FreeMask {
         inline void turn_on(uint32_t index) noexcept {
@@ -237,8 +288,13 @@ public:
     ~PersistentDescriptorPool();
 
     std::pair<uint32_t, uint32_t> allocate(uint32_t count);
+    // empty range if the descriptor pool has no block left
+    std::pair<uint32_t, uint32_t> try_allocate(uint32_t count);
     void deallocate(uint32_t pos, uint32_t count) noexcept;
     void advanceFrame();
+
+    void statistics(std::pmr::vector<PersistentDescriptorBinStatistics>& bins) const;
+    uint32_t compact(uint32_t maxMoves, std::pmr::vector<PersistentDescriptorRelocation>& relocations);
 private:
     uint32_t mCapacity = 0;
     uint32_t mSwapChainCount = 0;
@@ -300,13 +356,29 @@ public:
     ~CircularDescriptorPool();
 
     std::pair<uint32_t, uint32_t> allocate(uint32_t count);
+    // empty range if the descriptor pool has no block left
+    std::pair<uint32_t, uint32_t> try_allocate(uint32_t count);
     void advanceFrame();
+    // the descriptor pool grew, more blocks may be in use at once
+    void grow(uint32_t capacity);
+
+    const CircularDescriptorStatistics& statistics() const noexcept {
+        return mStatistics;
+    }
 private:
+    // frames between trims of the reserved blocks
+    static const uint32_t sTrimInterval = 120;
+
     uint32_t mCapacity = 0;
     uint32_t mSwapChainCount = 0;
     uint32_t mBlockSize = 0;
     uint32_t mCurrentSwapChain = 0;
     const DescriptorPool* mPool = nullptr;
+    uint32_t mFrameCount = 0;
+    uint32_t mFrameDescriptorCount = 0;
+    uint32_t mFrameBlockCount = 0;
+    uint32_t mPeakBlockCount = 0;
+    CircularDescriptorStatistics mStatistics;
 #pragma warning(push)
 #pragma warning(disable: 4251)
     pmr_circular_buffer<CircularDescriptorBlock> mBuffer;
@@ -0,0 +1,197 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+#include <Star/Graphics/SConfig.h>
+
+namespace Star::Graphics::Render {
+
+// flat runtime file layout shared by mesh and content files
+// header, section table, then every section 16-byte aligned,
+// sections are copied as is from a file mapping or a pack buffer
+constexpr uint32_t sFlatFileAlignment = 16;
+
+struct FlatFileHeader {
+    uint32_t mMagic = 0;
+    uint32_t mVersion = 0;
+    uint32_t mSectionCount = 0;
+    uint32_t mReserved = 0;
+};
+
+template<class Section>
+struct FlatFileSectionEntry {
+    Section mType = {};
+    uint32_t mIndex = 0;
+    uint64_t mOffset = 0;
+    uint64_t mSize = 0;
+};
+
+static_assert(sizeof(FlatFileHeader) == 16);
+
+inline bool isFlatFile(const std::byte* data, size_t size, uint32_t magic) noexcept {
+    if (size < sizeof(FlatFileHeader)) {
+        return false;
+    }
+    uint32_t value = 0;
+    std::memcpy(&value, data, sizeof(value));
+    return value == magic;
+}
+
+template<class Section>
+class FlatFileWriter {
+public:
+    using SectionEntry = FlatFileSectionEntry<Section>;
+    static_assert(sizeof(SectionEntry) == 24);
+
+    FlatFileWriter(uint32_t magic, uint32_t version) noexcept
+        : mMagic(magic)
+        , mVersion(version)
+    {}
+
+    void add(Section type, uint32_t index, const void* data, size_t size) {
+        mSections.emplace_back(Entry{ { type, index, 0, size }, data });
+    }
+
+    template<class T>
+    void add(Section type, const T& values) {
+        add(type, 0, values.data(), values.size() * sizeof(values[0]));
+    }
+
+    void write(std::ostream& os) {
+        FlatFileHeader header;
+        header.mMagic = mMagic;
+        header.mVersion = mVersion;
+        header.mSectionCount = gsl::narrow<uint32_t>(mSections.size());
+
+        uint64_t offset = boost::alignment::align_up(
+            sizeof(FlatFileHeader) + sizeof(SectionEntry) * mSections.size(), sFlatFileAlignment);
+        for (auto& section : mSections) {
+            section.mEntry.mOffset = offset;
+            offset = boost::alignment::align_up(offset + section.mEntry.mSize, uint64_t(sFlatFileAlignment));
+        }
+
+        uint64_t pos = 0;
+        auto put = [&](const void* data, size_t size) {
+            os.write(static_cast<const char*>(data), size);
+            pos += size;
+        };
+        auto pad = [&](uint64_t target) {
+            static constexpr char sZeros[sFlatFileAlignment] = {};
+            Expects(target >= pos && target - pos < sFlatFileAlignment);
+            put(sZeros, gsl::narrow_cast<size_t>(target - pos));
+        };
+        put(&header, sizeof(header));
+        for (const auto& section : mSections) {
+            put(&section.mEntry, sizeof(section.mEntry));
+        }
+        for (const auto& section : mSections) {
+            pad(section.mEntry.mOffset);
+            put(section.mData, gsl::narrow_cast<size_t>(section.mEntry.mSize));
+        }
+        pad(offset);
+    }
+private:
+    struct Entry {
+        SectionEntry mEntry;
+        const void* mData = nullptr;
+    };
+    uint32_t mMagic = 0;
+    uint32_t mVersion = 0;
+    std::vector<Entry> mSections;
+};
+
+// name prefixes error messages, throws on a truncated or foreign file
+template<class Section>
+class FlatFileReader {
+public:
+    using SectionEntry = FlatFileSectionEntry<Section>;
+
+    FlatFileReader(const std::byte* data, size_t size, uint32_t magic, uint32_t version, std::string_view name)
+        : mData(data)
+        , mSize(size)
+        , mName(name)
+    {
+        if (!isFlatFile(data, size, magic)) {
+            throw std::invalid_argument("not a " + std::string(name));
+        }
+        std::memcpy(&mHeader, data, sizeof(mHeader));
+        if (mHeader.mVersion != version) {
+            throw std::runtime_error(std::string(name) + " version not supported");
+        }
+        const auto tableSize = sizeof(SectionEntry) * uint64_t(mHeader.mSectionCount);
+        if (sizeof(FlatFileHeader) + tableSize > size) {
+            throw std::runtime_error(std::string(name) + " section table truncated");
+        }
+        mSections.resize(mHeader.mSectionCount);
+        std::memcpy(mSections.data(), data + sizeof(FlatFileHeader), gsl::narrow_cast<size_t>(tableSize));
+        for (const auto& section : mSections) {
+            if (section.mOffset % sFlatFileAlignment || section.mOffset > size || section.mSize > size - section.mOffset) {
+                throw std::runtime_error(std::string(name) + " section out of range");
+            }
+        }
+    }
+
+    const SectionEntry* find(Section type, uint32_t index = 0) const noexcept {
+        for (const auto& section : mSections) {
+            if (section.mType == type && section.mIndex == index) {
+                return &section;
+            }
+        }
+        return nullptr;
+    }
+
+    const std::byte* data(const SectionEntry& section) const noexcept {
+        return mData + section.mOffset;
+    }
+
+    template<class T>
+    void read(Section type, T& values) const {
+        using Value = std::decay_t<decltype(values[0])>;
+        const auto* section = find(type);
+        if (!section) {
+            values.clear();
+            return;
+        }
+        if (section->mSize % sizeof(Value)) {
+            throw std::runtime_error(std::string(mName) + " section size mismatch");
+        }
+        values.resize(gsl::narrow_cast<size_t>(section->mSize / sizeof(Value)));
+        std::memcpy(values.data(), data(*section), gsl::narrow_cast<size_t>(section->mSize));
+    }
+
+    template<class T>
+    T readValue(Section type) const {
+        const auto* section = find(type);
+        if (!section || section->mSize != sizeof(T)) {
+            throw std::runtime_error(std::string(mName) + " section missing");
+        }
+        T value;
+        std::memcpy(&value, data(*section), sizeof(T));
+        return value;
+    }
+
+    std::string_view name() const noexcept {
+        return mName;
+    }
+private:
+    const std::byte* mData = nullptr;
+    size_t mSize = 0;
+    FlatFileHeader mHeader;
+    std::vector<SectionEntry> mSections;
+    std::string_view mName;
+};
+
+}
@@ -0,0 +1,155 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "SMeshFile.h"
+
+namespace Star::Graphics::Render {
+
+static_assert(std::is_trivially_copyable_v<SubMeshData>);
+// fixed size Eigen vectors are plain floats, meshlets are copied bytewise
+static_assert(sizeof(MeshletData) == 48);
+static_assert(std::is_trivially_copyable_v<MeshLodData>);
+
+namespace {
+
+template<size_t... I>
+VertexElementType getVertexElementType(uint32_t index, std::index_sequence<I...>) {
+    if (index >= sizeof...(I)) {
+        throw std::out_of_range("mesh file vertex element type out of range");
+    }
+    VertexElementType type;
+    (void)((I == index ? (type.emplace<I>(), true) : false) || ...);
+    return type;
+}
+
+VertexElementType getVertexElementType(uint32_t index) {
+    return getVertexElementType(index, std::make_index_sequence<std::variant_size_v<VertexElementType>>{});
+}
+
+using MeshFileWriter = FlatFileWriter<MeshFileSection>;
+
+class MeshFileReader : public FlatFileReader<MeshFileSection> {
+public:
+    MeshFileReader(const std::byte* data, size_t size)
+        : FlatFileReader(data, size, sMeshFileMagic, sMeshFileVersion, "mesh file")
+    {}
+};
+
+}
+
+bool isMeshFile(const std::byte* data, size_t size) noexcept {
+    return isFlatFile(data, size, sMeshFileMagic);
+}
+
+void saveMeshFile(std::ostream& os, const MeshData& mesh) {
+    MeshFileInfo info;
+    info.mLayoutID = mesh.mLayoutID;
+    info.mVertexStreamCount = gsl::narrow<uint32_t>(mesh.mVertexBuffers.size());
+    info.mIndexElementSize = mesh.mIndexBuffer.mElementSize;
+    info.mPrimitiveCount = mesh.mIndexBuffer.mPrimitiveCount;
+    info.mPrimitiveTopology = mesh.mIndexBuffer.mPrimitiveTopology;
+
+    std::vector<MeshFileVertexStream> streams;
+    std::vector<MeshFileVertexElement> elements;
+    streams.reserve(mesh.mVertexBuffers.size());
+    for (const auto& vb : mesh.mVertexBuffers) {
+        auto& stream = streams.emplace_back();
+        stream.mVertexSize = vb.mDesc.mVertexSize;
+        stream.mVertexCount = vb.mVertexCount;
+        stream.mElementOffset = gsl::narrow<uint32_t>(elements.size());
+        stream.mElementCount = gsl::narrow<uint32_t>(vb.mDesc.mElements.size());
+        for (const auto& e : vb.mDesc.mElements) {
+            elements.emplace_back(MeshFileVertexElement{
+                gsl::narrow_cast<uint32_t>(e.mType.index()), e.mAlignedByteOffset, e.mFormat });
+        }
+    }
+
+    MeshFileWriter writer(sMeshFileMagic, sMeshFileVersion);
+    writer.add(MeshFileSection::Info, 0, &info, sizeof(info));
+    writer.add(MeshFileSection::LayoutName, mesh.mLayoutName);
+    writer.add(MeshFileSection::VertexStreams, streams);
+    writer.add(MeshFileSection::VertexElements, elements);
+    for (uint32_t i = 0; i != mesh.mVertexBuffers.size(); ++i) {
+        const auto& buffer = mesh.mVertexBuffers[i].mBuffer;
+        writer.add(MeshFileSection::VertexBuffer, i, buffer.data(), buffer.size());
+    }
+    writer.add(MeshFileSection::IndexBuffer, mesh.mIndexBuffer.mBuffer);
+    writer.add(MeshFileSection::SubMeshes, mesh.mSubMeshes);
+    writer.add(MeshFileSection::Meshlets, mesh.mMeshlets);
+    writer.add(MeshFileSection::MeshletVertices, mesh.mMeshletVertices);
+    writer.add(MeshFileSection::MeshletTriangles, mesh.mMeshletTriangles);
+    writer.add(MeshFileSection::Lods, mesh.mLods);
+    writer.add(MeshFileSection::LodSubMeshes, mesh.mLodSubMeshes);
+    writer.write(os);
+}
+
+void loadMeshFile(const std::byte* data, size_t size, MeshData& mesh) {
+    MeshFileReader reader(data, size);
+
+    const auto info = reader.readValue<MeshFileInfo>(MeshFileSection::Info);
+    mesh.mLayoutID = info.mLayoutID;
+    reader.read(MeshFileSection::LayoutName, mesh.mLayoutName);
+
+    std::vector<MeshFileVertexStream> streams;
+    std::vector<MeshFileVertexElement> elements;
+    reader.read(MeshFileSection::VertexStreams, streams);
+    reader.read(MeshFileSection::VertexElements, elements);
+    if (streams.size() != info.mVertexStreamCount) {
+        throw std::runtime_error("mesh file vertex stream count mismatch");
+    }
+
+    mesh.mVertexBuffers.clear();
+    mesh.mVertexBuffers.reserve(streams.size());
+    for (uint32_t i = 0; i != streams.size(); ++i) {
+        const auto& stream = streams[i];
+        if (uint64_t(stream.mElementOffset) + stream.mElementCount > elements.size()) {
+            throw std::runtime_error("mesh file vertex elements out of range");
+        }
+        auto& vb = mesh.mVertexBuffers.emplace_back();
+        vb.mDesc.mVertexSize = stream.mVertexSize;
+        vb.mVertexCount = stream.mVertexCount;
+        vb.mDesc.mElements.reserve(stream.mElementCount);
+        for (uint32_t k = 0; k != stream.mElementCount; ++k) {
+            const auto& e = elements[stream.mElementOffset + k];
+            vb.mDesc.mElements.emplace_back(VertexElement{
+                getVertexElementType(e.mType), gsl::narrow<uint16_t>(e.mAlignedByteOffset), e.mFormat });
+        }
+        const auto* section = reader.find(MeshFileSection::VertexBuffer, i);
+        if (!section) {
+            throw std::runtime_error("mesh file vertex buffer missing");
+        }
+        if (section->mSize != uint64_t(stream.mVertexSize) * stream.mVertexCount) {
+            throw std::runtime_error("mesh file vertex buffer size mismatch");
+        }
+        const auto* src = reinterpret_cast<const char*>(reader.data(*section));
+        vb.mBuffer.assign(src, src + section->mSize);
+    }
+
+    reader.read(MeshFileSection::IndexBuffer, mesh.mIndexBuffer.mBuffer);
+    mesh.mIndexBuffer.mElementSize = info.mIndexElementSize;
+    mesh.mIndexBuffer.mPrimitiveCount = info.mPrimitiveCount;
+    mesh.mIndexBuffer.mPrimitiveTopology = static_cast<GFX_PRIMITIVE_TOPOLOGY>(info.mPrimitiveTopology);
+
+    reader.read(MeshFileSection::SubMeshes, mesh.mSubMeshes);
+    reader.read(MeshFileSection::Meshlets, mesh.mMeshlets);
+    reader.read(MeshFileSection::MeshletVertices, mesh.mMeshletVertices);
+    reader.read(MeshFileSection::MeshletTriangles, mesh.mMeshletTriangles);
+    reader.read(MeshFileSection::Lods, mesh.mLods);
+    reader.read(MeshFileSection::LodSubMeshes, mesh.mLodSubMeshes);
+}
+
+}
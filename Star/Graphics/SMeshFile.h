@@ -0,0 +1,75 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <Star/Graphics/SConfig.h>
+#include <Star/Graphics/SContentTypes.h>
+#include <Star/Graphics/SFlatFile.h>
+
+namespace Star::Graphics::Render {
+
+// flat runtime mesh container, vertex and index blobs are copied as is
+constexpr uint32_t sMeshFileMagic = 0x48534D53; // SMSH
+constexpr uint32_t sMeshFileVersion = 1;
+
+enum class MeshFileSection : uint32_t {
+    Info,
+    LayoutName,
+    VertexStreams,
+    VertexElements,
+    VertexBuffer, // one per stream, mIndex is the stream
+    IndexBuffer,
+    SubMeshes,
+    Meshlets,
+    MeshletVertices,
+    MeshletTriangles,
+    Lods,
+    LodSubMeshes,
+};
+
+using MeshFileSectionEntry = FlatFileSectionEntry<MeshFileSection>;
+
+struct MeshFileInfo {
+    uint32_t mLayoutID = 0;
+    uint32_t mVertexStreamCount = 0;
+    uint32_t mIndexElementSize = 0;
+    uint32_t mPrimitiveCount = 0;
+    uint32_t mPrimitiveTopology = 0;
+    uint32_t mReserved[3] = {};
+};
+
+struct MeshFileVertexStream {
+    uint32_t mVertexSize = 0;
+    uint32_t mVertexCount = 0;
+    uint32_t mElementOffset = 0;
+    uint32_t mElementCount = 0;
+};
+
+struct MeshFileVertexElement {
+    uint32_t mType = 0; // VertexElementType index
+    uint32_t mAlignedByteOffset = 0;
+    Format mFormat = Format::UNKNOWN;
+};
+
+STAR_GRAPHICS_API bool isMeshFile(const std::byte* data, size_t size) noexcept;
+
+STAR_GRAPHICS_API void saveMeshFile(std::ostream& os, const MeshData& mesh);
+
+// mesh buffers keep their allocator, throws on a truncated or foreign file
+STAR_GRAPHICS_API void loadMeshFile(const std::byte* data, size_t size, MeshData& mesh);
+
+}
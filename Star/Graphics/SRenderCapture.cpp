@@ -0,0 +1,294 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "SRenderCapture.h"
+
+namespace Star::Graphics::Render {
+
+// sections are copied bytewise, camera variants hold empty tags only
+static_assert(std::is_trivially_copyable_v<RenderCaptureHeader>);
+static_assert(std::is_trivially_copyable_v<RenderCaptureFrame>);
+static_assert(std::is_trivially_copyable_v<RenderCaptureTransform>);
+static_assert(std::is_trivially_copyable_v<CameraData>);
+static_assert(std::is_trivially_copyable_v<PointLightData>);
+
+namespace {
+
+using RenderCaptureWriter = FlatFileWriter<RenderCaptureSection>;
+using RenderCaptureReader = FlatFileReader<RenderCaptureSection>;
+
+}
+
+bool isRenderCapture(const std::byte* data, size_t size) noexcept {
+    return isFlatFile(data, size, sRenderCaptureMagic);
+}
+
+void saveRenderCapture(std::ostream& os, const RenderCapture& capture) {
+    RenderCaptureWriter writer(sRenderCaptureMagic, sRenderCaptureVersion);
+    writer.add(RenderCaptureSection::Header, 0, &capture.mHeader, sizeof(capture.mHeader));
+    writer.add(RenderCaptureSection::Frames, capture.mFrames);
+    writer.add(RenderCaptureSection::Cameras, capture.mCameras);
+    writer.add(RenderCaptureSection::Transforms, capture.mTransforms);
+    writer.add(RenderCaptureSection::Names, capture.mNames);
+    writer.add(RenderCaptureSection::Lights, capture.mLights);
+    writer.write(os);
+}
+
+void loadRenderCapture(const std::byte* data, size_t size, RenderCapture& capture) {
+    RenderCaptureReader reader(data, size, sRenderCaptureMagic, sRenderCaptureVersion, "render capture");
+    capture.mHeader = reader.readValue<RenderCaptureHeader>(RenderCaptureSection::Header);
+    reader.read(RenderCaptureSection::Frames, capture.mFrames);
+    reader.read(RenderCaptureSection::Cameras, capture.mCameras);
+    reader.read(RenderCaptureSection::Transforms, capture.mTransforms);
+    reader.read(RenderCaptureSection::Names, capture.mNames);
+    reader.read(RenderCaptureSection::Lights, capture.mLights);
+
+    auto validName = [&](uint32_t offset) {
+        return offset == sRenderCaptureUnchanged ||
+            offset < capture.mNames.size() &&
+            std::find(capture.mNames.begin() + offset, capture.mNames.end(), '\0') != capture.mNames.end();
+    };
+    if (!validName(capture.mHeader.mSolutionName) || !validName(capture.mHeader.mPipelineName)) {
+        throw std::runtime_error("render capture name out of range");
+    }
+    for (const auto& frame : capture.mFrames) {
+        if ((frame.mCamera != sRenderCaptureUnchanged &&
+                uint64_t(frame.mCamera) + std::max(1u, frame.mCameraCount) > capture.mCameras.size()) ||
+            uint64_t(frame.mTransformOffset) + frame.mTransformCount > capture.mTransforms.size() ||
+            (frame.mLightOffset != sRenderCaptureUnchanged &&
+                uint64_t(frame.mLightOffset) + frame.mLightCount > capture.mLights.size()) ||
+            !validName(frame.mSolutionName) || !validName(frame.mPipelineName)
+        ) {
+            throw std::runtime_error("render capture frame out of range");
+        }
+    }
+}
+
+void replayRenderCaptureFrame(const RenderCapture& capture, uint32_t frameID,
+    Engine& engine, uint32_t swapChainID, SwapChainContext sc
+) {
+    const auto& frame = capture.mFrames.at(frameID);
+    if (frame.mWidth) {
+        sc.mWidth = frame.mWidth;
+        sc.mHeight = frame.mHeight;
+        engine.resizeSwapChain(swapChainID, sc);
+    }
+    if (frame.mSolutionName != sRenderCaptureUnchanged) {
+        engine.setCurrentPipeline(swapChainID,
+            capture.name(frame.mSolutionName), capture.name(frame.mPipelineName));
+    }
+    if (frame.mCamera != sRenderCaptureUnchanged) {
+        if (frame.mCameraCount) {
+            engine.setCameras(gsl::span<const CameraData>(
+                capture.mCameras.data() + frame.mCamera, frame.mCameraCount));
+        } else {
+            engine.setCamera(capture.mCameras[frame.mCamera]);
+        }
+    }
+    if (frame.mLightOffset != sRenderCaptureUnchanged) {
+        engine.setPointLights(gsl::span<const PointLightData>(
+            capture.mLights.data() + frame.mLightOffset, frame.mLightCount));
+    }
+    if (frameID == 0 || capture.mFrames[frameID - 1].mLodBias != frame.mLodBias) {
+        engine.setLodBias(frame.mLodBias);
+    }
+    if (frameID == 0 || capture.mFrames[frameID - 1].mShaderLevel != frame.mShaderLevel) {
+        engine.setShaderLevel(frame.mShaderLevel);
+    }
+    for (uint32_t i = 0; i != frame.mTransformCount; ++i) {
+        const auto& transform = capture.mTransforms[frame.mTransformOffset + i];
+        engine.setObjectTransform(transform.mObject, transform.mWorld);
+    }
+}
+
+CaptureEngine::CaptureEngine(std::unique_ptr<Engine> engine, const Configs& configs, uint32_t swapChainID)
+    : mEngine(std::move(engine))
+    , mSwapChainID(swapChainID)
+    , mLodBias(configs.mLodBias)
+    , mShaderLevel(configs.mShaderLevel)
+{
+    Expects(mEngine);
+    mCapture.mHeader.mRenderGraph = configs.mRenderGraph;
+    mCapture.mHeader.mSolutionName = mCapture.addName(configs.mSolutionName);
+    mCapture.mHeader.mPipelineName = mCapture.addName(configs.mPipelineName);
+    mEngine->setFrameCallback(recordFrames(nullptr));
+}
+
+CaptureEngine::~CaptureEngine() = default;
+
+void CaptureEngine::preload() {
+    mEngine->preload();
+}
+
+void CaptureEngine::start() {
+    mEngine->start();
+}
+
+void CaptureEngine::stop() {
+    mEngine->stop();
+}
+
+void CaptureEngine::resizeSwapChain(uint32_t id, const SwapChainContext& sc) {
+    if (id == mSwapChainID) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        // size before the first frame is the initial size of the replay
+        if (mCapture.mFrames.empty() && !mCapture.mHeader.mWidth) {
+            mCapture.mHeader.mWidth = sc.mWidth;
+            mCapture.mHeader.mHeight = sc.mHeight;
+        } else {
+            mFrame.mWidth = sc.mWidth;
+            mFrame.mHeight = sc.mHeight;
+        }
+    }
+    mEngine->resizeSwapChain(id, sc);
+}
+
+void CaptureEngine::startSwapChain(uint32_t id, void* hWnd) {
+    mEngine->startSwapChain(id, hWnd);
+}
+
+void CaptureEngine::stopSwapChain(uint32_t id) {
+    mEngine->stopSwapChain(id);
+}
+
+// windows are rendered without requests, frames are ended by the frame callback
+void CaptureEngine::renderSwapChain(uint32_t id) {
+    mEngine->renderSwapChain(id);
+}
+
+Engine::FrameCallback CaptureEngine::recordFrames(FrameCallback callback) {
+    return [this, callback = std::move(callback)](uint32_t id, CameraData& camera) {
+        const bool changed = callback && callback(id, camera);
+        if (id == mSwapChainID) {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (changed) {
+                mFrame.mCamera = gsl::narrow<uint32_t>(mCapture.mCameras.size());
+                mFrame.mCameraCount = 0;
+                mCapture.mCameras.emplace_back(camera);
+            }
+            mFrame.mLodBias = mLodBias;
+            mFrame.mShaderLevel = mShaderLevel;
+            mFrame.mTransformCount = gsl::narrow<uint32_t>(mCapture.mTransforms.size()) - mFrame.mTransformOffset;
+            mCapture.mFrames.emplace_back(mFrame);
+            mFrame = RenderCaptureFrame{};
+            mFrame.mTransformOffset = gsl::narrow<uint32_t>(mCapture.mTransforms.size());
+        }
+        return changed;
+    };
+}
+
+void CaptureEngine::setFrameCallback(FrameCallback callback) {
+    mEngine->setFrameCallback(recordFrames(std::move(callback)));
+}
+
+void CaptureEngine::setFramePacing(uint32_t id, uint32_t maxFrameLatency,
+    uint32_t syncInterval, bool allowTearing
+) {
+    // pacing of the live session is not replayed, the runner renders as fast as it can
+    mEngine->setFramePacing(id, maxFrameLatency, syncInterval, allowTearing);
+}
+
+void CaptureEngine::setCurrentPipeline(uint32_t id, std::string_view solutionName, std::string_view pipelineName) {
+    if (id == mSwapChainID) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mFrame.mSolutionName = mCapture.addName(solutionName);
+        mFrame.mPipelineName = mCapture.addName(pipelineName);
+    }
+    mEngine->setCurrentPipeline(id, solutionName, pipelineName);
+}
+
+void CaptureEngine::enableEventMarkers(bool enabled) {
+    mEngine->enableEventMarkers(enabled);
+}
+
+void CaptureEngine::setLodBias(float bias) {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mLodBias = bias;
+    }
+    mEngine->setLodBias(bias);
+}
+
+void CaptureEngine::setShaderLevel(uint32_t level) {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mShaderLevel = level;
+    }
+    mEngine->setShaderLevel(level);
+}
+
+// not recorded, scales follow the gpu time of the replaying machine
+void CaptureEngine::setResolutionBudget(float milliseconds) {
+    mEngine->setResolutionBudget(milliseconds);
+}
+
+void CaptureEngine::setCamera(const CameraData& camera) {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mFrame.mCamera = gsl::narrow<uint32_t>(mCapture.mCameras.size());
+        mFrame.mCameraCount = 0;
+        mCapture.mCameras.emplace_back(camera);
+    }
+    mEngine->setCamera(camera);
+}
+
+void CaptureEngine::setCameras(gsl::span<const CameraData> views) {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mFrame.mCamera = gsl::narrow<uint32_t>(mCapture.mCameras.size());
+        mFrame.mCameraCount = gsl::narrow<uint32_t>(views.size());
+        mCapture.mCameras.insert(mCapture.mCameras.end(), views.begin(), views.end());
+    }
+    mEngine->setCameras(views);
+}
+
+void CaptureEngine::setPointLights(gsl::span<const PointLightData> lights) {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mFrame.mLightOffset = gsl::narrow<uint32_t>(mCapture.mLights.size());
+        mFrame.mLightCount = gsl::narrow<uint32_t>(lights.size());
+        mCapture.mLights.insert(mCapture.mLights.end(), lights.begin(), lights.end());
+    }
+    mEngine->setPointLights(lights);
+}
+
+void CaptureEngine::setObjectTransform(const ObjectHandle& object, const Affine3f& world) {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mCapture.mTransforms.emplace_back(RenderCaptureTransform{ object, world });
+    }
+    mEngine->setObjectTransform(object, world);
+}
+
+void CaptureEngine::reloadTextures(gsl::span<const MetaID> textures) {
+    mEngine->reloadTextures(textures);
+}
+
+void CaptureEngine::reloadShaders(gsl::span<const MetaID> shaders) {
+    mEngine->reloadShaders(shaders);
+}
+
+double CaptureEngine::getGpuTimings(std::pmr::vector<GpuTiming>& subpasses) const {
+    return mEngine->getGpuTimings(subpasses);
+}
+
+void CaptureEngine::save(std::ostream& os) const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    saveRenderCapture(os, mCapture);
+}
+
+}
@@ -0,0 +1,158 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <Star/Graphics/SConfig.h>
+#include <Star/Graphics/SRenderEngine.h>
+#include <Star/Graphics/SContentTypes.h>
+#include <Star/Graphics/SFlatFile.h>
+#include <mutex>
+
+namespace Star::Graphics::Render {
+
+// engine inputs of one swapchain recorded per frame, replayed to compare builds on identical workloads
+// contents are listed by the render graph, the capture is only valid with the library it was recorded on
+constexpr uint32_t sRenderCaptureMagic = 0x50414353; // SCAP
+constexpr uint32_t sRenderCaptureVersion = 4;
+// input of a frame not changed since the previous frame
+constexpr uint32_t sRenderCaptureUnchanged = std::numeric_limits<uint32_t>::max();
+
+enum class RenderCaptureSection : uint32_t {
+    Header,
+    Frames,
+    Cameras,
+    Transforms,
+    Names,
+    Lights,
+};
+
+// names are offsets of null terminated strings in the names section
+struct RenderCaptureHeader {
+    MetaID mRenderGraph = {};
+    uint32_t mSolutionName = 0;
+    uint32_t mPipelineName = 0;
+    uint32_t mWidth = 0;
+    uint32_t mHeight = 0;
+};
+
+// inputs applied before the frame is rendered, a width of 0 keeps the size
+struct RenderCaptureFrame {
+    uint32_t mWidth = 0;
+    uint32_t mHeight = 0;
+    uint32_t mCamera = sRenderCaptureUnchanged;
+    uint32_t mSolutionName = sRenderCaptureUnchanged;
+    uint32_t mPipelineName = sRenderCaptureUnchanged;
+    uint32_t mTransformOffset = 0;
+    uint32_t mTransformCount = 0;
+    float mLodBias = 0;
+    uint32_t mShaderLevel = 0;
+    // lights replacing the lights of the scene
+    uint32_t mLightOffset = sRenderCaptureUnchanged;
+    uint32_t mLightCount = 0;
+    // views from mCamera replacing every view, 0 replaces the camera only
+    uint32_t mCameraCount = 0;
+};
+
+struct RenderCaptureTransform {
+    ObjectHandle mObject;
+    Affine3f mWorld;
+};
+
+struct RenderCapture {
+    std::string_view name(uint32_t offset) const {
+        Expects(offset < mNames.size());
+        return std::string_view(mNames.data() + offset);
+    }
+
+    uint32_t addName(std::string_view name) {
+        auto offset = gsl::narrow<uint32_t>(mNames.size());
+        mNames.insert(mNames.end(), name.begin(), name.end());
+        mNames.emplace_back('\0');
+        return offset;
+    }
+
+    RenderCaptureHeader mHeader;
+    std::vector<RenderCaptureFrame> mFrames;
+    std::vector<CameraData> mCameras;
+    std::vector<RenderCaptureTransform> mTransforms;
+    std::vector<char> mNames;
+    std::vector<PointLightData> mLights;
+};
+
+STAR_GRAPHICS_API bool isRenderCapture(const std::byte* data, size_t size) noexcept;
+
+STAR_GRAPHICS_API void saveRenderCapture(std::ostream& os, const RenderCapture& capture);
+
+// throws on a truncated or foreign file
+STAR_GRAPHICS_API void loadRenderCapture(const std::byte* data, size_t size, RenderCapture& capture);
+
+// inputs of the frame are passed to the engine, sc is resized to the size of the frame
+STAR_GRAPHICS_API void replayRenderCaptureFrame(const RenderCapture& capture, uint32_t frameID,
+    Engine& engine, uint32_t swapChainID, SwapChainContext sc);
+
+// records the inputs of one swapchain and forwards every call to the engine
+// frames end when the engine starts rendering the swapchain, transforms may be written by any thread
+class STAR_GRAPHICS_API CaptureEngine : public Engine {
+public:
+    CaptureEngine(std::unique_ptr<Engine> engine, const Configs& configs, uint32_t swapChainID);
+    ~CaptureEngine();
+
+    void preload() override;
+    void start() override;
+    void stop() override;
+
+    void resizeSwapChain(uint32_t id, const SwapChainContext& sc) override;
+    void startSwapChain(uint32_t id, void* hWnd) override;
+    void stopSwapChain(uint32_t id) override;
+    void renderSwapChain(uint32_t id) override;
+    void setFramePacing(uint32_t id, uint32_t maxFrameLatency,
+        uint32_t syncInterval, bool allowTearing) override;
+    void setCurrentPipeline(uint32_t id, std::string_view solutionName, std::string_view pipelineName) override;
+
+    void enableEventMarkers(bool enabled) override;
+    void setLodBias(float bias) override;
+    void setShaderLevel(uint32_t level) override;
+    void setResolutionBudget(float milliseconds) override;
+    void setCamera(const CameraData& camera) override;
+    void setCameras(gsl::span<const CameraData> views) override;
+    void setFrameCallback(FrameCallback callback) override;
+    void setPointLights(gsl::span<const PointLightData> lights) override;
+    void setObjectTransform(const ObjectHandle& object, const Affine3f& world) override;
+    void reloadTextures(gsl::span<const MetaID> textures) override;
+    void reloadShaders(gsl::span<const MetaID> shaders) override;
+    double getGpuTimings(std::pmr::vector<GpuTiming>& subpasses) const override;
+
+    // frames recorded so far
+    void save(std::ostream& os) const;
+private:
+    // ends the recorded frame when the engine starts it, cameras changed by callback are recorded
+    FrameCallback recordFrames(FrameCallback callback);
+
+#pragma warning(push)
+#pragma warning(disable: 4251)
+    std::unique_ptr<Engine> mEngine;
+    uint32_t mSwapChainID = 0;
+    mutable std::mutex mMutex;
+    RenderCapture mCapture;
+    // inputs of the frame being recorded
+    RenderCaptureFrame mFrame;
+    float mLodBias = 0;
+    uint32_t mShaderLevel = 0;
+#pragma warning(pop)
+};
+
+}
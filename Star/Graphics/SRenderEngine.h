@@ -17,6 +17,16 @@
 
 #pragma once
 #include <Star/Graphics/SConfig.h>
+#include <Star/Graphics/SContentFwd.h>
+#include <Star/SMathFwd.h>
+#include <Star/SFrameArena.h>
+#include <Star/SThreadPolicy.h>
+
+namespace Star {
+
+class JobSystem;
+
+}
 
 namespace Star::Graphics::Render {
 
@@ -28,15 +38,46 @@ struct SwapChainContext {
     uint32_t mMaxFrameLatency = 2;
     uint32_t mSyncInterval = 0;
     bool mUseWaitableObject = true;
+    // sync interval 0 presents immediately on displays supporting tearing
+    bool mAllowTearing = false;
+};
+
+// object of a loaded content, mBatchID indexes its flattened objects
+struct ObjectHandle {
+    MetaID mContentID;
+    uint32_t mBatchID = 0;
+    uint32_t mObjectID = 0;
 };
 
 struct EngineMemory {
     std::pmr::synchronized_pool_resource* mPool = nullptr; // thread safe
     std::pmr::monotonic_buffer_resource* mMonotonic = nullptr;
-    std::pmr::monotonic_buffer_resource* mPerFrame = nullptr;
-    std::pmr::monotonic_buffer_resource* mPerPass = nullptr;
-    std::pmr::monotonic_buffer_resource* mPerBatch = nullptr;
-    std::pmr::monotonic_buffer_resource* mPerInstance = nullptr;
+    // render thread only, released after each frame
+    FrameArena* mPerFrame = nullptr;
+    // render thread scratch rewound after each pass, queue and instance, recording jobs use their own
+    FrameArena* mPerPass = nullptr;
+    FrameArena* mPerBatch = nullptr;
+    FrameArena* mPerInstance = nullptr;
+};
+
+// work of a subpass counted by the gpu, zero without mPipelineStatistics
+// samples passed over the pixels of the targets is the overdraw,
+// pixel shader invocations over samples passed the shading wasted on hidden samples
+struct GpuStatistics {
+    uint64_t mVertices = 0;
+    uint64_t mPrimitives = 0;
+    uint64_t mRasterizedPrimitives = 0;
+    uint64_t mPixelShaderInvocations = 0;
+    uint64_t mComputeShaderInvocations = 0;
+    // samples passing the depth and stencil tests
+    uint64_t mSamplesPassed = 0;
+};
+
+// gpu time of a subpass, named by the render graph
+struct GpuTiming {
+    std::string_view mName;
+    double mMilliseconds = 0;
+    GpuStatistics mStatistics;
 };
 
 class STAR_GRAPHICS_API Engine {
@@ -47,13 +88,90 @@ public:
 
         boost::asio::io_context::strand* mRenderStrand = nullptr;
         boost::asio::io_context::strand* mTaskStrand = nullptr;
+
+        // fine grained frame work, culling and recording
+        JobSystem* mJobSystem = nullptr;
     };
 
     struct Configs {
         uint32_t mNumSwapChains = 0;
         uint32_t mFrameQueueSize = 3;
-        uint32_t mShaderDescriptorCapacity = 0;
-        uint32_t mShaderDescriptorCircularReserve = 0;
+        // adapter rendering, LowPart | HighPart << 32 of its luid, 0 selects by vendor or else the fastest
+        uint64_t mAdapterLuid = 0;
+        // pci vendor id of the adapter rendering if no luid matches, 0 selects the fastest
+        uint32_t mAdapterVendorID = 0;
+        // initial shader visible descriptors, the heap grows with the render graph and contents created
+        uint32_t mShaderDescriptorCapacity = 1024;
+        // initial circular blocks, resized to the peak frame usage afterwards
+        uint32_t mShaderDescriptorCircularReserve = 256;
+        // circular descriptors used when the shared pool runs out, 0 throws instead
+        // the heap grows by the spilled descriptors before the next frame
+        uint32_t mShaderDescriptorCircularSpill = 256;
+        // texture srvs in one table indexed by materials, 0 binds a descriptor table per material
+        uint32_t mBindlessTextureCapacity = 0;
+        // persistent descriptor vectors moved per frame out of sparse blocks, 0 disables compaction
+        uint32_t mDescriptorCompactionBudget = 0;
+        // upload blocks suballocated by recording threads, larger uploads get dedicated blocks
+        uint64_t mUploadBlockSize = 4 * 1024 * 1024;
+        uint32_t mUploadBlockCount = 8;
+        // command lists recorded in parallel per frame, 0 or 1 records on render thread only
+        uint32_t mNumRecordingThreads = 0;
+        uint32_t mMinDrawsPerRecorder = 256;
+        // mesh queues are culled and drawn by ExecuteIndirect, arguments generated on gpu
+        bool mGpuDrivenRendering = false;
+        // gpu culling is submitted to a compute queue, overlapping graphics work of the previous frame
+        bool mAsyncCompute = false;
+        // occlusion culled subpasses draw instances culled by an earlier frame again in the same frame
+        // if the depth drawn by the visible ones does not hide them, so nothing pops in late
+        bool mTwoPhaseOcclusion = false;
+        // bytes of mesh and texture data uploaded per frame, 0 uploads content when it is created
+        uint64_t mStreamingBudget = 0;
+        // bytes of the tile heap backing large streamed textures, 0 places every texture
+        uint64_t mTilePoolSize = 0;
+        // streamed textures this wide or high are reserved and only their uploaded mips hold tiles
+        uint32_t mReservedTextureDimension = 4096;
+        // indexed meshes sharing a vertex layout are packed into shared vertex and index buffers
+        bool mMeshPooling = false;
+        // acceleration structures of loaded contents are built for raytraced subpasses, ignored without DXR
+        bool mRaytracing = false;
+        // scratch memory shared by the bottom level builds of a batch
+        uint64_t mRaytracingScratchBudget = 64 * 1024 * 1024;
+        // gpu time of each subpass is measured with timestamp queries
+        bool mGpuProfiling = false;
+        // subpasses are also counted by pipeline statistics and occlusion queries, needs mGpuProfiling
+        bool mPipelineStatistics = false;
+        // dred breadcrumbs, page faults and subpass markers are reported to dump\ when the device is removed
+        bool mGpuCrashDiagnostics = false;
+        // gpu debugger events of passes, subpasses, queues and batches, ignored without STAR_DEV
+        bool mEventMarkers = false;
+        // graphics psos are stored in windows2\pipelines.bin and loaded by later runs
+        bool mPipelineCaching = false;
+        // graphics psos are compiled on task threads, draws are skipped until their pso is ready
+        bool mAsyncPipelineCompilation = false;
+        // subpasses are recorded as render passes, load and store ops are passed to the driver
+        bool mRenderPasses = false;
+        // milliseconds a window size must be stable before buffers are resized, stretched meanwhile
+        uint32_t mResizeSettleTime = 0;
+        // thread waking the render thread when a swapchain can take the next frame
+        ThreadPolicy mPresentThread = { 0, true, 0, "Games", false };
+        // log2 scale of the screen error allowed for simplified mesh levels, higher draws coarser levels
+        float mLodBias = 0;
+        // shader level drawn, 0 is the full quality level, clamped to the levels of each shader
+        uint32_t mShaderLevel = 0;
+        // each multiple of this distance from the eye draws one shader level coarser, 0 disables
+        float mShaderLodDistance = 0;
+        // gpu milliseconds per frame kept by rendering screen sized passes at a lower resolution, 0 disables
+        // targets keep their size, viewports are scaled and the back buffer pass upscales, needs mGpuProfiling
+        float mResolutionBudget = 0;
+        // lowest scale of the width and height of screen sized passes
+        float mMinResolutionScale = 0.5f;
+        // width and height of screen sized passes before the upscaling subpass of a pipeline, relative to the output
+        // applied on top of dynamic resolution, pipelines without an upscaling subpass ignore it
+        float mRenderScale = 1;
+        // heap allocations of the render thread are reported with their call stacks, ignored without STAR_DEV
+        bool mTrackFrameAllocations = false;
+        // breaks on allocations of frames rendered after the first sAllocationWarmupFrames
+        bool mAssertFrameAllocations = false;
         MetaID mRenderGraph = {};
         std::string_view mSolutionName;
         std::string_view mPipelineName;
@@ -64,14 +182,59 @@ public:
     Engine& operator=(const Engine&) = delete;
     virtual ~Engine() = 0;
 
+    // called on render thread before the frame of a swapchain is culled, the latest moment to sample input
+    // the camera may be changed in place, returns true if it was
+    using FrameCallback = std::function<bool(uint32_t swapChainID, CameraData& camera)>;
+
+    // reads the engine settings, needs neither producers nor the render thread
+    // may run on a task thread before start, start loads them itself otherwise
+    virtual void preload() = 0;
+    // the calling thread becomes the render thread, the engine may be created on another thread
     virtual void start() = 0;
     virtual void stop() = 0;
 
     virtual void resizeSwapChain(uint32_t id, const SwapChainContext& sc) = 0;
 
+    // windows are rendered from their first size on, each frame started on render thread once a latency slot frees
+    // null window renders offscreen, frames are rendered when requested
     virtual void startSwapChain(uint32_t id, void* hWnd) = 0;
     virtual void stopSwapChain(uint32_t id) = 0;
     virtual void renderSwapChain(uint32_t id) = 0;
+    // applied without recreating buffers or waiting for gpu
+    virtual void setFramePacing(uint32_t id, uint32_t maxFrameLatency,
+        uint32_t syncInterval, bool allowTearing) = 0;
+    // frames of the swapchain in flight are retired, render targets of the solution are recreated
+    virtual void setCurrentPipeline(uint32_t id, std::string_view solutionName, std::string_view pipelineName) = 0;
+
+    virtual void enableEventMarkers(bool enabled) = 0;
+    // raised by applications missing their frame budget, lowered when there is headroom
+    virtual void setLodBias(float bias) = 0;
+    // lowered to cheaper shading when gpu bound, applied when the next frame starts
+    virtual void setShaderLevel(uint32_t level) = 0;
+    // gpu milliseconds per frame kept by dynamic resolution, 0 renders at full resolution
+    virtual void setResolutionBudget(float milliseconds) = 0;
+    // applied when the next frame starts, shared by every swapchain
+    virtual void setCamera(const CameraData& camera) = 0;
+    // replaces the callback, null removes it, applied when the next frame starts
+    virtual void setFrameCallback(FrameCallback callback) = 0;
+    // replaces every view, view 0 is the camera, subpasses are culled and drawn with the view of their node
+    // views missing are drawn with the camera, applied when the next frame starts
+    virtual void setCameras(gsl::span<const CameraData> views) = 0;
+    // replaces the lights of the scene, applied when the next frame starts, read by light culled subpasses
+    virtual void setPointLights(gsl::span<const PointLightData> lights) = 0;
+    // thread safe, applied when the next frame starts, the last write of an object wins
+    // frames being recorded keep the transforms they started with
+    virtual void setObjectTransform(const ObjectHandle& object, const Affine3f& world) = 0;
+    // textures rebuilt on disk, read again on the manager thread and swapped in between frames once uploaded
+    // materials viewing them are patched in place, textures not created yet are skipped
+    virtual void reloadTextures(gsl::span<const MetaID> textures) = 0;
+    // shaders rewritten in the library, their psos are compiled in the background and swapped in between frames
+    // shaders changing their passes or bindings keep their psos until restart, shaders not created yet are skipped
+    virtual void reloadShaders(gsl::span<const MetaID> shaders) = 0;
+    // render thread only, last resolved frame, frame queue size frames old, zero without mGpuProfiling
+    // subpasses hold their statistics with mPipelineStatistics
+    // names are valid until the next frame is rendered
+    virtual double getGpuTimings(std::pmr::vector<GpuTiming>& subpasses) const = 0;
 };
 
 }
@@ -383,4 +383,54 @@ uint64_t getTextureUploadSize(Format format, uint32_t width, uint32_t height) no
     }
 }
 
+uint64_t getSubresourceFootprints(Format format, uint32_t width, uint32_t height,
+    uint32_t mipLevels, uint32_t arraySize, gsl::span<SubresourceFootprint> footprints) noexcept {
+    Expects(footprints.size() == size_t(mipLevels) * arraySize);
+    auto[bpe, blockX, blockY] = getEncoding(format);
+    Expects(bpe);
+    bool yuv420 = false;
+    switch(format) {
+    case Format::G16_B16R16_2PLANE_420_UNORM:
+    case Format::G12X4_B12X4R12X4_2PLANE_420_UNORM_3PACK16:
+    case Format::G10X6_B10X6R10X6_2PLANE_420_UNORM_3PACK16:
+    case Format::G8_B8R8_2PLANE_420_UNORM:
+        yuv420 = true;
+        break;
+    default:
+        break;
+    }
+
+    // mips of the first slice, the other slices repeat them
+    uint64_t offset = 0;
+    for (uint32_t i = 0; i != mipLevels; ++i) {
+        auto& footprint = footprints[i];
+        footprint.mOffset = offset;
+        footprint.mWidth = width;
+        footprint.mHeight = height;
+        auto& info = footprint.mMip;
+        if (yuv420) {
+            std::tie(info.mRowCount, info.mRowPitchSize, info.mSliceSize, info.mRowAlignedSliceSize) =
+                y_uv_420_mip_info(width, height, bpe, sPitchAlignment);
+        } else {
+            std::tie(info.mRowCount, info.mRowPitchSize, info.mSliceSize, info.mRowAlignedSliceSize) =
+                mip_info(width, height, blockX, blockY, bpe, sPitchAlignment);
+        }
+        info.mUploadRowPitchSize = boost::alignment::align_up(info.mRowPitchSize, sPitchAlignment);
+        info.mUploadSliceSize = boost::alignment::align_up(info.mRowAlignedSliceSize, sSliceAlignment);
+        offset += info.mUploadSliceSize;
+        width = half_size(width, blockX);
+        height = half_size(height, blockY);
+    }
+
+    const uint64_t sliceSize = offset;
+    for (uint32_t slice = 1; slice < arraySize; ++slice) {
+        for (uint32_t i = 0; i != mipLevels; ++i) {
+            auto& footprint = footprints[size_t(slice) * mipLevels + i];
+            footprint = footprints[i];
+            footprint.mOffset += slice * sliceSize;
+        }
+    }
+    return sliceSize * arraySize;
+}
+
 }
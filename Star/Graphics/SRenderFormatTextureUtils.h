@@ -40,6 +40,14 @@ struct MipInfo {
     uint64_t mUploadSliceSize; // align_up(mRowAlignedSliceSize, UploadRowSliceSize)
 };
 
+// placement of one subresource in the upload buffer, as GetCopyableFootprints lays it out
+struct SubresourceFootprint {
+    uint64_t mOffset;
+    uint32_t mWidth;
+    uint32_t mHeight;
+    MipInfo mMip;
+};
+
 STAR_GRAPHICS_API Encoding getEncoding(Format format) noexcept;
 STAR_GRAPHICS_API MipInfo getMipInfo(Format format, uint32_t width, uint32_t height) noexcept;
 
@@ -49,4 +57,9 @@ STAR_GRAPHICS_API uint64_t getMipUploadSize(Format format, uint32_t width, uint3
 STAR_GRAPHICS_API uint64_t getTextureSize(Format format, uint32_t width, uint32_t height) noexcept;
 STAR_GRAPHICS_API uint64_t getTextureUploadSize(Format format, uint32_t width, uint32_t height) noexcept;
 
+// footprints of every mip of every slice in one pass, indexed mip + slice * mipLevels like subresources
+// returns the upload size of all slices
+STAR_GRAPHICS_API uint64_t getSubresourceFootprints(Format format, uint32_t width, uint32_t height,
+    uint32_t mipLevels, uint32_t arraySize, gsl::span<SubresourceFootprint> footprints) noexcept;
+
 }
@@ -29,6 +29,12 @@ struct Device_;
 
 using ColorSpace = std::variant<Linear_, Device_>;
 
+struct SDR_;
+struct HDR10_;
+struct ScRGB_;
+
+using OutputColorSpace = std::variant<SDR_, HDR10_, ScRGB_>;
+
 struct Load_;
 struct DontRead_;
 struct Store_;
@@ -44,6 +50,7 @@ struct FramebufferHandle;
 struct DescriptorHandle;
 struct Attachment;
 struct RenderViewTransition;
+struct UpscaleAttachments;
 struct UnorderedRenderQueue;
 
 namespace Descriptor {
@@ -52,8 +59,12 @@ struct ConstantBuffer_;
 struct MainTex_;
 struct PointSampler_;
 struct LinearSampler_;
+struct PointLights_;
+struct LightGrid_;
+struct LightIndices_;
+struct MaterialConstants_;
 
-using Type = std::variant<std::monostate, ConstantBuffer_, MainTex_, PointSampler_, LinearSampler_>;
+using Type = std::variant<std::monostate, ConstantBuffer_, MainTex_, PointSampler_, LinearSampler_, PointLights_, LightGrid_, LightIndices_, MaterialConstants_>;
 
 } // namespace Descriptor
 
@@ -63,8 +74,13 @@ struct Proj_;
 struct View_;
 struct WorldView_;
 struct WorldInvT_;
+struct TextureIndices_;
+struct MaterialIndex_;
+struct ViewportScale_;
+struct PrevWorldView_;
+struct Jitter_;
 
-using Type = std::variant<std::monostate, Proj_, View_, WorldView_, WorldInvT_>;
+using Type = std::variant<std::monostate, Proj_, View_, WorldView_, WorldInvT_, TextureIndices_, MaterialIndex_, ViewportScale_, PrevWorldView_, Jitter_>;
 
 } // namespace Data
 
@@ -78,6 +94,7 @@ struct ShaderConstant;
 struct ShaderConstantBuffer;
 struct GraphicsSubpass;
 struct GraphicsSubpassDependency;
+struct ComputeIndirectArguments;
 struct ComputeSubpass;
 struct RaytracingSubpass;
 struct RenderPass;
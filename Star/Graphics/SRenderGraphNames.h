@@ -27,6 +27,9 @@ namespace Render {
 
 inline const char* getName(const Linear_& v) noexcept { return "Linear"; }
 inline const char* getName(const Device_& v) noexcept { return "Device"; }
+inline const char* getName(const SDR_& v) noexcept { return "SDR"; }
+inline const char* getName(const HDR10_& v) noexcept { return "HDR10"; }
+inline const char* getName(const ScRGB_& v) noexcept { return "ScRGB"; }
 inline const char* getName(const Load_& v) noexcept { return "Load"; }
 inline const char* getName(const DontRead_& v) noexcept { return "DontRead"; }
 inline const char* getName(const Store_& v) noexcept { return "Store"; }
@@ -37,6 +40,7 @@ inline const char* getName(const FramebufferHandle& v) noexcept { return "Frameb
 inline const char* getName(const DescriptorHandle& v) noexcept { return "DescriptorHandle"; }
 inline const char* getName(const Attachment& v) noexcept { return "Attachment"; }
 inline const char* getName(const RenderViewTransition& v) noexcept { return "RenderViewTransition"; }
+inline const char* getName(const UpscaleAttachments& v) noexcept { return "UpscaleAttachments"; }
 inline const char* getName(const UnorderedRenderQueue& v) noexcept { return "UnorderedRenderQueue"; }
 
 namespace Descriptor {
@@ -45,6 +49,10 @@ inline const char* getName(const ConstantBuffer_& v) noexcept { return "Constant
 inline const char* getName(const MainTex_& v) noexcept { return "MainTex"; }
 inline const char* getName(const PointSampler_& v) noexcept { return "PointSampler"; }
 inline const char* getName(const LinearSampler_& v) noexcept { return "LinearSampler"; }
+inline const char* getName(const PointLights_& v) noexcept { return "PointLights"; }
+inline const char* getName(const LightGrid_& v) noexcept { return "LightGrid"; }
+inline const char* getName(const LightIndices_& v) noexcept { return "LightIndices"; }
+inline const char* getName(const MaterialConstants_& v) noexcept { return "MaterialConstants"; }
 
 } // namespace Descriptor
 
@@ -54,6 +62,11 @@ inline const char* getName(const Proj_& v) noexcept { return "Proj"; }
 inline const char* getName(const View_& v) noexcept { return "View"; }
 inline const char* getName(const WorldView_& v) noexcept { return "WorldView"; }
 inline const char* getName(const WorldInvT_& v) noexcept { return "WorldInvT"; }
+inline const char* getName(const TextureIndices_& v) noexcept { return "TextureIndices"; }
+inline const char* getName(const MaterialIndex_& v) noexcept { return "MaterialIndex"; }
+inline const char* getName(const ViewportScale_& v) noexcept { return "ViewportScale"; }
+inline const char* getName(const PrevWorldView_& v) noexcept { return "PrevWorldView"; }
+inline const char* getName(const Jitter_& v) noexcept { return "Jitter"; }
 
 } // namespace Data
 inline const char* getName(const ShaderDescriptor& v) noexcept { return "ShaderDescriptor"; }
@@ -66,6 +79,7 @@ inline const char* getName(const ShaderConstant& v) noexcept { return "ShaderCon
 inline const char* getName(const ShaderConstantBuffer& v) noexcept { return "ShaderConstantBuffer"; }
 inline const char* getName(const GraphicsSubpass& v) noexcept { return "GraphicsSubpass"; }
 inline const char* getName(const GraphicsSubpassDependency& v) noexcept { return "GraphicsSubpassDependency"; }
+inline const char* getName(const ComputeIndirectArguments& v) noexcept { return "ComputeIndirectArguments"; }
 inline const char* getName(const ComputeSubpass& v) noexcept { return "ComputeSubpass"; }
 inline const char* getName(const RaytracingSubpass& v) noexcept { return "RaytracingSubpass"; }
 inline const char* getName(const RenderPass& v) noexcept { return "RenderPass"; }
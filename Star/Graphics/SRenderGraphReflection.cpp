@@ -24,23 +24,110 @@ namespace Graphics {
 
 namespace Render {
 
-namespace Descriptor {
+namespace {
 
-bool try_getType(std::string_view name, Type& type) noexcept {
-    static const std::unordered_map<std::string_view, Type> index{
-        { std::string_view(""), Type(std::in_place_type_t<ConstantBuffer_>()) },
-        { std::string_view("MainTex"), Type(std::in_place_type_t<MainTex_>()) },
-        { std::string_view("PointSampler"), Type(std::in_place_type_t<PointSampler_>()) },
-        { std::string_view("LinearSampler"), Type(std::in_place_type_t<LinearSampler_>()) },
+constexpr uint32_t hashName(std::string_view name, uint32_t seed) noexcept {
+    uint32_t h = 2166136261u ^ seed;
+    for (char c : name) {
+        h ^= static_cast<uint8_t>(c);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// the seed is searched at compile time until every name hashes to its own slot,
+// a lookup hashes once and compares one name
+template<size_t N>
+class PerfectHashTable {
+public:
+    static constexpr size_t sSize = [] {
+        size_t size = 1;
+        while (size < 2 * N) {
+            size *= 2;
+        }
+        return size;
+    }();
+
+    template<class T>
+    constexpr PerfectHashTable(const std::pair<std::string_view, T> (&entries)[N]) noexcept {
+        for (; !tryBuild(entries); ++mSeed) {
+        }
+    }
+
+    // entry of the name, N if not found
+    size_t find(std::string_view name) const noexcept {
+        const auto& slot = mSlots[hashName(name, mSeed) & (sSize - 1)];
+        return slot.mEntry != N && slot.mName == name ? slot.mEntry : N;
+    }
+private:
+    struct Slot {
+        std::string_view mName;
+        size_t mEntry = N;
     };
 
-    auto iter = index.find(name);
-    if (iter != index.end()) {
-        type = iter->second;
+    template<class T>
+    constexpr bool tryBuild(const std::pair<std::string_view, T> (&entries)[N]) noexcept {
+        for (size_t i = 0; i != sSize; ++i) {
+            mSlots[i].mName = std::string_view();
+            mSlots[i].mEntry = N;
+        }
+        for (size_t i = 0; i != N; ++i) {
+            auto& slot = mSlots[hashName(entries[i].first, mSeed) & (sSize - 1)];
+            if (slot.mEntry != N)
+                return false;
+            slot.mName = entries[i].first;
+            slot.mEntry = i;
+        }
         return true;
-    } else {
-        return false;
     }
+
+    uint32_t mSeed = 0;
+    Slot mSlots[sSize] = {};
+};
+
+template<class T, size_t N>
+bool try_find(const std::pair<std::string_view, T> (&entries)[N],
+    const PerfectHashTable<N>& table, std::string_view name, T& value
+) noexcept {
+    const auto i = table.find(name);
+    if (i == N)
+        return false;
+    value = entries[i].second;
+    return true;
+}
+
+constexpr std::pair<std::string_view, Descriptor::Type> sDescriptorTypes[] = {
+    { std::string_view(""), Descriptor::Type(std::in_place_type_t<Descriptor::ConstantBuffer_>()) },
+    { std::string_view("MainTex"), Descriptor::Type(std::in_place_type_t<Descriptor::MainTex_>()) },
+    { std::string_view("PointSampler"), Descriptor::Type(std::in_place_type_t<Descriptor::PointSampler_>()) },
+    { std::string_view("LinearSampler"), Descriptor::Type(std::in_place_type_t<Descriptor::LinearSampler_>()) },
+    { std::string_view("PointLights"), Descriptor::Type(std::in_place_type_t<Descriptor::PointLights_>()) },
+    { std::string_view("LightGrid"), Descriptor::Type(std::in_place_type_t<Descriptor::LightGrid_>()) },
+    { std::string_view("LightIndices"), Descriptor::Type(std::in_place_type_t<Descriptor::LightIndices_>()) },
+    { std::string_view("MaterialConstants"), Descriptor::Type(std::in_place_type_t<Descriptor::MaterialConstants_>()) },
+};
+
+constexpr std::pair<std::string_view, Data::Type> sDataTypes[] = {
+    { std::string_view("Proj"), Data::Type(std::in_place_type_t<Data::Proj_>()) },
+    { std::string_view("View"), Data::Type(std::in_place_type_t<Data::View_>()) },
+    { std::string_view("WorldView"), Data::Type(std::in_place_type_t<Data::WorldView_>()) },
+    { std::string_view("WorldInvT"), Data::Type(std::in_place_type_t<Data::WorldInvT_>()) },
+    { std::string_view("TextureIndices"), Data::Type(std::in_place_type_t<Data::TextureIndices_>()) },
+    { std::string_view("MaterialIndex"), Data::Type(std::in_place_type_t<Data::MaterialIndex_>()) },
+    { std::string_view("ViewportScale"), Data::Type(std::in_place_type_t<Data::ViewportScale_>()) },
+    { std::string_view("PrevWorldView"), Data::Type(std::in_place_type_t<Data::PrevWorldView_>()) },
+    { std::string_view("Jitter"), Data::Type(std::in_place_type_t<Data::Jitter_>()) },
+};
+
+constexpr PerfectHashTable<std::size(sDescriptorTypes)> sDescriptorIndex(sDescriptorTypes);
+constexpr PerfectHashTable<std::size(sDataTypes)> sDataIndex(sDataTypes);
+
+}
+
+namespace Descriptor {
+
+bool try_getType(std::string_view name, Type& type) noexcept {
+    return try_find(sDescriptorTypes, sDescriptorIndex, name, type);
 }
 
 void getType(std::string_view name, Type& type) {
@@ -54,20 +141,7 @@ void getType(std::string_view name, Type& type) {
 namespace Data {
 
 bool try_getType(std::string_view name, Type& type) noexcept {
-    static const std::unordered_map<std::string_view, Type> index{
-        { std::string_view("Proj"), Type(std::in_place_type_t<Proj_>()) },
-        { std::string_view("View"), Type(std::in_place_type_t<View_>()) },
-        { std::string_view("WorldView"), Type(std::in_place_type_t<WorldView_>()) },
-        { std::string_view("WorldInvT"), Type(std::in_place_type_t<WorldInvT_>()) },
-    };
-
-    auto iter = index.find(name);
-    if (iter != index.end()) {
-        type = iter->second;
-        return true;
-    } else {
-        return false;
-    }
+    return try_find(sDataTypes, sDataIndex, name, type);
 }
 
 void getType(std::string_view name, Type& type) {
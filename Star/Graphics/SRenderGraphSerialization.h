@@ -35,6 +35,24 @@ template<class Archive>
 void serialize(Archive& ar, Star::Graphics::Render::Device_& v, const uint32_t version) {
 }
 
+STAR_CLASS_IMPLEMENTATION(Star::Graphics::Render::SDR_, object_serializable);
+STAR_CLASS_TRACKING(Star::Graphics::Render::SDR_, track_never);
+template<class Archive>
+void serialize(Archive& ar, Star::Graphics::Render::SDR_& v, const uint32_t version) {
+}
+
+STAR_CLASS_IMPLEMENTATION(Star::Graphics::Render::HDR10_, object_serializable);
+STAR_CLASS_TRACKING(Star::Graphics::Render::HDR10_, track_never);
+template<class Archive>
+void serialize(Archive& ar, Star::Graphics::Render::HDR10_& v, const uint32_t version) {
+}
+
+STAR_CLASS_IMPLEMENTATION(Star::Graphics::Render::ScRGB_, object_serializable);
+STAR_CLASS_TRACKING(Star::Graphics::Render::ScRGB_, track_never);
+template<class Archive>
+void serialize(Archive& ar, Star::Graphics::Render::ScRGB_& v, const uint32_t version) {
+}
+
 STAR_CLASS_IMPLEMENTATION(Star::Graphics::Render::Load_, object_serializable);
 STAR_CLASS_TRACKING(Star::Graphics::Render::Load_, track_never);
 template<class Archive>
@@ -110,6 +128,7 @@ void serialize(Archive& ar, Star::Graphics::Render::RenderViewTransition& v, con
     ar & v.mFramebuffer;
     ar & v.mSource;
     ar & v.mTarget;
+    ar & v.mFlags;
 }
 
 STAR_CLASS_IMPLEMENTATION(Star::Graphics::Render::UnorderedRenderQueue, object_serializable);
@@ -157,6 +176,30 @@ template<class Archive>
 void serialize(Archive& ar, Star::Graphics::Render::Descriptor::LinearSampler_& v, const uint32_t version) {
 }
 
+STAR_CLASS_IMPLEMENTATION(Star::Graphics::Render::Descriptor::PointLights_, object_serializable);
+STAR_CLASS_TRACKING(Star::Graphics::Render::Descriptor::PointLights_, track_never);
+template<class Archive>
+void serialize(Archive& ar, Star::Graphics::Render::Descriptor::PointLights_& v, const uint32_t version) {
+}
+
+STAR_CLASS_IMPLEMENTATION(Star::Graphics::Render::Descriptor::LightGrid_, object_serializable);
+STAR_CLASS_TRACKING(Star::Graphics::Render::Descriptor::LightGrid_, track_never);
+template<class Archive>
+void serialize(Archive& ar, Star::Graphics::Render::Descriptor::LightGrid_& v, const uint32_t version) {
+}
+
+STAR_CLASS_IMPLEMENTATION(Star::Graphics::Render::Descriptor::LightIndices_, object_serializable);
+STAR_CLASS_TRACKING(Star::Graphics::Render::Descriptor::LightIndices_, track_never);
+template<class Archive>
+void serialize(Archive& ar, Star::Graphics::Render::Descriptor::LightIndices_& v, const uint32_t version) {
+}
+
+STAR_CLASS_IMPLEMENTATION(Star::Graphics::Render::Descriptor::MaterialConstants_, object_serializable);
+STAR_CLASS_TRACKING(Star::Graphics::Render::Descriptor::MaterialConstants_, track_never);
+template<class Archive>
+void serialize(Archive& ar, Star::Graphics::Render::Descriptor::MaterialConstants_& v, const uint32_t version) {
+}
+
 STAR_CLASS_IMPLEMENTATION(Star::Graphics::Render::Data::Proj_, object_serializable);
 STAR_CLASS_TRACKING(Star::Graphics::Render::Data::Proj_, track_never);
 template<class Archive>
@@ -181,6 +224,36 @@ template<class Archive>
 void serialize(Archive& ar, Star::Graphics::Render::Data::WorldInvT_& v, const uint32_t version) {
 }
 
+STAR_CLASS_IMPLEMENTATION(Star::Graphics::Render::Data::TextureIndices_, object_serializable);
+STAR_CLASS_TRACKING(Star::Graphics::Render::Data::TextureIndices_, track_never);
+template<class Archive>
+void serialize(Archive& ar, Star::Graphics::Render::Data::TextureIndices_& v, const uint32_t version) {
+}
+
+STAR_CLASS_IMPLEMENTATION(Star::Graphics::Render::Data::MaterialIndex_, object_serializable);
+STAR_CLASS_TRACKING(Star::Graphics::Render::Data::MaterialIndex_, track_never);
+template<class Archive>
+void serialize(Archive& ar, Star::Graphics::Render::Data::MaterialIndex_& v, const uint32_t version) {
+}
+
+STAR_CLASS_IMPLEMENTATION(Star::Graphics::Render::Data::ViewportScale_, object_serializable);
+STAR_CLASS_TRACKING(Star::Graphics::Render::Data::ViewportScale_, track_never);
+template<class Archive>
+void serialize(Archive& ar, Star::Graphics::Render::Data::ViewportScale_& v, const uint32_t version) {
+}
+
+STAR_CLASS_IMPLEMENTATION(Star::Graphics::Render::Data::PrevWorldView_, object_serializable);
+STAR_CLASS_TRACKING(Star::Graphics::Render::Data::PrevWorldView_, track_never);
+template<class Archive>
+void serialize(Archive& ar, Star::Graphics::Render::Data::PrevWorldView_& v, const uint32_t version) {
+}
+
+STAR_CLASS_IMPLEMENTATION(Star::Graphics::Render::Data::Jitter_, object_serializable);
+STAR_CLASS_TRACKING(Star::Graphics::Render::Data::Jitter_, track_never);
+template<class Archive>
+void serialize(Archive& ar, Star::Graphics::Render::Data::Jitter_& v, const uint32_t version) {
+}
+
 STAR_CLASS_IMPLEMENTATION(Star::Graphics::Render::ShaderDescriptor, object_serializable);
 STAR_CLASS_TRACKING(Star::Graphics::Render::ShaderDescriptor, track_never);
 template<class Archive>
@@ -312,6 +385,7 @@ void serialize(Archive& ar, Star::Graphics::Render::ShaderConstant& v, const uin
     ar & v.mDataType;
     ar & v.mSource;
     ar & v.mID;
+    ar & v.mOffset;
 }
 
 STAR_CLASS_IMPLEMENTATION(Star::Graphics::Render::ShaderConstantBuffer, object_serializable);
@@ -337,6 +411,15 @@ inline void load_construct_data(
     ::new(t) std::pair<K, Star::Graphics::Render::ShaderConstantBuffer>(std::piecewise_construct, std::forward_as_tuple(), std::forward_as_tuple(ar.resource()));
 }
 
+STAR_CLASS_IMPLEMENTATION(Star::Graphics::Render::UpscaleAttachments, object_serializable);
+STAR_CLASS_TRACKING(Star::Graphics::Render::UpscaleAttachments, track_never);
+template<class Archive>
+void serialize(Archive& ar, Star::Graphics::Render::UpscaleAttachments& v, const uint32_t version) {
+    ar & v.mColor;
+    ar & v.mDepth;
+    ar & v.mMotion;
+}
+
 STAR_CLASS_IMPLEMENTATION(Star::Graphics::Render::GraphicsSubpass, object_serializable);
 STAR_CLASS_TRACKING(Star::Graphics::Render::GraphicsSubpass, track_never);
 template<class Archive>
@@ -348,10 +431,18 @@ void serialize(Archive& ar, Star::Graphics::Render::GraphicsSubpass& v, const ui
     ar & v.mDepthStencilAttachment;
     ar & v.mPreserveAttachments;
     ar & v.mPostViewTransitions;
+    ar & v.mAliasingBarriers;
     ar & v.mOrderedRenderQueue;
     ar & v.mRootSignature;
     ar & v.mConstantBuffers;
     ar & v.mDescriptors;
+    ar & v.mOcclusionCulling;
+    ar & v.mLightCulling;
+    ar & v.mShadowCache;
+    ar & v.mShadingRate;
+    ar & v.mShadingRateImage;
+    ar & v.mView;
+    ar & v.mUpscaling;
 }
 
 template<class Archive>
@@ -376,11 +467,22 @@ void serialize(Archive& ar, Star::Graphics::Render::GraphicsSubpassDependency& v
     ar & v.mDstSubpass;
 }
 
+STAR_CLASS_IMPLEMENTATION(Star::Graphics::Render::ComputeIndirectArguments, object_serializable);
+STAR_CLASS_TRACKING(Star::Graphics::Render::ComputeIndirectArguments, track_never);
+template<class Archive>
+void serialize(Archive& ar, Star::Graphics::Render::ComputeIndirectArguments& v, const uint32_t version) {
+    ar & v.mSrcSubpass;
+    ar & v.mOffset;
+    ar & v.mGroupSize;
+}
+
 STAR_CLASS_IMPLEMENTATION(Star::Graphics::Render::ComputeSubpass, object_serializable);
 STAR_CLASS_TRACKING(Star::Graphics::Render::ComputeSubpass, track_never);
 template<class Archive>
 void serialize(Archive& ar, Star::Graphics::Render::ComputeSubpass& v, const uint32_t version) {
     ar & v.mAttachments;
+    ar & v.mThreadGroupCount;
+    ar & v.mIndirectArguments;
 }
 
 template<class Archive>
@@ -492,6 +594,7 @@ template<class Archive>
 void serialize(Archive& ar, Star::Graphics::Render::Framebuffer& v, const uint32_t version) {
     ar & v.mResource;
     ar & v.mClear;
+    ar & v.mAliasSlot;
 }
 
 STAR_CLASS_IMPLEMENTATION(Star::Graphics::Render::RenderSolution, object_serializable);
@@ -512,6 +615,7 @@ void serialize(Archive& ar, Star::Graphics::Render::RenderSolution& v, const uin
     ar & v.mUAVs;
     ar & v.mAttributeIndex;
     ar & v.mPipelineIndex;
+    ar & v.mOutputColorSpace;
 }
 
 template<class Archive>
@@ -185,6 +185,7 @@ GraphicsSubpass::GraphicsSubpass(const allocator_type& alloc)
     , mResolveAttachments(alloc)
     , mPreserveAttachments(alloc)
     , mPostViewTransitions(alloc)
+    , mAliasingBarriers(alloc)
     , mOrderedRenderQueue(alloc)
     , mRootSignature(alloc)
     , mConstantBuffers(alloc)
@@ -199,10 +200,18 @@ GraphicsSubpass::GraphicsSubpass(GraphicsSubpass const& rhs, const allocator_typ
     , mDepthStencilAttachment(rhs.mDepthStencilAttachment)
     , mPreserveAttachments(rhs.mPreserveAttachments, alloc)
     , mPostViewTransitions(rhs.mPostViewTransitions, alloc)
+    , mAliasingBarriers(rhs.mAliasingBarriers, alloc)
     , mOrderedRenderQueue(rhs.mOrderedRenderQueue, alloc)
     , mRootSignature(rhs.mRootSignature, alloc)
     , mConstantBuffers(rhs.mConstantBuffers, alloc)
     , mDescriptors(rhs.mDescriptors, alloc)
+    , mOcclusionCulling(rhs.mOcclusionCulling)
+    , mLightCulling(rhs.mLightCulling)
+    , mShadowCache(rhs.mShadowCache)
+    , mShadingRate(rhs.mShadingRate)
+    , mShadingRateImage(rhs.mShadingRateImage)
+    , mView(rhs.mView)
+    , mUpscaling(rhs.mUpscaling)
 {}
 
 GraphicsSubpass::GraphicsSubpass(GraphicsSubpass&& rhs, const allocator_type& alloc)
@@ -213,10 +222,18 @@ GraphicsSubpass::GraphicsSubpass(GraphicsSubpass&& rhs, const allocator_type& al
     , mDepthStencilAttachment(std::move(rhs.mDepthStencilAttachment))
     , mPreserveAttachments(std::move(rhs.mPreserveAttachments), alloc)
     , mPostViewTransitions(std::move(rhs.mPostViewTransitions), alloc)
+    , mAliasingBarriers(std::move(rhs.mAliasingBarriers), alloc)
     , mOrderedRenderQueue(std::move(rhs.mOrderedRenderQueue), alloc)
     , mRootSignature(std::move(rhs.mRootSignature), alloc)
     , mConstantBuffers(std::move(rhs.mConstantBuffers), alloc)
     , mDescriptors(std::move(rhs.mDescriptors), alloc)
+    , mOcclusionCulling(std::move(rhs.mOcclusionCulling))
+    , mLightCulling(std::move(rhs.mLightCulling))
+    , mShadowCache(std::move(rhs.mShadowCache))
+    , mShadingRate(std::move(rhs.mShadingRate))
+    , mShadingRateImage(std::move(rhs.mShadingRateImage))
+    , mView(std::move(rhs.mView))
+    , mUpscaling(std::move(rhs.mUpscaling))
 {}
 
 GraphicsSubpass::~GraphicsSubpass() = default;
@@ -231,10 +248,14 @@ ComputeSubpass::ComputeSubpass(const allocator_type& alloc)
 
 ComputeSubpass::ComputeSubpass(ComputeSubpass const& rhs, const allocator_type& alloc)
     : mAttachments(rhs.mAttachments, alloc)
+    , mThreadGroupCount{ rhs.mThreadGroupCount[0], rhs.mThreadGroupCount[1], rhs.mThreadGroupCount[2] }
+    , mIndirectArguments(rhs.mIndirectArguments)
 {}
 
 ComputeSubpass::ComputeSubpass(ComputeSubpass&& rhs, const allocator_type& alloc)
     : mAttachments(std::move(rhs.mAttachments), alloc)
+    , mThreadGroupCount{ rhs.mThreadGroupCount[0], rhs.mThreadGroupCount[1], rhs.mThreadGroupCount[2] }
+    , mIndirectArguments(std::move(rhs.mIndirectArguments))
 {}
 
 ComputeSubpass::~ComputeSubpass() = default;
@@ -359,6 +380,7 @@ RenderSolution::RenderSolution(RenderSolution const& rhs, const allocator_type&
     , mUAVs(rhs.mUAVs, alloc)
     , mAttributeIndex(rhs.mAttributeIndex, alloc)
     , mPipelineIndex(rhs.mPipelineIndex, alloc)
+    , mOutputColorSpace(rhs.mOutputColorSpace)
 {}
 
 RenderSolution::RenderSolution(RenderSolution&& rhs, const allocator_type& alloc)
@@ -376,6 +398,7 @@ RenderSolution::RenderSolution(RenderSolution&& rhs, const allocator_type& alloc
     , mUAVs(std::move(rhs.mUAVs), alloc)
     , mAttributeIndex(std::move(rhs.mAttributeIndex), alloc)
     , mPipelineIndex(std::move(rhs.mPipelineIndex), alloc)
+    , mOutputColorSpace(std::move(rhs.mOutputColorSpace))
 {}
 
 RenderSolution::~RenderSolution() = default;
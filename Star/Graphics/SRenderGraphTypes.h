@@ -44,6 +44,24 @@ inline bool operator!=(const ColorSpace& lhs, const ColorSpace& rhs) noexcept {
     return !(lhs == rhs);
 }
 
+// encoding of the back buffer as presented, written by the subpasses drawing to it
+// sRGB with BT.709 primaries
+struct SDR_ {} static constexpr SDR;
+// PQ with BT.2020 primaries, 10 bit back buffers
+struct HDR10_ {} static constexpr HDR10;
+// linear with BT.709 primaries, values above 1 are brighter than white, fp16 back buffers
+struct ScRGB_ {} static constexpr ScRGB;
+
+using OutputColorSpace = std::variant<SDR_, HDR10_, ScRGB_>;
+
+inline bool operator==(const OutputColorSpace& lhs, const OutputColorSpace& rhs) noexcept {
+    return lhs.index() == rhs.index();
+}
+
+inline bool operator!=(const OutputColorSpace& lhs, const OutputColorSpace& rhs) noexcept {
+    return !(lhs == rhs);
+}
+
 struct Load_ {} static constexpr Load;
 inline bool operator==(const Load_&, const Load_&) noexcept { return true; }
 inline bool operator!=(const Load_&, const Load_&) noexcept { return false; }
@@ -114,6 +132,7 @@ struct RenderViewTransition {
     FramebufferHandle mFramebuffer;
     RESOURCE_STATES mSource = {};
     RESOURCE_STATES mTarget = {};
+    RESOURCE_BARRIER_FLAGS mFlags = RESOURCE_BARRIER_FLAG_NONE;
 };
 
 struct STAR_GRAPHICS_API UnorderedRenderQueue {
@@ -134,8 +153,15 @@ struct ConstantBuffer_ {} static constexpr ConstantBuffer;
 struct MainTex_ {} static constexpr MainTex;
 struct PointSampler_ {} static constexpr PointSampler;
 struct LinearSampler_ {} static constexpr LinearSampler;
+// light culling of the subpass, point lights of the frame as float4 pairs, position and range, color and intensity
+struct PointLights_ {} static constexpr PointLights;
+// offset and count of the light indices of each cluster, uint2
+struct LightGrid_ {} static constexpr LightGrid;
+struct LightIndices_ {} static constexpr LightIndices;
+// constants of all materials in 16 byte blocks, float4, indexed by MaterialIndex
+struct MaterialConstants_ {} static constexpr MaterialConstants;
 
-using Type = std::variant<std::monostate, ConstantBuffer_, MainTex_, PointSampler_, LinearSampler_>;
+using Type = std::variant<std::monostate, ConstantBuffer_, MainTex_, PointSampler_, LinearSampler_, PointLights_, LightGrid_, LightIndices_, MaterialConstants_>;
 
 inline bool operator<(const Type& lhs, const Type& rhs) noexcept {
     return lhs.index() < rhs.index();
@@ -149,8 +175,18 @@ struct Proj_ {} static constexpr Proj;
 struct View_ {} static constexpr View;
 struct WorldView_ {} static constexpr WorldView;
 struct WorldInvT_ {} static constexpr WorldInvT;
-
-using Type = std::variant<std::monostate, Proj_, View_, WorldView_, WorldInvT_>;
+// bindless indices of material textures, uint4
+struct TextureIndices_ {} static constexpr TextureIndices;
+// first block of the material constants, uint
+struct MaterialIndex_ {} static constexpr MaterialIndex;
+// rendered part of screen sized render targets, float2, less than 1 with dynamic resolution
+struct ViewportScale_ {} static constexpr ViewportScale;
+// previous view * previous world of the instance, clip space motion of temporal passes
+struct PrevWorldView_ {} static constexpr PrevWorldView;
+// subpixel offset of the projection in ndc, float2, 0 after the upscaling subpass and without one
+struct Jitter_ {} static constexpr Jitter;
+
+using Type = std::variant<std::monostate, Proj_, View_, WorldView_, WorldInvT_, TextureIndices_, MaterialIndex_, ViewportScale_, PrevWorldView_, Jitter_>;
 
 inline bool operator<(const Type& lhs, const Type& rhs) noexcept {
     return lhs.index() < rhs.index();
@@ -238,6 +274,7 @@ struct ShaderConstant {
     Data::Type mDataType;
     DescriptorSource mSource;
     uint32_t mID = 0;
+    uint32_t mOffset = 0;
 };
 
 struct STAR_GRAPHICS_API ShaderConstantBuffer {
@@ -254,6 +291,15 @@ struct STAR_GRAPHICS_API ShaderConstantBuffer {
     std::pmr::vector<ShaderConstant> mConstants;
 };
 
+// render targets read by a temporal upscaling subpass, rendered at the render resolution
+// subpasses before it are jittered and scaled, the upscaling subpass and later ones run at the output resolution
+struct UpscaleAttachments {
+    FramebufferHandle mColor;
+    FramebufferHandle mDepth;
+    // screen motion, upscalers reproject by depth and camera without it
+    std::optional<FramebufferHandle> mMotion;
+};
+
 struct STAR_GRAPHICS_API GraphicsSubpass {
     using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
     allocator_type get_allocator() const noexcept;
@@ -270,10 +316,21 @@ struct STAR_GRAPHICS_API GraphicsSubpass {
     std::optional<Attachment> mDepthStencilAttachment;
     std::pmr::vector<Attachment> mPreserveAttachments;
     std::pmr::vector<RenderViewTransition> mPostViewTransitions;
+    // aliased framebuffers whose lifetime begins in this subpass
+    std::pmr::vector<FramebufferHandle> mAliasingBarriers;
     std::pmr::vector<UnorderedRenderQueue> mOrderedRenderQueue;
     std::pmr::string mRootSignature;
     std::pmr::vector<ShaderConstantBuffer> mConstantBuffers;
     std::pmr::vector<ShaderDescriptorCollection> mDescriptors;
+    bool mOcclusionCulling = false;
+    bool mLightCulling = false;
+    bool mShadowCache = false;
+    SHADING_RATE mShadingRate = SHADING_RATE_1X1;
+    // screen space rates, one texel per shading rate tile
+    std::optional<FramebufferHandle> mShadingRateImage;
+    // index of the engine camera
+    uint32_t mView = 0;
+    std::optional<UpscaleAttachments> mUpscaling;
 };
 
 struct GraphicsSubpassDependency {
@@ -281,6 +338,16 @@ struct GraphicsSubpassDependency {
     uint32_t mDstSubpass = 0;
 };
 
+// dispatch sized on gpu by an earlier compute subpass of the pass, no cpu readback
+// the source writes a thread count at mOffset, turned into D3D12_DISPATCH_ARGUMENTS of mGroupSize groups,
+// or the arguments themselves if mGroupSize is 0. arguments are read by ExecuteIndirect,
+// their buffer is in UNORDERED_ACCESS state outside of it
+struct ComputeIndirectArguments {
+    uint32_t mSrcSubpass = 0;
+    uint32_t mOffset = 0;
+    uint32_t mGroupSize = 0;
+};
+
 struct STAR_GRAPHICS_API ComputeSubpass {
     using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
     allocator_type get_allocator() const noexcept;
@@ -291,6 +358,9 @@ struct STAR_GRAPHICS_API ComputeSubpass {
     ~ComputeSubpass();
 
     std::pmr::vector<Attachment> mAttachments;
+    // thread groups of a cpu sized dispatch, ignored if the arguments are indirect
+    uint32_t mThreadGroupCount[3] = { 1, 1, 1 };
+    std::optional<ComputeIndirectArguments> mIndirectArguments;
 };
 
 struct STAR_GRAPHICS_API RaytracingSubpass {
@@ -358,6 +428,8 @@ struct STAR_GRAPHICS_API RenderPipeline {
 struct Framebuffer {
     RESOURCE_DESC mResource;
     OptimizedClearColor mClear;
+    // framebuffers sharing a slot have disjoint lifetimes and alias the same memory
+    std::optional<uint32_t> mAliasSlot;
 };
 
 struct STAR_GRAPHICS_API RenderSolution {
@@ -383,6 +455,8 @@ struct STAR_GRAPHICS_API RenderSolution {
     std::pmr::vector<UNORDERED_ACCESS_VIEW_DESC> mUAVs;
     PmrFlatMap<uint32_t, uint32_t> mAttributeIndex;
     PmrMap<std::pmr::string, uint32_t> mPipelineIndex;
+    // follows the back buffer format, swapchains are presented in it
+    OutputColorSpace mOutputColorSpace;
 };
 
 struct SwapChain {
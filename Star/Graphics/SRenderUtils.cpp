@@ -27,6 +27,10 @@ uint32_t getSize(const AttributeType& type) noexcept {
         [](uint4_) -> uint32_t { return 16; },
         [](int4_) -> uint32_t { return 16; },
 
+        [](float3_) -> uint32_t { return 12; },
+        [](uint3_) -> uint32_t { return 12; },
+        [](int3_) -> uint32_t { return 12; },
+
         [](float2_) -> uint32_t { return 8; },
         [](uint2_) -> uint32_t { return 8; },
         [](int2_) -> uint32_t { return 8; },
@@ -0,0 +1,89 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "SShaderBlobFile.h"
+
+namespace Star::Graphics::Render {
+
+ShaderBlobWriter::ShaderBlobWriter() {
+    ShaderBlobFileHeader header;
+    mData.assign(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+void ShaderBlobWriter::add(ShaderProgramData& program) {
+    program.mVSBlob = add(program.mVS);
+    program.mHSBlob = add(program.mHS);
+    program.mDSBlob = add(program.mDS);
+    program.mGSBlob = add(program.mGS);
+    program.mPSBlob = add(program.mPS);
+}
+
+ShaderBlobRange ShaderBlobWriter::add(std::pmr::string& bytecode) {
+    if (bytecode.empty())
+        return {};
+
+    const auto hash = std::hash<std::string_view>{}(bytecode);
+    auto [first, last] = mRanges.equal_range(hash);
+    for (auto iter = first; iter != last; ++iter) {
+        const auto& range = iter->second;
+        if (std::string_view(mData.data() + range.mOffset, range.mSize) == bytecode) {
+            bytecode.clear();
+            bytecode.shrink_to_fit();
+            return range;
+        }
+    }
+
+    ShaderBlobRange range;
+    range.mOffset = boost::alignment::align_up(mData.size(), sShaderBlobAlignment);
+    range.mSize = bytecode.size();
+    mData.resize(range.mOffset);
+    mData.append(bytecode);
+    mRanges.emplace(hash, range);
+
+    auto* header = reinterpret_cast<ShaderBlobFileHeader*>(mData.data());
+    header->mSize = mData.size();
+
+    bytecode.clear();
+    bytecode.shrink_to_fit();
+    return range;
+}
+
+void validateShaderBlobFile(const std::byte* data, size_t size) {
+    ShaderBlobFileHeader header;
+    if (size < sizeof(header)) {
+        throw std::runtime_error("shader blob file truncated");
+    }
+    memcpy(&header, data, sizeof(header));
+    if (header.mMagic != sShaderBlobFileMagic) {
+        throw std::runtime_error("not a shader blob file");
+    }
+    if (header.mVersion != sShaderBlobFileVersion) {
+        throw std::runtime_error("shader blob file version mismatch");
+    }
+    if (header.mSize != size) {
+        throw std::runtime_error("shader blob file truncated");
+    }
+}
+
+const std::byte* getShaderBlob(const std::byte* data, size_t size, const ShaderBlobRange& range) {
+    if (range.mOffset < sizeof(ShaderBlobFileHeader) || range.mOffset > size || range.mSize > size - range.mOffset) {
+        throw std::out_of_range("shader blob out of range");
+    }
+    return data + range.mOffset;
+}
+
+}
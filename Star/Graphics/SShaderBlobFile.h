@@ -0,0 +1,67 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <Star/Graphics/SConfig.h>
+#include <Star/Graphics/SContentTypes.h>
+#include <unordered_map>
+
+namespace Star::Graphics::Render {
+
+// compiled bytecode of every shader of a library in one uncompressed file
+// the engine maps it and creates psos from the mapping, shader files only keep ranges
+constexpr uint32_t sShaderBlobFileMagic = 0x424C4253; // SBLB
+constexpr uint32_t sShaderBlobFileVersion = 1;
+// dxil containers are read as dwords
+constexpr uint64_t sShaderBlobAlignment = 16;
+constexpr std::string_view sShaderBlobFileName = "shaders.blob";
+
+struct ShaderBlobFileHeader {
+    uint32_t mMagic = sShaderBlobFileMagic;
+    uint32_t mVersion = sShaderBlobFileVersion;
+    uint64_t mSize = 0;
+};
+
+// bytecode of identical stages is stored once, variants often share a stage
+class STAR_GRAPHICS_API ShaderBlobWriter {
+public:
+    ShaderBlobWriter();
+
+    // moves the bytecode of every stage into the file, the strings of the program are emptied
+    void add(ShaderProgramData& program);
+
+    // header and bytecode, ready to be written
+    const std::string& data() const noexcept {
+        return mData;
+    }
+private:
+    ShaderBlobRange add(std::pmr::string& bytecode);
+
+#pragma warning(push)
+#pragma warning(disable: 4251)
+    std::string mData;
+    std::unordered_multimap<size_t, ShaderBlobRange> mRanges;
+#pragma warning(pop)
+};
+
+// throws on a truncated or foreign file
+STAR_GRAPHICS_API void validateShaderBlobFile(const std::byte* data, size_t size);
+
+// throws if the range is outside of the file
+STAR_GRAPHICS_API const std::byte* getShaderBlob(const std::byte* data, size_t size, const ShaderBlobRange& range);
+
+}
@@ -26,6 +26,11 @@
 #include <boost/smart_ptr/make_shared_object.hpp>
 
 #include <boost/log/sinks/sync_frontend.hpp>
+#include <boost/log/sinks/async_frontend.hpp>
+#include <boost/log/sinks/bounded_fifo_queue.hpp>
+#include <boost/log/sinks/unbounded_fifo_queue.hpp>
+#include <boost/log/sinks/block_on_overflow.hpp>
+#include <boost/log/sinks/drop_on_overflow.hpp>
 #include <boost/log/sinks/text_ostream_backend.hpp>
 #include <boost/log/sinks/text_file_backend.hpp>
 #include <boost/log/sinks/debug_output_backend.hpp>
@@ -39,6 +44,11 @@
 
 #include <boost/log/support/date_time.hpp>
 #include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/core/null_deleter.hpp>
+#include <functional>
+#include <vector>
+#include <array>
+#include <atomic>
 
 namespace Star {
 
@@ -76,26 +86,71 @@ namespace keywords = boost::log::keywords;
 //    std::cout << colorSet(h, RED) << rec[expr::smessage] << colorSet(h, GRAY);
 //}
 
-void initLogging(boost::log::trivial::severity_level level, const char* filename) {
+namespace {
 
-    boost::log::aux::add_console_log(std::clog, 
-        keywords::format =
-        (
-            expr::stream
-                << "[" << expr::format_date_time<boost::posix_time::ptime>("TimeStamp", "%H:%M:%S")
-                << "] <" << logging::trivial::severity << "> " << expr::smessage
-        )
-    );
+// stops and flushes the asynchronous sinks on exitLogging
+std::vector<std::function<void()>> sAsyncSinkStops;
+
+// every channel passes until initLogging or setLogChannelLevel
+std::array<std::atomic<int>, size_t(LogChannel::Count)> sChannelLevels = {};
+
+auto recordFormat() {
+    return expr::stream
+        << "[" << expr::format_date_time<boost::posix_time::ptime>("TimeStamp", "%H:%M:%S")
+        << "] <" << logging::trivial::severity << "> " << expr::smessage;
+}
+
+template<class Queue, class Backend>
+void addAsyncSink(boost::shared_ptr<Backend> backend) {
+    using sink_t = logging::sinks::asynchronous_sink<Backend, Queue>;
+    auto sink = boost::make_shared<sink_t>(backend);
+    sink->set_formatter(recordFormat());
+    logging::core::get()->add_sink(sink);
+    sAsyncSinkStops.emplace_back([sink]() {
+        logging::core::get()->remove_sink(sink);
+        sink->stop();
+        sink->flush();
+    });
+}
+
+template<class Backend>
+void addAsyncSink(boost::shared_ptr<Backend> backend, LogMode mode) {
+    namespace sinks = logging::sinks;
+    switch (mode) {
+    case LogMode::Asynchronous:
+        addAsyncSink<sinks::unbounded_fifo_queue>(std::move(backend));
+        break;
+    case LogMode::AsynchronousBlocking:
+        addAsyncSink<sinks::bounded_fifo_queue<sLogQueueCapacity, sinks::block_on_overflow>>(std::move(backend));
+        break;
+    case LogMode::AsynchronousDropping:
+        addAsyncSink<sinks::bounded_fifo_queue<sLogQueueCapacity, sinks::drop_on_overflow>>(std::move(backend));
+        break;
+    default:
+        throw std::invalid_argument("log mode is not asynchronous");
+    }
+}
 
-    if (filename && filename != std::string("")) {
-        logging::add_file_log(filename, 
-            keywords::format =
-            (
-                expr::stream
-                << "[" << expr::format_date_time<boost::posix_time::ptime>("TimeStamp", "%H:%M:%S")
-                << "] <" << logging::trivial::severity << "> " << expr::smessage
-            )
-        );
+}
+
+void initLogging(boost::log::trivial::severity_level level, const char* filename, LogMode mode) {
+    const bool hasFile = filename && filename != std::string("");
+
+    if (mode == LogMode::Synchronous) {
+        boost::log::aux::add_console_log(std::clog, keywords::format = recordFormat());
+        if (hasFile) {
+            logging::add_file_log(filename, keywords::format = recordFormat());
+        }
+    } else {
+        // records are still built on the calling thread, formatting and writing move to the sink threads
+        auto console = boost::make_shared<logging::sinks::text_ostream_backend>();
+        console->add_stream(boost::shared_ptr<std::ostream>(&std::clog, boost::null_deleter()));
+        addAsyncSink(console, mode);
+        if (hasFile) {
+            auto file = boost::make_shared<logging::sinks::text_file_backend>(keywords::file_name = filename);
+            file->auto_flush(false);
+            addAsyncSink(file, mode);
+        }
     }
 
     boost::log::add_common_attributes();
@@ -111,9 +166,27 @@ void initLogging(boost::log::trivial::severity_level level, const char* filename
     core->set_filter(
         logging::trivial::severity >= level
     );
+
+    for (size_t i = 0; i != sChannelLevels.size(); ++i) {
+        setLogChannelLevel(LogChannel(i), level);
+    }
+}
+
+void setLogChannelLevel(LogChannel channel, boost::log::trivial::severity_level level) noexcept {
+    if (channel >= LogChannel::Count)
+        return;
+    sChannelLevels[size_t(channel)].store(int(level), std::memory_order_relaxed);
+}
+
+bool isLogChannelEnabled(LogChannel channel, boost::log::trivial::severity_level level) noexcept {
+    return int(level) >= sChannelLevels[size_t(channel)].load(std::memory_order_relaxed);
 }
 
 void exitLogging() {
+    for (auto& stop : sAsyncSinkStops) {
+        stop();
+    }
+    sAsyncSinkStops.clear();
     logging::core::get()->remove_all_sinks();
 }
 
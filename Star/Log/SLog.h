@@ -20,23 +20,71 @@
 #include <boost/log/trivial.hpp>
 
 namespace Star {
-    
+
+// console and file sinks format and write records on the logging thread or on a background thread
+enum class LogMode {
+    Synchronous,
+    // records are queued without bound
+    Asynchronous,
+    // at most sLogQueueCapacity records are queued, callers wait for room
+    AsynchronousBlocking,
+    // at most sLogQueueCapacity records are queued, records beyond are dropped
+    AsynchronousDropping,
+};
+
+constexpr size_t sLogQueueCapacity = 4096;
+
 void STAR_LOG_API initLogging(
     boost::log::trivial::severity_level level = boost::log::trivial::info, 
-    const char* filename  ="");
+    const char* filename  ="",
+    LogMode mode = LogMode::Synchronous);
 
+// flushes queued records and stops the background threads of asynchronous sinks
 void STAR_LOG_API exitLogging();
 
+// subsystems filtered separately at runtime by S_LOG
+enum class LogChannel : uint32_t {
+    Core,
+    Render,
+    Asset,
+    Count,
+};
+
+// records of the channel below level are skipped before their arguments are evaluated
+void STAR_LOG_API setLogChannelLevel(LogChannel channel, boost::log::trivial::severity_level level) noexcept;
+bool STAR_LOG_API isLogChannelEnabled(LogChannel channel, boost::log::trivial::severity_level level) noexcept;
+
 }
 
+// levels below STAR_LOG_MIN_LEVEL compile to nothing, their arguments are never evaluated
+#define STAR_LOG_LEVEL_trace 0
+#define STAR_LOG_LEVEL_debug 1
+#define STAR_LOG_LEVEL_info 2
+#define STAR_LOG_LEVEL_warning 3
+#define STAR_LOG_LEVEL_error 4
+#define STAR_LOG_LEVEL_fatal 5
+
+// defined by the build, e.g. STAR_LOG_MIN_LEVEL=STAR_LOG_LEVEL_info for shipping
+#ifndef STAR_LOG_MIN_LEVEL
+#   define STAR_LOG_MIN_LEVEL STAR_LOG_LEVEL_trace
+#endif
+
+#define STAR_LOG_IF_LEVEL(LEVEL) \
+    if constexpr (STAR_LOG_LEVEL_##LEVEL < STAR_LOG_MIN_LEVEL) {} else
+
 //#ifndef _DEBUG
 
-#define S_TRACE BOOST_LOG_TRIVIAL(trace)
-#define S_DEBUG BOOST_LOG_TRIVIAL(debug)
-#define S_INFO BOOST_LOG_TRIVIAL(info)
-#define S_WARNING BOOST_LOG_TRIVIAL(warning)
-#define S_ERROR BOOST_LOG_TRIVIAL(error)
-#define S_FATAL BOOST_LOG_TRIVIAL(fatal)
+#define S_TRACE STAR_LOG_IF_LEVEL(trace) BOOST_LOG_TRIVIAL(trace)
+#define S_DEBUG STAR_LOG_IF_LEVEL(debug) BOOST_LOG_TRIVIAL(debug)
+#define S_INFO STAR_LOG_IF_LEVEL(info) BOOST_LOG_TRIVIAL(info)
+#define S_WARNING STAR_LOG_IF_LEVEL(warning) BOOST_LOG_TRIVIAL(warning)
+#define S_ERROR STAR_LOG_IF_LEVEL(error) BOOST_LOG_TRIVIAL(error)
+#define S_FATAL STAR_LOG_IF_LEVEL(fatal) BOOST_LOG_TRIVIAL(fatal)
+
+// S_LOG(Render, debug) << ..., filtered at compile time by level and at runtime by channel
+#define S_LOG(CHANNEL, LEVEL) STAR_LOG_IF_LEVEL(LEVEL) \
+    if (!::Star::isLogChannelEnabled(::Star::LogChannel::CHANNEL, ::boost::log::trivial::LEVEL)) {} else \
+    BOOST_LOG_TRIVIAL(LEVEL)
 
 //#else
 //
@@ -134,6 +134,7 @@
 #include <Star/SAlignedBuffer.h>
 #include <Star/SMap.h>
 #include <Star/SFlatMap.h>
+#include <Star/SFlatHashMap.h>
 #include <Star/SMultiIndex.h>
 #include <Star/SMultiIndexUtils.h>
 #include <Star/SUUID.h>
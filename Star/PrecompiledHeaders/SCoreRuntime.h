@@ -24,6 +24,7 @@
 #include <execution>
 #include <atomic>
 #include <chrono>
+#include <future>
 
 //------------------------------------------------------------
 // boost
@@ -45,10 +46,6 @@
 // lockfree
 #include <boost/lockfree/queue.hpp>
 
-// state machine
-#include <boost/msm/front/state_machine_def.hpp>
-#include <boost/msm/back/state_machine.hpp>
-
 // geometry
 #include <boost/geometry.hpp>
 #include <boost/geometry/geometries/point.hpp>
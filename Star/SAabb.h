@@ -0,0 +1,148 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+#include <Star/SMathFwd.h>
+#include <xmmintrin.h>
+#include <limits>
+
+namespace Star {
+
+// axis aligned box, corners are padded to float4 so each loads into one SSE register
+// w lanes stay 0. a box with any min above its max is empty, e.g. an object without mesh
+struct alignas(16) Aabb3f {
+    Aabb3f() noexcept = default;
+    Aabb3f(const Vector3f& lower, const Vector3f& upper) noexcept
+        : mMin{ lower.x(), lower.y(), lower.z(), 0 }
+        , mMax{ upper.x(), upper.y(), upper.z(), 0 }
+    {}
+
+    static Aabb3f fromCenterExtent(const Vector3f& center, const Vector3f& extent) noexcept {
+        return Aabb3f(center - extent, center + extent);
+    }
+
+    bool valid() const noexcept {
+        return _mm_movemask_ps(_mm_cmple_ps(_mm_load_ps(mMin), _mm_load_ps(mMax))) == 0xF;
+    }
+
+    Vector3f lower() const noexcept {
+        return Vector3f(mMin[0], mMin[1], mMin[2]);
+    }
+    Vector3f upper() const noexcept {
+        return Vector3f(mMax[0], mMax[1], mMax[2]);
+    }
+    Vector3f center() const noexcept {
+        return 0.5f * (lower() + upper());
+    }
+    Vector3f extent() const noexcept {
+        return 0.5f * (upper() - lower());
+    }
+
+    void grow(const Vector3f& p) noexcept {
+        const __m128 v = _mm_setr_ps(p.x(), p.y(), p.z(), 0);
+        _mm_store_ps(mMin, _mm_min_ps(_mm_load_ps(mMin), v));
+        _mm_store_ps(mMax, _mm_max_ps(_mm_load_ps(mMax), v));
+    }
+    void grow(const Aabb3f& rhs) noexcept {
+        _mm_store_ps(mMin, _mm_min_ps(_mm_load_ps(mMin), _mm_load_ps(rhs.mMin)));
+        _mm_store_ps(mMax, _mm_max_ps(_mm_load_ps(mMax), _mm_load_ps(rhs.mMax)));
+    }
+
+    // box of the transformed corners, from center and extent: c' = M c + t, e' = |M| e
+    // an empty box stays empty
+    Aabb3f transformed(const Affine3f& world) const noexcept;
+
+    // false if the box is outside one of the planes, a point p is inside if dot(n, p) + d >= 0
+    // empty boxes are never outside
+    bool intersects(const float (&planes)[6][4]) const noexcept;
+
+    float mMin[4] = {
+        std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), 0
+    };
+    float mMax[4] = {
+        std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), 0
+    };
+};
+
+static_assert(sizeof(Aabb3f) == 32);
+
+inline Aabb3f merge(const Aabb3f& lhs, const Aabb3f& rhs) noexcept {
+    Aabb3f result = lhs;
+    result.grow(rhs);
+    return result;
+}
+
+inline Aabb3f Aabb3f::transformed(const Affine3f& world) const noexcept {
+    if (!valid())
+        return *this;
+
+    // columns of the affine matrix, w of the linear columns is 0
+    const float* m = world.data();
+    const __m128 c0 = _mm_loadu_ps(m);
+    const __m128 c1 = _mm_loadu_ps(m + 4);
+    const __m128 c2 = _mm_loadu_ps(m + 8);
+    const __m128 c3 = _mm_loadu_ps(m + 12);
+    const __m128 sign = _mm_set1_ps(-0.0f);
+
+    const __m128 lo = _mm_load_ps(mMin);
+    const __m128 hi = _mm_load_ps(mMax);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 c = _mm_mul_ps(_mm_add_ps(lo, hi), half);
+    const __m128 e = _mm_mul_ps(_mm_sub_ps(hi, lo), half);
+
+    __m128 center = _mm_mul_ps(c0, _mm_shuffle_ps(c, c, _MM_SHUFFLE(0, 0, 0, 0)));
+    center = _mm_add_ps(center, _mm_mul_ps(c1, _mm_shuffle_ps(c, c, _MM_SHUFFLE(1, 1, 1, 1))));
+    center = _mm_add_ps(center, _mm_mul_ps(c2, _mm_shuffle_ps(c, c, _MM_SHUFFLE(2, 2, 2, 2))));
+    // translation w is 1, dropped from the corners
+    center = _mm_add_ps(center, _mm_mul_ps(c3, _mm_setr_ps(1, 1, 1, 0)));
+
+    __m128 extent = _mm_mul_ps(_mm_andnot_ps(sign, c0), _mm_shuffle_ps(e, e, _MM_SHUFFLE(0, 0, 0, 0)));
+    extent = _mm_add_ps(extent, _mm_mul_ps(_mm_andnot_ps(sign, c1), _mm_shuffle_ps(e, e, _MM_SHUFFLE(1, 1, 1, 1))));
+    extent = _mm_add_ps(extent, _mm_mul_ps(_mm_andnot_ps(sign, c2), _mm_shuffle_ps(e, e, _MM_SHUFFLE(2, 2, 2, 2))));
+
+    Aabb3f result;
+    _mm_store_ps(result.mMin, _mm_sub_ps(center, extent));
+    _mm_store_ps(result.mMax, _mm_add_ps(center, extent));
+    return result;
+}
+
+inline bool Aabb3f::intersects(const float (&planes)[6][4]) const noexcept {
+    if (!valid())
+        return true;
+
+    const __m128 lo = _mm_load_ps(mMin);
+    const __m128 hi = _mm_load_ps(mMax);
+    const __m128 half = _mm_set1_ps(0.5f);
+    // w of the center is 1 so the dot product adds d
+    const __m128 c = _mm_add_ps(_mm_mul_ps(_mm_add_ps(lo, hi), half), _mm_setr_ps(0, 0, 0, 1));
+    const __m128 e = _mm_mul_ps(_mm_sub_ps(hi, lo), half);
+    const __m128 sign = _mm_set1_ps(-0.0f);
+
+    for (const auto& plane : planes) {
+        const __m128 n = _mm_loadu_ps(plane);
+        // distance of the center plus the projected radius, the w lane of e is 0
+        __m128 v = _mm_add_ps(_mm_mul_ps(n, c), _mm_mul_ps(_mm_andnot_ps(sign, n), e));
+        v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+        v = _mm_add_ss(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)));
+        if (_mm_cvtss_f32(v) < 0)
+            return false;
+    }
+    return true;
+}
+
+}
@@ -16,6 +16,7 @@
 // along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
 
 #pragma once
+#include <Star/SMemory.h>
 
 namespace Star {
 
@@ -43,17 +44,14 @@ public:
         : mBuffer(rhs.mBuffer, alloc)
     {}
 
+    // new storage is zero filled
     size_t resize_aligned(size_t sz) {
-        static_assert(std::is_pod_v<DataBlock>);
-        static_assert(sizeof(DataBlock) == NAlignment);
-        static_assert(sizeof(std::byte) == 1);
+        return resize_blocks(sz, true);
+    }
 
-        sz = boost::alignment::align_up(sz, NAlignment);
-        Expects(sz % NAlignment == 0);
-        size_t count = sz / NAlignment;
-        mBuffer.resize(count);
-        Expects(sz == 0 || (sz && boost::alignment::is_aligned(NAlignment, mBuffer.data())));
-        return sz;
+    // new storage is left uninitialized, caller must overwrite it
+    size_t resize_aligned_uninitialized(size_t sz) {
+        return resize_blocks(sz, false);
     }
 
     bool empty() const noexcept {
@@ -77,7 +75,25 @@ public:
     }
 
 private:
-    std::pmr::vector<DataBlock> mBuffer;
+    size_t resize_blocks(size_t sz, bool zeroFill) {
+        static_assert(std::is_trivially_copyable_v<DataBlock>);
+        static_assert(std::is_trivially_default_constructible_v<DataBlock>);
+        static_assert(sizeof(DataBlock) == NAlignment);
+        static_assert(sizeof(std::byte) == 1);
+
+        sz = boost::alignment::align_up(sz, NAlignment);
+        Expects(sz % NAlignment == 0);
+        size_t count = sz / NAlignment;
+        if (zeroFill) {
+            mBuffer.resize(count, DataBlock{});
+        } else {
+            mBuffer.resize(count);
+        }
+        Expects(sz == 0 || (sz && boost::alignment::is_aligned(NAlignment, mBuffer.data())));
+        return sz;
+    }
+
+    default_init_vector<DataBlock> mBuffer;
 };
 
 using AlignedBuffer16 = AlignedBuffer<16>;
@@ -0,0 +1,200 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <Star/SAlignedBuffer.h>
+#include <filesystem>
+#include <stdexcept>
+
+namespace Star {
+
+// unbuffered reads transfer whole sectors into sector aligned memory
+constexpr size_t sFileSectorAlignment = 4096;
+using FileBuffer = AlignedBuffer<sFileSectorAlignment>;
+// larger files are mapped by readers using a view of the file, copying them costs more than paging
+constexpr size_t sMappedReadThreshold = 1024 * 1024;
+
+// file opened for unbuffered overlapped reads, bypassing the system cache
+class UnbufferedFile {
+public:
+    UnbufferedFile() = default;
+    explicit UnbufferedFile(const std::filesystem::path& file) {
+        mFile = CreateFileW(file.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_NO_BUFFERING | FILE_FLAG_OVERLAPPED, nullptr);
+        if (mFile == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error("open file failed: " + file.string());
+        }
+        LARGE_INTEGER size{};
+        if (!GetFileSizeEx(mFile, &size)) {
+            close();
+            throw std::runtime_error("get file size failed: " + file.string());
+        }
+        mSize = static_cast<size_t>(size.QuadPart);
+        if (mSize > std::numeric_limits<DWORD>::max()) {
+            close();
+            throw std::runtime_error("file too large for a single read: " + file.string());
+        }
+        mOverlapped.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+        if (!mOverlapped.hEvent) {
+            close();
+            throw std::runtime_error("create file read event failed: " + file.string());
+        }
+    }
+    // the overlapped of a pending read is in use, files are moved before reading only
+    UnbufferedFile(UnbufferedFile&& rhs) noexcept
+        : mFile(std::exchange(rhs.mFile, INVALID_HANDLE_VALUE))
+        , mOverlapped(std::exchange(rhs.mOverlapped, OVERLAPPED{}))
+        , mSize(std::exchange(rhs.mSize, 0))
+        , mPending(false)
+    {
+        Expects(!rhs.mPending);
+    }
+    UnbufferedFile& operator=(UnbufferedFile&& rhs) noexcept {
+        Expects(!rhs.mPending);
+        if (this != &rhs) {
+            close();
+            mFile = std::exchange(rhs.mFile, INVALID_HANDLE_VALUE);
+            mOverlapped = std::exchange(rhs.mOverlapped, OVERLAPPED{});
+            mSize = std::exchange(rhs.mSize, 0);
+        }
+        return *this;
+    }
+    UnbufferedFile(const UnbufferedFile&) = delete;
+    UnbufferedFile& operator=(const UnbufferedFile&) = delete;
+    ~UnbufferedFile() {
+        close();
+    }
+
+    size_t size() const noexcept {
+        return mSize;
+    }
+
+    // starts reading the whole file into buffer, sized to the file padded to sectors
+    void beginRead(FileBuffer& buffer) {
+        Expects(!mPending);
+        const auto size = buffer.resize_aligned_uninitialized(mSize);
+        if (size == 0) {
+            return;
+        }
+        mOverlapped.Offset = 0;
+        mOverlapped.OffsetHigh = 0;
+        if (!ReadFile(mFile, buffer.data(), static_cast<DWORD>(size), nullptr, &mOverlapped)
+            && GetLastError() != ERROR_IO_PENDING)
+        {
+            throw std::runtime_error("file read failed");
+        }
+        mPending = true;
+    }
+
+    // blocks until the read completes, returns the size of the file
+    size_t endRead() {
+        if (!mPending) {
+            return mSize;
+        }
+        mPending = false;
+        DWORD bytesRead = 0;
+        if (!GetOverlappedResult(mFile, &mOverlapped, &bytesRead, TRUE) || bytesRead != mSize) {
+            throw std::runtime_error("file read incomplete");
+        }
+        return mSize;
+    }
+private:
+    void close() noexcept {
+        // the buffer of a pending read must not be released before the read stops
+        if (mPending) {
+            CancelIoEx(mFile, &mOverlapped);
+            DWORD bytesRead = 0;
+            GetOverlappedResult(mFile, &mOverlapped, &bytesRead, TRUE);
+            mPending = false;
+        }
+        if (mOverlapped.hEvent) {
+            CloseHandle(mOverlapped.hEvent);
+            mOverlapped.hEvent = nullptr;
+        }
+        if (mFile != INVALID_HANDLE_VALUE) {
+            CloseHandle(mFile);
+            mFile = INVALID_HANDLE_VALUE;
+        }
+        mSize = 0;
+    }
+
+    HANDLE mFile = INVALID_HANDLE_VALUE;
+    OVERLAPPED mOverlapped = {};
+    size_t mSize = 0;
+    bool mPending = false;
+};
+
+// whole file read unbuffered, returns the size of the file, buffer is padded to sectors
+inline size_t readFileUnbuffered(const std::filesystem::path& file, FileBuffer& buffer) {
+    UnbufferedFile f(file);
+    f.beginRead(buffer);
+    return f.endRead();
+}
+
+// reads of many files in flight together, the device queues them instead of one after another
+// buffers are allocated from the resource of the batch and live until the batch is cleared
+class FileReadBatch {
+public:
+    using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+
+    explicit FileReadBatch(const allocator_type& alloc)
+        : mReads(alloc)
+    {}
+
+    // index of the file in the batch, throws if it cannot be opened
+    size_t add(const std::filesystem::path& file) {
+        auto& read = mReads.emplace_back(UnbufferedFile(file));
+        read.mFile.beginRead(read.mBuffer);
+        return mReads.size() - 1;
+    }
+
+    // blocks until every read completes
+    void wait() {
+        for (auto& read : mReads) {
+            read.mFile.endRead();
+        }
+    }
+
+    size_t size() const noexcept {
+        return mReads.size();
+    }
+    const std::byte* data(size_t index) const noexcept {
+        return mReads[index].mBuffer.data();
+    }
+    size_t fileSize(size_t index) const noexcept {
+        return mReads[index].mFile.size();
+    }
+
+    void clear() noexcept {
+        mReads.clear();
+    }
+private:
+    struct Read {
+        using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+        Read(UnbufferedFile&& file, const allocator_type& alloc)
+            : mFile(std::move(file))
+            , mBuffer(alloc)
+        {}
+
+        UnbufferedFile mFile;
+        FileBuffer mBuffer;
+    };
+    // deque, buffers of pending reads must not move
+    std::pmr::deque<Read> mReads;
+};
+
+}
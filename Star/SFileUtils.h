@@ -31,31 +31,55 @@ inline size_t getFileSize(std::ifstream& ifs) {
     return sz;
 }
 
-// http://stackoverflow.com/questions/2602013/read-whole-ascii-file-into-c-stdstring
-// Jerry Coffin
+// whole file in one ReadFile, no stream buffer copies, buffer is resized to the file
+// returns false if the file cannot be opened or read
+template<class String>
+bool tryReadFile(const std::filesystem::path& file, String& buffer) {
+    HANDLE hFile = CreateFileW(file.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (hFile == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size{};
+    bool succeeded = GetFileSizeEx(hFile, &size) && size.QuadPart <= std::numeric_limits<DWORD>::max();
+    if (succeeded) {
+        buffer.resize(static_cast<size_t>(size.QuadPart));
+        DWORD bytesRead = 0;
+        succeeded = buffer.empty() || (ReadFile(hFile, buffer.data(),
+            static_cast<DWORD>(buffer.size()), &bytesRead, nullptr) && bytesRead == buffer.size());
+    }
+    CloseHandle(hFile);
+    if (!succeeded) {
+        buffer.clear();
+    }
+    return succeeded;
+}
+
+// text mode, line ends are read as \n, empty if the file cannot be read
 inline std::string readFile(const std::filesystem::path& file) {
-    std::ifstream ifs(file);
-    std::stringstream buffer;
-    buffer << ifs.rdbuf();
-    return buffer.str();
+    std::string buffer;
+    tryReadFile(file, buffer);
+    auto out = buffer.begin();
+    for (auto in = buffer.begin(); in != buffer.end(); ++in) {
+        if (*in == '\r' && in + 1 != buffer.end() && in[1] == '\n')
+            continue;
+        *out++ = *in;
+    }
+    buffer.erase(out, buffer.end());
+    return buffer;
 }
 
 inline void readFileBuffer(std::string_view file, std::pmr::string& buffer) {
-    std::ifstream ifs(file, std::ios::binary);
-    ifs.exceptions(std::ifstream::failbit);
-
-    auto sz = getFileSize(ifs);
-    buffer.resize(sz);
-    ifs.read(buffer.data(), sz);
+    if (!tryReadFile(std::filesystem::path(file), buffer)) {
+        throw std::ios_base::failure("read file failed: " + std::string(file));
+    }
 }
 
 inline void readFileBuffer(std::wstring_view file, std::pmr::string& buffer) {
-    std::ifstream ifs(file, std::ios::binary);
-    ifs.exceptions(std::ifstream::failbit);
-
-    auto sz = getFileSize(ifs);
-    buffer.resize(sz);
-    ifs.read(buffer.data(), sz);    
+    std::filesystem::path path(file);
+    if (!tryReadFile(path, buffer)) {
+        throw std::ios_base::failure("read file failed: " + path.string());
+    }
 }
 
 inline bool updateFile(const std::filesystem::path& file, std::string_view content) {
@@ -82,17 +106,13 @@ inline bool copyFile(const std::filesystem::path& src, const std::filesystem::pa
 }
 
 inline std::string readBinary(std::string_view file) {
-    std::ifstream ifs(file, std::ios::binary);
-    std::stringstream buffer;
-    buffer << ifs.rdbuf();
-    return buffer.str();
+    std::string buffer;
+    tryReadFile(std::filesystem::path(file), buffer);
+    return buffer;
 }
 
 inline void readBinary(std::string_view file, std::pmr::string& buffer) {
-    std::ifstream ifs(file, std::ios::binary);
-    auto sz = getFileSize(ifs);
-    buffer.resize(sz);
-    ifs.read(buffer.data(), sz);
+    tryReadFile(std::filesystem::path(file), buffer);
 }
 
 inline bool updateBinary(std::string_view file, std::string_view content) {
@@ -107,17 +127,13 @@ inline bool updateBinary(std::string_view file, std::string_view content) {
 }
 
 inline std::string readBinary(const std::filesystem::path& file) {
-    std::ifstream ifs(file, std::ios::binary);
-    std::stringstream buffer;
-    buffer << ifs.rdbuf();
-    return buffer.str();
+    std::string buffer;
+    tryReadFile(file, buffer);
+    return buffer;
 }
 
 inline void readBinary(const std::filesystem::path& file, std::pmr::string& buffer) {
-    std::ifstream ifs(file, std::ios::binary);
-    auto sz = getFileSize(ifs);
-    buffer.resize(sz);
-    ifs.read(buffer.data(), sz);
+    tryReadFile(file, buffer);
 }
 
 inline bool updateBinary(const std::filesystem::path& file, std::string_view content) {
@@ -0,0 +1,530 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <memory_resource>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include <immintrin.h>
+#include <gsl/gsl_assert>
+
+namespace Star {
+
+// open addressing hash map with swiss table control bytes. slots are probed 16 at a time
+// with one sse2 compare of their control bytes, elements live in one array allocated from
+// the map's memory resource and move on rehash. value_type is std::pair<Key, Value>,
+// keys must not be modified through iterators
+template<class Key, class Value, class Hash = std::hash<Key>, class KeyEqual = std::equal_to<Key>>
+class FlatHashMap {
+public:
+    using key_type = Key;
+    using mapped_type = Value;
+    using value_type = std::pair<Key, Value>;
+    using size_type = size_t;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+    using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+
+    allocator_type get_allocator() const noexcept {
+        return mAllocator;
+    }
+private:
+    using value_allocator = std::pmr::polymorphic_allocator<value_type>;
+
+    static constexpr size_t sGroupSize = 16;
+    static constexpr int8_t sEmpty = -128;
+    static constexpr int8_t sDeleted = -2;
+
+    // 16 control bytes, full slots hold the low 7 bits of their hash
+    struct Group {
+        explicit Group(const int8_t* pControl) noexcept
+            : mControl(_mm_load_si128(reinterpret_cast<const __m128i*>(pControl)))
+        {}
+        uint32_t match(int8_t h2) const noexcept {
+            return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(mControl, _mm_set1_epi8(h2))));
+        }
+        uint32_t matchEmpty() const noexcept {
+            return match(sEmpty);
+        }
+        // empty and deleted control bytes have their sign bit set
+        uint32_t matchFree() const noexcept {
+            return static_cast<uint32_t>(_mm_movemask_epi8(mControl));
+        }
+        __m128i mControl;
+    };
+
+    static uint32_t lowestBit(uint32_t mask) noexcept {
+        return _tzcnt_u32(mask);
+    }
+public:
+    template<class Element, class Map>
+    class basic_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = FlatHashMap::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Element*;
+        using reference = Element&;
+
+        basic_iterator() noexcept = default;
+        basic_iterator(Map* pMap, size_t index) noexcept
+            : mMap(pMap), mIndex(index)
+        {
+            skip();
+        }
+        template<class E2, class M2, std::enable_if_t<std::is_convertible_v<E2*, Element*>, int> = 0>
+        basic_iterator(const basic_iterator<E2, M2>& rhs) noexcept
+            : mMap(rhs.mMap), mIndex(rhs.mIndex)
+        {}
+
+        reference operator*() const noexcept {
+            return mMap->mSlots[mIndex];
+        }
+        pointer operator->() const noexcept {
+            return mMap->mSlots + mIndex;
+        }
+        basic_iterator& operator++() noexcept {
+            ++mIndex;
+            skip();
+            return *this;
+        }
+        basic_iterator operator++(int) noexcept {
+            auto tmp = *this;
+            ++*this;
+            return tmp;
+        }
+        bool operator==(const basic_iterator& rhs) const noexcept {
+            return mIndex == rhs.mIndex;
+        }
+        bool operator!=(const basic_iterator& rhs) const noexcept {
+            return mIndex != rhs.mIndex;
+        }
+    private:
+        friend class FlatHashMap;
+        template<class, class> friend class basic_iterator;
+
+        void skip() noexcept {
+            while (mIndex != mMap->mCapacity && mMap->mControl[mIndex] < 0) {
+                ++mIndex;
+            }
+        }
+
+        Map* mMap = nullptr;
+        size_t mIndex = 0;
+    };
+
+    using iterator = basic_iterator<value_type, FlatHashMap>;
+    using const_iterator = basic_iterator<const value_type, const FlatHashMap>;
+
+    FlatHashMap(const allocator_type& alloc = {}) noexcept
+        : mAllocator(alloc)
+    {}
+
+    FlatHashMap(const FlatHashMap& rhs, const allocator_type& alloc)
+        : mAllocator(alloc)
+        , mHash(rhs.mHash)
+        , mEqual(rhs.mEqual)
+    {
+        reserve(rhs.mSize);
+        for (const auto& v : rhs) {
+            insertUnique(hashOf(v.first), v);
+        }
+    }
+
+    FlatHashMap(FlatHashMap&& rhs, const allocator_type& alloc)
+        : mAllocator(alloc)
+        , mHash(rhs.mHash)
+        , mEqual(rhs.mEqual)
+    {
+        if (mAllocator == rhs.mAllocator) {
+            swapStorage(rhs);
+        } else {
+            reserve(rhs.mSize);
+            for (auto& v : rhs) {
+                insertUnique(hashOf(v.first), std::move(v));
+            }
+        }
+    }
+
+    FlatHashMap(const FlatHashMap& rhs)
+        : FlatHashMap(rhs, allocator_type{})
+    {}
+
+    FlatHashMap(FlatHashMap&& rhs) noexcept
+        : mAllocator(rhs.mAllocator)
+        , mHash(rhs.mHash)
+        , mEqual(rhs.mEqual)
+    {
+        swapStorage(rhs);
+    }
+
+    FlatHashMap& operator=(const FlatHashMap& rhs) {
+        if (this != &rhs) {
+            clear();
+            reserve(rhs.mSize);
+            for (const auto& v : rhs) {
+                insertUnique(hashOf(v.first), v);
+            }
+        }
+        return *this;
+    }
+
+    FlatHashMap& operator=(FlatHashMap&& rhs) {
+        if (this != &rhs) {
+            if (mAllocator == rhs.mAllocator) {
+                FlatHashMap tmp(mAllocator);
+                swapStorage(tmp);
+                swapStorage(rhs);
+            } else {
+                clear();
+                reserve(rhs.mSize);
+                for (auto& v : rhs) {
+                    insertUnique(hashOf(v.first), std::move(v));
+                }
+            }
+        }
+        return *this;
+    }
+
+    ~FlatHashMap() {
+        destroyStorage();
+    }
+
+    iterator begin() noexcept {
+        return iterator(this, 0);
+    }
+    iterator end() noexcept {
+        return iterator(this, mCapacity);
+    }
+    const_iterator begin() const noexcept {
+        return const_iterator(this, 0);
+    }
+    const_iterator end() const noexcept {
+        return const_iterator(this, mCapacity);
+    }
+
+    size_t size() const noexcept {
+        return mSize;
+    }
+    bool empty() const noexcept {
+        return mSize == 0;
+    }
+    size_t capacity() const noexcept {
+        return mCapacity;
+    }
+
+    void clear() noexcept {
+        for (size_t i = 0; i != mCapacity; ++i) {
+            if (mControl[i] >= 0) {
+                std::destroy_at(mSlots + i);
+            }
+            mControl[i] = sEmpty;
+        }
+        mSize = 0;
+        mGrowthLeft = maxLoad(mCapacity);
+    }
+
+    // makes room for count elements without rehashing
+    void reserve(size_t count) {
+        if (count <= mSize + mGrowthLeft)
+            return;
+        size_t capacity = sGroupSize;
+        while (maxLoad(capacity) < count) {
+            capacity *= 2;
+        }
+        rehash(capacity);
+    }
+
+    iterator find(const Key& key) noexcept {
+        return iterator(this, findIndex(hashOf(key), key));
+    }
+    const_iterator find(const Key& key) const noexcept {
+        return const_iterator(this, findIndex(hashOf(key), key));
+    }
+    bool contains(const Key& key) const noexcept {
+        return findIndex(hashOf(key), key) != mCapacity;
+    }
+    size_t count(const Key& key) const noexcept {
+        return contains(key) ? 1 : 0;
+    }
+
+    Value& at(const Key& key) {
+        auto index = findIndex(hashOf(key), key);
+        if (index == mCapacity) {
+            throw std::out_of_range("at(FlatHashMap) out of range");
+        }
+        return mSlots[index].second;
+    }
+    const Value& at(const Key& key) const {
+        auto index = findIndex(hashOf(key), key);
+        if (index == mCapacity) {
+            throw std::out_of_range("at(FlatHashMap) out of range");
+        }
+        return mSlots[index].second;
+    }
+
+    Value& operator[](const Key& key) {
+        return try_emplace(key).first->second;
+    }
+
+    template<class... Args>
+    std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args) {
+        auto hash = hashOf(key);
+        auto index = findIndex(hash, key);
+        if (index != mCapacity) {
+            return { iterator(this, index), false };
+        }
+        index = insertUnique(hash, std::piecewise_construct,
+            std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...));
+        return { iterator(this, index), true };
+    }
+
+    template<class... Args>
+    std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args) {
+        auto hash = hashOf(key);
+        auto index = findIndex(hash, key);
+        if (index != mCapacity) {
+            return { iterator(this, index), false };
+        }
+        index = insertUnique(hash, std::piecewise_construct,
+            std::forward_as_tuple(std::move(key)), std::forward_as_tuple(std::forward<Args>(args)...));
+        return { iterator(this, index), true };
+    }
+
+    std::pair<iterator, bool> insert(const value_type& value) {
+        return try_emplace(value.first, value.second);
+    }
+    std::pair<iterator, bool> insert(value_type&& value) {
+        return try_emplace(std::move(value.first), std::move(value.second));
+    }
+
+    template<class... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) {
+        value_type value(std::forward<Args>(args)...);
+        return insert(std::move(value));
+    }
+
+    // iterators other than the erased one stay valid
+    iterator erase(const_iterator pos) noexcept {
+        eraseIndex(pos.mIndex);
+        return iterator(this, pos.mIndex + 1);
+    }
+
+    size_t erase(const Key& key) noexcept {
+        auto index = findIndex(hashOf(key), key);
+        if (index == mCapacity)
+            return 0;
+        eraseIndex(index);
+        return 1;
+    }
+private:
+    // folds a multiply into the low bits, identity hashes of integers still spread over groups and tags
+    size_t hashOf(const Key& key) const noexcept {
+        auto h = static_cast<uint64_t>(mHash(key)) * 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(h ^ (h >> 32));
+    }
+
+    static int8_t h2(size_t hash) noexcept {
+        return static_cast<int8_t>(hash & 0x7F);
+    }
+
+    static size_t maxLoad(size_t capacity) noexcept {
+        return capacity - capacity / 8;
+    }
+
+    size_t groupCount() const noexcept {
+        return mCapacity / sGroupSize;
+    }
+
+    // triangular probing over a power of two group count visits every group once
+    template<class Function>
+    size_t probe(size_t hash, Function&& f) const noexcept {
+        auto mask = groupCount() - 1;
+        auto group = (hash >> 7) & mask;
+        for (size_t i = 0; i <= mask; ++i) {
+            auto result = f(group * sGroupSize);
+            if (result != SIZE_MAX)
+                return result;
+            group = (group + i + 1) & mask;
+        }
+        return mCapacity;
+    }
+
+    size_t findIndex(size_t hash, const Key& key) const noexcept {
+        if (!mCapacity)
+            return 0;
+        auto tag = h2(hash);
+        return probe(hash, [&](size_t base) -> size_t {
+            Group g(mControl + base);
+            for (auto m = g.match(tag); m; m &= m - 1) {
+                auto index = base + lowestBit(m);
+                if (mEqual(mSlots[index].first, key))
+                    return index;
+            }
+            // a group with an empty slot was never full, keys are not placed past it
+            return g.matchEmpty() ? mCapacity : SIZE_MAX;
+        });
+    }
+
+    size_t findFree(size_t hash) const noexcept {
+        return probe(hash, [&](size_t base) -> size_t {
+            auto m = Group(mControl + base).matchFree();
+            return m ? base + lowestBit(m) : SIZE_MAX;
+        });
+    }
+
+    template<class... Args>
+    size_t insertUnique(size_t hash, Args&&... args) {
+        auto index = mCapacity ? findFree(hash) : 0;
+        if (!mCapacity || (mGrowthLeft == 0 && mControl[index] == sEmpty)) {
+            // deleted slots holding most of the load are reclaimed without growing
+            if (!mCapacity) {
+                rehash(sGroupSize);
+            } else {
+                rehash(mSize * 2 < maxLoad(mCapacity) ? mCapacity : mCapacity * 2);
+            }
+            index = findFree(hash);
+        }
+        value_allocator(mAllocator).construct(mSlots + index, std::forward<Args>(args)...);
+        if (mControl[index] == sEmpty) {
+            --mGrowthLeft;
+        }
+        mControl[index] = h2(hash);
+        ++mSize;
+        return index;
+    }
+
+    void eraseIndex(size_t index) noexcept {
+        Expects(index < mCapacity && mControl[index] >= 0);
+        std::destroy_at(mSlots + index);
+        auto base = index & ~(sGroupSize - 1);
+        if (Group(mControl + base).matchEmpty()) {
+            mControl[index] = sEmpty;
+            ++mGrowthLeft;
+        } else {
+            mControl[index] = sDeleted;
+        }
+        --mSize;
+    }
+
+    void rehash(size_t capacity) {
+        Expects(capacity >= sGroupSize && (capacity & (capacity - 1)) == 0);
+        auto* pOldControl = mControl;
+        auto* pOldSlots = mSlots;
+        auto oldCapacity = mCapacity;
+
+        allocateStorage(capacity);
+        try {
+            for (size_t i = 0; i != oldCapacity; ++i) {
+                if (pOldControl[i] < 0)
+                    continue;
+                auto hash = hashOf(pOldSlots[i].first);
+                auto index = findFree(hash);
+                value_allocator(mAllocator).construct(mSlots + index, std::move_if_noexcept(pOldSlots[i]));
+                mControl[index] = h2(hash);
+                --mGrowthLeft;
+                ++mSize;
+            }
+        } catch (...) {
+            destroyStorage();
+            mControl = pOldControl;
+            mSlots = pOldSlots;
+            mCapacity = oldCapacity;
+            mSize = 0;
+            for (size_t i = 0; i != oldCapacity; ++i) {
+                mSize += pOldControl[i] >= 0;
+            }
+            recountGrowth();
+            throw;
+        }
+
+        for (size_t i = 0; i != oldCapacity; ++i) {
+            if (pOldControl[i] >= 0) {
+                std::destroy_at(pOldSlots + i);
+            }
+        }
+        deallocate(pOldControl, pOldSlots, oldCapacity);
+    }
+
+    void recountGrowth() noexcept {
+        size_t used = 0;
+        for (size_t i = 0; i != mCapacity; ++i) {
+            used += mControl[i] != sEmpty;
+        }
+        mGrowthLeft = maxLoad(mCapacity) > used ? maxLoad(mCapacity) - used : 0;
+    }
+
+    void allocateStorage(size_t capacity) {
+        auto* pResource = mAllocator.resource();
+        auto* pControl = static_cast<int8_t*>(pResource->allocate(capacity, sGroupSize));
+        value_type* pSlots = nullptr;
+        try {
+            pSlots = value_allocator(mAllocator).allocate(capacity);
+        } catch (...) {
+            pResource->deallocate(pControl, capacity, sGroupSize);
+            throw;
+        }
+        std::fill_n(pControl, capacity, sEmpty);
+        mControl = pControl;
+        mSlots = pSlots;
+        mCapacity = capacity;
+        mSize = 0;
+        mGrowthLeft = maxLoad(capacity);
+    }
+
+    void deallocate(int8_t* pControl, value_type* pSlots, size_t capacity) noexcept {
+        if (!capacity)
+            return;
+        mAllocator.resource()->deallocate(pControl, capacity, sGroupSize);
+        value_allocator(mAllocator).deallocate(pSlots, capacity);
+    }
+
+    void destroyStorage() noexcept {
+        for (size_t i = 0; i != mCapacity; ++i) {
+            if (mControl[i] >= 0) {
+                std::destroy_at(mSlots + i);
+            }
+        }
+        deallocate(mControl, mSlots, mCapacity);
+        mControl = nullptr;
+        mSlots = nullptr;
+        mCapacity = 0;
+        mSize = 0;
+        mGrowthLeft = 0;
+    }
+
+    void swapStorage(FlatHashMap& rhs) noexcept {
+        std::swap(mControl, rhs.mControl);
+        std::swap(mSlots, rhs.mSlots);
+        std::swap(mCapacity, rhs.mCapacity);
+        std::swap(mSize, rhs.mSize);
+        std::swap(mGrowthLeft, rhs.mGrowthLeft);
+    }
+
+    allocator_type mAllocator;
+    Hash mHash;
+    KeyEqual mEqual;
+    int8_t* mControl = nullptr;
+    value_type* mSlots = nullptr;
+    size_t mCapacity = 0;
+    size_t mSize = 0;
+    size_t mGrowthLeft = 0;
+};
+
+}
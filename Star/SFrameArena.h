@@ -0,0 +1,170 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <memory_resource>
+#include <vector>
+#include <algorithm>
+#include <gsl/gsl_assert>
+
+namespace Star {
+
+// bump allocator rewound to markers, blocks beyond the initial buffer come from upstream
+// and are kept for reuse until release. deallocate is a no-op, single threaded
+class FrameArena : public std::pmr::memory_resource {
+public:
+    struct Marker {
+        size_t mBlock = 0;
+        size_t mOffset = 0;
+        size_t mUsed = 0;
+    };
+
+    explicit FrameArena(std::pmr::memory_resource* upstream = std::pmr::get_default_resource()) noexcept
+        : mUpstream(upstream)
+        , mBlocks(upstream)
+    {}
+
+    FrameArena(void* buffer, size_t size,
+        std::pmr::memory_resource* upstream = std::pmr::get_default_resource()) noexcept
+        : mUpstream(upstream)
+        , mInitial{ static_cast<std::byte*>(buffer), size }
+        , mBlocks(upstream)
+    {}
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    ~FrameArena() {
+        release();
+    }
+
+    Marker mark() const noexcept {
+        return Marker{ mBlock, mOffset, mUsed };
+    }
+
+    // allocations made after the marker are invalidated
+    void rewind(const Marker& marker) noexcept {
+        Expects(marker.mBlock < mBlock || (marker.mBlock == mBlock && marker.mOffset <= mOffset));
+        mBlock = marker.mBlock;
+        mOffset = marker.mOffset;
+        mUsed = marker.mUsed;
+    }
+
+    // rewinds to the start and returns upstream blocks, the high water mark is kept
+    void release() noexcept {
+        for (const auto& block : mBlocks) {
+            mUpstream->deallocate(block.mData, block.mSize, alignof(std::max_align_t));
+        }
+        mBlocks.clear();
+        mBlock = 0;
+        mOffset = 0;
+        mUsed = 0;
+    }
+
+    // bytes in use, alignment padding and skipped block tails included
+    size_t used() const noexcept {
+        return mUsed;
+    }
+
+    // peak of used() since construction or the last reset
+    size_t highWaterMark() const noexcept {
+        return mHighWaterMark;
+    }
+
+    void resetHighWaterMark() noexcept {
+        mHighWaterMark = mUsed;
+    }
+
+    // blocks allocated from upstream and not yet released
+    size_t upstreamBlockCount() const noexcept {
+        return mBlocks.size();
+    }
+private:
+    struct Block {
+        std::byte* mData = nullptr;
+        size_t mSize = 0;
+    };
+
+    static constexpr size_t sMinBlockSize = 4096;
+
+    Block& block(size_t blockID) noexcept {
+        return blockID ? mBlocks[blockID - 1] : mInitial;
+    }
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        for (;;) {
+            auto& current = block(mBlock);
+            if (current.mData) {
+                const auto address = reinterpret_cast<uintptr_t>(current.mData) + mOffset;
+                const auto padding = ((address + alignment - 1) & ~uintptr_t(alignment - 1)) - address;
+                if (mOffset + padding + bytes <= current.mSize) {
+                    void* p = current.mData + mOffset + padding;
+                    mOffset += padding + bytes;
+                    mUsed += padding + bytes;
+                    mHighWaterMark = std::max(mHighWaterMark, mUsed);
+                    return p;
+                }
+            }
+            // tail of the block is skipped
+            mUsed += current.mSize - mOffset;
+            const auto currentSize = current.mSize;
+            if (mBlock < mBlocks.size() && mBlocks[mBlock].mSize >= bytes + alignment) {
+                ++mBlock;
+                mOffset = 0;
+                continue;
+            }
+            const auto size = std::max({ bytes + alignment, 2 * currentSize, sMinBlockSize });
+            auto* pData = static_cast<std::byte*>(mUpstream->allocate(size, alignof(std::max_align_t)));
+            mBlocks.insert(mBlocks.begin() + mBlock, Block{ pData, size });
+            ++mBlock;
+            mOffset = 0;
+        }
+    }
+
+    void do_deallocate(void*, std::size_t, std::size_t) override {}
+
+    bool do_is_equal(const std::pmr::memory_resource& rhs) const noexcept override {
+        return this == &rhs;
+    }
+
+    std::pmr::memory_resource* mUpstream = nullptr;
+    Block mInitial;
+    std::pmr::vector<Block> mBlocks;
+    size_t mBlock = 0;
+    size_t mOffset = 0;
+    size_t mUsed = 0;
+    size_t mHighWaterMark = 0;
+};
+
+// rewinds the arena to where it was on construction
+class FrameArenaScope {
+public:
+    explicit FrameArenaScope(FrameArena& arena) noexcept
+        : mArena(arena)
+        , mMarker(arena.mark())
+    {}
+    FrameArenaScope(const FrameArenaScope&) = delete;
+    FrameArenaScope& operator=(const FrameArenaScope&) = delete;
+    ~FrameArenaScope() {
+        mArena.rewind(mMarker);
+    }
+private:
+    FrameArena& mArena;
+    FrameArena::Marker mMarker;
+};
+
+}
@@ -24,6 +24,7 @@
 #include <boost/geometry/algorithms/envelope.hpp>
 
 #include <Star/SMathFwd.h>
+#include <Star/SAabb.h>
 
 BOOST_GEOMETRY_REGISTER_POINT_3D(Star::Vector3f, float, boost::geometry::cs::cartesian, x(), y(), z())
 
@@ -34,4 +35,13 @@ using Box3f = boost::geometry::model::box<Point3f>;
 using Polygon3f = boost::geometry::model::polygon<Point3f, false, true>;
 using Linestring3f = boost::geometry::model::linestring<Point3f>;
 
+// boxes of geometry algorithms, runtime bounds are Aabb3f
+inline Aabb3f toAabb3f(const Box3f& box) noexcept {
+    return Aabb3f(box.min_corner(), box.max_corner());
+}
+
+inline Box3f toBox3f(const Aabb3f& box) noexcept {
+    return Box3f(box.lower(), box.upper());
+}
+
 }
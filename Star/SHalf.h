@@ -18,9 +18,43 @@
 #pragma once
 #include <Eigen/Core>
 #include <Eigen/src/Core/arch/CUDA/Half.h>
+#include <gsl/span>
+#include <gsl/gsl_assert>
+#include <immintrin.h>
 
 namespace Star {
 
 using Eigen::half;
 
+// bulk conversions, eight values per F16C instruction, the tail and non-AVX2 builds are scalar
+inline void convertFloatToHalf(gsl::span<const float> src, gsl::span<half> dst) noexcept {
+    Expects(src.size() == dst.size());
+    const size_t count = src.size();
+    size_t i = 0;
+#ifdef __AVX2__
+    for (; i + 8 <= count; i += 8) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst.data() + i),
+            _mm256_cvtps_ph(_mm256_loadu_ps(src.data() + i), _MM_FROUND_TO_NEAREST_INT));
+    }
+#endif
+    for (; i != count; ++i) {
+        dst[i] = half(src[i]);
+    }
+}
+
+inline void convertHalfToFloat(gsl::span<const half> src, gsl::span<float> dst) noexcept {
+    Expects(src.size() == dst.size());
+    const size_t count = src.size();
+    size_t i = 0;
+#ifdef __AVX2__
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(dst.data() + i,
+            _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src.data() + i))));
+    }
+#endif
+    for (; i != count; ++i) {
+        dst[i] = static_cast<float>(src[i]);
+    }
+}
+
 }
@@ -0,0 +1,396 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+#include <Star/SLockFree.h>
+#include <Star/SScopeExit.h>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace Star {
+
+// bounded Chase-Lev deque, the owner pushes and pops at the bottom, thieves steal at the top
+// https://www.di.ens.fr/~zappa/readings/ppopp13.pdf
+template<class T>
+class WorkStealingDeque {
+public:
+    explicit WorkStealingDeque(size_t capacity)
+        : mBuffer(std::make_unique<std::atomic<T*>[]>(capacity))
+        , mMask(static_cast<int64_t>(capacity) - 1)
+    {
+        Expects(capacity && (capacity & (capacity - 1)) == 0);
+    }
+
+    // owner thread only, returns false when full
+    bool push(T* item) noexcept {
+        auto b = mBottom.load(std::memory_order_relaxed);
+        auto t = mTop.load(std::memory_order_acquire);
+        if (b - t > mMask)
+            return false;
+        mBuffer[b & mMask].store(item, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        mBottom.store(b + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // owner thread only
+    T* pop() noexcept {
+        auto b = mBottom.load(std::memory_order_relaxed) - 1;
+        mBottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto t = mTop.load(std::memory_order_relaxed);
+        if (t > b) {
+            mBottom.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        T* item = mBuffer[b & mMask].load(std::memory_order_relaxed);
+        if (t == b) {
+            // last item, race against thieves
+            if (!mTop.compare_exchange_strong(t, t + 1,
+                std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                item = nullptr;
+            }
+            mBottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+
+    // any thread
+    T* steal() noexcept {
+        auto t = mTop.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto b = mBottom.load(std::memory_order_acquire);
+        if (t >= b)
+            return nullptr;
+        T* item = mBuffer[t & mMask].load(std::memory_order_relaxed);
+        if (!mTop.compare_exchange_strong(t, t + 1,
+            std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return item;
+    }
+private:
+    std::unique_ptr<std::atomic<T*>[]> mBuffer;
+    int64_t mMask = 0;
+    alignas(64) std::atomic_int64_t mTop = 0;
+    alignas(64) std::atomic_int64_t mBottom = 0;
+};
+
+// a job finishes when its function and all its children have finished,
+// the closure is stored inline, no allocation per job
+struct alignas(64) Job {
+    using Function = void(*)(Job&);
+
+    Function mFunction = nullptr;
+    Job* mParent = nullptr;
+    std::atomic_int32_t mUnfinished = 0;
+    std::atomic_bool mFailed = false;
+    std::exception_ptr mException;
+    alignas(16) std::byte mStorage[64];
+
+    bool finished() const noexcept {
+        return mUnfinished.load(std::memory_order_acquire) == 0;
+    }
+
+    void fail(std::exception_ptr e) noexcept {
+        if (!mFailed.exchange(true, std::memory_order_relaxed))
+            mException = std::move(e);
+    }
+};
+
+// work-stealing scheduler, one deque per worker thread,
+// external threads submit to a shared queue and help while waiting
+class JobSystem {
+    struct alignas(64) Worker {
+        explicit Worker(size_t capacity)
+            : mDeque(capacity)
+        {}
+        WorkStealingDeque<Job> mDeque;
+        std::thread::id mThreadID;
+        std::thread mThread;
+    };
+public:
+    // jobs in flight must stay below capacity, slots are recycled in a ring
+    JobSystem(uint32_t numThreads, uint32_t capacity = 4096,
+        std::function<void(uint32_t)> onThreadStart = {})
+        : mJobs(std::make_unique<Job[]>(capacity))
+        , mMask(capacity - 1)
+        , mInjected(capacity)
+    {
+        Expects(numThreads);
+        Expects(capacity && (capacity & (capacity - 1)) == 0);
+
+        mWorkers.reserve(numThreads);
+        for (uint32_t i = 0; i != numThreads; ++i) {
+            mWorkers.emplace_back(std::make_unique<Worker>(capacity));
+        }
+        std::atomic_uint32_t started = 0;
+        for (uint32_t i = 0; i != numThreads; ++i) {
+            mWorkers[i]->mThread = std::thread([this, i, &started, onThreadStart]() {
+                mWorkers[i]->mThreadID = std::this_thread::get_id();
+                if (onThreadStart)
+                    onThreadStart(i);
+                started.fetch_add(1, std::memory_order_release);
+                while (!mStopped.load(std::memory_order_acquire)) {
+                    if (auto* pJob = findJob(i)) {
+                        execute(*pJob);
+                    } else {
+                        idle();
+                    }
+                }
+            });
+        }
+        // worker ids are read without locking afterwards
+        while (started.load(std::memory_order_acquire) != numThreads) {
+            std::this_thread::yield();
+        }
+    }
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    ~JobSystem() noexcept {
+        mStopped.store(true, std::memory_order_release);
+        mCondition.notify_all();
+        for (auto& pWorker : mWorkers) {
+            pWorker->mThread.join();
+        }
+    }
+
+    uint32_t threadCount() const noexcept {
+        return gsl::narrow_cast<uint32_t>(mWorkers.size());
+    }
+
+    template<class F>
+    Job& create(F&& f, Job* parent = nullptr) {
+        using Closure = std::decay_t<F>;
+        static_assert(sizeof(Closure) <= sizeof(Job::mStorage), "job closure too large");
+        static_assert(alignof(Closure) <= alignof(std::max_align_t), "job closure over aligned");
+
+        auto& job = mJobs[mNextJob.fetch_add(1, std::memory_order_relaxed) & mMask];
+        Expects(job.finished());
+        job.mParent = parent;
+        job.mFailed.store(false, std::memory_order_relaxed);
+        job.mException = nullptr;
+        job.mUnfinished.store(1, std::memory_order_relaxed);
+        if (parent) {
+            parent->mUnfinished.fetch_add(1, std::memory_order_relaxed);
+        }
+        new (job.mStorage) Closure(std::forward<F>(f));
+        job.mFunction = [](Job& self) {
+            auto& closure = *std::launder(reinterpret_cast<Closure*>(self.mStorage));
+            ON_SCOPE_EXIT(destroy, [&closure]() { closure.~Closure(); });
+            closure();
+        };
+        return job;
+    }
+
+    void run(Job& job) noexcept {
+        auto workerID = getWorkerID();
+        bool pushed = workerID != sInvalidWorker
+            ? mWorkers[workerID]->mDeque.push(&job)
+            : mInjected.push(&job);
+        if (!pushed) {
+            // queue full, run inline
+            execute(job);
+            return;
+        }
+        if (mSleeping.load(std::memory_order_relaxed)) {
+            mCondition.notify_one();
+        }
+    }
+
+    // executes other jobs until the job and its children are finished,
+    // rethrows the first exception of the job tree
+    void wait(Job& job) {
+        auto workerID = getWorkerID();
+        while (!job.finished()) {
+            if (auto* pJob = findJob(workerID)) {
+                execute(*pJob);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        if (job.mException) {
+            std::rethrow_exception(job.mException);
+        }
+    }
+
+    // f(begin, end) on sub ranges of at most grain elements, the caller takes part
+    template<class F>
+    void parallel_for(size_t begin, size_t end, size_t grain, const F& f) {
+        Expects(grain);
+        if (end <= begin)
+            return;
+        if (end - begin <= grain) {
+            f(begin, end);
+            return;
+        }
+        auto& root = create([]() {});
+        for (size_t first = begin; first < end; first += grain) {
+            run(create([&f, first, last = std::min(first + grain, end)]() {
+                f(first, last);
+            }, &root));
+        }
+        run(root);
+        wait(root);
+    }
+private:
+    static constexpr uint32_t sInvalidWorker = std::numeric_limits<uint32_t>::max();
+
+    // header only, so a thread_local would be duplicated per module
+    uint32_t getWorkerID() const noexcept {
+        const auto id = std::this_thread::get_id();
+        for (uint32_t i = 0; i != mWorkers.size(); ++i) {
+            if (mWorkers[i]->mThreadID == id)
+                return i;
+        }
+        return sInvalidWorker;
+    }
+
+    Job* findJob(uint32_t workerID) noexcept {
+        if (workerID != sInvalidWorker) {
+            if (auto* pJob = mWorkers[workerID]->mDeque.pop())
+                return pJob;
+        }
+        Job* pJob = nullptr;
+        if (mInjected.pop(pJob))
+            return pJob;
+
+        const auto count = gsl::narrow_cast<uint32_t>(mWorkers.size());
+        const auto start = workerID != sInvalidWorker ? workerID + 1 : 0;
+        for (uint32_t i = 0; i != count; ++i) {
+            auto victim = (start + i) % count;
+            if (victim == workerID)
+                continue;
+            if (auto* pJob = mWorkers[victim]->mDeque.steal())
+                return pJob;
+        }
+        return nullptr;
+    }
+
+    void execute(Job& job) noexcept {
+        try {
+            job.mFunction(job);
+        } catch (...) {
+            job.fail(std::current_exception());
+        }
+        finish(job);
+    }
+
+    void finish(Job& job) noexcept {
+        // children still running may write the exception,
+        // so it is forwarded once the whole subtree has finished
+        auto* parent = job.mParent;
+        if (job.mUnfinished.fetch_sub(1, std::memory_order_acq_rel) == 1 && parent) {
+            if (job.mFailed.load(std::memory_order_relaxed)) {
+                parent->fail(job.mException);
+            }
+            finish(*parent);
+        }
+    }
+
+    void idle() {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mSleeping.fetch_add(1, std::memory_order_relaxed);
+        // timeout covers wake ups missed between findJob and wait
+        mCondition.wait_for(lock, std::chrono::milliseconds(1));
+        mSleeping.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    std::unique_ptr<Job[]> mJobs;
+    uint64_t mMask = 0;
+    std::atomic_uint64_t mNextJob = 0;
+    std::vector<std::unique_ptr<Worker>> mWorkers;
+    RingQueue<Job*> mInjected;
+    std::atomic_bool mStopped = false;
+    std::atomic_uint32_t mSleeping = 0;
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+};
+
+// static dependency graph, built once and run many times,
+// a node is spawned as a job when its last predecessor finishes
+class JobGraph {
+public:
+    using NodeID = uint32_t;
+
+    bool empty() const noexcept {
+        return mNodes.empty();
+    }
+
+    void clear() noexcept {
+        mNodes.clear();
+    }
+
+    template<class F>
+    NodeID add(F&& f) {
+        auto id = gsl::narrow_cast<NodeID>(mNodes.size());
+        mNodes.emplace_back(Node{ std::forward<F>(f) });
+        return id;
+    }
+
+    void precede(NodeID before, NodeID after) {
+        Expects(before < mNodes.size() && after < mNodes.size());
+        mNodes[before].mSuccessors.emplace_back(after);
+        ++mNodes[after].mPredecessors;
+    }
+
+    // no allocation unless nodes were added since the last run
+    void run(JobSystem& jobs) {
+        if (mPendingSize != mNodes.size()) {
+            mPending = std::make_unique<std::atomic_uint32_t[]>(mNodes.size());
+            mPendingSize = mNodes.size();
+        }
+        for (size_t i = 0; i != mNodes.size(); ++i) {
+            mPending[i].store(mNodes[i].mPredecessors, std::memory_order_relaxed);
+        }
+        auto& root = jobs.create([]() {});
+        for (NodeID i = 0; i != mNodes.size(); ++i) {
+            if (!mNodes[i].mPredecessors)
+                spawn(jobs, root, i);
+        }
+        jobs.run(root);
+        jobs.wait(root);
+    }
+private:
+    struct Node {
+        std::function<void()> mFunction;
+        std::vector<NodeID> mSuccessors;
+        uint32_t mPredecessors = 0;
+    };
+
+    // successors are children of the root, spawned before the node finishes
+    void spawn(JobSystem& jobs, Job& root, NodeID id) {
+        jobs.run(jobs.create([this, &jobs, &root, id]() {
+            const auto& node = mNodes[id];
+            node.mFunction();
+            for (auto next : node.mSuccessors) {
+                if (mPending[next].fetch_sub(1, std::memory_order_acq_rel) == 1)
+                    spawn(jobs, root, next);
+            }
+        }, &root));
+    }
+
+    std::vector<Node> mNodes;
+    std::unique_ptr<std::atomic_uint32_t[]> mPending;
+    size_t mPendingSize = 0;
+};
+
+}
@@ -18,6 +18,7 @@
 #pragma once
 #include <boost/lockfree/queue.hpp>
 #include <boost/align/aligned_allocator.hpp>
+#include <atomic>
 
 namespace Star {
 
@@ -29,4 +30,124 @@ template<typename T, typename... Options>
 using pmr_lockfree_queue = boost::lockfree::queue<T, Options...,
     boost::lockfree::allocator<std::pmr::polymorphic_allocator<T>>>;
 
+// bounded mpmc queue, one sequence number per cell, no freelist and no tagging
+// http://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+template<class T>
+class RingQueue {
+    struct Cell {
+        std::atomic_size_t mSequence;
+        T mData;
+    };
+public:
+    // capacity is rounded up to a power of 2
+    explicit RingQueue(size_t capacity)
+        : mCapacity(getCapacity(capacity))
+        , mMask(mCapacity - 1)
+        , mCells(std::make_unique<Cell[]>(mCapacity))
+    {
+        for (size_t i = 0; i != mCapacity; ++i) {
+            mCells[i].mSequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    RingQueue(const RingQueue&) = delete;
+    RingQueue& operator=(const RingQueue&) = delete;
+
+    size_t capacity() const noexcept {
+        return mCapacity;
+    }
+
+    // false if full
+    bool push(const T& v) noexcept {
+        return push(&v, 1) == 1;
+    }
+
+    // false if empty
+    bool pop(T& v) noexcept {
+        return pop(&v, 1) == 1;
+    }
+
+    // pushes a prefix of items in order, returns its size
+    size_t push(const T* items, size_t count) noexcept {
+        auto pos = mEnqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            auto n = countCells(pos, count, 0);
+            if (!n) {
+                if (mCells[pos & mMask].mSequence.load(std::memory_order_acquire) < pos)
+                    return 0; // full
+                pos = mEnqueuePos.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (mEnqueuePos.compare_exchange_weak(pos, pos + n, std::memory_order_relaxed)) {
+                for (size_t i = 0; i != n; ++i) {
+                    auto& cell = mCells[(pos + i) & mMask];
+                    cell.mData = items[i];
+                    cell.mSequence.store(pos + i + 1, std::memory_order_release);
+                }
+                return n;
+            }
+        }
+    }
+
+    // pops up to count items in order, returns their number
+    size_t pop(T* items, size_t count) noexcept {
+        auto pos = mDequeuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            auto n = countCells(pos, count, 1);
+            if (!n) {
+                if (mCells[pos & mMask].mSequence.load(std::memory_order_acquire) < pos + 1)
+                    return 0; // empty
+                pos = mDequeuePos.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (mDequeuePos.compare_exchange_weak(pos, pos + n, std::memory_order_relaxed)) {
+                for (size_t i = 0; i != n; ++i) {
+                    auto& cell = mCells[(pos + i) & mMask];
+                    items[i] = std::move(cell.mData);
+                    cell.mSequence.store(pos + i + mCapacity, std::memory_order_release);
+                }
+                return n;
+            }
+        }
+    }
+
+    // same interface as boost::lockfree::queue, popped in batches
+    template<class F>
+    size_t consume_all(F&& f) {
+        std::array<T, 16> batch;
+        size_t total = 0;
+        while (auto n = pop(batch.data(), batch.size())) {
+            for (size_t i = 0; i != n; ++i) {
+                f(batch[i]);
+            }
+            total += n;
+        }
+        return total;
+    }
+private:
+    static size_t getCapacity(size_t capacity) noexcept {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        return size;
+    }
+
+    // consecutive cells ready at pos, offset 0 for writers and 1 for readers
+    size_t countCells(size_t pos, size_t count, size_t offset) const noexcept {
+        count = std::min(count, mCapacity);
+        size_t n = 0;
+        while (n != count && mCells[(pos + n) & mMask].mSequence.load(std::memory_order_acquire) == pos + n + offset) {
+            ++n;
+        }
+        return n;
+    }
+
+    const size_t mCapacity;
+    const size_t mMask;
+    std::unique_ptr<Cell[]> mCells;
+    alignas(64) std::atomic_size_t mEnqueuePos = 0;
+    alignas(64) std::atomic_size_t mDequeuePos = 0;
+};
+
 }
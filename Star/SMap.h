@@ -17,6 +17,9 @@
 
 #pragma once
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <Star/SMetaID.h>
 
 // for std::less<> the transparent comparator
 // see https://stackoverflow.com/questions/20317413/what-are-transparent-comparators
@@ -29,6 +32,14 @@ using Map = std::map<Key, Value, std::less<>>;
 template<class Key, class Value>
 using PmrMap = std::pmr::map<Key, Value, std::less<>>;
 
+template<class Value>
+using MetaIDUnorderedMap = std::unordered_map<MetaID, Value, MetaIDHash, MetaIDEqual>;
+
+template<class Value>
+using PmrMetaIDUnorderedMap = std::pmr::unordered_map<MetaID, Value, MetaIDHash, MetaIDEqual>;
+
+using MetaIDUnorderedSet = std::unordered_set<MetaID, MetaIDHash, MetaIDEqual>;
+
 // variant
 struct VariantIndexLess;
 
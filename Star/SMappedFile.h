@@ -0,0 +1,108 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <filesystem>
+#include <stdexcept>
+
+namespace Star {
+
+// read-only view of a whole file, pages are read on first access
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::filesystem::path& file) {
+        mFile = CreateFileW(file.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (mFile == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error("open mapped file failed: " + file.string());
+        }
+        LARGE_INTEGER size{};
+        if (!GetFileSizeEx(mFile, &size)) {
+            close();
+            throw std::runtime_error("get mapped file size failed: " + file.string());
+        }
+        mSize = static_cast<size_t>(size.QuadPart);
+        if (mSize == 0) {
+            return;
+        }
+        mMapping = CreateFileMappingW(mFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mMapping) {
+            close();
+            throw std::runtime_error("create file mapping failed: " + file.string());
+        }
+        mData = static_cast<const std::byte*>(MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0));
+        if (!mData) {
+            close();
+            throw std::runtime_error("map view of file failed: " + file.string());
+        }
+    }
+    MappedFile(MappedFile&& rhs) noexcept
+        : mFile(std::exchange(rhs.mFile, INVALID_HANDLE_VALUE))
+        , mMapping(std::exchange(rhs.mMapping, nullptr))
+        , mData(std::exchange(rhs.mData, nullptr))
+        , mSize(std::exchange(rhs.mSize, 0))
+    {}
+    MappedFile& operator=(MappedFile&& rhs) noexcept {
+        if (this != &rhs) {
+            close();
+            mFile = std::exchange(rhs.mFile, INVALID_HANDLE_VALUE);
+            mMapping = std::exchange(rhs.mMapping, nullptr);
+            mData = std::exchange(rhs.mData, nullptr);
+            mSize = std::exchange(rhs.mSize, 0);
+        }
+        return *this;
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() {
+        close();
+    }
+
+    const std::byte* data() const noexcept {
+        return mData;
+    }
+    size_t size() const noexcept {
+        return mSize;
+    }
+    bool empty() const noexcept {
+        return mSize == 0;
+    }
+private:
+    void close() noexcept {
+        if (mData) {
+            UnmapViewOfFile(mData);
+            mData = nullptr;
+        }
+        if (mMapping) {
+            CloseHandle(mMapping);
+            mMapping = nullptr;
+        }
+        if (mFile != INVALID_HANDLE_VALUE) {
+            CloseHandle(mFile);
+            mFile = INVALID_HANDLE_VALUE;
+        }
+        mSize = 0;
+    }
+
+    HANDLE mFile = INVALID_HANDLE_VALUE;
+    HANDLE mMapping = nullptr;
+    const std::byte* mData = nullptr;
+    size_t mSize = 0;
+};
+
+}
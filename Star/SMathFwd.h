@@ -618,6 +618,8 @@ using Unorm3 = Eigen::Matrix<uint8_t, 3, 1>;
 using Unorm2 = Eigen::Matrix<uint8_t, 2, 1>;
 using Unorm1 = Eigen::Matrix<uint8_t, 1, 1>;
 
+using Snorm4 = Eigen::Matrix<int8_t, 4, 1>;
+
 using Snorm4 = Eigen::Matrix<int8_t, 4, 1>;
 using Snorm3 = Eigen::Matrix<int8_t, 3, 1>;
 using Snorm2 = Eigen::Matrix<int8_t, 2, 1>;
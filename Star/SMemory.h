@@ -17,6 +17,13 @@
 
 #pragma once
 #include <memory>
+#include <memory_resource>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <ostream>
+#include <algorithm>
 
 namespace Star {
 
@@ -117,6 +124,45 @@ private:
     size_t mCount;
 };
 
+// polymorphic_allocator that default-initializes elements constructed without arguments,
+// resize() of trivial elements leaves the new storage uninitialized
+template<class T>
+class default_init_allocator : public std::pmr::polymorphic_allocator<T> {
+public:
+    using base_type = std::pmr::polymorphic_allocator<T>;
+
+    template<class U>
+    struct rebind {
+        using other = default_init_allocator<U>;
+    };
+
+    default_init_allocator() noexcept = default;
+
+    default_init_allocator(std::pmr::memory_resource* res) noexcept
+        : base_type(res) {}
+
+    template<class U>
+    default_init_allocator(const std::pmr::polymorphic_allocator<U>& rhs) noexcept
+        : base_type(rhs.resource()) {}
+
+    template<class U>
+    void construct(U* p) noexcept(std::is_nothrow_default_constructible_v<U>) {
+        ::new(static_cast<void*>(p)) U;
+    }
+
+    template<class U, class... Args>
+    void construct(U* p, Args&&... args) {
+        base_type::construct(p, std::forward<Args>(args)...);
+    }
+
+    default_init_allocator select_on_container_copy_construction() const noexcept {
+        return default_init_allocator();
+    }
+};
+
+template<class T>
+using default_init_vector = std::vector<T, default_init_allocator<T>>;
+
 template<class T>
 using pmr_unique_ptr = std::unique_ptr<T, Star::polymorphic_delete<T>>;
 
@@ -134,6 +180,204 @@ inline pmr_unique_ptr<T> pmr_make_unique(std::pmr::memory_resource* mr, Args&&..
     return pmr_unique_ptr<T>{ hold.release(), std::move(deleter) };
 }
 
+// forwards to upstream and counts bytes, allocations and peak bytes of a subsystem.
+// counts are added to every parent, so a parent reports the sum of its children and its own use
+class TrackingMemoryResource : public std::pmr::memory_resource {
+public:
+    struct Stats {
+        size_t mBytes = 0;
+        size_t mPeakBytes = 0;
+        size_t mAllocations = 0;
+        size_t mTotalAllocations = 0;
+    };
+
+    TrackingMemoryResource(std::string_view name, std::pmr::memory_resource* upstream,
+        TrackingMemoryResource* parent = nullptr)
+        : mName(name)
+        , mUpstream(upstream)
+        , mParent(parent)
+    {
+        Expects(mUpstream);
+        if (mParent) {
+            std::lock_guard<std::mutex> lock(mParent->mChildMutex);
+            mParent->mChildren.emplace_back(this);
+        }
+    }
+
+    TrackingMemoryResource(const TrackingMemoryResource&) = delete;
+    TrackingMemoryResource& operator=(const TrackingMemoryResource&) = delete;
+
+    ~TrackingMemoryResource() {
+        if (mParent) {
+            std::lock_guard<std::mutex> lock(mParent->mChildMutex);
+            auto& children = mParent->mChildren;
+            children.erase(std::remove(children.begin(), children.end(), this), children.end());
+        }
+    }
+
+    const std::string& name() const noexcept {
+        return mName;
+    }
+
+    Stats stats() const noexcept {
+        return Stats{
+            mBytes.load(std::memory_order_relaxed),
+            mPeakBytes.load(std::memory_order_relaxed),
+            mAllocations.load(std::memory_order_relaxed),
+            mTotalAllocations.load(std::memory_order_relaxed),
+        };
+    }
+
+    // writes "Engine/Persistent/Meshes: 412 MB, peak 530 MB, 1024 allocations" for this and every child
+    void writeReport(std::ostream& os, std::string_view prefix = {}) const {
+        std::string path(prefix);
+        if (!path.empty()) {
+            path += '/';
+        }
+        path += mName;
+
+        auto s = stats();
+        os << path << ": " << formatBytes(s.mBytes) << ", peak " << formatBytes(s.mPeakBytes)
+            << ", " << s.mAllocations << " allocations, " << s.mTotalAllocations << " total\n";
+
+        std::lock_guard<std::mutex> lock(mChildMutex);
+        for (const auto* child : mChildren) {
+            child->writeReport(os, path);
+        }
+    }
+private:
+    static std::string formatBytes(size_t bytes) {
+        if (bytes >= 1024 * 1024) {
+            return std::to_string(bytes / (1024 * 1024)) + " MB";
+        }
+        if (bytes >= 1024) {
+            return std::to_string(bytes / 1024) + " KB";
+        }
+        return std::to_string(bytes) + " B";
+    }
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        auto* p = mUpstream->allocate(bytes, alignment);
+        for (auto* node = this; node; node = node->mParent) {
+            node->add(bytes);
+        }
+        return p;
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        mUpstream->deallocate(p, bytes, alignment);
+        for (auto* node = this; node; node = node->mParent) {
+            node->mBytes.fetch_sub(bytes, std::memory_order_relaxed);
+            node->mAllocations.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& rhs) const noexcept override {
+        return this == &rhs;
+    }
+
+    void add(size_t bytes) noexcept {
+        auto current = mBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        mAllocations.fetch_add(1, std::memory_order_relaxed);
+        mTotalAllocations.fetch_add(1, std::memory_order_relaxed);
+        auto peak = mPeakBytes.load(std::memory_order_relaxed);
+        while (current > peak && !mPeakBytes.compare_exchange_weak(peak, current, std::memory_order_relaxed)) {
+        }
+    }
+
+    std::string mName;
+    std::pmr::memory_resource* mUpstream = nullptr;
+    TrackingMemoryResource* mParent = nullptr;
+
+    std::atomic<size_t> mBytes = 0;
+    std::atomic<size_t> mPeakBytes = 0;
+    std::atomic<size_t> mAllocations = 0;
+    std::atomic<size_t> mTotalAllocations = 0;
+
+    mutable std::mutex mChildMutex;
+    std::vector<TrackingMemoryResource*> mChildren;
+};
+
+// pages of the os for large long-lived arenas, e.g. content or asset build scratch, are 2 MB when
+// large pages are available, fewer tlb entries cover buffers iterated every frame.
+// every allocation takes whole pages, use it as upstream of a pool or monotonic resource.
+// large pages need SeLockMemoryPrivilege and contiguous physical memory, allocations fall back to
+// normal pages without them. pages are committed on numaNode if set, on any node otherwise
+class LargePageMemoryResource : public std::pmr::memory_resource {
+public:
+    explicit LargePageMemoryResource(DWORD numaNode = NUMA_NO_PREFERRED_NODE) noexcept
+        : mNumaNode(numaNode)
+    {
+        mLargePageSize = enableLockMemoryPrivilege() ? GetLargePageMinimum() : 0;
+    }
+
+    LargePageMemoryResource(const LargePageMemoryResource&) = delete;
+    LargePageMemoryResource& operator=(const LargePageMemoryResource&) = delete;
+
+    // 0 if large pages are not available to the process
+    size_t largePageSize() const noexcept {
+        return mLargePageSize;
+    }
+    // allocations so far on large pages and on normal pages
+    size_t largePageAllocations() const noexcept {
+        return mLargePageAllocations.load(std::memory_order_relaxed);
+    }
+    size_t fallbackAllocations() const noexcept {
+        return mFallbackAllocations.load(std::memory_order_relaxed);
+    }
+private:
+    static bool enableLockMemoryPrivilege() noexcept {
+        HANDLE token = nullptr;
+        if (!OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token))
+            return false;
+        TOKEN_PRIVILEGES privileges{};
+        privileges.PrivilegeCount = 1;
+        privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+        bool enabled = LookupPrivilegeValueW(nullptr, SE_LOCK_MEMORY_NAME, &privileges.Privileges[0].Luid)
+            && AdjustTokenPrivileges(token, FALSE, &privileges, 0, nullptr, nullptr)
+            && GetLastError() == ERROR_SUCCESS; // not all assigned if the account lacks the privilege
+        CloseHandle(token);
+        return enabled;
+    }
+
+    void* commit(size_t bytes, DWORD type) noexcept {
+        return VirtualAllocExNuma(GetCurrentProcess(), nullptr, bytes,
+            MEM_RESERVE | MEM_COMMIT | type, PAGE_READWRITE, mNumaNode);
+    }
+
+    // allocations under half a large page would waste most of it, they take normal pages
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        // VirtualAlloc returns addresses aligned to the allocation granularity, at least 64 KB
+        Expects(alignment <= 64 * 1024);
+        if (mLargePageSize && bytes >= mLargePageSize / 2) {
+            const size_t size = (bytes + mLargePageSize - 1) / mLargePageSize * mLargePageSize;
+            if (auto* p = commit(size, MEM_LARGE_PAGES)) {
+                mLargePageAllocations.fetch_add(1, std::memory_order_relaxed);
+                return p;
+            }
+        }
+        auto* p = commit(bytes, 0);
+        if (!p) {
+            throw std::bad_alloc();
+        }
+        mFallbackAllocations.fetch_add(1, std::memory_order_relaxed);
+        return p;
+    }
+
+    void do_deallocate(void* p, size_t /*bytes*/, size_t /*alignment*/) override {
+        VirtualFree(p, 0, MEM_RELEASE);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& rhs) const noexcept override {
+        return this == &rhs;
+    }
+
+    DWORD mNumaNode = NUMA_NO_PREFERRED_NODE;
+    size_t mLargePageSize = 0;
+    std::atomic<size_t> mLargePageAllocations = 0;
+    std::atomic<size_t> mFallbackAllocations = 0;
+};
+
 inline std::unique_ptr<char[], polymorphic_delete<char[]>>
 pmr_allocate_buffer(std::pmr::memory_resource* mr, size_t count) {
     using traits = std::allocator_traits<std::pmr::polymorphic_allocator<char>>;
@@ -18,9 +18,31 @@
 #pragma once
 #include <boost/uuid/uuid.hpp>
 #include <boost/uuid/uuid_hash.hpp>
+#include <cstring>
+#include <emmintrin.h>
 
 namespace Star {
 
 using MetaID = boost::uuids::uuid;
 
+// uuids are already random, fold the two halves instead of combining byte by byte
+struct MetaIDHash {
+    size_t operator()(const MetaID& id) const noexcept {
+        static_assert(sizeof(MetaID) == 16);
+        uint64_t lo, hi;
+        std::memcpy(&lo, id.data, sizeof(lo));
+        std::memcpy(&hi, id.data + sizeof(lo), sizeof(hi));
+        // version and variant bits sit in fixed positions, multiply spreads them over the bucket bits
+        return static_cast<size_t>((lo ^ hi) * 0x9E3779B97F4A7C15ull);
+    }
+};
+
+struct MetaIDEqual {
+    bool operator()(const MetaID& lhs, const MetaID& rhs) const noexcept {
+        auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs.data));
+        auto b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs.data));
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) == 0xFFFF;
+    }
+};
+
 }
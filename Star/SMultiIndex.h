@@ -134,7 +134,8 @@ using MetaIDNameIndex = boost::multi_index::multi_index_container<T,
     boost::multi_index::indexed_by<
         boost::multi_index::hashed_unique<
             boost::multi_index::tag<Index::MetaID>,
-            boost::multi_index::member<T, MetaID, &T::mMetaID>
+            boost::multi_index::member<T, MetaID, &T::mMetaID>,
+            MetaIDHash, MetaIDEqual
         >,
         boost::multi_index::ordered_unique<
             boost::multi_index::tag<Index::Name>,
@@ -149,7 +150,8 @@ using MetaIDNameMultiIndex = boost::multi_index::multi_index_container<T,
     boost::multi_index::indexed_by<
         boost::multi_index::hashed_unique<
             boost::multi_index::tag<Index::MetaID>,
-            boost::multi_index::member<T, MetaID, &T::mMetaID>
+            boost::multi_index::member<T, MetaID, &T::mMetaID>,
+            MetaIDHash, MetaIDEqual
         >,
         boost::multi_index::ordered_non_unique<
             boost::multi_index::tag<Index::Name>,
@@ -164,7 +166,8 @@ using PmrNameMetaIDIndex = boost::multi_index::multi_index_container<T,
     boost::multi_index::indexed_by<
         boost::multi_index::hashed_unique<
             boost::multi_index::tag<Index::MetaID>,
-            boost::multi_index::member<T, MetaID, &T::mMetaID>
+            boost::multi_index::member<T, MetaID, &T::mMetaID>,
+            MetaIDHash, MetaIDEqual
         >,
         boost::multi_index::ordered_unique<
             boost::multi_index::tag<Index::Name>,
@@ -180,7 +183,8 @@ using MetaIDIndex = boost::multi_index::multi_index_container<T,
     boost::multi_index::indexed_by<
         boost::multi_index::hashed_unique<
             boost::multi_index::tag<Index::MetaID>,
-            boost::multi_index::member<T, MetaID, &T::mMetaID>
+            boost::multi_index::member<T, MetaID, &T::mMetaID>,
+            MetaIDHash, MetaIDEqual
         >
     >
 >;
@@ -190,7 +194,8 @@ using PmrMetaIDIndex = boost::multi_index::multi_index_container<T,
     boost::multi_index::indexed_by<
         boost::multi_index::hashed_unique<
             boost::multi_index::tag<Index::MetaID>,
-            boost::multi_index::member<T, MetaID, &T::mMetaID>
+            boost::multi_index::member<T, MetaID, &T::mMetaID>,
+            MetaIDHash, MetaIDEqual
         >
     >,
     std::pmr::polymorphic_allocator<T>
@@ -201,7 +206,8 @@ using MetaIDHashMap = boost::multi_index::multi_index_container<T,
     boost::multi_index::indexed_by<
         boost::multi_index::hashed_unique<
             boost::multi_index::tag<Index::MetaID>,
-            boost::multi_index::const_mem_fun<T, const boost::uuids::uuid&, &T::metaID>
+            boost::multi_index::const_mem_fun<T, const boost::uuids::uuid&, &T::metaID>,
+            MetaIDHash, MetaIDEqual
         >
     >
 >;
@@ -211,7 +217,8 @@ using PmrMetaIDHashMap = boost::multi_index::multi_index_container<T,
     boost::multi_index::indexed_by<
         boost::multi_index::hashed_unique<
             boost::multi_index::tag<Index::MetaID>,
-            boost::multi_index::const_mem_fun<T, const boost::uuids::uuid&, &T::metaID>
+            boost::multi_index::const_mem_fun<T, const boost::uuids::uuid&, &T::metaID>,
+            MetaIDHash, MetaIDEqual
         >
     >,
     std::pmr::polymorphic_allocator<T>
@@ -222,7 +229,8 @@ using PmrMetaIDHashListIndex = boost::multi_index::multi_index_container<T,
     boost::multi_index::indexed_by<
         boost::multi_index::hashed_unique<
             boost::multi_index::tag<Index::MetaID>,
-            boost::multi_index::member<T, MetaID, &T::mMetaID>
+            boost::multi_index::member<T, MetaID, &T::mMetaID>,
+            MetaIDHash, MetaIDEqual
         >,
         boost::multi_index::sequenced<>
     >,
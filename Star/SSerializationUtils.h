@@ -18,6 +18,7 @@
 #pragma once
 #include <boost/serialization/level.hpp>
 #include <boost/serialization/tracking.hpp>
+#include <boost/serialization/is_bitwise_serializable.hpp>
 
 #define STAR_SERIALIZATION_SPLIT_FREE(T)       \
 template<class Archive>                         \
@@ -70,6 +71,14 @@ void serialize(Archive& ar, T& v, const uint32_t version) {\
     ar & make_binary_object(&v, sizeof(v));\
 }
 
+// arrays of T are read and written as one block by binary archives instead of element by element,
+// the bytes of T are the format, serialize of a single T is unchanged
+#define STAR_CLASS_BITWISE(T) \
+template<> \
+struct is_bitwise_serializable< T > : mpl::true_ { \
+    static_assert(std::is_standard_layout_v<T>); \
+};
+
 #define STAR_SERIALIZE_TAG(T) \
 STAR_CLASS_IMPLEMENTATION(T, object_serializable);\
 STAR_CLASS_TRACKING(T, track_never);\
@@ -0,0 +1,307 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <memory_resource>
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <gsl/gsl_assert>
+
+namespace Star {
+
+// 24 bit slot index and 8 bit generation, generations start at 1 so 0 is the null handle
+struct SlotHandle {
+    static constexpr uint32_t sIndexBits = 24;
+    static constexpr uint32_t sIndexMask = (1u << sIndexBits) - 1;
+
+    uint32_t index() const noexcept {
+        return mValue & sIndexMask;
+    }
+    uint32_t generation() const noexcept {
+        return mValue >> sIndexBits;
+    }
+    explicit operator bool() const noexcept {
+        return mValue != 0;
+    }
+    bool operator==(const SlotHandle& rhs) const noexcept {
+        return mValue == rhs.mValue;
+    }
+    bool operator!=(const SlotHandle& rhs) const noexcept {
+        return mValue != rhs.mValue;
+    }
+
+    uint32_t mValue = 0;
+};
+
+// generational slot map. elements are constructed with the map's allocator in pages of PageSize
+// and never move, so pointers to them stay valid until erased. erased slots are reused with the
+// next generation, stale handles are detected until the 8 bit generation wraps
+template<class T, size_t PageSize = 256>
+class SlotMap {
+    using element_allocator = std::pmr::polymorphic_allocator<T>;
+public:
+    using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+    allocator_type get_allocator() const noexcept {
+        return mPages.get_allocator();
+    }
+
+    template<class Value>
+    class basic_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Value*;
+        using reference = Value&;
+
+        basic_iterator() noexcept = default;
+        basic_iterator(Value* const* pPages, const uint8_t* pAlive, uint32_t index, uint32_t count) noexcept
+            : mPages(pPages), mAlive(pAlive), mIndex(index), mCount(count)
+        {
+            skip();
+        }
+
+        reference operator*() const noexcept {
+            return mPages[mIndex / PageSize][mIndex % PageSize];
+        }
+        pointer operator->() const noexcept {
+            return &**this;
+        }
+        basic_iterator& operator++() noexcept {
+            ++mIndex;
+            skip();
+            return *this;
+        }
+        basic_iterator operator++(int) noexcept {
+            auto tmp = *this;
+            ++*this;
+            return tmp;
+        }
+        bool operator==(const basic_iterator& rhs) const noexcept {
+            return mIndex == rhs.mIndex;
+        }
+        bool operator!=(const basic_iterator& rhs) const noexcept {
+            return mIndex != rhs.mIndex;
+        }
+    private:
+        void skip() noexcept {
+            while (mIndex != mCount && !mAlive[mIndex]) {
+                ++mIndex;
+            }
+        }
+
+        Value* const* mPages = nullptr;
+        const uint8_t* mAlive = nullptr;
+        uint32_t mIndex = 0;
+        uint32_t mCount = 0;
+    };
+
+    using iterator = basic_iterator<T>;
+    using const_iterator = basic_iterator<const T>;
+
+    SlotMap(const allocator_type& alloc) noexcept
+        : mPages(alloc)
+        , mGenerations(alloc)
+        , mAlive(alloc)
+        , mFreeSlots(alloc)
+    {}
+
+    SlotMap(const SlotMap& rhs, const allocator_type& alloc)
+        : SlotMap(alloc)
+    {
+        copyFrom(rhs);
+    }
+
+    SlotMap(SlotMap&& rhs, const allocator_type& alloc)
+        : SlotMap(alloc)
+    {
+        if (get_allocator() == rhs.get_allocator()) {
+            mPages.swap(rhs.mPages);
+            mGenerations.swap(rhs.mGenerations);
+            mAlive.swap(rhs.mAlive);
+            mFreeSlots.swap(rhs.mFreeSlots);
+            std::swap(mSize, rhs.mSize);
+        } else {
+            copyFrom(rhs);
+        }
+    }
+
+    SlotMap(const SlotMap&) = delete;
+    SlotMap& operator=(const SlotMap&) = delete;
+
+    ~SlotMap() {
+        clear();
+        element_allocator alloc(get_allocator());
+        for (auto* pPage : mPages) {
+            alloc.deallocate(pPage, PageSize);
+        }
+    }
+
+    template<class... Args>
+    SlotHandle emplace(Args&&... args) {
+        uint32_t index = 0;
+        if (mFreeSlots.empty()) {
+            index = gsl::narrow<uint32_t>(mGenerations.size());
+            if (index > SlotHandle::sIndexMask) {
+                throw std::length_error("slot map index out of range");
+            }
+            if (index / PageSize == mPages.size()) {
+                element_allocator alloc(get_allocator());
+                mPages.reserve(mPages.size() + 1);
+                mPages.emplace_back(alloc.allocate(PageSize));
+            }
+            // erase pushes without allocating
+            if (mFreeSlots.capacity() <= index) {
+                mFreeSlots.reserve(std::max<size_t>(index + 1, 2 * mFreeSlots.capacity()));
+            }
+            mGenerations.emplace_back(uint8_t(1));
+            mAlive.emplace_back(uint8_t(0));
+            try {
+                element_allocator(get_allocator()).construct(slot(index), std::forward<Args>(args)...);
+            } catch (...) {
+                mGenerations.pop_back();
+                mAlive.pop_back();
+                throw;
+            }
+            mAlive[index] = 1;
+        } else {
+            index = mFreeSlots.back();
+            element_allocator(get_allocator()).construct(slot(index), std::forward<Args>(args)...);
+            mFreeSlots.pop_back();
+            mAlive[index] = 1;
+        }
+        ++mSize;
+        return makeHandle(index);
+    }
+
+    void erase(SlotHandle handle) noexcept {
+        Expects(contains(handle));
+        auto index = handle.index();
+        std::destroy_at(slot(index));
+        mAlive[index] = 0;
+        mGenerations[index] = nextGeneration(mGenerations[index]);
+        mFreeSlots.emplace_back(index);
+        --mSize;
+    }
+
+    void clear() noexcept {
+        for (uint32_t i = 0; i != mAlive.size(); ++i) {
+            if (mAlive[i]) {
+                erase(makeHandle(i));
+            }
+        }
+    }
+
+    bool contains(SlotHandle handle) const noexcept {
+        auto index = handle.index();
+        return handle && index < mGenerations.size() && mAlive[index]
+            && mGenerations[index] == handle.generation();
+    }
+
+    // null if the handle is stale
+    T* get(SlotHandle handle) noexcept {
+        return contains(handle) ? slot(handle.index()) : nullptr;
+    }
+    const T* get(SlotHandle handle) const noexcept {
+        return contains(handle) ? slot(handle.index()) : nullptr;
+    }
+
+    T& operator[](SlotHandle handle) noexcept {
+        Expects(contains(handle));
+        return *slot(handle.index());
+    }
+    const T& operator[](SlotHandle handle) const noexcept {
+        Expects(contains(handle));
+        return *slot(handle.index());
+    }
+
+    size_t size() const noexcept {
+        return mSize;
+    }
+    bool empty() const noexcept {
+        return mSize == 0;
+    }
+    // slots ever used, handles index below it
+    size_t slotCount() const noexcept {
+        return mGenerations.size();
+    }
+
+    iterator begin() noexcept {
+        return iterator(mPages.data(), mAlive.data(), 0, slotCount32());
+    }
+    iterator end() noexcept {
+        return iterator(mPages.data(), mAlive.data(), slotCount32(), slotCount32());
+    }
+    const_iterator begin() const noexcept {
+        return const_iterator(pages(), mAlive.data(), 0, slotCount32());
+    }
+    const_iterator end() const noexcept {
+        return const_iterator(pages(), mAlive.data(), slotCount32(), slotCount32());
+    }
+private:
+    static uint8_t nextGeneration(uint8_t generation) noexcept {
+        return generation == 255 ? uint8_t(1) : uint8_t(generation + 1);
+    }
+
+    SlotHandle makeHandle(uint32_t index) const noexcept {
+        return SlotHandle{ (uint32_t(mGenerations[index]) << SlotHandle::sIndexBits) | index };
+    }
+
+    T* slot(uint32_t index) const noexcept {
+        return mPages[index / PageSize] + index % PageSize;
+    }
+
+    const T* const* pages() const noexcept {
+        return const_cast<const T* const*>(mPages.data());
+    }
+
+    uint32_t slotCount32() const noexcept {
+        return static_cast<uint32_t>(mGenerations.size());
+    }
+
+    // keeps the slots and generations of rhs, so its handles address the copies
+    void copyFrom(const SlotMap& rhs) {
+        element_allocator alloc(get_allocator());
+        mPages.reserve(rhs.mPages.size());
+        for (size_t i = 0; i != rhs.mPages.size(); ++i) {
+            mPages.emplace_back(alloc.allocate(PageSize));
+        }
+        mGenerations.reserve(rhs.mGenerations.size());
+        mAlive.reserve(rhs.mAlive.size());
+        mFreeSlots.reserve(rhs.mGenerations.size());
+        for (uint32_t i = 0; i != rhs.mGenerations.size(); ++i) {
+            mGenerations.emplace_back(rhs.mGenerations[i]);
+            if (rhs.mAlive[i]) {
+                alloc.construct(slot(i), *rhs.slot(i));
+                mAlive.emplace_back(uint8_t(1));
+                ++mSize;
+            } else {
+                mAlive.emplace_back(uint8_t(0));
+                mFreeSlots.emplace_back(i);
+            }
+        }
+    }
+
+    std::pmr::vector<T*> mPages;
+    std::pmr::vector<uint8_t> mGenerations;
+    std::pmr::vector<uint8_t> mAlive;
+    std::pmr::vector<uint32_t> mFreeSlots;
+    size_t mSize = 0;
+};
+
+}
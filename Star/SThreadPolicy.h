@@ -0,0 +1,38 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <cstdint>
+
+namespace Star {
+
+// scheduling of a long running thread, applied by the thread itself when it starts
+struct ThreadPolicy {
+    // logical processors of the first processor group, 0 keeps every processor
+    uint64_t mAffinityMask = 0;
+    // on hybrid cpus only the cores of the highest efficiency class, intersected with mAffinityMask
+    bool mPerformanceCores = false;
+    // THREAD_PRIORITY_* relative to the process class, 0 is normal
+    int32_t mPriority = 0;
+    // task registered with the multimedia class scheduler, e.g. "Games" or "Pro Audio", null skips it
+    // the scheduler raises the thread above normal priorities while it runs, mPriority is then ignored
+    const char* mMultimediaTask = nullptr;
+    // lowest cpu, io and memory priority, for threads reading assets while frames are rendered
+    bool mBackground = false;
+};
+
+}
@@ -16,7 +16,14 @@
 // along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
 
 #pragma once
+#include <Star/SThreadPolicy.h>
 #include <thread>
+#include <string>
+#include <vector>
+#include <limits>
+#include <avrt.h>
+
+#pragma comment(lib, "avrt.lib")
 
 namespace Star {
 
@@ -46,13 +53,103 @@ inline void SetThreadName(uint32_t dwThreadID, const char* threadName) {
     }
 }
 
+// kept by the thread and read by profilers and dumps, the exception reaches attached debuggers only
+inline void setThreadName(HANDLE thread, const char* name) {
+    const int size = MultiByteToWideChar(CP_UTF8, 0, name, -1, nullptr, 0);
+    if (size > 0) {
+        std::wstring description(size, L'\0');
+        MultiByteToWideChar(CP_UTF8, 0, name, -1, description.data(), size);
+        SetThreadDescription(thread, description.c_str());
+    }
+    if (IsDebuggerPresent()) {
+        SetThreadName(GetThreadId(thread), name);
+    }
+}
+
 inline void setThreadName(const char* name) {
-    SetThreadName(GetCurrentThreadId(), name);
+    setThreadName(GetCurrentThread(), name);
 }
 
 inline void setThreadName(const char* name, std::thread& thread) {
-    uint32_t threadId = GetThreadId(static_cast<HANDLE>(thread.native_handle()));
-    SetThreadName(threadId, name);
+    setThreadName(static_cast<HANDLE>(thread.native_handle()), name);
 }
 
+// logical processors of the first group in the highest efficiency class, 0 if every core is alike
+inline uint64_t getPerformanceCoreMask() {
+    ULONG size = 0;
+    GetSystemCpuSetInformation(nullptr, 0, &size, GetCurrentProcess(), 0);
+    std::vector<std::byte> buffer(size);
+    if (!size || !GetSystemCpuSetInformation(reinterpret_cast<PSYSTEM_CPU_SET_INFORMATION>(buffer.data()),
+        size, &size, GetCurrentProcess(), 0))
+        return 0;
+
+    BYTE minClass = std::numeric_limits<BYTE>::max();
+    BYTE maxClass = 0;
+    uint64_t mask = 0;
+    for (ULONG offset = 0; offset < size;) {
+        const auto& info = *reinterpret_cast<const SYSTEM_CPU_SET_INFORMATION*>(buffer.data() + offset);
+        offset += info.Size;
+        if (info.Type != CpuSetInformation || info.CpuSet.Group != 0 || info.CpuSet.LogicalProcessorIndex >= 64)
+            continue;
+        const auto efficiency = info.CpuSet.EfficiencyClass;
+        const uint64_t bit = uint64_t(1) << info.CpuSet.LogicalProcessorIndex;
+        minClass = std::min(minClass, efficiency);
+        if (efficiency > maxClass) {
+            maxClass = efficiency;
+            mask = bit;
+        } else if (efficiency == maxClass) {
+            mask |= bit;
+        }
+    }
+    return minClass == maxClass ? 0 : mask;
+}
+
+// names the calling thread and applies policy, the multimedia task and background mode end with the scope
+// settings the system refuses are reported to the debugger and skipped
+class ThreadScope {
+public:
+    ThreadScope(const char* name, const ThreadPolicy& policy)
+        : mBackground(policy.mBackground)
+    {
+        setThreadName(name);
+
+        uint64_t affinity = policy.mAffinityMask;
+        if (policy.mPerformanceCores) {
+            if (auto cores = getPerformanceCoreMask()) {
+                affinity = affinity ? (affinity & cores) : cores;
+            }
+        }
+        if (affinity && !SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(affinity))) {
+            OutputDebugStringA("WARNING: thread affinity not applied\n");
+        }
+
+        if (policy.mMultimediaTask) {
+            DWORD taskIndex = 0;
+            mMultimediaTask = AvSetMmThreadCharacteristicsA(policy.mMultimediaTask, &taskIndex);
+            if (!mMultimediaTask) {
+                OutputDebugStringA("WARNING: multimedia class scheduler task not registered\n");
+            }
+        } else if (policy.mPriority && !SetThreadPriority(GetCurrentThread(), policy.mPriority)) {
+            OutputDebugStringA("WARNING: thread priority not applied\n");
+        }
+
+        if (mBackground && !SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN)) {
+            mBackground = false;
+        }
+    }
+    ThreadScope(const ThreadScope&) = delete;
+    ThreadScope& operator=(const ThreadScope&) = delete;
+    ~ThreadScope() {
+        if (mBackground) {
+            SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_END);
+        }
+        if (mMultimediaTask) {
+            AvRevertMmThreadCharacteristics(mMultimediaTask);
+        }
+    }
+private:
+    HANDLE mMultimediaTask = nullptr;
+    bool mBackground = false;
+};
+
 }
@@ -0,0 +1,62 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <Star/SFlatHashMap.h>
+
+#include <boost/archive/detail/basic_iarchive.hpp>
+#include <boost/serialization/nvp.hpp>
+#include <boost/serialization/collection_size_type.hpp>
+#include <boost/serialization/item_version_type.hpp>
+#include <boost/serialization/detail/stack_constructor.hpp>
+#include <boost/serialization/utility.hpp>
+#include <boost/serialization/collections_save_imp.hpp>
+#include <boost/serialization/split_free.hpp>
+
+namespace boost::serialization {
+
+template<class Archive, class Key, class Value, class Hash, class KeyEqual>
+inline void save(Archive& ar, const Star::FlatHashMap<Key, Value, Hash, KeyEqual>& t, const unsigned int /* file_version */) {
+    boost::serialization::stl::save_collection<Archive, Star::FlatHashMap<Key, Value, Hash, KeyEqual>>(ar, t);
+}
+
+template<class Archive, class Key, class Value, class Hash, class KeyEqual>
+inline void load(Archive& ar, Star::FlatHashMap<Key, Value, Hash, KeyEqual>& t, const unsigned int /* file_version */) {
+    t.clear();
+    const boost::archive::library_version_type library_version(ar.get_library_version());
+    item_version_type item_version(0);
+    collection_size_type count;
+    ar >> BOOST_SERIALIZATION_NVP(count);
+    if (boost::archive::library_version_type(3) < library_version) {
+        ar >> BOOST_SERIALIZATION_NVP(item_version);
+    }
+    t.reserve(count);
+    while (count-- > 0) {
+        using type = typename Star::FlatHashMap<Key, Value, Hash, KeyEqual>::value_type;
+        detail::stack_construct<Archive, type> item(ar, item_version);
+        ar >> boost::serialization::make_nvp("item", item.reference());
+        // elements move on rehash, so their addresses are not tracked
+        t.insert(std::move(item.reference()));
+    }
+}
+
+template<class Archive, class Key, class Value, class Hash, class KeyEqual>
+inline void serialize(Archive& ar, Star::FlatHashMap<Key, Value, Hash, KeyEqual>& t, const unsigned int file_version) {
+    boost::serialization::split_free(ar, t, file_version);
+}
+
+}
@@ -23,3 +23,4 @@
 #include <Star/Serialization/SPmrString.h>
 #include <Star/Serialization/SPmrVector.h>
 #include <Star/Serialization/SFlatMap.h>
+#include <Star/Serialization/SFlatHashMap.h>
@@ -49,6 +49,12 @@ struct RaytracingView;
 
 using ResourceDataView = std::variant<BufferView, TextureView, RaytracingView>;
 
+struct SM5_0_;
+struct SM6_0_;
+struct SM6_6_;
+
+using ShaderModel = std::variant<SM5_0_, SM6_0_, SM6_6_>;
+
 } // namespace Render
 
 } // namespace Graphics
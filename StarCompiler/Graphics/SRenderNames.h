@@ -25,6 +25,9 @@ namespace Graphics {
 namespace Render {
 
 inline const char* getName(const BufferRaw_& v) noexcept { return "BufferRaw"; }
+inline const char* getName(const SM5_0_& v) noexcept { return "SM5_0"; }
+inline const char* getName(const SM6_0_& v) noexcept { return "SM6_0"; }
+inline const char* getName(const SM6_6_& v) noexcept { return "SM6_6"; }
 inline const char* getName(const BufferView& v) noexcept { return "BufferView"; }
 inline const char* getName(const MipChainView& v) noexcept { return "MipChainView"; }
 inline const char* getName(const MipRangeView& v) noexcept { return "MipRangeView"; }
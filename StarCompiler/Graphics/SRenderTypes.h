@@ -248,6 +248,22 @@ inline bool operator<(const RaytracingView& lhs, const RaytracingView& rhs) noex
 
 using ResourceDataView = std::variant<BufferView, TextureView, RaytracingView>;
 
+// SM5_0 is compiled with fxc, shader model 6 and above with dxc
+struct SM5_0_ {} static constexpr SM5_0;
+inline bool operator==(const SM5_0_&, const SM5_0_&) noexcept { return true; }
+inline bool operator!=(const SM5_0_&, const SM5_0_&) noexcept { return false; }
+inline bool operator<(const SM5_0_&, const SM5_0_&) noexcept { return false; }
+struct SM6_0_ {} static constexpr SM6_0;
+inline bool operator==(const SM6_0_&, const SM6_0_&) noexcept { return true; }
+inline bool operator!=(const SM6_0_&, const SM6_0_&) noexcept { return false; }
+inline bool operator<(const SM6_0_&, const SM6_0_&) noexcept { return false; }
+struct SM6_6_ {} static constexpr SM6_6;
+inline bool operator==(const SM6_6_&, const SM6_6_&) noexcept { return true; }
+inline bool operator!=(const SM6_6_&, const SM6_6_&) noexcept { return false; }
+inline bool operator<(const SM6_6_&, const SM6_6_&) noexcept { return false; }
+
+using ShaderModel = std::variant<SM5_0_, SM6_0_, SM6_6_>;
+
 } // namespace Render
 
 } // namespace Graphics
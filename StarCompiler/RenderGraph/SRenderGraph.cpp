@@ -69,6 +69,115 @@ size_t GraphicsRenderNodeGraph::createNode(RenderNode node) {
     return nodeID;
 }
 
+void GraphicsRenderNodeGraph::enableOcclusionCulling(size_t nodeID) {
+    auto& node = mNodeGraph[nodeID];
+    bool depthWrite = false;
+    for (const auto& output : node.mOutputs) {
+        if (std::holds_alternative<DepthWrite_>(output.mState)) {
+            depthWrite = true;
+        }
+    }
+    if (!depthWrite) {
+        throw std::invalid_argument("occlusion culling node must write depth stencil");
+    }
+    node.mOcclusionCulling = true;
+}
+
+void GraphicsRenderNodeGraph::enableLightCulling(size_t nodeID) {
+    auto& node = mNodeGraph[nodeID];
+    bool renderTarget = false;
+    for (const auto& output : node.mOutputs) {
+        if (std::holds_alternative<RenderTarget_>(output.mState)) {
+            renderTarget = true;
+        }
+    }
+    if (!renderTarget) {
+        throw std::invalid_argument("light culling node must write render target");
+    }
+    node.mLightCulling = true;
+}
+
+void GraphicsRenderNodeGraph::enableShadowCache(size_t nodeID) {
+    auto& node = mNodeGraph[nodeID];
+    bool depthWrite = false;
+    for (const auto& output : node.mOutputs) {
+        if (std::holds_alternative<RenderTarget_>(output.mState)) {
+            throw std::invalid_argument("shadow cache node must only write depth stencil");
+        }
+        if (std::holds_alternative<DepthWrite_>(output.mState)) {
+            depthWrite = true;
+        }
+    }
+    if (!depthWrite) {
+        throw std::invalid_argument("shadow cache node must write depth stencil");
+    }
+    node.mShadowCache = true;
+}
+
+void GraphicsRenderNodeGraph::setShadingRate(size_t nodeID, SHADING_RATE rate) {
+    auto& node = mNodeGraph[nodeID];
+    bool renderTarget = false;
+    for (const auto& output : node.mOutputs) {
+        if (std::holds_alternative<RenderTarget_>(output.mState)) {
+            renderTarget = true;
+        }
+    }
+    if (!renderTarget) {
+        throw std::invalid_argument("shading rate node must write render target");
+    }
+    node.mShadingRate = rate;
+}
+
+void GraphicsRenderNodeGraph::setView(size_t nodeID, uint32_t view) {
+    mNodeGraph[nodeID].mView = view;
+}
+
+void GraphicsRenderNodeGraph::enableUpscaling(size_t nodeID,
+    std::string_view color, std::string_view depth, std::string_view motion
+) {
+    auto& node = mNodeGraph[nodeID];
+    bool renderTarget = false;
+    for (const auto& output : node.mOutputs) {
+        if (std::holds_alternative<RenderTarget_>(output.mState)) {
+            renderTarget = true;
+        }
+        if (output.mName == color || output.mName == depth || output.mName == motion) {
+            throw std::invalid_argument("upscaling node cannot write its inputs");
+        }
+    }
+    if (!renderTarget) {
+        throw std::invalid_argument("upscaling node must write render target");
+    }
+    auto readState = [&](std::string_view name) -> const RenderValue* {
+        for (const auto& input : node.mInputs) {
+            if (input.mName == name)
+                return &input;
+        }
+        return nullptr;
+    };
+    const auto* pColor = readState(color);
+    if (!pColor || !std::holds_alternative<ShaderResource_>(pColor->mState)) {
+        throw std::invalid_argument("upscaling color must be shader resource input");
+    }
+    const auto* pDepth = readState(depth);
+    if (!pDepth || !(std::holds_alternative<ShaderResource_>(pDepth->mState) ||
+        std::holds_alternative<DepthRead_>(pDepth->mState))) {
+        throw std::invalid_argument("upscaling depth must be depth read or shader resource input");
+    }
+    if (!motion.empty()) {
+        const auto* pMotion = readState(motion);
+        if (!pMotion || !std::holds_alternative<ShaderResource_>(pMotion->mState)) {
+            throw std::invalid_argument("upscaling motion must be shader resource input");
+        }
+    }
+    for (size_t v = 0; v != num_vertices(mNodeGraph); ++v) {
+        if (v != nodeID && mNodeGraph[v].mUpscaling) {
+            throw std::invalid_argument("graph has more than one upscaling node");
+        }
+    }
+    node.mUpscaling = UpscaleInputs{ std::string(color), std::string(depth), std::string(motion) };
+}
+
 size_t GraphicsRenderNodeGraph::connectNode(size_t srcNodeID, size_t dstNodeID) {
     addNodeEdge(srcNodeID, dstNodeID);
 
@@ -172,6 +281,8 @@ int GraphicsRenderNodeGraph::compile() {
         return ++error;
     }
 
+    cullNodes();
+
     try {
         sortNodes();
     } catch (boost::not_a_dag) {
@@ -307,6 +418,104 @@ bool GraphicsRenderNodeGraph::isFullyConnected() const {
     return count == 1;
 }
 
+void GraphicsRenderNodeGraph::cullNodes() {
+    const auto sz = num_vertices(mNodeGraph);
+
+    std::vector<bool> live(sz, false);
+    std::vector<size_t> stack;
+    auto markLive = [&](size_t nodeID) {
+        if (!live[nodeID]) {
+            live[nodeID] = true;
+            stack.emplace_back(nodeID);
+        }
+    };
+
+    for (size_t nodeID = 0; nodeID != sz; ++nodeID) {
+        for (const auto& output : mNodeGraph[nodeID].mOutputs) {
+            if (std::holds_alternative<Present_>(output.mState)) {
+                markLive(nodeID);
+                break;
+            }
+        }
+    }
+    // missing present output is reported by validateCompleteness
+    if (stack.empty())
+        return;
+
+    // node edges are dependencies as well
+    while (!stack.empty()) {
+        const auto nodeID = stack.back();
+        stack.pop_back();
+        for (auto [iter, end] = in_edges(nodeID, mDependencyGraph); iter != end; ++iter) {
+            markLive(source(*iter, mDependencyGraph));
+        }
+    }
+
+    if (std::find(live.begin(), live.end(), false) == live.end())
+        return;
+
+    // rebuild graphs without culled nodes, node ids are contiguous
+    GraphicsRenderNodeGraph culled;
+    culled.mName = mName;
+    culled.mConfig = mConfig;
+    culled.mRenderTargets = mRenderTargets;
+
+    std::vector<size_t> nodeIDs(sz);
+    for (size_t nodeID = 0; nodeID != sz; ++nodeID) {
+        const auto& node = mNodeGraph[nodeID];
+        if (!live[nodeID]) {
+            CONSOLE_WARNING();
+            std::cout << "render node: " << node.mName << " does not contribute to present, culled" << std::endl;
+            continue;
+        }
+
+        // values only consumed by culled nodes are discarded
+        auto node2 = node;
+        for (auto iter = node2.mOutputs.begin(); iter != node2.mOutputs.end(); ++iter) {
+            auto valueID = mValueIndex.at(make_key(nodeID, *iter));
+            auto [edgeBegin, edgeEnd] = out_edges(valueID, mValueGraph);
+            if (edgeBegin == edgeEnd)
+                continue;
+            bool consumed = std::any_of(edgeBegin, edgeEnd, [&](const auto& e) {
+                return live[std::get<0>(mValueGraph[target(e, mValueGraph)])];
+            });
+            if (!consumed) {
+                auto output = *iter;
+                output.mStoreOp = Discard;
+                node2.mOutputs.replace(iter, output);
+            }
+        }
+        nodeIDs[nodeID] = culled.createNode(std::move(node2));
+    }
+
+    for (auto [iter, end] = edges(mNodeGraph); iter != end; ++iter) {
+        auto src = source(*iter, mNodeGraph);
+        auto dst = target(*iter, mNodeGraph);
+        if (live[src] && live[dst]) {
+            culled.addNodeEdge(nodeIDs[src], nodeIDs[dst]);
+        }
+    }
+    for (auto [iter, end] = edges(mDependencyGraph); iter != end; ++iter) {
+        auto src = source(*iter, mDependencyGraph);
+        auto dst = target(*iter, mDependencyGraph);
+        if (live[src] && live[dst]) {
+            culled.addDependency(nodeIDs[src], nodeIDs[dst]);
+        }
+    }
+    for (auto [iter, end] = edges(mValueGraph); iter != end; ++iter) {
+        const auto& [srcNodeID, srcName, srcData] = mValueGraph[source(*iter, mValueGraph)];
+        const auto& [dstNodeID, dstName, dstData] = mValueGraph[target(*iter, mValueGraph)];
+        if (!live[srcNodeID] || !live[dstNodeID])
+            continue;
+        add_edge(
+            culled.mValueIndex.at(value_type{ nodeIDs[srcNodeID], srcName, srcData }),
+            culled.mValueIndex.at(value_type{ nodeIDs[dstNodeID], dstName, dstData }),
+            culled.mValueGraph);
+    }
+
+    *this = std::move(culled);
+}
+
 void GraphicsRenderNodeGraph::sortNodes() {
     std::vector<size_t> order;
 
@@ -412,6 +621,10 @@ void GraphicsRenderNodeGraph::validateCompleteness() const {
 
             // no output
             if (outEdges.first == outEdges.second) {
+                // consumers culled
+                if (std::holds_alternative<Discard_>(output.mStoreOp)) {
+                    continue;
+                }
                 if (std::holds_alternative<DepthWrite_>(output.mState) ||
                     std::holds_alternative<DepthRead_>(output.mState))
                 {
@@ -495,39 +708,101 @@ void GraphicsRenderNodeGraph::buildRenderStatePaths() {
     }
 }
 
-void GraphicsRenderNodeGraph::buildRenderStatePaths2() {
-    for (auto& [name, v] : mViewStates) {
-        if (v.mStates.empty())
-            throw std::runtime_error("empty render value states");
-        Expects(v.mFullStates.empty());
-
-        // build fullstates
-        size_t i = 0;
-        for (size_t k = 0; k != mNodeSorted.size(); ++k) {
-            auto nodeID = mNodeSorted[k];
-            if (i == v.mStates.size()) {
-                i = 0;
+namespace {
+
+bool isReadOnlyState(const ResourceState& state) noexcept {
+    return std::holds_alternative<DepthRead_>(state) || std::holds_alternative<ShaderResource_>(state);
+}
+
+// consecutive reads share one combined state, no transition is needed between them
+void mergeReadOnlyStates(std::vector<NodeRenderTargetState>& states) {
+    std::vector<std::pair<size_t, size_t>> runs;
+    for (size_t i = 0; i != states.size();) {
+        size_t j = i + 1;
+        if (isReadOnlyState(states[i].mRenderTargetState.mState)) {
+            while (j != states.size() && isReadOnlyState(states[j].mRenderTargetState.mState)) {
+                ++j;
             }
-            v.mFullStates.emplace_back(
-                NodeRenderTargetState{ gsl::narrow<uint32_t>(nodeID), { v.mStates[i].mRenderTargetState } }
-            );
+        }
+        runs.emplace_back(i, j);
+        i = j;
+    }
 
-            if (nodeID == v.mStates[i].mNodeID) {
-                ++i;
+    auto mergeRuns = [&](std::initializer_list<std::pair<size_t, size_t>> merged) {
+        RenderTargetState combined{ ShaderResource };
+        for (const auto& [begin, end] : merged) {
+            for (size_t i = begin; i != end; ++i) {
+                const auto& s = states[i].mRenderTargetState;
+                if (std::holds_alternative<DepthRead_>(s.mState)) {
+                    combined.mState = DepthRead;
+                }
+                combined.mPixelShaderResource |= s.mPixelShaderResource;
+                combined.mNonPixelShaderResource |= s.mNonPixelShaderResource;
+            }
+        }
+        for (const auto& [begin, end] : merged) {
+            for (size_t i = begin; i != end; ++i) {
+                states[i].mRenderTargetState = combined;
             }
         }
+    };
+
+    auto isReadRun = [&](const std::pair<size_t, size_t>& run) {
+        return isReadOnlyState(states[run.first].mRenderTargetState.mState);
+    };
 
-        // build transitions
-        for (size_t k = 0; k != v.mFullStates.size(); ++k) {
-            const auto& curr = v.mFullStates[k];
-            const auto& next = getNextState(v, k);
-            const auto& target = getNextDifferentState(v, k);
-            if (target && next.mRenderTargetState != curr.mRenderTargetState) {
-                v.mTransitions.emplace_back(
-                    RenderTargetStateTransition{ curr.mNodeID, curr.mRenderTargetState, target->mRenderTargetState }
-                );
+    // states are cyclic, the last run continues into the first of the next frame
+    if (runs.size() > 1 && isReadRun(runs.front()) && isReadRun(runs.back())) {
+        mergeRuns({ runs.front(), runs.back() });
+        runs.erase(runs.begin());
+        runs.pop_back();
+    }
+    for (const auto& run : runs) {
+        if (isReadRun(run)) {
+            mergeRuns({ run });
+        }
+    }
+}
+
+}
+
+// states of one render target, same as buildRenderStatePaths visiting only the nodes using it
+void GraphicsRenderNodeGraph::buildRenderStatePath(const key_type& key, RenderTargetStateTransitions& v) const {
+    for (auto nodeID : mNodeSorted) {
+        const auto& node = mNodeGraph[nodeID];
+
+        auto output = node.mOutputs.find(key);
+        if (output != node.mOutputs.end()) {
+            v.mStates.emplace_back(
+                NodeRenderTargetState{ gsl::narrow<uint32_t>(nodeID), { output->mState } }
+            );
+        }
+
+        auto input = node.mInputs.find(key);
+        if (input == node.mInputs.end())
+            continue;
+        if (!v.mStates.empty()) {
+            const auto& state = v.mStates.back();
+            // same node must have same states
+            if (state.mNodeID == nodeID) {
+                if (state.mRenderTargetState.mState != input->mState) {
+                    throw std::runtime_error("input and output have different states");
+                }
+                if (!std::holds_alternative<DepthRead_>(input->mState)) {
+                    throw std::runtime_error("input is not DepthRead_");
+                }
+                continue;
             }
         }
+        v.mStates.emplace_back(
+            NodeRenderTargetState{ gsl::narrow<uint32_t>(nodeID), { input->mState } }
+        );
+    }
+}
+
+void GraphicsRenderNodeGraph::buildRenderStatePaths2() {
+    for (auto& [name, v] : mViewStates) {
+        buildStateTransitions(v);
     }
 
     if (mConfig.mVerbose) {
@@ -535,6 +810,112 @@ void GraphicsRenderNodeGraph::buildRenderStatePaths2() {
     }
 }
 
+void GraphicsRenderNodeGraph::updateNodeStates(size_t nodeID) {
+    if (mNodeSorted.size() != num_vertices(mNodeGraph)) {
+        throw std::invalid_argument("node order and node graph size inconsistent, please sort graph first");
+    }
+
+    // render targets the node uses now, and the ones it used before the edit
+    const auto& node = mNodeGraph[nodeID];
+    std::set<key_type> keys;
+    for (const auto& output : node.mOutputs) {
+        keys.emplace(get_key(output));
+    }
+    for (const auto& input : node.mInputs) {
+        keys.emplace(get_key(input));
+    }
+    for (const auto& [key, v] : mViewStates) {
+        for (const auto& state : v.mStates) {
+            if (state.mNodeID == nodeID) {
+                keys.emplace(key);
+                break;
+            }
+        }
+    }
+
+    for (const auto& key : keys) {
+        auto& v = mViewStates[key];
+        // shader stages reading a target are set by RenderSolutionFactory::updateRenderGraph,
+        // they are kept from the previous path for the reads still present
+        std::map<uint32_t, RenderTargetState> prev;
+        for (const auto& state : v.mStates) {
+            prev.emplace(state.mNodeID, state.mRenderTargetState);
+        }
+
+        v = RenderTargetStateTransitions{};
+        buildRenderStatePath(key, v);
+        if (v.mStates.empty()) {
+            mViewStates.erase(key);
+            continue;
+        }
+        for (auto& state : v.mStates) {
+            auto iter = prev.find(state.mNodeID);
+            if (iter == prev.end() || !isReadOnlyState(state.mRenderTargetState.mState))
+                continue;
+            state.mRenderTargetState.mPixelShaderResource = iter->second.mPixelShaderResource;
+            state.mRenderTargetState.mNonPixelShaderResource = iter->second.mNonPixelShaderResource;
+        }
+        buildStateTransitions(v);
+    }
+
+    mRTVs.clear();
+    mDSVs.clear();
+    mCBV_SRV_UAVs.clear();
+    buildResourceViews();
+}
+
+void GraphicsRenderNodeGraph::buildStateTransitions(RenderTargetStateTransitions& v) const {
+    if (v.mStates.empty())
+        throw std::runtime_error("empty render value states");
+    Expects(v.mFullStates.empty());
+
+    mergeReadOnlyStates(v.mStates);
+
+    // build fullstates
+    size_t i = 0;
+    for (size_t k = 0; k != mNodeSorted.size(); ++k) {
+        auto nodeID = mNodeSorted[k];
+        if (i == v.mStates.size()) {
+            i = 0;
+        }
+        v.mFullStates.emplace_back(
+            NodeRenderTargetState{ gsl::narrow<uint32_t>(nodeID), { v.mStates[i].mRenderTargetState } }
+        );
+
+        if (nodeID == v.mStates[i].mNodeID) {
+            ++i;
+        }
+    }
+
+    std::set<uint32_t> users;
+    for (const auto& state : v.mStates) {
+        users.emplace(state.mNodeID);
+    }
+
+    // build transitions
+    for (size_t k = 0; k != v.mFullStates.size(); ++k) {
+        const auto& curr = v.mFullStates[k];
+        const auto& next = getNextState(v, k);
+        const auto& target = getNextDifferentState(v, k);
+        if (target && next.mRenderTargetState != curr.mRenderTargetState) {
+            // split the barrier over the nodes not using the resource since its last use,
+            // a last use in the previous frame gets a full barrier
+            uint32_t beginNodeID = curr.mNodeID;
+            for (size_t j = k; j != v.mFullStates.size(); ++j) {
+                if (users.count(v.mFullStates[j].mNodeID)) {
+                    beginNodeID = v.mFullStates[j].mNodeID;
+                    break;
+                }
+            }
+            v.mTransitions.emplace_back(
+                RenderTargetStateTransition{
+                    curr.mNodeID, curr.mRenderTargetState, target->mRenderTargetState, beginNodeID
+                }
+            );
+        }
+    }
+}
+
 void GraphicsRenderNodeGraph::buildResourceViews() {
     if (mNodeSorted.size() != num_vertices(mNodeGraph)) {
         throw std::invalid_argument("node order and node graph size inconsistent, please sort graph first");
@@ -685,6 +1066,9 @@ void GraphicsRenderNodeGraph::outputValueStates() const {
             std::cout << t.mNodeID << " "
                 << getRenderTargetStateName(t.mTarget) << " <- "
                 << getRenderTargetStateName(t.mSource);
+            if (t.mBeginNodeID != t.mNodeID) {
+                std::cout << " (split from " << t.mBeginNodeID << ")";
+            }
         }
         std::cout << std::endl;
     }
@@ -48,6 +48,19 @@ public:
     size_t createNode(RenderNode node);
 
     size_t connectNode(size_t srcNodeID, size_t dstNodeID);
+    // objects are tested against the hierarchical-z of the node depth output
+    void enableOcclusionCulling(size_t nodeID);
+    // point lights are binned into view clusters before the node, its shaders read the cluster light lists
+    void enableLightCulling(size_t nodeID);
+    // depth of static casters is kept between frames, only moving casters are drawn on top of it
+    void enableShadowCache(size_t nodeID);
+    // coarse shading of the node draws, combined with a ShadingRateSource input if the node has one
+    void setShadingRate(size_t nodeID, SHADING_RATE rate);
+    // camera the node is culled and drawn with, an index into the views of the engine, 0 is the main camera
+    void setView(size_t nodeID, uint32_t view);
+    // the node upscales its color input to its render target outputs, nodes before it render at the render resolution
+    // with a jittered projection, color, depth and motion name inputs of the node, motion may be empty
+    void enableUpscaling(size_t nodeID, std::string_view color, std::string_view depth, std::string_view motion = {});
     void addDependency(size_t srcNodeID, size_t dstNodeID);
 
     int32_t compile();
@@ -60,6 +73,10 @@ public:
 
     void buildRenderStatePaths2();
     void buildResourceViews();
+
+    // after the states of a compiled node are edited, rebuilds only the state paths of
+    // the render targets it reads or writes, and the resource views. node order is unchanged
+    void updateNodeStates(size_t nodeID);
 private:
     void createValues(size_t nodeID);
     bool try_addNodeEdge(size_t srcNodeID, size_t dstNodeID);
@@ -73,8 +90,12 @@ private:
     bool isFullyConnected() const;
     void validateCompleteness() const;
 
+    // removes nodes the present output does not depend on
+    void cullNodes();
     void sortNodes();
     void buildRenderStatePaths();
+    void buildRenderStatePath(const key_type& key, RenderTargetStateTransitions& v) const;
+    void buildStateTransitions(RenderTargetStateTransitions& v) const;
 
     void outputValueStates() const;
     void outputViews() const;
@@ -77,6 +77,24 @@ auto NAME = graph.createNode(RenderNode{ BOOST_PP_STRINGIZE(NAME), __VA_ARGS__ }
 #define CONNECT(SRC, DST) \
 graph.connectNode(SRC, DST)
 
+#define OCCLUSION_CULLING(NAME) \
+graph.enableOcclusionCulling(NAME)
+
+#define LIGHT_CULLING(NAME) \
+graph.enableLightCulling(NAME)
+
+#define SHADOW_CACHE(NAME) \
+graph.enableShadowCache(NAME)
+
+#define VARIABLE_SHADING(NAME, RATE) \
+graph.setShadingRate(NAME, RATE)
+
+#define VIEW(NAME, INDEX) \
+graph.setView(NAME, INDEX)
+
+#define UPSCALING(NAME, ...) \
+graph.enableUpscaling(NAME, __VA_ARGS__)
+
 }
 
 }
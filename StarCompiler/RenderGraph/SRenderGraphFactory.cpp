@@ -19,13 +19,17 @@
 #include <StarCompiler/Graphics/SRenderFormatNames.h>
 #include <StarCompiler/RenderGraph/SRenderGraphTypes.h>
 #include <StarCompiler/RenderGraph/SRenderGraphUtils.h>
+#include <StarCompiler/RenderGraph/SRenderGraphSerialization.h>
 #include <StarCompiler/ShaderGraph/SShaderTypes.h>
 #include <Star/Graphics/SRenderFormatUtils.h>
+#include <Star/Graphics/SRenderFormatTextureUtils.h>
 #include <StarCompiler/ShaderWorks/SShaderCompiler.h>
 #include <Star/Graphics/SRenderGraphReflection.h>
 #include <StarCompiler/ShaderGraph/SShaderModules.h>
+#include <StarCompiler/ShaderGraph/SShaderDescriptorDatabase.h>
 #include <Star/Graphics/SRenderUtils.h>
 #include <StarCompiler/ShaderGraph/SShaderTypes.h>
+#include <iomanip>
 
 namespace Star {
 
@@ -33,6 +37,23 @@ namespace Graphics {
 
 namespace Render {
 
+namespace {
+
+// subpasses writing the same targets in the same states can share one pass
+bool hasSameFramebufferBindings(const RenderNode& lhs, const RenderNode& rhs) {
+    if (lhs.mSampling != rhs.mSampling)
+        return false;
+    if (lhs.mOutputs.size() != rhs.mOutputs.size())
+        return false;
+    return std::equal(lhs.mOutputs.begin(), lhs.mOutputs.end(), rhs.mOutputs.begin(),
+        [](const RenderValue& a, const RenderValue& b) {
+            return std::forward_as_tuple(a.mName, a.mState, a.mData, a.mModel) ==
+                std::forward_as_tuple(b.mName, b.mState, b.mData, b.mModel);
+        });
+}
+
+}
+
 void RenderSolutionFactory::addPipeline(GraphicsRenderNodeGraph&& graph) {
     auto name = graph.mName;
     mGraphOrder.emplace_back(name);
@@ -100,6 +121,7 @@ void RenderSolutionFactory::buildShaderGroup(Shader::ShaderGroups& shaderWorks)
 
     validateGraphs();
     auto& bundle = shaderWorks.mSolutions.try_emplace(mName).first->second;
+    shaderWorks.mShaderModels.insert_or_assign(mName, mConfig.mShaderModel);
 
     for (auto& [graphName, graph] : mNodeGraphs) {
         auto& pipeline = bundle.try_emplace(graph.mName,
@@ -347,6 +369,248 @@ void RenderSolutionFactory::buildFramebuffers(
     }
 }
 
+void RenderSolutionFactory::buildFramebufferAliasing(
+    const std::map<std::string, uint32_t>& rtIndex,
+    RenderSolution& sl
+) const {
+    struct Lifetime {
+        uint32_t mFirst = UINT32_MAX;
+        uint32_t mLast = 0;
+        bool used() const noexcept { return mFirst != UINT32_MAX; }
+    };
+
+    const auto numFramebuffers = gsl::narrow<uint32_t>(sl.mFramebuffers.size());
+
+    // back buffers and framebuffers carrying contents across frames keep dedicated memory
+    std::vector<bool> aliasable(numFramebuffers, true);
+    for (uint32_t i = 0; i != mBackBufferCount; ++i) {
+        aliasable[i] = false;
+    }
+
+    auto getFramebuffer = [&](const std::string& name) -> std::optional<uint32_t> {
+        auto iter = rtIndex.find(name);
+        if (iter == rtIndex.end() || iter->second < mBackBufferCount)
+            return std::nullopt;
+        return iter->second;
+    };
+
+    // lifetimes in subpass execution order, per pipeline
+    std::vector<std::vector<Lifetime>> lifetimes;
+    lifetimes.reserve(mNodeGraphs.size());
+
+    for (const auto& [graphName, graph] : mNodeGraphs) {
+        auto& lifetime = lifetimes.emplace_back(numFramebuffers);
+        const auto numNodes = graph.mNodeSorted.size();
+
+        std::map<uint32_t, uint32_t> nodeTimes;
+        for (size_t k = numNodes; k --> 0;) {
+            const auto time = gsl::narrow<uint32_t>(numNodes - 1 - k);
+            const auto& nodeID = graph.mNodeSorted[k];
+            const auto& node = graph.mNodeGraph[nodeID];
+            nodeTimes.emplace(gsl::narrow<uint32_t>(nodeID), time);
+
+            for (const auto& input : node.mInputs) {
+                auto fb = getFramebuffer(input.mName);
+                if (!fb)
+                    continue;
+                auto& life = lifetime[*fb];
+                if (!life.used()) {
+                    // read before written
+                    aliasable[*fb] = false;
+                    life.mFirst = time;
+                }
+                life.mLast = time;
+            }
+            for (const auto& output : node.mOutputs) {
+                auto fb = getFramebuffer(output.mName);
+                if (!fb)
+                    continue;
+                auto& life = lifetime[*fb];
+                if (!life.used()) {
+                    if (std::holds_alternative<Load_>(output.mLoadOp) ||
+                        std::holds_alternative<DepthRead_>(output.mState)) {
+                        aliasable[*fb] = false;
+                    }
+                    life.mFirst = time;
+                }
+                life.mLast = time;
+            }
+        }
+
+        // transitions are recorded after the subpass, they extend the lifetime
+        for (const auto& [resourceKey, states] : graph.mViewStates) {
+            auto fb = getFramebuffer(resourceKey.first);
+            if (!fb)
+                continue;
+            auto& life = lifetime[*fb];
+            for (const auto& trans : states.mTransitions) {
+                const auto time = at(nodeTimes, trans.mNodeID);
+                if (!life.used() || time < life.mFirst) {
+                    aliasable[*fb] = false;
+                    continue;
+                }
+                life.mLast = std::max(life.mLast, time);
+            }
+        }
+    }
+
+    auto overlaps = [&](uint32_t lhs, uint32_t rhs) {
+        for (const auto& lifetime : lifetimes) {
+            const auto& a = lifetime[lhs];
+            const auto& b = lifetime[rhs];
+            if (!a.used() || !b.used())
+                continue;
+            if (a.mFirst <= b.mLast && b.mFirst <= a.mLast)
+                return true;
+        }
+        return false;
+    };
+
+    // greedy slot assignment in framebuffer order
+    std::vector<std::vector<uint32_t>> slots;
+    for (uint32_t i = mBackBufferCount; i != numFramebuffers; ++i) {
+        if (!aliasable[i])
+            continue;
+
+        auto iter = std::find_if(slots.begin(), slots.end(), [&](const std::vector<uint32_t>& slot) {
+            return std::none_of(slot.begin(), slot.end(), [&](uint32_t j) {
+                return overlaps(i, j);
+            });
+        });
+        if (iter == slots.end()) {
+            slots.emplace_back().emplace_back(i);
+        } else {
+            iter->emplace_back(i);
+        }
+    }
+
+    // a slot with a single framebuffer saves nothing
+    uint32_t slotID = 0;
+    for (const auto& slot : slots) {
+        if (slot.size() < 2)
+            continue;
+        for (const auto& i : slot) {
+            sl.mFramebuffers[i].mAliasSlot = slotID;
+        }
+        ++slotID;
+    }
+
+    // aliasing barriers at the first use in each pipeline
+    uint32_t pipelineID = 0;
+    for (const auto& [graphName, graph] : mNodeGraphs) {
+        const auto& lifetime = lifetimes[pipelineID++];
+        auto& pipeline = sl.mPipelines.at(at(sl.mPipelineIndex, graphName));
+        const auto numNodes = graph.mNodeSorted.size();
+
+        for (uint32_t i = mBackBufferCount; i != numFramebuffers; ++i) {
+            if (!sl.mFramebuffers[i].mAliasSlot || !lifetime[i].used())
+                continue;
+            const auto& nodeID = graph.mNodeSorted[numNodes - 1 - lifetime[i].mFirst];
+            const auto& node = graph.mNodeGraph[nodeID];
+            const auto& subpassIndex = at(pipeline.mSubpassIndex, node.mName);
+            auto& subpass = pipeline.mPasses.at(subpassIndex.mPassID)
+                .mGraphicsSubpasses.at(subpassIndex.mSubpassID);
+            subpass.mAliasingBarriers.emplace_back(FramebufferHandle{ i });
+        }
+    }
+}
+
+void RenderSolutionFactory::reportFramebuffers(
+    const std::map<std::string, uint32_t>& rtIndex,
+    const RenderSolution& sl
+) const {
+    if (sl.mFramebuffers.empty())
+        return;
+
+    std::vector<std::string_view> names(sl.mFramebuffers.size());
+    for (const auto& [name, id] : rtIndex) {
+        names[id] = name;
+    }
+
+    const auto& bb = sl.mFramebuffers.front().mResource;
+    const auto getBytes = [&](const RESOURCE_DESC& desc, uint32_t width, uint32_t height) {
+        uint64_t w = desc.mWidth;
+        uint64_t h = desc.mHeight;
+        if (desc.mWidth == bb.mWidth && desc.mHeight == bb.mHeight) {
+            w = width;
+            h = height;
+        }
+        return getMipSize(desc.mFormat, gsl::narrow<uint32_t>(w), gsl::narrow<uint32_t>(h))
+            * desc.mDepthOrArraySize * std::max(desc.mSampleDesc.mCount, 1u);
+    };
+
+    // aliased framebuffers share the memory of their largest member
+    const auto getTotal = [&](uint32_t width, uint32_t height) {
+        uint64_t total = 0;
+        std::map<uint32_t, uint64_t> slots;
+        for (const auto& fb : sl.mFramebuffers) {
+            const auto bytes = getBytes(fb.mResource, width, height);
+            if (fb.mAliasSlot) {
+                auto& slot = slots[*fb.mAliasSlot];
+                slot = std::max(slot, bytes);
+            } else {
+                total += bytes;
+            }
+        }
+        for (const auto& [slotID, bytes] : slots) {
+            total += bytes;
+        }
+        return total;
+    };
+
+    const auto toMB = [](uint64_t bytes) {
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision(2) << double(bytes) / (1024.0 * 1024.0) << " MB";
+        return oss.str();
+    };
+
+    const auto width = gsl::narrow<uint32_t>(bb.mWidth);
+    const auto height = bb.mHeight;
+    std::cout << "framebuffer memory: " << std::endl;
+    uint64_t dedicated = 0;
+    for (uint32_t i = 0; i != sl.mFramebuffers.size(); ++i) {
+        const auto& fb = sl.mFramebuffers[i];
+        const auto bytes = getBytes(fb.mResource, width, height);
+        dedicated += bytes;
+        {
+            CONSOLE_COLOR(Cyan);
+            if (i < mBackBufferCount) {
+                std::cout << "BackBuffer" << i;
+            } else {
+                std::cout << names[i];
+            }
+        }
+        std::cout << ": " << getName(fb.mResource.mFormat) << " "
+            << fb.mResource.mWidth << "x" << fb.mResource.mHeight << ", " << toMB(bytes);
+        if (fb.mAliasSlot) {
+            std::cout << ", alias slot " << *fb.mAliasSlot;
+        }
+        std::cout << std::endl;
+    }
+
+    const auto checkBudget = [&](uint32_t w, uint32_t h) {
+        const auto total = getTotal(w, h);
+        std::cout << "  " << w << "x" << h << ": " << toMB(total) << std::endl;
+        if (!mFramebufferBudget || total <= mFramebufferBudget)
+            return;
+
+        std::ostringstream oss;
+        oss << "solution " << mName << " framebuffers need " << toMB(total)
+            << " at " << w << "x" << h << ", budget " << toMB(mFramebufferBudget);
+        if (mFailOverFramebufferBudget) {
+            throw std::runtime_error(oss.str());
+        }
+        CONSOLE_WARNING();
+        std::cout << " " << oss.str() << std::endl;
+    };
+
+    std::cout << "framebuffer total, " << toMB(dedicated) << " without aliasing:" << std::endl;
+    checkBudget(width, height);
+    for (const auto& [w, h] : mReportResolutions) {
+        checkBudget(w, h);
+    }
+}
+
 void RenderSolutionFactory::collectRTVsMinimal(
     size_t rtvOffset,
     const OrderedNameMap<RenderTargetResource>& bbs,
@@ -544,23 +808,81 @@ void RenderSolutionFactory::compile(std::string solutionName, RenderSolution& sl
         sl.mPipelines.emplace_back();
         auto& pipeline = sl.mPipelines.back();
 
+        const RenderNode* prevNode = nullptr;
         for (size_t k = graph.mNodeSorted.size(); k-- > 0;) {
             const auto& nodeID = graph.mNodeSorted[k];
             const auto& node = graph.mNodeGraph[nodeID];
 
+            // merge adjacent nodes sharing all bindings, output node always has its own pass
+            // upscaling starts a pass, its viewport is the output resolution
+            bool merge = k != 0 && prevNode && !node.mOutputs.empty() && !node.mUpscaling &&
+                hasSameFramebufferBindings(*prevNode, node);
+            prevNode = (k != 0) ? &node : nullptr;
+
+            if (!merge) {
+                pipeline.mPasses.emplace_back();
+            }
+            auto& pass = pipeline.mPasses.back();
+
             {
-                RenderSubpassDesc desc{ (uint32_t)pipeline.mPasses.size(), 0 };
+                RenderSubpassDesc desc{
+                    (uint32_t)(pipeline.mPasses.size() - 1),
+                    (uint32_t)pass.mGraphicsSubpasses.size()
+                };
                 auto res = pipeline.mSubpassIndex.emplace(std::piecewise_construct,
                     std::forward_as_tuple(node.mName),
                     std::forward_as_tuple(desc));
                 Ensures(res.second);
             }
 
-            pipeline.mPasses.emplace_back();
-            auto& pass = pipeline.mPasses.back();
-
             pass.mGraphicsSubpasses.emplace_back();
-            Ensures(pass.mGraphicsSubpasses.size() == 1);
+        }
+    }
+}
+
+void RenderSolutionFactory::outputCacheKey(std::ostream& os) const {
+    boost::archive::binary_oarchive oa(os);
+    oa << mName;
+    oa << mConfig;
+    oa << mBackBufferCount;
+    // a cached solution skips the budget check
+    for (const auto& [width, height] : mReportResolutions) {
+        oa << width;
+        oa << height;
+    }
+    oa << mFramebufferBudget;
+    oa << mFailOverFramebufferBudget;
+
+    for (const auto& [graphName, graph] : mNodeGraphs) {
+        oa << graphName;
+        oa << graph.mConfig;
+        for (const auto& rt : graph.mRenderTargets) {
+            oa << rt;
+        }
+        for (size_t k = graph.mNodeSorted.size(); k-- > 0;) {
+            const auto& node = graph.mNodeGraph[graph.mNodeSorted[k]];
+            oa << node;
+            oa << node.mRootSignature;
+            oa << node.mOcclusionCulling;
+            oa << node.mLightCulling;
+            oa << node.mShadowCache;
+            oa << node.mShadingRate;
+            oa << node.mView;
+            if (node.mUpscaling) {
+                oa << node.mUpscaling->mColor;
+                oa << node.mUpscaling->mDepth;
+                oa << node.mUpscaling->mMotion;
+            }
+            const auto* s = std::get_if<Multisampling>(&node.mSampling);
+            uint32_t count = s ? s->mCount : 1;
+            uint32_t quality = s ? s->mQuality : 0;
+            oa << count;
+            oa << quality;
+        }
+        for (const auto& [key, states] : graph.mViewStates) {
+            oa << key.first;
+            oa << key.second;
+            oa << states;
         }
     }
 }
@@ -574,6 +896,8 @@ void RenderSolutionFactory::build(const Shader::AttributeDatabase& attrs, std::s
     RenderSolution& sl, std::ostringstream& oss
 ) const {
     uint32_t rsgCount = 0;
+    // passes often generate identical root signatures, each source is compiled once
+    std::map<std::string_view, std::string> rootSignatures;
     OrderedNameMap<RenderTargetResource> bbs;
     OrderedNameMap<RenderTargetResource> rts;
     OrderedNameMap<RenderTargetResource> rtsAll;
@@ -627,6 +951,19 @@ void RenderSolutionFactory::build(const Shader::AttributeDatabase& attrs, std::s
         }
     }
 
+    // wide formats are presented as hdr, the subpasses writing the back buffer encode to it
+    switch (format) {
+    case Format::R10G10B10A2_UNORM_PACK32:
+        sl.mOutputColorSpace = HDR10;
+        break;
+    case Format::R16G16B16A16_SFLOAT:
+        sl.mOutputColorSpace = ScRGB;
+        break;
+    default:
+        sl.mOutputColorSpace = SDR;
+        break;
+    }
+
     // create backbuffer rtvs
     for (auto i = 0u; i != mBackBufferCount; ++i) {
         sl.mRTVSources[i] = FramebufferHandle{ i };
@@ -639,7 +976,7 @@ void RenderSolutionFactory::build(const Shader::AttributeDatabase& attrs, std::s
         };
 
         auto formatS = makeUNormSRGB(format);
-        if (formatS == format) {
+        if (formatS == format && std::holds_alternative<SDR_>(sl.mOutputColorSpace)) {
             CONSOLE_WARNING();
             std::cout << "backbuffer format srgb equal unorm" << std::endl;
         }
@@ -752,7 +1089,6 @@ void RenderSolutionFactory::build(const Shader::AttributeDatabase& attrs, std::s
             const auto& subpassIndex = at(pipeline.mSubpassIndex, node.mName);
             auto& pass = pipeline.mPasses.at(subpassIndex.mPassID);
             auto& subpass = pass.mGraphicsSubpasses.at(subpassIndex.mSubpassID);
-            Expects(pass.mGraphicsSubpasses.size() == 1);
 
             visit(overload(
                 [&](const Multisampling& s) {
@@ -765,10 +1101,37 @@ void RenderSolutionFactory::build(const Shader::AttributeDatabase& attrs, std::s
                     subpass.mSampleDesc.mQuality = 0;
                 }
             ), node.mSampling);
+            subpass.mOcclusionCulling = node.mOcclusionCulling;
+            subpass.mLightCulling = node.mLightCulling;
+            subpass.mShadowCache = node.mShadowCache;
+            subpass.mShadingRate = node.mShadingRate;
+            subpass.mView = node.mView;
+            for (const auto& input : node.mInputs) {
+                if (!std::holds_alternative<ShadingRateSource_>(input.mState))
+                    continue;
+                if (subpass.mShadingRateImage) {
+                    throw std::invalid_argument("subpass has more than one shading rate image");
+                }
+                subpass.mShadingRateImage = FramebufferHandle{ rtIndex.at(input.mName) };
+            }
+            if (node.mUpscaling) {
+                auto& upscaling = subpass.mUpscaling.emplace();
+                upscaling.mColor = FramebufferHandle{ rtIndex.at(node.mUpscaling->mColor) };
+                upscaling.mDepth = FramebufferHandle{ rtIndex.at(node.mUpscaling->mDepth) };
+                if (!node.mUpscaling->mMotion.empty()) {
+                    upscaling.mMotion = FramebufferHandle{ rtIndex.at(node.mUpscaling->mMotion) };
+                }
+            }
 
             if (!bOutput) {
-                Shader::compileShader(subpass.mRootSignature, "rootsig_1_1",
-                    node.mName, node.mRootSignature);
+                auto [iterRsg, bNewRsg] = rootSignatures.try_emplace(node.mRootSignature);
+                if (bNewRsg) {
+                    Shader::compileShader(subpass.mRootSignature, "rootsig_1_1",
+                        node.mName, node.mRootSignature);
+                    iterRsg->second.assign(subpass.mRootSignature.begin(), subpass.mRootSignature.end());
+                } else {
+                    subpass.mRootSignature.assign(iterRsg->second.begin(), iterRsg->second.end());
+                }
                 std::string space;
                 if (rsgCount++) {
                     oss << "\n";
@@ -797,7 +1160,10 @@ void RenderSolutionFactory::build(const Shader::AttributeDatabase& attrs, std::s
                     runtimeConstantBuffer.mIndex = index;
                     runtimeConstantBuffer.mConstants.reserve(constantBuffer.mValues.size());
                     Expects(runtimeConstantBuffer.mSize == 0);
-                    for (const auto& constant : constantBuffer.mValues) {
+                    const auto packed = packConstantBuffer(constantBuffer,
+                        std::holds_alternative<SRV_>(index.mType));
+                    for (const auto& [pConstant, offset] : packed.mConstants) {
+                        const auto& constant = *pConstant;
                         Expects(!constant.mName.empty());
                         const auto& attr = at(attrs.mAttributes, constant.mName);
                         auto& dst = runtimeConstantBuffer.mConstants.emplace_back();
@@ -814,8 +1180,9 @@ void RenderSolutionFactory::build(const Shader::AttributeDatabase& attrs, std::s
                             ), attr.mSource);
                         dst.mSource = attr.mSource;
                         dst.mID = gsl::narrow<uint32_t>(attrs.mIndex.at(constant.mName));
-                        runtimeConstantBuffer.mSize += getSize(constant.mType);
+                        dst.mOffset = offset;
                     }
+                    runtimeConstantBuffer.mSize = packed.mSize;
                 }
 
                 subpass.mDescriptors.reserve(group.mRootSignature.mDatabase.mDescriptors.size());
@@ -1044,26 +1411,39 @@ void RenderSolutionFactory::build(const Shader::AttributeDatabase& attrs, std::s
 
             for (const auto& path : graph.mViewStates) {
                 for (const auto& trans : path.second.mTransitions) {
-                    if (trans.mNodeID != nodeID)
+                    const bool bEnd = (trans.mNodeID == nodeID);
+                    const bool bBegin = (trans.mBeginNodeID == nodeID);
+                    if (!bEnd && !bBegin)
                         continue;
                     auto resourceKey = path.first;
 
                     uint32_t rtHandle{};
+                    bool bBackBuffer = false;
                     if (exists(bbs, resourceKey.first)) {
                         rtHandle = 0;
+                        bBackBuffer = true;
                         if (std::holds_alternative<Present_>(trans.mSource.mState))
                             continue;
                     } else {
                         rtHandle = rtIndex.at(std::get<0>(resourceKey));
                     }
 
+                    // back buffer index changes per frame, its barriers are never split
+                    auto flags = RESOURCE_BARRIER_FLAG_NONE;
+                    if (trans.mBeginNodeID != trans.mNodeID && !bBackBuffer) {
+                        flags = bEnd ? RESOURCE_BARRIER_FLAG_END_ONLY : RESOURCE_BARRIER_FLAG_BEGIN_ONLY;
+                    } else if (!bEnd) {
+                        continue;
+                    }
+
                     postTransitions.emplace(
                         std::pair{
                             resourceKey,
                             RenderViewTransition{
                                 rtHandle,
                                 buildResourceStates(trans.mSource),
-                                buildResourceStates(trans.mTarget)
+                                buildResourceStates(trans.mTarget),
+                                flags
                             }
                         }
                     );
@@ -1075,6 +1455,9 @@ void RenderSolutionFactory::build(const Shader::AttributeDatabase& attrs, std::s
             }
         }
     }
+
+    buildFramebufferAliasing(rtIndex, sl);
+    reportFramebuffers(rtIndex, sl);
 }
 
 void RenderGraphFactory::buildShaderGroupFromSolutions() {
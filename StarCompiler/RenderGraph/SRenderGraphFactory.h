@@ -61,6 +61,9 @@ public:
     void addContentOrdered(const UnorderedRenderQueue& content,
         std::string_view pipelineName, std::string_view passName,
         RenderSolution& renderWorks) const;
+
+    // writes the compiler inputs of build(), used as key of the compiled solution cache
+    void outputCacheKey(std::ostream& os) const;
 private:
     void collectFramebuffers(
         OrderedNameMap<RenderTargetResource>& bbs,
@@ -75,6 +78,17 @@ private:
         std::map<std::string, uint32_t>& rtIndex
     ) const;
 
+    void buildFramebufferAliasing(
+        const std::map<std::string, uint32_t>& rtIndex,
+        RenderSolution& renderWorks
+    ) const;
+
+    // prints the bytes of each framebuffer and checks mFramebufferBudget
+    void reportFramebuffers(
+        const std::map<std::string, uint32_t>& rtIndex,
+        const RenderSolution& renderWorks
+    ) const;
+
     void collectRTVsMinimal(
         size_t rtvOffset,
         const OrderedNameMap<RenderTargetResource>& bbs,
@@ -99,6 +113,13 @@ public:
     std::string mName;
     RenderConfigs mConfig;
     uint32_t mBackBufferCount = 3;
+    // framebuffer memory is also reported at these back buffer sizes, e.g. { 3840, 2160 },
+    // framebuffers of the back buffer size scale with it, the others keep their size
+    std::vector<std::pair<uint32_t, uint32_t>> mReportResolutions;
+    // bytes of all framebuffers, aliased ones counted once per slot, 0 disables the check
+    uint64_t mFramebufferBudget = 0;
+    // exceeding the budget throws instead of warning
+    bool mFailOverFramebufferBudget = false;
     std::vector<std::string> mGraphOrder;
     Map<std::string, GraphicsRenderNodeGraph> mNodeGraphs;
     const Shader::ShaderGroups* mShaderGroups = nullptr;
@@ -76,9 +76,10 @@ struct ResolveDest_;
 struct ResolveSource_;
 struct AccelerationStructure_;
 struct Present_;
+struct ShadingRateSource_;
 struct Predication_;
 
-using ResourceState = std::variant<Common_, RenderTarget_, UnorderedAccess_, DepthWrite_, DepthRead_, ShaderResource_, CopyDest_, CopySource_, ResolveDest_, ResolveSource_, AccelerationStructure_, Present_>;
+using ResourceState = std::variant<Common_, RenderTarget_, UnorderedAccess_, DepthWrite_, DepthRead_, ShaderResource_, CopyDest_, CopySource_, ResolveDest_, ResolveSource_, AccelerationStructure_, Present_, ShadingRateSource_>;
 
 struct RenderValue;
 struct RenderTargetState;
@@ -86,6 +87,7 @@ struct NodeRenderTargetState;
 struct RenderTargetStateTransition;
 struct RenderTargetStateTransitions;
 struct UnorderedRenderContent;
+struct UpscaleInputs;
 struct RenderNode;
 struct RenderGroup;
 struct BackBuffer_;
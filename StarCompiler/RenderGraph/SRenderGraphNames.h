@@ -60,6 +60,7 @@ inline const char* getName(const ResolveDest_& v) noexcept { return "ResolveDest
 inline const char* getName(const ResolveSource_& v) noexcept { return "ResolveSource"; }
 inline const char* getName(const AccelerationStructure_& v) noexcept { return "AccelerationStructure"; }
 inline const char* getName(const Present_& v) noexcept { return "Present"; }
+inline const char* getName(const ShadingRateSource_& v) noexcept { return "ShadingRateSource"; }
 inline const char* getName(const Predication_& v) noexcept { return "Predication"; }
 inline const char* getName(const RenderValue& v) noexcept { return "RenderValue"; }
 inline const char* getName(const RenderTargetState& v) noexcept { return "RenderTargetState"; }
@@ -67,6 +68,7 @@ inline const char* getName(const NodeRenderTargetState& v) noexcept { return "No
 inline const char* getName(const RenderTargetStateTransition& v) noexcept { return "RenderTargetStateTransition"; }
 inline const char* getName(const RenderTargetStateTransitions& v) noexcept { return "RenderTargetStateTransitions"; }
 inline const char* getName(const UnorderedRenderContent& v) noexcept { return "UnorderedRenderContent"; }
+inline const char* getName(const UpscaleInputs& v) noexcept { return "UpscaleInputs"; }
 inline const char* getName(const RenderNode& v) noexcept { return "RenderNode"; }
 inline const char* getName(const RenderGroup& v) noexcept { return "RenderGroup"; }
 inline const char* getName(const BackBuffer_& v) noexcept { return "BackBuffer"; }
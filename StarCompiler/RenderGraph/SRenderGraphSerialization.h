@@ -233,6 +233,12 @@ template<class Archive>
 void serialize(Archive& ar, Star::Graphics::Render::Present_& v, const uint32_t version) {
 }
 
+STAR_CLASS_IMPLEMENTATION(Star::Graphics::Render::ShadingRateSource_, object_serializable);
+STAR_CLASS_TRACKING(Star::Graphics::Render::ShadingRateSource_, track_never);
+template<class Archive>
+void serialize(Archive& ar, Star::Graphics::Render::ShadingRateSource_& v, const uint32_t version) {
+}
+
 STAR_CLASS_IMPLEMENTATION(Star::Graphics::Render::Raytracing_, object_serializable);
 STAR_CLASS_TRACKING(Star::Graphics::Render::Raytracing_, track_never);
 template<class Archive>
@@ -281,6 +287,7 @@ void serialize(Archive& ar, Star::Graphics::Render::RenderTargetStateTransition&
     ar & v.mNodeID;
     ar & v.mSource;
     ar & v.mTarget;
+    ar & v.mBeginNodeID;
 }
 
 STAR_CLASS_IMPLEMENTATION(Star::Graphics::Render::RenderTargetStateTransitions, object_serializable);
@@ -352,6 +359,24 @@ void serialize(Archive& ar, Star::Graphics::Render::RenderSwapChainBuilder& v, c
     ar & v.mRenderWorks;
 }
 
+STAR_CLASS_IMPLEMENTATION(Star::Graphics::Render::SM5_0_, object_serializable);
+STAR_CLASS_TRACKING(Star::Graphics::Render::SM5_0_, track_never);
+template<class Archive>
+void serialize(Archive& ar, Star::Graphics::Render::SM5_0_& v, const uint32_t version) {
+}
+
+STAR_CLASS_IMPLEMENTATION(Star::Graphics::Render::SM6_0_, object_serializable);
+STAR_CLASS_TRACKING(Star::Graphics::Render::SM6_0_, track_never);
+template<class Archive>
+void serialize(Archive& ar, Star::Graphics::Render::SM6_0_& v, const uint32_t version) {
+}
+
+STAR_CLASS_IMPLEMENTATION(Star::Graphics::Render::SM6_6_, object_serializable);
+STAR_CLASS_TRACKING(Star::Graphics::Render::SM6_6_, track_never);
+template<class Archive>
+void serialize(Archive& ar, Star::Graphics::Render::SM6_6_& v, const uint32_t version) {
+}
+
 STAR_CLASS_IMPLEMENTATION(Star::Graphics::Render::RenderConfigs, object_serializable);
 STAR_CLASS_TRACKING(Star::Graphics::Render::RenderConfigs, track_never);
 template<class Archive>
@@ -359,6 +384,7 @@ void serialize(Archive& ar, Star::Graphics::Render::RenderConfigs& v, const uint
     ar & v.mVerbose;
     ar & v.mStrictLightingColorSpace;
     ar & v.mFramebufferFetch;
+    ar & v.mShaderModel;
 }
 
 } // namespace serialization
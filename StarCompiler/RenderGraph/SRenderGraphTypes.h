@@ -230,9 +230,12 @@ inline bool operator!=(const AccelerationStructure_&, const AccelerationStructur
 struct Present_ {} static constexpr Present;
 inline bool operator==(const Present_&, const Present_&) noexcept { return true; }
 inline bool operator!=(const Present_&, const Present_&) noexcept { return false; }
+struct ShadingRateSource_ {} static constexpr ShadingRateSource;
+inline bool operator==(const ShadingRateSource_&, const ShadingRateSource_&) noexcept { return true; }
+inline bool operator!=(const ShadingRateSource_&, const ShadingRateSource_&) noexcept { return false; }
 struct Predication_ {} static constexpr Predication;
 
-using ResourceState = std::variant<Common_, RenderTarget_, UnorderedAccess_, DepthWrite_, DepthRead_, ShaderResource_, CopyDest_, CopySource_, ResolveDest_, ResolveSource_, AccelerationStructure_, Present_>;
+using ResourceState = std::variant<Common_, RenderTarget_, UnorderedAccess_, DepthWrite_, DepthRead_, ShaderResource_, CopyDest_, CopySource_, ResolveDest_, ResolveSource_, AccelerationStructure_, Present_, ShadingRateSource_>;
 
 struct RenderValue {
     RenderValue() = default;
@@ -318,6 +321,8 @@ struct RenderTargetStateTransition {
     uint32_t mNodeID = 0;
     RenderTargetState mSource;
     RenderTargetState mTarget;
+    // last node using the source state, the barrier is split if it differs from mNodeID
+    uint32_t mBeginNodeID = 0;
 };
 
 struct RenderTargetStateTransitions {
@@ -330,6 +335,13 @@ struct UnorderedRenderContent {
     std::vector<MetaID> mContents;
 };
 
+// inputs of a temporal upscaling node by render target name, motion may be empty
+struct UpscaleInputs {
+    std::string mColor;
+    std::string mDepth;
+    std::string mMotion;
+};
+
 struct RenderNode {
     RenderNode() = default;
     RenderNode(std::string name, ResourceDataViewMap<RenderValue> outputs)
@@ -382,6 +394,12 @@ struct RenderNode {
     ResourceDataViewMap<RenderValue> mInputs;
     ResourceSampling mSampling;
     std::string mRootSignature;
+    bool mOcclusionCulling = false;
+    bool mLightCulling = false;
+    bool mShadowCache = false;
+    SHADING_RATE mShadingRate = SHADING_RATE_1X1;
+    uint32_t mView = 0;
+    std::optional<UpscaleInputs> mUpscaling;
 };
 
 struct RenderGroup {
@@ -418,6 +436,7 @@ struct RenderConfigs {
     bool mVerbose = false;
     bool mStrictLightingColorSpace = false;
     bool mFramebufferFetch = false;
+    ShaderModel mShaderModel;
 };
 
 } // namespace Render
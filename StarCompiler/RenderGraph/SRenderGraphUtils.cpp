@@ -120,11 +120,13 @@ void validateTextureViewTransition(const ResourceState& src, const ResourceState
         [&](RenderTarget_, ResolveDest_) {},
         [&](RenderTarget_, ResolveSource_) {},
         [&](RenderTarget_, Present_) {},
+        [&](RenderTarget_, ShadingRateSource_) {},
         [&](UnorderedAccess_, Common_) {},
         [&](UnorderedAccess_, UnorderedAccess_) {},
         [&](UnorderedAccess_, ShaderResource_) {},
         [&](UnorderedAccess_, CopyDest_) {},
         [&](UnorderedAccess_, CopySource_) {},
+        [&](UnorderedAccess_, ShadingRateSource_) {},
         [&](DepthWrite_, Common_) {},
         [&](DepthWrite_, DepthWrite_) {},
         [&](DepthWrite_, DepthRead_) {},
@@ -149,6 +151,7 @@ void validateTextureViewTransition(const ResourceState& src, const ResourceState
         [&](ShaderResource_, CopySource_) {},
         [&](ShaderResource_, ResolveDest_) {},
         [&](ShaderResource_, ResolveSource_) {},
+        [&](ShaderResource_, ShadingRateSource_) {},
         [&](CopyDest_, auto) {},
         [&](CopySource_, auto) {},
         [&](ResolveDest_, Common_) {},
@@ -166,6 +169,12 @@ void validateTextureViewTransition(const ResourceState& src, const ResourceState
         [&](Present_, RenderTarget_) {},
         [&](Present_, ResolveDest_) {},
         [&](Present_, Present_) {},
+        [&](ShadingRateSource_, Common_) {},
+        [&](ShadingRateSource_, RenderTarget_) {},
+        [&](ShadingRateSource_, UnorderedAccess_) {},
+        [&](ShadingRateSource_, ShaderResource_) {},
+        [&](ShadingRateSource_, CopyDest_) {},
+        [&](ShadingRateSource_, ShadingRateSource_) {},
         [&](auto s, auto t) {
             throw std::invalid_argument("cannot transit from " + std::to_string(src.index())
                 + " to " + std::to_string(dst.index()));
@@ -596,6 +605,14 @@ void validateTextureViewState(const Resource& resource, const ResourceDataView&
                 },
                 [&](Present_) {
                     throw std::invalid_argument("Present_ is output only");
+                },
+                [&](ShadingRateSource_) {
+                    if (resource.mFormat != Format::R8_UINT) {
+                        throw std::invalid_argument("shading rate image must be R8_UINT");
+                    }
+                    if (!std::holds_alternative<std::monostate>(resource.mSampling)) {
+                        throw std::invalid_argument("shading rate image cannot be multisampled");
+                    }
                 }
             ), state);
         },
@@ -636,6 +653,9 @@ void validateTextureViewState(const Resource& resource, const ResourceDataView&
                     throw std::invalid_argument("target cannot be AccelerationStructure");
                 },
                 [&](Present_) {
+                },
+                [&](ShadingRateSource_) {
+                    throw std::invalid_argument("ShadingRateSource_ is input only");
                 }
             ), state);
         }
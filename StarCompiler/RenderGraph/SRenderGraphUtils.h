@@ -168,6 +168,9 @@ inline RESOURCE_STATES buildResourceStates(const RenderTargetState& state) {
         },
         [](Present_) {
             return RESOURCE_STATE_PRESENT;
+        },
+        [](ShadingRateSource_) {
+            return RESOURCE_STATE_SHADING_RATE_SOURCE;
         }
     ), state.mState);
 }
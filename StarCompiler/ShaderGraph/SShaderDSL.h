@@ -30,9 +30,10 @@ namespace DSL {
 
 static const AttributeDescriptor TypeFrame{ PerFrame, Table, Dynamic, EngineSource };
 static const AttributeDescriptor TypePass{ PerPass, Table, Dynamic, EngineSource };
-static const AttributeDescriptor TypeInstance{ PerInstance, Table, Dynamic, EngineSource };
+static const AttributeDescriptor TypeInstance{ PerInstance, SRV, Dynamic, EngineSource };
 static const AttributeDescriptor TypeRenderTarget{ PerPass, Table, Persistent, RenderTargetSource };
 static const AttributeDescriptor TypeMaterial{ PerBatch, Table, Persistent, MaterialSource };
+static const AttributeDescriptor TypeBindless{ PerBatch, Table, Persistent, "Bindless", MaterialSource, Unbounded };
 static const AttributeDescriptor TypeStaticSampler{ PerFrame, SSV, Persistent, EngineSource };
 
 static const ShaderValue global_state = {};
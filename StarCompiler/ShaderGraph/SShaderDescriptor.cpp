@@ -19,6 +19,72 @@
 
 namespace Star::Graphics::Render::Shader {
 
+namespace {
+
+const char* getRootSignatureName(FILTER filter) {
+    switch (filter) {
+    case FILTER_MIN_MAG_MIP_POINT: return "FILTER_MIN_MAG_MIP_POINT";
+    case FILTER_MIN_MAG_POINT_MIP_LINEAR: return "FILTER_MIN_MAG_POINT_MIP_LINEAR";
+    case FILTER_MIN_POINT_MAG_LINEAR_MIP_POINT: return "FILTER_MIN_POINT_MAG_LINEAR_MIP_POINT";
+    case FILTER_MIN_POINT_MAG_MIP_LINEAR: return "FILTER_MIN_POINT_MAG_MIP_LINEAR";
+    case FILTER_MIN_LINEAR_MAG_MIP_POINT: return "FILTER_MIN_LINEAR_MAG_MIP_POINT";
+    case FILTER_MIN_LINEAR_MAG_POINT_MIP_LINEAR: return "FILTER_MIN_LINEAR_MAG_POINT_MIP_LINEAR";
+    case FILTER_MIN_MAG_LINEAR_MIP_POINT: return "FILTER_MIN_MAG_LINEAR_MIP_POINT";
+    case FILTER_MIN_MAG_MIP_LINEAR: return "FILTER_MIN_MAG_MIP_LINEAR";
+    case FILTER_ANISOTROPIC: return "FILTER_ANISOTROPIC";
+    case FILTER_COMPARISON_MIN_MAG_MIP_POINT: return "FILTER_COMPARISON_MIN_MAG_MIP_POINT";
+    case FILTER_COMPARISON_MIN_MAG_POINT_MIP_LINEAR: return "FILTER_COMPARISON_MIN_MAG_POINT_MIP_LINEAR";
+    case FILTER_COMPARISON_MIN_POINT_MAG_LINEAR_MIP_POINT: return "FILTER_COMPARISON_MIN_POINT_MAG_LINEAR_MIP_POINT";
+    case FILTER_COMPARISON_MIN_POINT_MAG_MIP_LINEAR: return "FILTER_COMPARISON_MIN_POINT_MAG_MIP_LINEAR";
+    case FILTER_COMPARISON_MIN_LINEAR_MAG_MIP_POINT: return "FILTER_COMPARISON_MIN_LINEAR_MAG_MIP_POINT";
+    case FILTER_COMPARISON_MIN_LINEAR_MAG_POINT_MIP_LINEAR: return "FILTER_COMPARISON_MIN_LINEAR_MAG_POINT_MIP_LINEAR";
+    case FILTER_COMPARISON_MIN_MAG_LINEAR_MIP_POINT: return "FILTER_COMPARISON_MIN_MAG_LINEAR_MIP_POINT";
+    case FILTER_COMPARISON_MIN_MAG_MIP_LINEAR: return "FILTER_COMPARISON_MIN_MAG_MIP_LINEAR";
+    case FILTER_COMPARISON_ANISOTROPIC: return "FILTER_COMPARISON_ANISOTROPIC";
+    default:
+        throw std::invalid_argument("static sampler filter not supported yet");
+    }
+}
+
+const char* getRootSignatureName(TEXTURE_ADDRESS_MODE mode) {
+    switch (mode) {
+    case TEXTURE_ADDRESS_MODE_WRAP: return "TEXTURE_ADDRESS_WRAP";
+    case TEXTURE_ADDRESS_MODE_MIRROR: return "TEXTURE_ADDRESS_MIRROR";
+    case TEXTURE_ADDRESS_MODE_CLAMP: return "TEXTURE_ADDRESS_CLAMP";
+    case TEXTURE_ADDRESS_MODE_BORDER: return "TEXTURE_ADDRESS_BORDER";
+    case TEXTURE_ADDRESS_MODE_MIRROR_ONCE: return "TEXTURE_ADDRESS_MIRROR_ONCE";
+    default:
+        throw std::invalid_argument("invalid texture address mode");
+    }
+}
+
+const char* getRootSignatureName(COMPARISON_FUNC func) {
+    switch (func) {
+    case COMPARISON_FUNC_NEVER: return "COMPARISON_NEVER";
+    case COMPARISON_FUNC_LESS: return "COMPARISON_LESS";
+    case COMPARISON_FUNC_EQUAL: return "COMPARISON_EQUAL";
+    case COMPARISON_FUNC_LESS_EQUAL: return "COMPARISON_LESS_EQUAL";
+    case COMPARISON_FUNC_GREATER: return "COMPARISON_GREATER";
+    case COMPARISON_FUNC_NOT_EQUAL: return "COMPARISON_NOT_EQUAL";
+    case COMPARISON_FUNC_GREATER_EQUAL: return "COMPARISON_GREATER_EQUAL";
+    case COMPARISON_FUNC_ALWAYS: return "COMPARISON_ALWAYS";
+    default:
+        throw std::invalid_argument("invalid comparison func");
+    }
+}
+
+const char* getRootSignatureName(STATIC_BORDER_COLOR color) {
+    switch (color) {
+    case STATIC_BORDER_COLOR_TRANSPARENT_BLACK: return "STATIC_BORDER_COLOR_TRANSPARENT_BLACK";
+    case STATIC_BORDER_COLOR_OPAQUE_BLACK: return "STATIC_BORDER_COLOR_OPAQUE_BLACK";
+    case STATIC_BORDER_COLOR_OPAQUE_WHITE: return "STATIC_BORDER_COLOR_OPAQUE_WHITE";
+    default:
+        throw std::invalid_argument("invalid static border color");
+    }
+}
+
+}
+
 ShaderVisibilityType getShaderVisibilityType(ShaderStageType stage) {
     return visit(overload(
         [](OM_ v) -> ShaderVisibilityType { throw std::invalid_argument("output merger do not support root signature"); },
@@ -75,4 +141,41 @@ char getRegisterPrefix(const DescriptorType& type) noexcept {
     ), type);
 }
 
+std::string getStaticSamplerParameters(const StaticSampler& sampler) {
+    const StaticSampler defaults{};
+    std::ostringstream oss;
+    // floats need a decimal point, e.g. 1.00000f
+    oss << std::showpoint;
+    if (sampler.mFilter != defaults.mFilter)
+        oss << ", filter = " << getRootSignatureName(sampler.mFilter);
+    if (sampler.mAddressU != defaults.mAddressU)
+        oss << ", addressU = " << getRootSignatureName(sampler.mAddressU);
+    if (sampler.mAddressV != defaults.mAddressV)
+        oss << ", addressV = " << getRootSignatureName(sampler.mAddressV);
+    if (sampler.mAddressW != defaults.mAddressW)
+        oss << ", addressW = " << getRootSignatureName(sampler.mAddressW);
+    if (sampler.mMipLODBias != defaults.mMipLODBias)
+        oss << ", mipLODBias = " << sampler.mMipLODBias << "f";
+    if (sampler.mMaxAnisotropy != defaults.mMaxAnisotropy)
+        oss << ", maxAnisotropy = " << sampler.mMaxAnisotropy;
+    if (sampler.mComparisonFunc != defaults.mComparisonFunc)
+        oss << ", comparisonFunc = " << getRootSignatureName(sampler.mComparisonFunc);
+    if (sampler.mBorderColor != defaults.mBorderColor)
+        oss << ", borderColor = " << getRootSignatureName(sampler.mBorderColor);
+    if (sampler.mMinLOD != defaults.mMinLOD)
+        oss << ", minLOD = " << sampler.mMinLOD << "f";
+    if (sampler.mMaxLOD != defaults.mMaxLOD)
+        oss << ", maxLOD = " << sampler.mMaxLOD << "f";
+    return oss.str();
+}
+
+const ShaderAttribute* findSharedSampler(const std::vector<const ShaderAttribute*>& attrs,
+    const ShaderAttribute& attr) noexcept {
+    for (const auto* pAttr : attrs) {
+        if (pAttr->mSampler == attr.mSampler)
+            return pAttr;
+    }
+    return nullptr;
+}
+
 }
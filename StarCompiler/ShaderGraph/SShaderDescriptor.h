@@ -26,4 +26,11 @@ ShaderStageType getShaderStageType(ShaderVisibilityType e);
 const char* getRootDescriptorName(const DescriptorType& type) noexcept;
 char getRegisterPrefix(const DescriptorType& type) noexcept;
 
+// root signature parameters of the sampler that differ from the hlsl defaults, e.g. ", filter = ..."
+std::string getStaticSamplerParameters(const StaticSampler& sampler);
+
+// first sampler of attrs with the state of attr, static samplers of the same state share a register
+const ShaderAttribute* findSharedSampler(const std::vector<const ShaderAttribute*>& attrs,
+    const ShaderAttribute& attr) noexcept;
+
 }
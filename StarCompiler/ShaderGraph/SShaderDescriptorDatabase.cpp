@@ -17,9 +17,67 @@
 
 #include "SShaderDescriptorDatabase.h"
 #include "SShaderAttribute.h"
+#include <Star/Graphics/SRenderUtils.h>
 
 namespace Star::Graphics::Render::Shader {
 
+PackedConstantBuffer packConstantBuffer(const ConstantBuffer& cb, bool bStructured) {
+    PackedConstantBuffer packed;
+    packed.mConstants.reserve(cb.mValues.size());
+
+    std::vector<const Constant*> values;
+    values.reserve(cb.mValues.size());
+    for (const auto& c : cb.mValues) {
+        if (!getSize(c.mType)) {
+            throw std::invalid_argument("constant " + c.mName + " has unknown size");
+        }
+        values.emplace_back(&c);
+    }
+
+    // larger values first, so smaller ones fill the gaps
+    std::stable_sort(values.begin(), values.end(), [](const Constant* lhs, const Constant* rhs) {
+        return getSize(lhs->mType) > getSize(rhs->mType);
+    });
+
+    if (bStructured) {
+        uint32_t offset = 0;
+        for (const auto* c : values) {
+            packed.mConstants.emplace_back(PackedConstant{ c, offset });
+            offset += getSize(c->mType);
+        }
+        packed.mSize = (offset + 3) & ~3u;
+        return packed;
+    }
+
+    // first fit into 16-byte registers, matrices occupy whole registers
+    std::vector<uint32_t> registers; // bytes used in each register
+    for (const auto* c : values) {
+        auto sz = getSize(c->mType);
+        if (sz >= 16) {
+            auto count = (sz + 15) / 16;
+            packed.mConstants.emplace_back(PackedConstant{ c, gsl::narrow_cast<uint32_t>(registers.size() * 16) });
+            registers.resize(registers.size() + count, 16);
+            registers.back() = sz - (count - 1) * 16;
+            continue;
+        }
+        auto iter = std::find_if(registers.begin(), registers.end(), [sz](uint32_t used) {
+            return used + sz <= 16;
+        });
+        if (iter == registers.end()) {
+            iter = registers.emplace(registers.end(), 0u);
+        }
+        auto id = gsl::narrow_cast<uint32_t>(std::distance(registers.begin(), iter));
+        packed.mConstants.emplace_back(PackedConstant{ c, id * 16 + *iter });
+        *iter += sz;
+    }
+    std::stable_sort(packed.mConstants.begin(), packed.mConstants.end(),
+        [](const PackedConstant& lhs, const PackedConstant& rhs) {
+            return lhs.mOffset < rhs.mOffset;
+        });
+    packed.mSize = gsl::narrow_cast<uint32_t>(registers.size() * 16);
+    return packed;
+}
+
 bool DescriptorDatabase::try_addAttribute(const ShaderAttribute& attr, ShaderVisibilityType vis) {
     bool succeeded = false;
     const auto& d = attr.mDescriptor;
@@ -32,16 +90,17 @@ bool DescriptorDatabase::try_addAttribute(const ShaderAttribute& attr, ShaderVis
         mConstantBuffers[index].mValues.emplace(Constant{ attr.mType, attr.mName });
         succeeded = true;
     } else {
-        auto index = getDescriptorIndex(d, vis);
+        auto& collection = mDescriptors[index];
         visit(overload(
             [&](auto t) {
+                auto& list = collection.mResourceViewLists[d.mRegisterSpace];
                 visit(overload(
                     [&](Bounded_) {
-                        auto res = mDescriptors[index].mResourceViewLists[d.mRegisterSpace].mRanges[t].mSubranges[d.mSource].mAttributes.emplace(attr);
+                        auto res = list.mRanges[t].mSubranges[d.mSource].mAttributes.emplace(attr);
                         succeeded = res.second;
                     },
                     [&](Unbounded_) {
-                        const auto& unboundedSet = mDescriptors[index].mResourceViewLists[d.mRegisterSpace].mUnboundedDescriptors;
+                        const auto& unboundedSet = list.mUnboundedDescriptors;
                         if (!unboundedSet.empty()) {
                             auto iter = unboundedSet.find(DescriptorType{ t });
                             if (iter != unboundedSet.end() && iter->second.mAttribute.mName == attr.mName) {
@@ -50,20 +109,21 @@ bool DescriptorDatabase::try_addAttribute(const ShaderAttribute& attr, ShaderVis
                                 throw std::invalid_argument("resource view register space: " + d.mRegisterSpace + "already have unbounded descriptor");
                             }
                         } else {
-                            mDescriptors[index].mResourceViewLists[d.mRegisterSpace].mUnboundedDescriptors[t].mAttribute = attr;
+                            list.mUnboundedDescriptors[t].mAttribute = attr;
                             succeeded = true;
                         }
                     }
                 ), d.mBoundedness);
             },
             [&](SSV_ t) {
+                auto& list = collection.mSamplerLists[d.mRegisterSpace];
                 visit(overload(
                     [&](Bounded_) {
-                        auto res = mDescriptors[index].mSamplerLists[d.mRegisterSpace].mRanges[t].mSubranges[d.mSource].mAttributes.emplace(attr);
+                        auto res = list.mRanges[t].mSubranges[d.mSource].mAttributes.emplace(attr);
                         succeeded = res.second;
                     },
                     [&](Unbounded_) {
-                        const auto& unboundedSet = mDescriptors[index].mSamplerLists[d.mRegisterSpace].mUnboundedDescriptors;
+                        const auto& unboundedSet = list.mUnboundedDescriptors;
                         if (!unboundedSet.empty()) {
                             auto iter = unboundedSet.find(DescriptorType{ t });
                             if (iter != unboundedSet.end() && iter->second.mAttribute.mName == attr.mName) {
@@ -72,7 +132,7 @@ bool DescriptorDatabase::try_addAttribute(const ShaderAttribute& attr, ShaderVis
                                 throw std::invalid_argument("sampler view register space: " + d.mRegisterSpace + "already have unbounded descriptor");
                             }
                         } else {
-                            mDescriptors[index].mSamplerLists[d.mRegisterSpace].mUnboundedDescriptors[t].mAttribute = attr;
+                            list.mUnboundedDescriptors[t].mAttribute = attr;
                             succeeded = true;
                         }
                     }
@@ -96,9 +156,7 @@ void DescriptorDatabase::mergeConstantBuffers(UpdateEnum update, DescriptorDatab
             continue;
 
         auto& rhsTable = rhs.mConstantBuffers[index];
-        for (const auto& v : cb.mValues) {
-            rhsTable.mValues.emplace(v);
-        }
+        rhsTable.mValues.insert(cb.mValues.begin(), cb.mValues.end());
     }
 }
 
@@ -119,27 +177,30 @@ void reserveDescriptorCapacity(const DescriptorList& list, DescriptorList& rhsLi
     }
 }
 
-void copyDescriptors(const DescriptorList& list, ShaderVisibilityType vis, DescriptorDatabase& rhs) {
+// attributes of a list share its index and register space, subranges are merged as a whole
+// instead of looking up the index, list and range of every attribute
+void copyDescriptors(const DescriptorList& list, const std::string& space,
+    Map<std::string, DescriptorList>& rhsLists, DescriptorDatabase& rhs
+) {
+    // unbounded descriptors are not copied, lists without ranges are left out
+    if (list.mRanges.empty())
+        return;
+    auto& rhsList = rhsLists[space];
     for (const auto& [type, range] : list.mRanges) {
+        auto& rhsRange = rhsList.mRanges[type];
         for (const auto& [source, subrange] : range.mSubranges) {
-            for (const auto& attr : subrange.mAttributes) {
-                rhs.try_addAttribute(attr, vis);
-                rhs.mRegisterSpaces.emplace(std::pair{
-                    attr.mDescriptor.mDescriptorType,
-                    attr.mDescriptor.mRegisterSpace,
-                });
-            }
+            auto& rhsAttributes = rhsRange.mSubranges[source].mAttributes;
+            rhsAttributes.insert(subrange.mAttributes.begin(), subrange.mAttributes.end());
         }
+        rhs.mRegisterSpaces.emplace(std::pair{ type, space });
     }
 }
 
 void validateDescriptors(const DescriptorList& list) {
     for (const auto& [type, range] : list.mRanges) {
         for (const auto& [source, subrange] : range.mSubranges) {
-            for (const auto& attr : subrange.mAttributes) {
-                if (subrange.mAttributes.empty()) {
-                    throw std::runtime_error("subrange is empty");
-                }
+            if (subrange.mAttributes.empty()) {
+                throw std::runtime_error("subrange is empty");
             }
         }
     }
@@ -201,22 +262,31 @@ void DescriptorDatabase::collectDescriptors(UpdateEnum update, DescriptorDatabas
         if (index.mUpdate != update) {
             continue;
         }
+        auto hasRanges = [](const auto& lists) {
+            return std::any_of(lists.begin(), lists.end(), [](const auto& pair) {
+                return !pair.second.mRanges.empty();
+            });
+        };
+        if (!hasRanges(collection.mResourceViewLists) && !hasRanges(collection.mSamplerLists))
+            continue;
+        auto& rhsCollection = rhs.mDescriptors[index];
         for (const auto& [space, list] : collection.mResourceViewLists) {
-            copyDescriptors(list, index.mVisibility, rhs);
+            copyDescriptors(list, space, rhsCollection.mResourceViewLists, rhs);
         }
         for (const auto& [space, list] : collection.mSamplerLists) {
-            copyDescriptors(list, index.mVisibility, rhs);
+            copyDescriptors(list, space, rhsCollection.mSamplerLists, rhs);
         }
     }
 }
 
 void DescriptorDatabase::addConstantBuffersDescriptors() {
     for (const auto& [index, buffer] : mConstantBuffers) {
+        // root SRV constants are stored in a structured buffer, one element per instance
         auto d = AttributeDescriptor{
             index.mUpdate,
             index.mType,
             index.mPersistency,
-            CBV,
+            std::holds_alternative<SRV_>(index.mType) ? DescriptorType{ SRV } : DescriptorType{ CBV },
             "",
             EngineSource,
             Bounded,
@@ -328,17 +398,14 @@ DescriptorDatabase::Registers DescriptorDatabase::buildRegisters() {
     validate();
     Registers slots;
     {
-        std::map<DescriptorType, std::set<std::string>> spaces;
+        // register spaces are ordered by type, spaces of a type are numbered in order
+        const std::pair<DescriptorType, std::string>* prev = nullptr;
         uint32_t spaceID = 0;
-        for (const auto& [type, space] : mRegisterSpaces) {
-            auto iter = spaces[type].find(space);
-            Expects(iter == spaces[type].end());
-            auto spaceID = gsl::narrow<uint32_t>(spaces[type].size());
-            bool succeeded = false;
-            std::tie(iter, succeeded) = spaces[type].emplace(space);
-            Ensures(succeeded);
-            auto res = slots.mRegisterSpaces.try_emplace(std::pair{ type, space }, RegisterSpace{ spaceID });
-            Ensures(res.second);
+        for (const auto& key : mRegisterSpaces) {
+            spaceID = prev && prev->first == key.first ? spaceID + 1 : 0;
+            prev = &key;
+            auto res = slots.mRegisterSpaces.emplace_hint(slots.mRegisterSpaces.end(), key, RegisterSpace{ spaceID });
+            Ensures(res->second.mSpaceID == spaceID);
         }
     }
 
@@ -361,12 +428,29 @@ DescriptorDatabase::Registers DescriptorDatabase::buildRegisters() {
             if (index.mUpdate != update) {
                 continue;
             }
-            for (auto& [space, list] : collection.mResourceViewLists) {
-                list.mSlot = slots.mRootParameterSlots[index.mType]++;
-            }
-            for (auto& [space, list] : collection.mSamplerLists) {
-                list.mSlot = slots.mRootParameterSlots[index.mType]++;
-            }
+            // root parameters are emitted in the same order by ShaderGroup::generateRootSignature
+            visit(overload(
+                [&](Constants_) {
+                    throw std::invalid_argument("root signature Constants not supported yet");
+                },
+                [&](auto type) {
+                    for (auto& [space, list] : collection.mResourceViewLists) {
+                        list.mSlot = slots.mRootParameterCount;
+                        slots.mRootParameterCount += list.mRanges.at(DescriptorType{ type }).mCount;
+                    }
+                },
+                [&](SSV_) {
+                    // static samplers, no root parameter
+                },
+                [&](Table_) {
+                    for (auto& [space, list] : collection.mResourceViewLists) {
+                        list.mSlot = slots.mRootParameterCount++;
+                    }
+                    for (auto& [space, list] : collection.mSamplerLists) {
+                        list.mSlot = slots.mRootParameterCount++;
+                    }
+                }
+            ), index.mType);
         }
     }
 
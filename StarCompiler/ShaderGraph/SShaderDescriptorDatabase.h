@@ -21,6 +21,20 @@
 
 namespace Star::Graphics::Render::Shader {
 
+struct PackedConstant {
+    const Constant* mConstant = nullptr;
+    uint32_t mOffset = 0;
+};
+
+struct PackedConstantBuffer {
+    std::vector<PackedConstant> mConstants; // ordered by offset
+    uint32_t mSize = 0;
+};
+
+// cbuffer follows hlsl packing rules, values never straddle a 16-byte register
+// structured buffer elements are packed tightly
+PackedConstantBuffer packConstantBuffer(const ConstantBuffer& cb, bool bStructured = false);
+
 class DescriptorDatabase {
 public:
     struct RegisterSpace {
@@ -29,7 +43,7 @@ public:
     };
     struct Registers {
         std::map<std::pair<DescriptorType, std::string>, RegisterSpace> mRegisterSpaces;
-        std::map<RootParameterType, uint32_t> mRootParameterSlots;
+        uint32_t mRootParameterCount = 0;
     };
     // attributes
     bool try_addAttribute(const ShaderAttribute& attr, ShaderVisibilityType vis);
@@ -67,6 +67,7 @@ using Boundedness = std::variant<Bounded_, Unbounded_>;
 
 struct AttributeDescriptor;
 struct AttributeDatabase;
+struct StaticSampler;
 struct ShaderAttribute;
 
 enum ModuleBuilderFlags : uint32_t;
@@ -693,12 +693,67 @@ void ShaderGraph::addValueEdge(size_t srcNodeID, const ShaderValue& output,
     }
 }
 
+std::vector<bool> ShaderGraph::getLiveNodes() const {
+    // a node is live if it has side effects (no outputs)
+    // or any of its results reaches the final output node
+    size_t sz = num_vertices(mNodeGraph);
+    std::vector<bool> live(sz, false);
+    std::vector<size_t> stack;
+    stack.reserve(sz);
+
+    auto markLive = [&](size_t nodeID) {
+        if (!live[nodeID]) {
+            live[nodeID] = true;
+            stack.emplace_back(nodeID);
+        }
+    };
+
+    if (sz) {
+        markLive(0);
+    }
+    for (size_t nodeID = 0; nodeID != sz; ++nodeID) {
+        if (mNodeGraph[nodeID].mOutputs.empty()) {
+            markLive(nodeID);
+        }
+    }
+
+    while (!stack.empty()) {
+        auto nodeID = stack.back();
+        stack.pop_back();
+        {
+            auto edges = in_edges(nodeID, mNodeGraph);
+            for (auto iter = edges.first; iter != edges.second; ++iter) {
+                markLive(iter->m_source);
+            }
+        }
+        {
+            auto edges = in_edges(nodeID, mDependencyGraph);
+            for (auto iter = edges.first; iter != edges.second; ++iter) {
+                markLive(iter->m_source);
+            }
+        }
+        for (const auto& input : mNodeGraph[nodeID].mInputs) {
+            auto valueIter = mValueIndex.find(std::make_pair(nodeID, input.mName));
+            if (valueIter == mValueIndex.end())
+                continue;
+            auto edges = in_edges(valueIter->second, mValueGraph);
+            for (auto iter = edges.first; iter != edges.second; ++iter) {
+                markLive(mValueGraph[iter->m_source].first);
+            }
+        }
+    }
+
+    return live;
+}
+
 void ShaderGraph::getSubGraph(ShaderStageType stage, ShaderGraph& rhs) const {
     if (!rhs.empty()) {
         throw std::invalid_argument("rhs ShaderGraph is not empty");
     }
 
     size_t sz = num_vertices(mNodeGraph);
+    // dead nodes are not emitted, their results are never consumed
+    const auto live = getLiveNodes();
     std::map<size_t/*lhs nodeID*/, size_t /*rhs nodeID*/> nodeIndex;
 
     // Create Output Node
@@ -708,14 +763,17 @@ void ShaderGraph::getSubGraph(ShaderStageType stage, ShaderGraph& rhs) const {
         auto nodeID = k;
         const auto& node = mNodeGraph[nodeID];
         const auto& nodeStage = mNodeStages[nodeID];
-        if (nodeStage != stage) {
+        if (nodeStage != stage || !live[nodeID]) {
             continue;
         }
 
         for (const auto& output : node.mOutputs) {
             auto edges = out_edges(mValueIndex.at(std::make_pair(nodeID, output.mName)), mValueGraph);
             for (auto iter = edges.first; iter != edges.second; ++iter) {
-                auto dstStage = mNodeStages[mValueGraph[iter->m_target].first];
+                auto dstNodeID = mValueGraph[iter->m_target].first;
+                if (!live[dstNodeID])
+                    continue;
+                auto dstStage = mNodeStages[dstNodeID];
                 if (dstStage != stage) {
                     Output.mOutputs.emplace(output);
                     Output.mInputs.emplace(output);
@@ -732,7 +790,7 @@ void ShaderGraph::getSubGraph(ShaderStageType stage, ShaderGraph& rhs) const {
         const auto& lhsNode = mNodeGraph[lhsNodeID];
         const auto& lhsNodeStage = mNodeStages[lhsNodeID];
 
-        if (lhsNodeID == 0)
+        if (lhsNodeID == 0 || !live[lhsNodeID])
             continue;
 
         if (lhsNodeStage == stage) {
@@ -746,7 +804,7 @@ void ShaderGraph::getSubGraph(ShaderStageType stage, ShaderGraph& rhs) const {
     for (size_t k = 0; k != sz; ++k) {
         auto lhsNodeID = k;
 
-        if (lhsNodeID == 0)
+        if (lhsNodeID == 0 || !live[lhsNodeID])
             continue;
 
         const auto& lhsNode = mNodeGraph[lhsNodeID];
@@ -758,6 +816,8 @@ void ShaderGraph::getSubGraph(ShaderStageType stage, ShaderGraph& rhs) const {
         { // Dependency Graph
             auto edges = out_edges(lhsNodeID, mDependencyGraph);
             for (auto lhsEdge = edges.first; lhsEdge != edges.second; ++lhsEdge) {
+                if (!live[lhsEdge->m_target])
+                    continue;
                 if (mNodeStages[lhsEdge->m_target] != stage) {
                     rhs.addDependency(nodeIndex.at(lhsNodeID), rhsOutput);
                 } else {
@@ -768,6 +828,8 @@ void ShaderGraph::getSubGraph(ShaderStageType stage, ShaderGraph& rhs) const {
         { // Node Graph
             auto edges = out_edges(lhsNodeID, mNodeGraph);
             for (auto lhsEdge = edges.first; lhsEdge != edges.second; ++lhsEdge) {
+                if (!live[lhsEdge->m_target])
+                    continue;
                 if (mNodeStages[lhsEdge->m_target] != stage) {
                     // render nodes might be 
                     //    VS/ --PS 1
@@ -795,6 +857,8 @@ void ShaderGraph::getSubGraph(ShaderStageType stage, ShaderGraph& rhs) const {
 
             for (auto lhsEdge = edges.first; lhsEdge != edges.second; ++lhsEdge) {
                 auto lhsDstNodeID = mValueGraph[lhsEdge->m_target].first;
+                if (!live[lhsDstNodeID])
+                    continue;
                 if (mNodeStages[lhsDstNodeID] != stage) {
                     rhs.try_addValueEdge(rhsSrcNodeID, output, rhsOutput, output.mName);
                 } else {
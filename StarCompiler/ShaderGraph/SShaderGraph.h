@@ -95,6 +95,7 @@ private:
     void copyNodeDependenciesFromShaderGroup(size_t nodeID, ShaderGraph& rhs, size_t rhsNodeID) const; // validation required
 
     // Shader Graph
+    std::vector<bool> getLiveNodes() const;
     void sortNodes();
 public:
     std::vector<ShaderStageType> mNodeStages;
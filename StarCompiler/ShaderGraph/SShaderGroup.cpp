@@ -45,10 +45,17 @@ void ShaderGroup::validate() const {
     }
 }
 
-void ShaderGroup::buildProgramConstantBuffers(const AttributeMap& attrs) {
+void ShaderGroup::buildProgramRootSignatures(const AttributeMap& attrs, ProgramRootSignatures& built) {
     for (auto& [name, pair] : mPrograms) {
         auto& [program, rsg] = pair;
+        auto iter = built.find(program.get());
+        if (iter != built.end()) {
+            rsg = iter->second;
+            continue;
+        }
         program->buildConstantBuffers(attrs, rsg);
+        program->buildDescriptors(attrs, rsg);
+        built.emplace(program.get(), rsg);
     }
 }
 
@@ -69,16 +76,11 @@ void ShaderGroup::collectConstantBuffers() {
     }
 }
 
-void ShaderGroup::collectDescriptors(const AttributeMap& attrs) {
+void ShaderGroup::collectDescriptors() {
     mRootSignature.addConstantBuffersDescriptors();
 
     if (mGroups.empty()) {
         // Leaf Node
-        for (auto& [name, pair] : mPrograms) {
-            auto& [program, rsg] = pair;
-            program->buildDescriptors(attrs, rsg);
-        }
-
         for (uint32_t i = PerInstance; i != mUpdateFrequency; ++i) {
             for (auto& [name, pair] : mPrograms) {
                 auto& [program, rsg] = pair;
@@ -376,24 +378,22 @@ std::string ShaderGroup::generateRootSignature() const {
                         Expects(list.mUnboundedDescriptors.empty());
                         Expects(range.mCount);
 
+                        // registers are assigned in the order of the hlsl generator
+                        std::vector<const ShaderAttribute*> samplers;
                         uint32_t slot = range.mStart;
-                        if (range.mCapacity == 0) {
-                            auto sz = getDescriptorCapacity(range);
-                            for (uint32_t i = 0; i != sz; ++i) {
-                                OSS << bol << "StaticSampler(s" << slot++;
-                                outputSpace(oss, range);
-                                outputVisibility(oss, index.mVisibility);
-                                oss << ")," << eol;
-                            }
-                        } else {
-                            for (uint32_t i = 0; i != range.mCapacity; ++i) {
+                        for (const auto& [source, subrange] : range.mSubranges) {
+                            for (const auto& attr : subrange.mAttributes) {
+                                if (findSharedSampler(samplers, attr))
+                                    continue;
+                                samplers.emplace_back(&attr);
                                 OSS << bol << "StaticSampler(s" << slot++;
+                                oss << getStaticSamplerParameters(attr.mSampler);
                                 outputSpace(oss, range);
                                 outputVisibility(oss, index.mVisibility);
                                 oss << ")," << eol;
                             }
                         }
-                        Ensures(slot - range.mStart == range.mCount);
+                        Ensures(slot - range.mStart <= range.mCount);
                     }
                 },
                 [&](Table_) {
@@ -24,14 +24,18 @@ namespace Star::Graphics::Render::Shader {
 
 class ShaderRegister;
 
+// root signatures of programs only depend on the program and the attributes,
+// a program bound to several groups is built once and copied
+using ProgramRootSignatures = std::unordered_map<const ShaderProgram*, RootSignature>;
+
 class ShaderGroup {
 public:
     void validate() const;
     // bottom-up
-    void buildProgramConstantBuffers(const AttributeMap& attrs);
+    void buildProgramRootSignatures(const AttributeMap& attrs, ProgramRootSignatures& built);
 
     void collectConstantBuffers();
-    void collectDescriptors(const AttributeMap& attrs);
+    void collectDescriptors();
     void collectAttributes(const AttributeMap& attrs, AttributeDatabase& database) const;
 
     void buildRegisters();
@@ -19,6 +19,13 @@
 
 namespace Star::Graphics::Render::Shader {
 
+ShaderModel ShaderGroups::getShaderModel(std::string_view bundleName) const {
+    auto iter = mShaderModels.find(bundleName);
+    if (iter == mShaderModels.end())
+        return SM5_0;
+    return iter->second;
+}
+
 ShaderGroup* ShaderGroups::try_getGroup(std::string_view bundleName, std::string_view pipelineName, std::string_view passName) {
     auto bundleIter = mSolutions.find(bundleName);
     if (bundleIter == mSolutions.end())
@@ -93,13 +100,14 @@ void ShaderGroups::collectAttributes(const ShaderModules& modules, AttributeData
 
 void ShaderGroups::buildRootSignatures(const ShaderModules& modules, UpdateEnum frequency) {
     // collect shader usages
+    ProgramRootSignatures built;
     for (auto& [bundleName, bundle] : mSolutions) {
         for (auto& [pipelineName, pipeline] : bundle) {
             for (uint32_t i = 0; i != UpdateEnum::UpdateCount; ++i) {
                 for (auto& [name, group] : pipeline[i]) {
-                    group.buildProgramConstantBuffers(modules.mAttributes);
+                    group.buildProgramRootSignatures(modules.mAttributes, built);
                     group.collectConstantBuffers();
-                    group.collectDescriptors(modules.mAttributes);
+                    group.collectDescriptors();
                 }
             }
         }
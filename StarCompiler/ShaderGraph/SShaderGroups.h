@@ -38,7 +38,10 @@ public:
     void collectAttributes(const ShaderModules& modules, AttributeDatabase& database) const;
     void buildRootSignatures(const ShaderModules& modules, UpdateEnum frequency);
 
+    ShaderModel getShaderModel(std::string_view bundleName) const;
+
     Map<std::string, Map<std::string, PassGroup>> mSolutions;
+    Map<std::string, ShaderModel> mShaderModels;
 };
 
 }
@@ -197,6 +197,8 @@ enum UnityAttributeFlags : uint32_t {
     NoSampler = 1 << 16,
     PerMaterial = 1 << 17,
     PerDraw = 1 << 18,
+    // declared in the instancing buffer, varies per object without breaking instancing
+    Instanced = 1 << 19,
 };
 
 } // namespace Unity
@@ -264,6 +266,32 @@ struct AttributeDatabase {
     Map<std::string, uint32_t> mIndex;
 };
 
+// immutable sampler of a root signature, defaults are the ones of hlsl StaticSampler
+struct StaticSampler {
+    FILTER mFilter = FILTER_ANISOTROPIC;
+    TEXTURE_ADDRESS_MODE mAddressU = TEXTURE_ADDRESS_MODE_WRAP;
+    TEXTURE_ADDRESS_MODE mAddressV = TEXTURE_ADDRESS_MODE_WRAP;
+    TEXTURE_ADDRESS_MODE mAddressW = TEXTURE_ADDRESS_MODE_WRAP;
+    float mMipLODBias = 0;
+    uint32_t mMaxAnisotropy = 16;
+    COMPARISON_FUNC mComparisonFunc = COMPARISON_FUNC_LESS_EQUAL;
+    STATIC_BORDER_COLOR mBorderColor = STATIC_BORDER_COLOR_OPAQUE_WHITE;
+    float mMinLOD = 0;
+    float mMaxLOD = std::numeric_limits<float>::max();
+};
+
+inline bool operator==(const StaticSampler& lhs, const StaticSampler& rhs) noexcept {
+    return
+        std::forward_as_tuple(lhs.mFilter, lhs.mAddressU, lhs.mAddressV, lhs.mAddressW, lhs.mMipLODBias,
+            lhs.mMaxAnisotropy, lhs.mComparisonFunc, lhs.mBorderColor, lhs.mMinLOD, lhs.mMaxLOD) ==
+        std::forward_as_tuple(rhs.mFilter, rhs.mAddressU, rhs.mAddressV, rhs.mAddressW, rhs.mMipLODBias,
+            rhs.mMaxAnisotropy, rhs.mComparisonFunc, rhs.mBorderColor, rhs.mMinLOD, rhs.mMaxLOD);
+}
+
+inline bool operator!=(const StaticSampler& lhs, const StaticSampler& rhs) noexcept {
+    return !(lhs == rhs);
+}
+
 struct ShaderAttribute {
     ShaderAttribute() = default;
     ShaderAttribute(std::string name, AttributeType type, AttributeDescriptor descriptor)
@@ -318,6 +346,12 @@ struct ShaderAttribute {
         , mDescriptor(std::move(descriptor))
         , mDefaultValue(std::move(defaultValue))
     {}
+    ShaderAttribute(std::string name, AttributeType type, StaticSampler sampler, AttributeDescriptor descriptor)
+        : mName(std::move(name))
+        , mType(std::move(type))
+        , mDescriptor(std::move(descriptor))
+        , mSampler(std::move(sampler))
+    {}
     ShaderAttribute(std::string name, ValueModel model, AttributeType type, AttributeDescriptor descriptor)
         : mName(std::move(name))
         , mModel(std::move(model))
@@ -385,6 +419,8 @@ struct ShaderAttribute {
     AttributeDescriptor mDescriptor;
     uint32_t mFlags = 0;
     std::string mDefaultValue;
+    // state of SSV root parameters, compiled into the root signature
+    StaticSampler mSampler;
 };
 
 enum ModuleBuilderFlags : uint32_t {
@@ -29,13 +29,18 @@ void createBasicModules(ShaderModules& modules) {
 
         { "View", matrix, TypePass, Unity::BuiltIn },
         { "Proj", matrix, TypePass, Unity::BuiltIn },
+        { "ViewportScale", float2, TypePass, Unity::BuiltIn },
+        { "Jitter", float2, TypePass, Unity::BuiltIn },
 
         { "World", matrix, TypeInstance, Unity::BuiltIn },
         { "WorldInvT", matrix, TypeInstance, Unity::BuiltIn },
         { "WorldView", matrix, TypeInstance, Unity::BuiltIn },
+        { "TextureIndices", uint4, TypeInstance, Unity::BuiltIn },
+        { "MaterialIndex", uint1, TypeInstance, Unity::BuiltIn },
 
-        { "PointSampler", SamplerState, TypeStaticSampler },
-        { "LinearSampler", SamplerState, TypeStaticSampler },
+        { "PointSampler", SamplerState, StaticSampler{ FILTER_MIN_MAG_MIP_POINT,
+            TEXTURE_ADDRESS_MODE_CLAMP, TEXTURE_ADDRESS_MODE_CLAMP, TEXTURE_ADDRESS_MODE_CLAMP }, TypeStaticSampler },
+        { "LinearSampler", SamplerState, StaticSampler{ FILTER_MIN_MAG_MIP_LINEAR }, TypeStaticSampler },
 
         { "Normal", half3, Texture2D, TypeRenderTarget },
         { "BaseColor", half3, Texture2D, TypeRenderTarget },
@@ -44,6 +49,14 @@ void createBasicModules(ShaderModules& modules) {
 
         { "MainTex", half4, Texture2D, TypeMaterial },
         { "NormalMap", half3, Texture2D, TypeMaterial },
+
+        { "Textures", half4, Texture2D, TypeBindless },
+
+        { "PointLights", float4, StructuredBuffer, TypePass },
+        { "LightGrid", uint2, StructuredBuffer, TypePass },
+        { "LightIndices", uint1, StructuredBuffer, TypePass },
+
+        { "MaterialConstants", float4, StructuredBuffer, TypePass },
     });
 
     ADD_MODULE(Empty, Inline);
@@ -142,10 +155,12 @@ uv.y = 1.0 - (float)(vertexID / 2) * 2.0f;
 )" }
     );
 
+    // upscales the rendered part of Radiance with dynamic resolution
     ADD_MODULE(CopyRadiance, Inline,
         Attributes{
             { "Radiance", Texture2D },
-            { "PointSampler", SamplerState },
+            { "LinearSampler", SamplerState },
+            { "ViewportScale", float2 },
         },
         Outputs{
             { "color", half4  }
@@ -153,7 +168,27 @@ uv.y = 1.0 - (float)(vertexID / 2) * 2.0f;
         Inputs{
             { "uv", float2, TEXCOORD }
         },
-        Content{ R"(color = half4(Radiance.Sample(PointSampler, uv).xyz, 1.0h);
+        Content{ R"(color = half4(Radiance.Sample(LinearSampler, uv * ViewportScale).xyz, 1.0h);
+)" }
+    );
+
+    // spatial fallback of an UPSCALING node, resamples Radiance with the projection jitter removed
+    // temporal upscalers replace the draw of the subpass and also read its depth and motion inputs
+    ADD_MODULE(UpscaleRadiance, Inline,
+        Attributes{
+            { "Radiance", Texture2D },
+            { "LinearSampler", SamplerState },
+            { "ViewportScale", float2 },
+            { "Jitter", float2 },
+        },
+        Outputs{
+            { "color", half4  }
+        },
+        Inputs{
+            { "uv", float2, TEXCOORD }
+        },
+        Content{ R"(float2 jitterUV = float2(0.5f, -0.5f) * Jitter;
+color = half4(Radiance.Sample(LinearSampler, (uv + jitterUV) * ViewportScale).xyz, 1.0h);
 )" }
     );
 
@@ -163,6 +198,7 @@ uv.y = 1.0 - (float)(vertexID / 2) * 2.0f;
             { "Normal", Texture2D },
             { "DepthStencil", Texture2D },
             { "PointSampler", SamplerState },
+            { "ViewportScale", float2 },
         },
         Outputs{
             { "baseColor", half3 },
@@ -172,9 +208,10 @@ uv.y = 1.0 - (float)(vertexID / 2) * 2.0f;
         Inputs{
             { "uv", float2, TEXCOORD },
         },
-        Content{ R"(baseColor = BaseColor.Sample(PointSampler, uv).xyz;
-worldNormal = 2.0h * Normal.Sample(PointSampler, uv).xyz - 1.0h;
-depth = DepthStencil.Sample(PointSampler, uv).x;
+        Content{ R"(float2 targetUV = uv * ViewportScale;
+baseColor = BaseColor.Sample(PointSampler, targetUV).xyz;
+worldNormal = 2.0h * Normal.Sample(PointSampler, targetUV).xyz - 1.0h;
+depth = DepthStencil.Sample(PointSampler, targetUV).x;
 )" }
     );
 
@@ -296,6 +333,54 @@ lightIntensity = half3(1.0h, 1.0h, 1.0h);
 )" }
     );
 
+    // reads the cluster light lists of a LIGHT_CULLING node, grid matches the engine light culling
+    ADD_MODULE(EvaluateClusteredLights, Inline,
+        Attributes{
+            { "View", matrix },
+            { "Proj", matrix },
+            { "PointLights", StructuredBuffer },
+            { "LightGrid", StructuredBuffer },
+            { "LightIndices", StructuredBuffer },
+        },
+        Outputs{
+            { "color", half4 },
+        },
+        Inputs{
+            { "color", half4 },
+            { "baseColor", half3 },
+            { "worldNormal", half3 },
+            { "depth", float1 },
+            { "uv", float2, TEXCOORD },
+        },
+        Content{ R"({
+    const uint3 clusters = uint3(16, 9, 24);
+    float z0 = abs(Proj._34 / -Proj._33);
+    float z1 = abs(Proj._34 / (Proj._43 - Proj._33));
+    float zNear = min(z0, z1);
+    float zFar = max(z0, z1);
+    float viewZ = Proj._34 / (depth * Proj._43 - Proj._33);
+    float2 ndc = float2(uv.x * 2.0f - 1.0f, 1.0f - uv.y * 2.0f);
+    float3 viewPos = float3(viewZ * (ndc.x * Proj._43 - Proj._13) / Proj._11,
+        viewZ * (ndc.y * Proj._43 - Proj._23) / Proj._22, viewZ);
+    float3 viewNormal = normalize(mul((float3x3)View, (float3)worldNormal));
+
+    uint slice = (uint)clamp(log(abs(viewZ) / zNear) / log(zFar / zNear) * clusters.z, 0.0f, clusters.z - 1.0f);
+    uint2 tile = min((uint2)(saturate(uv) * clusters.xy), clusters.xy - 1);
+    uint2 range = LightGrid[(slice * clusters.y + tile.y) * clusters.x + tile.x];
+    for (uint i = 0; i != range.y; ++i) {
+        uint lightID = LightIndices[range.x + i];
+        float4 position = PointLights[2 * lightID];
+        float4 intensity = PointLights[2 * lightID + 1];
+        float3 toLight = mul(View, float4(position.xyz, 1.0f)).xyz - viewPos;
+        float distance = length(toLight);
+        float falloff = saturate(1.0f - distance / position.w);
+        float ndotl = saturate(dot(viewNormal, toLight / max(distance, 1e-4f)));
+        color.xyz += baseColor * (half3)(intensity.xyz * intensity.w * ndotl * falloff * falloff);
+    }
+}
+)" }
+    );
+
     // Normal Mapping
     ADD_MODULE(WorldNormal, Inline,
         Attributes{
@@ -371,7 +456,8 @@ tangentToWorld2 = half4(worldTangent.z, worldBinormal.z, worldNormal.z, 0.0h);
         Inputs{
             { "uv", float2, TEXCOORD },
         },
-        Content{ R"(tangentNormal = NormalMap.Sample(LinearSampler, uv).xyz * 2 - 1;
+        Content{ R"(half2 normalXY = NormalMap.Sample(LinearSampler, uv).xy * 2 - 1;
+tangentNormal = half3(normalXY, sqrt(saturate(1 - dot(normalXY, normalXY))));
 )" }
     );
 
@@ -20,6 +20,7 @@
 #include <StarCompiler/ShaderGraph/SShaderValue.h>
 #include <StarCompiler/ShaderGraph/SShaderGroup.h>
 #include <StarCompiler/ShaderGraph/SShaderRootSignature.h>
+#include <StarCompiler/ShaderGraph/SShaderDescriptorDatabase.h>
 #include <StarCompiler/ShaderGraph/SShaderDescriptor.h>
 #include <StarCompiler/ShaderGraph/SShaderNames.h>
 #include <StarCompiler/Graphics/SRenderNames.h>
@@ -95,21 +96,40 @@ std::string HLSLGenerator::generateOutput(const ShaderStageType& stage) const {
 }
 
 std::string HLSLGenerator::generateModules() const {
-    std::ostringstream oss;
-    std::string space;
+    std::vector<std::string> generated;
+    std::vector<const std::string*> texts;
+    generated.reserve(mProgram.mGraph.mNodeIndex.size());
+    texts.reserve(mProgram.mGraph.mNodeIndex.size());
+    size_t size = 0;
 
     for (const auto& p : mProgram.mGraph.mNodeIndex) {
         const auto& node = mProgram.mGraph.mNodeGraph[p.second];
-        if (getContent(node).empty())
+        const auto content = getContent(node);
+        if (content.empty())
             continue;
         if (node.mBuilderFlags & Inline)
             continue;
 
-        oss << "\n";
-        copyString(oss, space, generateModule(node));
+        if (mModuleCache) {
+            auto& fragment = mModuleCache->mFragments[node.mName];
+            if (fragment.mText.empty() || fragment.mContent != content) {
+                fragment.mContent = content;
+                fragment.mText = generateModule(node);
+            }
+            texts.emplace_back(&fragment.mText);
+        } else {
+            texts.emplace_back(&generated.emplace_back(generateModule(node)));
+        }
+        size += texts.back()->size() + 1;
     }
 
-    return oss.str();
+    std::string result;
+    result.reserve(size);
+    for (const auto* text : texts) {
+        result.push_back('\n');
+        result.append(*text);
+    }
+    return result;
 }
 
 std::string HLSLGenerator::generateShader(const ShaderStageType& stage) const {
@@ -198,6 +218,34 @@ void outputAttribute(std::ostream& oss, std::string& space,
 ) {
     visit(overload(
         [&](CBuffer_) {
+            const auto& cb = pRSG ? pRSG->mDatabase.mConstantBuffers.at(index) : parent.getConstantBuffer(index);
+            if (std::holds_alternative<SRV_>(index.mType)) {
+                // instanced constants, indexed by SV_InstanceID
+                if (!std::holds_alternative<VS_>(index.mVisibility)) {
+                    throw std::invalid_argument("instanced constants only supported in vertex shader");
+                }
+                const auto packed = packConstantBuffer(cb, true);
+                oss << "struct " << getName(index.mUpdate) << "Data {\n";
+                {
+                    INDENT();
+                    for (const auto& p : packed.mConstants) {
+                        oss << space << getHLSLName(p.mConstant->mType) << " m" << p.mConstant->mName << ";\n";
+                    }
+                }
+                oss << "};\n";
+                oss << "StructuredBuffer<" << getName(index.mUpdate) << "Data> g"
+                    << getName(index.mUpdate) << " : register(t" << slotID;
+                if (spaceID) {
+                    oss << ", space" << spaceID;
+                }
+                oss << ");\n";
+                for (const auto& c : cb.mValues) {
+                    oss << "#define m" << c.mName << " g" << getName(index.mUpdate)
+                        << "[gInstanceID].m" << c.mName << "\n";
+                }
+                slotID += getDescriptorCapacity(attr);
+                return;
+            }
             oss << "cbuffer " << getName(index.mUpdate) << " : register(b"
                 << slotID;
             if (spaceID) {
@@ -205,17 +253,11 @@ void outputAttribute(std::ostream& oss, std::string& space,
             }
             oss << ") {\n";
             {
+                // declared in packed order, hlsl places each value where the builder expects it
                 INDENT();
-                if (pRSG) {
-                    const auto& cb = pRSG->mDatabase.mConstantBuffers.at(index);
-                    for (const auto& c : cb.mValues) {
-                        oss << space << getHLSLName(c.mType) << " m" << c.mName << ";\n";
-                    }
-                } else {
-                    const auto& cb = parent.getConstantBuffer(index);
-                    for (const auto& c : cb.mValues) {
-                        oss << space << getHLSLName(c.mType) << " m" << c.mName << ";\n";
-                    }
+                const auto packed = packConstantBuffer(cb);
+                for (const auto& p : packed.mConstants) {
+                    oss << space << getHLSLName(p.mConstant->mType) << " m" << p.mConstant->mName << ";\n";
                 }
             }
             oss << "};\n";
@@ -307,11 +349,20 @@ void outputAttributes(std::ostream& oss, std::string& space, const ShaderGroup&
 
         auto slotID = range.mStart;
         auto spaceID = range.mSpace;
+        std::vector<const ShaderAttribute*> samplers;
         for (const auto& subrangePair : range.mSubranges) {
             const auto& source = subrangePair.first;
             const auto& subrange = subrangePair.second;
             oss << "// " << getVariantName(source) << "\n";
             for (const auto& attr : subrange.mAttributes) {
+                // static samplers of the same state are one sampler of the root signature
+                if (std::holds_alternative<SSV_>(attr.mDescriptor.mRootParameterType)) {
+                    if (const auto* pShared = findSharedSampler(samplers, attr)) {
+                        oss << "#define m" << attr.mName << " m" << pShared->mName << "\n";
+                        continue;
+                    }
+                    samplers.emplace_back(&attr);
+                }
                 outputAttribute(oss, space, attr, slotID, spaceID, parent, index, pRSG);
             }
         }
@@ -337,6 +388,10 @@ std::string HLSLGenerator::generateAttributes(const AttributeMap& attrs,
     std::ostringstream oss;
     std::string space;
     int count = 0;
+    if (mInstancing && std::holds_alternative<VS_>(stage)) {
+        oss << "static uint gInstanceID = 0;\n";
+        ++count;
+    }
     for (int i = UpdateEnum::UpdateCount; i --> static_cast<int>(rsgGroup.mUpdateFrequency);) {
         for (const auto& collectionPair : rsgGroup.mRootSignature.mDatabase.mDescriptors) {
             const auto& index = collectionPair.first;
@@ -398,18 +453,46 @@ std::string HLSLGenerator::generateAttributes(const AttributeMap& attrs,
     return oss.str();
 }
 
+// identifiers are scanned once, a regex per attribute dominated the export of large libraries
 std::string HLSLGenerator::renameAttributes(const ShaderModule& node) const {
-    auto content = std::string(getContent(node));
-    for (const auto& attr : node.mAttributes) {
-        std::string name = "\\b(" + attr.mName + ")\\b";
-        std::regex e(name);
-        if (mAttributeRegex.empty()) {
-            content = std::regex_replace(content, e, "m$1");
+    const auto content = getContent(node);
+    if (node.mAttributes.empty())
+        return std::string(content);
+
+    const auto isWord = [](char c) {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+    };
+    const auto& attributeRegex = mAttributeRegex.empty() ? std::string("m$1") : mAttributeRegex;
+
+    std::string result;
+    result.reserve(content.size() + content.size() / 4);
+    size_t i = 0;
+    while (i != content.size()) {
+        if (!isWord(content[i])) {
+            result.push_back(content[i++]);
+            continue;
+        }
+        size_t end = i + 1;
+        while (end != content.size() && isWord(content[end])) {
+            ++end;
+        }
+        const auto word = content.substr(i, end - i);
+        const auto iter = std::find_if(node.mAttributes.begin(), node.mAttributes.end(),
+            [&](const AttributeUsage& attr) { return attr.mName == word; });
+        if (iter == node.mAttributes.end()) {
+            result.append(word);
         } else {
-            content = std::regex_replace(content, e, mAttributeRegex);
+            const auto& pattern = mInstancedAttributes.count(iter->mName) ?
+                mAttributeInstancingRegex : attributeRegex;
+            const auto pos = pattern.find("$1");
+            Expects(pos != std::string::npos);
+            result.append(pattern, 0, pos);
+            result.append(word);
+            result.append(pattern, pos + 2);
         }
+        i = end;
     }
-    return content;
+    return result;
 }
 
 std::string HLSLGenerator::generateModule(const ShaderModule& node) const {
@@ -463,6 +546,28 @@ std::string HLSLGenerator::generateModule(const ShaderModule& node) const {
     return oss.str();
 }
 
+std::string HLSLGenerator::getTarget(const ShaderStageType& stage) const {
+    std::string target = visit(overload(
+        [](PS_) { return "ps_"; },
+        [](GS_) { return "gs_"; },
+        [](DS_) { return "ds_"; },
+        [](HS_) { return "hs_"; },
+        [](VS_) { return "vs_"; },
+        [](CS_) { return "cs_"; },
+        [](auto) -> const char* {
+            throw std::invalid_argument("shader stage has no compile target");
+        }
+    ), stage);
+
+    target += visit(overload(
+        [](SM5_0_) { return "5_0"; },
+        [](SM6_0_) { return "6_0"; },
+        [](SM6_6_) { return "6_6"; }
+    ), mShaderModel);
+
+    return target;
+}
+
 std::string_view HLSLGenerator::getContent(const ShaderModule& node) const {
     if (node.mContents.empty())
         return {};
@@ -496,6 +601,9 @@ std::string HLSLGenerator::generateMain(const ShaderStageType& stage) const {
     }
 
     INDENT();    
+    if (mInstancing && std::holds_alternative<VS_>(stage)) {
+        OSS << "gInstanceID = instanceID;\n";
+    }
     copyString(oss, space, generateInputCopy(shader, declared));
     
     int count = 0;
@@ -530,11 +638,20 @@ std::string HLSLGenerator::generateMainSignature(const ShaderStage& shader, std:
     const auto& naming = mNamings.at(stage);
 
     const auto& inputs = mInputs.at(stage);
+    const bool instanced = mInstancing && std::holds_alternative<VS_>(stage);
     if (inputs.empty()) {
-        oss << naming.mOutputStruct << " " << naming.mMain << "()";
+        oss << naming.mOutputStruct << " " << naming.mMain << "(";
+        if (instanced) {
+            oss << "uint instanceID : SV_InstanceID";
+        }
+        oss << ")";
     } else {
         oss << naming.mOutputStruct << " " << naming.mMain << "("
-            << naming.mInputStruct << " " << naming.mInputVariable << ")";
+            << naming.mInputStruct << " " << naming.mInputVariable;
+        if (instanced) {
+            oss << ", uint instanceID : SV_InstanceID";
+        }
+        oss << ")";
     }
 
     return oss.str();
@@ -23,6 +23,16 @@ namespace Star::Graphics::Render::Shader {
 
 class ShaderGroup;
 
+// generated modules keyed by name, shared by generators of the same configuration.
+// a module is regenerated only if its content changed, not thread safe
+struct HLSLModuleCache {
+    struct Fragment {
+        std::string mContent;
+        std::string mText;
+    };
+    std::unordered_map<std::string, Fragment> mFragments;
+};
+
 class HLSLGenerator {
 public:
     HLSLGenerator(const ShaderProgram& program, Language l = HLSL);
@@ -37,6 +47,9 @@ public:
     std::string generateInput(const ShaderStageType& stage) const;
     std::string generateOutput(const ShaderStageType& stage) const;
     std::string generateMain(const ShaderStageType& stage) const;
+
+    // compile target of the stage for mShaderModel, e.g. ps_5_0 or ps_6_6
+    std::string getTarget(const ShaderStageType& stage) const;
 private:
     // helpers
     std::string renameAttributes(const ShaderModule& node) const;
@@ -54,11 +67,16 @@ public:
     const ShaderProgram& mProgram;
     std::string mAttributeRegex = "m$1";
     std::string mAttributeInstancingRegex = "m$1";
+    // attributes renamed by mAttributeInstancingRegex instead of mAttributeRegex
+    std::set<std::string> mInstancedAttributes;
     std::map<ShaderStageType, ShaderStageContent> mNamings;
     std::map<ShaderStageType, IdentityMap<ShaderSemanticValue>> mInputs;
     std::map<ShaderStageType, IdentityMap<ShaderSemanticValue>> mOutputs;
     Language mLanguage;
+    ShaderModel mShaderModel;
+    bool mInstancing = false;
     bool mDebug = true;
+    HLSLModuleCache* mModuleCache = nullptr;
 };
 
 }
@@ -23,16 +23,35 @@
 #include <StarCompiler/STextUtils.h>
 #include <Star/Graphics/SRenderGraphReflection.h>
 #include <Star/Graphics/SRenderUtils.h>
+#include <execution>
 
 namespace Star::Graphics::Render::Shader {
 
 void ShaderAssetBuilder::buildShaders(const ShaderDatabase& database, const ShaderGroups& sw, const ShaderModules& modules) {
+    // prototypes only read the shader groups and modules, their sources are generated in parallel
+    // compile tasks are gathered in prototype order, compilation is deferred and runs in parallel
+    struct PrototypeBuild {
+        const std::string* mName = nullptr;
+        const ShaderPrototype* mPrototype = nullptr;
+        ShaderData* mData = nullptr;
+        std::vector<ShaderCompileTask> mTasks;
+    };
+    std::vector<PrototypeBuild> builds;
+    builds.reserve(database.mPrototypes.size());
     for (const auto& [prototypeName, prototype] : database.mPrototypes) {
         auto res = mShaders.emplace(std::piecewise_construct,
             std::forward_as_tuple(prototypeName), std::forward_as_tuple());
         Ensures(res.second);
+        builds.emplace_back(PrototypeBuild{ &prototypeName, &prototype, &res.first->second });
+    }
 
-        auto& prototypeData = res.first->second;
+    std::for_each(std::execution::par, builds.begin(), builds.end(), [&](PrototypeBuild& build) {
+        const auto& prototypeName = *build.mName;
+        const auto& prototype = *build.mPrototype;
+        auto& prototypeData = *build.mData;
+        auto& tasks = build.mTasks;
+        // modules are formatted once for all variants of the prototype, the cache is not shared
+        HLSLModuleCache moduleCache;
         for (const auto& [bundleName, bundle] : prototype.mSolutions) {
             auto res = prototypeData.mSolutions.emplace(std::piecewise_construct,
                 std::forward_as_tuple(bundleName), std::forward_as_tuple());
@@ -77,6 +96,9 @@ void ShaderAssetBuilder::buildShaders(const ShaderDatabase& database, const Shad
 
                                 const auto& [pProgram, rsg] = group.mPrograms.at(shaderName);
                                 HLSLGenerator hlsl(*pProgram);
+                                hlsl.mInstancing = true;
+                                hlsl.mModuleCache = &moduleCache;
+                                hlsl.mShaderModel = sw.getShaderModel(bundleName);
 
                                 passData.mSubpasses.emplace_back();
                                 auto& subpassData = passData.mSubpasses.back();
@@ -91,15 +113,15 @@ void ShaderAssetBuilder::buildShaders(const ShaderDatabase& database, const Shad
                                     std::ostringstream oss;
                                     std::string space;
                                     oss << hlsl.generateAttributes(modules.mAttributes, stageID, group.getRootSignatureShaderGroup(), rsg);
-                                    if (!oss.str().empty())
+                                    if (oss.tellp() > 0)
                                         oss << "\n";
                                     oss << hlsl.generateModules();
                                     oss << hlsl.generateShader(stageID);
 
                                     visit(overload(
                                         [&](PS_) {
-                                            compileShader(subpassData.mProgram.mPS, "ps_5_0",
-                                                shaderName + ".ps", oss.str());
+                                            tasks.emplace_back(ShaderCompileTask{ &subpassData.mProgram.mPS, hlsl.getTarget(PS),
+                                                shaderName + ".ps", oss.str() });
                                         },
                                         [&](GS_) {
                                             throw std::invalid_argument("shader not supported");
@@ -131,8 +153,8 @@ void ShaderAssetBuilder::buildShaders(const ShaderDatabase& database, const Shad
                                                     subpassData.mInputLayout.mSemantics[type].emplace_back(input.mName);
                                                 }
                                             }
-                                            compileShader(subpassData.mProgram.mVS, "vs_5_0",
-                                                shaderName + ".vs", oss.str());
+                                            tasks.emplace_back(ShaderCompileTask{ &subpassData.mProgram.mVS, hlsl.getTarget(VS),
+                                                shaderName + ".vs", oss.str() });
                                         },
                                         [](auto) {
                                             throw std::runtime_error("unknown shader");
@@ -146,7 +168,13 @@ void ShaderAssetBuilder::buildShaders(const ShaderDatabase& database, const Shad
                 } // queue
             } // pipeline
         } // bundle
-    } // prototype
+    }); // prototype
+
+    std::vector<ShaderCompileTask> tasks;
+    for (auto& build : builds) {
+        std::move(build.mTasks.begin(), build.mTasks.end(), std::back_inserter(tasks));
+    }
+    compileShaderTasks(tasks);
 }
 
 void ShaderAssetBuilder::build(Resources& resources) const {
@@ -160,11 +188,18 @@ void ShaderAssetBuilder::build(Resources& resources) const {
     }
 }
 
-void buildShaderData(const ShaderPrototype& prototype, const ShaderModules& modules,
+namespace {
+
+// compiled shaders are queued into pTasks, without tasks the hlsl text is stored instead.
+// if pQueues is set, only the listed (solution, pipeline, queue) variants are built
+void buildShaderDataImpl(const ShaderPrototype& prototype, const ShaderModules& modules,
     const ShaderGroups& sw, const AttributeDatabase& attrs,
-    ShaderData& prototypeData, bool bCompile
+    ShaderData& prototypeData, std::vector<ShaderCompileTask>* pTasks,
+    const ShaderQueueSet* pQueues
 ) {
+    const bool bCompile = pTasks != nullptr;
     prototypeData.mName = prototype.mName;
+    HLSLModuleCache moduleCache;
     for (const auto& [bundleName, bundle] : prototype.mSolutions) {
         auto solutionIter = sw.mSolutions.find(bundleName);
         if (solutionIter == sw.mSolutions.end()) {
@@ -182,6 +217,9 @@ void buildShaderData(const ShaderPrototype& prototype, const ShaderModules& modu
 
             auto& pipelineData = res.first->second;
             for (const auto& [queueName, queue] : pipeline.mQueues) {
+                if (pQueues && !pQueues->count(ShaderQueueKey{ bundleName, pipelineName, queueName })) {
+                    continue;
+                }
                 auto res = pipelineData.mQueues.emplace(std::piecewise_construct,
                     std::forward_as_tuple(queueName), std::forward_as_tuple());
                 Ensures(res.second);
@@ -217,6 +255,9 @@ void buildShaderData(const ShaderPrototype& prototype, const ShaderModules& modu
 
                             const auto& [pProgram, rsg] = group.mPrograms.at(shaderName);
                             HLSLGenerator hlsl(*pProgram);
+                            hlsl.mInstancing = true;
+                            hlsl.mModuleCache = &moduleCache;
+                            hlsl.mShaderModel = sw.getShaderModel(bundleName);
 
                             subpassData.mState.mStreamOutput = {};
                             subpassData.mState.mBlendState = getRenderType(subpass.mShaderState.mBlendState);
@@ -240,7 +281,10 @@ void buildShaderData(const ShaderPrototype& prototype, const ShaderModules& modu
                                     constantBuffer.mIndex = index;
                                     constantBuffer.mConstants.reserve(srcConstantBuffer.mValues.size());
                                     Expects(constantBuffer.mSize == 0);
-                                    for (const auto& src : srcConstantBuffer.mValues) {
+                                    const auto packed = packConstantBuffer(srcConstantBuffer,
+                                        std::holds_alternative<SRV_>(index.mType));
+                                    for (const auto& [pSrc, offset] : packed.mConstants) {
+                                        const auto& src = *pSrc;
                                         Expects(!src.mName.empty());
                                         const auto& attr = at(attrs.mAttributes, src.mName);
                                         auto& dst = constantBuffer.mConstants.emplace_back();
@@ -257,10 +301,9 @@ void buildShaderData(const ShaderPrototype& prototype, const ShaderModules& modu
                                         ), attr.mSource);
                                         dst.mSource = attr.mSource;
                                         dst.mID = gsl::narrow<uint32_t>(attrs.mIndex.at(src.mName));
-                                        auto sz = getSize(src.mType);
-                                        Ensures(sz);
-                                        constantBuffer.mSize += sz;
+                                        dst.mOffset = offset;
                                     }
+                                    constantBuffer.mSize = packed.mSize;
                                 }
                                 // build material descriptor tables
                                 for (const auto& parentCollectionPair : group.mRootSignature.mDatabase.mDescriptors) {
@@ -354,7 +397,7 @@ void buildShaderData(const ShaderPrototype& prototype, const ShaderModules& modu
                                 std::ostringstream oss;
                                 std::string space;
                                 oss << hlsl.generateAttributes(modules.mAttributes, stageID, group.getRootSignatureShaderGroup(), rsg);
-                                if (!oss.str().empty())
+                                if (oss.tellp() > 0)
                                     oss << "\n";
                                 oss << hlsl.generateModules();
                                 oss << hlsl.generateShader(stageID);
@@ -362,8 +405,8 @@ void buildShaderData(const ShaderPrototype& prototype, const ShaderModules& modu
                                 visit(overload(
                                     [&](PS_) {
                                         if (bCompile) {
-                                            compileShader(subpassData.mProgram.mPS, "ps_5_0",
-                                                shaderName + ".vs", oss.str());
+                                            pTasks->emplace_back(ShaderCompileTask{ &subpassData.mProgram.mPS, hlsl.getTarget(PS),
+                                                shaderName + ".vs", oss.str() });
                                         } else {
                                             Expects(subpassData.mProgram.mPS.empty());
                                             auto content = oss.str();
@@ -403,8 +446,8 @@ void buildShaderData(const ShaderPrototype& prototype, const ShaderModules& modu
                                             }
                                         }
                                         if (bCompile) {
-                                            compileShader(subpassData.mProgram.mVS, "vs_5_0",
-                                                shaderName + ".vs", oss.str());
+                                            pTasks->emplace_back(ShaderCompileTask{ &subpassData.mProgram.mVS, hlsl.getTarget(VS),
+                                                shaderName + ".vs", oss.str() });
                                         } else {
                                             Expects(subpassData.mProgram.mVS.empty());
                                             auto content = oss.str();
@@ -427,6 +470,29 @@ void buildShaderData(const ShaderPrototype& prototype, const ShaderModules& modu
     } // bundle
 }
 
+}
+
+void buildShaderData(const ShaderPrototype& prototype, const ShaderModules& modules,
+    const ShaderGroups& sw, const AttributeDatabase& attrs,
+    ShaderData& prototypeData, bool bCompile
+) {
+    if (bCompile) {
+        std::vector<ShaderCompileTask> tasks;
+        buildShaderDataImpl(prototype, modules, sw, attrs, prototypeData, &tasks, nullptr);
+        compileShaderTasks(tasks);
+    } else {
+        buildShaderDataImpl(prototype, modules, sw, attrs, prototypeData, nullptr, nullptr);
+    }
+}
+
+void buildShaderData(const ShaderPrototype& prototype, const ShaderModules& modules,
+    const ShaderGroups& sw, const AttributeDatabase& attrs,
+    ShaderData& prototypeData, std::vector<ShaderCompileTask>& tasks,
+    const ShaderQueueSet* pQueues
+) {
+    buildShaderDataImpl(prototype, modules, sw, attrs, prototypeData, &tasks, pQueues);
+}
+
 void buildShaderText(std::ostream& oss, const ShaderData& prototype) {
     std::string space;
     OSS << "Shader \"" << prototype.mName << "\" {\n";
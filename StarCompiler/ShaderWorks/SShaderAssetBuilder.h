@@ -19,6 +19,7 @@
 #include <Star/Graphics/SContentTypes.h>
 #include <StarCompiler/ShaderGraph/SShaderDatabase.h>
 #include <StarCompiler/ShaderGraph/SShaderGroups.h>
+#include <StarCompiler/ShaderWorks/SShaderCompiler.h>
 
 namespace Star::Graphics::Render::Shader {
 
@@ -42,6 +43,16 @@ public:
 void buildShaderData(const ShaderPrototype& prototype, const ShaderModules& modules,
     const ShaderGroups& sw, const AttributeDatabase& attributes,
     ShaderData& prototypeData, bool bCompile = true);
+// (solution, pipeline, queue) a shader variant is drawn in
+using ShaderQueueKey = std::tuple<std::string, std::string, std::string>;
+using ShaderQueueSet = std::set<ShaderQueueKey>;
+
+// queues the compilation into tasks, run them with compileShaderTasks.
+// when queues are given, unreachable variants are stripped
+void buildShaderData(const ShaderPrototype& prototype, const ShaderModules& modules,
+    const ShaderGroups& sw, const AttributeDatabase& attributes,
+    ShaderData& prototypeData, std::vector<ShaderCompileTask>& tasks,
+    const ShaderQueueSet* pQueues = nullptr);
 void buildShaderText(std::ostream& oss, const ShaderData& prototypeData);
 void buildShaderText2(std::ostream& oss, const ShaderData& prototype);
 
@@ -16,24 +16,128 @@
 // along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
 
 #include "SShaderCompiler.h"
+#include <chrono>
+#include <execution>
+#include <iomanip>
+#include <thread>
+#include <boost/functional/hash.hpp>
 
 // msvc
 #include <D3Dcompiler.h>
 #pragma comment(lib, "D3DCompiler.lib")
+#include <dxcapi.h>
+#pragma comment(lib, "dxcompiler.lib")
 
 // Star
 #include <Star/SWinRT.h>
 
 namespace Star::Graphics::Render::Shader {
 
-void compileShader(std::pmr::string& buffer, const std::string& target,
-    const std::string& name, const std::string& content
-) {
+namespace {
+
+struct ShaderCache {
+    std::filesystem::path mLocalFolder;
+    std::filesystem::path mSharedFolder;
+};
+
+ShaderCache sShaderCache;
+
+UINT getCompileFlags() noexcept {
     UINT flags = D3DCOMPILE_ENABLE_STRICTNESS | D3DCOMPILE_WARNINGS_ARE_ERRORS;
 #if defined( DEBUG ) || defined( _DEBUG )
     flags |= D3DCOMPILE_DEBUG;
 #endif
+    return flags;
+}
+
+// shader model 6 targets are compiled to dxil with dxc, older ones with fxc
+bool isDXCTarget(const std::string& target) noexcept {
+    auto pos = target.find('_');
+    return pos != std::string::npos && pos + 1 < target.size() && target[pos + 1] >= '6';
+}
+
+uint32_t getDXCVersion() {
+    static const uint32_t sVersion = []() {
+        com_ptr<IDxcCompiler3> compiler;
+        ThrowIfFailed(DxcCreateInstance(CLSID_DxcCompiler, IID_PPV_ARGS(compiler.put())));
+        UINT32 major = 0;
+        UINT32 minor = 0;
+        auto info = compiler.try_as<IDxcVersionInfo>();
+        if (info) {
+            ThrowIfFailed(info->GetVersion(&major, &minor));
+        }
+        return (major << 16) | minor;
+    }();
+    return sVersion;
+}
+
+// entries are named by hash(source, target, flags, compiler version)
+std::string getCacheFilename(const std::string& target, UINT flags, const std::string& content) {
+    size_t seed = 0;
+    boost::hash_combine(seed, content);
+    boost::hash_combine(seed, target);
+    boost::hash_combine(seed, flags);
+    if (isDXCTarget(target)) {
+        boost::hash_combine(seed, std::string_view("dxc"));
+        boost::hash_combine(seed, getDXCVersion());
+    } else {
+        boost::hash_combine(seed, D3D_COMPILER_VERSION);
+    }
+    std::ostringstream oss;
+    oss << std::hex << std::setw(16) << std::setfill('0') << seed << ".cso";
+    return oss.str();
+}
+
+// entry layout: source size, source, bytecode. the source is compared to rule out collisions
+bool try_readCache(const std::filesystem::path& folder, const std::string& filename,
+    const std::string& content, std::string& bytecode
+) {
+    if (folder.empty())
+        return false;
+
+    auto entry = readBinary(folder / filename);
+    uint64_t sz = 0;
+    if (entry.size() < sizeof(sz))
+        return false;
+    std::memcpy(&sz, entry.data(), sizeof(sz));
+    if (entry.size() < sizeof(sz) + sz)
+        return false;
+    if (std::string_view(entry.data() + sizeof(sz), sz) != content)
+        return false;
+
+    bytecode.assign(entry.data() + sizeof(sz) + sz, entry.size() - sizeof(sz) - sz);
+    return !bytecode.empty();
+}
+
+void writeCache(const std::filesystem::path& folder, const std::string& filename,
+    const std::string& content, const std::string& bytecode
+) noexcept {
+    if (folder.empty())
+        return;
+
+    // written to a temporary first so concurrent builds never read a partial entry
+    try {
+        create_directories(folder);
+        std::ostringstream tmpName;
+        tmpName << filename << "." << std::this_thread::get_id() << ".tmp";
+        auto tmp = folder / tmpName.str();
+        {
+            std::ofstream ofs(tmp, std::ios::binary);
+            ofs.exceptions(std::ostream::failbit);
+            uint64_t sz = content.size();
+            ofs.write(reinterpret_cast<const char*>(&sz), sizeof(sz));
+            ofs.write(content.data(), content.size());
+            ofs.write(bytecode.data(), bytecode.size());
+        }
+        std::filesystem::rename(tmp, folder / filename);
+    } catch (const std::exception& e) {
+        std::cout << "write shader cache: " << filename << " failed, " << e.what() << std::endl;
+    }
+}
 
+bool compileFXC(const std::string& target, const std::string& name,
+    const std::string& content, UINT flags, std::string& bytecode
+) {
     com_ptr<ID3DBlob> shaderBlob;
     com_ptr<ID3DBlob> errorBlob;
 
@@ -49,58 +153,174 @@ void compileShader(std::pmr::string& buffer, const std::string& target,
         std::cout << "compile shader: " << name << " failed, " <<
             std::string_view(static_cast<const char*>(errorBlob->GetBufferPointer()),
                 errorBlob->GetBufferSize()) << std::endl;
-        return;
+        return false;
     }
 
-    buffer.resize(shaderBlob->GetBufferSize());
-    std::memcpy(buffer.data(), shaderBlob->GetBufferPointer(), buffer.size());
+    bytecode.assign(static_cast<const char*>(shaderBlob->GetBufferPointer()),
+        shaderBlob->GetBufferSize());
+    return true;
 }
 
-void compileShaderFile(const std::filesystem::path& filename, const std::string& target,
-    const std::string& name, const std::string& content
+bool compileDXC(const std::string& target, const std::string& name,
+    const std::string& content, UINT flags, std::string& bytecode
 ) {
-    UINT flags = D3DCOMPILE_ENABLE_STRICTNESS | D3DCOMPILE_WARNINGS_ARE_ERRORS;
-#if defined( DEBUG ) || defined( _DEBUG )
-    flags |= D3DCOMPILE_DEBUG;
-#endif
+    // dxc objects are not thread safe, every compiling thread owns its own
+    thread_local com_ptr<IDxcUtils> utils;
+    thread_local com_ptr<IDxcCompiler3> compiler;
+    thread_local com_ptr<IDxcIncludeHandler> includeHandler;
+    if (!compiler) {
+        ThrowIfFailed(DxcCreateInstance(CLSID_DxcUtils, IID_PPV_ARGS(utils.put())));
+        ThrowIfFailed(DxcCreateInstance(CLSID_DxcCompiler, IID_PPV_ARGS(compiler.put())));
+        ThrowIfFailed(utils->CreateDefaultIncludeHandler(includeHandler.put()));
+    }
 
-    com_ptr<ID3DBlob> shaderBlob;
-    com_ptr<ID3DBlob> errorBlob;
+    std::wstring wname(name.begin(), name.end());
+    std::wstring wtarget(target.begin(), target.end());
+    std::vector<LPCWSTR> args{ wname.c_str(), L"-E", L"main", L"-T", wtarget.c_str() };
+    if (flags & D3DCOMPILE_ENABLE_STRICTNESS) {
+        args.emplace_back(DXC_ARG_ENABLE_STRICTNESS);
+    }
+    if (flags & D3DCOMPILE_WARNINGS_ARE_ERRORS) {
+        args.emplace_back(DXC_ARG_WARNINGS_ARE_ERRORS);
+    }
+    if (flags & D3DCOMPILE_DEBUG) {
+        args.emplace_back(DXC_ARG_DEBUG);
+        args.emplace_back(L"-Qembed_debug");
+    }
+    // 16-bit types need shader model 6.2
+    if (target.compare(target.size() - 3, 3, "6_6") == 0) {
+        args.emplace_back(L"-enable-16bit-types");
+    }
 
-    HRESULT hr = S_OK;
+    DxcBuffer source{ content.data(), content.size(), DXC_CP_UTF8 };
+    com_ptr<IDxcResult> result;
+    ThrowIfFailed(compiler->Compile(&source, args.data(), gsl::narrow_cast<UINT32>(args.size()),
+        includeHandler.get(), IID_PPV_ARGS(result.put())));
 
-    hr = D3DCompile(content.data(), content.size(), name.c_str(),
-        nullptr,
-        D3D_COMPILE_STANDARD_FILE_INCLUDE,
-        "main", target.c_str(),
-        flags, 0, shaderBlob.put(), errorBlob.put());
-
-    if (FAILED(hr)) {
+    HRESULT status = S_OK;
+    ThrowIfFailed(result->GetStatus(&status));
+    if (FAILED(status)) {
+        com_ptr<IDxcBlobUtf8> errors;
+        result->GetOutput(DXC_OUT_ERRORS, IID_PPV_ARGS(errors.put()), nullptr);
         std::cout << "compile shader: " << name << " failed, " <<
-            std::string_view(static_cast<const char*>(errorBlob->GetBufferPointer()),
-                errorBlob->GetBufferSize()) << std::endl;
+            (errors ? std::string_view(errors->GetStringPointer(), errors->GetStringLength()) : std::string_view())
+            << std::endl;
+        return false;
+    }
+
+    com_ptr<IDxcBlob> object;
+    ThrowIfFailed(result->GetOutput(DXC_OUT_OBJECT, IID_PPV_ARGS(object.put()), nullptr));
+    bytecode.assign(static_cast<const char*>(object->GetBufferPointer()),
+        object->GetBufferSize());
+    return true;
+}
+
+bool compileBytecode(const std::string& target, const std::string& name,
+    const std::string& content, std::string& bytecode
+) {
+    const UINT flags = getCompileFlags();
+    const auto filename = getCacheFilename(target, flags, content);
+
+    if (try_readCache(sShaderCache.mLocalFolder, filename, content, bytecode)) {
+        return true;
+    }
+    if (try_readCache(sShaderCache.mSharedFolder, filename, content, bytecode)) {
+        writeCache(sShaderCache.mLocalFolder, filename, content, bytecode);
+        return true;
+    }
+
+    bool succeeded = isDXCTarget(target) ?
+        compileDXC(target, name, content, flags, bytecode) :
+        compileFXC(target, name, content, flags, bytecode);
+    if (!succeeded) {
+        return false;
+    }
+
+    writeCache(sShaderCache.mLocalFolder, filename, content, bytecode);
+    writeCache(sShaderCache.mSharedFolder, filename, content, bytecode);
+    return true;
+}
+
+}
+
+void setShaderCache(std::filesystem::path localFolder, std::filesystem::path sharedFolder) {
+    sShaderCache.mLocalFolder = std::move(localFolder);
+    sShaderCache.mSharedFolder = std::move(sharedFolder);
+}
+
+void compileShader(std::pmr::string& buffer, const std::string& target,
+    const std::string& name, const std::string& content
+) {
+    std::string bytecode;
+    if (!compileBytecode(target, name, content, bytecode)) {
         return;
     }
 
+    buffer.assign(bytecode.begin(), bytecode.end());
+}
 
-    if (exists(filename)) {
-        com_ptr<ID3DBlob> origShaderBlob;
-        ThrowIfFailed(D3DReadFileToBlob(filename.wstring().c_str(), origShaderBlob.put()));
-        if (std::string_view(static_cast<const char*>(origShaderBlob->GetBufferPointer()),
-            origShaderBlob->GetBufferSize()) !=
-            std::string_view(static_cast<const char*>(shaderBlob->GetBufferPointer()),
-                shaderBlob->GetBufferSize()))
-        {
-            ThrowIfFailed(D3DWriteBlobToFile(shaderBlob.get(), filename.wstring().c_str(), true));
+void compileShaderFile(const std::filesystem::path& filename, const std::string& target,
+    const std::string& name, const std::string& content
+) {
+    std::string bytecode;
+    if (!compileBytecode(target, name, content, bytecode)) {
+        return;
+    }
+
+    updateBinary(filename.string(), bytecode);
+}
+
+void compileShaderTasks(std::vector<ShaderCompileTask>& tasks, std::vector<double>* pMilliseconds) {
+    // identical programs are compiled once and copied
+    std::map<std::pair<std::string_view, std::string_view>, size_t> unique;
+    std::vector<size_t> sources(tasks.size());
+    std::vector<size_t> compiled;
+    for (size_t i = 0; i != tasks.size(); ++i) {
+        Expects(tasks[i].mBuffer);
+        auto res = unique.emplace(std::make_pair(
+            std::string_view(tasks[i].mTarget), std::string_view(tasks[i].mContent)), i);
+        sources[i] = res.first->second;
+        if (res.second) {
+            compiled.emplace_back(i);
+        }
+    }
+
+    if (pMilliseconds) {
+        pMilliseconds->assign(tasks.size(), 0.0);
+    }
+    std::for_each(std::execution::par, compiled.begin(), compiled.end(),
+        [&tasks, pMilliseconds](size_t i) {
+            auto& task = tasks[i];
+            auto start = std::chrono::steady_clock::now();
+            compileShader(*task.mBuffer, task.mTarget, task.mName, task.mContent);
+            if (pMilliseconds) {
+                (*pMilliseconds)[i] = std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - start).count();
+            }
+        });
+
+    for (size_t i = 0; i != tasks.size(); ++i) {
+        if (sources[i] != i) {
+            *tasks[i].mBuffer = *tasks[sources[i]].mBuffer;
         }
-    } else {
-        ThrowIfFailed(D3DWriteBlobToFile(shaderBlob.get(), filename.wstring().c_str(), true));
     }
 }
 
+namespace {
+
+struct ShaderFileTask {
+    std::filesystem::path mFilename;
+    std::string mTarget;
+    std::string mName;
+    std::string mContent;
+};
+
+}
+
 void compileShaders(const ShaderGroups& shaderWorks,
     const std::filesystem::path& folder, const std::filesystem::path& binaryFolder
 ) {
+    std::vector<ShaderFileTask> tasks;
     if (!exists(binaryFolder)) {
         create_directories(binaryFolder);
     }
@@ -119,7 +339,7 @@ void compileShaders(const ShaderGroups& shaderWorks,
 
                         filename += "-rs";
                         auto content = readFile(folder / (filename + ".hlsl"));
-                        compileShaderFile(binaryFolder / (filename + ".cso"), "rootsig_1_1", filename, content);
+                        tasks.emplace_back(ShaderFileTask{ binaryFolder / (filename + ".cso"), "rootsig_1_1", filename, std::move(content) });
                     }
 
                     for (const auto& [name, pair] : group.mPrograms) {
@@ -133,27 +353,27 @@ void compileShaders(const ShaderGroups& shaderWorks,
                                 [&](PS_) {
                                     filename2 += "-ps";
                                     auto content = readFile(folder / (filename2 + ".hlsl"));
-                                    compileShaderFile(binaryFolder / (filename2 + ".cso"), "ps_5_0", filename2, content);
+                                    tasks.emplace_back(ShaderFileTask{ binaryFolder / (filename2 + ".cso"), "ps_5_0", filename2, std::move(content) });
                                 },
                                 [&](GS_) {
                                     filename2 += "-gs";
                                     auto content = readFile(folder / (filename2 + ".hlsl"));
-                                    compileShaderFile(binaryFolder / (filename2 + ".cso"), "gs_5_0", filename2, content);
+                                    tasks.emplace_back(ShaderFileTask{ binaryFolder / (filename2 + ".cso"), "gs_5_0", filename2, std::move(content) });
                                 },
                                 [&](DS_) {
                                     filename2 += "-ds";
                                     auto content = readFile(folder / (filename2 + ".hlsl"));
-                                    compileShaderFile(binaryFolder / (filename2 + ".cso"), "ds_5_0", filename2, content);
+                                    tasks.emplace_back(ShaderFileTask{ binaryFolder / (filename2 + ".cso"), "ds_5_0", filename2, std::move(content) });
                                 },
                                 [&](HS_) {
                                     filename2 += "-hs";
                                     auto content = readFile(folder / (filename2 + ".hlsl"));
-                                    compileShaderFile(binaryFolder / (filename2 + ".cso"), "hs_5_0", filename2, content);
+                                    tasks.emplace_back(ShaderFileTask{ binaryFolder / (filename2 + ".cso"), "hs_5_0", filename2, std::move(content) });
                                 },
                                 [&](VS_) {
                                     filename2 += "-vs";
                                     auto content = readFile(folder / (filename2 + ".hlsl"));
-                                    compileShaderFile(binaryFolder / (filename2 + ".cso"), "vs_5_0", filename2, content);
+                                    tasks.emplace_back(ShaderFileTask{ binaryFolder / (filename2 + ".cso"), "vs_5_0", filename2, std::move(content) });
                                 },
                                 [](auto) {}
                             ), stage);
@@ -163,6 +383,12 @@ void compileShaders(const ShaderGroups& shaderWorks,
             }
         }
     }
+
+    // shader sources are read serially, only the compilation is parallel
+    std::for_each(std::execution::par, tasks.begin(), tasks.end(),
+        [](const ShaderFileTask& task) {
+            compileShaderFile(task.mFilename, task.mTarget, task.mName, task.mContent);
+        });
 }
 
 }
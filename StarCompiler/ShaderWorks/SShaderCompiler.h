@@ -20,6 +20,17 @@
 
 namespace Star::Graphics::Render::Shader {
 
+// bytecode is looked up in the local cache folder first, then in the shared one.
+// freshly compiled shaders are stored in both, empty paths disable a cache
+void setShaderCache(std::filesystem::path localFolder, std::filesystem::path sharedFolder = {});
+
+struct ShaderCompileTask {
+    std::pmr::string* mBuffer = nullptr;
+    std::string mTarget;
+    std::string mName;
+    std::string mContent;
+};
+
 void compileShader(std::pmr::string& buffer,
     const std::string& target, const std::string& name,
     const std::string& content);
@@ -27,6 +38,10 @@ void compileShader(std::pmr::string& buffer,
 void compileShaderFile(const std::filesystem::path& filename, const std::string& target,
     const std::string& name, const std::string& content);
 
+// tasks run concurrently, each writes its own buffer so results do not depend on scheduling.
+// pMilliseconds receives the compile time of each task, zero for tasks copied from an identical one
+void compileShaderTasks(std::vector<ShaderCompileTask>& tasks, std::vector<double>* pMilliseconds = nullptr);
+
 void compileShaders(const ShaderGroups& shaderWorks,
     const std::filesystem::path& folder, const std::filesystem::path& binaryFolder);
 
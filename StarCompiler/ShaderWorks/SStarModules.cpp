@@ -33,9 +33,13 @@ void createStarModules(ShaderModules& modules) {
         { "World", matrix, TypeInstance, Unity::BuiltIn },
         { "WorldInvT", matrix, TypeInstance, Unity::BuiltIn },
         { "WorldView", matrix, TypeInstance, Unity::BuiltIn },
+        { "PrevWorldView", matrix, TypeInstance },
+        { "TextureIndices", uint4, TypeInstance, Unity::BuiltIn },
+        { "MaterialIndex", uint1, TypeInstance, Unity::BuiltIn },
 
-        { "PointSampler", SamplerState, TypeStaticSampler },
-        { "LinearSampler", SamplerState, TypeStaticSampler },
+        { "PointSampler", SamplerState, StaticSampler{ FILTER_MIN_MAG_MIP_POINT,
+            TEXTURE_ADDRESS_MODE_CLAMP, TEXTURE_ADDRESS_MODE_CLAMP, TEXTURE_ADDRESS_MODE_CLAMP }, TypeStaticSampler },
+        { "LinearSampler", SamplerState, StaticSampler{ FILTER_MIN_MAG_MIP_LINEAR }, TypeStaticSampler },
 
         // Unreal SceneTextures
         { "SceneColor", Texture2D, TypePass },
@@ -73,6 +77,9 @@ void createStarModules(ShaderModules& modules) {
         { "BumpMapSampler", SamplerState, TypeMaterial },
         { "Material", Texture2D, TypeMaterial },
         { "MaterialSampler", SamplerState, TypeMaterial },
+
+        // Bindless
+        { "Textures", Texture2D, TypeBindless },
     });
 
     ADD_MODULE(ClipPos, Inline,
@@ -93,6 +100,36 @@ void createStarModules(ShaderModules& modules) {
         }
     );
 
+    // clip positions of this and the previous frame, interpolated for per pixel motion
+    ADD_MODULE(MotionClipPos, Inline,
+        Attributes{
+            { "WorldView", matrix },
+            { "PrevWorldView", matrix },
+            { "Proj", matrix },
+        },
+        Outputs{
+            { "currClipPos", float4, TEXCOORD },
+            { "prevClipPos", float4, TEXCOORD },
+        },
+        Inputs{
+            { "vertex", float4, POSITION }
+        },
+        Content{ "currClipPos = mul(Proj, mul(WorldView, vertex));\n"
+            "prevClipPos = mul(Proj, mul(PrevWorldView, vertex));\n" }
+    );
+
+    // screen motion since the previous frame in ndc units, written by passes feeding temporal techniques
+    ADD_MODULE(Velocity, Inline,
+        Outputs{
+            { "velocity", float2 },
+        },
+        Inputs{
+            { "currClipPos", float4 },
+            { "prevClipPos", float4 },
+        },
+        Content{ "velocity = currClipPos.xy / currClipPos.w - prevClipPos.xy / prevClipPos.w;\n" }
+    );
+
     ADD_MODULE(WorldPos, Inline,
         Attributes{
             { "World", matrix },
@@ -549,7 +586,8 @@ tspace2 = half4(worldTangent.z, worldBinormal.z, worldNormal.z, viewDir.z);
             { "deviceUV", float2, TEXCOORD },
         },
         Contents{
-            { "normalTS = BumpMap.Sample(BumpMapSampler, deviceUV).xyz;\n" },
+            { "half2 normalXY = BumpMap.Sample(BumpMapSampler, deviceUV).xy * 2 - 1;\n"
+                "normalTS = half3(normalXY, sqrt(saturate(1 - dot(normalXY, normalXY))));\n" },
             { "normalTS = UnpackNormal(tex2D(BumpMap, deviceUV)).xyz;\n", UnityCG }
         }
     );
@@ -19,11 +19,16 @@
 #include <StarCompiler/ShaderGraph/SShaderPrototype.h>
 #include <StarCompiler/ShaderGraph/SShaderNames.h>
 #include "SHLSLGenerator.h"
+#include <execution>
+#include <mutex>
 
 namespace Star::Graphics::Render::Shader {
 
 namespace {
 
+// shaders are exported in parallel, warnings of a pass are printed together
+std::mutex sConsoleMutex;
+
 struct UnityIsPropertyVisitor {
     bool operator()(const uint4_&) const { return false; }
     bool operator()(const uint2_&) const { return false; }
@@ -200,6 +205,16 @@ struct UnityPropertyDefaultValueVisitor {
     }
 };
 
+struct UnityIsTextureVisitor {
+    bool operator()(Texture1D_) const { return true; }
+    bool operator()(Texture2D_) const { return true; }
+    bool operator()(Texture2DArray_) const { return true; }
+    bool operator()(Texture3D_) const { return true; }
+    bool operator()(TextureCube_) const { return true; }
+
+    template<class T> bool operator()(const T&) const { return false; }
+};
+
 struct UnityHLSLNameVisitor {
     const char* operator()(const matrix_& v) const { return "matrix"; }
     const char* operator()(const float4_& v) const { return "float4"; }
@@ -229,6 +244,44 @@ struct UnityHLSLNameVisitor {
     const char* operator()(const T&) const { return ""; }
 };
 
+// properties declared by the shader, not by unity or its includes
+bool isUnityProperty(const ShaderAttribute& attr) {
+    if (attr.mFlags & (Unity::Global | Unity::BuiltIn | Unity::Declared))
+        return false;
+    return visit(UnityIsPropertyVisitor{}, attr.mType);
+}
+
+// per instance properties, or properties marked Instanced, vary per object in the instancing buffer
+bool isUnityInstanced(const ShaderAttribute& attr) {
+    return attr.mDescriptor.mUpdate == PerInstance || (attr.mFlags & Unity::Instanced) != 0;
+}
+
+// numeric properties and texture scale offsets are in UnityPerMaterial, instanced properties are per draw
+bool isUnityPerMaterial(const ShaderAttribute& attr) {
+    if (!isUnityProperty(attr))
+        return false;
+    if (visit(UnityIsTextureVisitor{}, attr.mType))
+        return (attr.mFlags & Unity::TexScaleOffset) != 0;
+    return !isUnityInstanced(attr);
+}
+
+// properties of a pass declared outside of UnityPerMaterial, they make the SRP Batcher skip the shader
+std::vector<std::string> getUnbatchedProperties(const AttributeMap& attrs,
+    const AttributeMap& materialAttrs, bool instancing
+) {
+    std::vector<std::string> names;
+    for (const auto& attr : attrs) {
+        if (!isUnityProperty(attr) || visit(UnityIsTextureVisitor{}, attr.mType))
+            continue;
+        if (instancing && isUnityInstanced(attr))
+            continue;
+        if (isUnityPerMaterial(attr) && materialAttrs.find(get_key(attr)) != materialAttrs.end())
+            continue;
+        names.emplace_back("_" + attr.mName);
+    }
+    return names;
+}
+
 } // namespace
 
 std::string UnityShaderBuilder::generateShader(const AttributeMap& attrMap, const ShaderPrototype& p) const {
@@ -268,6 +321,15 @@ std::string UnityShaderBuilder::generateShader(const AttributeMap& attrMap, cons
     if (!p.mSolutions.empty() && !p.mSolutions.begin()->second.mPipelines.empty()) {
         auto attrs = getAttributes(attrMap, p.getAttributes());
         copyString(oss, generateProperties(attrs, p));
+
+        // one layout for all passes, including properties a pass does not read
+        AttributeMap materialAttrs;
+        for (const auto& attr : attrs) {
+            if (isUnityPerMaterial(attr)) {
+                materialAttrs.emplace(attr);
+            }
+        }
+
         const auto& pipeline = p.mSolutions.begin()->second.mPipelines.begin()->second;
         for (const auto& [queueName, queue] : pipeline.mQueues) {
             for (const auto& subshader : queue.mLevels) {
@@ -286,7 +348,19 @@ std::string UnityShaderBuilder::generateShader(const AttributeMap& attrMap, cons
                         }
                         copyString(oss, generatePassStates(pass));
                         auto attrs = getAttributes(attrMap, pass.mProgram.mGraph.mAttributeUsages);
-                        copyString(oss, generateProgram(attrs, pass));
+                        copyString(oss, generateProgram(attrs, materialAttrs, pass));
+
+                        auto unbatched = getUnbatchedProperties(attrs, materialAttrs, pass.mUnityInstancing);
+                        if (!unbatched.empty()) {
+                            std::lock_guard<std::mutex> lock(sConsoleMutex);
+                            CONSOLE_WARNING();
+                            std::cout << " shader \"" << p.mName << "\" pass \"" << pass.mName
+                                << "\" is not SRP Batcher compatible, outside of UnityPerMaterial:";
+                            for (const auto& name : unbatched) {
+                                std::cout << " " << name;
+                            }
+                            std::cout << std::endl;
+                        }
 
                         oss << "\n";
                         oss << "} // Pass end\n";
@@ -321,6 +395,25 @@ std::string UnityShaderBuilder::generateShader(const AttributeMap& attrMap, cons
     return oss.str();
 }
 
+uint32_t UnityShaderBuilder::exportShaders(const AttributeMap& attrs, const ShaderDatabase& db,
+    const std::vector<UnityShaderFile>& files
+) const {
+    std::vector<std::string> contents(files.size());
+    std::vector<size_t> indices(files.size());
+    std::iota(indices.begin(), indices.end(), size_t(0));
+    std::for_each(std::execution::par, indices.begin(), indices.end(), [&](size_t i) {
+        contents[i] = generateShader(attrs, at(db.mPrototypes, files[i].mShader));
+    });
+
+    uint32_t count = 0;
+    for (size_t i = 0; i != files.size(); ++i) {
+        if (updateFile(files[i].mPath, contents[i])) {
+            ++count;
+        }
+    }
+    return count;
+}
+
 std::string UnityShaderBuilder::generateProperties(
     const AttributeMap& attrs, const ShaderPrototype& p
 ) const {
@@ -525,7 +618,9 @@ std::string UnityShaderBuilder::generatePassStates(const ShaderPass& p) const {
     return oss.str();
 }
 
-std::string UnityShaderBuilder::generateProgram(const AttributeMap& attrs, const ShaderPass& pass) const {
+std::string UnityShaderBuilder::generateProgram(const AttributeMap& attrs,
+    const AttributeMap& materialAttrs, const ShaderPass& pass
+) const {
     std::ostringstream oss;
     std::string space;
 
@@ -578,7 +673,17 @@ std::string UnityShaderBuilder::generateProgram(const AttributeMap& attrs, const
     }
 
     auto attrSet = getAttributes(attrs, pass.mProgram.mGraph.mAttributeUsages);
-    copyString(oss, space, generateAttributes(attrSet, pass.mUnityInstancing));
+    copyString(oss, space, generateAttributes(attrSet, materialAttrs, pass.mUnityInstancing));
+
+    // instanced properties are read through the instancing buffer, the instance id is set up per stage
+    if (pass.mUnityInstancing) {
+        for (const auto& attr : attrSet) {
+            if (isUnityProperty(attr) && isUnityInstanced(attr)) {
+                hlsl.mInstancedAttributes.emplace(attr.mName);
+            }
+        }
+    }
+    const bool instancedPS = !hasGS && !hlsl.mInstancedAttributes.empty();
 
     copyString(oss, hlsl.generateModules());
 
@@ -629,6 +734,9 @@ std::string UnityShaderBuilder::generateProgram(const AttributeMap& attrs, const
         if (pass.mUnityInstancing) {
             v2f += "    UNITY_SETUP_INSTANCE_ID(v);\n";
         }
+        if (instancedPS) {
+            v2f += "    UNITY_TRANSFER_INSTANCE_ID(v, o);\n";
+        }
         boost::replace_first(content, "{\n", v2f);
 
         if (pass.mUnityReceiveShadow && !pass.isShadowCaster() && !pass.isMeta()) {
@@ -650,7 +758,13 @@ std::string UnityShaderBuilder::generateProgram(const AttributeMap& attrs, const
     }
 
     oss << "\n";
-    copyString(oss, space, hlsl.generateMain(PS));
+    {
+        auto content = hlsl.generateMain(PS);
+        if (instancedPS) {
+            boost::replace_first(content, "{\n", "{\n    UNITY_SETUP_INSTANCE_ID(IN);\n");
+        }
+        copyString(oss, space, content);
+    }
 
     oss << '\n';
     OSS << "ENDCG\n";
@@ -659,10 +773,17 @@ std::string UnityShaderBuilder::generateProgram(const AttributeMap& attrs, const
 }
 
 std::string UnityShaderBuilder::generateAttributes(
-    const AttributeMap& attrs, bool instancing
+    const AttributeMap& attrs, const AttributeMap& materialAttrs, bool instancing
 ) const {
     std::ostringstream oss;
 
+    // textures stay outside, their scale offsets are in the constant buffer
+    const auto perMaterial = generatePerMaterial(materialAttrs);
+    const auto isDeclaredPerMaterial = [&](const ShaderAttribute& attr) {
+        return !visit(UnityIsTextureVisitor{}, attr.mType) && isUnityPerMaterial(attr) &&
+            materialAttrs.find(get_key(attr)) != materialAttrs.end();
+    };
+
     int count = 0;
     int instanced = 0;
     for (const auto& attr : attrs) {
@@ -672,7 +793,7 @@ std::string UnityShaderBuilder::generateAttributes(
         if (attr.mFlags & Unity::BuiltIn)
             continue;
 
-        if (instancing && attr.mDescriptor.mUpdate == PerInstance) {
+        if (instancing && isUnityInstanced(attr)) {
             ++instanced;
             continue;
         }
@@ -680,6 +801,9 @@ std::string UnityShaderBuilder::generateAttributes(
         if (!visit(UnityIsPropertyVisitor{}, attr.mType))
             continue;
 
+        if (isDeclaredPerMaterial(attr))
+            continue;
+
         visit(overload(
             [&](Texture2D_) {
                 if (attr.mFlags & Unity::SeparateSampler) {
@@ -700,17 +824,25 @@ std::string UnityShaderBuilder::generateAttributes(
             }
         ), attr.mType);
 
-        if (attr.mFlags & Unity::TexScaleOffset) {
+        if ((attr.mFlags & Unity::TexScaleOffset) && !isUnityPerMaterial(attr)) {
             oss << "float4 " << "_" + attr.mName << "_ST;\n";
         }
         ++count;
     }
 
+    if (!perMaterial.empty()) {
+        if (count) {
+            oss << "\n";
+        }
+        oss << perMaterial;
+        ++count;
+    }
+
     if (instancing && instanced) {
         oss << "\n";
         oss << "UNITY_INSTANCING_BUFFER_START(Props)\n";
         for (const auto& attr : attrs) {
-            if (!(attr.mDescriptor.mUpdate == PerInstance))
+            if (!isUnityInstanced(attr))
                 continue;
 
             if (attr.mFlags & Unity::Declared)
@@ -735,4 +867,21 @@ std::string UnityShaderBuilder::generateAttributes(
     return oss.str();
 }
 
+std::string UnityShaderBuilder::generatePerMaterial(const AttributeMap& materialAttrs) const {
+    std::ostringstream oss;
+    if (materialAttrs.empty())
+        return oss.str();
+
+    oss << "CBUFFER_START(UnityPerMaterial)\n";
+    for (const auto& attr : materialAttrs) {
+        if (visit(UnityIsTextureVisitor{}, attr.mType)) {
+            oss << "    float4 _" << attr.mName << "_ST;\n";
+        } else {
+            oss << "    " << visit(UnityHLSLNameVisitor{}, attr.mType) << " _" << attr.mName << ";\n";
+        }
+    }
+    oss << "CBUFFER_END\n";
+    return oss.str();
+}
+
 }
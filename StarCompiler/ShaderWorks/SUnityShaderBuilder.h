@@ -17,18 +17,30 @@
 
 #pragma once
 #include <StarCompiler/ShaderGraph/SShaderPrototype.h>
+#include <StarCompiler/ShaderGraph/SShaderDatabase.h>
 
 namespace Star::Graphics::Render::Shader {
 
+struct UnityShaderFile {
+    std::string mShader;
+    std::filesystem::path mPath;
+};
+
 class UnityShaderBuilder {
 public:
     std::string generateShader(const AttributeMap& attrs, const ShaderPrototype& p) const;
+    // shaders are generated in parallel, only files whose content changed are written
+    // returns the number of files written
+    uint32_t exportShaders(const AttributeMap& attrs, const ShaderDatabase& db,
+        const std::vector<UnityShaderFile>& files) const;
 private:
     std::string generateProperties(const AttributeMap& attrMap, const ShaderPrototype& p) const;
     std::string generateSubShaderStates(const ShaderLevel& subshader) const;
     std::string generatePassStates(const ShaderPass& p) const;
-    std::string generateProgram(const AttributeMap& attrs, const ShaderPass& p) const;
-    std::string generateAttributes(const AttributeMap& attrs, bool instancing) const;
+    // material properties of every pass are declared in one UnityPerMaterial layout, so the SRP Batcher accepts them
+    std::string generateProgram(const AttributeMap& attrs, const AttributeMap& materialAttrs, const ShaderPass& p) const;
+    std::string generateAttributes(const AttributeMap& attrs, const AttributeMap& materialAttrs, bool instancing) const;
+    std::string generatePerMaterial(const AttributeMap& materialAttrs) const;
 };
 
 }